@@ -107,6 +107,8 @@ def _get_dslx_test_cmdline(ctx, src, all_srcs, append_cmd_line_args = True):
         "disable_warnings",
         "enable_warnings",
         "max_ticks",
+        "proc_threads",
+        "test_threads",
         "format_preference",
     )
 
@@ -735,6 +737,9 @@ def _xls_dslx_generate_cpp_type_files_impl(ctx):
     if ctx.attr.namespace:
         my_args.add("--namespaces={}".format(ctx.attr.namespace))
 
+    if ctx.attr.native_layout:
+        my_args.add("--generate_native_layout")
+
     ctx.actions.run(
         outputs = [cc_file, h_file],
         tools = [cpp_transpiler_tool],
@@ -759,6 +764,11 @@ def _xls_dslx_generate_cpp_type_files_impl(ctx):
 
 xls_dslx_generate_cpp_type_files_attrs = {
     "namespace": attr.string(doc = "The C++ namespace to generate the code in (e.g., `foo::bar`)."),
+    "native_layout": attr.bool(
+        doc = "Whether to also generate conversions to and from the native " +
+              "layout used by the JIT.",
+        default = False,
+    ),
     "source_file": attr.output(
         doc = "The filename of the generated source file. The filename must " +
               "have a '" + _CC_FILE_EXTENSION + "' extension.",
@@ -54,6 +54,19 @@ _xls_aot_files_attrs = {
         doc = "if the jit code should be compiled with msan",
         mandatory = True,
     ),
+    "pgo_instrument": attr.bool(
+        doc = "if the code should be instrumented to collect an LLVM profile " +
+              "for profile-guided optimization. Binaries linking the code " +
+              "write a raw profile at exit (see LLVM_PROFILE_FILE) which " +
+              "should be merged with `llvm-profdata merge` and passed as " +
+              "pgo_profile to a rebuild.",
+        default = False,
+    ),
+    "pgo_profile": attr.label(
+        doc = "merged LLVM profile (.profdata) collected from a " +
+              "pgo_instrument build used to optimize the code.",
+        allow_single_file = True,
+    ),
     "_save_temps_is_requested": attr.label(
         doc = "save_temps config",
         default = "//xls/common/config:save_temps_is_requested",
@@ -104,6 +117,19 @@ def _xls_aot_generate_impl(ctx):
         args.add("-output_llvm_opt_ir", llvm_opt_ir_file.path)
         args.add("-output_asm", asm_file.path)
 
+    inputs = [src.ir_file]
+    user_link_flags = []
+    if ctx.attr.pgo_instrument and ctx.file.pgo_profile:
+        fail("pgo_instrument and pgo_profile are mutually exclusive")
+    if ctx.attr.pgo_instrument:
+        args.add("--pgo_instrument")
+
+        # The instrumented code calls into the LLVM profile runtime.
+        user_link_flags = ["-fprofile-generate"]
+    if ctx.file.pgo_profile:
+        args.add("--pgo_profile", ctx.file.pgo_profile.path)
+        inputs.append(ctx.file.pgo_profile)
+
     other_linking_contexts = []
     if ctx.attr.with_msan:
         args.add("--include_msan=true")
@@ -114,7 +140,7 @@ def _xls_aot_generate_impl(ctx):
         args.add("--include_msan=false")
     ctx.actions.run(
         outputs = [proto_file, obj_file] + extra_files,
-        inputs = [src.ir_file],
+        inputs = inputs,
         arguments = [args],
         executable = aot_compiler,
         mnemonic = "AOTCompiling",
@@ -132,6 +158,7 @@ def _xls_aot_generate_impl(ctx):
         cc_toolchain = cc_toolchain,
         compilation_outputs = obj_file_outputs,
         linking_contexts = other_linking_contexts,
+        user_link_flags = user_link_flags,
     )
     cc_common.merge_compilation_contexts()
 
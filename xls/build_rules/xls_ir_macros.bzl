@@ -210,7 +210,9 @@ def xls_ir_cc_library_macro(
         name,
         src,
         top = None,
-        namespaces = ""):
+        namespaces = "",
+        pgo_instrument = False,
+        pgo_profile = None):
     """Invokes the AOT compiles the input IR into a cc_library.
 
     Example:
@@ -238,11 +240,17 @@ def xls_ir_cc_library_macro(
       top: The entry point in the IR file of interest.
       namespaces: A comma-separated list of namespaces into which the
                   generated code should go.
+      pgo_instrument: Whether to instrument the code to collect an LLVM
+                  profile for profile-guided optimization.
+      pgo_profile: A merged LLVM profile collected from a pgo_instrument
+                  build with which to optimize the code.
     """
     string_type_check("name", name)
     string_type_check("src", src)
     string_type_check("top", top, True)
     string_type_check("namespaces", namespaces)
+    bool_type_check("pgo_instrument", pgo_instrument)
+    string_type_check("pgo_profile", pgo_profile, True)
 
     aot_name = name + "_gen_aot"
     xls_aot_generate(
@@ -251,6 +259,8 @@ def xls_ir_cc_library_macro(
         top = top,
         # The XLS AOT compiler does not currently support cross-compilation.
         with_msan = XLS_IS_MSAN_BUILD,
+        pgo_instrument = pgo_instrument,
+        pgo_profile = pgo_profile,
     )
 
     wrapper_name = name + "_gen_aot_wrapper"
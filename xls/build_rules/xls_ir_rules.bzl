@@ -140,6 +140,7 @@ def _convert_to_ir(ctx, src):
         "disable_warnings",
         "convert_tests",
         "default_fifo_config",
+        "simplify_during_conversion",
     )
 
     # With runs outside a monorepo, the execution root for the workspace of
@@ -311,6 +312,8 @@ def get_ir_equivalence_test_cmd(
     IR_EQUIVALENCE_FLAGS = (
         "timeout",
         "activation_count",
+        "simulation_samples",
+        "max_cut_points",
     )
 
     ir_equivalence_args = dict(ctx.attr.ir_equivalence_args)
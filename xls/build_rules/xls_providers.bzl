@@ -109,6 +109,8 @@ CODEGEN_FIELDS = {
                                       "streaming channels.",
     "assert_format": "Format string to use for assertions.",
     "gate_format": "Format string to use for gate! ops.",
+    "clock_gate_format": "Format string of the clock gate cell for registers sharing a load enable.",
+    "clock_gating_min_width": "Minimum total width of the registers sharing a clock gate.",
     "smulp_format": "Format string to use for smulp.",
     "umulp_format": "Format string to use for smulp.",
     "ram_configurations": "A comma-separated list of ram configurations.",
@@ -124,6 +126,12 @@ CODEGEN_FIELDS = {
     "emit_sv_types": "Whether or not to honor the #[sv_type(NAME)] annotations in the source DSLX.",
     "codegen_version": "Version of codegen to use (0=default).",
     "materialize_internal_fifos": "Whether or not to materialize internal fifos directly in Verilog.",
+    "block_generation_threads": "Number of threads generating the Verilog of independent blocks; 0 " +
+                                "uses all available CPUs.",
+    "module_cache_dir": "Directory of a cache of generated Verilog modules, reused for unchanged blocks.",
+    "retime_registers": "Whether to retime pipeline registers to reduce register bits.",
+    "low_memory": "Whether to release the converted IR before generating Verilog to lower peak memory use.",
+    "io_analysis_time_budget_ms": "Time budget in milliseconds of the BDD analysis of proc I/O; 0 is unlimited.",
 }
 
 SCHEDULING_FIELDS = {
@@ -151,6 +159,15 @@ SCHEDULING_FIELDS = {
                                       "`--clock_period_ps` is not set, will first " +
                                       "optimize for clock speed, and then find the best " +
                                       "possible worst-case throughput within that constraint.",
+    "lazy_timing_constraints": "If true, the SDC scheduler only adds timing constraints " +
+                               "to its linear program once a solution violates them.",
+    "partitioned_scheduling_threshold": "If positive, functions with more nodes than " +
+                                        "this are scheduled one partition of their " +
+                                        "topological order at a time.",
+    "delay_cache_path": "If set, operation delays are cached by structure in this " +
+                        "file across runs.",
+    "schedule_cache_dir": "If set, schedules are cached in this directory and reused " +
+                          "when the IR and scheduling flags are unchanged.",
     "worst_case_throughput": "Allow scheduling a pipeline with worst-case throughput " +
                              "no slower than once per N cycles. If unspecified and " +
                              "`--minimize_worst_case_throughput` is not set, defaults to 1 " +
@@ -166,6 +183,8 @@ SCHEDULING_FIELDS = {
     "ffi_fallback_delay_ps": "Delay of foreign function calls if not " +
                              "otherwise specified.",
     "io_constraints": "A comma-separated list of IO constraints.",
+    "multi_cycle_ops": "A comma-separated list of ops whose operations may span " +
+                       "several pipeline stages.",
     "receives_first_sends_last": "If true, this forces receives into the " +
                                  "first cycle and sends into the last cycle.",
     "mutual_exclusion_z3_rlimit": "Resource limit for solver in mutual " +
@@ -15,11 +15,25 @@
 #include "xls/codegen/bdd_io_analysis.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/data_structures/union_find.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_util.h"
@@ -48,9 +62,83 @@ bool UseNodeInBddEngine(const Node* node) {
          node->Is<CompareOp>();
 }
 
+// Returns whether the BDD of `node` may be computed from the BDDs of its
+// operands. Other nodes are modeled as new variables.
+bool MayEvaluateInBdd(const Node* node) {
+  return node->GetType()->IsBits() && UseNodeInBddEngine(node) &&
+         absl::c_all_of(node->operands(), [](Node* operand) {
+           return operand->GetType()->IsBits();
+         });
+}
+
+// Returns the nodes which the BDD of `predicate` may depend on: the nodes
+// reachable through operands of evaluated nodes.
+std::vector<Node*> PredicateCone(Node* predicate) {
+  std::vector<Node*> cone = {predicate};
+  absl::flat_hash_set<Node*> visited = {predicate};
+  for (int64_t i = 0; i < cone.size(); ++i) {
+    if (!MayEvaluateInBdd(cone[i])) {
+      continue;
+    }
+    for (Node* operand : cone[i]->operands()) {
+      if (visited.insert(operand).second) {
+        cone.push_back(operand);
+      }
+    }
+  }
+  return cone;
+}
+
+// Send predicates whose BDDs may share variables, and the nodes they depend
+// on. The BDDs of predicates in different groups are independent.
+struct PredicateGroup {
+  std::vector<Node*> predicates;
+  absl::flat_hash_set<Node*> cone;
+};
+
+std::vector<PredicateGroup> GroupPredicates(
+    absl::Span<Node* const> predicates) {
+  std::vector<std::vector<Node*>> cones;
+  cones.reserve(predicates.size());
+  UnionFind<int64_t> groups;
+  absl::flat_hash_map<Node*, int64_t> first_user;
+  for (int64_t i = 0; i < predicates.size(); ++i) {
+    groups.Insert(i);
+    cones.push_back(PredicateCone(predicates[i]));
+    for (Node* node : cones.back()) {
+      auto [it, inserted] = first_user.try_emplace(node, i);
+      if (!inserted) {
+        groups.Union(it->second, i);
+      }
+    }
+  }
+
+  std::vector<PredicateGroup> result;
+  absl::flat_hash_map<int64_t, int64_t> group_index;
+  for (int64_t i = 0; i < predicates.size(); ++i) {
+    auto [it, inserted] =
+        group_index.try_emplace(groups.Find(i), result.size());
+    if (inserted) {
+      result.emplace_back();
+    }
+    PredicateGroup& group = result[it->second];
+    group.predicates.push_back(predicates[i]);
+    group.cone.insert(cones[i].begin(), cones[i].end());
+  }
+  return result;
+}
+
+struct GroupResult {
+  // Whether at most one predicate of the group is true at a time.
+  bool at_most_one_true = false;
+  // Whether any predicate of the group may be true.
+  bool may_be_true = true;
+};
+
 }  // namespace
 
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(Proc* proc) {
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    Proc* proc, const BddIoAnalysisOptions& options) {
   // Find all send nodes associated with streaming channels.
   int64_t streaming_send_count = 0;
   std::vector<Node*> send_predicates;
@@ -87,13 +175,93 @@ absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(Proc* proc) {
     return false;
   }
 
-  // Use BDD query engine to determine predicates are such that
-  // if one is true, the rest are false.
-  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit,
-                              UseNodeInBddEngine);
-  XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
+  // Use BDD query engines to determine predicates are such that if one is
+  // true, the rest are false. Predicates of different groups depend on
+  // disjoint variables, so two of them can only both be true if each can be
+  // true; the outputs are exclusive if the predicates of each group are and at
+  // most one group has a predicate which can be true.
+  std::vector<PredicateGroup> groups = GroupPredicates(send_predicates);
+  int64_t thread_count = std::clamp<int64_t>(
+      options.max_threads == 0 ? AvailableCPUs() : options.max_threads, 1,
+      groups.size());
+  VLOG(3) << absl::StreamFormat(
+      "Analyzing %d send predicates in %d independent groups on %d threads",
+      send_predicates.size(), groups.size(), thread_count);
+
+  std::optional<absl::Time> deadline;
+  if (options.time_budget.has_value()) {
+    deadline = absl::Now() + *options.time_budget;
+  }
+  std::atomic<bool> out_of_time = false;
+  auto in_time = [&]() {
+    if (!deadline.has_value()) {
+      return true;
+    }
+    if (out_of_time.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    if (absl::Now() >= *deadline) {
+      out_of_time.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  };
+
+  // Each thread analyzes every `thread_count`-th group with a single BDD
+  // restricted to the nodes those groups depend on.
+  std::vector<absl::Status> statuses(thread_count);
+  std::vector<GroupResult> results(groups.size());
+  auto analyze = [&](int64_t thread_index) {
+    absl::flat_hash_set<Node*> cone;
+    for (int64_t i = thread_index; i < groups.size(); i += thread_count) {
+      cone.insert(groups[i].cone.begin(), groups[i].cone.end());
+    }
+    BddQueryEngine query_engine(BddFunction::kDefaultPathLimit,
+                                [&](const Node* node) {
+                                  return cone.contains(node) &&
+                                         UseNodeInBddEngine(node) && in_time();
+                                });
+    statuses[thread_index] = query_engine.Populate(proc).status();
+    if (!statuses[thread_index].ok()) {
+      return;
+    }
+    for (int64_t i = thread_index; i < groups.size(); i += thread_count) {
+      results[i].at_most_one_true =
+          query_engine.AtMostOneNodeTrue(groups[i].predicates);
+      results[i].may_be_true =
+          !absl::c_all_of(groups[i].predicates, [&](Node* predicate) {
+            return query_engine.IsAllZeros(predicate);
+          });
+    }
+  };
+  if (thread_count == 1) {
+    analyze(0);
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(
+          std::make_unique<Thread>([&analyze, i]() { analyze(i); }));
+    }
+    for (auto& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  if (out_of_time) {
+    LOG(WARNING) << "I/O analysis of proc " << proc->name()
+                 << " ran out of time; remaining nodes were not evaluated.";
+  }
 
-  return query_engine.AtMostOneNodeTrue(send_predicates);
+  return absl::c_all_of(results,
+                        [](const GroupResult& r) {
+                          return r.at_most_one_true;
+                        }) &&
+         absl::c_count_if(results, [](const GroupResult& r) {
+           return r.may_be_true;
+         }) <= 1;
 }
 
 }  // namespace xls
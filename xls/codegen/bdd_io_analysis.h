@@ -15,16 +15,37 @@
 #ifndef XLS_CODEGEN_BDD_IO_ANALYSIS_H_
 #define XLS_CODEGEN_BDD_IO_ANALYSIS_H_
 
+#include <cstdint>
+#include <optional>
+
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/ir/function_base.h"
 
 namespace xls {
 
+struct BddIoAnalysisOptions {
+  // The maximum number of threads analyzing independent groups of send
+  // predicates. Zero uses all available CPUs. The answer does not depend on
+  // the number of threads.
+  int64_t max_threads = 0;
+
+  // If set, once this much time has passed the remaining nodes are modeled as
+  // unknown values rather than evaluated. The answer stays correct but may
+  // conservatively be that the outputs are not mutually exclusive.
+  std::optional<absl::Duration> time_budget;
+};
+
 // Determines if streaming outputs are mutually exclusive.
 //
+// The send predicates are split into groups whose BDDs depend on disjoint sets
+// of nodes, and the groups are analyzed concurrently, each thread with its own
+// BDD.
+//
 // TODO(tedhong): 2022-02-09 Add analysis of I/O dependencies
 // TODO(tedhong): 2022-02-09 Add additional exclusivity analysis
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(Proc* proc);
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    Proc* proc, const BddIoAnalysisOptions& options = {});
 
 }  // namespace xls
 
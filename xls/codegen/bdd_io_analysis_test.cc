@@ -14,9 +14,11 @@
 
 #include "xls/codegen/bdd_io_analysis.h"
 
+#include <cstdint>
 #include <memory>
 
 #include "gtest/gtest.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel_ops.h"
@@ -212,5 +214,131 @@ TEST_F(BddIOAnalysisPassTest, NonMutuallyExclusiveSendIf) {
   EXPECT_EQ(mutually_exclusive, false);
 }
 
+TEST_F(BddIOAnalysisPassTest, IndependentPredicateGroups) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * sel_a,
+      package.CreateStreamingChannel("sel_a", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * sel_b,
+      package.CreateStreamingChannel("sel_b", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out2,
+      package.CreateStreamingChannel("out2", ChannelOps::kSendOnly, u32));
+
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+
+  BValue in_val = pb.Receive(in);
+  BValue sel_a_val = pb.Receive(sel_a);
+  BValue sel_b_val = pb.Receive(sel_b);
+
+  pb.SendIf(out0, pb.Eq(sel_a_val, pb.Literal(UBits(0, 32))), in_val);
+  pb.SendIf(out1, pb.Eq(sel_a_val, pb.Literal(UBits(1, 32))), in_val);
+  // Never true, so exclusive with the sends predicated on `sel_a`.
+  BValue sel_b_bit = pb.BitSlice(sel_b_val, /*start=*/0, /*width=*/1);
+  pb.SendIf(out2, pb.And(sel_b_bit, pb.Not(sel_b_bit)), in_val);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  for (int64_t max_threads : {1, 2}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        bool mutually_exclusive,
+        AreStreamingOutputsMutuallyExclusive(
+            proc, BddIoAnalysisOptions{.max_threads = max_threads}));
+    EXPECT_TRUE(mutually_exclusive) << max_threads << " threads";
+  }
+}
+
+TEST_F(BddIOAnalysisPassTest, NonMutuallyExclusiveIndependentGroups) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * sel_a,
+      package.CreateStreamingChannel("sel_a", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * sel_b,
+      package.CreateStreamingChannel("sel_b", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+
+  BValue in_val = pb.Receive(in);
+  BValue sel_a_val = pb.Receive(sel_a);
+  BValue sel_b_val = pb.Receive(sel_b);
+
+  pb.SendIf(out0, pb.Eq(sel_a_val, pb.Literal(UBits(0, 32))), in_val);
+  pb.SendIf(out1, pb.Eq(sel_b_val, pb.Literal(UBits(1, 32))), in_val);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool mutually_exclusive,
+      AreStreamingOutputsMutuallyExclusive(
+          proc, BddIoAnalysisOptions{.max_threads = 2}));
+  EXPECT_FALSE(mutually_exclusive);
+}
+
+TEST_F(BddIOAnalysisPassTest, ExhaustedTimeBudgetIsConservative) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * sel,
+      package.CreateStreamingChannel("sel", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+
+  BValue in_val = pb.Receive(in);
+  BValue sel_val = pb.Receive(sel);
+
+  pb.SendIf(out0, pb.Eq(sel_val, pb.Literal(UBits(0, 32))), in_val);
+  pb.SendIf(out1, pb.Eq(sel_val, pb.Literal(UBits(1, 32))), in_val);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(bool mutually_exclusive,
+                           AreStreamingOutputsMutuallyExclusive(proc));
+  EXPECT_TRUE(mutually_exclusive);
+
+  // Without time to evaluate the predicates, they cannot be proven exclusive.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      mutually_exclusive,
+      AreStreamingOutputsMutuallyExclusive(
+          proc, BddIoAnalysisOptions{.time_budget = absl::ZeroDuration()}));
+  EXPECT_FALSE(mutually_exclusive);
+}
+
 }  // namespace
 }  // namespace xls
@@ -855,8 +855,11 @@ absl::StatusOr<CodegenPassUnit> ProcToCombinationalBlock(
 
   if (number_of_outputs > 1) {
     // TODO: do this analysis on a per-stage basis
-    XLS_ASSIGN_OR_RETURN(bool streaming_outputs_mutually_exclusive,
-                         AreStreamingOutputsMutuallyExclusive(proc));
+    BddIoAnalysisOptions io_analysis_options;
+    io_analysis_options.time_budget = options.io_analysis_time_budget();
+    XLS_ASSIGN_OR_RETURN(
+        bool streaming_outputs_mutually_exclusive,
+        AreStreamingOutputsMutuallyExclusive(proc, io_analysis_options));
 
     if (streaming_outputs_mutually_exclusive) {
       VLOG(3) << absl::StrFormat(
@@ -16,9 +16,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <deque>
+#include <filesystem>  // NOLINT
 #include <initializer_list>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -27,6 +30,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -35,6 +39,8 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
 #include "absl/types/span.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/codegen_options.h"
@@ -47,9 +53,11 @@
 #include "xls/codegen/vast/vast.h"
 #include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/common/casts.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/format_preference.h"
@@ -57,11 +65,13 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
 #include "xls/ir/register.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "re2/re2.h"
 
 namespace xls {
 namespace verilog {
@@ -70,6 +80,32 @@ namespace {
 // Returns true if the given type is representable in the Verilog.
 bool IsRepresentable(Type* type) { return type->GetFlatBitCount() > 0; }
 
+// Identifies a clock gate by its load enable and whether the clock also runs
+// during reset.
+using ClockGateKey = std::pair<Node*, bool>;
+
+// Substitutes the placeholders of the clock gate format string.
+absl::StatusOr<std::string> FormatClockGate(
+    std::string_view format,
+    const absl::flat_hash_map<std::string, std::string>& placeholders) {
+  RE2 re(R"({(\w+)})");
+  std::string placeholder;
+  std::string_view piece(format);
+  while (RE2::FindAndConsume(&piece, re, &placeholder)) {
+    if (!placeholders.contains(placeholder)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid placeholder {%s} in clock gate format string. Valid "
+          "placeholders: {clock}, {enable}, {gated_clock}",
+          placeholder));
+    }
+  }
+  std::string result(format);
+  for (const auto& [name, value] : placeholders) {
+    absl::StrReplaceAll({{absl::StrCat("{", name, "}"), value}}, &result);
+  }
+  return result;
+}
+
 // Return the Verilog representation for the given node which has at least one
 // operand which is not represented by an Expression*.
 absl::StatusOr<NodeRepresentation> CodegenNodeWithUnrepresentedOperands(
@@ -363,6 +399,7 @@ class BlockGenerator {
 
   // Generates and returns the Verilog text for the underlying block.
   absl::Status Emit() {
+    GroupClockGatedRegisters();
     XLS_RETURN_IF_ERROR(EmitInputPorts());
     // TODO(meheff): 2021/11/04 Emit instantiations in pipeline stages if
     // possible.
@@ -717,29 +754,111 @@ class BlockGenerator {
     return absl::OkStatus();
   }
 
+  // Determines which registers are clocked by a gated clock. Registers with
+  // the same load enable share a clock gate if their total width is at least
+  // the clock gating threshold. Registers with a synchronous reset need the
+  // clock to run during reset, so they use a separate clock gate.
+  void GroupClockGatedRegisters() {
+    if (options_.clock_gate_format().empty()) {
+      return;
+    }
+    absl::flat_hash_map<ClockGateKey, int64_t> widths;
+    for (Node* node : block_->nodes()) {
+      if (!node->Is<RegisterWrite>() ||
+          !node->As<RegisterWrite>()->load_enable().has_value()) {
+        continue;
+      }
+      RegisterWrite* reg_write = node->As<RegisterWrite>();
+      Register* reg = reg_write->GetRegister();
+      bool clock_during_reset = reg->reset().has_value() &&
+                                mb_.reset().has_value() &&
+                                !mb_.reset()->asynchronous;
+      ClockGateKey key{*reg_write->load_enable(), clock_during_reset};
+      clock_gate_keys_[reg] = key;
+      widths[key] += reg->type()->GetFlatBitCount();
+    }
+    absl::erase_if(clock_gate_keys_, [&](const auto& entry) {
+      return widths.at(entry.second) < options_.clock_gating_min_width();
+    });
+  }
+
+  // Returns the clock gated by the given key, emitting its clock gate cell if
+  // it does not exist yet. The enable expression must already be emitted.
+  absl::StatusOr<LogicRef*> GetGatedClock(const ClockGateKey& key) {
+    if (auto it = gated_clocks_.find(key); it != gated_clocks_.end()) {
+      return it->second;
+    }
+    auto [enable, clock_during_reset] = key;
+    const NodeRepresentation& enable_repr = node_exprs_.at(enable);
+    XLS_RET_CHECK(std::holds_alternative<Expression*>(enable_repr));
+    Expression* enable_expr = std::get<Expression*>(enable_repr);
+    if (clock_during_reset) {
+      const verilog::Reset& reset = *mb_.reset();
+      Expression* reset_expr =
+          reset.active_low ? file_->LogicalNot(reset.signal, SourceInfo())
+                           : reset.signal;
+      enable_expr = file_->LogicalOr(enable_expr, reset_expr, SourceInfo());
+    }
+    LogicRef* gated_clock = mb_.DeclareVariable(
+        absl::StrCat(enable->GetName(),
+                     clock_during_reset ? "_rst_gated_clk" : "_gated_clk"),
+        /*bit_count=*/1);
+    XLS_ASSIGN_OR_RETURN(
+        std::string cell,
+        FormatClockGate(options_.clock_gate_format(),
+                        {{"clock", mb_.clock()->GetName()},
+                         {"enable", enable_expr->Emit(nullptr)},
+                         {"gated_clock", gated_clock->GetName()}}));
+    mb_.assignment_section()->Add<InlineVerilogStatement>(SourceInfo(),
+                                                          cell + ";");
+    gated_clocks_[key] = gated_clock;
+    return gated_clock;
+  }
+
   // Adds an always_ff (or Verilog equivalent) and use it to assign the next
   // cycle value for each of the given registers. Registers must have been
   // declared previously with DeclareRegisters.
   absl::Status AssignRegisters(absl::Span<Register* const> registers) {
-    // Group registers with/without reset signal and call
-    // ModuleBuilder::AssignRegisters for each.
-    std::vector<ModuleBuilder::Register> registers_with_reset;
-    std::vector<ModuleBuilder::Register> registers_without_reset;
+    // Group registers by clock and with/without reset signal and call
+    // ModuleBuilder::AssignRegisters for each. A null clock is the module
+    // clock.
+    struct RegisterGroup {
+      LogicRef* clock;
+      std::vector<ModuleBuilder::Register> registers_with_reset;
+      std::vector<ModuleBuilder::Register> registers_without_reset;
+    };
+    std::vector<RegisterGroup> groups = {RegisterGroup{.clock = nullptr}};
+    absl::flat_hash_map<LogicRef*, int64_t> group_indices = {{nullptr, 0}};
     for (Register* reg : registers) {
       XLS_RET_CHECK(mb_registers_.contains(reg)) << absl::StreamFormat(
           "Register `%s` was not previously declared", reg->name());
       ModuleBuilder::Register mb_reg = mb_registers_.at(reg);
+      LogicRef* clock = nullptr;
+      if (auto it = clock_gate_keys_.find(reg); it != clock_gate_keys_.end()) {
+        XLS_ASSIGN_OR_RETURN(clock, GetGatedClock(it->second));
+        // The gated clock only runs when the register is enabled.
+        mb_reg.load_enable = nullptr;
+      }
+      auto [it, inserted] = group_indices.try_emplace(clock, groups.size());
+      if (inserted) {
+        groups.push_back(RegisterGroup{.clock = clock});
+      }
+      RegisterGroup& group = groups[it->second];
       if (reg->reset().has_value()) {
-        registers_with_reset.push_back(mb_reg);
+        group.registers_with_reset.push_back(mb_reg);
       } else {
-        registers_without_reset.push_back(mb_reg);
+        group.registers_without_reset.push_back(mb_reg);
       }
     }
-    if (!registers_without_reset.empty()) {
-      XLS_RETURN_IF_ERROR(mb_.AssignRegisters(registers_without_reset));
-    }
-    if (!registers_with_reset.empty()) {
-      XLS_RETURN_IF_ERROR(mb_.AssignRegisters(registers_with_reset));
+    for (const RegisterGroup& group : groups) {
+      if (!group.registers_without_reset.empty()) {
+        XLS_RETURN_IF_ERROR(
+            mb_.AssignRegisters(group.registers_without_reset, group.clock));
+      }
+      if (!group.registers_with_reset.empty()) {
+        XLS_RETURN_IF_ERROR(
+            mb_.AssignRegisters(group.registers_with_reset, group.clock));
+      }
     }
     return absl::OkStatus();
   }
@@ -951,6 +1070,11 @@ class BlockGenerator {
   // Map from xls::Register* to the ModuleBuilder register abstraction
   // representing the underlying Verilog register.
   absl::flat_hash_map<xls::Register*, ModuleBuilder::Register> mb_registers_;
+
+  // The load enable and whether the clock runs during reset of each register
+  // clocked by a gated clock, and the gated clocks emitted so far.
+  absl::flat_hash_map<xls::Register*, ClockGateKey> clock_gate_keys_;
+  absl::flat_hash_map<ClockGateKey, LogicRef*> gated_clocks_;
 };
 
 // Recursive visitor of blocks in a DFS order. Edges are block instantiations.
@@ -995,6 +1119,233 @@ absl::StatusOr<std::vector<Block*>> GatherInstantiatedBlocks(Block* top) {
   return blocks;
 }
 
+// Adds to `verilog_line_map` the mappings from the source locations of the
+// VAST nodes recorded in `line_info` to their Verilog lines, offset by
+// `line_offset`.
+absl::Status AddLineMappings(const LineInfo& line_info, int64_t line_offset,
+                             Package* package,
+                             VerilogLineMap* verilog_line_map) {
+  for (const VastNode* vast_node : line_info.nodes()) {
+    std::optional<std::vector<LineSpan>> spans =
+        line_info.LookupNode(vast_node);
+    if (!spans.has_value()) {
+      return absl::InternalError("Unbalanced calls to LineInfo::{Start, End}");
+    }
+    for (const LineSpan& span : spans.value()) {
+      SourceInfo info = vast_node->loc();
+      for (const SourceLocation& loc : info.locations) {
+        int64_t line = static_cast<int32_t>(loc.lineno());
+        VerilogLineMapping* mapping = verilog_line_map->add_mapping();
+        mapping->set_source_file(
+            package->GetFilename(loc.fileno()).value_or(""));
+        mapping->mutable_source_span()->set_line_start(line);
+        mapping->mutable_source_span()->set_line_end(line);
+        mapping->set_verilog_file("");  // to be updated later on
+        mapping->mutable_verilog_span()->set_line_start(span.StartLine() +
+                                                        line_offset);
+        mapping->mutable_verilog_span()->set_line_end(span.EndLine() +
+                                                      line_offset);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Returns the 64-bit FNV-1a hash of `data`. Unlike absl::Hash, it is the same
+// in every run, so it can be used to name files.
+uint64_t StableHash(std::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+// Returns the path, without extension, of the module cache entry of `block`.
+// The key covers everything the generated module depends on: the options, the
+// IR of the block, the interfaces of the blocks it instantiates, the requested
+// SystemVerilog port types and the names of the source files of the block's
+// nodes, which appear in the line map.
+std::filesystem::path ModuleCachePath(
+    Block* block, const CodegenOptions& options,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types) {
+  std::string key =
+      absl::StrCat(options.module_cache_options_key(), "\n", block->DumpIr());
+  for (xls::Instantiation* instantiation : block->GetInstantiations()) {
+    if (instantiation->kind() == InstantiationKind::kBlock) {
+      absl::StrAppend(&key, "\n", down_cast<BlockInstantiation*>(instantiation)
+                                      ->instantiated_block()
+                                      ->DumpIr());
+    }
+  }
+  for (InputPort* port : block->GetInputPorts()) {
+    if (auto it = input_port_sv_types.find(port);
+        it != input_port_sv_types.end()) {
+      absl::StrAppend(&key, "\nsv_type ", port->GetName(), " ", it->second);
+    }
+  }
+  for (OutputPort* port : block->GetOutputPorts()) {
+    if (auto it = output_port_sv_types.find(port);
+        it != output_port_sv_types.end()) {
+      absl::StrAppend(&key, "\nsv_type ", port->GetName(), " ", it->second);
+    }
+  }
+  absl::btree_set<std::string> filenames;
+  for (Node* node : block->nodes()) {
+    for (const SourceLocation& loc : node->loc().locations) {
+      filenames.insert(
+          block->package()->GetFilename(loc.fileno()).value_or(""));
+    }
+  }
+  absl::StrAppend(&key, "\nfiles ", absl::StrJoin(filenames, " "));
+  return std::filesystem::path(options.module_cache_dir()) /
+         absl::StrFormat("%s.%016x", SanitizeIdentifier(block->name()),
+                         StableHash(key));
+}
+
+// The Verilog of a single block, generated into its own file so blocks can be
+// generated concurrently and cached, with the line map relative to the start
+// of the block's text.
+struct GeneratedBlock {
+  std::string text;
+  VerilogLineMap line_map;
+  // The module cache entry of the block, if the cache is enabled.
+  std::filesystem::path cache_path;
+  bool from_cache = false;
+};
+
+// Returns the module cached at `cache_path`, if any.
+std::optional<GeneratedBlock> ReadCachedBlock(
+    const std::filesystem::path& cache_path) {
+  std::filesystem::path text_path = absl::StrCat(cache_path.string(), ".v");
+  std::filesystem::path line_map_path =
+      absl::StrCat(cache_path.string(), ".line_map.textproto");
+  // The text is written last, so its presence means the entry is complete.
+  if (!FileExists(text_path).ok()) {
+    return std::nullopt;
+  }
+  GeneratedBlock generated{.cache_path = cache_path, .from_cache = true};
+  absl::StatusOr<std::string> text = GetFileContents(text_path);
+  absl::Status line_map_status =
+      ParseTextProtoFile(line_map_path, &generated.line_map);
+  if (!text.ok() || !line_map_status.ok()) {
+    LOG(WARNING) << "Ignoring module cache entry " << cache_path << ": "
+                 << (text.ok() ? line_map_status : text.status());
+    return std::nullopt;
+  }
+  generated.text = *std::move(text);
+  return generated;
+}
+
+absl::Status WriteCachedBlock(const GeneratedBlock& generated) {
+  XLS_RETURN_IF_ERROR(SetTextProtoFile(
+      absl::StrCat(generated.cache_path.string(), ".line_map.textproto"),
+      generated.line_map));
+  return SetFileContents(absl::StrCat(generated.cache_path.string(), ".v"),
+                         generated.text);
+}
+
+absl::StatusOr<GeneratedBlock> GenerateBlock(
+    Block* block, const CodegenOptions& options,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types) {
+  GeneratedBlock generated;
+  if (!options.module_cache_dir().empty()) {
+    generated.cache_path = ModuleCachePath(block, options, input_port_sv_types,
+                                           output_port_sv_types);
+    if (std::optional<GeneratedBlock> cached =
+            ReadCachedBlock(generated.cache_path)) {
+      VLOG(2) << "Using cached Verilog of block " << block->name();
+      return *std::move(cached);
+    }
+  }
+  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
+                                                : FileType::kVerilog);
+  XLS_RETURN_IF_ERROR(BlockGenerator::Generate(
+      block, &file, options, input_port_sv_types, output_port_sv_types));
+  LineInfo line_info;
+  generated.text = file.Emit(&line_info);
+  XLS_RETURN_IF_ERROR(AddLineMappings(line_info, /*line_offset=*/0,
+                                      block->package(), &generated.line_map));
+  return generated;
+}
+
+// Generates the Verilog of each of `blocks` separately, on up to
+// `thread_count` threads and through the module cache if it is enabled, and
+// returns the concatenated text in the order of `blocks`. The result is
+// identical to generating all of the blocks into a single file.
+absl::StatusOr<std::string> GenerateBlocksSeparately(
+    absl::Span<Block* const> blocks, int64_t thread_count,
+    const CodegenOptions& options, VerilogLineMap* verilog_line_map,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types) {
+  // Generation only reads the IR, and each block gets its own VerilogFile, so
+  // no state is shared between the workers.
+  std::vector<absl::StatusOr<GeneratedBlock>> generated(
+      blocks.size(), absl::UnknownError("not generated"));
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < blocks.size();
+         i = next_index.fetch_add(1)) {
+      generated[i] = GenerateBlock(blocks[i], options, input_port_sv_types,
+                                   output_port_sv_types);
+    }
+  };
+  if (thread_count <= 1) {
+    worker();
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (auto& t : threads) {
+      t->Join();
+    }
+  }
+
+  std::string text;
+  int64_t line_offset = 0;
+  int64_t cached_count = 0;
+  for (int64_t i = 0; i < blocks.size(); ++i) {
+    XLS_RETURN_IF_ERROR(generated[i].status());
+    GeneratedBlock& block = *generated[i];
+    if (block.from_cache) {
+      ++cached_count;
+    } else if (!block.cache_path.empty()) {
+      if (absl::Status status = WriteCachedBlock(block); !status.ok()) {
+        LOG(WARNING) << "Unable to cache the Verilog of block "
+                     << blocks[i]->name() << ": " << status;
+      }
+    }
+    if (verilog_line_map != nullptr) {
+      for (const VerilogLineMapping& mapping : block.line_map.mapping()) {
+        VerilogLineMapping* shifted = verilog_line_map->add_mapping();
+        *shifted = mapping;
+        shifted->mutable_verilog_span()->set_line_start(
+            mapping.verilog_span().line_start() + line_offset);
+        shifted->mutable_verilog_span()->set_line_end(
+            mapping.verilog_span().line_end() + line_offset);
+      }
+    }
+    // Blocks are separated by two blank lines.
+    if (i + 1 < blocks.size()) {
+      absl::StrAppend(&block.text, "\n\n");
+    }
+    line_offset += absl::c_count(block.text, '\n');
+    absl::StrAppend(&text, block.text);
+    // Release the block's copy of its text as soon as it is in the result.
+    block = GeneratedBlock();
+  }
+  if (!options.module_cache_dir().empty()) {
+    VLOG(1) << absl::StreamFormat("Reused %d of %d cached Verilog modules",
+                                  cached_count, blocks.size());
+  }
+  return text;
+}
+
 }  // namespace
 
 absl::StatusOr<std::string> GenerateVerilog(
@@ -1008,6 +1359,25 @@ absl::StatusOr<std::string> GenerateVerilog(
 
   XLS_ASSIGN_OR_RETURN(std::vector<Block*> blocks,
                        GatherInstantiatedBlocks(top));
+  int64_t thread_count = std::min<int64_t>(
+      options.block_generation_threads() == 0
+          ? AvailableCPUs()
+          : options.block_generation_threads(),
+      blocks.size());
+  // Generating the blocks separately keeps only one block's VAST alive at a
+  // time when there is a single thread.
+  if (thread_count > 1 || !options.module_cache_dir().empty() ||
+      options.low_memory()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::string text,
+        GenerateBlocksSeparately(blocks, thread_count, options,
+                                 verilog_line_map, input_port_sv_types,
+                                 output_port_sv_types));
+    VLOG(2) << "Verilog output:";
+    XLS_VLOG_LINES(2, text);
+    return text;
+  }
+
   VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
                                                 : FileType::kVerilog);
   for (Block* block : blocks) {
@@ -1022,28 +1392,8 @@ absl::StatusOr<std::string> GenerateVerilog(
   LineInfo line_info;
   std::string text = file.Emit(&line_info);
   if (verilog_line_map != nullptr) {
-    for (const VastNode* vast_node : line_info.nodes()) {
-      std::optional<std::vector<LineSpan>> spans =
-          line_info.LookupNode(vast_node);
-      if (!spans.has_value()) {
-        return absl::InternalError(
-            "Unbalanced calls to LineInfo::{Start, End}");
-      }
-      for (const LineSpan& span : spans.value()) {
-        SourceInfo info = vast_node->loc();
-        for (const SourceLocation& loc : info.locations) {
-          int64_t line = static_cast<int32_t>(loc.lineno());
-          VerilogLineMapping* mapping = verilog_line_map->add_mapping();
-          mapping->set_source_file(
-              top->package()->GetFilename(loc.fileno()).value_or(""));
-          mapping->mutable_source_span()->set_line_start(line);
-          mapping->mutable_source_span()->set_line_end(line);
-          mapping->set_verilog_file("");  // to be updated later on
-          mapping->mutable_verilog_span()->set_line_start(span.StartLine());
-          mapping->mutable_verilog_span()->set_line_end(span.EndLine());
-        }
-      }
-    }
+    XLS_RETURN_IF_ERROR(AddLineMappings(line_info, /*line_offset=*/0,
+                                        top->package(), verilog_line_map));
   }
 
   VLOG(2) << "Verilog output:";
@@ -32,6 +32,7 @@
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -43,6 +44,9 @@
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/op_override_impls.h"
 #include "xls/codegen/signature_generator.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/ret_check.h"
@@ -84,6 +88,7 @@ namespace xls {
 namespace verilog {
 namespace {
 
+using ::absl_testing::IsOkAndHolds;
 using ::absl_testing::StatusIs;
 using ::testing::HasSubstr;
 
@@ -901,6 +906,67 @@ TEST_P(BlockGeneratorTest, LoadEnables) {
   XLS_ASSERT_OK(tb->Run());
 }
 
+TEST_P(BlockGeneratorTest, ClockGating) {
+  // Registers "a" and "b" share a load enable and are wide enough to be clock
+  // gated. "a" has a synchronous reset, so it needs its own clock gate which
+  // runs during reset. The one-bit register "c" keeps its load enable.
+  Package package(TestBaseName());
+
+  Type* u1 = package.GetBitsType(1);
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb(TestBaseName(), &package);
+  BValue a = bb.InputPort("a", u32);
+  BValue b = bb.InputPort("b", u32);
+  BValue c = bb.InputPort("c", u1);
+  BValue le = bb.InputPort("le", u1);
+  BValue c_le = bb.InputPort("c_le", u1);
+  BValue rst = bb.InputPort("rst", u1);
+
+  BValue a_reg =
+      bb.InsertRegister("a_reg", a, rst,
+                        xls::Reset{.reset_value = Value(UBits(42, 32)),
+                                   .asynchronous = false,
+                                   .active_low = false},
+                        le);
+  BValue b_reg = bb.InsertRegister("b_reg", b, le);
+  BValue c_reg = bb.InsertRegister("c_reg", c, c_le);
+
+  bb.OutputPort("a_out", a_reg);
+  bb.OutputPort("b_out", b_reg);
+  bb.OutputPort("c_out", c_reg);
+
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  CodegenOptions options = codegen_options();
+  options.clock_gate_format(
+      "my_icg {gated_clock}_icg (.CK({clock}), .EN({enable}), "
+      ".GCK({gated_clock}))");
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateVerilog(block, options));
+  EXPECT_THAT(verilog, HasSubstr("my_icg le_gated_clk_icg (.CK(clk), .EN(le), "
+                                 ".GCK(le_gated_clk));"));
+  EXPECT_THAT(verilog,
+              HasSubstr("my_icg le_rst_gated_clk_icg (.CK(clk), "
+                        ".EN(le || rst), .GCK(le_rst_gated_clk));"));
+  EXPECT_THAT(verilog, HasSubstr("(posedge le_gated_clk)"));
+  EXPECT_THAT(verilog, HasSubstr("(posedge le_rst_gated_clk)"));
+  EXPECT_THAT(verilog, HasSubstr("(posedge clk)"));
+  EXPECT_THAT(verilog, HasSubstr("c_le ?"));
+  EXPECT_THAT(verilog, Not(HasSubstr("le ? b")));
+
+  // Below the width threshold no register is clock gated.
+  options.clock_gating_min_width(64);
+  XLS_ASSERT_OK_AND_ASSIGN(verilog, GenerateVerilog(block, options));
+  EXPECT_THAT(verilog, Not(HasSubstr("my_icg")));
+
+  options.clock_gating_min_width(1);
+  options.clock_gate_format("my_icg (.CK({clk}))");
+  EXPECT_THAT(GenerateVerilog(block, options),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid placeholder {clk}")));
+}
+
 TEST_P(BlockGeneratorTest, GatedBitsType) {
   Package package(TestBaseName());
   BlockBuilder b(TestBaseName(), &package);
@@ -1511,6 +1577,85 @@ TEST_P(BlockGeneratorTest, DiamondDependencyInstantiations) {
   XLS_ASSERT_OK(tb->Run());
 }
 
+TEST_P(BlockGeneratorTest, ConcurrentBlockGenerationMatchesSequential) {
+  Package package(TestBaseName());
+  Type* u32 = package.GetBitsType(32);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub_block,
+                           MakeSubtractBlock("subtractor", &package));
+  BlockBuilder bb("my_block", &package);
+  BValue j = bb.InputPort("j", u32);
+  BValue k = bb.InputPort("k", u32);
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Block * delegator,
+        MakeDelegatingBlock(absl::StrCat("delegator", i), sub_block, &package));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        xls::Instantiation * instantiation,
+        bb.block()->AddBlockInstantiation(absl::StrCat("deleg", i), delegator));
+    bb.InstantiationInput(instantiation, "x", j);
+    bb.InstantiationInput(instantiation, "y", k);
+    bb.OutputPort(absl::StrCat("out", i),
+                  bb.InstantiationOutput(instantiation, "z"));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  VerilogLineMap sequential_line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string sequential,
+      GenerateVerilog(block, codegen_options(), &sequential_line_map));
+  for (int64_t threads : {0, 2, 16}) {
+    VerilogLineMap line_map;
+    CodegenOptions options = codegen_options();
+    options.block_generation_threads(threads);
+    XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                             GenerateVerilog(block, options, &line_map));
+    EXPECT_EQ(verilog, sequential) << threads << " threads";
+    EXPECT_EQ(line_map.DebugString(), sequential_line_map.DebugString());
+  }
+}
+
+TEST_P(BlockGeneratorTest, ModuleCacheReusesUnchangedBlocks) {
+  Package package(TestBaseName());
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub_block,
+                           MakeSubtractBlock("subtractor", &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block, MakeDelegatingBlock("delegator", sub_block, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string expected,
+                           GenerateVerilog(block, codegen_options()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory cache_dir, TempDirectory::Create());
+  CodegenOptions options = codegen_options();
+  options.module_cache(cache_dir.path().string(), "key");
+  VerilogLineMap line_map;
+  EXPECT_THAT(GenerateVerilog(block, options, &line_map),
+              IsOkAndHolds(expected));
+
+  // Each block has a cached module; replace the subtractor's to observe that
+  // it is reused.
+  std::vector<std::filesystem::path> cached_modules;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(cache_dir.path())) {
+    if (entry.path().extension() == ".v") {
+      cached_modules.push_back(entry.path());
+    }
+  }
+  ASSERT_EQ(cached_modules.size(), 2);
+  for (const std::filesystem::path& path : cached_modules) {
+    if (absl::StartsWith(path.filename().string(), "subtractor.")) {
+      XLS_ASSERT_OK(SetFileContents(path, "// cached subtractor\n"));
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateVerilog(block, options));
+  EXPECT_THAT(verilog, HasSubstr("// cached subtractor"));
+  EXPECT_THAT(verilog, HasSubstr("module delegator"));
+
+  // Different options do not reuse the entries.
+  options.module_cache(cache_dir.path().string(), "other key");
+  EXPECT_THAT(GenerateVerilog(block, options), IsOkAndHolds(expected));
+}
+
 TEST_P(BlockGeneratorTest, LoopbackFifoInstantiation) {
   constexpr std::string_view ir_text = R"(package test
 
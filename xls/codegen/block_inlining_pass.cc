@@ -14,6 +14,7 @@
 
 #include "xls/codegen/block_inlining_pass.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -43,7 +44,11 @@ namespace {
 
 class InlineVisitor : public ElaboratedBlockDfsVisitorWithDefault {
  public:
-  explicit InlineVisitor(Block* out) : new_block_(out) {}
+  // `node_count` is the number of elaborated nodes, used to size the node
+  // map up front.
+  InlineVisitor(Block* out, int64_t node_count) : new_block_(out) {
+    old_to_new_.reserve(node_count);
+  }
 
   const absl::flat_hash_map<std::pair<Register*, BlockInstance*>, Register*>&
   reg_map() const {
@@ -281,7 +286,16 @@ absl::StatusOr<Block*> InlineElaboration(
     XLS_RETURN_IF_ERROR(elab.package()->SetTop(stitched));
   }
 
-  InlineVisitor vis(stitched);
+  // Every instance is cloned straight into `stitched` in a single traversal of
+  // the elaboration, so no intermediate partially-inlined blocks are built
+  // however deep the hierarchy is.
+  int64_t node_count = 0;
+  for (BlockInstance* instance : elab.instances()) {
+    if (instance->block().has_value()) {
+      node_count += (*instance->block())->node_count();
+    }
+  }
+  InlineVisitor vis(stitched, node_count);
   XLS_RETURN_IF_ERROR(elab.Accept(vis));
 
   // Record new register names.
@@ -21,6 +21,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
 #include "absl/status/status_matchers.h"
 #include "absl/strings/str_format.h"
 #include "xls/codegen/codegen_pass.h"
@@ -34,6 +35,8 @@
 #include "xls/ir/instantiation.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
 #include "xls/ir/value.h"
 
 namespace m = xls::op_matchers;
@@ -335,5 +338,53 @@ TEST_F(BlockInliningPassTest, InlineBlocksWithExtern) {
                              testing::Contains(m::InstantiationOutput(
                                  "return", right_foobar_inst))));
 }
+
+TEST_F(BlockInliningPassTest, InlineDeepHierarchy) {
+  auto p = CreatePackage();
+
+  // Each level wraps two instances of the level below and adds their results,
+  // so the top computes 2**kDepth * (x + 1).
+  constexpr int64_t kDepth = 8;
+  BlockBuilder bb_leaf("level0", p.get());
+  bb_leaf.OutputPort("res",
+                     bb_leaf.Add(bb_leaf.InputPort("x", p->GetBitsType(32)),
+                                 bb_leaf.Literal(UBits(1, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * level, bb_leaf.Build());
+  for (int64_t i = 1; i <= kDepth; ++i) {
+    BlockBuilder bb(i == kDepth ? TestName() : absl::StrFormat("level%d", i),
+                    p.get());
+    BValue x = bb.InputPort("x", p->GetBitsType(32));
+    XLS_ASSERT_OK_AND_ASSIGN(Instantiation * left,
+                             bb.block()->AddBlockInstantiation("left", level));
+    XLS_ASSERT_OK_AND_ASSIGN(Instantiation * right,
+                             bb.block()->AddBlockInstantiation("right", level));
+    bb.InstantiationInput(left, "x", x);
+    bb.InstantiationInput(right, "x", x);
+    bb.OutputPort("res", bb.Add(bb.InstantiationOutput(left, "res"),
+                                bb.InstantiationOutput(right, "res")));
+    XLS_ASSERT_OK_AND_ASSIGN(level, bb.Build());
+  }
+  Block* top = level;
+
+  BlockInliningPass bip;
+  CodegenPassUnit pu(p.get(), top);
+  CodegenPassResults results;
+  CodegenPassOptions opt;
+  ASSERT_THAT(bip.Run(&pu, opt, &results), absl_testing::IsOkAndHolds(true));
+
+  Block* inlined = pu.top_block;
+  EXPECT_THAT(inlined->GetInstantiations(), IsEmpty());
+  // 2**kDepth leaf adds and 2**kDepth - 1 adds combining them.
+  EXPECT_EQ(absl::c_count_if(inlined->nodes(),
+                             [](Node* n) { return n->op() == Op::kAdd; }),
+            (int64_t{1} << (kDepth + 1)) - 1);
+
+  InterpreterBlockEvaluator eval;
+  XLS_ASSERT_OK_AND_ASSIGN(auto test, eval.NewContinuation(inlined));
+  XLS_ASSERT_OK(test->RunOneCycle({{"x", Value(UBits(5, 32))}}));
+  EXPECT_THAT(test->output_ports(),
+              UnorderedElementsAre(
+                  Pair("res", Value(UBits((int64_t{1} << kDepth) * 6, 32)))));
+}
 }  // namespace
 }  // namespace xls::verilog
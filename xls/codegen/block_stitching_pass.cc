@@ -66,6 +66,7 @@ InstantiateBlocksInContainer(Block* container, const CodegenOptions& options) {
   }
   // Instantiate all blocks in the container block.
   absl::flat_hash_map<Block*, ::xls::Instantiation*> instantiations;
+  instantiations.reserve(blocks_to_instantiate.size());
   for (Block* block : blocks_to_instantiate) {
     std::string inst_name =
         absl::StrCat(block->name(), "_inst", instantiations.size());
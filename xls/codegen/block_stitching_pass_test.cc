@@ -279,6 +279,52 @@ TEST_F(BlockStitchingPassTest, StitchNetworkWithFifos) {
       }));
 }
 
+TEST_F(BlockStitchingPassTest, StitchLongChain) {
+  constexpr int64_t kProcCount = 32;
+  auto p = CreatePackage();
+  Type* u32 = p->GetBitsType(32);
+  std::vector<StreamingChannel*> channels;
+  for (int64_t i = 0; i <= kProcCount; ++i) {
+    ChannelOps ops = ChannelOps::kSendReceive;
+    std::optional<FifoConfig> fifo_config =
+        FifoConfig(/*depth=*/1, /*bypass=*/false,
+                   /*register_push_outputs=*/false,
+                   /*register_pop_outputs=*/false);
+    if (i == 0 || i == kProcCount) {
+      ops = i == 0 ? ChannelOps::kReceiveOnly : ChannelOps::kSendOnly;
+      fifo_config = std::nullopt;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(
+        StreamingChannel * channel,
+        p->CreateStreamingChannel(absl::StrCat("ch", i), ops, u32,
+                                  /*initial_values=*/{}, fifo_config));
+    channels.push_back(channel);
+  }
+  for (int64_t i = 0; i < kProcCount; ++i) {
+    ProcBuilder pb(absl::StrCat(TestName(), i), p.get());
+    BValue rcv = pb.Receive(channels[i], pb.AfterAll({}));
+    pb.Send(channels[i + 1], pb.TupleIndex(rcv, 0), pb.TupleIndex(rcv, 1));
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+    if (i == 0) {
+      XLS_ASSERT_OK(p->SetTop(proc));
+    }
+  }
+
+  EXPECT_THAT(RunBlockStitchingPass(p.get()), IsOkAndHolds(Pair(true, _)));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * top, p->GetBlock("top_proc"));
+  int64_t block_instantiations = 0;
+  int64_t fifo_instantiations = 0;
+  for (xls::Instantiation* instantiation : top->GetInstantiations()) {
+    if (instantiation->kind() == InstantiationKind::kBlock) {
+      ++block_instantiations;
+    } else if (instantiation->kind() == InstantiationKind::kFifo) {
+      ++fifo_instantiations;
+    }
+  }
+  EXPECT_EQ(block_instantiations, kProcCount);
+  EXPECT_EQ(fifo_instantiations, kProcCount - 1);
+}
+
 TEST_F(BlockStitchingPassTest, StitchNetworkWithDirectConnections) {
   auto p = CreatePackage();
   Type* u32 = p->GetBitsType(32);
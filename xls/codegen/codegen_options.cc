@@ -73,7 +73,15 @@ CodegenOptions::CodegenOptions(const CodegenOptions& options)
       emit_sv_types_(options.emit_sv_types_),
       simulation_macro_name_(options.simulation_macro_name_),
       codegen_version_(options.codegen_version_),
-      materialize_internal_fifos_(options.materialize_internal_fifos_) {
+      materialize_internal_fifos_(options.materialize_internal_fifos_),
+      block_generation_threads_(options.block_generation_threads_),
+      module_cache_dir_(options.module_cache_dir_),
+      module_cache_options_key_(options.module_cache_options_key_),
+      retime_registers_(options.retime_registers_),
+      low_memory_(options.low_memory_),
+      io_analysis_time_budget_(options.io_analysis_time_budget_),
+      clock_gate_format_(options.clock_gate_format_),
+      clock_gating_min_width_(options.clock_gating_min_width_) {
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
   }
@@ -112,6 +120,14 @@ CodegenOptions& CodegenOptions::operator=(const CodegenOptions& options) {
   simulation_macro_name_ = options.simulation_macro_name_;
   codegen_version_ = options.codegen_version_;
   materialize_internal_fifos_ = options.materialize_internal_fifos_;
+  block_generation_threads_ = options.block_generation_threads_;
+  module_cache_dir_ = options.module_cache_dir_;
+  module_cache_options_key_ = options.module_cache_options_key_;
+  retime_registers_ = options.retime_registers_;
+  low_memory_ = options.low_memory_;
+  io_analysis_time_budget_ = options.io_analysis_time_budget_;
+  clock_gate_format_ = options.clock_gate_format_;
+  clock_gating_min_width_ = options.clock_gating_min_width_;
 
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
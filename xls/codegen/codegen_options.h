@@ -25,6 +25,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/codegen/op_override.h"
@@ -333,6 +334,82 @@ class CodegenOptions {
     return materialize_internal_fifos_;
   }
 
+  // The number of threads used to generate the Verilog of the blocks of a
+  // multi-block design concurrently. Zero uses all available CPUs; one (the
+  // default) generates the blocks one at a time. The output is the same
+  // regardless.
+  CodegenOptions& block_generation_threads(int64_t value) {
+    CHECK_GE(value, 0);
+    block_generation_threads_ = value;
+    return *this;
+  }
+  int64_t block_generation_threads() const { return block_generation_threads_; }
+
+  // Enables a cache of generated Verilog modules in the directory `dir`. The
+  // module of a block whose IR, instantiated blocks and options are unchanged
+  // since an earlier run is reused rather than regenerated. `options_key` is
+  // part of the key of every entry and must differ between any two sets of
+  // options which generate different Verilog, e.g. a serialization of them.
+  CodegenOptions& module_cache(std::string dir, std::string options_key) {
+    module_cache_dir_ = std::move(dir);
+    module_cache_options_key_ = std::move(options_key);
+    return *this;
+  }
+  const std::string& module_cache_dir() const { return module_cache_dir_; }
+  const std::string& module_cache_options_key() const {
+    return module_cache_options_key_;
+  }
+
+  // Whether to move pipeline registers across operations which narrow their
+  // operands, where that reduces the number of register bits without
+  // lengthening the critical path beyond the clock period. Requires a delay
+  // estimator.
+  CodegenOptions& retime_registers(bool value) {
+    retime_registers_ = value;
+    return *this;
+  }
+  bool retime_registers() const { return retime_registers_; }
+
+  // Whether to lower the peak memory use of codegen. The functions and procs
+  // converted to blocks are removed from the package before the Verilog is
+  // generated, and each block is generated into its own VerilogFile which is
+  // released once its text is emitted. The package top becomes the top block.
+  CodegenOptions& low_memory(bool value) {
+    low_memory_ = value;
+    return *this;
+  }
+  bool low_memory() const { return low_memory_; }
+
+  // The time after which the BDD analysis of the I/O of a proc stops
+  // evaluating nodes and answers conservatively. Unlimited if not set.
+  CodegenOptions& io_analysis_time_budget(
+      std::optional<absl::Duration> value) {
+    io_analysis_time_budget_ = value;
+    return *this;
+  }
+  std::optional<absl::Duration> io_analysis_time_budget() const {
+    return io_analysis_time_budget_;
+  }
+
+  // Format string of the integrated clock gate cell which clocks registers
+  // sharing a load enable instead of the enable multiplexing their next value.
+  // Supported placeholders are {clock}, {enable} and {gated_clock}. The wire
+  // named by {gated_clock} is declared by codegen and must be driven by the
+  // cell. Clock gating is disabled if empty.
+  CodegenOptions& clock_gate_format(std::string_view value) {
+    clock_gate_format_ = value;
+    return *this;
+  }
+  std::string_view clock_gate_format() const { return clock_gate_format_; }
+
+  // The minimum total bit width of the registers sharing a load enable for
+  // them to be clock gated.
+  CodegenOptions& clock_gating_min_width(int64_t value) {
+    clock_gating_min_width_ = value;
+    return *this;
+  }
+  int64_t clock_gating_min_width() const { return clock_gating_min_width_; }
+
  private:
   std::optional<std::string> entry_;
   std::optional<std::string> module_name_;
@@ -368,6 +445,14 @@ class CodegenOptions {
   std::string simulation_macro_name_ = "SIMULATION";
   Version codegen_version_ = Version::kDefault;
   bool materialize_internal_fifos_ = false;
+  int64_t block_generation_threads_ = 1;
+  std::string module_cache_dir_;
+  std::string module_cache_options_key_;
+  bool retime_registers_ = false;
+  bool low_memory_ = false;
+  std::optional<absl::Duration> io_analysis_time_budget_;
+  std::string clock_gate_format_;
+  int64_t clock_gating_min_width_ = 8;
 };
 
 template <typename Sink>
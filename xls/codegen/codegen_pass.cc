@@ -15,6 +15,7 @@
 #include "xls/codegen/codegen_pass.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -24,13 +25,18 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "xls/codegen/module_signature.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node.h"
+#include "xls/ir/package.h"
 
 namespace xls::verilog {
 
@@ -54,6 +60,34 @@ int64_t CodegenPassUnit::GetNodeCount() const {
   return package->GetNodeCount();
 }
 
+absl::Status CodegenPassUnit::ReleaseFunctionBases() {
+  absl::flat_hash_set<FunctionBase*> live;
+  for (const std::unique_ptr<Block>& block : package->blocks()) {
+    for (Instantiation* instantiation : block->GetInstantiations()) {
+      if (instantiation->kind() != InstantiationKind::kExtern) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(ExternInstantiation * extern_instantiation,
+                           instantiation->AsExternInstantiation());
+      for (FunctionBase* f :
+           GetDependentFunctions(extern_instantiation->function())) {
+        live.insert(f);
+      }
+    }
+  }
+
+  // The schedules refer to the nodes of the removed function bases.
+  function_base_to_schedule_.clear();
+  function_base_to_block_.clear();
+  XLS_RETURN_IF_ERROR(package->SetTop(top_block));
+  for (FunctionBase* f : package->GetFunctionBases()) {
+    if (!f->IsBlock() && !live.contains(f)) {
+      XLS_RETURN_IF_ERROR(package->RemoveFunctionBase(f));
+    }
+  }
+  return absl::OkStatus();
+}
+
 void CodegenPassUnit::GcMetadata() {
   absl::flat_hash_set<Node*> nodes;
   for (auto& [this_block, block_metadata] : metadata) {
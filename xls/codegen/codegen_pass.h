@@ -27,6 +27,7 @@
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/concurrent_stage_groups.h"
 #include "xls/codegen/module_signature.h"
@@ -322,6 +323,11 @@ struct CodegenPassUnit {
 
   // Clean up any dangling pointers in codegen metadata.
   void GcMetadata();
+
+  // Removes the functions and procs from the package once they have been
+  // converted to blocks, keeping only those used by extern instantiations.
+  // The top block becomes the package top and the schedules are dropped.
+  absl::Status ReleaseFunctionBases();
 };
 
 struct CodegenPassResults : public PassResults {
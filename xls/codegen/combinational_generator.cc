@@ -15,6 +15,7 @@
 #include "xls/codegen/combinational_generator.h"
 
 #include <string>
+#include <utility>
 
 #include "absl/status/statusor.h"
 #include "xls/codegen/block_conversion.h"
@@ -50,6 +51,9 @@ absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
   XLS_RET_CHECK_NE(unit.top_block, nullptr);
   XLS_RET_CHECK(unit.metadata.contains(unit.top_block));
   XLS_RET_CHECK(unit.metadata.at(unit.top_block).signature.has_value());
+  if (options.low_memory()) {
+    XLS_RETURN_IF_ERROR(unit.ReleaseFunctionBases());
+  }
   VerilogLineMap verilog_line_map;
   XLS_ASSIGN_OR_RETURN(
       std::string verilog,
@@ -58,7 +62,7 @@ absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
   // TODO: google/xls#1323 - add all block signatures to ModuleGeneratorResult,
   // not just top.
   return ModuleGeneratorResult{
-      verilog, verilog_line_map,
+      std::move(verilog), std::move(verilog_line_map),
       unit.metadata.at(unit.top_block).signature.value()};
 }
 
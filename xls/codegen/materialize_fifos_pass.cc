@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -43,9 +44,107 @@
 
 namespace xls::verilog {
 namespace {
-absl::StatusOr<Block*> MaterializeFifo(NameUniquer& uniquer, Package* p,
-                                       FifoInstantiation* inst,
-                                       const xls::Reset& reset_behavior) {
+
+std::string FifoBlockName(NameUniquer& uniquer, FifoInstantiation* inst) {
+  const FifoConfig& config = inst->fifo_config();
+  return uniquer.GetSanitizedUniqueName(absl::StrFormat(
+      "fifo_for_depth_%d_ty_%s_%s%s%s", config.depth(),
+      inst->data_type()->ToString(),
+      config.bypass() ? "with_bypass" : "no_bypass",
+      config.register_pop_outputs() ? "_register_pop" : "",
+      config.register_push_outputs() ? "_register_push" : ""));
+}
+
+// A depth-0 bypass FIFO is a direct connection from the push side to the pop
+// side.
+absl::StatusOr<Block*> MaterializePassthroughFifo(NameUniquer& uniquer,
+                                                  Package* p,
+                                                  FifoInstantiation* inst) {
+  Type* u1 = p->GetBitsType(1);
+  BlockBuilder bb(FifoBlockName(uniquer, inst), p);
+  XLS_RETURN_IF_ERROR(bb.AddClockPort("clk"));
+  bb.ResetPort(FifoInstantiation::kResetPortName);
+  BValue push_valid = bb.InputPort(FifoInstantiation::kPushValidPortName, u1);
+  BValue pop_ready = bb.InputPort(FifoInstantiation::kPopReadyPortName, u1);
+  BValue push_data =
+      bb.InputPort(FifoInstantiation::kPushDataPortName, inst->data_type());
+  bb.OutputPort(FifoInstantiation::kPushReadyPortName, pop_ready);
+  bb.OutputPort(FifoInstantiation::kPopValidPortName, push_valid);
+  bb.OutputPort(FifoInstantiation::kPopDataPortName, push_data);
+  return bb.Build();
+}
+
+// A depth-1 FIFO without registered pop outputs is a single data register and
+// a full flag, with no buffer array or pointers.
+absl::StatusOr<Block*> MaterializeSingleEntryFifo(
+    NameUniquer& uniquer, Package* p, FifoInstantiation* inst,
+    const xls::Reset& reset_behavior) {
+  const FifoConfig& config = inst->fifo_config();
+  const bool bypass = config.bypass();
+  Type* u1 = p->GetBitsType(1);
+  Type* ty = inst->data_type();
+
+  BlockBuilder bb(FifoBlockName(uniquer, inst), p);
+  XLS_RETURN_IF_ERROR(bb.AddClockPort("clk"));
+  BValue reset_port = bb.ResetPort(FifoInstantiation::kResetPortName);
+  BValue push_valid = bb.InputPort(FifoInstantiation::kPushValidPortName, u1);
+  BValue pop_ready = bb.InputPort(FifoInstantiation::kPopReadyPortName, u1);
+  BValue push_data = bb.InputPort(FifoInstantiation::kPushDataPortName, ty);
+
+  XLS_ASSIGN_OR_RETURN(
+      Register * data_reg,
+      bb.block()->AddRegister(
+          "data", ty,
+          xls::Reset{.reset_value = ZeroOfType(ty),
+                     .asynchronous = reset_behavior.asynchronous,
+                     .active_low = reset_behavior.active_low}));
+  XLS_ASSIGN_OR_RETURN(
+      Register * full_reg,
+      bb.block()->AddRegister(
+          "full", u1,
+          xls::Reset{.reset_value = Value::Bool(false),
+                     .asynchronous = reset_behavior.asynchronous,
+                     .active_low = reset_behavior.active_low}));
+  BValue data = bb.RegisterRead(data_reg);
+  BValue full = bb.RegisterRead(full_reg, SourceInfo(), "is_full_bool");
+  BValue not_full = bb.Not(full);
+
+  BValue push_ready = config.register_push_outputs()
+                          ? not_full
+                          : bb.Or(not_full, pop_ready, SourceInfo(),
+                                  "can_do_push");
+  BValue pop_valid = bypass ? bb.Or(full, push_valid) : full;
+  BValue pop_data = bypass ? bb.Select(full, {push_data, data}) : data;
+
+  // A value pushed while empty and popped in the same cycle bypasses the
+  // register.
+  BValue did_push_occur_bool = bb.And(push_valid, push_ready);
+  if (bypass) {
+    BValue bypassed = bb.And({not_full, push_valid, pop_ready});
+    did_push_occur_bool = bb.And(did_push_occur_bool, bb.Not(bypassed));
+  }
+  did_push_occur_bool.SetName("did_push_occur");
+  BValue did_pop_occur_bool =
+      bb.And(full, pop_ready, SourceInfo(), "did_pop_occur");
+  BValue full_next =
+      bb.Or(did_push_occur_bool, bb.And(full, bb.Not(did_pop_occur_bool)));
+
+  bb.OutputPort(FifoInstantiation::kPushReadyPortName, push_ready);
+  bb.OutputPort(FifoInstantiation::kPopValidPortName, pop_valid);
+  bb.OutputPort(FifoInstantiation::kPopDataPortName, pop_data);
+
+  bb.RegisterWrite(data_reg, push_data,
+                   /*load_enable=*/did_push_occur_bool, reset_port);
+  bb.RegisterWrite(full_reg, full_next, /*load_enable=*/std::nullopt,
+                   reset_port);
+  return bb.Build();
+}
+
+// The general implementation: a ring buffer of registers with head and tail
+// pointers.
+absl::StatusOr<Block*> MaterializeRingFifo(NameUniquer& uniquer, Package* p,
+                                           FifoInstantiation* inst,
+                                           const xls::Reset& reset_behavior) {
   const FifoConfig& config = inst->fifo_config();
   const int64_t depth = config.depth();
   const bool bypass = config.bypass();
@@ -59,20 +158,15 @@ absl::StatusOr<Block*> MaterializeFifo(NameUniquer& uniquer, Package* p,
   Type* buf_type = p->GetArrayType(depth + 1, ty);
   Type* ptr_type = p->GetBitsType(Bits::MinBitCountUnsigned(depth + 1));
 
-  BlockBuilder bb(uniquer.GetSanitizedUniqueName(absl::StrFormat(
-                      "fifo_for_depth_%d_ty_%s_%s%s%s", depth, ty->ToString(),
-                      bypass ? "with_bypass" : "no_bypass",
-                      register_pop ? "_register_pop" : "",
-                      register_push ? "_register_push" : "")),
-                  p);
+  BlockBuilder bb(FifoBlockName(uniquer, inst), p);
   XLS_RETURN_IF_ERROR(bb.AddClockPort("clk"));
   BValue reset_port = bb.ResetPort(FifoInstantiation::kResetPortName);
 
+  BValue zero_lit = bb.Literal(UBits(0, ptr_type->GetFlatBitCount()));
   BValue one_lit = bb.Literal(UBits(1, ptr_type->GetFlatBitCount()));
   BValue depth_lit = bb.Literal(UBits(depth, ptr_type->GetFlatBitCount()));
-  BValue long_buf_size_lit =
-      bb.Literal(UBits(depth + 1, ptr_type->GetFlatBitCount() + 1),
-                 SourceInfo(), "long_buf_size_lit");
+  BValue last_slot_lit = bb.Literal(UBits(depth, ptr_type->GetFlatBitCount()),
+                                    SourceInfo(), "last_slot_lit");
 
   BValue push_valid = bb.InputPort(FifoInstantiation::kPushValidPortName, u1);
   BValue pop_ready_port =
@@ -144,19 +238,12 @@ absl::StatusOr<Block*> MaterializeFifo(NameUniquer& uniquer, Package* p,
 
   BValue current_queue_tail = bb.ArrayIndex(buf, {tail});
 
-  auto add_mod_buf_size = [&](BValue val, BValue addend,
-                              std::optional<std::string_view> name) -> BValue {
-    // NB Need to be sure to not run into issues where the 2 mods here (explicit
-    // umod and implicit bit-width) interfere. To avoid this just do the
-    // arithmetic with an extra bit and remove it, we don't really care about
-    // QOR anyway.
-    // TODO(allight): Rewriting this to just make the buffer a pow-2 size seems
-    // like it would be simpler.
-    return bb.BitSlice(
-        bb.UMod(bb.Add(bb.ZeroExtend(val, ptr_type->GetFlatBitCount() + 1),
-                       bb.ZeroExtend(addend, ptr_type->GetFlatBitCount() + 1)),
-                long_buf_size_lit),
-        0, ptr_type->GetFlatBitCount(), SourceInfo(), name.value_or(""));
+  // Advances a pointer by one slot, wrapping after the last slot. A compare
+  // and select rather than a modulus keeps the pointer logic off the critical
+  // path for any depth.
+  auto increment_ptr = [&](BValue ptr, std::string_view name) -> BValue {
+    return bb.Select(bb.Eq(ptr, last_slot_lit), /*on_true=*/zero_lit,
+                     /*on_false=*/bb.Add(ptr, one_lit), SourceInfo(), name);
   };
 
   // If we aren't registering pop outputs, there's nothing special on the pop
@@ -183,9 +270,9 @@ absl::StatusOr<Block*> MaterializeFifo(NameUniquer& uniquer, Package* p,
 
   // NB we don't bother clearing data after a pop.
   BValue next_tail_value_if_pop_occurs =
-      add_mod_buf_size(tail, one_lit, "next_tail_if_pop");
+      increment_ptr(tail, "next_tail_if_pop");
   BValue next_head_value_if_push_occurs =
-      add_mod_buf_size(head, one_lit, "next_head_if_push");
+      increment_ptr(head, "next_head_if_push");
 
   BValue push_ready;
   BValue pop_valid;
@@ -263,6 +350,21 @@ absl::StatusOr<Block*> MaterializeFifo(NameUniquer& uniquer, Package* p,
 
   return bb.Build();
 }
+
+// Picks the cheapest implementation for the configuration of `inst`.
+absl::StatusOr<Block*> MaterializeFifo(NameUniquer& uniquer, Package* p,
+                                       FifoInstantiation* inst,
+                                       const xls::Reset& reset_behavior) {
+  const FifoConfig& config = inst->fifo_config();
+  if (config.depth() == 0 && config.bypass() &&
+      !config.register_push_outputs() && !config.register_pop_outputs()) {
+    return MaterializePassthroughFifo(uniquer, p, inst);
+  }
+  if (config.depth() == 1 && !config.register_pop_outputs()) {
+    return MaterializeSingleEntryFifo(uniquer, p, inst, reset_behavior);
+  }
+  return MaterializeRingFifo(uniquer, p, inst, reset_behavior);
+}
 }  // namespace
 
 absl::StatusOr<bool> MaterializeFifosPass::RunInternal(
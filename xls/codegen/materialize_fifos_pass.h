@@ -20,7 +20,10 @@
 
 namespace xls::verilog {
 
-// Materialize FIFO instantiations into blocks. The performance
+// Materialize FIFO instantiations into blocks. The implementation depends on
+// the configuration: a depth-0 bypass FIFO is a direct connection, a depth-1
+// FIFO without registered pop outputs is a single register and full flag, and
+// deeper FIFOs are a ring buffer of registers. The performance
 // characteristics/DV Support may not be ideal for all use cases.
 class MaterializeFifosPass : public CodegenPass {
  public:
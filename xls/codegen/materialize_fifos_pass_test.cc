@@ -291,6 +291,70 @@ TEST_P(MaterializeFifosPassTest, BasicFifoBypass) {
                                          });
 }
 
+TEST_P(MaterializeFifosPassTest, SingleEntryFifo) {
+  if (GetParam().reg_pop_outputs) {
+    GTEST_SKIP() << "Depth 1 fifos cannot register pop outputs.";
+  }
+  RunTestVector(GetParam().WithDepth(1), {
+                                             Push{1},
+                                             Push{2},
+                                             NotReady{},
+                                             Pop{},
+                                             Pop{},
+                                             PushAndPop{3},
+                                             PushAndPop{4},
+                                             Pop{},
+                                             Push{5},
+                                             PushAndPop{6},
+                                             Pop{},
+                                             ResetOp{},
+                                             Pop{},
+                                         });
+}
+
+TEST_F(MaterializeFifosPassTest, SingleEntryFifoHasNoBuffer) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * fifo_block,
+      MakeFifoBlock(p.get(), FifoConfig(1, /*bypass=*/true,
+                                        /*register_push_outputs=*/false,
+                                        /*register_pop_outputs=*/false)));
+  EXPECT_THAT(fifo_block->GetRegisters(), testing::SizeIs(2));
+}
+
+TEST_F(MaterializeFifosPassTest, PassthroughFifo) {
+  FifoConfig cfg(0, /*bypass=*/true, /*register_push_outputs=*/false,
+                 /*register_pop_outputs=*/false);
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * fifo_block, MakeFifoBlock(p.get(), cfg));
+  EXPECT_THAT(fifo_block->GetRegisters(), testing::IsEmpty());
+  RunTestVector(cfg, {
+                         PushAndPop{1},
+                         Push{2},
+                         Pop{},
+                         NotReady{},
+                         PushAndPop{3},
+                         ResetOp{},
+                         PushAndPop{4},
+                     });
+}
+
+TEST_F(MaterializeFifosPassTest, DeepFifo) {
+  FifoConfig cfg(16, /*bypass=*/false, /*register_push_outputs=*/true,
+                 /*register_pop_outputs=*/true);
+  std::vector<Operation> ops;
+  for (int32_t i = 0; i < 20; ++i) {
+    ops.push_back(Push{i + 1});
+  }
+  for (int32_t i = 0; i < 40; ++i) {
+    ops.push_back(i % 3 == 0 ? Operation(Pop{}) : Operation(PushAndPop{i}));
+  }
+  for (int32_t i = 0; i < 20; ++i) {
+    ops.push_back(Pop{});
+  }
+  RunTestVector(cfg, ops);
+}
+
 INSTANTIATE_TEST_SUITE_P(MaterializeFifosPassTest, MaterializeFifosPassTest,
                          testing::ValuesIn<PartialConfig>({
                              PartialConfig{
@@ -1382,7 +1382,7 @@ absl::StatusOr<ModuleBuilder::Register> ModuleBuilder::DeclareRegister(
 }
 
 absl::Status ModuleBuilder::AssignRegisters(
-    absl::Span<const Register> registers) {
+    absl::Span<const Register> registers, LogicRef* clock) {
   XLS_RET_CHECK(clk_ != nullptr);
 
   if (registers.empty()) {
@@ -1420,7 +1420,8 @@ absl::Status ModuleBuilder::AssignRegisters(
 
   // Construct an always_ff block.
   std::vector<SensitivityListElement> sensitivity_list;
-  sensitivity_list.push_back(file_->Make<PosEdge>(SourceInfo(), clk_));
+  sensitivity_list.push_back(
+      file_->Make<PosEdge>(SourceInfo(), clock == nullptr ? clk_ : clock));
   if (rst_.has_value()) {
     if (rst_->asynchronous) {
       if (rst_->active_low) {
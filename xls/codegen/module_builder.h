@@ -186,8 +186,10 @@ class ModuleBuilder {
                                            int64_t bit_count, Expression* next,
                                            Expression* reset_value = nullptr);
 
-  // Construct an always block to assign values to the registers.
-  absl::Status AssignRegisters(absl::Span<const Register> registers);
+  // Construct an always block to assign values to the registers. The registers
+  // are clocked by `clock` if given, otherwise by the module clock.
+  absl::Status AssignRegisters(absl::Span<const Register> registers,
+                               LogicRef* clock = nullptr);
 
   // For organization (not functionality) the module is divided into several
   // sections. The emitted module has the following structure:
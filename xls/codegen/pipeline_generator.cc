@@ -77,6 +77,9 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
   XLS_RET_CHECK(unit.top_block != nullptr &&
                 unit.metadata.contains(unit.top_block) &&
                 unit.metadata.at(unit.top_block).signature.has_value());
+  if (options.low_memory()) {
+    XLS_RETURN_IF_ERROR(unit.ReleaseFunctionBases());
+  }
   VerilogLineMap verilog_line_map;
   const auto& pipeline =
       unit.metadata.at(unit.top_block).streaming_io_and_pipeline;
@@ -89,7 +92,7 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
   // TODO: google/xls#1323 - add all block signatures to ModuleGeneratorResult,
   // not just top.
   return ModuleGeneratorResult{
-      verilog, verilog_line_map,
+      std::move(verilog), std::move(verilog_line_map),
       unit.metadata.at(unit.top_block).signature.value()};
 }
 
@@ -129,6 +132,9 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
   XLS_RET_CHECK(unit.top_block != nullptr &&
                 unit.metadata.contains(unit.top_block) &&
                 unit.metadata.at(unit.top_block).signature.has_value());
+  if (options.low_memory()) {
+    XLS_RETURN_IF_ERROR(unit.ReleaseFunctionBases());
+  }
   VerilogLineMap verilog_line_map;
   const auto& pipeline =
       unit.metadata[unit.top_block].streaming_io_and_pipeline;
@@ -141,7 +147,7 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
   // TODO: google/xls#1323 - add all block signatures to ModuleGeneratorResult,
   // not just top.
   return ModuleGeneratorResult{
-      verilog, verilog_line_map,
+      std::move(verilog), std::move(verilog_line_map),
       unit.metadata.at(unit.top_block).signature.value()};
 }
 
@@ -29,6 +29,7 @@
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
@@ -1160,6 +1161,45 @@ proc ii_greater_than_one(st: bits[32], init={0}) {
                                  result.verilog_text);
 }
 
+TEST_P(PipelineGeneratorTest, LowMemoryReleasesFunctions) {
+  auto generate = [&](Package* package,
+                      bool low_memory) -> absl::StatusOr<std::string> {
+    FunctionBuilder fb("x_plus_y_times_z", package);
+    Type* u32 = package->GetBitsType(32);
+    BValue x = fb.Param("x", u32);
+    BValue y = fb.Param("y", u32);
+    BValue z = fb.Param("z", u32);
+    XLS_ASSIGN_OR_RETURN(Function * func,
+                         fb.BuildWithReturnValue(fb.UMul(x + y, z)));
+    XLS_RETURN_IF_ERROR(package->SetTop(func));
+    XLS_ASSIGN_OR_RETURN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(func, TestDelayEstimator(),
+                            SchedulingOptions().pipeline_stages(3)));
+    XLS_ASSIGN_OR_RETURN(
+        ModuleGeneratorResult result,
+        ToPipelineModuleText(schedule, func,
+                             BuildPipelineOptions()
+                                 .use_system_verilog(UseSystemVerilog())
+                                 .low_memory(low_memory)));
+    return result.verilog_text;
+  };
+
+  Package package(TestBaseName());
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           generate(&package, /*low_memory=*/false));
+  EXPECT_EQ(package.functions().size(), 1);
+
+  Package low_memory_package(TestBaseName());
+  XLS_ASSERT_OK_AND_ASSIGN(std::string low_memory_verilog,
+                           generate(&low_memory_package, /*low_memory=*/true));
+  EXPECT_EQ(low_memory_verilog, verilog);
+  EXPECT_TRUE(low_memory_package.functions().empty());
+  ASSERT_EQ(low_memory_package.blocks().size(), 1);
+  EXPECT_EQ(low_memory_package.GetTop(),
+            low_memory_package.blocks().front().get());
+}
+
 INSTANTIATE_TEST_SUITE_P(PipelineGeneratorTestInstantiation,
                          PipelineGeneratorTest,
                          testing::ValuesIn(kDefaultSimulationTargets),
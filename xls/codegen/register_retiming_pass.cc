@@ -0,0 +1,351 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/register_retiming_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/codegen/conversion_utils.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/block.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+
+namespace xls::verilog {
+
+namespace {
+
+// Returns the nodes referenced by the metadata of a block, other than through
+// its pipeline registers. Later passes rely on these, so they are not moved.
+absl::flat_hash_set<Node*> PinnedNodes(const CodegenMetadata& metadata) {
+  const StreamingIOPipeline& pipeline = metadata.streaming_io_and_pipeline;
+  absl::flat_hash_set<Node*> pinned;
+  auto pin = [&](std::optional<Node*> node) {
+    if (node.has_value() && *node != nullptr) {
+      pinned.insert(*node);
+    }
+  };
+  for (const std::vector<StreamingInput>& inputs : pipeline.inputs) {
+    for (const StreamingInput& input : inputs) {
+      pin(input.port);
+      pin(input.port_valid);
+      pin(input.port_ready);
+      pin(input.signal_data);
+      pin(input.signal_valid);
+      pin(input.predicate);
+    }
+  }
+  for (const std::vector<StreamingOutput>& outputs : pipeline.outputs) {
+    for (const StreamingOutput& output : outputs) {
+      pin(output.port);
+      pin(output.port_valid);
+      pin(output.port_ready);
+      pin(output.predicate);
+    }
+  }
+  for (const std::optional<StateRegister>& state : pipeline.state_registers) {
+    if (!state.has_value()) {
+      continue;
+    }
+    for (const StateRegister::NextValue& next_value : state->next_values) {
+      pin(next_value.value);
+      pin(next_value.predicate);
+    }
+    pin(state->reg_read);
+    pin(state->reg_write);
+    pin(state->reg_full_read);
+    pin(state->reg_full_write);
+  }
+  for (const auto* nodes :
+       {&pipeline.pipeline_valid, &pipeline.stage_valid, &pipeline.stage_done}) {
+    for (std::optional<Node*> node : *nodes) {
+      pin(node);
+    }
+  }
+  if (const auto* proc_metadata =
+          std::get_if<ProcConversionMetadata>(&metadata.conversion_metadata)) {
+    for (std::optional<Node*> node : proc_metadata->valid_flops) {
+      pin(node);
+    }
+  }
+  return pinned;
+}
+
+// Returns the delay of `node`, or zero for the block-specific operations the
+// delay model does not cover.
+int64_t NodeDelay(Node* node, const DelayEstimator& delay_estimator) {
+  absl::StatusOr<int64_t> delay = delay_estimator.GetOperationDelayInPs(node);
+  if (!delay.ok()) {
+    VLOG(4) << "No delay estimate for " << node->GetName() << ": "
+            << delay.status();
+    return 0;
+  }
+  return *delay;
+}
+
+class Retimer {
+ public:
+  Retimer(Block* block, CodegenMetadata& metadata,
+          const DelayEstimator& delay_estimator,
+          std::optional<int64_t> clock_period_ps)
+      : block_(block),
+        pipeline_(metadata.streaming_io_and_pipeline),
+        delay_estimator_(delay_estimator),
+        pinned_(PinnedNodes(metadata)) {
+    // The arrival time of a node is the delay of the longest combinational
+    // path ending at it, starting at a register, port or instantiation.
+    int64_t critical_path_ps = 0;
+    for (Node* node : TopoSort(block)) {
+      int64_t arrival = 0;
+      if (!node->Is<RegisterRead>() && !node->Is<InputPort>() &&
+          !node->Is<InstantiationOutput>()) {
+        for (Node* operand : node->operands()) {
+          arrival = std::max(arrival, arrival_ps_.at(operand));
+        }
+        arrival += NodeDelay(node, delay_estimator);
+      }
+      arrival_ps_[node] = arrival;
+      critical_path_ps = std::max(critical_path_ps, arrival);
+    }
+    // Retiming never lengthens the critical path beyond the clock period, nor
+    // beyond the current critical path when that is longer already.
+    max_arrival_ps_ = std::max(clock_period_ps.value_or(0), critical_path_ps);
+
+    for (Stage stage = 0; stage < pipeline_.pipeline_registers.size();
+         ++stage) {
+      for (const PipelineRegister& reg : pipeline_.pipeline_registers[stage]) {
+        if (!reg.reg->reset().has_value() &&
+            !reg.reg_write->reset().has_value() &&
+            !pinned_.contains(reg.reg_read)) {
+          register_of_read_[reg.reg_read] = {stage, reg};
+        }
+      }
+    }
+  }
+
+  // Retimes registers until no more bits can be saved. Returns whether
+  // anything changed.
+  absl::StatusOr<bool> Run() {
+    bool changed = false;
+    bool round_changed = true;
+    while (round_changed) {
+      round_changed = false;
+      removed_.clear();
+      for (Node* node : TopoSort(block_)) {
+        if (removed_.contains(node)) {
+          continue;
+        }
+        XLS_ASSIGN_OR_RETURN(bool retimed, MaybeRetime(node));
+        round_changed = round_changed || retimed;
+      }
+      changed = changed || round_changed;
+    }
+    return changed;
+  }
+
+ private:
+  struct StageRegister {
+    // The stage in which the register is written.
+    Stage stage;
+    PipelineRegister reg;
+  };
+
+  // Moves the registers feeding `node` past it if that saves register bits
+  // without violating timing. Returns whether it did.
+  absl::StatusOr<bool> MaybeRetime(Node* node) {
+    if (OpIsSideEffecting(node->op()) || TypeHasToken(node->GetType()) ||
+        node->operand_count() == 0 || pinned_.contains(node)) {
+      return false;
+    }
+    auto stage_it = pipeline_.node_to_stage_map.find(node);
+    if (stage_it == pipeline_.node_to_stage_map.end() ||
+        stage_it->second == 0) {
+      return false;
+    }
+    Stage write_stage = stage_it->second - 1;
+
+    std::vector<StageRegister> operand_registers;
+    for (Node* operand : node->operands()) {
+      if (operand->Is<Literal>()) {
+        continue;
+      }
+      auto it = operand->Is<RegisterRead>()
+                    ? register_of_read_.find(operand->As<RegisterRead>())
+                    : register_of_read_.end();
+      if (it == register_of_read_.end() || it->second.stage != write_stage) {
+        return false;
+      }
+      operand_registers.push_back(it->second);
+    }
+    if (operand_registers.empty()) {
+      return false;
+    }
+    // The new register must be loaded exactly when the ones it replaces are.
+    std::optional<Node*> load_enable =
+        operand_registers.front().reg.reg_write->load_enable();
+    for (const StageRegister& operand_register : operand_registers) {
+      if (operand_register.reg.reg_write->load_enable() != load_enable) {
+        return false;
+      }
+    }
+
+    // Only registers which are used by nothing but `node` go away.
+    absl::flat_hash_set<RegisterRead*> freed;
+    int64_t freed_bits = 0;
+    for (const StageRegister& operand_register : operand_registers) {
+      RegisterRead* read = operand_register.reg.reg_read;
+      if (!freed.contains(read) &&
+          std::all_of(read->users().begin(), read->users().end(),
+                      [&](Node* user) { return user == node; })) {
+        freed.insert(read);
+        freed_bits += read->GetType()->GetFlatBitCount();
+      }
+    }
+    int64_t new_bits = node->GetType()->GetFlatBitCount();
+    if (new_bits >= freed_bits) {
+      return false;
+    }
+
+    int64_t arrival = 0;
+    for (const StageRegister& operand_register : operand_registers) {
+      arrival = std::max(arrival,
+                         arrival_ps_.at(operand_register.reg.reg_write->data()));
+    }
+    arrival += NodeDelay(node, delay_estimator_);
+    if (arrival > max_arrival_ps_) {
+      VLOG(3) << absl::StreamFormat(
+          "Not retiming %s: path of %dps exceeds %dps", node->GetName(),
+          arrival, max_arrival_ps_);
+      return false;
+    }
+
+    VLOG(2) << absl::StreamFormat(
+        "Retiming %s into stage %d, saving %d register bits", node->GetName(),
+        write_stage, freed_bits - new_bits);
+    std::vector<Node*> new_operands;
+    new_operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      new_operands.push_back(
+          operand->Is<Literal>()
+              ? operand
+              : register_of_read_.at(operand->As<RegisterRead>())
+                    .reg.reg_write->data());
+    }
+    XLS_ASSIGN_OR_RETURN(Node * clone,
+                         node->CloneInNewFunction(new_operands, block_));
+    XLS_ASSIGN_OR_RETURN(
+        Register * reg,
+        block_->AddRegister(PipelineSignalName(node->GetName(), write_stage),
+                            node->GetType()));
+    XLS_ASSIGN_OR_RETURN(
+        RegisterWrite * reg_write,
+        block_->MakeNode<RegisterWrite>(node->loc(), clone, load_enable,
+                                        /*reset=*/std::nullopt, reg));
+    XLS_ASSIGN_OR_RETURN(RegisterRead * reg_read,
+                         block_->MakeNodeWithName<RegisterRead>(
+                             node->loc(), reg, /*name=*/reg->name()));
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(reg_read));
+
+    pipeline_.node_to_stage_map[clone] = write_stage;
+    pipeline_.node_to_stage_map[reg_write] = write_stage;
+    pipeline_.node_to_stage_map[reg_read] = write_stage + 1;
+    arrival_ps_[clone] = arrival;
+    arrival_ps_[reg_write] = arrival;
+    arrival_ps_[reg_read] = 0;
+    PipelineRegister pipeline_register{
+        .reg = reg, .reg_write = reg_write, .reg_read = reg_read};
+    pipeline_.pipeline_registers[write_stage].push_back(pipeline_register);
+    register_of_read_[reg_read] = {write_stage, pipeline_register};
+
+    XLS_RETURN_IF_ERROR(RemoveNode(node));
+    for (RegisterRead* read : freed) {
+      StageRegister freed_register = register_of_read_.at(read);
+      register_of_read_.erase(read);
+      std::erase_if(pipeline_.pipeline_registers[write_stage],
+                    [&](const PipelineRegister& r) {
+                      return r.reg == freed_register.reg.reg;
+                    });
+      XLS_RETURN_IF_ERROR(RemoveNode(freed_register.reg.reg_read));
+      XLS_RETURN_IF_ERROR(RemoveNode(freed_register.reg.reg_write));
+      XLS_RETURN_IF_ERROR(block_->RemoveRegister(freed_register.reg.reg));
+    }
+    return true;
+  }
+
+  absl::Status RemoveNode(Node* node) {
+    XLS_RET_CHECK(node->users().empty()) << node->GetName();
+    pipeline_.node_to_stage_map.erase(node);
+    arrival_ps_.erase(node);
+    removed_.insert(node);
+    return block_->RemoveNode(node);
+  }
+
+  Block* block_;
+  StreamingIOPipeline& pipeline_;
+  const DelayEstimator& delay_estimator_;
+  absl::flat_hash_set<Node*> pinned_;
+  absl::flat_hash_map<Node*, int64_t> arrival_ps_;
+  int64_t max_arrival_ps_;
+  absl::flat_hash_map<RegisterRead*, StageRegister> register_of_read_;
+  // The nodes removed in the current round.
+  absl::flat_hash_set<Node*> removed_;
+};
+
+}  // namespace
+
+absl::StatusOr<bool> RegisterRetimingPass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    CodegenPassResults* results) const {
+  if (!options.codegen_options.retime_registers()) {
+    return false;
+  }
+  if (options.delay_estimator == nullptr) {
+    VLOG(2) << "Not retiming registers without a delay estimator.";
+    return false;
+  }
+  std::optional<int64_t> clock_period_ps;
+  if (options.schedule.has_value()) {
+    clock_period_ps = options.schedule->min_clock_period_ps();
+  }
+  bool changed = false;
+  for (auto& [block, metadata] : unit->metadata) {
+    Retimer retimer(block, metadata, *options.delay_estimator,
+                    clock_period_ps);
+    XLS_ASSIGN_OR_RETURN(bool block_changed, retimer.Run());
+    changed = changed || block_changed;
+  }
+  if (changed) {
+    unit->GcMetadata();
+  }
+  return changed;
+}
+
+}  // namespace xls::verilog
@@ -0,0 +1,50 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
+#define XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+
+namespace xls::verilog {
+
+// Moves pipeline registers forward across combinational nodes where that
+// reduces the number of register bits, in the manner of min-area retiming.
+//
+// A node whose operands are all pipeline registers written in the preceding
+// stage (or literals) is recomputed in the preceding stage and registered in
+// place of its operands, provided its result is narrower than the operand
+// registers which become unused and the lengthened path in the preceding
+// stage fits within the clock period (or, without a known clock period, the
+// block's current critical path). Registers with a reset and nodes referenced
+// by the codegen metadata are left alone.
+//
+// Runs only if CodegenOptions::retime_registers is set and a delay estimator
+// is given.
+class RegisterRetimingPass : public CodegenPass {
+ public:
+  RegisterRetimingPass()
+      : CodegenPass("register_retiming",
+                    "Retime pipeline registers to reduce register bits") {}
+  ~RegisterRetimingPass() override = default;
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   CodegenPassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
@@ -0,0 +1,153 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/register_retiming_pass.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/codegen/block_conversion.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/matchers.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/register.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+namespace xls::verilog {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+class RegisterRetimingPassTest : public IrTestBase {
+ public:
+  absl::StatusOr<CodegenPassUnit> ToBlock(const PipelineSchedule& schedule,
+                                          Function* f) {
+    return FunctionBaseToPipelinedBlock(schedule,
+                                        CodegenOptions()
+                                            .emit_as_pipeline(true)
+                                            .module_name(TestName())
+                                            .clock_name("clk"),
+                                        f);
+  }
+
+  absl::StatusOr<bool> Run(CodegenPassUnit& unit,
+                           const PipelineSchedule& schedule,
+                           bool retime_registers = true) {
+    XLS_ASSIGN_OR_RETURN(const DelayEstimator* estimator,
+                         GetDelayEstimator("unit"));
+    RegisterRetimingPass pass;
+    CodegenPassResults results;
+    return pass.Run(
+        &unit,
+        CodegenPassOptions{
+            .codegen_options =
+                CodegenOptions().retime_registers(retime_registers),
+            .schedule = schedule,
+            .delay_estimator = estimator},
+        &results);
+  }
+
+  static int64_t RegisterBits(Block* block) {
+    int64_t bits = 0;
+    for (Register* reg : block->GetRegisters()) {
+      bits += reg->type()->GetFlatBitCount();
+    }
+    return bits;
+  }
+};
+
+TEST_F(RegisterRetimingPassTest, MovesRegistersPastComparison) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue eq = fb.Eq(a, b);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(eq));
+  PipelineSchedule schedule(f, {{a.node(), 0}, {b.node(), 0}, {eq.node(), 1}},
+                            2);
+  XLS_ASSERT_OK_AND_ASSIGN(CodegenPassUnit unit, ToBlock(schedule, f));
+  EXPECT_EQ(RegisterBits(unit.top_block), 64);
+
+  EXPECT_THAT(Run(unit, schedule), IsOkAndHolds(true));
+  EXPECT_EQ(RegisterBits(unit.top_block), 1);
+  XLS_ASSERT_OK(unit.top_block->GetOutputPort("out").status());
+}
+
+TEST_F(RegisterRetimingPassTest, KeepsRegistersBeforeWideningNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue concat = fb.Concat({a, b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(concat));
+  PipelineSchedule schedule(
+      f, {{a.node(), 0}, {b.node(), 0}, {concat.node(), 1}}, 2);
+  XLS_ASSERT_OK_AND_ASSIGN(CodegenPassUnit unit, ToBlock(schedule, f));
+
+  EXPECT_THAT(Run(unit, schedule), IsOkAndHolds(false));
+  EXPECT_EQ(RegisterBits(unit.top_block), 64);
+}
+
+TEST_F(RegisterRetimingPassTest, RespectsClockPeriod) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue c = fb.Param("c", p->GetBitsType(32));
+  BValue sum = fb.Add(a, b);
+  BValue diff = fb.Subtract(sum, c);
+  BValue eq = fb.Eq(diff, c);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(eq));
+  // Stage 0 is already as long as the clock period, so the comparison cannot
+  // move into it.
+  PipelineSchedule schedule(f,
+                            {{a.node(), 0},
+                             {b.node(), 0},
+                             {c.node(), 0},
+                             {sum.node(), 0},
+                             {diff.node(), 0},
+                             {eq.node(), 1}},
+                            2, /*min_clock_period_ps=*/2);
+  XLS_ASSERT_OK_AND_ASSIGN(CodegenPassUnit unit, ToBlock(schedule, f));
+
+  EXPECT_THAT(Run(unit, schedule), IsOkAndHolds(false));
+  EXPECT_EQ(RegisterBits(unit.top_block), 64);
+}
+
+TEST_F(RegisterRetimingPassTest, DisabledByDefault) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue eq = fb.Eq(a, b);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(eq));
+  PipelineSchedule schedule(f, {{a.node(), 0}, {b.node(), 0}, {eq.node(), 1}},
+                            2);
+  XLS_ASSERT_OK_AND_ASSIGN(CodegenPassUnit unit, ToBlock(schedule, f));
+
+  EXPECT_THAT(Run(unit, schedule, /*retime_registers=*/false),
+              IsOkAndHolds(false));
+  EXPECT_EQ(RegisterBits(unit.top_block), 64);
+}
+
+}  // namespace
+}  // namespace xls::verilog
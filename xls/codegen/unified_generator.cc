@@ -90,6 +90,10 @@ absl::StatusOr<ModuleGeneratorResult> GenerateModuleText(
                 unit.metadata.contains(unit.top_block) &&
                 unit.metadata.at(unit.top_block).signature.has_value());
 
+  if (options.low_memory()) {
+    XLS_RETURN_IF_ERROR(unit.ReleaseFunctionBases());
+  }
+
   // VAST Generation: Block to Verilog codegen pass.
   VerilogLineMap verilog_line_map;
   const auto& pipeline =
@@ -103,7 +107,7 @@ absl::StatusOr<ModuleGeneratorResult> GenerateModuleText(
   // TODO: google/xls#1323 - add all block signatures to ModuleGeneratorResult,
   // not just top.
   return ModuleGeneratorResult{
-      verilog, verilog_line_map,
+      std::move(verilog), std::move(verilog_line_map),
       unit.metadata.at(unit.top_block).signature.value()};
 }
 
@@ -15,7 +15,12 @@
 #include "xls/codegen/vast/vast.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <ios>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -308,6 +313,85 @@ std::optional<std::vector<LineSpan>> LineInfo::LookupNode(
   return spans_.at(node).completed_spans;
 }
 
+VerilogSink::VerilogSink(std::ofstream file, std::filesystem::path path,
+                         int64_t buffer_size)
+    : file_(std::move(file)),
+      path_(std::move(path)),
+      buffer_size_(buffer_size) {
+  buffer_.reserve(buffer_size_);
+}
+
+absl::StatusOr<std::unique_ptr<VerilogSink>> VerilogSink::ForFile(
+    const std::filesystem::path& path, int64_t buffer_size) {
+  std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!file.is_open()) {
+    return absl::UnavailableError(
+        absl::StrFormat("Unable to open %s for writing", path.string()));
+  }
+  return std::unique_ptr<VerilogSink>(
+      new VerilogSink(std::move(file), path, buffer_size));
+}
+
+VerilogSink::~VerilogSink() {
+  if (file_.has_value()) {
+    absl::Status status = Close();
+    LOG_IF(ERROR, !status.ok()) << status;
+  }
+}
+
+void VerilogSink::Write(std::string_view text) {
+  std::string& out = string_out_ != nullptr ? *string_out_ : buffer_;
+  while (!text.empty()) {
+    size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+    if (!line.empty()) {
+      if (at_line_start_) {
+        out.append(indent_, ' ');
+        at_line_start_ = false;
+      }
+      out.append(line);
+    }
+    if (newline == std::string_view::npos) {
+      break;
+    }
+    out.push_back('\n');
+    at_line_start_ = true;
+    text.remove_prefix(newline + 1);
+  }
+  if (file_.has_value() && buffer_.size() >= buffer_size_) {
+    Flush().IgnoreError();
+  }
+}
+
+absl::Status VerilogSink::Flush() {
+  if (file_.has_value() && !buffer_.empty()) {
+    file_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+    if (!file_->good() && status_.ok()) {
+      status_ = absl::InternalError(
+          absl::StrFormat("Failed to write to %s", path_.string()));
+    }
+  }
+  return status_;
+}
+
+absl::Status VerilogSink::Close() {
+  XLS_RETURN_IF_ERROR(Flush());
+  if (file_.has_value()) {
+    file_->close();
+    if (file_->fail()) {
+      status_ = absl::InternalError(
+          absl::StrFormat("Failed to close %s", path_.string()));
+    }
+    file_.reset();
+  }
+  return status_;
+}
+
+void VastNode::EmitTo(VerilogSink& sink, LineInfo* line_info) const {
+  sink.Write(Emit(line_info));
+}
+
 std::string SanitizeIdentifier(std::string_view name) {
   if (name.empty()) {
     return "_";
@@ -433,16 +517,18 @@ UnpackedArrayType* VerilogFile::UnpackedArrayType(
 }
 
 std::string VerilogFile::Emit(LineInfo* line_info) const {
-  auto file_member_str = [=](const FileMember& member) -> std::string {
-    return absl::visit([=](auto* m) { return m->Emit(line_info); }, member);
-  };
-
   std::string out;
+  VerilogSink sink(&out);
+  Emit(sink, line_info);
+  return out;
+}
+
+void VerilogFile::Emit(VerilogSink& sink, LineInfo* line_info) const {
   for (const FileMember& member : members_) {
-    absl::StrAppend(&out, file_member_str(member), "\n");
+    absl::visit([&](auto* m) { m->EmitTo(sink, line_info); }, member);
+    sink.Write("\n");
     LineInfoIncrease(line_info, 1);
   }
-  return out;
 }
 
 LocalParamItemRef* LocalParam::AddItem(std::string_view name, Expression* value,
@@ -1005,55 +1091,58 @@ GenvarDef::GenvarDef(std::string_view name, VerilogFile* file,
 
 namespace {
 
-// "Match" statement for emitting a ModuleMember.
-std::string EmitModuleMember(LineInfo* line_info, const ModuleMember& member) {
-  return absl::visit([=](auto* d) { return d->Emit(line_info); }, member);
-}
-
-// Visitor for emitting a VerilogPackageMember.
-std::string EmitVerilogPackageMember(LineInfo* line_info,
-                                     const VerilogPackageMember& member) {
-  return absl::visit([=](auto* d) { return d->Emit(line_info); }, member);
+// Writes the members of a module or package section to `sink`, separated by
+// newlines. Empty subsections are skipped.
+template <typename SectionT, typename MemberT>
+void EmitSectionMembers(absl::Span<const MemberT> members, VerilogSink& sink,
+                        LineInfo* line_info) {
+  bool first = true;
+  for (const MemberT& member : members) {
+    if (std::holds_alternative<SectionT*>(member) &&
+        std::get<SectionT*>(member)->members().empty()) {
+      continue;
+    }
+    if (!first) {
+      sink.Write("\n");
+    }
+    first = false;
+    absl::visit([&](auto* m) { m->EmitTo(sink, line_info); }, member);
+    LineInfoIncrease(line_info, 1);
+  }
+  if (!first) {
+    LineInfoIncrease(line_info, -1);
+  }
 }
 
 }  // namespace
 
 std::string ModuleSection::Emit(LineInfo* line_info) const {
+  std::string result;
+  VerilogSink sink(&result);
+  EmitTo(sink, line_info);
+  return result;
+}
+
+void ModuleSection::EmitTo(VerilogSink& sink, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
-  for (const ModuleMember& member : members_) {
-    if (std::holds_alternative<ModuleSection*>(member)) {
-      if (std::get<ModuleSection*>(member)->members_.empty()) {
-        continue;
-      }
-    }
-    elements.push_back(EmitModuleMember(line_info, member));
-    LineInfoIncrease(line_info, 1);
-  }
-  if (!elements.empty()) {
-    LineInfoIncrease(line_info, -1);
-  }
+  EmitSectionMembers<ModuleSection>(absl::MakeConstSpan(members_), sink,
+                                    line_info);
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string VerilogPackageSection::Emit(LineInfo* line_info) const {
+  std::string result;
+  VerilogSink sink(&result);
+  EmitTo(sink, line_info);
+  return result;
+}
+
+void VerilogPackageSection::EmitTo(VerilogSink& sink,
+                                   LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
-  for (const VerilogPackageMember& member : members_) {
-    if (std::holds_alternative<VerilogPackageSection*>(member)) {
-      if (std::get<VerilogPackageSection*>(member)->members_.empty()) {
-        continue;
-      }
-    }
-    elements.push_back(EmitVerilogPackageMember(line_info, member));
-    LineInfoIncrease(line_info, 1);
-  }
-  if (!elements.empty()) {
-    LineInfoIncrease(line_info, -1);
-  }
+  EmitSectionMembers<VerilogPackageSection>(absl::MakeConstSpan(members_),
+                                            sink, line_info);
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string ContinuousAssignment::Emit(LineInfo* line_info) const {
@@ -1192,45 +1281,62 @@ std::string SystemFunctionCall::Emit(LineInfo* line_info) const {
 }
 
 std::string Module::Emit(LineInfo* line_info) const {
+  std::string result;
+  VerilogSink sink(&result);
+  EmitTo(sink, line_info);
+  return result;
+}
+
+void Module::EmitTo(VerilogSink& sink, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result = absl::StrCat("module ", name_);
+  sink.Write(absl::StrCat("module ", name_));
   if (ports_.empty()) {
-    absl::StrAppend(&result, ";\n");
+    sink.Write(";\n");
     LineInfoIncrease(line_info, 1);
   } else {
-    absl::StrAppend(&result, "(\n  ");
+    sink.Write("(\n");
     LineInfoIncrease(line_info, 1);
-    absl::StrAppend(
-        &result,
-        absl::StrJoin(ports_, ",\n  ", [=](std::string* out, const Port& port) {
-          std::string wire_str = port.wire->EmitNoSemi(line_info);
-          CHECK(CannotStripWhitespace(wire_str));
-          absl::StrAppendFormat(out, "%s %s", ToString(port.direction),
-                                wire_str);
-          LineInfoIncrease(line_info, 1);
-        }));
-    absl::StrAppend(&result, "\n);\n");
+    for (int64_t i = 0; i < ports_.size(); ++i) {
+      std::string wire_str = ports_[i].wire->EmitNoSemi(line_info);
+      CHECK(CannotStripWhitespace(wire_str));
+      sink.Write(absl::StrFormat("  %s %s%s", ToString(ports_[i].direction),
+                                 wire_str,
+                                 i + 1 < ports_.size() ? ",\n" : ""));
+      LineInfoIncrease(line_info, 1);
+    }
+    sink.Write("\n);\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  sink.Indent();
+  top_.EmitTo(sink, line_info);
+  sink.Dedent();
+  sink.Write("\n");
   LineInfoIncrease(line_info, 1);
-  absl::StrAppend(&result, "endmodule");
+  sink.Write("endmodule");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string VerilogPackage::Emit(LineInfo* line_info) const {
+  std::string result;
+  VerilogSink sink(&result);
+  EmitTo(sink, line_info);
+  return result;
+}
+
+void VerilogPackage::EmitTo(VerilogSink& sink, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
 
-  std::string result = absl::StrCat("package ", name_, ";\n");
+  sink.Write(absl::StrCat("package ", name_, ";\n"));
   LineInfoIncrease(line_info, 1);
 
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  sink.Indent();
+  top_.EmitTo(sink, line_info);
+  sink.Dedent();
+  sink.Write("\n");
   LineInfoIncrease(line_info, 1);
 
-  absl::StrAppend(&result, "endpackage");
+  sink.Write("endpackage");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Literal::Emit(LineInfo* line_info) const {
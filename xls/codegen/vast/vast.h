@@ -19,6 +19,8 @@
 #define XLS_CODEGEN_VAST_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -150,6 +152,65 @@ class LineInfo {
   std::vector<const VastNode*> nodes_;
 };
 
+// An output for emitted Verilog text. Lines are indented to the current
+// indentation level as they are written, so containers can emit their members
+// directly rather than indenting and concatenating the members' text. Text
+// written to a file is buffered and written out in large chunks.
+class VerilogSink {
+ public:
+  static constexpr int64_t kDefaultBufferSize = int64_t{1} << 16;
+
+  // Returns a sink which appends to `*out`.
+  explicit VerilogSink(std::string* out) : string_out_(out) {}
+
+  // Returns a sink which writes to the file at `path`, replacing its contents.
+  static absl::StatusOr<std::unique_ptr<VerilogSink>> ForFile(
+      const std::filesystem::path& path,
+      int64_t buffer_size = kDefaultBufferSize);
+
+  // Flushes any buffered text. Errors are logged; call Close to observe them.
+  ~VerilogSink();
+
+  VerilogSink(const VerilogSink&) = delete;
+  VerilogSink& operator=(const VerilogSink&) = delete;
+
+  // Writes the given text. Each nonempty line is prefixed with the current
+  // indentation when its first character is written. Empty lines are not
+  // indented to avoid trailing whitespace, matching `Indent`.
+  void Write(std::string_view text);
+
+  // Increases or decreases the indentation of subsequently started lines by
+  // the given number of spaces.
+  void Indent(int64_t spaces = 2) { indent_ += spaces; }
+  void Dedent(int64_t spaces = 2) {
+    CHECK_GE(indent_, spaces);
+    indent_ -= spaces;
+  }
+
+  // Writes out any buffered text and returns the first error encountered
+  // writing to the underlying file, if any.
+  absl::Status Flush();
+
+  // Flushes and closes the underlying file, if any.
+  absl::Status Close();
+
+ private:
+  VerilogSink(std::ofstream file, std::filesystem::path path,
+              int64_t buffer_size);
+
+  void Append(std::string_view text);
+
+  std::string* string_out_ = nullptr;
+  std::optional<std::ofstream> file_;
+  std::filesystem::path path_;
+  std::string buffer_;
+  int64_t buffer_size_ = 0;
+
+  int64_t indent_ = 0;
+  bool at_line_start_ = true;
+  absl::Status status_;
+};
+
 // Returns a sanitized identifier string based on the given name. Invalid
 // characters are replaced with '_'.
 std::string SanitizeIdentifier(std::string_view name);
@@ -168,6 +229,11 @@ class VastNode {
 
   virtual std::string Emit(LineInfo* line_info) const = 0;
 
+  // Writes the text of this node to `sink`. By default this writes the result
+  // of `Emit`; containers whose text may be large override this to write
+  // their members directly, and implement `Emit` in terms of it.
+  virtual void EmitTo(VerilogSink& sink, LineInfo* line_info) const;
+
  private:
   VerilogFile* file_;
   SourceInfo loc_;
@@ -2207,6 +2273,7 @@ class ModuleSection final : public VastNode {
   const std::vector<ModuleMember>& members() const { return members_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VerilogSink& sink, LineInfo* line_info) const final;
 
  private:
   std::vector<ModuleMember> members_;
@@ -2307,6 +2374,7 @@ class Module final : public VastNode {
   const std::string& name() const { return name_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VerilogSink& sink, LineInfo* line_info) const final;
 
  private:
   // Add the given Def as a port on the module.
@@ -2377,6 +2445,7 @@ class VerilogPackageSection final : public VastNode {
   const std::vector<VerilogPackageMember>& members() const { return members_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VerilogSink& sink, LineInfo* line_info) const final;
 
  private:
   std::vector<VerilogPackageMember> members_;
@@ -2411,6 +2480,7 @@ class VerilogPackage final : public VastNode {
   const std::string& name() const { return name_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VerilogSink& sink, LineInfo* line_info) const final;
 
  private:
   std::string name_;
@@ -2464,6 +2534,9 @@ class VerilogFile {
   }
 
   std::string Emit(LineInfo* line_info = nullptr) const;
+  // Writes the text of the file to `sink`. Prefer this over `Emit` for large
+  // files, e.g. with a sink writing directly to the output file.
+  void Emit(VerilogSink& sink, LineInfo* line_info = nullptr) const;
 
   verilog::Slice* Slice(IndexableExpression* subject, Expression* hi,
                         Expression* lo, const SourceInfo& loc) {
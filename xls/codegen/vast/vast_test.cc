@@ -15,6 +15,7 @@
 #include "xls/codegen/vast/vast.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -28,6 +29,8 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/format_preference.h"
@@ -1721,6 +1724,67 @@ endmodule)");
             std::vector<LineSpan>{LineSpan(7, 7)});
 }
 
+TEST_P(VastTest, SinkIndentsNonEmptyLines) {
+  std::string out;
+  VerilogSink sink(&out);
+  sink.Write("a\n");
+  sink.Indent();
+  sink.Write("b");
+  sink.Write("c\n\nd\n");
+  sink.Indent();
+  sink.Write("e\n");
+  sink.Dedent(4);
+  sink.Write("f");
+  EXPECT_EQ(out, "a\n  bc\n\n  d\n    e\nf");
+}
+
+TEST_P(VastTest, EmitToFileSink) {
+  VerilogFile f(GetFileType());
+  Module* module = f.AddModule("my_module", SourceInfo());
+  LogicRef* a = module->AddInput("a", f.BitVectorType(8, SourceInfo()),
+                                 SourceInfo());
+  LogicRef* out = module->AddOutput("out", f.BitVectorType(8, SourceInfo()),
+                                    SourceInfo());
+  ModuleSection* section = module->Add<ModuleSection>(SourceInfo());
+  section->Add<Comment>(SourceInfo(), "in a section");
+  section->Add<ModuleSection>(SourceInfo());
+  module->Add<ContinuousAssignment>(SourceInfo(), out,
+                                    f.BitwiseNot(a, SourceInfo()));
+  f.Add(f.Make<BlankLine>(SourceInfo()));
+  f.AddModule("empty", SourceInfo());
+
+  LineInfo line_info;
+  std::string text = f.Emit(&line_info);
+  EXPECT_EQ(text, R"(module my_module(
+  input wire [7:0] a,
+  output wire [7:0] out
+);
+  // in a section
+  assign out = ~a;
+endmodule
+
+module empty;
+
+endmodule
+)");
+  EXPECT_EQ(line_info.LookupNode(module).value(),
+            std::vector<LineSpan>{LineSpan(0, 6)});
+  EXPECT_EQ(line_info.LookupNode(section).value(),
+            std::vector<LineSpan>{LineSpan(4, 4)});
+
+  // A small buffer forces several flushes while emitting.
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp_file, TempFile::Create(".v"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerilogSink> sink,
+                           VerilogSink::ForFile(temp_file.path(),
+                                                /*buffer_size=*/16));
+  LineInfo sink_line_info;
+  f.Emit(*sink, &sink_line_info);
+  XLS_ASSERT_OK(sink->Close());
+  EXPECT_THAT(GetFileContents(temp_file.path()), IsOkAndHolds(text));
+  EXPECT_EQ(sink_line_info.LookupNode(module).value(),
+            std::vector<LineSpan>{LineSpan(0, 6)});
+}
+
 TEST_P(VastTest, VerilogFunction) {
   VerilogFile f(GetFileType());
   Module* m = f.AddModule("top", SourceInfo());
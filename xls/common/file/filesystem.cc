@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <filesystem>  // NOLINT
 #include <sstream>
@@ -30,6 +31,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -80,6 +82,23 @@ class ParseTextProtoFileErrorCollector : public google::protobuf::io::ErrorColle
   const google::protobuf::Message& proto_;
 };
 
+// Writes all of `content` to `fd`.
+absl::Status WriteAll(int fd, std::string_view content,
+                      const std::filesystem::path& file_name) {
+  ssize_t written = 0;
+  while (written < content.size()) {
+    ssize_t n = write(fd, content.data() + written, content.size() - written);
+    if (n < 0) {
+      if (errno == EAGAIN) {
+        continue;
+      }
+      return ErrNoToStatusWithFilename(errno, file_name);
+    }
+    written += n;
+  }
+  return absl::OkStatus();
+}
+
 enum class SetOrAppend { kSet, kAppend };
 
 absl::Status SetFileContentsOrAppend(const std::filesystem::path& file_name,
@@ -101,17 +120,9 @@ absl::Status SetFileContentsOrAppend(const std::filesystem::path& file_name,
     }
   }
 
-  ssize_t written = 0;
-  while (written < content.size()) {
-    ssize_t n = write(fd, content.data() + written, content.size() - written);
-    if (n < 0) {
-      if (errno == EAGAIN) {
-        continue;
-      }
-      close(fd);
-      return ErrNoToStatusWithFilename(errno, file_name);
-    }
-    written += n;
+  if (absl::Status status = WriteAll(fd, content, file_name); !status.ok()) {
+    close(fd);
+    return status;
   }
 
   if (close(fd) != 0) {
@@ -204,6 +215,42 @@ absl::Status SetFileContents(const std::filesystem::path& file_name,
   return SetFileContentsOrAppend(file_name, content, SetOrAppend::kSet);
 }
 
+absl::Status SetFileContentsStreaming(
+    const std::filesystem::path& file_name,
+    absl::FunctionRef<
+        absl::Status(absl::FunctionRef<absl::Status(std::string_view)>)>
+        producer) {
+  // Pieces smaller than this are coalesced into writes of about this size.
+  constexpr int64_t kChunkSize = int64_t{1} << 20;
+
+  int fd = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                0664);
+  if (fd == -1) {
+    return ErrNoToStatusWithFilename(errno, file_name);
+  }
+  std::string buffer;
+  buffer.reserve(kChunkSize);
+  auto append = [&](std::string_view piece) -> absl::Status {
+    if (static_cast<int64_t>(buffer.size() + piece.size()) > kChunkSize) {
+      XLS_RETURN_IF_ERROR(WriteAll(fd, buffer, file_name));
+      buffer.clear();
+    }
+    if (static_cast<int64_t>(piece.size()) >= kChunkSize) {
+      return WriteAll(fd, piece, file_name);
+    }
+    buffer.append(piece);
+    return absl::OkStatus();
+  };
+  absl::Status status = producer(append);
+  if (status.ok()) {
+    status = WriteAll(fd, buffer, file_name);
+  }
+  if (close(fd) != 0 && status.ok()) {
+    return ErrNoToStatusWithFilename(errno, file_name);
+  }
+  return status;
+}
+
 absl::Status AppendStringToFile(const std::filesystem::path& file_name,
                                 std::string_view content) {
   return SetFileContentsOrAppend(file_name, content, SetOrAppend::kAppend);
@@ -25,6 +25,7 @@
 
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "google/protobuf/message.h"
 
@@ -98,6 +99,19 @@ absl::StatusOr<std::string> GetFileContents(
 absl::Status SetFileContents(const std::filesystem::path& file_name,
                              std::string_view content);
 
+// Writes the content produced by `producer` into the file file_name,
+// overwriting any existing content. `producer` is passed a function which
+// appends a piece of the content; pieces are buffered and written in chunks
+// so the entire content need never be held in memory. Returns the first error
+// from writing or from `producer`.
+//
+// WARNING: The file update is NOT guaranteed to be atomic.
+absl::Status SetFileContentsStreaming(
+    const std::filesystem::path& file_name,
+    absl::FunctionRef<
+        absl::Status(absl::FunctionRef<absl::Status(std::string_view)>)>
+        producer);
+
 // Writes the contents of data into the file file_name, appending to any
 // existing content.
 //
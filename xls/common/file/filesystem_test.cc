@@ -20,17 +20,21 @@
 #include <fstream>
 #include <ios>
 #include <string>
+#include <string_view>
 #include <system_error>  // NOLINT(build/c++11)
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/file/filesystem_test.pb.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 
 namespace xls {
 namespace {
@@ -293,6 +297,45 @@ TEST(FilesystemTest, AppendStringToFileAppendsToFile) {
   EXPECT_THAT(read_contents, IsOkAndHolds(Eq("hello there")));
 }
 
+TEST(FilesystemTest, SetFileContentsStreamingWritesAllPieces) {
+  absl::StatusOr<TempFile> temp_file = TempFile::CreateWithContent("old");
+  XLS_ASSERT_OK(temp_file);
+
+  // Mix small pieces with one larger than the internal buffer.
+  std::string large(3 << 20, 'x');
+  std::string expected;
+  XLS_EXPECT_OK(SetFileContentsStreaming(
+      temp_file->path(),
+      [&](absl::FunctionRef<absl::Status(std::string_view)> append)
+          -> absl::Status {
+        for (int i = 0; i < 1000; ++i) {
+          std::string piece = absl::StrCat(i, ",");
+          expected += piece;
+          XLS_RETURN_IF_ERROR(append(piece));
+        }
+        expected += large;
+        XLS_RETURN_IF_ERROR(append(large));
+        expected += "end";
+        return append("end");
+      }));
+
+  EXPECT_THAT(GetFileContents(temp_file->path()), IsOkAndHolds(Eq(expected)));
+}
+
+TEST(FilesystemTest, SetFileContentsStreamingReturnsProducerError) {
+  absl::StatusOr<TempDirectory> temp_dir = TempDirectory::Create();
+  XLS_ASSERT_OK(temp_dir);
+  EXPECT_THAT(
+      SetFileContentsStreaming(
+          temp_dir->path() / "file",
+          [](absl::FunctionRef<absl::Status(std::string_view)> append)
+              -> absl::Status {
+            XLS_RETURN_IF_ERROR(append("partial"));
+            return absl::InternalError("producer failed");
+          }),
+      StatusIs(absl::StatusCode::kInternal, HasSubstr("producer failed")));
+}
+
 TEST(FilesystemTest, ParseTextProtoFileOfNonexistingFileFails) {
   absl::StatusOr<TempDirectory> temp_dir = TempDirectory::Create();
   XLS_ASSERT_OK(temp_dir);
@@ -62,7 +62,12 @@ absl::StatusOr<TempDirectory> TempDirectory::Create() {
     return absl::InternalError("Failed to get temporary directory path.");
   }
 
-  std::string temp_dir = (global_temp_dir / "temp_directory_XXXXXX").string();
+  return CreateInDirectory(global_temp_dir);
+}
+
+absl::StatusOr<TempDirectory> TempDirectory::CreateInDirectory(
+    const std::filesystem::path& directory) {
+  std::string temp_dir = (directory / "temp_directory_XXXXXX").string();
   if (mkdtemp(temp_dir.data()) == nullptr) {
     return absl::UnavailableError(
         absl::StrCat("Failed to create temporary directory ", temp_dir));
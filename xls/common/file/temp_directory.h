@@ -31,6 +31,10 @@ class TempDirectory {
   ~TempDirectory();
 
   static absl::StatusOr<TempDirectory> Create();
+  // Create a temporary directory inside the given existing directory, e.g. a
+  // tmpfs mount such as /dev/shm.
+  static absl::StatusOr<TempDirectory> CreateInDirectory(
+      const std::filesystem::path& directory);
 
   const std::filesystem::path& path() const;
 
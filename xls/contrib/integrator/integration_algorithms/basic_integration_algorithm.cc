@@ -17,10 +17,13 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/contrib/integrator/integration_algorithms/integration_algorithm.h"
@@ -36,6 +39,83 @@ void BasicIntegrationAlgorithm::EnqueueNodeIfReady(Node* node) {
       integration_function_->AllOperandsHaveMapping(node)) {
     ready_nodes_.push_back(node);
     queued_nodes_.insert(node);
+    ready_nodes_by_key_[IntegrationFunction::MergeCandidateKey(node)].insert(
+        node);
+  }
+}
+
+absl::StatusOr<BasicIntegrationAlgorithm::BasicIntegrationMove>
+BasicIntegrationAlgorithm::GetBestMove(std::list<Node*>::iterator node_itr) {
+  Node* node = *node_itr;
+  if (auto cached = best_move_cache_.find(node);
+      cached != best_move_cache_.end()) {
+    return cached->second;
+  }
+
+  // Check insertion cost.
+  XLS_ASSIGN_OR_RETURN(int64_t insert_cost,
+                       integration_function_->GetInsertNodeCost(node));
+  BasicIntegrationMove move = MakeInsertMove(node_itr, insert_cost);
+  XLS_ASSIGN_OR_RETURN(std::vector<Node*> integrated_operands,
+                       integration_function_->GetIntegratedOperands(node));
+  for (Node* operand : integrated_operands) {
+    cache_dependents_[operand].insert(node);
+  }
+
+  // Check merge cost.
+  for (Node* candidate : integration_function_->GetMergeCandidates(node)) {
+    cache_dependents_[candidate].insert(node);
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<int64_t> merge_cost,
+        integration_function_->GetMergeNodesCost(node, candidate));
+    if (merge_cost.has_value() && merge_cost.value() < move.cost) {
+      move = MakeMergeMove(node_itr, candidate, merge_cost.value());
+    }
+  }
+
+  best_move_cache_.insert({node, move});
+  return move;
+}
+
+void BasicIntegrationAlgorithm::InvalidateCachedMoves(
+    const BasicIntegrationMove& move, absl::Span<Node* const> targets) {
+  // A merge or insert rewires the targets' operands (adding or modifying
+  // muxes), which changes the cost of merging with anything that reads
+  // those muxes or with any node the muxes select between.
+  std::vector<Node*> touched(targets.begin(), targets.end());
+  if (move.merge_node != nullptr) {
+    touched.push_back(move.merge_node);
+  }
+  for (Node* target : targets) {
+    for (Node* operand : target->operands()) {
+      touched.push_back(operand);
+      touched.insert(touched.end(), operand->users().begin(),
+                     operand->users().end());
+      touched.insert(touched.end(), operand->operands().begin(),
+                     operand->operands().end());
+    }
+  }
+  for (Node* node : touched) {
+    auto dependents = cache_dependents_.find(node);
+    if (dependents == cache_dependents_.end()) {
+      continue;
+    }
+    for (Node* dependent : dependents->second) {
+      best_move_cache_.erase(dependent);
+    }
+    cache_dependents_.erase(dependents);
+  }
+
+  // The targets are new merge candidates for ready nodes with the same key.
+  for (Node* target : targets) {
+    auto bucket = ready_nodes_by_key_.find(
+        IntegrationFunction::MergeCandidateKey(target));
+    if (bucket == ready_nodes_by_key_.end()) {
+      continue;
+    }
+    for (Node* ready_node : bucket->second) {
+      best_move_cache_.erase(ready_node);
+    }
   }
 }
 
@@ -60,45 +140,27 @@ BasicIntegrationAlgorithm::Run() {
     std::optional<BasicIntegrationMove> move;
     for (auto node_itr = ready_nodes_.begin(); node_itr != ready_nodes_.end();
          ++node_itr) {
-      // Check insertion cost.
-      XLS_ASSIGN_OR_RETURN(int64_t insert_cost,
-                           integration_function_->GetInsertNodeCost(*node_itr));
-      if (!move.has_value() || insert_cost < move.value().cost) {
-        move = MakeInsertMove(node_itr, insert_cost);
-      }
-
-      // Check merge cost.
-      for (Node* internal_node : integration_function_->function()->nodes()) {
-        // TODO(jbaileyhandle): Relax this requirement so that
-        // it only applies to integration-generated muxes.
-        if (!integration_function_->IsMappingTarget(internal_node)) {
-          continue;
-        }
-
-        // Check if mergeable
-        XLS_ASSIGN_OR_RETURN(
-            std::optional<int64_t> merge_cost,
-            integration_function_->GetMergeNodesCost(*node_itr, internal_node));
-        if (!merge_cost.has_value()) {
-          continue;
-        }
-
-        // Check if lowest cost.
-        XLS_RET_CHECK(move.has_value());
-        if (merge_cost < move.value().cost) {
-          move = MakeMergeMove(node_itr, internal_node, merge_cost.value());
-        }
+      XLS_ASSIGN_OR_RETURN(BasicIntegrationMove node_move,
+                           GetBestMove(node_itr));
+      if (!move.has_value() || node_move.cost < move.value().cost) {
+        move = node_move;
       }
     }
 
     // Execute lowest-cost move.
     XLS_RET_CHECK(move.has_value());
-    XLS_RETURN_IF_ERROR(
-        ExecuteMove(integration_function_.get(), move.value()).status());
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<Node*> targets,
+        ExecuteMove(integration_function_.get(), move.value()));
+    InvalidateCachedMoves(move.value(), targets);
 
     // Update ready_nodes_.
+    Node* moved_node = move.value().node;
     ready_nodes_.erase(move.value().node_itr);
-    for (Node* user : move.value().node->users()) {
+    best_move_cache_.erase(moved_node);
+    ready_nodes_by_key_[IntegrationFunction::MergeCandidateKey(moved_node)]
+        .erase(moved_node);
+    for (Node* user : moved_node->users()) {
       EnqueueNodeIfReady(user);
     }
   }
@@ -19,7 +19,9 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -37,6 +39,11 @@ namespace xls {
 // At each step, adds the eligible node for which the cost of adding it to
 // the function (either by inserting or merging with any integeration function
 // node) is the lowest.
+//
+// Only integration function nodes returned by
+// IntegrationFunction::GetMergeCandidates are considered for merges, and the
+// best move for each eligible node is cached until a move touches a part of
+// the integration function that the cached cost was computed from.
 class BasicIntegrationAlgorithm
     : public IntegrationAlgorithm<BasicIntegrationAlgorithm> {
  public:
@@ -94,6 +101,16 @@ class BasicIntegrationAlgorithm
   // and node has not already been queued for processing.
   void EnqueueNodeIfReady(Node* node);
 
+  // Returns the lowest-cost move for the ready node at 'node_itr', using the
+  // cached move if it is still valid.
+  absl::StatusOr<BasicIntegrationMove> GetBestMove(
+      std::list<Node*>::iterator node_itr);
+
+  // Drops the cached moves that may have been affected by executing 'move',
+  // which produced the integration nodes 'targets'.
+  void InvalidateCachedMoves(const BasicIntegrationMove& move,
+                             absl::Span<Node* const> targets);
+
   // Track nodes for which all operands are already mapped and
   // are ready to be added to the integration_function_
   std::list<Node*> ready_nodes_;
@@ -101,6 +118,19 @@ class BasicIntegrationAlgorithm
   // Track all nodes that have ever been inserted into 'ready_nodes_'.
   absl::flat_hash_set<Node*> queued_nodes_;
 
+  // Lowest-cost move for each ready node, as last computed.
+  absl::flat_hash_map<Node*, BasicIntegrationMove> best_move_cache_;
+
+  // Maps integration function nodes to the ready nodes whose cached move was
+  // computed from them. Entries may be stale, which only causes extra
+  // recomputation.
+  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> cache_dependents_;
+
+  // Ready nodes bucketed by IntegrationFunction::MergeCandidateKey, so that
+  // adding a new merge candidate invalidates the moves that could use it.
+  absl::flat_hash_map<std::string, absl::flat_hash_set<Node*>>
+      ready_nodes_by_key_;
+
   // Function combining the source functions.
   std::unique_ptr<IntegrationFunction> integration_function_;
 };
@@ -12,10 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
 #include "xls/contrib/integrator/integration_builder.h"
 #include "xls/contrib/integrator/integration_options.h"
@@ -23,6 +27,7 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/verifier.h"
@@ -412,5 +417,44 @@ TEST_F(BasicIntegrationAlgorithmTest, BasicIntegrationLiterals) {
                  m::Literal(UBits(2, 2)))));
 }
 
+TEST_F(BasicIntegrationAlgorithmTest, BasicIntegrationManyFunctions) {
+  constexpr int64_t kNumFunctions = 8;
+  constexpr int64_t kChainLength = 16;
+  auto p = CreatePackage();
+  FunctionBuilder fb("func_0", p.get());
+  auto x = fb.Param("x", p->GetBitsType(8));
+  auto y = fb.Param("y", p->GetBitsType(8));
+  BValue value = x;
+  for (int64_t i = 0; i < kChainLength; ++i) {
+    value = fb.Add(value, y);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_0, fb.Build());
+  std::vector<const Function*> functions = {func_0};
+  for (int64_t i = 1; i < kNumFunctions; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(Function * clone,
+                             func_0->Clone(absl::StrCat("func_", i)));
+    functions.push_back(clone);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IntegrationBuilder> builder,
+      IntegrationBuilder::Build(
+          functions, IntegrationOptions()
+                         .algorithm(IntegrationOptions::Algorithm::
+                                        kBasicIntegrationAlgorithm)
+                         .area_model_name(
+                             "area_model_testing_2_point_5_mux_per_node")));
+
+  // Muxing operands is always cheaper than a second adder, so each level of
+  // the chain ends up sharing a single add.
+  int64_t add_count = 0;
+  for (Node* node : builder->integrated_function()->function()->nodes()) {
+    if (node->op() == Op::kAdd) {
+      ++add_count;
+    }
+  }
+  EXPECT_EQ(add_count, kChainLength);
+}
+
 }  // namespace
 }  // namespace xls
@@ -17,6 +17,8 @@
 #define XLS_CONTRIB_INTEGRATOR_INTEGRATION_OPTIONS_H_
 
 #include <iostream>
+#include <string>
+#include <string_view>
 
 namespace xls {
 
@@ -45,8 +47,17 @@ class IntegrationOptions {
     return unique_select_signal_per_mux_;
   }
 
+  // Name of the area model (see area_model/) used to score inserts and
+  // merges. If empty, a coarse built-in per-op cost table is used instead.
+  IntegrationOptions& area_model_name(std::string_view value) {
+    area_model_name_ = value;
+    return *this;
+  }
+  const std::string& area_model_name() const { return area_model_name_; }
+
  private:
   bool unique_select_signal_per_mux_ = false;
+  std::string area_model_name_;
   Algorithm algorithm_ = Algorithm::kBasicIntegrationAlgorithm;
 };
 
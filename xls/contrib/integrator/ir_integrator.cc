@@ -14,6 +14,7 @@
 
 #include "xls/contrib/integrator/ir_integrator.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -28,10 +29,12 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/contrib/integrator/area_model/area_estimator.h"
 #include "xls/contrib/integrator/integration_options.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/node.h"
@@ -50,6 +53,11 @@ IntegrationFunction::MakeIntegrationFunctionWithParamTuples(
   // WrapUnique.
   auto integration_function =
       absl::WrapUnique(new IntegrationFunction(package, options));
+  if (!options.area_model_name().empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        integration_function->area_estimator_,
+        integrator::GetAreaEstimatorByName(options.area_model_name()));
+  }
 
   // Create ir function.
   integration_function->function_ =
@@ -149,16 +157,47 @@ absl::Status IntegrationFunction::SetNodeMapping(const Node* source,
 
     // No nodes map to source anymore.
     integrated_node_to_original_nodes_map_.erase(source);
+    merge_candidate_buckets_[MergeCandidateKey(source)].erase(
+        const_cast<Node*>(source));
 
     // 'source' is an external node.
   } else {
     original_node_to_integrated_node_map_[source] = map_target;
     integrated_node_to_original_nodes_map_[map_target].insert(source);
   }
+  merge_candidate_buckets_[MergeCandidateKey(map_target)].insert(map_target);
 
   return absl::OkStatus();
 }
 
+std::string IntegrationFunction::MergeCandidateKey(const Node* node) {
+  return absl::StrCat(
+      OpToString(node->op()), ":", node->GetType()->ToString(), "(",
+      absl::StrJoin(node->operands(), ",",
+                    [](std::string* out, const Node* operand) {
+                      absl::StrAppend(out, operand->GetType()->ToString());
+                    }),
+      ")");
+}
+
+std::vector<Node*> IntegrationFunction::GetMergeCandidates(
+    const Node* node) const {
+  // Mirrors the checks in Node::IsDefinitelyEqualTo, which MergeNodesBackend
+  // requires of distinct nodes.
+  if (OpIsSideEffecting(node->op())) {
+    return {};
+  }
+  auto bucket_itr = merge_candidate_buckets_.find(MergeCandidateKey(node));
+  if (bucket_itr == merge_candidate_buckets_.end()) {
+    return {};
+  }
+  std::vector<Node*> candidates(bucket_itr->second.begin(),
+                                bucket_itr->second.end());
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Node* a, const Node* b) { return a->id() < b->id(); });
+  return candidates;
+}
+
 absl::StatusOr<Node*> IntegrationFunction::GetNodeMapping(
     const Node* original) const {
   XLS_RET_CHECK(!IntegrationFunctionOwnsNode(original));
@@ -666,20 +705,25 @@ absl::StatusOr<std::optional<int64_t>> IntegrationFunction::GetMergeNodesCost(
 
   // Score.
   int64_t cost = 0;
-  auto tabulate_node_elimination_cost = [this, &cost](const Node* node) {
+  auto tabulate_node_elimination_cost =
+      [this, &cost](const Node* node) -> absl::Status {
     if (IntegrationFunctionOwnsNode(node)) {
-      cost -= GetNodeCost(node);
+      XLS_ASSIGN_OR_RETURN(int64_t node_cost, GetNodeCost(node));
+      cost -= node_cost;
     }
+    return absl::OkStatus();
   };
-  tabulate_node_elimination_cost(node_a);
-  tabulate_node_elimination_cost(node_b);
+  XLS_RETURN_IF_ERROR(tabulate_node_elimination_cost(node_a));
+  XLS_RETURN_IF_ERROR(tabulate_node_elimination_cost(node_b));
   for (UnifiedNode& unified_node : merge_result.changed_muxes) {
     if (unified_node.change == UnificationChange::kNewMuxAdded) {
-      cost += GetNodeCost(unified_node.node);
+      XLS_ASSIGN_OR_RETURN(int64_t mux_cost, GetNodeCost(unified_node.node));
+      cost += mux_cost;
     }
   }
   for (Node* new_node : merge_result.other_added_nodes) {
-    cost += GetNodeCost(new_node);
+    XLS_ASSIGN_OR_RETURN(int64_t node_cost, GetNodeCost(new_node));
+    cost += node_cost;
   }
 
   // Cleanup.
@@ -709,8 +753,12 @@ absl::StatusOr<std::optional<int64_t>> IntegrationFunction::GetMergeNodesCost(
   return cost;
 }
 
-int64_t IntegrationFunction::GetNodeCost(const Node* node) const {
-  // TODO: Actual estimate.
+absl::StatusOr<int64_t> IntegrationFunction::GetNodeCost(
+    const Node* node) const {
+  if (area_estimator_ != nullptr) {
+    // Estimators take a mutable node but do not modify it.
+    return area_estimator_->GetOperationArea(const_cast<Node*>(node));
+  }
   switch (node->op()) {
     case Op::kArray:
     case Op::kConcat:
@@ -30,6 +30,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/contrib/integrator/area_model/area_estimator.h"
 #include "xls/contrib/integrator/integration_options.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
@@ -179,13 +180,24 @@ class IntegrationFunction {
   // Returns true if other nodes map to 'node'
   bool IsMappingTarget(const Node* node) const;
 
+  // Returns the mapping targets that 'node' could possibly be merged with,
+  // ordered by node id. Only nodes with the same op, result type and operand
+  // types are returned, so callers need not scan the whole integration
+  // function when searching for merges.
+  std::vector<Node*> GetMergeCandidates(const Node* node) const;
+
+  // Key under which mapping targets are bucketed for GetMergeCandidates.
+  // Nodes with different keys can never be merged.
+  static std::string MergeCandidateKey(const Node* node);
+
   // Returns true if 'node' is in the integrated function.
   bool IntegrationFunctionOwnsNode(const Node* node) const {
     return function_.get() == node->function_base();
   }
 
-  // Returns an estimate of the (gate count? area?) cost of a node.
-  int64_t GetNodeCost(const Node* node) const;
+  // Returns an estimate of the area cost of a node. Uses the area model named
+  // in the IntegrationOptions if there is one.
+  absl::StatusOr<int64_t> GetNodeCost(const Node* node) const;
 
  private:
   IntegrationFunction(Package* package, const IntegrationOptions& options)
@@ -274,6 +286,11 @@ class IntegrationFunction {
   absl::node_hash_map<const Node*, absl::flat_hash_set<const Node*>>
       integrated_node_to_original_nodes_map_;
 
+  // Mapping targets bucketed by MergeCandidateKey. Kept up to date by
+  // SetNodeMapping.
+  absl::flat_hash_map<std::string, absl::flat_hash_set<Node*>>
+      merge_candidate_buckets_;
+
   // Track which node-pairs have an associated mux.
   absl::flat_hash_map<std::pair<const Node*, const Node*>, Node*>
       node_pair_to_mux_;
@@ -314,6 +331,9 @@ class IntegrationFunction {
   std::unique_ptr<Function> function_;
   Package* package_;
   const IntegrationOptions integration_options_;
+
+  // Area model used by GetNodeCost, if one was requested.
+  std::unique_ptr<integrator::AreaEstimator> area_estimator_;
 };
 
 }  // namespace xls
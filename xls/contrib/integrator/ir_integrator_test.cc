@@ -1447,7 +1447,82 @@ TEST_F(IntegratorTest, GetNodeCost) {
   Node* add_node = func_a->return_value();
   XLS_ASSERT_OK_AND_ASSIGN(float cost,
                            integration->GetInsertNodeCost(add_node));
-  EXPECT_EQ(cost, integration->GetNodeCost(add_node));
+  EXPECT_EQ(cost, integration->GetNodeCost(add_node).value());
+}
+
+TEST_F(IntegratorTest, GetNodeCostAreaModel) {
+  auto p = CreatePackage();
+  FunctionBuilder fb_a("func_a", p.get());
+  auto a1 = fb_a.Param("a1", p->GetBitsType(2));
+  auto a2 = fb_a.Param("a2", p->GetBitsType(2));
+  fb_a.Add(a1, a2);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_a, fb_a.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IntegrationFunction> integration,
+      IntegrationFunction::MakeIntegrationFunctionWithParamTuples(
+          p.get(), {func_a},
+          IntegrationOptions().area_model_name(
+              "area_model_testing_2_point_5_mux_per_node")));
+
+  Node* add_node = func_a->return_value();
+  EXPECT_THAT(integration->GetNodeCost(add_node), IsOkAndHolds(5));
+  EXPECT_THAT(integration->GetInsertNodeCost(add_node), IsOkAndHolds(5));
+}
+
+TEST_F(IntegratorTest, GetNodeCostUnknownAreaModel) {
+  auto p = CreatePackage();
+  FunctionBuilder fb_a("func_a", p.get());
+  fb_a.Param("a1", p->GetBitsType(2));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_a, fb_a.Build());
+
+  EXPECT_FALSE(IntegrationFunction::MakeIntegrationFunctionWithParamTuples(
+                   p.get(), {func_a},
+                   IntegrationOptions().area_model_name("no_such_model"))
+                   .ok());
+}
+
+TEST_F(IntegratorTest, GetMergeCandidates) {
+  auto p = CreatePackage();
+  FunctionBuilder fb_a("func_a", p.get());
+  auto a1 = fb_a.Param("a1", p->GetBitsType(2));
+  auto a2 = fb_a.Param("a2", p->GetBitsType(2));
+  fb_a.Add(a1, a2, SourceInfo(), "a_add");
+  fb_a.Subtract(a1, a2, SourceInfo(), "a_sub");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_a, fb_a.Build());
+
+  FunctionBuilder fb_b("func_b", p.get());
+  auto b1 = fb_b.Param("b1", p->GetBitsType(2));
+  auto b2 = fb_b.Param("b2", p->GetBitsType(2));
+  auto b3 = fb_b.Param("b3", p->GetBitsType(3));
+  fb_b.Add(b1, b2, SourceInfo(), "b_add");
+  fb_b.Add(b3, b3, SourceInfo(), "b_wide_add");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_b, fb_b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IntegrationFunction> integration,
+      IntegrationFunction::MakeIntegrationFunctionWithParamTuples(
+          p.get(), {func_a, func_b}));
+  Node* a_add = FindNode("a_add", func_a);
+  Node* a_sub = FindNode("a_sub", func_a);
+  Node* b_add = FindNode("b_add", func_b);
+  Node* b_wide_add = FindNode("b_wide_add", func_b);
+
+  EXPECT_THAT(integration->GetMergeCandidates(b_add), ElementsAre());
+  XLS_ASSERT_OK_AND_ASSIGN(Node * a_add_target, integration->InsertNode(a_add));
+  XLS_ASSERT_OK(integration->InsertNode(a_sub).status());
+
+  // Only the add with matching operand types is a candidate.
+  EXPECT_THAT(integration->GetMergeCandidates(b_add),
+              ElementsAre(a_add_target));
+  EXPECT_THAT(integration->GetMergeCandidates(b_wide_add), ElementsAre());
+
+  // The merged node replaces the original target in its bucket.
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Node*> merged,
+                           integration->MergeNodes(b_add, a_add_target));
+  ASSERT_EQ(merged.size(), 1);
+  EXPECT_THAT(integration->GetMergeCandidates(a_add),
+              ElementsAre(merged.front()));
 }
 
 TEST_F(IntegratorTest, DeUnifyIntegrationNodesExternalNode) {
@@ -2099,8 +2174,8 @@ TEST_F(IntegratorTest, MergeCostExternalExternalTwoMux) {
 
   // Check cost.
   EXPECT_TRUE(optional_cost.has_value());
-  float expected_cost = integration->GetNodeCost(a_add_node) +
-                        2 * integration->GetNodeCost(ref_mux_node);
+  float expected_cost = integration->GetNodeCost(a_add_node).value() +
+                        2 * integration->GetNodeCost(ref_mux_node).value();
   EXPECT_FLOAT_EQ(optional_cost.value(), expected_cost);
 
   // Reverse order of merged nodes.
@@ -2189,7 +2264,7 @@ TEST_F(IntegratorTest, MergeCostInternalExternalOneMux) {
 
   // Check cost.
   EXPECT_TRUE(optional_cost.has_value());
-  float expected_cost = integration->GetNodeCost(ref_mux_node);
+  float expected_cost = integration->GetNodeCost(ref_mux_node).value();
   EXPECT_FLOAT_EQ(optional_cost.value(), expected_cost);
 
   // Reverse order of merged nodes.
@@ -2281,8 +2356,9 @@ TEST_F(IntegratorTest, MergeCostGlobalMuxSelect) {
 
   // Check cost. One 'add' and one new mux added.
   EXPECT_TRUE(optional_cost.has_value());
-  float expected_cost = integration->GetNodeCost(ref_3_input_mux_node) +
-                        integration->GetNodeCost(a_add);
+  float expected_cost =
+      integration->GetNodeCost(ref_3_input_mux_node).value() +
+      integration->GetNodeCost(a_add).value();
   EXPECT_FLOAT_EQ(optional_cost.value(), expected_cost);
 
   // Reverse order of merged nodes.
@@ -2306,7 +2382,7 @@ TEST_F(IntegratorTest, MergeCostGlobalMuxSelect) {
 
   // Check cost. One mux added, one mux modified (no cost).
   EXPECT_TRUE(optional_cost.has_value());
-  expected_cost = integration->GetNodeCost(ref_3_input_mux_node);
+  expected_cost = integration->GetNodeCost(ref_3_input_mux_node).value();
   EXPECT_FLOAT_EQ(optional_cost.value(), expected_cost);
   EXPECT_EQ(modified_node_count, integration->function()->node_count());
 }
@@ -1362,8 +1362,8 @@ LogicalResult setTop(Operation* op, std::string_view name, Package* package) {
 }
 }  // namespace
 
-LogicalResult MlirXlsToXlsTranslate(Operation* op, llvm::raw_ostream& output,
-                                    MlirXlsToXlsTranslateOptions options) {
+FailureOr<std::unique_ptr<Package>> MlirXlsToXlsPackage(
+    Operation* op, MlirXlsToXlsTranslateOptions options) {
   DslxPackageCache maybe_cache;
   if (options.dslx_cache == nullptr) {
     options.dslx_cache = &maybe_cache;
@@ -1399,6 +1399,15 @@ LogicalResult MlirXlsToXlsTranslate(Operation* op, llvm::raw_ostream& output,
       return failure();
     }
   }
+  return package;
+}
+
+LogicalResult MlirXlsToXlsTranslate(Operation* op, llvm::raw_ostream& output,
+                                    MlirXlsToXlsTranslateOptions options) {
+  auto package = MlirXlsToXlsPackage(op, options);
+  if (failed(package)) {
+    return failure();
+  }
 
   if (!options.generate_verilog) {
     std::string out = (*package)->DumpIr();
@@ -24,6 +24,7 @@
 #include "absl/status/statusor.h"
 #include "llvm/include/llvm/ADT/StringRef.h"
 #include "mlir/include/mlir/Support/LLVM.h"
+#include "mlir/include/mlir/Support/LogicalResult.h"
 #include "xls/tools/codegen_flags.h"
 #include "xls/tools/codegen_flags.pb.h"
 #include "xls/tools/scheduling_options_flags.h"
@@ -89,6 +90,13 @@ struct MlirXlsToXlsTranslateOptions {
       DieUnlessOk(::xls::GetSchedulingOptionsFlagsProto());
 };
 
+// Translates an operation with XLS dialect to an in-memory XLS package,
+// optionally running the XLS optimizer on it. This avoids serializing the
+// package to text and re-parsing it when the caller goes on to optimize or
+// codegen the result itself, which dominates the cost for large modules.
+FailureOr<std::unique_ptr<::xls::Package>> MlirXlsToXlsPackage(
+    Operation* op, MlirXlsToXlsTranslateOptions options = {});
+
 // Translates an operation with XLS dialect to DSLX.
 LogicalResult MlirXlsToXlsTranslate(Operation* op, llvm::raw_ostream& output,
                                     MlirXlsToXlsTranslateOptions options = {});
@@ -24,6 +24,7 @@
 
 #include "absl/algorithm/container.h"
 #include "llvm/include/llvm/ADT/ArrayRef.h"
+#include "llvm/include/llvm/ADT/DenseSet.h"
 #include "llvm/include/llvm/ADT/STLExtras.h"
 #include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/ADT/StringRef.h"
@@ -42,11 +43,14 @@
 #include "mlir/include/mlir/IR/MLIRContext.h"
 #include "mlir/include/mlir/IR/OpDefinition.h"
 #include "mlir/include/mlir/IR/PatternMatch.h"
+#include "mlir/include/mlir/IR/SymbolTable.h"
+#include "mlir/include/mlir/IR/Threading.h"
 #include "mlir/include/mlir/IR/TypeUtilities.h"
 #include "mlir/include/mlir/IR/ValueRange.h"
 #include "mlir/include/mlir/IR/Visitors.h"
 #include "mlir/include/mlir/Interfaces/ControlFlowInterfaces.h"
 #include "mlir/include/mlir/Pass/Pass.h"  // IWYU pragma: keep
+#include "mlir/include/mlir/Rewrite/FrozenRewritePatternSet.h"
 #include "mlir/include/mlir/Support/LLVM.h"
 #include "mlir/include/mlir/Support/LogicalResult.h"
 #include "mlir/include/mlir/Support/TypeID.h"
@@ -784,14 +788,18 @@ LogicalResult convertVectorizedCall(mlir::Operation* op,
 class LegalizeVectorizedCallPattern
     : public OpConversionPattern<VectorizedCallOp> {
  public:
-  using OpConversionPattern::OpConversionPattern;
+  // `symbolTable` is built before conversion starts; regions are converted
+  // concurrently, so the module must not be scanned for symbols here.
+  LegalizeVectorizedCallPattern(const TypeConverter& typeConverter,
+                                MLIRContext* context,
+                                const SymbolTable& symbolTable)
+      : OpConversionPattern(typeConverter, context),
+        symbolTable(symbolTable) {}
 
   LogicalResult matchAndRewrite(
       VectorizedCallOp op, OpAdaptor adaptor,
       ConversionPatternRewriter& rewriter) const override {
-    auto callee =
-        op->getParentOfType<mlir::ModuleOp>().lookupSymbol<mlir::func::FuncOp>(
-            adaptor.getCallee());
+    auto callee = symbolTable.lookup<mlir::func::FuncOp>(adaptor.getCallee());
     if (!callee) {
       return failure();
     }
@@ -799,6 +807,9 @@ class LegalizeVectorizedCallPattern
     return convertVectorizedCall<func::CallOp>(op, adaptor.getOperands(),
                                                *typeConverter, rewriter);
   }
+
+ private:
+  const SymbolTable& symbolTable;  // NOLINT
 };
 
 class LegalizeCallDslxPattern : public OpConversionPattern<CallDslxOp> {
@@ -816,34 +827,7 @@ class LegalizeCallDslxPattern : public OpConversionPattern<CallDslxOp> {
 class ScalarizePass : public impl::ScalarizePassBase<ScalarizePass> {
  public:
   void runOnOperation() override {
-    getOperation()->walk([&](Operation* op) {
-      if (auto interface = dyn_cast<XlsRegionOpInterface>(op)) {
-        if (interface.isSupportedRegion()) {
-          runOnOperation(interface);
-          return WalkResult::skip();
-        }
-      } else if (auto chanOp = dyn_cast<ChanOp>(op)) {
-        runOnOperation(chanOp);
-        return WalkResult::skip();
-      }
-      return WalkResult::advance();
-    });
-  }
-
-  void runOnOperation(ChanOp operation) {
-    TensorTypeConverter typeConverter;
-    ConversionTarget target(getContext());
-    target.addDynamicallyLegalOp<ChanOp>(
-        [&](ChanOp op) { return typeConverter.isLegal(op.getType()); });
-    RewritePatternSet patterns(&getContext());
-    patterns.add<LegalizeChanOpPattern>(typeConverter, &getContext());
-    if (failed(mlir::applyFullConversion(operation, target,
-                                         std::move(patterns)))) {
-      signalPassFailure();
-    }
-  }
-
-  void runOnOperation(XlsRegionOpInterface operation) {
+    SymbolTable symbolTable(getOperation());
     TensorTypeConverter typeConverter;
     ConversionTarget target(getContext());
     // TODO(jpienaar,jmolloy): This target definition seems to broad: it allows
@@ -877,13 +861,53 @@ class ScalarizePass : public impl::ScalarizePassBase<ScalarizePass> {
         LegalizeTensorFromElementsPattern,
         LegalizeTensorInsertSingleSlicePattern,
         LegalizeTensorInsertPattern,
-        LegalizeVectorizedCallPattern,
         ReturnLikeOpPattern
         // clang-format on
         >(typeConverter, &getContext());
-    operation.addSignatureConversionPatterns(patterns, typeConverter, target);
+    patterns.add<LegalizeVectorizedCallPattern>(typeConverter, &getContext(),
+                                                symbolTable);
+    DenseSet<OperationName> seen;
+    getOperation()->walk([&](XlsRegionOpInterface op) {
+      if (op.isSupportedRegion() && seen.insert(op->getName()).second) {
+        op.addSignatureConversionPatterns(patterns, typeConverter, target);
+      }
+    });
     mlir::populateReturnOpTypeConversionPattern(patterns, typeConverter);
     mlir::populateCallOpTypeConversionPattern(patterns, typeConverter);
+    FrozenRewritePatternSet frozenPatterns(std::move(patterns));
+
+    // Channels are rewritten in place in the module body, so they are
+    // converted serially; regions are independent and converted in parallel.
+    SmallVector<XlsRegionOpInterface> regions;
+    getOperation()->walk([&](Operation* op) {
+      if (auto interface = dyn_cast<XlsRegionOpInterface>(op)) {
+        if (interface.isSupportedRegion()) {
+          regions.push_back(interface);
+          return WalkResult::skip();
+        }
+      } else if (auto chanOp = dyn_cast<ChanOp>(op)) {
+        runOnOperation(chanOp);
+        return WalkResult::skip();
+      }
+      return WalkResult::advance();
+    });
+
+    mlir::parallelForEach(
+        &getContext(), regions, [&](XlsRegionOpInterface interface) {
+          if (failed(mlir::applyFullConversion(interface, target,
+                                               frozenPatterns))) {
+            signalPassFailure();
+          }
+        });
+  }
+
+  void runOnOperation(ChanOp operation) {
+    TensorTypeConverter typeConverter;
+    ConversionTarget target(getContext());
+    target.addDynamicallyLegalOp<ChanOp>(
+        [&](ChanOp op) { return typeConverter.isLegal(op.getType()); });
+    RewritePatternSet patterns(&getContext());
+    patterns.add<LegalizeChanOpPattern>(typeConverter, &getContext());
     if (failed(mlir::applyFullConversion(operation, target,
                                          std::move(patterns)))) {
       signalPassFailure();
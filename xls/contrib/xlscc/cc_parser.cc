@@ -14,6 +14,10 @@
 
 #include "xls/contrib/xlscc/cc_parser.h"
 
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <limits>
@@ -21,6 +25,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -30,8 +35,10 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
 #include "clang/include/clang/AST/ASTConsumer.h"
@@ -54,7 +61,9 @@
 #include "clang/include/clang/Basic/TokenKinds.h"
 #include "clang/include/clang/Frontend/CompilerInstance.h"
 #include "clang/include/clang/Frontend/FrontendAction.h"
+#include "clang/include/clang/Frontend/FrontendActions.h"
 #include "clang/include/clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/include/clang/Frontend/Utils.h"
 #include "clang/include/clang/Lex/PPCallbacks.h"
 #include "clang/include/clang/Lex/Pragma.h"
 #include "clang/include/clang/Lex/Preprocessor.h"
@@ -63,12 +72,17 @@
 #include "clang/include/clang/Sema/Sema.h"
 #include "clang/include/clang/Tooling/Tooling.h"
 #include "llvm/include/llvm/ADT/APInt.h"
+#include "llvm/include/llvm/ADT/ArrayRef.h"
 #include "llvm/include/llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/include/llvm/ADT/StringExtras.h"
 #include "llvm/include/llvm/Support/Casting.h"
+#include "llvm/include/llvm/Support/ErrorOr.h"
 #include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Support/SHA256.h"
 #include "llvm/include/llvm/Support/VirtualFileSystem.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/fileno.h"
@@ -147,6 +161,149 @@ std::optional<std::vector<clang::Token>> LexPragmaArgs(
   return toks;
 }
 
+constexpr std::string_view kPrecompiledHeaderCacheVersion = "xlscc-pch-v1";
+
+// In-memory header that the precompiled header is built from.
+constexpr std::string_view kPrecompiledHeaderSource = "/xls_pch.h";
+
+std::string Sha256Hex(std::string_view text) {
+  std::array<uint8_t, 32> digest = llvm::SHA256::hash(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(text.data()), text.size()));
+  return llvm::toHex(digest, /*LowerCase=*/true);
+}
+
+absl::StatusOr<std::string> ReadVfsFile(llvm::vfs::FileSystem& fs,
+                                        const std::string& path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      fs.getBufferForFile(path);
+  if (!buffer) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Unable to read `%s`: %s", path, buffer.getError().message()));
+  }
+  return std::string((*buffer)->getBuffer());
+}
+
+// A cache entry's manifest lists the digest and path of every file read to
+// build it, one per line. The entry is only reused if all of them are
+// unchanged.
+bool ManifestIsCurrent(std::string_view manifest, llvm::vfs::FileSystem& fs) {
+  for (std::string_view line :
+       absl::StrSplit(manifest, '\n', absl::SkipEmpty())) {
+    std::pair<std::string_view, std::string_view> digest_and_path =
+        absl::StrSplit(line, absl::MaxSplits(' ', 1));
+    absl::StatusOr<std::string> contents =
+        ReadVfsFile(fs, std::string(digest_and_path.second));
+    if (!contents.ok() || Sha256Hex(*contents) != digest_and_path.first) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class IncludedFilesCollector : public clang::DependencyCollector {
+ public:
+  bool needSystemDependencies() override { return true; }
+};
+
+// Builds a precompiled header, recording the files it reads.
+class PrecompileAction : public clang::GeneratePCHAction {
+ public:
+  explicit PrecompileAction(std::shared_ptr<IncludedFilesCollector> collector)
+      : collector_(std::move(collector)) {}
+
+  bool BeginSourceFileAction(clang::CompilerInstance& CI) override {
+    collector_->attachToPreprocessor(CI.getPreprocessor());
+    return clang::GeneratePCHAction::BeginSourceFileAction(CI);
+  }
+
+ private:
+  std::shared_ptr<IncludedFilesCollector> collector_;
+};
+
+// Writes to a uniquely named temporary file and renames it into place, so
+// that concurrent xlscc invocations never observe partial cache entries.
+absl::Status RenameIntoPlace(const std::filesystem::path& temp_path,
+                             const std::filesystem::path& path) {
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+    return absl::InternalError(absl::StrFormat(
+        "Unable to rename `%s` to `%s`", temp_path.string(), path.string()));
+  }
+  return absl::OkStatus();
+}
+
+// Returns the path of a precompiled header for `header`, parsed with the
+// given clang arguments, building it into `cache_dir` if there is no current
+// one there.
+absl::StatusOr<std::string> GetOrBuildPrecompiledHeader(
+    std::string_view header, const std::filesystem::path& cache_dir,
+    absl::Span<const std::string> clang_args,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> fs) {
+  XLS_ASSIGN_OR_RETURN(std::string header_contents,
+                       ReadVfsFile(*fs, std::string(header)));
+  const std::string key = Sha256Hex(absl::StrCat(
+      kPrecompiledHeaderCacheVersion, "\n", absl::StrJoin(clang_args, "\n"),
+      "\n", header, "\n", header_contents));
+  const std::filesystem::path pch_path = cache_dir / absl::StrCat(key, ".pch");
+  const std::filesystem::path manifest_path =
+      cache_dir / absl::StrCat(key, ".manifest");
+
+  absl::StatusOr<std::string> manifest = xls::GetFileContents(manifest_path);
+  if (manifest.ok() && std::filesystem::exists(pch_path) &&
+      ManifestIsCurrent(*manifest, *fs)) {
+    VLOG(1) << absl::StreamFormat("Using precompiled header `%s`",
+                                  pch_path.string());
+    return pch_path.string();
+  }
+
+  XLS_RETURN_IF_ERROR(xls::RecursivelyCreateDir(cache_dir));
+  static std::atomic<int64_t> temp_file_counter = 0;
+  const std::string temp_suffix = absl::StrFormat(
+      ".tmp.%d.%d", getpid(), temp_file_counter.fetch_add(1));
+  const std::filesystem::path temp_pch_path =
+      cache_dir / absl::StrCat(key, ".pch", temp_suffix);
+
+  std::vector<std::string> argv = {"binary",
+                                   "-x",
+                                   "c++-header",
+                                   std::string(kPrecompiledHeaderSource),
+                                   "-o",
+                                   temp_pch_path.string()};
+  argv.insert(argv.end(), clang_args.begin(), clang_args.end());
+
+  auto collector = std::make_shared<IncludedFilesCollector>();
+  llvm::IntrusiveRefCntPtr<clang::FileManager> files(
+      new clang::FileManager(clang::FileSystemOptions(), fs));
+  clang::tooling::ToolInvocation invocation(
+      argv, std::make_unique<PrecompileAction>(collector), files.get());
+  llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diag_opts =
+      new clang::DiagnosticOptions();
+  clang::TextDiagnosticPrinter diag_print(llvm::errs(), &*diag_opts);
+  invocation.setDiagnosticConsumer(&diag_print);
+  if (!invocation.run()) {
+    std::error_code ec;
+    std::filesystem::remove(temp_pch_path, ec);
+    return absl::InternalError(absl::StrFormat(
+        "Unable to build precompiled header for `%s`", header));
+  }
+
+  std::string new_manifest;
+  for (const std::string& path : collector->getDependencies()) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, ReadVfsFile(*fs, path));
+    absl::StrAppend(&new_manifest, Sha256Hex(contents), " ", path, "\n");
+  }
+  const std::filesystem::path temp_manifest_path =
+      cache_dir / absl::StrCat(key, ".manifest", temp_suffix);
+  XLS_RETURN_IF_ERROR(xls::SetFileContents(temp_manifest_path, new_manifest));
+  XLS_RETURN_IF_ERROR(RenameIntoPlace(temp_pch_path, pch_path));
+  XLS_RETURN_IF_ERROR(RenameIntoPlace(temp_manifest_path, manifest_path));
+  VLOG(1) << absl::StreamFormat("Built precompiled header `%s`",
+                                pch_path.string());
+  return pch_path.string();
+}
+
 }  // namespace
 
 class LibToolVisitor : public clang::RecursiveASTVisitor<LibToolVisitor> {
@@ -1274,7 +1431,6 @@ void LibToolThread::Run() {
   argv.emplace_back("-Wno-conversion");
   argv.emplace_back("-Wno-missing-template-arg-list-after-template-kw");
 
-  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
 
   std::unique_ptr<LibToolFrontendAction> libtool_action(
       new LibToolFrontendAction(parser_));
@@ -1373,13 +1529,21 @@ void __xlscc_top_class_instance_ref2() {
 )",
                                                                top_class_name_);
 
+  const std::string& precompiled_header = parser_.precompiled_header_;
+  const std::string prefix_include =
+      precompiled_header.empty()
+          ? ""
+          : absl::StrFormat("#include \"%s\"", precompiled_header);
+
   const std::string top_src =
       absl::StrFormat(R"(
 #include "/xls_builtin.h"
+%s
 #include "%s"
 %s
           )",
-                      source_filename_, top_class_inst_injection);
+                      prefix_include, source_filename_,
+                      top_class_inst_injection);
 
   mem_fs->addFile("/xls_top.cc", 0, llvm::MemoryBuffer::getMemBuffer(top_src));
 
@@ -1388,7 +1552,40 @@ void __xlscc_top_class_instance_ref2() {
 
   overlay_fs->pushOverlay(mem_fs);
 
-  libtool_files =
+  if (!precompiled_header.empty()) {
+    const std::string pch_src = absl::StrFormat(R"(
+#include "/xls_builtin.h"
+%s
+)",
+                                                prefix_include);
+    mem_fs->addFile(kPrecompiledHeaderSource, 0,
+                    llvm::MemoryBuffer::getMemBufferCopy(pch_src));
+
+    // Everything after the source file name, except the action.
+    std::vector<std::string> clang_args;
+    for (auto it = argv.begin() + 2; it != argv.end(); ++it) {
+      if (*it != "-fsyntax-only") {
+        clang_args.push_back(*it);
+      }
+    }
+    absl::StatusOr<std::string> pch_path = GetOrBuildPrecompiledHeader(
+        precompiled_header, parser_.precompiled_header_cache_dir_, clang_args,
+        overlay_fs);
+    if (pch_path.ok()) {
+      argv.emplace_back("-include-pch");
+      argv.push_back(*pch_path);
+      // The manifest check in GetOrBuildPrecompiledHeader() compares file
+      //  contents, so clang's timestamp based validation is not needed.
+      argv.emplace_back("-Xclang");
+      argv.emplace_back("-fno-validate-pch");
+    } else {
+      LOG(WARNING) << absl::StreamFormat(
+          "Parsing without a precompiled header: %s",
+          pch_path.status().ToString());
+    }
+  }
+
+  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files =
       new clang::FileManager(clang::FileSystemOptions(), overlay_fs);
 
   std::unique_ptr<clang::tooling::ToolInvocation> libtool_inv(
@@ -1411,6 +1608,12 @@ void LibToolFrontendAction::EndSourceFileAction() {
   parser_.libtool_wait_for_destruct_->Wait();
 }
 
+void CCParser::SetPrecompiledHeader(std::string_view header,
+                                    std::string_view cache_dir) {
+  precompiled_header_ = header;
+  precompiled_header_cache_dir_ = cache_dir;
+}
+
 absl::StatusOr<std::string> CCParser::GetEntryFunctionName() const {
   if (top_function_ == nullptr) {
     return absl::NotFoundError("No top function found");
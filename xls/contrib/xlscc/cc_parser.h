@@ -87,6 +87,14 @@ class CCParser {
   absl::Status SelectTop(std::string_view top_function_name,
                          std::string_view top_class_name = "");
 
+  // Includes `header` ahead of the scanned source, reusing a clang
+  //  precompiled header for it from `cache_dir`. The precompiled header is
+  //  rebuilt whenever the header, any file it includes, or the command line
+  //  changes. The header must have an include guard. Must be called before
+  //  ScanFile.
+  void SetPrecompiledHeader(std::string_view header,
+                            std::string_view cache_dir);
+
   // This function uses Clang to parse a source file and then walks its
   //  AST to discover global constructs. It will also scan the file
   //  and includes, recursively, for #pragma statements.
@@ -144,6 +152,8 @@ class CCParser {
   const clang::FunctionDecl* top_function_ = nullptr;
   std::string_view top_function_name_ = "";
   std::string_view top_class_name_ = "";
+  std::string precompiled_header_;
+  std::string precompiled_header_cache_dir_;
   const clang::VarDecl* xlscc_on_reset_ = nullptr;
 
   // For source location
@@ -84,6 +84,15 @@ ABSL_FLAG(std::vector<std::string>, defines, std::vector<std::string>(),
 ABSL_FLAG(std::vector<std::string>, include_dirs, std::vector<std::string>(),
           "Comma separated list of include directories to pass to clang");
 
+ABSL_FLAG(std::string, precompiled_header, "",
+          "Header, such as one including the synth_only headers, to include "
+          "ahead of the source file and parse only once into a clang "
+          "precompiled header. Requires --precompiled_header_cache_dir.");
+
+ABSL_FLAG(std::string, precompiled_header_cache_dir, "",
+          "Directory in which precompiled headers are cached across "
+          "invocations.");
+
 ABSL_FLAG(std::string, meta_out, "",
           "Path at which to output metadata protobuf");
 
@@ -127,6 +136,12 @@ ABSL_FLAG(int, warn_unroll_iters, 100,
 ABSL_FLAG(int, z3_rlimit, 100000L,
           "rlimit to set for z3 solver (eg for loop unrolling)");
 
+ABSL_FLAG(int, auto_loop_init_interval, 0,
+          "If positive, loops without an unroll or pipelining pragma are "
+          "unrolled when their trip count is small enough, and otherwise "
+          "pipelined at this initiation interval. Decisions are reported in "
+          "the metadata output.");
+
 ABSL_FLAG(xlscc::ChannelStrictnessMap, channel_strictness,
           xlscc::ChannelStrictnessMap(),
           "Comma separated map of channels to strictness modes");
@@ -196,6 +211,11 @@ static absl::Status Run(std::string_view cpp_path) {
       absl::GetFlag(FLAGS_warn_unroll_iters), absl::GetFlag(FLAGS_z3_rlimit),
       io_op_token_ordering);
 
+  if (absl::GetFlag(FLAGS_auto_loop_init_interval) > 0) {
+    translator.SetAutoLoopInitInterval(
+        absl::GetFlag(FLAGS_auto_loop_init_interval));
+  }
+
   const std::string block_pb_name = absl::GetFlag(FLAGS_block_pb);
 
   const std::string block_from_class_name =
@@ -250,6 +270,18 @@ static absl::Status Run(std::string_view cpp_path) {
     clang_argv.push_back(i);
   }
 
+  const std::string precompiled_header =
+      absl::GetFlag(FLAGS_precompiled_header);
+  if (!precompiled_header.empty()) {
+    const std::string cache_dir =
+        absl::GetFlag(FLAGS_precompiled_header_cache_dir);
+    if (cache_dir.empty()) {
+      return absl::InvalidArgumentError(
+          "--precompiled_header requires --precompiled_header_cache_dir");
+    }
+    translator.SetPrecompiledHeader(precompiled_header, cache_dir);
+  }
+
   std::cerr << "Parsing file '" << cpp_path << "' with clang..." << '\n';
   XLS_RETURN_IF_ERROR(translator.ScanFile(
       cpp_path, clang_argv.empty()
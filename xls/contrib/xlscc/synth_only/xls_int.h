@@ -163,6 +163,41 @@ class MultiplyWithSign<Width, true> {
   }
 };
 
+// Multiplies operands of the same signedness but possibly different widths
+//  into a result of a (wider) width, without first extending the operands.
+template <int WidthA, int WidthB, int ResultWidth, bool Signed>
+class MultiplyWidenWithSign {};
+
+template <int WidthA, int WidthB, int ResultWidth>
+class MultiplyWidenWithSign<WidthA, WidthB, ResultWidth, false> {
+ public:
+  inline static __xls_bits<ResultWidth> Operate(__xls_bits<WidthA> a,
+                                                __xls_bits<WidthB> b) {
+    __xls_bits<ResultWidth> ret;
+    asm("fn (fid)(a: bits[i], b: bits[c]) -> bits[d] { ret (aid): bits[d] "
+        "= umul(a, b, pos=(loc)) }"
+        : "=r"(ret)
+        : "i"(WidthA), "c"(WidthB), "d"(ResultWidth), "parama"(a),
+          "paramb"(b));
+    return ret;
+  }
+};
+
+template <int WidthA, int WidthB, int ResultWidth>
+class MultiplyWidenWithSign<WidthA, WidthB, ResultWidth, true> {
+ public:
+  inline static __xls_bits<ResultWidth> Operate(__xls_bits<WidthA> a,
+                                                __xls_bits<WidthB> b) {
+    __xls_bits<ResultWidth> ret;
+    asm("fn (fid)(a: bits[i], b: bits[c]) -> bits[d] { ret (aid): bits[d] "
+        "= smul(a, b, pos=(loc)) }"
+        : "=r"(ret)
+        : "i"(WidthA), "c"(WidthB), "d"(ResultWidth), "parama"(a),
+          "paramb"(b));
+    return ret;
+  }
+};
+
 template <int Width, int IndexW>
 class [[hls_synthetic_int]] ShiftLeft {
  public:
@@ -712,7 +747,28 @@ class [[hls_synthetic_int]] XlsInt : public XlsIntBase<Width, Signed> {
   BINARY_OP(+, "add", plus);
   BINARY_OP(-, "sub", minus);
 
-  BINARY_OP_WITH_SIGN(*, MultiplyWithSign, mult);
+  template <int ToW, bool ToSign>
+  inline typename rt<ToW, ToSign>::mult operator*(
+      const XlsInt<ToW, ToSign> &o) const {
+    typedef typename rt<ToW, ToSign>::mult Result;
+    if constexpr (Signed == ToSign) {
+      // A single multiply at the result width, no extensions needed
+      return Result(
+          MultiplyWidenWithSign<Width, ToW, Result::width, Signed>::Operate(
+              this->storage, o.storage));
+    } else {
+      Result as = *this;
+      Result bs = o;
+      return Result(MultiplyWithSign<Result::width, Result::sign>::Operate(
+          as.storage, bs.storage));
+    }
+  }
+  template <int ToW, bool ToSign>
+  inline XlsInt operator*=(const XlsInt<ToW, ToSign> &o) {
+    (*this) = (*this) * o;
+    return (*this);
+  }
+
   BINARY_OP_WITH_SIGN(/, DivideWithSign, div);
   BINARY_OP_WITH_SIGN(%, ModuloWithSign, mod);
 
@@ -722,19 +778,25 @@ class [[hls_synthetic_int]] XlsInt : public XlsIntBase<Width, Signed> {
 
   template <int W2, bool S2>
   inline XlsInt operator>>(XlsInt<W2, S2> offset) const {
-    XlsInt<W2, S2> neg_offset = -offset;
-    XlsInt ret_right;
-    asm("fn (fid)(a: bits[i]) -> bits[i] { ret op_5_(aid): bits[i] = "
-        "identity(a, pos=(loc)) }"
-        : "=r"(ret_right.storage)
-        : "i"(Width), "a"(ShiftRightWithSign<Width, Signed, W2>::Operate(
-                          this->storage, offset.storage)));
-    XlsInt ret_left;
-    asm("fn (fid)(a: bits[i], o: bits[c]) -> bits[i] { ret op_(aid): bits[i] = "
-        "shll(a, o, pos=(loc)) }"
-        : "=r"(ret_left.storage)
-        : "i"(Width), "c"(W2), "a"(this->storage), "o"(neg_offset.storage));
-    return (offset < 0) ? ret_left : ret_right;
+    if constexpr (!S2) {
+      // Unsigned offsets can't be negative, so one shift is enough
+      return XlsInt(ShiftRightWithSign<Width, Signed, W2>::Operate(
+          this->storage, offset.storage));
+    } else {
+      XlsInt<W2, S2> neg_offset = -offset;
+      XlsInt ret_right;
+      asm("fn (fid)(a: bits[i]) -> bits[i] { ret op_5_(aid): bits[i] = "
+          "identity(a, pos=(loc)) }"
+          : "=r"(ret_right.storage)
+          : "i"(Width), "a"(ShiftRightWithSign<Width, Signed, W2>::Operate(
+                            this->storage, offset.storage)));
+      XlsInt ret_left;
+      asm("fn (fid)(a: bits[i], o: bits[c]) -> bits[i] { ret op_(aid): "
+          "bits[i] = shll(a, o, pos=(loc)) }"
+          : "=r"(ret_left.storage)
+          : "i"(Width), "c"(W2), "a"(this->storage), "o"(neg_offset.storage));
+      return (offset < 0) ? ret_left : ret_right;
+    }
   }
   template <int W2, bool S2>
   inline XlsInt operator>>=(XlsInt<W2, S2> offset) {
@@ -744,19 +806,24 @@ class [[hls_synthetic_int]] XlsInt : public XlsIntBase<Width, Signed> {
 
   template <int W2, bool S2>
   inline XlsInt operator<<(XlsInt<W2, S2> offset) const {
-    XlsInt<W2, S2> neg_offset = -offset;
-    XlsInt ret_right;
-    asm("fn (fid)(a: bits[i]) -> bits[i] { ret op_5_(aid): bits[i] = "
-        "identity(a, pos=(loc)) }"
-        : "=r"(ret_right.storage)
-        : "i"(Width), "a"(ShiftRightWithSign<Width, Signed, W2>::Operate(
-                          this->storage, neg_offset.storage)));
-    XlsInt ret_left;
-    asm("fn (fid)(a: bits[i], o: bits[c]) -> bits[i] { ret op_(aid): bits[i] = "
-        "shll(a, o, pos=(loc)) }"
-        : "=r"(ret_left.storage)
-        : "i"(Width), "c"(W2), "a"(this->storage), "o"(offset.storage));
-    return (offset < 0) ? ret_right : ret_left;
+    if constexpr (!S2) {
+      return XlsInt(
+          ShiftLeft<Width, W2>::Operate(this->storage, offset.storage));
+    } else {
+      XlsInt<W2, S2> neg_offset = -offset;
+      XlsInt ret_right;
+      asm("fn (fid)(a: bits[i]) -> bits[i] { ret op_5_(aid): bits[i] = "
+          "identity(a, pos=(loc)) }"
+          : "=r"(ret_right.storage)
+          : "i"(Width), "a"(ShiftRightWithSign<Width, Signed, W2>::Operate(
+                            this->storage, neg_offset.storage)));
+      XlsInt ret_left;
+      asm("fn (fid)(a: bits[i], o: bits[c]) -> bits[i] { ret op_(aid): "
+          "bits[i] = shll(a, o, pos=(loc)) }"
+          : "=r"(ret_left.storage)
+          : "i"(Width), "c"(W2), "a"(this->storage), "o"(offset.storage));
+      return (offset < 0) ? ret_right : ret_left;
+    }
   }
   template <int W2, bool S2>
   inline XlsInt operator<<=(XlsInt<W2, S2> offset) {
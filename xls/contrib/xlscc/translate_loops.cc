@@ -41,6 +41,7 @@
 #include "llvm/include/llvm/Support/Casting.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
+#include "xls/contrib/xlscc/metadata_output.pb.h"
 #include "xls/contrib/xlscc/translator.h"
 #include "xls/contrib/xlscc/xlscc_logging.h"
 #include "xls/ir/bits.h"
@@ -65,6 +66,200 @@ ABSL_FLAG(bool, log_slow_unroll_iterations, false,
 
 namespace xlscc {
 
+namespace {
+
+// Loops without pragmas are only unrolled automatically if the unrolled
+// bodies add up to at most this many clang AST nodes.
+constexpr int64_t kMaxAutoUnrolledAstNodes = 10000;
+
+const clang::VarDecl* GetReferencedVar(const clang::Expr* expr) {
+  auto* ref = clang::dyn_cast<clang::DeclRefExpr>(expr->IgnoreParenImpCasts());
+  if (ref == nullptr) {
+    return nullptr;
+  }
+  return clang::dyn_cast<clang::VarDecl>(ref->getDecl());
+}
+
+std::optional<int64_t> EvaluateConstantInt64(const clang::Expr* expr,
+                                             const clang::ASTContext& ctx) {
+  clang::Expr::EvalResult result;
+  if (expr == nullptr ||
+      !expr->EvaluateAsInt(result, ctx, clang::Expr::SE_NoSideEffects)) {
+    return std::nullopt;
+  }
+  const llvm::APSInt& value = result.Val.getInt();
+  if (value.getSignificantBits() > 64) {
+    return std::nullopt;
+  }
+  return value.getExtValue();
+}
+
+int64_t CountAstNodes(const clang::Stmt* stmt) {
+  if (stmt == nullptr) {
+    return 0;
+  }
+  int64_t count = 1;
+  for (const clang::Stmt* child : stmt->children()) {
+    count += CountAstNodes(child);
+  }
+  return count;
+}
+
+// Estimates the trip count of loops of the form
+//   for (int i = start; i < bound; i += step)
+// with constant start, bound and step. Other comparisons and decrementing
+// counters are also recognized. Assignments to the counter in the body are
+// not, so the result is only an estimate.
+std::optional<int64_t> EstimateTripCount(const clang::Stmt* init,
+                                         const clang::Expr* cond_expr,
+                                         const clang::Stmt* inc,
+                                         const clang::ASTContext& ctx) {
+  if (init == nullptr || cond_expr == nullptr || inc == nullptr) {
+    return std::nullopt;
+  }
+
+  const clang::VarDecl* counter = nullptr;
+  std::optional<int64_t> start;
+  if (auto* decl_stmt = clang::dyn_cast<clang::DeclStmt>(init);
+      decl_stmt != nullptr && decl_stmt->isSingleDecl()) {
+    counter = clang::dyn_cast<clang::VarDecl>(decl_stmt->getSingleDecl());
+    if (counter != nullptr) {
+      start = EvaluateConstantInt64(counter->getInit(), ctx);
+    }
+  } else if (auto* assign = clang::dyn_cast<clang::BinaryOperator>(init);
+             assign != nullptr && assign->getOpcode() == clang::BO_Assign) {
+    counter = GetReferencedVar(assign->getLHS());
+    start = EvaluateConstantInt64(assign->getRHS(), ctx);
+  }
+  if (counter == nullptr || !start.has_value()) {
+    return std::nullopt;
+  }
+
+  std::optional<int64_t> step;
+  if (auto* unary = clang::dyn_cast<clang::UnaryOperator>(inc);
+      unary != nullptr && GetReferencedVar(unary->getSubExpr()) == counter) {
+    if (unary->isIncrementOp()) {
+      step = 1;
+    } else if (unary->isDecrementOp()) {
+      step = -1;
+    }
+  } else if (auto* compound =
+                 clang::dyn_cast<clang::CompoundAssignOperator>(inc);
+             compound != nullptr &&
+             GetReferencedVar(compound->getLHS()) == counter) {
+    std::optional<int64_t> amount =
+        EvaluateConstantInt64(compound->getRHS(), ctx);
+    if (amount.has_value() && compound->getOpcode() == clang::BO_AddAssign) {
+      step = *amount;
+    } else if (amount.has_value() &&
+               compound->getOpcode() == clang::BO_SubAssign &&
+               *amount != std::numeric_limits<int64_t>::min()) {
+      step = -*amount;
+    }
+  }
+  if (!step.has_value() || *step == 0) {
+    return std::nullopt;
+  }
+
+  auto* cond = clang::dyn_cast<clang::BinaryOperator>(
+      cond_expr->IgnoreParenImpCasts());
+  if (cond == nullptr || !cond->isComparisonOp()) {
+    return std::nullopt;
+  }
+  clang::BinaryOperatorKind op = cond->getOpcode();
+  std::optional<int64_t> bound;
+  if (GetReferencedVar(cond->getLHS()) == counter) {
+    bound = EvaluateConstantInt64(cond->getRHS(), ctx);
+  } else if (GetReferencedVar(cond->getRHS()) == counter) {
+    bound = EvaluateConstantInt64(cond->getLHS(), ctx);
+    op = clang::BinaryOperator::reverseComparisonOp(op);
+  }
+  if (!bound.has_value()) {
+    return std::nullopt;
+  }
+
+  // Normalize to counting up from 0 to distance by a positive step.
+  int64_t distance;
+  if (__builtin_sub_overflow(*bound, *start, &distance)) {
+    return std::nullopt;
+  }
+  int64_t abs_step = *step;
+  switch (op) {
+    case clang::BO_LT:
+    case clang::BO_LE:
+      if (*step < 0) {
+        return std::nullopt;
+      }
+      break;
+    case clang::BO_GT:
+    case clang::BO_GE:
+      if (*step > 0 || distance == std::numeric_limits<int64_t>::min() ||
+          abs_step == std::numeric_limits<int64_t>::min()) {
+        return std::nullopt;
+      }
+      distance = -distance;
+      abs_step = -abs_step;
+      op = (op == clang::BO_GT) ? clang::BO_LT : clang::BO_LE;
+      break;
+    case clang::BO_NE:
+      if (*step == -1 && distance == std::numeric_limits<int64_t>::min()) {
+        return std::nullopt;
+      }
+      if ((distance % *step) != 0 || (distance / *step) < 0) {
+        return std::nullopt;
+      }
+      return distance / *step;
+    default:
+      return std::nullopt;
+  }
+  if (distance < 0 || (distance == 0 && op == clang::BO_LT)) {
+    return 0;
+  }
+  if (op == clang::BO_LT) {
+    return (distance - 1) / abs_step + 1;
+  }
+  return distance / abs_step + 1;
+}
+
+}  // namespace
+
+xlscc_metadata::LoopDecision Translator::ChooseLoopImplementation(
+    const clang::Stmt* loop_stmt, const clang::Stmt* init,
+    const clang::Expr* cond_expr, const clang::Stmt* inc,
+    const clang::Stmt* body, clang::ASTContext& ctx) {
+  // Inner loops are revisited for every iteration of an unrolled outer loop.
+  auto [iter, inserted] =
+      loop_decision_indices_.insert({loop_stmt, loop_decisions_.size()});
+  if (!inserted) {
+    return loop_decisions_.at(iter->second);
+  }
+
+  xlscc_metadata::LoopDecision decision;
+  FillLocationProto(loop_stmt->getBeginLoc(), decision.mutable_location());
+
+  std::optional<int64_t> trip_count =
+      EstimateTripCount(init, cond_expr, inc, ctx);
+  const int64_t body_size = CountAstNodes(body) + CountAstNodes(cond_expr) +
+                            CountAstNodes(inc);
+  decision.set_body_size(body_size);
+  if (trip_count.has_value()) {
+    decision.set_trip_count(*trip_count);
+  }
+
+  // Unrolling gives the most throughput, so it is preferred as long as the
+  // unrolled IR stays small. Otherwise pipeline at the target interval.
+  if (trip_count.has_value() && *trip_count <= max_unroll_iters_ &&
+      *trip_count * body_size <= kMaxAutoUnrolledAstNodes) {
+    decision.set_implementation(xlscc_metadata::LOOP_IMPLEMENTATION_UNROLLED);
+  } else {
+    decision.set_implementation(xlscc_metadata::LOOP_IMPLEMENTATION_PIPELINED);
+    decision.set_init_interval(auto_loop_init_interval_);
+  }
+
+  loop_decisions_.push_back(decision);
+  return decision;
+}
+
 absl::Status Translator::GenerateIR_Loop(
     bool always_first_iter, const clang::Stmt* loop_stmt,
     clang::ArrayRef<const clang::AnnotateAttr*> attrs, const clang::Stmt* init,
@@ -108,6 +303,19 @@ absl::Status Translator::GenerateIR_Loop(
     unroll_factor = unroll_factor_optional.value();
   }
 
+  if (auto_loop_init_interval_ > 0 && !unroll_factor_optional.has_value() &&
+      !init_interval_optional.has_value() && unroll_factor == 0 &&
+      init_interval <= 0) {
+    xlscc_metadata::LoopDecision decision = ChooseLoopImplementation(
+        loop_stmt, init, cond_expr, inc, body, ctx);
+    if (decision.implementation() ==
+        xlscc_metadata::LOOP_IMPLEMENTATION_UNROLLED) {
+      unroll_factor = std::numeric_limits<int64_t>::max();
+    } else {
+      init_interval = decision.init_interval();
+    }
+  }
+
   if (unroll_factor > 0) {
     if (unroll_factor < std::numeric_limits<int64_t>::max()) {
       LOG(WARNING) << WarningMessage(loc,
@@ -151,6 +359,7 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
     Z3_context ctx_;
     Z3_solver solver_;
   };
+  SolverDeref solver_deref(z3_translator_parent->ctx(), solver);
 
   // Generate the declaration within a private context
   PushContextGuard for_init_guard(*this, loc);
@@ -203,6 +203,10 @@ absl::StatusOr<xlscc_metadata::MetadataOutput> Translator::GenerateMetadata() {
 
   parser_->AddSourceInfoToMetadata(ret);
 
+  for (const xlscc_metadata::LoopDecision& decision : loop_decisions_) {
+    *ret.add_loop_decisions() = decision;
+  }
+
   absl::flat_hash_set<const clang::NamedDecl*> aliases_used_unordered;
 
   // Top function proto
@@ -77,6 +77,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/contrib/xlscc/cc_parser.h"
 #include "xls/contrib/xlscc/xlscc_logging.h"
+#include "xls/data_structures/leaf_type_tree.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
@@ -90,9 +91,12 @@
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
+#include "xls/ir/ternary.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_utils.h"
 #include "z3/src/api/z3_api.h"
@@ -5627,6 +5631,16 @@ absl::StatusOr<bool> Translator::BitMustBe(bool assert_value, xls::BValue& bval,
 
   XLS_RETURN_IF_ERROR(ShortCircuitBVal(bval, loc));
 
+  // Ternary evaluation settles constant conditions, such as those of loops
+  // with a fixed trip count, far more cheaply than Z3.
+  XLS_ASSIGN_OR_RETURN(xls::TernaryQueryEngine * ternary_query_engine,
+                       GetTernaryQueryEngine(bval.builder()->function()));
+  std::optional<bool> known_value = ternary_query_engine->KnownValue(
+      xls::TreeBitLocation(bval.node(), /*bit_index=*/0));
+  if (known_value.has_value()) {
+    return *known_value == assert_value;
+  }
+
   XLS_ASSIGN_OR_RETURN(xls::solvers::z3::IrTranslator * z3_translator,
                        GetZ3Translator(bval.builder()->function()));
   XLS_RETURN_IF_ERROR(bval.node()->Accept(z3_translator));
@@ -6064,6 +6078,12 @@ absl::Status Translator::SelectTop(std::string_view top_function_name,
   return parser_->SelectTop(top_function_name, top_class_name);
 }
 
+void Translator::SetPrecompiledHeader(std::string_view header,
+                                      std::string_view cache_dir) {
+  CHECK_NE(parser_.get(), nullptr);
+  parser_->SetPrecompiledHeader(header, cache_dir);
+}
+
 absl::StatusOr<GeneratedFunction*> Translator::GenerateIR_Top_Function(
     xls::Package* package,
     const absl::flat_hash_map<const clang::NamedDecl*, ChannelBundle>&
@@ -6294,6 +6314,42 @@ absl::StatusOr<xls::solvers::z3::IrTranslator*> Translator::GetZ3Translator(
   return iter->second.get();
 }
 
+namespace {
+
+// Supplies the values already computed by a query engine as givens, so that
+// repopulating it only evaluates nodes it has not seen yet.
+class PreviousTernaryValues final : public xls::TernaryDataProvider {
+ public:
+  explicit PreviousTernaryValues(const xls::TernaryQueryEngine& query_engine)
+      : query_engine_(query_engine) {}
+
+  std::optional<xls::LeafTypeTree<xls::TernaryVector>> GetKnownTernary(
+      xls::Node* n) const final {
+    if (!query_engine_.IsTracked(n)) {
+      return std::nullopt;
+    }
+    return query_engine_.GetTernaryView(n).AsShared().ToOwned();
+  }
+
+ private:
+  const xls::TernaryQueryEngine& query_engine_;
+};
+
+}  // namespace
+
+absl::StatusOr<xls::TernaryQueryEngine*> Translator::GetTernaryQueryEngine(
+    xls::FunctionBase* func) {
+  std::unique_ptr<xls::TernaryQueryEngine>& query_engine =
+      ternary_query_engines_[func];
+  if (query_engine == nullptr) {
+    query_engine = std::make_unique<xls::TernaryQueryEngine>();
+  }
+  PreviousTernaryValues previous_values(*query_engine);
+  XLS_RETURN_IF_ERROR(
+      query_engine->PopulateWithGivens(func, previous_values).status());
+  return query_engine.get();
+}
+
 bool Translator::DeclHasAnnotation(const clang::NamedDecl& decl,
                                    std::string_view name) {
   return HasAnnotation(GetClangAnnotations(decl), name);
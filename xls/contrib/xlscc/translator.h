@@ -69,6 +69,7 @@
 #include "xls/ir/state_element.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/passes/ternary_query_engine.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "z3/src/api/z3_api.h"
 
@@ -1154,6 +1155,10 @@ class Translator {
   absl::Status SelectTop(std::string_view top_function_name,
                          std::string_view top_class_name = "");
 
+  // See CCParser::SetPrecompiledHeader()
+  void SetPrecompiledHeader(std::string_view header,
+                            std::string_view cache_dir);
+
   // Generates IR as an XLS function, that is, a pure function without
   //  IO / state / side effects.
   // If top_function is 0 or "" then top must be specified via pragma
@@ -1203,6 +1208,13 @@ class Translator {
 
   inline void SetIOTestMode() { io_test_mode_ = true; }
 
+  // Enables automatic implementation of loops without an unroll or pipelining
+  //  pragma: they are unrolled when small enough, and otherwise pipelined at
+  //  the given initiation interval.
+  inline void SetAutoLoopInitInterval(int64_t init_interval) {
+    auto_loop_init_interval_ = init_interval;
+  }
+
   absl::StatusOr<const clang::FunctionDecl*> GetTopFunction() const {
     CHECK_NE(parser_, nullptr);
     return parser_->GetTopFunction();
@@ -1494,6 +1506,14 @@ class Translator {
   // so that IO operations can be generated without calling GenerateIR_Block()
   bool io_test_mode_ = false;
 
+  // Initiation interval for automatically pipelined loops, disabled if <= 0
+  int64_t auto_loop_init_interval_ = -1;
+
+  // Decisions made for automatically implemented loops, in order of first
+  //  encounter, and the index of each loop's decision.
+  std::vector<xlscc_metadata::LoopDecision> loop_decisions_;
+  absl::flat_hash_map<const clang::Stmt*, int64_t> loop_decision_indices_;
+
   const int64_t kNumSubBlockModeBits = 8;
 
   struct InstTypeHash {
@@ -1938,7 +1958,13 @@ class Translator {
       clang::ASTContext& ctx);
 
   // init, cond, and inc can be nullptr
-  absl::Status GenerateIR_UnrolledLoop(bool always_first_iter,
+  // Chooses between unrolling and pipelining a loop without pragmas,
+  //  recording the decision for the metadata output.
+  xlscc_metadata::LoopDecision ChooseLoopImplementation(
+      const clang::Stmt* loop_stmt, const clang::Stmt* init,
+      const clang::Expr* cond_expr, const clang::Stmt* inc,
+      const clang::Stmt* body, clang::ASTContext& ctx);
+    absl::Status GenerateIR_UnrolledLoop(bool always_first_iter,
                                        const clang::Stmt* init,
                                        const clang::Expr* cond_expr,
                                        const clang::Stmt* inc,
@@ -2324,6 +2350,16 @@ class Translator {
   absl::flat_hash_map<xls::FunctionBase*,
                       std::unique_ptr<xls::solvers::z3::IrTranslator>>
       z3_translators_;
+
+  // Returns a ternary query engine for the function, updated to cover any
+  // nodes added since the previous call. Values computed by earlier calls are
+  // reused, so only the new nodes are evaluated.
+  absl::StatusOr<xls::TernaryQueryEngine*> GetTernaryQueryEngine(
+      xls::FunctionBase* func) ABSL_ATTRIBUTE_LIFETIME_BOUND;
+
+  absl::flat_hash_map<xls::FunctionBase*,
+                      std::unique_ptr<xls::TernaryQueryEngine>>
+      ternary_query_engines_;
 };
 
 }  // namespace xlscc
@@ -15,6 +15,7 @@
 #include "xls/contrib/xlscc/cc_parser.h"
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
 
@@ -32,6 +33,8 @@
 #include "clang/include/clang/AST/Stmt.h"
 #include "clang/include/clang/Basic/LLVM.h"
 #include "llvm/include/llvm/Support/Casting.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
 #include "xls/contrib/xlscc/unit_tests/unit_test.h"
@@ -240,6 +243,62 @@ TEST_F(CCParserTest, Basic) {
   EXPECT_NE(top_ptr, nullptr);
 }
 
+int64_t CountFilesWithExtension(const std::filesystem::path& directory,
+                                std::string_view extension) {
+  int64_t count = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.path().extension() == extension) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+TEST_F(CCParserTest, PrecompiledHeader) {
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempDirectory temp_dir,
+                           xls::TempDirectory::Create());
+  const std::filesystem::path header = temp_dir.path() / "prefix.h";
+  const std::filesystem::path cache_dir = temp_dir.path() / "cache";
+
+  const std::string cpp_src = R"(
+    #pragma hls_top
+    int foo(int a, int b) {
+      return add3(a + b);
+    }
+  )";
+
+  auto scan = [&]() {
+    xlscc::CCParser parser;
+    parser.SetPrecompiledHeader(header.string(), cache_dir.string());
+    XLS_ASSERT_OK(ScanTempFileWithContent(cpp_src, {}, &parser));
+    XLS_ASSERT_OK_AND_ASSIGN(const auto* top_ptr, parser.GetTopFunction());
+    EXPECT_NE(top_ptr, nullptr);
+  };
+
+  XLS_ASSERT_OK(xls::SetFileContents(header, R"(
+    #ifndef PREFIX_H
+    #define PREFIX_H
+    inline int add3(int x) { return x + 3; }
+    #endif
+  )"));
+  scan();
+  EXPECT_EQ(CountFilesWithExtension(cache_dir, ".pch"), 1);
+  EXPECT_EQ(CountFilesWithExtension(cache_dir, ".manifest"), 1);
+
+  // Reused while the header is unchanged.
+  scan();
+  EXPECT_EQ(CountFilesWithExtension(cache_dir, ".pch"), 1);
+
+  XLS_ASSERT_OK(xls::SetFileContents(header, R"(
+    #ifndef PREFIX_H
+    #define PREFIX_H
+    inline int add3(int x) { return 3 + x; }
+    #endif
+  )"));
+  scan();
+  EXPECT_EQ(CountFilesWithExtension(cache_dir, ".pch"), 2);
+}
+
 TEST_F(CCParserTest, Basic2) {
   xlscc::CCParser parser;
 
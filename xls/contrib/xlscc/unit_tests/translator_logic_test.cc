@@ -1910,6 +1910,84 @@ TEST_F(TranslatorLogicTest, ForUnrollNoPragma) {
                   testing::HasSubstr("missing #pragma or attribute")));
 }
 
+TEST_F(TranslatorLogicTest, ForAutoUnrollNoPragma) {
+  std::string_view content = R"(
+      long long my_package(long long a, long long b) {
+        for(int i=1;i<=10;++i) {
+          a += b;
+          a += 2*b;
+        }
+        return a;
+      })";
+  auto_loop_init_interval_ = 1;
+  Run({{"a", 11}, {"b", 20}}, 611, content);
+
+  XLS_ASSERT_OK_AND_ASSIGN(xlscc_metadata::MetadataOutput meta,
+                           translator_->GenerateMetadata());
+  ASSERT_EQ(meta.loop_decisions_size(), 1);
+  const xlscc_metadata::LoopDecision& decision = meta.loop_decisions(0);
+  EXPECT_EQ(decision.implementation(),
+            xlscc_metadata::LOOP_IMPLEMENTATION_UNROLLED);
+  EXPECT_EQ(decision.trip_count(), 10);
+  EXPECT_EQ(decision.location().line(), 3);
+}
+
+TEST_F(TranslatorLogicTest, ForAutoPipelineUnknownTripCount) {
+  // The counter update isn't recognized, so the trip count is unknown.
+  const std::string content = R"(
+    #pragma hls_top
+    void foo(__xls_channel<int>& in,
+             __xls_channel<int>& out) {
+      int a = in.read();
+
+      for(long i=1;i<=4;i=i+1) {
+        #pragma hls_unroll yes
+        for(int j=0;j<5;++j) {
+          a += i;
+        }
+      }
+
+      out.write(a);
+    })";
+
+  HLSBlock block_spec;
+  {
+    block_spec.set_name("foo");
+
+    HLSChannel* ch_in = block_spec.add_channels();
+    ch_in->set_name("in");
+    ch_in->set_is_input(true);
+    ch_in->set_type(FIFO);
+
+    HLSChannel* ch_out1 = block_spec.add_channels();
+    ch_out1->set_name("out");
+    ch_out1->set_is_input(false);
+    ch_out1->set_type(FIFO);
+  }
+
+  absl::flat_hash_map<std::string, std::list<xls::Value>> inputs;
+  inputs["in"] = {xls::Value(xls::SBits(80, 32)),
+                  xls::Value(xls::SBits(100, 32))};
+
+  auto_loop_init_interval_ = 1;
+  {
+    absl::flat_hash_map<std::string, std::list<xls::Value>> outputs;
+    outputs["out"] = {xls::Value(xls::SBits(80 + 5 * 10, 32)),
+                      xls::Value(xls::SBits(100 + 5 * 10, 32))};
+
+    ProcTest(content, block_spec, inputs, outputs, /* min_ticks = */ 8);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(xlscc_metadata::MetadataOutput meta,
+                           translator_->GenerateMetadata());
+  ASSERT_EQ(meta.loop_decisions_size(), 1);
+  const xlscc_metadata::LoopDecision& decision = meta.loop_decisions(0);
+  EXPECT_EQ(decision.implementation(),
+            xlscc_metadata::LOOP_IMPLEMENTATION_PIPELINED);
+  EXPECT_FALSE(decision.has_trip_count());
+  EXPECT_EQ(decision.init_interval(), 1);
+}
+
 TEST_F(TranslatorLogicTest, ForUnrollBadNumber) {
   std::string_view content = R"(
       long long my_package(long long a, long long b) {
@@ -270,6 +270,7 @@ absl::Status XlsccTestBase::ScanFile(
   if (io_test_mode) {
     translator_->SetIOTestMode();
   }
+  translator_->SetAutoLoopInitInterval(auto_loop_init_interval_);
   if (fail_xlscc_check) {
     auto source_info = xls::SourceInfo(loc);
     XLSCC_CHECK(false, source_info);
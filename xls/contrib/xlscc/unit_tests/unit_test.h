@@ -224,6 +224,7 @@ class XlsccTestBase : public xls::SimTestBase, public ::absl::LogSink {
   bool generate_fsms_for_pipelined_loops_ = false;
   bool merge_states_ = false;
   bool split_states_on_channel_ops_ = false;
+  int64_t auto_loop_init_interval_ = -1;
 
  protected:
   std::vector<CapturedLogEntry> log_entries_;
@@ -63,6 +63,45 @@ TEST_F(XlsIntTest, Mul) {
                     xabsl::SourceLocation::current());
 }
 
+TEST_F(XlsIntTest, MulMixedWidthUnsigned) {
+  const std::string content = R"(
+    #include "xls_int.h"
+
+    long long my_package(long long a, long long b) {
+      XlsInt<20, false> ax = a;
+      XlsInt<12, false> bx = b;
+      return ax * bx;
+    })";
+  RunAcDatatypeTest({{"a", 1000000}, {"b", 4000}}, 4000000000LL, content,
+                    xabsl::SourceLocation::current());
+}
+
+TEST_F(XlsIntTest, MulMixedWidthSigned) {
+  const std::string content = R"(
+    #include "xls_int.h"
+
+    long long my_package(long long a, long long b) {
+      XlsInt<20, true> ax = a;
+      XlsInt<12, true> bx = b;
+      return ax * bx;
+    })";
+  RunAcDatatypeTest({{"a", -500000}, {"b", 2000}}, -1000000000LL, content,
+                    xabsl::SourceLocation::current());
+}
+
+TEST_F(XlsIntTest, MulMixedSign) {
+  const std::string content = R"(
+    #include "xls_int.h"
+
+    long long my_package(long long a, long long b) {
+      XlsInt<20, true> ax = a;
+      XlsInt<12, false> bx = b;
+      return ax * bx;
+    })";
+  RunAcDatatypeTest({{"a", -500000}, {"b", 4000}}, -2000000000LL, content,
+                    xabsl::SourceLocation::current());
+}
+
 TEST_F(XlsIntTest, Div) {
   const std::string content = R"(
     #include "xls_int.h"
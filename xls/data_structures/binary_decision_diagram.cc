@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/log/vlog_is_on.h"
@@ -31,10 +32,26 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 
 namespace xls {
+namespace {
 
-BinaryDecisionDiagram::BinaryDecisionDiagram() {
+// Variable of nodes in the free list.
+constexpr BddVariable kFreeVariable = BddVariable(-2);
+
+// Initial number of entries in the computed table.
+constexpr int64_t kInitialComputedTableSize = 1024;
+
+}  // namespace
+
+BinaryDecisionDiagram::BinaryDecisionDiagram(int64_t max_computed_table_size)
+    : max_computed_table_size_(max_computed_table_size) {
+  CHECK_GT(max_computed_table_size, 0);
+  CHECK_EQ(max_computed_table_size & (max_computed_table_size - 1), 0)
+      << "Computed table size must be a power of two";
+  computed_table_.resize(
+      std::min(kInitialComputedTableSize, max_computed_table_size));
   // Leaf node 0.
   nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
                            /*p=*/1));
@@ -73,13 +90,100 @@ BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
         std::min(static_cast<int64_t>(GetNode(low).path_count) +
                      GetNode(high).path_count,
                  static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
-    nodes_.emplace_back(var, high, low, paths);
-    BddNodeIndex node_index = BddNodeIndex(nodes_.size() - 1);
-    ctor(key, node_index);
+    ctor(key, AllocateNode(var, high, low, paths));
   });
   return it->second;
 }
 
+BddNodeIndex BinaryDecisionDiagram::AllocateNode(BddVariable var,
+                                                 BddNodeIndex high,
+                                                 BddNodeIndex low,
+                                                 int32_t paths) {
+  BddNodeIndex index;
+  if (free_list_.empty()) {
+    nodes_.emplace_back(var, high, low, paths);
+    index = BddNodeIndex(nodes_.size() - 1);
+  } else {
+    index = free_list_.back();
+    free_list_.pop_back();
+    nodes_[index.value()] = BddNode(var, high, low, paths);
+  }
+  MaybeGrowComputedTable();
+  return index;
+}
+
+BinaryDecisionDiagram::ComputedTableEntry&
+BinaryDecisionDiagram::GetComputedTableEntry(BddNodeIndex cond,
+                                             BddNodeIndex if_true,
+                                             BddNodeIndex if_false) {
+  size_t slot = absl::HashOf(cond, if_true, if_false) &
+                (computed_table_.size() - 1);
+  return computed_table_[slot];
+}
+
+void BinaryDecisionDiagram::MaybeGrowComputedTable() {
+  int64_t table_size = computed_table_.size();
+  if (table_size >= max_computed_table_size_ || size() <= table_size) {
+    return;
+  }
+  std::vector<ComputedTableEntry> old_table(2 * table_size);
+  std::swap(old_table, computed_table_);
+  for (const ComputedTableEntry& entry : old_table) {
+    if (entry.result != BddNodeIndex(-1)) {
+      GetComputedTableEntry(entry.cond, entry.if_true, entry.if_false) = entry;
+    }
+  }
+}
+
+int64_t BinaryDecisionDiagram::GarbageCollect(
+    absl::Span<const BddNodeIndex> roots) {
+  std::vector<bool> live(nodes_.size(), false);
+  live[zero().value()] = true;
+  live[one().value()] = true;
+  for (BddNodeIndex base : variable_base_nodes_) {
+    live[base.value()] = true;
+  }
+  std::vector<BddNodeIndex> worklist(roots.begin(), roots.end());
+  while (!worklist.empty()) {
+    BddNodeIndex index = worklist.back();
+    worklist.pop_back();
+    if (live[index.value()]) {
+      continue;
+    }
+    live[index.value()] = true;
+    const BddNode& node = GetNode(index);
+    worklist.push_back(node.high);
+    worklist.push_back(node.low);
+  }
+
+  int64_t freed = 0;
+  for (int64_t i = 0; i < nodes_.size(); ++i) {
+    BddNode& node = nodes_[i];
+    if (live[i] || node.variable == kFreeVariable) {
+      continue;
+    }
+    node_map_.erase(std::make_tuple(node.variable, node.high, node.low));
+    node = BddNode(kFreeVariable, BddNodeIndex(-1), BddNodeIndex(-1),
+                   /*p=*/0);
+    free_list_.push_back(BddNodeIndex(i));
+    ++freed;
+  }
+
+  // Drop computed table entries which refer to freed nodes.
+  if (freed > 0) {
+    for (ComputedTableEntry& entry : computed_table_) {
+      if (entry.result != BddNodeIndex(-1) &&
+          (!live[entry.cond.value()] || !live[entry.if_true.value()] ||
+           !live[entry.if_false.value()] || !live[entry.result.value()])) {
+        entry = ComputedTableEntry();
+      }
+    }
+  }
+  VLOG(3) << absl::StreamFormat("BDD garbage collection freed %d of %d nodes",
+                                freed, nodes_.size());
+  return freed;
+}
+
 BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
                                              bool value) {
   if (expr == zero() || expr == one()) {
@@ -109,10 +213,13 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
   if (if_true == if_false) {
     return if_true;
   }
-  auto key = std::make_tuple(cond, if_true, if_false);
-  auto it = ite_map_.find(key);
-  if (it != ite_map_.end()) {
-    return it->second;
+  {
+    const ComputedTableEntry& entry =
+        GetComputedTableEntry(cond, if_true, if_false);
+    if (entry.cond == cond && entry.if_true == if_true &&
+        entry.if_false == if_false) {
+      return entry.result;
+    }
   }
 
   // The expression is non-trivial and has not been computed before. Recursively
@@ -142,12 +249,14 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                            Restrict(if_true, min_var, false),
                                            Restrict(if_false, min_var, false));
 
-  if (true_cofactor == false_cofactor) {
-    ite_map_[key] = true_cofactor;
-    return true_cofactor;
-  }
+  // Node creation may have grown the computed table so the entry must be looked
+  // up again.
   BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
-  ite_map_[key] = expr;
+  GetComputedTableEntry(cond, if_true, if_false) =
+      ComputedTableEntry{.cond = cond,
+                         .if_true = if_true,
+                         .if_false = if_false,
+                         .result = expr};
   return expr;
 }
 
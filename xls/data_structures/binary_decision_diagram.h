@@ -22,6 +22,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -60,9 +61,15 @@ struct BddNode {
 
 class BinaryDecisionDiagram {
  public:
+  // Default maximum number of entries in the computed table which caches the
+  // results of if-then-else operations. Each entry is 16 bytes.
+  static constexpr int64_t kDefaultMaxComputedTableSize = int64_t{1} << 20;
+
   // Creates an empty BDD. Initialize the BDD contains only the nodes
-  // corresponding to zero and one.
-  BinaryDecisionDiagram();
+  // corresponding to zero and one. `max_computed_table_size` bounds the memory
+  // used for caching if-then-else results and must be a power of two.
+  explicit BinaryDecisionDiagram(
+      int64_t max_computed_table_size = kDefaultMaxComputedTableSize);
 
   // Adds a new variable to the BDD and returns the node corresponding the
   // variable's value.
@@ -98,8 +105,13 @@ class BinaryDecisionDiagram {
     return nodes_.at(node_index.value());
   }
 
-  // Returns the number of nodes in the graph.
-  int64_t size() const { return nodes_.size(); }
+  // Returns the number of (live) nodes in the graph.
+  int64_t size() const { return nodes_.size() - free_list_.size(); }
+
+  // Returns one more than the largest node index in the graph. Node indices in
+  // [0, table_size()) which have been freed by GarbageCollect are free slots
+  // with a path count of zero.
+  int64_t table_size() const { return nodes_.size(); }
 
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return variable_base_nodes_.size(); }
@@ -125,6 +137,13 @@ class BinaryDecisionDiagram {
   BddNodeIndex IfThenElse(BddNodeIndex cond, BddNodeIndex if_true,
                           BddNodeIndex if_false);
 
+  // Frees all nodes which are not reachable from `roots`. The leaves and the
+  // variable base nodes are always retained. The indices of retained nodes are
+  // unchanged; indices of freed nodes are reused by subsequently created
+  // nodes so any index not reachable from `roots` is invalidated. Returns the
+  // number of nodes freed.
+  int64_t GarbageCollect(absl::Span<const BddNodeIndex> roots);
+
  private:
   // Helper for constructing a DNF string respresentation.
   void ToStringDnfHelper(BddNodeIndex expr, int64_t* minterms_to_emit,
@@ -148,6 +167,27 @@ class BinaryDecisionDiagram {
   // Creates the base BddNode corresponding to the given variable.
   BddNodeIndex CreateVariableBaseNode(BddVariable var);
 
+  // Adds a node to the node vector, reusing a free slot if one exists.
+  BddNodeIndex AllocateNode(BddVariable var, BddNodeIndex high,
+                            BddNodeIndex low, int32_t paths);
+
+  // An entry in the computed table. An empty entry has a result of -1.
+  struct ComputedTableEntry {
+    BddNodeIndex cond = BddNodeIndex(-1);
+    BddNodeIndex if_true = BddNodeIndex(-1);
+    BddNodeIndex if_false = BddNodeIndex(-1);
+    BddNodeIndex result = BddNodeIndex(-1);
+  };
+
+  // Returns the computed table slot for the given if-then-else expression.
+  ComputedTableEntry& GetComputedTableEntry(BddNodeIndex cond,
+                                            BddNodeIndex if_true,
+                                            BddNodeIndex if_false);
+
+  // Grows the computed table (up to max_computed_table_size_) if it is small
+  // relative to the number of nodes in the BDD.
+  void MaybeGrowComputedTable();
+
   // NodeIndexes corresponding to the base nodes (var, one, zero) for each
   // variable.
   std::vector<BddNodeIndex> variable_base_nodes_;
@@ -161,11 +201,15 @@ class BinaryDecisionDiagram {
   using NodeKey = std::tuple<BddVariable, BddNodeIndex, BddNodeIndex>;
   absl::flat_hash_map<NodeKey, BddNodeIndex> node_map_;
 
-  // A map from if-then-else expression to the node corresponding to that
-  // expression. The key elements are (condition, if-true, if-false). This map
-  // enables fast lookup for expressions.
-  using IteKey = std::tuple<BddNodeIndex, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map_;
+  // Indices of nodes freed by GarbageCollect which may be reused.
+  std::vector<BddNodeIndex> free_list_;
+
+  // A direct-mapped cache from if-then-else expression (condition, if-true,
+  // if-false) to the node corresponding to that expression. Colliding entries
+  // overwrite each other so the memory used is bounded. The size is a power of
+  // two which grows with the number of nodes up to max_computed_table_size_.
+  std::vector<ComputedTableEntry> computed_table_;
+  int64_t max_computed_table_size_;
 };
 
 }  // namespace xls
@@ -23,6 +23,7 @@
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/numeric/bits.h"
 #include "absl/status/status_matchers.h"
 
 namespace xls {
@@ -315,5 +316,50 @@ TEST(BinaryDecisionDiagramTest, ThreeVariableExhaustive) {
   }
 }
 
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars = bdd.NewVariables(4);
+  BddNodeIndex x0_and_x1 = bdd.And(vars[0], vars[1]);
+  BddNodeIndex x2_xor_x3 = bdd.Or(bdd.And(vars[2], bdd.Not(vars[3])),
+                                  bdd.And(bdd.Not(vars[2]), vars[3]));
+  int64_t before_size = bdd.size();
+
+  // Only x0_and_x1 is live so the nodes of x2_xor_x3 are freed.
+  EXPECT_GT(bdd.GarbageCollect({x0_and_x1}), 0);
+  EXPECT_LT(bdd.size(), before_size);
+  EXPECT_EQ(bdd.table_size(), before_size);
+  EXPECT_EQ(bdd.ToStringDnf(x0_and_x1), "x0.x1");
+
+  // Rebuilding the freed expression reuses the free slots and produces a
+  // correct result.
+  x2_xor_x3 = bdd.Or(bdd.And(vars[2], bdd.Not(vars[3])),
+                     bdd.And(bdd.Not(vars[2]), vars[3]));
+  EXPECT_EQ(bdd.table_size(), before_size);
+  EXPECT_EQ(bdd.ToStringDnf(x2_xor_x3), "x2.!x3 + !x2.x3");
+
+  // Collecting with every expression live frees nothing.
+  EXPECT_EQ(bdd.GarbageCollect({x0_and_x1, x2_xor_x3}), 0);
+}
+
+TEST(BinaryDecisionDiagramTest, SmallComputedTable) {
+  // A tiny computed table forces collisions which must not affect results.
+  BinaryDecisionDiagram bdd(/*max_computed_table_size=*/2);
+  std::vector<BddNodeIndex> vars = bdd.NewVariables(8);
+  BddNodeIndex parity = bdd.zero();
+  for (BddNodeIndex var : vars) {
+    parity = bdd.Or(bdd.And(parity, bdd.Not(var)),
+                    bdd.And(bdd.Not(parity), var));
+  }
+  for (int64_t value = 0; value < 256; ++value) {
+    absl::flat_hash_map<BddNodeIndex, bool> assignment;
+    for (int64_t i = 0; i < 8; ++i) {
+      assignment[vars[i]] = ((value >> i) & 1) != 0;
+    }
+    EXPECT_THAT(bdd.Evaluate(parity, assignment),
+                IsOkAndHolds(absl::popcount(static_cast<uint64_t>(value)) % 2 ==
+                             1));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -55,9 +55,9 @@ namespace leaf_type_tree_internal {
 std::pair<Type*, int64_t> GetSubtypeAndOffset(Type* t,
                                               absl::Span<int64_t const> index);
 
-// Returns the leaf types for the type `t`. Returned as an inlined vector to
-// match internal storage of LeafTypeTree.
-absl::InlinedVector<Type*, 1> GetLeafTypes(Type* t);
+// Returns the leaf types for the type `t`. The span refers to storage owned by
+// `t` which is shared by all LeafTypeTrees of that type.
+absl::Span<Type* const> GetLeafTypes(Type* t);
 
 // Returns the leaf element linear offset in the flattened representation of
 // type `t` for the given type-index `index`. CHECK fails if the index is not
@@ -354,8 +354,11 @@ class LeafTypeTreeIterator {
 template <typename T>
 class LeafTypeTree {
  public:
+  // Elements are stored inline for the common single-leaf (bits-typed) case.
+  // The leaf types are not copied per tree but refer to the storage cached on
+  // the XLS type (see Type::leaf_types).
   using DataContainerT = absl::InlinedVector<T, 1>;
-  using TypeContainerT = absl::InlinedVector<Type*, 1>;
+  using TypeContainerT = absl::Span<Type* const>;
 
   LeafTypeTree() : type_(nullptr) {}
   LeafTypeTree(const LeafTypeTree<T>& other) = default;
@@ -404,7 +407,7 @@ class LeafTypeTree {
     CHECK_EQ(type->leaf_count(), 1);
     LeafTypeTree<T> ltt;
     ltt.type_ = type;
-    ltt.elements_ = {element};
+    ltt.elements_.push_back(std::move(element));
     ltt.leaf_types_ = leaf_type_tree_internal::GetLeafTypes(type);
     return ltt;
   }
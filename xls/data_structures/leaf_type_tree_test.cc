@@ -97,6 +97,27 @@ TEST_F(LeafTypeTreeTest, BitsTypes) {
   EXPECT_EQ(tree_with_init.Get({}), 123456);
 }
 
+TEST_F(LeafTypeTreeTest, LeafTypesAreSharedWithType) {
+  Type* t = AsType("(bits[3], bits[42][2], token)");
+  LeafTypeTree<int64_t> a(t, 1);
+  LeafTypeTree<int64_t> b = LeafTypeTree<int64_t>::CreateFromVector(
+      t, LeafTypeTree<int64_t>::DataContainerT{1, 2, 3, 4});
+  LeafTypeTree<int64_t> c = a;
+  EXPECT_EQ(a.leaf_types().data(), t->leaf_types().data());
+  EXPECT_EQ(b.leaf_types().data(), t->leaf_types().data());
+  EXPECT_EQ(c.leaf_types().data(), t->leaf_types().data());
+  EXPECT_THAT(AsStrings(a.leaf_types()),
+              ElementsAre("bits[3]", "bits[42]", "bits[42]", "token"));
+  EXPECT_EQ(a, c);
+  EXPECT_NE(a, b);
+
+  Type* u32 = AsType("bits[32]");
+  LeafTypeTree<std::string> single =
+      LeafTypeTree<std::string>::CreateSingleElementTree(u32, "foo");
+  EXPECT_THAT(single.elements(), ElementsAre("foo"));
+  EXPECT_THAT(single.leaf_types(), ElementsAre(u32));
+}
+
 TEST_F(LeafTypeTreeTest, TupleType) {
   LeafTypeTree<Bits> tree(AsType("(bits[123], bits[2], bits[42])"));
 
@@ -15,84 +15,218 @@
 #ifndef XLS_DATA_STRUCTURES_STRONGLY_CONNECTED_COMPONENTS_H_
 #define XLS_DATA_STRUCTURES_STRONGLY_CONNECTED_COMPONENTS_H_
 
+#include <algorithm>
 #include <cstdint>
-#include <functional>
-#include <stack>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/log/check.h"
+#include "absl/types/span.h"
 
 namespace xls {
 
-// Computes the strongly connected components of a graph using Tarjan's strongly
-// connected components algorithm.
+// A directed graph over the vertices [0, vertex_count()) stored in compressed
+// sparse row form: the out-neighbors of vertex `v` are
+// `targets[offsets[v]] ... targets[offsets[v + 1] - 1]`.
+struct CsrGraph {
+  std::vector<int64_t> offsets = {0};
+  std::vector<int64_t> targets;
+
+  int64_t vertex_count() const { return offsets.size() - 1; }
+  int64_t edge_count() const { return targets.size(); }
+  absl::Span<const int64_t> successors(int64_t v) const {
+    return absl::MakeConstSpan(targets).subspan(offsets[v],
+                                                offsets[v + 1] - offsets[v]);
+  }
+
+  // Builds a graph from a list of (source, target) edges. The successors of
+  // each vertex are kept in the order their edges appear in `edges`.
+  static CsrGraph FromEdges(
+      int64_t vertex_count,
+      absl::Span<const std::pair<int64_t, int64_t>> edges) {
+    CsrGraph graph;
+    graph.offsets.assign(vertex_count + 1, 0);
+    for (const auto& [source, target] : edges) {
+      DCHECK(source >= 0 && source < vertex_count);
+      DCHECK(target >= 0 && target < vertex_count);
+      ++graph.offsets[source + 1];
+    }
+    for (int64_t v = 0; v < vertex_count; ++v) {
+      graph.offsets[v + 1] += graph.offsets[v];
+    }
+    graph.targets.resize(edges.size());
+    std::vector<int64_t> next(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (const auto& [source, target] : edges) {
+      graph.targets[next[source]++] = target;
+    }
+    return graph;
+  }
+};
+
+// Assigns dense ids to the vertices of an arbitrary graph (e.g. Node*s) so
+// that it can be stored as a CsrGraph. Ids are assigned in order of first
+// insertion.
+template <typename V, typename Hash = absl::Hash<V>>
+class VertexIndexer {
+ public:
+  // Returns the id of `vertex`, assigning a new one if it has none.
+  int64_t GetOrAdd(const V& vertex) {
+    auto [it, inserted] = ids_.try_emplace(vertex, vertices_.size());
+    if (inserted) {
+      vertices_.push_back(vertex);
+    }
+    return it->second;
+  }
+
+  std::optional<int64_t> Find(const V& vertex) const {
+    auto it = ids_.find(vertex);
+    if (it == ids_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  const V& vertex(int64_t id) const { return vertices_[id]; }
+  absl::Span<const V> vertices() const { return vertices_; }
+  int64_t size() const { return vertices_.size(); }
+
+ private:
+  absl::flat_hash_map<V, int64_t, Hash> ids_;
+  std::vector<V> vertices_;
+};
+
+// The strongly connected components of a CsrGraph.
+struct SccDecomposition {
+  // The component containing each vertex. Components are numbered in reverse
+  // topological order, i.e., every edge between two different components goes
+  // from a higher-numbered component to a lower-numbered one.
+  std::vector<int64_t> component;
+  int64_t component_count = 0;
+
+  // Returns the vertices of each component, in increasing vertex order.
+  std::vector<std::vector<int64_t>> Components() const {
+    std::vector<std::vector<int64_t>> components(component_count);
+    for (int64_t v = 0; v < component.size(); ++v) {
+      components[component[v]].push_back(v);
+    }
+    return components;
+  }
+};
+
+// Computes the strongly connected components of `graph` using an iterative
+// formulation of Tarjan's algorithm. The depth-first search keeps an explicit
+// stack of (vertex, next edge) frames rather than recursing, so arbitrarily
+// deep graphs are handled in O(V + E) time with flat per-vertex arrays.
+//
+// Roots are visited in increasing vertex order and successors in CSR order, so
+// the components are discovered in the same order as the textbook recursive
+// algorithm.
+inline SccDecomposition StronglyConnectedComponents(const CsrGraph& graph) {
+  const int64_t vertex_count = graph.vertex_count();
+  SccDecomposition result;
+  result.component.assign(vertex_count, -1);
+  // Preorder index and low link of each vertex; -1 if unvisited. A visited
+  // vertex with no component yet is on the Tarjan stack.
+  std::vector<int64_t> index(vertex_count, -1);
+  std::vector<int64_t> low_link(vertex_count);
+  std::vector<int64_t> stack;
+  // DFS frames: the vertex and the position of its next unexplored edge.
+  std::vector<std::pair<int64_t, int64_t>> frames;
+  int64_t next_index = 0;
+
+  auto visit = [&](int64_t v) {
+    index[v] = next_index;
+    low_link[v] = next_index;
+    ++next_index;
+    stack.push_back(v);
+    frames.push_back({v, graph.offsets[v]});
+  };
+
+  for (int64_t root = 0; root < vertex_count; ++root) {
+    if (index[root] != -1) {
+      continue;
+    }
+    visit(root);
+    while (!frames.empty()) {
+      auto& [v, edge] = frames.back();
+      if (edge < graph.offsets[v + 1]) {
+        int64_t w = graph.targets[edge++];
+        if (index[w] == -1) {
+          visit(w);  // Invalidates `v` and `edge`.
+        } else if (result.component[w] == -1) {
+          low_link[v] = std::min(low_link[v], index[w]);
+        }
+        continue;
+      }
+      int64_t finished = v;
+      frames.pop_back();
+      if (low_link[finished] == index[finished]) {
+        int64_t w;
+        do {
+          w = stack.back();
+          stack.pop_back();
+          result.component[w] = result.component_count;
+        } while (w != finished);
+        ++result.component_count;
+      }
+      if (!frames.empty()) {
+        int64_t parent = frames.back().first;
+        low_link[parent] = std::min(low_link[parent], low_link[finished]);
+      }
+    }
+  }
+  return result;
+}
+
+// Computes the strongly connected components of a graph.
 //
 // The parameter `graph` is an arbitrary adjacency matrix represented as a
 // map from nodes to the set of out-neighbors of that node. Self-edges are
-// permitted.
+// permitted. Only vertices which appear in at least one edge are included in
+// the result.
 //
-// A description of the Tarjan SCC algorithm exists on Wikipedia:
-// https://w.wiki/5h9U
-// This implementation is directly based off of that pseudocode, so please read
-// that to make sense of this code.
+// The vertices are mapped to dense ids in sorted order and the components are
+// computed by the CsrGraph overload above; the components are returned in
+// reverse topological order.
 template <typename V>
 std::vector<absl::btree_set<V>> StronglyConnectedComponents(
     const absl::btree_map<V, absl::btree_set<V>>& graph) {
-  absl::btree_set<V> vertices;
+  absl::btree_map<V, int64_t> ids;
   for (const auto& [source, targets] : graph) {
     for (const V& target : targets) {
-      vertices.insert(source);
-      vertices.insert(target);
+      ids.insert({source, 0});
+      ids.insert({target, 0});
     }
   }
+  std::vector<const V*> vertices;
+  vertices.reserve(ids.size());
+  for (auto& [vertex, id] : ids) {
+    id = vertices.size();
+    vertices.push_back(&vertex);
+  }
 
-  int64_t index = 0;
-  std::stack<V, std::vector<V>> stack;
-  std::vector<absl::btree_set<V>> result;
-  absl::btree_map<V, int64_t> indexes;
-  absl::btree_map<V, int64_t> low_links;
-  absl::btree_set<V> on_stack;
-
-  std::function<void(const V&)> strong_connect = [&](const V& vertex) {
-    indexes[vertex] = index;
-    low_links[vertex] = index;
-    ++index;
-    stack.push(vertex);
-    on_stack.insert(vertex);
-
-    if (graph.contains(vertex)) {
-      for (const V& neighbor : graph.at(vertex)) {
-        if (!indexes.contains(neighbor)) {
-          strong_connect(neighbor);
-          low_links.at(vertex) =
-              std::min(low_links.at(vertex), low_links.at(neighbor));
-        } else if (on_stack.contains(neighbor)) {
-          low_links.at(vertex) =
-              std::min(low_links.at(vertex), indexes.at(neighbor));
-        }
-      }
-    }
-
-    if (low_links.at(vertex) == indexes.at(vertex)) {
-      absl::btree_set<V> scc;
-      V v;
-      do {
-        v = stack.top();
-        stack.pop();
-        on_stack.erase(v);
-        scc.insert(v);
-      } while (v != vertex);
-      result.push_back(scc);
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (const auto& [source, targets] : graph) {
+    if (targets.empty()) {
+      continue;
     }
-  };
-
-  for (const V& vertex : vertices) {
-    if (!indexes.contains(vertex)) {
-      strong_connect(vertex);
+    int64_t source_id = ids.at(source);
+    for (const V& target : targets) {
+      edges.push_back({source_id, ids.at(target)});
     }
   }
 
+  SccDecomposition sccs = StronglyConnectedComponents(
+      CsrGraph::FromEdges(vertices.size(), edges));
+  std::vector<absl::btree_set<V>> result(sccs.component_count);
+  for (int64_t v = 0; v < vertices.size(); ++v) {
+    result[sccs.component[v]].insert(*vertices[v]);
+  }
   return result;
 }
 
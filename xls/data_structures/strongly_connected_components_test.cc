@@ -15,16 +15,22 @@
 #include "xls/data_structures/strongly_connected_components.h"
 
 #include <cstdint>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "benchmark/benchmark.h"
 
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+
 using V = std::string;
 
 absl::btree_set<V> FlattenSCCs(const std::vector<absl::btree_set<V>>& sccs) {
@@ -145,5 +151,92 @@ TEST(StronglyConnectedComponentsTest, Tree) {
   EXPECT_EQ(FlattenSCCs(sccs).size(), GraphSize(graph));
 }
 
+TEST(StronglyConnectedComponentsTest, CsrComponentsAreReverseTopological) {
+  // 0 -> {1 <-> 2} -> 3, plus an isolated vertex 4 and a self-loop on 3.
+  CsrGraph graph = CsrGraph::FromEdges(
+      5, {{0, 1}, {1, 2}, {2, 1}, {2, 3}, {3, 3}});
+  EXPECT_EQ(graph.vertex_count(), 5);
+  EXPECT_EQ(graph.edge_count(), 5);
+  EXPECT_THAT(graph.successors(2), ElementsAre(1, 3));
+  EXPECT_THAT(graph.successors(4), ElementsAre());
+
+  SccDecomposition sccs = StronglyConnectedComponents(graph);
+  EXPECT_EQ(sccs.component_count, 4);
+  EXPECT_EQ(sccs.component[1], sccs.component[2]);
+  EXPECT_GT(sccs.component[0], sccs.component[1]);
+  EXPECT_GT(sccs.component[1], sccs.component[3]);
+  EXPECT_THAT(sccs.Components()[sccs.component[1]], ElementsAre(1, 2));
+}
+
+TEST(StronglyConnectedComponentsTest, VertexIndexer) {
+  VertexIndexer<V> indexer;
+  EXPECT_EQ(indexer.GetOrAdd("b"), 0);
+  EXPECT_EQ(indexer.GetOrAdd("a"), 1);
+  EXPECT_EQ(indexer.GetOrAdd("b"), 0);
+  EXPECT_EQ(indexer.Find("a"), 1);
+  EXPECT_EQ(indexer.Find("c"), std::nullopt);
+  EXPECT_EQ(indexer.vertex(1), "a");
+  EXPECT_EQ(indexer.size(), 2);
+}
+
+TEST(StronglyConnectedComponentsTest, DeepGraph) {
+  // A long cycle and a long chain would overflow the stack of a recursive
+  // implementation.
+  constexpr int64_t kLength = 1000000;
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (int64_t i = 0; i + 1 < kLength; ++i) {
+    edges.push_back({i, i + 1});
+  }
+  SccDecomposition chain =
+      StronglyConnectedComponents(CsrGraph::FromEdges(kLength, edges));
+  EXPECT_EQ(chain.component_count, kLength);
+  EXPECT_EQ(chain.component[0], kLength - 1);
+
+  edges.push_back({kLength - 1, 0});
+  SccDecomposition cycle =
+      StronglyConnectedComponents(CsrGraph::FromEdges(kLength, edges));
+  EXPECT_EQ(cycle.component_count, 1);
+}
+
+std::vector<std::pair<int64_t, int64_t>> RandomEdges(int64_t vertex_count,
+                                                     int64_t edge_count) {
+  std::mt19937_64 bitgen(42);
+  std::uniform_int_distribution<int64_t> vertex(0, vertex_count - 1);
+  std::vector<std::pair<int64_t, int64_t>> edges(edge_count);
+  for (auto& [source, target] : edges) {
+    source = vertex(bitgen);
+    target = vertex(bitgen);
+  }
+  return edges;
+}
+
+// The argument is the number of edges; graphs have an average out-degree of 4.
+void BM_CsrStronglyConnectedComponents(benchmark::State& state) {
+  int64_t edge_count = state.range(0);
+  CsrGraph graph = CsrGraph::FromEdges(
+      edge_count / 4, RandomEdges(edge_count / 4, edge_count));
+  for (auto _ : state) {
+    SccDecomposition sccs = StronglyConnectedComponents(graph);
+    benchmark::DoNotOptimize(sccs);
+  }
+}
+
+void BM_BtreeStronglyConnectedComponents(benchmark::State& state) {
+  int64_t edge_count = state.range(0);
+  absl::btree_map<int64_t, absl::btree_set<int64_t>> graph;
+  for (const auto& [source, target] :
+       RandomEdges(edge_count / 4, edge_count)) {
+    graph[source].insert(target);
+  }
+  for (auto _ : state) {
+    std::vector<absl::btree_set<int64_t>> sccs =
+        StronglyConnectedComponents<int64_t>(graph);
+    benchmark::DoNotOptimize(sccs);
+  }
+}
+
+BENCHMARK(BM_CsrStronglyConnectedComponents)->Range(1024, 1 << 20);
+BENCHMARK(BM_BtreeStronglyConnectedComponents)->Range(1024, 1 << 20);
+
 }  // namespace
 }  // namespace xls
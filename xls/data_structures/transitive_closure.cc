@@ -0,0 +1,96 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/transitive_closure.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls::internal {
+namespace {
+
+// Returns the indices in topological order (each index after all the indices
+// which relate to it) or std::nullopt if the relation has a cycle.
+std::optional<std::vector<int64_t>> TopologicalOrder(
+    absl::Span<const std::vector<int64_t>> children) {
+  const int64_t n = children.size();
+  std::vector<int64_t> in_degree(n, 0);
+  for (const std::vector<int64_t>& c : children) {
+    for (int64_t child : c) {
+      ++in_degree[child];
+    }
+  }
+  std::vector<int64_t> order;
+  order.reserve(n);
+  for (int64_t i = 0; i < n; ++i) {
+    if (in_degree[i] == 0) {
+      order.push_back(i);
+    }
+  }
+  for (int64_t next = 0; next < order.size(); ++next) {
+    for (int64_t child : children[order[next]]) {
+      if (--in_degree[child] == 0) {
+        order.push_back(child);
+      }
+    }
+  }
+  if (order.size() != n) {
+    return std::nullopt;
+  }
+  return order;
+}
+
+}  // namespace
+
+std::vector<InlineBitmap> DenseTransitiveClosure(
+    absl::Span<const std::vector<int64_t>> children) {
+  const int64_t n = children.size();
+  std::vector<InlineBitmap> closure(n, InlineBitmap(n));
+
+  if (std::optional<std::vector<int64_t>> order = TopologicalOrder(children);
+      order.has_value()) {
+    // Every child is complete before its parents so each element's row is the
+    // union of its children and their rows.
+    for (auto it = order->rbegin(); it != order->rend(); ++it) {
+      InlineBitmap& row = closure[*it];
+      for (int64_t child : children[*it]) {
+        row.Set(child);
+        row.Union(closure[child]);
+      }
+    }
+    return closure;
+  }
+
+  // Warshall's algorithm; after step k each row includes the elements reachable
+  // through intermediate elements <= k.
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t child : children[i]) {
+      closure[i].Set(child);
+    }
+  }
+  for (int64_t k = 0; k < n; ++k) {
+    for (int64_t i = 0; i < n; ++i) {
+      if (i != k && closure[i].Get(k)) {
+        closure[i].Union(closure[k]);
+      }
+    }
+  }
+  return closure;
+}
+
+}  // namespace xls::internal
@@ -15,22 +15,41 @@
 #ifndef XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 #define XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 
 template <typename V>
 using HashRelation = absl::flat_hash_map<V, absl::flat_hash_set<V>>;
 
-// Compute the transitive closure of a relation.
+namespace internal {
+
+// Computes the transitive closure of the relation over the dense indices
+// [0, children.size()) where `children[i]` holds the indices related to `i`.
+// Element `i` of the result has bit `j` set iff `i` relates to `j`.
+//
+// If the relation is acyclic the closure is propagated in a single pass in
+// reverse topological order. Otherwise Warshall's algorithm is used. Either way
+// rows are combined a word at a time.
+std::vector<InlineBitmap> DenseTransitiveClosure(
+    absl::Span<const std::vector<int64_t>> children);
+
+// Warshall's algorithm over hash sets. This was the implementation of
+// TransitiveClosure before it moved to dense bitmaps and is kept for
+// comparison in tests and benchmarks.
 template <typename V>
-HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
+HashRelation<V> HashTransitiveClosure(const HashRelation<V>& relation) {
   using Rel = HashRelation<V>;
 
   if (relation.empty()) {
@@ -106,6 +125,61 @@ HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
   return result;
 }
 
+}  // namespace internal
+
+// Compute the transitive closure of a relation. The result has an entry for
+// each element with an entry in `relation`.
+template <typename V>
+HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
+  using Rel = HashRelation<V>;
+
+  if (relation.empty()) {
+    return Rel();
+  }
+
+  // Number the elements densely, keys of the relation first.
+  std::vector<V> nodes;
+  absl::flat_hash_map<V, int64_t> node_to_index;
+  node_to_index.reserve(relation.size());
+  auto index_of = [&](const V& node) -> int64_t {
+    auto [it, inserted] = node_to_index.try_emplace(node, nodes.size());
+    if (inserted) {
+      nodes.push_back(node);
+    }
+    return it->second;
+  };
+  for (const auto& [node, _] : relation) {
+    index_of(node);
+  }
+  const int64_t key_count = nodes.size();
+  std::vector<std::vector<int64_t>> children(key_count);
+  for (const auto& [node, node_children] : relation) {
+    std::vector<int64_t>& indices = children[node_to_index.at(node)];
+    indices.reserve(node_children.size());
+    for (const V& child : node_children) {
+      indices.push_back(index_of(child));
+    }
+  }
+  // Elements which only appear as children relate to nothing.
+  children.resize(nodes.size());
+
+  std::vector<InlineBitmap> closure = internal::DenseTransitiveClosure(children);
+
+  Rel result;
+  result.reserve(key_count);
+  for (int64_t i = 0; i < key_count; ++i) {
+    absl::flat_hash_set<V>& related = result[nodes[i]];
+    const InlineBitmap& row = closure[i];
+    // Visit only the set bits, a word at a time.
+    for (int64_t w = 0; w < row.word_count(); ++w) {
+      for (uint64_t word = row.GetWord(w); word != 0; word &= word - 1) {
+        related.insert(nodes[w * 64 + absl::countr_zero(word)]);
+      }
+    }
+  }
+  return result;
+}
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
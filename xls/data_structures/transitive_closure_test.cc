@@ -14,16 +14,22 @@
 
 #include "xls/data_structures/transitive_closure.h"
 
+#include <cstdint>
+#include <random>
 #include <string>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/distributions.h"
+#include "benchmark/benchmark.h"
 
 namespace xls {
 namespace {
 
+using ::testing::IsEmpty;
 using ::testing::UnorderedElementsAre;
 
 using V = std::string;
@@ -43,5 +49,84 @@ TEST(TransitiveClosureTest, Simple) {
   EXPECT_FALSE(tc.contains("qux"));
 }
 
+TEST(TransitiveClosureTest, Cycle) {
+  HashRelation<V> rel;
+  rel["a"].insert("b");
+  rel["b"].insert("c");
+  rel["c"].insert("a");
+  rel["c"].insert("d");
+  rel["e"];
+  HashRelation<V> tc = TransitiveClosure<V>(rel);
+  EXPECT_THAT(tc.at("a"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("b"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("c"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("e"), IsEmpty());
+  EXPECT_FALSE(tc.contains("d"));
+}
+
+TEST(TransitiveClosureTest, SelfLoop) {
+  HashRelation<V> rel;
+  rel["a"].insert("a");
+  rel["a"].insert("b");
+  HashRelation<V> tc = TransitiveClosure<V>(rel);
+  EXPECT_THAT(tc.at("a"), UnorderedElementsAre("a", "b"));
+  EXPECT_FALSE(tc.contains("b"));
+}
+
+// Returns a random relation over `n` integers with the given edge probability.
+// If `acyclic` is true elements only relate to larger elements.
+HashRelation<int64_t> RandomRelation(int64_t n, double edge_probability,
+                                     bool acyclic, absl::BitGenRef bitgen) {
+  HashRelation<int64_t> rel;
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j = acyclic ? i + 1 : 0; j < n; ++j) {
+      if (absl::Bernoulli(bitgen, edge_probability)) {
+        rel[i].insert(j);
+      }
+    }
+  }
+  return rel;
+}
+
+TEST(TransitiveClosureTest, MatchesHashImplementation) {
+  std::mt19937_64 bitgen(42);
+  for (bool acyclic : {false, true}) {
+    for (int64_t n : {1, 7, 64, 65, 150}) {
+      HashRelation<int64_t> rel =
+          RandomRelation(n, 2.0 / n, acyclic, bitgen);
+      EXPECT_EQ(TransitiveClosure<int64_t>(rel),
+                internal::HashTransitiveClosure<int64_t>(rel))
+          << "n=" << n << " acyclic=" << acyclic;
+    }
+  }
+}
+
+template <bool kAcyclic>
+void BM_TransitiveClosure(benchmark::State& state) {
+  std::mt19937_64 bitgen(42);
+  HashRelation<int64_t> rel =
+      RandomRelation(state.range(0), 4.0 / state.range(0), kAcyclic, bitgen);
+  for (auto _ : state) {
+    auto v = TransitiveClosure<int64_t>(rel);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+template <bool kAcyclic>
+void BM_HashTransitiveClosure(benchmark::State& state) {
+  std::mt19937_64 bitgen(42);
+  HashRelation<int64_t> rel =
+      RandomRelation(state.range(0), 4.0 / state.range(0), kAcyclic, bitgen);
+  for (auto _ : state) {
+    auto v = internal::HashTransitiveClosure<int64_t>(rel);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_TransitiveClosure, true)->Range(16, 4096);
+BENCHMARK_TEMPLATE(BM_TransitiveClosure, false)->Range(16, 4096);
+BENCHMARK_TEMPLATE(BM_HashTransitiveClosure, true)->Range(16, 256);
+BENCHMARK_TEMPLATE(BM_HashTransitiveClosure, false)->Range(16, 256);
+
 }  // namespace
 }  // namespace xls
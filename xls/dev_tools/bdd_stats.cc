@@ -134,7 +134,7 @@ absl::Status RealMain(std::string_view input_path) {
     std::cout << "Bits in graph: " << number_bits << "\n";
 
     int64_t max_paths = 0;
-    for (int64_t i = 0; i < bdd_function->bdd().size(); ++i) {
+    for (int64_t i = 0; i < bdd_function->bdd().table_size(); ++i) {
       max_paths =
           std::max(max_paths, bdd_function->bdd().path_count(BddNodeIndex(i)));
     }
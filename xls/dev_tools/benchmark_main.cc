@@ -679,6 +679,25 @@ absl::Status RunBlockInterpreterAndJit(Block* block,
   std::cout << absl::StreamFormat(
       "Interpreter run time (%s): %d calls/s\n", description,
       static_cast<int64_t>(kInputCount * interpreter_run_rate));
+
+  // The compiled interpreter only handles blocks without instantiations.
+  absl::StatusOr<std::unique_ptr<CompiledBlockInterpreter>> compiled =
+      CompiledBlockInterpreter::Create(block);
+  if (compiled.ok()) {
+    XLS_ASSIGN_OR_RETURN(
+        float compiled_run_rate,
+        CountRate(
+            [&]() -> absl::Status {
+              for (const std::vector<Value>& ports : arg_set) {
+                CHECK_OK((*compiled)->RunOneCycle(ports));
+              }
+              return absl::OkStatus();
+            },
+            kRunDurationMs));
+    std::cout << absl::StreamFormat(
+        "Compiled interpreter run time (%s): %d calls/s\n", description,
+        static_cast<int64_t>(kInputCount * compiled_run_rate));
+  }
   return absl::OkStatus();
 }
 
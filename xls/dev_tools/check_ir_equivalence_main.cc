@@ -90,17 +90,26 @@ ABSL_FLAG(int, match_exit_code, 0,
           "Value to exit with if equivalence is not proven.");
 ABSL_FLAG(absl::Duration, timeout, absl::InfiniteDuration(),
           "How long to wait for any proof to complete.");
+ABSL_FLAG(int64_t, simulation_samples, 256,
+          "How many random inputs to simulate before invoking the solver. A "
+          "mismatch found by simulation is reported without a proof. Zero "
+          "disables simulation.");
+ABSL_FLAG(int64_t, max_cut_points, 256,
+          "How many simulation-identified internal equivalences to try to "
+          "prove and merge before the final proof.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls {
 namespace {
 
 absl::StatusOr<solvers::z3::ProverResult> CheckFunctionEquivalence(
-    Function* f1, Function* f2, absl::Duration timeout) {
-  return solvers::z3::TryProveEquivalence(f1, f2, timeout);
+    Function* f1, Function* f2,
+    const solvers::z3::EquivalenceCheckOptions& options) {
+  return solvers::z3::TryProveEquivalence(f1, f2, options);
 }
 absl::StatusOr<solvers::z3::ProverResult> CheckProcEquivalence(
-    Proc* p1, Proc* p2, int64_t activation_count, absl::Duration timeout) {
+    Proc* p1, Proc* p2, int64_t activation_count,
+    const solvers::z3::EquivalenceCheckOptions& options) {
   XLS_ASSIGN_OR_RETURN(
       Function * f1,
       UnrollProcToFunction(p1, activation_count, /*include_state=*/false),
@@ -109,7 +118,7 @@ absl::StatusOr<solvers::z3::ProverResult> CheckProcEquivalence(
       Function * f2,
       UnrollProcToFunction(p2, activation_count, /*include_state=*/false),
       _ << "Unable to unroll: " << p2->DumpIr());
-  return CheckFunctionEquivalence(f1, f2, timeout);
+  return CheckFunctionEquivalence(f1, f2, options);
 }
 
 absl::StatusOr<std::vector<std::string>> CounterexampleParams(
@@ -228,7 +237,8 @@ class AssertAndCoverRemovalPass : public OptimizationFunctionBasePass {
 absl::StatusOr<bool> RealMain(const std::vector<std::string_view>& ir_paths,
                               const std::string& entry,
                               std::optional<int64_t> activation_count,
-                              absl::Duration timeout) {
+                              const solvers::z3::EquivalenceCheckOptions&
+                                  equivalence_options) {
   std::vector<std::unique_ptr<Package>> packages;
   for (const auto ir_path : ir_paths) {
     XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
@@ -283,9 +293,10 @@ absl::StatusOr<bool> RealMain(const std::vector<std::string_view>& ir_paths,
     if (!functions[1]->IsFunction()) {
       return absl::InvalidArgumentError("Both inputs must be functions");
     }
-    XLS_ASSIGN_OR_RETURN(result, CheckFunctionEquivalence(
-                                     functions[0]->AsFunctionOrDie(),
-                                     functions[1]->AsFunctionOrDie(), timeout));
+    XLS_ASSIGN_OR_RETURN(
+        result, CheckFunctionEquivalence(functions[0]->AsFunctionOrDie(),
+                                         functions[1]->AsFunctionOrDie(),
+                                         equivalence_options));
   } else if (functions[0]->IsProc()) {
     if (!functions[1]->IsProc()) {
       return absl::InvalidArgumentError("Both inputs must be procs");
@@ -297,7 +308,8 @@ absl::StatusOr<bool> RealMain(const std::vector<std::string_view>& ir_paths,
     XLS_ASSIGN_OR_RETURN(result,
                          CheckProcEquivalence(functions[0]->AsProcOrDie(),
                                               functions[1]->AsProcOrDie(),
-                                              *activation_count, timeout));
+                                              *activation_count,
+                                              equivalence_options));
   } else {
     return absl::InternalError(
         "Block equivalence checking not supported currently.");
@@ -326,9 +338,14 @@ int main(int argc, char** argv) {
   std::vector<std::string_view> positional_args =
       xls::InitXls(kUsage, argc, argv);
   QCHECK_EQ(positional_args.size(), 2) << "Two IR files must be specified!";
-  auto result = xls::RealMain(positional_args, absl::GetFlag(FLAGS_top),
-                              absl::GetFlag(FLAGS_activation_count),
-                              absl::GetFlag(FLAGS_timeout));
+  auto result = xls::RealMain(
+      positional_args, absl::GetFlag(FLAGS_top),
+      absl::GetFlag(FLAGS_activation_count),
+      xls::solvers::z3::EquivalenceCheckOptions{
+          .timeout = absl::GetFlag(FLAGS_timeout),
+          .simulation_samples = absl::GetFlag(FLAGS_simulation_samples),
+          .max_cut_points = absl::GetFlag(FLAGS_max_cut_points),
+      });
   if (!result.ok()) {
     return xls::ExitStatus(result.status());
   }
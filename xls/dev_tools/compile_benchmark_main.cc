@@ -0,0 +1,385 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks the compile time of a curated set of designs through the whole
+// flow (DSLX to IR, optimization, scheduling, codegen and JIT compilation and
+// evaluation), writes per-stage timings as an xls.CompileBenchmarkResults
+// proto and optionally compares them against a stored baseline.
+//
+// To record a baseline:
+//
+//   bazel run -c opt //xls/dev_tools:compile_benchmark_main -- \
+//     --output_path=/tmp/baseline.textproto
+//
+// and to check a change against it:
+//
+//   bazel run -c opt //xls/dev_tools:compile_benchmark_main -- \
+//     --baseline_path=/tmp/baseline.textproto
+//
+// The exit status is non-zero if any stage regressed by more than
+// --max_regression.
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dev_tools/compile_benchmark.pb.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/ir_convert/conversion_info.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/passes/pass_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_flags.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/opt.h"
+#include "xls/tools/scheduling_options_flags.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+
+ABSL_FLAG(std::string, config_path,
+          "xls/dev_tools/compile_benchmark_designs.textproto",
+          "Path (absolute or runfiles-relative) of the "
+          "xls.CompileBenchmarkConfig textproto listing the designs.");
+ABSL_FLAG(std::vector<std::string>, designs, {},
+          "Names of the designs to benchmark. Benchmarks all designs in the "
+          "config if empty. Run designs one at a time for per-design peak "
+          "memory numbers.");
+ABSL_FLAG(int64_t, runs, 1,
+          "Number of times to compile each design. The fastest time of each "
+          "stage is reported.");
+ABSL_FLAG(std::string, output_path, "",
+          "If given, write the results as an xls.CompileBenchmarkResults "
+          "textproto to this path.");
+ABSL_FLAG(std::string, baseline_path, "",
+          "If given, compare the results against this "
+          "xls.CompileBenchmarkResults textproto.");
+ABSL_FLAG(double, max_regression, 0.25,
+          "Maximum allowed slowdown of a stage relative to the baseline, as a "
+          "fraction of the baseline time.");
+ABSL_FLAG(double, min_regression_ms, 50.0,
+          "Slowdowns smaller than this many milliseconds are never reported, "
+          "to keep short stages from tripping on noise.");
+
+namespace xls {
+namespace {
+
+// Number of times the JIT-compiled function is invoked (or procs ticked) in
+// the "jit_eval" stage.
+constexpr int64_t kJitEvalIterations = 1000;
+
+absl::StatusOr<std::filesystem::path> ResolvePath(std::string_view path) {
+  if (FileExists(path).ok()) {
+    return std::filesystem::path(path);
+  }
+  return GetXlsRunfilePath(path);
+}
+
+// Runs `f` and appends its timing to `result` as `stage`.
+absl::Status TimeStage(std::string_view stage,
+                       const std::function<absl::Status()>& f,
+                       CompileBenchmarkDesignResult& result) {
+  absl::Time start = absl::Now();
+  XLS_RETURN_IF_ERROR(f());
+  CompileBenchmarkStage* proto = result.add_stages();
+  proto->set_stage(std::string{stage});
+  proto->set_wall_time_ms(absl::ToDoubleMilliseconds(absl::Now() - start));
+  proto->set_peak_rss_bytes(internal::PeakRssBytes());
+  return absl::OkStatus();
+}
+
+absl::Status RunJit(FunctionBase* top, CompileBenchmarkDesignResult& result) {
+  if (top->IsFunction()) {
+    Function* function = top->AsFunctionOrDie();
+    std::unique_ptr<FunctionJit> jit;
+    XLS_RETURN_IF_ERROR(TimeStage(
+        "jit_compile",
+        [&]() -> absl::Status {
+          XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(function));
+          return absl::OkStatus();
+        },
+        result));
+    std::vector<Value> args;
+    for (Param* param : function->params()) {
+      args.push_back(ZeroOfType(param->GetType()));
+    }
+    return TimeStage(
+        "jit_eval",
+        [&]() -> absl::Status {
+          for (int64_t i = 0; i < kJitEvalIterations; ++i) {
+            XLS_RETURN_IF_ERROR(jit->Run(args).status());
+          }
+          return absl::OkStatus();
+        },
+        result);
+  }
+
+  XLS_RET_CHECK(top->IsProc()) << "Unsupported top: " << top->name();
+  Proc* proc = top->AsProcOrDie();
+  std::unique_ptr<SerialProcRuntime> runtime;
+  XLS_RETURN_IF_ERROR(TimeStage(
+      "jit_compile",
+      [&]() -> absl::Status {
+        if (proc->is_new_style_proc()) {
+          XLS_ASSIGN_OR_RETURN(runtime, CreateJitSerialProcRuntime(proc));
+        } else {
+          XLS_ASSIGN_OR_RETURN(runtime,
+                               CreateJitSerialProcRuntime(proc->package()));
+        }
+        return absl::OkStatus();
+      },
+      result));
+  return TimeStage(
+      "jit_eval",
+      [&]() -> absl::Status {
+        // No inputs are provided so most networks deadlock waiting on input
+        // after a few ticks; that ends the stage.
+        for (int64_t i = 0; i < kJitEvalIterations; ++i) {
+          if (!runtime->Tick().ok()) {
+            break;
+          }
+        }
+        return absl::OkStatus();
+      },
+      result);
+}
+
+absl::StatusOr<CompileBenchmarkDesignResult> CompileDesignOnce(
+    const CompileBenchmarkDesign& design) {
+  CompileBenchmarkDesignResult result;
+  result.set_name(design.name());
+
+  std::unique_ptr<Package> package;
+  XLS_RETURN_IF_ERROR(TimeStage(
+      "dslx_to_ir",
+      [&]() -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(std::filesystem::path path,
+                             ResolvePath(design.dslx_path()));
+        std::string path_str = path.string();
+        std::vector<std::string_view> paths = {path_str};
+        XLS_ASSIGN_OR_RETURN(
+            dslx::PackageConversionData conversion,
+            dslx::ConvertFilesToPackage(paths, kDefaultDslxStdlibPath,
+                                        /*dslx_paths=*/{},
+                                        dslx::ConvertOptions(),
+                                        /*top=*/design.dslx_top()));
+        package = std::move(conversion.package);
+        return absl::OkStatus();
+      },
+      result));
+  XLS_RET_CHECK(package->GetTop().has_value());
+  std::string top_name = package->GetTop().value()->name();
+
+  XLS_RETURN_IF_ERROR(TimeStage(
+      "opt",
+      [&]() -> absl::Status {
+        tools::OptOptions options;
+        options.top = top_name;
+        return tools::OptimizeIrForTop(package.get(), options);
+      },
+      result));
+  XLS_ASSIGN_OR_RETURN(FunctionBase * top,
+                       package->GetFunctionBaseByName(top_name));
+  result.set_optimized_node_count(top->node_count());
+
+  XLS_ASSIGN_OR_RETURN(SchedulingOptionsFlagsProto scheduling_options,
+                       GetSchedulingOptionsFlagsProto());
+  XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags, GetCodegenFlags());
+  codegen_flags.set_generator(GENERATOR_KIND_PIPELINE);
+  scheduling_options.set_pipeline_stages(design.pipeline_stages());
+  if (design.has_delay_model()) {
+    scheduling_options.set_delay_model(design.delay_model());
+  } else if (scheduling_options.delay_model().empty()) {
+    scheduling_options.set_delay_model("unit");
+  }
+
+  PipelineScheduleOrGroup schedules = PackagePipelineSchedules();
+  XLS_RETURN_IF_ERROR(TimeStage(
+      "schedule",
+      [&]() -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(
+            schedules, Schedule(package.get(), scheduling_options,
+                                codegen_flags, /*scheduling_time=*/nullptr));
+        return absl::OkStatus();
+      },
+      result));
+  XLS_RETURN_IF_ERROR(TimeStage(
+      "codegen",
+      [&]() -> absl::Status {
+        return Codegen(package.get(), scheduling_options, codegen_flags,
+                       /*with_delay_model=*/true, &schedules,
+                       /*codegen_time=*/nullptr)
+            .status();
+      },
+      result));
+
+  XLS_RETURN_IF_ERROR(RunJit(top, result));
+  return result;
+}
+
+// Compiles `design` --runs times and keeps the fastest time of each stage.
+absl::StatusOr<CompileBenchmarkDesignResult> CompileDesign(
+    const CompileBenchmarkDesign& design, int64_t runs) {
+  XLS_RET_CHECK_GE(runs, 1);
+  XLS_ASSIGN_OR_RETURN(CompileBenchmarkDesignResult best,
+                       CompileDesignOnce(design));
+  for (int64_t run = 1; run < runs; ++run) {
+    XLS_ASSIGN_OR_RETURN(CompileBenchmarkDesignResult result,
+                         CompileDesignOnce(design));
+    XLS_RET_CHECK_EQ(result.stages_size(), best.stages_size());
+    for (int64_t i = 0; i < result.stages_size(); ++i) {
+      CompileBenchmarkStage* stage = best.mutable_stages(i);
+      stage->set_wall_time_ms(
+          std::min(stage->wall_time_ms(), result.stages(i).wall_time_ms()));
+      stage->set_peak_rss_bytes(result.stages(i).peak_rss_bytes());
+    }
+  }
+  return best;
+}
+
+// Returns a description of every stage in `results` which is slower than in
+// `baseline` by more than the allowed margin.
+std::vector<std::string> FindRegressions(
+    const CompileBenchmarkResults& results,
+    const CompileBenchmarkResults& baseline, double max_regression,
+    double min_regression_ms) {
+  absl::flat_hash_map<std::pair<std::string, std::string>, double>
+      baseline_times;
+  for (const CompileBenchmarkDesignResult& design : baseline.designs()) {
+    for (const CompileBenchmarkStage& stage : design.stages()) {
+      baseline_times[{design.name(), stage.stage()}] = stage.wall_time_ms();
+    }
+  }
+  std::vector<std::string> regressions;
+  for (const CompileBenchmarkDesignResult& design : results.designs()) {
+    for (const CompileBenchmarkStage& stage : design.stages()) {
+      auto it = baseline_times.find({design.name(), stage.stage()});
+      if (it == baseline_times.end()) {
+        continue;
+      }
+      double delta_ms = stage.wall_time_ms() - it->second;
+      if (delta_ms > min_regression_ms &&
+          delta_ms > max_regression * it->second) {
+        regressions.push_back(absl::StrFormat(
+            "%s/%s: %.1fms -> %.1fms (%+.0f%%)", design.name(), stage.stage(),
+            it->second, stage.wall_time_ms(), 100.0 * delta_ms / it->second));
+      }
+    }
+  }
+  return regressions;
+}
+
+void PrintResults(const CompileBenchmarkResults& results) {
+  for (const CompileBenchmarkDesignResult& design : results.designs()) {
+    std::cout << absl::StrFormat("%s (%d nodes after opt)\n", design.name(),
+                                 design.optimized_node_count());
+    for (const CompileBenchmarkStage& stage : design.stages()) {
+      std::cout << absl::StrFormat("  %-12s %10.1fms %8.1fMiB\n",
+                                   stage.stage(), stage.wall_time_ms(),
+                                   stage.peak_rss_bytes() / (1024.0 * 1024.0));
+    }
+  }
+}
+
+absl::Status RealMain() {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path config_path,
+                       ResolvePath(absl::GetFlag(FLAGS_config_path)));
+  XLS_ASSIGN_OR_RETURN(
+      CompileBenchmarkConfig config,
+      ParseTextProtoFile<CompileBenchmarkConfig>(config_path));
+  std::vector<std::string> design_names = absl::GetFlag(FLAGS_designs);
+  absl::flat_hash_set<std::string> selected(design_names.begin(),
+                                            design_names.end());
+
+  CompileBenchmarkResults results;
+  for (const CompileBenchmarkDesign& design : config.designs()) {
+    if (!selected.empty() && !selected.erase(design.name())) {
+      continue;
+    }
+    LOG(INFO) << "Benchmarking " << design.name();
+    XLS_ASSIGN_OR_RETURN(*results.add_designs(),
+                         CompileDesign(design, absl::GetFlag(FLAGS_runs)));
+  }
+  if (!selected.empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown designs: %s", absl::StrJoin(selected, ", ")));
+  }
+  PrintResults(results);
+
+  if (!absl::GetFlag(FLAGS_output_path).empty()) {
+    XLS_RETURN_IF_ERROR(
+        SetTextProtoFile(absl::GetFlag(FLAGS_output_path), results));
+  }
+  if (absl::GetFlag(FLAGS_baseline_path).empty()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(CompileBenchmarkResults baseline,
+                       ParseTextProtoFile<CompileBenchmarkResults>(
+                           absl::GetFlag(FLAGS_baseline_path)));
+  std::vector<std::string> regressions =
+      FindRegressions(results, baseline, absl::GetFlag(FLAGS_max_regression),
+                      absl::GetFlag(FLAGS_min_regression_ms));
+  if (regressions.empty()) {
+    std::cout << "No compile-time regressions against the baseline.\n";
+    return absl::OkStatus();
+  }
+  return absl::FailedPreconditionError(
+      absl::StrFormat("Compile-time regressions against the baseline:\n  %s",
+                      absl::StrJoin(regressions, "\n  ")));
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments = xls::InitXls(
+      "Benchmarks compile time of the designs in --config_path.", argc, argv);
+  QCHECK(positional_arguments.empty())
+      << "Unexpected positional arguments: "
+      << absl::StrJoin(positional_arguments, " ");
+  return xls::ExitStatus(xls::RealMain());
+}
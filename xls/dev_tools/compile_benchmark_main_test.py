@@ -0,0 +1,97 @@
+# Copyright 2024 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for compile_benchmark_main."""
+
+import subprocess
+
+from google.protobuf import text_format
+from xls.common import runfiles
+from xls.common import test_base
+from xls.dev_tools import compile_benchmark_pb2
+
+BINARY_PATH = runfiles.get_path('xls/dev_tools/compile_benchmark_main')
+
+STAGES = [
+    'dslx_to_ir',
+    'opt',
+    'schedule',
+    'codegen',
+    'jit_compile',
+    'jit_eval',
+]
+
+
+def _make_baseline(wall_time_ms: float) -> str:
+  results = compile_benchmark_pb2.CompileBenchmarkResults()
+  design = results.designs.add(name='nested_sel')
+  for stage in STAGES:
+    design.stages.add(stage=stage, wall_time_ms=wall_time_ms)
+  return text_format.MessageToString(results)
+
+
+class CompileBenchmarkMainTest(test_base.TestCase):
+
+  def test_writes_results(self):
+    output_file = self.create_tempfile()
+    subprocess.check_call([
+        BINARY_PATH,
+        '--designs=nested_sel',
+        '--output_path=' + output_file.full_path,
+    ])
+    results = text_format.Parse(
+        output_file.read_text(), compile_benchmark_pb2.CompileBenchmarkResults()
+    )
+    self.assertLen(results.designs, 1)
+    self.assertEqual(results.designs[0].name, 'nested_sel')
+    self.assertEqual([s.stage for s in results.designs[0].stages], STAGES)
+    self.assertGreater(results.designs[0].optimized_node_count, 0)
+
+  def test_no_regression(self):
+    baseline_file = self.create_tempfile(content=_make_baseline(1e9))
+    subprocess.check_call([
+        BINARY_PATH,
+        '--designs=nested_sel',
+        '--baseline_path=' + baseline_file.full_path,
+    ])
+
+  def test_regression(self):
+    baseline_file = self.create_tempfile(content=_make_baseline(0.0))
+    comp = subprocess.run(
+        [
+            BINARY_PATH,
+            '--designs=nested_sel',
+            '--baseline_path=' + baseline_file.full_path,
+            '--min_regression_ms=0',
+        ],
+        stderr=subprocess.PIPE,
+        encoding='utf-8',
+        check=False,
+    )
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('nested_sel/opt', comp.stderr)
+
+  def test_unknown_design(self):
+    comp = subprocess.run(
+        [BINARY_PATH, '--designs=not_a_design'],
+        stderr=subprocess.PIPE,
+        encoding='utf-8',
+        check=False,
+    )
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('Unknown designs: not_a_design', comp.stderr)
+
+
+if __name__ == '__main__':
+  test_base.main()
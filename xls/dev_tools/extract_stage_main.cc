@@ -15,7 +15,6 @@
 // Simple driver for executing the ExtractStage() routine.
 #include <optional>
 #include <string>
-#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
@@ -24,8 +23,10 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/scheduling/extract_stage.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
@@ -66,27 +67,22 @@ static absl::Status RealMain(const std::string& ir_path,
       ParseTextProtoFile<PackagePipelineSchedulesProto>(schedule_path));
   XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
                        PipelineSchedule::FromProto(function, proto));
-  std::vector<FunctionBase*> funcs = package->GetFunctionBases();
-
+  // Build the stages directly into a new package so nothing outside of the
+  // extracted stages has to be copied or torn down.
+  Package extracted(package->name());
   if (stage == -1) {
     for (int i = 0; i < schedule.length(); ++i) {
       XLS_ASSIGN_OR_RETURN(Function * stage,
-                           ExtractStage(function, schedule, i));
-      XLS_RETURN_IF_ERROR(package->SetTop(stage));
+                           ExtractStage(function, schedule, i, &extracted));
+      XLS_RETURN_IF_ERROR(extracted.SetTop(stage));
     }
   } else {
     XLS_ASSIGN_OR_RETURN(Function * stage,
-                         ExtractStage(function, schedule, stage));
-    XLS_RETURN_IF_ERROR(package->SetTop(stage));
+                         ExtractStage(function, schedule, stage, &extracted));
+    XLS_RETURN_IF_ERROR(extracted.SetTop(stage));
   }
 
-  for (auto& f : funcs) {
-    XLS_RETURN_IF_ERROR(package->RemoveFunctionBase(f));
-  }
-  while (!package->channels().empty()) {
-    XLS_RETURN_IF_ERROR(package->RemoveChannel(package->channels().front()));
-  }
-  XLS_RETURN_IF_ERROR(SetFileContents(output_path, package->DumpIr()));
+  XLS_RETURN_IF_ERROR(SetFileContents(output_path, extracted.DumpIr()));
 
   return absl::OkStatus();
 }
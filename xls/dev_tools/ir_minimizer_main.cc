@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <iostream>
 #include <iterator>
 #include <memory>
@@ -22,15 +24,18 @@
 #include <random>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/random/bit_gen_ref.h"
@@ -42,6 +47,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
@@ -51,6 +57,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/binary_search.h"
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/dev_tools/extract_segment.h"
@@ -67,6 +74,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/package_transaction.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/state_element.h"
 #include "xls/ir/type.h"
@@ -119,6 +127,15 @@ from the interpreter results. Example invocation:
   ir_minimizer_main --test_llvm_jit --use_optimization_pipeline \
     --input='bits[32]:42; bits[1]:0' IR_FILE
 
+--test_optimizer and --test_optimizer_fails similarly test for optimizer bugs
+in-process, without launching a subprocess per candidate.
+
+With --parallelism=N, N candidate simplifications of the smallest known
+failing IR are derived independently and tested concurrently, and the smallest
+which still fails is kept. With --checkpoint_path the smallest known failing
+IR is saved as minimization progresses, and an interrupted run given the same
+--checkpoint_path resumes from it.
+
 )";
 
 ABSL_FLAG(bool, can_remove_params, false,
@@ -168,6 +185,10 @@ ABSL_FLAG(bool, test_llvm_jit, false,
           "Tests for differences between results from the JIT and the "
           "interpreter as the reduction test case. Must specify --input with "
           "this flag. Cannot be used with --test_optimizer.");
+ABSL_FLAG(bool, test_optimizer_fails, false,
+          "If true, the IR exhibits the bug if the optimization pipeline "
+          "returns an error on it. Cannot be used with --test_executable, "
+          "--test_llvm_jit or --test_optimizer.");
 ABSL_FLAG(bool, test_optimizer, false,
           "Tests for differences between results from the unoptimized and "
           "optimized IR as the reduction test case. Must specify --input with "
@@ -219,6 +240,15 @@ ABSL_FLAG(
     "well-formed IR fails to parse, it is useful to disable IR verification so "
     "the minimizer can proceed and help you understand why it fails to "
     "verify.");
+ABSL_FLAG(int64_t, parallelism, 1,
+          "Number of candidate simplifications to test concurrently. Each "
+          "candidate is derived independently from the smallest known "
+          "failing IR and the smallest candidate which still fails is kept. "
+          "Most useful when --test_executable is long-running.");
+ABSL_FLAG(std::string, checkpoint_path, "",
+          "If set, the smallest known failing IR is written to this file "
+          "whenever it changes. If the file exists when starting, "
+          "minimization resumes from its contents instead of the IR file.");
 ABSL_FLAG(bool, simplify_top_only, false,
           "If true only the top function/proc/block will be actively "
           "simplified. Otherwise each simplification will use a function "
@@ -305,6 +335,23 @@ absl::StatusOr<bool> StillFailsHelper(
     return subproc_result.exit_status == 0;
   }
 
+  if (absl::GetFlag(FLAGS_test_optimizer_fails)) {
+    // Test for bugs by running the optimization pipeline and checking for an
+    // error.
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         ParsePackage(ir_text));
+    std::unique_ptr<OptimizationCompoundPass> pipeline =
+        CreateOptimizationPassPipeline();
+    PassResults results;
+    absl::Status status =
+        pipeline->Run(package.get(), OptimizationPassOptions(), &results)
+            .status();
+    if (!status.ok()) {
+      VLOG(2) << "Optimization failed: " << status;
+    }
+    return !status.ok();
+  }
+
   if (absl::GetFlag(FLAGS_test_optimizer)) {
     // Test for bugs by comparing the results of the unoptimized & optimized IR.
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
@@ -363,26 +410,48 @@ absl::StatusOr<bool> StillFailsHelper(
   return jit_result.value != interpreter_result.value;
 }
 
+// Results of testing IR texts, shared by concurrently running tests.
+class TestCache {
+ public:
+  std::optional<bool> Get(std::string_view ir_text) {
+    absl::MutexLock lock(&mutex_);
+    auto it = results_.find(ir_text);
+    if (it == results_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  void Set(std::string_view ir_text, bool still_fails) {
+    absl::MutexLock lock(&mutex_);
+    results_[ir_text] = still_fails;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, bool> results_ ABSL_GUARDED_BY(mutex_);
+};
+
 // Wrapper around StillFails which memoizes the result. Optional test_cache is
 // used to memoize the results of testing the given IR.
-absl::StatusOr<bool> StillFails(
-    std::string_view ir_text, std::optional<std::vector<Value>> inputs,
-    absl::flat_hash_map<std::string, bool>* test_cache) {
+absl::StatusOr<bool> StillFails(std::string_view ir_text,
+                                std::optional<std::vector<Value>> inputs,
+                                TestCache* test_cache) {
   VLOG(1) << "=== Verifying contents still fails";
   XLS_VLOG_LINES(2, ir_text);
 
   if (test_cache != nullptr) {
-    auto it = test_cache->find(ir_text);
-    if (it != test_cache->end()) {
+    std::optional<bool> cached = test_cache->Get(ir_text);
+    if (cached.has_value()) {
       LOG(INFO) << absl::StreamFormat("Found result in cache (failed = %d)",
-                                      it->second);
-      return it->second;
+                                      *cached);
+      return *cached;
     }
   }
 
   XLS_ASSIGN_OR_RETURN(bool result, StillFailsHelper(ir_text, inputs));
   if (test_cache != nullptr) {
-    (*test_cache)[ir_text] = result;
+    test_cache->Set(ir_text, result);
   }
   return result;
 }
@@ -390,10 +459,10 @@ absl::StatusOr<bool> StillFails(
 // Writes the IR out to a temporary file, runs the test executable on it, and
 // returns 'true' if the test (still) fails on that IR text.  Optional test
 // cache is used to memoize the results of testing the given IR.
-absl::Status VerifyStillFails(
-    std::string_view ir_text, std::optional<std::vector<Value>> inputs,
-    std::string_view description,
-    absl::flat_hash_map<std::string, bool>* test_cache) {
+absl::Status VerifyStillFails(std::string_view ir_text,
+                              std::optional<std::vector<Value>> inputs,
+                              std::string_view description,
+                              TestCache* test_cache) {
   XLS_ASSIGN_OR_RETURN(bool still_fails,
                        StillFails(ir_text, inputs, test_cache));
 
@@ -1221,14 +1290,120 @@ absl::Status CleanUp(FunctionBase* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
+// A simplification made on top of the ones before it in a chain of candidate
+// changes.
+struct CandidateChange {
+  std::string which_transform;
+  std::string candidate_name;
+  std::string package_ir_text;
+  std::string candidate_ir_text;
+  int64_t node_count;
+};
+
+// Calls `f` on each index in [0, count), running up to --parallelism calls
+// concurrently. Returns the first error in index order.
+absl::Status ParallelFor(int64_t count,
+                         absl::FunctionRef<absl::Status(int64_t)> f) {
+  int64_t thread_count = std::min(absl::GetFlag(FLAGS_parallelism), count);
+  if (thread_count <= 1) {
+    for (int64_t i = 0; i < count; ++i) {
+      XLS_RETURN_IF_ERROR(f(i));
+    }
+    return absl::OkStatus();
+  }
+  std::vector<absl::Status> statuses(count);
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < count;
+         i = next_index.fetch_add(1)) {
+      statuses[i] = f(i);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (auto& t : threads) {
+    t->Join();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+// Returns, for each chain, the length of its longest prefix which still fails
+// (zero if none does). Assumes that once a change in a chain makes the sample
+// pass, later changes do not make it fail again.
+absl::StatusOr<std::vector<int64_t>> FailingPrefixLengths(
+    absl::Span<const std::vector<CandidateChange>> chains,
+    const std::optional<std::vector<Value>>& inputs, TestCache* test_cache) {
+  std::vector<int64_t> lengths(chains.size());
+  XLS_RETURN_IF_ERROR(
+      ParallelFor(chains.size(), [&](int64_t c) -> absl::Status {
+        const std::vector<CandidateChange>& chain = chains[c];
+        XLS_ASSIGN_OR_RETURN(
+            bool still_fails,
+            StillFails(chain.back().package_ir_text, inputs, test_cache));
+        if (still_fails) {
+          lengths[c] = chain.size();
+          return absl::OkStatus();
+        }
+        // Test earlier changes to see if they were failing, and discard the
+        // ones that aren't.
+        LOG(INFO) << "Latest candidate no longer fails; trying earlier "
+                     "untested candidates";
+        XLS_ASSIGN_OR_RETURN(
+            lengths[c],
+            BinarySearchMinTrueWithStatus(
+                0, chain.size() - 1,
+                [&](int64_t i) -> absl::StatusOr<bool> {
+                  XLS_ASSIGN_OR_RETURN(
+                      bool still_fails,
+                      StillFails(chain[i].package_ir_text, inputs, test_cache));
+                  return !still_fails;
+                },
+                BinarySearchAssumptions::kEndKnownTrue));
+        LOG(INFO) << "Discarded " << (chain.size() - lengths[c])
+                  << " candidates, leaving " << lengths[c];
+        return absl::OkStatus();
+      }));
+  return lengths;
+}
+
+// Replaces the contents of --checkpoint_path, if set, with `ir_text`.
+absl::Status WriteCheckpoint(std::string_view ir_text) {
+  std::string path = absl::GetFlag(FLAGS_checkpoint_path);
+  if (path.empty()) {
+    return absl::OkStatus();
+  }
+  // Write to a temporary file and rename it into place so that an interrupted
+  // run never leaves a truncated checkpoint.
+  std::string temp_path = absl::StrCat(path, ".tmp");
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, ir_text));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    return absl::InternalError(absl::StrFormat(
+        "Unable to write checkpoint %s: %s", path, ec.message()));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
                       const int64_t total_attempt_limit,
                       const int64_t simplifications_between_tests,
                       const int64_t failed_attempts_between_tests_limit) {
+  std::string checkpoint_path = absl::GetFlag(FLAGS_checkpoint_path);
+  if (!checkpoint_path.empty() && FileExists(checkpoint_path).ok()) {
+    LOG(INFO) << "Resuming from checkpoint " << checkpoint_path;
+    path = checkpoint_path;
+  }
   XLS_ASSIGN_OR_RETURN(std::string knownf_ir_text, GetFileContents(path));
   // Cache of test results to avoid duplicate invocations of the
   // test_executable.
-  absl::flat_hash_map<std::string, bool> test_cache;
+  TestCache test_cache;
 
   // Parse inputs, if specified.
   std::optional<std::vector<xls::Value>> inputs;
@@ -1269,6 +1444,7 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     } else {
       LOG(INFO) << "=== Original main function does not fail after cleanup";
     }
+    XLS_RETURN_IF_ERROR(WriteCheckpoint(knownf_ir_text));
     LOG(INFO) << "=== Done cleaning up initial garbage";
   }
 
@@ -1281,16 +1457,90 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
   int64_t failed_attempts_between_tests = 0;
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        ParsePackage(knownf_ir_text));
-
-  struct CandidateChange {
-    std::string which_transform;
-    std::string package_ir_text;
-    std::string candidate_ir_text;
-    int64_t node_count;
+  // Records the changes made to the package since it was last known to fail
+  // so they can be rolled back without re-parsing the known failure.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<PackageTransaction> transaction,
+                       PackageTransaction::Begin(package.get()));
+
+  // Returns the package to the last known failure, discarding any changes.
+  auto restore_known_failure = [&]() -> absl::Status {
+    if (transaction->CanRollback()) {
+      XLS_RETURN_IF_ERROR(transaction->Rollback());
+    } else {
+      transaction->Commit();
+      XLS_ASSIGN_OR_RETURN(package, ParsePackage(knownf_ir_text));
+    }
+    XLS_ASSIGN_OR_RETURN(transaction,
+                         PackageTransaction::Begin(package.get()));
+    return absl::OkStatus();
   };
+
   std::vector<CandidateChange> candidate_changes;
+  // Chains of candidate changes, each starting from the last known failure,
+  // waiting to be tested together. There are up to --parallelism of them.
+  std::vector<std::vector<CandidateChange>> pending_chains;
+
+  // Tests the pending chains and moves on from the smallest candidate which
+  // still fails, if any.
+  auto test_pending_chains = [&]() -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<int64_t> prefix_lengths,
+        FailingPrefixLengths(pending_chains, inputs, &test_cache));
+    std::vector<CandidateChange>* best_chain = nullptr;
+    for (int64_t i = 0; i < pending_chains.size(); ++i) {
+      std::vector<CandidateChange>& chain = pending_chains[i];
+      chain.resize(prefix_lengths[i]);
+      if (!chain.empty() &&
+          (best_chain == nullptr ||
+           chain.back().node_count < best_chain->back().node_count)) {
+        best_chain = &chain;
+      }
+    }
+    if (best_chain == nullptr) {
+      failed_simplification_attempts += pending_chains.size();
+      pending_chains.clear();
+      LOG(INFO) << "Sample no longer fails.";
+      LOG(INFO) << "Failed simplification attempts now: "
+                << failed_simplification_attempts;
+      // That simplification caused it to stop failing, but keep going with the
+      // last known failing version and seeing if we can find something else
+      // from there.
+      return restore_known_failure();
+    }
+
+    const CandidateChange& known_failure = best_chain->back();
+
+    // We found something that definitely fails, update our "knownf" value and
+    // reset our failed simplification attempt count since we see we've made
+    // some forward progress.
+    knownf_ir_text = known_failure.package_ir_text;
+    std::cerr << "---\ntransforms: "
+              << absl::StrJoin(
+                     *best_chain, ", ",
+                     [](std::string* out, const CandidateChange& change) {
+                       absl::StrAppend(out, change.which_transform);
+                     })
+              << " on " << known_failure.candidate_name << "\n"
+              << (known_failure.node_count > 50
+                      ? ""
+                      : known_failure.candidate_ir_text)
+              << "(" << known_failure.node_count << " nodes)\n";
+    XLS_RETURN_IF_ERROR(WriteCheckpoint(knownf_ir_text));
+
+    transaction->Commit();
+    XLS_ASSIGN_OR_RETURN(package, ParsePackage(knownf_ir_text));
+    XLS_ASSIGN_OR_RETURN(transaction, PackageTransaction::Begin(package.get()));
+    failed_simplification_attempts = 0;
+    pending_chains.clear();
+    return absl::OkStatus();
+  };
+
   while (true) {
     if (failed_simplification_attempts >= failed_attempt_limit) {
+      if (!pending_chains.empty()) {
+        XLS_RETURN_IF_ERROR(test_pending_chains());
+        continue;
+      }
       LOG(INFO) << "Hit failed-simplification-attempt-limit: "
                 << failed_simplification_attempts;
       // Used up all our attempts for this state.
@@ -1306,6 +1556,9 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     total_attempts++;
     if (total_attempts >= total_attempt_limit) {
       LOG(INFO) << "Hit total-attempt-limit: " << total_attempts;
+      if (!pending_chains.empty()) {
+        XLS_RETURN_IF_ERROR(test_pending_chains());
+      }
       break;
     }
 
@@ -1330,6 +1583,10 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
         it++;
       }
       if (bases.empty()) {
+        if (!pending_chains.empty()) {
+          XLS_RETURN_IF_ERROR(test_pending_chains());
+          continue;
+        }
         LOG(INFO) << "Nothing left to simplify";
         break;
       }
@@ -1348,6 +1605,10 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
 
     // If we cannot change it, we're done.
     if (simplification.result == SimplificationResult::kCannotChange) {
+      if (!pending_chains.empty()) {
+        XLS_RETURN_IF_ERROR(test_pending_chains());
+        continue;
+      }
       LOG(INFO) << "Cannot simplify any further, done!";
       break;
     }
@@ -1394,6 +1655,7 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
 
     candidate_changes.push_back({
         .which_transform = which_transform,
+        .candidate_name = candidate_name,
         .package_ir_text = simplification.ir(),
         .candidate_ir_text = candidate_ir(),
         .node_count = simplification.node_count,
@@ -1406,66 +1668,17 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     simplification_iterations = 0;
     failed_attempts_between_tests = 0;
 
-    XLS_ASSIGN_OR_RETURN(bool still_fails,
-                         StillFails(candidate_changes.back().package_ir_text,
-                                    inputs, &test_cache));
-    if (!still_fails) {
-      // Test earlier changes to see if they were failing, and discard the ones
-      // that aren't.
-      LOG(INFO) << "Latest candidate no longer fails; trying earlier "
-                   "untested candidates";
-      XLS_ASSIGN_OR_RETURN(
-          int64_t first_non_failing,
-          BinarySearchMinTrueWithStatus(
-              0, candidate_changes.size() - 1,
-              [&](int64_t i) -> absl::StatusOr<bool> {
-                XLS_ASSIGN_OR_RETURN(
-                    bool still_fails,
-                    StillFails(candidate_changes[i].package_ir_text, inputs,
-                               &test_cache));
-                return !still_fails;
-              },
-              BinarySearchAssumptions::kEndKnownTrue));
-      LOG(INFO) << "Discarded "
-                << (candidate_changes.size() - first_non_failing)
-                << " candidates, leaving " << first_non_failing;
-      candidate_changes.erase(candidate_changes.begin() + first_non_failing,
-                              candidate_changes.end());
-    }
-    if (candidate_changes.empty()) {
-      failed_simplification_attempts++;
-      LOG(INFO) << "Sample no longer fails.";
-      LOG(INFO) << "Failed simplification attempts now: "
-                << failed_simplification_attempts;
-      // That simplification caused it to stop failing, but keep going with the
-      // last known failing version and seeing if we can find something else
-      // from there.
-      XLS_ASSIGN_OR_RETURN(package, ParsePackage(knownf_ir_text));
+    pending_chains.push_back(std::move(candidate_changes));
+    candidate_changes.clear();
+    if (static_cast<int64_t>(pending_chains.size()) <
+        absl::GetFlag(FLAGS_parallelism)) {
+      // Derive the next chain from the last known failure as well.
+      XLS_RETURN_IF_ERROR(restore_known_failure());
       continue;
     }
-
-    const CandidateChange& known_failure = candidate_changes.back();
-
-    // We found something that definitely fails, update our "knownf" value and
-    // reset our failed simplification attempt count since we see we've made
-    // some forward progress.
-    knownf_ir_text = known_failure.package_ir_text;
-    std::cerr << "---\ntransforms: "
-              << absl::StrJoin(
-                     candidate_changes, ", ",
-                     [](std::string* out, const CandidateChange& change) {
-                       absl::StrAppend(out, change.which_transform);
-                     })
-              << " on " << candidate->name() << "\n"
-              << (known_failure.node_count > 50
-                      ? ""
-                      : known_failure.candidate_ir_text)
-              << "(" << known_failure.node_count << " nodes)\n";
-
-    XLS_ASSIGN_OR_RETURN(package, ParsePackage(knownf_ir_text));
-    failed_simplification_attempts = 0;
-    candidate_changes.clear();
+    XLS_RETURN_IF_ERROR(test_pending_chains());
   }
+  transaction->Commit();
 
   std::cout << knownf_ir_text;
 
@@ -1499,9 +1712,14 @@ int main(int argc, char** argv) {
   if (absl::GetFlag(FLAGS_test_optimizer)) {
     test_flags++;
   }
+  if (absl::GetFlag(FLAGS_test_optimizer_fails)) {
+    test_flags++;
+  }
   QCHECK_EQ(test_flags, 1)
-      << "Must specify exactly one of --test_executable, --test_llvm_jit, or "
-         "--test_optimizer";
+      << "Must specify exactly one of --test_executable, --test_llvm_jit, "
+         "--test_optimizer, or --test_optimizer_fails";
+  QCHECK_GE(absl::GetFlag(FLAGS_parallelism), 1)
+      << "--parallelism must be positive";
 
   if (absl::GetFlag(FLAGS_can_extract_segments)) {
     std::vector<std::string> failures;
@@ -785,6 +785,62 @@ top fn foo() -> (bits[1], (bits[42]), bits[32]) {
     self.assertIn('myadd', minimized_ir)
     self.assertIn('result', minimized_ir)
 
+  def test_minimize_in_parallel(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    test_sh_file = self.create_tempfile()
+    self._write_sh_script(
+        test_sh_file.full_path, ['/usr/bin/env grep myadd $1']
+    )
+    minimized_ir = subprocess.check_output(
+        [
+            IR_MINIMIZER_MAIN_PATH,
+            '--test_executable=' + test_sh_file.full_path,
+            '--can_remove_params=false',
+            '--parallelism=4',
+            ir_file.full_path,
+        ],
+        encoding='utf-8',
+    )
+    self._maybe_record_property('output', minimized_ir)
+    self.assertEqual(function_count(minimized_ir), 1)
+    self.assertEqual(node_count(minimized_ir), 1)
+    self.assertIn('ret myadd', minimized_ir)
+
+  def test_resume_from_checkpoint(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    checkpoint_path = os.path.join(
+        self.create_tempdir().full_path, 'checkpoint.ir'
+    )
+    test_sh_file = self.create_tempfile()
+    self._write_sh_script(
+        test_sh_file.full_path, ['/usr/bin/env grep myadd $1']
+    )
+    minimized_ir = subprocess.check_output(
+        [
+            IR_MINIMIZER_MAIN_PATH,
+            '--test_executable=' + test_sh_file.full_path,
+            '--checkpoint_path=' + checkpoint_path,
+            ir_file.full_path,
+        ],
+        encoding='utf-8',
+    )
+    with open(checkpoint_path) as f:
+      self.assertEqual(f.read(), minimized_ir)
+
+    # The IR file does not exhibit the bug, so this only succeeds if the
+    # minimizer starts from the checkpoint.
+    passing_ir_file = self.create_tempfile(content='package foo\n')
+    resumed_ir = subprocess.check_output(
+        [
+            IR_MINIMIZER_MAIN_PATH,
+            '--test_executable=' + test_sh_file.full_path,
+            '--checkpoint_path=' + checkpoint_path,
+            passing_ir_file.full_path,
+        ],
+        encoding='utf-8',
+    )
+    self.assertEqual(resumed_ir, minimized_ir)
+
   def test_inline_single_invoke_is_triggerable(self):
     ir_file = self.create_tempfile(content=INVOKE_TWO)
     test_sh_file = self.create_tempfile()
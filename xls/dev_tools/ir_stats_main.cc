@@ -14,7 +14,13 @@
 
 // Prints summary information about an IR file to the terminal.
 // Output will be added as needs warrant, so feel free to make additions!
+//
+// With --streaming the IR text is scanned rather than parsed, which needs
+// a fraction of the memory and time on very large packages, and per-op counts
+// and widths and the fan-out distribution are printed for every function,
+// proc and block.
 
+#include <cstdint>
 #include <iostream>
 #include <optional>
 #include <string>
@@ -24,10 +30,12 @@
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/dev_tools/ir_text_stats.h"
 #include "xls/ir/ir_parser.h"
 
 ABSL_FLAG(
@@ -35,9 +43,49 @@ ABSL_FLAG(
     "The name of the top entity. Currently, only functions are supported. "
     "If set, restrict dumping to the given function. "
     "The name should not be mangled with the Package name.");
+ABSL_FLAG(bool, streaming, false,
+          "Scan the IR text instead of parsing it into a package, and print "
+          "op and fan-out statistics. Suitable for very large IR files.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads used to scan functions with --streaming. "
+          "Defaults to the number of available CPUs.");
 
 namespace xls {
 
+static absl::Status StreamingMain(std::string_view ir_path,
+                                  std::optional<std::string> restrict_fn) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<IrTextFunctionStats> stats,
+      ComputeIrTextStats(contents, absl::GetFlag(FLAGS_threads)));
+
+  int64_t total_nodes = 0;
+  for (const IrTextFunctionStats& function : stats) {
+    total_nodes += function.node_count;
+    if (restrict_fn && restrict_fn.value() != function.name) {
+      continue;
+    }
+    std::cout << absl::StrFormat("  %s: \"%s\"\n", function.kind,
+                                 function.name);
+    std::cout << "    Nodes: " << function.node_count << '\n';
+    std::cout << "    Ops (count, average/max flat bit count):\n";
+    for (const auto& [op, op_stats] : function.op_stats) {
+      std::cout << absl::StrFormat(
+          "      %-24s %8d %10.1f %8d\n", op, op_stats.count,
+          static_cast<double>(op_stats.total_bit_count) / op_stats.count,
+          op_stats.max_bit_count);
+    }
+    std::cout << "    Fan-out (uses, nodes):\n";
+    for (const auto& [fanout, count] : function.fanout_histogram) {
+      std::cout << absl::StrFormat("      %8d %8d\n", fanout, count);
+    }
+    std::cout << '\n';
+  }
+  std::cout << absl::StrFormat("Total: %d functions, %d nodes\n", stats.size(),
+                               total_nodes);
+  return absl::OkStatus();
+}
+
 static absl::Status RealMain(std::string_view ir_path,
                              std::optional<std::string> restrict_fn) {
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
@@ -67,5 +115,9 @@ int main(int argc, char** argv) {
   if (!absl::GetFlag(FLAGS_top).empty()) {
     restrict_fn = absl::GetFlag(FLAGS_top);
   }
+  if (absl::GetFlag(FLAGS_streaming)) {
+    return xls::ExitStatus(
+        xls::StreamingMain(positional_args[0], restrict_fn));
+  }
   return xls::ExitStatus(xls::RealMain(positional_args[0], restrict_fn));
 }
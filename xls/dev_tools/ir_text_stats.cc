@@ -0,0 +1,422 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dev_tools/ir_text_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace {
+
+// Keyword arguments whose values name something other than a node and so are
+// never operands. Literal values contain no identifiers so need no special
+// handling.
+constexpr std::string_view kNonOperandKeywords[] = {
+    "body",          "channel",  "format",
+    "id",            "init",     "instantiation",
+    "label",         "message",  "name",
+    "port_name",     "pos",      "register",
+    "state_element", "to_apply",
+};
+
+bool IsIdentifierStart(char c) { return absl::ascii_isalpha(c) || c == '_'; }
+
+bool IsIdentifierChar(char c) {
+  return absl::ascii_isalnum(c) || c == '_' || c == '.';
+}
+
+// Consumes a (possibly empty) identifier from the front of `s`.
+std::string_view ConsumeIdentifier(std::string_view& s) {
+  if (s.empty() || !IsIdentifierStart(s.front())) {
+    return std::string_view();
+  }
+  int64_t end = 1;
+  while (end < s.size() && IsIdentifierChar(s[end])) {
+    ++end;
+  }
+  std::string_view identifier = s.substr(0, end);
+  s.remove_prefix(end);
+  return identifier;
+}
+
+std::optional<int64_t> ConsumeInt(std::string_view& s) {
+  int64_t end = 0;
+  while (end < s.size() && absl::ascii_isdigit(s[end])) {
+    ++end;
+  }
+  int64_t value;
+  if (end == 0 || !absl::SimpleAtoi(s.substr(0, end), &value)) {
+    return std::nullopt;
+  }
+  s.remove_prefix(end);
+  return value;
+}
+
+// Consumes a type from the front of `s` and returns its flat bit count.
+absl::StatusOr<int64_t> ConsumeType(std::string_view& s) {
+  int64_t bit_count = 0;
+  if (absl::ConsumePrefix(&s, "bits[")) {
+    std::optional<int64_t> width = ConsumeInt(s);
+    if (!width.has_value() || !absl::ConsumePrefix(&s, "]")) {
+      return absl::InvalidArgumentError("Malformed bits type");
+    }
+    bit_count = *width;
+  } else if (absl::ConsumePrefix(&s, "token")) {
+    bit_count = 0;
+  } else if (absl::ConsumePrefix(&s, "(")) {
+    while (!absl::ConsumePrefix(&s, ")")) {
+      XLS_ASSIGN_OR_RETURN(int64_t element_bit_count, ConsumeType(s));
+      bit_count += element_bit_count;
+      if (absl::ConsumePrefix(&s, ",")) {
+        absl::ConsumePrefix(&s, " ");
+      } else if (!absl::StartsWith(s, ")")) {
+        return absl::InvalidArgumentError("Malformed tuple type");
+      }
+    }
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown type at `%s`", s.substr(0, 16)));
+  }
+  while (absl::ConsumePrefix(&s, "[")) {
+    std::optional<int64_t> size = ConsumeInt(s);
+    if (!size.has_value() || !absl::ConsumePrefix(&s, "]")) {
+      return absl::InvalidArgumentError("Malformed array type");
+    }
+    bit_count *= *size;
+  }
+  return bit_count;
+}
+
+// Returns the length of the bracketed group at the start of `s`, or of all of
+// `s` if the group is not closed.
+int64_t BracketedLength(std::string_view s) {
+  int64_t depth = 0;
+  for (int64_t i = 0; i < s.size(); ++i) {
+    switch (s[i]) {
+      case '(':
+      case '[':
+      case '{':
+        ++depth;
+        break;
+      case ')':
+      case ']':
+      case '}':
+        if (--depth == 0) {
+          return i + 1;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return s.size();
+}
+
+// Appends to `operands` the identifiers in the argument list `args` which
+// name nodes in `defined`.
+void CollectOperands(std::string_view args,
+                     const absl::flat_hash_set<std::string_view>& defined,
+                     std::vector<std::string_view>& operands) {
+  while (!args.empty()) {
+    char c = args.front();
+    if (IsIdentifierStart(c)) {
+      std::string_view identifier = ConsumeIdentifier(args);
+      if (absl::ConsumePrefix(&args, "=")) {
+        if (absl::c_linear_search(kNonOperandKeywords, identifier)) {
+          // Skip the value.
+          if (!args.empty() &&
+              (args.front() == '(' || args.front() == '[' ||
+               args.front() == '{')) {
+            args.remove_prefix(BracketedLength(args));
+          } else {
+            while (!args.empty() && args.front() != ',' &&
+                   args.front() != ')') {
+              args.remove_prefix(1);
+            }
+          }
+        }
+      } else if (defined.contains(identifier)) {
+        operands.push_back(identifier);
+      }
+    } else if (absl::ascii_isdigit(c)) {
+      // Numbers, including ones like 0x1f and 0b101.
+      while (!args.empty() && absl::ascii_isalnum(args.front())) {
+        args.remove_prefix(1);
+      }
+    } else if (c == '"') {
+      args.remove_prefix(1);
+      while (!args.empty() && args.front() != '"') {
+        args.remove_prefix(args.front() == '\\' && args.size() > 1 ? 2 : 1);
+      }
+      if (!args.empty()) {
+        args.remove_prefix(1);
+      }
+    } else {
+      args.remove_prefix(1);
+    }
+  }
+}
+
+// Parses a line of the form `[ret ]name: type = op(args)`. Returns nullopt for
+// lines which are not node definitions.
+std::optional<IrTextNode> ParseNodeLine(
+    std::string_view line,
+    const absl::flat_hash_set<std::string_view>& defined) {
+  line = absl::StripAsciiWhitespace(line);
+  absl::ConsumePrefix(&line, "ret ");
+  IrTextNode node;
+  node.name = ConsumeIdentifier(line);
+  if (node.name.empty() || !absl::ConsumePrefix(&line, ": ")) {
+    return std::nullopt;
+  }
+  std::string_view type_start = line;
+  absl::StatusOr<int64_t> bit_count = ConsumeType(line);
+  if (!bit_count.ok()) {
+    return std::nullopt;
+  }
+  node.type = type_start.substr(0, type_start.size() - line.size());
+  node.flat_bit_count = *bit_count;
+  if (!absl::ConsumePrefix(&line, " = ")) {
+    return std::nullopt;
+  }
+  node.op = ConsumeIdentifier(line);
+  if (node.op.empty() || !absl::ConsumePrefix(&line, "(")) {
+    return std::nullopt;
+  }
+  CollectOperands(line, defined, node.operands);
+  return node;
+}
+
+// Calls `f` on each parameter in the header of a fn.
+absl::Status ForEachFunctionParam(
+    const IrTextFunction& function,
+    absl::FunctionRef<absl::Status(const IrTextNode&)> f) {
+  // The name is a view into the header.
+  std::string_view header = function.header;
+  header.remove_prefix(function.name.data() - header.data() +
+                       function.name.size());
+  if (!absl::ConsumePrefix(&header, "(")) {
+    return absl::OkStatus();
+  }
+  while (!header.empty() && header.front() != ')') {
+    std::string_view item = header;
+    IrTextNode param;
+    param.op = "param";
+    param.name = ConsumeIdentifier(item);
+    if (!param.name.empty() && absl::ConsumePrefix(&item, ": ")) {
+      std::string_view type_start = item;
+      absl::StatusOr<int64_t> bit_count = ConsumeType(item);
+      if (bit_count.ok()) {
+        param.type = type_start.substr(0, type_start.size() - item.size());
+        param.flat_bit_count = *bit_count;
+        XLS_RETURN_IF_ERROR(f(param));
+      }
+    }
+    // Advance past the next top-level comma.
+    int64_t i = 0;
+    while (i < header.size() && header[i] != ',' && header[i] != ')') {
+      char c = header[i];
+      i += (c == '(' || c == '[' || c == '{')
+               ? BracketedLength(header.substr(i))
+               : 1;
+    }
+    header.remove_prefix(i);
+    absl::ConsumePrefix(&header, ",");
+    absl::ConsumePrefix(&header, " ");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<int64_t> IrTextTypeFlatBitCount(std::string_view type) {
+  std::string_view rest = type;
+  XLS_ASSIGN_OR_RETURN(int64_t bit_count, ConsumeType(rest));
+  if (!rest.empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Trailing characters in type `%s`", type));
+  }
+  return bit_count;
+}
+
+absl::StatusOr<std::vector<IrTextFunction>> SplitIrTextFunctions(
+    std::string_view ir_text) {
+  std::vector<IrTextFunction> functions;
+  size_t pos = 0;
+  while (pos < ir_text.size()) {
+    size_t eol = ir_text.find('\n', pos);
+    if (eol == std::string_view::npos) {
+      eol = ir_text.size();
+    }
+    std::string_view line =
+        absl::StripTrailingAsciiWhitespace(ir_text.substr(pos, eol - pos));
+    std::string_view rest = line;
+    absl::ConsumePrefix(&rest, "top ");
+    std::string_view kind;
+    for (std::string_view candidate : {"fn", "proc", "block"}) {
+      if (absl::StartsWith(rest, candidate) &&
+          rest.size() > candidate.size() && rest[candidate.size()] == ' ') {
+        kind = candidate;
+        break;
+      }
+    }
+    if (kind.empty() || !absl::EndsWith(line, "{")) {
+      pos = eol + 1;
+      continue;
+    }
+    rest.remove_prefix(kind.size() + 1);
+    IrTextFunction function;
+    function.kind = kind;
+    function.name = ConsumeIdentifier(rest);
+    function.header = line;
+    if (function.name.empty()) {
+      pos = eol + 1;
+      continue;
+    }
+
+    // Body lines are indented, so the function ends at the first line which
+    // starts with a closing brace.
+    size_t body_start = std::min(eol + 1, ir_text.size());
+    size_t close = ir_text.find("\n}", eol);
+    if (close == std::string_view::npos) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "No closing brace for %s %s", function.kind, function.name));
+    }
+    function.body = ir_text.substr(body_start, close + 1 - body_start);
+    functions.push_back(function);
+    pos = close + 2;
+  }
+  return functions;
+}
+
+absl::Status ForEachIrTextNode(
+    const IrTextFunction& function,
+    absl::FunctionRef<absl::Status(const IrTextNode&)> f) {
+  absl::flat_hash_set<std::string_view> defined;
+  // Proc headers declare state elements, which are read by state_read nodes
+  // in the body.
+  if (function.kind == "fn") {
+    XLS_RETURN_IF_ERROR(
+        ForEachFunctionParam(function, [&](const IrTextNode& param) {
+          defined.insert(param.name);
+          return f(param);
+        }));
+  }
+  std::string_view body = function.body;
+  while (!body.empty()) {
+    size_t eol = body.find('\n');
+    std::string_view line = body.substr(0, eol);
+    body.remove_prefix(eol == std::string_view::npos ? body.size() : eol + 1);
+    std::optional<IrTextNode> node = ParseNodeLine(line, defined);
+    if (node.has_value()) {
+      XLS_RETURN_IF_ERROR(f(*node));
+      defined.insert(node->name);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ParallelForEachIrTextFunction(
+    absl::Span<const IrTextFunction> functions, int64_t thread_count,
+    absl::FunctionRef<absl::Status(int64_t, const IrTextFunction&)> f) {
+  std::vector<absl::Status> statuses(functions.size());
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < functions.size();
+         i = next_index.fetch_add(1)) {
+      statuses[i] = f(i, functions[i]);
+    }
+  };
+  thread_count =
+      std::clamp<int64_t>(thread_count > 0 ? thread_count : AvailableCPUs(),
+                          1, std::max<int64_t>(functions.size(), 1));
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (auto& t : threads) {
+    t->Join();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<IrTextFunctionStats> ComputeIrTextFunctionStats(
+    const IrTextFunction& function) {
+  IrTextFunctionStats stats;
+  stats.kind = function.kind;
+  stats.name = function.name;
+  absl::flat_hash_map<std::string_view, int64_t> node_index;
+  std::vector<int64_t> fanout;
+  XLS_RETURN_IF_ERROR(
+      ForEachIrTextNode(function, [&](const IrTextNode& node) -> absl::Status {
+        ++stats.node_count;
+        IrTextOpStats& op_stats = stats.op_stats[node.op];
+        ++op_stats.count;
+        op_stats.total_bit_count += node.flat_bit_count;
+        op_stats.max_bit_count =
+            std::max(op_stats.max_bit_count, node.flat_bit_count);
+        for (std::string_view operand : node.operands) {
+          ++fanout[node_index.at(operand)];
+        }
+        node_index[node.name] = fanout.size();
+        fanout.push_back(0);
+        return absl::OkStatus();
+      }));
+  for (int64_t count : fanout) {
+    ++stats.fanout_histogram[count];
+  }
+  return stats;
+}
+
+absl::StatusOr<std::vector<IrTextFunctionStats>> ComputeIrTextStats(
+    std::string_view ir_text, int64_t thread_count) {
+  XLS_ASSIGN_OR_RETURN(std::vector<IrTextFunction> functions,
+                       SplitIrTextFunctions(ir_text));
+  std::vector<IrTextFunctionStats> stats(functions.size());
+  XLS_RETURN_IF_ERROR(ParallelForEachIrTextFunction(
+      functions, thread_count,
+      [&](int64_t i, const IrTextFunction& function) -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(stats[i], ComputeIrTextFunctionStats(function));
+        return absl::OkStatus();
+      }));
+  return stats;
+}
+
+}  // namespace xls
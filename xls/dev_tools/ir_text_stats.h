@@ -0,0 +1,104 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DEV_TOOLS_IR_TEXT_STATS_H_
+#define XLS_DEV_TOOLS_IR_TEXT_STATS_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+// Lightweight scanning of IR text for gathering statistics over packages too
+// large to comfortably parse into a Package. Nothing beyond string views into
+// the text and per-function name tables is materialized.
+//
+// The scanner understands the shape of the IR text format but does not
+// validate it; malformed input produces approximate statistics rather than
+// errors wherever possible.
+
+namespace xls {
+
+// A fn, proc or block in the IR text.
+struct IrTextFunction {
+  std::string_view kind;  // "fn", "proc" or "block".
+  std::string_view name;
+  std::string_view header;  // The line declaring the function.
+  std::string_view body;    // The text between the braces.
+};
+
+// A single node definition in the IR text.
+struct IrTextNode {
+  std::string_view name;
+  std::string_view op;
+  std::string_view type;
+  int64_t flat_bit_count = 0;
+  // Names of the operands which are nodes defined earlier in the function.
+  std::vector<std::string_view> operands;
+};
+
+// Returns the functions in the given package text in order of appearance.
+absl::StatusOr<std::vector<IrTextFunction>> SplitIrTextFunctions(
+    std::string_view ir_text);
+
+// Calls `f` on each node of `function`, including the parameters of fns (with
+// op "param"), in order of appearance.
+absl::Status ForEachIrTextNode(
+    const IrTextFunction& function,
+    absl::FunctionRef<absl::Status(const IrTextNode&)> f);
+
+// Returns the flat bit count of a type in IR text syntax, e.g. "bits[8][4]" or
+// "(bits[1], token)".
+absl::StatusOr<int64_t> IrTextTypeFlatBitCount(std::string_view type);
+
+struct IrTextOpStats {
+  int64_t count = 0;
+  int64_t total_bit_count = 0;
+  int64_t max_bit_count = 0;
+};
+
+struct IrTextFunctionStats {
+  std::string kind;
+  std::string name;
+  int64_t node_count = 0;
+  absl::btree_map<std::string, IrTextOpStats> op_stats;
+  // Maps a fan-out (number of uses as an operand) to the number of nodes with
+  // that fan-out.
+  absl::btree_map<int64_t, int64_t> fanout_histogram;
+};
+
+// Calls `f` on each of `functions` (with its index), running up to
+// `thread_count` calls concurrently (the number of available CPUs if zero).
+// Returns the error of the first function, in order, for which `f` failed.
+absl::Status ParallelForEachIrTextFunction(
+    absl::Span<const IrTextFunction> functions, int64_t thread_count,
+    absl::FunctionRef<absl::Status(int64_t, const IrTextFunction&)> f);
+
+absl::StatusOr<IrTextFunctionStats> ComputeIrTextFunctionStats(
+    const IrTextFunction& function);
+
+// Computes statistics for every function in the package text, scanning
+// functions concurrently. The result is in order of appearance.
+absl::StatusOr<std::vector<IrTextFunctionStats>> ComputeIrTextStats(
+    std::string_view ir_text, int64_t thread_count = 0);
+
+}  // namespace xls
+
+#endif  // XLS_DEV_TOOLS_IR_TEXT_STATS_H_
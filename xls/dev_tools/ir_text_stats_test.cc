@@ -0,0 +1,159 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dev_tools/ir_text_stats.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/btree_map.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+constexpr std::string_view kPackage = R"(package test
+
+chan ch(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=none, strictness=proven_mutually_exclusive, metadata="""""")
+
+fn body(x: bits[11] id=6, y: bits[11] id=7) -> bits[11] {
+  ret add.3: bits[11] = add(x, y, id=3)
+}
+
+fn main(a: bits[11] id=10, b: bits[8][4] id=11) -> (bits[11], bits[8]) {
+  literal.12: bits[11] = literal(value=0, id=12)
+  add.13: bits[11] = add(a, a, id=13)
+  counted_for.14: bits[11] = counted_for(literal.12, trip_count=7, stride=1, body=body, id=14)
+  literal.15: bits[2] = literal(value=1, id=15)
+  array_index.16: bits[8] = array_index(b, indices=[literal.15], id=16)
+  sel.17: bits[11] = sel(literal.15, cases=[add.13, counted_for.14], default=a, id=17)
+  ret tuple.18: (bits[11], bits[8]) = tuple(sel.17, array_index.16, id=18)
+}
+
+proc my_proc(my_token: token, my_state: bits[32], init={token, 42}) {
+  my_token: token = state_read(state_element=my_token, id=20)
+  my_state: bits[32] = state_read(state_element=my_state, id=21)
+  send.22: token = send(my_token, my_state, channel=ch, id=22)
+  literal.23: bits[1] = literal(value=1, id=23)
+  receive.24: (token, bits[32]) = receive(send.22, predicate=literal.23, channel=ch, id=24)
+  tuple_index.25: token = tuple_index(receive.24, index=0, id=25)
+  next_value.26: () = next_value(param=my_token, value=tuple_index.25, id=26)
+  next_value.27: () = next_value(param=my_state, value=my_state, id=27)
+}
+
+block my_block(in: bits[32], clk: clock, out: bits[32]) {
+  reg foo(bits[32])
+  in: bits[32] = input_port(name=in, id=30)
+  foo_d: () = register_write(in, register=foo, id=31)
+  foo_q: bits[32] = register_read(register=foo, id=32)
+  out: () = output_port(foo_q, name=out, id=33)
+}
+)";
+
+TEST(IrTextStatsTest, TypeFlatBitCount) {
+  EXPECT_THAT(IrTextTypeFlatBitCount("bits[8]"), IsOkAndHolds(8));
+  EXPECT_THAT(IrTextTypeFlatBitCount("bits[8][4]"), IsOkAndHolds(32));
+  EXPECT_THAT(IrTextTypeFlatBitCount("token"), IsOkAndHolds(0));
+  EXPECT_THAT(IrTextTypeFlatBitCount("()"), IsOkAndHolds(0));
+  EXPECT_THAT(IrTextTypeFlatBitCount("(bits[1], token, (bits[2][3]))[2]"),
+              IsOkAndHolds(14));
+  EXPECT_THAT(IrTextTypeFlatBitCount("bits[8] junk"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(IrTextTypeFlatBitCount("clock"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(IrTextStatsTest, SplitFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<IrTextFunction> functions,
+                           SplitIrTextFunctions(kPackage));
+  std::vector<std::string> names;
+  for (const IrTextFunction& function : functions) {
+    names.push_back(absl::StrCat(function.kind, " ", function.name));
+  }
+  EXPECT_THAT(names, ElementsAre("fn body", "fn main", "proc my_proc",
+                                 "block my_block"));
+}
+
+TEST(IrTextStatsTest, UnterminatedFunction) {
+  EXPECT_THAT(SplitIrTextFunctions("package p\n\nfn f() -> () {\n"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(IrTextStatsTest, FunctionStats) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<IrTextFunctionStats> stats,
+                           ComputeIrTextStats(kPackage, /*thread_count=*/2));
+  ASSERT_EQ(stats.size(), 4);
+  const IrTextFunctionStats& main = stats[1];
+  EXPECT_EQ(main.name, "main");
+  EXPECT_EQ(main.node_count, 9);
+  EXPECT_EQ(main.op_stats.at("param").count, 2);
+  EXPECT_EQ(main.op_stats.at("param").total_bit_count, 43);
+  EXPECT_EQ(main.op_stats.at("param").max_bit_count, 32);
+  EXPECT_EQ(main.op_stats.at("literal").count, 2);
+  EXPECT_EQ(main.op_stats.at("tuple").max_bit_count, 19);
+  // `a` is used three times, `literal.15` twice, the return value never and
+  // everything else once.
+  EXPECT_THAT(main.fanout_histogram,
+              ElementsAre(Pair(0, 1), Pair(1, 6), Pair(2, 1), Pair(3, 1)));
+}
+
+// The scanner should agree with the parser on every function.
+TEST(IrTextStatsTest, MatchesParser) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<IrTextFunctionStats> stats,
+                           ComputeIrTextStats(kPackage));
+  for (const IrTextFunctionStats& function_stats : stats) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        FunctionBase * fb, package->GetFunctionBaseByName(function_stats.name));
+    EXPECT_EQ(function_stats.node_count, fb->node_count()) << fb->name();
+    absl::btree_map<std::string, int64_t> op_counts;
+    int64_t operand_count = 0;
+    for (Node* node : fb->nodes()) {
+      ++op_counts[OpToString(node->op())];
+      operand_count += node->operand_count();
+    }
+    absl::btree_map<std::string, int64_t> text_op_counts;
+    int64_t text_operand_count = 0;
+    for (const auto& [op, op_stats] : function_stats.op_stats) {
+      text_op_counts[op] = op_stats.count;
+    }
+    for (const auto& [fanout, count] : function_stats.fanout_histogram) {
+      text_operand_count += fanout * count;
+    }
+    EXPECT_EQ(text_op_counts, op_counts) << fb->name();
+    EXPECT_EQ(text_operand_count, operand_count) << fb->name();
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,167 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the compilation stages (optimization, scheduling, codegen and
+// JIT compilation) on synthetic designs of 10K to 1M nodes, to track how each
+// stage scales with design size. Run with e.g.
+//
+//   bazel run -c opt //xls/dev_tools:synthetic_design_benchmark -- \
+//     --benchmark_filter=BM_Schedule
+//
+// The asymptotic complexity estimated by the benchmark library is reported
+// after each family.
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/log/check.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/pipeline_generator.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/benchmark_support.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+#include "xls/jit/function_jit.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/tools/opt.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kPipelineStages = 16;
+
+struct Design {
+  std::unique_ptr<Package> package;
+  FunctionBase* top;
+};
+
+Design MakeDesign(int64_t node_count, int64_t proc_count = 0) {
+  Design design;
+  design.package = std::make_unique<Package>("synthetic");
+  benchmark_support::SyntheticDesignOptions options;
+  options.node_count = node_count;
+  options.proc_count = proc_count;
+  design.top =
+      benchmark_support::GenerateSyntheticDesign(design.package.get(), options)
+          .value();
+  return design;
+}
+
+const DelayEstimator& UnitDelayEstimator() {
+  return *GetDelayEstimator("unit").value();
+}
+
+PipelineSchedule Schedule(FunctionBase* top, SchedulingStrategy strategy) {
+  return RunPipelineSchedule(
+             top, UnitDelayEstimator(),
+             SchedulingOptions(strategy).pipeline_stages(kPipelineStages))
+      .value();
+}
+
+void BM_Generate(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MakeDesign(state.range(0)));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+// Runs the full optimization pipeline, as opt_main does.
+void BM_Optimize(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    Design design = MakeDesign(state.range(0), /*proc_count=*/state.range(1));
+    tools::OptOptions options;
+    options.top = design.top->name();
+    state.ResumeTiming();
+    CHECK_OK(tools::OptimizeIrForTop(design.package.get(), options));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void BM_ScheduleSdc(benchmark::State& state) {
+  Design design = MakeDesign(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Schedule(design.top, SchedulingStrategy::SDC));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void BM_ScheduleMinCut(benchmark::State& state) {
+  Design design = MakeDesign(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        Schedule(design.top, SchedulingStrategy::MIN_CUT));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void BM_Codegen(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    Design design = MakeDesign(state.range(0));
+    PipelineSchedule schedule = Schedule(design.top, SchedulingStrategy::ASAP);
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(
+        verilog::ToPipelineModuleText(schedule, design.top,
+                                      verilog::BuildPipelineOptions())
+            .value());
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void BM_JitCompile(benchmark::State& state) {
+  Design design = MakeDesign(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        FunctionJit::Create(design.top->AsFunctionOrDie()).value());
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+// Each benchmark runs at 10K, 100K and 1M nodes.
+BENCHMARK(BM_Generate)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 1'000'000)
+    ->Complexity();
+BENCHMARK(BM_ScheduleSdc)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 1'000'000)
+    ->Complexity();
+BENCHMARK(BM_ScheduleMinCut)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 1'000'000)
+    ->Complexity();
+BENCHMARK(BM_Codegen)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 1'000'000)
+    ->Complexity();
+BENCHMARK(BM_JitCompile)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 1'000'000)
+    ->Complexity();
+// The second argument is the number of procs; zero is a single function.
+BENCHMARK(BM_Optimize)
+    ->ArgsProduct({{10'000, 100'000, 1'000'000}, {0, 16}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls
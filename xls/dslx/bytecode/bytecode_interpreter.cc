@@ -208,6 +208,15 @@ absl::Status BytecodeInterpreter::Run(bool* progress_made) {
       VLOG(3) << absl::StreamFormat(" - stack depth %d [%s]", stack_.size(),
                                     stack_.ToString());
       int64_t old_pc = frame->pc();
+      if (bytecode.op() == Bytecode::Op::kLoad) {
+        XLS_ASSIGN_OR_RETURN(bool fused, EvalFusedLoadBinop());
+        if (fused) {
+          if (progress_made != nullptr) {
+            *progress_made = true;
+          }
+          continue;
+        }
+      }
       XLS_RETURN_IF_ERROR(EvalNextInstruction());
       VLOG(3) << absl::StreamFormat(" - stack depth %d [%s]", stack_.size(),
                                     stack_.ToString());
@@ -257,7 +266,7 @@ BytecodeInterpreter::PopArgsRightToLeft(size_t count) {
   std::vector<InterpValue> args(count, InterpValue::MakeToken());
   for (int i = 0; i < count; i++) {
     XLS_ASSIGN_OR_RETURN(InterpValue arg, Pop());
-    args[count - i - 1] = arg;
+    args[count - i - 1] = std::move(arg);
   }
   return args;
 }
@@ -503,6 +512,120 @@ absl::Status BytecodeInterpreter::EvalBinop(
   return absl::OkStatus();
 }
 
+/* static */ bool BytecodeInterpreter::IsPureBinop(Bytecode::Op op) {
+  switch (op) {
+    case Bytecode::Op::kAnd:
+    case Bytecode::Op::kEq:
+    case Bytecode::Op::kGe:
+    case Bytecode::Op::kGt:
+    case Bytecode::Op::kIndex:
+    case Bytecode::Op::kLe:
+    case Bytecode::Op::kLt:
+    case Bytecode::Op::kNe:
+    case Bytecode::Op::kOr:
+    case Bytecode::Op::kXor:
+      return true;
+    default:
+      return false;
+  }
+}
+
+absl::StatusOr<InterpValue> BytecodeInterpreter::ComputePureBinop(
+    const Bytecode& bytecode, const InterpValue& lhs, const InterpValue& rhs) {
+  switch (bytecode.op()) {
+    case Bytecode::Op::kAnd:
+      return lhs.BitwiseAnd(rhs);
+    case Bytecode::Op::kEq:
+      return InterpValue::MakeBool(lhs.Eq(rhs));
+    case Bytecode::Op::kGe:
+      return lhs.Ge(rhs);
+    case Bytecode::Op::kGt:
+      return lhs.Gt(rhs);
+    case Bytecode::Op::kIndex: {
+      if (!lhs.IsArray() && !lhs.IsTuple()) {
+        return absl::InternalError(
+            "BytecodeInterpreter type error: can only index on array or tuple "
+            "values; got: " +
+            lhs.ToString());
+      }
+      XLS_ASSIGN_OR_RETURN(
+          InterpValue result, lhs.Index(rhs),
+          _ << " while processing "
+            << bytecode.ToString(file_table(), /*source_locs=*/true));
+      return result;
+    }
+    case Bytecode::Op::kLe:
+      return lhs.Le(rhs);
+    case Bytecode::Op::kLt:
+      return lhs.Lt(rhs);
+    case Bytecode::Op::kNe:
+      return InterpValue::MakeBool(lhs.Ne(rhs));
+    case Bytecode::Op::kOr:
+      return lhs.BitwiseOr(rhs);
+    case Bytecode::Op::kXor:
+      return lhs.BitwiseXor(rhs);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Not a pure binary bytecode: ",
+                       bytecode.ToString(file_table())));
+  }
+}
+
+absl::Status BytecodeInterpreter::EvalPureBinop(const Bytecode& bytecode) {
+  return EvalBinop([&](const InterpValue& lhs, const InterpValue& rhs) {
+    return ComputePureBinop(bytecode, lhs, rhs);
+  });
+}
+
+absl::StatusOr<bool> BytecodeInterpreter::EvalFusedLoadBinop() {
+  Frame* frame = &frames_.back();
+  const std::vector<Bytecode>& bytecodes = frame->bf()->bytecodes();
+  int64_t pc = frame->pc();
+  if (pc + 2 >= bytecodes.size()) {
+    return false;
+  }
+  const Bytecode& lhs_bytecode = bytecodes[pc];
+  const Bytecode& rhs_bytecode = bytecodes[pc + 1];
+  const Bytecode& op_bytecode = bytecodes[pc + 2];
+  if (lhs_bytecode.op() != Bytecode::Op::kLoad ||
+      (rhs_bytecode.op() != Bytecode::Op::kLoad &&
+       rhs_bytecode.op() != Bytecode::Op::kLiteral) ||
+      !IsPureBinop(op_bytecode.op())) {
+    return false;
+  }
+
+  // Out-of-range slots are left to the unfused loads to report.
+  const std::vector<InterpValue>& slots = frame->slots();
+  XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex lhs_slot,
+                       lhs_bytecode.slot_index());
+  if (lhs_slot.value() >= slots.size()) {
+    return false;
+  }
+  std::optional<InterpValue> literal;
+  const InterpValue* rhs;
+  if (rhs_bytecode.op() == Bytecode::Op::kLoad) {
+    XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex rhs_slot,
+                         rhs_bytecode.slot_index());
+    if (rhs_slot.value() >= slots.size()) {
+      return false;
+    }
+    rhs = &slots[rhs_slot.value()];
+  } else {
+    XLS_ASSIGN_OR_RETURN(literal, rhs_bytecode.value_data());
+    rhs = &*literal;
+  }
+
+  VLOG(2) << "Fused bytecodes: " << lhs_bytecode.ToString(file_table())
+          << "; " << rhs_bytecode.ToString(file_table()) << "; "
+          << op_bytecode.ToString(file_table());
+  XLS_ASSIGN_OR_RETURN(
+      InterpValue result,
+      ComputePureBinop(op_bytecode, slots[lhs_slot.value()], *rhs));
+  stack_.Push(std::move(result));
+  frame->set_pc(pc + 3);
+  return true;
+}
+
 absl::Status BytecodeInterpreter::EvalAdd(const Bytecode& bytecode,
                                           bool is_signed) {
   return EvalBinop([&](const InterpValue& lhs,
@@ -528,9 +651,7 @@ absl::Status BytecodeInterpreter::EvalAdd(const Bytecode& bytecode,
 }
 
 absl::Status BytecodeInterpreter::EvalAnd(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseAnd(rhs);
-  });
+  return EvalPureBinop(bytecode);
 }
 
 absl::StatusOr<BytecodeFunction*> BytecodeInterpreter::GetBytecodeFn(
@@ -670,7 +791,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
         InterpValue result,
         ResizeBitsValue(from_value, to_bits_like.value(), to, is_checked,
                         bytecode.source_span(), file_table()));
-    stack_.Push(result);
+    stack_.Push(std::move(result));
     return absl::OkStatus();
   }
 
@@ -691,7 +812,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
         InterpValue result,
         ResizeBitsValue(from_value, to_bits_like.value(), to, is_checked,
                         bytecode.source_span(), file_table()));
-    stack_.Push(result);
+    stack_.Push(std::move(result));
     return absl::OkStatus();
   }
 
@@ -816,9 +937,7 @@ absl::Status BytecodeInterpreter::EvalDup(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalEq(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Eq(rhs));
-  });
+  return EvalPureBinop(bytecode);
 }
 
 absl::Status BytecodeInterpreter::EvalExpandTuple(const Bytecode& bytecode) {
@@ -852,15 +971,11 @@ absl::Status BytecodeInterpreter::EvalFail(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalGe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Ge(rhs);
-  });
+  return EvalPureBinop(bytecode);
 }
 
 absl::Status BytecodeInterpreter::EvalGt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Gt(rhs);
-  });
+  return EvalPureBinop(bytecode);
 }
 
 absl::Status BytecodeInterpreter::EvalTupleIndex(const Bytecode& bytecode) {
@@ -877,40 +992,23 @@ absl::Status BytecodeInterpreter::EvalTupleIndex(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(
       InterpValue result, basis.Index(index),
       _ << " while processing " << bytecode.ToString(file_table()));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalIndex(const Bytecode& bytecode) {
-  XLS_ASSIGN_OR_RETURN(InterpValue index, Pop());
-  XLS_ASSIGN_OR_RETURN(InterpValue basis, Pop());
-
-  if (!basis.IsArray() && !basis.IsTuple()) {
-    return absl::InternalError(
-        "BytecodeInterpreter type error: can only index on array or tuple "
-        "values; got: " +
-        basis.ToString());
-  }
-
-  XLS_ASSIGN_OR_RETURN(
-      InterpValue result, basis.Index(index),
-      _ << " while processing "
-        << bytecode.ToString(file_table(), /*source_locs=*/true));
-  stack_.Push(result);
-  return absl::OkStatus();
+  return EvalPureBinop(bytecode);
 }
 
 absl::Status BytecodeInterpreter::EvalInvert(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue operand, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue result, operand.BitwiseNegate());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalLe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Le(rhs);
-  });
+  return EvalPureBinop(bytecode);
 }
 
 absl::Status BytecodeInterpreter::EvalLiteral(const Bytecode& bytecode) {
@@ -949,7 +1047,7 @@ absl::Status BytecodeInterpreter::EvalLogicalAnd(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.BitwiseAnd(rhs));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -970,14 +1068,12 @@ absl::Status BytecodeInterpreter::EvalLogicalOr(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.BitwiseOr(rhs));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalLt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Lt(rhs);
-  });
+  return EvalPureBinop(bytecode);
 }
 
 absl::StatusOr<bool> BytecodeInterpreter::MatchArmEqualsInterpValue(
@@ -1090,22 +1186,18 @@ absl::Status BytecodeInterpreter::EvalMul(const Bytecode& bytecode,
 }
 
 absl::Status BytecodeInterpreter::EvalNe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Ne(rhs));
-  });
+  return EvalPureBinop(bytecode);
 }
 
 absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue operand, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue result, operand.ArithmeticNegate());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalOr(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseOr(rhs);
-  });
+  return EvalPureBinop(bytecode);
 }
 
 absl::Status BytecodeInterpreter::EvalPop(const Bytecode& bytecode) {
@@ -1178,6 +1270,7 @@ absl::Status BytecodeInterpreter::EvalRecv(const Bytecode& bytecode) {
       blocked_channel_info_ = BlockedChannelInfo{
           .name = FormatChannelNameForTracing(*channel_data),
           .span = bytecode.source_span(),
+          .channel_id = channel_id,
       };
       return absl::UnavailableError("Channel is empty.");
     }
@@ -1302,7 +1395,7 @@ absl::Status BytecodeInterpreter::EvalSlice(const Bytecode& bytecode) {
   start = InterpValue::MakeBits(/*is_signed=*/false, start.GetBitsOrDie());
   length = InterpValue::MakeBits(/*is_signed=*/false, length.GetBitsOrDie());
   XLS_ASSIGN_OR_RETURN(InterpValue result, basis.Slice(start, length));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -1314,7 +1407,7 @@ absl::Status BytecodeInterpreter::EvalStore(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-  frames_.back().StoreSlot(slot, value);
+  frames_.back().StoreSlot(slot, std::move(value));
   return absl::OkStatus();
 }
 
@@ -1461,14 +1554,12 @@ absl::Status BytecodeInterpreter::EvalWidthSlice(const Bytecode& bytecode) {
       is_signed ? InterpValueTag::kSBits : InterpValueTag::kUBits;
   XLS_ASSIGN_OR_RETURN(InterpValue result,
                        InterpValue::MakeBits(tag, result_bits));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalXor(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseXor(rhs);
-  });
+  return EvalPureBinop(bytecode);
 }
 
 absl::Status BytecodeInterpreter::RunBuiltinFn(const Bytecode& bytecode,
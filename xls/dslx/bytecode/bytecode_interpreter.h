@@ -25,8 +25,10 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/dslx/bytecode/bytecode.h"
@@ -60,26 +62,52 @@ inline void InfoLoggingTraceHook(const FileTable& file_table,
 struct BlockedChannelInfo {
   std::string name;
   Span span;
+  // Instance id of the channel in the InterpValueChannelManager.
+  int64_t channel_id;
 };
 
-// A FIFO which backs channel instances in the bytecode interpreter.
+// A FIFO which backs channel instances in the bytecode interpreter. The queue
+// is internally synchronized so that a sending and a receiving proc may run on
+// different threads.
 class InterpValueChannel {
  public:
   InterpValueChannel() = default;
   InterpValueChannel(const InterpValueChannel&) = delete;
-  InterpValueChannel(InterpValueChannel&&) = default;
 
-  bool IsEmpty() const { return queue_.empty(); }
-  int64_t GetSize() const { return queue_.size(); }
+  bool IsEmpty() const {
+    absl::MutexLock lock(&mutex_);
+    return queue_.empty();
+  }
+  int64_t GetSize() const {
+    absl::MutexLock lock(&mutex_);
+    return queue_.size();
+  }
   InterpValue Read() {
+    absl::MutexLock lock(&mutex_);
     InterpValue result = std::move(queue_.front());
     queue_.pop_front();
     return result;
   }
-  void Write(InterpValue v) { queue_.push_back(std::move(v)); }
+  void Write(InterpValue v) {
+    {
+      absl::MutexLock lock(&mutex_);
+      queue_.push_back(std::move(v));
+    }
+    if (write_listener_ != nullptr) {
+      write_listener_();
+    }
+  }
+
+  // Sets a callback which is invoked after every write to the channel. Must
+  // not be called while the channel is in use.
+  void SetWriteListener(std::function<void()> listener) {
+    write_listener_ = std::move(listener);
+  }
 
  private:
-  std::deque<InterpValue> queue_;
+  mutable absl::Mutex mutex_;
+  std::deque<InterpValue> queue_ ABSL_GUARDED_BY(mutex_);
+  std::function<void()> write_listener_;
 };
 
 // A collection of all channel objects used by a proc network (elaboration).
@@ -224,6 +252,21 @@ class BytecodeInterpreter {
       const std::function<absl::StatusOr<InterpValue>(
           const InterpValue& lhs, const InterpValue& rhs)>& op);
 
+  // Returns whether `op` pops two operands and pushes a result computed by
+  // ComputePureBinop, without any other effect on the interpreter state.
+  static bool IsPureBinop(Bytecode::Op op);
+  absl::StatusOr<InterpValue> ComputePureBinop(const Bytecode& bytecode,
+                                               const InterpValue& lhs,
+                                               const InterpValue& rhs);
+  absl::Status EvalPureBinop(const Bytecode& bytecode);
+
+  // Evaluates a `load; (load | literal); <pure binop>` sequence starting at
+  // the current PC as a single instruction, reading the operands directly out
+  // of the frame's slots rather than copying them onto the stack. This is the
+  // shape of e.g. for-loop iterable indexing and most comparisons. Returns
+  // false, without evaluating anything, if the sequence does not match.
+  absl::StatusOr<bool> EvalFusedLoadBinop();
+
   absl::StatusOr<BytecodeFunction*> GetBytecodeFn(
       Function& function, const Invocation* invocation,
       const ParametricEnv& caller_bindings);
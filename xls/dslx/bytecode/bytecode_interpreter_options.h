@@ -88,6 +88,27 @@ class BytecodeInterpreterOptions {
     return validate_final_stack_depth_;
   }
 
+  // When executing a proc hierarchy, the number of worker threads on which
+  // proc instances are run concurrently. A proc blocked on a receive is parked
+  // until its channel is written. If zero, procs are run one at a time on the
+  // calling thread in a fixed order.
+  BytecodeInterpreterOptions& proc_threads(int64_t value) {
+    proc_threads_ = value;
+    return *this;
+  }
+  int64_t proc_threads() const { return proc_threads_; }
+
+  // When procs run concurrently (see `proc_threads`), whether trace and
+  // rollover hook invocations are buffered and replayed at the end of each
+  // tick grouped by proc instance in elaboration order. This makes the trace
+  // output independent of thread scheduling. If false, hooks are invoked as
+  // they occur (serialized, but in nondeterministic order).
+  BytecodeInterpreterOptions& deterministic_proc_traces(bool value) {
+    deterministic_proc_traces_ = value;
+    return *this;
+  }
+  bool deterministic_proc_traces() const { return deterministic_proc_traces_; }
+
   // The format preference to use when one is not otherwise specified. This is
   // used for `{}` in `trace_fmt`, in `assert_eq` messages, with the
   // `trace_channels` options and elsewhere.
@@ -104,6 +125,8 @@ class BytecodeInterpreterOptions {
   bool trace_channels_ = false;
   std::optional<int64_t> max_ticks_;
   bool validate_final_stack_depth_ = true;
+  int64_t proc_threads_ = 0;
+  bool deterministic_proc_traces_ = true;
   FormatPreference format_preference_ = FormatPreference::kDefault;
 };
 
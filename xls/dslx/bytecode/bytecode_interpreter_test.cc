@@ -1271,6 +1271,32 @@ fn index_tuple() -> u32 {
   EXPECT_EQ(int_value, 6);
 }
 
+// Exercises the fused `load; load; <op>` and `load; literal; <op>` sequences
+// emitted for loop headers, array indexing and comparisons of locals.
+TEST_F(BytecodeInterpreterTest, BinopsOnLocals) {
+  constexpr std::string_view kProgram = R"(
+fn main(a: u32[4], x: u32, y: u32) -> (u32, bool, bool, u32) {
+  let sum = for (i, acc): (u32, u32) in u32:0..u32:4 {
+    acc + a[i]
+  }(u32:0);
+  (sum, x < y, x == u32:7, x ^ y)
+})";
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue array,
+      InterpValue::MakeArray(
+          {InterpValue::MakeU32(1), InterpValue::MakeU32(2),
+           InterpValue::MakeU32(3), InterpValue::MakeU32(4)}));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue value,
+      Interpret(kProgram, "main",
+                {array, InterpValue::MakeU32(7), InterpValue::MakeU32(9)}));
+  EXPECT_EQ(value, InterpValue::MakeTuple(
+                       {InterpValue::MakeU32(10), InterpValue::MakeBool(true),
+                        InterpValue::MakeBool(true),
+                        InterpValue::MakeU32(7 ^ 9)}));
+}
+
 TEST_F(BytecodeInterpreterTest, SimpleBitSlice) {
   constexpr std::string_view kProgram = R"(
 fn simple_slice() -> u16 {
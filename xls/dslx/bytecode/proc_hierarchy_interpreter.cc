@@ -29,9 +29,11 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
@@ -209,7 +211,8 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeInterpreter> next_interpreter,
       CreateUnique(import_data, callee_proc_id, next_bf.get(), full_next_args,
-                   &hierarchy_interpreter->channel_manager(), options));
+                   &hierarchy_interpreter->channel_manager(),
+                   hierarchy_interpreter->GetProcInstanceOptions(options)));
   hierarchy_interpreter->AddProcInstance(
       ProcInstance{proc, std::move(next_interpreter), std::move(next_bf),
                    *proc_members, initial_state, type_info});
@@ -224,6 +227,7 @@ ProcHierarchyInterpreter::Create(ImportData* import_data, TypeInfo* type_info,
                                  const BytecodeInterpreterOptions& options) {
   ProcIdFactory proc_id_factory;
   auto hierarchy_interpreter = std::make_unique<ProcHierarchyInterpreter>();
+  hierarchy_interpreter->options_ = options;
 
   // Allocate the channels for the top-level config interface.
   for (int64_t index = 0; index < top_proc->config().params().size(); ++index) {
@@ -317,7 +321,181 @@ void ProcHierarchyInterpreter::AddProcInstance(ProcInstance&& proc_instance) {
   proc_instances_.push_back(std::move(proc_instance));
 }
 
+ProcHierarchyInterpreter::~ProcHierarchyInterpreter() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+BytecodeInterpreterOptions ProcHierarchyInterpreter::GetProcInstanceOptions(
+    const BytecodeInterpreterOptions& options) {
+  if (options.proc_threads() <= 0) {
+    return options;
+  }
+  BytecodeInterpreterOptions result = options;
+  if (options.post_fn_eval_hook() != nullptr) {
+    result.post_fn_eval_hook(
+        [this, hook = options.post_fn_eval_hook()](
+            const Function* f, absl::Span<const InterpValue> args,
+            const ParametricEnv* env, const InterpValue& got) {
+          absl::MutexLock lock(&hook_mutex_);
+          return hook(f, args, env, got);
+        });
+  }
+  if (options.deterministic_proc_traces()) {
+    std::vector<BufferedHookCall>* calls =
+        hook_buffers_
+            .emplace_back(std::make_unique<std::vector<BufferedHookCall>>())
+            .get();
+    if (options.trace_hook() != nullptr) {
+      result.trace_hook([calls](const Span& span, std::string_view message) {
+        calls->push_back(
+            BufferedHookCall{.span = span, .message = std::string{message}});
+      });
+    }
+    if (options.rollover_hook() != nullptr) {
+      result.rollover_hook([calls](const Span& span) {
+        calls->push_back(
+            BufferedHookCall{.span = span, .message = std::nullopt});
+      });
+    }
+    return result;
+  }
+  if (options.trace_hook() != nullptr) {
+    result.trace_hook([this, hook = options.trace_hook()](
+                          const Span& span, std::string_view message) {
+      absl::MutexLock lock(&hook_mutex_);
+      hook(span, message);
+    });
+  }
+  if (options.rollover_hook() != nullptr) {
+    result.rollover_hook(
+        [this, hook = options.rollover_hook()](const Span& span) {
+          absl::MutexLock lock(&hook_mutex_);
+          hook(span);
+        });
+  }
+  return result;
+}
+
+void ProcHierarchyInterpreter::StartWorkers() {
+  {
+    absl::MutexLock lock(&mutex_);
+    parked_.resize(channel_manager_.size());
+  }
+  for (int64_t id = 0; id < channel_manager_.size(); ++id) {
+    channel_manager_.GetChannel(id).SetWriteListener(
+        [this, id]() { OnChannelWrite(id); });
+  }
+  for (int64_t i = 0; i < options_.proc_threads(); ++i) {
+    workers_.push_back(std::make_unique<Thread>([this]() { WorkerLoop(); }));
+  }
+}
+
+void ProcHierarchyInterpreter::WorkerLoop() {
+  while (true) {
+    int64_t index;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(
+          absl::Condition(this, &ProcHierarchyInterpreter::WorkerHasWork));
+      if (shutdown_) {
+        return;
+      }
+      index = ready_.front();
+      ready_.pop_front();
+      ++running_;
+    }
+
+    absl::StatusOr<ProcRunResult> run_result = proc_instances_[index].Run();
+
+    absl::MutexLock lock(&mutex_);
+    --running_;
+    if (!run_result.ok()) {
+      if (!error_.has_value() || index < error_->first) {
+        error_ = {index, run_result.status()};
+      }
+      // Stop dispatching; the tick ends once the running procs finish.
+      ready_.clear();
+      continue;
+    }
+    progress_made_ |= run_result->progress_made;
+    if (error_.has_value() ||
+        run_result->execution_state != ProcExecutionState::kBlockedOnReceive) {
+      continue;
+    }
+    // The channel may have been written between the failed receive and now, in
+    // which case the write did not see this proc parked.
+    int64_t channel_id = run_result->blocked_channel_info->channel_id;
+    if (channel_manager_.GetChannel(channel_id).IsEmpty()) {
+      parked_[channel_id].push_back(index);
+    } else {
+      ready_.push_back(index);
+    }
+  }
+}
+
+void ProcHierarchyInterpreter::OnChannelWrite(int64_t channel_id) {
+  absl::MutexLock lock(&mutex_);
+  if (!tick_active_ || error_.has_value()) {
+    return;
+  }
+  std::vector<int64_t>& parked = parked_[channel_id];
+  ready_.insert(ready_.end(), parked.begin(), parked.end());
+  parked.clear();
+}
+
+void ProcHierarchyInterpreter::ReplayBufferedHookCalls() {
+  for (std::unique_ptr<std::vector<BufferedHookCall>>& calls : hook_buffers_) {
+    for (const BufferedHookCall& call : *calls) {
+      if (call.message.has_value()) {
+        options_.trace_hook()(call.span, *call.message);
+      } else {
+        options_.rollover_hook()(call.span);
+      }
+    }
+    calls->clear();
+  }
+}
+
+absl::Status ProcHierarchyInterpreter::TickConcurrently(bool* progress_made) {
+  if (workers_.empty()) {
+    StartWorkers();
+  }
+  std::optional<std::pair<int64_t, absl::Status>> error;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (std::vector<int64_t>& parked : parked_) {
+      parked.clear();
+    }
+    for (int64_t i = 0; i < proc_instances_.size(); ++i) {
+      ready_.push_back(i);
+    }
+    progress_made_ = false;
+    error_.reset();
+    tick_active_ = true;
+    mutex_.Await(absl::Condition(this, &ProcHierarchyInterpreter::TickDone));
+    tick_active_ = false;
+    *progress_made = progress_made_;
+    error = std::move(error_);
+  }
+  ReplayBufferedHookCalls();
+  if (error.has_value()) {
+    return error->second;
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ProcHierarchyInterpreter::Tick() {
+  if (options_.proc_threads() > 0) {
+    bool progress_made;
+    return TickConcurrently(&progress_made);
+  }
+
   std::deque<ProcInstance*> ready_list;
   for (auto& p : proc_instances()) {
     ready_list.push_back(&p);
@@ -390,18 +568,33 @@ absl::StatusOr<int64_t> ProcHierarchyInterpreter::TickUntilOutput(
                           options.max_ticks().value()));
     }
     std::vector<std::string> blocked_channels;
-    for (auto& p : proc_instances()) {
-      XLS_ASSIGN_OR_RETURN(ProcRunResult run_result, p.Run());
-      if (run_result.execution_state == ProcExecutionState::kBlockedOnReceive) {
-        XLS_RET_CHECK(run_result.blocked_channel_info.has_value());
-        BlockedChannelInfo channel_info =
-            run_result.blocked_channel_info.value();
-        blocked_channels.push_back(absl::StrFormat(
-            "%s: proc `%s` is blocked on receive on channel `%s`",
-            channel_info.span.ToString(p.interpreter().file_table()),
-            p.proc()->identifier(), channel_info.name));
+    auto add_blocked_channel = [&](const ProcInstance& p,
+                                   const BlockedChannelInfo& channel_info) {
+      blocked_channels.push_back(absl::StrFormat(
+          "%s: proc `%s` is blocked on receive on channel `%s`",
+          channel_info.span.ToString(p.interpreter().file_table()),
+          p.proc()->identifier(), channel_info.name));
+    };
+    if (options_.proc_threads() > 0) {
+      XLS_RETURN_IF_ERROR(TickConcurrently(&progress_made));
+      absl::MutexLock lock(&mutex_);
+      for (const std::vector<int64_t>& parked : parked_) {
+        for (int64_t index : parked) {
+          const ProcInstance& p = proc_instances_[index];
+          XLS_RET_CHECK(p.interpreter().blocked_channel_info().has_value());
+          add_blocked_channel(p, *p.interpreter().blocked_channel_info());
+        }
+      }
+    } else {
+      for (auto& p : proc_instances()) {
+        XLS_ASSIGN_OR_RETURN(ProcRunResult run_result, p.Run());
+        if (run_result.execution_state ==
+            ProcExecutionState::kBlockedOnReceive) {
+          XLS_RET_CHECK(run_result.blocked_channel_info.has_value());
+          add_blocked_channel(p, run_result.blocked_channel_info.value());
+        }
+        progress_made |= run_result.progress_made;
       }
-      progress_made |= run_result.progress_made;
     }
 
     if (!progress_made) {
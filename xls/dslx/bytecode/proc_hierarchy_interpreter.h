@@ -15,6 +15,7 @@
 #define XLS_DSLX_BYTECODE_PROC_HIERARCHY_INTERPRETER_H_
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -22,14 +23,18 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter_options.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/proc.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/interp_value.h"
@@ -95,12 +100,19 @@ class ProcInstance {
 // An interpreter which evaluates a hierarchy of procs elaborated from the top
 // proc. The abstraction includes interpreters for each proc instantiation and
 // InterpValueChannels for each channel instantiation.
+//
+// If BytecodeInterpreterOptions::proc_threads is set, proc instances are run
+// concurrently on a pool of worker threads owned by the interpreter. A proc
+// which blocks on a receive is parked on the channel and is resumed when the
+// channel is written.
 class ProcHierarchyInterpreter {
  public:
   static absl::StatusOr<std::unique_ptr<ProcHierarchyInterpreter>> Create(
       ImportData* import_data, TypeInfo* type_info, Proc* top_proc,
       const BytecodeInterpreterOptions& options = BytecodeInterpreterOptions());
 
+  ~ProcHierarchyInterpreter();
+
   // Execute at most a single iteration of every proc in the hierarchy. Upon
   // return, all procs are either blocked on a receive or have completed a
   // tick. A proc may be blocked and resumed multiple times in a single
@@ -149,7 +161,38 @@ class ProcHierarchyInterpreter {
                                    const Type* payload_type);
   void AddProcInstance(ProcInstance&& proc_instance);
 
+  // Returns the options with which to create the interpreter of the proc
+  // instance which is next added with AddProcInstance. When procs run
+  // concurrently the hooks in `options` are wrapped so that they may be called
+  // from the worker threads.
+  BytecodeInterpreterOptions GetProcInstanceOptions(
+      const BytecodeInterpreterOptions& options);
+
  private:
+  // A trace (if `message` is set) or rollover hook invocation buffered for
+  // deterministic replay at the end of a tick.
+  struct BufferedHookCall {
+    Span span;
+    std::optional<std::string> message;
+  };
+
+  // Runs the proc instances on the worker threads until every instance has
+  // either completed a tick or is parked on an empty channel. Sets
+  // `progress_made` if any instance executed at least one instruction.
+  absl::Status TickConcurrently(bool* progress_made);
+  void StartWorkers();
+  void WorkerLoop();
+  void OnChannelWrite(int64_t channel_id);
+  void ReplayBufferedHookCalls();
+
+  bool WorkerHasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return shutdown_ || (tick_active_ && !ready_.empty());
+  }
+  bool TickDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return ready_.empty() && running_ == 0;
+  }
+
+  BytecodeInterpreterOptions options_;
   InterpValueChannelManager channel_manager_;
   std::vector<ProcInstance> proc_instances_;
   std::vector<InterpValue> interface_args_;
@@ -162,6 +205,28 @@ class ProcHierarchyInterpreter {
     InterpValueChannel* channel;
   };
   std::vector<InterfaceChannel> interface_channels_;
+
+  // State for running proc instances concurrently.
+  std::vector<std::unique_ptr<Thread>> workers_;
+  absl::Mutex mutex_;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  bool tick_active_ ABSL_GUARDED_BY(mutex_) = false;
+  // Indices of proc instances which are ready to run.
+  std::deque<int64_t> ready_ ABSL_GUARDED_BY(mutex_);
+  int64_t running_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Indices of the proc instances parked on each channel, indexed by channel
+  // id.
+  std::vector<std::vector<int64_t>> parked_ ABSL_GUARDED_BY(mutex_);
+  bool progress_made_ ABSL_GUARDED_BY(mutex_) = false;
+  // The error from the lowest-indexed proc instance which failed in this tick.
+  std::optional<std::pair<int64_t, absl::Status>> error_
+      ABSL_GUARDED_BY(mutex_);
+
+  // Buffered hook calls of each proc instance, in instance order. Only used if
+  // `deterministic_proc_traces` is set.
+  std::vector<std::unique_ptr<std::vector<BufferedHookCall>>> hook_buffers_;
+  // Serializes hook calls which are not buffered.
+  absl::Mutex hook_mutex_;
 };
 
 }  // namespace xls::dslx
@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "xls/dslx/bytecode/proc_hierarchy_interpreter.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -792,5 +793,117 @@ proc tester_proc {
           "Sent data on channel `tester_proc::terminator`:\n  u1:1"));
 }
 
+constexpr std::string_view kIncrementerPipelineProgram = R"(
+proc incrementer {
+  in_ch: chan<u32> in;
+  out_ch: chan<u32> out;
+
+  init { () }
+
+  config(in_ch: chan<u32> in, out_ch: chan<u32> out) {
+    (in_ch, out_ch)
+  }
+  next(_: ()) {
+    let (tok, i) = recv(join(), in_ch);
+    let tok = send(tok, out_ch, i + u32:1);
+  }
+}
+
+#[test_proc]
+proc tester_proc {
+  data_out: chan<u32> out;
+  data_in: chan<u32> in;
+  terminator: chan<bool> out;
+
+  init { u32:0 }
+
+  config(terminator: chan<bool> out) {
+    let (p0, c0) = chan<u32>("c0");
+    let (p1, c1) = chan<u32>("c1");
+    let (p2, c2) = chan<u32>("c2");
+    let (p3, c3) = chan<u32>("c3");
+    spawn incrementer(c0, p1);
+    spawn incrementer(c1, p2);
+    spawn incrementer(c2, p3);
+    (p0, c3, terminator)
+  }
+
+  next(count: u32) {
+    let tok = send(join(), data_out, count);
+    let (tok, result) = recv(tok, data_in);
+    assert_eq(result, count + u32:3);
+    let tok = send_if(tok, terminator, count == u32:20, true);
+    count + u32:1
+  }
+})";
+
+TEST_F(ProcHierarchyInterpreterTest, ConcurrentProcs) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestProc * test_proc,
+      ParseAndGetTestProc(kIncrementerPipelineProgram, "tester_proc"));
+  for (int64_t threads : {1, 2, 8}) {
+    XLS_EXPECT_OK(
+        Run(test_proc, BytecodeInterpreterOptions().proc_threads(threads)));
+  }
+}
+
+TEST_F(ProcHierarchyInterpreterTest, ConcurrentProcsDeterministicTraces) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestProc * test_proc,
+      ParseAndGetTestProc(kIncrementerPipelineProgram, "tester_proc"));
+  auto run = [&](const BytecodeInterpreterOptions& options)
+      -> absl::StatusOr<std::vector<std::string>> {
+    std::vector<std::string> trace_output;
+    XLS_RETURN_IF_ERROR(Run(
+        test_proc, BytecodeInterpreterOptions(options)
+                       .trace_channels(true)
+                       .trace_hook([&](const Span&, std::string_view s) {
+                         trace_output.push_back(std::string{s});
+                       })));
+    return trace_output;
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> expected,
+      run(BytecodeInterpreterOptions().proc_threads(1)));
+  // Each tick the traces are grouped by proc instance. The incrementers are
+  // elaborated before the tester, so the first tick begins with the first
+  // incrementer receiving the tester's first value.
+  ASSERT_FALSE(expected.empty());
+  EXPECT_EQ(expected.front(),
+            "Received data on channel `tester_proc->incrementer#0::in_ch`:\n"
+            "  u32:0");
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_THAT(run(BytecodeInterpreterOptions().proc_threads(8)),
+                IsOkAndHolds(expected));
+  }
+}
+
+TEST_F(ProcHierarchyInterpreterTest, ConcurrentProcsDeadlock) {
+  constexpr std::string_view kProgram = R"(
+#[test_proc]
+proc tester_proc {
+  data_in: chan<u32> in;
+  terminator: chan<bool> out;
+
+  init { () }
+
+  config(terminator: chan<bool> out) {
+    let (_p, c) = chan<u32>("never_written");
+    (c, terminator)
+  }
+
+  next(state: ()) {
+    let (tok, _x) = recv(join(), data_in);
+    let tok = send(tok, terminator, true);
+  }
+})";
+  XLS_ASSERT_OK_AND_ASSIGN(TestProc * test_proc,
+                           ParseAndGetTestProc(kProgram, "tester_proc"));
+  EXPECT_THAT(Run(test_proc, BytecodeInterpreterOptions().proc_threads(2)),
+              StatusIs(absl::StatusCode::kDeadlineExceeded,
+                       HasSubstr("proc `tester_proc` is blocked on receive on "
+                                 "channel `tester_proc::data_in`")));
+}
+
 }  // namespace
 }  // namespace xls::dslx
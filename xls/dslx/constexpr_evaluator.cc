@@ -181,12 +181,34 @@ absl::Status ConstexprEvaluator::HandleAllOnesMacro(const AllOnesMacro* expr) {
 
 absl::Status ConstexprEvaluator::HandleArray(const Array* expr) {
   VLOG(3) << "ConstexprEvaluator::HandleArray : " << expr->ToString();
+  if (expr->members().empty()) {
+    return InterpretExpr(expr);
+  }
+
+  // No need to fire up the interpreter: with every member known, the value is
+  // built directly, which keeps large constant tables from being re-emitted as
+  // bytecode.
   std::vector<InterpValue> values;
+  values.reserve(expr->members().size());
   for (const Expr* member : expr->members()) {
-    EVAL_AS_CONSTEXPR_OR_RETURN(member);
+    GET_CONSTEXPR_OR_RETURN(InterpValue value, member);
+    values.push_back(std::move(value));
   }
 
-  return InterpretExpr(expr);
+  // If we've got an ellipsis, then repeat the last element until we reach the
+  // full array size.
+  if (expr->has_ellipsis()) {
+    XLS_ASSIGN_OR_RETURN(ArrayType * array_type,
+                         type_info_->GetItemAs<ArrayType>(expr));
+    XLS_ASSIGN_OR_RETURN(int64_t size, array_type->size().GetAsInt64());
+    XLS_RET_CHECK_GE(size, values.size());
+    values.resize(size, values.back());
+  }
+
+  XLS_ASSIGN_OR_RETURN(InterpValue array,
+                       InterpValue::MakeArray(std::move(values)));
+  type_info_->NoteConstExpr(expr, std::move(array));
+  return absl::OkStatus();
 }
 
 absl::Status ConstexprEvaluator::HandleBinop(const Binop* expr) {
@@ -139,6 +139,26 @@ const kFoo = u32:7;
   EXPECT_TRUE(warnings.warnings().empty());
 }
 
+TEST(ConstexprEvaluatorTest, HandleArrayWithEllipsis) {
+  constexpr std::string_view kModule = R"(
+const kFoo = u8[4]:[1, 2, ...];
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(TestData test_data, CreateTestData(kModule));
+  Module* module = test_data.module.get();
+  TypeInfo* type_info = test_data.type_info;
+  XLS_ASSERT_OK_AND_ASSIGN(ConstantDef * constant_def,
+                           module->GetConstantDef("kFoo"));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue value,
+                           type_info->GetConstExpr(constant_def->value()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue want,
+      InterpValue::MakeArray(
+          {InterpValue::MakeUBits(8, 1), InterpValue::MakeUBits(8, 2),
+           InterpValue::MakeUBits(8, 2), InterpValue::MakeUBits(8, 2)}));
+  EXPECT_EQ(value, want);
+}
+
 TEST(ConstexprEvaluatorTest, HandleCastSimple) {
   constexpr std::string_view kModule = R"(
 const kFoo = u32:13;
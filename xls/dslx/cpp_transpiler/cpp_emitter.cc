@@ -191,6 +191,41 @@ class BitVectorCppEmitter : public CppEmitter {
     return absl::StrJoin(pieces, "\n");
   }
 
+  std::string AssignToNative(std::string_view buffer, std::string_view layout,
+                             std::string_view leaf_index, std::string_view rhs,
+                             int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("if (!FitsInNBits%s(%s, %d)) {",
+                                     is_signed() ? "Signed" : "Unsigned", rhs,
+                                     dslx_bit_count()));
+    pieces.push_back(
+        absl::StrFormat("  return absl::InvalidArgumentError(\"Value does "
+                        "not fit in %d bits\");",
+                        dslx_bit_count()));
+    pieces.push_back("}");
+    pieces.push_back(absl::StrFormat(
+        "XLS_RETURN_IF_ERROR(WriteNativeLeaf(static_cast<uint64_t>(%s), %d, "
+        "%s, %s, %s));",
+        rhs, dslx_bit_count(), layout, leaf_index, buffer));
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string AssignFromNative(std::string_view lhs, std::string_view buffer,
+                               std::string_view layout,
+                               std::string_view leaf_index,
+                               int64_t nesting) const override {
+    std::string leaf_var = absl::StrCat("leaf", nesting);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat(
+        "XLS_ASSIGN_OR_RETURN(uint64_t %s, ReadNativeLeaf(%d, %s, %s, %s, "
+        "%s));",
+        leaf_var, dslx_bit_count(), is_signed() ? "true" : "false", layout,
+        leaf_index, buffer));
+    pieces.push_back(absl::StrFormat("%s = static_cast<%s>(%s);", lhs,
+                                     cpp_type(), leaf_var));
+    return absl::StrFormat("{\n%s\n}", Indent(absl::StrJoin(pieces, "\n"), 2));
+  }
+
   std::string Verify(std::string_view identifier, std::string_view name,
                      int64_t nesting) const override {
     std::vector<std::string> pieces;
@@ -300,6 +335,31 @@ class TypeRefCppEmitter : public CppEmitter {
                          : absl::StrFormat("%sFromValue(%s)", cpp_type(), rhs));
   }
 
+  std::string AssignToNative(std::string_view buffer, std::string_view layout,
+                             std::string_view leaf_index, std::string_view rhs,
+                             int64_t nesting) const override {
+    return absl::StrFormat(
+        "XLS_RETURN_IF_ERROR(%s);",
+        TypeHasMethods()
+            ? absl::StrFormat("%s.ToNative(%s, %s, %s)", rhs, layout, buffer,
+                              leaf_index)
+            : absl::StrFormat("%sToNative(%s, %s, %s, %s)", cpp_type(), rhs,
+                              layout, buffer, leaf_index));
+  }
+
+  std::string AssignFromNative(std::string_view lhs, std::string_view buffer,
+                               std::string_view layout,
+                               std::string_view leaf_index,
+                               int64_t nesting) const override {
+    return absl::StrFormat(
+        "XLS_ASSIGN_OR_RETURN(%s, %s);", lhs,
+        TypeHasMethods()
+            ? absl::StrFormat("%s::FromNative(%s, %s, %s)", cpp_type(), layout,
+                              buffer, leaf_index)
+            : absl::StrFormat("%sFromNative(%s, %s, %s)", cpp_type(), layout,
+                              buffer, leaf_index));
+  }
+
   std::string Verify(std::string_view identifier, std::string_view name,
                      int64_t nesting) const override {
     return absl::StrFormat(
@@ -430,6 +490,37 @@ class ArrayCppEmitter : public CppEmitter {
     return absl::StrJoin(pieces, "\n");
   }
 
+  std::string AssignToNative(std::string_view buffer, std::string_view layout,
+                             std::string_view leaf_index, std::string_view rhs,
+                             int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("for (int64_t %s = 0; %s < %d; ++%s) {",
+                                     ind_var, ind_var, array_size(), ind_var));
+    std::string element_assignment = element_emitter_->AssignToNative(
+        buffer, layout, leaf_index, absl::StrFormat("%s[%s]", rhs, ind_var),
+        nesting + 1);
+    pieces.push_back(Indent(element_assignment, 2));
+    pieces.push_back("}");
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string AssignFromNative(std::string_view lhs, std::string_view buffer,
+                               std::string_view layout,
+                               std::string_view leaf_index,
+                               int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("for (int64_t %s = 0; %s < %d; ++%s) {",
+                                     ind_var, ind_var, array_size(), ind_var));
+    std::string element_assignment = element_emitter_->AssignFromNative(
+        absl::StrFormat("%s[%s]", lhs, ind_var), buffer, layout, leaf_index,
+        nesting + 1);
+    pieces.push_back(Indent(element_assignment, 2));
+    pieces.push_back("}");
+    return absl::StrJoin(pieces, "\n");
+  }
+
   std::string Verify(std::string_view identifier, std::string_view name,
                      int64_t nesting) const override {
     std::string ind_var = absl::StrCat("i", nesting);
@@ -568,6 +659,31 @@ class TupleCppEmitter : public CppEmitter {
     return absl::StrJoin(pieces, "\n");
   }
 
+  std::string AssignToNative(std::string_view buffer, std::string_view layout,
+                             std::string_view leaf_index, std::string_view rhs,
+                             int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    for (int64_t i = 0; i < size(); ++i) {
+      pieces.push_back(element_emitters_[i]->AssignToNative(
+          buffer, layout, leaf_index,
+          absl::StrFormat("std::get<%d>(%s)", i, rhs), nesting + 1));
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string AssignFromNative(std::string_view lhs, std::string_view buffer,
+                               std::string_view layout,
+                               std::string_view leaf_index,
+                               int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    for (int64_t i = 0; i < size(); ++i) {
+      pieces.push_back(element_emitters_[i]->AssignFromNative(
+          absl::StrFormat("std::get<%d>(%s)", i, lhs), buffer, layout,
+          leaf_index, nesting + 1));
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
   std::string Verify(std::string_view identifier, std::string_view name,
                      int64_t nesting) const override {
     std::vector<std::string> pieces;
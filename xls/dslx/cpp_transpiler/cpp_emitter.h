@@ -58,6 +58,27 @@ class CppEmitter {
                                       std::string_view rhs,
                                       int64_t nesting) const = 0;
 
+  // Emits and returns c++ code which writes `rhs` of `cpp_type()` into the
+  // native JIT layout in the `uint8_t*` named `buffer`, as described by the
+  // `::xls::TypeLayout` named `layout`. `leaf_index` names an `int64_t*` which
+  // holds the index of the next leaf element of `layout` to write and which is
+  // advanced past the leaves of this type. Padding bytes are not written so
+  // the buffer must be zeroed beforehand.
+  virtual std::string AssignToNative(std::string_view buffer,
+                                     std::string_view layout,
+                                     std::string_view leaf_index,
+                                     std::string_view rhs,
+                                     int64_t nesting) const = 0;
+
+  // Emits and returns c++ code which reads `lhs` of `cpp_type()` from the
+  // native JIT layout in the `const uint8_t*` named `buffer`. The other
+  // arguments are as in AssignToNative.
+  virtual std::string AssignFromNative(std::string_view lhs,
+                                       std::string_view buffer,
+                                       std::string_view layout,
+                                       std::string_view leaf_index,
+                                       int64_t nesting) const = 0;
+
   // Emits and returns c++ code which verifies that `identifier` of type
   // `cpp_type()` is properly formed. `name` is a descriptive string (e.g., type
   // or field name) which can be used in an error message. The code will raise
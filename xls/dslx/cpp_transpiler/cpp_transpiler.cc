@@ -37,7 +37,8 @@ namespace xls::dslx {
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces) {
+                                         std::string_view namespaces,
+                                         bool generate_native_layout) {
   constexpr std::string_view kHeaderTemplate =
       R"(// AUTOMATICALLY GENERATED FILE FROM `xls/dslx/cpp_transpiler`. DO NOT EDIT!
 #ifndef $0
@@ -49,7 +50,7 @@ absl::StatusOr<CppSource> TranspileToCpp(Module* module,
 #include <vector>
 
 #include "absl/status/statusor.h"
-#include "xls/public/value.h"
+$4#include "xls/public/value.h"
 
 $2$1$3
 
@@ -59,7 +60,7 @@ $2$1$3
   constexpr std::string_view kSourceTemplate =
       R"(// AUTOMATICALLY GENERATED FILE FROM `xls/dslx/cpp_transpiler`. DO NOT EDIT!
 #include <array>
-#include <string>
+%s#include <string>
 #include <vector>
 
 #include "%s"
@@ -68,7 +69,7 @@ $2$1$3
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
-#include "xls/public/status_macros.h"
+%s#include "xls/public/status_macros.h"
 #include "xls/public/value.h"
 
 [[maybe_unused]] static bool FitsInNBitsSigned(int64_t value, int64_t n) {
@@ -93,8 +94,81 @@ $2$1$3
 [[maybe_unused]] static std::string __indent(int64_t amount) {
   return std::string(amount * 2, ' ');
 }
-
+%s
 %s%s%s
+)";
+
+  // Support routines for the generated `ToNative` and `FromNative`
+  // conversions. Leaves are copied in host byte order, as the JIT does.
+  constexpr std::string_view kNativeLayoutSupport = R"(
+[[maybe_unused]] static absl::Status CheckNativeLeafCount(
+    const ::xls::TypeLayout& layout, int64_t leaf_count) {
+  if (leaf_count != layout.elements().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Type layout has %d leaf elements, expected %d.",
+        layout.elements().size(), leaf_count));
+  }
+  return absl::OkStatus();
+}
+
+[[maybe_unused]] static absl::StatusOr<const ::xls::ElementLayout*>
+NextNativeLeaf(const ::xls::TypeLayout& layout, int64_t bit_count,
+               int64_t* leaf_index) {
+  if (*leaf_index >= layout.elements().size()) {
+    return absl::InvalidArgumentError(
+        "Type layout has too few leaf elements.");
+  }
+  const ::xls::ElementLayout& element = layout.elements()[(*leaf_index)++];
+  if (!element.bit_offset.has_value() &&
+      element.data_size != (bit_count + 7) / 8) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Type layout element %d has %d bytes of data, expected %d bits.",
+        *leaf_index - 1, element.data_size, bit_count));
+  }
+  return &element;
+}
+
+[[maybe_unused]] static absl::Status WriteNativeLeaf(
+    uint64_t value, int64_t bit_count, const ::xls::TypeLayout& layout,
+    int64_t* leaf_index, uint8_t* buffer) {
+  XLS_ASSIGN_OR_RETURN(const ::xls::ElementLayout* element,
+                       NextNativeLeaf(layout, bit_count, leaf_index));
+  int64_t value_bits = bit_count < 64 ? bit_count : 64;
+  if (value_bits < 64) {
+    value &= (uint64_t{1} << value_bits) - 1;
+  }
+  if (element->bit_offset.has_value()) {
+    ::xls::WritePackedBits(buffer + element->offset, *element->bit_offset,
+                           value_bits, value);
+    return absl::OkStatus();
+  }
+  std::memcpy(buffer + element->offset, &value,
+              element->data_size < 8 ? element->data_size : 8);
+  return absl::OkStatus();
+}
+
+[[maybe_unused]] static absl::StatusOr<uint64_t> ReadNativeLeaf(
+    int64_t bit_count, bool is_signed, const ::xls::TypeLayout& layout,
+    int64_t* leaf_index, const uint8_t* buffer) {
+  XLS_ASSIGN_OR_RETURN(const ::xls::ElementLayout* element,
+                       NextNativeLeaf(layout, bit_count, leaf_index));
+  int64_t value_bits = bit_count < 64 ? bit_count : 64;
+  uint64_t value = 0;
+  if (element->bit_offset.has_value()) {
+    value = ::xls::ReadPackedBits(buffer + element->offset,
+                                  *element->bit_offset, value_bits);
+  } else {
+    std::memcpy(&value, buffer + element->offset,
+                element->data_size < 8 ? element->data_size : 8);
+  }
+  if (value_bits < 64) {
+    value &= (uint64_t{1} << value_bits) - 1;
+    if (is_signed && value_bits > 0 && (value >> (value_bits - 1)) != 0) {
+      value |= ~((uint64_t{1} << value_bits) - 1);
+    }
+  }
+  return value;
+}
 )";
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        import_data->GetRootTypeInfo(module));
@@ -105,7 +179,8 @@ $2$1$3
   // that types defined in imported files can be used.
   for (const TypeDefinition& def : module->GetTypeDefinitions()) {
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<CppTypeGenerator> generator,
-                         CppTypeGenerator::Create(def, type_info, import_data));
+                         CppTypeGenerator::Create(def, type_info, import_data,
+                                                  generate_native_layout));
     XLS_ASSIGN_OR_RETURN(CppSource result, generator->GetCppSource());
     header.push_back(result.header);
     source.push_back(result.source);
@@ -128,12 +203,17 @@ $2$1$3
     namespace_end = absl::StrCat("\n\n}  // namespace ", namespaces);
   }
 
+  std::string_view native_include =
+      generate_native_layout ? "#include \"xls/jit/type_layout.h\"\n" : "";
   return CppSource{
       absl::Substitute(kHeaderTemplate, header_guard,
                        absl::StrJoin(header, "\n\n"), namespace_begin,
-                       namespace_end),
-      absl::StrFormat(kSourceTemplate, output_header_path, namespace_begin,
-                      absl::StrJoin(source, "\n\n"), namespace_end)};
+                       namespace_end, native_include),
+      absl::StrFormat(
+          kSourceTemplate, generate_native_layout ? "#include <cstring>\n" : "",
+          output_header_path, native_include,
+          generate_native_layout ? kNativeLayoutSupport : "", namespace_begin,
+          absl::StrJoin(source, "\n\n"), namespace_end)};
 }
 
 }  // namespace xls::dslx
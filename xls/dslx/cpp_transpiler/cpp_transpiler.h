@@ -38,10 +38,16 @@ namespace xls::dslx {
 // should be infrequent, so users should feel comfortable using these
 // interfaces, but should also be aware of the potential for change in the
 // future.
+//
+// If `generate_native_layout` is true, the types also get `ToNative` and
+// `FromNative` conversions which copy them directly to and from buffers in the
+// native layout used by the JIT, as described by an `xls::TypeLayout`. The
+// generated code then depends on `//xls/jit:type_layout`.
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces = "");
+                                         std::string_view namespaces = "",
+                                         bool generate_native_layout = false);
 
 }  // namespace xls::dslx
 
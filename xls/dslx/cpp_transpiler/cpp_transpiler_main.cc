@@ -45,6 +45,9 @@ ABSL_FLAG(std::string, namespaces, "",
           "Double-colon-delimited namespaces with which to wrap the "
           "generated code, e.g., \"my::namespace\" or "
           "\"::my::explicitly::top::level::namespace\".");
+ABSL_FLAG(bool, generate_native_layout, false,
+          "Whether to also generate `ToNative`/`FromNative` conversions "
+          "between the types and the native layout used by the JIT.");
 ABSL_FLAG(std::string, dslx_stdlib_path,
           std::string(xls::kDefaultDslxStdlibPath),
           "Path to DSLX standard library");
@@ -69,7 +72,8 @@ absl::Status RealMain(const std::filesystem::path& module_path,
                       absl::Span<const std::filesystem::path> dslx_paths,
                       std::string_view output_header_path,
                       std::string_view output_source_path,
-                      std::string_view namespaces) {
+                      std::string_view namespaces,
+                      bool generate_native_layout) {
   XLS_ASSIGN_OR_RETURN(std::string module_text, GetFileContents(module_path));
 
   ImportData import_data(CreateImportData(
@@ -81,7 +85,7 @@ absl::Status RealMain(const std::filesystem::path& module_path,
   XLS_ASSIGN_OR_RETURN(
       CppSource sources,
       TranspileToCpp(module.module, &import_data, output_header_path,
-                     std::string(namespaces)));
+                     std::string(namespaces), generate_native_layout));
 
   XLS_RETURN_IF_ERROR(SetFileContents(output_header_path, sources.header));
   XLS_RETURN_IF_ERROR(SetFileContents(output_source_path, sources.source));
@@ -117,7 +121,8 @@ int main(int argc, char* argv[]) {
 
   return xls::ExitStatus(xls::dslx::RealMain(
       args[0], absl::GetFlag(FLAGS_dslx_stdlib_path), dslx_paths,
-      output_header_path, output_source_path, absl::GetFlag(FLAGS_namespaces)));
+      output_header_path, output_source_path, absl::GetFlag(FLAGS_namespaces),
+      absl::GetFlag(FLAGS_generate_native_layout)));
 
   return 0;
 }
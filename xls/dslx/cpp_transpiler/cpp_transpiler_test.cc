@@ -313,6 +313,40 @@ struct Bar {
   ExpectEqualToGoldenFiles(result);
 }
 
+TEST(CppTranspilerTest, NativeLayoutConversions) {
+  constexpr std::string_view kModule = R"(
+type MyType = u17;
+
+struct MyStruct {
+  x: MyType,
+  y: u8[2],
+}
+)";
+
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule module,
+      ParseAndTypecheck(kModule, "fake_path", "MyModule", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CppSource result,
+      TranspileToCpp(module.module, &import_data, "/tmp/fake_path.h",
+                     /*namespaces=*/"", /*generate_native_layout=*/true));
+  EXPECT_THAT(result.header, HasSubstr("#include \"xls/jit/type_layout.h\""));
+  EXPECT_THAT(result.header,
+              HasSubstr("absl::Status MyTypeToNative(MyType value, const "
+                        "::xls::TypeLayout& layout, uint8_t* buffer);"));
+  EXPECT_THAT(result.header,
+              HasSubstr("static absl::StatusOr<MyStruct> FromNative(const "
+                        "::xls::TypeLayout& layout, const uint8_t* buffer);"));
+  EXPECT_THAT(result.source,
+              HasSubstr("XLS_RETURN_IF_ERROR(MyTypeToNative(x, layout, "
+                        "buffer, leaf_index));"));
+  EXPECT_THAT(result.source,
+              HasSubstr("XLS_RETURN_IF_ERROR(WriteNativeLeaf("
+                        "static_cast<uint64_t>(y[i0]), 8, layout, leaf_index, "
+                        "buffer));"));
+}
+
 TEST(CppTranspilerTest, UnsupportedS1) {
   constexpr std::string_view kModule = R"(
 type MyUnsupportedSignedBit = s1;
@@ -54,6 +54,70 @@ absl::StatusOr<InterpValue> InterpretExpr(
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*args=*/{});
 }
 
+// Returns the body of a `ToNative` overload which converts a whole buffer by
+// zeroing it and then writing the leaves with `call`.
+std::string ToNativeEntryBody(std::string_view call) {
+  std::vector<std::string> pieces;
+  pieces.push_back("std::memset(buffer, 0, layout.size());");
+  pieces.push_back("int64_t leaf_index = 0;");
+  pieces.push_back(absl::StrFormat("XLS_RETURN_IF_ERROR(%s);", call));
+  pieces.push_back("return CheckNativeLeafCount(layout, leaf_index);");
+  return absl::StrJoin(pieces, "\n");
+}
+
+// Returns the body of a `FromNative` overload which converts a whole buffer by
+// reading the leaves with `call`.
+std::string FromNativeEntryBody(std::string_view cpp_type,
+                                std::string_view call) {
+  std::vector<std::string> pieces;
+  pieces.push_back("int64_t leaf_index = 0;");
+  pieces.push_back(
+      absl::StrFormat("XLS_ASSIGN_OR_RETURN(%s result, %s);", cpp_type, call));
+  pieces.push_back(
+      "XLS_RETURN_IF_ERROR(CheckNativeLeafCount(layout, leaf_index));");
+  pieces.push_back("return result;");
+  return absl::StrJoin(pieces, "\n");
+}
+
+// Returns the `<type>ToNative` and `<type>FromNative` functions of a type
+// which is not represented as a C++ struct. `to_native_body` and
+// `from_native_body` convert the leaves starting at `*leaf_index`; the
+// overloads without a `leaf_index` convert a whole buffer.
+CppSource MakeNativeLayoutFunctions(std::string_view cpp_type,
+                                    std::string_view value_parameter,
+                                    std::string_view to_native_body,
+                                    std::string_view from_native_body) {
+  std::string to_native = absl::StrFormat(
+      "absl::Status %sToNative(%s, const ::xls::TypeLayout& layout, "
+      "uint8_t* buffer",
+      cpp_type, value_parameter);
+  std::string from_native = absl::StrFormat(
+      "absl::StatusOr<%s> %sFromNative(const ::xls::TypeLayout& layout, "
+      "const uint8_t* buffer",
+      cpp_type, cpp_type);
+  std::string header = absl::StrFormat(
+      "%s);\n%s, int64_t* leaf_index);\n%s);\n%s, int64_t* leaf_index);",
+      to_native, to_native, from_native, from_native);
+  std::vector<std::string> source;
+  source.push_back(absl::StrFormat(
+      "%s) {\n%s\n}", to_native,
+      Indent(ToNativeEntryBody(absl::StrFormat(
+                 "%sToNative(value, layout, buffer, &leaf_index)", cpp_type)),
+             2)));
+  source.push_back(absl::StrFormat("%s, int64_t* leaf_index) {\n%s\n}",
+                                   to_native, Indent(to_native_body, 2)));
+  source.push_back(absl::StrFormat(
+      "%s) {\n%s\n}", from_native,
+      Indent(FromNativeEntryBody(
+                 cpp_type, absl::StrFormat(
+                               "%sFromNative(layout, buffer, &leaf_index)",
+                               cpp_type)),
+             2)));
+  source.push_back(absl::StrFormat("%s, int64_t* leaf_index) {\n%s\n}",
+                                   from_native, Indent(from_native_body, 2)));
+  return CppSource{.header = header, .source = absl::StrJoin(source, "\n\n")};
+}
+
 // A type generator for emitting a C++ enum representing a dslx::EnumDef.
 class EnumCppTypeGenerator : public CppTypeGenerator {
  public:
@@ -96,15 +160,20 @@ class EnumCppTypeGenerator : public CppTypeGenerator {
     CppSource from_value = FromValueFunction();
     CppSource verify = VerifyFunction();
 
-    return CppSource{.header = absl::StrJoin(
-                         {enum_decl, num_elements_def, width_def,
-                          to_string.header, to_dslx_string.header,
-                          to_value.header, from_value.header, verify.header},
-                         "\n"),
-                     .source = absl::StrJoin(
-                         {to_string.source, to_dslx_string.source,
-                          to_value.source, from_value.source, verify.source},
-                         "\n\n")};
+    std::vector<std::string> header = {
+        enum_decl,         num_elements_def,      width_def,
+        to_string.header,  to_dslx_string.header, to_value.header,
+        from_value.header, verify.header};
+    std::vector<std::string> source = {to_string.source, to_dslx_string.source,
+                                       to_value.source, from_value.source,
+                                       verify.source};
+    if (generate_native_layout()) {
+      CppSource native = NativeLayoutFunctions();
+      header.push_back(native.header);
+      source.push_back(native.source);
+    }
+    return CppSource{.header = absl::StrJoin(header, "\n"),
+                     .source = absl::StrJoin(source, "\n\n")};
   }
 
   int64_t dslx_bit_count() const {
@@ -255,6 +324,30 @@ class EnumCppTypeGenerator : public CppTypeGenerator {
         .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
   }
 
+  CppSource NativeLayoutFunctions() const {
+    std::vector<std::string> to_native;
+    to_native.push_back(
+        absl::StrFormat("XLS_RETURN_IF_ERROR(Verify%s(value));", cpp_type()));
+    to_native.push_back(emitter_->AssignToNative(
+        "buffer", "layout", "leaf_index", CastToCppBaseType("value"),
+        /*nesting=*/0));
+    to_native.push_back("return absl::OkStatus();");
+
+    std::vector<std::string> from_native;
+    from_native.push_back(
+        absl::StrFormat("%s result_base;", emitter_->cpp_type()));
+    from_native.push_back(emitter_->AssignFromNative(
+        "result_base", "buffer", "layout", "leaf_index", /*nesting=*/0));
+    from_native.push_back(absl::StrFormat(
+        "%s result = static_cast<%s>(result_base);", cpp_type(), cpp_type()));
+    from_native.push_back(
+        absl::StrFormat("XLS_RETURN_IF_ERROR(Verify%s(result));", cpp_type()));
+    from_native.push_back("return result;");
+    return MakeNativeLayoutFunctions(
+        cpp_type(), absl::StrFormat("%s value", cpp_type()),
+        absl::StrJoin(to_native, "\n"), absl::StrJoin(from_native, "\n"));
+  }
+
   std::vector<EnumValue> enum_values_;
   std::unique_ptr<CppEmitter> emitter_;
 };
@@ -301,12 +394,16 @@ class TypeAliasCppTypeGenerator : public CppTypeGenerator {
     hdr_pieces.push_back(to_dslx_string_src.header);
     hdr_pieces.push_back(to_value_src.header);
     hdr_pieces.push_back(from_value_src.header);
-    return CppSource{
-        .header = absl::StrJoin(hdr_pieces, "\n"),
-        .source = absl::StrJoin(
-            {verify_src.source, to_string_src.source, to_dslx_string_src.source,
-             to_value_src.source, from_value_src.source},
-            "\n\n")};
+    std::vector<std::string> src_pieces = {
+        verify_src.source, to_string_src.source, to_dslx_string_src.source,
+        to_value_src.source, from_value_src.source};
+    if (generate_native_layout()) {
+      CppSource native_src = NativeLayoutFunctions();
+      hdr_pieces.push_back(native_src.header);
+      src_pieces.push_back(native_src.source);
+    }
+    return CppSource{.header = absl::StrJoin(hdr_pieces, "\n"),
+                     .source = absl::StrJoin(src_pieces, "\n\n")};
   }
 
  protected:
@@ -406,6 +503,20 @@ class TypeAliasCppTypeGenerator : public CppTypeGenerator {
         .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
   }
 
+  CppSource NativeLayoutFunctions() const {
+    std::string to_native = absl::StrCat(
+        emitter_->AssignToNative("buffer", "layout", "leaf_index", "value",
+                                 /*nesting=*/0),
+        "\nreturn absl::OkStatus();");
+    std::string from_native = absl::StrCat(
+        absl::StrFormat("%s result;\n", cpp_type()),
+        emitter_->AssignFromNative("result", "buffer", "layout", "leaf_index",
+                                   /*nesting=*/0),
+        "\nreturn result;");
+    return MakeNativeLayoutFunctions(
+        cpp_type(), GetValueParameter("value"), to_native, from_native);
+  }
+
   std::unique_ptr<CppEmitter> emitter_;
 };
 
@@ -487,18 +598,23 @@ class StructCppTypeGenerator : public CppTypeGenerator {
         "bool operator!=(const %s& other) const { return !(*this == other); }",
         cpp_type()));
     hdr_pieces.push_back(operator_stream_method.header);
+    std::vector<std::string> src_pieces = {
+        from_value_method.source,     to_value_method.source,
+        to_string_method.source,      to_dslx_string_method.source,
+        verify_method.source,         operator_eq_method.source,
+        operator_stream_method.source};
+    if (generate_native_layout()) {
+      CppSource native_methods = NativeLayoutMethods();
+      hdr_pieces.push_back(native_methods.header);
+      src_pieces.push_back(native_methods.source);
+    }
 
     std::string members = absl::StrJoin(hdr_pieces, "\n");
 
     std::string header =
         absl::StrFormat("struct %s {\n%s\n};", cpp_type(), Indent(members, 2));
-    std::string source =
-        absl::StrJoin({from_value_method.source, to_value_method.source,
-                       to_string_method.source, to_dslx_string_method.source,
-                       verify_method.source, operator_eq_method.source,
-                       operator_stream_method.source},
-                      "\n\n");
-    return CppSource{.header = header, .source = source};
+    return CppSource{.header = header,
+                     .source = absl::StrJoin(src_pieces, "\n\n")};
   }
 
  protected:
@@ -654,6 +770,58 @@ class StructCppTypeGenerator : public CppTypeGenerator {
     };
   }
 
+  CppSource NativeLayoutMethods() const {
+    constexpr std::string_view kToNative =
+        "ToNative(const ::xls::TypeLayout& layout, uint8_t* buffer";
+    constexpr std::string_view kFromNative =
+        "FromNative(const ::xls::TypeLayout& layout, const uint8_t* buffer";
+
+    std::vector<std::string> to_native;
+    std::vector<std::string> from_native;
+    from_native.push_back(absl::StrFormat("%s result;", cpp_type()));
+    for (int i = 0; i < struct_def_->members().size(); i++) {
+      to_native.push_back(member_emitters_[i]->AssignToNative(
+          "buffer", "layout", "leaf_index", cpp_member_names_[i],
+          /*nesting=*/0));
+      from_native.push_back(member_emitters_[i]->AssignFromNative(
+          absl::StrFormat("result.%s", cpp_member_names_[i]), "buffer",
+          "layout", "leaf_index", /*nesting=*/0));
+    }
+    to_native.push_back("return absl::OkStatus();");
+    from_native.push_back("return result;");
+
+    std::vector<std::string> header;
+    header.push_back(absl::StrFormat("absl::Status %s) const;", kToNative));
+    header.push_back(absl::StrFormat(
+        "absl::Status %s, int64_t* leaf_index) const;", kToNative));
+    header.push_back(absl::StrFormat("static absl::StatusOr<%s> %s);",
+                                     cpp_type(), kFromNative));
+    header.push_back(
+        absl::StrFormat("static absl::StatusOr<%s> %s, int64_t* leaf_index);",
+                        cpp_type(), kFromNative));
+
+    std::vector<std::string> source;
+    source.push_back(absl::StrFormat(
+        "absl::Status %s::%s) const {\n%s\n}", cpp_type(), kToNative,
+        Indent(ToNativeEntryBody("ToNative(layout, buffer, &leaf_index)"),
+               2)));
+    source.push_back(absl::StrFormat(
+        "absl::Status %s::%s, int64_t* leaf_index) const {\n%s\n}",
+        cpp_type(), kToNative, Indent(absl::StrJoin(to_native, "\n"), 2)));
+    source.push_back(absl::StrFormat(
+        "absl::StatusOr<%s> %s::%s) {\n%s\n}", cpp_type(), cpp_type(),
+        kFromNative,
+        Indent(FromNativeEntryBody(cpp_type(),
+                                   "FromNative(layout, buffer, &leaf_index)"),
+               2)));
+    source.push_back(absl::StrFormat(
+        "absl::StatusOr<%s> %s::%s, int64_t* leaf_index) {\n%s\n}",
+        cpp_type(), cpp_type(), kFromNative,
+        Indent(absl::StrJoin(from_native, "\n"), 2)));
+    return CppSource{.header = absl::StrJoin(header, "\n"),
+                     .source = absl::StrJoin(source, "\n\n")};
+  }
+
   const StructDef* struct_def_;
   std::vector<std::unique_ptr<CppEmitter>> member_emitters_;
   std::vector<std::string> cpp_member_names_;
@@ -663,7 +831,17 @@ class StructCppTypeGenerator : public CppTypeGenerator {
 
 /* static */ absl::StatusOr<std::unique_ptr<CppTypeGenerator>>
 CppTypeGenerator::Create(const TypeDefinition& type_definition,
-                         TypeInfo* type_info, ImportData* import_data) {
+                         TypeInfo* type_info, ImportData* import_data,
+                         bool generate_native_layout) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CppTypeGenerator> generator,
+                       CreateInternal(type_definition, type_info, import_data));
+  generator->generate_native_layout_ = generate_native_layout;
+  return generator;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<CppTypeGenerator>>
+CppTypeGenerator::CreateInternal(const TypeDefinition& type_definition,
+                                 TypeInfo* type_info, ImportData* import_data) {
   return absl::visit(
       Visitor{[&](const TypeAlias* type_alias)
                   -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
@@ -52,14 +52,25 @@ class CppTypeGenerator {
   // not a tuple or array).
   std::string dslx_type() const { return dslx_type_; }
 
+  // Returns whether the generated code converts to and from the native layout
+  // used by the JIT (`ToNative`/`FromNative`) in addition to `xls::Value`.
+  bool generate_native_layout() const { return generate_native_layout_; }
+
   // Returns a type generator for the given TypeDefinition.
   static absl::StatusOr<std::unique_ptr<CppTypeGenerator>> Create(
       const TypeDefinition& type_definition, TypeInfo* type_info,
-      ImportData* import_data);
+      ImportData* import_data, bool generate_native_layout = false);
 
  protected:
   std::string cpp_type_;
   std::string dslx_type_;
+
+ private:
+  static absl::StatusOr<std::unique_ptr<CppTypeGenerator>> CreateInternal(
+      const TypeDefinition& type_definition, TypeInfo* type_info,
+      ImportData* import_data);
+
+  bool generate_native_layout_ = false;
 };
 
 }  // namespace xls::dslx
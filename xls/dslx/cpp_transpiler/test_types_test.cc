@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
@@ -19,7 +22,10 @@
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/cpp_transpiler/test_types_lib.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
@@ -222,6 +228,44 @@ TEST(TestTypesTest, SimpleStructFromValue) {
                        HasSubstr("Value is not a tuple of 2 elements")));
 }
 
+TEST(TestTypesTest, SimpleStructNativeLayout) {
+  Package package("test");
+  Type* type =
+      package.GetTupleType({package.GetBitsType(17), package.GetBitsType(7)});
+  TypeLayout layout(type, /*size=*/8,
+                    {ElementLayout{.offset = 0, .data_size = 3,
+                                   .padded_size = 4},
+                     ElementLayout{.offset = 4, .data_size = 1,
+                                   .padded_size = 4}});
+  test::InnerStruct s{.x = 0x1abcd, .y = test::MyEnum::kC};
+  std::vector<uint8_t> buffer(layout.size(), 0xff);
+  XLS_ASSERT_OK(s.ToNative(layout, buffer.data()));
+  XLS_ASSERT_OK_AND_ASSIGN(Value value, s.ToValue());
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+  EXPECT_THAT(test::InnerStruct::FromNative(layout, buffer.data()),
+              IsOkAndHolds(s));
+
+  // The layout of a single bits leaf does not match the struct.
+  TypeLayout bits_layout(
+      package.GetBitsType(17), /*size=*/4,
+      {ElementLayout{.offset = 0, .data_size = 3, .padded_size = 4}});
+  EXPECT_THAT(s.ToNative(bits_layout, buffer.data()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("too few leaf elements")));
+}
+
+TEST(TestTypesTest, SignedTypeNativeLayout) {
+  Package package("test");
+  TypeLayout layout(
+      package.GetBitsType(20), /*size=*/4,
+      {ElementLayout{.offset = 0, .data_size = 3, .padded_size = 4}});
+  std::vector<uint8_t> buffer(layout.size());
+  XLS_ASSERT_OK(test::MySignedTypeToNative(-5, layout, buffer.data()));
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), Value(SBits(-5, 20)));
+  EXPECT_THAT(test::MySignedTypeFromNative(layout, buffer.data()),
+              IsOkAndHolds(-5));
+}
+
 TEST(TestTypesTest, TupleToString) {
   test::MyTuple s{42, -3, 123, -1};
   EXPECT_EQ(test::MyTupleToString(s), R"((
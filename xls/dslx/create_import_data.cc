@@ -38,6 +38,17 @@ ImportData CreateImportData(
   return import_data;
 }
 
+std::unique_ptr<ImportData> CreateImportDataPtr(
+    const std::filesystem::path& stdlib_path,
+    absl::Span<const std::filesystem::path> additional_search_paths,
+    WarningKindSet warnings, std::unique_ptr<VirtualizableFilesystem> vfs) {
+  auto import_data = absl::WrapUnique(new ImportData(
+      stdlib_path, additional_search_paths, warnings, std::move(vfs)));
+  import_data->SetBytecodeCache(
+      std::make_unique<BytecodeCache>(import_data.get()));
+  return import_data;
+}
+
 ImportData CreateImportDataForTest() {
   ImportData import_data(xls::kDefaultDslxStdlibPath,
                          /*additional_search_paths=*/{}, kDefaultWarningsSet,
@@ -34,6 +34,13 @@ ImportData CreateImportData(
     absl::Span<const std::filesystem::path> additional_search_paths,
     WarningKindSet warnings, std::unique_ptr<VirtualizableFilesystem> vfs);
 
+// As CreateImportData, but the result is heap-allocated so that it can be
+// moved around without invalidating the modules that refer to its file table.
+std::unique_ptr<ImportData> CreateImportDataPtr(
+    const std::filesystem::path& stdlib_path,
+    absl::Span<const std::filesystem::path> additional_search_paths,
+    WarningKindSet warnings, std::unique_ptr<VirtualizableFilesystem> vfs);
+
 // Creates an ImportData with reasonable defaults (standard path to the stdlib
 // and no additional search paths).
 ImportData CreateImportDataForTest();
@@ -15,6 +15,7 @@
 #include "xls/dslx/frontend/scanner.h"
 
 #include <cctype>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -50,7 +51,7 @@ absl::Status ScanErrorStatus(const Span& span, std::string_view message,
 
 char Scanner::PopChar() {
   CHECK(!AtEof()) << "Cannot pop character when at EOF.";
-  char c = PeekChar();
+  char c = text_[index_];
   index_ += 1;
   if (c == '\n') {
     lineno_ += 1;
@@ -61,6 +62,18 @@ char Scanner::PopChar() {
   return c;
 }
 
+void Scanner::AdvanceTo(int64_t index) {
+  CHECK_LE(index, text_.size());
+  for (; index_ < index; ++index_) {
+    if (text_[index_] == '\n') {
+      lineno_ += 1;
+      colno_ = 0;
+    } else {
+      colno_ += 1;
+    }
+  }
+}
+
 void Scanner::DropChar(int64_t count) {
   for (int64_t i = 0; i < count; ++i) {
     (void)PopChar();
@@ -79,23 +92,27 @@ Token Scanner::PopComment(const Pos& start_pos, bool allow_multiline) {
   std::string chars;
   Pos end_pos = GetPos();
   while (!AtCharEof()) {
-    char c = PopChar();
-    chars.append(1, c);
+    // Take the rest of the line, including its newline, in one go.
+    size_t newline = text_.find('\n', index_);
+    int64_t end = newline == std::string::npos ? text_.size() : newline + 1;
+    chars.append(text_, index_, end - index_);
+    AdvanceTo(end);
     end_pos = GetPos();
-    if (c == '\n') {
-      // If we've collected a comment, conditionally look for a continuation of
-      // it on the next line at the same colno.
-      if (allow_multiline && !AtCharEof() && PeekChar() != '\n' &&
-          chars.size() > 1) {
-        DropLeadingWhitespace();
-        if (!AtCharEof() && PeekChar() == '/' && PeekChar2OrNull() == '/' &&
-            GetPos().colno() == start_pos.colno()) {
-          DropChar(2);
-          continue;
-        }
-      }
+    if (newline == std::string::npos) {
       break;
     }
+    // If we've collected a comment, conditionally look for a continuation of
+    // it on the next line at the same colno.
+    if (allow_multiline && !AtCharEof() && PeekChar() != '\n' &&
+        chars.size() > 1) {
+      DropLeadingWhitespace();
+      if (!AtCharEof() && PeekChar() == '/' && PeekChar2OrNull() == '/' &&
+          GetPos().colno() == start_pos.colno()) {
+        DropChar(2);
+        continue;
+      }
+    }
+    break;
   }
   return Token(TokenKind::kComment, Span(start_pos, end_pos), chars);
 }
@@ -307,12 +324,18 @@ absl::StatusOr<Token> Scanner::ScanIdentifierOrKeyword(char startc,
     return std::isalpha(c) != 0 || std::isdigit(c) != 0 || c == '_' ||
            c == '!' || c == '\'';
   };
-  std::string s = ScanWhile(startc, is_trailing_identifier_char);
+  // `startc` was already popped, so the identifier starts one character back
+  // in the buffer; only identifiers (not keywords) need their text copied out.
+  const int64_t start = index_ - 1;
+  DCHECK_EQ(text_[start], startc);
+  const int64_t end = FindRunEnd(is_trailing_identifier_char);
+  std::string_view s = std::string_view(text_).substr(start, end - start);
+  AdvanceTo(end);
   Span span(start_pos, GetPos());
   if (std::optional<Keyword> keyword = GetKeyword(s)) {
     return Token(span, *keyword);
   }
-  return Token(TokenKind::kIdentifier, span, std::move(s));
+  return Token(TokenKind::kIdentifier, span, std::string(s));
 }
 
 std::optional<CommentData> Scanner::TryPopComment(bool allow_multiline) {
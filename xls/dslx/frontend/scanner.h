@@ -16,7 +16,6 @@
 #define XLS_DSLX_FRONTEND_SCANNER_H_
 
 #include <cstdint>
-#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -146,19 +145,28 @@ class Scanner {
   // Precondition: The character stream must be positioned at an open quote.
   absl::StatusOr<Token> ScanChar(const Pos& start_pos);
 
-  // Scans from the current position until ftake returns false or EOF is
-  // reached.
-  std::string ScanWhile(std::string s, const std::function<bool(char)>& ftake) {
-    while (!AtCharEof()) {
-      char peek = PeekChar();
-      if (!ftake(peek)) {
-        break;
-      }
-      s.append(1, PopChar());
+  // Returns the index one past the run of characters starting at the cursor
+  // for which ftake returns true.
+  template <typename F>
+  int64_t FindRunEnd(F ftake) const {
+    int64_t end = index_;
+    while (end < text_.size() && ftake(text_[end])) {
+      ++end;
     }
+    return end;
+  }
+
+  // Scans from the current position until ftake returns false or EOF is
+  // reached, appending the run to `s` in one go.
+  template <typename F>
+  std::string ScanWhile(std::string s, F ftake) {
+    int64_t end = FindRunEnd(ftake);
+    s.append(text_, index_, end - index_);
+    AdvanceTo(end);
     return s;
   }
-  std::string ScanWhile(char c, const std::function<bool(char)>& ftake) {
+  template <typename F>
+  std::string ScanWhile(char c, F ftake) {
     return ScanWhile(std::string(1, c), ftake);
   }
 
@@ -216,6 +224,10 @@ class Scanner {
   // routine will check-fail).
   ABSL_MUST_USE_RESULT char PopChar();
 
+  // Moves the cursor forward to `index`, updating the line and column numbers
+  // for the characters skipped over.
+  void AdvanceTo(int64_t index);
+
   // Drops "count" characters from the head of the character stream.
   //
   // Note: As with PopChar() if the character stream is extinguished when a
@@ -84,6 +84,20 @@ TEST(ScannerTest, IdentifierWithTick) {
   EXPECT_TRUE(tokens[3].IsIdentifier("s'"));
 }
 
+TEST(ScannerTest, IdentifierAndKeywordSpans) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Token> tokens,
+                           ToTokens("fn foo_bar'\n  let x1"));
+  ASSERT_EQ(4, tokens.size());
+  EXPECT_TRUE(tokens[0].IsKeyword(Keyword::kFn));
+  EXPECT_TRUE(tokens[1].IsIdentifier("foo_bar'"));
+  EXPECT_TRUE(tokens[2].IsKeyword(Keyword::kLet));
+  EXPECT_TRUE(tokens[3].IsIdentifier("x1"));
+  EXPECT_EQ(tokens[1].span(),
+            Span(Pos(Fileno(0), 0, 3), Pos(Fileno(0), 0, 11)));
+  EXPECT_EQ(tokens[3].span(),
+            Span(Pos(Fileno(0), 1, 6), Pos(Fileno(0), 1, 8)));
+}
+
 TEST(ScannerTest, TickCannotStartAnIdentifier) {
   const char* kText = "'state";
   EXPECT_THAT(
@@ -17,6 +17,7 @@
 #include <cstddef>
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -73,6 +74,69 @@ absl::StatusOr<ModuleInfo*> ImportData::Put(
   return pmodule_info;
 }
 
+std::optional<PrefetchedModule> ImportData::TakePrefetchedModule(
+    const ImportTokens& subject) {
+  auto it = prefetched_modules_.find(subject);
+  if (it == prefetched_modules_.end()) {
+    return std::nullopt;
+  }
+  PrefetchedModule prefetched = std::move(it->second);
+  prefetched_modules_.erase(it);
+  return prefetched;
+}
+
+void ImportData::EvictModules(
+    absl::FunctionRef<bool(const std::filesystem::path&)> predicate) {
+  for (auto it = modules_.begin(); it != modules_.end();) {
+    ModuleInfo* module_info = it->second.get();
+    if (!predicate(module_info->path())) {
+      ++it;
+      continue;
+    }
+    VLOG(3) << "Evicting module " << it->first.ToString() << " @ "
+            << module_info->path();
+    Module* module = &module_info->module();
+    path_to_module_info_.erase(std::string{module_info->path()});
+    top_level_bindings_.erase(module);
+    top_level_bindings_done_.erase(module);
+    typecheck_wip_.erase(module);
+    if (module_info->cache_key().has_value()) {
+      if (auto evicted = evicted_modules_.find(it->first);
+          evicted != evicted_modules_.end()) {
+        DropModule(std::move(evicted->second));
+        evicted_modules_.erase(evicted);
+      }
+      evicted_modules_.emplace(it->first, std::move(it->second));
+    } else {
+      type_info_owner_.Release(module);
+    }
+    modules_.erase(it++);
+  }
+  for (auto it = prefetched_modules_.begin();
+       it != prefetched_modules_.end();) {
+    if (predicate(it->second.source_path)) {
+      prefetched_modules_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::unique_ptr<ModuleInfo> ImportData::TakeEvictedModule(
+    const ImportTokens& subject) {
+  auto it = evicted_modules_.find(subject);
+  if (it == evicted_modules_.end()) {
+    return nullptr;
+  }
+  std::unique_ptr<ModuleInfo> module_info = std::move(it->second);
+  evicted_modules_.erase(it);
+  return module_info;
+}
+
+void ImportData::DropModule(std::unique_ptr<ModuleInfo> module_info) {
+  type_info_owner_.Release(&module_info->module());
+}
+
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfoForNode(
     const AstNode* node) {
   XLS_RET_CHECK(node != nullptr);
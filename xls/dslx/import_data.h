@@ -19,6 +19,7 @@
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -26,6 +27,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
@@ -57,10 +59,33 @@ class ModuleInfo {
   TypeInfo* type_info() { return type_info_; }
   const std::filesystem::path& path() const { return path_; }
 
+  // Key under which the module can be reused after being evicted: a hash of
+  // its source text combined with the cache keys of the modules it imports,
+  // so that it also changes when any transitive import changes. Not set for
+  // modules which were not imported from a file, e.g. the entry module.
+  std::optional<uint64_t> cache_key() const { return cache_key_; }
+  void set_cache_key(uint64_t cache_key) { cache_key_ = cache_key; }
+
+  // Hash of the source text the module was parsed from, if known.
+  std::optional<uint64_t> content_hash() const { return content_hash_; }
+  void set_content_hash(uint64_t content_hash) {
+    content_hash_ = content_hash;
+  }
+
  private:
   std::unique_ptr<Module> module_;
   TypeInfo* type_info_;
   std::filesystem::path path_;
+  std::optional<uint64_t> cache_key_;
+  std::optional<uint64_t> content_hash_;
+};
+
+// A module read and parsed ahead of its import; see PrefetchImports.
+struct PrefetchedModule {
+  std::unique_ptr<Module> module;
+  std::filesystem::path source_path;
+  // Hash of the source text `module` was parsed from.
+  uint64_t content_hash;
 };
 
 // Immutable "tuple" of tokens that name an absolute import location.
@@ -145,6 +170,51 @@ class ImportData {
   absl::StatusOr<ModuleInfo*> Put(const ImportTokens& subject,
                                   std::unique_ptr<ModuleInfo> module_info);
 
+  // Notes a module parsed ahead of its import, which DoImport then typechecks
+  // instead of reading and parsing the module itself.
+  void AddPrefetchedModule(const ImportTokens& subject,
+                           PrefetchedModule prefetched) {
+    prefetched_modules_.emplace(subject, std::move(prefetched));
+  }
+  bool IsPrefetched(const ImportTokens& subject) const {
+    return prefetched_modules_.contains(subject);
+  }
+
+  // Removes and returns the prefetched module for `subject`, if any.
+  std::optional<PrefetchedModule> TakePrefetchedModule(
+      const ImportTokens& subject);
+
+  // Removes the cached modules whose path satisfies `predicate`, e.g. because
+  // their source may have changed. Modules importing an evicted module must be
+  // evicted as well, since their type information refers to it.
+  //
+  // Evicted modules with a cache key are kept, along with their type
+  // information, until they are imported again: DoImport reuses such a module
+  // instead of parsing and typechecking it when its source text and the cache
+  // keys of its imports are unchanged. Other evicted modules are dropped.
+  void EvictModules(
+      absl::FunctionRef<bool(const std::filesystem::path&)> predicate);
+
+  // Returns whether an evicted module is kept for `subject`.
+  bool HasEvictedModule(const ImportTokens& subject) const {
+    return evicted_modules_.contains(subject);
+  }
+
+  // Removes and returns the evicted module kept for `subject`, if any. The
+  // caller must either Put() it back or drop it with DropModule().
+  std::unique_ptr<ModuleInfo> TakeEvictedModule(const ImportTokens& subject);
+
+  // Destroys a module which is not registered with this object, along with its
+  // type information.
+  void DropModule(std::unique_ptr<ModuleInfo> module_info);
+
+  // Counts of imports which reused an evicted module, and which had to parse
+  // and typecheck a module from its source.
+  int64_t module_cache_hits() const { return module_cache_hits_; }
+  int64_t module_cache_misses() const { return module_cache_misses_; }
+  void NoteModuleCacheHit() { ++module_cache_hits_; }
+  void NoteModuleCacheMiss() { ++module_cache_misses_; }
+
   TypeInfoOwner& type_info_owner() { return type_info_owner_; }
 
   // Helper that gets the "root" type information for the module of the given
@@ -228,7 +298,7 @@ class ImportData {
 
   friend std::unique_ptr<ImportData> CreateImportDataPtr(
       const std::filesystem::path&, absl::Span<const std::filesystem::path>,
-      WarningKindSet);
+      WarningKindSet, std::unique_ptr<VirtualizableFilesystem>);
 
   friend ImportData CreateImportDataForTest();
   friend std::unique_ptr<ImportData> CreateImportDataPtrForTest();
@@ -250,6 +320,11 @@ class ImportData {
 
   FileTable file_table_;
   absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>> modules_;
+  absl::flat_hash_map<ImportTokens, PrefetchedModule> prefetched_modules_;
+  absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>>
+      evicted_modules_;
+  int64_t module_cache_hits_ = 0;
+  int64_t module_cache_misses_ = 0;
   absl::flat_hash_map<std::string, ModuleInfo*> path_to_module_info_;
   absl::flat_hash_map<Module*, std::unique_ptr<InterpBindings>>
       top_level_bindings_;
@@ -14,15 +14,21 @@
 
 #include "xls/dslx/import_routines.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>  // NOLINT
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -35,6 +41,7 @@
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/pos.h"
@@ -171,6 +178,178 @@ static absl::StatusOr<DslxPath> FindExistingPath(
       vfs.GetCurrentDirectory().value(), stdlib_path));
 }
 
+static absl::StatusOr<std::unique_ptr<Module>> ParseImportedModule(
+    std::string module_name, Fileno fileno, std::string contents,
+    FileTable& file_table) {
+  Scanner scanner(file_table, fileno, std::move(contents));
+  Parser parser(std::move(module_name), &scanner);
+  return parser.ParseModule();
+}
+
+// Runs `f` for each index in [0, count) on up to `max_threads` threads, or on
+// as many threads as there are available CPUs if `max_threads` is zero.
+static void ParallelFor(int64_t count, int64_t max_threads,
+                        const std::function<void(int64_t)>& f) {
+  int64_t thread_count = std::clamp<int64_t>(
+      max_threads > 0 ? max_threads : AvailableCPUs(), 1,
+      std::max<int64_t>(count, 1));
+  if (thread_count == 1) {
+    for (int64_t i = 0; i < count; ++i) {
+      f(i);
+    }
+    return;
+  }
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < count;
+         i = next_index.fetch_add(1)) {
+      f(i);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (auto& thread : threads) {
+    thread->Join();
+  }
+}
+
+void PrefetchImports(const Module& module, ImportData* import_data,
+                     int64_t max_threads) {
+  FileTable& file_table = import_data->file_table();
+  VirtualizableFilesystem& vfs = import_data->vfs();
+
+  // The file table is shared by the parsing threads. Parsing only reads it as
+  // long as every file, and the pseudo-file of builtin names, is registered
+  // before the threads start.
+  file_table.GetOrCreate("<builtin>");
+
+  struct PendingImport {
+    ImportTokens subject;
+    Span import_span;
+    absl::StatusOr<DslxPath> path = absl::UnknownError("Not resolved");
+    absl::StatusOr<std::string> contents = absl::UnknownError("Not read");
+    uint64_t content_hash = 0;
+    Fileno fileno;
+    absl::StatusOr<std::unique_ptr<Module>> module =
+        absl::UnknownError("Not parsed");
+  };
+
+  // Walk the import DAG breadth-first, resolving, reading and parsing each
+  // level concurrently.
+  absl::flat_hash_set<ImportTokens> seen;
+  std::vector<const Module*> parsed = {&module};
+  while (!parsed.empty()) {
+    std::vector<PendingImport> pending;
+    for (const Module* importer : parsed) {
+      for (const ModuleMember& member : importer->top()) {
+        if (!std::holds_alternative<Import*>(member)) {
+          continue;
+        }
+        const Import* import = std::get<Import*>(member);
+        ImportTokens subject(import->subject());
+        // Evicted modules are left to DoImport, which only has to parse them
+        // if they cannot be reused.
+        if (import_data->Contains(subject) ||
+            import_data->IsPrefetched(subject) ||
+            import_data->HasEvictedModule(subject) ||
+            !seen.insert(subject).second) {
+          continue;
+        }
+        pending.push_back(
+            PendingImport{.subject = subject, .import_span = import->span()});
+      }
+    }
+    parsed.clear();
+
+    ParallelFor(pending.size(), max_threads, [&](int64_t i) {
+      PendingImport& p = pending[i];
+      p.path = FindExistingPath(p.subject, import_data->stdlib_path(),
+                                import_data->additional_search_paths(),
+                                p.import_span, file_table, vfs);
+      if (p.path.ok()) {
+        p.contents = vfs.GetFileContents(p.path->filesystem_path);
+      }
+    });
+    for (PendingImport& p : pending) {
+      if (p.contents.ok()) {
+        p.fileno = file_table.GetOrCreate(p.path->source_path.c_str());
+      }
+    }
+    ParallelFor(pending.size(), max_threads, [&](int64_t i) {
+      PendingImport& p = pending[i];
+      if (p.contents.ok()) {
+        p.content_hash = absl::HashOf(*p.contents);
+        p.module = ParseImportedModule(p.subject.ToString(), p.fileno,
+                                       std::move(*p.contents), file_table);
+      }
+    });
+
+    // Modules which cannot be found or parsed are left to DoImport, which
+    // reports the error in the context of the import.
+    for (PendingImport& p : pending) {
+      absl::Status status = p.contents.ok() ? p.module.status()
+                                            : p.contents.status();
+      if (!status.ok()) {
+        VLOG(3) << "Not prefetching " << p.subject.ToString() << ": "
+                << status;
+        continue;
+      }
+      parsed.push_back(p.module->get());
+      import_data->AddPrefetchedModule(
+          p.subject, PrefetchedModule{.module = std::move(*p.module),
+                                      .source_path = p.path->source_path,
+                                      .content_hash = p.content_hash});
+    }
+  }
+}
+
+// Returns the cache key of `module`, parsed from text hashing to
+// `content_hash`, given that everything it imports is in `import_data`.
+static absl::StatusOr<uint64_t> GetModuleCacheKey(const Module& module,
+                                                  uint64_t content_hash,
+                                                  ImportData* import_data) {
+  std::vector<uint64_t> import_keys;
+  for (const ModuleMember& member : module.top()) {
+    if (!std::holds_alternative<Import*>(member)) {
+      continue;
+    }
+    const Import* import = std::get<Import*>(member);
+    XLS_ASSIGN_OR_RETURN(ModuleInfo * imported,
+                         import_data->Get(ImportTokens(import->subject())));
+    XLS_RET_CHECK(imported->cache_key().has_value());
+    import_keys.push_back(*imported->cache_key());
+  }
+  return absl::HashOf(content_hash, import_keys);
+}
+
+// Returns whether the evicted `module_info` can be reused for a module whose
+// source text now hashes to `content_hash`. Imports the modules it imports, so
+// that their cache keys can be checked as well.
+static absl::StatusOr<bool> CanReuseEvictedModule(
+    const ModuleInfo& module_info, uint64_t content_hash,
+    const TypecheckModuleFn& ftypecheck, ImportData* import_data,
+    VirtualizableFilesystem& vfs) {
+  if (module_info.content_hash() != content_hash) {
+    return false;
+  }
+  for (const ModuleMember& member : module_info.module().top()) {
+    if (!std::holds_alternative<Import*>(member)) {
+      continue;
+    }
+    const Import* import = std::get<Import*>(member);
+    XLS_RETURN_IF_ERROR(DoImport(ftypecheck, ImportTokens(import->subject()),
+                                 import_data, import->span(), vfs)
+                            .status());
+  }
+  XLS_ASSIGN_OR_RETURN(
+      uint64_t cache_key,
+      GetModuleCacheKey(module_info.module(), content_hash, import_data));
+  return module_info.cache_key() == cache_key;
+}
+
 absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const ImportTokens& subject,
                                      ImportData* import_data,
@@ -185,12 +364,19 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
   VLOG(3) << "DoImport (uncached) subject: " << subject.ToString();
 
   FileTable& file_table = import_data->file_table();
-  XLS_ASSIGN_OR_RETURN(DslxPath dslx_path,
-                       FindExistingPath(subject, import_data->stdlib_path(),
-                                        import_data->additional_search_paths(),
-                                        import_span, file_table, vfs));
-
-  VLOG(3) << "Found DSLX path: " << dslx_path.ToString();
+  std::optional<PrefetchedModule> prefetched =
+      import_data->TakePrefetchedModule(subject);
+  DslxPath dslx_path;
+  if (prefetched.has_value()) {
+    dslx_path.source_path = prefetched->source_path;
+    VLOG(3) << "Using prefetched module from " << dslx_path.source_path;
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        dslx_path, FindExistingPath(subject, import_data->stdlib_path(),
+                                    import_data->additional_search_paths(),
+                                    import_span, file_table, vfs));
+    VLOG(3) << "Found DSLX path: " << dslx_path.ToString();
+  }
 
   // We make a note about the import that's about to happen:
   // - so we can detect circular imports
@@ -202,32 +388,67 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
   absl::Cleanup cleanup = absl::MakeCleanup(
       [&] { CHECK_OK(import_data->PopFromImporterStack(import_span)); });
 
-  // Use the "filesystem_path" for reading the contents but the "source_path"
-  // for other uses. This avoids decorated paths like
-  // "/build/work/.../runfiles/...a/b/c/foo.x" appearing in the file table and
-  // artifacts. Instead the original "a/b/c/foo.x" path is used.
-  XLS_ASSIGN_OR_RETURN(std::string contents,
-                       vfs.GetFileContents(dslx_path.filesystem_path));
-
   absl::Span<std::string const> pieces = subject.pieces();
   std::string fully_qualified_name = absl::StrJoin(pieces, ".");
   VLOG(3) << "Parsing and typechecking " << fully_qualified_name << ": start";
 
-  VLOG(4) << "Subject = " << subject.ToString();
-  VLOG(4) << "Source path = " << dslx_path.source_path.c_str();
-  VLOG(4) << "Filesystem path = " << dslx_path.filesystem_path.c_str();
+  std::unique_ptr<Module> module;
+  std::optional<std::string> contents;
+  uint64_t content_hash;
+  if (prefetched.has_value()) {
+    module = std::move(prefetched->module);
+    content_hash = prefetched->content_hash;
+  } else {
+    // Use the "filesystem_path" for reading the contents but the
+    // "source_path" for other uses. This avoids decorated paths like
+    // "/build/work/.../runfiles/...a/b/c/foo.x" appearing in the file table
+    // and artifacts. Instead the original "a/b/c/foo.x" path is used.
+    XLS_ASSIGN_OR_RETURN(contents,
+                         vfs.GetFileContents(dslx_path.filesystem_path));
+    content_hash = absl::HashOf(*contents);
+  }
+
+  if (std::unique_ptr<ModuleInfo> evicted =
+          import_data->TakeEvictedModule(subject)) {
+    absl::StatusOr<bool> reusable = CanReuseEvictedModule(
+        *evicted, content_hash, ftypecheck, import_data, vfs);
+    if (reusable.ok() && *reusable) {
+      VLOG(3) << "Reusing evicted module " << fully_qualified_name;
+      import_data->NoteModuleCacheHit();
+      return import_data->Put(subject, std::move(evicted));
+    }
+    import_data->DropModule(std::move(evicted));
+    XLS_RETURN_IF_ERROR(reusable.status());
+  }
+  import_data->NoteModuleCacheMiss();
+
+  if (module == nullptr) {
+    VLOG(4) << "Subject = " << subject.ToString();
+    VLOG(4) << "Source path = " << dslx_path.source_path.c_str();
+    VLOG(4) << "Filesystem path = " << dslx_path.filesystem_path.c_str();
 
-  Fileno fileno = file_table.GetOrCreate(dslx_path.source_path.c_str());
-  Scanner scanner(file_table, fileno, contents);
-  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
-  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
+    Fileno fileno = file_table.GetOrCreate(dslx_path.source_path.c_str());
+    XLS_ASSIGN_OR_RETURN(module,
+                         ParseImportedModule(fully_qualified_name, fileno,
+                                             *std::move(contents), file_table));
+  }
+  absl::StatusOr<TypeInfo*> type_info = ftypecheck(module.get());
+  if (!type_info.ok()) {
+    // The module is destroyed on return, so drop any type information noted
+    // for it; this keeps `import_data` usable for later imports.
+    import_data->type_info_owner().Release(module.get());
+    return type_info.status();
+  }
 
   VLOG(3) << "Parsing and typechecking " << fully_qualified_name << ": done";
 
-  return import_data->Put(
-      subject, std::make_unique<ModuleInfo>(std::move(module), type_info,
-                                            std::move(dslx_path.source_path)));
+  XLS_ASSIGN_OR_RETURN(uint64_t cache_key,
+                       GetModuleCacheKey(*module, content_hash, import_data));
+  auto module_info = std::make_unique<ModuleInfo>(
+      std::move(module), *type_info, std::move(dslx_path.source_path));
+  module_info->set_content_hash(content_hash);
+  module_info->set_cache_key(cache_key);
+  return import_data->Put(subject, std::move(module_info));
 }
 
 }  // namespace xls::dslx
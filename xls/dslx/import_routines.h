@@ -15,6 +15,7 @@
 #ifndef XLS_DSLX_IMPORT_ROUTINES_H_
 #define XLS_DSLX_IMPORT_ROUTINES_H_
 
+#include <cstdint>
 #include <functional>
 
 #include "absl/status/statusor.h"
@@ -54,6 +55,18 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const Span& import_span,
                                      VirtualizableFilesystem& vfs);
 
+// Discovers the modules transitively imported by `module` which are not yet in
+// `import_data`, and reads and parses them ahead of their import, one level of
+// the import DAG at a time on up to `max_threads` threads (as many as there
+// are available CPUs if zero). DoImport then only has to typecheck them.
+//
+// Typechecking itself stays sequential in import order: typechecking a module
+// can add type information (e.g. parametric instantiations) to the modules it
+// imports. Modules which cannot be found or parsed are skipped, so that
+// DoImport reports the error at the import statement.
+void PrefetchImports(const Module& module, ImportData* import_data,
+                     int64_t max_threads = 0);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_IMPORT_ROUTINES_H_
@@ -0,0 +1,140 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/import_routines.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/virtualizable_file_system.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+using ::absl_testing::StatusIs;
+
+// Filesystem whose files live in a map, so that tests can edit them.
+class InMemoryFilesystem : public VirtualizableFilesystem {
+ public:
+  absl::Status FileExists(const std::filesystem::path& path) override {
+    if (files_.contains(path.string())) {
+      return absl::OkStatus();
+    }
+    return absl::NotFoundError(path.string());
+  }
+  absl::StatusOr<std::string> GetFileContents(
+      const std::filesystem::path& path) override {
+    auto it = files_.find(path.string());
+    if (it == files_.end()) {
+      return absl::NotFoundError(path.string());
+    }
+    return it->second;
+  }
+  absl::StatusOr<std::filesystem::path> GetCurrentDirectory() override {
+    return std::filesystem::path("/");
+  }
+
+  void SetFile(const std::string& path, std::string contents) {
+    files_[path] = std::move(contents);
+  }
+
+ private:
+  absl::flat_hash_map<std::string, std::string> files_;
+};
+
+class ImportRoutinesTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto vfs = std::make_unique<InMemoryFilesystem>();
+    vfs_ = vfs.get();
+    vfs_->SetFile("leaf.x", "pub const A = u32:1;");
+    vfs_->SetFile("mid.x", R"(import leaf;
+pub const B = leaf::A + u32:1;
+)");
+    import_data_ = CreateImportDataPtr(kDefaultDslxStdlibPath,
+                                       /*additional_search_paths=*/{},
+                                       kDefaultWarningsSet, std::move(vfs));
+  }
+
+  // Parses and typechecks a top module importing `mid`, after evicting every
+  // module from a previous run.
+  absl::Status Typecheck() {
+    import_data_->EvictModules(
+        [](const std::filesystem::path& path) { return true; });
+    return ParseAndTypecheck(R"(import mid;
+const C = mid::B;
+)",
+                             "top.x", "top", import_data_.get())
+        .status();
+  }
+
+  InMemoryFilesystem* vfs_;
+  std::unique_ptr<ImportData> import_data_;
+};
+
+TEST_F(ImportRoutinesTest, UnchangedEvictedModulesAreReused) {
+  XLS_ASSERT_OK(Typecheck());
+  EXPECT_EQ(import_data_->module_cache_hits(), 0);
+  EXPECT_EQ(import_data_->module_cache_misses(), 2);
+
+  XLS_ASSERT_OK(Typecheck());
+  EXPECT_EQ(import_data_->module_cache_hits(), 2);
+  EXPECT_EQ(import_data_->module_cache_misses(), 2);
+}
+
+TEST_F(ImportRoutinesTest, ChangedModuleIsTypecheckedAgain) {
+  XLS_ASSERT_OK(Typecheck());
+  vfs_->SetFile("mid.x", R"(import leaf;
+pub const B = leaf::A + u32:2;
+)");
+
+  XLS_ASSERT_OK(Typecheck());
+  EXPECT_EQ(import_data_->module_cache_hits(), 1);
+  EXPECT_EQ(import_data_->module_cache_misses(), 3);
+}
+
+// A module whose own text is unchanged must still be typechecked again when a
+// module it transitively imports changes.
+TEST_F(ImportRoutinesTest, ChangedImportInvalidatesImporter) {
+  XLS_ASSERT_OK(Typecheck());
+  vfs_->SetFile("leaf.x", "pub const A = u32:2;");
+
+  XLS_ASSERT_OK(Typecheck());
+  EXPECT_EQ(import_data_->module_cache_hits(), 0);
+  EXPECT_EQ(import_data_->module_cache_misses(), 4);
+}
+
+TEST_F(ImportRoutinesTest, ChangedImportTypeIsReportedAtImporter) {
+  XLS_ASSERT_OK(Typecheck());
+  vfs_->SetFile("leaf.x", "pub const A = u8:1;");
+
+  EXPECT_THAT(Typecheck(), StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -85,6 +85,13 @@ ABSL_FLAG(bool, trace_channels, false,
 ABSL_FLAG(int64_t, max_ticks, 100000,
           "If non-zero, the maximum number of ticks to execute on any proc. If "
           "exceeded an error is returned.");
+ABSL_FLAG(int64_t, proc_threads, 0,
+          "If non-zero, test procs run by the DSLX interpreter execute their "
+          "proc instances concurrently on this many threads.");
+ABSL_FLAG(int64_t, test_threads, 0,
+          "If non-zero, the unit tests of the module are run concurrently on "
+          "this many threads. Results and trace output are still reported in "
+          "the order the tests are declared.");
 ABSL_FLAG(std::string, evaluator, "dslx-interpreter",
           "What evaluator should be used to actually execute the dslx test. "
           "'dslx-interpreter' is the DSLX bytecode interpreter. 'ir-jit' is "
@@ -195,7 +202,11 @@ absl::StatusOr<TestResult> RealMain(
                                  .warnings_as_errors = warnings_as_errors,
                                  .warnings = warnings,
                                  .trace_channels = trace_channels,
-                                 .max_ticks = max_ticks};
+                                 .max_ticks = max_ticks,
+                                 .proc_threads =
+                                     absl::GetFlag(FLAGS_proc_threads),
+                                 .test_threads =
+                                     absl::GetFlag(FLAGS_test_threads)};
 
   std::unique_ptr<AbstractTestRunner> test_runner = GetTestRunner(evaluator);
   XLS_ASSIGN_OR_RETURN(TestResultData test_result,
@@ -51,6 +51,11 @@ struct ConvertOptions {
   // If present, the default FIFO config to use for any FIFO that does not
   // specify a config.
   std::optional<FifoConfig> default_fifo_config;
+
+  // Whether to simplify trivially redundant IR (e.g., tuple-index chains of
+  // destructured tuples, no-op casts and operations on constants) as it is
+  // emitted. See BuilderBase::set_simplify.
+  bool simplify_during_conversion = false;
 };
 
 }  // namespace xls::dslx
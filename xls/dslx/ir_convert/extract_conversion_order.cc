@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -576,46 +577,57 @@ absl::StatusOr<std::vector<Proc*>> GetTopLevelProcs(Module* module,
 // This function removes duplicate conversion records containing a non-derived
 // DSLX functions from a list. A non-derived non-parametric function is not an
 // inferred function (e.g. derived from a proc spawn/invocation or a parametric
-// function). The 'ready' input list is modified and cannot be nullptr.
+// function). The first record of each function (and parametric environment,
+// for parametric functions) is kept. The 'ready' input list is modified and
+// cannot be nullptr.
 static void RemoveFunctionDuplicates(std::vector<ConversionRecord>* ready) {
-  for (auto iter_func = ready->begin(); iter_func != ready->end();
-       iter_func++) {
-    const ConversionRecord& function_cr = *iter_func;
-    for (auto iter_subject = iter_func + 1; iter_subject != ready->end();) {
-      const ConversionRecord& subject_cr = *iter_subject;
-
-      bool same_fns = function_cr.f() == subject_cr.f();
-      bool either_is_proc_instance_fn =
-          function_cr.f()->tag() == FunctionTag::kProcConfig ||
-          function_cr.f()->tag() == FunctionTag::kProcNext ||
-          subject_cr.f()->tag() == FunctionTag::kProcConfig ||
-          subject_cr.f()->tag() == FunctionTag::kProcNext;
-      bool either_is_parametric =
-          function_cr.f()->IsParametric() || subject_cr.f()->IsParametric();
-      bool both_are_parametric =
-          function_cr.f()->IsParametric() && subject_cr.f()->IsParametric();
-
-      if (same_fns && !either_is_proc_instance_fn) {
-        // If neither are parametric, then function identity comparison is
-        // a sufficient test to eliminate detected duplicates.
-        if (!either_is_parametric) {
-          iter_subject = ready->erase(iter_subject);
-          continue;
-        }
-
-        // If the functions are the same and they have the same parametric
-        // environment, eliminate any duplicates.
-        if (both_are_parametric &&
-            function_cr.parametric_env() == subject_cr.parametric_env()) {
-          iter_subject = ready->erase(iter_subject);
-          continue;
-        }
-      }
-      iter_subject++;
+  absl::flat_hash_set<std::pair<const Function*, ParametricEnv>> seen;
+  auto is_duplicate = [&](const ConversionRecord& cr) {
+    if (cr.f()->tag() == FunctionTag::kProcConfig ||
+        cr.f()->tag() == FunctionTag::kProcNext) {
+      return false;
+    }
+    // If the function is not parametric, then function identity comparison is
+    // a sufficient test to eliminate detected duplicates.
+    return !seen
+                .emplace(cr.f(), cr.f()->IsParametric() ? cr.parametric_env()
+                                                        : ParametricEnv())
+                .second;
+  };
+  std::vector<ConversionRecord> deduplicated;
+  deduplicated.reserve(ready->size());
+  for (ConversionRecord& cr : *ready) {
+    if (!is_duplicate(cr)) {
+      deduplicated.push_back(std::move(cr));
     }
   }
+  *ready = std::move(deduplicated);
 }
 
+// The conversion order being built, along with an index of the (non-proc)
+// function instantiations it contains, so that checking whether a callee is
+// already in the order does not need to scan the whole order. Modules with
+// many parametric instantiations would otherwise spend time quadratic in
+// their number here.
+struct ReadyList {
+  using Key = std::tuple<const Function*, const Module*, ParametricEnv>;
+
+  bool Contains(const Function* f, const Module* m,
+                const ParametricEnv& bindings) const {
+    return index.contains(Key{f, m, bindings});
+  }
+
+  void Add(ConversionRecord cr) {
+    if (!cr.proc_id().has_value()) {
+      index.insert(Key{cr.f(), cr.module(), cr.parametric_env()});
+    }
+    records.push_back(std::move(cr));
+  }
+
+  std::vector<ConversionRecord> records;
+  absl::flat_hash_set<Key> index;
+};
+
 // Traverses the definition of a node to find callees.
 //
 // Args:
@@ -639,37 +651,24 @@ static absl::StatusOr<std::vector<Callee>> GetCallees(
 }
 
 static bool IsReady(std::variant<Function*, TestFunction*> f, Module* m,
-                    const ParametricEnv& bindings,
-                    const std::vector<ConversionRecord>* ready) {
+                    const ParametricEnv& bindings, const ReadyList* ready) {
   // Test functions are always the root and non-parametric, so they're always
   // ready.
   if (std::holds_alternative<TestFunction*>(f)) {
     return true;
   }
-
-  auto matches_fn = [&](const ConversionRecord& cr, Function* f) {
-    return cr.f() == f && cr.module() == m && cr.parametric_env() == bindings &&
-           !cr.proc_id().has_value();
-  };
-
-  for (const ConversionRecord& cr : *ready) {
-    if (matches_fn(cr, std::get<Function*>(f))) {
-      return true;
-    }
-  }
-  return false;
+  return ready->Contains(std::get<Function*>(f), m, bindings);
 }
 
 // Forward decl.
 static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
-                                   std::vector<ConversionRecord>* ready);
+                                   ReadyList* ready);
 
 // Adds (f, bindings) to conversion order after deps have been added.
 static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
                                const Invocation* invocation, Module* m,
                                TypeInfo* type_info,
-                               const ParametricEnv& bindings,
-                               std::vector<ConversionRecord>* ready,
+                               const ParametricEnv& bindings, ReadyList* ready,
                                const std::optional<ProcId>& proc_id,
                                bool is_top = false) {
   CHECK_EQ(type_info->module(), m);
@@ -698,12 +697,12 @@ static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
       ConversionRecord cr,
       ConversionRecord::Make(fn, invocation, m, type_info, bindings,
                              orig_callees, proc_id, is_top));
-  ready->push_back(std::move(cr));
+  ready->Add(std::move(cr));
   return absl::OkStatus();
 }
 
 static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
-                                   std::vector<ConversionRecord>* ready) {
+                                   ReadyList* ready) {
   // Knock out all callees that are already in the (ready) order.
   std::vector<Callee> non_ready;
   {
@@ -727,7 +726,7 @@ static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
 
 static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
     std::variant<Proc*, TestProc*> entry, TypeInfo* type_info, bool is_top) {
-  std::vector<ConversionRecord> ready;
+  ReadyList ready;
   Proc* p;
   if (std::holds_alternative<TestProc*>(entry)) {
     p = std::get<TestProc*>(entry)->proc();
@@ -753,7 +752,7 @@ static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
   std::vector<ConversionRecord> final_order;
   std::vector<ConversionRecord> config_fns;
   std::vector<ConversionRecord> next_fns;
-  for (const auto& record : ready) {
+  for (const auto& record : ready.records) {
     if (record.f()->tag() == FunctionTag::kProcConfig) {
       config_fns.push_back(record);
     } else if (record.f()->tag() == FunctionTag::kProcNext) {
@@ -774,7 +773,7 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
                                                        TypeInfo* type_info,
                                                        bool include_tests) {
   CHECK_EQ(type_info->module(), module);
-  std::vector<ConversionRecord> ready;
+  ReadyList ready;
 
   auto handle_function = [&](Function* f) -> absl::Status {
     // NOTE: Proc creation is driven by Spawn instantiations - the
@@ -833,6 +832,8 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
     XLS_RETURN_IF_ERROR(status);
   }
 
+  std::vector<ConversionRecord> order = std::move(ready.records);
+
   // Collect the top level procs.
   XLS_ASSIGN_OR_RETURN(std::vector<Proc*> top_level_procs,
                        GetTopLevelProcs(module, type_info));
@@ -844,43 +845,44 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
 
     XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> proc_ready,
                          GetOrderForProc(proc, proc_ti, /*is_top=*/false));
-    ready.insert(ready.end(), proc_ready.begin(), proc_ready.end());
+    order.insert(order.end(), proc_ready.begin(), proc_ready.end());
   }
 
   // Remove duplicated functions. When performing a complete module conversion,
   // the functions and the proc are converted in that order. However, procs may
   // call functions resulting in functions being accounted for twice. There must
   // be a single instance of the function to convert.
-  RemoveFunctionDuplicates(&ready);
+  RemoveFunctionDuplicates(&order);
 
-  VLOG(5) << "Ready list: " << ConversionRecordsToString(ready);
+  VLOG(5) << "Ready list: " << ConversionRecordsToString(order);
 
-  return ready;
+  return order;
 }
 
 absl::StatusOr<std::vector<ConversionRecord>> GetOrderForEntry(
     std::variant<Function*, Proc*> entry, TypeInfo* type_info) {
-  std::vector<ConversionRecord> ready;
   if (std::holds_alternative<Function*>(entry)) {
     Function* f = std::get<Function*>(entry);
     if (f->proc().has_value()) {
       XLS_ASSIGN_OR_RETURN(
           type_info, type_info->GetTopLevelProcTypeInfo(f->proc().value()));
     }
+    ReadyList ready;
     XLS_RETURN_IF_ERROR(AddToReady(f,
                                    /*invocation=*/nullptr, f->owner(),
                                    type_info, ParametricEnv(), &ready, {},
                                    /*is_top=*/true));
-    RemoveFunctionDuplicates(&ready);
-    return ready;
+    RemoveFunctionDuplicates(&ready.records);
+    return std::move(ready.records);
   }
 
   Proc* p = std::get<Proc*>(entry);
   XLS_ASSIGN_OR_RETURN(TypeInfo * new_ti,
                        type_info->GetTopLevelProcTypeInfo(p));
-  XLS_ASSIGN_OR_RETURN(ready, GetOrderForProc(p, new_ti, /*is_top=*/true));
-  RemoveFunctionDuplicates(&ready);
-  return ready;
+  XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> order,
+                       GetOrderForProc(p, new_ti, /*is_top=*/true));
+  RemoveFunctionDuplicates(&order);
+  return order;
 }
 
 }  // namespace xls::dslx
@@ -458,6 +458,7 @@ void FunctionConverter::SetFunctionBuilder(
     base->set_top(true);
   }
   function_builder_ = std::move(builder);
+  function_builder_->set_simplify(options_.simplify_during_conversion);
 }
 
 void FunctionConverter::AddConstantDep(ConstantDef* constant_def) {
@@ -32,6 +32,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/ir_convert/conversion_info.h"
 #include "xls/dslx/ir_convert/convert_options.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
@@ -92,6 +93,8 @@ absl::Status RealMain(absl::Span<const std::string_view> paths) {
   bool emit_fail_as_assert = ir_converter_options.emit_fail_as_assert();
   bool verify_ir = ir_converter_options.verify();
   bool convert_tests = ir_converter_options.convert_tests();
+  bool simplify_during_conversion =
+      ir_converter_options.simplify_during_conversion();
   bool warnings_as_errors = ir_converter_options.warnings_as_errors();
   XLS_ASSIGN_OR_RETURN(WarningKindSet enabled_warnings,
                        WarningKindSetFromDisabledString(
@@ -110,6 +113,7 @@ absl::Status RealMain(absl::Span<const std::string_view> paths) {
       .enabled_warnings = enabled_warnings,
       .convert_tests = convert_tests,
       .default_fifo_config = default_fifo_config,
+      .simplify_during_conversion = simplify_during_conversion,
   };
 
   // The following checks are performed inside ConvertFilesToPackage(), but we
@@ -132,9 +136,15 @@ absl::Status RealMain(absl::Span<const std::string_view> paths) {
                            /*top=*/top,
                            /*package_name=*/package_name, &printed_error));
   if (output_file) {
-    XLS_RETURN_IF_ERROR(SetFileContents(*output_file, result.DumpIr()));
+    XLS_RETURN_IF_ERROR(result.package->DumpIrToFile(
+        *output_file, /*parallelism=*/AvailableCPUs()));
   } else {
-    std::cout << result.package->DumpIr();
+    XLS_RETURN_IF_ERROR(result.package->EmitIr(
+        [](std::string_view piece) {
+          std::cout << piece;
+          return absl::OkStatus();
+        },
+        /*parallelism=*/AvailableCPUs()));
   }
   if (ir_converter_options.has_interface_proto_file()) {
     XLS_RETURN_IF_ERROR(
@@ -51,6 +51,10 @@ ABSL_FLAG(bool, convert_tests, false,
           "Feature flag for emitting test procs/functions to IR.");
 ABSL_FLAG(bool, verify, true,
           "If true, verifies the generated IR for correctness.");
+ABSL_FLAG(bool, simplify_during_conversion, false,
+          "If true, trivially redundant IR (e.g., tuple-index chains of "
+          "destructured tuples, no-op casts and operations on constants) is "
+          "simplified as it is emitted.");
 
 ABSL_FLAG(std::optional<std::string>, disable_warnings, std::nullopt,
           "Comma-delimited list of warnings to disable -- not generally "
@@ -100,6 +104,7 @@ absl::StatusOr<bool> SetOptionsFromFlags(IrConverterOptionsFlagsProto& proto) {
   POPULATE_FLAG(emit_fail_as_assert);
   POPULATE_FLAG(verify);
   POPULATE_FLAG(convert_tests);
+  POPULATE_FLAG(simplify_during_conversion);
   POPULATE_OPTIONAL_FLAG(disable_warnings);
   POPULATE_FLAG(warnings_as_errors);
   POPULATE_OPTIONAL_FLAG(interface_proto_file);
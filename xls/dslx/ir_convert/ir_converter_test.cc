@@ -46,6 +46,7 @@ namespace {
 
 using ::absl_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Not;
 
 absl::StatusOr<TestResultData> ParseAndTest(
     std::string_view program, std::string_view module_name,
@@ -182,6 +183,23 @@ TEST(IrConverterTest, LetTupleBinding) {
   ExpectIr(converted, TestName());
 }
 
+TEST(IrConverterTest, LetTupleBindingSimplified) {
+  const char* program =
+      R"(fn f(x: u32) -> u32 {
+  let (a, b) = (x, u32:2 + u32:3);
+  a + b
+})";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string converted,
+      ConvertOneFunctionForTest(
+          program, "f",
+          ConvertOptions{.emit_positions = false,
+                         .simplify_during_conversion = true}));
+  EXPECT_THAT(converted, HasSubstr("literal(value=5"));
+  EXPECT_THAT(converted, Not(HasSubstr("tuple_index")));
+  EXPECT_THAT(converted, Not(HasSubstr("tuple(")));
+}
+
 TEST(IrConverterTest, LetTupleBindingNested) {
   const char* program =
       R"(fn f() -> u32 {
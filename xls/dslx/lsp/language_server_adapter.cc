@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -40,6 +41,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/extract_module_name.h"
 #include "xls/dslx/fmt/ast_fmt.h"
@@ -170,7 +172,19 @@ absl::Status LanguageServerAdapter::Update(
     LspUri file_uri, std::optional<std::string_view> dslx_code) {
   // Either update or get the last contents from the virtual filesystem map.
   if (dslx_code.has_value()) {
-    vfs_contents_[file_uri] = std::string{dslx_code.value()};
+    std::string& contents = vfs_contents_[file_uri];
+    if (contents != *dslx_code) {
+      contents = std::string{dslx_code.value()};
+      // Other buffers may have the old contents of this file (or of modules
+      // importing it) cached; they're evicted on the buffer's next parse.
+      std::vector<LspUri> sensitive =
+          import_sensitivity_.GatherAllSensitiveToChangeIn(file_uri);
+      for (const auto& [uri, parse_data] : uri_parse_data_) {
+        if (uri != file_uri) {
+          stale_imports_[uri].insert(sensitive.begin(), sensitive.end());
+        }
+      }
+    }
   } else {
     auto it = vfs_contents_.find(file_uri);
     if (it == vfs_contents_.end()) {
@@ -196,9 +210,28 @@ absl::Status LanguageServerAdapter::Update(
   std::vector<std::filesystem::path> dslx_paths_as_filesystem_paths =
       GetDslxPathsAsFilesystemPaths();
 
-  ImportData import_data = CreateImportData(
-      stdlib_.GetFilesystemPath(), dslx_paths_as_filesystem_paths,
-      kAllWarningsSet, std::make_unique<LanguageServerFilesystem>(*this));
+  std::unique_ptr<ImportData> import_data_ptr;
+  if (insert_value != nullptr) {
+    // Reuse the modules imported by the previous parse of this buffer, except
+    // for the buffer's own module and the stale ones.
+    import_data_ptr = insert_value->TakeImportData();
+    insert_value.reset();
+    absl::flat_hash_set<LspUri> stale = std::move(stale_imports_[file_uri]);
+    stale_imports_.erase(file_uri);
+    const std::filesystem::path file_path = file_uri.GetFilesystemPath();
+    import_data_ptr->EvictModules([&](const std::filesystem::path& path) {
+      return path == file_path ||
+             stale.contains(LspUri::FromFilesystemPath(path));
+    });
+    // Cached bytecode refers to the type information of evicted modules.
+    import_data_ptr->SetBytecodeCache(
+        std::make_unique<BytecodeCache>(import_data_ptr.get()));
+  } else {
+    import_data_ptr = CreateImportDataPtr(
+        stdlib_.GetFilesystemPath(), dslx_paths_as_filesystem_paths,
+        kAllWarningsSet, std::make_unique<LanguageServerFilesystem>(*this));
+  }
+  ImportData& import_data = *import_data_ptr;
 
   import_data.SetImporterStackObserver(
       [&](const Span& importer_span, const std::filesystem::path& imported) {
@@ -223,13 +256,14 @@ absl::Status LanguageServerAdapter::Update(
 
   if (typechecked_module.ok()) {
     insert_value = std::make_unique<ParseData>(
-        std::move(import_data), TypecheckedModuleWithComments{
-                                    .tm = std::move(typechecked_module).value(),
-                                    .comments = Comments::Create(comments),
-                                    .contents = std::string(*dslx_code),
-                                });
+        std::move(import_data_ptr),
+        TypecheckedModuleWithComments{
+            .tm = std::move(typechecked_module).value(),
+            .comments = Comments::Create(comments),
+            .contents = std::string(*dslx_code),
+        });
   } else {
-    insert_value = std::make_unique<ParseData>(std::move(import_data),
+    insert_value = std::make_unique<ParseData>(std::move(import_data_ptr),
                                                typechecked_module.status());
   }
 
@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -61,7 +62,10 @@ class LanguageServerAdapter {
   // `dslx_code` can be nullopt when we're re-evaluating the previous contents
   // again; i.e. because we think a dependency may have been corrected.
   //
-  // Note: this is parsing is triggered for every keystroke. Fine for now.
+  // Note: this is parsing is triggered for every keystroke. Each buffer keeps
+  // the imports of its previous parse cached, so only the modules which may
+  // have changed since (the buffer itself and anything sensitive to an edited
+  // buffer, see `ImportSensitivity`) are parsed and typechecked again.
   // Successful and unsuccessful parses are memoized so that their status
   // and can be queried.
   //
@@ -137,15 +141,21 @@ class LanguageServerAdapter {
   // This could maybe be considered to be put in a single place.
   class ParseData {
    public:
-    ParseData(ImportData&& import_data,
+    ParseData(std::unique_ptr<ImportData> import_data,
               absl::StatusOr<TypecheckedModuleWithComments> tmc)
         : import_data_(std::move(import_data)), tmc_(std::move(tmc)) {}
 
     bool ok() const { return tmc_.ok(); }
     absl::Status status() const { return tmc_.status(); }
 
-    ImportData& import_data() { return import_data_; }
-    FileTable& file_table() { return import_data_.file_table(); }
+    ImportData& import_data() { return *import_data_; }
+    FileTable& file_table() { return import_data_->file_table(); }
+
+    // Releases the import data for reuse by the next parse of the buffer. The
+    // parse data must not be used afterwards.
+    std::unique_ptr<ImportData> TakeImportData() {
+      return std::move(import_data_);
+    }
     const Module& module() const {
       CHECK_OK(tmc_.status());
       return *tmc_->tm.module;
@@ -168,7 +178,7 @@ class LanguageServerAdapter {
     }
 
    private:
-    ImportData import_data_;
+    std::unique_ptr<ImportData> import_data_;
     absl::StatusOr<TypecheckedModuleWithComments> tmc_;
   };
 
@@ -176,6 +186,10 @@ class LanguageServerAdapter {
   const std::vector<LspUri> dslx_paths_;
   absl::flat_hash_map<LspUri, std::unique_ptr<ParseData>> uri_parse_data_;
 
+  // For each buffer, the files whose cached modules are stale in its import
+  // data because they're sensitive to an edit made since its last parse.
+  absl::flat_hash_map<LspUri, absl::flat_hash_set<LspUri>> stale_imports_;
+
   // The language server, in effect, needs to maintain a virtual filesystem
   // layer, that's interwoven with the true filesystem; i.e. if a file is
   // present on disk but not opened in the LSP workspace, we resolve it on
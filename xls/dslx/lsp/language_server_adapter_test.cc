@@ -523,6 +523,36 @@ const OUTER_FOO = inner::FOO;  // this is not public, at first
   ASSERT_TRUE(diags.empty());
 }
 
+// Tests that imports cached from a previous parse of a buffer are re-evaluated
+// once the imported buffer changes.
+TEST(LanguageServerAdapterTest, CachedImportsAreInvalidatedByEdits) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory tempdir, TempDirectory::Create());
+  LanguageServerAdapter adapter(
+      GetDslxStdlibUri(),
+      /*dslx_paths=*/{LspUri::FromFilesystemPath(tempdir.path())});
+
+  const LspUri imported_uri(
+      absl::StrFormat("file://%s/imported.x", tempdir.path()));
+  const LspUri importer_uri(
+      absl::StrFormat("file://%s/importer.x", tempdir.path()));
+  XLS_ASSERT_OK(adapter.Update(imported_uri, "pub const X = u32:1;"));
+  XLS_ASSERT_OK(adapter.Update(importer_uri, R"(import imported;
+const Y: u32 = imported::X;
+)"));
+  // Re-parsing the importer reuses its cached import of `imported`.
+  XLS_ASSERT_OK(adapter.Update(importer_uri, R"(import imported;
+const Y: u32 = imported::X + u32:1;
+)"));
+
+  XLS_ASSERT_OK(adapter.Update(imported_uri, "pub const X = u8:1;"));
+  EXPECT_THAT(adapter.Update(importer_uri, std::nullopt),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  XLS_EXPECT_OK(adapter.Update(importer_uri, R"(import imported;
+const Y: u8 = imported::X;
+)"));
+  EXPECT_TRUE(adapter.GenerateParseDiagnostics(importer_uri).empty());
+}
+
 // Tests that when DSLX path values are given we can resolve imports against
 // them.
 TEST(LanguageServerAdapterTest, NontrivialDslxPathResolution) {
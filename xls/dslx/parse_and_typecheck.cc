@@ -33,6 +33,7 @@
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/typecheck_module.h"
 #include "xls/dslx/type_system_v2/typecheck_module_v2.h"
@@ -59,6 +60,7 @@ absl::StatusOr<TypecheckedModule> ParseAndTypecheck(
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module,
                        ParseModule(text, path, module_name,
                                    import_data->file_table(), comments));
+  PrefetchImports(*module, import_data);
   return TypecheckModule(std::move(module), path, import_data);
 }
 
@@ -95,17 +97,21 @@ absl::StatusOr<TypecheckedModule> TypecheckModule(
   std::string_view module_name = module->name();
 
   WarningCollector warnings(import_data->enabled_warnings());
-  XLS_ASSIGN_OR_RETURN(
-      TypeInfo * type_info,
+  absl::StatusOr<TypeInfo*> type_info =
       module->annotations().contains(ModuleAnnotation::kTypeInferenceVersion2)
           ? TypecheckModuleV2(module.get(), import_data, &warnings)
-          : TypecheckModule(module.get(), import_data, &warnings));
-  TypecheckedModule result{module.get(), type_info, std::move(warnings)};
+          : TypecheckModule(module.get(), import_data, &warnings);
+  if (!type_info.ok()) {
+    // As in DoImport, the module is destroyed on return.
+    import_data->type_info_owner().Release(module.get());
+    return type_info.status();
+  }
+  TypecheckedModule result{module.get(), *type_info, std::move(warnings)};
   XLS_ASSIGN_OR_RETURN(ImportTokens subject,
                        ImportTokens::FromString(module_name));
   XLS_RETURN_IF_ERROR(import_data
                           ->Put(subject, std::make_unique<ModuleInfo>(
-                                             std::move(module), type_info,
+                                             std::move(module), *type_info,
                                              std::filesystem::path(path)))
                           .status());
   return result;
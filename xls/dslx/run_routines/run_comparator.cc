@@ -146,4 +146,13 @@ absl::StatusOr<InterpreterResult<xls::Value>> RunComparator::RunIrFunction(
   return jit->Run(ir_args);
 }
 
+absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+RunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> ir_arg_sets) {
+  XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
+                       GetOrCompileJitFunction(ir_name, ir_function));
+  return jit->RunBatched(ir_arg_sets);
+}
+
 }  // namespace xls::dslx
@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -63,6 +64,13 @@ class RunComparator : public AbstractRunComparator {
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) override;
 
+  // Runs all the argument sets with a single call into the batched entry point
+  // of the jitted function.
+  absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+  RunIrFunctionBatched(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> ir_arg_sets) override;
+
   // Returns the cached or newly-compiled jit function for ir_name.  ir_name has
   // already been mangled (see MangleDslxName) so it should be unique in the
   // program and is used as the cache key.
@@ -17,9 +17,11 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <ctime>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <random>
@@ -29,6 +31,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/bind_front.h"
 #include "absl/log/check.h"
@@ -38,13 +41,15 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bytecode/bytecode.h"
-#include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter_options.h"
@@ -87,6 +92,17 @@ namespace {
 constexpr int kUnitSpaces = 7;
 constexpr int kQuickcheckSpaces = 15;
 
+// The outcome of running a unit test in `ParseAndTest()`.
+struct UnitTestRun {
+  bool filtered = false;
+  absl::Time start;
+  absl::Time end;
+  absl::StatusOr<RunResult> out;
+  // Trace messages buffered while running concurrently with other tests.
+  std::vector<std::pair<Span, std::string>> traces;
+  absl::Notification done;
+};
+
 void HandleError(TestResultData& result, const absl::Status& status,
                  std::string_view test_name, const Pos& start_pos,
                  const absl::Time& start, const absl::Duration& duration,
@@ -132,8 +148,6 @@ void HandleError(TestResultData& result, const absl::Status& status,
 absl::Status RunDslxTestFunction(ImportData* import_data, TypeInfo* type_info,
                                  Module* module, TestFunction* tf,
                                  const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
       BytecodeEmitter::Emit(
@@ -149,9 +163,6 @@ absl::Status RunDslxTestFunction(ImportData* import_data, TypeInfo* type_info,
 absl::Status RunDslxTestProc(ImportData* import_data, TypeInfo* type_info,
                              Module* module, TestProc* tp,
                              const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
-
   XLS_ASSIGN_OR_RETURN(TypeInfo * ti,
                        type_info->GetTopLevelProcTypeInfo(tp->proc()));
 
@@ -270,36 +281,85 @@ static bool TestMatchesFilter(std::string_view test_name,
   return RE2::FullMatch(test_name, *test_filter);
 }
 
+absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+AbstractRunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> ir_arg_sets) {
+  InterpreterResult<std::vector<xls::Value>> results;
+  results.value.reserve(ir_arg_sets.size());
+  for (const std::vector<xls::Value>& ir_args : ir_arg_sets) {
+    XLS_ASSIGN_OR_RETURN(InterpreterResult<xls::Value> result,
+                         RunIrFunction(ir_name, ir_function, ir_args));
+    results.value.push_back(std::move(result.value));
+    absl::c_move(result.events.trace_msgs,
+                 std::back_inserter(results.events.trace_msgs));
+    absl::c_move(result.events.assert_msgs,
+                 std::back_inserter(results.events.assert_msgs));
+  }
+  return results;
+}
+
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
     AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests) {
+  // Number of argument sets evaluated per call into the comparator. At most
+  // this many evaluations are wasted once a falsifying example is found.
+  constexpr int64_t kBatchSize = 1024;
+
   QuickCheckResults results;
   std::minstd_rand rng_engine(seed);
 
-  for (int i = 0; i < num_tests; i++) {
-    results.arg_sets.push_back(
-        RandomFunctionArguments(xls_function, rng_engine));
+  while (results.arg_sets.size() < num_tests) {
+    int64_t batch_start = results.arg_sets.size();
+    int64_t batch_size = std::min(kBatchSize, num_tests - batch_start);
+    for (int64_t i = 0; i < batch_size; ++i) {
+      results.arg_sets.push_back(
+          RandomFunctionArguments(xls_function, rng_engine));
+    }
+    absl::Span<const std::vector<Value>> batch =
+        absl::MakeConstSpan(results.arg_sets).subspan(batch_start);
+
     // TODO(https://github.com/google/xls/issues/506): 2021-10-15
     // Assertion failures should work out, but we should consciously decide
     // if/how we want to dump traces when running QuickChecks (always, for
     // failures, flag-controlled, ...).
-    XLS_ASSIGN_OR_RETURN(xls::Value result,
-                         DropInterpreterEvents(run_comparator->RunIrFunction(
-                             ir_name, xls_function, results.arg_sets.back())));
-
-    // In the case of an implicit token signature we get (token, bool) as the
-    // result of the quickcheck'd function, so we unbox the boolean here.
-    if (result.IsTuple()) {
-      result = result.elements()[1];
-      XLS_RET_CHECK(result.IsBits());
+    XLS_ASSIGN_OR_RETURN(
+        InterpreterResult<std::vector<Value>> batch_results,
+        run_comparator->RunIrFunctionBatched(ir_name, xls_function, batch));
+    if (!batch_results.events.assert_msgs.empty()) {
+      // An assertion fired somewhere in the batch. Rerun the samples one at a
+      // time so that only an assertion raised before any falsifying example
+      // is reported, as when running unbatched.
+      batch_results.value.clear();
+      for (const std::vector<Value>& args : batch) {
+        XLS_ASSIGN_OR_RETURN(
+            Value result,
+            DropInterpreterEvents(
+                run_comparator->RunIrFunction(ir_name, xls_function, args)));
+        batch_results.value.push_back(result);
+        if (result.IsTuple() ? result.elements()[1].IsAllZeros()
+                             : result.IsAllZeros()) {
+          break;
+        }
+      }
     }
 
-    results.results.push_back(result);
+    for (Value& result : batch_results.value) {
+      // In the case of an implicit token signature we get (token, bool) as the
+      // result of the quickcheck'd function, so we unbox the boolean here.
+      if (result.IsTuple()) {
+        result = result.elements()[1];
+        XLS_RET_CHECK(result.IsBits());
+      }
 
-    if (result.IsAllZeros()) {
-      // We were able to falsify the xls_function (predicate), bail out early
-      // and present this evidence.
-      break;
+      results.results.push_back(std::move(result));
+
+      if (results.results.back().IsAllZeros()) {
+        // We were able to falsify the xls_function (predicate), bail out early
+        // and present this evidence.
+        results.arg_sets.resize(results.results.size());
+        return results;
+      }
     }
   }
 
@@ -679,6 +739,7 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
   // with the interpreter.
   std::unique_ptr<Package> ir_package;
   PostFnEvalHook post_fn_eval_hook;
+  absl::Mutex comparator_mutex;
   if (options.run_comparator != nullptr) {
     absl::StatusOr<dslx::PackageConversionData> ir_package_conversion_data =
         ConvertModuleToPackage(entry_module, &import_data,
@@ -694,12 +755,15 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
                 "turning off comparison with `--compare=none`: ";
     }
     ir_package = (*std::move(ir_package_conversion_data)).package;
-    post_fn_eval_hook = [&ir_package, &import_data, &options](
+    post_fn_eval_hook = [&ir_package, &import_data, &options,
+                         &comparator_mutex](
                             const Function* f,
                             absl::Span<const InterpValue> args,
                             const ParametricEnv* parametric_env,
                             const InterpValue& got) -> absl::Status {
       XLS_RET_CHECK(f != nullptr);
+      // The comparator is not thread-safe and unit tests may run concurrently.
+      absl::MutexLock lock(&comparator_mutex);
       std::optional<bool> requires_implicit_token =
           import_data.GetRootTypeInfoForNode(f)
               .value()
@@ -715,42 +779,104 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
       std::unique_ptr<AbstractParsedTestRunner> runner,
       CreateTestRunner(&import_data, tm->type_info, entry_module));
   // Run unit tests.
-  for (const std::string& test_name : entry_module->GetTestNames()) {
-    auto test_case_start = absl::Now();
+  std::vector<std::string> test_names = entry_module->GetTestNames();
+  std::vector<UnitTestRun> runs(test_names.size());
+  std::vector<int64_t> to_run;
+  for (int64_t i = 0; i < test_names.size(); ++i) {
+    runs[i].filtered = !TestMatchesFilter(test_names[i], options.test_filter);
+    if (!runs[i].filtered) {
+      to_run.push_back(i);
+    }
+  }
+  bool concurrent = options.test_threads > 0 && to_run.size() > 1 &&
+                    runner->SupportsConcurrentTests();
+
+  // Runs the i-th unit test. When tests run concurrently, trace messages are
+  // buffered and replayed when the test is reported so that the output does
+  // not depend on thread scheduling.
+  auto run_test = [&](int64_t i) {
+    UnitTestRun& run = runs[i];
+    const std::string& test_name = test_names[i];
+    run.start = absl::Now();
+    BytecodeInterpreterOptions interpreter_options;
+    if (concurrent) {
+      interpreter_options.trace_hook(
+          [&run](const Span& span, std::string_view message) {
+            run.traces.push_back({span, std::string(message)});
+          });
+    } else {
+      interpreter_options.trace_hook(
+          absl::bind_front(InfoLoggingTraceHook, file_table));
+    }
+    interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
+        .trace_channels(options.trace_channels)
+        .max_ticks(options.max_ticks)
+        .proc_threads(options.proc_threads)
+        .format_preference(options.format_preference);
+    ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
+    if (std::holds_alternative<TestFunction*>(*member)) {
+      run.out = runner->RunTestFunction(test_name, interpreter_options);
+    } else {
+      run.out = runner->RunTestProc(test_name, interpreter_options);
+    }
+    run.end = absl::Now();
+  };
+
+  std::atomic<int64_t> next_to_run = 0;
+  std::atomic<bool> cancelled = false;
+  std::vector<std::unique_ptr<Thread>> workers;
+  if (concurrent) {
+    auto worker = [&]() {
+      for (int64_t i = next_to_run.fetch_add(1);
+           i < to_run.size() && !cancelled.load();
+           i = next_to_run.fetch_add(1)) {
+        run_test(to_run[i]);
+        runs[to_run[i]].done.Notify();
+      }
+    };
+    int64_t thread_count =
+        std::min<int64_t>(options.test_threads, to_run.size());
+    for (int64_t i = 0; i < thread_count; ++i) {
+      workers.push_back(std::make_unique<Thread>(worker));
+    }
+  }
+
+  // Report the results in declaration order.
+  absl::Status runner_status;
+  for (int64_t i = 0; i < test_names.size(); ++i) {
+    const std::string& test_name = test_names[i];
+    UnitTestRun& run = runs[i];
     ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
     const Pos start_pos = GetPos(*member);
 
-    if (!TestMatchesFilter(test_name, options.test_filter)) {
-      auto test_case_end = absl::Now();
+    if (run.filtered) {
+      auto test_case_start = absl::Now();
       result.AddTestCase(test_xml::TestCase{
           .name = test_name,
           .file = std::string{start_pos.GetFilename(file_table)},
           .line = start_pos.GetHumanLineno(),
           .status = test_xml::RunStatus::kRun,
           .result = test_xml::RunResult::kFiltered,
-          .time = test_case_end - test_case_start,
+          .time = absl::Now() - test_case_start,
           .timestamp = test_case_start});
       continue;
     }
 
     std::cerr << "[ RUN UNITTEST  ] " << test_name << '\n';
-    RunResult out;
-    BytecodeInterpreterOptions interpreter_options;
-    interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
-        .trace_hook(absl::bind_front(InfoLoggingTraceHook, file_table))
-        .trace_channels(options.trace_channels)
-        .max_ticks(options.max_ticks)
-        .format_preference(options.format_preference);
-    if (std::holds_alternative<TestFunction*>(*member)) {
-      XLS_ASSIGN_OR_RETURN(
-          out, runner->RunTestFunction(test_name, interpreter_options));
+    if (concurrent) {
+      run.done.WaitForNotification();
+      for (const auto& [span, message] : run.traces) {
+        InfoLoggingTraceHook(file_table, span, message);
+      }
     } else {
-      XLS_ASSIGN_OR_RETURN(out,
-                           runner->RunTestProc(test_name, interpreter_options));
+      run_test(i);
+    }
+    if (!run.out.ok()) {
+      runner_status = run.out.status();
+      break;
     }
-    auto test_case_end = absl::Now();
 
-    if (out.result.ok()) {
+    if (run.out->result.ok()) {
       // Add to the tracking data.
       result.AddTestCase(test_xml::TestCase{
           .name = test_name,
@@ -758,15 +884,20 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
           .line = start_pos.GetHumanLineno(),
           .status = test_xml::RunStatus::kRun,
           .result = test_xml::RunResult::kCompleted,
-          .time = test_case_end - test_case_start,
-          .timestamp = test_case_start});
+          .time = run.end - run.start,
+          .timestamp = run.start});
       std::cerr << "[            OK ]" << '\n';
     } else {
-      HandleError(result, out.result, test_name, start_pos, test_case_start,
-                  test_case_end - test_case_start,
+      HandleError(result, run.out->result, test_name, start_pos, run.start,
+                  run.end - run.start,
                   /*is_quickcheck=*/false, file_table, import_data.vfs());
     }
   }
+  cancelled = true;
+  for (std::unique_ptr<Thread>& worker : workers) {
+    worker->Join();
+  }
+  XLS_RETURN_IF_ERROR(runner_status);
 
   std::cerr << absl::StreamFormat(
                    "[===============] %d test(s) ran; %d failed; %d skipped.",
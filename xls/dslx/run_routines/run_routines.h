@@ -80,6 +80,14 @@ class AbstractRunComparator {
   virtual absl::StatusOr<InterpreterResult<xls::Value>> RunIrFunction(
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) = 0;
+
+  // Runs `ir_function` on each of the given argument sets, returning the
+  // results in the same order with the events of all invocations combined.
+  // Subclasses can override this to amortize the per-invocation overhead; the
+  // default implementation calls RunIrFunction for each argument set.
+  virtual absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+  RunIrFunctionBatched(std::string_view ir_name, xls::Function* ir_function,
+                       absl::Span<const std::vector<xls::Value>> ir_arg_sets);
 };
 
 // Optional arguments to ParseAndTest (that have sensible defaults).
@@ -95,6 +103,10 @@ class AbstractRunComparator {
 //   warnings_as_errors: Whether warnings should be reported as errors (i.e.
 //    cause the run routine to report failure when a warning is encountered).
 //   warnings: Set of warnings to enable for reporting.
+//   test_threads: If positive, unit tests (`#[test]` and `#[test_proc]`) are
+//    run concurrently on this many threads when the test runner supports it.
+//    Results, XML test cases and trace output are reported in declaration
+//    order regardless.
 struct ParseAndTestOptions {
   std::filesystem::path dslx_stdlib_path;
   absl::Span<const std::filesystem::path> dslx_paths;
@@ -108,6 +120,8 @@ struct ParseAndTestOptions {
   WarningKindSet warnings = kDefaultWarningsSet;
   bool trace_channels = false;
   std::optional<int64_t> max_ticks;
+  int64_t proc_threads = 0;
+  int64_t test_threads = 0;
 };
 
 // As above, but a subset of the options required for the ParseAndProve()
@@ -234,6 +248,10 @@ class AbstractParsedTestRunner {
       std::string_view name, const BytecodeInterpreterOptions& options) = 0;
   virtual absl::StatusOr<RunResult> RunTestFunction(
       std::string_view name, const BytecodeInterpreterOptions& options) = 0;
+
+  // Whether RunTestProc and RunTestFunction may be called concurrently from
+  // multiple threads.
+  virtual bool SupportsConcurrentTests() const { return false; }
 };
 
 class DslxInterpreterTestRunner final : public AbstractTestRunner {
@@ -258,6 +276,10 @@ class DslxInterpreterParsedTestRunner : public AbstractParsedTestRunner {
       std::string_view name,
       const BytecodeInterpreterOptions& options) override;
 
+  // Tests only read the shared module and type information, and bytecode is
+  // emitted through the import data's (thread-safe) bytecode cache.
+  bool SupportsConcurrentTests() const override { return true; }
+
  private:
   ImportData* import_data_;
   TypeInfo* type_info_;
@@ -283,7 +305,8 @@ struct QuickCheckResults {
 
 // JIT-compiles the given xls_function and invokes it with num_tests randomly
 // generated arguments -- returns `([argset, ...], [results, ...])` (i.e. in
-// structure-of-array style).
+// structure-of-array style). The arguments are evaluated in batches via
+// AbstractRunComparator::RunIrFunctionBatched.
 //
 // xls_function is a predicate we're trying to find evidence to falsify, so if
 // this finds an example that falsifies the predicate, we early-return (i.e. the
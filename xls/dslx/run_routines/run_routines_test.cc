@@ -30,6 +30,7 @@
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/run_routines/ir_test_runner.h"
 #include "xls/dslx/run_routines/run_comparator.h"
+#include "xls/dslx/run_routines/test_xml.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
@@ -69,6 +70,7 @@ MATCHER_P4(IsTestResult, result, ran_count, skipped_count, failed_count, "") {
 }
 
 using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 enum class RunnerType : int8_t {
@@ -415,6 +417,35 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// Samples are evaluated in batches, but the results still stop at the first
+// falsifying example.
+TEST(QuickcheckTest, StopsAtFirstFalsifyingExample) {
+  Package package("rarely_false");
+  std::string ir_text = R"(
+  fn ne_zero(x: bits[12]) -> bits[1] {
+    literal.2: bits[12] = literal(value=0)
+    ret ne.3: bits[1] = ne(x, literal.2)
+  }
+  )";
+  int64_t seed = 42;
+  int64_t num_tests = 100000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto quickcheck_info,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests));
+
+  const auto& [argsets, results] = quickcheck_info;
+  ASSERT_LT(results.size(), num_tests);
+  EXPECT_EQ(argsets.size(), results.size());
+  EXPECT_EQ(argsets.back(), std::vector<Value>{Value(UBits(0, 12))});
+  EXPECT_EQ(results.back(), Value(UBits(0, 1)));
+  for (int64_t i = 0; i + 1 < results.size(); ++i) {
+    EXPECT_EQ(results[i], Value(UBits(1, 1)));
+  }
+}
+
 TEST_P(ParseAndTestTest, DeadlockedProc) {
   // Test proc never sends to the subproc, so network is deadlocked.
   constexpr std::string_view kProgram = R"(
@@ -563,6 +594,42 @@ TEST_P(ParseAndTestTest, TestFilterSelectBoth) {
   EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 2, 0, 0));
 }
 
+TEST_P(ParseAndTestTest, ConcurrentTestsReportInOrder) {
+  constexpr std::string_view kProgram = R"(
+fn sum(n: u32) -> u32 {
+  for (i, acc): (u32, u32) in u32:0..n { acc + i }(u32:0)
+}
+
+#[test] fn test_a() { assert_eq(sum(u32:10), u32:45) }
+#[test] fn test_b() { assert_eq(sum(u32:4), u32:7) }
+#[test] fn test_c() { trace_fmt!("c: {}", sum(u32:3)); }
+#[test] fn skipped() {}
+#[test] fn test_d() { assert_eq(sum(u32:5), u32:11) }
+#[test] fn test_e() { assert_eq(sum(u32:100), u32:4950) }
+)";
+  const RE2 test_filter("test_.*");
+  ParseAndTestOptions options;
+  options.test_filter = &test_filter;
+  XLS_ASSERT_OK_AND_ASSIGN(TestResultData serial,
+                           ParseAndTest(kProgram, "test", "test.x", options));
+  options.test_threads = 4;
+  XLS_ASSERT_OK_AND_ASSIGN(TestResultData concurrent,
+                           ParseAndTest(kProgram, "test", "test.x", options));
+  EXPECT_THAT(serial, IsTestResult(TestResult::kSomeFailed, 6, 1, 2));
+  EXPECT_THAT(concurrent, IsTestResult(TestResult::kSomeFailed, 6, 1, 2));
+  EXPECT_EQ(concurrent.failures(), serial.failures());
+  auto names = [](const TestResultData& result) {
+    std::vector<std::string> names;
+    for (const test_xml::TestCase& test_case :
+         result.ToXmlSuites("test").test_suites.front().test_cases) {
+      names.push_back(test_case.name);
+    }
+    return names;
+  };
+  EXPECT_THAT(names(concurrent), ElementsAre("test_a", "test_b", "test_c",
+                                             "skipped", "test_d", "test_e"));
+}
+
 // Exercises https://github.com/google/xls/issues/1368
 TEST_P(ParseAndTestTest, StructParametricFromProcParametric) {
   constexpr std::string_view kProgram = R"(
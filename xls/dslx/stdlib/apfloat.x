@@ -1939,6 +1939,106 @@ fn or_last_bit<WIDTH: u32>(value: bits[WIDTH], lsb: u1) -> bits[WIDTH] {
     bit_slice_update(value, u1:0, (value[0:1] | lsb))
 }
 
+// Rounds (RNE) the normalized sum of `x` and `y` and packs it into the result, handling exponent
+// under/overflow as well as infinity and NaN operands. `shifted_fraction` holds the normalized
+// fraction (hidden bit included) followed by guard, round and sticky bits; `leading_zeroes` is
+// the exponent adjustment from normalization, offset by one (0 on carry, 1 if already normal).
+//
+// Shared by `add` and `add_two_path` so both produce bit-identical results.
+fn add_round_and_pack<EXP_SZ: u32, FRACTION_SZ: u32, NORMALIZED_FRACTION: u32, LZ_SZ: u32>
+    (x: APFloat<EXP_SZ, FRACTION_SZ>, y: APFloat<EXP_SZ, FRACTION_SZ>, result_sign: u1,
+     fraction_is_zero: bool, shifted_fraction: uN[NORMALIZED_FRACTION], leading_zeroes: uN[LZ_SZ])
+    -> APFloat<EXP_SZ, FRACTION_SZ> {
+    const WIDE_EXP: u32 = EXP_SZ + u32:1;
+    const CARRY_EXP: u32 = u32:1 + WIDE_EXP;
+    const GUARD_ROUND_STICKY_BITS = u32:3;
+    const WIDE_FRACTION: u32 = NORMALIZED_FRACTION + u32:1;
+    const_assert!(NORMALIZED_FRACTION == u32:1 + FRACTION_SZ + GUARD_ROUND_STICKY_BITS);
+
+    // Step 4: Rounding.
+    // Rounding down is a no-op, since we eventually have to shift off
+    // the extra precision bits, so we only need to be concerned with
+    // rounding up. We only support round to nearest, half to even
+    // mode. This means we round up if:
+    //  - The last three bits are greater than 1/2 way between
+    //    values, i.e., the last three bits are > 0b100.
+    //  - We're exactly 1/2 way between values (0b100) and bit 3 is 1
+    //    (i.e., 0x...1100). In other words, if we're "halfway", we round
+    //    in whichever direction makes the last bit in the fraction 0.
+    let normal_chunk = shifted_fraction[0:3];
+    let half_way_chunk = shifted_fraction[2:4];
+    let do_round_up = (normal_chunk > u3:0x4) || (half_way_chunk == u2:0x3);
+
+    // We again need an extra bit for carry.
+    let rounded_fraction = if do_round_up {
+        (shifted_fraction as uN[WIDE_FRACTION]) + uN[WIDE_FRACTION]:0x8
+    } else {
+        shifted_fraction as uN[WIDE_FRACTION]
+    };
+    let rounding_carry = rounded_fraction[-1:];
+
+    // After rounding, we can chop off the extra precision bits.
+    // As with normalization, if we carried, we need to shift right
+    // an extra place.
+    let fraction_shift =
+        GUARD_ROUND_STICKY_BITS as u3 + (if rounded_fraction[-1:] { u3:1 } else { u3:0 });
+    let result_fraction = (rounded_fraction >> fraction_shift) as uN[FRACTION_SZ];
+
+    // Finally, adjust the exponent based on addition and rounding -
+    // each bit of carry or cancellation moves it by one place.
+    let wide_exponent = (x.bexp as sN[CARRY_EXP]) + (rounding_carry as sN[CARRY_EXP]) +
+                        sN[CARRY_EXP]:1 - (leading_zeroes as sN[CARRY_EXP]);
+    let wide_exponent = if fraction_is_zero { sN[CARRY_EXP]:0 } else { wide_exponent };
+
+    // Chop off the sign bit.
+    let wide_exponent = if wide_exponent < sN[CARRY_EXP]:0 {
+        uN[WIDE_EXP]:0
+    } else {
+        wide_exponent as uN[WIDE_EXP]
+    };
+
+    // Extra bonus step 5: special case handling!
+
+    // If the exponent underflowed, don't bother with denormals. Just flush to 0.
+    let result_fraction =
+        if wide_exponent < uN[WIDE_EXP]:1 { uN[FRACTION_SZ]:0 } else { result_fraction };
+
+    // Handle exponent overflow infinities.
+    const MAX_EXPONENT = std::mask_bits<EXP_SZ>();
+    const SATURATED_EXPONENT = MAX_EXPONENT as uN[WIDE_EXP];
+    let result_fraction =
+        if wide_exponent < SATURATED_EXPONENT { result_fraction } else { uN[FRACTION_SZ]:0 };
+    let result_exponent =
+        if wide_exponent < SATURATED_EXPONENT { wide_exponent as uN[EXP_SZ] } else { MAX_EXPONENT };
+
+    // Handle arg infinities.
+    let is_operand_inf = is_inf<EXP_SZ, FRACTION_SZ>(x) || is_inf<EXP_SZ, FRACTION_SZ>(y);
+    let result_exponent = if is_operand_inf { MAX_EXPONENT } else { result_exponent };
+    let result_fraction = if is_operand_inf { uN[FRACTION_SZ]:0 } else { result_fraction };
+    // Result infinity is negative iff all infinite operands are neg.
+    let has_pos_inf = (is_inf<EXP_SZ, FRACTION_SZ>(x) && (x.sign == u1:0)) ||
+                      (is_inf<EXP_SZ, FRACTION_SZ>(y) && (y.sign == u1:0));
+    let result_sign = if is_operand_inf { !has_pos_inf } else { result_sign };
+
+    // Handle NaN; NaN trumps infinities, so we handle it last.
+    // -inf + inf = NaN, i.e., if we have both positive and negative inf.
+    let has_neg_inf = (is_inf<EXP_SZ, FRACTION_SZ>(x) && (x.sign == u1:1)) ||
+                      (is_inf<EXP_SZ, FRACTION_SZ>(y) && (y.sign == u1:1));
+    let is_result_nan = is_nan<EXP_SZ, FRACTION_SZ>(x) || is_nan<EXP_SZ, FRACTION_SZ>(y) ||
+                        (has_pos_inf && has_neg_inf);
+    const FRACTION_HIGH_BIT = uN[FRACTION_SZ]:1 << (FRACTION_SZ - u32:1);
+    let result_exponent = if is_result_nan { MAX_EXPONENT } else { result_exponent };
+    let result_fraction = if is_result_nan { FRACTION_HIGH_BIT } else { result_fraction };
+    let result_sign = if is_result_nan { u1:0 } else { result_sign };
+
+    // Finally (finally!), construct the output float.
+    APFloat<EXP_SZ, FRACTION_SZ> {
+        sign: result_sign,
+        bexp: result_exponent,
+        fraction: result_fraction as uN[FRACTION_SZ],
+    }
+}
+
 // Floating point addition based on a generalization of IEEE 754 single-precision floating-point
 // addition, with the following exceptions:
 //  - Both input and output denormals are treated as/flushed to 0.
@@ -1953,11 +2053,6 @@ fn or_last_bit<WIDTH: u32>(value: bits[WIDTH], lsb: u1) -> bits[WIDTH] {
 pub fn add<EXP_SZ: u32, FRACTION_SZ: u32>
     (a: APFloat<EXP_SZ, FRACTION_SZ>, b: APFloat<EXP_SZ, FRACTION_SZ>)
     -> APFloat<EXP_SZ, FRACTION_SZ> {
-    // WIDE_EXP: Widened exponent to capture a possible carry bit.
-    const WIDE_EXP: u32 = EXP_SZ + u32:1;
-    // CARRY_EXP: WIDE_EXP plus one sign bit.
-    const CARRY_EXP: u32 = u32:1 + WIDE_EXP;
-
     // WIDE_FRACTION: Widened fraction to contain full precision + rounding
     // (sign, hidden as well as guard, round, sticky) bits.
     const SIGN_BIT = u32:1;
@@ -2031,88 +2126,157 @@ pub fn add<EXP_SZ: u32, FRACTION_SZ: u32>
     let cancel_fraction = (cancel_fraction >> u32:1) as uN[NORMALIZED_FRACTION];
     let shifted_fraction = if carry_bit { carry_fraction } else { cancel_fraction };
 
-    // Step 4: Rounding.
-    // Rounding down is a no-op, since we eventually have to shift off
-    // the extra precision bits, so we only need to be concerned with
-    // rounding up. We only support round to nearest, half to even
-    // mode. This means we round up if:
-    //  - The last three bits are greater than 1/2 way between
-    //    values, i.e., the last three bits are > 0b100.
-    //  - We're exactly 1/2 way between values (0b100) and bit 3 is 1
-    //    (i.e., 0x...1100). In other words, if we're "halfway", we round
-    //    in whichever direction makes the last bit in the fraction 0.
-    let normal_chunk = shifted_fraction[0:3];
-    let half_way_chunk = shifted_fraction[2:4];
-    let do_round_up = (normal_chunk > u3:0x4) || (half_way_chunk == u2:0x3);
+    add_round_and_pack(x, y, result_sign, fraction_is_zero, shifted_fraction, leading_zeroes)
+}
 
-    // We again need an extra bit for carry.
-    let rounded_fraction = if do_round_up {
-        (shifted_fraction as uN[WIDE_FRACTION]) + uN[WIDE_FRACTION]:0x8
-    } else {
-        shifted_fraction as uN[WIDE_FRACTION]
-    };
-    let rounding_carry = rounded_fraction[-1:];
+// Leading-zero anticipation for the difference `a - b` of two magnitudes with `a > b`. The
+// indicator is computed from the operands alone, so counting its leading zeroes can run in
+// parallel with the subtraction itself. Its leading one is either at the position of the leading
+// one of `a - b` or one place above it, i.e., `clz(lza(a, b))` under-counts the leading zeroes of
+// the difference by at most one.
+fn lza<WIDTH: u32>(a: uN[WIDTH], b: uN[WIDTH]) -> uN[WIDTH] {
+    !(a ^ b) ^ (((a | !b) << u32:1) | uN[WIDTH]:1)
+}
 
-    // After rounding, we can chop off the extra precision bits.
-    // As with normalization, if we carried, we need to shift right
-    // an extra place.
-    let fraction_shift =
-        GUARD_ROUND_STICKY_BITS as u3 + (if rounded_fraction[-1:] { u3:1 } else { u3:0 });
-    let result_fraction = (rounded_fraction >> fraction_shift) as uN[FRACTION_SZ];
+#[test]
+fn lza_test() {
+    // Exact anticipation.
+    assert_eq(std::clzt(lza(u8:0b1000_0000, u8:0b0100_0000)), u4:1);
+    assert_eq(std::clzt(lza(u8:0b1000_0000, u8:0b0111_1111)), u4:7);
+    // Under-counts by one: 0b0000_1000 - 0b0000_0001 == 0b0000_0111.
+    assert_eq(std::clzt(lza(u8:0b0000_1000, u8:0b0000_0001)), u4:4);
+}
 
-    // Finally, adjust the exponent based on addition and rounding -
-    // each bit of carry or cancellation moves it by one place.
-    let wide_exponent = (x.bexp as sN[CARRY_EXP]) + (rounding_carry as sN[CARRY_EXP]) +
-                        sN[CARRY_EXP]:1 - (leading_zeroes as sN[CARRY_EXP]);
-    let wide_exponent = if fraction_is_zero { sN[CARRY_EXP]:0 } else { wide_exponent };
+#[quickcheck]
+fn lza_off_by_at_most_one(a: u8, b: u8) -> bool {
+    let (x, y) = if a > b { (a, b) } else { (b, a) };
+    let anticipated = std::clzt(lza(x, y));
+    let actual = std::clzt(x - y);
+    a == b || anticipated == actual || anticipated + u4:1 == actual
+}
+
+// Floating point addition with the same semantics as (and bit-identical results to) `add`, but
+// structured as the classic two-path adder for pipelined, throughput-oriented designs:
+//  - The far path handles effective additions and subtractions whose exponents differ by more
+//    than one. It needs the full alignment shifter, but at most one bit can cancel, so
+//    normalization is a fixed 0, 1 or 2 bit shift.
+//  - The near path handles effective subtractions whose exponents differ by at most one. Its
+//    alignment is a one bit shift, but arbitrarily many bits can cancel; the normalization amount
+//    is anticipated from the operands (see `lza`) in parallel with the subtraction and corrected
+//    by at most one place afterwards.
+// Neither path chains a wide shifter after another, which shortens the critical path compared to
+// `add` at the cost of some area. Rounding and special case handling are shared with `add`.
+pub fn add_two_path<EXP_SZ: u32, FRACTION_SZ: u32>
+    (a: APFloat<EXP_SZ, FRACTION_SZ>, b: APFloat<EXP_SZ, FRACTION_SZ>)
+    -> APFloat<EXP_SZ, FRACTION_SZ> {
+    const HIDDEN_BIT = u32:1;
+    const CARRY_BIT = u32:1;
+    const GUARD_ROUND_STICKY_BITS = u32:3;
+    const FRACTION = HIDDEN_BIT + FRACTION_SZ;
+    // WIDE_FRACTION: full precision + guard, round and sticky bits, plus one bit to capture the
+    // carry of an effective addition.
+    const WIDE_FRACTION: u32 = CARRY_BIT + FRACTION + GUARD_ROUND_STICKY_BITS;
+    // NORMALIZED_FRACTION: WIDE_FRACTION minus the carry bit after normalization.
+    const NORMALIZED_FRACTION: u32 = WIDE_FRACTION - u32:1;
+    const LEADING_ZEROES_SZ: u32 = std::clog2(WIDE_FRACTION + u32:1);
 
-    // Chop off the sign bit.
-    let wide_exponent = if wide_exponent < sN[CARRY_EXP]:0 {
-        uN[WIDE_EXP]:0
-    } else {
-        wide_exponent as uN[WIDE_EXP]
-    };
+    // Operand swap and denormal flushing are the same as in `add`.
+    let (a_is_smaller, shift) = sign_magnitude_difference(a.bexp, b.bexp);
+    let (x, y) = if a_is_smaller { (b, a) } else { (a, b) };
 
-    // Extra bonus step 5: special case handling!
+    let fraction_x = (u1:1 ++ x.fraction) as uN[FRACTION];
+    let fraction_y = (u1:1 ++ y.fraction) as uN[FRACTION];
+    let fraction_x = if x.bexp == uN[EXP_SZ]:0 { uN[FRACTION]:0 } else { fraction_x };
+    let fraction_y = if y.bexp == uN[EXP_SZ]:0 { uN[FRACTION]:0 } else { fraction_y };
 
-    // If the exponent underflowed, don't bother with denormals. Just flush to 0.
-    let result_fraction =
-        if wide_exponent < uN[WIDE_EXP]:1 { uN[FRACTION_SZ]:0 } else { result_fraction };
+    let wide_x = fraction_x as uN[WIDE_FRACTION] << GUARD_ROUND_STICKY_BITS;
+    let wide_y = fraction_y as uN[WIDE_FRACTION] << GUARD_ROUND_STICKY_BITS;
+    let is_subtraction = x.sign != y.sign;
+    let use_near_path = is_subtraction && shift <= uN[EXP_SZ]:1;
 
-    // Handle exponent overflow infinities.
-    const MAX_EXPONENT = std::mask_bits<EXP_SZ>();
-    const SATURATED_EXPONENT = MAX_EXPONENT as uN[WIDE_EXP];
-    let result_fraction =
-        if wide_exponent < SATURATED_EXPONENT { result_fraction } else { uN[FRACTION_SZ]:0 };
-    let result_exponent =
-        if wide_exponent < SATURATED_EXPONENT { wide_exponent as uN[EXP_SZ] } else { MAX_EXPONENT };
+    // Far path. x has the larger magnitude here, so the difference is never negative.
+    let sticky = std::or_reduce_lsb(wide_y, shift);
+    let aligned_y = or_last_bit(wide_y >> shift, sticky);
+    let far_fraction = if is_subtraction { wide_x - aligned_y } else { wide_x + aligned_y };
+    let far_is_zero = far_fraction == uN[WIDE_FRACTION]:0;
+    let far_sign = if far_is_zero { x.sign && y.sign } else { x.sign };
+
+    let far_carry = far_fraction[-1:];
+    let far_is_normal = far_fraction[-2:-1];
+    let far_leading_zeroes = if far_carry {
+        uN[LEADING_ZEROES_SZ]:0
+    } else if far_is_normal {
+        uN[LEADING_ZEROES_SZ]:1
+    } else {
+        uN[LEADING_ZEROES_SZ]:2
+    };
+    let far_shifted = if far_carry {
+        // Don't drop the sticky bit.
+        or_last_bit((far_fraction >> u32:1) as uN[NORMALIZED_FRACTION], far_fraction[0:1])
+    } else if far_is_normal {
+        far_fraction as uN[NORMALIZED_FRACTION]
+    } else {
+        (far_fraction << u32:1) as uN[NORMALIZED_FRACTION]
+    };
 
-    // Handle arg infinities.
-    let is_operand_inf = is_inf<EXP_SZ, FRACTION_SZ>(x) || is_inf<EXP_SZ, FRACTION_SZ>(y);
-    let result_exponent = if is_operand_inf { MAX_EXPONENT } else { result_exponent };
-    let result_fraction = if is_operand_inf { uN[FRACTION_SZ]:0 } else { result_fraction };
-    // Result infinity is negative iff all infinite operands are neg.
-    let has_pos_inf = (is_inf<EXP_SZ, FRACTION_SZ>(x) && (x.sign == u1:0)) ||
-                      (is_inf<EXP_SZ, FRACTION_SZ>(y) && (y.sign == u1:0));
-    let result_sign = if is_operand_inf { !has_pos_inf } else { result_sign };
+    // Near path. A one bit alignment shift only drops a zero guard bit, so no sticky is needed.
+    let near_y = wide_y >> shift[0:1];
+    let (x_is_smaller, near_fraction) = sign_magnitude_difference(wide_x, near_y);
+    let near_is_zero = near_fraction == uN[WIDE_FRACTION]:0;
+    // x - x is +0.0 in round-to-nearest.
+    let near_sign = if near_is_zero { u1:0 } else if x_is_smaller { y.sign } else { x.sign };
+
+    let anticipated = if x_is_smaller { lza(near_y, wide_x) } else { lza(wide_x, near_y) };
+    let anticipated_zeroes = std::clzt(anticipated);
+    let near_shifted = near_fraction << anticipated_zeroes;
+    // Fix up a one place under-count of the anticipated leading zeroes.
+    let correction = !near_shifted[-1:];
+    let near_shifted = near_shifted << correction;
+    let near_leading_zeroes = anticipated_zeroes + (correction as uN[LEADING_ZEROES_SZ]);
+    let near_shifted = (near_shifted >> u32:1) as uN[NORMALIZED_FRACTION];
+
+    let (result_sign, fraction_is_zero, shifted_fraction, leading_zeroes) = if use_near_path {
+        (near_sign, near_is_zero, near_shifted, near_leading_zeroes)
+    } else {
+        (far_sign, far_is_zero, far_shifted, far_leading_zeroes)
+    };
+    add_round_and_pack(x, y, result_sign, fraction_is_zero, shifted_fraction, leading_zeroes)
+}
 
-    // Handle NaN; NaN trumps infinities, so we handle it last.
-    // -inf + inf = NaN, i.e., if we have both positive and negative inf.
-    let has_neg_inf = (is_inf<EXP_SZ, FRACTION_SZ>(x) && (x.sign == u1:1)) ||
-                      (is_inf<EXP_SZ, FRACTION_SZ>(y) && (y.sign == u1:1));
-    let is_result_nan = is_nan<EXP_SZ, FRACTION_SZ>(x) || is_nan<EXP_SZ, FRACTION_SZ>(y) ||
-                        (has_pos_inf && has_neg_inf);
-    const FRACTION_HIGH_BIT = uN[FRACTION_SZ]:1 << (FRACTION_SZ - u32:1);
-    let result_exponent = if is_result_nan { MAX_EXPONENT } else { result_exponent };
-    let result_fraction = if is_result_nan { FRACTION_HIGH_BIT } else { result_fraction };
-    let result_sign = if is_result_nan { u1:0 } else { result_sign };
+#[test]
+fn add_two_path_test() {
+    type F32 = APFloat<u32:8, u32:23>;
+    let one = one<u32:8, u32:23>(u1:0);
+    let two = add(one, one);
+    assert_eq(add_two_path(one, one), two);
+    assert_eq(add_two_path(two, F32 { sign: u1:1, ..one }), one);
+
+    // Near path with massive cancellation: 1.0 - (1.0 - 2^-24) == 2^-24.
+    let below_one = F32 { sign: u1:1, bexp: u8:126, fraction: u23:0x7fffff };
+    let expected = F32 { sign: u1:0, bexp: u8:103, fraction: u23:0 };
+    assert_eq(add_two_path(one, below_one), expected);
+    assert_eq(add_two_path(below_one, one), expected);
+    assert_eq(add(one, below_one), expected);
+
+    // Exact cancellation is +0.0.
+    assert_eq(add_two_path(F32 { sign: u1:1, ..one }, one), zero<u32:8, u32:23>(u1:0));
+
+    // Far path subtraction with rounding: 2^30 - 1.0 rounds back to 2^30.
+    let big = F32 { sign: u1:0, bexp: u8:157, fraction: u23:0 };
+    assert_eq(add_two_path(big, F32 { sign: u1:1, ..one }), big);
+    assert_eq(add_two_path(big, F32 { sign: u1:1, ..one }), add(big, F32 { sign: u1:1, ..one }));
+
+    // Special values.
+    let inf = inf<u32:8, u32:23>(u1:0);
+    assert_eq(add_two_path(inf, F32 { sign: u1:1, ..inf }), qnan<u32:8, u32:23>());
+    assert_eq(add_two_path(inf, one), inf);
+}
 
-    // Finally (finally!), construct the output float.
-    APFloat<EXP_SZ, FRACTION_SZ> {
-        sign: result_sign,
-        bexp: result_exponent,
-        fraction: result_fraction as uN[FRACTION_SZ],
-    }
+#[quickcheck]
+fn add_two_path_matches_add(a: u8, b: u8) -> bool {
+    let a = unflatten<u32:4, u32:3>(a);
+    let b = unflatten<u32:4, u32:3>(b);
+    add_two_path(a, b) == add(a, b)
 }
 
 // IEEE floating-point subtraction (and comparisons that are implemented using subtraction),
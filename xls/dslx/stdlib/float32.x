@@ -312,6 +312,10 @@ fn from_int32_test() {
 
 pub fn add(x: F32, y: F32) -> F32 { apfloat::add(x, y) }
 
+// Bit-identical to `add`, structured as a near/far two-path adder with a
+// shorter critical path; see `apfloat::add_two_path`.
+pub fn add_two_path(x: F32, y: F32) -> F32 { apfloat::add_two_path(x, y) }
+
 pub fn sub(x: F32, y: F32) -> F32 { apfloat::sub(x, y) }
 
 pub fn mul(x: F32, y: F32) -> F32 { apfloat::mul(x, y) }
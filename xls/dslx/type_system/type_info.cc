@@ -145,6 +145,13 @@ absl::StatusOr<TypeInfo*> TypeInfoOwner::New(Module* module, TypeInfo* parent) {
   return result;
 }
 
+void TypeInfoOwner::Release(const Module* module) {
+  module_to_root_.erase(module);
+  std::erase_if(type_infos_, [&](const std::unique_ptr<TypeInfo>& type_info) {
+    return type_info->module() == module;
+  });
+}
+
 absl::StatusOr<TypeInfo*> TypeInfoOwner::GetRootTypeInfo(const Module* module) {
   auto it = module_to_root_.find(module);
   if (it == module_to_root_.end()) {
@@ -435,6 +442,25 @@ absl::Status TypeInfo::AddInvocationTypeInfo(const Invocation& invocation,
       caller_env, InvocationCalleeData{callee_env, derived_type_info});
 }
 
+void TypeInfo::NoteInstantiationTypeInfo(const Function& f,
+                                         const ParametricEnv& env,
+                                         TypeInfo* derived_type_info) {
+  CHECK_EQ(f.owner(), module_);
+  TypeInfo* top = GetRoot();
+  top->instantiations_.insert_or_assign(std::make_pair(&f, env),
+                                        derived_type_info);
+}
+
+std::optional<TypeInfo*> TypeInfo::GetInstantiationTypeInfo(
+    const Function& f, const ParametricEnv& env) const {
+  const TypeInfo* top = GetRoot();
+  auto it = top->instantiations_.find(std::make_pair(&f, env));
+  if (it == top->instantiations_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
 std::optional<bool> TypeInfo::GetRequiresImplicitToken(
     const Function& f) const {
   CHECK_EQ(f.owner(), module_) << "function owner: " << f.owner()->name()
@@ -21,6 +21,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -136,6 +137,10 @@ class TypeInfoOwner {
   // status error if it is not present.
   absl::StatusOr<TypeInfo*> GetRootTypeInfo(const Module* module);
 
+  // Destroys all the type information for the given module, e.g. because the
+  // module is about to be destroyed.
+  void Release(const Module* module);
+
  private:
   // Mapping from module to the "root" (or "parentmost") type info -- these have
   // nullptr as their parent. There should only be one of these for any given
@@ -198,6 +203,18 @@ class TypeInfo {
   absl::StatusOr<TypeInfo*> GetInvocationTypeInfoOrError(
       const Invocation* invocation, const ParametricEnv& caller) const;
 
+  // Notes that `derived_type_info` holds the deduced body of `f` instantiated
+  // with the parametric bindings `env`, so that later invocations with the same
+  // bindings can reuse it instead of re-deducing the body. Recorded on the
+  // module root TypeInfo.
+  void NoteInstantiationTypeInfo(const Function& f, const ParametricEnv& env,
+                                 TypeInfo* derived_type_info);
+
+  // Retrieves the type information noted above for `f` instantiated with
+  // `env`, if any.
+  std::optional<TypeInfo*> GetInstantiationTypeInfo(
+      const Function& f, const ParametricEnv& env) const;
+
   // Sets the type info for the given proc when typechecked at top-level (i.e.,
   // not via an instantiation). Can only be called on the module root TypeInfo.
   absl::Status SetTopLevelProcTypeInfo(const Proc* p, TypeInfo* ti);
@@ -392,6 +409,8 @@ class TypeInfo {
   absl::flat_hash_map<const Invocation*, InvocationData> invocations_;
   absl::flat_hash_map<Slice*, SliceData> slices_;
   absl::flat_hash_map<const Function*, bool> requires_implicit_token_;
+  absl::flat_hash_map<std::pair<const Function*, ParametricEnv>, TypeInfo*>
+      instantiations_;
 
   // Maps a Proc to the TypeInfo used for its top-level typechecking.
   absl::flat_hash_map<const Proc*, TypeInfo*> top_level_proc_type_info_;
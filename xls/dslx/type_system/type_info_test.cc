@@ -14,8 +14,10 @@
 
 #include "xls/dslx/type_system/type_info.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <variant>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -89,5 +91,41 @@ fn main() -> u32 {
                                  "present in parametric keys: {}")));
 }
 
+// Invocations which instantiate a parametric function with the same bindings
+// share the type information deduced for its body.
+TEST(TypeInfoTest, RepeatedInstantiationsShareTypeInfo) {
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(TypecheckedModule tm,
+                           ParseAndTypecheck(R"(
+fn p<X: u32, Y: u32>() -> u32 {
+  X+Y
+}
+
+fn main() -> u32 {
+  let a = p<u32:2, u32:3>();
+  let b = p<u32:2, u32:3>();
+  let c = p<u32:2, u32:4>();
+  a + b + c
+})",
+                                             "test.x", "test", &import_data));
+
+  Function* main = tm.module->GetFunctionByName().at("main");
+  auto get_invocation_type_info = [&](int64_t index) -> TypeInfo* {
+    const Let* let =
+        std::get<Let*>(main->body()->statements().at(index)->wrapped());
+    std::optional<TypeInfo*> ti = tm.type_info->GetInvocationTypeInfo(
+        down_cast<const Invocation*>(let->rhs()), ParametricEnv());
+    return ti.value_or(nullptr);
+  };
+
+  TypeInfo* a = get_invocation_type_info(0);
+  TypeInfo* b = get_invocation_type_info(1);
+  TypeInfo* c = get_invocation_type_info(2);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(c, nullptr);
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -423,9 +423,31 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
   parent_ctx->type_info()->SetItem(invocation->callee(), instantiated_ft);
   ctx->type_info()->SetItem(callee_fn->name_def(), instantiated_ft);
 
+  TypeInfo* const original_ti = parent_ctx->type_info();
+
+  // The body of a function only depends on its parametric bindings, so if it
+  // was already deduced under the same bindings (from any call site or module)
+  // we reuse that type information. Procs and invocations with constexpr
+  // arguments need their own TypeInfo for their constexpr values.
+  const bool memoizable =
+      !callee_fn->proc().has_value() && constexpr_env.empty();
+  if (memoizable) {
+    if (std::optional<TypeInfo*> memoized =
+            ctx->type_info()->GetInstantiationTypeInfo(
+                *callee_fn, callee_tab.parametric_env);
+        memoized.has_value()) {
+      VLOG(5) << "Reusing type info for instantiation of `"
+              << callee_fn->identifier()
+              << "` with env: " << callee_tab.parametric_env.ToString();
+      XLS_RETURN_IF_ERROR(original_ti->AddInvocationTypeInfo(
+          *invocation, caller, caller_parametric_env,
+          callee_tab.parametric_env, *memoized));
+      return callee_tab;
+    }
+  }
+
   // We need to deduce fn body, so we're going to call Deduce, which means we'll
   // need a new stack entry w/the new symbolic bindings.
-  TypeInfo* const original_ti = parent_ctx->type_info();
   ctx->AddFnStackEntry(FnStackEntry::Make(
       *callee_fn, callee_tab.parametric_env, invocation,
       callee_fn->proc().has_value() ? WithinProc::kYes : WithinProc::kNo));
@@ -519,6 +541,10 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
 
   XLS_RETURN_IF_ERROR(ctx->PopDerivedTypeInfo(derived_type_info));
   ctx->PopFnStackEntry();
+  if (memoizable) {
+    ctx->type_info()->NoteInstantiationTypeInfo(
+        *callee_fn, callee_tab.parametric_env, derived_type_info);
+  }
 
   // Implementation note: though we could have all functions have
   // NoteRequiresImplicitToken() be false unless otherwise noted, this helps
@@ -343,12 +343,22 @@ class InferenceTableConverter {
             "on at least one side of its assignment.",
             node->parent()->ToString(), node_span->ToString(file_table_)));
       }
-      XLS_ASSIGN_OR_RETURN(annotation,
-                           UnifyTypeAnnotations(parametric_invocation,
-                                                *type_variable, *node_span));
-    } else {
-      annotation = table_.GetTypeAnnotation(node);
+      // All nodes sharing a type variable in the same invocation get the same
+      // concrete type, so it is only unified and concretized for the first.
+      const VariableKey key(parametric_invocation,
+                            ToAstNode((*type_variable)->name_def()));
+      auto it = concrete_type_variables_.find(key);
+      if (it == concrete_type_variables_.end()) {
+        XLS_ASSIGN_OR_RETURN(annotation,
+                             UnifyTypeAnnotations(parametric_invocation,
+                                                  *type_variable, *node_span));
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> type,
+                             Concretize(*annotation, parametric_invocation));
+        it = concrete_type_variables_.emplace(key, std::move(type)).first;
+      }
+      return SetConcreteType(ti, node, it->second->CloneToUnique());
     }
+    annotation = table_.GetTypeAnnotation(node);
     if (!annotation.has_value()) {
       // The caller may have passed a node that is in the AST but not in the
       // table, and it may not be needed in the table.
@@ -357,6 +367,21 @@ class InferenceTableConverter {
     }
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> type,
                          Concretize(*annotation, parametric_invocation));
+    return SetConcreteType(ti, node, std::move(type));
+  }
+
+  // Returns the resulting base type info for the entire conversion.
+  TypeInfo* GetBaseTypeInfo() { return base_type_info_; }
+
+ private:
+  // Identifies a type variable in the context of a particular invocation.
+  using VariableKey =
+      std::pair<std::optional<const ParametricInvocation*>, const AstNode*>;
+
+  // Validates the concrete `type` of `node` and records it in `ti`, along with
+  // the value of `node` if it is a constant.
+  absl::Status SetConcreteType(TypeInfo* ti, const AstNode* node,
+                               std::unique_ptr<Type> type) {
     XLS_RETURN_IF_ERROR(ValidateConcreteTypeForNode(node, type.get()));
     if (const auto* literal = dynamic_cast<const Number*>(node);
         literal != nullptr && literal->type_annotation() != nullptr) {
@@ -381,10 +406,6 @@ class InferenceTableConverter {
     return absl::OkStatus();
   }
 
-  // Returns the resulting base type info for the entire conversion.
-  TypeInfo* GetBaseTypeInfo() { return base_type_info_; }
-
- private:
   // Converts the given type annotation to a concrete `Type`, either statically
   // or in the context of a parametric invocation.
   absl::StatusOr<std::unique_ptr<Type>> Concretize(
@@ -558,6 +579,18 @@ class InferenceTableConverter {
   absl::StatusOr<const TypeAnnotation*> UnifyTypeAnnotations(
       std::optional<const ParametricInvocation*> parametric_invocation,
       const NameRef* type_variable, const Span& span) {
+    // The unification of a variable is reused for every reference to it with
+    // the same span, which is typically every `var:` annotation referring to
+    // it. Without this, a chain of constants where each refers to the previous
+    // one more than once would be unified an exponential number of times.
+    std::vector<std::pair<Span, const TypeAnnotation*>>& cached =
+        resolved_type_variables_[VariableKey(
+            parametric_invocation, ToAstNode(type_variable->name_def()))];
+    for (const auto& [cached_span, cached_annotation] : cached) {
+      if (cached_span == span) {
+        return cached_annotation;
+      }
+    }
     VLOG(5) << "Unifying type annotations for variable "
             << type_variable->ToString();
     XLS_ASSIGN_OR_RETURN(
@@ -568,6 +601,11 @@ class InferenceTableConverter {
         UnifyTypeAnnotations(parametric_invocation, annotations, span));
     VLOG(5) << "Unified type for variable " << type_variable->ToString() << ": "
             << result->ToString();
+    // Note that the recursive unification may have added entries to the map,
+    // invalidating `cached`.
+    resolved_type_variables_[VariableKey(parametric_invocation,
+                                         ToAstNode(type_variable->name_def()))]
+        .emplace_back(span, result);
     return result;
   }
 
@@ -943,6 +981,15 @@ class InferenceTableConverter {
       invocation_type_info_;
   absl::flat_hash_map<const ParametricInvocation*, ParametricEnv>
       converted_parametric_envs_;
+  // Successful unifications of type variables per invocation, along with the
+  // span requested for each one, since it ends up in the unified annotation.
+  absl::flat_hash_map<VariableKey,
+                      std::vector<std::pair<Span, const TypeAnnotation*>>>
+      resolved_type_variables_;
+  // The concrete type of the nodes governed by each type variable per
+  // invocation.
+  absl::flat_hash_map<VariableKey, std::unique_ptr<Type>>
+      concrete_type_variables_;
   absl::flat_hash_set<const TypeAnnotation*> auto_literal_annotations_;
   // For annotations that are present in here, any `Expr` in the annotation must
   // be treated as an `InvocationScopedExpr` scoped to the invocation specified
@@ -12,9 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
@@ -364,6 +366,31 @@ const Z = Y;
                     HasSubstr("node: `const Z = Y;`, type: sN[20]")));
 }
 
+// Generates a chain of `count` constants, each referring to the previous one
+// twice, e.g.:
+//   const X0 = u32:1;
+//   const X1 = X0 + X0;
+//   const X2 = X1 + X1;
+std::string GenerateConstantChain(int64_t count) {
+  std::string program = "const X0 = u32:1;\n";
+  for (int64_t i = 1; i < count; ++i) {
+    absl::StrAppend(&program, absl::Substitute("const X$0 = X$1 + X$1;\n", i,
+                                               i - 1));
+  }
+  return program;
+}
+
+TEST(TypecheckV2Test, GlobalIntegerConstantWithManyLevelsOfReferences) {
+  // Each level doubles the number of paths to `X0`, so this is only feasible
+  // if the unification of each variable is reused.
+  XLS_ASSERT_OK_AND_ASSIGN(TypecheckResult result,
+                           TypecheckV2(GenerateConstantChain(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string type_info_string,
+                           TypeInfoToString(result.tm));
+  EXPECT_THAT(type_info_string,
+              HasSubstr("node: `const X63 = X62 + X62;`, type: uN[32]"));
+}
+
 TEST(TypecheckV2Test, GlobalBoolConstantWithNoTypeAnnotations) {
   EXPECT_THAT("const X = true;", TopNodeHasType("uN[1]"));
 }
@@ -1149,5 +1176,24 @@ const Z = bar<X>(u3:1 + Y);
             HasSubstr("node: `const Z = bar<X>(u3:1 + Y);`, type: uN[3]")));
 }
 
+void BM_TypecheckConstantChain(benchmark::State& state) {
+  std::string program = GenerateConstantChain(state.range(0));
+  for (auto _ : state) {
+    XLS_ASSERT_OK_AND_ASSIGN(TypecheckResult result, Typecheck(program));
+    benchmark::DoNotOptimize(result.tm.type_info);
+  }
+}
+
+void BM_TypecheckV2ConstantChain(benchmark::State& state) {
+  std::string program = GenerateConstantChain(state.range(0));
+  for (auto _ : state) {
+    XLS_ASSERT_OK_AND_ASSIGN(TypecheckResult result, TypecheckV2(program));
+    benchmark::DoNotOptimize(result.tm.type_info);
+  }
+}
+
+BENCHMARK(BM_TypecheckConstantChain)->Range(8, 1024);
+BENCHMARK(BM_TypecheckV2ConstantChain)->Range(8, 1024);
+
 }  // namespace
 }  // namespace xls::dslx
@@ -0,0 +1,482 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/eco/ir_diff_engine.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/eco/ir_patch.pb.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/xls_value.pb.h"
+
+namespace xls {
+namespace {
+
+// Returns a hash of the attributes which must be equal for two nodes to be
+// matched. Equal hashes are confirmed with AttributesMatch.
+uint64_t AttributeHash(const Node* node) {
+  std::string key = absl::StrCat(OpToString(node->op()), " ",
+                                 node->GetType()->ToString());
+  for (const Node* operand : node->operands()) {
+    absl::StrAppend(&key, " ", operand->GetType()->ToString());
+  }
+  if (node->Is<Literal>()) {
+    absl::StrAppend(&key, " ", node->As<Literal>()->value().ToString());
+  }
+  return absl::HashOf(key);
+}
+
+// Returns true if 'a' may be substituted for 'b' at no cost, i.e. the nodes
+// differ at most in their names and operands.
+bool AttributesMatch(const Node* a, const Node* b) {
+  if (!OpIsSideEffecting(a->op())) {
+    return a->IsDefinitelyEqualTo(b);
+  }
+  // IsDefinitelyEqualTo never equates distinct side-effecting nodes.
+  if (a->op() != b->op() || !a->GetType()->IsEqualTo(b->GetType()) ||
+      a->operand_count() != b->operand_count()) {
+    return false;
+  }
+  for (int64_t i = 0; i < a->operand_count(); ++i) {
+    if (!a->operand(i)->GetType()->IsEqualTo(b->operand(i)->GetType())) {
+      return false;
+    }
+  }
+  if (a->Is<ChannelNode>()) {
+    return a->As<ChannelNode>()->channel_name() ==
+           b->As<ChannelNode>()->channel_name();
+  }
+  return true;
+}
+
+// Fills 'proto' with the attributes of 'node' in the same form as
+// IrPatch._export_pb_node_attributes in ir_patch_gen.py.
+absl::Status NodeToProto(const Node* node, xls_eco::NodeProto* proto) {
+  proto->set_id(node->id());
+  proto->set_op(OpToString(node->op()));
+  proto->set_name(node->GetName());
+  *proto->mutable_data_type() = node->GetType()->ToProto();
+  for (const Node* operand : node->operands()) {
+    *proto->add_operand_data_types() = operand->GetType()->ToProto();
+  }
+  switch (node->op()) {
+    case Op::kLiteral: {
+      XLS_ASSIGN_OR_RETURN(*proto->add_unique_args()->mutable_value(),
+                           node->As<Literal>()->value().AsProto());
+      break;
+    }
+    case Op::kBitSlice:
+      proto->add_unique_args()->set_start(node->As<BitSlice>()->start());
+      break;
+    case Op::kTupleIndex:
+      proto->add_unique_args()->set_index(node->As<TupleIndex>()->index());
+      break;
+    case Op::kOneHot:
+      proto->add_unique_args()->set_lsb_prio(node->As<OneHot>()->priority() ==
+                                             LsbOrMsb::kLsb);
+      break;
+    case Op::kSignExt:
+    case Op::kZeroExt:
+      proto->add_unique_args()->set_new_bit_count(
+          node->As<ExtendOp>()->new_bit_count());
+      break;
+    case Op::kSel:
+      proto->add_unique_args()->set_has_default_value(
+          node->As<Select>()->default_value().has_value());
+      break;
+    case Op::kReceive:
+      proto->add_unique_args()->set_channel(
+          node->As<Receive>()->channel_name());
+      proto->add_unique_args()->set_blocking(
+          node->As<Receive>()->is_blocking());
+      break;
+    case Op::kSend:
+      proto->add_unique_args()->set_channel(node->As<Send>()->channel_name());
+      break;
+    default:
+      break;
+  }
+  return absl::OkStatus();
+}
+
+void EdgeToProto(const Node* from, const Node* to, int64_t index,
+                 xls_eco::EdgeProto* proto) {
+  proto->set_from_node(from->GetName());
+  proto->set_to_node(to->GetName());
+  proto->set_index(index);
+}
+
+// Builds a one-to-one matching between the nodes of two functions.
+class NodeMatcher {
+ public:
+  NodeMatcher(FunctionBase* golden, FunctionBase* revised)
+      : golden_(golden),
+        golden_order_(TopoSort(golden)),
+        revised_order_(TopoSort(revised)) {}
+
+  void Match() {
+    for (Node* node : golden_order_) {
+      attribute_hashes_[node] = AttributeHash(node);
+    }
+    for (Node* node : revised_order_) {
+      attribute_hashes_[node] = AttributeHash(node);
+    }
+
+    MatchByName();
+    Propagate();
+    MatchUnique([this](Node* node) { return StructuralHash(node); });
+    Propagate();
+    MatchUnique([this](Node* node) -> std::optional<uint64_t> {
+      if (node->loc().locations.empty()) {
+        return std::nullopt;
+      }
+      return absl::HashOf(attribute_hashes_.at(node), node->loc().ToString());
+    });
+    Propagate();
+    MatchByMatchedOperands();
+    Propagate();
+    VLOG(1) << "Matched " << golden_to_revised_.size() << " of "
+            << golden_order_.size() << " golden nodes to "
+            << revised_order_.size() << " revised nodes";
+  }
+
+  absl::Span<Node* const> golden_order() const { return golden_order_; }
+  absl::Span<Node* const> revised_order() const { return revised_order_; }
+
+  Node* GoldenMatch(Node* revised) const {
+    auto it = revised_to_golden_.find(revised);
+    return it == revised_to_golden_.end() ? nullptr : it->second;
+  }
+  bool IsMatched(Node* golden) const {
+    return golden_to_revised_.contains(golden);
+  }
+
+ private:
+  bool TryMatch(Node* golden, Node* revised) {
+    if (golden_to_revised_.contains(golden) ||
+        revised_to_golden_.contains(revised) ||
+        attribute_hashes_.at(golden) != attribute_hashes_.at(revised) ||
+        !AttributesMatch(golden, revised)) {
+      return false;
+    }
+    golden_to_revised_[golden] = revised;
+    revised_to_golden_[revised] = golden;
+    worklist_.push_back({golden, revised});
+    return true;
+  }
+
+  void MatchByName() {
+    for (Node* revised : revised_order_) {
+      if (!revised->HasAssignedName()) {
+        continue;
+      }
+      absl::StatusOr<Node*> golden = golden_->GetNode(revised->GetName());
+      if (golden.ok() && golden.value()->HasAssignedName()) {
+        TryMatch(golden.value(), revised);
+      }
+    }
+  }
+
+  // Hash of a node's attributes and, transitively, those of its operands.
+  // Operands of commutative ops are combined order-independently.
+  uint64_t StructuralHash(Node* node) {
+    if (auto it = structural_hashes_.find(node);
+        it != structural_hashes_.end()) {
+      return it->second;
+    }
+    // Nodes are visited in topological order, so operands are already
+    // hashed.
+    std::vector<uint64_t> operand_hashes;
+    operand_hashes.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operand_hashes.push_back(structural_hashes_.at(operand));
+    }
+    if (OpIsCommutative(node->op())) {
+      std::sort(operand_hashes.begin(), operand_hashes.end());
+    }
+    uint64_t hash = absl::HashOf(attribute_hashes_.at(node), operand_hashes);
+    structural_hashes_[node] = hash;
+    return hash;
+  }
+
+  // Matches unmatched nodes whose key is unique among the unmatched nodes of
+  // both functions. 'key' returns std::nullopt for nodes without a key.
+  template <typename KeyFn>
+  void MatchUnique(KeyFn key) {
+    // Value is the unique node with the key, or nullptr if there are several.
+    auto collect = [&](absl::Span<Node* const> order, bool is_golden) {
+      absl::flat_hash_map<uint64_t, Node*> unique;
+      for (Node* node : order) {
+        std::optional<uint64_t> node_key = key(node);
+        bool matched = is_golden ? golden_to_revised_.contains(node)
+                                 : revised_to_golden_.contains(node);
+        if (!node_key.has_value() || matched) {
+          continue;
+        }
+        auto [it, inserted] = unique.insert({*node_key, node});
+        if (!inserted) {
+          it->second = nullptr;
+        }
+      }
+      return unique;
+    };
+    absl::flat_hash_map<uint64_t, Node*> golden_unique =
+        collect(golden_order_, /*is_golden=*/true);
+    absl::flat_hash_map<uint64_t, Node*> revised_unique =
+        collect(revised_order_, /*is_golden=*/false);
+    for (const auto& [revised_key, revised] : revised_unique) {
+      auto golden = golden_unique.find(revised_key);
+      if (revised != nullptr && golden != golden_unique.end() &&
+          golden->second != nullptr) {
+        TryMatch(golden->second, revised);
+      }
+    }
+  }
+
+  // Matches each unmatched revised node to an unmatched golden node with the
+  // same attributes whose operands are matched to the revised node's
+  // operands. Visits nodes in topological order so that chains of new matches
+  // are found in a single pass.
+  void MatchByMatchedOperands() {
+    absl::flat_hash_map<uint64_t, std::deque<Node*>> golden_leaves;
+    for (Node* golden : golden_order_) {
+      if (golden->operand_count() == 0 && !IsMatched(golden)) {
+        golden_leaves[attribute_hashes_.at(golden)].push_back(golden);
+      }
+    }
+    for (Node* revised : revised_order_) {
+      if (revised_to_golden_.contains(revised)) {
+        continue;
+      }
+      if (revised->operand_count() == 0) {
+        std::deque<Node*>& leaves =
+            golden_leaves[attribute_hashes_.at(revised)];
+        while (!leaves.empty() && !TryMatch(leaves.front(), revised) &&
+               IsMatched(leaves.front())) {
+          leaves.pop_front();
+        }
+        continue;
+      }
+      std::vector<Node*> golden_operands;
+      for (Node* operand : revised->operands()) {
+        Node* golden_operand = GoldenMatch(operand);
+        if (golden_operand == nullptr) {
+          break;
+        }
+        golden_operands.push_back(golden_operand);
+      }
+      if (golden_operands.size() != revised->operand_count()) {
+        continue;
+      }
+      for (Node* candidate : golden_operands.front()->users()) {
+        if (candidate->operands() == absl::MakeConstSpan(golden_operands) &&
+            TryMatch(candidate, revised)) {
+          break;
+        }
+      }
+    }
+  }
+
+  // Extends the matching from each newly matched pair to operands and users
+  // where the correspondence is unambiguous.
+  void Propagate() {
+    while (!worklist_.empty()) {
+      auto [golden, revised] = worklist_.front();
+      worklist_.pop_front();
+
+      if (golden->operand_count() == revised->operand_count()) {
+        for (int64_t i = 0; i < golden->operand_count(); ++i) {
+          TryMatch(golden->operand(i), revised->operand(i));
+        }
+      }
+
+      // Users are grouped by attributes and the operand slot they read the
+      // matched node through; groups of exactly one user on each side match.
+      auto group_users = [this](Node* node, bool is_golden) {
+        absl::flat_hash_map<std::pair<uint64_t, int64_t>, Node*> groups;
+        for (Node* user : node->users()) {
+          bool matched = is_golden ? golden_to_revised_.contains(user)
+                                   : revised_to_golden_.contains(user);
+          if (matched) {
+            continue;
+          }
+          for (int64_t index = 0; index < user->operand_count(); ++index) {
+            if (user->operand(index) != node) {
+              continue;
+            }
+            auto [it, inserted] =
+                groups.insert({{attribute_hashes_.at(user), index}, user});
+            if (!inserted) {
+              it->second = nullptr;
+            }
+          }
+        }
+        return groups;
+      };
+      absl::flat_hash_map<std::pair<uint64_t, int64_t>, Node*> golden_users =
+          group_users(golden, /*is_golden=*/true);
+      absl::flat_hash_map<std::pair<uint64_t, int64_t>, Node*> revised_users =
+          group_users(revised, /*is_golden=*/false);
+      for (const auto& [key, revised_user] : revised_users) {
+        auto golden_user = golden_users.find(key);
+        if (revised_user != nullptr && golden_user != golden_users.end() &&
+            golden_user->second != nullptr) {
+          TryMatch(golden_user->second, revised_user);
+        }
+      }
+    }
+  }
+
+  FunctionBase* golden_;
+  std::vector<Node*> golden_order_;
+  std::vector<Node*> revised_order_;
+  absl::flat_hash_map<Node*, uint64_t> attribute_hashes_;
+  absl::flat_hash_map<Node*, uint64_t> structural_hashes_;
+  absl::flat_hash_map<Node*, Node*> golden_to_revised_;
+  absl::flat_hash_map<Node*, Node*> revised_to_golden_;
+  // Newly matched pairs whose neighborhoods have not been propagated yet.
+  std::deque<std::pair<Node*, Node*>> worklist_;
+};
+
+}  // namespace
+
+absl::StatusOr<xls_eco::IrPatchProto> ComputeIrPatch(FunctionBase* golden,
+                                                     FunctionBase* revised) {
+  NodeMatcher matcher(golden, revised);
+  matcher.Match();
+
+  xls_eco::IrPatchProto patch;
+  patch.set_function_name(golden->name());
+  uint32_t next_id = 0;
+  auto add_edit_path = [&](xls_eco::Operation operation) {
+    xls_eco::EditPathProto* edit_path = patch.add_edit_paths();
+    edit_path->set_id(next_id++);
+    edit_path->set_operation(operation);
+    return edit_path;
+  };
+  Node* revised_return = revised->IsFunction()
+                             ? revised->AsFunctionOrDie()->return_value()
+                             : nullptr;
+
+  // Node edits.
+  for (Node* node : matcher.golden_order()) {
+    if (!matcher.IsMatched(node)) {
+      XLS_RETURN_IF_ERROR(NodeToProto(node, add_edit_path(xls_eco::DELETE)
+                                                ->mutable_node_edit_path()
+                                                ->mutable_node()));
+    }
+  }
+  for (Node* node : matcher.revised_order()) {
+    Node* golden_node = matcher.GoldenMatch(node);
+    if (golden_node == nullptr) {
+      XLS_RETURN_IF_ERROR(NodeToProto(node, add_edit_path(xls_eco::INSERT)
+                                                ->mutable_node_edit_path()
+                                                ->mutable_node()));
+    } else if (golden_node->GetName() != node->GetName()) {
+      xls_eco::NodeEditPathProto* update =
+          add_edit_path(xls_eco::UPDATE)->mutable_node_edit_path();
+      XLS_RETURN_IF_ERROR(NodeToProto(golden_node, update->mutable_node()));
+      XLS_RETURN_IF_ERROR(NodeToProto(node, update->mutable_updated_node()));
+    } else {
+      continue;
+    }
+    if (node == revised_return) {
+      XLS_RETURN_IF_ERROR(NodeToProto(node, patch.mutable_return_node()));
+    }
+  }
+
+  // Edge edits. Golden operand edges which correspond to a revised edge are
+  // recorded in 'kept_edges' as (sink, operand index); the rest are deleted.
+  absl::flat_hash_set<std::pair<Node*, int64_t>> kept_edges;
+  std::vector<std::pair<Node*, int64_t>> inserted_edges;
+  for (Node* sink : matcher.revised_order()) {
+    Node* golden_sink = matcher.GoldenMatch(sink);
+    for (int64_t index = 0; index < sink->operand_count(); ++index) {
+      Node* golden_source = matcher.GoldenMatch(sink->operand(index));
+      std::optional<int64_t> golden_index;
+      if (golden_sink != nullptr && golden_source != nullptr) {
+        auto is_unused_edge = [&](int64_t i) {
+          return i < golden_sink->operand_count() &&
+                 golden_sink->operand(i) == golden_source &&
+                 !kept_edges.contains({golden_sink, i});
+        };
+        if (is_unused_edge(index)) {
+          golden_index = index;
+        } else if (OpIsCommutative(sink->op())) {
+          for (int64_t i = 0; i < golden_sink->operand_count(); ++i) {
+            if (is_unused_edge(i)) {
+              golden_index = i;
+              break;
+            }
+          }
+        }
+      }
+      if (!golden_index.has_value()) {
+        inserted_edges.push_back({sink, index});
+        continue;
+      }
+      kept_edges.insert({golden_sink, *golden_index});
+      if (*golden_index != index ||
+          golden_sink->GetName() != sink->GetName() ||
+          golden_source->GetName() != sink->operand(index)->GetName()) {
+        xls_eco::EdgeEditPathProto* update =
+            add_edit_path(xls_eco::UPDATE)->mutable_edge_edit_path();
+        EdgeToProto(golden_source, golden_sink, *golden_index,
+                    update->mutable_edge());
+        EdgeToProto(sink->operand(index), sink, index,
+                    update->mutable_updated_edge());
+      }
+    }
+  }
+  for (const auto& [sink, index] : inserted_edges) {
+    EdgeToProto(sink->operand(index), sink, index,
+                add_edit_path(xls_eco::INSERT)
+                    ->mutable_edge_edit_path()
+                    ->mutable_edge());
+  }
+  for (Node* sink : matcher.golden_order()) {
+    for (int64_t index = 0; index < sink->operand_count(); ++index) {
+      if (!kept_edges.contains({sink, index})) {
+        EdgeToProto(sink->operand(index), sink, index,
+                    add_edit_path(xls_eco::DELETE)
+                        ->mutable_edge_edit_path()
+                        ->mutable_edge());
+      }
+    }
+  }
+  return patch;
+}
+
+}  // namespace xls
@@ -0,0 +1,50 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_ECO_IR_DIFF_ENGINE_H_
+#define XLS_ECO_IR_DIFF_ENGINE_H_
+
+#include "absl/status/statusor.h"
+#include "xls/eco/ir_patch.pb.h"
+#include "xls/ir/function_base.h"
+
+namespace xls {
+
+// Computes the edit path which transforms 'golden' into 'revised', in the
+// form consumed by PatchIr. This is a native replacement for the NetworkX
+// graph edit distance in ir_diff.py / ir_patch_gen.py.
+//
+// Rather than searching all node assignments, nodes are only ever matched to
+// nodes with identical attributes (the zero-cost substitutions of the Python
+// cost model), and matches are found in order of confidence:
+//
+//   1. Nodes with the same user-assigned name.
+//   2. Nodes whose structural hash (attributes of the node and its transitive
+//      operands) is unique in both graphs.
+//   3. Nodes whose source location is unique in both graphs.
+//   4. Nodes whose operands are all matched to the operands of a single
+//      candidate, visited in topological order.
+//
+// After each step, matches are propagated to the operands and users of
+// matched nodes when the correspondence is unambiguous. Unmatched nodes are
+// deleted or inserted, and edges are deleted, inserted or updated to match.
+// Runtime is roughly linear in the size of the graphs, so the result is not
+// guaranteed to be a minimum-cost edit path, but it is for the common ECO case
+// of small local changes to a large design.
+absl::StatusOr<xls_eco::IrPatchProto> ComputeIrPatch(FunctionBase* golden,
+                                                     FunctionBase* revised);
+
+}  // namespace xls
+
+#endif  // XLS_ECO_IR_DIFF_ENGINE_H_
@@ -0,0 +1,78 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/stopwatch.h"
+#include "xls/eco/ir_diff_engine.h"
+#include "xls/eco/ir_patch.pb.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+static constexpr std::string_view kUsage = R"(
+Computes a patch which transforms the top of the golden IR into the top of the
+revised IR. The patch can be applied with patch_ir_main.
+
+Example invocation:
+  ir_diff_engine_main --golden_ir_path=<ir file> --revised_ir_path=<ir file> \
+    --output_patch_path=<patch file>
+)";
+
+ABSL_FLAG(std::string, golden_ir_path, "",
+          "Path to the IR file to patch.");  // NOLINT
+ABSL_FLAG(std::string, revised_ir_path, "",
+          "Path to the IR file the patched IR should match.");  // NOLINT
+ABSL_FLAG(std::string, output_patch_path, "",
+          "Path to write the binary IrPatchProto to.");  // NOLINT
+
+namespace xls {
+static absl::Status RealMain(const std::string& golden_path,
+                             const std::string& revised_path,
+                             const std::string& output_path) {
+  XLS_ASSIGN_OR_RETURN(std::string golden_ir, GetFileContents(golden_path));
+  XLS_ASSIGN_OR_RETURN(std::string revised_ir, GetFileContents(revised_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> golden_package,
+                       Parser::ParsePackage(golden_ir));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> revised_package,
+                       Parser::ParsePackage(revised_ir));
+  XLS_ASSIGN_OR_RETURN(FunctionBase * golden, golden_package->GetTop());
+  XLS_ASSIGN_OR_RETURN(FunctionBase * revised, revised_package->GetTop());
+
+  Stopwatch stopwatch;
+  XLS_ASSIGN_OR_RETURN(xls_eco::IrPatchProto patch,
+                       ComputeIrPatch(golden, revised));
+  LOG(INFO) << "Computed " << patch.edit_paths_size() << " edit paths in "
+            << stopwatch.GetElapsedTime();
+  return SetFileContents(output_path, patch.SerializeAsString());
+}
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_args =
+      xls::InitXls(kUsage, argc, argv);
+  return xls::ExitStatus(xls::RealMain(absl::GetFlag(FLAGS_golden_ir_path),
+                                       absl::GetFlag(FLAGS_revised_ir_path),
+                                       absl::GetFlag(FLAGS_output_patch_path)));
+}
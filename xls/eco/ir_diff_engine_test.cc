@@ -0,0 +1,260 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/eco/ir_diff_engine.h"
+
+#include <memory>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/proto_test_utils.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/eco/ir_patch.pb.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::xls::proto_testing::EqualsProto;
+using ::xls::proto_testing::IgnoringRepeatedFieldOrdering;
+using ::xls::proto_testing::Partially;
+
+// Matches a patch against the fields set in 'expected'. Edit path ids and
+// node types are ignored, but every edit path must be accounted for.
+auto PatchIs(std::string_view expected) {
+  return IsOkAndHolds(
+      Partially(IgnoringRepeatedFieldOrdering(EqualsProto(expected))));
+}
+
+class IrDiffEngineTest : public IrTestBase {
+ protected:
+  // Returns the patch from function 'f' of 'golden' to function 'f' of
+  // 'revised'.
+  absl::StatusOr<xls_eco::IrPatchProto> Diff(std::string_view golden,
+                                             std::string_view revised) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> golden_package,
+                         ParsePackage(golden));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> revised_package,
+                         ParsePackage(revised));
+    XLS_ASSIGN_OR_RETURN(Function * golden_f,
+                         golden_package->GetFunction("f"));
+    XLS_ASSIGN_OR_RETURN(Function * revised_f,
+                         revised_package->GetFunction("f"));
+    return ComputeIrPatch(golden_f, revised_f);
+  }
+};
+
+TEST_F(IrDiffEngineTest, IdenticalFunctions) {
+  constexpr std::string_view kIr = R"(
+package p
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  ret sum: bits[8] = add(x, y)
+}
+)";
+  EXPECT_THAT(Diff(kIr, kIr), PatchIs(R"pb(function_name: "f")pb"));
+}
+
+TEST_F(IrDiffEngineTest, RenamedNode) {
+  EXPECT_THAT(Diff(R"(
+package p
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  ret sum: bits[8] = add(x, y)
+}
+)",
+                   R"(
+package p
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  ret total: bits[8] = add(x, y)
+}
+)"),
+              PatchIs(R"pb(
+                function_name: "f"
+                edit_paths {
+                  operation: UPDATE
+                  node_edit_path {
+                    node { op: "add" name: "sum" }
+                    updated_node { op: "add" name: "total" }
+                  }
+                }
+                edit_paths {
+                  operation: UPDATE
+                  edge_edit_path {
+                    edge { from_node: "x" to_node: "sum" }
+                    updated_edge { from_node: "x" to_node: "total" }
+                  }
+                }
+                edit_paths {
+                  operation: UPDATE
+                  edge_edit_path {
+                    edge { from_node: "y" to_node: "sum" index: 1 }
+                    updated_edge { from_node: "y" to_node: "total" index: 1 }
+                  }
+                }
+                return_node { op: "add" name: "total" }
+              )pb"));
+}
+
+TEST_F(IrDiffEngineTest, InsertedOp) {
+  EXPECT_THAT(Diff(R"(
+package p
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  sum: bits[8] = add(x, y)
+  ret out: bits[8] = not(sum)
+}
+)",
+                   R"(
+package p
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  sum: bits[8] = add(x, y)
+  inv: bits[8] = not(sum)
+  ret out: bits[8] = not(inv)
+}
+)"),
+              PatchIs(R"pb(
+                function_name: "f"
+                edit_paths {
+                  operation: INSERT
+                  node_edit_path { node { op: "not" name: "inv" } }
+                }
+                edit_paths {
+                  operation: INSERT
+                  edge_edit_path { edge { from_node: "sum" to_node: "inv" } }
+                }
+                edit_paths {
+                  operation: INSERT
+                  edge_edit_path { edge { from_node: "inv" to_node: "out" } }
+                }
+                edit_paths {
+                  operation: DELETE
+                  edge_edit_path { edge { from_node: "sum" to_node: "out" } }
+                }
+              )pb"));
+}
+
+TEST_F(IrDiffEngineTest, ChangedLiteral) {
+  EXPECT_THAT(Diff(R"(
+package p
+
+fn f(x: bits[8]) -> bits[8] {
+  k: bits[8] = literal(value=1)
+  ret out: bits[8] = add(x, k)
+}
+)",
+                   R"(
+package p
+
+fn f(x: bits[8]) -> bits[8] {
+  k: bits[8] = literal(value=2)
+  ret out: bits[8] = add(x, k)
+}
+)"),
+              PatchIs(R"pb(
+                function_name: "f"
+                edit_paths {
+                  operation: DELETE
+                  node_edit_path {
+                    node {
+                      op: "literal"
+                      name: "k"
+                      unique_args {
+                        value { bits { bit_count: 8 data: "\001" } }
+                      }
+                    }
+                  }
+                }
+                edit_paths {
+                  operation: INSERT
+                  node_edit_path {
+                    node {
+                      op: "literal"
+                      name: "k"
+                      unique_args {
+                        value { bits { bit_count: 8 data: "\002" } }
+                      }
+                    }
+                  }
+                }
+                edit_paths {
+                  operation: INSERT
+                  edge_edit_path {
+                    edge { from_node: "k" to_node: "out" index: 1 }
+                  }
+                }
+                edit_paths {
+                  operation: DELETE
+                  edge_edit_path {
+                    edge { from_node: "k" to_node: "out" index: 1 }
+                  }
+                }
+              )pb"));
+}
+
+TEST_F(IrDiffEngineTest, RenamedSideEffectingOp) {
+  // Side-effecting nodes are never "definitely equal", but a renamed assert is
+  // still the same node and must not be deleted and reinserted.
+  EXPECT_THAT(Diff(R"(
+package p
+
+fn f(tkn: token, cond: bits[1]) -> token {
+  ret check: token = assert(tkn, cond, message="boom")
+}
+)",
+                   R"(
+package p
+
+fn f(tkn: token, cond: bits[1]) -> token {
+  ret guard: token = assert(tkn, cond, message="boom")
+}
+)"),
+              PatchIs(R"pb(
+                function_name: "f"
+                edit_paths {
+                  operation: UPDATE
+                  node_edit_path {
+                    node { op: "assert" name: "check" }
+                    updated_node { op: "assert" name: "guard" }
+                  }
+                }
+                edit_paths {
+                  operation: UPDATE
+                  edge_edit_path {
+                    edge { from_node: "tkn" to_node: "check" }
+                    updated_edge { from_node: "tkn" to_node: "guard" }
+                  }
+                }
+                edit_paths {
+                  operation: UPDATE
+                  edge_edit_path {
+                    edge { from_node: "cond" to_node: "check" index: 1 }
+                    updated_edge { from_node: "cond" to_node: "guard" index: 1 }
+                  }
+                }
+                return_node { op: "assert" name: "guard" }
+              )pb"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "absl/base/attributes.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -41,6 +42,7 @@
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
@@ -429,6 +431,69 @@ absl::Status PatchIr::ValidatePatch() {
   return absl::OkStatus();
 }
 
+bool PatchIr::IsPinnable(Node* node) const {
+  return !inserted_node_names_.contains(node->GetName()) &&
+         node->op() != Op::kLiteral;
+}
+
+std::optional<PipelineSchedule> PatchIr::PlaceInSlack(
+    const PipelineSchedule& schedule, bool asap) const {
+  // Untouched nodes keep their stage; patched nodes are placed between the
+  // stages of their operands and users.
+  std::vector<Node*> order = TopoSort(function_base_);
+  ScheduleCycleMap cycle_map;
+  for (Node* node : order) {
+    if (schedule.IsScheduled(node) && IsPinnable(node)) {
+      cycle_map[node] = schedule.cycle(node);
+    }
+  }
+  auto earliest = [&cycle_map](Node* node) {
+    int64_t stage = 0;
+    for (Node* operand : node->operands()) {
+      stage = std::max(stage, cycle_map.at(operand));
+    }
+    return stage;
+  };
+  auto latest = [&cycle_map, &schedule](Node* node) {
+    int64_t stage = schedule.length() - 1;
+    for (Node* user : node->users()) {
+      stage = std::min(stage, cycle_map.at(user));
+    }
+    return stage;
+  };
+  std::vector<Node*> placed;
+  if (asap) {
+    for (Node* node : order) {
+      if (!cycle_map.contains(node)) {
+        cycle_map[node] = earliest(node);
+        placed.push_back(node);
+      }
+    }
+    // Operand-less nodes (e.g. literals) cost no delay, so sink them to their
+    // users instead of carrying them through pipeline registers.
+    for (auto it = placed.rbegin(); it != placed.rend(); ++it) {
+      if ((*it)->operand_count() == 0) {
+        cycle_map[*it] = latest(*it);
+      }
+    }
+  } else {
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      if (!cycle_map.contains(*it)) {
+        cycle_map[*it] = latest(*it);
+        placed.push_back(*it);
+      }
+    }
+  }
+  for (Node* node : placed) {
+    if (cycle_map.at(node) < earliest(node) ||
+        cycle_map.at(node) > latest(node)) {
+      return std::nullopt;
+    }
+  }
+  return PipelineSchedule(function_base_, cycle_map, schedule.length(),
+                          schedule.min_clock_period_ps());
+}
+
 absl::Status PatchIr::PatchSchedule(const PipelineSchedule& schedule) {
   XLS_ASSIGN_OR_RETURN(
       SchedulingOptionsFlagsProto scheduling_options_flags_proto,
@@ -436,28 +501,59 @@ absl::Status PatchIr::PatchSchedule(const PipelineSchedule& schedule) {
   XLS_ASSIGN_OR_RETURN(
       SchedulingOptions scheduling_options,
       SetUpSchedulingOptions(scheduling_options_flags_proto, package_));
-  SchedulingOptions tmp_scheduling_options = scheduling_options;
   XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
                        SetUpDelayEstimator(scheduling_options_flags_proto));
-  decltype(package_->GetNodeCount()) constraint_count = 0;
-  for (const auto& [node, cycle] : schedule.GetCycleMap()) {
-    if (inserted_node_names_.contains(node->GetName())) {
-      std::cout << "Skipping constraint for node: " << node->GetName()
-                << " due to node being newly inserted.\n";
+  std::optional<int64_t> clock_period_ps =
+      scheduling_options.clock_period_ps().has_value()
+          ? scheduling_options.clock_period_ps()
+          : schedule.min_clock_period_ps();
+
+  // Fast path: keep every untouched node in its stage and fit the patched
+  // nodes into the existing slack, without running the scheduler at all.
+  for (bool asap : {true, false}) {
+    std::optional<PipelineSchedule> placed = PlaceInSlack(schedule, asap);
+    if (!placed.has_value() || !placed->Verify().ok()) {
       continue;
     }
-    if (std::find(function_base_->nodes().begin(),
-                  function_base_->nodes().end(),
-                  node) == function_base_->nodes().end()) {
-      std::cout << "Skipping constraint for node: " << node->GetName()
-                << " due to node not found in IR.\n";
+    if (clock_period_ps.has_value() &&
+        !placed->VerifyTiming(*clock_period_ps, *delay_estimator).ok()) {
       continue;
     }
-    if (node->op() == Op::kLiteral) {
-      std::cout << "Skipping constraint for node: " << node->GetName()
-                << " due to node being a literal.\n";
-      continue;
+    std::cout << "Placed patched nodes within the existing schedule ("
+              << (asap ? "ASAP" : "ALAP") << ").\n";
+    schedule_ = std::move(placed);
+    schedule_strategy_ = ScheduleStrategy::kSlack;
+    return absl::OkStatus();
+  }
+
+  // Pin all untouched nodes in a single scheduler run.
+  absl::flat_hash_set<Node*> live_nodes(function_base_->nodes().begin(),
+                                        function_base_->nodes().end());
+  std::vector<std::pair<Node*, int64_t>> pinnable;
+  for (const auto& [node, cycle] : schedule.GetCycleMap()) {
+    if (live_nodes.contains(node) && IsPinnable(node)) {
+      pinnable.push_back({node, cycle});
     }
+  }
+  SchedulingOptions pinned_options = scheduling_options;
+  for (const auto& [node, cycle] : pinnable) {
+    pinned_options.add_constraint(NodeInCycleConstraint(node, cycle));
+  }
+  absl::StatusOr<PipelineSchedule> pinned_schedule =
+      RunPipelineSchedule(function_base_, *delay_estimator, pinned_options);
+  if (pinned_schedule.ok()) {
+    std::cout << "Rescheduled with all " << pinnable.size()
+              << " untouched nodes pinned.\n";
+    schedule_ = std::move(pinned_schedule).value();
+    schedule_strategy_ = ScheduleStrategy::kPinned;
+    return schedule_->Verify();
+  }
+
+  // Slow path: add pin constraints one at a time, dropping any that make the
+  // schedule infeasible.
+  SchedulingOptions tmp_scheduling_options = scheduling_options;
+  decltype(package_->GetNodeCount()) constraint_count = 0;
+  for (const auto& [node, cycle] : pinnable) {
     tmp_scheduling_options.add_constraint(NodeInCycleConstraint(node, cycle));
     // check if schedule is feasible; if not, then we need remove the constraint
     if (!RunPipelineSchedule(function_base_, *delay_estimator,
@@ -471,11 +567,12 @@ absl::Status PatchIr::PatchSchedule(const PipelineSchedule& schedule) {
       constraint_count++;
     }
     tmp_scheduling_options = scheduling_options;
-    XLS_ASSIGN_OR_RETURN(schedule_,
-                         RunPipelineSchedule(function_base_, *delay_estimator,
-                                             scheduling_options));
   }
+  XLS_ASSIGN_OR_RETURN(schedule_,
+                       RunPipelineSchedule(function_base_, *delay_estimator,
+                                           scheduling_options));
   XLS_RETURN_IF_ERROR(schedule_->Verify());
+  schedule_strategy_ = ScheduleStrategy::kIncremental;
   std::cout << "Total nodes: " << package_->GetNodeCount();
   std::cout << "constrained nodes count: " << constraint_count;
   return absl::OkStatus();
@@ -41,6 +41,17 @@ namespace xls {
 
 class PatchIr {
  public:
+  // How PatchSchedule arrived at the patched schedule, in the order the
+  // strategies are tried.
+  enum class ScheduleStrategy : uint8_t {
+    // Patched nodes were placed in the slack of the original schedule.
+    kSlack,
+    // One scheduler run with every untouched node pinned to its stage.
+    kPinned,
+    // Untouched nodes were pinned one at a time, dropping infeasible pins.
+    kIncremental,
+  };
+
   explicit PatchIr(FunctionBase* function_base, xls_eco::IrPatchProto& patch);
   absl::Status ApplyPatch();
   absl::Status PrintPatch();
@@ -48,8 +59,19 @@ class PatchIr {
   absl::Status ExportScheduleProto();
   absl::Status PatchSchedule(const PipelineSchedule& schedule);
   absl::StatusOr<PipelineSchedule> GetPatchedSchedule();
+  std::optional<ScheduleStrategy> schedule_strategy() const {
+    return schedule_strategy_;
+  }
 
  private:
+  // Returns whether 'node' was present before patching and so should keep
+  // its stage in the patched schedule.
+  bool IsPinnable(Node* node) const;
+  // Returns 'schedule' with untouched nodes in their original stages and
+  // patched nodes placed as early (or as late) as their operands and users
+  // allow. Returns std::nullopt if a patched node has no legal stage.
+  std::optional<PipelineSchedule> PlaceInSlack(const PipelineSchedule& schedule,
+                                               bool asap) const;
   absl::Status ApplyPath(const xls_eco::EditPathProto& edit_path);
   absl::Status ApplyDeletePath(const xls_eco::NodeEditPathProto& node_delete);
   absl::Status ApplyDeletePath(const xls_eco::EdgeEditPathProto& edge_delete);
@@ -115,6 +137,7 @@ class PatchIr {
   FunctionBase* function_base_;
   Package* package_;
   std::optional<PipelineSchedule> schedule_;
+  std::optional<ScheduleStrategy> schedule_strategy_;
   absl::flat_hash_map<Node*, std::vector<Node*>> dummy_nodes_map_;
   Node* dummy_return_node_ = nullptr;
   absl::flat_hash_map<std::string, std::string> patch_to_ir_node_map_;
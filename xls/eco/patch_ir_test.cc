@@ -0,0 +1,158 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/eco/patch_ir.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "xls/common/status/matchers.h"
+#include "xls/eco/ir_patch.pb.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+ABSL_DECLARE_FLAG(std::string, delay_model);
+ABSL_DECLARE_FLAG(int64_t, clock_period_ps);
+ABSL_DECLARE_FLAG(int64_t, pipeline_stages);
+
+namespace xls {
+namespace {
+
+using ::testing::Optional;
+
+// The tests below model an applied patch by scheduling only the untouched
+// nodes of a function; nodes missing from the original schedule are the ones
+// the patch inserted. With the unit delay model and a 2ps clock, each stage
+// fits a chain of at most two ops.
+class PatchScheduleTest : public IrTestBase {
+ protected:
+  void SetUp() override {
+    absl::SetFlag(&FLAGS_delay_model, "unit");
+    absl::SetFlag(&FLAGS_clock_period_ps, 2);
+    absl::SetFlag(&FLAGS_pipeline_stages, 3);
+  }
+
+  absl::FlagSaver flag_saver_;
+};
+
+TEST_F(PatchScheduleTest, PlacesPatchedNodeInSlack) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package p
+
+fn f(x: bits[8]) -> bits[8] {
+  a: bits[8] = not(x)
+  b: bits[8] = not(a)
+  c: bits[8] = not(b)
+  d: bits[8] = not(c)
+  patched: bits[8] = not(d)
+  ret e: bits[8] = not(patched)
+}
+)"));
+  Function* f = FindFunction("f", p.get());
+  PipelineSchedule original(f,
+                            {{FindNode("x", f), 0},
+                             {FindNode("a", f), 0},
+                             {FindNode("b", f), 0},
+                             {FindNode("c", f), 1},
+                             {FindNode("d", f), 1},
+                             {FindNode("e", f), 2}},
+                            /*length=*/3);
+  xls_eco::IrPatchProto patch;
+  PatchIr patch_ir(f, patch);
+
+  XLS_ASSERT_OK(patch_ir.PatchSchedule(original));
+  EXPECT_THAT(patch_ir.schedule_strategy(),
+              Optional(PatchIr::ScheduleStrategy::kSlack));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule patched,
+                           patch_ir.GetPatchedSchedule());
+  // Stage 1 is full, so the patched node goes late, next to its user.
+  EXPECT_EQ(patched.cycle(FindNode("patched", f)), 2);
+  for (const auto& [node, cycle] : original.GetCycleMap()) {
+    EXPECT_EQ(patched.cycle(node), cycle) << node->GetName();
+  }
+}
+
+TEST_F(PatchScheduleTest, PinsUntouchedNodesWhenSlackIsNotEnough) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package p
+
+fn f(x: bits[8]) -> bits[8] {
+  a: bits[8] = not(x)
+  p1: bits[8] = not(a)
+  p2: bits[8] = not(p1)
+  p3: bits[8] = not(p2)
+  ret b: bits[8] = not(p3)
+}
+)"));
+  Function* f = FindFunction("f", p.get());
+  // Stage 1 is empty. Placing the whole patched chain in stage 0 or stage 2
+  // misses timing, but splitting it across the stages fits.
+  PipelineSchedule original(
+      f, {{FindNode("x", f), 0}, {FindNode("a", f), 0}, {FindNode("b", f), 2}},
+      /*length=*/3);
+  xls_eco::IrPatchProto patch;
+  PatchIr patch_ir(f, patch);
+
+  XLS_ASSERT_OK(patch_ir.PatchSchedule(original));
+  EXPECT_THAT(patch_ir.schedule_strategy(),
+              Optional(PatchIr::ScheduleStrategy::kPinned));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule patched,
+                           patch_ir.GetPatchedSchedule());
+  for (const auto& [node, cycle] : original.GetCycleMap()) {
+    EXPECT_EQ(patched.cycle(node), cycle) << node->GetName();
+  }
+}
+
+TEST_F(PatchScheduleTest, DropsInfeasiblePins) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package p
+
+fn f(x: bits[8]) -> bits[8] {
+  a: bits[8] = not(x)
+  p1: bits[8] = not(a)
+  p2: bits[8] = not(p1)
+  p3: bits[8] = not(p2)
+  ret b: bits[8] = not(p3)
+}
+)"));
+  Function* f = FindFunction("f", p.get());
+  // The patched chain no longer fits between 'a' and 'b' in two stages, so
+  // 'b' cannot keep its stage.
+  PipelineSchedule original(
+      f, {{FindNode("x", f), 0}, {FindNode("a", f), 0}, {FindNode("b", f), 1}},
+      /*length=*/2);
+  xls_eco::IrPatchProto patch;
+  PatchIr patch_ir(f, patch);
+
+  XLS_ASSERT_OK(patch_ir.PatchSchedule(original));
+  EXPECT_THAT(patch_ir.schedule_strategy(),
+              Optional(PatchIr::ScheduleStrategy::kIncremental));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule patched,
+                           patch_ir.GetPatchedSchedule());
+  EXPECT_EQ(patched.cycle(FindNode("x", f)), 0);
+  EXPECT_EQ(patched.cycle(FindNode("a", f)), 0);
+  EXPECT_EQ(patched.cycle(FindNode("b", f)), 2);
+}
+
+}  // namespace
+}  // namespace xls
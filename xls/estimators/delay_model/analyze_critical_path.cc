@@ -14,10 +14,12 @@
 
 #include "xls/estimators/delay_model/analyze_critical_path.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -28,6 +30,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
@@ -175,4 +178,173 @@ CriticalPathProto CriticalPathToProto(
   return proto;
 }
 
+absl::StatusOr<CriticalPathReportProto> AnalyzeStageCriticalPaths(
+    FunctionBase* f, const absl::flat_hash_map<Node*, int64_t>& cycle_map,
+    std::optional<int64_t> clock_period_ps,
+    const DelayEstimator& delay_estimator,
+    const CriticalPathReportOptions& options) {
+  // The delay of the longest path within its stage ending at each node, and
+  // the operand preceding the node on that path.
+  struct Arrival {
+    int64_t node_delay;
+    int64_t path_delay;
+    Node* predecessor = nullptr;
+  };
+  absl::flat_hash_map<Node*, Arrival> arrivals;
+  int64_t stage_count = 0;
+  int64_t max_path_delay = 0;
+  // The nodes whose value leaves their stage, by stage.
+  std::vector<std::vector<Node*>> stage_ends;
+  for (Node* node : TopoSort(f)) {
+    auto stage_it = cycle_map.find(node);
+    if (stage_it == cycle_map.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Node %s is not scheduled", node->GetName()));
+    }
+    int64_t stage = stage_it->second;
+    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    Arrival arrival{.node_delay = node_delay, .path_delay = node_delay};
+    for (Node* operand : node->operands()) {
+      if (cycle_map.at(operand) != stage) {
+        continue;
+      }
+      const Arrival& operand_arrival = arrivals.at(operand);
+      if (operand_arrival.path_delay + node_delay > arrival.path_delay) {
+        arrival.path_delay = operand_arrival.path_delay + node_delay;
+        arrival.predecessor = operand;
+      }
+    }
+    arrivals[node] = arrival;
+    max_path_delay = std::max(max_path_delay, arrival.path_delay);
+
+    if (node->users().empty() ||
+        absl::c_any_of(node->users(), [&](Node* user) {
+          return cycle_map.at(user) != stage;
+        })) {
+      if (stage >= stage_ends.size()) {
+        stage_ends.resize(stage + 1);
+      }
+      stage_ends[stage].push_back(node);
+    }
+    stage_count = std::max(stage_count, stage + 1);
+  }
+  stage_ends.resize(stage_count);
+
+  CriticalPathReportProto report;
+  int64_t clock_period = clock_period_ps.value_or(max_path_delay);
+  int64_t bucket_width = options.slack_bucket_ps > 0
+                             ? options.slack_bucket_ps
+                             : std::max<int64_t>(clock_period / 10, 1);
+  report.set_clock_period_ps(clock_period);
+  report.set_slack_bucket_ps(bucket_width);
+  for (int64_t stage = 0; stage < stage_count; ++stage) {
+    StageCriticalPathReportProto* stage_report = report.add_stages();
+    stage_report->set_stage(stage);
+    std::vector<Node*>& ends = stage_ends[stage];
+    std::stable_sort(ends.begin(), ends.end(), [&](Node* a, Node* b) {
+      return arrivals.at(a).path_delay > arrivals.at(b).path_delay;
+    });
+
+    // Bucket the slack of every path leaving the stage.
+    absl::flat_hash_map<int64_t, int64_t> bucket_counts;
+    for (Node* end : ends) {
+      int64_t slack = clock_period - arrivals.at(end).path_delay;
+      bucket_counts[FloorOfRatio(slack, bucket_width)]++;
+    }
+    std::vector<std::pair<int64_t, int64_t>> buckets(bucket_counts.begin(),
+                                                     bucket_counts.end());
+    absl::c_sort(buckets);
+    for (const auto& [bucket, count] : buckets) {
+      SlackHistogramBucketProto* bucket_proto =
+          stage_report->add_slack_histogram();
+      bucket_proto->set_min_slack_ps(bucket * bucket_width);
+      bucket_proto->set_count(count);
+    }
+
+    absl::flat_hash_map<Op, std::pair<int64_t, int64_t>> op_contributions;
+    for (int64_t i = 0;
+         i < std::min<int64_t>(options.paths_per_stage, ends.size()); ++i) {
+      std::vector<CriticalPathEntry> path;
+      for (Node* node = ends[i]; node != nullptr;
+           node = arrivals.at(node).predecessor) {
+        const Arrival& arrival = arrivals.at(node);
+        path.push_back(CriticalPathEntry{
+            .node = node,
+            .node_delay_ps = arrival.node_delay,
+            .path_delay_ps = arrival.path_delay,
+            .delayed_by_cycle_boundary = false});
+        std::pair<int64_t, int64_t>& contribution = op_contributions[node->op()];
+        contribution.first += arrival.node_delay;
+        contribution.second++;
+      }
+      *stage_report->add_paths() = CriticalPathToProto(path);
+    }
+    std::vector<std::pair<Op, std::pair<int64_t, int64_t>>> contributions(
+        op_contributions.begin(), op_contributions.end());
+    absl::c_sort(contributions, [](const auto& a, const auto& b) {
+      return a.second.first > b.second.first ||
+             (a.second.first == b.second.first && a.first < b.first);
+    });
+    for (const auto& [op, contribution] : contributions) {
+      OpDelayContributionProto* contribution_proto =
+          stage_report->add_op_contributions();
+      contribution_proto->set_op(ToOpProto(op));
+      contribution_proto->set_total_delay_ps(contribution.first);
+      contribution_proto->set_node_count(contribution.second);
+    }
+  }
+  return report;
+}
+
+namespace {
+
+std::string JsonEscape(std::string_view s) {
+  std::string escaped;
+  escaped.reserve(s.size());
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppendFormat(&escaped, "\\u%04x", static_cast<int>(c));
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+std::string CriticalPathReportToChromeTrace(
+    const CriticalPathReportProto& report) {
+  std::vector<std::string> events;
+  for (const StageCriticalPathReportProto& stage : report.stages()) {
+    events.push_back(absl::StrFormat(
+        R"({"name":"process_name","ph":"M","pid":%d,"args":{"name":"stage %d"}})",
+        stage.stage(), stage.stage()));
+    for (int64_t i = 0; i < stage.paths_size(); ++i) {
+      const CriticalPathProto& path = stage.paths(i);
+      events.push_back(absl::StrFormat(
+          R"({"name":"thread_name","ph":"M","pid":%d,"tid":%d,)"
+          R"("args":{"name":"path %d (%dps, slack %dps)"}})",
+          stage.stage(), i, i, path.total_delay_ps(),
+          report.clock_period_ps() -
+              static_cast<int64_t>(path.total_delay_ps())));
+      for (const DelayInfoNodeProto& node : path.nodes()) {
+        events.push_back(absl::StrFormat(
+            R"({"name":"%s","cat":"%s","ph":"X","pid":%d,"tid":%d,)"
+            R"("ts":%d,"dur":%d,"args":{"id":%d}})",
+            JsonEscape(node.ir()),
+            OpToString(FromOpProto(node.op())), stage.stage(), i,
+            node.total_delay_ps() - node.node_delay_ps(), node.node_delay_ps(),
+            node.id()));
+      }
+    }
+  }
+  return absl::StrCat("{\"traceEvents\":[\n", absl::StrJoin(events, ",\n"),
+                      "\n]}\n");
+}
+
 }  // namespace xls
@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -78,6 +79,35 @@ std::string CriticalPathToString(
 CriticalPathProto CriticalPathToProto(
     absl::Span<const CriticalPathEntry> critical_path);
 
+struct CriticalPathReportOptions {
+  // The number of longest paths reported for each stage.
+  int64_t paths_per_stage = 10;
+  // The width of the slack histogram buckets. If zero, a tenth of the clock
+  // period.
+  int64_t slack_bucket_ps = 0;
+};
+
+// Returns the longest combinational paths within each stage of the given
+// schedule (a map from node to stage), the distribution of the slack of the
+// paths leaving each stage, and how much each op contributes to the longest
+// paths. Paths end at a node whose value leaves its stage (a node with users
+// in later stages or with no users) and start at a node of the same stage.
+//
+// Slack is measured against `clock_period_ps`, or if not given against the
+// delay of the longest path of any stage.
+absl::StatusOr<CriticalPathReportProto> AnalyzeStageCriticalPaths(
+    FunctionBase* f, const absl::flat_hash_map<Node*, int64_t>& cycle_map,
+    std::optional<int64_t> clock_period_ps,
+    const DelayEstimator& delay_estimator,
+    const CriticalPathReportOptions& options = CriticalPathReportOptions());
+
+// Returns the paths of the report in the Chrome trace event JSON format, for
+// viewing in chrome://tracing or Perfetto. Each stage is a process and each
+// path a thread whose nodes are complete events. Times are in picoseconds but
+// shown by the viewers as microseconds.
+std::string CriticalPathReportToChromeTrace(
+    const CriticalPathReportProto& report);
+
 }  // namespace xls
 
 #endif  // XLS_ESTIMATORS_DELAY_MODEL_ANALYZE_CRITICAL_PATH_H_
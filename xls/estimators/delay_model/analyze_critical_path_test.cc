@@ -20,10 +20,12 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/estimators/delay_model/delay_info.pb.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/function_builder.h"
@@ -41,6 +43,7 @@ namespace {
 using ::testing::_;
 using ::testing::ElementsAre;
 using ::testing::FieldsAre;
+using ::testing::HasSubstr;
 
 class AnalyzeCriticalPathTest : public IrTestBase {
  protected:
@@ -173,5 +176,50 @@ TEST_F(AnalyzeCriticalPathTest, EmptyProc) {
   EXPECT_TRUE(cp.empty());
 }
 
+TEST_F(AnalyzeCriticalPathTest, StageCriticalPathReport) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto rev_neg_x = fb.Reverse(neg_x);
+  auto neg_y = fb.Negate(y);
+  auto sum = fb.Add(rev_neg_x, neg_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  absl::flat_hash_map<Node*, int64_t> cycle_map = {
+      {x.node(), 0},     {y.node(), 0},         {neg_x.node(), 0},
+      {neg_y.node(), 0}, {rev_neg_x.node(), 1}, {sum.node(), 1}};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CriticalPathReportProto report,
+      AnalyzeStageCriticalPaths(
+          f, cycle_map, /*clock_period_ps=*/4, *delay_estimator_,
+          CriticalPathReportOptions{.paths_per_stage = 1,
+                                    .slack_bucket_ps = 1}));
+
+  ASSERT_EQ(report.stages_size(), 2);
+  // Both negations leave stage 0 with a slack of 3ps.
+  const StageCriticalPathReportProto& stage0 = report.stages(0);
+  ASSERT_EQ(stage0.paths_size(), 1);
+  EXPECT_EQ(stage0.paths(0).total_delay_ps(), 1);
+  ASSERT_EQ(stage0.slack_histogram_size(), 1);
+  EXPECT_EQ(stage0.slack_histogram(0).min_slack_ps(), 3);
+  EXPECT_EQ(stage0.slack_histogram(0).count(), 2);
+
+  // The path of stage 1 starts at the reverse, not at the negation of stage 0.
+  const StageCriticalPathReportProto& stage1 = report.stages(1);
+  ASSERT_EQ(stage1.paths_size(), 1);
+  EXPECT_EQ(stage1.paths(0).total_delay_ps(), 2);
+  ASSERT_EQ(stage1.paths(0).nodes_size(), 2);
+  EXPECT_EQ(stage1.paths(0).nodes(0).id(), sum.node()->id());
+  EXPECT_EQ(stage1.paths(0).nodes(1).id(), rev_neg_x.node()->id());
+  ASSERT_EQ(stage1.slack_histogram_size(), 1);
+  EXPECT_EQ(stage1.slack_histogram(0).min_slack_ps(), 2);
+  EXPECT_EQ(stage1.op_contributions_size(), 2);
+
+  EXPECT_THAT(CriticalPathReportToChromeTrace(report),
+              HasSubstr(R"("ph":"X")"));
+}
+
 }  // namespace
 }  // namespace xls
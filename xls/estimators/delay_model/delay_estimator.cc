@@ -17,23 +17,36 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "absl/base/no_destructor.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/die_if_null.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/logical_effort.h"
 
@@ -219,6 +232,84 @@ namespace {
 
 }  // namespace
 
+absl::StatusOr<absl::flat_hash_map<Node*, int64_t>>
+DelayEstimator::GetOperationDelaysInPs(FunctionBase* f) const {
+  absl::flat_hash_map<Node*, int64_t> delays;
+  delays.reserve(f->node_count());
+  for (Node* node : f->nodes()) {
+    XLS_ASSIGN_OR_RETURN(delays[node], GetOperationDelayInPs(node));
+  }
+  return delays;
+}
+
+namespace {
+
+// The features of an operation which the generated delay models depend on.
+// Types are uniqued within a package so they can be compared by pointer.
+struct OperationShape {
+  Op op;
+  Type* type;
+  // The type of each operand and whether it is a literal.
+  absl::InlinedVector<std::pair<Type*, bool>, 3> operands;
+  bool operands_identical;
+
+  bool operator==(const OperationShape& other) const = default;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const OperationShape& shape) {
+    return H::combine(std::move(h), shape.op, shape.type, shape.operands,
+                      shape.operands_identical);
+  }
+};
+
+OperationShape GetOperationShape(Node* node) {
+  OperationShape shape{.op = node->op(),
+                       .type = node->GetType(),
+                       .operands_identical = true};
+  shape.operands.reserve(node->operand_count());
+  for (Node* operand : node->operands()) {
+    shape.operands.push_back({operand->GetType(), operand->Is<Literal>()});
+    shape.operands_identical &= operand == node->operand(0);
+  }
+  return shape;
+}
+
+}  // namespace
+
+absl::StatusOr<absl::flat_hash_map<Node*, int64_t>> GetOperationDelaysByShape(
+    FunctionBase* f,
+    absl::FunctionRef<absl::StatusOr<int64_t>(Node*)> delay_fn) {
+  // Map every node to the index of its shape, keeping one representative node
+  // per shape, then evaluate the delay function on the representatives only.
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  std::vector<int64_t> shape_indices;
+  shape_indices.reserve(nodes.size());
+  std::vector<Node*> representatives;
+  absl::flat_hash_map<OperationShape, int64_t> shapes;
+  for (Node* node : nodes) {
+    auto [it, inserted] =
+        shapes.try_emplace(GetOperationShape(node), representatives.size());
+    if (inserted) {
+      representatives.push_back(node);
+    }
+    shape_indices.push_back(it->second);
+  }
+
+  std::vector<int64_t> shape_delays;
+  shape_delays.reserve(representatives.size());
+  for (Node* node : representatives) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay, delay_fn(node));
+    shape_delays.push_back(delay);
+  }
+
+  absl::flat_hash_map<Node*, int64_t> delays;
+  delays.reserve(nodes.size());
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    delays.emplace(nodes[i], shape_delays[shape_indices[i]]);
+  }
+  return delays;
+}
+
 DecoratingDelayEstimator::DecoratingDelayEstimator(
     std::string_view name, const DelayEstimator& decorated,
     std::function<int64_t(Node*, int64_t)> modifier)
@@ -233,6 +324,15 @@ absl::StatusOr<int64_t> DecoratingDelayEstimator::GetOperationDelayInPs(
   return modifier_(node, original);
 }
 
+absl::StatusOr<absl::flat_hash_map<Node*, int64_t>>
+DecoratingDelayEstimator::GetOperationDelaysInPs(FunctionBase* f) const {
+  XLS_ASSIGN_OR_RETURN(auto delays, decorated_.GetOperationDelaysInPs(f));
+  for (auto& [node, delay] : delays) {
+    delay = modifier_(node, delay);
+  }
+  return delays;
+}
+
 FirstMatchDelayEstimator::FirstMatchDelayEstimator(
     std::string_view name, std::vector<const DelayEstimator*> estimators)
     : DelayEstimator(name), estimators_(std::move(estimators)) {}
@@ -264,6 +364,149 @@ absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
   return delay;
 }
 
+/* static */ StructuralDelayCache& StructuralDelayCache::Global() {
+  static absl::NoDestructor<StructuralDelayCache> cache;
+  return *cache;
+}
+
+/* static */ std::string StructuralDelayCache::StructuralKey(Node* node) {
+  std::string key = absl::StrCat(OpToString(node->op()), " ",
+                                 node->GetType()->ToString(), "(");
+  for (Node* operand : node->operands()) {
+    absl::StrAppend(&key, operand->GetType()->ToString());
+    if (operand->Is<Literal>()) {
+      absl::StrAppend(&key, "=", operand->As<Literal>()->value().ToString());
+    }
+    absl::StrAppend(&key, ",");
+  }
+  absl::StrAppend(&key, ")");
+
+  // Attributes which are not implied by the types.
+  auto append_callee = [&](FunctionBase* callee) {
+    absl::StrAppend(&key, " callee=", callee->name());
+    if (callee->ForeignFunctionData().has_value() &&
+        callee->ForeignFunctionData()->has_delay_ps()) {
+      absl::StrAppend(&key,
+                      " ffi_delay=", callee->ForeignFunctionData()->delay_ps());
+    }
+  };
+  switch (node->op()) {
+    case Op::kBitSlice:
+      absl::StrAppend(&key, " start=", node->As<BitSlice>()->start());
+      break;
+    case Op::kTupleIndex:
+      absl::StrAppend(&key, " index=", node->As<TupleIndex>()->index());
+      break;
+    case Op::kOneHot:
+      absl::StrAppend(&key, " priority=",
+                      static_cast<int>(node->As<OneHot>()->priority()));
+      break;
+    case Op::kMinDelay:
+      absl::StrAppend(&key, " delay=", node->As<MinDelay>()->delay());
+      break;
+    case Op::kInvoke:
+      append_callee(node->As<Invoke>()->to_apply());
+      // The FFI delay estimator also looks at the function containing the
+      // invoke.
+      if (node->function_base()->ForeignFunctionData().has_value() &&
+          node->function_base()->ForeignFunctionData()->has_delay_ps()) {
+        absl::StrAppend(
+            &key, " caller_ffi_delay=",
+            node->function_base()->ForeignFunctionData()->delay_ps());
+      }
+      break;
+    case Op::kMap:
+      append_callee(node->As<Map>()->to_apply());
+      break;
+    case Op::kCountedFor:
+      append_callee(node->As<CountedFor>()->body());
+      break;
+    case Op::kDynamicCountedFor:
+      append_callee(node->As<DynamicCountedFor>()->body());
+      break;
+    default:
+      break;
+  }
+  return key;
+}
+
+std::optional<int64_t> StructuralDelayCache::Get(
+    std::string_view estimator_name, std::string_view key) const {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = delays_.find(
+      std::make_pair(std::string(estimator_name), std::string(key)));
+  if (it == delays_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void StructuralDelayCache::Put(std::string_view estimator_name,
+                               std::string_view key, int64_t delay) {
+  absl::WriterMutexLock lock(&mutex_);
+  delays_.try_emplace(
+      std::make_pair(std::string(estimator_name), std::string(key)), delay);
+}
+
+int64_t StructuralDelayCache::size() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return delays_.size();
+}
+
+void StructuralDelayCache::Clear() {
+  absl::WriterMutexLock lock(&mutex_);
+  delays_.clear();
+}
+
+// The file holds one entry per line: the estimator name, the key and the
+// delay, separated by tabs.
+absl::Status StructuralDelayCache::Load(const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  absl::WriterMutexLock lock(&mutex_);
+  for (std::string_view line :
+       absl::StrSplit(contents, '\n', absl::SkipEmpty())) {
+    std::vector<std::string_view> fields = absl::StrSplit(line, '\t');
+    int64_t delay;
+    if (fields.size() != 3 || !absl::SimpleAtoi(fields[2], &delay)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Malformed delay cache entry in %s: `%s`", path.string(), line));
+    }
+    delays_.try_emplace(
+        std::make_pair(std::string(fields[0]), std::string(fields[1])), delay);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status StructuralDelayCache::Save(
+    const std::filesystem::path& path) const {
+  std::string contents;
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    for (const auto& [name_and_key, delay] : delays_) {
+      absl::StrAppend(&contents, name_and_key.first, "\t", name_and_key.second,
+                      "\t", delay, "\n");
+    }
+  }
+  return SetFileContents(path, contents);
+}
+
+StructuralCachingDelayEstimator::StructuralCachingDelayEstimator(
+    std::string_view name, const DelayEstimator& cached,
+    StructuralDelayCache& cache)
+    : DelayEstimator(name), cached_(cached), cache_(cache) {}
+
+absl::StatusOr<int64_t> StructuralCachingDelayEstimator::GetOperationDelayInPs(
+    Node* node) const {
+  std::string key = StructuralDelayCache::StructuralKey(node);
+  if (std::optional<int64_t> delay = cache_.Get(name(), key);
+      delay.has_value()) {
+    return *delay;
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t delay, cached_.GetOperationDelayInPs(node));
+  cache_.Put(name(), key, delay);
+  return delay;
+}
+
 /* static */ absl::StatusOr<int64_t> DelayEstimator::GetLogicalEffortDelayInPs(
     Node* node, int64_t tau_in_ps) {
   XLS_ASSIGN_OR_RETURN(int64_t delay_in_tau, GetLogicalEffortDelayInTau(node));
@@ -16,8 +16,10 @@
 #define XLS_ESTIMATORS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -25,11 +27,13 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -45,6 +49,13 @@ class DelayEstimator {
   // Returns the estimated delay of the given node in picoseconds.
   virtual absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const = 0;
 
+  // Returns the estimated delays of all nodes of `f` in picoseconds, or the
+  // first error encountered. Schedulers and other clients which need every
+  // node's delay should prefer this over per-node calls. The default
+  // implementation calls GetOperationDelayInPs on each node.
+  virtual absl::StatusOr<absl::flat_hash_map<Node*, int64_t>>
+  GetOperationDelaysInPs(FunctionBase* f) const;
+
   // Compute the delay of the given node using logical effort estimation. Only
   // relatively simple operations (kAnd, kOr, etc) are supported using this
   // method.
@@ -55,6 +66,15 @@ class DelayEstimator {
   std::string name_;
 };
 
+// Computes the delays of all nodes of `f` by calling `delay_fn` once per
+// distinct operation shape: the op, the result and operand types, which
+// operands are literals and whether all operands are the same node. Only valid
+// for delay functions which depend on nothing else, such as the generated
+// delay models.
+absl::StatusOr<absl::flat_hash_map<Node*, int64_t>> GetOperationDelaysByShape(
+    FunctionBase* f,
+    absl::FunctionRef<absl::StatusOr<int64_t>(Node*)> delay_fn);
+
 // Decorates an underlying delay estimator with an overriding modifier function.
 class DecoratingDelayEstimator : public DelayEstimator {
  public:
@@ -65,6 +85,8 @@ class DecoratingDelayEstimator : public DelayEstimator {
   ~DecoratingDelayEstimator() override = default;
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
+  absl::StatusOr<absl::flat_hash_map<Node*, int64_t>> GetOperationDelaysInPs(
+      FunctionBase* f) const override;
 
  private:
   const DelayEstimator& decorated_;
@@ -122,6 +144,59 @@ class CachingDelayEstimator : public DelayEstimator {
       ABSL_GUARDED_BY(cache_mutex_);
 };
 
+// A cache of operation delays keyed on the structure of the operation rather
+// than on the node itself: its op, result and operand types, the values of
+// literal operands and the attributes which affect delay. Entries stay valid
+// when passes rewrite nodes and are shared between packages. This class is
+// safe for concurrent access.
+class StructuralDelayCache {
+ public:
+  // Returns the process-wide cache.
+  static StructuralDelayCache& Global();
+
+  // Returns the structural key of the given node. Nodes with equal keys have
+  // equal delays under any delay estimator in the tree.
+  static std::string StructuralKey(Node* node);
+
+  std::optional<int64_t> Get(std::string_view estimator_name,
+                             std::string_view key) const;
+  void Put(std::string_view estimator_name, std::string_view key,
+           int64_t delay);
+
+  int64_t size() const;
+  void Clear();
+
+  // Adds the entries stored in the given file, which must have been written
+  // by Save. Existing entries take precedence.
+  absl::Status Load(const std::filesystem::path& path);
+  absl::Status Save(const std::filesystem::path& path) const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::pair<std::string, std::string>, int64_t> delays_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// Caches the delays of an underlying delay estimator in a
+// StructuralDelayCache, by default the process-wide one. Only successful
+// estimates are cached. The cache entries are keyed on `name`, so estimators
+// which may give different delays for the same operation must have different
+// names. This class is safe for concurrent access.
+class StructuralCachingDelayEstimator : public DelayEstimator {
+ public:
+  StructuralCachingDelayEstimator(
+      std::string_view name, const DelayEstimator& cached,
+      StructuralDelayCache& cache = StructuralDelayCache::Global());
+
+  ~StructuralCachingDelayEstimator() override = default;
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
+
+ private:
+  const DelayEstimator& cached_;
+  StructuralDelayCache& cache_;
+};
+
 enum class DelayEstimatorPrecedence {
   kLow = 1,
   kMedium = 2,
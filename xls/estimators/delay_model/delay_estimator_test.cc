@@ -24,11 +24,15 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
 
 namespace xls {
 
@@ -304,6 +308,88 @@ TEST_F(DelayEstimatorTest, CachingDelayEstimator) {
   EXPECT_THAT(caching.GetNodeDelay(f->return_value()), 1);
 }
 
+// A delay estimator which counts how often it is queried.
+class CountingDelayEstimator : public DelayEstimator {
+ public:
+  CountingDelayEstimator() : DelayEstimator("counting") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    ++queries_;
+    return node->BitCountOrDie();
+  }
+
+  int64_t queries() const { return queries_; }
+
+ private:
+  mutable int64_t queries_ = 0;
+};
+
+TEST_F(DelayEstimatorTest, StructuralCachingDelayEstimator) {
+  CountingDelayEstimator counting;
+  StructuralDelayCache cache;
+  StructuralCachingDelayEstimator caching("caching", counting, cache);
+
+  // Structurally equal nodes in different packages share one entry.
+  std::vector<Node*> xors;
+  std::vector<std::unique_ptr<Package>> packages;
+  for (int64_t width : {8, 8, 16}) {
+    packages.push_back(CreatePackage());
+    FunctionBuilder fb(TestName(), packages.back().get());
+    BValue x = fb.Param("x", packages.back()->GetBitsType(width));
+    BValue y = fb.Param("y", packages.back()->GetBitsType(width));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                             fb.BuildWithReturnValue(fb.Xor(x, y)));
+    xors.push_back(f->return_value());
+  }
+  EXPECT_THAT(caching.GetOperationDelayInPs(xors[0]), IsOkAndHolds(8));
+  EXPECT_THAT(caching.GetOperationDelayInPs(xors[1]), IsOkAndHolds(8));
+  EXPECT_EQ(counting.queries(), 1);
+  EXPECT_THAT(caching.GetOperationDelayInPs(xors[2]), IsOkAndHolds(16));
+  EXPECT_EQ(counting.queries(), 2);
+  EXPECT_EQ(cache.size(), 2);
+
+  // The entries survive a round trip through a file.
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp_file, TempFile::Create());
+  XLS_ASSERT_OK(cache.Save(temp_file.path()));
+  StructuralDelayCache loaded;
+  XLS_ASSERT_OK(loaded.Load(temp_file.path()));
+  EXPECT_EQ(loaded.size(), 2);
+  EXPECT_EQ(loaded.Get("caching", StructuralDelayCache::StructuralKey(xors[2])),
+            16);
+}
+
+TEST_F(DelayEstimatorTest, GetOperationDelaysByShape) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue xor_xy = fb.Xor(x, y);
+  BValue xor_yx = fb.Xor(y, x);
+  BValue xor_xx = fb.Xor(x, x);
+  BValue xor_literal = fb.Xor(x, fb.Literal(UBits(1, 8)));
+  BValue concat = fb.Concat({xor_xy, xor_yx, xor_xx, xor_literal});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(concat));
+
+  CountingDelayEstimator counting;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto delays, GetOperationDelaysByShape(f, [&](Node* node) {
+        return counting.GetOperationDelayInPs(node);
+      }));
+  // One query each for the params, the literal, the two-operand xors, the
+  // identical-operand xor, the xor with a literal and the concat.
+  EXPECT_EQ(counting.queries(), 6);
+  EXPECT_EQ(delays.size(), f->node_count());
+  EXPECT_EQ(delays.at(xor_yx.node()), 8);
+  EXPECT_EQ(delays.at(concat.node()), 32);
+
+  // Decorating estimators apply their modifier to bulk results.
+  DecoratingDelayEstimator decorating(
+      "decorating", counting,
+      [](Node* n, int64_t original) { return original + 1; });
+  XLS_ASSERT_OK_AND_ASSIGN(delays, decorating.GetOperationDelaysInPs(f));
+  EXPECT_EQ(delays.at(xor_xx.node()), 9);
+}
+
 // A Delay Estimator that can only handle one kind of operation.
 class TestNodeMatchEstimator : public DelayEstimator {
  public:
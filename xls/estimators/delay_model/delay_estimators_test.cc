@@ -14,13 +14,18 @@
 
 #include "xls/estimators/delay_model/delay_estimators.h"
 
+#include <string_view>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status_matchers.h"
 #include "xls/common/status/matchers.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 
 namespace xls {
 namespace {
@@ -49,5 +54,32 @@ TEST_F(DelayEstimatorsTest, UnitDelayModel) {
   EXPECT_THAT(estimator->GetOperationDelayInPs(tuple.node()), IsOkAndHolds(1));
 }
 
+TEST_F(DelayEstimatorsTest, BulkDelaysMatchPerNodeDelays) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  BValue add_same = fb.Add(x, x);
+  BValue shift = fb.Shll(add, fb.Literal(UBits(3, 5)));
+  BValue mul = fb.UMul(add_same, shift);
+  BValue sum = fb.Add(mul, fb.Add(y, x));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({sum, add})));
+
+  for (std::string_view name : {"unit", "asap7", "sky130"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * estimator,
+                             GetDelayEstimator(name));
+    XLS_ASSERT_OK_AND_ASSIGN(auto delays,
+                             estimator->GetOperationDelaysInPs(f));
+    EXPECT_EQ(delays.size(), f->node_count());
+    for (Node* node : f->nodes()) {
+      EXPECT_THAT(estimator->GetOperationDelayInPs(node),
+                  IsOkAndHolds(delays.at(node)))
+          << name << ": " << node->ToString();
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -154,6 +154,10 @@ def _do_config_task(config: WorkerConfig):
   )
 
   if config.openroad_path:
+    # Each target gets its own checkpoint as results differ between PDKs.
+    if config.client_checkpoint_file:
+      root, ext = os.path.splitext(config.client_checkpoint_file)
+      config.client_checkpoint_file = f'{root}_{config.target}{ext}'
     # Expect OpenROAD-flow-scripts to hold tools
     config.yosys_bin = f'{config.openroad_path}/tools/install/yosys/bin/yosys'
     config.sta_bin = f'{config.openroad_path}/tools/install/OpenROAD/bin/sta'
@@ -366,6 +370,7 @@ def _do_worker_task(config: WorkerConfig):
   client.extend(repr(arg) for arg in config.client_args)
   client.extend(repr(arg) for arg in config.client_extra_args)
   client.append(f'--port={config.rpc_port}')
+  client.append(f'--target={config.target}')
 
   client_cmd = ' '.join(client)
   # create a checkpoint file if not already there
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <queue>
 #include <tuple>
 #include <vector>
 
@@ -43,34 +44,75 @@ DelayManager::DelayManager(FunctionBase *function,
                            const DelayEstimator &delay_estimator)
     : function_(function),
       index_to_node_(function_->node_count()),
-      indices_to_delay_(function_->node_count(),
-                        std::vector<int64_t>(function_->node_count(), -1)),
-      indices_to_critical_operand_(
-          function_->node_count(),
-          std::vector<Node *>(function_->node_count(), nullptr)),
+      topo_position_(function_->node_count()),
+      paths_to_(function_->node_count()),
+      dirty_(function_->node_count(), true),
       name_(delay_estimator.name()) {
   // Get the mapping between function node and their index. Also, estimate the
   // delay of each node.
+  absl::StatusOr<absl::flat_hash_map<Node *, int64_t>> delays =
+      delay_estimator.GetOperationDelaysInPs(function_);
+  CHECK_OK(delays.status());
   node_to_index_.reserve(function_->node_count());
   int32_t index = 0;
   for (Node *node : function_->nodes()) {
     node_to_index_[node] = index;
     index_to_node_[index] = node;
-    absl::StatusOr<int64_t> maybe_delay =
-        delay_estimator.GetOperationDelayInPs(node);
-    CHECK_OK(maybe_delay.status());
-    indices_to_delay_[index][index] = maybe_delay.value();
+    paths_to_[index].push_back(PathDelay{
+        .source = index, .critical_operand = -1, .delay = delays->at(node)});
     index++;
   }
+  int64_t position = 0;
+  for (Node *node : TopoSort(function_)) {
+    topo_position_[node_to_index_.at(node)] = position++;
+  }
   PropagateDelays();
 }
 
+const DelayManager::PathDelay *DelayManager::FindPath(int64_t from,
+                                                      int64_t to) const {
+  const std::vector<PathDelay> &paths = paths_to_[to];
+  auto it = std::lower_bound(
+      paths.begin(), paths.end(), from,
+      [](const PathDelay &path, int64_t source) {
+        return path.source < source;
+      });
+  if (it == paths.end() || it->source != from) {
+    return nullptr;
+  }
+  return &*it;
+}
+
+DelayManager::PathDelay *DelayManager::FindPath(int64_t from, int64_t to) {
+  return const_cast<PathDelay *>(
+      static_cast<const DelayManager *>(this)->FindPath(from, to));
+}
+
+DelayManager::PathDelay &DelayManager::InsertPath(int64_t from, int64_t to,
+                                                  int64_t delay,
+                                                  int32_t critical_operand) {
+  std::vector<PathDelay> &paths = paths_to_[to];
+  auto it = std::lower_bound(
+      paths.begin(), paths.end(), from,
+      [](const PathDelay &path, int64_t source) {
+        return path.source < source;
+      });
+  return *paths.insert(it, PathDelay{.source = static_cast<int32_t>(from),
+                                     .critical_operand = critical_operand,
+                                     .delay = delay});
+}
+
+int64_t DelayManager::Delay(int64_t from, int64_t to) const {
+  const PathDelay *path = FindPath(from, to);
+  return path == nullptr ? -1 : path->delay;
+}
+
 absl::StatusOr<int64_t> DelayManager::GetNodeDelay(Node *node) const {
   if (node->function_base() != function_) {
     return absl::InvalidArgumentError("invalid node");
   }
   int64_t node_index = node_to_index_.at(node);
-  return indices_to_delay_[node_index][node_index];
+  return Delay(node_index, node_index);
 }
 
 absl::StatusOr<int64_t> DelayManager::GetCriticalPathDelay(Node *from,
@@ -80,7 +122,7 @@ absl::StatusOr<int64_t> DelayManager::GetCriticalPathDelay(Node *from,
   }
   int64_t from_index = node_to_index_.at(from);
   int64_t to_index = node_to_index_.at(to);
-  return indices_to_delay_[from_index][to_index];
+  return Delay(from_index, to_index);
 }
 
 absl::Status DelayManager::SetCriticalPathDelay(Node *from, Node *to,
@@ -91,10 +133,21 @@ absl::Status DelayManager::SetCriticalPathDelay(Node *from, Node *to,
   }
   int64_t from_index = node_to_index_.at(from);
   int64_t to_index = node_to_index_.at(to);
-  int64_t &current_delay = indices_to_delay_[from_index][to_index];
+  PathDelay *path = FindPath(from_index, to_index);
+  int64_t current_delay = path == nullptr ? -1 : path->delay;
   if (!if_shorter || current_delay > delay) {
     if (!if_exist || current_delay != -1) {
-      current_delay = delay;
+      if (path == nullptr) {
+        InsertPath(from_index, to_index, delay, /*critical_operand=*/-1);
+      } else {
+        path->delay = delay;
+      }
+      if (from_index == to_index) {
+        // The delay of a node is part of every path through it.
+        std::fill(dirty_.begin(), dirty_.end(), true);
+      } else {
+        dirty_[to_index] = true;
+      }
     }
   }
   return absl::OkStatus();
@@ -106,88 +159,160 @@ absl::StatusOr<std::vector<Node *>> DelayManager::GetFullCriticalPath(
   int64_t to_index = node_to_index_.at(to);
   std::vector<Node *> critical_path;
 
-  Node *critical_operand = indices_to_critical_operand_[from_index][to_index];
+  auto critical_operand_of = [&](int64_t index) -> int64_t {
+    const PathDelay *path = FindPath(from_index, index);
+    return path == nullptr ? -1 : path->critical_operand;
+  };
+  int64_t critical_operand = critical_operand_of(to_index);
   critical_path.push_back(to);
-  while (critical_operand != nullptr && critical_operand != from) {
-    critical_path.push_back(critical_operand);
-    int64_t critical_operand_index = node_to_index_.at(critical_operand);
-    critical_operand =
-        indices_to_critical_operand_[from_index][critical_operand_index];
+  while (critical_operand != -1 && critical_operand != from_index) {
+    critical_path.push_back(index_to_node_[critical_operand]);
+    critical_operand = critical_operand_of(critical_operand);
   }
-  XLS_RET_CHECK(critical_operand == from);
+  XLS_RET_CHECK(critical_operand == from_index);
   critical_path.push_back(from);
   std::reverse(critical_path.begin(), critical_path.end());
   return critical_path;
 }
 
-void DelayManager::PropagateDelays() {
-  // Traverse the function in a reversed topological order.
-  for (Node *node : ReverseTopoSort(function_)) {
-    int64_t node_index = node_to_index_[node];
-    int64_t node_delay = indices_to_delay_[node_index][node_index];
-    std::vector<int64_t> new_delays(function_->node_count(), -1);
-
-    // Compute the critical-path distance from `a` to `node` for all nodes `a`
-    // from the delays of `a` to each operand of `node`.
+bool DelayManager::UpdatePathsFromUsers(int64_t to) {
+  // The delays of the paths to `to`, keyed by source index.
+  absl::flat_hash_map<int64_t, int64_t> delays;
+  delays.reserve(paths_to_[to].size());
+  for (const PathDelay &path : paths_to_[to]) {
+    delays[path.source] = path.delay;
+  }
+
+  // Visit every node with a user on a path to `to` in a reversed topological
+  // order.
+  auto later = [&](int64_t a, int64_t b) {
+    return topo_position_[a] < topo_position_[b];
+  };
+  std::priority_queue<int64_t, std::vector<int64_t>, decltype(later)> worklist(
+      later);
+  absl::flat_hash_set<int64_t> visited;
+  auto enqueue_operands = [&](int64_t index) {
+    for (Node *operand : index_to_node_[index]->operands()) {
+      int64_t operand_index = node_to_index_.at(operand);
+      if (visited.insert(operand_index).second) {
+        worklist.push(operand_index);
+      }
+    }
+  };
+  for (const PathDelay &path : paths_to_[to]) {
+    enqueue_operands(path.source);
+  }
+
+  bool changed = false;
+  while (!worklist.empty()) {
+    int64_t node_index = worklist.top();
+    worklist.pop();
+    Node *node = index_to_node_[node_index];
+
+    // Compute the critical-path distance from `node` to `to` from the delays
+    // of each user of `node` to `to`.
+    int64_t new_delay = -1;
     for (Node *user : node->users()) {
-      int64_t user_index = node_to_index_[user];
-      for (int64_t i = 0; i < function_->node_count(); ++i) {
-        int64_t from_user_delay = indices_to_delay_[user_index][i];
-        if (from_user_delay != -1) {
-          // Always pick the critical path.
-          if (new_delays[i] < from_user_delay + node_delay) {
-            new_delays[i] = from_user_delay + node_delay;
-          }
-        }
+      auto it = delays.find(node_to_index_.at(user));
+      if (it != delays.end()) {
+        // Always pick the critical path.
+        new_delay = std::max(new_delay, it->second);
       }
     }
+    if (new_delay == -1) {
+      continue;
+    }
+    new_delay += Delay(node_index, node_index);
 
     // Update the original delay if the newly calculated delay is smaller.
-    for (int64_t i = 0; i < function_->node_count(); ++i) {
-      if (new_delays[i] != -1) {
-        int64_t &current_delay = indices_to_delay_[node_index][i];
-        if (current_delay >= new_delays[i] || current_delay == -1) {
-          current_delay = new_delays[i];
-        }
-      }
+    auto [it, inserted] = delays.try_emplace(node_index, new_delay);
+    if (inserted) {
+      InsertPath(node_index, to, new_delay, /*critical_operand=*/-1);
+      changed = true;
+    } else if (it->second >= new_delay) {
+      changed |= it->second != new_delay;
+      it->second = new_delay;
+      FindPath(node_index, to)->delay = new_delay;
     }
+    enqueue_operands(node_index);
   }
+  return changed;
+}
 
-  // Traverse the function in a topological order.
-  for (Node *node : TopoSort(function_)) {
-    int64_t node_index = node_to_index_[node];
-    int64_t node_delay = indices_to_delay_[node_index][node_index];
-    std::vector<int64_t> new_delays(function_->node_count(), -1);
-    std::vector<Node *> new_critical_operands(function_->node_count(), nullptr);
-
-    // Compute the critical-path distance from `a` to `node` for all nodes `a`
-    // from the delays of `a` to each operand of `node`.
-    for (Node *operand : node->operands()) {
-      int64_t operand_index = node_to_index_[operand];
-      for (int64_t i = 0; i < function_->node_count(); ++i) {
-        int64_t to_operand_delay = indices_to_delay_[i][operand_index];
-        if (to_operand_delay != -1) {
-          // Always pick the critical path.
-          if (new_delays[i] < to_operand_delay + node_delay) {
-            new_delays[i] = to_operand_delay + node_delay;
-            new_critical_operands[i] = operand;
-          }
-        }
+bool DelayManager::UpdatePathsFromOperands(int64_t to) {
+  Node *node = index_to_node_[to];
+  int64_t node_delay = Delay(to, to);
+
+  // Compute the critical-path distance from `a` to `node` for all nodes `a`
+  // from the delays of `a` to each operand of `node`.
+  absl::flat_hash_map<int64_t, PathDelay> new_paths;
+  for (Node *operand : node->operands()) {
+    int64_t operand_index = node_to_index_.at(operand);
+    for (const PathDelay &path : paths_to_[operand_index]) {
+      auto [it, inserted] = new_paths.try_emplace(
+          path.source,
+          PathDelay{.source = path.source,
+                    .critical_operand = static_cast<int32_t>(operand_index),
+                    .delay = path.delay + node_delay});
+      // Always pick the critical path.
+      if (!inserted && it->second.delay < path.delay + node_delay) {
+        it->second.delay = path.delay + node_delay;
+        it->second.critical_operand = static_cast<int32_t>(operand_index);
       }
     }
+  }
 
-    // Update the original delay if the newly calculated delay is smaller.
-    for (int64_t i = 0; i < function_->node_count(); ++i) {
-      if (new_delays[i] != -1) {
-        int64_t &current_delay = indices_to_delay_[i][node_index];
-        if (current_delay >= new_delays[i] || current_delay == -1) {
-          current_delay = new_delays[i];
-          indices_to_critical_operand_[i][node_index] =
-              new_critical_operands[i];
-        }
-      }
+  // Update the original delay if the newly calculated delay is smaller.
+  bool changed = false;
+  std::vector<PathDelay> &paths = paths_to_[to];
+  for (PathDelay &path : paths) {
+    auto it = new_paths.find(path.source);
+    if (it == new_paths.end()) {
+      continue;
+    }
+    if (path.delay >= it->second.delay) {
+      changed |= path.delay != it->second.delay;
+      path = it->second;
     }
+    new_paths.erase(it);
   }
+  if (!new_paths.empty()) {
+    for (const auto &[source, path] : new_paths) {
+      paths.push_back(path);
+    }
+    std::sort(paths.begin(), paths.end(),
+              [](const PathDelay &a, const PathDelay &b) {
+                return a.source < b.source;
+              });
+    changed = true;
+  }
+  return changed;
+}
+
+void DelayManager::PropagateDelays() {
+  std::vector<bool> changed(function_->node_count(), false);
+  for (int64_t i = 0; i < function_->node_count(); ++i) {
+    if (dirty_[i]) {
+      UpdatePathsFromUsers(i);
+      changed[i] = true;
+    }
+  }
+
+  // Traverse the function in a topological order, only revisiting the nodes
+  // whose delays may have changed.
+  for (Node *node : TopoSort(function_)) {
+    int64_t node_index = node_to_index_.at(node);
+    bool operand_changed = std::any_of(
+        node->operands().begin(), node->operands().end(),
+        [&](Node *operand) { return changed[node_to_index_.at(operand)]; });
+    if (!changed[node_index] && !operand_changed) {
+      continue;
+    }
+    if (UpdatePathsFromOperands(node_index)) {
+      changed[node_index] = true;
+    }
+  }
+  std::fill(dirty_.begin(), dirty_.end(), false);
 }
 
 absl::flat_hash_map<Node *, std::vector<Node *>>
@@ -196,12 +321,11 @@ DelayManager::GetPathsOverDelayThreshold(int64_t delay_threshold) const {
   if (delay_threshold < 0) {
     return paths;
   }
-  for (int64_t i = 0; i < function_->node_count(); ++i) {
-    Node *from = index_to_node_[i];
-    for (int64_t j = 0; j < function_->node_count(); ++j) {
-      Node *to = index_to_node_[j];
-      if (indices_to_delay_[i][j] > delay_threshold) {
-        paths[from].push_back(to);
+  for (int64_t j = 0; j < function_->node_count(); ++j) {
+    Node *to = index_to_node_[j];
+    for (const PathDelay &path : paths_to_[j]) {
+      if (path.delay > delay_threshold) {
+        paths[index_to_node_[path.source]].push_back(to);
       }
     }
   }
@@ -217,65 +341,68 @@ absl::StatusOr<std::vector<PathInfo>> DelayManager::GetTopNPaths(
     XLS_RET_CHECK(options.cycle_map);
   }
 
-  // Traverse all nodes in the function and construct a worklist with score of
-  // each path.
+  // Traverse all connected pairs of nodes, ordered by source then target, and
+  // construct a worklist with score of each path.
+  std::vector<std::tuple<int64_t, int64_t, int64_t>> candidates;
+  for (int64_t j = 0; j < function_->node_count(); ++j) {
+    for (const PathDelay &path : paths_to_[j]) {
+      if (path.delay >= 0) {
+        candidates.emplace_back(path.source, j, path.delay);
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+
   std::vector<std::tuple<float, int64_t, Node *, Node *>> worklist;
-  for (int64_t i = 0; i < function_->node_count(); ++i) {
+  for (auto [i, j, delay] : candidates) {
     Node *from = index_to_node_[i];
-    for (int64_t j = 0; j < function_->node_count(); ++j) {
-      Node *to = index_to_node_[j];
-      int64_t delay = indices_to_delay_[i][j];
+    Node *to = index_to_node_[j];
+    if (options.exclude_single_node_path && from == to) {
+      continue;
+    }
+    if (options.exclude_param_source && from->Is<Param>()) {
+      continue;
+    }
 
-      if (delay < 0) {
+    if (options.combinational_only) {
+      const ScheduleCycleMap &cycle_map = *options.cycle_map;
+
+      // Because we only collect combinational paths, we always skip a path
+      // that is crossing different pipeline stages.
+      if (cycle_map.at(from) != cycle_map.at(to)) {
         continue;
       }
-      if (options.exclude_single_node_path && from == to) {
+      // If the source has operands and all operands are scheduled in the same
+      // clock cycle with the source, indicating the source is an internal
+      // node, skip it if applicable.
+      if (options.input_source_only && !from->operands().empty() &&
+          std::all_of(from->operands().begin(), from->operands().end(),
+                      [&](Node *operand) {
+                        return cycle_map.at(operand) == cycle_map.at(from) &&
+                               !operand->Is<Param>();
+                      })) {
         continue;
       }
-      if (options.exclude_param_source && from->Is<Param>()) {
+      // If the target has users and all users are scheduled in the same clock
+      // cycle with the target, indicating the target is an internal node,
+      // skip it if applicable.
+      if (options.output_target_only && !to->users().empty() &&
+          std::all_of(to->users().begin(), to->users().end(),
+                      [&](Node *user) {
+                        return cycle_map.at(user) == cycle_map.at(to);
+                      })) {
         continue;
       }
-
-      if (options.combinational_only) {
-        const ScheduleCycleMap &cycle_map = *options.cycle_map;
-
-        // Because we only collect combinational paths, we always skip a path
-        // that is crossing different pipeline stages.
-        if (cycle_map.at(from) != cycle_map.at(to)) {
-          continue;
-        }
-        // If the source has operands and all operands are scheduled in the same
-        // clock cycle with the source, indicating the source is an internal
-        // node, skip it if applicable.
-        if (options.input_source_only && !from->operands().empty() &&
-            std::all_of(from->operands().begin(), from->operands().end(),
-                        [&](Node *operand) {
-                          return cycle_map.at(operand) == cycle_map.at(from) &&
-                                 !operand->Is<Param>();
-                        })) {
-          continue;
-        }
-        // If the target has users and all users are scheduled in the same clock
-        // cycle with the target, indicating the target is an internal node,
-        // skip it if applicable.
-        if (options.output_target_only && !to->users().empty() &&
-            std::all_of(to->users().begin(), to->users().end(),
-                        [&](Node *user) {
-                          return cycle_map.at(user) == cycle_map.at(to);
-                        })) {
-          continue;
-        }
-      } else {
-        if (options.input_source_only && !from->operands().empty()) {
-          continue;
-        }
-        if (options.output_target_only && !to->users().empty()) {
-          continue;
-        }
+    } else {
+      if (options.input_source_only && !from->operands().empty()) {
+        continue;
+      }
+      if (options.output_target_only && !to->users().empty()) {
+        continue;
       }
-
-      worklist.emplace_back(score(from, to), delay, from, to);
     }
+
+    worklist.emplace_back(score(from, to), delay, from, to);
   }
 
   std::sort(worklist.begin(), worklist.end(), [](const auto &a, const auto &b) {
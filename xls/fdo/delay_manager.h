@@ -72,6 +72,10 @@ struct PathExtractOptions {
 // or proc. It allows users to update the delay between a certain pair of nodes,
 // re-calculate the critical delay of all pairs of nodes, extract paths longer
 // than a threshold, extract top-N longest paths, etc.
+//
+// Only pairs of nodes connected by a path (or given a delay explicitly) are
+// stored, so memory grows with the number of such pairs rather than with the
+// square of the number of nodes.
 class DelayManager {
  public:
   explicit DelayManager(FunctionBase *function,
@@ -101,6 +105,10 @@ class DelayManager {
   // topological order once. Note that this method is not optimal - it cannot
   // find the best combination of partial paths as Floyd–Warshall but it's
   // complexity is in O(n^2).
+  //
+  // The recalculation is incremental: the reversed pass only revisits the
+  // targets of paths set since the last call, and the forward pass only the
+  // nodes whose paths, or whose operands' paths, changed.
   void PropagateDelays();
 
   // Get all the paths whose delay is longer than the given delay threshold.
@@ -133,6 +141,29 @@ class DelayManager {
   static float GetZeroScore(Node *from, Node *to) { return 0.0; }
   static bool GetFalse(Node *from, Node *to) { return false; }
 
+  // The delay of a path ending at a given target node.
+  struct PathDelay {
+    // Index of the source node.
+    int32_t source;
+    // Index of the operand of the target on the critical path, or -1.
+    int32_t critical_operand;
+    // Both the source and target node delays are counted.
+    int64_t delay;
+  };
+
+  // Returns the delay of the path from `from` to `to`, or -1 if there is none.
+  int64_t Delay(int64_t from, int64_t to) const;
+  const PathDelay *FindPath(int64_t from, int64_t to) const;
+  PathDelay *FindPath(int64_t from, int64_t to);
+  PathDelay &InsertPath(int64_t from, int64_t to, int64_t delay,
+                        int32_t critical_operand);
+
+  // Recalculates the paths to `to` from the paths of the users of their
+  // sources (reversed pass) or from the paths to the operands of `to` (forward
+  // pass). Returns whether any path changed.
+  bool UpdatePathsFromUsers(int64_t to);
+  bool UpdatePathsFromOperands(int64_t to);
+
   FunctionBase *function_;
 
   // A mapping from a node to its index in the function.
@@ -141,14 +172,15 @@ class DelayManager {
   // A mapping from a node index to the corresponding node.
   std::vector<Node *> index_to_node_;
 
-  // An all-to-all delay mapping. The self-to-self delay of a node is defined as
-  // the delay of itself. If there is no valid path exists, the delay is defined
-  // as -1. Both the source and target node delays are counted.
-  std::vector<std::vector<int64_t>> indices_to_delay_;
+  // The position of each node index in a topological order.
+  std::vector<int64_t> topo_position_;
+
+  // For each target node index, the delays of the paths ending at it sorted by
+  // source index. The self-to-self delay of a node is the delay of itself.
+  std::vector<std::vector<PathDelay>> paths_to_;
 
-  // A all-to-all mapping from the source and target node indices to the
-  // critical operand of the target node.
-  std::vector<std::vector<Node *>> indices_to_critical_operand_;
+  // The target node indices whose paths were set since the last propagation.
+  std::vector<bool> dirty_;
 
   // Name of the delay estimator.
   const std::string name_;
@@ -19,7 +19,9 @@
 #include <string>
 #include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
 #include "absl/container/flat_hash_map.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
@@ -31,6 +33,8 @@
 namespace xls {
 namespace {
 
+using ::absl_testing::IsOkAndHolds;
+
 class DelayManagerTest : public IrTestBase {};
 
 // Smoke test.
@@ -176,5 +180,42 @@ fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
   EXPECT_EQ(new_udiv3_i0_delay, -1);
 }
 
+TEST_F(DelayManagerTest, DisconnectedNodes) {
+  std::string ir_text = R"(
+package p
+
+fn main(i0: bits[3], i1: bits[3]) -> (bits[3], bits[3]) {
+  neg.1: bits[3] = neg(i0)
+  neg.2: bits[3] = neg(i1)
+  add.3: bits[3] = add(neg.2, i1)
+  ret tuple.4: (bits[3], bits[3]) = tuple(neg.1, add.3)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetFunction("main"));
+  Node *i0 = FindNode("i0", function);
+  Node *i1 = FindNode("i1", function);
+  Node *neg1 = FindNode("neg.1", function);
+  Node *neg2 = FindNode("neg.2", function);
+  Node *add3 = FindNode("add.3", function);
+
+  DelayManager dm(function, TestDelayEstimator());
+
+  EXPECT_THAT(dm.GetCriticalPathDelay(i0, add3), IsOkAndHolds(-1));
+  EXPECT_THAT(dm.GetCriticalPathDelay(neg1, add3), IsOkAndHolds(-1));
+  EXPECT_THAT(dm.GetCriticalPathDelay(i1, add3), IsOkAndHolds(2));
+  EXPECT_THAT(dm.GetFullCriticalPath(i1, add3),
+              IsOkAndHolds(std::vector<Node *>({i1, neg2, add3})));
+  EXPECT_FALSE(dm.GetFullCriticalPath(i0, add3).ok());
+
+  // Only the paths through the updated pair change.
+  XLS_EXPECT_OK(dm.SetCriticalPathDelay(neg2, add3, 1));
+  dm.PropagateDelays();
+  EXPECT_THAT(dm.GetCriticalPathDelay(i1, add3), IsOkAndHolds(1));
+  EXPECT_THAT(dm.GetCriticalPathDelay(i0, neg1), IsOkAndHolds(1));
+  EXPECT_THAT(dm.GetCriticalPathDelay(i0, add3), IsOkAndHolds(-1));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,6 +14,8 @@
 
 #include "xls/fdo/synthesizer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -28,6 +30,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/block_generator.h"
@@ -41,33 +44,43 @@
 #include "xls/ir/block.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls {
 namespace synthesis {
 
+Synthesizer::Synthesizer(std::string_view name)
+    : name_(name), max_concurrency_(AvailableCPUs()) {}
+
 absl::StatusOr<std::vector<int64_t>>
 Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays(
     absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const {
-  // Launches multi-threading delay estimation.
-  std::vector<absl::StatusOr<int64_t>> results;
+  // Workers take the next unclaimed set of nodes until all are done, so no
+  // more than `max_concurrency_` syntheses run at once.
+  std::vector<absl::StatusOr<int64_t>> results(nodes_list.size(), 0);
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < nodes_list.size();
+         i = next_index.fetch_add(1)) {
+      results[i] = SynthesizeNodesAndGetDelay(nodes_list[i]);
+    }
+  };
+  int64_t thread_count = std::clamp<int64_t>(
+      max_concurrency_, 1, std::max<int64_t>(nodes_list.size(), 1));
   std::vector<std::unique_ptr<Thread>> threads;
-  results.reserve(nodes_list.size());
-  absl::StatusOr<int64_t> init_val = 0;
-  for (const absl::flat_hash_set<Node *> &nodes : nodes_list) {
-    results.push_back(init_val);
-    absl::StatusOr<int64_t> &dest = results.back();
-    // TODO(hanchenye): 2023-08-14 Use a thread pool structure that we can
-    // schedule on.
-    threads.push_back(std::make_unique<Thread>(
-        [&]() { dest = SynthesizeNodesAndGetDelay(nodes); }));
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
   }
-
-  // Records the estimated delays.
   for (auto &t : threads) {
     t->Join();
   }
+
+  // Records the estimated delays.
   std::vector<int64_t> delay_list;
   delay_list.reserve(results.size());
   for (absl::StatusOr<int64_t> result : results) {
@@ -83,12 +96,41 @@ absl::StatusOr<int64_t> Synthesizer::SynthesizeNodesAndGetDelay(
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> tmp_package,
                        ExtractNodes(nodes, top_name));
   XLS_ASSIGN_OR_RETURN(Function * f, tmp_package->GetFunction(top_name));
+  // Name the nodes by their position so the Verilog only depends on the
+  // structure of the node set and can serve as the cache key.
+  int64_t index = 0;
+  for (Node *node : TopoSort(f)) {
+    node->SetNameDirectly(
+        absl::StrFormat("%s%d", node->Is<Param>() ? "in" : "n", index++));
+  }
   XLS_ASSIGN_OR_RETURN(std::string verilog_text,
                        FunctionBaseToVerilog(f, /*flop_inputs_outputs=*/true));
   if (verilog_text.empty()) {
     return 0;
   }
-  return SynthesizeVerilogAndGetDelay(verilog_text, top_name);
+
+  CachedDelay *entry;
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    auto [it, inserted] = delay_cache_.try_emplace(verilog_text);
+    entry = &it->second;
+    if (!inserted) {
+      // Another thread may be synthesizing the same Verilog right now.
+      cache_mutex_.Await(absl::Condition(&entry->done));
+      if (entry->delay.ok()) {
+        ++cache_hits_;
+        return entry->delay;
+      }
+      // Failures are not cached; retry the synthesis.
+      entry->done = false;
+    }
+  }
+  absl::StatusOr<int64_t> delay =
+      SynthesizeVerilogAndGetDelay(verilog_text, top_name);
+  absl::MutexLock lock(&cache_mutex_);
+  entry->delay = delay;
+  entry->done = true;
+  return delay;
 }
 
 absl::StatusOr<int64_t> Synthesizer::SynthesizeFunctionBaseAndGetDelay(
@@ -22,11 +22,14 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -38,7 +41,7 @@ namespace synthesis {
 // An abstract class of a synthesis service.
 class Synthesizer {
  public:
-  explicit Synthesizer(std::string_view name) : name_(name) {}
+  explicit Synthesizer(std::string_view name);
   virtual ~Synthesizer() = default;
 
   const std::string &name() const { return name_; }
@@ -71,14 +74,44 @@ class Synthesizer {
       FunctionBase *f, bool flop_inputs_outputs) const;
 
   // Launches `SynthesizeNodesAndGetDelay` concurrently for each set of nodes
-  // listed in `nodes_list` and get their delays.
+  // listed in `nodes_list` and get their delays. At most `max_concurrency()`
+  // syntheses run at once.
   absl::StatusOr<std::vector<int64_t>> SynthesizeNodesConcurrentlyAndGetDelays(
       absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const;
 
+  // Sets/gets the maximum number of syntheses launched at once by
+  // `SynthesizeNodesConcurrentlyAndGetDelays`. Defaults to the number of
+  // available CPUs.
+  void set_max_concurrency(int64_t value) { max_concurrency_ = value; }
+  int64_t max_concurrency() const { return max_concurrency_; }
+
+  // Returns the number of `SynthesizeNodesAndGetDelay` calls answered from
+  // the delay cache rather than by running synthesis.
+  int64_t cache_hits() const {
+    absl::MutexLock lock(&cache_mutex_);
+    return cache_hits_;
+  }
+
  private:
+  // A delay cache entry; `done` is false while the delay is being synthesized.
+  struct CachedDelay {
+    bool done = false;
+    absl::StatusOr<int64_t> delay;
+  };
+
   // Records the name of the concreate synthesizer, e.g., yosys, for management
   // and debugging purpose.
   std::string name_;
+  int64_t max_concurrency_;
+
+  // Delays of previously synthesized node sets, keyed on the Verilog generated
+  // for them with canonical names, so structurally identical sets from
+  // anywhere in the design share an entry. Node-based storage keeps entries at
+  // stable addresses for threads waiting on them.
+  mutable absl::Mutex cache_mutex_;
+  mutable absl::node_hash_map<std::string, CachedDelay> delay_cache_
+      ABSL_GUARDED_BY(cache_mutex_);
+  mutable int64_t cache_hits_ ABSL_GUARDED_BY(cache_mutex_) = 0;
 };
 
 // An abstract class of a synthesis service.
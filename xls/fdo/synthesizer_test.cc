@@ -14,12 +14,15 @@
 
 #include "xls/fdo/synthesizer.h"
 
+#include <atomic>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/golden_files.h"
@@ -41,8 +44,14 @@ class FakeSynthesizer : public synthesis::Synthesizer {
   absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
       std::string_view verilog_text,
       std::string_view top_module_name) const override {
+    ++synthesis_count_;
     return 0;
   }
+
+  int64_t synthesis_count() const { return synthesis_count_; }
+
+ private:
+  mutable std::atomic<int64_t> synthesis_count_ = 0;
 };
 
 class SynthesizerTest : public IrTestBase {
@@ -118,5 +127,32 @@ fn test(i0: bits[3], i1: bits[3]) -> (bits[3], bits[3]) {
   ExpectEqualToGoldenFile(GoldenFilePath("vtxt"), actual_verilog_text);
 }
 
+TEST_F(SynthesizerTest, IdenticalNodeSetsSynthesizedOnce) {
+  std::string ir_text = R"(
+package p
+
+fn test(a: bits[3], b: bits[3], c: bits[3], d: bits[3]) -> (bits[3], bits[3]) {
+  add.5: bits[3] = add(a, b, id=5)
+  add.6: bits[3] = add(c, d, id=6)
+  ret tuple.7: (bits[3], bits[3]) = tuple(add.5, add.6, id=7)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetFunction("test"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add5, function->GetNode("add.5"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add6, function->GetNode("add.6"));
+  std::vector<absl::flat_hash_set<Node*>> nodes_list = {{add5}, {add6}};
+
+  // The two additions only differ in their names, so they share one synthesis
+  // even when requested concurrently.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<int64_t> delays,
+      synthesizer_.SynthesizeNodesConcurrentlyAndGetDelays(nodes_list));
+  EXPECT_EQ(delays.size(), 2);
+  EXPECT_EQ(synthesizer_.synthesis_count(), 1);
+  EXPECT_EQ(synthesizer_.cache_hits(), 1);
+}
+
 }  // namespace
 }  // namespace xls
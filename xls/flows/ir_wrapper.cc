@@ -117,6 +117,19 @@ absl::Status JitChannelQueueWrapper::Read(absl::Span<uint8_t> buffer) {
   return absl::OkStatus();
 }
 
+absl::Status JitChannelQueueWrapper::WriteBatch(
+    absl::Span<const uint8_t> buffer) {
+  XLS_RET_CHECK_EQ(buffer.size() % batch_element_stride(), 0);
+  queue_->WriteRawN(buffer.data(), buffer.size() / batch_element_stride());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int64_t> JitChannelQueueWrapper::ReadBatch(
+    absl::Span<uint8_t> buffer) {
+  return queue_->ReadRawN(buffer.data(),
+                          buffer.size() / batch_element_stride());
+}
+
 absl::StatusOr<DslxModuleAndPath> DslxModuleAndPath::Create(
     std::string_view module_name, std::string_view file_path,
     dslx::ImportData* import_data) {
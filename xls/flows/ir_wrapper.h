@@ -74,6 +74,18 @@ class JitChannelQueueWrapper {
   // Read the content of the channel into the buffer.
   absl::Status Read(absl::Span<uint8_t> buffer);
 
+  // The distance in bytes between consecutive elements of the buffers passed
+  // to WriteBatch and ReadBatch.
+  int64_t batch_element_stride() const { return queue_->raw_element_stride(); }
+
+  // Writes all elements in `buffer` to the channel. The buffer holds elements
+  // in LLVM representation spaced `batch_element_stride()` bytes apart.
+  absl::Status WriteBatch(absl::Span<const uint8_t> buffer);
+
+  // Reads as many elements as are available (up to the number which fit in
+  // `buffer`) from the channel. Returns the number of elements read.
+  absl::StatusOr<int64_t> ReadBatch(absl::Span<uint8_t> buffer);
+
  private:
   // Pointer to the jit channel queue this object wraps.
   JitChannelQueue* queue_ = nullptr;
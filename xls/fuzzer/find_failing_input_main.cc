@@ -29,7 +29,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
-#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/incremental_function_interpreter.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
@@ -73,6 +73,10 @@ absl::Status RealMain(std::string_view ir_path,
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
                        FunctionJit::Create(f));
+  // Consecutive inputs often differ in only a few arguments so evaluate them
+  // incrementally.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IncrementalFunctionInterpreter> interp,
+                       IncrementalFunctionInterpreter::Create(f));
   for (const std::vector<Value>& args : inputs) {
     InterpreterResult<Value> jit_result;
     if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
@@ -86,7 +90,7 @@ absl::Status RealMain(std::string_view ir_path,
     // events once the JIT fully supports events (and we have decided how to
     // handle event mismatches).
     XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> interpreter_result,
-                         InterpretFunction(f, args));
+                         interp->Run(args));
     if (jit_result.value != interpreter_result.value) {
       std::cout << absl::StrJoin(args, "; ", ValueFormatterHex);
       return absl::OkStatus();
@@ -0,0 +1,164 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/fuzz_coverage.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/discrete_distribution.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+
+namespace xls {
+namespace {
+
+// Widths are bucketed by their log2 so that a new width only counts as new
+// coverage when it is of a different magnitude.
+std::string NodeFeature(Node* node) {
+  return absl::StrCat(OpToString(node->op()), ":",
+                      TypeKindToString(node->GetType()->kind()), ":w",
+                      CeilOfLog2(node->GetType()->GetFlatBitCount() + 1));
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParseIrFile(
+    const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(path));
+  return Parser::ParsePackage(ir_text, path.string());
+}
+
+absl::flat_hash_map<Op, int64_t> OpCounts(const Package& package) {
+  absl::flat_hash_map<Op, int64_t> counts;
+  for (FunctionBase* fb : package.GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      ++counts[node->op()];
+    }
+  }
+  return counts;
+}
+
+}  // namespace
+
+absl::StatusOr<absl::flat_hash_set<std::string>> CollectIrCoverage(
+    const std::filesystem::path& run_dir) {
+  absl::flat_hash_set<std::string> features;
+  std::filesystem::path ir_path = run_dir / "sample.ir";
+  if (!FileExists(ir_path).ok()) {
+    return features;
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> unoptimized,
+                       ParseIrFile(ir_path));
+  for (FunctionBase* fb : unoptimized->GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      features.insert(NodeFeature(node));
+      std::vector<std::string> operand_ops;
+      operand_ops.reserve(node->operand_count());
+      for (Node* operand : node->operands()) {
+        operand_ops.push_back(OpToString(operand->op()));
+      }
+      features.insert(absl::StrCat(OpToString(node->op()), "(",
+                                   absl::StrJoin(operand_ops, ","), ")"));
+    }
+  }
+
+  std::filesystem::path opt_ir_path = run_dir / "sample.opt.ir";
+  if (!FileExists(opt_ir_path).ok()) {
+    return features;
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> optimized,
+                       ParseIrFile(opt_ir_path));
+  absl::flat_hash_map<Op, int64_t> optimized_counts = OpCounts(*optimized);
+  for (const auto& [op, count] : optimized_counts) {
+    features.insert(absl::StrCat("opt:", OpToString(op)));
+  }
+  for (const auto& [op, count] : OpCounts(*unoptimized)) {
+    auto it = optimized_counts.find(op);
+    if (it == optimized_counts.end() || it->second < count) {
+      features.insert(absl::StrCat("reduced:", OpToString(op)));
+    }
+  }
+  return features;
+}
+
+FuzzCoverage::FuzzCoverage(const dslx::AstGeneratorOptions& base_options) {
+  variants_.push_back(base_options);
+  if (base_options.max_width_bits_types > 8) {
+    dslx::AstGeneratorOptions narrow = base_options;
+    narrow.max_width_bits_types = 8;
+    narrow.max_width_aggregate_types =
+        std::min<int64_t>(base_options.max_width_aggregate_types, 64);
+    variants_.push_back(narrow);
+  }
+  if (base_options.emit_loops) {
+    dslx::AstGeneratorOptions no_loops = base_options;
+    no_loops.emit_loops = false;
+    variants_.push_back(no_loops);
+  }
+  stats_.resize(variants_.size());
+}
+
+int64_t FuzzCoverage::ChooseVariant(absl::BitGenRef bit_gen) const {
+  std::vector<double> weights;
+  {
+    absl::MutexLock lock(&mutex_);
+    weights.reserve(stats_.size());
+    for (const VariantStats& stats : stats_) {
+      // The discovery rate, smoothed so untried variants get a fair chance.
+      weights.push_back(static_cast<double>(stats.new_features + 1) /
+                        static_cast<double>(stats.samples + 1));
+    }
+  }
+  return absl::discrete_distribution<int64_t>(weights.begin(),
+                                              weights.end())(bit_gen);
+}
+
+int64_t FuzzCoverage::Record(int64_t variant,
+                             const absl::flat_hash_set<std::string>& features) {
+  absl::MutexLock lock(&mutex_);
+  int64_t new_features = 0;
+  for (const std::string& feature : features) {
+    if (features_.insert(feature).second) {
+      ++new_features;
+    }
+  }
+  stats_[variant].samples++;
+  stats_[variant].new_features += new_features;
+  return new_features;
+}
+
+int64_t FuzzCoverage::feature_count() const {
+  absl::MutexLock lock(&mutex_);
+  return features_.size();
+}
+
+}  // namespace xls
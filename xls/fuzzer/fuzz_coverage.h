@@ -0,0 +1,84 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_FUZZ_COVERAGE_H_
+#define XLS_FUZZER_FUZZ_COVERAGE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/ast_generator.h"
+
+namespace xls {
+
+// Returns cheap coverage features of the IR a sample run left in `run_dir`
+// (`sample.ir` and, if present, `sample.opt.ir`). Features are strings naming
+// the unoptimized ops by type and width bucket, the unoptimized op/operand-op
+// pairs, the optimized ops, and the ops whose count the optimizer reduced
+// (a proxy for which passes changed the IR).
+absl::StatusOr<absl::flat_hash_set<std::string>> CollectIrCoverage(
+    const std::filesystem::path& run_dir);
+
+// Coverage feedback shared by fuzzer workers.
+//
+// Holds the union of the coverage features seen so far and a few variants of
+// the base AST generator options. Workers choose a variant for each sample
+// with probability proportional to the rate at which its samples have added
+// new features, so generation drifts toward option settings which currently
+// exercise unexplored parts of the toolchain. Variants only ever restrict the
+// base options (narrower types, no loops), so every generated sample is one
+// the base options could have produced. Thread-safe.
+class FuzzCoverage {
+ public:
+  explicit FuzzCoverage(const dslx::AstGeneratorOptions& base_options);
+
+  // Returns the index of the variant to generate the next sample with.
+  int64_t ChooseVariant(absl::BitGenRef bit_gen) const;
+
+  const dslx::AstGeneratorOptions& variant_options(int64_t variant) const {
+    return variants_[variant];
+  }
+  int64_t variant_count() const { return variants_.size(); }
+
+  // Records the features of a sample generated with `variant` and returns how
+  // many of them had not been seen before.
+  int64_t Record(int64_t variant,
+                 const absl::flat_hash_set<std::string>& features);
+
+  // Returns the number of distinct features seen by all workers.
+  int64_t feature_count() const;
+
+ private:
+  struct VariantStats {
+    int64_t samples = 0;
+    int64_t new_features = 0;
+  };
+
+  std::vector<dslx::AstGeneratorOptions> variants_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_set<std::string> features_ ABSL_GUARDED_BY(mutex_);
+  std::vector<VariantStats> stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_FUZZ_COVERAGE_H_
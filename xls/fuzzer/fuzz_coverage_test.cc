@@ -0,0 +1,114 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/fuzz_coverage.h"
+
+#include <cstdint>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/random/random.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/ast_generator.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Contains;
+using ::testing::IsEmpty;
+using ::testing::Not;
+
+TEST(FuzzCoverageTest, CollectIrCoverage) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(absl::flat_hash_set<std::string> empty,
+                           CollectIrCoverage(temp_dir.path()));
+  EXPECT_THAT(empty, IsEmpty());
+
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "sample.ir", R"(
+package sample
+
+top fn main(x: bits[8]) -> bits[8] {
+  literal.1: bits[8] = literal(value=0)
+  ret add.2: bits[8] = add(x, literal.1)
+}
+)"));
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "sample.opt.ir", R"(
+package sample
+
+top fn main(x: bits[8]) -> bits[8] {
+  ret x: bits[8] = param(name=x)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(absl::flat_hash_set<std::string> features,
+                           CollectIrCoverage(temp_dir.path()));
+  EXPECT_THAT(features, Contains("add:bits:w4"));
+  EXPECT_THAT(features, Contains("add(param,literal)"));
+  EXPECT_THAT(features, Contains("opt:param"));
+  EXPECT_THAT(features, Contains("reduced:add"));
+  EXPECT_THAT(features, Not(Contains("reduced:param")));
+}
+
+TEST(FuzzCoverageTest, RecordCountsNewFeatures) {
+  FuzzCoverage coverage(dslx::AstGeneratorOptions{});
+  EXPECT_EQ(coverage.Record(0, {"a", "b"}), 2);
+  EXPECT_EQ(coverage.Record(0, {"b", "c"}), 1);
+  EXPECT_EQ(coverage.Record(0, {"a", "c"}), 0);
+  EXPECT_EQ(coverage.feature_count(), 3);
+}
+
+TEST(FuzzCoverageTest, VariantsRestrictBaseOptions) {
+  dslx::AstGeneratorOptions base;
+  base.max_width_bits_types = 64;
+  base.emit_loops = true;
+  FuzzCoverage coverage(base);
+  ASSERT_EQ(coverage.variant_count(), 3);
+  for (int64_t i = 0; i < coverage.variant_count(); ++i) {
+    EXPECT_LE(coverage.variant_options(i).max_width_bits_types,
+              base.max_width_bits_types);
+    EXPECT_LE(coverage.variant_options(i).max_width_aggregate_types,
+              base.max_width_aggregate_types);
+  }
+
+  dslx::AstGeneratorOptions restricted;
+  restricted.max_width_bits_types = 4;
+  restricted.emit_loops = false;
+  EXPECT_EQ(FuzzCoverage(restricted).variant_count(), 1);
+}
+
+TEST(FuzzCoverageTest, ChooseVariantFavorsNewCoverage) {
+  FuzzCoverage coverage(dslx::AstGeneratorOptions{});
+  ASSERT_GT(coverage.variant_count(), 1);
+  // Variant 1 keeps finding new features; the others find nothing.
+  for (int64_t i = 0; i < 100; ++i) {
+    for (int64_t v = 0; v < coverage.variant_count(); ++v) {
+      coverage.Record(v, {v == 1 ? absl::StrCat("f", i) : "stale"});
+    }
+  }
+  absl::BitGen bit_gen;
+  int64_t chose_variant_1 = 0;
+  for (int64_t i = 0; i < 1000; ++i) {
+    if (coverage.ChooseVariant(bit_gen) == 1) {
+      ++chose_variant_1;
+    }
+  }
+  EXPECT_GT(chose_variant_1, 900);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,460 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/remote_fuzz.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "grpcpp/channel.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/fuzz_service.grpc.pb.h"
+#include "xls/fuzzer/fuzz_service.pb.h"
+#include "xls/fuzzer/run_fuzz.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/scrub_crasher.h"
+
+namespace xls {
+namespace {
+
+// How long a worker waits before asking again when no work is available. The
+// coordinator keeps serving for twice this long after the run is over so that
+// waiting workers learn that it is.
+constexpr absl::Duration kPollInterval = absl::Seconds(5);
+
+// Crasher directories include the sample's IR and generated Verilog, which can
+// exceed gRPC's default message size limit.
+constexpr int kMaxMessageBytes = 256 * 1024 * 1024;
+
+// Name of the file in the summary directory which the workers' sample
+// summaries are appended to.
+constexpr std::string_view kSummaryFileName = "summary_remote.binarypb";
+
+absl::Status FromGrpcStatus(const ::grpc::Status& status) {
+  // This assumes that the status code enums match up.
+  return absl::Status(
+      static_cast<absl::StatusCode>(static_cast<int>(status.error_code())),
+      status.error_message());
+}
+
+::grpc::Status ToGrpcStatus(const absl::Status& status) {
+  return ::grpc::Status(
+      static_cast<::grpc::StatusCode>(static_cast<int>(status.code())),
+      std::string(status.message()));
+}
+
+// Returns whether `name` is a single path component, so that a reported
+// crasher cannot write outside of the crasher directory.
+bool IsPlainFileName(std::string_view name) {
+  return !name.empty() && name != "." && name != ".." &&
+         !absl::StrContains(name, '/');
+}
+
+class FuzzCoordinatorServiceImpl
+    : public fuzzer::FuzzCoordinatorService::Service {
+ public:
+  explicit FuzzCoordinatorServiceImpl(FuzzCoordinator& coordinator)
+      : coordinator_(coordinator) {}
+
+  ::grpc::Status GetWork(::grpc::ServerContext* context,
+                         const fuzzer::GetWorkRequest* request,
+                         fuzzer::GetWorkResponse* response) override {
+    *response = coordinator_.GetWork(request->worker(), absl::Now());
+    return ::grpc::Status::OK;
+  }
+
+  ::grpc::Status ReportWork(::grpc::ServerContext* context,
+                            const fuzzer::ReportWorkRequest* request,
+                            fuzzer::ReportWorkResponse* response) override {
+    return ToGrpcStatus(coordinator_.ReportWork(*request));
+  }
+
+ private:
+  FuzzCoordinator& coordinator_;
+};
+
+// Returns the crashers saved in `crasher_dir` by GenerateSampleAndRun: one
+// directory per crasher.
+absl::StatusOr<std::vector<fuzzer::FuzzCrasherProto>> CollectCrashers(
+    const std::filesystem::path& crasher_dir) {
+  std::vector<fuzzer::FuzzCrasherProto> crashers;
+  XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> crasher_paths,
+                       GetDirectoryEntries(crasher_dir));
+  for (const std::filesystem::path& crasher_path : crasher_paths) {
+    if (!std::filesystem::is_directory(crasher_path)) {
+      continue;
+    }
+    fuzzer::FuzzCrasherProto& crasher = crashers.emplace_back();
+    crasher.set_name(crasher_path.filename().string());
+    XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> file_paths,
+                         GetDirectoryEntries(crasher_path));
+    for (const std::filesystem::path& file_path : file_paths) {
+      if (!std::filesystem::is_regular_file(file_path)) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(file_path));
+      (*crasher.mutable_files())[file_path.filename().string()] =
+          std::move(contents);
+    }
+  }
+  return crashers;
+}
+
+absl::Status RunWorkerThread(
+    fuzzer::FuzzCoordinatorService::Stub& stub, std::string_view name,
+    const std::optional<std::filesystem::path>& top_run_dir) {
+  fuzzer::GetWorkRequest request;
+  request.set_worker(name);
+  while (true) {
+    fuzzer::GetWorkResponse response;
+    {
+      ::grpc::ClientContext context;
+      XLS_RETURN_IF_ERROR(
+          FromGrpcStatus(stub.GetWork(&context, request, &response)));
+    }
+    if (response.done()) {
+      LOG(INFO) << "--- Worker " << name << ": coordinator is done. Exiting.";
+      return absl::OkStatus();
+    }
+    if (!response.has_unit()) {
+      absl::SleepFor(kPollInterval);
+      continue;
+    }
+    LOG(INFO) << absl::StreamFormat(
+        "--- Worker %s: running work unit %d (%d samples)", name,
+        response.unit().id(), response.unit().sample_count());
+    XLS_ASSIGN_OR_RETURN(fuzzer::ReportWorkRequest report,
+                         RunFuzzWorkUnit(response.unit(), top_run_dir));
+    report.set_worker(name);
+    fuzzer::ReportWorkResponse report_response;
+    ::grpc::ClientContext context;
+    XLS_RETURN_IF_ERROR(
+        FromGrpcStatus(stub.ReportWork(&context, report, &report_response)));
+  }
+}
+
+}  // namespace
+
+FuzzCoordinator::FuzzCoordinator(Options options, absl::Time start)
+    : options_(std::move(options)),
+      start_(start),
+      unit_count_(options_.sample_count.has_value()
+                      ? std::make_optional(CeilOfRatio(
+                            *options_.sample_count, options_.samples_per_unit))
+                      : std::nullopt) {
+  CHECK_GT(options_.samples_per_unit, 0);
+}
+
+bool FuzzCoordinator::HasNewUnits(absl::Time now) {
+  if (options_.duration.has_value() && now - start_ >= *options_.duration) {
+    return false;
+  }
+  return !unit_count_.has_value() || next_unit_ < *unit_count_;
+}
+
+bool FuzzCoordinator::IsDoneLocked(absl::Time now) {
+  if (HasNewUnits(now)) {
+    return false;
+  }
+  if (leases_.empty()) {
+    return true;
+  }
+  // Once the duration is over, units whose lease expired are not handed out
+  // again, so there is nothing more to wait for once all leases expired.
+  if (options_.duration.has_value() && now - start_ >= *options_.duration) {
+    for (const auto& [id, expiry] : leases_) {
+      if (expiry > now) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+bool FuzzCoordinator::IsDone(absl::Time now) {
+  absl::MutexLock lock(&mutex_);
+  return IsDoneLocked(now);
+}
+
+fuzzer::FuzzWorkUnit FuzzCoordinator::MakeUnit(int64_t id) {
+  fuzzer::FuzzWorkUnit unit;
+  unit.set_id(id);
+  unit.set_seed(options_.seed + id);
+  int64_t sample_count = options_.samples_per_unit;
+  if (unit_count_.has_value() && id == *unit_count_ - 1) {
+    sample_count = *options_.sample_count - id * options_.samples_per_unit;
+  }
+  unit.set_sample_count(sample_count);
+  *unit.mutable_ast_generator_options() =
+      options_.ast_generator_options.ToProto();
+  *unit.mutable_sample_options() = options_.sample_options.proto();
+  unit.set_force_failure(options_.force_failure);
+  return unit;
+}
+
+fuzzer::GetWorkResponse FuzzCoordinator::GetWork(std::string_view worker,
+                                                 absl::Time now) {
+  absl::MutexLock lock(&mutex_);
+  fuzzer::GetWorkResponse response;
+  if (IsDoneLocked(now)) {
+    response.set_done(true);
+    return response;
+  }
+  if (!options_.duration.has_value() || now - start_ < *options_.duration) {
+    for (auto& [id, expiry] : leases_) {
+      if (expiry <= now) {
+        LOG(WARNING) << absl::StreamFormat(
+            "Lease of work unit %d expired; handing it out again to %s", id,
+            worker);
+        expiry = now + options_.lease_duration;
+        *response.mutable_unit() = MakeUnit(id);
+        return response;
+      }
+    }
+  }
+  if (HasNewUnits(now)) {
+    int64_t id = next_unit_++;
+    leases_[id] = now + options_.lease_duration;
+    *response.mutable_unit() = MakeUnit(id);
+  }
+  return response;
+}
+
+absl::Status FuzzCoordinator::SaveCrasher(
+    const fuzzer::FuzzCrasherProto& crasher) {
+  if (!IsPlainFileName(crasher.name())) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid crasher name: ", crasher.name()));
+  }
+  std::optional<std::string_view> crasher_text;
+  for (const auto& [file_name, contents] : crasher.files()) {
+    if (!IsPlainFileName(file_name)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid file name in crasher %s: %s", crasher.name(), file_name));
+    }
+    if (absl::StartsWith(file_name, "crasher_") &&
+        absl::EndsWith(file_name, ".x")) {
+      crasher_text = contents;
+    }
+  }
+  if (!crasher_text.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Crasher ", crasher.name(), " has no crasher file"));
+  }
+  if (!crashers_.insert(ScrubCrasher(*crasher_text)).second) {
+    ++duplicate_crashers_;
+    return absl::OkStatus();
+  }
+  if (!options_.crasher_dir.has_value()) {
+    return absl::OkStatus();
+  }
+  std::filesystem::path crasher_dir = *options_.crasher_dir / crasher.name();
+  LOG(INFO) << "Saving crasher to " << crasher_dir;
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(crasher_dir));
+  for (const auto& [file_name, contents] : crasher.files()) {
+    XLS_RETURN_IF_ERROR(SetFileContents(crasher_dir / file_name, contents));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status FuzzCoordinator::ReportWork(
+    const fuzzer::ReportWorkRequest& request) {
+  absl::MutexLock lock(&mutex_);
+  // A unit whose lease expired may be reported by more than one worker; the
+  // samples are generated deterministically from the unit's seed, so later
+  // reports add nothing.
+  if (leases_.erase(request.unit_id()) == 0) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Ignoring report of work unit %d from %s which is not outstanding",
+        request.unit_id(), request.worker());
+    return absl::OkStatus();
+  }
+  samples_run_ += request.sample_count();
+  for (const fuzzer::FuzzCrasherProto& crasher : request.crashers()) {
+    XLS_RETURN_IF_ERROR(SaveCrasher(crasher));
+  }
+  if (options_.summary_dir.has_value() && !request.summaries().empty()) {
+    XLS_RETURN_IF_ERROR(AppendStringToFile(
+        *options_.summary_dir / kSummaryFileName, request.summaries()));
+  }
+  LOG(INFO) << absl::StreamFormat(
+      "--- %s finished work unit %d: %d samples; %d crashers (%d duplicates)",
+      request.worker(), request.unit_id(), samples_run_, crashers_.size(),
+      duplicate_crashers_);
+  return absl::OkStatus();
+}
+
+int64_t FuzzCoordinator::samples_run() {
+  absl::MutexLock lock(&mutex_);
+  return samples_run_;
+}
+
+int64_t FuzzCoordinator::crasher_count() {
+  absl::MutexLock lock(&mutex_);
+  return crashers_.size();
+}
+
+int64_t FuzzCoordinator::duplicate_crasher_count() {
+  absl::MutexLock lock(&mutex_);
+  return duplicate_crashers_;
+}
+
+absl::Status ServeFuzzCoordinator(FuzzCoordinator& coordinator, int port) {
+  FuzzCoordinatorServiceImpl service(coordinator);
+  ::grpc::ServerBuilder builder;
+  // The workers run on other machines, so the local credentials used by the
+  // synthesis server do not apply; run the coordinator on a trusted network.
+  builder.AddListeningPort(absl::StrCat("[::]:", port),
+                           ::grpc::InsecureServerCredentials());
+  builder.RegisterService(&service);
+  builder.SetMaxReceiveMessageSize(kMaxMessageBytes);
+  std::unique_ptr<::grpc::Server> server = builder.BuildAndStart();
+  if (server == nullptr) {
+    return absl::UnavailableError(
+        absl::StrCat("Failed to start the fuzz coordinator on port ", port));
+  }
+  LOG(INFO) << "Serving fuzz coordinator on port " << port;
+  while (!coordinator.IsDone(absl::Now())) {
+    absl::SleepFor(kPollInterval);
+  }
+  absl::SleepFor(2 * kPollInterval);
+  server->Shutdown();
+  LOG(INFO) << absl::StreamFormat(
+      "--- Fuzz coordinator finished! %d samples; %d crashers (%d duplicates)",
+      coordinator.samples_run(), coordinator.crasher_count(),
+      coordinator.duplicate_crasher_count());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<fuzzer::ReportWorkRequest> RunFuzzWorkUnit(
+    const fuzzer::FuzzWorkUnit& unit,
+    const std::optional<std::filesystem::path>& top_run_dir) {
+  XLS_ASSIGN_OR_RETURN(
+      dslx::AstGeneratorOptions ast_generator_options,
+      dslx::AstGeneratorOptions::FromProto(unit.ast_generator_options()));
+  XLS_ASSIGN_OR_RETURN(SampleOptions sample_options,
+                       SampleOptions::FromProto(unit.sample_options()));
+  XLS_ASSIGN_OR_RETURN(TempDirectory crasher_dir, TempDirectory::Create());
+  XLS_ASSIGN_OR_RETURN(TempDirectory summary_dir, TempDirectory::Create());
+  std::filesystem::path summary_file = summary_dir.path() / "summary.binarypb";
+
+  std::mt19937_64 rng{unit.seed()};
+  dslx::FileTable file_table;
+  for (int64_t sample = 0; sample < unit.sample_count(); ++sample) {
+    std::filesystem::path run_dir;
+    std::optional<TempDirectory> temp_run_dir;
+    if (top_run_dir.has_value()) {
+      run_dir = *top_run_dir /
+                absl::StrFormat("unit%d-sample%d", unit.id(), sample);
+      XLS_RETURN_IF_ERROR(RecursivelyCreateDir(run_dir));
+    } else {
+      XLS_ASSIGN_OR_RETURN(temp_run_dir, TempDirectory::Create());
+      run_dir = temp_run_dir->path();
+    }
+    absl::Status sample_status =
+        GenerateSampleAndRun(file_table, rng, ast_generator_options,
+                             sample_options, run_dir, crasher_dir.path(),
+                             summary_file, unit.force_failure())
+            .status();
+    if (!sample_status.ok()) {
+      LOG(INFO) << absl::StreamFormat(
+          "--- Work unit %d: sample %d failed: %s", unit.id(), sample,
+          sample_status.ToString());
+    }
+  }
+
+  fuzzer::ReportWorkRequest report;
+  report.set_unit_id(unit.id());
+  report.set_sample_count(unit.sample_count());
+  XLS_ASSIGN_OR_RETURN(std::vector<fuzzer::FuzzCrasherProto> crashers,
+                       CollectCrashers(crasher_dir.path()));
+  for (fuzzer::FuzzCrasherProto& crasher : crashers) {
+    *report.add_crashers() = std::move(crasher);
+  }
+  if (FileExists(summary_file).ok()) {
+    XLS_ASSIGN_OR_RETURN(*report.mutable_summaries(),
+                         GetFileContents(summary_file));
+  }
+  return report;
+}
+
+absl::Status RunFuzzWorker(
+    std::string_view coordinator_address, int64_t worker_count,
+    const std::optional<std::filesystem::path>& top_run_dir) {
+  std::shared_ptr<::grpc::Channel> channel = ::grpc::CreateChannel(
+      std::string(coordinator_address), ::grpc::InsecureChannelCredentials());
+  // Stubs are thread-safe, so the worker threads share one.
+  std::unique_ptr<fuzzer::FuzzCoordinatorService::Stub> stub =
+      fuzzer::FuzzCoordinatorService::NewStub(channel);
+
+  std::array<char, 256> hostname{};
+  if (gethostname(hostname.data(), hostname.size() - 1) != 0) {
+    hostname = {};
+  }
+  std::vector<std::unique_ptr<Thread>> workers;
+  std::vector<absl::Status> worker_status(
+      worker_count, absl::InternalError("worker did not terminate."));
+  for (int64_t i = 0; i < worker_count; ++i) {
+    workers.push_back(std::make_unique<Thread>(
+        [&, i, name = absl::StrCat(hostname.data(), "/", i)] {
+          worker_status[i] = RunWorkerThread(*stub, name, top_run_dir);
+        }));
+  }
+  absl::Status status = absl::OkStatus();
+  for (int64_t i = 0; i < workers.size(); ++i) {
+    workers[i]->Join();
+    if (!worker_status[i].ok()) {
+      LOG(ERROR) << "-- Worker #" << i << " failed: " << worker_status[i];
+      status.Update(worker_status[i]);
+    }
+  }
+  return status;
+}
+
+}  // namespace xls
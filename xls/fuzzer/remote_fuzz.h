@@ -0,0 +1,124 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_REMOTE_FUZZ_H_
+#define XLS_FUZZER_REMOTE_FUZZ_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/fuzz_service.pb.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+
+// Coordinator state of a fuzzing run distributed over remote workers.
+//
+// The run is split into work units of `samples_per_unit` samples, each
+// generated from its own seed. A unit which is not reported back within
+// `lease_duration` of being handed out is handed out again. Crashers reported
+// by the workers are deduplicated by their scrubbed crasher text (see
+// ScrubCrasher) and written to `crasher_dir`; sample summaries are appended to
+// a single file in `summary_dir`, in the format read by read_summary_main.
+//
+// Thread-safe.
+class FuzzCoordinator {
+ public:
+  struct Options {
+    dslx::AstGeneratorOptions ast_generator_options;
+    SampleOptions sample_options;
+    uint64_t seed = 0;
+    // Total number of samples to run; unbounded if unspecified.
+    std::optional<int64_t> sample_count;
+    // Time after which no more work is handed out; unbounded if unspecified.
+    std::optional<absl::Duration> duration;
+    int64_t samples_per_unit = 16;
+    absl::Duration lease_duration = absl::Minutes(30);
+    std::optional<std::filesystem::path> crasher_dir;
+    std::optional<std::filesystem::path> summary_dir;
+    bool force_failure = false;
+  };
+
+  explicit FuzzCoordinator(Options options, absl::Time start = absl::Now());
+
+  // Returns the response to a request for work from `worker` at time `now`.
+  fuzzer::GetWorkResponse GetWork(std::string_view worker, absl::Time now);
+
+  // Records the results of a work unit.
+  absl::Status ReportWork(const fuzzer::ReportWorkRequest& request);
+
+  // Returns whether the run is over at time `now`: no more work will be handed
+  // out and no handed out work is still expected to be reported.
+  bool IsDone(absl::Time now);
+
+  int64_t samples_run();
+  int64_t crasher_count();
+  int64_t duplicate_crasher_count();
+
+ private:
+  bool IsDoneLocked(absl::Time now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Whether units which have not been handed out yet may be handed out.
+  bool HasNewUnits(absl::Time now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  fuzzer::FuzzWorkUnit MakeUnit(int64_t id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  absl::Status SaveCrasher(const fuzzer::FuzzCrasherProto& crasher)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Options options_;
+  const absl::Time start_;
+  // Number of units in the run; unbounded if unspecified.
+  const std::optional<int64_t> unit_count_;
+
+  absl::Mutex mutex_;
+  int64_t next_unit_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Units which were handed out but not reported yet, with the expiry time of
+  // their lease.
+  absl::btree_map<int64_t, absl::Time> leases_ ABSL_GUARDED_BY(mutex_);
+  int64_t samples_run_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Scrubbed text of the crashers seen so far.
+  absl::flat_hash_set<std::string> crashers_ ABSL_GUARDED_BY(mutex_);
+  int64_t duplicate_crashers_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Serves `coordinator` to remote workers on `port` until the run is over.
+absl::Status ServeFuzzCoordinator(FuzzCoordinator& coordinator, int port);
+
+// Generates and runs the samples of `unit` and returns the report to send back
+// to the coordinator. Creates run directories in `top_run_dir` if specified;
+// otherwise creates ephemeral temporary directories for each sample.
+absl::StatusOr<fuzzer::ReportWorkRequest> RunFuzzWorkUnit(
+    const fuzzer::FuzzWorkUnit& unit,
+    const std::optional<std::filesystem::path>& top_run_dir = std::nullopt);
+
+// Pulls work units from the coordinator at `coordinator_address` on
+// `worker_count` threads, runs them and reports the results back until the
+// coordinator reports that the run is over.
+absl::Status RunFuzzWorker(
+    std::string_view coordinator_address, int64_t worker_count,
+    const std::optional<std::filesystem::path>& top_run_dir = std::nullopt);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_REMOTE_FUZZ_H_
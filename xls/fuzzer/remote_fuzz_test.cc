@@ -0,0 +1,167 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/remote_fuzz.h"
+
+#include <cstdint>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/fuzz_service.pb.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+const absl::Time kStart = absl::FromUnixSeconds(1000);
+
+fuzzer::ReportWorkRequest Report(const fuzzer::FuzzWorkUnit& unit) {
+  fuzzer::ReportWorkRequest report;
+  report.set_worker("test");
+  report.set_unit_id(unit.id());
+  report.set_sample_count(unit.sample_count());
+  return report;
+}
+
+void AddCrasher(fuzzer::ReportWorkRequest& report, std::string name,
+                std::string text) {
+  fuzzer::FuzzCrasherProto* crasher = report.add_crashers();
+  crasher->set_name(name);
+  (*crasher->mutable_files())["crasher_2024-01-01_" + name + ".x"] = text;
+  (*crasher->mutable_files())["exception.txt"] = "boom";
+}
+
+TEST(RemoteFuzzTest, SplitsSampleCountIntoUnits) {
+  FuzzCoordinator coordinator({.seed = 100,
+                               .sample_count = 10,
+                               .samples_per_unit = 4},
+                              kStart);
+  fuzzer::GetWorkResponse first = coordinator.GetWork("a", kStart);
+  fuzzer::GetWorkResponse second = coordinator.GetWork("b", kStart);
+  fuzzer::GetWorkResponse third = coordinator.GetWork("c", kStart);
+  ASSERT_TRUE(first.has_unit());
+  ASSERT_TRUE(second.has_unit());
+  ASSERT_TRUE(third.has_unit());
+  EXPECT_EQ(first.unit().seed(), 100);
+  EXPECT_EQ(second.unit().seed(), 101);
+  EXPECT_EQ(first.unit().sample_count(), 4);
+  EXPECT_EQ(third.unit().sample_count(), 2);
+
+  // All work is handed out but not reported yet.
+  fuzzer::GetWorkResponse none = coordinator.GetWork("d", kStart);
+  EXPECT_FALSE(none.has_unit());
+  EXPECT_FALSE(none.done());
+  EXPECT_FALSE(coordinator.IsDone(kStart));
+
+  XLS_ASSERT_OK(coordinator.ReportWork(Report(first.unit())));
+  XLS_ASSERT_OK(coordinator.ReportWork(Report(second.unit())));
+  XLS_ASSERT_OK(coordinator.ReportWork(Report(third.unit())));
+  EXPECT_EQ(coordinator.samples_run(), 10);
+  EXPECT_TRUE(coordinator.IsDone(kStart));
+  EXPECT_TRUE(coordinator.GetWork("a", kStart).done());
+}
+
+TEST(RemoteFuzzTest, ExpiredLeaseIsHandedOutAgain) {
+  FuzzCoordinator coordinator({.sample_count = 4,
+                               .samples_per_unit = 4,
+                               .lease_duration = absl::Minutes(1)},
+                              kStart);
+  fuzzer::GetWorkResponse first = coordinator.GetWork("a", kStart);
+  ASSERT_TRUE(first.has_unit());
+  EXPECT_FALSE(coordinator.GetWork("b", kStart).has_unit());
+
+  fuzzer::GetWorkResponse again =
+      coordinator.GetWork("b", kStart + absl::Minutes(2));
+  ASSERT_TRUE(again.has_unit());
+  EXPECT_EQ(again.unit().id(), first.unit().id());
+
+  // Only the first report of the unit counts.
+  XLS_ASSERT_OK(coordinator.ReportWork(Report(again.unit())));
+  XLS_ASSERT_OK(coordinator.ReportWork(Report(first.unit())));
+  EXPECT_EQ(coordinator.samples_run(), 4);
+  EXPECT_TRUE(coordinator.IsDone(kStart + absl::Minutes(2)));
+}
+
+TEST(RemoteFuzzTest, DurationStopsHandingOutWork) {
+  FuzzCoordinator coordinator({.duration = absl::Minutes(10),
+                               .lease_duration = absl::Minutes(5)},
+                              kStart);
+  absl::Time leased = kStart + absl::Minutes(9);
+  ASSERT_TRUE(coordinator.GetWork("a", leased).has_unit());
+  ASSERT_TRUE(coordinator.GetWork("a", leased).has_unit());
+
+  absl::Time over = kStart + absl::Minutes(10);
+  EXPECT_FALSE(coordinator.GetWork("a", over).has_unit());
+  EXPECT_FALSE(coordinator.IsDone(over));
+  // Outstanding leases are not handed out again once they expire.
+  EXPECT_TRUE(coordinator.GetWork("a", leased + absl::Minutes(5)).done());
+}
+
+TEST(RemoteFuzzTest, DeduplicatesCrashers) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory crasher_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory summary_dir, TempDirectory::Create());
+  FuzzCoordinator coordinator({.samples_per_unit = 1,
+                               .crasher_dir = crasher_dir.path(),
+                               .summary_dir = summary_dir.path()},
+                              kStart);
+  fuzzer::GetWorkResponse first = coordinator.GetWork("a", kStart);
+  fuzzer::GetWorkResponse second = coordinator.GetWork("b", kStart);
+
+  fuzzer::ReportWorkRequest first_report = Report(first.unit());
+  AddCrasher(first_report, "0123abcd", "fn main() -> u32 { u32:1 }");
+  first_report.set_summaries("first");
+  XLS_ASSERT_OK(coordinator.ReportWork(first_report));
+
+  fuzzer::ReportWorkRequest second_report = Report(second.unit());
+  AddCrasher(second_report, "4567abcd", "fn main() -> u32 { u32:1 }");
+  AddCrasher(second_report, "89abcdef", "fn main() -> u32 { u32:2 }");
+  second_report.set_summaries("second");
+  XLS_ASSERT_OK(coordinator.ReportWork(second_report));
+
+  EXPECT_EQ(coordinator.crasher_count(), 2);
+  EXPECT_EQ(coordinator.duplicate_crasher_count(), 1);
+  XLS_EXPECT_OK(
+      FileExists(crasher_dir.path() / "0123abcd" / "exception.txt"));
+  EXPECT_FALSE(FileExists(crasher_dir.path() / "4567abcd").ok());
+  XLS_EXPECT_OK(FileExists(crasher_dir.path() / "89abcdef" /
+                           "crasher_2024-01-01_89abcdef.x"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string summaries,
+      GetFileContents(summary_dir.path() / "summary_remote.binarypb"));
+  EXPECT_EQ(summaries, "firstsecond");
+}
+
+TEST(RemoteFuzzTest, RejectsCrasherOutsideCrasherDirectory) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory crasher_dir, TempDirectory::Create());
+  FuzzCoordinator coordinator(
+      {.samples_per_unit = 1, .crasher_dir = crasher_dir.path()}, kStart);
+  fuzzer::ReportWorkRequest report =
+      Report(coordinator.GetWork("a", kStart).unit());
+  AddCrasher(report, "..", "fn main() -> u32 { u32:1 }");
+  EXPECT_THAT(coordinator.ReportWork(report),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid crasher name")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -106,6 +106,7 @@ std::string ArgvToCmdline(const std::vector<std::string>& argv) {
 
 absl::Status WriteIrSummaries(const std::filesystem::path& run_dir,
                               const fuzzer::SampleTimingProto& timing,
+                              bool validated_ir_cache_hit,
                               const std::filesystem::path& summary_path) {
   XLS_ASSIGN_OR_RETURN(std::filesystem::path summarize_ir_main_path,
                        GetXlsRunfilePath(kSummarizeIrMainPath));
@@ -120,6 +121,9 @@ absl::Status WriteIrSummaries(const std::filesystem::path& run_dir,
       absl::StrCat("--summary_file=", summary_path.string()),
       absl::StrCat("--timing=", timing_str),
   };
+  if (validated_ir_cache_hit) {
+    argv.push_back("--validated_ir_cache_hit");
+  }
 
   bool has_ir = false;
   std::filesystem::path unoptimized_path = run_dir / "sample.ir";
@@ -225,11 +229,37 @@ cd "$RUNDIR"
 
   VLOG(1) << "Starting to run sample";
   VLOG(2) << smp.input_text();
-  SampleRunner runner(run_dir);
-  XLS_RETURN_IF_ERROR(runner.RunFromFiles(sample_file_name, options_file_name,
-                                          testvector_path));
-
-  fuzzer::SampleTimingProto timing = runner.timing();
+  fuzzer::SampleTimingProto timing;
+  bool validated_ir_cache_hit = false;
+  if (smp.options().in_process()) {
+    // The sample runner calls the IR tools' library entry points directly, so
+    // run it in a single subprocess to keep a crash from taking down the
+    // fuzzer. Per-step timings and validated IR cache hits are not reported
+    // in this mode.
+    argv.back() = run_dir.string();
+    std::optional<absl::Duration> timeout;
+    if (smp.options().timeout_seconds().has_value()) {
+      timeout = absl::Seconds(*smp.options().timeout_seconds());
+    }
+    XLS_ASSIGN_OR_RETURN(SubprocessResult result,
+                         InvokeSubprocess(argv, run_dir, timeout));
+    if (result.timeout_expired) {
+      return absl::DeadlineExceededError(absl::StrCat(
+          "Sample runner timed out after ", *smp.options().timeout_seconds(),
+          " seconds"));
+    }
+    if (!result.normal_termination || result.exit_status != EXIT_SUCCESS) {
+      return absl::InternalError(
+          absl::StrFormat("Sample runner failed (exit status %d):\n%s",
+                          result.exit_status, result.stderr_content));
+    }
+  } else {
+    SampleRunner runner(run_dir);
+    XLS_RETURN_IF_ERROR(runner.RunFromFiles(
+        sample_file_name, options_file_name, testvector_path));
+    timing = runner.timing();
+    validated_ir_cache_hit = runner.validated_ir_cache_hit();
+  }
 
   absl::Duration total_elapsed = stopwatch.GetElapsedTime();
   if (generate_sample_elapsed.has_value()) {
@@ -245,7 +275,8 @@ cd "$RUNDIR"
   VLOG(1) << "Completed running sample, elapsed: " << total_elapsed;
 
   if (summary_file.has_value()) {
-    XLS_RETURN_IF_ERROR(WriteIrSummaries(run_dir, timing, *summary_file));
+    XLS_RETURN_IF_ERROR(WriteIrSummaries(
+        run_dir, timing, validated_ir_cache_hit, *summary_file));
   }
   return absl::OkStatus();
 }
@@ -23,6 +23,7 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/random/distributions.h"
 #include "absl/random/random.h"
@@ -39,6 +40,7 @@
 #include "xls/common/thread.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/fuzz_coverage.h"
 #include "xls/fuzzer/run_fuzz.h"
 #include "xls/fuzzer/sample.h"
 
@@ -57,7 +59,8 @@ absl::Status GenerateAndRunSamples(
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count,
-    const std::optional<absl::Duration>& duration, bool force_failure) {
+    const std::optional<absl::Duration>& duration, bool force_failure,
+    FuzzCoverage* coverage) {
   int64_t crashers = 0;
   LOG(INFO) << "--- Started worker " << worker_number;
   Stopwatch stopwatch;
@@ -96,11 +99,29 @@ absl::Status GenerateAndRunSamples(
       run_dir = temp_run_dir->path();
     }
 
+    int64_t variant = 0;
+    if (coverage != nullptr) {
+      variant = coverage->ChooseVariant(rng);
+    }
     absl::Status sample_status =
-        GenerateSampleAndRun(file_table, rng, ast_generator_options,
-                             sample_options, run_dir, crasher_dir, summary_file,
-                             force_failure)
+        GenerateSampleAndRun(
+            file_table, rng,
+            coverage == nullptr ? ast_generator_options
+                                : coverage->variant_options(variant),
+            sample_options, run_dir, crasher_dir, summary_file, force_failure)
             .status();
+    if (coverage != nullptr) {
+      absl::StatusOr<absl::flat_hash_set<std::string>> features =
+          CollectIrCoverage(run_dir);
+      if (features.ok()) {
+        int64_t new_features = coverage->Record(variant, *features);
+        VLOG(1) << absl::StreamFormat(
+            "--- Worker #%d: sample %d (variant %d) added %d features",
+            worker_number, sample, variant, new_features);
+      } else {
+        VLOG(1) << "Failed to collect coverage: " << features.status();
+      }
+    }
     if (!sample_status.ok()) {
       LOG(INFO) << kRedText
                 << absl::StreamFormat(
@@ -113,7 +134,7 @@ absl::Status GenerateAndRunSamples(
     absl::Duration elapsed = stopwatch.GetElapsedTime();
     if (sample > 0 && sample % 16 == 0) {
       std::vector<std::string> metrics;
-      metrics.reserve(3);
+      metrics.reserve(4);
       if (sample_count.has_value()) {
         metrics.push_back(
             absl::StrFormat("%d/%d samples", sample, *sample_count));
@@ -131,6 +152,10 @@ absl::Status GenerateAndRunSamples(
         metrics.push_back(
             absl::StrFormat("running for %s", absl::FormatDuration(elapsed)));
       }
+      if (coverage != nullptr) {
+        metrics.push_back(
+            absl::StrCat(coverage->feature_count(), " coverage features"));
+      }
       LOG(INFO) << absl::StreamFormat("--- Worker #%d: %s", worker_number,
                                       absl::StrJoin(metrics, ", "));
     }
@@ -169,7 +194,11 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count, std::optional<absl::Duration> duration,
-    bool force_failure) {
+    bool force_failure, bool coverage_guided) {
+  std::optional<FuzzCoverage> coverage;
+  if (coverage_guided) {
+    coverage.emplace(ast_generator_options);
+  }
   std::vector<std::unique_ptr<Thread>> workers;
   workers.resize(worker_count);
   std::vector<absl::Status> worker_status;
@@ -185,7 +214,8 @@ absl::Status ParallelGenerateAndRunSamples(
       *status =
           GenerateAndRunSamples(i, ast_generator_options, sample_options, seed,
                                 top_run_dir, crasher_dir, summary_dir,
-                                worker_sample_count, duration, force_failure);
+                                worker_sample_count, duration, force_failure,
+                                coverage.has_value() ? &*coverage : nullptr);
     });
   }
   for (int64_t i = 0; i < workers.size(); ++i) {
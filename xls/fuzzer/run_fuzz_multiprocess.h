@@ -37,6 +37,10 @@ namespace xls {
 //
 // If `force_failure` is true, every sample run will be considered a failure.
 // This is useful for testing failure paths.
+//
+// If `coverage_guided` is true, the workers share coverage feedback (see
+// FuzzCoverage) and bias sample generation toward generator option variants
+// whose samples add new coverage.
 absl::Status ParallelGenerateAndRunSamples(
     int64_t worker_count,
     const dslx::AstGeneratorOptions& ast_generator_options,
@@ -47,7 +51,7 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& summary_dir = std::nullopt,
     std::optional<int64_t> sample_count = std::nullopt,
     std::optional<absl::Duration> duration = std::nullopt,
-    bool force_failure = false);
+    bool force_failure = false, bool coverage_guided = false);
 
 }  // namespace xls
 
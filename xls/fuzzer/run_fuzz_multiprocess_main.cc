@@ -22,6 +22,8 @@
 
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
+#include "absl/random/distributions.h"
+#include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
@@ -32,6 +34,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/remote_fuzz.h"
 #include "xls/fuzzer/run_fuzz_multiprocess.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
@@ -42,11 +45,29 @@ ABSL_FLAG(int64_t, calls_per_sample, 128, "Arguments to generate per sample.");
 ABSL_FLAG(std::optional<std::string>, crash_path, std::nullopt,
           "Path at which to place crash data.");
 ABSL_FLAG(bool, codegen, false, "Run code generation.");
+ABSL_FLAG(std::optional<std::string>, coordinator_address, std::nullopt,
+          "Address (host:port) of a fuzz coordinator started with "
+          "--coordinator_port. If given, runs as a remote worker: work units "
+          "are pulled from the coordinator, which also supplies the generator "
+          "and sample options, and crashers and summaries are sent back to "
+          "it.");
+ABSL_FLAG(std::optional<int32_t>, coordinator_port, std::nullopt,
+          "If given, runs no samples locally but serves work units to remote "
+          "workers (see --coordinator_address) on this port, and collects "
+          "their deduplicated crashers in --crash_path and their summaries in "
+          "--summary_path. The workers are not authenticated; only use this "
+          "on a trusted network.");
+ABSL_FLAG(bool, coverage_guided, false,
+          "Share IR coverage feedback between workers and bias sample "
+          "generation toward options which add new coverage.");
 ABSL_FLAG(bool, emit_loops, true, "Emit loops in generator.");
 ABSL_FLAG(
     bool, force_failure, false,
     "Forces the samples to fail. Can be used to test failure code paths.");
 ABSL_FLAG(bool, generate_proc, false, "Generate a proc sample.");
+ABSL_FLAG(bool, in_process, false,
+          "Optimize and evaluate the IR within a single sample runner process "
+          "per sample rather than invoking a tool subprocess per step.");
 ABSL_FLAG(int64_t, max_width_aggregate_types, 1024,
           "The maximum width of aggregate types (tuples and arrays) in the "
           "generated samples.");
@@ -56,6 +77,9 @@ ABSL_FLAG(int64_t, proc_ticks, 100,
           "Number of ticks to execute the generated procs.");
 ABSL_FLAG(std::optional<int64_t>, sample_count, std::nullopt,
           "Number of samples to generate.");
+ABSL_FLAG(int64_t, samples_per_work_unit, 16,
+          "Number of samples in each work unit handed out by the fuzz "
+          "coordinator.");
 ABSL_FLAG(std::optional<std::string>, save_temps_path, std::nullopt,
           "Path of directory in which to save temporary files. These temporary "
           "files include DSLX, IR, and arguments. A separate numerically-named "
@@ -80,11 +104,18 @@ ABSL_FLAG(bool, use_llvm_jit, true,
 ABSL_FLAG(
     bool, use_system_verilog, true,
     "If true, emit SystemVerilog during codegen; otherwise emit Verilog.");
+ABSL_FLAG(std::optional<std::string>, validated_ir_cache_dir, std::nullopt,
+          "Directory of a cache of optimized IR which already passed codegen "
+          "and simulation. Samples whose optimized IR is found in the cache "
+          "skip codegen and simulation. May be shared across runs.");
 ABSL_FLAG(std::optional<int64_t>, worker_count, std::nullopt,
           "Number of workers to use for execution; defaults to number of "
           "physical cores detected.");
 ABSL_FLAG(bool, with_valid_holdoff, false,
           "If true, emit valid random holdoffs on proc input channels.");
+ABSL_FLAG(absl::Duration, work_unit_lease, absl::Minutes(30),
+          "Time after which the fuzz coordinator hands out a work unit again "
+          "if the worker it was handed to has not reported it back.");
 
 namespace xls {
 namespace {
@@ -94,13 +125,18 @@ struct Options {
   int64_t calls_per_sample;
   std::optional<std::filesystem::path> crash_path;
   bool codegen;
+  std::optional<std::string> coordinator_address;
+  std::optional<int32_t> coordinator_port;
+  bool coverage_guided;
   bool emit_loops;
   bool force_failure;
   bool generate_proc;
+  bool in_process;
   int64_t max_width_aggregate_types;
   int64_t max_width_bits_types;
   int64_t proc_ticks;
   std::optional<int64_t> sample_count;
+  int64_t samples_per_work_unit;
   std::optional<std::filesystem::path> save_temps_path;
   std::optional<int64_t> seed;
   bool simulate;
@@ -109,8 +145,10 @@ struct Options {
   std::optional<int64_t> timeout_seconds;
   bool use_llvm_jit;
   bool use_system_verilog;
+  std::optional<std::string> validated_ir_cache_dir;
   std::optional<int64_t> worker_count;
   bool with_valid_holdoff;
+  absl::Duration work_unit_lease;
 };
 
 absl::Status CheckOrCreateWritableDirectory(const std::filesystem::path& path) {
@@ -128,13 +166,6 @@ absl::Status CheckOrCreateWritableDirectory(const std::filesystem::path& path) {
 }
 
 absl::Status RealMain(const Options& options) {
-  if (options.crash_path.has_value()) {
-    XLS_RETURN_IF_ERROR(CheckOrCreateWritableDirectory(*options.crash_path));
-  }
-  if (options.summary_path.has_value()) {
-    XLS_RETURN_IF_ERROR(CheckOrCreateWritableDirectory(*options.summary_path));
-  }
-
   int64_t worker_count;
   if (options.worker_count.has_value()) {
     worker_count = *options.worker_count;
@@ -142,6 +173,18 @@ absl::Status RealMain(const Options& options) {
     worker_count = std::max(AvailableCPUs(), 1);
   }
 
+  if (options.coordinator_address.has_value()) {
+    return RunFuzzWorker(*options.coordinator_address, worker_count,
+                         /*top_run_dir=*/options.save_temps_path);
+  }
+
+  if (options.crash_path.has_value()) {
+    XLS_RETURN_IF_ERROR(CheckOrCreateWritableDirectory(*options.crash_path));
+  }
+  if (options.summary_path.has_value()) {
+    XLS_RETURN_IF_ERROR(CheckOrCreateWritableDirectory(*options.summary_path));
+  }
+
   dslx::AstGeneratorOptions ast_generator_options;
   ast_generator_options.emit_gate = !options.codegen;
   ast_generator_options.emit_loops = options.emit_loops;
@@ -156,6 +199,7 @@ absl::Status RealMain(const Options& options) {
   sample_options.set_codegen(options.codegen);
   sample_options.set_convert_to_ir(true);
   sample_options.set_input_is_dslx(true);
+  sample_options.set_in_process(options.in_process);
   sample_options.set_ir_converter_args({"--top=main"});
   sample_options.set_optimize_ir(true);
   sample_options.set_proc_ticks(options.generate_proc ? options.proc_ticks : 0);
@@ -171,13 +215,35 @@ absl::Status RealMain(const Options& options) {
   }
   sample_options.set_use_jit(options.use_llvm_jit);
   sample_options.set_use_system_verilog(options.use_system_verilog);
+  if (options.validated_ir_cache_dir.has_value()) {
+    sample_options.set_validated_ir_cache_dir(*options.validated_ir_cache_dir);
+  }
   sample_options.set_with_valid_holdoff(options.with_valid_holdoff);
 
+  if (options.coordinator_port.has_value()) {
+    FuzzCoordinator coordinator({
+        .ast_generator_options = ast_generator_options,
+        .sample_options = sample_options,
+        .seed = options.seed.has_value()
+                    ? static_cast<uint64_t>(*options.seed)
+                    : absl::Uniform<uint64_t>(absl::BitGen()),
+        .sample_count = options.sample_count,
+        .duration = options.duration,
+        .samples_per_unit = options.samples_per_work_unit,
+        .lease_duration = options.work_unit_lease,
+        .crasher_dir = options.crash_path,
+        .summary_dir = options.summary_path,
+        .force_failure = options.force_failure,
+    });
+    return ServeFuzzCoordinator(coordinator, *options.coordinator_port);
+  }
+
   return ParallelGenerateAndRunSamples(
       worker_count, ast_generator_options, sample_options, options.seed,
       /*top_run_dir=*/options.save_temps_path,
       /*crasher_dir=*/options.crash_path, /*summary_dir=*/options.summary_path,
-      options.sample_count, options.duration, options.force_failure);
+      options.sample_count, options.duration, options.force_failure,
+      options.coverage_guided);
 }
 
 }  // namespace
@@ -197,20 +263,37 @@ int main(int argc, char** argv) {
   if (absl::GetFlag(FLAGS_simulate) && !absl::GetFlag(FLAGS_codegen)) {
     LOG(QFATAL) << "Must specify --codegen when --simulate is given.";
   }
+  if (absl::GetFlag(FLAGS_coordinator_address).has_value() &&
+      absl::GetFlag(FLAGS_coordinator_port).has_value()) {
+    LOG(QFATAL) << "Cannot specify both --coordinator_address and "
+                   "--coordinator_port.";
+  }
+  if (absl::GetFlag(FLAGS_coordinator_port).has_value() &&
+      absl::GetFlag(FLAGS_coverage_guided)) {
+    LOG(QFATAL) << "--coverage_guided is not supported with remote workers.";
+  }
+  if (absl::GetFlag(FLAGS_samples_per_work_unit) <= 0) {
+    LOG(QFATAL) << "--samples_per_work_unit must be positive.";
+  }
 
   return xls::ExitStatus(xls::RealMain({
       .duration = absl::GetFlag(FLAGS_duration),
       .calls_per_sample = absl::GetFlag(FLAGS_calls_per_sample),
       .crash_path = absl::GetFlag(FLAGS_crash_path),
       .codegen = absl::GetFlag(FLAGS_codegen),
+      .coordinator_address = absl::GetFlag(FLAGS_coordinator_address),
+      .coordinator_port = absl::GetFlag(FLAGS_coordinator_port),
+      .coverage_guided = absl::GetFlag(FLAGS_coverage_guided),
       .emit_loops = absl::GetFlag(FLAGS_emit_loops),
       .force_failure = absl::GetFlag(FLAGS_force_failure),
       .generate_proc = absl::GetFlag(FLAGS_generate_proc),
+      .in_process = absl::GetFlag(FLAGS_in_process),
       .max_width_aggregate_types =
           absl::GetFlag(FLAGS_max_width_aggregate_types),
       .max_width_bits_types = absl::GetFlag(FLAGS_max_width_bits_types),
       .proc_ticks = absl::GetFlag(FLAGS_proc_ticks),
       .sample_count = absl::GetFlag(FLAGS_sample_count),
+      .samples_per_work_unit = absl::GetFlag(FLAGS_samples_per_work_unit),
       .save_temps_path = absl::GetFlag(FLAGS_save_temps_path),
       .seed = absl::GetFlag(FLAGS_seed),
       .simulate = absl::GetFlag(FLAGS_simulate),
@@ -219,7 +302,9 @@ int main(int argc, char** argv) {
       .timeout_seconds = absl::GetFlag(FLAGS_timeout_seconds),
       .use_llvm_jit = absl::GetFlag(FLAGS_use_llvm_jit),
       .use_system_verilog = absl::GetFlag(FLAGS_use_system_verilog),
+      .validated_ir_cache_dir = absl::GetFlag(FLAGS_validated_ir_cache_dir),
       .worker_count = absl::GetFlag(FLAGS_worker_count),
       .with_valid_holdoff = absl::GetFlag(FLAGS_with_valid_holdoff),
+      .work_unit_lease = absl::GetFlag(FLAGS_work_unit_lease),
   }));
 }
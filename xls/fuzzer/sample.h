@@ -139,6 +139,18 @@ class SampleOptions {
   }
   void set_timeout_seconds(int64_t value) { proto_.set_timeout_seconds(value); }
 
+  bool in_process() const { return proto_.in_process(); }
+  void set_in_process(bool value) { proto_.set_in_process(value); }
+
+  std::optional<std::string> validated_ir_cache_dir() const {
+    return proto_.has_validated_ir_cache_dir()
+               ? std::optional<std::string>(proto_.validated_ir_cache_dir())
+               : std::nullopt;
+  }
+  void set_validated_ir_cache_dir(std::string_view value) {
+    proto_.set_validated_ir_cache_dir(ToProtoString(value));
+  }
+
   int64_t calls_per_sample() const { return proto_.calls_per_sample(); }
   void set_calls_per_sample(int64_t value) {
     proto_.set_calls_per_sample(value);
@@ -14,7 +14,10 @@
 
 #include "xls/fuzzer/sample_runner.h"
 
+#include <unistd.h>
+
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
 #include <deque>
@@ -24,6 +27,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
 #include <utility>
 #include <variant>
 #include <vector>
@@ -33,18 +37,22 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/flags/declare.h"
 #include "absl/flags/flag.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/log/vlog_is_on.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "google/protobuf/text_format.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/logging/log_lines.h"
@@ -72,13 +80,20 @@
 #include "xls/fuzzer/cpp_sample_runner.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
+#include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/passes/optimization_cache.h"
 #include "xls/public/runtime_build_actions.h"
 #include "xls/simulation/check_simulator.h"
 #include "xls/tests/testvector.pb.h"
 #include "xls/tools/eval_utils.h"
+#include "xls/tools/opt.h"
 #include "re2/re2.h"
 
 // These are used to forward, but also see comment below.
@@ -259,6 +274,145 @@ SampleRunner::Commands::Callable CallableFromExecutable(
   };
 }
 
+// Returns `status`, downgraded to a FailedPrecondition error if it matches one
+// of the known failures of `tool`. This mirrors the stderr filtering done for
+// subprocesses for tools run in process.
+absl::Status SuppressKnownFailures(std::string_view tool, absl::Status status,
+                                   const SampleOptions& options) {
+  if (status.ok()) {
+    return status;
+  }
+  for (const KnownFailure& filter : options.known_failures()) {
+    if ((filter.tool == nullptr || RE2::FullMatch(tool, *filter.tool)) &&
+        RE2::PartialMatch(status.message(), *filter.stderr_regex)) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "%s failed but failure was suppressed due to stderr regexp: %s",
+          tool, status.message()));
+    }
+  }
+  return status;
+}
+
+// Runs `body` as the in-process equivalent of `tool`. Like a subprocess, any
+// error is written to `<tool>.stderr` in the run directory.
+absl::StatusOr<std::string> RunInProcess(
+    std::string_view tool, const std::filesystem::path& run_dir,
+    const SampleOptions& options,
+    absl::FunctionRef<absl::StatusOr<std::string>()> body) {
+  absl::StatusOr<std::string> result = body();
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      run_dir / absl::StrCat(tool, ".stderr"),
+      result.ok() ? "" : result.status().ToString()));
+  if (!result.ok()) {
+    return SuppressKnownFailures(tool, result.status(), options);
+  }
+  return result;
+}
+
+// Returns a callable which optimizes an IR file in process with the same
+// default options as opt_main. Takes the arguments passed to opt_main by
+// OptimizeIr.
+SampleRunner::Commands::Callable InProcessOptMain() {
+  return [](const std::vector<std::string>& args,
+            const std::filesystem::path& run_dir,
+            const SampleOptions& options) -> absl::StatusOr<std::string> {
+    XLS_RET_CHECK_EQ(args.size(), 1) << absl::StrJoin(args, " ");
+    return RunInProcess(
+        "opt_main", run_dir, options, [&]() -> absl::StatusOr<std::string> {
+          XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(args[0]));
+          return tools::OptimizeIrForTop(ir_text, tools::OptOptions());
+        });
+  };
+}
+
+// Returns a callable which evaluates the top function of an IR file on the
+// arguments of a testvector in process, printing the results like
+// eval_ir_main. Takes the arguments passed to eval_ir_main by
+// EvaluateIrFunction.
+SampleRunner::Commands::Callable InProcessEvalIrMain() {
+  return [](const std::vector<std::string>& args,
+            const std::filesystem::path& run_dir,
+            const SampleOptions& options) -> absl::StatusOr<std::string> {
+    std::optional<std::string> testvector_path;
+    std::optional<std::string> ir_path;
+    bool use_jit = false;
+    for (std::string_view arg : args) {
+      if (absl::ConsumePrefix(&arg, "--testvector_textproto=")) {
+        testvector_path = std::string(arg);
+      } else if (arg == "--use_llvm_jit" || arg == "--nouse_llvm_jit") {
+        use_jit = arg == "--use_llvm_jit";
+      } else {
+        XLS_RET_CHECK(!ir_path.has_value() && !absl::StartsWith(arg, "--"))
+            << "Unsupported eval_ir_main arguments: "
+            << absl::StrJoin(args, " ");
+        ir_path = std::string(arg);
+      }
+    }
+    XLS_RET_CHECK(testvector_path.has_value() && ir_path.has_value());
+    return RunInProcess(
+        "eval_ir_main", run_dir, options,
+        [&]() -> absl::StatusOr<std::string> {
+          XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(*ir_path));
+          XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                               Parser::ParsePackage(ir_text, *ir_path));
+          XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+          testvector::SampleInputsProto testvector;
+          XLS_RETURN_IF_ERROR(
+              ParseTextProtoFile(*testvector_path, &testvector));
+          std::vector<std::vector<Value>> batched_args;
+          for (std::string_view arg_line : testvector.function_args().args()) {
+            std::vector<Value> arg_values;
+            for (std::string_view value_text : absl::StrSplit(arg_line, ';')) {
+              XLS_ASSIGN_OR_RETURN(Value value,
+                                   Parser::ParseTypedValue(value_text));
+              arg_values.push_back(std::move(value));
+            }
+            batched_args.push_back(std::move(arg_values));
+          }
+          std::vector<Value> result_values;
+          if (use_jit) {
+            // Evaluate the whole batch with a single call into the jitted
+            // code.
+            XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                                 FunctionJit::Create(f));
+            XLS_ASSIGN_OR_RETURN(
+                result_values,
+                DropInterpreterEvents(jit->RunBatched(batched_args)));
+          } else {
+            result_values.reserve(batched_args.size());
+            for (const std::vector<Value>& arg_values : batched_args) {
+              XLS_ASSIGN_OR_RETURN(Value result,
+                                   DropInterpreterEvents(
+                                       InterpretFunction(f, arg_values)));
+              result_values.push_back(std::move(result));
+            }
+          }
+          std::string results;
+          for (const Value& result : result_values) {
+            absl::StrAppend(&results, result.ToString(FormatPreference::kHex),
+                            "\n");
+          }
+          return results;
+        });
+  };
+}
+
+// Returns the command to run for `tool`: the one given in `commands` if any,
+// the in-process equivalent if the sample runs tools in process and one
+// exists, or else the tool's executable.
+SampleRunner::Commands::Callable ResolveCommand(
+    const std::optional<SampleRunner::Commands::Callable>& command,
+    std::string_view executable, const SampleOptions& options,
+    SampleRunner::Commands::Callable (*in_process)()) {
+  if (command.has_value()) {
+    return *command;
+  }
+  if (options.in_process() && in_process != nullptr) {
+    return in_process();
+  }
+  return CallableFromExecutable(executable);
+}
+
 // Runs the given command, returning the command's stdout if successful, and
 // attaching the command's stderr to the resulting status if not.
 absl::StatusOr<std::string> RunCommand(
@@ -325,18 +479,16 @@ absl::StatusOr<std::vector<dslx::InterpValue>> EvaluateIrFunction(
     const std::filesystem::path& testvector_path, bool use_jit,
     const SampleOptions& options, const std::filesystem::path& run_dir,
     const SampleRunner::Commands& commands) {
-  std::optional<SampleRunner::Commands::Callable> command =
-      commands.eval_ir_main;
-  if (!command.has_value()) {
-    command = CallableFromExecutable(kBinary.eval_ir_main);
-  }
+  SampleRunner::Commands::Callable command = ResolveCommand(
+      commands.eval_ir_main, kBinary.eval_ir_main, options,
+      &InProcessEvalIrMain);
 
   XLS_ASSIGN_OR_RETURN(
       std::string results_text,
       RunCommand(
           absl::StrFormat("Evaluating IR file (%s): %s",
                           (use_jit ? "JIT" : "interpreter"), ir_path),
-          *command,
+          command,
           {
               absl::StrCat("--testvector_textproto=", testvector_path.string()),
               absl::StrFormat("--%suse_llvm_jit", use_jit ? "" : "no"),
@@ -396,15 +548,12 @@ absl::StatusOr<std::filesystem::path> OptimizeIr(
     const std::filesystem::path& ir_path, const SampleOptions& options,
     const std::filesystem::path& run_dir,
     const SampleRunner::Commands& commands) {
-  std::optional<SampleRunner::Commands::Callable> command =
-      commands.ir_opt_main;
-  if (!command.has_value()) {
-    command = CallableFromExecutable(kBinary.ir_opt_main);
-  }
+  SampleRunner::Commands::Callable command = ResolveCommand(
+      commands.ir_opt_main, kBinary.ir_opt_main, options, &InProcessOptMain);
 
   XLS_ASSIGN_OR_RETURN(
       std::string opt_ir_text,
-      RunCommand("Optimizing IR", *command, {ir_path}, run_dir, options));
+      RunCommand("Optimizing IR", command, {ir_path}, run_dir, options));
   VLOG(3) << "Optimized IR:\n" << opt_ir_text;
   std::filesystem::path opt_ir_path = run_dir / "sample.opt.ir";
   XLS_RETURN_IF_ERROR(SetFileContents(opt_ir_path, opt_ir_text));
@@ -768,6 +917,68 @@ SimulateProc(const std::filesystem::path& verilog_path,
   return unordered_channel_values;
 }
 
+// Returns the key under which the optimized IR at `opt_ir_path` is recorded in
+// the validated IR cache, or std::nullopt if the IR has no top function. The
+// key depends only on the structure of the top function and on the sample
+// options, so samples which optimize to the same IR share a key.
+std::optional<std::string> ValidatedIrCacheKey(
+    const std::filesystem::path& opt_ir_path, const SampleOptions& options) {
+  absl::StatusOr<std::string> key = [&]() -> absl::StatusOr<std::string> {
+    XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(opt_ir_path));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         Parser::ParsePackage(ir_text));
+    XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+    fuzzer::SampleOptionsProto key_options = options.proto();
+    key_options.clear_validated_ir_cache_dir();
+    std::string options_text;
+    XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(key_options,
+                                                              &options_text));
+    return OptimizationCache::ComputeKey(f, options_text, /*opt_level=*/0);
+  }();
+  if (!key.ok()) {
+    LOG(WARNING) << "Unable to compute validated IR cache key: "
+                 << key.status();
+    return std::nullopt;
+  }
+  return *std::move(key);
+}
+
+std::filesystem::path ValidatedIrCachePath(std::string_view cache_dir,
+                                           std::string_view key) {
+  return std::filesystem::path(cache_dir) / absl::StrCat(key, ".ir");
+}
+
+// Records that the optimized IR at `opt_ir_path` passed codegen and
+// simulation. Failures are logged rather than returned as the cache is only
+// an optimization.
+void StoreValidatedIr(std::string_view cache_dir, std::string_view key,
+                      const std::filesystem::path& opt_ir_path) {
+  // Copy to a uniquely named temporary file and rename it into place so that
+  // concurrent fuzzer processes never observe a partial entry.
+  std::filesystem::path path = ValidatedIrCachePath(cache_dir, key);
+  static std::atomic<int64_t> temp_file_counter = 0;
+  std::filesystem::path temp_path =
+      std::filesystem::path(cache_dir) /
+      absl::StrFormat("%s.ir.tmp.%d.%d", key, getpid(),
+                      temp_file_counter.fetch_add(1));
+  std::error_code ec;
+  std::filesystem::create_directories(cache_dir, ec);
+  if (!ec) {
+    std::filesystem::copy_file(
+        opt_ir_path, temp_path,
+        std::filesystem::copy_options::overwrite_existing, ec);
+  }
+  if (!ec) {
+    std::filesystem::rename(temp_path, path, ec);
+  }
+  if (ec) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to write validated IR cache entry `%s`: %s", path.string(),
+        ec.message());
+    std::filesystem::remove(temp_path, ec);
+  }
+}
+
 }  // namespace
 
 absl::Status SampleRunner::Run(const Sample& sample) {
@@ -895,12 +1106,33 @@ absl::Status SampleRunner::RunFunction(
     }
   }
 
+  // Key of the optimized IR in the validated IR cache, if it is to be recorded
+  // there once the sample passes.
+  std::optional<std::string> validated_ir_key;
+  std::filesystem::path opt_ir_path;
   if (options.optimize_ir()) {
     Stopwatch t;
-    XLS_ASSIGN_OR_RETURN(std::filesystem::path opt_ir_path,
+    XLS_ASSIGN_OR_RETURN(opt_ir_path,
                          OptimizeIr(ir_path, options, run_dir_, commands_));
     timing_.set_optimize_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
 
+    bool skip_codegen = false;
+    if (options.validated_ir_cache_dir().has_value() &&
+        (options.codegen() || options.codegen_ng())) {
+      validated_ir_key = ValidatedIrCacheKey(opt_ir_path, options);
+      if (validated_ir_key.has_value() &&
+          FileExists(ValidatedIrCachePath(*options.validated_ir_cache_dir(),
+                                          *validated_ir_key))
+              .ok()) {
+        VLOG(1) << "Optimized IR was already validated; skipping codegen and "
+                   "simulation. Key: "
+                << *validated_ir_key;
+        validated_ir_cache_hit_ = true;
+        skip_codegen = true;
+        validated_ir_key.reset();
+      }
+    }
+
     if (args_batch.has_value()) {
       if (options.use_jit()) {
         t.Reset();
@@ -920,7 +1152,7 @@ absl::Status SampleRunner::RunFunction(
           absl::ToInt64Nanoseconds(t.GetElapsedTime()));
     }
 
-    if (options.codegen()) {
+    if (options.codegen() && !skip_codegen) {
       t.Reset();
       XLS_ASSIGN_OR_RETURN(std::filesystem::path verilog_path,
                            Codegen(opt_ir_path, options.codegen_args(), options,
@@ -938,7 +1170,7 @@ absl::Status SampleRunner::RunFunction(
       }
     }
 
-    if (options.codegen_ng()) {
+    if (options.codegen_ng() && !skip_codegen) {
       t.Reset();
       XLS_ASSIGN_OR_RETURN(
           std::filesystem::path verilog_path,
@@ -961,8 +1193,13 @@ absl::Status SampleRunner::RunFunction(
 
   absl::flat_hash_map<std::string, absl::Span<const dslx::InterpValue>>
       results_spans(results.begin(), results.end());
-  return CompareResultsFunction(
-      results_spans, args_batch.has_value() ? &*args_batch : nullptr);
+  XLS_RETURN_IF_ERROR(CompareResultsFunction(
+      results_spans, args_batch.has_value() ? &*args_batch : nullptr));
+  if (validated_ir_key.has_value()) {
+    StoreValidatedIr(*options.validated_ir_cache_dir(), *validated_ir_key,
+                     opt_ir_path);
+  }
+  return absl::OkStatus();
 }
 
 absl::Status SampleRunner::RunProc(
@@ -77,6 +77,11 @@ class SampleRunner {
 
   const fuzzer::SampleTimingProto& timing() const { return timing_; }
 
+  // Whether codegen and simulation were skipped because the optimized IR was
+  // found in the validated IR cache (see
+  // SampleOptionsProto.validated_ir_cache_dir).
+  bool validated_ir_cache_hit() const { return validated_ir_cache_hit_; }
+
  private:
   // Runs a sample with a function as the top which is read from files.
   absl::Status RunFunction(const std::filesystem::path& input_path,
@@ -90,6 +95,7 @@ class SampleRunner {
   const std::filesystem::path run_dir_;
   const Commands commands_;
   fuzzer::SampleTimingProto timing_;
+  bool validated_ir_cache_hit_ = false;
 };
 
 }  // namespace xls
@@ -303,6 +303,29 @@ TEST_F(SampleRunnerTest, EvaluateIR) {
               ElementsAre("bits[8]:0x8e", "bits[8]:0xce"));
 }
 
+TEST_F(SampleRunnerTest, OptimizeAndEvaluateIRInProcess) {
+  SampleRunner runner(GetTempPath());
+  constexpr std::string_view dslx_text =
+      "fn main(x: u8, y: u8) -> u8 { x + y }";
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  options.set_optimize_ir(true);
+  options.set_in_process(true);
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch,
+                           ToArgsBatch({{"bits[8]:42", "bits[8]:100"},
+                                        {"bits[8]:222", "bits[8]:240"}}));
+  XLS_ASSERT_OK(
+      runner.Run(Sample(std::string(dslx_text), options, args_batch)));
+  EXPECT_TRUE(std::filesystem::exists(GetTempPath() / "sample.opt.ir"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string opt_ir_results,
+      GetFileContents(GetTempPath() / "sample.opt.ir.results"));
+  EXPECT_THAT(absl::StrSplit(absl::StripAsciiWhitespace(opt_ir_results), "\n",
+                             absl::SkipEmpty()),
+              ElementsAre("bits[8]:0x8e", "bits[8]:0xce"));
+}
+
 TEST_F(SampleRunnerTest, EvaluateIRWide) {
   SampleRunner runner(GetTempPath());
   constexpr std::string_view dslx_text =
@@ -616,6 +639,42 @@ TEST_F(SampleRunnerTest, CodegenCombinational) {
               ElementsAre("bits[8]:0x8e"));
 }
 
+TEST_F(SampleRunnerTest, ValidatedIrCacheSkipsCodegen) {
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  options.set_codegen(true);
+  options.set_codegen_args({"--generator=combinational"});
+  options.set_use_system_verilog(false);
+  options.set_simulate(true);
+  options.set_validated_ir_cache_dir((GetTempPath() / "cache").string());
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch,
+                           ToArgsBatch({{"bits[8]:42", "bits[8]:100"}}));
+
+  std::filesystem::path first_dir = GetTempPath() / "first";
+  XLS_ASSERT_OK(RecursivelyCreateDir(first_dir));
+  SampleRunner first(first_dir);
+  XLS_ASSERT_OK(first.Run(
+      Sample("fn main(x: u8, y: u8) -> u8 { x + y }", options, args_batch)));
+  EXPECT_FALSE(first.validated_ir_cache_hit());
+  EXPECT_TRUE(std::filesystem::exists(first_dir / "sample.v.results"));
+
+  // Optimizes to the same IR as the first sample.
+  std::filesystem::path second_dir = GetTempPath() / "second";
+  XLS_ASSERT_OK(RecursivelyCreateDir(second_dir));
+  SampleRunner second(second_dir);
+  XLS_ASSERT_OK(second.Run(Sample(
+      "fn main(x: u8, y: u8) -> u8 { x + y + u8:0 }", options, args_batch)));
+  EXPECT_TRUE(second.validated_ir_cache_hit());
+  EXPECT_FALSE(std::filesystem::exists(second_dir / "sample.v"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string opt_ir_results,
+      GetFileContents(second_dir / "sample.opt.ir.results"));
+  EXPECT_THAT(absl::StrSplit(absl::StripAsciiWhitespace(opt_ir_results), "\n",
+                             absl::SkipEmpty()),
+              ElementsAre("bits[8]:0x8e"));
+}
+
 TEST_F(SampleRunnerTest, CodegenCombinationalWrongResults) {
   SampleRunner runner(
       GetTempPath(),
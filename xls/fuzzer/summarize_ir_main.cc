@@ -12,16 +12,21 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "google/protobuf/repeated_ptr_field.h"
 #include "google/protobuf/text_format.h"
@@ -29,6 +34,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/dev_tools/ir_text_stats.h"
 #include "xls/fuzzer/sample_summary.pb.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/op.h"
@@ -47,6 +53,9 @@ operations are being covered. Usage:
 
 The summary file will be created if it does not exist. Otherwise the summary
 file is appended to.
+
+With --streaming the IR text is scanned, one function per thread, instead of
+being parsed into a package. This is much cheaper for very large IR files.
 )";
 
 ABSL_FLAG(std::string, optimized_ir, "", "Optimized IR file to summarize.");
@@ -55,6 +64,11 @@ ABSL_FLAG(
     std::string, timing, "",
     "A serialized fuzzer::SampleTimingProto to write into the summary file.");
 ABSL_FLAG(std::string, unoptimized_ir, "", "Unoptimized IR file to summarize.");
+ABSL_FLAG(bool, validated_ir_cache_hit, false,
+          "Whether codegen and simulation of the sample were skipped because "
+          "its optimized IR was already validated.");
+ABSL_FLAG(bool, streaming, false,
+          "Summarize by scanning the IR text rather than parsing it.");
 
 namespace xls {
 namespace {
@@ -89,9 +103,72 @@ void SummarizePackage(Package* package,
     }
   }
 }
-absl::StatusOr<std::unique_ptr<Package>> ParseFile(std::string_view path) {
+// Returns the summary type of a type in IR text syntax; see TypeToString.
+std::string TypeTextToString(std::string_view type) {
+  if (absl::EndsWith(type, "]") &&
+      (!absl::StartsWith(type, "bits[") || absl::c_count(type, '[') > 1)) {
+    return "array";
+  }
+  if (absl::StartsWith(type, "bits[")) {
+    return "bits";
+  }
+  if (absl::StartsWith(type, "(")) {
+    return "tuple";
+  }
+  return "other";
+}
+
+// Equivalent of SummarizePackage which scans the IR text instead of parsing it.
+absl::Status SummarizeIrText(
+    std::string_view ir_text,
+    google::protobuf::RepeatedPtrField<fuzzer::NodeProto>* nodes) {
+  XLS_ASSIGN_OR_RETURN(std::vector<IrTextFunction> functions,
+                       SplitIrTextFunctions(ir_text));
+  std::vector<std::vector<fuzzer::NodeProto>> summaries(functions.size());
+  XLS_RETURN_IF_ERROR(ParallelForEachIrTextFunction(
+      functions, /*thread_count=*/0,
+      [&](int64_t i, const IrTextFunction& function) -> absl::Status {
+        std::vector<fuzzer::NodeProto>& summary = summaries[i];
+        absl::flat_hash_map<std::string_view, int64_t> node_index;
+        return ForEachIrTextNode(
+            function, [&](const IrTextNode& node) -> absl::Status {
+              fuzzer::NodeProto node_proto;
+              node_proto.set_op(std::string{node.op});
+              node_proto.set_type(TypeTextToString(node.type));
+              node_proto.set_width(node.flat_bit_count);
+              for (std::string_view operand : node.operands) {
+                const fuzzer::NodeProto& operand_node =
+                    summary[node_index.at(operand)];
+                fuzzer::NodeProto* operand_proto = node_proto.add_operands();
+                operand_proto->set_op(operand_node.op());
+                operand_proto->set_type(operand_node.type());
+                operand_proto->set_width(operand_node.width());
+              }
+              node_index[node.name] = summary.size();
+              summary.push_back(std::move(node_proto));
+              return absl::OkStatus();
+            });
+      }));
+  for (std::vector<fuzzer::NodeProto>& summary : summaries) {
+    for (fuzzer::NodeProto& node_proto : summary) {
+      *nodes->Add() = std::move(node_proto);
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Summarizes the IR in `path` into `nodes`.
+absl::Status SummarizeFile(
+    std::string_view path,
+    google::protobuf::RepeatedPtrField<fuzzer::NodeProto>* nodes) {
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
-  return Parser::ParsePackage(contents, path);
+  if (absl::GetFlag(FLAGS_streaming)) {
+    return SummarizeIrText(contents, nodes);
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(contents, path));
+  SummarizePackage(package.get(), nodes);
+  return absl::OkStatus();
 }
 
 absl::Status RealMain(std::string_view unoptimized_path,
@@ -111,16 +188,17 @@ absl::Status RealMain(std::string_view unoptimized_path,
     }
     *summary_proto->mutable_timing() = timing;
   }
+  if (absl::GetFlag(FLAGS_validated_ir_cache_hit)) {
+    summary_proto->set_validated_ir_cache_hit(true);
+  }
 
   if (!unoptimized_path.empty()) {
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                         ParseFile(unoptimized_path));
-    SummarizePackage(package.get(), summary_proto->mutable_unoptimized_nodes());
+    XLS_RETURN_IF_ERROR(SummarizeFile(
+        unoptimized_path, summary_proto->mutable_unoptimized_nodes()));
   }
   if (!optimized_path.empty()) {
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                         ParseFile(optimized_path));
-    SummarizePackage(package.get(), summary_proto->mutable_optimized_nodes());
+    XLS_RETURN_IF_ERROR(SummarizeFile(
+        optimized_path, summary_proto->mutable_optimized_nodes()));
   }
 
   QCHECK(!absl::GetFlag(FLAGS_summary_file).empty())
@@ -23,10 +23,12 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -39,6 +41,7 @@
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/interpreter/observer.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/block.h"
 #include "xls/ir/block_elaboration.h"
 #include "xls/ir/channel.h"
@@ -47,7 +50,9 @@
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
@@ -941,6 +946,359 @@ StatelessBlockContinuation(BlockElaboration&&, BlockRunResult&&,
                            Evaluate) -> StatelessBlockContinuation<Evaluate>;
 }  // namespace
 
+absl::StatusOr<std::unique_ptr<CompiledBlockInterpreter>>
+CompiledBlockInterpreter::Create(Block* block) {
+  if (!block->GetInstantiations().empty()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Block '%s' has instantiations which are not supported by the "
+        "compiled block interpreter",
+        block->name()));
+  }
+  auto interpreter = absl::WrapUnique(new CompiledBlockInterpreter(block));
+  for (int64_t i = 0; i < block->GetInputPorts().size(); ++i) {
+    interpreter->input_port_indices_[block->GetInputPorts()[i]->GetName()] = i;
+  }
+  for (int64_t i = 0; i < block->GetOutputPorts().size(); ++i) {
+    interpreter->output_port_indices_[block->GetOutputPorts()[i]->GetName()] =
+        i;
+  }
+  for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+    Register* reg = block->GetRegisters()[i];
+    interpreter->register_indices_[reg->name()] = i;
+    interpreter->register_values_.push_back(ZeroOfType(reg->type()));
+  }
+  interpreter->output_values_.resize(block->GetOutputPorts().size());
+  interpreter->next_register_values_.resize(block->GetRegisters().size());
+
+  absl::flat_hash_map<Node*, int64_t> slots;
+  slots.reserve(block->node_count());
+  interpreter->steps_.reserve(block->node_count());
+  for (Node* node : TopoSort(block)) {
+    Step step{.node = node};
+    step.operand_slots.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      step.operand_slots.push_back(slots.at(operand));
+    }
+    if (node->Is<InputPort>()) {
+      step.index = interpreter->input_port_indices_.at(node->GetName());
+    } else if (node->Is<OutputPort>()) {
+      step.index = interpreter->output_port_indices_.at(node->GetName());
+    } else if (node->Is<RegisterRead>()) {
+      step.index = interpreter->register_indices_.at(
+          node->As<RegisterRead>()->GetRegister()->name());
+    } else if (node->Is<RegisterWrite>()) {
+      step.index = interpreter->register_indices_.at(
+          node->As<RegisterWrite>()->GetRegister()->name());
+    }
+    slots[node] = interpreter->steps_.size();
+    interpreter->steps_.push_back(std::move(step));
+  }
+  interpreter->node_values_.resize(interpreter->steps_.size());
+  return interpreter;
+}
+
+absl::StatusOr<int64_t> CompiledBlockInterpreter::GetInputPortIndex(
+    std::string_view name) const {
+  auto it = input_port_indices_.find(name);
+  if (it == input_port_indices_.end()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Block has no input port '%s'", name));
+  }
+  return it->second;
+}
+
+absl::StatusOr<int64_t> CompiledBlockInterpreter::GetOutputPortIndex(
+    std::string_view name) const {
+  auto it = output_port_indices_.find(name);
+  if (it == output_port_indices_.end()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Block has no output port '%s'", name));
+  }
+  return it->second;
+}
+
+absl::StatusOr<int64_t> CompiledBlockInterpreter::GetRegisterIndex(
+    std::string_view name) const {
+  auto it = register_indices_.find(name);
+  if (it == register_indices_.end()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Block has no register '%s'", name));
+  }
+  return it->second;
+}
+
+absl::Status CompiledBlockInterpreter::SetRegisterValues(
+    absl::Span<const Value> values) {
+  XLS_RET_CHECK_EQ(values.size(), register_values_.size());
+  for (int64_t i = 0; i < values.size(); ++i) {
+    XLS_RET_CHECK(ValueConformsToType(values[i],
+                                      block_->GetRegisters()[i]->type()))
+        << "'" << block_->GetRegisters()[i]->name()
+        << "' is incorrect type. Value " << values[i] << " does not match.";
+  }
+  register_values_.assign(values.begin(), values.end());
+  return absl::OkStatus();
+}
+
+absl::Status CompiledBlockInterpreter::RunOneCycle(
+    absl::Span<const Value> inputs) {
+  XLS_RET_CHECK_EQ(inputs.size(), block_->GetInputPorts().size());
+  events_.Clear();
+  for (int64_t i = 0; i < steps_.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(node_values_[i], EvaluateStep(steps_[i], inputs));
+    if (observer_ != nullptr) {
+      observer_->NodeEvaluated(steps_[i].node, node_values_[i]);
+    }
+  }
+  // Register writes are staged so that reads scheduled after a write in the
+  // same cycle still see the current value.
+  for (const Step& step : steps_) {
+    if (step.node->Is<RegisterWrite>()) {
+      register_values_[step.index] =
+          std::move(next_register_values_[step.index]);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Value> CompiledBlockInterpreter::EvaluateStep(
+    const Step& step, absl::Span<const Value> inputs) {
+  Node* node = step.node;
+  switch (node->op()) {
+    case Op::kInputPort: {
+      const Value& value = inputs[step.index];
+      if (!ValueConformsToType(value, node->GetType())) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Expected value %s to match type %s of input port '%s'",
+            value.ToString(), node->GetType()->ToString(), node->GetName()));
+      }
+      return value;
+    }
+    case Op::kOutputPort:
+      output_values_[step.index] = OperandValue(step, 0);
+      // Output ports have empty tuple types.
+      return Value::Tuple({});
+    case Op::kRegisterRead:
+      return register_values_[step.index];
+    case Op::kRegisterWrite: {
+      RegisterWrite* reg_write = node->As<RegisterWrite>();
+      Value& next = next_register_values_[step.index];
+      if (reg_write->reset().has_value()) {
+        XLS_ASSIGN_OR_RETURN(int64_t reset_operand,
+                             reg_write->reset_operand_number());
+        bool reset_signal = OperandValue(step, reset_operand).bits().IsOne();
+        const Reset& reset = reg_write->GetRegister()->reset().value();
+        if (reset_signal != reset.active_low) {
+          // Reset is activated. Next register state is the reset value.
+          next = reset.reset_value;
+          return Value::Tuple({});
+        }
+      }
+      bool load_enable = true;
+      if (reg_write->load_enable().has_value()) {
+        XLS_ASSIGN_OR_RETURN(int64_t load_enable_operand,
+                             reg_write->load_enable_operand_number());
+        load_enable = OperandValue(step, load_enable_operand).bits().IsOne();
+      }
+      if (!load_enable) {
+        next = register_values_[step.index];
+      } else {
+        next = OperandValue(step, 0);
+      }
+      // Register writes have empty tuple types.
+      return Value::Tuple({});
+    }
+    case Op::kLiteral:
+      return node->As<Literal>()->value();
+    case Op::kIdentity:
+      return OperandValue(step, 0);
+    case Op::kTuple: {
+      std::vector<Value> elements;
+      elements.reserve(step.operand_slots.size());
+      for (int64_t slot : step.operand_slots) {
+        elements.push_back(node_values_[slot]);
+      }
+      return Value::Tuple(elements);
+    }
+    case Op::kTupleIndex:
+      return OperandValue(step, 0).element(node->As<TupleIndex>()->index());
+    case Op::kNot:
+      return Value(bits_ops::Not(OperandValue(step, 0).bits()));
+    case Op::kAnd:
+    case Op::kOr:
+    case Op::kXor: {
+      Bits result = OperandValue(step, 0).bits();
+      for (int64_t i = 1; i < step.operand_slots.size(); ++i) {
+        const Bits& operand = OperandValue(step, i).bits();
+        if (node->op() == Op::kAnd) {
+          result = bits_ops::And(result, operand);
+        } else if (node->op() == Op::kOr) {
+          result = bits_ops::Or(result, operand);
+        } else {
+          result = bits_ops::Xor(result, operand);
+        }
+      }
+      return Value(std::move(result));
+    }
+    case Op::kAdd:
+      return Value(bits_ops::Add(OperandValue(step, 0).bits(),
+                                 OperandValue(step, 1).bits()));
+    case Op::kSub:
+      return Value(bits_ops::Sub(OperandValue(step, 0).bits(),
+                                 OperandValue(step, 1).bits()));
+    case Op::kEq:
+      return Value::Bool(OperandValue(step, 0) == OperandValue(step, 1));
+    case Op::kNe:
+      return Value::Bool(OperandValue(step, 0) != OperandValue(step, 1));
+    case Op::kBitSlice: {
+      BitSlice* bit_slice = node->As<BitSlice>();
+      return Value(OperandValue(step, 0).bits().Slice(bit_slice->start(),
+                                                      bit_slice->width()));
+    }
+    case Op::kConcat: {
+      std::vector<Bits> operands;
+      operands.reserve(step.operand_slots.size());
+      for (int64_t slot : step.operand_slots) {
+        operands.push_back(node_values_[slot].bits());
+      }
+      return Value(bits_ops::Concat(operands));
+    }
+    case Op::kZeroExt:
+      return Value(bits_ops::ZeroExtend(OperandValue(step, 0).bits(),
+                                        node->BitCountOrDie()));
+    case Op::kSignExt:
+      return Value(bits_ops::SignExtend(OperandValue(step, 0).bits(),
+                                        node->BitCountOrDie()));
+    case Op::kSel: {
+      // Operands are the selector, the cases and then the optional default.
+      int64_t case_count = node->As<Select>()->cases().size();
+      const Bits& selector = OperandValue(step, 0).bits();
+      if (bits_ops::ULessThan(selector, case_count)) {
+        return OperandValue(step, 1 + *selector.ToUint64());
+      }
+      return OperandValue(step, step.operand_slots.size() - 1);
+    }
+    default:
+      break;
+  }
+
+  // Everything else is evaluated by an IrInterpreter on just this node.
+  fallback_values_.clear();
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    fallback_values_[node->operand(i)] = OperandValue(step, i);
+  }
+  IrInterpreter interpreter(&fallback_values_, &events_);
+  XLS_RETURN_IF_ERROR(node->VisitSingleNode(&interpreter));
+  return std::move(fallback_values_.at(node));
+}
+
+namespace {
+
+// A BlockContinuation backed by a CompiledBlockInterpreter. The name-keyed
+// maps of the BlockContinuation interface are translated to and from the
+// interpreter's positional state through the precomputed port and register
+// indices.
+class CompiledBlockContinuation final : public BlockContinuation {
+ public:
+  explicit CompiledBlockContinuation(
+      BlockElaboration&& elaboration,
+      std::unique_ptr<CompiledBlockInterpreter> interpreter)
+      : elaboration_(std::move(elaboration)),
+        interpreter_(std::move(interpreter)),
+        inputs_(interpreter_->block()->GetInputPorts().size()),
+        input_set_(inputs_.size()) {}
+
+  const absl::flat_hash_map<std::string, Value>& output_ports() final {
+    if (outputs_stale_) {
+      Block* block = interpreter_->block();
+      for (int64_t i = 0; i < block->GetOutputPorts().size(); ++i) {
+        outputs_[block->GetOutputPorts()[i]->GetName()] =
+            interpreter_->output_values()[i];
+      }
+      outputs_stale_ = false;
+    }
+    return outputs_;
+  }
+
+  const absl::flat_hash_map<std::string, Value>& registers() final {
+    if (registers_stale_) {
+      Block* block = interpreter_->block();
+      for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+        registers_[block->GetRegisters()[i]->name()] =
+            interpreter_->register_values()[i];
+      }
+      registers_stale_ = false;
+    }
+    return registers_;
+  }
+
+  const InterpreterEvents& events() final { return interpreter_->events(); }
+
+  absl::Status RunOneCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs) final {
+    absl::c_fill(input_set_, false);
+    for (const auto& [name, value] : inputs) {
+      absl::StatusOr<int64_t> index = interpreter_->GetInputPortIndex(name);
+      if (!index.ok()) {
+        // Empty tuples don't have data
+        if (value.GetFlatBitCount() == 0) {
+          continue;
+        }
+        return index.status();
+      }
+      inputs_[*index] = value;
+      input_set_[*index] = true;
+    }
+    for (int64_t i = 0; i < inputs_.size(); ++i) {
+      if (!input_set_[i]) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Missing input for port '%s'",
+            interpreter_->block()->GetInputPorts()[i]->GetName()));
+      }
+    }
+    XLS_RETURN_IF_ERROR(interpreter_->RunOneCycle(inputs_));
+    outputs_stale_ = true;
+    registers_stale_ = true;
+    return absl::OkStatus();
+  }
+
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs) final {
+    std::vector<Value> values(interpreter_->register_values().begin(),
+                              interpreter_->register_values().end());
+    XLS_RET_CHECK_EQ(regs.size(), values.size());
+    for (const auto& [name, value] : regs) {
+      XLS_ASSIGN_OR_RETURN(int64_t index,
+                           interpreter_->GetRegisterIndex(name));
+      XLS_RET_CHECK(values[index].SameTypeAs(value))
+          << "'" << name << "' is incorrect type. Expected shape to match "
+          << values[index] << " but value " << value << " does not match.";
+      values[index] = value;
+    }
+    XLS_RETURN_IF_ERROR(interpreter_->SetRegisterValues(values));
+    registers_stale_ = true;
+    return absl::OkStatus();
+  }
+
+  absl::Status SetObserver(EvaluationObserver* obs) override {
+    interpreter_->SetObserver(obs);
+    return absl::OkStatus();
+  }
+  void ClearObserver() override { interpreter_->ClearObserver(); }
+
+ private:
+  BlockElaboration elaboration_;
+  std::unique_ptr<CompiledBlockInterpreter> interpreter_;
+  std::vector<Value> inputs_;
+  std::vector<bool> input_set_;
+  absl::flat_hash_map<std::string, Value> outputs_;
+  absl::flat_hash_map<std::string, Value> registers_;
+  bool outputs_stale_ = true;
+  bool registers_stale_ = true;
+};
+
+}  // namespace
+
 absl::StatusOr<std::unique_ptr<BlockContinuation>>
 InterpreterBlockEvaluator::MakeNewContinuation(
     BlockElaboration&& elaboration,
@@ -960,6 +1318,21 @@ InterpreterBlockEvaluator::MakeNewContinuation(
     }
   }
 
+  if (compiled_ && elaboration.instances().size() == 1) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<CompiledBlockInterpreter> interpreter,
+        CompiledBlockInterpreter::Create(*elaboration.top()->block()));
+    std::vector<Value> registers(interpreter->register_values().begin(),
+                                 interpreter->register_values().end());
+    for (const auto& [name, value] : initial_registers) {
+      XLS_ASSIGN_OR_RETURN(int64_t index, interpreter->GetRegisterIndex(name));
+      registers[index] = value;
+    }
+    XLS_RETURN_IF_ERROR(interpreter->SetRegisterValues(registers));
+    return std::make_unique<CompiledBlockContinuation>(std::move(elaboration),
+                                                       std::move(interpreter));
+  }
+
   auto* cont = new StatelessBlockContinuation(
       std::move(elaboration), BlockRunResult{.reg_state = std::move(ext_regs)},
       BlockRun);
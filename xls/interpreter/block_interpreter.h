@@ -19,28 +19,119 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/interpreter/block_evaluator.h"
+#include "xls/interpreter/observer.h"
 #include "xls/ir/block.h"
 #include "xls/ir/block_elaboration.h"
+#include "xls/ir/events.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/register.h"
 #include "xls/ir/value.h"
 
 namespace xls {
 
+// An interpreter for a single block without instantiations in which the
+// nodes, ports and registers of the block are resolved to dense slots once at
+// construction. Per-cycle state is held in flat arrays and inputs, outputs and
+// registers are passed positionally in the order of Block::GetInputPorts(),
+// Block::GetOutputPorts() and Block::GetRegisters() respectively. This avoids
+// the name-keyed maps of the elaborated interpreter when running many cycles.
+class CompiledBlockInterpreter {
+ public:
+  // Creates an interpreter for `block` with all registers initialized to zero.
+  // Returns an error if the block contains instantiations.
+  static absl::StatusOr<std::unique_ptr<CompiledBlockInterpreter>> Create(
+      Block* block);
+
+  Block* block() const { return block_; }
+
+  // Returns the index of the named input port, output port or register.
+  absl::StatusOr<int64_t> GetInputPortIndex(std::string_view name) const;
+  absl::StatusOr<int64_t> GetOutputPortIndex(std::string_view name) const;
+  absl::StatusOr<int64_t> GetRegisterIndex(std::string_view name) const;
+
+  // Runs a single cycle of the block. `inputs` holds one value per input port
+  // of the block. After the cycle the registers hold their next-state values.
+  absl::Status RunOneCycle(absl::Span<const Value> inputs);
+
+  // The values of the output ports computed by the last cycle.
+  absl::Span<const Value> output_values() const { return output_values_; }
+
+  // The current values of the registers.
+  absl::Span<const Value> register_values() const { return register_values_; }
+  absl::Status SetRegisterValues(absl::Span<const Value> values);
+
+  // The events generated during the last cycle.
+  const InterpreterEvents& events() const { return events_; }
+
+  void SetObserver(EvaluationObserver* observer) { observer_ = observer; }
+  void ClearObserver() { observer_ = nullptr; }
+
+ private:
+  // A node of the block in topological order along with the slots of its
+  // operands. `index` is the position of the port or register the node refers
+  // to, if any.
+  struct Step {
+    Node* node;
+    int64_t index = -1;
+    std::vector<int64_t> operand_slots;
+  };
+
+  explicit CompiledBlockInterpreter(Block* block) : block_(block) {}
+
+  absl::StatusOr<Value> EvaluateStep(const Step& step,
+                                     absl::Span<const Value> inputs);
+  const Value& OperandValue(const Step& step, int64_t operand_no) const {
+    return node_values_[step.operand_slots[operand_no]];
+  }
+
+  Block* block_;
+  std::vector<Step> steps_;
+  absl::flat_hash_map<std::string, int64_t> input_port_indices_;
+  absl::flat_hash_map<std::string, int64_t> output_port_indices_;
+  absl::flat_hash_map<std::string, int64_t> register_indices_;
+
+  // Per-cycle state, indexed by step, output port and register respectively.
+  std::vector<Value> node_values_;
+  std::vector<Value> output_values_;
+  std::vector<Value> register_values_;
+  std::vector<Value> next_register_values_;
+  InterpreterEvents events_;
+
+  // Operand values of nodes without a dedicated implementation are handed to
+  // an IrInterpreter through this map.
+  absl::flat_hash_map<Node*, Value> fallback_values_;
+
+  EvaluationObserver* observer_ = nullptr;
+};
+
 class InterpreterBlockEvaluator final : public BlockEvaluator {
  public:
   constexpr InterpreterBlockEvaluator() : BlockEvaluator("Interpreter") {}
 
+  // If `compiled` is true then continuations of blocks without instantiations
+  // are backed by a CompiledBlockInterpreter.
+  constexpr explicit InterpreterBlockEvaluator(bool compiled)
+      : BlockEvaluator(compiled ? "CompiledInterpreter" : "Interpreter"),
+        compiled_(compiled) {}
+
  protected:
   absl::StatusOr<std::unique_ptr<BlockContinuation>> MakeNewContinuation(
       BlockElaboration&& elaboration,
       const absl::flat_hash_map<std::string, Value>& initial_registers)
       const override;
+
+ private:
+  bool compiled_ = false;
 };
 
 // Runs the interpreter on a combinational block. `inputs` must contain a
@@ -116,6 +207,10 @@ InterpretChannelizedSequentialBlockWithUint64(
 // A single evaluator which uses the interpreter.
 inline constexpr InterpreterBlockEvaluator kInterpreterBlockEvaluator;
 
+// An evaluator which uses the CompiledBlockInterpreter where possible.
+inline constexpr InterpreterBlockEvaluator kCompiledInterpreterBlockEvaluator(
+    /*compiled=*/true);
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_BLOCK_INTERPRETER_H_
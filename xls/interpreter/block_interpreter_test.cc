@@ -14,14 +14,33 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
 #include "xls/interpreter/block_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
 
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
 inline constexpr BlockEvaluatorTestParam kBlockInterpreterTestParam = {
     .evaluator = &kInterpreterBlockEvaluator,
     .supports_fifos = true,
@@ -38,5 +57,95 @@ INSTANTIATE_TEST_SUITE_P(
     testing::ValuesIn(GenerateFifoTestParams(kBlockInterpreterTestParam)),
     FifoTestName);
 
+inline constexpr BlockEvaluatorTestParam kCompiledBlockInterpreterTestParam = {
+    .evaluator = &kCompiledInterpreterBlockEvaluator,
+    .supports_fifos = true,
+    .supports_observer = true};
+
+INSTANTIATE_TEST_SUITE_P(CompiledBlockInterpreterTest, BlockEvaluatorTest,
+                         testing::Values(kCompiledBlockInterpreterTestParam),
+                         [](const auto& v) -> std::string {
+                           return std::string(v.param.evaluator->name());
+                         });
+
+INSTANTIATE_TEST_SUITE_P(
+    CompiledBlockInterpreterFifoTest, FifoTest,
+    testing::ValuesIn(
+        GenerateFifoTestParams(kCompiledBlockInterpreterTestParam)),
+    FifoTestName);
+
+class CompiledBlockInterpreterTest : public IrTestBase {};
+
+TEST_F(CompiledBlockInterpreterTest, PositionalAccumulator) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.AddClockPort("clk"));
+  BValue rst = bb.InputPort("rst", p->GetBitsType(1));
+  BValue x = bb.InputPort("x", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * acc_reg,
+      bb.block()->AddRegister(
+          "acc", p->GetBitsType(32),
+          Reset{.reset_value = Value(UBits(0, 32)), .asynchronous = false,
+                .active_low = false}));
+  BValue acc = bb.RegisterRead(acc_reg);
+  BValue sum = bb.Add(acc, x);
+  bb.RegisterWrite(acc_reg, sum, /*load_enable=*/std::nullopt,
+                   /*reset=*/rst);
+  bb.OutputPort("out", bb.Concat({sum, bb.Eq(sum, x)}));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledBlockInterpreter> interp,
+                           CompiledBlockInterpreter::Create(block));
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t rst_index, interp->GetInputPortIndex("rst"));
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t x_index, interp->GetInputPortIndex("x"));
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t out_index,
+                           interp->GetOutputPortIndex("out"));
+  EXPECT_THAT(interp->GetInputPortIndex("y"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Block has no input port 'y'")));
+
+  std::vector<Value> inputs(2);
+  inputs[rst_index] = Value(UBits(0, 1));
+  inputs[x_index] = Value(UBits(3, 32));
+  XLS_ASSERT_OK(interp->RunOneCycle(inputs));
+  EXPECT_EQ(interp->output_values()[out_index], Value(UBits(3 << 1 | 1, 33)));
+  EXPECT_THAT(interp->register_values(), ElementsAre(Value(UBits(3, 32))));
+
+  inputs[x_index] = Value(UBits(4, 32));
+  XLS_ASSERT_OK(interp->RunOneCycle(inputs));
+  EXPECT_EQ(interp->output_values()[out_index], Value(UBits(7 << 1, 33)));
+  EXPECT_THAT(interp->register_values(), ElementsAre(Value(UBits(7, 32))));
+
+  inputs[rst_index] = Value(UBits(1, 1));
+  XLS_ASSERT_OK(interp->RunOneCycle(inputs));
+  EXPECT_THAT(interp->register_values(), ElementsAre(Value(UBits(0, 32))));
+
+  XLS_ASSERT_OK(interp->SetRegisterValues({Value(UBits(10, 32))}));
+  inputs[rst_index] = Value(UBits(0, 1));
+  inputs[x_index] = Value(UBits(1, 32));
+  XLS_ASSERT_OK(interp->RunOneCycle(inputs));
+  EXPECT_EQ(interp->output_values()[out_index], Value(UBits(11 << 1, 33)));
+}
+
+TEST_F(CompiledBlockInterpreterTest, InstantiationsAreUnsupported) {
+  auto p = CreatePackage();
+  BlockBuilder sub_bb("sub", p.get());
+  sub_bb.OutputPort("out", sub_bb.InputPort("in", p->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub, sub_bb.Build());
+
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockInstantiation * inst,
+      bb.block()->AddBlockInstantiation("sub_inst", sub));
+  bb.InstantiationInput(inst, "in", bb.InputPort("x", p->GetBitsType(8)));
+  bb.OutputPort("y", bb.InstantiationOutput(inst, "out"));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(CompiledBlockInterpreter::Create(block),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("has instantiations")));
+}
+
 }  // namespace
 }  // namespace xls
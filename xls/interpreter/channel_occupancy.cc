@@ -0,0 +1,206 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/channel_occupancy.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/casts.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+std::string ChannelOccupancy::ToString() const {
+  return absl::StrFormat(
+      "writes=%d reads=%d occupancy=%d max_occupancy=%d backlogged_ticks=%d "
+      "full_events=%d",
+      writes, reads, occupancy, max_occupancy, backlogged_ticks, full_events);
+}
+
+// Forwards queue activity to the owning tracker. Owned by the queue.
+class ChannelOccupancyTracker::Callback : public ChannelQueueCallback {
+ public:
+  explicit Callback(ChannelOccupancyTracker* tracker) : tracker_(tracker) {}
+  ~Callback() override = default;
+
+  void ReadValue(ChannelInstance* channel_instance,
+                 const Value& value) override {
+    tracker_->RecordRead(channel_instance);
+  }
+  void WriteValue(ChannelInstance* channel_instance,
+                  const Value& value) override {
+    tracker_->RecordWrite(channel_instance);
+  }
+
+ private:
+  ChannelOccupancyTracker* tracker_;
+};
+
+std::unique_ptr<ChannelOccupancyTracker> ChannelOccupancyTracker::Create(
+    ChannelQueueManager& queue_manager, bool include_io_channels) {
+  auto tracker = absl::WrapUnique(new ChannelOccupancyTracker());
+  for (ChannelQueue* queue : queue_manager.queues()) {
+    Channel* channel = queue->channel();
+    if (channel->kind() != ChannelKind::kStreaming ||
+        (!include_io_channels &&
+         channel->supported_ops() != ChannelOps::kSendReceive)) {
+      continue;
+    }
+    std::optional<int64_t> fifo_depth =
+        down_cast<StreamingChannel*>(channel)->GetFifoDepth();
+    if (fifo_depth.has_value()) {
+      tracker->fifo_depths_[queue->channel_instance()] = *fifo_depth;
+    }
+    // Initial values are already held in the queue.
+    int64_t initial_size = queue->GetSize();
+    {
+      absl::MutexLock lock(&tracker->mutex_);
+      tracker->occupancies_[queue->channel_instance()] =
+          ChannelOccupancy{.occupancy = initial_size,
+                           .max_occupancy = initial_size};
+    }
+    tracker->queues_.push_back(queue);
+    queue->AddCallback(std::make_unique<Callback>(tracker.get()));
+  }
+  return tracker;
+}
+
+void ChannelOccupancyTracker::RecordWrite(ChannelInstance* channel_instance) {
+  absl::MutexLock lock(&mutex_);
+  ChannelOccupancy& occupancy = occupancies_.at(channel_instance);
+  ++occupancy.writes;
+  ++occupancy.occupancy;
+  occupancy.max_occupancy =
+      std::max(occupancy.max_occupancy, occupancy.occupancy);
+  auto it = fifo_depths_.find(channel_instance);
+  if (it != fifo_depths_.end() && occupancy.occupancy > it->second) {
+    ++occupancy.full_events;
+  }
+}
+
+void ChannelOccupancyTracker::RecordRead(ChannelInstance* channel_instance) {
+  absl::MutexLock lock(&mutex_);
+  ChannelOccupancy& occupancy = occupancies_.at(channel_instance);
+  ++occupancy.reads;
+  --occupancy.occupancy;
+}
+
+void ChannelOccupancyTracker::RecordTick() {
+  // The queue callbacks acquire `mutex_` while holding the queue lock so the
+  // queues must be sampled before acquiring `mutex_`.
+  std::vector<int64_t> sizes;
+  sizes.reserve(queues_.size());
+  for (ChannelQueue* queue : queues_) {
+    sizes.push_back(queue->GetSize());
+  }
+  absl::MutexLock lock(&mutex_);
+  ++ticks_;
+  for (int64_t i = 0; i < queues_.size(); ++i) {
+    ChannelOccupancy& occupancy =
+        occupancies_.at(queues_[i]->channel_instance());
+    occupancy.occupancy_tick_sum += sizes[i];
+    if (sizes[i] > 0) {
+      ++occupancy.backlogged_ticks;
+    }
+  }
+}
+
+int64_t ChannelOccupancyTracker::ticks() const {
+  absl::MutexLock lock(&mutex_);
+  return ticks_;
+}
+
+std::vector<std::pair<ChannelInstance*, ChannelOccupancy>>
+ChannelOccupancyTracker::GetOccupancies() const {
+  absl::MutexLock lock(&mutex_);
+  std::vector<std::pair<ChannelInstance*, ChannelOccupancy>> result;
+  result.reserve(queues_.size());
+  for (ChannelQueue* queue : queues_) {
+    result.push_back({queue->channel_instance(),
+                      occupancies_.at(queue->channel_instance())});
+  }
+  return result;
+}
+
+absl::flat_hash_map<Channel*, int64_t>
+ChannelOccupancyTracker::GetMaxOccupancyByChannel() const {
+  absl::flat_hash_map<Channel*, int64_t> result;
+  for (const auto& [instance, occupancy] : GetOccupancies()) {
+    int64_t& max_occupancy = result[instance->channel];
+    max_occupancy = std::max(max_occupancy, occupancy.max_occupancy);
+  }
+  return result;
+}
+
+std::string ChannelOccupancyTracker::ToString() const {
+  std::string result = absl::StrFormat("Channel occupancy after %d ticks:\n",
+                                       ticks());
+  for (const auto& [instance, occupancy] : GetOccupancies()) {
+    absl::StrAppendFormat(&result, "  %s: %s\n", instance->ToString(),
+                          occupancy.ToString());
+  }
+  return result;
+}
+
+absl::StatusOr<int64_t> ApplyFifoDepths(
+    const absl::flat_hash_map<Channel*, int64_t>& max_occupancies,
+    int64_t min_depth) {
+  int64_t changed = 0;
+  for (const auto& [channel, max_occupancy] : max_occupancies) {
+    if (channel->kind() != ChannelKind::kStreaming) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Cannot set the FIFO depth of non-streaming channel `%s`",
+          channel->name()));
+    }
+    StreamingChannel* streaming_channel = down_cast<StreamingChannel*>(channel);
+    int64_t depth = std::max(max_occupancy, min_depth);
+    const ChannelConfig& config = streaming_channel->channel_config();
+    FifoConfig fifo_config =
+        config.fifo_config().has_value()
+            ? FifoConfig(depth, config.fifo_config()->bypass(),
+                         config.fifo_config()->register_push_outputs(),
+                         config.fifo_config()->register_pop_outputs())
+            : FifoConfig(depth, /*bypass=*/false,
+                         /*register_push_outputs=*/false,
+                         /*register_pop_outputs=*/false);
+    if (config.fifo_config() == fifo_config) {
+      continue;
+    }
+    VLOG(1) << absl::StreamFormat("Setting FIFO depth of channel `%s` to %d",
+                                  channel->name(), depth);
+    streaming_channel->channel_config(config.WithFifoConfig(fifo_config));
+    ++changed;
+  }
+  return changed;
+}
+
+}  // namespace xls
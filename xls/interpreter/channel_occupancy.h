@@ -0,0 +1,127 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_CHANNEL_OCCUPANCY_H_
+#define XLS_INTERPRETER_CHANNEL_OCCUPANCY_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+// Occupancy statistics of a single channel instance gathered while running a
+// proc network.
+struct ChannelOccupancy {
+  // Total number of values written to and read from the channel.
+  int64_t writes = 0;
+  int64_t reads = 0;
+
+  // Number of values currently held in the channel.
+  int64_t occupancy = 0;
+
+  // Largest number of values held in the channel at any point.
+  int64_t max_occupancy = 0;
+
+  // Number of ticks at the end of which the channel held at least one value,
+  // i.e., ticks in which data was produced but the consumer had not yet
+  // accepted it. A large count relative to the number of ticks indicates
+  // back-pressure on the consumer side.
+  int64_t backlogged_ticks = 0;
+
+  // Sum of the occupancy at the end of each tick. Divided by the number of
+  // ticks this gives the average occupancy.
+  int64_t occupancy_tick_sum = 0;
+
+  // Number of writes which left the channel holding more values than the
+  // depth of its FIFO. In hardware these writes would have stalled the
+  // sender. Always zero for channels without a configured FIFO depth.
+  int64_t full_events = 0;
+
+  std::string ToString() const;
+};
+
+// Records the occupancy of the streaming channels of a proc network by
+// attaching callbacks to the channel queues. By default input and output
+// channels of the network are not tracked as their occupancy is determined by
+// the testbench rather than the design.
+//
+// The tracker must outlive the queue manager it is attached to. Thread-safe so
+// it may be used with the parallel runtime.
+class ChannelOccupancyTracker {
+ public:
+  // Attaches a tracker to every internal streaming channel queue in
+  // `queue_manager`, and also to the input and output streaming channel queues
+  // if `include_io_channels` is true.
+  static std::unique_ptr<ChannelOccupancyTracker> Create(
+      ChannelQueueManager& queue_manager, bool include_io_channels = false);
+
+  // Samples the current state of the queues. Should be called once after each
+  // tick of the runtime.
+  void RecordTick();
+
+  // Returns the number of times `RecordTick` has been called.
+  int64_t ticks() const;
+
+  // Returns the occupancy statistics of the tracked channel instances in
+  // channel ID order.
+  std::vector<std::pair<ChannelInstance*, ChannelOccupancy>> GetOccupancies()
+      const;
+
+  // Returns the maximum occupancy of each tracked channel taken across all of
+  // its instances.
+  absl::flat_hash_map<Channel*, int64_t> GetMaxOccupancyByChannel() const;
+
+  // Returns a human-readable table of the statistics of all tracked channels.
+  std::string ToString() const;
+
+ private:
+  class Callback;
+
+  ChannelOccupancyTracker() = default;
+
+  void RecordWrite(ChannelInstance* channel_instance);
+  void RecordRead(ChannelInstance* channel_instance);
+
+  std::vector<ChannelQueue*> queues_;
+  // FIFO depth of the channel of each tracked instance, if configured.
+  absl::flat_hash_map<ChannelInstance*, int64_t> fifo_depths_;
+
+  mutable absl::Mutex mutex_;
+  int64_t ticks_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<ChannelInstance*, ChannelOccupancy> occupancies_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// Sets the FIFO depth of every streaming channel in `max_occupancies` to its
+// observed maximum occupancy (but at least `min_depth`). Existing FIFO settings
+// other than the depth are preserved; channels without a FIFO configuration get
+// a non-bypass FIFO. Returns the number of channels whose depth changed.
+absl::StatusOr<int64_t> ApplyFifoDepths(
+    const absl::flat_hash_map<Channel*, int64_t>& max_occupancies,
+    int64_t min_depth = 1);
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_CHANNEL_OCCUPANCY_H_
@@ -0,0 +1,169 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/channel_occupancy.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/casts.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+using ::testing::Optional;
+using ::testing::Pair;
+
+class ChannelOccupancyTest : public IrTestBase {};
+
+TEST_F(ChannelOccupancyTest, TracksInternalChannelsOnly) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * input,
+      p->CreateStreamingChannel("input", ChannelOps::kReceiveOnly,
+                                p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * internal,
+      p->CreateStreamingChannel("internal", ChannelOps::kSendReceive,
+                                p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelQueueManager> manager,
+                           ChannelQueueManager::Create(p.get()));
+  std::unique_ptr<ChannelOccupancyTracker> tracker =
+      ChannelOccupancyTracker::Create(*manager);
+
+  ChannelQueue& input_queue = manager->GetQueue(input);
+  ChannelQueue& internal_queue = manager->GetQueue(internal);
+  XLS_ASSERT_OK(input_queue.WriteValues(
+      {Value(UBits(1, 32)), Value(UBits(2, 32)), Value(UBits(3, 32))}));
+  XLS_ASSERT_OK(internal_queue.Write(Value(UBits(1, 32))));
+  XLS_ASSERT_OK(internal_queue.Write(Value(UBits(2, 32))));
+  tracker->RecordTick();
+  EXPECT_TRUE(internal_queue.Read().has_value());
+  XLS_ASSERT_OK(internal_queue.Write(Value(UBits(3, 32))));
+  EXPECT_TRUE(internal_queue.Read().has_value());
+  EXPECT_TRUE(internal_queue.Read().has_value());
+  tracker->RecordTick();
+
+  EXPECT_EQ(tracker->ticks(), 2);
+  auto occupancies = tracker->GetOccupancies();
+  ASSERT_EQ(occupancies.size(), 1);
+  EXPECT_EQ(occupancies[0].first->channel, internal);
+  const ChannelOccupancy& occupancy = occupancies[0].second;
+  EXPECT_EQ(occupancy.writes, 3);
+  EXPECT_EQ(occupancy.reads, 3);
+  EXPECT_EQ(occupancy.occupancy, 0);
+  EXPECT_EQ(occupancy.max_occupancy, 2);
+  EXPECT_EQ(occupancy.backlogged_ticks, 1);
+  EXPECT_THAT(tracker->GetMaxOccupancyByChannel(),
+              ElementsAre(Pair(internal, 2)));
+}
+
+TEST_F(ChannelOccupancyTest, ProcNetwork) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * internal,
+      p->CreateStreamingChannel("internal", ChannelOps::kSendReceive,
+                                p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * output,
+      p->CreateStreamingChannel("output", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  {
+    ProcBuilder pb("producer", p.get());
+    BValue st = pb.StateElement("st", Value(UBits(0, 32)));
+    pb.Send(internal, pb.Literal(Value::Token()), st);
+    XLS_ASSERT_OK(pb.Build({pb.Add(st, pb.Literal(UBits(1, 32)))}).status());
+  }
+  {
+    ProcBuilder pb("consumer", p.get());
+    BValue receive = pb.Receive(internal, pb.Literal(Value::Token()));
+    pb.Send(output, pb.TupleIndex(receive, 0), pb.TupleIndex(receive, 1));
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> runtime,
+                           CreateInterpreterSerialProcRuntime(p.get()));
+  std::unique_ptr<ChannelOccupancyTracker> tracker =
+      ChannelOccupancyTracker::Create(runtime->queue_manager());
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+    tracker->RecordTick();
+  }
+
+  EXPECT_THAT(tracker->GetMaxOccupancyByChannel(),
+              ElementsAre(Pair(internal, 1)));
+  EXPECT_THAT(ApplyFifoDepths(tracker->GetMaxOccupancyByChannel()),
+              IsOkAndHolds(1));
+  EXPECT_THAT(down_cast<StreamingChannel*>(internal)->GetFifoDepth(),
+              Optional(1));
+}
+
+TEST_F(ChannelOccupancyTest, ApplyFifoDepthsPreservesFifoSettings) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * sized,
+      p->CreateStreamingChannel(
+          "sized", ChannelOps::kSendReceive, p->GetBitsType(32),
+          /*initial_values=*/{},
+          ChannelConfig(FifoConfig(/*depth=*/8, /*bypass=*/true,
+                                   /*register_push_outputs=*/true,
+                                   /*register_pop_outputs=*/false))));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * unsized,
+      p->CreateStreamingChannel("unsized", ChannelOps::kSendReceive,
+                                p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * unchanged,
+      p->CreateStreamingChannel(
+          "unchanged", ChannelOps::kSendReceive, p->GetBitsType(32),
+          /*initial_values=*/{},
+          ChannelConfig(FifoConfig(/*depth=*/2, /*bypass=*/false,
+                                   /*register_push_outputs=*/false,
+                                   /*register_pop_outputs=*/false))));
+
+  absl::flat_hash_map<Channel*, int64_t> occupancies = {
+      {sized, 3}, {unsized, 0}, {unchanged, 2}};
+  EXPECT_THAT(ApplyFifoDepths(occupancies), IsOkAndHolds(2));
+
+  EXPECT_EQ(sized->channel_config().fifo_config(),
+            FifoConfig(/*depth=*/3, /*bypass=*/true,
+                       /*register_push_outputs=*/true,
+                       /*register_pop_outputs=*/false));
+  EXPECT_EQ(unsized->channel_config().fifo_config(),
+            FifoConfig(/*depth=*/1, /*bypass=*/false,
+                       /*register_push_outputs=*/false,
+                       /*register_pop_outputs=*/false));
+  EXPECT_THAT(unchanged->GetFifoDepth(), Optional(2));
+}
+
+}  // namespace
+}  // namespace xls
@@ -22,7 +22,6 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
@@ -30,6 +29,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
@@ -108,6 +108,51 @@ std::optional<Value> ChannelQueue::Read() {
   return value;
 }
 
+absl::Status ChannelQueue::WriteValues(absl::Span<const Value> values) {
+  VLOG(4) << absl::StreamFormat("Writing %d values to channel instance `%s`",
+                                values.size(), channel_instance()->ToString());
+  for (const Value& value : values) {
+    if (!ValueConformsToType(value, channel()->type())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Channel `%s` expects values to have type %s, got: %s",
+          channel()->name(), channel()->type()->ToString(), value.ToString()));
+    }
+  }
+  absl::MutexLock lock(&mutex_);
+  if (generator_.has_value()) {
+    return absl::InternalError(
+        "Cannot write to ChannelQueue because it has a generator function.");
+  }
+  for (const Value& value : values) {
+    WriteInternal(value);
+  }
+  return absl::OkStatus();
+}
+
+std::vector<Value> ChannelQueue::ReadValues(int64_t max_count) {
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    max_count = std::min(max_count, int64_t{1});
+  }
+  std::vector<Value> values;
+  absl::MutexLock lock(&mutex_);
+  while (static_cast<int64_t>(values.size()) < max_count) {
+    if (generator_.has_value()) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+    }
+    std::optional<Value> value = ReadInternal();
+    if (!value.has_value()) {
+      break;
+    }
+    values.push_back(*std::move(value));
+  }
+  VLOG(4) << absl::StreamFormat("Read %d values from channel instance %s",
+                                values.size(), channel_instance()->ToString());
+  return values;
+}
+
 int64_t ChannelQueue::GetSizeInternal() const { return queue_.size(); }
 
 std::optional<Value> ChannelQueue::ReadInternal() {
@@ -133,27 +178,27 @@ ChannelQueueManager::Create(Package* package) {
 ChannelQueueManager::Create(std::vector<std::unique_ptr<ChannelQueue>>&& queues,
                             ProcElaboration elaboration) {
   // Verify there is exactly one queue per channel.
-  absl::flat_hash_set<ChannelInstance*> channel_instances(
-      elaboration.channel_instances().begin(),
-      elaboration.channel_instances().end());
-  absl::flat_hash_set<ChannelInstance*> queue_chan_instances;
+  absl::Span<ChannelInstance* const> channel_instances =
+      elaboration.channel_instances();
+  std::vector<bool> has_queue(channel_instances.size(), false);
   for (const std::unique_ptr<ChannelQueue>& queue : queues) {
-    if (!channel_instances.contains(queue->channel_instance())) {
+    ChannelInstance* instance = queue->channel_instance();
+    if (instance->id < 0 ||
+        instance->id >= static_cast<int64_t>(channel_instances.size()) ||
+        channel_instances[instance->id] != instance) {
       return absl::InvalidArgumentError(absl::StrFormat(
           "Channel instance `%s` for queue does not exist in package `%s`",
-          queue->channel_instance()->ToString(),
-          elaboration.package()->name()));
+          instance->ToString(), elaboration.package()->name()));
     }
-    auto [ir, inserted] =
-        queue_chan_instances.insert(queue->channel_instance());
-    if (!inserted) {
+    if (has_queue[instance->id]) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Multiple queues specified for channel instance `%s`",
-                          queue->channel_instance()->ToString()));
+                          instance->ToString()));
     }
+    has_queue[instance->id] = true;
   }
-  for (ChannelInstance* instance : elaboration.channel_instances()) {
-    if (!queue_chan_instances.contains(instance)) {
+  for (ChannelInstance* instance : channel_instances) {
+    if (!has_queue[instance->id]) {
       return absl::InvalidArgumentError(
           absl::StrFormat("No queue specified for channel instance `%s`",
                           instance->ToString()));
@@ -186,10 +231,11 @@ ChannelQueueManager::ChannelQueueManager(
     ProcElaboration elaboration,
     std::vector<std::unique_ptr<ChannelQueue>>&& queues)
     : elaboration_(std::move(elaboration)) {
+  queues_.resize(elaboration_.channel_instances().size());
   for (std::unique_ptr<ChannelQueue>& queue : queues) {
-    ChannelInstance* instance = queue->channel_instance();
-    queues_[instance] = std::move(queue);
-    queue_vec_.push_back(queues_[instance].get());
+    int64_t id = queue->channel_instance()->id;
+    queues_[id] = std::move(queue);
+    queue_vec_.push_back(queues_[id].get());
   }
   // Stably sort the queues by channel ID.
   std::sort(queue_vec_.begin(), queue_vec_.end(),
@@ -203,7 +249,7 @@ absl::StatusOr<ChannelQueue*> ChannelQueueManager::GetQueueById(
   XLS_ASSIGN_OR_RETURN(Channel * channel, package()->GetChannel(channel_id));
   XLS_ASSIGN_OR_RETURN(ChannelInstance * instance,
                        elaboration().GetUniqueInstance(channel));
-  return queues_.at(instance).get();
+  return queues_.at(instance->id).get();
 }
 
 absl::StatusOr<ChannelQueue*> ChannelQueueManager::GetQueueByName(
@@ -211,7 +257,7 @@ absl::StatusOr<ChannelQueue*> ChannelQueueManager::GetQueueByName(
   XLS_ASSIGN_OR_RETURN(Channel * channel, package()->GetChannel(name));
   XLS_ASSIGN_OR_RETURN(ChannelInstance * instance,
                        elaboration().GetUniqueInstance(channel));
-  return queues_.at(instance).get();
+  return queues_.at(instance->id).get();
 }
 
 }  // namespace xls
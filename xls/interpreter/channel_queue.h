@@ -25,7 +25,6 @@
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
@@ -91,6 +90,14 @@ class ChannelQueue {
   // the channel is empty.
   std::optional<Value> Read();
 
+  // Batch versions of Write and Read which acquire the queue lock once for the
+  // entire batch. WriteValues writes `values` in order and writes nothing if
+  // any value does not conform to the channel type. ReadValues reads up to
+  // `max_count` values, stopping early if the channel becomes empty. Reads of
+  // single-value channels are non-destructive so at most one value is read.
+  absl::Status WriteValues(absl::Span<const Value> values);
+  std::vector<Value> ReadValues(int64_t max_count);
+
   // Attaches a function which generates values for the channel. The generator
   // is called when a value is needed for reading. If a generator is attached
   // then calling `Write` returns an error.
@@ -175,10 +182,10 @@ class ChannelQueueManager {
 
   // Get the channel queue associated with the channel with the given id/name.
   ChannelQueue& GetQueue(ChannelInstance* channel_instance) {
-    return *queues_.at(channel_instance);
+    return *queues_.at(channel_instance->id);
   }
   ChannelQueue& GetQueue(Channel* channel) {
-    return *queues_.at(elaboration().GetUniqueInstance(channel).value());
+    return *queues_.at(elaboration().GetUniqueInstance(channel).value()->id);
   }
 
   // Returns the vector of all queues sorted by channel ID.
@@ -201,8 +208,8 @@ class ChannelQueueManager {
   // by the runtime.
   ProcElaboration elaboration_;
 
-  // Channel queues indexed by the associated channel instance pointer.
-  absl::flat_hash_map<ChannelInstance*, std::unique_ptr<ChannelQueue>> queues_;
+  // Channel queues indexed by the id of the associated channel instance.
+  std::vector<std::unique_ptr<ChannelQueue>> queues_;
 
   // Vector containing pointers to the channel queues held in queues_.
   std::vector<ChannelQueue*> queue_vec_;
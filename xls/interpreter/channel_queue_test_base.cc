@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <optional>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -35,7 +36,9 @@ namespace xls {
 namespace {
 
 using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Optional;
 
 TEST_P(ChannelQueueTestBase, FifoChannelQueueTest) {
@@ -127,6 +130,62 @@ TEST_P(ChannelQueueTestBase, ErrorConditions) {
                                  "type bits[1], got: bits[123]:0x2c")));
 }
 
+TEST_P(ChannelQueueTestBase, BatchWriteAndRead) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  auto queue =
+      GetParam().CreateQueue(elaboration.GetUniqueInstance(channel).value());
+
+  std::vector<Value> values;
+  for (int64_t i = 0; i < 100; ++i) {
+    values.push_back(Value(UBits(i, 32)));
+  }
+  XLS_ASSERT_OK(queue->WriteValues(values));
+  EXPECT_EQ(queue->GetSize(), 100);
+  XLS_ASSERT_OK(queue->Write(Value(UBits(100, 32))));
+
+  EXPECT_THAT(queue->ReadValues(0), IsEmpty());
+  EXPECT_THAT(queue->ReadValues(2),
+              ElementsAre(Value(UBits(0, 32)), Value(UBits(1, 32))));
+  EXPECT_THAT(queue->Read(), Optional(Value(UBits(2, 32))));
+  std::vector<Value> rest = queue->ReadValues(1000);
+  ASSERT_EQ(rest.size(), 98);
+  EXPECT_EQ(rest.front(), Value(UBits(3, 32)));
+  EXPECT_EQ(rest.back(), Value(UBits(100, 32)));
+  EXPECT_TRUE(queue->IsEmpty());
+  EXPECT_THAT(queue->ReadValues(10), IsEmpty());
+
+  // Nothing is written if any value of the batch has the wrong type.
+  EXPECT_THAT(queue->WriteValues({Value(UBits(1, 32)), Value(UBits(2, 3))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("expects values to have type bits[32]")));
+  EXPECT_TRUE(queue->IsEmpty());
+}
+
+TEST_P(ChannelQueueTestBase, SingleValueChannelBatchRead) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateSingleValueChannel("my_channel", ChannelOps::kSendReceive,
+                                       package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  auto queue =
+      GetParam().CreateQueue(elaboration.GetUniqueInstance(channel).value());
+
+  EXPECT_THAT(queue->ReadValues(5), IsEmpty());
+  XLS_ASSERT_OK(queue->WriteValues(
+      {Value(UBits(10, 32)), Value(UBits(20, 32)), Value(UBits(30, 32))}));
+  EXPECT_EQ(queue->GetSize(), 1);
+  EXPECT_THAT(queue->ReadValues(5), ElementsAre(Value(UBits(30, 32))));
+  EXPECT_THAT(queue->ReadValues(5), ElementsAre(Value(UBits(30, 32))));
+}
+
 TEST_P(ChannelQueueTestBase, IotaGenerator) {
   Package package(TestName());
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -0,0 +1,310 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/interpreter/observer.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/keyword_args.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Returns the given bits value as a uint64_t value. If the value exceeds
+// upper_limit, then upper_limit is returned.
+uint64_t BitsToBoundedUint64(const Bits& bits, uint64_t upper_limit) {
+  if (Bits::MinBitCountUnsigned(upper_limit) <= bits.bit_count() &&
+      bits_ops::UGreaterThan(bits, UBits(upper_limit, bits.bit_count()))) {
+    return upper_limit;
+  }
+  return bits.ToUint64().value();
+}
+
+Value BoolValue(bool b) { return Value(UBits(b ? 1 : 0, 1)); }
+
+// Returns the product of `lhs` and `rhs` truncated or extended to `width`.
+Bits FitMulToWidth(Bits product, int64_t width, bool is_signed) {
+  if (product.bit_count() > width) {
+    return product.Slice(0, width);
+  }
+  if (product.bit_count() < width) {
+    return is_signed ? bits_ops::SignExtend(product, width)
+                     : bits_ops::ZeroExtend(product, width);
+  }
+  return product;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>>
+CompiledFunctionInterpreter::Create(Function* function) {
+  std::unique_ptr<CompiledFunctionInterpreter> result(
+      new CompiledFunctionInterpreter(function));
+  // Each node's value lives in the register with the node's index in
+  // topological order.
+  std::vector<Node*> order = TopoSort(function);
+  absl::flat_hash_map<Node*, int64_t> registers;
+  registers.reserve(order.size());
+  for (Node* node : order) {
+    registers.emplace(node, registers.size());
+  }
+  result->param_registers_.reserve(function->params().size());
+  for (Param* param : function->params()) {
+    result->param_registers_.push_back(registers.at(param));
+  }
+  result->instructions_.reserve(order.size() - function->params().size());
+  for (Node* node : order) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    result->instructions_.push_back(Instruction{
+        .node = node,
+        .op = node->op(),
+        .result = registers.at(node),
+        .operands_start = static_cast<int64_t>(result->operands_.size()),
+        .operand_count = node->operand_count(),
+    });
+    for (Node* operand : node->operands()) {
+      result->operands_.push_back(registers.at(operand));
+    }
+  }
+  result->return_register_ = registers.at(function->return_value());
+  return result;
+}
+
+absl::StatusOr<Value> CompiledFunctionInterpreter::EvaluateWithIrInterpreter(
+    const Instruction& instruction, absl::Span<const Value> registers,
+    InterpreterEvents& events) const {
+  absl::flat_hash_map<Node*, Value> values;
+  for (int64_t i = 0; i < instruction.operand_count; ++i) {
+    values.try_emplace(instruction.node->operand(i),
+                       registers[operands_[instruction.operands_start + i]]);
+  }
+  IrInterpreter visitor(&values, &events);
+  XLS_RETURN_IF_ERROR(instruction.node->VisitSingleNode(&visitor));
+  return std::move(values.at(instruction.node));
+}
+
+absl::StatusOr<Value> CompiledFunctionInterpreter::Evaluate(
+    const Instruction& instruction, absl::Span<const Value> registers,
+    InterpreterEvents& events) const {
+  Node* node = instruction.node;
+  auto operand = [&](int64_t i) -> const Value& {
+    return registers[operands_[instruction.operands_start + i]];
+  };
+  auto bits = [&](int64_t i) -> const Bits& { return operand(i).bits(); };
+  // Applies a binary bits operation to all the operands of a variadic op.
+  auto fold = [&](Bits (*f)(const Bits&, const Bits&)) {
+    Bits result = bits(0);
+    for (int64_t i = 1; i < instruction.operand_count; ++i) {
+      result = f(result, bits(i));
+    }
+    return result;
+  };
+  switch (instruction.op) {
+    case Op::kLiteral:
+      return node->As<Literal>()->value();
+    case Op::kIdentity:
+      return operand(0);
+    case Op::kAdd:
+      return Value(bits_ops::Add(bits(0), bits(1)));
+    case Op::kSub:
+      return Value(bits_ops::Sub(bits(0), bits(1)));
+    case Op::kUMul:
+      return Value(FitMulToWidth(bits_ops::UMul(bits(0), bits(1)),
+                                 node->BitCountOrDie(), /*is_signed=*/false));
+    case Op::kSMul:
+      return Value(FitMulToWidth(bits_ops::SMul(bits(0), bits(1)),
+                                 node->BitCountOrDie(), /*is_signed=*/true));
+    case Op::kAnd:
+      return Value(fold(bits_ops::And));
+    case Op::kOr:
+      return Value(fold(bits_ops::Or));
+    case Op::kXor:
+      return Value(fold(bits_ops::Xor));
+    case Op::kNand:
+      return Value(bits_ops::Not(fold(bits_ops::And)));
+    case Op::kNor:
+      return Value(bits_ops::Not(fold(bits_ops::Or)));
+    case Op::kNot:
+      return Value(bits_ops::Not(bits(0)));
+    case Op::kNeg:
+      return Value(bits_ops::Negate(bits(0)));
+    case Op::kReverse:
+      return Value(bits_ops::Reverse(bits(0)));
+    case Op::kAndReduce:
+      return Value(bits_ops::AndReduce(bits(0)));
+    case Op::kOrReduce:
+      return Value(bits_ops::OrReduce(bits(0)));
+    case Op::kXorReduce:
+      return Value(bits_ops::XorReduce(bits(0)));
+    case Op::kEq:
+      return BoolValue(operand(0) == operand(1));
+    case Op::kNe:
+      return BoolValue(operand(0) != operand(1));
+    case Op::kULt:
+      return BoolValue(bits_ops::ULessThan(bits(0), bits(1)));
+    case Op::kULe:
+      return BoolValue(bits_ops::ULessThanOrEqual(bits(0), bits(1)));
+    case Op::kUGt:
+      return BoolValue(bits_ops::UGreaterThan(bits(0), bits(1)));
+    case Op::kUGe:
+      return BoolValue(bits_ops::UGreaterThanOrEqual(bits(0), bits(1)));
+    case Op::kSLt:
+      return BoolValue(bits_ops::SLessThan(bits(0), bits(1)));
+    case Op::kSLe:
+      return BoolValue(bits_ops::SLessThanOrEqual(bits(0), bits(1)));
+    case Op::kSGt:
+      return BoolValue(bits_ops::SGreaterThan(bits(0), bits(1)));
+    case Op::kSGe:
+      return BoolValue(bits_ops::SGreaterThanOrEqual(bits(0), bits(1)));
+    case Op::kShll:
+      return Value(bits_ops::ShiftLeftLogical(
+          bits(0), BitsToBoundedUint64(bits(1), bits(0).bit_count())));
+    case Op::kShrl:
+      return Value(bits_ops::ShiftRightLogical(
+          bits(0), BitsToBoundedUint64(bits(1), bits(0).bit_count())));
+    case Op::kShra:
+      return Value(bits_ops::ShiftRightArith(
+          bits(0), BitsToBoundedUint64(bits(1), bits(0).bit_count())));
+    case Op::kZeroExt:
+      return Value(bits_ops::ZeroExtend(
+          bits(0), node->As<ExtendOp>()->new_bit_count()));
+    case Op::kSignExt:
+      return Value(bits_ops::SignExtend(
+          bits(0), node->As<ExtendOp>()->new_bit_count()));
+    case Op::kBitSlice: {
+      BitSlice* bit_slice = node->As<BitSlice>();
+      return Value(bits(0).Slice(bit_slice->start(), bit_slice->width()));
+    }
+    case Op::kConcat: {
+      std::vector<Bits> operand_bits;
+      operand_bits.reserve(instruction.operand_count);
+      for (int64_t i = 0; i < instruction.operand_count; ++i) {
+        operand_bits.push_back(bits(i));
+      }
+      return Value(bits_ops::Concat(operand_bits));
+    }
+    case Op::kTuple: {
+      std::vector<Value> elements;
+      elements.reserve(instruction.operand_count);
+      for (int64_t i = 0; i < instruction.operand_count; ++i) {
+        elements.push_back(operand(i));
+      }
+      return Value::TupleOwned(std::move(elements));
+    }
+    case Op::kTupleIndex:
+      return operand(0).element(node->As<TupleIndex>()->index());
+    case Op::kArrayIndex: {
+      const Value* array = &operand(0);
+      for (int64_t i = 1; i < instruction.operand_count; ++i) {
+        array =
+            &array->element(BitsToBoundedUint64(bits(i), array->size() - 1));
+      }
+      return *array;
+    }
+    case Op::kSel: {
+      Select* sel = node->As<Select>();
+      const Bits& selector = bits(0);
+      int64_t case_count = sel->cases().size();
+      if (bits_ops::UGreaterThan(selector,
+                                 UBits(case_count - 1, selector.bit_count()))) {
+        XLS_RET_CHECK(sel->default_value().has_value());
+        return operand(instruction.operand_count - 1);
+      }
+      return operand(1 + selector.ToUint64().value());
+    }
+    default:
+      return EvaluateWithIrInterpreter(instruction, registers, events);
+  }
+}
+
+absl::Status CompiledFunctionInterpreter::CheckArgs(
+    absl::Span<const Value> args) const {
+  if (args.size() != function_->params().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Function `%s` (type: `%s`) wants %d arguments, got %d.",
+        function_->name(), function_->GetType()->ToString(),
+        function_->params().size(), args.size()));
+  }
+  for (int64_t argno = 0; argno < args.size(); ++argno) {
+    Param* param = function_->param(argno);
+    if (function_->package()->GetTypeForValue(args[argno]) !=
+        param->GetType()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Got argument %s for parameter %d which is not of type %s",
+          args[argno].ToString(), argno, param->GetType()->ToString()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<InterpreterResult<Value>> CompiledFunctionInterpreter::Run(
+    absl::Span<const Value> args,
+    std::optional<EvaluationObserver*> observer) const {
+  XLS_RETURN_IF_ERROR(CheckArgs(args));
+  std::vector<Value> registers(instructions_.size() + args.size());
+  for (int64_t argno = 0; argno < args.size(); ++argno) {
+    registers[param_registers_[argno]] = args[argno];
+    if (observer.has_value()) {
+      (*observer)->NodeEvaluated(function_->param(argno), args[argno]);
+    }
+  }
+  InterpreterEvents events;
+  for (const Instruction& instruction : instructions_) {
+    XLS_ASSIGN_OR_RETURN(Value result,
+                         Evaluate(instruction, registers, events));
+    if (observer.has_value()) {
+      (*observer)->NodeEvaluated(instruction.node, result);
+    }
+    registers[instruction.result] = std::move(result);
+  }
+  return InterpreterResult<Value>{std::move(registers[return_register_]),
+                                  std::move(events)};
+}
+
+absl::StatusOr<InterpreterResult<Value>>
+CompiledFunctionInterpreter::RunKwargs(
+    const absl::flat_hash_map<std::string, Value>& args,
+    std::optional<EvaluationObserver*> observer) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> positional_args,
+                       KeywordArgsToPositional(*function_, args));
+  return Run(positional_args, observer);
+}
+
+}  // namespace xls
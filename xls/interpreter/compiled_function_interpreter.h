@@ -0,0 +1,102 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+#define XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/observer.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// An interpreter for XLS functions which linearizes the function once into a
+// flat list of instructions, each referring to its operands by index into a
+// register file of values. Evaluation then walks this list without the
+// per-node virtual dispatch and hash map lookups of IrInterpreter. Common
+// operations are evaluated directly and the remaining ones (invokes, loops,
+// side-effecting ops, etc) are delegated to IrInterpreter so the results and
+// events are identical to InterpretFunction.
+//
+// Intended as a fast, portable fallback for when the JIT is unavailable and a
+// function is evaluated many times. Thread-safe: Run may be called
+// concurrently.
+class CompiledFunctionInterpreter {
+ public:
+  static absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>> Create(
+      Function* function);
+
+  // Evaluates the function with the given positional (or keyword) arguments.
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      absl::Span<const Value> args,
+      std::optional<EvaluationObserver*> observer = std::nullopt) const;
+  absl::StatusOr<InterpreterResult<Value>> RunKwargs(
+      const absl::flat_hash_map<std::string, Value>& args,
+      std::optional<EvaluationObserver*> observer = std::nullopt) const;
+
+  Function* function() const { return function_; }
+
+ private:
+  friend class IncrementalFunctionInterpreter;
+
+  struct Instruction {
+    Node* node;
+    Op op;
+    // Register holding the result.
+    int64_t result;
+    // Index of the first operand register in `operands_` and the operand
+    // count.
+    int64_t operands_start;
+    int64_t operand_count;
+  };
+
+  explicit CompiledFunctionInterpreter(Function* function)
+      : function_(function) {}
+
+  // Returns an error if `args` are not valid arguments of the function.
+  absl::Status CheckArgs(absl::Span<const Value> args) const;
+
+  // Evaluates `instruction` using the given register file.
+  absl::StatusOr<Value> Evaluate(const Instruction& instruction,
+                                 absl::Span<const Value> registers,
+                                 InterpreterEvents& events) const;
+  // Evaluates `instruction` with IrInterpreter.
+  absl::StatusOr<Value> EvaluateWithIrInterpreter(
+      const Instruction& instruction, absl::Span<const Value> registers,
+      InterpreterEvents& events) const;
+
+  Function* function_;
+  std::vector<Instruction> instructions_;
+  // Operand registers of all the instructions.
+  std::vector<int64_t> operands_;
+  std::vector<int64_t> param_registers_;
+  int64_t return_register_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
@@ -0,0 +1,117 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_evaluator_test_base.h"
+#include "xls/interpreter/observer.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+INSTANTIATE_TEST_SUITE_P(
+    CompiledFunctionInterpreterTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        [](Function* function, absl::Span<const Value> args,
+           std::optional<EvaluationObserver*> obs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(
+              std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+              CompiledFunctionInterpreter::Create(function));
+          return interpreter->Run(args, obs);
+        },
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs,
+           std::optional<EvaluationObserver*> obs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(
+              std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+              CompiledFunctionInterpreter::Create(function));
+          return interpreter->RunKwargs(kwargs, obs);
+        },
+        true)));
+
+class CompiledFunctionInterpreterTest : public IrTestBase {};
+
+TEST_F(CompiledFunctionInterpreterTest, RepeatedRuns) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  BValue sum = fb.Add(x, y);
+  fb.Concat({fb.BitSlice(sum, 8, 8), fb.Shrl(x, fb.Literal(UBits(4, 4))),
+             fb.UMul(x, y, 8)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunctionInterpreter> interp,
+                           CompiledFunctionInterpreter::Create(f));
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Value> args = {Value(UBits(i * 997, 16)),
+                               Value(UBits(i * 31 + 7, 16))};
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             InterpretFunction(f, args));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                             interp->Run(args));
+    EXPECT_EQ(actual.value, expected.value);
+  }
+}
+
+TEST_F(CompiledFunctionInterpreterTest, InvokeAndTraceFallBackToInterpreter) {
+  auto p = CreatePackage();
+  FunctionBuilder callee_fb("callee", p.get());
+  callee_fb.Not(callee_fb.Param("a", p->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * callee, callee_fb.Build());
+
+  FunctionBuilder fb(TestName(), p.get());
+  BValue tkn = fb.Param("tkn", p->GetTokenType());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue inverted = fb.Invoke({x}, callee);
+  BValue traced = fb.Trace(tkn, fb.Literal(UBits(1, 1)), {inverted},
+                           "inverted: {}");
+  fb.Tuple({traced, inverted});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunctionInterpreter> interp,
+                           CompiledFunctionInterpreter::Create(f));
+  std::vector<Value> args = {Value::Token(), Value(UBits(0x0f, 8))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                           InterpretFunction(f, args));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual, interp->Run(args));
+  EXPECT_EQ(actual.value, expected.value);
+  EXPECT_EQ(actual.events, expected.events);
+  EXPECT_EQ(actual.events.trace_msgs.size(), 1);
+}
+
+}  // namespace
+}  // namespace xls
@@ -15,10 +15,15 @@
 #ifndef XLS_INTERPRETER_EVALUATOR_OPTIONS_H_
 #define XLS_INTERPRETER_EVALUATOR_OPTIONS_H_
 
+#include <cstdint>
+
 #include "xls/ir/format_preference.h"
 
 namespace xls {
 
+class JitNodeCoverage;
+class NodeProfiler;
+
 // Options when running the IR interpreter and JIT.
 class EvaluatorOptions {
  public:
@@ -42,10 +47,82 @@ class EvaluatorOptions {
   }
   bool support_observers() const { return support_observers_; }
 
+  // The number of threads used to JIT compile the procs of a network. Each
+  // proc is compiled into its own LLVM module so procs may be compiled
+  // concurrently. A value of one compiles the procs serially on the calling
+  // thread.
+  EvaluatorOptions& set_jit_compile_threads(int64_t value) {
+    jit_compile_threads_ = value;
+    return *this;
+  }
+  int64_t jit_compile_threads() const { return jit_compile_threads_; }
+
+  // When set, each proc of a JIT proc network is compiled once any of its
+  // instances completes a tick rather than when the runtime is created; until
+  // then the proc is interpreted. Procs which never complete a tick, e.g.
+  // because they block on a receive which is never satisfied, are never
+  // compiled.
+  EvaluatorOptions& set_lazy_jit_compilation(bool value) {
+    lazy_jit_compilation_ = value;
+    return *this;
+  }
+  bool lazy_jit_compilation() const { return lazy_jit_compilation_; }
+
+  // When set, JIT compiled procs record node coverage natively into the given
+  // object (see xls/jit/jit_node_coverage.h) without using observers. The
+  // object must outlive the runtime. Ignored by the interpreter.
+  EvaluatorOptions& set_jit_node_coverage(JitNodeCoverage* value) {
+    jit_node_coverage_ = value;
+    return *this;
+  }
+  JitNodeCoverage* jit_node_coverage() const { return jit_node_coverage_; }
+
+  // When set, JIT compiled procs accumulate the cycles spent evaluating each
+  // node into the given object (see xls/jit/node_profiler.h). The object must
+  // outlive the runtime. Ignored by the interpreter.
+  EvaluatorOptions& set_jit_node_profiler(NodeProfiler* value) {
+    jit_node_profiler_ = value;
+    return *this;
+  }
+  NodeProfiler* jit_node_profiler() const { return jit_node_profiler_; }
+
+  // When positive, arrays of narrow bits types in the state of JIT compiled
+  // procs whose native layout occupies at least this many bytes are stored
+  // bit-packed rather than with each element padded to a power-of-two number
+  // of bytes (see xls/jit/jit_layout_options.h). Only arrays accessed
+  // exclusively by operations which support the packed layout are packed.
+  // Ignored by the interpreter.
+  EvaluatorOptions& set_jit_bit_packed_array_min_bytes(int64_t value) {
+    jit_bit_packed_array_min_bytes_ = value;
+    return *this;
+  }
+  int64_t jit_bit_packed_array_min_bytes() const {
+    return jit_bit_packed_array_min_bytes_;
+  }
+
+  // When set, the serial proc runtime runs the receiver of a point-to-point
+  // channel between two proc instances as soon as the sender writes to it if
+  // the receiver is blocked on that channel, rather than after the other ready
+  // procs. Data then flows through chains of procs while it is hot, one element
+  // at a time, instead of each proc draining its inputs in turn. Networks with
+  // non-blocking receives or single-value channels, whose results depend on
+  // the order procs run in, are run without fusion.
+  EvaluatorOptions& set_fuse_proc_chains(bool value) {
+    fuse_proc_chains_ = value;
+    return *this;
+  }
+  bool fuse_proc_chains() const { return fuse_proc_chains_; }
+
  private:
   bool trace_channels_ = false;
   FormatPreference format_preference_ = FormatPreference::kDefault;
   bool support_observers_ = false;
+  int64_t jit_compile_threads_ = 1;
+  bool lazy_jit_compilation_ = false;
+  JitNodeCoverage* jit_node_coverage_ = nullptr;
+  NodeProfiler* jit_node_profiler_ = nullptr;
+  int64_t jit_bit_packed_array_min_bytes_ = 0;
+  bool fuse_proc_chains_ = false;
 };
 
 }  // namespace xls
@@ -0,0 +1,125 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/incremental_function_interpreter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/compiled_function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/keyword_args.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Returns whether evaluating a node with the given op may produce interpreter
+// events.
+bool MayProduceEvents(Op op) {
+  switch (op) {
+    case Op::kInvoke:
+    case Op::kMap:
+    case Op::kCountedFor:
+    case Op::kDynamicCountedFor:
+      return true;
+    default:
+      return OpIsSideEffecting(op);
+  }
+}
+
+}  // namespace
+
+IncrementalFunctionInterpreter::IncrementalFunctionInterpreter(
+    std::unique_ptr<CompiledFunctionInterpreter> interpreter)
+    : interpreter_(std::move(interpreter)) {
+  const int64_t register_count = interpreter_->instructions_.size() +
+                                 interpreter_->param_registers_.size();
+  registers_.resize(register_count);
+  changed_.resize(register_count);
+  always_evaluate_.reserve(interpreter_->instructions_.size());
+  for (const CompiledFunctionInterpreter::Instruction& instruction :
+       interpreter_->instructions_) {
+    always_evaluate_.push_back(MayProduceEvents(instruction.op));
+  }
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<IncrementalFunctionInterpreter>>
+IncrementalFunctionInterpreter::Create(Function* function) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+                       CompiledFunctionInterpreter::Create(function));
+  return absl::WrapUnique(
+      new IncrementalFunctionInterpreter(std::move(interpreter)));
+}
+
+absl::StatusOr<InterpreterResult<Value>> IncrementalFunctionInterpreter::Run(
+    absl::Span<const Value> args) {
+  XLS_RETURN_IF_ERROR(interpreter_->CheckArgs(args));
+  std::fill(changed_.begin(), changed_.end(), !valid_);
+  for (int64_t argno = 0; argno < args.size(); ++argno) {
+    int64_t reg = interpreter_->param_registers_[argno];
+    if (!valid_ || registers_[reg] != args[argno]) {
+      registers_[reg] = args[argno];
+      changed_[reg] = true;
+    }
+  }
+  // Any failure below leaves the cache partially updated.
+  valid_ = false;
+  last_evaluated_node_count_ = 0;
+  InterpreterEvents events;
+  const std::vector<int64_t>& operands = interpreter_->operands_;
+  for (int64_t i = 0; i < interpreter_->instructions_.size(); ++i) {
+    const CompiledFunctionInterpreter::Instruction& instruction =
+        interpreter_->instructions_[i];
+    bool evaluate = changed_[instruction.result] || always_evaluate_[i];
+    for (int64_t j = 0; !evaluate && j < instruction.operand_count; ++j) {
+      evaluate = changed_[operands[instruction.operands_start + j]];
+    }
+    if (!evaluate) {
+      continue;
+    }
+    ++last_evaluated_node_count_;
+    XLS_ASSIGN_OR_RETURN(
+        Value result, interpreter_->Evaluate(instruction, registers_, events));
+    // Nodes whose value did not change do not dirty their fanout.
+    Value& cached = registers_[instruction.result];
+    if (changed_[instruction.result] || result != cached) {
+      cached = std::move(result);
+      changed_[instruction.result] = true;
+    }
+  }
+  valid_ = true;
+  return InterpreterResult<Value>{
+      registers_[interpreter_->return_register_], std::move(events)};
+}
+
+absl::StatusOr<InterpreterResult<Value>>
+IncrementalFunctionInterpreter::RunKwargs(
+    const absl::flat_hash_map<std::string, Value>& args) {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> positional_args,
+                       KeywordArgsToPositional(*function(), args));
+  return Run(positional_args);
+}
+
+}  // namespace xls
@@ -0,0 +1,78 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_INCREMENTAL_FUNCTION_INTERPRETER_H_
+#define XLS_INTERPRETER_INCREMENTAL_FUNCTION_INTERPRETER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/compiled_function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// An interpreter for evaluating a function over a sequence of similar inputs.
+// The value of every node computed by the previous Run is cached and the next
+// Run only re-evaluates the nodes in the transitive fanout of the arguments
+// which changed. Nodes which may produce interpreter events (traces, asserts,
+// invokes, loops, etc) are always re-evaluated so the returned events are
+// complete.
+//
+// Results are identical to InterpretFunction. Not thread-safe.
+class IncrementalFunctionInterpreter {
+ public:
+  static absl::StatusOr<std::unique_ptr<IncrementalFunctionInterpreter>>
+  Create(Function* function);
+
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+  absl::StatusOr<InterpreterResult<Value>> RunKwargs(
+      const absl::flat_hash_map<std::string, Value>& args);
+
+  // Discards the cached node values. The next Run evaluates every node.
+  void Invalidate() { valid_ = false; }
+
+  // Returns the number of (non-parameter) nodes evaluated by the last Run.
+  int64_t last_evaluated_node_count() const {
+    return last_evaluated_node_count_;
+  }
+
+  Function* function() const { return interpreter_->function(); }
+
+ private:
+  explicit IncrementalFunctionInterpreter(
+      std::unique_ptr<CompiledFunctionInterpreter> interpreter);
+
+  std::unique_ptr<CompiledFunctionInterpreter> interpreter_;
+  // Whether each instruction must be evaluated on every run.
+  std::vector<bool> always_evaluate_;
+  // The value of each node computed by the last run, indexed by register.
+  std::vector<Value> registers_;
+  // Scratch space marking the registers whose values changed in this run.
+  std::vector<bool> changed_;
+  // Whether `registers_` holds the values of a successful run.
+  bool valid_ = false;
+  int64_t last_evaluated_node_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_INCREMENTAL_FUNCTION_INTERPRETER_H_
@@ -0,0 +1,136 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/incremental_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+
+class IncrementalFunctionInterpreterTest : public IrTestBase {};
+
+TEST_F(IncrementalFunctionInterpreterTest, OnlyFanoutOfChangedArgsEvaluated) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  // Three nodes depend only on `x`, two only on `y`, and the final add on
+  // both.
+  BValue x_cone = fb.Not(fb.Negate(fb.Add(x, x)));
+  BValue y_cone = fb.Not(fb.Negate(y));
+  fb.Add(x_cone, y_cone);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalFunctionInterpreter> interp,
+      IncrementalFunctionInterpreter::Create(f));
+  auto check = [&](uint64_t x_value, uint64_t y_value,
+                   int64_t expected_evaluated) {
+    std::vector<Value> args = {Value(UBits(x_value, 32)),
+                               Value(UBits(y_value, 32))};
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             InterpretFunction(f, args));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                             interp->Run(args));
+    EXPECT_EQ(actual.value, expected.value);
+    EXPECT_EQ(interp->last_evaluated_node_count(), expected_evaluated);
+  };
+  check(1, 2, /*expected_evaluated=*/6);
+  check(1, 2, /*expected_evaluated=*/0);
+  check(5, 2, /*expected_evaluated=*/4);
+  check(5, 7, /*expected_evaluated=*/3);
+  interp->Invalidate();
+  check(5, 7, /*expected_evaluated=*/6);
+}
+
+TEST_F(IncrementalFunctionInterpreterTest, UnchangedValuesStopPropagation) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  // Only the low bit of `x` reaches the negate.
+  fb.Negate(fb.BitSlice(x, 0, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalFunctionInterpreter> interp,
+      IncrementalFunctionInterpreter::Create(f));
+  XLS_ASSERT_OK(interp->Run({Value(UBits(1, 8))}).status());
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           interp->Run({Value(UBits(3, 8))}));
+  EXPECT_EQ(result.value, Value(UBits(1, 1)));
+  EXPECT_EQ(interp->last_evaluated_node_count(), 1);
+}
+
+TEST_F(IncrementalFunctionInterpreterTest, TracesAreAlwaysReported) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue tkn = fb.Param("tkn", p->GetTokenType());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue traced = fb.Trace(tkn, fb.Literal(UBits(1, 1)), {x}, "x: {}");
+  fb.Tuple({traced, fb.Add(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalFunctionInterpreter> interp,
+      IncrementalFunctionInterpreter::Create(f));
+  for (uint64_t y_value : {1, 2, 3}) {
+    std::vector<Value> args = {Value::Token(), Value(UBits(42, 8)),
+                               Value(UBits(y_value, 8))};
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             InterpretFunction(f, args));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                             interp->Run(args));
+    EXPECT_EQ(actual.value, expected.value);
+    EXPECT_EQ(actual.events, expected.events);
+  }
+}
+
+TEST_F(IncrementalFunctionInterpreterTest, InvalidArguments) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalFunctionInterpreter> interp,
+      IncrementalFunctionInterpreter::Create(f));
+  EXPECT_THAT(interp->Run({Value(UBits(1, 4))}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(interp->Run({}), StatusIs(absl::StatusCode::kInvalidArgument));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           interp->Run({Value(UBits(1, 8))}));
+  EXPECT_EQ(result.value, Value(UBits(0xfe, 8)));
+}
+
+}  // namespace
+}  // namespace xls
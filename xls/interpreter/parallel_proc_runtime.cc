@@ -0,0 +1,288 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/events.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+ParallelProcRuntime::Create(
+    std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    const EvaluatorOptions& options, std::optional<int64_t> thread_count) {
+  // Verify there exists exactly one evaluator per proc in the package.
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluator_map;
+  for (std::unique_ptr<ProcEvaluator>& evaluator : evaluators) {
+    Proc* proc = evaluator->proc();
+    auto [it, inserted] = evaluator_map.insert({proc, std::move(evaluator)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one evaluator given for proc `%s`", proc->name());
+  }
+  for (Proc* proc : queue_manager->elaboration().procs()) {
+    XLS_RET_CHECK(evaluator_map.contains(proc))
+        << absl::StreamFormat("No evaluator given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(evaluator_map.size(),
+                   queue_manager->elaboration().procs().size())
+      << "More evaluators than procs given.";
+  int64_t worker_count =
+      thread_count.value_or(std::max(int64_t{1}, int64_t{AvailableCPUs()}));
+  XLS_RET_CHECK_GT(worker_count, 0);
+  return absl::WrapUnique(new ParallelProcRuntime(
+      std::move(evaluator_map), std::move(queue_manager), options,
+      worker_count));
+}
+
+ParallelProcRuntime::ParallelProcRuntime(
+    absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    const EvaluatorOptions& options, int64_t thread_count)
+    : ProcRuntime(std::move(evaluators), std::move(queue_manager), options) {
+  work_queues_.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    work_queues_.push_back(std::make_unique<WorkQueue>());
+  }
+  workers_.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    workers_.push_back(
+        std::make_unique<Thread>([this, i]() { WorkerLoop(i); }));
+  }
+}
+
+ParallelProcRuntime::~ParallelProcRuntime() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+void ParallelProcRuntime::WorkerLoop(int64_t worker_index) {
+  int64_t seen_generation = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      auto tick_started_or_shutdown = [&]() {
+        mutex_.AssertReaderHeld();
+        return shutdown_ || generation_ != seen_generation;
+      };
+      mutex_.Await(absl::Condition(&tick_started_or_shutdown));
+      if (shutdown_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+    RunUntilTickComplete(worker_index);
+  }
+}
+
+void ParallelProcRuntime::RunUntilTickComplete(int64_t worker_index) {
+  while (true) {
+    std::optional<ProcInstance*> instance = PopReadyInstance(worker_index);
+    if (instance.has_value()) {
+      RunInstance(worker_index, *instance);
+      continue;
+    }
+    absl::MutexLock lock(&mutex_);
+    auto work_available_or_done = [&]() {
+      mutex_.AssertReaderHeld();
+      return active_count_ == 0 || queued_count_.load() > 0;
+    };
+    mutex_.Await(absl::Condition(&work_available_or_done));
+    if (active_count_ == 0) {
+      return;
+    }
+  }
+}
+
+std::optional<ProcInstance*> ParallelProcRuntime::PopReadyInstance(
+    int64_t worker_index) {
+  {
+    WorkQueue& own = *work_queues_[worker_index];
+    absl::MutexLock lock(&own.mutex);
+    if (!own.instances.empty()) {
+      ProcInstance* instance = own.instances.front();
+      own.instances.pop_front();
+      queued_count_.fetch_sub(1);
+      return instance;
+    }
+  }
+  for (int64_t i = 1; i < work_queues_.size(); ++i) {
+    WorkQueue& victim =
+        *work_queues_[(worker_index + i) % work_queues_.size()];
+    absl::MutexLock lock(&victim.mutex);
+    if (!victim.instances.empty()) {
+      ProcInstance* instance = victim.instances.back();
+      victim.instances.pop_back();
+      queued_count_.fetch_sub(1);
+      return instance;
+    }
+  }
+  return std::nullopt;
+}
+
+void ParallelProcRuntime::PushReadyInstance(int64_t worker_index,
+                                            ProcInstance* instance) {
+  WorkQueue& queue = *work_queues_[worker_index];
+  absl::MutexLock lock(&queue.mutex);
+  queue.instances.push_back(instance);
+  queued_count_.fetch_add(1);
+}
+
+void ParallelProcRuntime::RunInstance(int64_t worker_index,
+                                      ProcInstance* instance) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!status_.ok()) {
+      // An error occurred elsewhere in this tick. Drain the instance.
+      --active_count_;
+      return;
+    }
+  }
+
+  VLOG(3) << absl::StreamFormat("Worker %d ticking proc instance `%s`",
+                                worker_index, instance->GetName());
+  ProcEvaluator* evaluator = evaluators_.at(instance->proc()).get();
+  absl::StatusOr<TickResult> tick_result =
+      evaluator->Tick(*continuations_.at(instance->id()));
+  absl::Status status = tick_result.status();
+  if (status.ok()) {
+    status = InterpreterEventsToStatus(GetInterpreterEvents(instance));
+  }
+
+  absl::MutexLock lock(&mutex_);
+  if (!status.ok()) {
+    if (status_.ok()) {
+      status_ = status;
+    }
+    --active_count_;
+    return;
+  }
+  VLOG(3) << "Tick result: " << *tick_result;
+
+  progress_made_ |= tick_result->progress_made;
+  progress_made_on_io_procs_ |=
+      tick_result->progress_made && evaluator->ProcHasIoOperations();
+  switch (tick_result->execution_state) {
+    case TickExecutionState::kSentOnChannel: {
+      ChannelInstance* channel_instance = tick_result->channel_instance.value();
+      auto it = blocked_instances_.find(channel_instance);
+      if (it != blocked_instances_.end()) {
+        for (ProcInstance* blocked : it->second) {
+          VLOG(3) << absl::StreamFormat(
+              "Unblocking proc instance `%s` and adding to ready list",
+              blocked->GetName());
+          ++active_count_;
+          PushReadyInstance(worker_index, blocked);
+        }
+        blocked_instances_.erase(it);
+      }
+      // This proc instance can go back on the ready queue.
+      PushReadyInstance(worker_index, instance);
+      return;
+    }
+    case TickExecutionState::kBlockedOnReceive: {
+      ChannelInstance* channel_instance = tick_result->channel_instance.value();
+      // The sender may have written to the channel after this proc observed it
+      // as empty but before it was parked. Senders check for parked receivers
+      // while holding `mutex_` so checking the queue here, also under `mutex_`,
+      // guarantees the wake up is not lost.
+      if (!queue_manager().GetQueue(channel_instance).IsEmpty()) {
+        PushReadyInstance(worker_index, instance);
+        return;
+      }
+      VLOG(3) << absl::StreamFormat(
+          "Proc instance `%s` is now blocked on channel instance `%s`",
+          instance->GetName(), channel_instance->ToString());
+      blocked_instances_[channel_instance].push_back(instance);
+      --active_count_;
+      return;
+    }
+    case TickExecutionState::kCompleted:
+      --active_count_;
+      return;
+  }
+}
+
+absl::StatusOr<ParallelProcRuntime::NetworkTickResult>
+ParallelProcRuntime::TickInternal() {
+  VLOG(3) << absl::StreamFormat("TickInternal on package %s",
+                                package()->name());
+  absl::MutexLock lock(&mutex_);
+  blocked_instances_.clear();
+  progress_made_ = false;
+  progress_made_on_io_procs_ = false;
+  status_ = absl::OkStatus();
+
+  // Distribute all proc instances round-robin across the workers.
+  absl::Span<ProcInstance* const> instances = elaboration().proc_instances();
+  active_count_ = instances.size();
+  for (int64_t i = 0; i < instances.size(); ++i) {
+    PushReadyInstance(i % work_queues_.size(), instances[i]);
+  }
+  ++generation_;
+
+  auto tick_complete = [&]() {
+    mutex_.AssertReaderHeld();
+    return active_count_ == 0;
+  };
+  mutex_.Await(absl::Condition(&tick_complete));
+  XLS_RETURN_IF_ERROR(status_);
+
+  std::vector<ChannelInstance*> blocked_channel_instances;
+  std::vector<ProcInstance*> blocked_proc_instances;
+  for (ChannelInstance* instance : elaboration().channel_instances()) {
+    auto it = blocked_instances_.find(instance);
+    if (it != blocked_instances_.end()) {
+      blocked_channel_instances.push_back(instance);
+      blocked_proc_instances.insert(blocked_proc_instances.end(),
+                                    it->second.begin(), it->second.end());
+    }
+  }
+  return NetworkTickResult{
+      .progress_made = progress_made_,
+      .progress_made_on_io_procs = progress_made_on_io_procs_,
+      .blocked_channel_instances = std::move(blocked_channel_instances),
+      .blocked_proc_instances = std::move(blocked_proc_instances),
+  };
+}
+
+}  // namespace xls
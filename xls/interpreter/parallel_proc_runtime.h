@@ -0,0 +1,125 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+// Class for evaluating a network of procs on a pool of worker threads. Each
+// call to Tick executes (up to) one iteration of every proc instance, like
+// SerialProcRuntime, but proc instances are distributed across per-worker
+// deques and idle workers steal from the other workers' deques. A proc instance
+// blocked on an empty channel is parked until a send on that channel wakes it.
+//
+// The evaluators and channel queues must support concurrent use from multiple
+// threads (e.g., ProcJit with a thread-safe JitChannelQueueManager). Observer
+// callbacks, if any, may be invoked concurrently from the worker threads.
+// ParallelProcRuntimes are thread-compatible, but not thread-safe.
+class ParallelProcRuntime : public ProcRuntime {
+ public:
+  // Creates and returns a parallel proc runtime for the given evaluators.
+  // `thread_count` is the number of worker threads. If not given the number of
+  // available CPUs is used.
+  static absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> Create(
+      std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      const EvaluatorOptions& options = EvaluatorOptions(),
+      std::optional<int64_t> thread_count = std::nullopt);
+
+  ~ParallelProcRuntime() override;
+
+  int64_t thread_count() const { return workers_.size(); }
+
+ private:
+  ParallelProcRuntime(
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      const EvaluatorOptions& options, int64_t thread_count);
+
+  absl::StatusOr<ParallelProcRuntime::NetworkTickResult> TickInternal()
+      override;
+
+  // Per-worker deque of proc instances ready to run. The owning worker pops
+  // from the front and other workers steal from the back.
+  struct WorkQueue {
+    absl::Mutex mutex;
+    std::deque<ProcInstance*> instances ABSL_GUARDED_BY(mutex);
+  };
+
+  // Main loop of worker thread `worker_index`.
+  void WorkerLoop(int64_t worker_index);
+
+  // Runs ready proc instances until the current network tick is complete.
+  void RunUntilTickComplete(int64_t worker_index);
+
+  // Pops a ready proc instance from the worker's own queue or, if that is
+  // empty, steals one from another worker's queue.
+  std::optional<ProcInstance*> PopReadyInstance(int64_t worker_index);
+
+  // Adds the proc instance to the ready queue of the given worker.
+  void PushReadyInstance(int64_t worker_index, ProcInstance* instance)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Ticks the proc instance once and schedules the follow-up work.
+  void RunInstance(int64_t worker_index, ProcInstance* instance);
+
+  std::vector<std::unique_ptr<WorkQueue>> work_queues_;
+  std::vector<std::unique_ptr<Thread>> workers_;
+
+  // Number of proc instances sitting in the work queues. Only incremented
+  // while holding `mutex_` so waiters on `mutex_` observe new work.
+  std::atomic<int64_t> queued_count_ = 0;
+
+  // Guards the scheduling state of the current network tick.
+  absl::Mutex mutex_;
+  // Incremented to start a network tick on the workers.
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  // Number of proc instances which are either queued or running in the current
+  // network tick. The tick is complete when this reaches zero.
+  int64_t active_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Proc instances parked on each channel instance awaiting a send.
+  absl::flat_hash_map<ChannelInstance*, std::vector<ProcInstance*>>
+      blocked_instances_ ABSL_GUARDED_BY(mutex_);
+  bool progress_made_ ABSL_GUARDED_BY(mutex_) = false;
+  bool progress_made_on_io_procs_ ABSL_GUARDED_BY(mutex_) = false;
+  // First error encountered in the current network tick. Once set, remaining
+  // ready instances are drained without being run.
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
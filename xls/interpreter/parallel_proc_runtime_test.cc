@@ -0,0 +1,163 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Optional;
+
+constexpr const char kIrAssertPath[] = "xls/interpreter/force_assert.ir";
+
+TEST(ParallelProcRuntimeTest, JitAsserts) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::filesystem::path ir_path,
+                           GetXlsRunfilePath(kIrAssertPath));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime,
+                           CreateJitParallelProcRuntime(package.get()));
+
+  EXPECT_THAT(runtime->Tick(),
+              absl_testing::StatusIs(
+                  absl::StatusCode::kAborted,
+                  ::testing::HasSubstr("Assertion failure via fail!")));
+}
+
+class ParallelProcRuntimeChainTest : public IrTestBase {};
+
+// A long chain of pass-through procs each incrementing the value. Exercises
+// parking and waking of proc instances across worker threads.
+TEST_F(ParallelProcRuntimeChainTest, LongChainOfIncrementers) {
+  constexpr int64_t kStages = 32;
+  constexpr int64_t kValues = 100;
+  auto package = CreatePackage();
+  std::vector<Channel*> channels;
+  for (int64_t i = 0; i <= kStages; ++i) {
+    ChannelOps ops = i == 0         ? ChannelOps::kReceiveOnly
+                     : i == kStages ? ChannelOps::kSendOnly
+                                    : ChannelOps::kSendReceive;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * channel,
+        package->CreateStreamingChannel(absl::StrFormat("ch%d", i), ops,
+                                        package->GetBitsType(32)));
+    channels.push_back(channel);
+  }
+  for (int64_t i = 0; i < kStages; ++i) {
+    TokenlessProcBuilder pb(absl::StrFormat("stage%d", i), "tkn",
+                            package.get());
+    pb.Send(channels[i + 1],
+            pb.Add(pb.Receive(channels[i]), pb.Literal(UBits(1, 32))));
+    XLS_ASSERT_OK(pb.Build({}).status());
+  }
+
+  for (int64_t thread_count : {1, 2, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ParallelProcRuntime> runtime,
+        CreateJitParallelProcRuntime(package.get(), EvaluatorOptions(),
+                                     thread_count));
+    EXPECT_EQ(runtime->thread_count(), thread_count);
+    ChannelQueue& input = runtime->queue_manager().GetQueue(channels.front());
+    ChannelQueue& output = runtime->queue_manager().GetQueue(channels.back());
+    for (int64_t i = 0; i < kValues; ++i) {
+      XLS_ASSERT_OK(input.Write(Value(UBits(i, 32))));
+    }
+    XLS_ASSERT_OK(runtime->TickUntilOutput({{channels.back(), kValues}},
+                                           /*max_ticks=*/1000));
+    for (int64_t i = 0; i < kValues; ++i) {
+      EXPECT_THAT(output.Read(), Optional(Value(UBits(i + kStages, 32))));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(int64_t ticks, runtime->TickUntilBlocked(
+                                                /*max_ticks=*/1000));
+    EXPECT_EQ(ticks, 0);
+  }
+}
+
+// Instantiate and run all the tests in proc_runtime_test_base.cc using the
+// parallel runtime.
+INSTANTIATE_TEST_SUITE_P(
+    ParallelProcRuntimeTest, ProcRuntimeTestBase,
+    testing::Values(
+        ProcRuntimeTestParam(
+            "parallel_jit",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(package, options,
+                                                  /*thread_count=*/4)
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(top, options,
+                                                  /*thread_count=*/4)
+                  .value();
+            },
+            // Observer callbacks are invoked concurrently so the order the
+            // observer test expects is not guaranteed.
+            /*supports_observers=*/false),
+        ProcRuntimeTestParam(
+            "parallel_jit_lazy",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(
+                         package,
+                         EvaluatorOptions(options).set_lazy_jit_compilation(
+                             true),
+                         /*thread_count=*/4)
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(
+                         top,
+                         EvaluatorOptions(options).set_lazy_jit_compilation(
+                             true),
+                         /*thread_count=*/4)
+                  .value();
+            },
+            /*supports_observers=*/false)),
+    [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
+      return info.param.name();
+    });
+
+}  // namespace
+}  // namespace xls
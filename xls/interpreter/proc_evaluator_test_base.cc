@@ -1348,5 +1348,62 @@ TEST_P(ProcEvaluatorTestBase, ProcSetState) {
   EXPECT_TRUE(ch0_queue.IsEmpty());
 }
 
+
+TEST_P(ProcEvaluatorTestBase, PartiallyUpdatedStateProc) {
+  // Create a proc where each tick updates only some of its state elements: one
+  // is updated every tick, one every other tick and one is never changed.
+  auto package = CreatePackage();
+  ProcBuilder pb("partial", package.get());
+  BValue iteration = pb.StateElement("iteration", Value(UBits(0, 32)));
+  BValue counter = pb.StateElement("counter", Value(UBits(0, 32)));
+  BValue constant = pb.StateElement("constant", Value(UBits(5, 32)));
+  BValue odd_iteration = pb.Eq(pb.BitSlice(iteration, /*start=*/0, /*width=*/1),
+                               pb.Literal(UBits(1, 1)));
+  pb.Next(/*state_read=*/iteration,
+          /*value=*/pb.Add(iteration, pb.Literal(UBits(1, 32))));
+  pb.Next(/*state_read=*/counter,
+          /*value=*/pb.Add(counter, constant), /*pred=*/odd_iteration);
+  pb.Next(/*state_read=*/constant, /*value=*/constant);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      GetParam().CreateQueueManager(package.get());
+  std::unique_ptr<ProcEvaluator> evaluator =
+      GetParam().CreateEvaluator(proc, queue_manager.get());
+  std::unique_ptr<ProcContinuation> continuation = evaluator->NewContinuation(
+      queue_manager->elaboration().GetUniqueInstance(proc).value());
+
+  auto tick = [&]() {
+    EXPECT_THAT(evaluator->Tick(*continuation),
+                IsOkAndHolds(TickResult{
+                    .execution_state = TickExecutionState::kCompleted,
+                    .channel_instance = std::nullopt,
+                    .progress_made = true}));
+  };
+  auto state = [](int64_t iteration, int64_t counter, int64_t constant) {
+    return ElementsAre(Value(UBits(iteration, 32)), Value(UBits(counter, 32)),
+                       Value(UBits(constant, 32)));
+  };
+
+  tick();
+  EXPECT_THAT(continuation->GetState(), state(1, 0, 5));
+  tick();
+  EXPECT_THAT(continuation->GetState(), state(2, 5, 5));
+  tick();
+  EXPECT_THAT(continuation->GetState(), state(3, 5, 5));
+  tick();
+  EXPECT_THAT(continuation->GetState(), state(4, 10, 5));
+
+  // Elements which are not updated must keep the values set between ticks.
+  XLS_ASSERT_OK(continuation->SetState(
+      {Value(UBits(1, 32)), Value(UBits(100, 32)), Value(UBits(7, 32))}));
+  tick();
+  EXPECT_THAT(continuation->GetState(), state(2, 107, 7));
+  tick();
+  EXPECT_THAT(continuation->GetState(), state(3, 107, 7));
+  tick();
+  EXPECT_THAT(continuation->GetState(), state(4, 114, 7));
+}
+
 }  // namespace
 }  // namespace xls
@@ -36,6 +36,8 @@
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime_profile.h"
+#include "xls/interpreter/proc_runtime_profile.pb.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/events.h"
@@ -83,13 +85,13 @@ void ProcRuntime::ClearObserver() {
   if (!observer_) {
     return;
   }
-  for (const auto& [_, cont] : continuations_) {
+  for (const std::unique_ptr<ProcContinuation>& cont : continuations_) {
     cont->ClearObserver();
   }
   observer_.reset();
 }
 absl::Status ProcRuntime::SetObserver(EvaluationObserver* obs) {
-  for (const auto& [inst, cont] : continuations_) {
+  for (const std::unique_ptr<ProcContinuation>& cont : continuations_) {
     XLS_RETURN_IF_ERROR(cont->SetObserver(obs));
   }
   observer_ = obs;
@@ -97,7 +99,7 @@ absl::Status ProcRuntime::SetObserver(EvaluationObserver* obs) {
 }
 
 bool ProcRuntime::SupportsObservers() const {
-  for (const auto& [inst, cont] : continuations_) {
+  for (const std::unique_ptr<ProcContinuation>& cont : continuations_) {
     if (!cont->SupportsObservers()) {
       return false;
     }
@@ -114,7 +116,7 @@ ProcRuntime::ProcRuntime(
   for (ProcInstance* instance : elaboration().proc_instances()) {
     std::unique_ptr<ProcContinuation> continuation =
         evaluators_.at(instance->proc())->NewContinuation(instance);
-    continuations_[instance] = std::move(continuation);
+    continuations_.push_back(std::move(continuation));
   }
   if (options.trace_channels()) {
     for (ChannelQueue* queue : queue_manager_->queues()) {
@@ -124,9 +126,31 @@ ProcRuntime::ProcRuntime(
   }
 }
 
+absl::StatusOr<ProcRuntime::NetworkTickResult>
+ProcRuntime::ProfiledTickInternal() {
+  XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+  if (profiler_ != nullptr) {
+    profiler_->RecordTick(result.blocked_proc_instances,
+                          result.blocked_channel_instances);
+  }
+  return result;
+}
+
+void ProcRuntime::EnableProfiling(bool record_timeline) {
+  profiler_ =
+      std::make_unique<ProcRuntimeProfiler>(*queue_manager_, record_timeline);
+}
+
+absl::StatusOr<ProcNetworkProfileProto> ProcRuntime::GetProfile() const {
+  if (profiler_ == nullptr) {
+    return absl::FailedPreconditionError("Profiling is not enabled.");
+  }
+  return profiler_->ToProto();
+}
+
 absl::Status ProcRuntime::Tick() {
   std::vector<Channel*> blocked_channels;
-  XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+  XLS_ASSIGN_OR_RETURN(NetworkTickResult result, ProfiledTickInternal());
   if (!result.progress_made) {
     // Not a single instruction executed on any proc. This is necessarily a
     // deadlock.
@@ -216,7 +240,7 @@ absl::StatusOr<int64_t> ProcRuntime::TickUntilBlocked(
                                 package()->name());
   int64_t ticks = 0;
   while (!max_ticks.has_value() || ticks < max_ticks.value()) {
-    XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+    XLS_ASSIGN_OR_RETURN(NetworkTickResult result, ProfiledTickInternal());
     if (!result.progress_made_on_io_procs) {
       return ticks;
     }
@@ -229,11 +253,11 @@ absl::StatusOr<int64_t> ProcRuntime::TickUntilBlocked(
 
 void ProcRuntime::ResetState() {
   for (ProcInstance* instance : elaboration().proc_instances()) {
-    continuations_[instance] =
+    continuations_[instance->id()] =
         evaluators_.at(instance->proc())->NewContinuation(instance);
     if (observer_) {
       // We must have called this successfully at least once.
-      CHECK_OK(continuations_[instance]->SetObserver(*observer_));
+      CHECK_OK(continuations_[instance->id()]->SetObserver(*observer_));
     }
   }
 }
@@ -253,7 +277,8 @@ InterpreterEvents ProcRuntime::GetGlobalEvents() const {
 }
 
 void ProcRuntime::ClearInterpreterEvents() {
-  for (const auto& [_, continuation] : continuations_) {
+  for (const std::unique_ptr<ProcContinuation>& continuation :
+       continuations_) {
     continuation->ClearEvents();
   }
   {
@@ -30,6 +30,8 @@
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime_profile.h"
+#include "xls/interpreter/proc_runtime_profile.pb.h"
 #include "xls/ir/events.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
@@ -90,19 +92,21 @@ class ProcRuntime {
 
   // Returns the state values for a proc in the network.
   std::vector<Value> ResolveState(ProcInstance* instance) const {
-    return continuations_.at(instance)->GetState();
+    return continuations_.at(instance->id())->GetState();
   }
   std::vector<Value> ResolveState(Proc* proc) const {
-    return continuations_.at(elaboration().GetUniqueInstance(proc).value())
+    return continuations_
+        .at(elaboration().GetUniqueInstance(proc).value()->id())
         ->GetState();
   }
 
   // Updates the state values for a proc in the network.
   absl::Status SetState(ProcInstance* instance, std::vector<Value> v) {
-    return continuations_.at(instance)->SetState(std::move(v));
+    return continuations_.at(instance->id())->SetState(std::move(v));
   }
   absl::Status SetState(Proc* proc, std::vector<Value> v) {
-    return continuations_.at(elaboration().GetUniqueInstance(proc).value())
+    return continuations_
+        .at(elaboration().GetUniqueInstance(proc).value()->id())
         ->SetState(std::move(v));
   }
 
@@ -112,10 +116,11 @@ class ProcRuntime {
   // Returns the events for each proc in the network.
   const InterpreterEvents& GetInterpreterEvents(
       const ProcInstance* instance) const {
-    return continuations_.at(instance)->GetEvents();
+    return continuations_.at(instance->id())->GetEvents();
   }
   const InterpreterEvents& GetInterpreterEvents(Proc* proc) const {
-    return continuations_.at(elaboration().GetUniqueInstance(proc).value())
+    return continuations_
+        .at(elaboration().GetUniqueInstance(proc).value()->id())
         ->GetEvents();
   }
 
@@ -142,6 +147,17 @@ class ProcRuntime {
   // could cause crashes.
   bool SupportsObservers() const;
 
+  // Starts gathering per proc instance and per channel instance statistics
+  // (activations, ticks blocked on receives, channel occupancy and throughput)
+  // over all subsequent ticks. If `record_timeline` is true the state of the
+  // network at the end of every tick is also recorded. Restarts the profile if
+  // profiling is already enabled.
+  void EnableProfiling(bool record_timeline = false);
+
+  // Returns the statistics gathered since profiling was enabled. Returns an
+  // error if profiling is not enabled.
+  absl::StatusOr<ProcNetworkProfileProto> GetProfile() const;
+
  protected:
   friend class ChannelTraceRecorder;
   void AddTraceMessage(TraceMessage message);
@@ -155,19 +171,26 @@ class ProcRuntime {
     bool progress_made_on_io_procs;
 
     std::vector<ChannelInstance*> blocked_channel_instances;
+
+    // The proc instances which are blocked on a receive at the end of the tick.
+    std::vector<ProcInstance*> blocked_proc_instances;
   };
   virtual absl::StatusOr<NetworkTickResult> TickInternal() = 0;
 
+  // Calls TickInternal and records the result in the profile, if enabled.
+  absl::StatusOr<NetworkTickResult> ProfiledTickInternal();
+
   std::unique_ptr<ChannelQueueManager> queue_manager_;
   absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluators_;
-  absl::flat_hash_map<ProcInstance*, std::unique_ptr<ProcContinuation>>
-      continuations_;
+  // Continuations indexed by the id of the proc instance.
+  std::vector<std::unique_ptr<ProcContinuation>> continuations_;
 
   mutable absl::Mutex global_events_mutex_;
   InterpreterEvents global_events_ ABSL_GUARDED_BY(global_events_mutex_);
 
   EvaluatorOptions options_;
   std::optional<EvaluationObserver*> observer_ = std::nullopt;
+  std::unique_ptr<ProcRuntimeProfiler> profiler_;
 };
 
 }  // namespace xls
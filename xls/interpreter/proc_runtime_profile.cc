@@ -0,0 +1,193 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/proc_runtime_profile.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/channel_occupancy.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_runtime_profile.pb.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+namespace {
+
+// Returns `s` as a quoted JSON string.
+std::string JsonString(std::string_view s) {
+  std::string result = "\"";
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(&result, "\\u%04x", c);
+        } else {
+          result += c;
+        }
+    }
+  }
+  result += "\"";
+  return result;
+}
+
+}  // namespace
+
+ProcRuntimeProfiler::ProcRuntimeProfiler(ChannelQueueManager& queue_manager,
+                                         bool record_timeline)
+    : elaboration_(queue_manager.elaboration()),
+      record_timeline_(record_timeline),
+      occupancy_tracker_(ChannelOccupancyTracker::Create(
+          queue_manager, /*include_io_channels=*/true)),
+      blocked_ticks_(elaboration_.proc_instances().size(), 0) {}
+
+void ProcRuntimeProfiler::RecordTick(
+    absl::Span<ProcInstance* const> blocked_proc_instances,
+    absl::Span<ChannelInstance* const> blocked_channel_instances) {
+  occupancy_tracker_->RecordTick();
+  for (ProcInstance* instance : blocked_proc_instances) {
+    ++blocked_ticks_[instance->id()];
+  }
+  for (ChannelInstance* instance : blocked_channel_instances) {
+    ++blocked_receive_ticks_[instance];
+  }
+  if (!record_timeline_) {
+    return;
+  }
+  TickProfileProto& tick = timeline_.emplace_back();
+  for (ProcInstance* instance : blocked_proc_instances) {
+    tick.add_blocked_proc_instances(instance->id());
+  }
+  for (const auto& [_, occupancy] : occupancy_tracker_->GetOccupancies()) {
+    tick.add_channel_occupancies(occupancy.occupancy);
+  }
+}
+
+ProcNetworkProfileProto ProcRuntimeProfiler::ToProto() const {
+  ProcNetworkProfileProto proto;
+  int64_t ticks = occupancy_tracker_->ticks();
+  proto.set_ticks(ticks);
+  for (ProcInstance* instance : elaboration_.proc_instances()) {
+    ProcInstanceProfileProto* proc_proto = proto.add_proc_instances();
+    proc_proto->set_name(instance->GetName());
+    proc_proto->set_activations(ticks - blocked_ticks_[instance->id()]);
+    proc_proto->set_blocked_ticks(blocked_ticks_[instance->id()]);
+  }
+  for (const auto& [instance, occupancy] :
+       occupancy_tracker_->GetOccupancies()) {
+    ChannelInstanceProfileProto* channel_proto = proto.add_channel_instances();
+    channel_proto->set_name(instance->ToString());
+    channel_proto->set_writes(occupancy.writes);
+    channel_proto->set_reads(occupancy.reads);
+    channel_proto->set_max_occupancy(occupancy.max_occupancy);
+    channel_proto->set_backlogged_ticks(occupancy.backlogged_ticks);
+    auto it = blocked_receive_ticks_.find(instance);
+    channel_proto->set_blocked_receive_ticks(
+        it == blocked_receive_ticks_.end() ? 0 : it->second);
+    channel_proto->set_full_events(occupancy.full_events);
+    if (ticks > 0) {
+      channel_proto->set_average_occupancy(
+          static_cast<double>(occupancy.occupancy_tick_sum) / ticks);
+      channel_proto->set_throughput(static_cast<double>(occupancy.writes) /
+                                    ticks);
+    }
+  }
+  for (const TickProfileProto& tick : timeline_) {
+    *proto.add_timeline() = tick;
+  }
+  return proto;
+}
+
+std::string ProcNetworkProfileToChromeTrace(
+    const ProcNetworkProfileProto& profile) {
+  std::vector<std::string> events;
+  events.push_back(
+      "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+      "\"args\":{\"name\":\"procs\"}}");
+  events.push_back(
+      "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+      "\"args\":{\"name\":\"channels\"}}");
+  for (int64_t i = 0; i < profile.proc_instances_size(); ++i) {
+    events.push_back(absl::StrFormat(
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,"
+        "\"args\":{\"name\":%s}}",
+        i, JsonString(profile.proc_instances(i).name())));
+  }
+
+  // Emit a complete event for every run of ticks in which a proc instance was
+  // continuously active or continuously blocked.
+  const int64_t tick_count = profile.timeline_size();
+  const int64_t proc_count = profile.proc_instances_size();
+  std::vector<bool> blocked(proc_count, false);
+  std::vector<int64_t> run_start(proc_count, 0);
+  auto end_run = [&](int64_t proc, int64_t tick) {
+    events.push_back(absl::StrFormat(
+        "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%d,\"dur\":%d,\"pid\":0,"
+        "\"tid\":%d}",
+        blocked[proc] ? "blocked" : "active", run_start[proc],
+        tick - run_start[proc], proc));
+    run_start[proc] = tick;
+  };
+  for (int64_t tick = 0; tick < tick_count; ++tick) {
+    std::vector<bool> blocked_now(proc_count, false);
+    for (int64_t proc : profile.timeline(tick).blocked_proc_instances()) {
+      blocked_now[proc] = true;
+    }
+    for (int64_t proc = 0; proc < proc_count; ++proc) {
+      if (tick > 0 && blocked_now[proc] != blocked[proc]) {
+        end_run(proc, tick);
+      }
+      blocked[proc] = blocked_now[proc];
+    }
+  }
+  if (tick_count > 0) {
+    for (int64_t proc = 0; proc < proc_count; ++proc) {
+      end_run(proc, tick_count);
+    }
+  }
+
+  // Emit a counter event whenever the occupancy of a channel instance changes.
+  for (int64_t channel = 0; channel < profile.channel_instances_size();
+       ++channel) {
+    std::string name = JsonString(profile.channel_instances(channel).name());
+    for (int64_t tick = 0; tick < tick_count; ++tick) {
+      int64_t occupancy = profile.timeline(tick).channel_occupancies(channel);
+      if (tick > 0 &&
+          occupancy ==
+              profile.timeline(tick - 1).channel_occupancies(channel)) {
+        continue;
+      }
+      events.push_back(absl::StrFormat(
+          "{\"name\":%s,\"ph\":\"C\",\"ts\":%d,\"pid\":1,"
+          "\"args\":{\"occupancy\":%d}}",
+          name, tick, occupancy));
+    }
+  }
+  return absl::StrCat("{\"traceEvents\":[\n", absl::StrJoin(events, ",\n"),
+                      "\n]}\n");
+}
+
+}  // namespace xls
@@ -0,0 +1,72 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PROC_RUNTIME_PROFILE_H_
+#define XLS_INTERPRETER_PROC_RUNTIME_PROFILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/channel_occupancy.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_runtime_profile.pb.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+// Gathers per proc instance and per channel instance statistics over the ticks
+// of a proc network: activations, ticks blocked on receives, channel occupancy
+// and throughput. Optionally records a per-tick timeline. Must be attached
+// before the first tick to be profiled.
+class ProcRuntimeProfiler {
+ public:
+  ProcRuntimeProfiler(ChannelQueueManager& queue_manager,
+                      bool record_timeline);
+
+  // Records the end of a tick of the proc network. `blocked_proc_instances`
+  // and `blocked_channel_instances` are the proc instances blocked on a receive
+  // and the channel instances they are blocked on. All other proc instances
+  // completed an activation during the tick.
+  void RecordTick(absl::Span<ProcInstance* const> blocked_proc_instances,
+                  absl::Span<ChannelInstance* const> blocked_channel_instances);
+
+  ProcNetworkProfileProto ToProto() const;
+
+ private:
+  const ProcElaboration& elaboration_;
+  bool record_timeline_;
+  std::unique_ptr<ChannelOccupancyTracker> occupancy_tracker_;
+
+  // Indexed by proc instance id.
+  std::vector<int64_t> blocked_ticks_;
+  absl::flat_hash_map<ChannelInstance*, int64_t> blocked_receive_ticks_;
+  std::vector<TickProfileProto> timeline_;
+};
+
+// Returns the timeline of `profile` as a JSON document in the Chrome trace
+// event format, which can be loaded into chrome://tracing or Perfetto. Each
+// proc instance is a thread with a complete event for each run of consecutive
+// ticks in which it was active or blocked, and each channel instance is a
+// counter tracking its occupancy. One tick is shown as one microsecond. Only
+// the names of the instances are emitted if the profile has no timeline.
+std::string ProcNetworkProfileToChromeTrace(
+    const ProcNetworkProfileProto& profile);
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PROC_RUNTIME_PROFILE_H_
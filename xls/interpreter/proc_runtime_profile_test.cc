@@ -0,0 +1,164 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/proc_runtime_profile.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_profile.pb.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::DoubleEq;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+class ProcRuntimeProfileTest : public IrTestBase {
+ protected:
+  // Creates a network in which a producer sends a counter on `internal` every
+  // tick and a consumer receives from `internal` and then from `in`, and sends
+  // the sum on `out`.
+  void CreateNetwork(Package* p) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * internal,
+        p->CreateStreamingChannel("internal", ChannelOps::kSendReceive,
+                                  p->GetBitsType(32)));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * in, p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                                p->GetBitsType(32)));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                                 p->GetBitsType(32)));
+    {
+      ProcBuilder pb("producer", p);
+      BValue st = pb.StateElement("st", Value(UBits(0, 32)));
+      pb.Send(internal, pb.Literal(Value::Token()), st);
+      XLS_ASSERT_OK(pb.Build({pb.Add(st, pb.Literal(UBits(1, 32)))}).status());
+    }
+    {
+      ProcBuilder pb("consumer", p);
+      BValue a = pb.Receive(internal, pb.Literal(Value::Token()));
+      BValue b = pb.Receive(in, pb.TupleIndex(a, 0));
+      pb.Send(out, pb.TupleIndex(b, 0),
+              pb.Add(pb.TupleIndex(a, 1), pb.TupleIndex(b, 1)));
+      XLS_ASSERT_OK(pb.Build().status());
+    }
+  }
+};
+
+TEST_F(ProcRuntimeProfileTest, ProfileNotEnabled) {
+  auto p = CreatePackage();
+  CreateNetwork(p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> runtime,
+                           CreateInterpreterSerialProcRuntime(p.get()));
+  EXPECT_THAT(runtime->GetProfile(),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(ProcRuntimeProfileTest, BlockedConsumer) {
+  auto p = CreatePackage();
+  CreateNetwork(p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> runtime,
+                           CreateInterpreterSerialProcRuntime(p.get()));
+  runtime->EnableProfiling(/*record_timeline=*/true);
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in_queue,
+                           runtime->queue_manager().GetQueueByName("in"));
+  XLS_ASSERT_OK(in_queue->WriteValues({Value(UBits(1, 32)),
+                                       Value(UBits(2, 32))}));
+  // The consumer blocks on `in` in the last two ticks.
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(ProcNetworkProfileProto profile,
+                           runtime->GetProfile());
+  EXPECT_EQ(profile.ticks(), 4);
+
+  ASSERT_EQ(profile.proc_instances_size(), 2);
+  const ProcInstanceProfileProto& producer = profile.proc_instances(0);
+  EXPECT_EQ(producer.name(), "producer");
+  EXPECT_EQ(producer.activations(), 4);
+  EXPECT_EQ(producer.blocked_ticks(), 0);
+  const ProcInstanceProfileProto& consumer = profile.proc_instances(1);
+  EXPECT_EQ(consumer.name(), "consumer");
+  EXPECT_EQ(consumer.activations(), 2);
+  EXPECT_EQ(consumer.blocked_ticks(), 2);
+
+  ASSERT_EQ(profile.channel_instances_size(), 3);
+  const ChannelInstanceProfileProto& internal = profile.channel_instances(0);
+  EXPECT_EQ(internal.writes(), 4);
+  EXPECT_EQ(internal.reads(), 3);
+  EXPECT_EQ(internal.max_occupancy(), 1);
+  EXPECT_EQ(internal.backlogged_ticks(), 1);
+  EXPECT_THAT(internal.average_occupancy(), DoubleEq(0.25));
+  EXPECT_EQ(internal.blocked_receive_ticks(), 0);
+  const ChannelInstanceProfileProto& in = profile.channel_instances(1);
+  EXPECT_EQ(in.writes(), 2);
+  EXPECT_EQ(in.reads(), 2);
+  EXPECT_EQ(in.max_occupancy(), 2);
+  EXPECT_EQ(in.blocked_receive_ticks(), 2);
+  const ChannelInstanceProfileProto& out = profile.channel_instances(2);
+  EXPECT_EQ(out.writes(), 2);
+  EXPECT_THAT(out.throughput(), DoubleEq(0.5));
+
+  ASSERT_EQ(profile.timeline_size(), 4);
+  EXPECT_THAT(profile.timeline(0).blocked_proc_instances(), IsEmpty());
+  EXPECT_THAT(profile.timeline(3).blocked_proc_instances(), ElementsAre(1));
+  EXPECT_THAT(profile.timeline(3).channel_occupancies(),
+              ElementsAre(1, 0, 2));
+
+  std::string trace = ProcNetworkProfileToChromeTrace(profile);
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"blocked\",\"ph\":\"X\",\"ts\":2,"
+                               "\"dur\":2,\"pid\":0,\"tid\":1"));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"active\",\"ph\":\"X\",\"ts\":0,"
+                               "\"dur\":4,\"pid\":0,\"tid\":0"));
+}
+
+TEST_F(ProcRuntimeProfileTest, NoTimeline) {
+  auto p = CreatePackage();
+  CreateNetwork(p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> runtime,
+                           CreateInterpreterSerialProcRuntime(p.get()));
+  runtime->EnableProfiling();
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK_AND_ASSIGN(ProcNetworkProfileProto profile,
+                           runtime->GetProfile());
+  EXPECT_EQ(profile.ticks(), 1);
+  EXPECT_THAT(profile.timeline(), IsEmpty());
+  EXPECT_THAT(ProcNetworkProfileToChromeTrace(profile),
+              HasSubstr("\"thread_name\""));
+}
+
+}  // namespace
+}  // namespace xls
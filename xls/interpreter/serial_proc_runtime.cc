@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
@@ -29,11 +30,61 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/channel.h"
 #include "xls/ir/events.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
 
 namespace xls {
+namespace {
+
+// Returns the channel instances which connect exactly one sending proc
+// instance to a different, single receiving proc instance. Returns an empty set
+// if the order in which procs run can affect the results of the network, i.e.,
+// if there are non-blocking receives or single-value channels.
+absl::StatusOr<absl::flat_hash_set<ChannelInstance*>> GetFusableChannels(
+    const ProcElaboration& elaboration) {
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      senders;
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      receivers;
+  for (ProcInstance* instance : elaboration.proc_instances()) {
+    for (Node* node : instance->proc()->nodes()) {
+      if (!node->Is<Send>() && !node->Is<Receive>()) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
+                           instance->GetChannelInstance(
+                               node->As<ChannelNode>()->channel_name()));
+      if (channel_instance->channel->kind() == ChannelKind::kSingleValue) {
+        return absl::flat_hash_set<ChannelInstance*>();
+      }
+      if (node->Is<Send>()) {
+        senders[channel_instance].insert(instance);
+        continue;
+      }
+      if (!node->As<Receive>()->is_blocking()) {
+        return absl::flat_hash_set<ChannelInstance*>();
+      }
+      receivers[channel_instance].insert(instance);
+    }
+  }
+  absl::flat_hash_set<ChannelInstance*> fusable;
+  for (const auto& [channel_instance, sending_instances] : senders) {
+    auto it = receivers.find(channel_instance);
+    if (sending_instances.size() == 1 && it != receivers.end() &&
+        it->second.size() == 1 &&
+        *it->second.begin() != *sending_instances.begin()) {
+      fusable.insert(channel_instance);
+    }
+  }
+  return fusable;
+}
+
+}  // namespace
 
 /* static */ absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
 SerialProcRuntime::Create(
@@ -55,8 +106,14 @@ SerialProcRuntime::Create(
   XLS_RET_CHECK_EQ(evaluator_map.size(),
                    queue_manager->elaboration().procs().size())
       << "More evaluators than procs given.";
+  absl::flat_hash_set<ChannelInstance*> fused_channels;
+  if (options.fuse_proc_chains()) {
+    XLS_ASSIGN_OR_RETURN(fused_channels,
+                         GetFusableChannels(queue_manager->elaboration()));
+  }
   auto network_interpreter = absl::WrapUnique(new SerialProcRuntime(
       std::move(evaluator_map), std::move(queue_manager), options));
+  network_interpreter->fused_channels_ = std::move(fused_channels);
   return std::move(network_interpreter);
 }
 
@@ -82,7 +139,7 @@ SerialProcRuntime::TickInternal() {
     ready_instances.push_back(
         QueueElement{.instance = instance,
                      .evaluator = evaluators_.at(instance->proc()).get(),
-                     .continuation = continuations_.at(instance).get()});
+                     .continuation = continuations_[instance->id()].get()});
   }
 
   bool progress_made = false;
@@ -105,6 +162,22 @@ SerialProcRuntime::TickInternal() {
         (tick_result.progress_made && element.evaluator->ProcHasIoOperations());
     if (tick_result.execution_state == TickExecutionState::kSentOnChannel) {
       ChannelInstance* channel_instance = tick_result.channel_instance.value();
+      if (blocked_instances.contains(channel_instance) &&
+          fused_channels_.contains(channel_instance)) {
+        // Run the receiver immediately and resume the sender once the receiver
+        // blocks or completes.
+        VLOG(3) << absl::StreamFormat(
+            "Unblocking proc instance `%s` and running it next",
+            blocked_instances.at(channel_instance)->GetName());
+        ProcInstance* instance = blocked_instances.at(channel_instance);
+        ready_instances.push_front(element);
+        ready_instances.push_front(
+            QueueElement{.instance = instance,
+                         .evaluator = evaluators_.at(instance->proc()).get(),
+                         .continuation = continuations_[instance->id()].get()});
+        blocked_instances.erase(channel_instance);
+        continue;
+      }
       if (blocked_instances.contains(channel_instance)) {
         VLOG(3) << absl::StreamFormat(
             "Unblocking proc instance `%s` and adding to ready list",
@@ -113,7 +186,7 @@ SerialProcRuntime::TickInternal() {
         ready_instances.push_back(
             QueueElement{.instance = instance,
                          .evaluator = evaluators_.at(instance->proc()).get(),
-                         .continuation = continuations_.at(instance).get()});
+                         .continuation = continuations_[instance->id()].get()});
         blocked_instances.erase(channel_instance);
       }
       // This proc instance can go back on the ready queue.
@@ -127,19 +200,19 @@ SerialProcRuntime::TickInternal() {
       blocked_instances[channel_instance] = element.instance;
     }
   }
-  auto get_blocked_channel_instances = [&]() {
-    std::vector<ChannelInstance*> instances;
-    for (ChannelInstance* instance : elaboration().channel_instances()) {
-      if (blocked_instances.contains(instance)) {
-        instances.push_back(instance);
-      }
+  std::vector<ChannelInstance*> blocked_channel_instances;
+  std::vector<ProcInstance*> blocked_proc_instances;
+  for (ChannelInstance* instance : elaboration().channel_instances()) {
+    if (blocked_instances.contains(instance)) {
+      blocked_channel_instances.push_back(instance);
+      blocked_proc_instances.push_back(blocked_instances.at(instance));
     }
-    return instances;
-  };
+  }
   return NetworkTickResult{
       .progress_made = progress_made,
       .progress_made_on_io_procs = progress_made_on_io_procs,
-      .blocked_channel_instances = get_blocked_channel_instances(),
+      .blocked_channel_instances = std::move(blocked_channel_instances),
+      .blocked_proc_instances = std::move(blocked_proc_instances),
   };
 }
 
@@ -20,12 +20,14 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_runtime.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
 
 namespace xls {
 
@@ -49,6 +51,10 @@ class SerialProcRuntime : public ProcRuntime {
       : ProcRuntime(std::move(evaluators), std::move(queue_manager), options) {}
 
   absl::StatusOr<SerialProcRuntime::NetworkTickResult> TickInternal() override;
+
+  // Channel instances whose receiver is run immediately after the sender
+  // writes to them (see EvaluatorOptions::fuse_proc_chains).
+  absl::flat_hash_set<ChannelInstance*> fused_channels_;
 };
 
 }  // namespace xls
@@ -177,6 +177,59 @@ INSTANTIATE_TEST_SUITE_P(
               return CreateJitSerialProcRuntime(top, options).value();
             },
             /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "jit_concurrent_compile",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         package,
+                         EvaluatorOptions(options).set_jit_compile_threads(4))
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         top,
+                         EvaluatorOptions(options).set_jit_compile_threads(4))
+                  .value();
+            },
+            /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "jit_lazy",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         package,
+                         EvaluatorOptions(options).set_lazy_jit_compilation(
+                             true))
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         top,
+                         EvaluatorOptions(options).set_lazy_jit_compilation(
+                             true))
+                  .value();
+            },
+            /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "jit_fused",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         package,
+                         EvaluatorOptions(options).set_fuse_proc_chains(true))
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         top,
+                         EvaluatorOptions(options).set_fuse_proc_chains(true))
+                  .value();
+            },
+            /*supports_observers=*/true),
         ProcRuntimeTestParam(
             "mixed",
             [](Package* package, const EvaluatorOptions& options)
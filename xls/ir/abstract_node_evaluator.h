@@ -19,12 +19,12 @@
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -38,11 +38,11 @@
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/lsb_or_msb.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
-#include "xls/ir/value_utils.h"
 
 namespace xls {
 
@@ -222,16 +222,15 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
                             elements.begin(), elements.end())));
   }
   absl::Status HandleLiteral(Literal* literal) override {
-    XLS_ASSIGN_OR_RETURN(
-        LeafTypeTree<Value> v_ltt,
-        ValueToLeafTypeTree(literal->value(), literal->GetType()));
+    XLS_ASSIGN_OR_RETURN(std::shared_ptr<const LeafTypeTree<Value>> v_ltt,
+                         literal->GetValueTree());
     XLS_RET_CHECK(absl::c_all_of(
-        v_ltt.elements(),
+        v_ltt->elements(),
         [](const Value& v) { return v.IsBits() || v.IsToken(); }))
         << literal << " has non-bits and non-token leaf.";
     LeafTypeTree<LeafValueT> result =
         leaf_type_tree::Map<typename AbstractEvaluatorT::Vector, Value>(
-            v_ltt.AsView(), [&](const Value& value) {
+            v_ltt->AsView(), [&](const Value& value) {
               if (value.IsToken()) {
                 return evaluator_.BitsToVector(Bits());
               }
@@ -558,11 +557,11 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
     return values_.at(n).AsView();
   }
 
-  const absl::flat_hash_map<Node*, LeafTypeTree<LeafValueT>>& values() const& {
+  const NodeMap<LeafTypeTree<LeafValueT>>& values() const& {
     return values_;
   }
 
-  absl::flat_hash_map<Node*, LeafTypeTree<LeafValueT>>&& values() && {
+  NodeMap<LeafTypeTree<LeafValueT>>&& values() && {
     return std::move(values_);
   }
 
@@ -651,7 +650,7 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
   // represent values which are considered unconstrained. This uses unique_ptr
   // to ensure that the internal pointers do not move since we may want to hold
   // views to them.
-  absl::flat_hash_map<Node*, LeafTypeTree<LeafValueT>> values_;
+  NodeMap<LeafTypeTree<LeafValueT>> values_;
 };
 
 // An abstract evaluator for XLS Nodes. The function takes an AbstractEvaluator
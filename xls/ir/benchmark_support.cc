@@ -14,17 +14,31 @@
 
 #include "xls/ir/benchmark_support.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <random>
+#include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace benchmark_support {
@@ -170,5 +184,186 @@ absl::StatusOr<BValue> GenerateFullyConnectedLayerGraph(
                            fb, absl::MakeSpan(current_layer)));
   return return_value;
 }
+
+namespace {
+
+// Returns `values` combined pairwise with xor until a single value remains.
+BValue XorReduceTree(BuilderBase& builder, std::vector<BValue> values) {
+  while (values.size() > 1) {
+    std::vector<BValue> next;
+    next.reserve((values.size() + 1) / 2);
+    for (int64_t i = 0; i + 1 < values.size(); i += 2) {
+      next.push_back(builder.Xor(values[i], values[i + 1]));
+    }
+    if (values.size() % 2 == 1) {
+      next.push_back(values.back());
+    }
+    values = std::move(next);
+  }
+  return values.front();
+}
+
+absl::StatusOr<BValue> SyntheticNode(BuilderBase& builder, Op op,
+                                     int64_t bit_width, BValue a, BValue b,
+                                     BValue c) {
+  switch (op) {
+    case Op::kAdd:
+    case Op::kSub:
+      return builder.AddBinOp(op, a, b);
+    case Op::kAnd:
+    case Op::kOr:
+    case Op::kXor:
+      return builder.AddNaryOp(op, {a, b});
+    case Op::kNot:
+      return builder.Not(a);
+    case Op::kNeg:
+      return builder.Negate(a);
+    case Op::kUMul:
+      return builder.UMul(a, b, bit_width);
+    case Op::kShll:
+    case Op::kShrl: {
+      // Shift by a narrow amount so the result is not usually zero.
+      BValue amount =
+          builder.BitSlice(b, 0, Bits::MinBitCountUnsigned(bit_width - 1));
+      return op == Op::kShll ? builder.Shll(a, amount)
+                             : builder.Shrl(a, amount);
+    }
+    case Op::kSel:
+      return builder.Select(builder.BitSlice(c, 0, 1), /*on_true=*/b,
+                            /*on_false=*/a);
+    default:
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Op %s is not supported in synthetic designs", OpToString(op)));
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<BValue> GenerateSyntheticLogic(
+    BuilderBase& builder, absl::Span<const BValue> inputs, int64_t node_count,
+    const SyntheticDesignOptions& options, std::mt19937_64& rng) {
+  XLS_RET_CHECK(!inputs.empty());
+  XLS_RET_CHECK_GE(options.depth, 1);
+  XLS_RET_CHECK_GE(options.operand_levels, 1);
+  XLS_RET_CHECK(!options.op_mix.empty());
+  std::vector<int64_t> weights;
+  for (const auto& [op, weight] : options.op_mix) {
+    weights.push_back(weight);
+  }
+  std::discrete_distribution<int64_t> pick_op(weights.begin(), weights.end());
+
+  int64_t level_width = std::max<int64_t>(
+      1, (node_count + options.depth - 1) / options.depth);
+  std::vector<std::vector<BValue>> levels;
+  levels.reserve(options.depth + 1);
+  levels.emplace_back(inputs.begin(), inputs.end());
+  for (int64_t level = 1; level <= options.depth; ++level) {
+    int64_t first_level = std::max<int64_t>(0, level - options.operand_levels);
+    std::uniform_int_distribution<int64_t> pick_level(first_level, level - 1);
+    auto pick_operand = [&]() {
+      const std::vector<BValue>& source = levels[pick_level(rng)];
+      return source[std::uniform_int_distribution<int64_t>(
+          0, source.size() - 1)(rng)];
+    };
+    const std::vector<BValue>& previous = levels.back();
+    std::vector<BValue> current;
+    current.reserve(level_width);
+    for (int64_t i = 0; i < level_width; ++i) {
+      BValue first = previous[i % previous.size()];
+      XLS_ASSIGN_OR_RETURN(
+          BValue node,
+          SyntheticNode(builder, options.op_mix[pick_op(rng)].first,
+                        options.bit_width, first, pick_operand(),
+                        pick_operand()));
+      current.push_back(node);
+    }
+    levels.push_back(std::move(current));
+  }
+  return XorReduceTree(builder, std::move(levels.back()));
+}
+
+absl::StatusOr<FunctionBase*> GenerateSyntheticDesign(
+    Package* package, const SyntheticDesignOptions& options) {
+  XLS_RET_CHECK_GE(options.proc_count, 0);
+  std::mt19937_64 rng(options.seed);
+  Type* type = package->GetBitsType(options.bit_width);
+
+  if (options.proc_count == 0) {
+    FunctionBuilder fb("synthetic", package);
+    std::vector<BValue> params;
+    for (int64_t i = 0; i < 8; ++i) {
+      params.push_back(fb.Param(absl::StrFormat("x%d", i), type));
+    }
+    XLS_ASSIGN_OR_RETURN(BValue result,
+                         GenerateSyntheticLogic(fb, params, options.node_count,
+                                                options, rng));
+    XLS_ASSIGN_OR_RETURN(Function * f, fb.BuildWithReturnValue(result));
+    XLS_RETURN_IF_ERROR(package->SetTop(f));
+    return f;
+  }
+
+  // Channel `i` feeds proc `i` and channel `i + 1` is driven by it.
+  const bool chained =
+      options.channel_topology != ChannelTopology::kIndependent;
+  std::vector<Channel*> inputs;
+  std::vector<Channel*> outputs;
+  for (int64_t i = 0; i < options.proc_count; ++i) {
+    bool external_input = !chained || i == 0;
+    if (external_input) {
+      XLS_ASSIGN_OR_RETURN(
+          Channel * in,
+          package->CreateStreamingChannel(absl::StrFormat("in%d", i),
+                                          ChannelOps::kReceiveOnly, type));
+      inputs.push_back(in);
+    } else {
+      inputs.push_back(outputs.back());
+    }
+    bool external_output = !chained || i == options.proc_count - 1;
+    XLS_ASSIGN_OR_RETURN(
+        Channel * out,
+        package->CreateStreamingChannel(
+            absl::StrFormat(external_output ? "out%d" : "ch%d", i),
+            external_output ? ChannelOps::kSendOnly : ChannelOps::kSendReceive,
+            type));
+    outputs.push_back(out);
+  }
+  Channel* ring = nullptr;
+  if (options.channel_topology == ChannelTopology::kRing) {
+    XLS_ASSIGN_OR_RETURN(
+        ring, package->CreateStreamingChannel("ring", ChannelOps::kSendReceive,
+                                              type));
+  }
+
+  int64_t nodes_per_proc =
+      std::max<int64_t>(1, options.node_count / options.proc_count);
+  Proc* first = nullptr;
+  for (int64_t i = 0; i < options.proc_count; ++i) {
+    ProcBuilder pb(absl::StrFormat("synthetic_proc%d", i), package);
+    BValue token = pb.Literal(Value::Token());
+    BValue state = pb.StateElement("state", Value(UBits(0, options.bit_width)));
+    BValue receive = pb.Receive(inputs[i], token);
+    token = pb.TupleIndex(receive, 0);
+    std::vector<BValue> logic_inputs = {pb.TupleIndex(receive, 1), state};
+    if (ring != nullptr && i == 0) {
+      BValue ring_receive = pb.ReceiveNonBlocking(ring, token);
+      token = pb.TupleIndex(ring_receive, 0);
+      logic_inputs.push_back(pb.TupleIndex(ring_receive, 1));
+    }
+    XLS_ASSIGN_OR_RETURN(BValue result,
+                         GenerateSyntheticLogic(pb, logic_inputs,
+                                                nodes_per_proc, options, rng));
+    token = pb.Send(outputs[i], token, result);
+    if (ring != nullptr && i == options.proc_count - 1) {
+      pb.Send(ring, token, result);
+    }
+    pb.Next(state, result);
+    XLS_ASSIGN_OR_RETURN(Proc * proc, pb.Build());
+    if (first == nullptr) {
+      first = proc;
+    }
+  }
+  XLS_RETURN_IF_ERROR(package->SetTop(first));
+  return first;
+}
 }  // namespace benchmark_support
 }  // namespace xls
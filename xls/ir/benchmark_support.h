@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <optional>
+#include <random>
 #include <utility>
 #include <vector>
 
@@ -29,6 +30,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/node.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 
 namespace xls {
@@ -307,6 +309,67 @@ absl::StatusOr<BValue> ChainReduce(
     const strategy::NaryNode& interior_node_strategy,
     const strategy::NullaryNode& leaf_strategy, BValue previous_layer);
 
+// The channels connecting the procs of a synthetic design.
+enum class ChannelTopology : int8_t {
+  // Procs form a chain: an input channel feeds the first proc, each proc feeds
+  // the next and the last drives an output channel.
+  kPipeline,
+  // As kPipeline, with an extra channel from the last proc back to the first
+  // which the first proc reads non-blocking.
+  kRing,
+  // Every proc has its own input and output channel.
+  kIndependent,
+};
+
+// Parameters of a synthetic design generated by GenerateSyntheticDesign.
+//
+// The logic is organized in `depth` levels of roughly equal size. Each node
+// takes operands from the previous `operand_levels` levels, with its first
+// operand chosen so that every node of the previous level has at least one
+// user.
+struct SyntheticDesignOptions {
+  // Approximate total number of nodes, across all procs.
+  int64_t node_count = 10'000;
+
+  // Number of levels of logic.
+  int64_t depth = 64;
+
+  // Operands are drawn from this many preceding levels. Larger values give
+  // long edges spanning many levels (and pipeline stages) and increase the
+  // fan-out of each node.
+  int64_t operand_levels = 2;
+
+  // Relative weights of the operations used for interior nodes. Supported
+  // ops: kAdd, kSub, kAnd, kOr, kXor, kNot, kNeg, kUMul, kShll, kShrl, kSel.
+  std::vector<std::pair<Op, int64_t>> op_mix = {
+      {Op::kAdd, 4}, {Op::kXor, 2},  {Op::kAnd, 2},  {Op::kOr, 1},
+      {Op::kSub, 1}, {Op::kShll, 1}, {Op::kUMul, 1}, {Op::kSel, 2}};
+
+  // Bit width of every value.
+  int64_t bit_width = 32;
+
+  // Number of procs. If zero a single function is generated instead.
+  int64_t proc_count = 0;
+
+  ChannelTopology channel_topology = ChannelTopology::kPipeline;
+
+  // Seed of the random choices; the same options always give the same design.
+  uint64_t seed = 0;
+};
+
+// Generates a synthetic design of configurable size and shape in `package`
+// and sets it as the top. Returns the top function or the first proc. Unlike
+// the generators above this is meant for measuring how a stage scales with
+// design size, so the logic does not fold away under optimization.
+absl::StatusOr<FunctionBase*> GenerateSyntheticDesign(
+    Package* package, const SyntheticDesignOptions& options);
+
+// Adds synthetic logic of about `node_count` nodes with the shape described by
+// `options` on top of `inputs` and returns its single result.
+absl::StatusOr<BValue> GenerateSyntheticLogic(
+    BuilderBase& builder, absl::Span<const BValue> inputs, int64_t node_count,
+    const SyntheticDesignOptions& options, std::mt19937_64& rng);
+
 }  // namespace benchmark_support
 }  // namespace xls
 
@@ -15,10 +15,12 @@
 #include "xls/ir/benchmark_support.h"
 
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
@@ -27,7 +29,9 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/verifier.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -36,6 +40,8 @@ namespace benchmark_support {
 
 namespace {
 using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
 using ::testing::Not;
 
 MATCHER_P(SameNode, bn, "") { return bn.node() == arg.node(); }
@@ -249,6 +255,61 @@ TEST(Chain, Reduce) {
                          m::Literal(UBits(42, 8)), m::Literal(UBits(42, 8))},
                         m::Literal(UBits(42, 8))));
 }
+TEST(SyntheticDesign, Function) {
+  Package p("p");
+  SyntheticDesignOptions options;
+  options.node_count = 1000;
+  options.depth = 10;
+  XLS_ASSERT_OK_AND_ASSIGN(FunctionBase * top,
+                           GenerateSyntheticDesign(&p, options));
+  EXPECT_TRUE(top->IsFunction());
+  EXPECT_EQ(p.GetTop(), top);
+  EXPECT_GE(top->node_count(), options.node_count);
+  EXPECT_LE(top->node_count(), 3 * options.node_count);
+  XLS_EXPECT_OK(VerifyPackage(&p));
+}
+
+TEST(SyntheticDesign, Deterministic) {
+  SyntheticDesignOptions options;
+  options.node_count = 500;
+  Package p1("p");
+  Package p2("p");
+  XLS_ASSERT_OK(GenerateSyntheticDesign(&p1, options).status());
+  XLS_ASSERT_OK(GenerateSyntheticDesign(&p2, options).status());
+  EXPECT_EQ(p1.DumpIr(), p2.DumpIr());
+}
+
+TEST(SyntheticDesign, ProcTopologies) {
+  for (ChannelTopology topology :
+       {ChannelTopology::kPipeline, ChannelTopology::kRing,
+        ChannelTopology::kIndependent}) {
+    Package p("p");
+    SyntheticDesignOptions options;
+    options.node_count = 400;
+    options.depth = 4;
+    options.proc_count = 4;
+    options.channel_topology = topology;
+    XLS_ASSERT_OK_AND_ASSIGN(FunctionBase * top,
+                             GenerateSyntheticDesign(&p, options));
+    EXPECT_TRUE(top->IsProc());
+    EXPECT_EQ(p.procs().size(), 4);
+    int64_t expected_channels =
+        topology == ChannelTopology::kIndependent ? 8
+        : topology == ChannelTopology::kRing      ? 6
+                                                  : 5;
+    EXPECT_EQ(p.channels().size(), expected_channels);
+    XLS_EXPECT_OK(VerifyPackage(&p));
+  }
+}
+
+TEST(SyntheticDesign, UnsupportedOp) {
+  Package p("p");
+  SyntheticDesignOptions options;
+  options.op_mix = {{Op::kConcat, 1}};
+  EXPECT_THAT(GenerateSyntheticDesign(&p, options),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not supported")));
+}
 }  // namespace
 }  // namespace benchmark_support
 }  // namespace xls
@@ -0,0 +1,1080 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_ir.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/error_code_to_status.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/fileno.h"
+#include "xls/ir/foreign_function_data.pb.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/function.h"
+#include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/op.pb.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
+
+namespace xls {
+namespace binary_ir_internal {
+
+// Reads the primitive encodings of binary IR from a buffer. All reads return
+// an error rather than reading past the end of the buffer.
+class ByteReader {
+ public:
+  explicit ByteReader(std::string_view bytes) : bytes_(bytes) {}
+
+  bool AtEnd() const { return pos_ == bytes_.size(); }
+
+  absl::StatusOr<uint64_t> ReadVarint() {
+    uint64_t result = 0;
+    for (int64_t shift = 0; shift < 64; shift += 7) {
+      if (AtEnd()) {
+        return Truncated();
+      }
+      uint8_t byte = static_cast<uint8_t>(bytes_[pos_++]);
+      result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return result;
+      }
+    }
+    return absl::InvalidArgumentError("Malformed varint in binary IR");
+  }
+  absl::StatusOr<int64_t> ReadSignedVarint() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, ReadVarint());
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+  // Reads a varint which must be less than `limit`.
+  absl::StatusOr<int64_t> ReadIndex(int64_t limit) {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, ReadVarint());
+    if (value >= static_cast<uint64_t>(limit)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Index %d out of range [0, %d) in binary IR", value, limit));
+    }
+    return static_cast<int64_t>(value);
+  }
+  absl::StatusOr<bool> ReadBool() {
+    XLS_ASSIGN_OR_RETURN(std::string_view byte, ReadRaw(1));
+    return byte[0] != 0;
+  }
+  absl::StatusOr<std::string_view> ReadRaw(uint64_t size) {
+    if (size > bytes_.size() - pos_) {
+      return Truncated();
+    }
+    std::string_view result = bytes_.substr(pos_, size);
+    pos_ += size;
+    return result;
+  }
+  absl::StatusOr<std::string_view> ReadString() {
+    XLS_ASSIGN_OR_RETURN(uint64_t size, ReadVarint());
+    return ReadRaw(size);
+  }
+  absl::StatusOr<std::optional<std::string>> ReadOptionalString() {
+    XLS_ASSIGN_OR_RETURN(bool present, ReadBool());
+    if (!present) {
+      return std::nullopt;
+    }
+    XLS_ASSIGN_OR_RETURN(std::string_view str, ReadString());
+    return std::string(str);
+  }
+
+ private:
+  static absl::Status Truncated() {
+    return absl::InvalidArgumentError("Truncated binary IR");
+  }
+
+  std::string_view bytes_;
+  size_t pos_ = 0;
+};
+
+}  // namespace binary_ir_internal
+
+namespace {
+
+using ::xls::binary_ir_internal::ByteReader;
+
+constexpr std::string_view kMagic("\0XLSBIR", 7);
+constexpr int64_t kVersion = 1;
+
+// Tags of the entries of the type table.
+enum class TypeTag : uint8_t { kBits = 0, kTuple = 1, kArray = 2, kToken = 3 };
+
+class ByteWriter {
+ public:
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      bytes_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    bytes_.push_back(static_cast<char>(value));
+  }
+  void WriteSignedVarint(int64_t value) {
+    // Zigzag encoding so small negative values are also short.
+    WriteVarint((static_cast<uint64_t>(value) << 1) ^
+                static_cast<uint64_t>(value >> 63));
+  }
+  void WriteBool(bool value) { bytes_.push_back(value ? 1 : 0); }
+  void WriteRaw(std::string_view bytes) { bytes_.append(bytes); }
+  void WriteString(std::string_view str) {
+    WriteVarint(str.size());
+    WriteRaw(str);
+  }
+  void WriteOptionalString(const std::optional<std::string>& str) {
+    WriteBool(str.has_value());
+    if (str.has_value()) {
+      WriteString(*str);
+    }
+  }
+
+  const std::string& bytes() const { return bytes_; }
+  std::string&& Release() && { return std::move(bytes_); }
+
+ private:
+  std::string bytes_;
+};
+
+
+// Values are encoded without any framing: the structure of the value is given
+// by its type and each bits leaf is stored as ceil(width / 8) little-endian
+// bytes.
+void WriteValue(const Value& value, ByteWriter& writer) {
+  switch (value.kind()) {
+    case ValueKind::kBits: {
+      std::vector<uint8_t> bytes = value.bits().ToBytes();
+      writer.WriteRaw(std::string_view(
+          reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+      return;
+    }
+    case ValueKind::kTuple:
+    case ValueKind::kArray:
+      for (const Value& element : value.elements()) {
+        WriteValue(element, writer);
+      }
+      return;
+    case ValueKind::kToken:
+    case ValueKind::kInvalid:
+      return;
+  }
+}
+
+absl::StatusOr<Value> ReadValue(Type* type, ByteReader& reader) {
+  switch (type->kind()) {
+    case TypeKind::kBits: {
+      int64_t bit_count = type->AsBitsOrDie()->bit_count();
+      XLS_ASSIGN_OR_RETURN(std::string_view bytes,
+                           reader.ReadRaw(CeilOfRatio(bit_count, int64_t{8})));
+      return Value(Bits::FromBytes(
+          absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(bytes.data()),
+                              bytes.size()),
+          bit_count));
+    }
+    case TypeKind::kTuple: {
+      std::vector<Value> elements;
+      elements.reserve(type->AsTupleOrDie()->size());
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        XLS_ASSIGN_OR_RETURN(Value element, ReadValue(element_type, reader));
+        elements.push_back(std::move(element));
+      }
+      return Value::TupleOwned(std::move(elements));
+    }
+    case TypeKind::kArray: {
+      ArrayType* array_type = type->AsArrayOrDie();
+      std::vector<Value> elements;
+      elements.reserve(array_type->size());
+      for (int64_t i = 0; i < array_type->size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(Value element,
+                             ReadValue(array_type->element_type(), reader));
+        elements.push_back(std::move(element));
+      }
+      return Value::ArrayOwned(std::move(elements));
+    }
+    case TypeKind::kToken:
+      return Value::Token();
+  }
+  return absl::InternalError("Unknown type kind");
+}
+
+// Adds nodes with a given id, source location and name to a function.
+struct NodeMaker {
+  // `args` are the arguments of the NodeT constructor between the source
+  // location and the name.
+  template <typename NodeT, typename... Args>
+  Node* New(Args&&... args) const {
+    // Nodes take the next node id of the package on construction.
+    function->package()->set_next_node_id(id);
+    return function->AddNode(std::make_unique<NodeT>(
+        loc, std::forward<Args>(args)..., name, function));
+  }
+
+  Function* function;
+  int64_t id;
+  const SourceInfo& loc;
+  std::string_view name;
+};
+
+// Returns the nodes of `f` ordered such that every node follows its operands.
+// If the order of the nodes in `f` is already topological (the usual case) it
+// is returned unchanged. Otherwise the order is kept as close to it as
+// possible. In particular the relative order of nodes without users, which
+// breaks ties in TopoSort, is preserved so the dumped IR of a deserialized
+// function matches the original.
+std::vector<Node*> StableTopoSort(FunctionBase* f) {
+  std::vector<Node*> order;
+  order.reserve(f->node_count());
+  NodeSet visited;
+  // Stack of nodes being visited along with the index of the next operand to
+  // visit.
+  std::vector<std::pair<Node*, int64_t>> stack;
+  for (Node* root : f->nodes()) {
+    if (!visited.insert(root).second) {
+      continue;
+    }
+    stack.push_back({root, 0});
+    while (!stack.empty()) {
+      auto& [node, next_operand] = stack.back();
+      if (next_operand == node->operand_count()) {
+        order.push_back(node);
+        stack.pop_back();
+        continue;
+      }
+      Node* operand = node->operand(next_operand++);
+      if (visited.insert(operand).second) {
+        stack.push_back({operand, 0});
+      }
+    }
+  }
+  return order;
+}
+
+class BinaryIrWriter {
+ public:
+  explicit BinaryIrWriter(Package* package) : package_(package) {}
+
+  absl::StatusOr<std::string> Write();
+
+ private:
+  // Returns the index of `type` in the type table, adding it (and its element
+  // types) if necessary.
+  int64_t TypeIndex(Type* type);
+  // Returns the index of `value` in the literal pool, adding it if necessary.
+  int64_t LiteralIndex(const Value& value, Type* type);
+
+  absl::StatusOr<std::string> EncodeFunction(Function* function);
+  absl::Status EncodeNode(Node* node, int64_t node_index,
+                          const NodeMap<int64_t>& node_indices,
+                          ByteWriter& writer);
+
+  Package* package_;
+  ByteWriter types_;
+  absl::flat_hash_map<Type*, int64_t> type_indices_;
+  ByteWriter literals_;
+  absl::flat_hash_map<Value, int64_t> literal_indices_;
+  absl::flat_hash_map<const Function*, int64_t> function_indices_;
+};
+
+int64_t BinaryIrWriter::TypeIndex(Type* type) {
+  auto it = type_indices_.find(type);
+  if (it != type_indices_.end()) {
+    return it->second;
+  }
+  switch (type->kind()) {
+    case TypeKind::kBits:
+      types_.WriteVarint(static_cast<uint64_t>(TypeTag::kBits));
+      types_.WriteVarint(type->AsBitsOrDie()->bit_count());
+      break;
+    case TypeKind::kTuple: {
+      std::vector<int64_t> element_indices;
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        element_indices.push_back(TypeIndex(element_type));
+      }
+      types_.WriteVarint(static_cast<uint64_t>(TypeTag::kTuple));
+      types_.WriteVarint(element_indices.size());
+      for (int64_t element_index : element_indices) {
+        types_.WriteVarint(element_index);
+      }
+      break;
+    }
+    case TypeKind::kArray: {
+      int64_t element_index = TypeIndex(type->AsArrayOrDie()->element_type());
+      types_.WriteVarint(static_cast<uint64_t>(TypeTag::kArray));
+      types_.WriteVarint(type->AsArrayOrDie()->size());
+      types_.WriteVarint(element_index);
+      break;
+    }
+    case TypeKind::kToken:
+      types_.WriteVarint(static_cast<uint64_t>(TypeTag::kToken));
+      break;
+  }
+  int64_t index = type_indices_.size();
+  type_indices_[type] = index;
+  return index;
+}
+
+int64_t BinaryIrWriter::LiteralIndex(const Value& value, Type* type) {
+  auto [it, inserted] =
+      literal_indices_.try_emplace(value, literal_indices_.size());
+  if (inserted) {
+    ByteWriter payload;
+    WriteValue(value, payload);
+    literals_.WriteVarint(TypeIndex(type));
+    literals_.WriteString(payload.bytes());
+  }
+  return it->second;
+}
+
+absl::Status BinaryIrWriter::EncodeNode(Node* node, int64_t node_index,
+                                        const NodeMap<int64_t>& node_indices,
+                                        ByteWriter& writer) {
+  writer.WriteVarint(ToOpProto(node->op()));
+  writer.WriteVarint(TypeIndex(node->GetType()));
+  writer.WriteVarint(node->id());
+  writer.WriteString(node->HasAssignedName() ? node->GetName() : "");
+  writer.WriteVarint(node->loc().locations.size());
+  for (const SourceLocation& location : node->loc().locations) {
+    writer.WriteVarint(location.fileno().value());
+    writer.WriteVarint(location.lineno().value());
+    writer.WriteVarint(location.colno().value());
+  }
+  writer.WriteVarint(node->operand_count());
+  for (Node* operand : node->operands()) {
+    writer.WriteVarint(node_index - node_indices.at(operand));
+  }
+
+  // Op-specific attributes. Attributes which are implied by the type of the
+  // node (e.g., the width of a bit slice) are not stored.
+  switch (node->op()) {
+    case Op::kArrayIndex:
+      writer.WriteBool(node->As<ArrayIndex>()->assumed_in_bounds());
+      break;
+    case Op::kArrayUpdate:
+      writer.WriteBool(node->As<ArrayUpdate>()->assumed_in_bounds());
+      break;
+    case Op::kAssert: {
+      Assert* assert = node->As<Assert>();
+      writer.WriteString(assert->message());
+      writer.WriteOptionalString(assert->label());
+      writer.WriteOptionalString(assert->original_label());
+      break;
+    }
+    case Op::kBitSlice:
+      writer.WriteVarint(node->As<BitSlice>()->start());
+      break;
+    case Op::kCountedFor: {
+      CountedFor* counted_for = node->As<CountedFor>();
+      writer.WriteVarint(counted_for->trip_count());
+      writer.WriteVarint(counted_for->stride());
+      writer.WriteVarint(function_indices_.at(counted_for->body()));
+      break;
+    }
+    case Op::kCover: {
+      Cover* cover = node->As<Cover>();
+      writer.WriteString(cover->label());
+      writer.WriteOptionalString(cover->original_label());
+      break;
+    }
+    case Op::kDynamicCountedFor:
+      writer.WriteVarint(
+          function_indices_.at(node->As<DynamicCountedFor>()->body()));
+      break;
+    case Op::kInvoke:
+      writer.WriteVarint(function_indices_.at(node->As<Invoke>()->to_apply()));
+      break;
+    case Op::kLiteral:
+      writer.WriteVarint(
+          LiteralIndex(node->As<Literal>()->value(), node->GetType()));
+      break;
+    case Op::kMap:
+      writer.WriteVarint(function_indices_.at(node->As<Map>()->to_apply()));
+      break;
+    case Op::kMinDelay:
+      writer.WriteVarint(node->As<MinDelay>()->delay());
+      break;
+    case Op::kOneHot:
+      writer.WriteBool(node->As<OneHot>()->priority() == LsbOrMsb::kMsb);
+      break;
+    case Op::kSel:
+      writer.WriteBool(node->As<Select>()->default_value().has_value());
+      break;
+    case Op::kTrace: {
+      Trace* trace = node->As<Trace>();
+      writer.WriteString(StepsToXlsFormatString(trace->format()));
+      writer.WriteSignedVarint(trace->verbosity());
+      break;
+    }
+    case Op::kTupleIndex:
+      writer.WriteVarint(node->As<TupleIndex>()->index());
+      break;
+    case Op::kInputPort:
+    case Op::kInstantiationInput:
+    case Op::kInstantiationOutput:
+    case Op::kNext:
+    case Op::kOutputPort:
+    case Op::kReceive:
+    case Op::kRegisterRead:
+    case Op::kRegisterWrite:
+    case Op::kSend:
+    case Op::kStateRead:
+      return absl::UnimplementedError(absl::StrFormat(
+          "Binary IR does not support node %s", node->GetName()));
+    default:
+      break;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> BinaryIrWriter::EncodeFunction(Function* function) {
+  ByteWriter writer;
+  writer.WriteBool(function->GetInitiationInterval().has_value());
+  if (function->GetInitiationInterval().has_value()) {
+    writer.WriteSignedVarint(*function->GetInitiationInterval());
+  }
+  writer.WriteBool(function->ForeignFunctionData().has_value());
+  if (function->ForeignFunctionData().has_value()) {
+    writer.WriteString(function->ForeignFunctionData()->SerializeAsString());
+  }
+
+  std::vector<Node*> order = StableTopoSort(function);
+  writer.WriteVarint(order.size());
+  NodeMap<int64_t> node_indices;
+  for (Node* node : order) {
+    int64_t node_index = node_indices.size();
+    XLS_RETURN_IF_ERROR(EncodeNode(node, node_index, node_indices, writer));
+    node_indices[node] = node_index;
+  }
+  writer.WriteVarint(function->params().size());
+  for (Param* param : function->params()) {
+    writer.WriteVarint(node_indices.at(param));
+  }
+  XLS_RET_CHECK_NE(function->return_value(), nullptr);
+  writer.WriteVarint(node_indices.at(function->return_value()));
+  return std::move(writer).Release();
+}
+
+absl::StatusOr<std::string> BinaryIrWriter::Write() {
+  if (!package_->procs().empty() || !package_->blocks().empty() ||
+      !package_->channels().empty()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Binary IR does not support procs, blocks or channels (package `%s`)",
+        package_->name()));
+  }
+
+  std::vector<std::string> bodies;
+  bodies.reserve(package_->functions().size());
+  for (const std::unique_ptr<Function>& function : package_->functions()) {
+    function_indices_[function.get()] = bodies.size();
+  }
+  for (const std::unique_ptr<Function>& function : package_->functions()) {
+    XLS_ASSIGN_OR_RETURN(std::string body, EncodeFunction(function.get()));
+    bodies.push_back(std::move(body));
+  }
+
+  ByteWriter writer;
+  writer.WriteRaw(kMagic);
+  writer.WriteVarint(kVersion);
+  writer.WriteString(package_->name());
+  writer.WriteVarint(package_->next_node_id());
+
+  // Sort filenos for deterministic output.
+  std::vector<std::pair<Fileno, std::string>> filenos(
+      package_->fileno_to_name().begin(), package_->fileno_to_name().end());
+  std::sort(filenos.begin(), filenos.end(), [](const auto& a, const auto& b) {
+    return a.first.value() < b.first.value();
+  });
+  writer.WriteVarint(filenos.size());
+  for (const auto& [fileno, filename] : filenos) {
+    writer.WriteVarint(fileno.value());
+    writer.WriteString(filename);
+  }
+
+  writer.WriteVarint(type_indices_.size());
+  writer.WriteRaw(types_.bytes());
+  writer.WriteVarint(literal_indices_.size());
+  writer.WriteRaw(literals_.bytes());
+
+  writer.WriteVarint(bodies.size());
+  for (int64_t i = 0; i < bodies.size(); ++i) {
+    writer.WriteString(package_->functions()[i]->name());
+    writer.WriteVarint(bodies[i].size());
+  }
+  std::optional<FunctionBase*> top = package_->GetTop();
+  writer.WriteVarint(
+      top.has_value() ? function_indices_.at((*top)->AsFunctionOrDie()) + 1
+                      : 0);
+  for (const std::string& body : bodies) {
+    writer.WriteRaw(body);
+  }
+  return std::move(writer).Release();
+}
+
+}  // namespace
+
+bool IsBinaryIr(std::string_view bytes) { return bytes.starts_with(kMagic); }
+
+absl::StatusOr<std::string> PackageToBinaryIr(Package* package) {
+  return BinaryIrWriter(package).Write();
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryIrPackage(
+    std::string_view bytes) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BinaryIrReader> reader,
+                       BinaryIrReader::Create(bytes));
+  return reader->ReleasePackage();
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<BinaryIrReader>>
+BinaryIrReader::Create(std::string_view bytes) {
+  auto reader = absl::WrapUnique(
+      new BinaryIrReader(bytes, /*mapping=*/nullptr, /*mapping_size=*/0));
+  XLS_RETURN_IF_ERROR(reader->ReadHeader());
+  return reader;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<BinaryIrReader>>
+BinaryIrReader::OpenFile(const std::filesystem::path& path) {
+  FileDescriptor fd(open(path.c_str(), O_RDONLY));
+  if (fd.get() < 0) {
+    return ErrnoToStatus(errno)
+           << "Unable to open binary IR file " << path.string();
+  }
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0) {
+    return ErrnoToStatus(errno)
+           << "Unable to stat binary IR file " << path.string();
+  }
+  int64_t file_size = st.st_size;
+  if (file_size == 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Binary IR file `%s` is empty", path.string()));
+  }
+  void* mapping =
+      mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd.get(), /*offset=*/0);
+  if (mapping == MAP_FAILED) {
+    return ErrnoToStatus(errno)
+           << "Unable to map binary IR file " << path.string();
+  }
+  // The reader owns the mapping from here on.
+  auto reader = absl::WrapUnique(new BinaryIrReader(
+      std::string_view(static_cast<const char*>(mapping), file_size), mapping,
+      file_size));
+  absl::Status status = reader->ReadHeader();
+  if (!status.ok()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid binary IR file `%s`: %s", path.string(), status.message()));
+  }
+  return reader;
+}
+
+BinaryIrReader::~BinaryIrReader() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
+absl::Status BinaryIrReader::ReadHeader() {
+  if (!IsBinaryIr(bytes_)) {
+    return absl::InvalidArgumentError("Input is not binary IR");
+  }
+  ByteReader reader(bytes_.substr(kMagic.size()));
+  XLS_ASSIGN_OR_RETURN(uint64_t version, reader.ReadVarint());
+  if (version != kVersion) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unsupported binary IR version %d", version));
+  }
+  XLS_ASSIGN_OR_RETURN(std::string_view name, reader.ReadString());
+  package_ = std::make_unique<Package>(name);
+  XLS_ASSIGN_OR_RETURN(next_node_id_, reader.ReadVarint());
+
+  XLS_ASSIGN_OR_RETURN(uint64_t fileno_count, reader.ReadVarint());
+  for (uint64_t i = 0; i < fileno_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(uint64_t fileno, reader.ReadVarint());
+    XLS_ASSIGN_OR_RETURN(std::string_view filename, reader.ReadString());
+    package_->SetFileno(Fileno(fileno), filename);
+  }
+
+  XLS_ASSIGN_OR_RETURN(uint64_t type_count, reader.ReadVarint());
+  for (uint64_t i = 0; i < type_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(uint64_t tag, reader.ReadVarint());
+    switch (static_cast<TypeTag>(tag)) {
+      case TypeTag::kBits: {
+        XLS_ASSIGN_OR_RETURN(uint64_t bit_count, reader.ReadVarint());
+        types_.push_back(package_->GetBitsType(bit_count));
+        break;
+      }
+      case TypeTag::kTuple: {
+        XLS_ASSIGN_OR_RETURN(uint64_t size, reader.ReadVarint());
+        std::vector<Type*> element_types;
+        for (uint64_t j = 0; j < size; ++j) {
+          XLS_ASSIGN_OR_RETURN(int64_t element, reader.ReadIndex(i));
+          element_types.push_back(types_[element]);
+        }
+        types_.push_back(package_->GetTupleType(element_types));
+        break;
+      }
+      case TypeTag::kArray: {
+        XLS_ASSIGN_OR_RETURN(uint64_t size, reader.ReadVarint());
+        XLS_ASSIGN_OR_RETURN(int64_t element, reader.ReadIndex(i));
+        types_.push_back(package_->GetArrayType(size, types_[element]));
+        break;
+      }
+      case TypeTag::kToken:
+        types_.push_back(package_->GetTokenType());
+        break;
+      default:
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Invalid type tag %d in binary IR", tag));
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(uint64_t literal_count, reader.ReadVarint());
+  for (uint64_t i = 0; i < literal_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(int64_t type, reader.ReadIndex(types_.size()));
+    XLS_ASSIGN_OR_RETURN(std::string_view payload, reader.ReadString());
+    encoded_literals_.push_back({types_[type], payload});
+  }
+  literals_.resize(encoded_literals_.size());
+
+  XLS_ASSIGN_OR_RETURN(uint64_t function_count, reader.ReadVarint());
+  std::vector<uint64_t> body_sizes;
+  for (uint64_t i = 0; i < function_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(std::string_view function_name, reader.ReadString());
+    XLS_ASSIGN_OR_RETURN(uint64_t body_size, reader.ReadVarint());
+    if (!function_indices_.try_emplace(function_name, i).second) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Duplicate function `%s` in binary IR", function_name));
+    }
+    functions_.push_back(FunctionEntry{.name = std::string(function_name)});
+    body_sizes.push_back(body_size);
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t top, reader.ReadIndex(function_count + 1));
+  if (top > 0) {
+    top_index_ = top - 1;
+  }
+  // Only skip over the bodies here. They are decoded on demand.
+  for (uint64_t i = 0; i < function_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(functions_[i].body, reader.ReadRaw(body_sizes[i]));
+  }
+  if (!reader.AtEnd()) {
+    return absl::InvalidArgumentError("Trailing bytes after binary IR");
+  }
+  return absl::OkStatus();
+}
+
+std::vector<std::string> BinaryIrReader::GetFunctionNames() const {
+  std::vector<std::string> names;
+  names.reserve(functions_.size());
+  for (const FunctionEntry& entry : functions_) {
+    names.push_back(entry.name);
+  }
+  return names;
+}
+
+std::optional<std::string> BinaryIrReader::GetTopName() const {
+  if (!top_index_.has_value()) {
+    return std::nullopt;
+  }
+  return functions_[*top_index_].name;
+}
+
+absl::StatusOr<Function*> BinaryIrReader::GetFunction(std::string_view name) {
+  auto it = function_indices_.find(name);
+  if (it == function_indices_.end()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "No function `%s` in binary IR package `%s`", name, package_->name()));
+  }
+  return Materialize(it->second);
+}
+
+absl::Status BinaryIrReader::MaterializeAll() {
+  for (int64_t i = 0; i < functions_.size(); ++i) {
+    XLS_RETURN_IF_ERROR(Materialize(i).status());
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<Package>> BinaryIrReader::ReleasePackage() {
+  XLS_RETURN_IF_ERROR(MaterializeAll());
+  // Materialized functions are verified individually; this also verifies
+  // package-level invariants.
+  XLS_RETURN_IF_ERROR(VerifyPackage(package_.get()));
+  return std::move(package_);
+}
+
+absl::StatusOr<Value> BinaryIrReader::GetLiteral(int64_t index) {
+  if (!literals_[index].has_value()) {
+    auto [type, payload] = encoded_literals_[index];
+    ByteReader reader(payload);
+    XLS_ASSIGN_OR_RETURN(Value value, ReadValue(type, reader));
+    if (!reader.AtEnd()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Malformed literal %d in binary IR", index));
+    }
+    literals_[index] = std::move(value);
+  }
+  return *literals_[index];
+}
+
+absl::StatusOr<Function*> BinaryIrReader::Materialize(int64_t function_index) {
+  FunctionEntry& entry = functions_[function_index];
+  if (entry.function != nullptr) {
+    return entry.function;
+  }
+  if (entry.in_progress) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Function `%s` in binary IR is recursive", entry.name));
+  }
+  entry.in_progress = true;
+  absl::StatusOr<Function*> function = DecodeFunction(entry);
+  entry.in_progress = false;
+  if (!function.ok()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unable to materialize function `%s`: %s", entry.name,
+                        function.status().message()));
+  }
+  entry.function = *function;
+  if (top_index_ == function_index) {
+    XLS_RETURN_IF_ERROR(package_->SetTop(entry.function));
+  }
+  return entry.function;
+}
+
+absl::StatusOr<Node*> BinaryIrReader::DecodeNode(
+    ByteReader& reader, Function* function, absl::Span<Node* const> nodes) {
+  int64_t node_index = nodes.size();
+  XLS_ASSIGN_OR_RETURN(uint64_t op_proto, reader.ReadVarint());
+  if (op_proto > std::numeric_limits<int>::max() ||
+      !OpProto_IsValid(static_cast<int>(op_proto))) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid op %d", op_proto));
+  }
+  Op op = FromOpProto(static_cast<OpProto>(op_proto));
+  XLS_ASSIGN_OR_RETURN(int64_t type_index, reader.ReadIndex(types_.size()));
+  Type* type = types_[type_index];
+  XLS_ASSIGN_OR_RETURN(uint64_t id, reader.ReadVarint());
+  XLS_ASSIGN_OR_RETURN(std::string_view name, reader.ReadString());
+  XLS_ASSIGN_OR_RETURN(uint64_t location_count, reader.ReadVarint());
+  SourceInfo loc;
+  for (uint64_t i = 0; i < location_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(uint64_t fileno, reader.ReadVarint());
+    XLS_ASSIGN_OR_RETURN(uint64_t lineno, reader.ReadVarint());
+    XLS_ASSIGN_OR_RETURN(uint64_t colno, reader.ReadVarint());
+    loc.locations.push_back(
+        SourceLocation(Fileno(fileno), Lineno(lineno), Colno(colno)));
+  }
+  XLS_ASSIGN_OR_RETURN(uint64_t operand_count, reader.ReadVarint());
+  std::vector<Node*> operands;
+  operands.reserve(operand_count);
+  for (uint64_t i = 0; i < operand_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(uint64_t distance, reader.ReadVarint());
+    if (distance == 0 || distance > node_index) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid operand of node %d", node_index));
+    }
+    operands.push_back(nodes[node_index - distance]);
+  }
+  auto check_operand_count = [&](int64_t expected,
+                                 bool variadic = false) -> absl::Status {
+    if (operands.size() < expected ||
+        (!variadic && operands.size() != expected)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Node %d (%s) has %d operands, expected %s%d", node_index,
+          OpToString(op), operands.size(), variadic ? "at least " : "",
+          expected));
+    }
+    return absl::OkStatus();
+  };
+  auto read_function = [&]() -> absl::StatusOr<Function*> {
+    XLS_ASSIGN_OR_RETURN(int64_t index, reader.ReadIndex(functions_.size()));
+    return Materialize(index);
+  };
+  auto bit_count = [&]() -> absl::StatusOr<int64_t> {
+    XLS_RET_CHECK(type->IsBits()) << "Node " << node_index;
+    return type->AsBitsOrDie()->bit_count();
+  };
+
+  absl::Span<Node* const> rest = absl::MakeConstSpan(operands);
+  NodeMaker make{
+      .function = function, .id = static_cast<int64_t>(id),
+      .loc = loc, .name = name};
+  Node* node = nullptr;
+  if (op == Op::kParam) {
+    XLS_RETURN_IF_ERROR(check_operand_count(0));
+    node = make.New<Param>(type);
+  } else if (op == Op::kLiteral) {
+    XLS_RETURN_IF_ERROR(check_operand_count(0));
+    XLS_ASSIGN_OR_RETURN(int64_t index,
+                         reader.ReadIndex(encoded_literals_.size()));
+    XLS_ASSIGN_OR_RETURN(Value value, GetLiteral(index));
+    node = make.New<Literal>(std::move(value));
+  } else if (op == Op::kAfterAll) {
+    node = make.New<AfterAll>(rest);
+  } else if (op == Op::kArray) {
+    XLS_RET_CHECK(type->IsArray()) << "Node " << node_index;
+    node = make.New<Array>(rest, type->AsArrayOrDie()->element_type());
+  } else if (op == Op::kArrayConcat) {
+    node = make.New<ArrayConcat>(rest);
+  } else if (op == Op::kArrayIndex) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1, /*variadic=*/true));
+    XLS_ASSIGN_OR_RETURN(bool assumed_in_bounds, reader.ReadBool());
+    node = make.New<ArrayIndex>(operands[0], rest.subspan(1),
+                                assumed_in_bounds);
+  } else if (op == Op::kArraySlice) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    XLS_RET_CHECK(type->IsArray()) << "Node " << node_index;
+    node = make.New<ArraySlice>(operands[0], operands[1],
+                                type->AsArrayOrDie()->size());
+  } else if (op == Op::kArrayUpdate) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2, /*variadic=*/true));
+    XLS_ASSIGN_OR_RETURN(bool assumed_in_bounds, reader.ReadBool());
+    node = make.New<ArrayUpdate>(operands[0], operands[1], rest.subspan(2),
+                                 assumed_in_bounds);
+  } else if (op == Op::kAssert) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    XLS_ASSIGN_OR_RETURN(std::string_view message, reader.ReadString());
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> label,
+                         reader.ReadOptionalString());
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> original_label,
+                         reader.ReadOptionalString());
+    node = make.New<Assert>(operands[0], operands[1], message, label,
+                            original_label);
+  } else if (op == Op::kBitSlice) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    XLS_ASSIGN_OR_RETURN(uint64_t start, reader.ReadVarint());
+    XLS_ASSIGN_OR_RETURN(int64_t width, bit_count());
+    node = make.New<BitSlice>(operands[0], start, width);
+  } else if (op == Op::kBitSliceUpdate) {
+    XLS_RETURN_IF_ERROR(check_operand_count(3));
+    node =
+        make.New<BitSliceUpdate>(operands[0], operands[1], operands[2]);
+  } else if (op == Op::kConcat) {
+    node = make.New<Concat>(rest);
+  } else if (op == Op::kCountedFor) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1, /*variadic=*/true));
+    XLS_ASSIGN_OR_RETURN(uint64_t trip_count, reader.ReadVarint());
+    XLS_ASSIGN_OR_RETURN(uint64_t stride, reader.ReadVarint());
+    XLS_ASSIGN_OR_RETURN(Function * body, read_function());
+    node = make.New<CountedFor>(operands[0], rest.subspan(1), trip_count,
+                                stride, body);
+  } else if (op == Op::kCover) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    XLS_ASSIGN_OR_RETURN(std::string_view label, reader.ReadString());
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> original_label,
+                         reader.ReadOptionalString());
+    node = make.New<Cover>(operands[0], label, original_label);
+  } else if (op == Op::kDecode) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    XLS_ASSIGN_OR_RETURN(int64_t width, bit_count());
+    node = make.New<Decode>(operands[0], width);
+  } else if (op == Op::kDynamicBitSlice) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    XLS_ASSIGN_OR_RETURN(int64_t width, bit_count());
+    node = make.New<DynamicBitSlice>(operands[0], operands[1], width);
+  } else if (op == Op::kDynamicCountedFor) {
+    XLS_RETURN_IF_ERROR(check_operand_count(3, /*variadic=*/true));
+    XLS_ASSIGN_OR_RETURN(Function * body, read_function());
+    node = make.New<DynamicCountedFor>(operands[0], operands[1],
+                                       operands[2], rest.subspan(3), body);
+  } else if (op == Op::kEncode) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    node = make.New<Encode>(operands[0]);
+  } else if (op == Op::kGate) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    node = make.New<Gate>(operands[0], operands[1]);
+  } else if (op == Op::kInvoke) {
+    XLS_ASSIGN_OR_RETURN(Function * to_apply, read_function());
+    node = make.New<Invoke>(rest, to_apply);
+  } else if (op == Op::kMap) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    XLS_ASSIGN_OR_RETURN(Function * to_apply, read_function());
+    node = make.New<Map>(operands[0], to_apply);
+  } else if (op == Op::kMinDelay) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    XLS_ASSIGN_OR_RETURN(uint64_t delay, reader.ReadVarint());
+    node = make.New<MinDelay>(operands[0], delay);
+  } else if (op == Op::kOneHot) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    XLS_ASSIGN_OR_RETURN(bool msb, reader.ReadBool());
+    node =
+        make.New<OneHot>(operands[0], msb ? LsbOrMsb::kMsb : LsbOrMsb::kLsb);
+  } else if (op == Op::kOneHotSel) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1, /*variadic=*/true));
+    node = make.New<OneHotSelect>(operands[0], rest.subspan(1));
+  } else if (op == Op::kPrioritySel) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2, /*variadic=*/true));
+    node = make.New<PrioritySelect>(operands[0],
+                                    rest.subspan(1, operands.size() - 2),
+                                    operands.back());
+  } else if (op == Op::kSel) {
+    XLS_ASSIGN_OR_RETURN(bool has_default, reader.ReadBool());
+    XLS_RETURN_IF_ERROR(
+        check_operand_count(has_default ? 2 : 1, /*variadic=*/true));
+    std::optional<Node*> default_value;
+    int64_t case_count = operands.size() - 1;
+    if (has_default) {
+      default_value = operands.back();
+      --case_count;
+    }
+    node = make.New<Select>(operands[0], rest.subspan(1, case_count),
+                            default_value);
+  } else if (op == Op::kTrace) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2, /*variadic=*/true));
+    XLS_ASSIGN_OR_RETURN(std::string_view format_string, reader.ReadString());
+    XLS_ASSIGN_OR_RETURN(std::vector<FormatStep> format,
+                         ParseFormatString(format_string));
+    XLS_ASSIGN_OR_RETURN(int64_t verbosity, reader.ReadSignedVarint());
+    node = make.New<Trace>(operands[0], operands[1], rest.subspan(2), format,
+                           verbosity);
+  } else if (op == Op::kTuple) {
+    node = make.New<Tuple>(rest);
+  } else if (op == Op::kTupleIndex) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    XLS_ASSIGN_OR_RETURN(uint64_t index, reader.ReadVarint());
+    node = make.New<TupleIndex>(operands[0], index);
+  } else if (IsOpClass<ArithOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    XLS_ASSIGN_OR_RETURN(int64_t width, bit_count());
+    node = make.New<ArithOp>(operands[0], operands[1], width, op);
+  } else if (IsOpClass<BinOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    node = make.New<BinOp>(operands[0], operands[1], op);
+  } else if (IsOpClass<BitwiseReductionOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    node = make.New<BitwiseReductionOp>(operands[0], op);
+  } else if (IsOpClass<CompareOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    node = make.New<CompareOp>(operands[0], operands[1], op);
+  } else if (IsOpClass<ExtendOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    XLS_ASSIGN_OR_RETURN(int64_t width, bit_count());
+    node = make.New<ExtendOp>(operands[0], width, op);
+  } else if (IsOpClass<NaryOp>(op)) {
+    node = make.New<NaryOp>(rest, op);
+  } else if (IsOpClass<PartialProductOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    XLS_RET_CHECK(type->IsTuple() && type->AsTupleOrDie()->size() == 2 &&
+                  type->AsTupleOrDie()->element_type(0)->IsBits())
+        << "Node " << node_index;
+    node = make.New<PartialProductOp>(
+        operands[0], operands[1],
+        type->AsTupleOrDie()->element_type(0)->GetFlatBitCount(), op);
+  } else if (IsOpClass<UnOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    node = make.New<UnOp>(operands[0], op);
+  } else {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Op %s is not supported in binary IR functions", OpToString(op)));
+  }
+  if (node->GetType() != type) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Node %s has type %s, expected %s", node->GetName(),
+        node->GetType()->ToString(), type->ToString()));
+  }
+  return node;
+}
+
+absl::StatusOr<Function*> BinaryIrReader::DecodeFunction(
+    FunctionEntry& entry) {
+  ByteReader reader(entry.body);
+  auto function = std::make_unique<Function>(entry.name, package_.get());
+  XLS_ASSIGN_OR_RETURN(bool has_initiation_interval, reader.ReadBool());
+  if (has_initiation_interval) {
+    XLS_ASSIGN_OR_RETURN(int64_t initiation_interval,
+                         reader.ReadSignedVarint());
+    function->SetInitiationInterval(initiation_interval);
+  }
+  XLS_ASSIGN_OR_RETURN(bool has_ffi, reader.ReadBool());
+  if (has_ffi) {
+    XLS_ASSIGN_OR_RETURN(std::string_view serialized, reader.ReadString());
+    ForeignFunctionData ffi;
+    XLS_RET_CHECK(ffi.ParseFromArray(serialized.data(), serialized.size()));
+    function->SetForeignFunctionData(ffi);
+  }
+
+  XLS_ASSIGN_OR_RETURN(uint64_t node_count, reader.ReadVarint());
+  std::vector<Node*> nodes;
+  nodes.reserve(node_count);
+  int64_t max_node_id = 0;
+  for (int64_t node_index = 0; node_index < node_count; ++node_index) {
+    XLS_ASSIGN_OR_RETURN(Node * node,
+                         DecodeNode(reader, function.get(), nodes));
+    max_node_id = std::max(max_node_id, node->id());
+    nodes.push_back(node);
+  }
+  package_->set_next_node_id(std::max(next_node_id_, max_node_id + 1));
+
+  // Params are created in node order; restore the parameter order.
+  XLS_ASSIGN_OR_RETURN(uint64_t param_count, reader.ReadVarint());
+  if (param_count != function->params().size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d params, found %d", param_count,
+                        function->params().size()));
+  }
+  for (int64_t i = 0; i < param_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(int64_t param_index, reader.ReadIndex(node_count));
+    if (!nodes[param_index]->Is<Param>()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Node %d is not a param", param_index));
+    }
+    XLS_RETURN_IF_ERROR(
+        function->MoveParamToIndex(nodes[param_index]->As<Param>(), i));
+  }
+
+  XLS_ASSIGN_OR_RETURN(int64_t return_index, reader.ReadIndex(node_count));
+  XLS_RETURN_IF_ERROR(function->set_return_value(nodes[return_index]));
+  if (!reader.AtEnd()) {
+    return absl::InvalidArgumentError("Trailing bytes after function body");
+  }
+  Function* result = package_->AddFunction(std::move(function));
+  absl::Status verified = VerifyFunction(result);
+  if (!verified.ok()) {
+    XLS_RETURN_IF_ERROR(package_->RemoveFunction(result));
+    return verified;
+  }
+  return result;
+}
+
+}  // namespace xls
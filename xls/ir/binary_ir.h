@@ -0,0 +1,161 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_BINARY_IR_H_
+#define XLS_IR_BINARY_IR_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace binary_ir_internal {
+class ByteReader;
+}  // namespace binary_ir_internal
+
+// Binary IR is a compact serialization of a package which is much faster to
+// load than the text IR. It is intended for handing packages between tools
+// rather than for human consumption.
+//
+// A binary IR file consists of:
+//
+//   * A 7-byte magic string (beginning with a NUL byte so it can never be
+//     mistaken for text IR) followed by the format version.
+//   * The package name, the next node id and the fileno to filename map.
+//   * The type table. Every type used in the package is stored once and
+//     referred to by index. Aggregate types refer to their element types by
+//     index (elements always precede the aggregates using them).
+//   * The literal pool. Each distinct literal value is stored once along with
+//     its type and encoded size so values can be decoded on demand.
+//   * The function directory holding the name and encoded size of each
+//     function, and the index of the top function (if any).
+//   * The function bodies. Each node is a record holding the op, type index,
+//     id, name, source locations and operands followed by any op-specific
+//     attributes. Operands are encoded as the distance back to the operand in
+//     the (topologically sorted) node sequence which is usually small.
+//
+// All integers are LEB128 varints (zigzag encoded if signed) and strings are
+// length-prefixed. The format does not currently support procs, blocks or
+// channels.
+
+// Returns whether `bytes` starts with the binary IR magic string.
+bool IsBinaryIr(std::string_view bytes);
+
+// Serializes `package` into binary IR. Returns an UnimplementedError if the
+// package contains constructs not supported by the format.
+absl::StatusOr<std::string> PackageToBinaryIr(Package* package);
+
+// Parses a complete package from binary IR and verifies it.
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryIrPackage(
+    std::string_view bytes);
+
+// A reader of binary IR which materializes functions on demand. Only the
+// package header and the function directory are decoded up front. Functions
+// are decoded (along with the functions they call) the first time they are
+// requested so tools which need only part of a package do not pay for the
+// rest.
+class BinaryIrReader {
+ public:
+  // Creates a reader of `bytes` which must outlive the reader.
+  static absl::StatusOr<std::unique_ptr<BinaryIrReader>> Create(
+      std::string_view bytes);
+
+  // Creates a reader of the binary IR file at `path`. The file is
+  // memory-mapped so only the parts of the file which are materialized are
+  // read from disk.
+  static absl::StatusOr<std::unique_ptr<BinaryIrReader>> OpenFile(
+      const std::filesystem::path& path);
+
+  ~BinaryIrReader();
+
+  BinaryIrReader(const BinaryIrReader&) = delete;
+  BinaryIrReader& operator=(const BinaryIrReader&) = delete;
+
+  // The package holding the materialized functions. The package initially
+  // holds no functions.
+  Package* package() const { return package_.get(); }
+
+  // Returns the names of all functions in the package in definition order.
+  std::vector<std::string> GetFunctionNames() const;
+
+  // Returns the name of the top function of the package, if any.
+  std::optional<std::string> GetTopName() const;
+
+  // Returns the function with the given name, materializing it (and the
+  // functions it calls) if necessary. Materialized functions are verified.
+  absl::StatusOr<Function*> GetFunction(std::string_view name);
+
+  // Materializes all functions not already materialized.
+  absl::Status MaterializeAll();
+
+  // Materializes all functions and returns the package, verified. The reader
+  // may not be used afterwards.
+  absl::StatusOr<std::unique_ptr<Package>> ReleasePackage();
+
+ private:
+  struct FunctionEntry {
+    std::string name;
+    std::string_view body;
+    Function* function = nullptr;
+    bool in_progress = false;
+  };
+
+  BinaryIrReader(std::string_view bytes, void* mapping, int64_t mapping_size)
+      : bytes_(bytes), mapping_(mapping), mapping_size_(mapping_size) {}
+
+  // Decodes everything up to the function bodies.
+  absl::Status ReadHeader();
+
+  absl::StatusOr<Function*> Materialize(int64_t function_index);
+  absl::StatusOr<Function*> DecodeFunction(FunctionEntry& entry);
+  // Decodes the next node of a function whose previous nodes are `nodes`.
+  absl::StatusOr<Node*> DecodeNode(binary_ir_internal::ByteReader& reader,
+                                   Function* function,
+                                   absl::Span<Node* const> nodes);
+  absl::StatusOr<Value> GetLiteral(int64_t index);
+
+  std::string_view bytes_;
+  // The memory-mapped file backing `bytes_`, if any.
+  void* mapping_;
+  int64_t mapping_size_;
+
+  std::unique_ptr<Package> package_;
+  int64_t next_node_id_ = 1;
+  std::vector<Type*> types_;
+  // Encoded literal values and their types, decoded on first use.
+  std::vector<std::pair<Type*, std::string_view>> encoded_literals_;
+  std::vector<std::optional<Value>> literals_;
+  std::vector<FunctionEntry> functions_;
+  absl::flat_hash_map<std::string, int64_t> function_indices_;
+  std::optional<int64_t> top_index_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_BINARY_IR_H_
@@ -0,0 +1,228 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_ir.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/fileno.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+class BinaryIrTest : public IrTestBase {
+ protected:
+  // Builds a package exercising most ops and function attributes.
+  std::unique_ptr<Package> BuildPackage() {
+    auto package = CreatePackage();
+    Fileno fileno = package->GetOrCreateFileno("foo.x");
+    SourceInfo loc(SourceLocation(fileno, Lineno(3), Colno(7)));
+
+    FunctionBuilder body_builder("body", package.get());
+    BValue i = body_builder.Param("i", package->GetBitsType(8));
+    BValue accum = body_builder.Param("accum", package->GetBitsType(8));
+    BValue inv = body_builder.Param("inv", package->GetBitsType(8));
+    body_builder.Add(body_builder.Add(i, accum), inv);
+    Function* body = body_builder.Build().value();
+
+    FunctionBuilder map_builder("negate", package.get());
+    map_builder.Negate(map_builder.Param("x", package->GetBitsType(8)));
+    Function* negate = map_builder.Build().value();
+
+    FunctionBuilder unused_builder("unused", package.get());
+    unused_builder.Not(unused_builder.Param("x", package->GetBitsType(3)));
+    CHECK_OK(unused_builder.Build().status());
+
+    FunctionBuilder fb("main", package.get());
+    BValue x = fb.Param("x", package->GetBitsType(8), loc);
+    BValue y = fb.Param("y", package->GetBitsType(8));
+    BValue arr = fb.Param("arr", package->GetArrayType(4, x.GetType()));
+    BValue tok = fb.Param("tok", package->GetTokenType());
+    BValue sum = fb.Add(x, y, loc, "sum");
+    BValue cmp = fb.ULt(x, y);
+    BValue big = fb.Literal(Value(Bits::AllOnes(100)));
+    BValue tuple_lit = fb.Literal(Value::Tuple(
+        {Value(UBits(1, 2)), Value::UBitsArray({1, 2, 3}, 5).value()}));
+    BValue concat = fb.Concat({sum, fb.BitSlice(big, 3, 20)});
+    BValue selected = fb.Select(fb.BitSlice(x, 0, 2), {x, y, sum},
+                                /*default_value=*/fb.Literal(UBits(0, 8)));
+    BValue priority = fb.PrioritySelect(fb.BitSlice(y, 0, 2), {x, y}, sum);
+    BValue one_hot = fb.OneHot(fb.BitSlice(x, 0, 3), LsbOrMsb::kMsb);
+    BValue one_hot_sel = fb.OneHotSelect(fb.BitSlice(one_hot, 0, 2), {x, y});
+    BValue counted = fb.CountedFor(x, /*trip_count=*/4, /*stride=*/2, body,
+                                   /*invariant_args=*/{y});
+    BValue dynamic_counted = fb.DynamicCountedFor(
+        x, fb.Literal(UBits(3, 3)), fb.Literal(UBits(1, 3)), body, {y});
+    BValue mapped = fb.Map(arr, negate);
+    BValue invoked = fb.Invoke({x}, negate);
+    BValue index = fb.ArrayIndex(arr, {fb.BitSlice(x, 0, 2)},
+                                 /*assumed_in_bounds=*/true);
+    BValue updated = fb.ArrayUpdate(arr, y, {fb.Literal(UBits(1, 2))});
+    BValue slice = fb.ArraySlice(updated, fb.Literal(UBits(1, 2)), 2);
+    BValue array_concat =
+        fb.ArrayConcat({slice, fb.Array({x, y}, x.GetType())});
+    BValue umulp = fb.UMulp(x, y);
+    BValue tok2 = fb.Assert(tok, cmp, "x must be less than y", "my_label");
+    BValue tok3 = fb.Trace(fb.MinDelay(tok2, 3), cmp, {x, y},
+                           "x is {} and y is {:#x}", /*verbosity=*/2);
+    fb.Cover(cmp, "cover_label");
+    BValue gated = fb.Gate(cmp, x);
+    fb.Tuple(
+        {tok3, fb.AfterAll({tok2, tok3}), concat, selected, priority,
+         one_hot_sel, counted, dynamic_counted, mapped, invoked, index,
+         array_concat, fb.TupleIndex(umulp, 1), fb.TupleIndex(tuple_lit, 1),
+         fb.SignExtend(gated, 17), fb.ZeroExtend(y, 9), fb.UMul(x, y, 16),
+         fb.Shll(x, y), fb.Not(fb.Reverse(x)), fb.AndReduce(x),
+         fb.Eq(x, y), fb.Decode(fb.BitSlice(x, 0, 3)), fb.Encode(x),
+         fb.DynamicBitSlice(big, x, 10),
+         fb.BitSliceUpdate(x, y, fb.Literal(UBits(1, 2))),
+         fb.Identity(big)});
+    Function* main = fb.Build().value();
+    main->SetInitiationInterval(5);
+    CHECK_OK(package->SetTop(main));
+    return package;
+  }
+};
+
+TEST_F(BinaryIrTest, RoundTrip) {
+  std::unique_ptr<Package> package = BuildPackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           PackageToBinaryIr(package.get()));
+  EXPECT_TRUE(IsBinaryIr(binary));
+  EXPECT_LT(binary.size(), package->DumpIr().size());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> parsed,
+                           ParseBinaryIrPackage(binary));
+  EXPECT_EQ(parsed->DumpIr(), package->DumpIr());
+  EXPECT_EQ(parsed->next_node_id(), package->next_node_id());
+  EXPECT_THAT(parsed->GetFilename(Fileno(0)), Optional(std::string("foo.x")));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * top, parsed->GetTopAsFunction());
+  EXPECT_EQ(top->name(), "main");
+
+  // Serialization is deterministic.
+  XLS_ASSERT_OK_AND_ASSIGN(std::string reserialized,
+                           PackageToBinaryIr(parsed.get()));
+  EXPECT_EQ(reserialized, binary);
+}
+
+TEST_F(BinaryIrTest, LazyMaterialization) {
+  std::unique_ptr<Package> package = BuildPackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           PackageToBinaryIr(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BinaryIrReader> reader,
+                           BinaryIrReader::Create(binary));
+  EXPECT_THAT(reader->GetFunctionNames(),
+              ElementsAre("body", "negate", "unused", "main"));
+  EXPECT_THAT(reader->GetTopName(), Optional(std::string("main")));
+  EXPECT_TRUE(reader->package()->functions().empty());
+
+  // Materializing a function also materializes its callees, but nothing else.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, reader->GetFunction("main"));
+  EXPECT_EQ(main->DumpIr(), package->GetFunction("main").value()->DumpIr());
+  EXPECT_EQ(reader->package()->functions().size(), 3);
+  EXPECT_FALSE(reader->package()->TryGetFunction("unused").has_value());
+  EXPECT_EQ(reader->package()->GetTop(), main);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main_again, reader->GetFunction("main"));
+  EXPECT_EQ(main_again, main);
+  EXPECT_THAT(reader->GetFunction("nonexistent"),
+              StatusIs(absl::StatusCode::kNotFound));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> parsed,
+                           reader->ReleasePackage());
+  EXPECT_EQ(parsed->functions().size(), 4);
+}
+
+TEST_F(BinaryIrTest, OpenFile) {
+  std::unique_ptr<Package> package = BuildPackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           PackageToBinaryIr(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file,
+                           TempFile::CreateWithContent(binary, ".irb"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BinaryIrReader> reader,
+                           BinaryIrReader::OpenFile(file.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * negate, reader->GetFunction("negate"));
+  EXPECT_EQ(negate->DumpIr(),
+            package->GetFunction("negate").value()->DumpIr());
+}
+
+TEST_F(BinaryIrTest, ParserAcceptsBinaryIr) {
+  std::unique_ptr<Package> package = BuildPackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           PackageToBinaryIr(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> parsed,
+                           Parser::ParsePackage(binary));
+  EXPECT_EQ(parsed->DumpIr(), package->DumpIr());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Package> with_entry,
+      Parser::ParsePackageWithEntry(binary, /*entry=*/"unused"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * top, with_entry->GetTopAsFunction());
+  EXPECT_EQ(top->name(), "unused");
+}
+
+TEST_F(BinaryIrTest, TruncatedInputIsRejected) {
+  std::unique_ptr<Package> package = BuildPackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           PackageToBinaryIr(package.get()));
+  for (int64_t size = 0; size < binary.size(); ++size) {
+    EXPECT_FALSE(
+        ParseBinaryIrPackage(std::string_view(binary).substr(0, size)).ok())
+        << "size " << size;
+  }
+}
+
+TEST_F(BinaryIrTest, TextIrIsRejected) {
+  std::unique_ptr<Package> package = BuildPackage();
+  EXPECT_FALSE(IsBinaryIr(package->DumpIr()));
+  EXPECT_THAT(ParseBinaryIrPackage(package->DumpIr()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not binary IR")));
+}
+
+TEST_F(BinaryIrTest, ProcsAreUnsupported) {
+  auto package = CreatePackage();
+  ProcBuilder pb(TestName(), package.get());
+  BValue state = pb.StateElement("st", Value(UBits(0, 8)));
+  pb.Next(state, state);
+  XLS_ASSERT_OK(pb.Build().status());
+  EXPECT_THAT(PackageToBinaryIr(package.get()),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+}  // namespace
+}  // namespace xls
@@ -21,6 +21,7 @@
 #include "absl/base/casts.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
+#include "absl/numeric/bits.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -114,10 +115,8 @@ bool Bits::IsOne() const { return PopCount() == 1 && Get(0); }
 
 int64_t Bits::PopCount() const {
   int64_t count = 0;
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(i)) {
-      ++count;
-    }
+  for (int64_t i = 0; i < bitmap_.word_count(); ++i) {
+    count += absl::popcount(bitmap_.GetWord(i));
   }
   return count;
 }
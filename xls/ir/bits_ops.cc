@@ -21,8 +21,10 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
@@ -50,6 +52,180 @@ Bits TruncateOrSignExtend(Bits bits, int64_t bit_count) {
   return Truncate(std::move(bits), bit_count);
 }
 
+// Operands wider than this many 64-bit words are multiplied with Karatsuba
+// multiplication rather than schoolbook multiplication.
+constexpr int64_t kKaratsubaThresholdWords = 32;
+
+// Returns the result of applying `f` to each pair of corresponding 64-bit
+// words of `lhs` and `rhs`. Bits beyond the bit count in the last word of the
+// result are masked off.
+template <typename F>
+Bits WordwiseOp(const Bits& lhs, const Bits& rhs, F f) {
+  InlineBitmap result(lhs.bit_count());
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    result.SetWord(i, f(lhs.bitmap().GetWord(i), rhs.bitmap().GetWord(i)));
+  }
+  return Bits::FromBitmap(std::move(result));
+}
+
+// Returns the 64-bit words of `bits`, least significant word first.
+std::vector<uint64_t> ToWords(const Bits& bits) {
+  std::vector<uint64_t> words(bits.bitmap().word_count());
+  for (int64_t i = 0; i < words.size(); ++i) {
+    words[i] = bits.bitmap().GetWord(i);
+  }
+  return words;
+}
+
+// Returns a Bits value of width `bit_count` holding the low bits of the
+// little-endian `words`. Words past the end of `words` are zero.
+Bits FromWords(absl::Span<const uint64_t> words, int64_t bit_count) {
+  InlineBitmap result(bit_count);
+  for (int64_t i = 0; i < result.word_count() && i < words.size(); ++i) {
+    result.SetWord(i, words[i]);
+  }
+  return Bits::FromBitmap(std::move(result));
+}
+
+// Returns the `wordno`-th word of `bitmap` where words below zero read as zero
+// and bits at or above the bit count read as `fill`.
+uint64_t GetWordOrFill(const InlineBitmap& bitmap, int64_t wordno, bool fill) {
+  const uint64_t fill_word = fill ? ~uint64_t{0} : uint64_t{0};
+  if (wordno < 0) {
+    return 0;
+  }
+  if (wordno >= bitmap.word_count()) {
+    return fill_word;
+  }
+  uint64_t word = bitmap.GetWord(wordno);
+  int64_t bits_in_word = bitmap.bit_count() - wordno * 64;
+  if (bits_in_word < 64) {
+    word |= fill_word & ~Mask(bits_in_word);
+  }
+  return word;
+}
+
+// Returns the 64 bits of `bitmap` starting at bit `offset`, which may be
+// negative or extend past the end of the bitmap (see GetWordOrFill). The two
+// words straddled by the extracted bits are combined with a funnel shift.
+uint64_t ExtractWord(const InlineBitmap& bitmap, int64_t offset, bool fill) {
+  int64_t wordno = FloorOfRatio(offset, int64_t{64});
+  int64_t bit_offset = offset - wordno * 64;
+  uint64_t lo = GetWordOrFill(bitmap, wordno, fill);
+  if (bit_offset == 0) {
+    return lo;
+  }
+  uint64_t hi = GetWordOrFill(bitmap, wordno + 1, fill);
+  return (lo >> bit_offset) | (hi << (64 - bit_offset));
+}
+
+// Returns `bits` shifted right by `shift_amount` (which may be negative to
+// shift left) with `fill` shifted in at the top.
+Bits WordShift(const Bits& bits, int64_t shift_amount, bool fill) {
+  InlineBitmap result(bits.bit_count());
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    result.SetWord(i, ExtractWord(bits.bitmap(), i * 64 + shift_amount, fill));
+  }
+  return Bits::FromBitmap(std::move(result));
+}
+
+// Adds `addend` into `accum`, propagating the carry through all of `accum`.
+// A carry out of the top of `accum` is discarded.
+void AddWordsInPlace(absl::Span<uint64_t> accum,
+                     absl::Span<const uint64_t> addend) {
+  DCHECK_LE(addend.size(), accum.size());
+  uint64_t carry = 0;
+  for (int64_t i = 0; i < accum.size(); ++i) {
+    if (i >= addend.size() && carry == 0) {
+      break;
+    }
+    uint64_t a = i < addend.size() ? addend[i] : 0;
+    uint64_t sum = accum[i] + a;
+    uint64_t carry_out = sum < a ? 1 : 0;
+    accum[i] = sum + carry;
+    carry = carry_out | (accum[i] < sum ? 1 : 0);
+  }
+}
+
+// Subtracts `subtrahend` from `accum`, propagating the borrow through all of
+// `accum`. A borrow out of the top of `accum` is discarded.
+void SubWordsInPlace(absl::Span<uint64_t> accum,
+                     absl::Span<const uint64_t> subtrahend) {
+  DCHECK_LE(subtrahend.size(), accum.size());
+  uint64_t borrow = 0;
+  for (int64_t i = 0; i < accum.size(); ++i) {
+    if (i >= subtrahend.size() && borrow == 0) {
+      break;
+    }
+    uint64_t a = accum[i];
+    uint64_t s = i < subtrahend.size() ? subtrahend[i] : 0;
+    accum[i] = a - s - borrow;
+    borrow = (a < s || a - s < borrow) ? 1 : 0;
+  }
+}
+
+// Returns the full product (lhs.size() + rhs.size() words) of the
+// little-endian word vectors `lhs` and `rhs`.
+std::vector<uint64_t> MulWords(absl::Span<const uint64_t> lhs,
+                               absl::Span<const uint64_t> rhs) {
+  std::vector<uint64_t> result(lhs.size() + rhs.size(), 0);
+  const int64_t m = std::min(lhs.size(), rhs.size()) / 2;
+  if (m < kKaratsubaThresholdWords / 2) {
+    // Schoolbook multiplication.
+    for (int64_t i = 0; i < lhs.size(); ++i) {
+      uint64_t carry = 0;
+      for (int64_t j = 0; j < rhs.size(); ++j) {
+        absl::uint128 product = absl::uint128(lhs[i]) * rhs[j] +
+                                result[i + j] + carry;
+        result[i + j] = absl::Uint128Low64(product);
+        carry = absl::Uint128High64(product);
+      }
+      result[i + rhs.size()] = carry;
+    }
+    return result;
+  }
+
+  // Karatsuba multiplication. With lhs = l1 * B + l0 and rhs = r1 * B + r0
+  // where B = 2^(64 * m):
+  //
+  //   lhs * rhs = z2 * B^2 + (z1 - z2 - z0) * B + z0
+  //
+  // where z0 = l0 * r0, z2 = l1 * r1 and z1 = (l0 + l1) * (r0 + r1).
+  absl::Span<const uint64_t> l0 = lhs.subspan(0, m);
+  absl::Span<const uint64_t> l1 = lhs.subspan(m);
+  absl::Span<const uint64_t> r0 = rhs.subspan(0, m);
+  absl::Span<const uint64_t> r1 = rhs.subspan(m);
+  std::vector<uint64_t> z0 = MulWords(l0, r0);
+  std::vector<uint64_t> z2 = MulWords(l1, r1);
+  std::vector<uint64_t> lhs_sum(l1.begin(), l1.end());
+  lhs_sum.push_back(0);
+  AddWordsInPlace(absl::MakeSpan(lhs_sum), l0);
+  std::vector<uint64_t> rhs_sum(r1.begin(), r1.end());
+  rhs_sum.push_back(0);
+  AddWordsInPlace(absl::MakeSpan(rhs_sum), r0);
+  std::vector<uint64_t> z1 = MulWords(lhs_sum, rhs_sum);
+  SubWordsInPlace(absl::MakeSpan(z1), z0);
+  SubWordsInPlace(absl::MakeSpan(z1), z2);
+
+  absl::c_copy(z0, result.begin());
+  absl::c_copy(z2, result.begin() + 2 * m);
+  AddWordsInPlace(absl::MakeSpan(result).subspan(m), z1);
+  return result;
+}
+
+// Divides the little-endian word vector `words` in place by the non-zero
+// `divisor` and returns the remainder.
+uint64_t DivideWordsInPlace(absl::Span<uint64_t> words, uint64_t divisor) {
+  DCHECK_NE(divisor, 0);
+  uint64_t remainder = 0;
+  for (int64_t i = words.size() - 1; i >= 0; --i) {
+    absl::uint128 dividend = absl::MakeUint128(remainder, words[i]);
+    words[i] = absl::Uint128Low64(dividend / divisor);
+    remainder = absl::Uint128Low64(dividend % divisor);
+  }
+  return remainder;
+}
+
 }  // namespace
 
 Bits And(const Bits& lhs, const Bits& rhs) {
@@ -58,12 +234,8 @@ Bits And(const Bits& lhs, const Bits& rhs) {
     return UBits(lhs.ToUint64().value() & rhs.ToUint64().value(),
                  lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] & rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs,
+                    [](uint64_t a, uint64_t b) { return a & b; });
 }
 
 Bits NaryAnd(absl::Span<const Bits> operands) {
@@ -82,12 +254,8 @@ Bits Or(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int | rhs_int);
     return UBits(result, lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] | rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs,
+                    [](uint64_t a, uint64_t b) { return a | b; });
 }
 
 Bits NaryOr(absl::Span<const Bits> operands) {
@@ -106,12 +274,8 @@ Bits Xor(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int ^ rhs_int);
     return UBits(result, lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] ^ rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs,
+                    [](uint64_t a, uint64_t b) { return a ^ b; });
 }
 
 Bits NaryXor(absl::Span<const Bits> operands) {
@@ -129,12 +293,8 @@ Bits Nand(const Bits& lhs, const Bits& rhs) {
                      Mask(lhs.bit_count()),
                  lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] & rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs,
+                    [](uint64_t a, uint64_t b) { return ~(a & b); });
 }
 
 Bits NaryNand(absl::Span<const Bits> operands) {
@@ -152,12 +312,8 @@ Bits Nor(const Bits& lhs, const Bits& rhs) {
                      Mask(lhs.bit_count()),
                  lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] | rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs,
+                    [](uint64_t a, uint64_t b) { return ~(a | b); });
 }
 
 Bits NaryNor(absl::Span<const Bits> operands) {
@@ -173,11 +329,11 @@ Bits Not(const Bits& bits) {
     return UBits((~bits.ToUint64().value()) & Mask(bits.bit_count()),
                  bits.bit_count());
   }
-  std::vector<uint8_t> bytes = bits.ToBytes();
-  for (uint8_t& byte : bytes) {
-    byte = ~byte;
+  InlineBitmap result(bits.bit_count());
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    result.SetWord(i, ~bits.bitmap().GetWord(i));
   }
-  return Bits::FromBytes(bytes, bits.bit_count());
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits AndReduce(const Bits& operand) {
@@ -204,9 +360,9 @@ Bits Add(const Bits& lhs, const Bits& rhs) {
     return UBits(result, lhs.bit_count());
   }
 
-  Bits sum = BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                 .ToSignedBits();
-  return TruncateOrSignExtend(std::move(sum), lhs.bit_count());
+  std::vector<uint64_t> sum = ToWords(lhs);
+  AddWordsInPlace(absl::MakeSpan(sum), ToWords(rhs));
+  return FromWords(sum, lhs.bit_count());
 }
 
 Bits Sub(const Bits& lhs, const Bits& rhs) {
@@ -217,9 +373,9 @@ Bits Sub(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int - rhs_int) & Mask(lhs.bit_count());
     return UBits(result, lhs.bit_count());
   }
-  Bits diff = BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                  .ToSignedBits();
-  return TruncateOrSignExtend(std::move(diff), lhs.bit_count());
+  std::vector<uint64_t> diff = ToWords(lhs);
+  SubWordsInPlace(absl::MakeSpan(diff), ToWords(rhs));
+  return FromWords(diff, lhs.bit_count());
 }
 
 Bits Increment(const Bits& x) {
@@ -257,9 +413,22 @@ Bits SMul(const Bits& lhs, const Bits& rhs) {
     return SBits(result, result_width);
   }
 
-  BigInt product =
-      BigInt::Mul(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
-  return product.ToSignedBitsWithBitCount(result_width).value();
+  // Interpreting the operands as unsigned adds 2^n to a negative n-bit
+  // operand, so modulo 2^result_width:
+  //
+  //   smul(l, r) = umul(l, r) - msb(l) * (r << n) - msb(r) * (l << m)
+  //
+  // where n and m are the widths of l and r respectively.
+  Bits product = UMul(lhs, rhs);
+  if (lhs.msb()) {
+    product = Sub(product, ShiftLeftLogical(ZeroExtend(rhs, result_width),
+                                            lhs.bit_count()));
+  }
+  if (rhs.msb()) {
+    product = Sub(product, ShiftLeftLogical(ZeroExtend(lhs, result_width),
+                                            rhs.bit_count()));
+  }
+  return product;
 }
 
 Bits UMul(const Bits& lhs, const Bits& rhs) {
@@ -271,15 +440,18 @@ Bits UMul(const Bits& lhs, const Bits& rhs) {
     return UBits(result, result_width);
   }
 
-  BigInt product =
-      BigInt::Mul(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
-  return product.ToUnsignedBitsWithBitCount(result_width).value();
+  return FromWords(MulWords(ToWords(lhs), ToWords(rhs)), result_width);
 }
 
 Bits UDiv(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits::AllOnes(lhs.bit_count());
   }
+  if (rhs.FitsInUint64()) {
+    std::vector<uint64_t> quotient = ToWords(lhs);
+    DivideWordsInPlace(absl::MakeSpan(quotient), rhs.ToUint64().value());
+    return FromWords(quotient, lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(quotient.ToUnsignedBits(), lhs.bit_count());
@@ -289,6 +461,12 @@ Bits UMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (rhs.FitsInUint64()) {
+    std::vector<uint64_t> quotient = ToWords(lhs);
+    uint64_t remainder =
+        DivideWordsInPlace(absl::MakeSpan(quotient), rhs.ToUint64().value());
+    return UBits(remainder, rhs.bit_count());
+  }
   BigInt modulo =
       BigInt::Mod(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(modulo.ToUnsignedBits(), rhs.bit_count());
@@ -499,23 +677,19 @@ Bits Abs(const Bits& bits) {
 Bits ShiftLeftLogical(const Bits& bits, int64_t shift_amount) {
   CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.Slice(0, bits.bit_count() - shift_amount), UBits(0, shift_amount)});
+  return WordShift(bits, -shift_amount, /*fill=*/false);
 }
 
 Bits ShiftRightLogical(const Bits& bits, int64_t shift_amount) {
   CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat({UBits(0, shift_amount),
-                 bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  return WordShift(bits, shift_amount, /*fill=*/false);
 }
 
 Bits ShiftRightArith(const Bits& bits, int64_t shift_amount) {
   CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.msb() ? Bits::AllOnes(shift_amount) : UBits(0, shift_amount),
-       bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  return WordShift(bits, shift_amount, /*fill=*/bits.msb());
 }
 
 Bits OneHotLsbToMsb(const Bits& bits) {
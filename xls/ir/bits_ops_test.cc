@@ -14,6 +14,7 @@
 
 #include "xls/ir/bits_ops.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <limits>
@@ -25,10 +26,12 @@
 #include "gtest/gtest.h"
 #include "xls/common/fuzzing/fuzztest.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/random/random.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/big_int.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_test_utils.h"
 #include "xls/ir/format_preference.h"
@@ -41,6 +44,26 @@ std::string ToPlainString(const std::string& s) {
   return absl::StrJoin(absl::StrSplit(s.substr(2), '_'), "");
 }
 
+// Returns a random value of the given width. Words are biased towards all
+// zeros and all ones to exercise carry and borrow propagation.
+Bits RandomBits(int64_t bit_count, absl::BitGen& bitgen) {
+  InlineBitmap bitmap(bit_count);
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    switch (absl::Uniform(bitgen, 0, 4)) {
+      case 0:
+        bitmap.SetWord(i, 0);
+        break;
+      case 1:
+        bitmap.SetWord(i, ~uint64_t{0});
+        break;
+      default:
+        bitmap.SetWord(i, absl::Uniform<uint64_t>(bitgen));
+        break;
+    }
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
 TEST(BitsOpsTest, LogicalOps) {
   Bits empty_bits(0);
   EXPECT_EQ(empty_bits, bits_ops::And(empty_bits, empty_bits));
@@ -380,6 +403,92 @@ TEST(BitsOpsTest, SMod) {
             "0xffff_ffff_ffff_ffff_ffff_ffff_f000_a000_b000_c000");
 }
 
+TEST(BitsOpsTest, WideArithmeticMatchesBigInt) {
+  absl::BitGen bitgen;
+  for (int64_t width : {65, 100, 128, 257, 512, 1000, 2048, 4096 + 7}) {
+    for (int64_t i = 0; i < 5; ++i) {
+      Bits lhs = RandomBits(width, bitgen);
+      Bits rhs = RandomBits(absl::Uniform(bitgen, 1, width + 1), bitgen);
+      Bits same_width_rhs = bits_ops::ZeroExtend(rhs, width);
+      Bits small_rhs = RandomBits(absl::Uniform(bitgen, 1, 65), bitgen);
+
+      EXPECT_EQ(
+          bits_ops::UMul(lhs, rhs),
+          BigInt::Mul(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs))
+              .ToUnsignedBitsWithBitCount(width + rhs.bit_count())
+              .value());
+      EXPECT_EQ(bits_ops::SMul(lhs, rhs),
+                BigInt::Mul(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
+                    .ToSignedBitsWithBitCount(width + rhs.bit_count())
+                    .value());
+      EXPECT_EQ(bits_ops::Add(lhs, same_width_rhs),
+                bits_ops::Truncate(
+                    BigInt::Add(BigInt::MakeUnsigned(lhs),
+                                BigInt::MakeUnsigned(same_width_rhs))
+                        .ToUnsignedBitsWithBitCount(width + 1)
+                        .value(),
+                    width));
+      EXPECT_EQ(bits_ops::Add(bits_ops::Sub(lhs, same_width_rhs),
+                              same_width_rhs),
+                lhs);
+      if (!small_rhs.IsZero()) {
+        EXPECT_EQ(bits_ops::UDiv(lhs, small_rhs),
+                  bits_ops::ZeroExtend(BigInt::Div(BigInt::MakeUnsigned(lhs),
+                                                   BigInt::MakeUnsigned(
+                                                       small_rhs))
+                                           .ToUnsignedBits(),
+                                       width));
+        EXPECT_EQ(bits_ops::UMod(lhs, small_rhs),
+                  bits_ops::ZeroExtend(BigInt::Mod(BigInt::MakeUnsigned(lhs),
+                                                   BigInt::MakeUnsigned(
+                                                       small_rhs))
+                                           .ToUnsignedBits(),
+                                       small_rhs.bit_count()));
+      }
+    }
+  }
+}
+
+TEST(BitsOpsTest, WideShiftsAndLogicalOps) {
+  absl::BitGen bitgen;
+  for (int64_t width : {65, 128, 300, 1024}) {
+    Bits value = RandomBits(width, bitgen);
+    Bits other = RandomBits(width, bitgen);
+    for (int64_t amount : {int64_t{0}, int64_t{1}, int64_t{63}, int64_t{64},
+                           int64_t{65}, width / 2, width - 1, width,
+                           width + 10}) {
+      int64_t clamped = std::min(amount, width);
+      EXPECT_EQ(bits_ops::ShiftLeftLogical(value, amount),
+                bits_ops::Concat({value.Slice(0, width - clamped),
+                                  UBits(0, clamped)}));
+      EXPECT_EQ(bits_ops::ShiftRightLogical(value, amount),
+                bits_ops::Concat({UBits(0, clamped),
+                                  value.Slice(clamped, width - clamped)}));
+      EXPECT_EQ(bits_ops::ShiftRightArith(value, amount),
+                bits_ops::Concat({value.msb() ? Bits::AllOnes(clamped)
+                                              : UBits(0, clamped),
+                                  value.Slice(clamped, width - clamped)}));
+    }
+    int64_t popcount = 0;
+    for (int64_t i = 0; i < width; ++i) {
+      popcount += value.Get(i) ? 1 : 0;
+      EXPECT_EQ(bits_ops::And(value, other).Get(i),
+                value.Get(i) && other.Get(i));
+      EXPECT_EQ(bits_ops::Or(value, other).Get(i),
+                value.Get(i) || other.Get(i));
+      EXPECT_EQ(bits_ops::Xor(value, other).Get(i),
+                value.Get(i) != other.Get(i));
+      EXPECT_EQ(bits_ops::Nand(value, other).Get(i),
+                !(value.Get(i) && other.Get(i)));
+      EXPECT_EQ(bits_ops::Nor(value, other).Get(i),
+                !(value.Get(i) || other.Get(i)));
+    }
+    EXPECT_EQ(value.PopCount(), popcount);
+    EXPECT_EQ(bits_ops::Not(bits_ops::Not(value)), value);
+    EXPECT_EQ(bits_ops::Not(Bits(width)), Bits::AllOnes(width));
+  }
+}
+
 TEST(BitsOpsTest, UnsignedComparisons) {
   Bits b42 = UBits(42, 64);
   Bits b77 = UBits(77, 64);
@@ -1171,6 +1280,70 @@ void BM_SubCachedOne(benchmark::State& state) {
 }
 BENCHMARK(BM_SubCachedOne)->Range(64, 1 << 20);
 
+void BM_UMul(benchmark::State& state) {
+  absl::BitGen bitgen;
+  Bits lhs = RandomBits(state.range(0), bitgen);
+  Bits rhs = RandomBits(state.range(0), bitgen);
+  for (auto _ : state) {
+    auto v = bits_ops::UMul(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_UMul)->Range(64, 8192);
+
+void BM_SMul(benchmark::State& state) {
+  absl::BitGen bitgen;
+  Bits lhs = RandomBits(state.range(0), bitgen);
+  Bits rhs = RandomBits(state.range(0), bitgen);
+  for (auto _ : state) {
+    auto v = bits_ops::SMul(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_SMul)->Range(64, 8192);
+
+void BM_UDivByWord(benchmark::State& state) {
+  absl::BitGen bitgen;
+  Bits lhs = RandomBits(state.range(0), bitgen);
+  Bits rhs = bits_ops::ZeroExtend(UBits(0xdeadbeef, 32), state.range(0));
+  for (auto _ : state) {
+    auto v = bits_ops::UDiv(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_UDivByWord)->Range(64, 8192);
+
+void BM_ShiftLeftLogical(benchmark::State& state) {
+  absl::BitGen bitgen;
+  Bits value = RandomBits(state.range(0), bitgen);
+  for (auto _ : state) {
+    auto v = bits_ops::ShiftLeftLogical(value, 37);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_ShiftLeftLogical)->Range(64, 8192);
+
+void BM_Xor(benchmark::State& state) {
+  absl::BitGen bitgen;
+  Bits lhs = RandomBits(state.range(0), bitgen);
+  Bits rhs = RandomBits(state.range(0), bitgen);
+  for (auto _ : state) {
+    auto v = bits_ops::Xor(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_Xor)->Range(64, 8192);
+
+void BM_PopCount(benchmark::State& state) {
+  absl::BitGen bitgen;
+  Bits value = RandomBits(state.range(0), bitgen);
+  for (auto _ : state) {
+    auto v = value.PopCount();
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_PopCount)->Range(64, 8192);
+
 void BM_Truncate(benchmark::State& state) {
   for (auto _ : state) {
     Bits f(256);
@@ -47,6 +47,8 @@
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/package_transaction.h"
 #include "xls/ir/register.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
@@ -474,6 +476,10 @@ static absl::Status AddToMapOfNodeVectors(
 }
 
 Node* Block::AddNodeInternal(std::unique_ptr<Node> node) {
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordUnsupportedMutation(
+        "adding a block node");
+  }
   Node* ptr = FunctionBase::AddNodeInternal(std::move(node));
   if (RegisterRead* reg_read = dynamic_cast<RegisterRead*>(ptr)) {
     CHECK_OK(AddToMapOfNodeVectors(reg_read->GetRegister(), reg_read,
@@ -493,6 +499,10 @@ Node* Block::AddNodeInternal(std::unique_ptr<Node> node) {
 }
 
 absl::Status Block::RemoveNode(Node* n) {
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordUnsupportedMutation(
+        "removing a block node");
+  }
   // Similar to parameters in xls::Functions, input and output ports are also
   // also stored separately as vectors for easy access and to indicate ordering.
   // Fix up these vectors prior to removing the node.
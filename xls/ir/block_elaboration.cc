@@ -71,21 +71,14 @@ absl::StatusOr<std::optional<ElaboratedNode>> InputPortPredecessor(
   }
   // We're not the top block, an input port has the parent InstantiationInput as
   // a predecessor.
-  Instantiation* instantiation = *instance->instantiation();
   XLS_RET_CHECK(instance->parent_instance().has_value() &&
                 instance->parent_instance().value()->block().has_value());
-  Block* parent_block = *instance->parent_instance().value()->block();
-
-  absl::Span<InstantiationInput* const> inputs =
-      parent_block->GetInstantiationInputs(instantiation);
-  auto iter =
-      absl::c_find_if(inputs, [&input_port](const InstantiationInput* input) {
-        return input->port_name() == input_port->name();
-      });
-  if (iter == inputs.end()) {
+  std::optional<InstantiationInput*> input =
+      instance->GetParentInstantiationInput(input_port->name());
+  if (!input.has_value()) {
     return std::nullopt;
   }
-  return ElaboratedNode{.node = *iter,
+  return ElaboratedNode{.node = *input,
                         .instance = *instance->parent_instance()};
 }
 
@@ -97,21 +90,14 @@ absl::StatusOr<std::optional<ElaboratedNode>> OutputPortSuccessor(
   }
   // We're not the top block, an output port has the parent InstantiationOutput
   // as a successor.
-  Instantiation* instantiation = *instance->instantiation();
   XLS_RET_CHECK(instance->parent_instance().has_value() &&
                 instance->parent_instance().value()->block().has_value());
-  Block* parent_block = *instance->parent_instance().value()->block();
-
-  absl::Span<InstantiationOutput* const> outputs =
-      parent_block->GetInstantiationOutputs(instantiation);
-  auto iter = absl::c_find_if(
-      outputs, [&output_port](const InstantiationOutput* output) {
-        return output->port_name() == output_port->name();
-      });
-  if (iter == outputs.end()) {
+  std::optional<InstantiationOutput*> output =
+      instance->GetParentInstantiationOutput(output_port->name());
+  if (!output.has_value()) {
     return std::nullopt;
   }
-  return ElaboratedNode{.node = *iter,
+  return ElaboratedNode{.node = *output,
                         .instance = *instance->parent_instance()};
 }
 
@@ -657,9 +643,38 @@ BlockInstance::BlockInstance(
     if (!child_instance->instantiation().has_value()) {
       continue;
     }
-    instantiation_to_instance_.insert(
-        {*child_instance->instantiation(), child_instance.get()});
+    Instantiation* instantiation = *child_instance->instantiation();
+    instantiation_to_instance_.insert({instantiation, child_instance.get()});
+    // If a port is connected more than once, the first connection is used.
+    for (InstantiationInput* input :
+         (*block)->GetInstantiationInputs(instantiation)) {
+      child_instance->parent_inputs_by_port_.try_emplace(input->port_name(),
+                                                         input);
+    }
+    for (InstantiationOutput* output :
+         (*block)->GetInstantiationOutputs(instantiation)) {
+      child_instance->parent_outputs_by_port_.try_emplace(output->port_name(),
+                                                          output);
+    }
+  }
+}
+
+std::optional<InstantiationInput*> BlockInstance::GetParentInstantiationInput(
+    std::string_view port_name) const {
+  auto it = parent_inputs_by_port_.find(port_name);
+  if (it == parent_inputs_by_port_.end()) {
+    return std::nullopt;
   }
+  return it->second;
+}
+
+std::optional<InstantiationOutput*>
+BlockInstance::GetParentInstantiationOutput(std::string_view port_name) const {
+  auto it = parent_outputs_by_port_.find(port_name);
+  if (it == parent_outputs_by_port_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
 }
 
 std::string BlockInstance::ToString() const {
@@ -34,6 +34,8 @@
 namespace xls {
 class BlockInstance;
 class ElaboratedBlockDfsVisitor;
+class InstantiationInput;
+class InstantiationOutput;
 
 // A node and its associated hierarchical instance.
 struct ElaboratedNode {
@@ -125,6 +127,17 @@ class BlockInstance {
     return parent_instance_;
   }
 
+  // Returns the InstantiationInput in the parent block which drives the input
+  // port `port_name` of this instance, if any. These are indexed when the
+  // elaboration is built so linking ports across the hierarchy takes constant
+  // time regardless of the number of ports.
+  std::optional<InstantiationInput*> GetParentInstantiationInput(
+      std::string_view port_name) const;
+  // Returns the InstantiationOutput in the parent block which reads the output
+  // port `port_name` of this instance, if any.
+  std::optional<InstantiationOutput*> GetParentInstantiationOutput(
+      std::string_view port_name) const;
+
  private:
   std::optional<Block*> block_;
   std::optional<Instantiation*> instantiation_;
@@ -141,6 +154,12 @@ class BlockInstance {
   // Each pointer (keys and values!) must be non-null.
   absl::flat_hash_map<Instantiation*, BlockInstance*>
       instantiation_to_instance_;
+  // The nodes of the parent block connected to the ports of this instance,
+  // keyed by port name. Empty for the root instance.
+  absl::flat_hash_map<std::string_view, InstantiationInput*>
+      parent_inputs_by_port_;
+  absl::flat_hash_map<std::string_view, InstantiationOutput*>
+      parent_outputs_by_port_;
 };
 
 // Data structure representing the elaboration tree starting from a root block.
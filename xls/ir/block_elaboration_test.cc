@@ -227,6 +227,32 @@ TEST_F(ElaborationTest, ElaborateMultipleBlockInstantiations) {
                           "instance count: 3")));
 }
 
+TEST_F(ElaborationTest, ParentInstantiationPorts) {
+  auto p = CreatePackage();
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, MultipleAddInstantiations(*p));
+  XLS_ASSERT_OK_AND_ASSIGN(BlockElaboration elab,
+                           BlockElaboration::Elaborate(block));
+
+  EXPECT_EQ(elab.top()->GetParentInstantiationInput("a"), std::nullopt);
+  EXPECT_EQ(elab.top()->GetParentInstantiationOutput("c"), std::nullopt);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockInstance * adder2,
+      elab.GetInstance("multi_adder::adder2_inst->adder"));
+  std::optional<InstantiationInput*> input =
+      adder2->GetParentInstantiationInput("a");
+  ASSERT_TRUE(input.has_value());
+  EXPECT_THAT(*input,
+              m::InstantiationInput(m::InstantiationOutput("c"), "a"));
+  std::optional<InstantiationOutput*> output =
+      adder2->GetParentInstantiationOutput("c");
+  ASSERT_TRUE(output.has_value());
+  EXPECT_THAT(output.value()->users(), ElementsAre(m::OutputPort("out")));
+  EXPECT_EQ(adder2->GetParentInstantiationInput("c"), std::nullopt);
+  EXPECT_EQ(adder2->GetParentInstantiationOutput("a"), std::nullopt);
+}
+
 TEST_F(ElaborationTest, ElaborateFifoInstantiation) {
   auto p = CreatePackage();
 
@@ -25,21 +25,36 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/package_transaction.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 
 namespace xls {
 
+absl::Status Function::set_return_value(Node* n) {
+  XLS_RET_CHECK_EQ(n->function_base(), this) << absl::StreamFormat(
+      "Return value node %s is not in this function %s (is in function %s)",
+      n->GetName(), name(), n->function_base()->name());
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordReturnValueChanged(this);
+  }
+  return_value_ = n;
+  IncrementGraphVersion();
+  return absl::OkStatus();
+}
+
 FunctionType* Function::GetType() {
   std::vector<Type*> arg_types;
   for (Param* param : params()) {
@@ -16,7 +16,6 @@
 #define XLS_IR_FUNCTION_H_
 
 #include <functional>
-#include <list>
 #include <memory>
 #include <optional>
 #include <string>
@@ -36,9 +35,6 @@
 namespace xls {
 
 class Function : public FunctionBase {
- private:
-  using NodeList = std::list<std::unique_ptr<Node>>;
-
  public:
   Function(std::string_view name, Package* package)
       : FunctionBase(name, package) {}
@@ -48,13 +44,7 @@ class Function : public FunctionBase {
   Node* return_value() const { return return_value_; }
 
   // Sets the node that serves as the return value of this function.
-  absl::Status set_return_value(Node* n) {
-    XLS_RET_CHECK_EQ(n->function_base(), this) << absl::StreamFormat(
-        "Return value node %s is not in this function %s (is in function %s)",
-        n->GetName(), name(), n->function_base()->name());
-    return_value_ = n;
-    return absl::OkStatus();
-  }
+  absl::Status set_return_value(Node* n);
 
   FunctionType* GetType();
 
@@ -87,6 +77,8 @@ class Function : public FunctionBase {
   bool HasImplicitUse(Node* node) const final { return node == return_value(); }
 
  private:
+  friend class PackageTransaction;
+
   Node* return_value_ = nullptr;
 };
 
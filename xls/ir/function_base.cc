@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
@@ -25,12 +26,14 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
@@ -43,6 +46,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/package_transaction.h"
 #include "xls/ir/proc.h"
 
 namespace xls {
@@ -94,8 +98,13 @@ absl::Status FunctionBase::MoveParamToIndex(Param* param, int64_t index) {
         "Given param is not a member of this function base: " +
         param->ToString());
   }
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordParamMoved(
+        param, std::distance(params_.begin(), it));
+  }
   params_.erase(it);
   params_.insert(params_.begin() + index, param);
+  IncrementModificationCount();
   return absl::OkStatus();
 }
 
@@ -125,6 +134,7 @@ absl::StatusOr<Node*> FunctionBase::GetNode(
 }
 
 absl::Status FunctionBase::RemoveNode(Node* node) {
+  XLS_RET_CHECK_EQ(node->function_base(), this) << node->GetName();
   XLS_RET_CHECK(node->users().empty()) << node->GetName();
   XLS_RET_CHECK(!HasImplicitUse(node)) << node->GetName();
   VLOG(4) << absl::StrFormat("Removing node from FunctionBase %s: %s", name(),
@@ -139,7 +149,11 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   for (Node* operand : unique_operands) {
     operand->RemoveUser(node);
   }
+  // Position of the node in `params_` or `next_values_`, if applicable.
+  std::optional<int64_t> list_index;
   if (node->Is<Param>()) {
+    auto it = absl::c_find(params_, node);
+    list_index = std::distance(params_.begin(), it);
     params_.erase(std::remove(params_.begin(), params_.end(), node),
                   params_.end());
   }
@@ -150,15 +164,59 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
     Next* next = node->As<Next>();
     StateRead* state_read = next->state_read()->As<StateRead>();
     next_values_by_state_read_.at(state_read).erase(next);
+    list_index = std::distance(next_values_.begin(),
+                               absl::c_find(next_values_, next));
     std::erase(next_values_, next);
   }
-  auto node_it = node_iterators_.find(node);
-  XLS_RET_CHECK(node_it != node_iterators_.end());
-  nodes_.erase(node_it->second);
-  node_iterators_.erase(node_it);
+  std::erase_if(
+      removal_trackers_,
+      [&](const std::weak_ptr<absl::flat_hash_set<int64_t>>& tracker) {
+        std::shared_ptr<absl::flat_hash_set<int64_t>> removed = tracker.lock();
+        if (removed == nullptr) {
+          return true;
+        }
+        removed->insert(node->id());
+        return false;
+      });
+  if (PackageTransaction* transaction = package()->transaction();
+      transaction != nullptr) {
+    // Keep the node alive so the removal can be rolled back.
+    auto next_position = std::next(node->node_list_position_);
+    Node* next_node =
+        next_position == nodes_.end() ? nullptr : next_position->get();
+    std::unique_ptr<Node> removed = std::move(*node->node_list_position_);
+    nodes_.erase(node->node_list_position_);
+    transaction->RecordNodeRemoved(this, std::move(removed), next_node,
+                                   list_index);
+  } else {
+    nodes_.erase(node->node_list_position_);
+  }
+  IncrementGraphVersion();
   return absl::OkStatus();
 }
 
+std::shared_ptr<const absl::flat_hash_set<int64_t>>
+FunctionBase::TrackNodeRemovals() {
+  auto removed = std::make_shared<absl::flat_hash_set<int64_t>>();
+  removal_trackers_.push_back(removed);
+  return removed;
+}
+
+std::optional<std::vector<Node*>> FunctionBase::GetCachedReverseTopoSort()
+    const {
+  absl::MutexLock lock(&topo_sort_cache_mutex_);
+  if (topo_sort_cache_version_ != graph_version_) {
+    return std::nullopt;
+  }
+  return topo_sort_cache_;
+}
+
+void FunctionBase::SetCachedReverseTopoSort(std::vector<Node*> order) const {
+  absl::MutexLock lock(&topo_sort_cache_mutex_);
+  topo_sort_cache_ = std::move(order);
+  topo_sort_cache_version_ = graph_version_;
+}
+
 absl::Status FunctionBase::Accept(DfsVisitor* visitor) {
   for (Node* node : nodes()) {
     if (node->users().empty()) {
@@ -245,7 +303,11 @@ Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
     next_values_by_state_read_.at(state_read).insert(next);
   }
   Node* ptr = node.get();
-  node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
+  ptr->node_list_position_ = nodes_.insert(nodes_.end(), std::move(node));
+  IncrementGraphVersion();
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordNodeAdded(ptr);
+  }
   return ptr;
 }
 
@@ -15,6 +15,7 @@
 #ifndef XLS_IR_FUNCTION_BASE_H_
 #define XLS_IR_FUNCTION_BASE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -22,13 +23,17 @@
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
 #include "xls/common/status/status_macros.h"
@@ -36,6 +41,7 @@
 #include "xls/ir/foreign_function_data.pb.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_allocator.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/unwrapping_iterator.h"
@@ -44,22 +50,41 @@
 namespace xls {
 
 class Function;
+class PackageTransaction;
 class Proc;
 
 // Base class for Functions and Procs. A holder of a set of nodes.
 class FunctionBase {
  protected:
-  using NodeList = std::list<std::unique_ptr<Node>>;
+  using NodeList = Node::NodeList;
 
  public:
   FunctionBase(std::string_view name, Package* package)
-      : name_(name), package_(package) {}
+      : name_(name),
+        package_(package),
+        nodes_(NodeStlAllocator<std::unique_ptr<Node>>(&node_arena())),
+        uid_(next_uid_.fetch_add(1, std::memory_order_relaxed)),
+        node_name_uniquer_(
+            /*separator=*/"__", GetIrReservedWords(),
+            package == nullptr ? nullptr : &package->name_table()) {}
   FunctionBase(const FunctionBase& other) = delete;
   void operator=(const FunctionBase& other) = delete;
 
   virtual ~FunctionBase() = default;
 
   Package* package() const { return package_; }
+
+  // Returns the arena from which the nodes of this function base are
+  // allocated.
+  NodeArena& node_arena() const {
+    return package_ == nullptr ? NodeArena::Default()
+                               : package_->node_arena();
+  }
+
+  // Returns an id which is unique among all function bases created by the
+  // process. Unlike the address of the function base it is never reused, so
+  // it may be used to key caches which outlive the function base.
+  int64_t uid() const { return uid_; }
   const std::string& name() const { return name_; }
   void SetName(std::string_view name) { name_ = name; }
   std::string qualified_name() const {
@@ -103,6 +128,49 @@ class FunctionBase {
 
   int64_t node_count() const { return nodes_.size(); }
 
+  // Returns a counter which is incremented whenever the graph structure of
+  // this function base changes: a node is added or removed, an operand edge
+  // changes, or the return value of a function is set. Used to invalidate
+  // cached analyses of the graph such as the topological order.
+  int64_t graph_version() const { return graph_version_; }
+  void IncrementGraphVersion() {
+    ++graph_version_;
+    ++modification_count_;
+  }
+
+  // Returns a counter which is incremented on every modification of this
+  // function base, including those which leave the graph structure unchanged
+  // such as renaming a node or changing a node attribute.
+  int64_t modification_count() const { return modification_count_; }
+  void IncrementModificationCount() { ++modification_count_; }
+
+  // Returns a set to which the ids of the nodes removed from this function base
+  // are added from now on, for as long as the set is held. This lets analyses
+  // which outlive modifications of the function base tell whether a node they
+  // have seen still exists without rescanning the function base.
+  std::shared_ptr<const absl::flat_hash_set<int64_t>> TrackNodeRemovals();
+
+  // Records that running `transform` (an opaque key, e.g. a pass instance)
+  // within the fixed-point session `session` left this function base
+  // unchanged at the current modification count. Only the most recent record
+  // for each transform is kept.
+  void RecordUnchangedBy(const void* transform, int64_t session) {
+    unchanged_by_[transform] = {session, modification_count_};
+  }
+  // Returns whether `transform` is known to leave this function base
+  // unchanged: it was recorded as such within `session` and the function
+  // base has not been modified since.
+  bool IsUnchangedBy(const void* transform, int64_t session) const {
+    auto it = unchanged_by_.find(transform);
+    return it != unchanged_by_.end() &&
+           it->second == std::make_pair(session, modification_count_);
+  }
+
+  // Returns the cached reverse topological order of the nodes (see
+  // ReverseTopoSort) if it was recorded at the current graph version.
+  std::optional<std::vector<Node*>> GetCachedReverseTopoSort() const;
+  void SetCachedReverseTopoSort(std::vector<Node*> order) const;
+
   // Expose Nodes, so that transformation passes can operate
   // on this function.
   xabsl::iterator_range<UnwrappingIterator<NodeList::iterator>> nodes() {
@@ -132,8 +200,8 @@ class FunctionBase {
   template <typename NodeT, typename... Args>
     requires(std::is_base_of_v<Node, NodeT>)
   absl::StatusOr<NodeT*> MakeNode(Args&&... args) {
-    NodeT* new_node = AddNode(std::make_unique<NodeT>(
-        std::forward<Args>(args)..., /*name=*/"", this));
+    NodeT* new_node = AddNode(std::unique_ptr<NodeT>(new (node_arena()) NodeT(
+        std::forward<Args>(args)..., /*name=*/"", this)));
     XLS_RETURN_IF_ERROR(VerifyNode(new_node));
     return new_node;
   }
@@ -141,8 +209,8 @@ class FunctionBase {
   template <typename NodeT, typename... Args>
     requires(std::is_base_of_v<Node, NodeT>)
   absl::StatusOr<NodeT*> MakeNodeWithName(Args&&... args) {
-    NodeT* new_node =
-        AddNode(std::make_unique<NodeT>(std::forward<Args>(args)..., this));
+    NodeT* new_node = AddNode(std::unique_ptr<NodeT>(
+        new (node_arena()) NodeT(std::forward<Args>(args)..., this)));
     XLS_RETURN_IF_ERROR(VerifyNode(new_node));
     return new_node;
   }
@@ -169,6 +237,11 @@ class FunctionBase {
     return node_name_uniquer_.GetSanitizedUniqueName(name);
   }
 
+  // As above but returns the id of the name in the package's NameTable.
+  int32_t UniquifyNodeNameId(std::string_view name) {
+    return node_name_uniquer_.GetSanitizedUniqueNameId(name);
+  }
+
   // Returns whether this FunctionBase is a function, proc, or block.
   bool IsFunction() const;
   bool IsProc() const;
@@ -215,6 +288,9 @@ class FunctionBase {
   };
 
  protected:
+  // PackageTransaction restores removed nodes on rollback.
+  friend class PackageTransaction;
+
   // Internal virtual helper for adding a node. Returns a pointer to the newly
   // added node.
   virtual Node* AddNodeInternal(std::unique_ptr<Node> node);
@@ -227,18 +303,39 @@ class FunctionBase {
   std::optional<int64_t> initiation_interval_;
 
   // Store Nodes in std::list as they can be added and removed arbitrarily and
-  // we want a stable iteration order. Keep a map from instruction pointer to
-  // location in the list for fast lookup.
+  // we want a stable iteration order. Each node records its position in the
+  // list for fast removal.
   NodeList nodes_;
-  absl::flat_hash_map<const Node*, NodeList::iterator> node_iterators_;
+
+  static inline std::atomic<int64_t> next_uid_ = 0;
+  int64_t uid_;
+
+  int64_t graph_version_ = 0;
+  int64_t modification_count_ = 0;
+
+  // Map from transform to the (session, modification count) at which the
+  // transform last ran without changing this function base.
+  absl::flat_hash_map<const void*, std::pair<int64_t, int64_t>> unchanged_by_;
+
+  // The sets returned by TrackNodeRemovals which may still be held.
+  std::vector<std::weak_ptr<absl::flat_hash_set<int64_t>>> removal_trackers_;
+
+  // Cache of the reverse topological order of `nodes_` and the graph version
+  // at which it was computed. Guarded by a mutex as TopoSort may be called
+  // concurrently on a function base which is not being mutated.
+  mutable absl::Mutex topo_sort_cache_mutex_;
+  mutable int64_t topo_sort_cache_version_
+      ABSL_GUARDED_BY(topo_sort_cache_mutex_) = -1;
+  mutable std::vector<Node*> topo_sort_cache_
+      ABSL_GUARDED_BY(topo_sort_cache_mutex_);
 
   std::vector<Param*> params_;
   std::vector<Next*> next_values_;
   absl::flat_hash_map<StateRead*, absl::btree_set<Next*, Node::NodeIdLessThan>>
       next_values_by_state_read_;
 
-  NameUniquer node_name_uniquer_ =
-      NameUniquer(/*separator=*/"__", GetIrReservedWords());
+  // Interns the node names in the name table of the package.
+  NameUniquer node_name_uniquer_;
 
   std::optional<xls::ForeignFunctionData> foreign_function_;
 };
@@ -25,6 +25,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
@@ -37,6 +38,8 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/symbolized_stacktrace.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/foreign_function_data.pb.h"
@@ -44,6 +47,7 @@
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
@@ -58,6 +62,83 @@
 #include "xls/ir/verify_node.h"
 
 namespace xls {
+namespace {
+
+// Returns the result of applying `op` to the literal values `operands` if `op`
+// is one of the cheap operations folded by builders which simplify.
+std::optional<Value> FoldOp(Op op, absl::Span<const Value> operands) {
+  if (op == Op::kEq || op == Op::kNe) {
+    return Value(UBits((operands[0] == operands[1]) == (op == Op::kEq), 1));
+  }
+  std::vector<Bits> bits;
+  for (const Value& operand : operands) {
+    if (!operand.IsBits()) {
+      return std::nullopt;
+    }
+    // Leave malformed operations to the verifier.
+    if (op != Op::kConcat &&
+        operand.bits().bit_count() != operands[0].bits().bit_count()) {
+      return std::nullopt;
+    }
+    bits.push_back(operand.bits());
+  }
+  auto predicate = [](bool value) { return Value(UBits(value ? 1 : 0, 1)); };
+  switch (op) {
+    case Op::kNot:
+      return Value(bits_ops::Not(bits[0]));
+    case Op::kNeg:
+      return Value(bits_ops::Negate(bits[0]));
+    case Op::kAnd:
+      return Value(bits_ops::NaryAnd(bits));
+    case Op::kOr:
+      return Value(bits_ops::NaryOr(bits));
+    case Op::kXor:
+      return Value(bits_ops::NaryXor(bits));
+    case Op::kNand:
+      return Value(bits_ops::NaryNand(bits));
+    case Op::kNor:
+      return Value(bits_ops::NaryNor(bits));
+    case Op::kAdd:
+      return Value(bits_ops::Add(bits[0], bits[1]));
+    case Op::kSub:
+      return Value(bits_ops::Sub(bits[0], bits[1]));
+    case Op::kULt:
+      return predicate(bits_ops::ULessThan(bits[0], bits[1]));
+    case Op::kULe:
+      return predicate(bits_ops::ULessThanOrEqual(bits[0], bits[1]));
+    case Op::kUGt:
+      return predicate(bits_ops::UGreaterThan(bits[0], bits[1]));
+    case Op::kUGe:
+      return predicate(bits_ops::UGreaterThanOrEqual(bits[0], bits[1]));
+    case Op::kSLt:
+      return predicate(bits_ops::SLessThan(bits[0], bits[1]));
+    case Op::kSLe:
+      return predicate(bits_ops::SLessThanOrEqual(bits[0], bits[1]));
+    case Op::kSGt:
+      return predicate(bits_ops::SGreaterThan(bits[0], bits[1]));
+    case Op::kSGe:
+      return predicate(bits_ops::SGreaterThanOrEqual(bits[0], bits[1]));
+    case Op::kConcat:
+      return Value(bits_ops::Concat(bits));
+    default:
+      return std::nullopt;
+  }
+}
+
+// Returns whether `node` may be removed by a simplifying builder: it is dead
+// and a pure, cheap operation of the kind the builder bypasses.
+bool IsRemovableBypassedNode(Node* node) {
+  if (!node->users().empty() || node->function_base()->HasImplicitUse(node)) {
+    return false;
+  }
+  return node->Is<xls::Literal>() || node->Is<xls::Tuple>() ||
+         node->Is<xls::TupleIndex>() || node->Is<ExtendOp>() ||
+         node->Is<xls::BitSlice>() || node->Is<xls::Concat>() ||
+         node->Is<UnOp>() || node->Is<NaryOp>() || node->Is<CompareOp>() ||
+         node->OpIn({Op::kAdd, Op::kSub});
+}
+
+}  // namespace
 
 std::ostream& operator<<(std::ostream& os, const BValue& bv) {
   return os << bv.ToString();
@@ -118,10 +199,65 @@ void BuilderBase::SetForeignFunctionData(
   function_->SetForeignFunctionData(ff);
 }
 
+BValue BuilderBase::Forward(Node* node) {
+  last_node_ = node;
+  return BValue(node, this);
+}
+
+std::optional<BValue> BuilderBase::MaybeSimplify(
+    Op op, absl::Span<const BValue> operands, const SourceInfo& loc,
+    std::string_view name) {
+  if (!simplify_ || !name.empty()) {
+    return std::nullopt;
+  }
+  if (op == Op::kIdentity || (op == Op::kConcat && operands.size() == 1)) {
+    return Forward(operands[0].node());
+  }
+  std::vector<Value> values;
+  for (const BValue& operand : operands) {
+    if (!operand.node()->Is<xls::Literal>()) {
+      return std::nullopt;
+    }
+    values.push_back(operand.node()->As<xls::Literal>()->value());
+  }
+  std::optional<Value> folded = FoldOp(op, values);
+  if (!folded.has_value()) {
+    return std::nullopt;
+  }
+  for (const BValue& operand : operands) {
+    bypassed_nodes_.push_back(operand.node());
+  }
+  return Literal(*std::move(folded), loc);
+}
+
+absl::Status BuilderBase::RemoveDeadBypassedNodes(FunctionBase* f) {
+  std::vector<Node*> worklist = std::move(bypassed_nodes_);
+  bypassed_nodes_.clear();
+  absl::flat_hash_set<Node*> removed;
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (removed.contains(node) || !IsRemovableBypassedNode(node)) {
+      continue;
+    }
+    std::vector<Node*> operands(node->operands().begin(),
+                                node->operands().end());
+    XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+    removed.insert(node);
+    for (Node* operand : operands) {
+      if (!removed.contains(operand)) {
+        worklist.push_back(operand);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 template <typename NodeT, typename... Args>
 BValue BuilderBase::AddNode(const SourceInfo& loc, Args&&... args) {
-  last_node_ = function_->AddNode<NodeT>(std::make_unique<NodeT>(
-      loc, std::forward<Args>(args)..., function_.get()));
+  last_node_ = function_->AddNode<NodeT>(
+      std::unique_ptr<NodeT>(new (function_->node_arena()) NodeT(
+          loc, std::forward<Args>(args)..., function_.get())));
   return CreateBValue(last_node_, loc);
 }
 
@@ -433,6 +569,17 @@ BValue BuilderBase::TupleIndex(BValue arg, int64_t idx, const SourceInfo& loc,
             GetType(arg)->ToString()),
         loc);
   }
+  if (simplify_ && name.empty() && idx >= 0 &&
+      idx < GetType(arg)->AsTupleOrDie()->size()) {
+    if (arg.node()->Is<xls::Tuple>()) {
+      bypassed_nodes_.push_back(arg.node());
+      return Forward(arg.node()->operand(idx));
+    }
+    if (arg.node()->Is<xls::Literal>()) {
+      bypassed_nodes_.push_back(arg.node());
+      return Literal(arg.node()->As<xls::Literal>()->value().element(idx), loc);
+    }
+  }
   return AddNode<xls::TupleIndex>(loc, arg.node(), idx, name);
 }
 
@@ -651,6 +798,19 @@ BValue BuilderBase::SignExtend(BValue arg, int64_t new_bit_count,
   if (ErrorPending()) {
     return BValue();
   }
+  if (simplify_ && name.empty() && GetType(arg)->IsBits()) {
+    int64_t bit_count = GetType(arg)->GetFlatBitCount();
+    if (new_bit_count == bit_count) {
+      return Forward(arg.node());
+    }
+    if (arg.node()->Is<xls::Literal>() && new_bit_count > bit_count) {
+      bypassed_nodes_.push_back(arg.node());
+      return Literal(
+          Value(bits_ops::SignExtend(
+              arg.node()->As<xls::Literal>()->value().bits(), new_bit_count)),
+          loc);
+    }
+  }
   return AddNode<xls::ExtendOp>(loc, arg.node(), new_bit_count, Op::kSignExt,
                                 name);
 }
@@ -660,6 +820,19 @@ BValue BuilderBase::ZeroExtend(BValue arg, int64_t new_bit_count,
   if (ErrorPending()) {
     return BValue();
   }
+  if (simplify_ && name.empty() && GetType(arg)->IsBits()) {
+    int64_t bit_count = GetType(arg)->GetFlatBitCount();
+    if (new_bit_count == bit_count) {
+      return Forward(arg.node());
+    }
+    if (arg.node()->Is<xls::Literal>() && new_bit_count > bit_count) {
+      bypassed_nodes_.push_back(arg.node());
+      return Literal(
+          Value(bits_ops::ZeroExtend(
+              arg.node()->As<xls::Literal>()->value().bits(), new_bit_count)),
+          loc);
+    }
+  }
   return AddNode<xls::ExtendOp>(loc, arg.node(), new_bit_count, Op::kZeroExt,
                                 name);
 }
@@ -669,6 +842,19 @@ BValue BuilderBase::BitSlice(BValue arg, int64_t start, int64_t width,
   if (ErrorPending()) {
     return BValue();
   }
+  if (simplify_ && name.empty() && GetType(arg)->IsBits() && start >= 0 &&
+      width >= 0 && start + width <= GetType(arg)->GetFlatBitCount()) {
+    if (start == 0 && width == GetType(arg)->GetFlatBitCount()) {
+      return Forward(arg.node());
+    }
+    if (arg.node()->Is<xls::Literal>()) {
+      bypassed_nodes_.push_back(arg.node());
+      return Literal(
+          Value(arg.node()->As<xls::Literal>()->value().bits().Slice(start,
+                                                                      width)),
+          loc);
+    }
+  }
   return AddNode<xls::BitSlice>(loc, arg.node(), start, width, name);
 }
 
@@ -1017,6 +1203,10 @@ BValue BuilderBase::Concat(absl::Span<const BValue> operands,
           loc);
     }
   }
+  if (std::optional<BValue> simplified =
+          MaybeSimplify(Op::kConcat, operands, loc, name)) {
+    return *simplified;
+  }
   return AddNode<xls::Concat>(loc, node_operands, name);
 }
 
@@ -1063,6 +1253,7 @@ absl::StatusOr<Function*> FunctionBuilder::BuildWithReturnValue(
   Function* f = package()->AddFunction(
       absl::WrapUnique(down_cast<Function*>(function_.release())));
   XLS_RETURN_IF_ERROR(f->set_return_value(return_value.node()));
+  XLS_RETURN_IF_ERROR(RemoveDeadBypassedNodes(f));
   if (should_verify_) {
     XLS_RETURN_IF_ERROR(VerifyFunction(f));
   }
@@ -1196,6 +1387,7 @@ absl::StatusOr<Proc*> ProcBuilder::Build(absl::Span<const BValue> next_state) {
   for (int64_t i = 0; i < next_state.size(); ++i) {
     XLS_RETURN_IF_ERROR(proc->SetNextStateElement(i, next_state[i].node()));
   }
+  XLS_RETURN_IF_ERROR(RemoveDeadBypassedNodes(proc));
   if (should_verify_) {
     XLS_RETURN_IF_ERROR(VerifyProc(proc));
   }
@@ -1362,6 +1554,9 @@ BValue BuilderBase::AddUnOp(Op op, BValue x, const SourceInfo& loc,
                                     OpToString(op)),
                     loc);
   }
+  if (std::optional<BValue> simplified = MaybeSimplify(op, {x}, loc, name)) {
+    return *simplified;
+  }
   return AddNode<UnOp>(loc, x.node(), op, name);
 }
 
@@ -1376,6 +1571,10 @@ BValue BuilderBase::AddBinOp(Op op, BValue lhs, BValue rhs,
                                     OpToString(op)),
                     loc);
   }
+  if (std::optional<BValue> simplified =
+          MaybeSimplify(op, {lhs, rhs}, loc, name)) {
+    return *simplified;
+  }
   return AddNode<BinOp>(loc, lhs.node(), rhs.node(), op, name);
 }
 
@@ -1391,6 +1590,10 @@ BValue BuilderBase::AddCompareOp(Op op, BValue lhs, BValue rhs,
                         OpToString(op)),
         loc);
   }
+  if (std::optional<BValue> simplified =
+          MaybeSimplify(op, {lhs, rhs}, loc, name)) {
+    return *simplified;
+  }
   return AddNode<CompareOp>(loc, lhs.node(), rhs.node(), op, name);
 }
 
@@ -1404,6 +1607,9 @@ BValue BuilderBase::AddNaryOp(Op op, absl::Span<const BValue> args,
                                     OpToString(op)),
                     loc);
   }
+  if (std::optional<BValue> simplified = MaybeSimplify(op, args, loc, name)) {
+    return *simplified;
+  }
   std::vector<Node*> nodes;
   for (const BValue& bvalue : args) {
     nodes.push_back(bvalue.node());
@@ -159,6 +159,21 @@ class BuilderBase {
   // a foreign function.
   void SetForeignFunctionData(const std::optional<ForeignFunctionData>& ff);
 
+  // Enables simplification of trivially redundant operations as they are
+  // built. When enabled, operations without a requested name are simplified
+  // as follows rather than added to the function:
+  //
+  //  - tuple_index of a tuple (or tuple literal) returns the element,
+  //  - identity, extension to the operand's width, bit_slice of all of the
+  //    operand's bits and single-operand concat return the operand,
+  //  - cheap bits operations (bitwise, add, sub, comparisons, extensions,
+  //    slices, concat) of literals are folded to a literal.
+  //
+  // The returned BValue may then refer to a previously built node. Nodes
+  // which were bypassed this way and are dead when the function or proc is
+  // built are removed. Disabled by default.
+  void set_simplify(bool value) { simplify_ = value; }
+
   // Get access to currently built up function (or proc).
   FunctionBase* function() const { return function_.get(); }
 
@@ -672,6 +687,19 @@ class BuilderBase {
 
   BValue CreateBValue(Node* node, const SourceInfo& loc);
 
+  // Returns `node` as the result of a simplified operation.
+  BValue Forward(Node* node);
+
+  // Returns the simplification of applying `op` to `operands` if simplification
+  // is enabled and possible. See set_simplify.
+  std::optional<BValue> MaybeSimplify(Op op, absl::Span<const BValue> operands,
+                                      const SourceInfo& loc,
+                                      std::string_view name);
+
+  // Removes the nodes of `f` bypassed by simplification which are dead, and
+  // the operands of those nodes which become dead in turn.
+  absl::Status RemoveDeadBypassedNodes(FunctionBase* f);
+
   // The most recently added node to the function.
   Node* last_node_ = nullptr;
 
@@ -684,6 +712,10 @@ class BuilderBase {
   // tests.
   bool should_verify_;
 
+  bool simplify_ = false;
+  // Nodes whose uses were bypassed by simplification.
+  std::vector<Node*> bypassed_nodes_;
+
   std::string error_msg_;
   std::string error_stacktrace_;
   SourceInfo error_loc_;
@@ -1119,6 +1119,35 @@ TEST(FunctionBuilderTest, Ports) {
   EXPECT_FALSE(blk->HasInputPort("bar"));
 }
 
+TEST(FunctionBuilderTest, Simplify) {
+  Package p("p");
+  FunctionBuilder b("f", &p);
+  b.set_simplify(true);
+  BValue x = b.Param("x", p.GetBitsType(32));
+  BValue y = b.Param("y", p.GetBitsType(32));
+  BValue t = b.Tuple({x, y});
+  EXPECT_EQ(b.TupleIndex(t, 1).node(), y.node());
+  EXPECT_EQ(b.ZeroExtend(x, 32).node(), x.node());
+  EXPECT_EQ(b.BitSlice(y, 0, 32).node(), y.node());
+  BValue sum = b.Add(b.Literal(UBits(2, 32)), b.Literal(UBits(3, 32)));
+  EXPECT_THAT(sum.node(), m::Literal(UBits(5, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           b.BuildWithReturnValue(b.Add(x, sum)));
+  // The tuple and the folded literal operands are dead and removed.
+  EXPECT_THAT(f->return_value(), m::Add(m::Param("x"), m::Literal(5)));
+  EXPECT_EQ(f->node_count(), 4);
+}
+
+TEST(FunctionBuilderTest, SimplifyDisabledByDefault) {
+  Package p("p");
+  FunctionBuilder b("f", &p);
+  BValue x = b.Param("x", p.GetBitsType(32));
+  BValue t = b.Tuple({x});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           b.BuildWithReturnValue(b.TupleIndex(t, 0)));
+  EXPECT_THAT(f->return_value(), m::TupleIndex(m::Tuple(m::Param("x")), 0));
+}
+
 TEST(FunctionBuilderTest, Registers) {
   Package p("p");
   BlockBuilder b("b", &p);
@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -83,7 +84,7 @@ void IntervalSet::Normalize() {
 
   Bits zero(BitCount());
   Bits max = Bits::AllOnes(BitCount());
-  std::vector<Interval> expand_improper;
+  absl::InlinedVector<Interval, 8> expand_improper;
   for (const Interval& interval : intervals_) {
     if (interval.IsImproper()) {
       expand_improper.push_back(Interval(zero, interval.UpperBound()));
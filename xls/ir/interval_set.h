@@ -19,10 +19,12 @@
 #include <cstdint>
 #include <functional>
 #include <iosfwd>
+#include <iterator>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
@@ -84,7 +86,8 @@ class IntervalSet {
 
   std::vector<Interval> Intervals() && {
     CHECK(is_normalized_);
-    return intervals_;
+    return std::vector<Interval>(std::make_move_iterator(intervals_.begin()),
+                                 std::make_move_iterator(intervals_.end()));
   }
 
   class SignedIntervalIterator {
@@ -295,7 +298,9 @@ class IntervalSet {
  private:
   bool is_normalized_;
   int64_t bit_count_;
-  std::vector<Interval> intervals_;
+  // Most sets hold only a few intervals, so keep those inline to avoid a heap
+  // allocation per set.
+  absl::InlinedVector<Interval, 4> intervals_;
 };
 
 inline std::ostream& operator<<(std::ostream& os,
@@ -43,6 +43,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/visitor.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/channel.h"
@@ -2745,6 +2746,14 @@ Parser::ParsePackageWithEntry(std::string_view input_string,
 Parser::ParsePackageNoVerify(std::string_view input_string,
                              std::optional<std::string_view> filename,
                              std::optional<std::string_view> entry) {
+  if (IsBinaryIr(input_string)) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         ParseBinaryIrPackage(input_string));
+    if (entry.has_value()) {
+      XLS_RETURN_IF_ERROR(package->SetTopByName(*entry));
+    }
+    return package;
+  }
   return ParseDerivedPackageNoVerify<Package>(input_string, filename, entry);
 }
 
@@ -63,7 +63,8 @@ using DeclAttributes = absl::flat_hash_map<std::string, Token>;
 
 class Parser {
  public:
-  // Parses the given input string as a package.
+  // Parses the given input string as a package. The input may also be binary
+  // IR (see binary_ir.h) which is detected by its magic string.
   static absl::StatusOr<std::unique_ptr<Package>> ParsePackage(
       std::string_view input_string,
       std::optional<std::string_view> filename = std::nullopt);
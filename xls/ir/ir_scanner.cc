@@ -14,9 +14,12 @@
 
 #include "xls/ir/ir_scanner.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cstdint>
 #include <functional>
+#include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -31,6 +34,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/number_parser.h"
 
@@ -134,8 +138,8 @@ class Tokenizer {
  public:
   // Tokenizes the given string and returns the vector of Tokens.
   static absl::StatusOr<std::vector<Token>> TokenizeString(
-      std::string_view str) {
-    Tokenizer tokenizer(str);
+      std::string_view str, int64_t start_lineno = 0) {
+    Tokenizer tokenizer(str, start_lineno);
     return tokenizer.Tokenize();
   }
 
@@ -381,7 +385,8 @@ class Tokenizer {
   int64_t colno() const { return colno_; }
 
  private:
-  explicit Tokenizer(std::string_view str) : str_(str) {}
+  Tokenizer(std::string_view str, int64_t start_lineno)
+      : str_(str), lineno_(start_lineno) {}
 
   // The string being tokenized.
   std::string_view str_;
@@ -390,18 +395,126 @@ class Tokenizer {
   int64_t index_ = 0;
 
   // Line/column number based on the current index.
-  int64_t lineno_ = 0;
+  int64_t lineno_;
   int64_t colno_ = 0;
 };
 
+// A piece of the text to tokenize which starts at the beginning of a line
+// outside of any token.
+struct TextChunk {
+  std::string_view text;
+  int64_t start_lineno;
+};
+
+// Splits `str` into at most `max_chunks` chunks of roughly equal size which
+// can be tokenized independently. This is a fast pre-scan which only tracks
+// comments and quoted strings (mirroring the tokenizer) so that chunks are
+// split at newlines which are not inside a token; tokens other than
+// triple-quoted strings never span lines.
+std::vector<TextChunk> SplitIntoChunks(std::string_view str,
+                                       int64_t max_chunks) {
+  std::vector<TextChunk> chunks;
+  const int64_t target_size =
+      std::max<int64_t>(1, str.size() / std::max<int64_t>(1, max_chunks));
+  int64_t chunk_start = 0;
+  int64_t chunk_start_lineno = 0;
+  int64_t lineno = 0;
+  auto match = [&](int64_t i, std::string_view substr) {
+    return str.substr(i, substr.size()) == substr;
+  };
+  int64_t i = 0;
+  while (i < str.size()) {
+    char c = str[i];
+    if (c == '\n') {
+      ++lineno;
+      ++i;
+      if (i - chunk_start >= target_size && i < str.size() &&
+          chunks.size() + 1 < max_chunks) {
+        chunks.push_back(
+            {str.substr(chunk_start, i - chunk_start), chunk_start_lineno});
+        chunk_start = i;
+        chunk_start_lineno = lineno;
+      }
+      continue;
+    }
+    if (c == '/' && match(i, "//")) {
+      while (i < str.size() && str[i] != '\n') {
+        ++i;
+      }
+      continue;
+    }
+    if (c == '"') {
+      if (match(i, "\"\"\"")) {
+        i += 3;
+        while (i < str.size() && !match(i, "\"\"\"")) {
+          lineno += str[i] == '\n' ? 1 : 0;
+          ++i;
+        }
+        i = std::min<int64_t>(i + 3, str.size());
+        continue;
+      }
+      ++i;
+      while (i < str.size() && str[i] != '"' && str[i] != '\n') {
+        ++i;
+      }
+      if (i < str.size() && str[i] == '"') {
+        ++i;
+      }
+      continue;
+    }
+    ++i;
+  }
+  chunks.push_back({str.substr(chunk_start), chunk_start_lineno});
+  return chunks;
+}
+
 }  // namespace
 
 absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str) {
   return Tokenizer::TokenizeString(str);
 }
 
+absl::StatusOr<std::vector<Token>> TokenizeStringInParallel(
+    std::string_view str, int64_t thread_count) {
+  std::vector<TextChunk> chunks = SplitIntoChunks(str, thread_count);
+  if (chunks.size() == 1) {
+    return TokenizeString(str);
+  }
+  std::vector<absl::StatusOr<std::vector<Token>>> results(chunks.size());
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(chunks.size());
+    for (int64_t i = 0; i < chunks.size(); ++i) {
+      threads.push_back(std::make_unique<Thread>([&chunks, &results, i]() {
+        results[i] = Tokenizer::TokenizeString(chunks[i].text,
+                                               chunks[i].start_lineno);
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  // Return the first error in text order to match serial tokenization.
+  int64_t token_count = 0;
+  for (absl::StatusOr<std::vector<Token>>& result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+    token_count += result->size();
+  }
+  std::vector<Token> tokens;
+  tokens.reserve(token_count);
+  for (absl::StatusOr<std::vector<Token>>& result : results) {
+    std::move(result->begin(), result->end(), std::back_inserter(tokens));
+  }
+  return tokens;
+}
+
 absl::StatusOr<Scanner> Scanner::Create(std::string_view text) {
-  XLS_ASSIGN_OR_RETURN(auto tokens, TokenizeString(text));
+  int64_t thread_count =
+      std::min<int64_t>(AvailableCPUs(), text.size() / kParallelTokenizeBytes);
+  XLS_ASSIGN_OR_RETURN(auto tokens,
+                       thread_count > 1
+                           ? TokenizeStringInParallel(text, thread_count)
+                           : TokenizeString(text));
   return Scanner(std::move(tokens));
 }
 
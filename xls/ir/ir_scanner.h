@@ -136,8 +136,18 @@ inline std::ostream& operator<<(std::ostream& os, const Token& token) {
 // driven tokenization.
 absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str);
 
+// As TokenizeString, but splits the string at line boundaries into up to
+// `thread_count` chunks which are tokenized concurrently. Returns the same
+// tokens (and, for invalid input, the same error) as TokenizeString.
+absl::StatusOr<std::vector<Token>> TokenizeStringInParallel(
+    std::string_view str, int64_t thread_count);
+
 class Scanner {
  public:
+  // Inputs of at least this many bytes per available CPU are tokenized in
+  // parallel by Create.
+  static constexpr int64_t kParallelTokenizeBytes = 4 * 1024 * 1024;
+
   static absl::StatusOr<Scanner> Create(std::string_view text);
 
   // Peeks at the next token in the token stream, or returns an error if we're
@@ -14,6 +14,7 @@
 
 #include "xls/ir/ir_scanner.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 
@@ -179,5 +181,52 @@ TEST(IrScannerTest, UnterminatedTripleQuotedStrings) {
                HasSubstr("Unterminated quoted string starting at 1:1")));
 }
 
+// Returns a string uniquely describing the tokens including their positions.
+std::vector<std::string> TokensToStringsWithPositions(
+    absl::Span<const Token> tokens) {
+  std::vector<std::string> strs;
+  for (const Token& token : tokens) {
+    strs.push_back(
+        absl::StrCat(token.ToString(), "@", token.pos().ToHumanString()));
+  }
+  return strs;
+}
+
+TEST(IrScannerTest, ParallelTokenizationMatchesSerial) {
+  std::string text;
+  for (int64_t i = 0; i < 50; ++i) {
+    absl::StrAppend(&text, "// comment with \"quote and \"\"\"\n");
+    absl::StrAppend(&text, "fn f", i, "(x: bits[32]) -> bits[32] {\n");
+    absl::StrAppend(&text, "\tliteral.", i, ": bits[32] = literal(value=", i,
+                    ")\n");
+    absl::StrAppend(&text, "  trace.", i,
+                    ": token = trace(format=\"\"\"multi\nline\n\nfn g()",
+                    "\n\"\"\", id=", i, ")\n");
+    absl::StrAppend(&text, "  ret add.", i, ": bits[32] = add(x, literal.",
+                    i, ", pos=[(0, 1, 2)])\n}\n\n");
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Token> serial, TokenizeString(text));
+  for (int64_t thread_count : {1, 2, 3, 7, 64, 1000}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<Token> parallel,
+                             TokenizeStringInParallel(text, thread_count));
+    EXPECT_EQ(TokensToStringsWithPositions(parallel),
+              TokensToStringsWithPositions(serial))
+        << "thread_count=" << thread_count;
+  }
+}
+
+TEST(IrScannerTest, ParallelTokenizationReportsFirstError) {
+  std::string text;
+  for (int64_t i = 0; i < 20; ++i) {
+    absl::StrAppend(&text, "fn f", i, "() -> bits[1] {\n");
+    absl::StrAppend(&text, i == 7 ? "  ret $bad\n" : "  ret x\n");
+    absl::StrAppend(&text, i == 15 ? "  \"unterminated\n" : "", "}\n");
+  }
+  absl::Status serial = TokenizeString(text).status();
+  EXPECT_THAT(serial, StatusIs(absl::StatusCode::kInvalidArgument,
+                               HasSubstr("Invalid character")));
+  EXPECT_EQ(TokenizeStringInParallel(text, 8).status(), serial);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,56 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/name_table.h"
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+
+namespace xls {
+
+int32_t NameTable::Intern(std::string_view name) {
+  if (name.empty()) {
+    return kEmptyId;
+  }
+  absl::MutexLock lock(&mutex_);
+  auto it = ids_.find(name);
+  if (it != ids_.end()) {
+    return it->second;
+  }
+  CHECK_LT(names_.size(), std::numeric_limits<int32_t>::max());
+  const std::string& stored = names_.emplace_back(name);
+  int32_t id = static_cast<int32_t>(names_.size());
+  ids_.emplace(stored, id);
+  return id;
+}
+
+std::string_view NameTable::Get(int32_t id) const {
+  if (id == kEmptyId) {
+    return "";
+  }
+  absl::ReaderMutexLock lock(&mutex_);
+  DCHECK_LE(id, names_.size());
+  return names_[id - 1];
+}
+
+int64_t NameTable::size() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return names_.size();
+}
+
+}  // namespace xls
@@ -0,0 +1,61 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NAME_TABLE_H_
+#define XLS_IR_NAME_TABLE_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace xls {
+
+// A table of interned names. Each distinct name is stored once and identified
+// by a small integer id so objects which carry a name (e.g., nodes) need only
+// hold the id. Names are never removed so ids and the views returned by Get
+// remain valid for the lifetime of the table. The table is thread-safe.
+class NameTable {
+ public:
+  // Id of the empty name.
+  static constexpr int32_t kEmptyId = 0;
+
+  NameTable() = default;
+  NameTable(const NameTable&) = delete;
+  NameTable& operator=(const NameTable&) = delete;
+
+  // Returns the id of `name`, adding it to the table if necessary.
+  int32_t Intern(std::string_view name);
+
+  // Returns the name with the given id.
+  std::string_view Get(int32_t id) const;
+
+  // Returns the number of distinct non-empty names in the table.
+  int64_t size() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  // Names indexed by id - 1. A deque so the storage of existing names (which
+  // the keys of `ids_` refer to) does not move as names are added.
+  std::deque<std::string> names_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string_view, int32_t> ids_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NAME_TABLE_H_
@@ -24,6 +24,7 @@
 #include "absl/strings/ascii.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "xls/ir/name_table.h"
 
 namespace xls {
 
@@ -64,7 +65,7 @@ std::string SanitizeName(
 
 }  // namespace
 
-std::string NameUniquer::GetSanitizedUniqueName(std::string_view prefix) {
+int32_t NameUniquer::GetSanitizedUniqueNameId(std::string_view prefix) {
   std::string root = SanitizeName(prefix, reserved_names_);
 
   // Strip away a numeric suffix. For example, grab "foo" from "foo__42". This
@@ -87,22 +88,24 @@ std::string NameUniquer::GetSanitizedUniqueName(std::string_view prefix) {
   root = root.empty() ? "name" : root;
 
   // This will create  a map entry if it does not already exist.
-  PrefixTracker& prefix_tracker = generated_names_[root];
+  int32_t root_id = name_table_->Intern(root);
+  PrefixTracker& prefix_tracker = generated_names_[root_id];
 
   SequentialIdGenerator& generator = prefix_tracker.generator;
   if (numeric_suffix.has_value()) {
-    return absl::StrCat(root, separator_,
-                        generator.RegisterId(numeric_suffix.value()));
+    return name_table_->Intern(absl::StrCat(
+        root, separator_, generator.RegisterId(numeric_suffix.value())));
   }
   if (prefix_tracker.bare_prefix_taken) {
     // There already exists a node with the same root name (no suffix), add a
     // suffix to uniquify the name.
-    return absl::StrCat(root, separator_, generator.NextId());
+    return name_table_->Intern(
+        absl::StrCat(root, separator_, generator.NextId()));
   }
 
   // Root has not been seen before and there is no suffix. Just return it.
   prefix_tracker.bare_prefix_taken = true;
-  return root;
+  return root_id;
 }
 
 /* static */ bool NameUniquer::IsValidIdentifier(std::string_view str) {
@@ -16,6 +16,7 @@
 #define XLS_IR_NAME_UNIQUER_H_
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 
@@ -23,6 +24,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/types/span.h"
+#include "xls/ir/name_table.h"
 
 namespace xls {
 
@@ -30,12 +32,23 @@ namespace xls {
 // been seen/generated. The names returned by GetUniqueName are guaranteed to
 // be distinct for this instance of the class.  The names will be
 // sanitized to match regexp "[a-zA-Z_][a-zA-Z0-9_]*".
+//
+// The names are interned in a NameTable. If `name_table` is given (e.g., the
+// name table of a package) the uniquer works on that table directly and
+// GetSanitizedUniqueNameId returns ids in it; otherwise the uniquer uses a
+// table of its own.
 class NameUniquer {
  public:
   explicit NameUniquer(std::string_view separator,
-                       absl::Span<const std::string> reserved_names = {})
+                       absl::Span<const std::string> reserved_names = {},
+                       NameTable* name_table = nullptr)
       : separator_(separator),
-        reserved_names_(reserved_names.begin(), reserved_names.end()) {}
+        reserved_names_(reserved_names.begin(), reserved_names.end()),
+        owned_name_table_(name_table == nullptr
+                              ? std::make_unique<NameTable>()
+                              : nullptr),
+        name_table_(name_table == nullptr ? owned_name_table_.get()
+                                          : name_table) {}
 
   NameUniquer(const NameUniquer&) = delete;
   NameUniquer operator=(const NameUniquer&) = delete;
@@ -45,7 +58,12 @@ class NameUniquer {
   // from the given prefix by "separator_". For example,
   // GetSanitizedUniqueName("foo") might return "foo__1" if "foo" is not
   // available.
-  std::string GetSanitizedUniqueName(std::string_view prefix);
+  std::string GetSanitizedUniqueName(std::string_view prefix) {
+    return std::string(name_table_->Get(GetSanitizedUniqueNameId(prefix)));
+  }
+
+  // As above but returns the id of the name in the name table.
+  int32_t GetSanitizedUniqueNameId(std::string_view prefix);
 
   // Returns true if the given str is a valid Verilog, and thus XLS, identifier.
   static bool IsValidIdentifier(std::string_view str);
@@ -100,15 +118,18 @@ class NameUniquer {
   // prefix.
   absl::flat_hash_set<std::string> reserved_names_;
 
-  // Map from name prefix to the generator data structure which tracks used
-  // identifiers and generates new ones.
+  std::unique_ptr<NameTable> owned_name_table_;
+  NameTable* name_table_;
+
+  // Map from the id of a name prefix to the generator data structure which
+  // tracks used identifiers and generates new ones.
   struct PrefixTracker {
     // Whether the bare prefix (no numeric suffix) is taken as a name.
     bool bare_prefix_taken = false;
     // Numeric suffix generator for guaranteeing uniqueness.
     SequentialIdGenerator generator;
   };
-  absl::flat_hash_map<std::string, PrefixTracker> generated_names_;
+  absl::flat_hash_map<int32_t, PrefixTracker> generated_names_;
 };
 
 }  // namespace xls
@@ -14,7 +14,10 @@
 
 #include "xls/ir/name_uniquer.h"
 
+#include <cstdint>
+
 #include "gtest/gtest.h"
+#include "xls/ir/name_table.h"
 
 namespace xls {
 namespace {
@@ -130,5 +133,21 @@ TEST(NameUniquerTest, IsValidIdentifier) {
   EXPECT_FALSE(NameUniquer::IsValidIdentifier("foo+bar"));
 }
 
+TEST(NameUniquerTest, SharedNameTable) {
+  NameTable table;
+  NameUniquer a("__", {}, &table);
+  NameUniquer b("__", {}, &table);
+
+  int32_t foo = a.GetSanitizedUniqueNameId("foo");
+  EXPECT_EQ(table.Get(foo), "foo");
+  EXPECT_EQ(table.Get(a.GetSanitizedUniqueNameId("foo")), "foo__1");
+  // Names are unique per uniquer but interned once in the table.
+  EXPECT_EQ(b.GetSanitizedUniqueNameId("foo"), foo);
+  EXPECT_EQ(table.Get(a.GetSanitizedUniqueNameId("foo__1")), "foo__2");
+  EXPECT_EQ(table.size(), 3);
+  EXPECT_EQ(table.Intern(""), NameTable::kEmptyId);
+  EXPECT_EQ(table.Get(NameTable::kEmptyId), "");
+}
+
 }  // namespace
 }  // namespace xls
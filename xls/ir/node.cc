@@ -43,11 +43,14 @@
 #include "xls/ir/function.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/name_table.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/package_transaction.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/register.h"
+#include "xls/ir/source_info_table.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/verify_node.h"
@@ -60,10 +63,15 @@ Node::Node(Op op, Type* type, const SourceInfo& loc, std::string_view name,
       id_(function_base_->package()->GetNextNodeIdAndIncrement()),
       op_(op),
       type_(type),
-      loc_(loc),
-      name_(name.empty() ? nullptr
-                         : std::make_unique<std::string>(
-                               function_base_->UniquifyNodeName(name))) {}
+      loc_id_(package()->source_info_table().Acquire(loc)),
+      name_id_(name.empty() ? NameTable::kEmptyId
+                            : function_base_->UniquifyNodeNameId(name)) {}
+
+Node::~Node() { package()->source_info_table().Release(loc_id_); }
+
+const SourceInfo& Node::loc() const {
+  return package()->source_info_table().Get(loc_id_);
+}
 
 void Node::AddOperand(Node* operand) {
   VLOG(3) << " Adding operand " << operand->GetName() << " as #"
@@ -109,6 +117,7 @@ void Node::AddUser(Node* user) {
   }
   if (it == users_.end() || (*it)->id() != user->id()) {
     users_.insert(it, user);
+    function_base_->IncrementGraphVersion();
   }
 }
 
@@ -122,6 +131,7 @@ void Node::RemoveUser(Node* user) {
   }
   if (it != users_.end() && (*it)->id() == user->id()) {
     users_.erase(it);
+    function_base_->IncrementGraphVersion();
   }
 }
 
@@ -470,43 +480,58 @@ bool Node::IsDefinitelyEqualTo(const Node* other) const {
 }
 
 std::string Node::GetName() const {
-  if (name_ == nullptr) {
+  if (!HasAssignedName()) {
     // Return a generated name based on the id.
     return absl::StrFormat("%s.%d", OpToString(op()), id());
   }
-  return *name_;
+  return std::string(GetNameView());
 }
 
 std::string_view Node::GetNameView() const {
-  if (name_ == nullptr) {
-    return "";
-  }
-  return *name_;
+  return package()->name_table().Get(name_id_);
 }
 
 void Node::SetName(std::string_view name) {
-  if (name.empty()) {
-    name_.reset();
-  } else {
-    name_ =
-        std::make_unique<std::string>(function_base()->UniquifyNodeName(name));
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordNameChanged(this);
   }
+  function_base()->IncrementModificationCount();
+  name_id_ = name.empty() ? NameTable::kEmptyId
+                          : function_base()->UniquifyNodeNameId(name);
 }
 
 void Node::SetNameDirectly(std::string_view name) {
-  if (name.empty()) {
-    name_.reset();
-  } else {
-    name_ = std::make_unique<std::string>(name);
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordNameChanged(this);
   }
+  function_base()->IncrementModificationCount();
+  name_id_ = package()->name_table().Intern(name);
 }
 
 void Node::ClearName() {
   CHECK(!Is<Param>());
-  name_.reset();
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordNameChanged(this);
+  }
+  function_base()->IncrementModificationCount();
+  name_id_ = NameTable::kEmptyId;
+}
+
+void Node::SetLoc(const SourceInfo& loc) {
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordLocChanged(this);
+  }
+  function_base()->IncrementModificationCount();
+  AssignLoc(loc);
 }
 
-void Node::SetLoc(const SourceInfo& loc) { loc_ = loc; }
+void Node::AssignLoc(const SourceInfo& loc) {
+  SourceInfoTable& table = package()->source_info_table();
+  // Acquire before releasing in case `loc` refers to the current entry.
+  int32_t old_loc_id = loc_id_;
+  loc_id_ = table.Acquire(loc);
+  table.Release(old_loc_id);
+}
 
 std::string Node::ToStringInternal(bool include_operand_types) const {
   std::string ret = absl::StrCat(GetName(), ": ", GetType()->ToString(), " = ",
@@ -819,6 +844,9 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
     return true;
   }
   ++package()->transform_metrics().operands_replaced;
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordOperandsChanged(this);
+  }
   bool did_replace = false;
   for (int64_t i = 0; i < operand_count(); ++i) {
     if (operands_[i] == old_operand) {
@@ -831,9 +859,28 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
     }
   }
   old_operand->RemoveUser(this);
+  if (did_replace) {
+    // The user sets may be unchanged (e.g., if `new_operand` was already an
+    // operand) but the operand order, which determines the topological sort
+    // order, has changed.
+    function_base()->IncrementGraphVersion();
+  }
   return did_replace;
 }
 
+void Node::SwapOperands(int64_t a, int64_t b) {
+  if (a == b) {
+    return;
+  }
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordOperandsChanged(this);
+  }
+  // Operand/user chains already set up properly but the operand order, which
+  // determines the topological sort order, changes.
+  std::swap(operands_[a], operands_[b]);
+  function_base()->IncrementGraphVersion();
+}
+
 absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
                                         bool type_must_match) {
   Node* old_operand = operands_[operand_no];
@@ -843,11 +890,15 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
         << " new operand type: " << new_operand->GetType()->ToString();
   }
   ++package()->transform_metrics().operands_replaced;
+  if (package()->transaction() != nullptr) {
+    package()->transaction()->RecordOperandsChanged(this);
+  }
 
   // AddUser is idempotent so even if the new operand is already used by this
   // node in another operand slot, it is safe to call.
   new_operand->AddUser(this);
   operands_[operand_no] = new_operand;
+  function_base()->IncrementGraphVersion();
 
   for (Node* operand : operands()) {
     if (operand == old_operand) {
@@ -895,7 +946,7 @@ absl::Status Node::ReplaceUsesWith(Node* replacement,
       !replacement->HasAssignedName()) {
     // Do not use SetName because we do not want the name to be uniqued which
     // would add a suffix because (clearly) the name already exists.
-    replacement->SetNameDirectly(*name_);
+    replacement->SetNameDirectly(GetNameView());
     ClearName();
   }
   return absl::OkStatus();
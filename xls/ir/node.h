@@ -15,8 +15,10 @@
 #ifndef XLS_IR_NODE_H_
 #define XLS_IR_NODE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <list>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -32,6 +34,8 @@
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/name_table.h"
+#include "xls/ir/node_allocator.h"
 #include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
@@ -39,6 +43,7 @@
 namespace xls {
 
 class Package;
+class PackageTransaction;
 class Node;
 class FunctionBase;
 
@@ -50,7 +55,21 @@ class DfsVisitor;
 // Node is subtyped and can be checked-converted via the As* methods below.
 class Node {
  public:
-  virtual ~Node() = default;
+  virtual ~Node();
+
+  // Nodes of all subclasses are allocated from slabs (see node_allocator.h)
+  // to avoid a heap allocation per node and to keep nodes created together
+  // adjacent in memory. FunctionBase::MakeNode allocates from the arena of the
+  // package so the memory is released along with the package.
+  static void* operator new(size_t size) {
+    return NodeArena::Default().Allocate(size);
+  }
+  static void* operator new(size_t size, NodeArena& arena) {
+    return arena.Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    NodeArena::Deallocate(ptr, size);
+  }
 
   // Accepts the visitor, instructing it to visit this node.
   //
@@ -76,7 +95,7 @@ class Node {
   Op op() const { return op_; }
   FunctionBase* function_base() const { return function_base_; }
   Package* package() const;
-  const SourceInfo& loc() const { return loc_; }
+  const SourceInfo& loc() const;
 
   // Returns the sequence of operands used by this node.
   //
@@ -141,10 +160,7 @@ class Node {
   absl::StatusOr<bool> ReplaceImplicitUsesWith(Node* replacement);
 
   // Swaps the operands at indices 'a' and 'b' in the operands sequence.
-  void SwapOperands(int64_t a, int64_t b) {
-    // Operand/user chains already set up properly.
-    std::swap(operands_[a], operands_[b]);
-  }
+  void SwapOperands(int64_t a, int64_t b);
 
   // Returns true if analysis indicates that this node always produces the
   // same value as 'other' when run with the same operands. The analysis is
@@ -174,7 +190,7 @@ class Node {
   // Returns whether this node was assigned a name at construction. Nodes
   // without assigned names will have names generated from the opcode and unique
   // id.
-  bool HasAssignedName() const { return name_ != nullptr; }
+  bool HasAssignedName() const { return name_id_ != NameTable::kEmptyId; }
 
   // Returns the name of this node. If not assigned at construction time, the
   // name is generated from the opcode and unique id (e.g. "add.2");
@@ -284,15 +300,26 @@ class Node {
   // FunctionBase needs to be a friend to access RemoveUser for deleting nodes
   // from the graph.
   friend class FunctionBase;
+  // PackageTransaction restores operands, names and locations on rollback.
+  friend class PackageTransaction;
   // Block needs to be a friend to strongly name ports (guarantee name has no
   // uniquifying prefix).
   friend class Block;
+  // Package renumbers the nodes created by concurrent transformations.
+  friend class Package;
+
+  // The list of nodes owned by a FunctionBase.
+  using NodeList =
+      std::list<std::unique_ptr<Node>, NodeStlAllocator<std::unique_ptr<Node>>>;
 
   Node(Op op, Type* type, const SourceInfo& loc, std::string_view name,
        FunctionBase* function);
 
   std::string ToStringInternal(bool include_operand_types) const;
 
+  // Sets the location of the node without recording the change.
+  void AssignLoc(const SourceInfo& loc);
+
   // Adds an operand to the operand list with a symmetric "user" link added to
   // those operands, noting that this node is a user.
   void AddOperand(Node* operand);
@@ -320,14 +347,20 @@ class Node {
   int64_t id_;
   Op op_;
   Type* type_;
-  SourceInfo loc_;
-  std::unique_ptr<std::string> name_;  // Non-null if name has been assigned.
+  // The location and name of the node are interned in the SourceInfoTable and
+  // NameTable of the package.
+  int32_t loc_id_;
+  int32_t name_id_;  // NameTable::kEmptyId if no name has been assigned.
 
   // Most nodes have <= 2 operands, so we keep those locally if we can.
   absl::InlinedVector<Node*, 2> operands_;
 
   // Set of users sorted by node_id for stability.
   absl::InlinedVector<Node*, 2> users_;
+
+  // The position of this node in the node list of its FunctionBase, for
+  // constant time removal.
+  NodeList::iterator node_list_position_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Node& node) {
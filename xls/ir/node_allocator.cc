@@ -0,0 +1,169 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_allocator.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include "absl/base/config.h"
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+
+namespace xls {
+namespace {
+
+#if defined(ABSL_HAVE_ADDRESS_SANITIZER) ||   \
+    defined(ABSL_HAVE_HWADDRESS_SANITIZER) || \
+    defined(ABSL_HAVE_MEMORY_SANITIZER)
+constexpr bool kPooled = false;
+#else
+constexpr bool kPooled = true;
+#endif
+
+static_assert(NodeArena::kSizeClassBytes >= sizeof(void*));
+static_assert(NodeArena::kSizeClassBytes % alignof(std::max_align_t) == 0);
+
+// The start of each slab, holding the arena the slab belongs to. Padded so
+// that allocations after it stay aligned.
+struct alignas(NodeArena::kSizeClassBytes) SlabHeader {
+  NodeArena* arena;
+};
+
+constexpr std::align_val_t kSlabAlignment{NodeArena::kSlabBytes};
+
+std::atomic<int64_t> total_slab_bytes = 0;
+
+// Returns the index of the size class of allocations of `size` bytes.
+int64_t SizeClass(size_t size) {
+  return (static_cast<int64_t>(size) - 1) / NodeArena::kSizeClassBytes;
+}
+
+int64_t SizeClassBytes(int64_t size_class) {
+  return (size_class + 1) * NodeArena::kSizeClassBytes;
+}
+
+bool IsPooledSize(size_t size) {
+  return kPooled && size != 0 && size <= NodeArena::kMaxPooledBytes;
+}
+
+}  // namespace
+
+/* static */ std::unique_ptr<NodeArena, NodeArena::Deleter>
+NodeArena::Create() {
+  return std::unique_ptr<NodeArena, Deleter>(new NodeArena());
+}
+
+/* static */ NodeArena& NodeArena::Default() {
+  // Never released so nodes of static objects may be freed during exit.
+  static NodeArena* arena = Create().release();
+  return *arena;
+}
+
+/* static */ bool NodeArena::IsPooled() { return kPooled; }
+
+/* static */ int64_t NodeArena::TotalSlabBytes() {
+  return total_slab_bytes.load(std::memory_order_relaxed);
+}
+
+NodeArena::~NodeArena() {
+  for (std::byte* slab : slabs_) {
+    ::operator delete(slab, kSlabAlignment);
+  }
+  total_slab_bytes.fetch_sub(slabs_.size() * kSlabBytes,
+                             std::memory_order_relaxed);
+}
+
+void NodeArena::Release() {
+  bool destroy;
+  {
+    absl::MutexLock lock(&mutex_);
+    CHECK(!released_);
+    released_ = true;
+    destroy = live_allocations_ == 0;
+  }
+  if (destroy) {
+    delete this;
+  }
+}
+
+void* NodeArena::Allocate(size_t size) {
+  if (!IsPooledSize(size)) {
+    return ::operator new(size);
+  }
+  int64_t size_class = SizeClass(size);
+  int64_t bytes = SizeClassBytes(size_class);
+  absl::MutexLock lock(&mutex_);
+  ++live_allocations_;
+  stats_.live_bytes += bytes;
+  if (FreeBlock* block = free_lists_[size_class]; block != nullptr) {
+    free_lists_[size_class] = block->next;
+    stats_.free_list_bytes -= bytes;
+    return block;
+  }
+  if (slab_end_ - slab_next_ < bytes) {
+    std::byte* slab =
+        static_cast<std::byte*>(::operator new(kSlabBytes, kSlabAlignment));
+    new (slab) SlabHeader{.arena = this};
+    slabs_.push_back(slab);
+    slab_next_ = slab + sizeof(SlabHeader);
+    slab_end_ = slab + kSlabBytes;
+    ++stats_.slab_count;
+    total_slab_bytes.fetch_add(kSlabBytes, std::memory_order_relaxed);
+  }
+  void* result = slab_next_;
+  slab_next_ += bytes;
+  return result;
+}
+
+/* static */ void NodeArena::Deallocate(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (!IsPooledSize(size)) {
+    ::operator delete(ptr);
+    return;
+  }
+  constexpr uintptr_t kSlabMask = ~static_cast<uintptr_t>(kSlabBytes - 1);
+  auto* header =
+      reinterpret_cast<SlabHeader*>(reinterpret_cast<uintptr_t>(ptr) & kSlabMask);
+  header->arena->Free(ptr, size);
+}
+
+void NodeArena::Free(void* ptr, size_t size) {
+  int64_t size_class = SizeClass(size);
+  int64_t bytes = SizeClassBytes(size_class);
+  bool destroy;
+  {
+    absl::MutexLock lock(&mutex_);
+    stats_.live_bytes -= bytes;
+    stats_.free_list_bytes += bytes;
+    free_lists_[size_class] =
+        new (ptr) FreeBlock{.next = free_lists_[size_class]};
+    destroy = --live_allocations_ == 0 && released_;
+  }
+  if (destroy) {
+    delete this;
+  }
+}
+
+NodeArena::Stats NodeArena::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+}  // namespace xls
@@ -0,0 +1,146 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_ALLOCATOR_H_
+#define XLS_IR_NODE_ALLOCATOR_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace xls {
+
+// A slab arena for IR nodes and the per-node bookkeeping of their
+// FunctionBase. Each Package owns an arena, so nodes of different packages
+// never contend on the same lock and a package's node memory is returned to
+// the system when the package is destroyed.
+//
+// Allocations are rounded up to a multiple of kSizeClassBytes and carved
+// sequentially out of large slabs so nodes created together are adjacent in
+// memory, and freed blocks are kept on per-size free lists for reuse by later
+// allocations of the same size.
+//
+// Allocations larger than kMaxPooledBytes, and all allocations in builds with
+// a memory sanitizer (which would otherwise miss use-after-free of nodes), are
+// forwarded to the global operator new.
+//
+// Thread-safe.
+class NodeArena {
+ public:
+  static constexpr int64_t kSizeClassBytes = 16;
+  static constexpr int64_t kMaxPooledBytes = 1024;
+  static constexpr int64_t kSlabBytes = 256 * 1024;
+
+  // Releases the owner's reference to the arena, see Create().
+  struct Deleter {
+    void operator()(NodeArena* arena) const { arena->Release(); }
+  };
+
+  // Creates an arena. The arena, along with its slabs, is destroyed once the
+  // returned pointer has been reset and every allocation from it has been
+  // freed, so allocations may safely outlive the owner.
+  static std::unique_ptr<NodeArena, Deleter> Create();
+
+  // The arena used for nodes which don't belong to a package. Never destroyed.
+  static NodeArena& Default();
+
+  // Whether allocations are served from slabs in this build.
+  static bool IsPooled();
+
+  void* Allocate(size_t size);
+  // Frees memory returned by Allocate() of any arena. `size` must be the size
+  // passed to the Allocate call which returned `ptr`.
+  static void Deallocate(void* ptr, size_t size);
+
+  struct Stats {
+    // Number of slabs allocated from the system.
+    int64_t slab_count = 0;
+    // Bytes of slab memory in live allocations (after rounding to the size
+    // class).
+    int64_t live_bytes = 0;
+    // Bytes of slab memory on the free lists.
+    int64_t free_list_bytes = 0;
+  };
+  Stats GetStats() const;
+
+  // Bytes of slab memory currently held by all arenas of the process.
+  static int64_t TotalSlabBytes();
+
+ private:
+  static constexpr int64_t kSizeClassCount = kMaxPooledBytes / kSizeClassBytes;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  NodeArena() = default;
+  ~NodeArena();
+
+  void Release();
+  void Free(void* ptr, size_t size);
+
+  mutable absl::Mutex mutex_;
+  // Slabs are aligned to kSlabBytes and start with a pointer to their arena,
+  // which is how Deallocate() finds the arena of an allocation.
+  std::vector<std::byte*> slabs_ ABSL_GUARDED_BY(mutex_);
+  // The unused tail of the most recently allocated slab.
+  std::byte* slab_next_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  std::byte* slab_end_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  std::array<FreeBlock*, kSizeClassCount> free_lists_ ABSL_GUARDED_BY(
+      mutex_) = {};
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+  int64_t live_allocations_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool released_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+// An allocator satisfying the standard Allocator requirements which allocates
+// from a NodeArena. Any instance can free the memory of any other, so all
+// instances compare equal.
+template <typename T>
+class NodeStlAllocator {
+ public:
+  using value_type = T;
+
+  NodeStlAllocator() : arena_(&NodeArena::Default()) {}
+  explicit NodeStlAllocator(NodeArena* arena) : arena_(arena) {}
+  template <typename U>
+  NodeStlAllocator(const NodeStlAllocator<U>& other)  // NOLINT
+      : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, size_t n) {
+    NodeArena::Deallocate(ptr, n * sizeof(T));
+  }
+
+  NodeArena* arena() const { return arena_; }
+
+  template <typename U>
+  bool operator==(const NodeStlAllocator<U>&) const {
+    return true;
+  }
+
+ private:
+  NodeArena* arena_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_ALLOCATOR_H_
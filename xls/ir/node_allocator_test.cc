@@ -0,0 +1,146 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+class NodeArenaTest : public IrTestBase {
+ protected:
+  void SetUp() override {
+    if (!NodeArena::IsPooled()) {
+      GTEST_SKIP() << "Node pooling is disabled in sanitizer builds";
+    }
+  }
+};
+
+TEST_F(NodeArenaTest, FreedBlocksAreReused) {
+  auto arena = NodeArena::Create();
+  void* a = arena->Allocate(40);
+  EXPECT_EQ(arena->GetStats().live_bytes, 48);
+  NodeArena::Deallocate(a, 40);
+  EXPECT_EQ(arena->GetStats().live_bytes, 0);
+  EXPECT_EQ(arena->GetStats().free_list_bytes, 48);
+
+  // Any size in the same size class reuses the block.
+  void* b = arena->Allocate(33);
+  EXPECT_EQ(b, a);
+  EXPECT_EQ(arena->GetStats().free_list_bytes, 0);
+  NodeArena::Deallocate(b, 33);
+}
+
+TEST_F(NodeArenaTest, AllocationsAreAdjacent) {
+  auto arena = NodeArena::Create();
+  auto* a = static_cast<std::byte*>(arena->Allocate(64));
+  auto* b = static_cast<std::byte*>(arena->Allocate(64));
+  EXPECT_EQ(b, a + 64);
+  EXPECT_EQ(arena->GetStats().slab_count, 1);
+  NodeArena::Deallocate(a, 64);
+  NodeArena::Deallocate(b, 64);
+}
+
+TEST_F(NodeArenaTest, LargeAllocationsAreNotPooled) {
+  auto arena = NodeArena::Create();
+  void* ptr = arena->Allocate(NodeArena::kMaxPooledBytes + 1);
+  EXPECT_EQ(arena->GetStats().live_bytes, 0);
+  EXPECT_EQ(arena->GetStats().slab_count, 0);
+  NodeArena::Deallocate(ptr, NodeArena::kMaxPooledBytes + 1);
+  EXPECT_EQ(arena->GetStats().free_list_bytes, 0);
+}
+
+TEST_F(NodeArenaTest, StlAllocator) {
+  auto arena = NodeArena::Create();
+  {
+    std::list<int64_t, NodeStlAllocator<int64_t>> list(
+        NodeStlAllocator<int64_t>(arena.get()));
+    for (int64_t i = 0; i < 100; ++i) {
+      list.push_back(i);
+    }
+    EXPECT_GT(arena->GetStats().live_bytes, 0);
+  }
+  EXPECT_EQ(arena->GetStats().live_bytes, 0);
+}
+
+TEST_F(NodeArenaTest, RemovedNodesAreRecycled) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue sum = fb.Add(x, y);
+  BValue dead = fb.Subtract(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(sum));
+
+  Node* removed = dead.node();
+  XLS_ASSERT_OK(f->RemoveNode(removed));
+  EXPECT_EQ(f->node_count(), 3);
+  int64_t free_list_bytes = p->node_arena().GetStats().free_list_bytes;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * added,
+      f->MakeNode<BinOp>(SourceInfo(), x.node(), y.node(), Op::kSub));
+  // The new node (and its list entry) take the freed blocks.
+  EXPECT_EQ(added, removed);
+  EXPECT_LT(p->node_arena().GetStats().free_list_bytes, free_list_bytes);
+  EXPECT_EQ(f->node_count(), 4);
+  XLS_ASSERT_OK(f->RemoveNode(added));
+  EXPECT_EQ(f->node_count(), 3);
+}
+
+TEST_F(NodeArenaTest, PackageMemoryIsReleasedOnDestruction) {
+  int64_t slab_bytes = NodeArena::TotalSlabBytes();
+  {
+    auto p = CreatePackage();
+    FunctionBuilder fb(TestName(), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    for (int64_t i = 0; i < 10000; ++i) {
+      x = fb.Add(x, fb.Literal(UBits(i, 32)));
+    }
+    XLS_ASSERT_OK(fb.BuildWithReturnValue(x).status());
+    EXPECT_GT(p->node_arena().GetStats().slab_count, 1);
+    EXPECT_GT(NodeArena::TotalSlabBytes(), slab_bytes);
+  }
+  EXPECT_EQ(NodeArena::TotalSlabBytes(), slab_bytes);
+}
+
+TEST_F(NodeArenaTest, AllocationsMayOutliveArenaOwner) {
+  int64_t slab_bytes = NodeArena::TotalSlabBytes();
+  auto arena = NodeArena::Create();
+  void* a = arena->Allocate(64);
+  void* b = arena->Allocate(64);
+  arena.reset();
+  // The slabs are kept until the last allocation is freed.
+  EXPECT_EQ(NodeArena::TotalSlabBytes(), slab_bytes + NodeArena::kSlabBytes);
+  NodeArena::Deallocate(a, 64);
+  EXPECT_EQ(NodeArena::TotalSlabBytes(), slab_bytes + NodeArena::kSlabBytes);
+  NodeArena::Deallocate(b, 64);
+  EXPECT_EQ(NodeArena::TotalSlabBytes(), slab_bytes);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,398 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_MAP_H_
+#define XLS_IR_NODE_MAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+namespace internal {
+
+// Dense storage of one optional `SlotT` per node id in a contiguous id range
+// which grows as nodes with ids outside the range are added. Each slot carries
+// the generation in which it was written so clearing the table is constant
+// time: slots from earlier generations are considered empty.
+template <typename SlotT>
+class NodeIdTable {
+ public:
+  // Returns the slot for `id` if it is within the table and was written in the
+  // current generation.
+  SlotT* Find(int64_t id) {
+    if (id < base_id_ || id - base_id_ >= slots_.size()) {
+      return nullptr;
+    }
+    Entry& entry = slots_[id - base_id_];
+    if (entry.generation != generation_ || !entry.slot.has_value()) {
+      return nullptr;
+    }
+    return &*entry.slot;
+  }
+  const SlotT* Find(int64_t id) const {
+    return const_cast<NodeIdTable*>(this)->Find(id);
+  }
+
+  // Returns the (possibly stale or empty) entry for `id`, growing the table as
+  // necessary. A stale entry is reset before it is returned.
+  std::optional<SlotT>& GetOrCreateEntry(int64_t id) {
+    if (slots_.empty()) {
+      base_id_ = id;
+    } else if (id < base_id_) {
+      // Grow at the front by at least the current size to amortize the cost
+      // of moving the existing slots.
+      int64_t grow_by = std::max<int64_t>(base_id_ - id, slots_.size());
+      grow_by = std::min(grow_by, base_id_);
+      slots_.insert(slots_.begin(), grow_by, Entry());
+      base_id_ -= grow_by;
+    }
+    if (id - base_id_ >= slots_.size()) {
+      slots_.resize(id - base_id_ + 1);
+    }
+    Entry& entry = slots_[id - base_id_];
+    if (entry.generation != generation_) {
+      entry.slot.reset();
+      entry.generation = generation_;
+    }
+    return entry.slot;
+  }
+
+  void Clear() { ++generation_; }
+
+  // Returns the index of the slot of `id` which must be within the table.
+  int64_t SlotIndex(int64_t id) const { return id - base_id_; }
+
+  // Index-based iteration over the slots of the current generation.
+  int64_t slot_count() const { return slots_.size(); }
+  SlotT* SlotAt(int64_t index) {
+    Entry& entry = slots_[index];
+    return entry.generation == generation_ && entry.slot.has_value()
+               ? &*entry.slot
+               : nullptr;
+  }
+  const SlotT* SlotAt(int64_t index) const {
+    return const_cast<NodeIdTable*>(this)->SlotAt(index);
+  }
+
+ private:
+  struct Entry {
+    Entry() = default;
+    Entry(const Entry& other) = default;
+    Entry(Entry&& other) noexcept = default;
+    // Slots may hold pairs with const members (e.g., map keys) which are not
+    // assignable, so assignment reconstructs the slot.
+    Entry& operator=(const Entry& other) {
+      if (this != &other) {
+        generation = other.generation;
+        slot.reset();
+        if (other.slot.has_value()) {
+          slot.emplace(*other.slot);
+        }
+      }
+      return *this;
+    }
+    Entry& operator=(Entry&& other) noexcept {
+      if (this != &other) {
+        generation = other.generation;
+        slot.reset();
+        if (other.slot.has_value()) {
+          slot.emplace(std::move(*other.slot));
+        }
+      }
+      return *this;
+    }
+
+    int64_t generation = -1;
+    std::optional<SlotT> slot;
+  };
+
+  int64_t base_id_ = 0;
+  int64_t generation_ = 0;
+  std::vector<Entry> slots_;
+};
+
+}  // namespace internal
+
+// A map from nodes to values of type T stored densely in a vector indexed by
+// node id. Lookups are an index computation plus a comparison rather than a
+// hash of the node pointer, making NodeMap a drop-in replacement for
+// absl::flat_hash_map<Node*, T> in analyses which keep a value per node.
+// Iteration is in order of increasing node id.
+//
+// Storage is proportional to the range of ids of the nodes in the map, so maps
+// should hold nodes of a single FunctionBase (whose ids are mostly
+// contiguous) rather than of an entire package.
+//
+// Entries are keyed by both the node's id and its address so an entry for a
+// node which has since been removed is never returned for a different node,
+// even one given the same id; inserting such a node replaces the stale entry.
+// As with flat_hash_map, insertions invalidate references to values; erasures
+// do not.
+template <typename T>
+class NodeMap {
+ public:
+  using key_type = Node*;
+  using mapped_type = T;
+  using value_type = std::pair<Node* const, T>;
+
+  template <bool kConst>
+  class Iterator {
+   public:
+    using MapT = std::conditional_t<kConst, const NodeMap, NodeMap>;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = NodeMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<kConst, const value_type&, value_type&>;
+    using pointer = std::conditional_t<kConst, const value_type*, value_type*>;
+
+    Iterator() = default;
+    Iterator(MapT* map, int64_t index) : map_(map), index_(index) {
+      SkipEmpty();
+    }
+    // Allow conversion from iterator to const_iterator.
+    template <bool kOtherConst>
+      requires(kConst && !kOtherConst)
+    Iterator(const Iterator<kOtherConst>& other)  // NOLINT
+        : map_(other.map_), index_(other.index_) {}
+
+    reference operator*() const { return *map_->table_.SlotAt(index_); }
+    pointer operator->() const { return map_->table_.SlotAt(index_); }
+    Iterator& operator++() {
+      ++index_;
+      SkipEmpty();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class NodeMap;
+    friend class Iterator<!kConst>;
+
+    void SkipEmpty() {
+      while (index_ < map_->table_.slot_count() &&
+             map_->table_.SlotAt(index_) == nullptr) {
+        ++index_;
+      }
+    }
+
+    MapT* map_ = nullptr;
+    int64_t index_ = 0;
+  };
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  NodeMap() = default;
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, table_.slot_count()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const {
+    return const_iterator(this, table_.slot_count());
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  bool contains(const Node* node) const { return FindSlot(node) != nullptr; }
+  size_t count(const Node* node) const { return contains(node) ? 1 : 0; }
+
+  iterator find(const Node* node) {
+    return FindSlot(node) == nullptr ? end() : IteratorFor(node);
+  }
+  const_iterator find(const Node* node) const {
+    return FindSlot(node) == nullptr ? end() : IteratorFor(node);
+  }
+
+  T& at(const Node* node) {
+    value_type* slot = FindSlot(node);
+    CHECK(slot != nullptr) << "Node not in map: " << node->GetName();
+    return slot->second;
+  }
+  const T& at(const Node* node) const {
+    return const_cast<NodeMap*>(this)->at(node);
+  }
+
+  T& operator[](Node* node) { return try_emplace(node).first->second; }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Node* node, Args&&... args) {
+    if (FindSlot(node) != nullptr) {
+      return {IteratorFor(node), false};
+    }
+    std::optional<value_type>& slot = table_.GetOrCreateEntry(node->id());
+    if (slot.has_value()) {
+      // The slot holds a different node with the same id, which must have been
+      // removed since (e.g., the parser reassigned its id). Replace it.
+      --size_;
+    }
+    slot.emplace(std::piecewise_construct, std::forward_as_tuple(node),
+                 std::forward_as_tuple(std::forward<Args>(args)...));
+    ++size_;
+    return {IteratorFor(node), true};
+  }
+
+  std::pair<iterator, bool> insert(value_type value) {
+    return try_emplace(value.first, std::move(value.second));
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Node* node, Args&&... args) {
+    return try_emplace(node, std::forward<Args>(args)...);
+  }
+
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign(Node* node, V&& value) {
+    auto [it, inserted] = try_emplace(node, std::forward<V>(value));
+    if (!inserted) {
+      it->second = std::forward<V>(value);
+    }
+    return {it, inserted};
+  }
+
+  size_t erase(const Node* node) {
+    if (FindSlot(node) == nullptr) {
+      return 0;
+    }
+    table_.GetOrCreateEntry(node->id()).reset();
+    --size_;
+    return 1;
+  }
+  void erase(iterator it) { erase(it->first); }
+
+  void clear() {
+    table_.Clear();
+    size_ = 0;
+  }
+
+ private:
+  value_type* FindSlot(const Node* node) {
+    value_type* slot = table_.Find(node->id());
+    return slot != nullptr && slot->first == node ? slot : nullptr;
+  }
+  const value_type* FindSlot(const Node* node) const {
+    return const_cast<NodeMap*>(this)->FindSlot(node);
+  }
+  // Returns the iterator pointing at `node` which must be in the map.
+  iterator IteratorFor(const Node* node) {
+    return iterator(this, table_.SlotIndex(node->id()));
+  }
+  const_iterator IteratorFor(const Node* node) const {
+    return const_iterator(this, table_.SlotIndex(node->id()));
+  }
+
+  internal::NodeIdTable<value_type> table_;
+  size_t size_ = 0;
+};
+
+// A set of nodes stored densely by node id. See NodeMap.
+class NodeSet {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Node*;
+    using difference_type = std::ptrdiff_t;
+    using reference = Node* const&;
+    using pointer = Node* const*;
+
+    const_iterator() = default;
+    explicit const_iterator(NodeMap<std::monostate>::const_iterator it)
+        : it_(it) {}
+
+    reference operator*() const { return it_->first; }
+    pointer operator->() const { return &it_->first; }
+    const_iterator& operator++() {
+      ++it_;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator result = *this;
+      ++it_;
+      return result;
+    }
+    bool operator==(const const_iterator& other) const {
+      return it_ == other.it_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    NodeMap<std::monostate>::const_iterator it_;
+  };
+  using iterator = const_iterator;
+  using value_type = Node*;
+
+  NodeSet() = default;
+  template <typename It>
+  NodeSet(It first, It last) {
+    insert(first, last);
+  }
+  NodeSet(std::initializer_list<Node*> nodes) {
+    insert(nodes.begin(), nodes.end());
+  }
+
+  const_iterator begin() const { return const_iterator(map_.begin()); }
+  const_iterator end() const { return const_iterator(map_.end()); }
+
+  size_t size() const { return map_.size(); }
+  bool empty() const { return map_.empty(); }
+
+  bool contains(const Node* node) const { return map_.contains(node); }
+  size_t count(const Node* node) const { return map_.count(node); }
+  const_iterator find(const Node* node) const {
+    return const_iterator(map_.find(node));
+  }
+
+  std::pair<const_iterator, bool> insert(Node* node) {
+    auto [it, inserted] = map_.try_emplace(node);
+    return {const_iterator(it), inserted};
+  }
+  template <typename It>
+  void insert(It first, It last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  size_t erase(const Node* node) { return map_.erase(node); }
+  void clear() { map_.clear(); }
+
+ private:
+  NodeMap<std::monostate> map_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_MAP_H_
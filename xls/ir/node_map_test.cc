@@ -0,0 +1,200 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_map.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+class NodeMapTest : public IrTestBase {
+ protected:
+  // Builds a function with `count` literal nodes and returns the nodes.
+  std::vector<Node*> MakeNodes(Package* p, int64_t count) {
+    FunctionBuilder fb(TestName(), p);
+    std::vector<BValue> values;
+    for (int64_t i = 0; i < count; ++i) {
+      values.push_back(fb.Literal(UBits(i, 32)));
+    }
+    Function* f = fb.BuildWithReturnValue(fb.Concat(values)).value();
+    std::vector<Node*> nodes;
+    for (const BValue& v : values) {
+      nodes.push_back(v.node());
+    }
+    CHECK_EQ(f->node_count(), count + 1);
+    return nodes;
+  }
+};
+
+TEST_F(NodeMapTest, Basic) {
+  auto p = CreatePackage();
+  std::vector<Node*> nodes = MakeNodes(p.get(), 4);
+  NodeMap<std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(nodes[0]));
+
+  map[nodes[2]] = "two";
+  map.insert({nodes[0], "zero"});
+  EXPECT_TRUE(map.try_emplace(nodes[3], "three").second);
+  EXPECT_FALSE(map.try_emplace(nodes[3], "THREE").second);
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_TRUE(map.contains(nodes[0]));
+  EXPECT_FALSE(map.contains(nodes[1]));
+  EXPECT_EQ(map.at(nodes[3]), "three");
+  EXPECT_EQ(map.find(nodes[1]), map.end());
+  EXPECT_EQ(map.find(nodes[2])->second, "two");
+
+  map.insert_or_assign(nodes[3], "THREE");
+  EXPECT_EQ(map.at(nodes[3]), "THREE");
+
+  EXPECT_EQ(map.erase(nodes[2]), 1);
+  EXPECT_EQ(map.erase(nodes[2]), 0);
+  EXPECT_EQ(map.count(nodes[2]), 0);
+  EXPECT_EQ(map.size(), 2);
+}
+
+TEST_F(NodeMapTest, IteratesInIdOrder) {
+  auto p = CreatePackage();
+  std::vector<Node*> nodes = MakeNodes(p.get(), 5);
+  NodeMap<int64_t> map;
+  // Insert out of order so the table grows at both ends.
+  map[nodes[3]] = 3;
+  map[nodes[1]] = 1;
+  map[nodes[4]] = 4;
+  map[nodes[0]] = 0;
+  EXPECT_THAT(map, ElementsAre(Pair(nodes[0], 0), Pair(nodes[1], 1),
+                               Pair(nodes[3], 3), Pair(nodes[4], 4)));
+  for (auto& [node, value] : map) {
+    value += 10;
+  }
+  EXPECT_EQ(map.at(nodes[4]), 14);
+}
+
+TEST_F(NodeMapTest, ClearAndReuse) {
+  auto p = CreatePackage();
+  std::vector<Node*> nodes = MakeNodes(p.get(), 3);
+  NodeMap<int64_t> map;
+  map[nodes[0]] = 1;
+  map[nodes[2]] = 2;
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(nodes[0]));
+  EXPECT_EQ(map.begin(), map.end());
+  // Values from before the clear are not visible after re-insertion.
+  EXPECT_EQ(map[nodes[0]], 0);
+  EXPECT_THAT(map, ElementsAre(Pair(nodes[0], 0)));
+}
+
+TEST_F(NodeMapTest, RemovedNodeIsNotConfusedWithNewNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue dead = fb.Not(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+  NodeMap<int64_t> map;
+  map[dead.node()] = 42;
+  XLS_ASSERT_OK(f->RemoveNode(dead.node()));
+  // The new node may reuse the memory of the removed node but has a new id.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * added,
+                           f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNot));
+  EXPECT_FALSE(map.contains(added));
+}
+
+TEST_F(NodeMapTest, RemovedNodeIdReusedByNewNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue dead = fb.Not(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+  NodeMap<int64_t> map;
+  NodeSet set;
+  map[dead.node()] = 42;
+  set.insert(dead.node());
+  int64_t dead_id = dead.node()->id();
+  XLS_ASSERT_OK(f->RemoveNode(dead.node()));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * added,
+                           f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNeg));
+  added->SetId(dead_id);
+
+  // The slot of the id still holds the removed node, which must not be
+  // mistaken for the new node.
+  EXPECT_FALSE(map.contains(added));
+  EXPECT_FALSE(set.contains(added));
+  EXPECT_EQ(map.find(added), map.end());
+  EXPECT_EQ(map.erase(added), 0);
+  EXPECT_EQ(map.size(), 1);
+
+  // Inserting the new node replaces the stale entry.
+  EXPECT_TRUE(map.try_emplace(added, 7).second);
+  EXPECT_TRUE(set.insert(added).second);
+  EXPECT_EQ(map.size(), 1);
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_THAT(map, ElementsAre(Pair(added, 7)));
+  EXPECT_THAT(set, ElementsAre(added));
+  EXPECT_EQ(map.erase(added), 1);
+  EXPECT_TRUE(map.empty());
+}
+
+TEST_F(NodeMapTest, CopyAndMove) {
+  auto p = CreatePackage();
+  std::vector<Node*> nodes = MakeNodes(p.get(), 2);
+  NodeMap<std::vector<int64_t>> map;
+  map[nodes[1]] = {1, 2, 3};
+  NodeMap<std::vector<int64_t>> copy = map;
+  EXPECT_THAT(copy.at(nodes[1]), ElementsAre(1, 2, 3));
+  NodeMap<std::vector<int64_t>> moved = std::move(map);
+  EXPECT_THAT(moved.at(nodes[1]), ElementsAre(1, 2, 3));
+  copy = moved;
+  EXPECT_EQ(copy.size(), 1);
+}
+
+TEST_F(NodeMapTest, NodeSet) {
+  auto p = CreatePackage();
+  std::vector<Node*> nodes = MakeNodes(p.get(), 4);
+  NodeSet set = {nodes[3], nodes[1]};
+  EXPECT_TRUE(set.insert(nodes[0]).second);
+  EXPECT_FALSE(set.insert(nodes[1]).second);
+  EXPECT_EQ(set.size(), 3);
+  EXPECT_TRUE(set.contains(nodes[3]));
+  EXPECT_FALSE(set.contains(nodes[2]));
+  EXPECT_THAT(set, ElementsAre(nodes[0], nodes[1], nodes[3]));
+  EXPECT_EQ(set.erase(nodes[1]), 1);
+  EXPECT_THAT(set, UnorderedElementsAre(nodes[0], nodes[3]));
+  set.clear();
+  EXPECT_TRUE(set.empty());
+}
+
+}  // namespace
+}  // namespace xls
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -29,6 +30,7 @@
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/format_strings.h"
 #include "xls/ir/function.h"
@@ -44,6 +46,7 @@
 #include "xls/ir/state_element.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_pool.h"
 
 namespace xls {
 
@@ -191,6 +194,11 @@ ArrayIndex::ArrayIndex(const SourceInfo& loc, Node* arg,
   AddOperands(indices);
 }
 
+void ArrayIndex::SetAssumedInBounds(bool value) {
+  assumed_in_bounds_ = value;
+  function_base()->IncrementModificationCount();
+}
+
 bool ArrayIndex::IsDefinitelyEqualTo(const Node* other) const {
   if (this == other) {
     return true;
@@ -247,6 +255,11 @@ ArrayUpdate::ArrayUpdate(const SourceInfo& loc, Node* arg, Node* update_value,
   AddOperands(indices);
 }
 
+void ArrayUpdate::SetAssumedInBounds(bool value) {
+  assumed_in_bounds_ = value;
+  function_base()->IncrementModificationCount();
+}
+
 bool ArrayUpdate::IsDefinitelyEqualTo(const Node* other) const {
   if (this == other) {
     return true;
@@ -375,6 +388,11 @@ absl::StatusOr<Node*> Assert::CloneInNewFunction(
       original_label(), GetNameView());
 }
 
+void Assert::set_label(std::string new_label) {
+  label_ = std::move(new_label);
+  function_base()->IncrementModificationCount();
+}
+
 bool Assert::IsDefinitelyEqualTo(const Node* other) const {
   if (this == other) {
     return true;
@@ -433,6 +451,11 @@ absl::StatusOr<Node*> Cover::CloneInNewFunction(
                                                original_label(), GetNameView());
 }
 
+void Cover::set_label(std::string new_label) {
+  label_ = std::move(new_label);
+  function_base()->IncrementModificationCount();
+}
+
 bool Cover::IsDefinitelyEqualTo(const Node* other) const {
   if (this == other) {
     return true;
@@ -779,11 +802,16 @@ Literal::Literal(const SourceInfo& loc, Value value, std::string_view name,
                  FunctionBase* function)
     : Node(Op::kLiteral, function->package()->GetTypeForValue(value), loc, name,
            function),
-      value_(std::move(value)) {
+      value_(function->package()->value_pool().Intern(std::move(value))) {
   CHECK(IsOpClass<Literal>(op_))
       << "Op `" << op_ << "` is not a valid op for Node class `Literal`.";
 }
 
+absl::StatusOr<std::shared_ptr<const LeafTypeTree<Value>>>
+Literal::GetValueTree() const {
+  return package()->value_pool().GetLeafTypeTree(value(), GetType());
+}
+
 absl::StatusOr<Node*> Literal::CloneInNewFunction(
     absl::Span<Node* const> new_operands, FunctionBase* new_function) const {
   XLS_RET_CHECK_EQ(operand_count(), new_operands.size());
@@ -18,6 +18,7 @@
 #include <array>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -30,6 +31,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/format_strings.h"
 #include "xls/ir/lsb_or_msb.h"
@@ -141,7 +143,7 @@ class ArrayIndex final : public Node {
 
   // Mark/unmark this array-index as having all of its bounds statically known
   // to be good.
-  void SetAssumedInBounds(bool value = true) { assumed_in_bounds_ = value; }
+  void SetAssumedInBounds(bool value = true);
 
   bool IsDefinitelyEqualTo(const Node* other) const final;
 
@@ -203,7 +205,7 @@ class ArrayUpdate final : public Node {
 
   // Mark/unmark this array-index as having all of its bounds statically known
   // to be good.
-  void SetAssumedInBounds(bool value = true) { assumed_in_bounds_ = value; }
+  void SetAssumedInBounds(bool value = true);
 
   bool IsDefinitelyEqualTo(const Node* other) const final;
 
@@ -235,7 +237,7 @@ class Assert final : public Node {
 
   Node* condition() const { return operand(1); }
 
-  void set_label(std::string new_label) { label_ = std::move(new_label); }
+  void set_label(std::string new_label);
 
   bool IsDefinitelyEqualTo(const Node* other) const final;
 
@@ -396,7 +398,7 @@ class Cover final : public Node {
 
   Node* condition() const { return operand(0); }
 
-  void set_label(std::string new_label) { label_ = std::move(new_label); }
+  void set_label(std::string new_label);
 
   bool IsDefinitelyEqualTo(const Node* other) const final;
 
@@ -615,6 +617,11 @@ class Literal final : public Node {
       FunctionBase* new_function) const final;
   const Value& value() const { return value_; }
 
+  // Returns the leaf type tree of the value. The tree is shared among all
+  // equal literals in the package.
+  absl::StatusOr<std::shared_ptr<const LeafTypeTree<Value>>> GetValueTree()
+      const;
+
   bool IsZero() const { return value().IsBits() && value().bits().IsZero(); }
 
   bool IsDefinitelyEqualTo(const Node* other) const final;
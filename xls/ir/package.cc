@@ -15,8 +15,11 @@
 #include "xls/ir/package.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
+#include <filesystem>  // NOLINT
+#include <iterator>
 #include <list>
 #include <memory>
 #include <optional>
@@ -26,17 +29,22 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/block.h"
 #include "xls/ir/call_graph.h"
 #include "xls/ir/channel.h"
@@ -48,6 +56,7 @@
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package_transaction.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/transform_metrics.pb.h"
@@ -57,6 +66,47 @@
 
 namespace xls {
 
+namespace {
+
+// The smallest range of node ids given to a function base by
+// Package::ForEachFunctionBaseConcurrently.
+constexpr int64_t kMinConcurrentIdRangeSize = 256;
+
+// The state of the thread calling the function of
+// Package::ForEachFunctionBaseConcurrently on a function base.
+//
+// Node ids are allocated in rounds of ranges fixed at the start of the run:
+// in each round, the function base at index `i` owns the `range_size` ids
+// starting at `base_id + round * round_size + range_offset`. A function base
+// which exhausts its range continues in its range of the next round. The ids
+// of every node thus depend only on the function bases and not on how the
+// calls were scheduled.
+struct ConcurrentTask {
+  const Package* package;
+  int64_t base_id;
+  int64_t round_size;
+  int64_t range_offset;
+  int64_t range_size;
+  int64_t round = 0;
+  int64_t next_node_id;
+  TransformMetrics metrics;
+
+  int64_t range_end() const {
+    return base_id + round * round_size + range_offset + range_size;
+  }
+};
+
+thread_local ConcurrentTask* current_concurrent_task = nullptr;
+
+// Returns the task of the calling thread if it is transforming a function base
+// of `package`.
+ConcurrentTask* GetConcurrentTask(const Package* package) {
+  ConcurrentTask* task = current_concurrent_task;
+  return task != nullptr && task->package == package ? task : nullptr;
+}
+
+}  // namespace
+
 Package::Package(std::string_view name) : name_(name) {}
 
 Package::~Package() = default;
@@ -70,6 +120,9 @@ absl::Status Package::SetTop(std::optional<FunctionBase*> top) {
         "belong to the package.",
         top.value()->name()));
   }
+  if (transaction_ != nullptr) {
+    transaction_->RecordTopChanged();
+  }
   top_ = top;
   return absl::OkStatus();
 }
@@ -147,16 +200,25 @@ absl::StatusOr<FunctionBase*> Package::GetFunctionBaseByName(
 
 Function* Package::AddFunction(std::unique_ptr<Function> f) {
   functions_.push_back(std::move(f));
+  if (transaction_ != nullptr) {
+    transaction_->RecordFunctionBaseAdded(functions_.back().get());
+  }
   return functions_.back().get();
 }
 
 Proc* Package::AddProc(std::unique_ptr<Proc> proc) {
   procs_.push_back(std::move(proc));
+  if (transaction_ != nullptr) {
+    transaction_->RecordFunctionBaseAdded(procs_.back().get());
+  }
   return procs_.back().get();
 }
 
 Block* Package::AddBlock(std::unique_ptr<Block> block) {
   blocks_.push_back(std::move(block));
+  if (transaction_ != nullptr) {
+    transaction_->RecordFunctionBaseAdded(blocks_.back().get());
+  }
   return blocks_.back().get();
 }
 
@@ -425,6 +487,20 @@ absl::Status Package::RemoveFunction(Function* function) {
         "Cannot remove function: %s. The function is the top entity.",
         function->name()));
   }
+  if (transaction_ != nullptr) {
+    auto it = absl::c_find_if(functions_,
+                              [&](const std::unique_ptr<Function>& f) {
+                                return f.get() == function;
+                              });
+    if (it != functions_.end()) {
+      // Keep the function alive so the removal can be rolled back.
+      int64_t index = std::distance(functions_.begin(), it);
+      std::unique_ptr<Function> removed = std::move(*it);
+      functions_.erase(it);
+      transaction_->RecordFunctionBaseRemoved(std::move(removed), index);
+      return absl::OkStatus();
+    }
+  }
   auto it = std::remove_if(
       functions_.begin(), functions_.end(),
       [&](const std::unique_ptr<Function>& f) { return f.get() == function; });
@@ -441,6 +517,19 @@ absl::Status Package::RemoveProc(Proc* proc) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Cannot remove proc: %s. The proc is the top entity.", proc->name()));
   }
+  if (transaction_ != nullptr) {
+    auto it = absl::c_find_if(procs_, [&](const std::unique_ptr<Proc>& f) {
+      return f.get() == proc;
+    });
+    if (it != procs_.end()) {
+      // Keep the proc alive so the removal can be rolled back.
+      int64_t index = std::distance(procs_.begin(), it);
+      std::unique_ptr<Proc> removed = std::move(*it);
+      procs_.erase(it);
+      transaction_->RecordFunctionBaseRemoved(std::move(removed), index);
+      return absl::OkStatus();
+    }
+  }
   auto it = std::remove_if(
       procs_.begin(), procs_.end(),
       [&](const std::unique_ptr<Proc>& f) { return f.get() == proc; });
@@ -458,6 +547,19 @@ absl::Status Package::RemoveBlock(Block* block) {
         absl::StrFormat("Cannot remove block: %s. The block is the top entity.",
                         block->name()));
   }
+  if (transaction_ != nullptr) {
+    auto it = absl::c_find_if(blocks_, [&](const std::unique_ptr<Block>& f) {
+      return f.get() == block;
+    });
+    if (it != blocks_.end()) {
+      // Keep the block alive so the removal can be rolled back.
+      int64_t index = std::distance(blocks_.begin(), it);
+      std::unique_ptr<Block> removed = std::move(*it);
+      blocks_.erase(it);
+      transaction_->RecordFunctionBaseRemoved(std::move(removed), index);
+      return absl::OkStatus();
+    }
+  }
   auto it = std::remove_if(
       blocks_.begin(), blocks_.end(),
       [&](const std::unique_ptr<Block>& f) { return f.get() == block; });
@@ -562,6 +664,17 @@ bool Package::IsDefinitelyEqualTo(const Package* other) const {
 
 std::string Package::DumpIr() const {
   std::string out;
+  CHECK_OK(EmitIr([&out](std::string_view piece) {
+    absl::StrAppend(&out, piece);
+    return absl::OkStatus();
+  }));
+  return out;
+}
+
+absl::Status Package::EmitIr(
+    absl::FunctionRef<absl::Status(std::string_view)> sink,
+    int64_t parallelism) const {
+  std::string out;
   absl::StrAppend(&out, "package ", name(), "\n\n");
 
   if (!fileno_to_filename_.empty()) {
@@ -585,8 +698,15 @@ std::string Package::DumpIr() const {
     }
     absl::StrAppend(&out, "\n");
   }
+  // The emitted text is that of every function base followed by a newline,
+  // minus the final newline. Emit the header without its trailing newline and
+  // each function base preceded by one instead, so nothing is held back.
+  CHECK_EQ(out.back(), '\n');
+  out.pop_back();
+  XLS_RETURN_IF_ERROR(sink(out));
+
   std::optional<FunctionBase*> top = GetTop();
-  auto append_ir_with_attributes = [&top, &out](FunctionBase* fb) {
+  auto ir_with_attributes = [&top](FunctionBase* fb) -> std::string {
     std::string_view attribute_prefix;
     std::string_view attribute_suffix;
     std::vector<std::string> attribute_strings = fb->AttributeIrStrings();
@@ -599,22 +719,59 @@ std::string Package::DumpIr() const {
       top_prefix = "top ";
     }
 
-    absl::StrAppend(&out, attribute_prefix,
-                    absl::StrJoin(attribute_strings, ", "), attribute_suffix,
-                    top_prefix, fb->DumpIr(), "\n");
+    return absl::StrCat("\n", attribute_prefix,
+                        absl::StrJoin(attribute_strings, ", "),
+                        attribute_suffix, top_prefix, fb->DumpIr());
   };
   // Our parser relies on everything being in post-order. Ensure that here.
-  for (FunctionBase* fb : FunctionsInPostOrder(this)) {
-    append_ir_with_attributes(fb);
+  std::vector<FunctionBase*> function_bases = FunctionsInPostOrder(this);
+  if (parallelism <= 1) {
+    for (FunctionBase* fb : function_bases) {
+      XLS_RETURN_IF_ERROR(sink(ir_with_attributes(fb)));
+    }
+    return absl::OkStatus();
   }
-  // We don't include the trailing newline, drop it here.
-  CHECK_EQ(out.back(), '\n');
-  out.pop_back();
-  return out;
+  // Format batches of `parallelism` function bases concurrently and emit each
+  // batch in order. Only one batch of text is held in memory at a time.
+  std::vector<std::string> texts(parallelism);
+  for (int64_t start = 0; start < function_bases.size(); start += parallelism) {
+    int64_t count =
+        std::min<int64_t>(parallelism, function_bases.size() - start);
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      threads.reserve(count);
+      for (int64_t i = 0; i < count; ++i) {
+        threads.push_back(std::make_unique<Thread>([&, i]() {
+          texts[i] = ir_with_attributes(function_bases[start + i]);
+        }));
+      }
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+    for (int64_t i = 0; i < count; ++i) {
+      XLS_RETURN_IF_ERROR(sink(texts[i]));
+      texts[i].clear();
+      texts[i].shrink_to_fit();
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Package::DumpIrToFile(const std::filesystem::path& path,
+                                   int64_t parallelism) const {
+  return SetFileContentsStreaming(
+      path,
+      [&](absl::FunctionRef<absl::Status(std::string_view)> append) {
+        return EmitIr(append, parallelism);
+      });
 }
 
 std::ostream& operator<<(std::ostream& os, const Package& package) {
-  os << package.DumpIr();
+  CHECK_OK(package.EmitIr([&os](std::string_view piece) {
+    os << piece;
+    return absl::OkStatus();
+  }));
   return os;
 }
 
@@ -698,6 +855,9 @@ absl::Status Package::RemoveChannel(Channel* channel) {
   // First check that the channel is owned by this package.
   auto it = std::find(channel_vec_.begin(), channel_vec_.end(), channel);
   XLS_RET_CHECK(it != channel_vec_.end()) << "Channel not owned by package";
+  if (transaction_ != nullptr) {
+    transaction_->RecordUnsupportedMutation("removing a channel");
+  }
 
   // Check that no send/receive nodes are associated with the channel.
   // TODO(https://github.com/google/xls/issues/411) 2012/04/24 Avoid iterating
@@ -730,6 +890,9 @@ absl::Status Package::RemoveChannel(Channel* channel) {
 }
 
 absl::Status Package::AddChannel(std::unique_ptr<Channel> channel, Proc* proc) {
+  if (transaction_ != nullptr) {
+    transaction_->RecordUnsupportedMutation("adding a channel");
+  }
   if (proc != nullptr) {
     next_channel_id_ = std::max(next_channel_id_, channel->id() + 1);
     return proc->AddChannel(std::move(channel)).status();
@@ -878,6 +1041,114 @@ absl::StatusOr<FunctionBase*> FindTop(Package* p,
   return top.value();
 }
 
+int64_t Package::GetNextNodeIdAndIncrement() {
+  if (ConcurrentTask* task = GetConcurrentTask(this)) {
+    if (task->next_node_id == task->range_end()) {
+      ++task->round;
+      task->next_node_id = task->range_end() - task->range_size;
+    }
+    return task->next_node_id++;
+  }
+  return next_node_id_++;
+}
+
+int64_t Package::next_node_id() const {
+  if (ConcurrentTask* task = GetConcurrentTask(this)) {
+    return task->next_node_id;
+  }
+  return next_node_id_;
+}
+
+void Package::set_next_node_id(int64_t value) {
+  if (ConcurrentTask* task = GetConcurrentTask(this)) {
+    // Ids outside the range of the function base may belong to another.
+    CHECK_LE(value, task->next_node_id)
+        << "Node ids cannot be raised while transforming concurrently";
+    return;
+  }
+  next_node_id_ = value;
+}
+
+const TransformMetrics& Package::transform_metrics() const {
+  if (ConcurrentTask* task = GetConcurrentTask(this)) {
+    return task->metrics;
+  }
+  return transform_metrics_;
+}
+
+TransformMetrics& Package::transform_metrics() {
+  if (ConcurrentTask* task = GetConcurrentTask(this)) {
+    return task->metrics;
+  }
+  return transform_metrics_;
+}
+
+absl::Status Package::ForEachFunctionBaseConcurrently(
+    absl::Span<FunctionBase* const> function_bases, int64_t thread_count,
+    absl::FunctionRef<absl::Status(FunctionBase*)> f) {
+  XLS_RET_CHECK(GetConcurrentTask(this) == nullptr)
+      << "Concurrent transformations of a package may not be nested";
+  const int64_t count = function_bases.size();
+  if (thread_count <= 1 || count <= 1) {
+    for (FunctionBase* function_base : function_bases) {
+      XLS_RETURN_IF_ERROR(f(function_base));
+    }
+    return absl::OkStatus();
+  }
+  // The undo log of a transaction is not thread-safe.
+  XLS_RET_CHECK(transaction_ == nullptr)
+      << "Cannot transform a package concurrently during a transaction";
+
+  // Give each function base a range of ids for the nodes it creates, sized by
+  // the function base so large function bases rarely need another round.
+  const int64_t base_id = next_node_id_;
+  std::vector<ConcurrentTask> tasks;
+  tasks.reserve(count);
+  int64_t round_size = 0;
+  for (FunctionBase* function_base : function_bases) {
+    int64_t range_size =
+        std::max(kMinConcurrentIdRangeSize, function_base->node_count());
+    tasks.push_back(ConcurrentTask{.package = this,
+                                   .base_id = base_id,
+                                   .range_offset = round_size,
+                                   .range_size = range_size,
+                                   .next_node_id = base_id + round_size});
+    round_size += range_size;
+  }
+  for (ConcurrentTask& task : tasks) {
+    task.round_size = round_size;
+  }
+  std::vector<absl::Status> statuses(count);
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < count; i = next_index++) {
+      current_concurrent_task = &tasks[i];
+      statuses[i] = f(function_bases[i]);
+      current_concurrent_task = nullptr;
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(std::min(thread_count, count));
+    for (int64_t i = 0; i < std::min(thread_count, count); ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  for (const ConcurrentTask& task : tasks) {
+    transform_metrics_ = transform_metrics_ + task.metrics;
+    next_node_id_ = std::max(next_node_id_, task.next_node_id);
+  }
+
+  for (absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 TransformMetrics TransformMetrics::operator+(
     const TransformMetrics& other) const {
   return TransformMetrics{
@@ -885,6 +1156,8 @@ TransformMetrics TransformMetrics::operator+(
       .nodes_removed = nodes_removed + other.nodes_removed,
       .nodes_replaced = nodes_replaced + other.nodes_replaced,
       .operands_replaced = operands_replaced + other.operands_replaced,
+      .nodes_visited = nodes_visited + other.nodes_visited,
+      .query_engine_time = query_engine_time + other.query_engine_time,
   };
 }
 
@@ -895,14 +1168,17 @@ TransformMetrics TransformMetrics::operator-(
       .nodes_removed = nodes_removed - other.nodes_removed,
       .nodes_replaced = nodes_replaced - other.nodes_replaced,
       .operands_replaced = operands_replaced - other.operands_replaced,
+      .nodes_visited = nodes_visited - other.nodes_visited,
+      .query_engine_time = query_engine_time - other.query_engine_time,
   };
 }
 
 std::string TransformMetrics::ToString() const {
   return absl::StrFormat(
       "{ nodes added: %d, nodes removed: %d, nodes replaced: %d, operands "
-      "replaced: %d }",
-      nodes_added, nodes_removed, nodes_replaced, operands_replaced);
+      "replaced: %d, nodes visited: %d, query engine time: %s }",
+      nodes_added, nodes_removed, nodes_replaced, operands_replaced,
+      nodes_visited, absl::FormatDuration(query_engine_time));
 }
 
 TransformMetricsProto TransformMetrics::ToProto() const {
@@ -911,6 +1187,12 @@ TransformMetricsProto TransformMetrics::ToProto() const {
   ret.set_nodes_removed(nodes_removed);
   ret.set_nodes_replaced(nodes_replaced);
   ret.set_operands_replaced(operands_replaced);
+  ret.set_nodes_visited(nodes_visited);
+  absl::Duration rem;
+  ret.mutable_query_engine_duration()->set_seconds(
+      absl::IDivDuration(query_engine_time, absl::Seconds(1), &rem));
+  ret.mutable_query_engine_duration()->set_nanos(
+      absl::IDivDuration(rem, absl::Nanoseconds(1), &rem));
   return ret;
 }
 
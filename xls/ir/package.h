@@ -16,6 +16,7 @@
 #define XLS_IR_PACKAGE_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -26,18 +27,24 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/fileno.h"
+#include "xls/ir/name_table.h"
+#include "xls/ir/node_allocator.h"
+#include "xls/ir/source_info_table.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/transform_metrics.pb.h"
 #include "xls/ir/type.h"
 #include "xls/ir/type_manager.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_pool.h"
 #include "xls/ir/xls_type.pb.h"
 
 namespace xls {
@@ -46,6 +53,7 @@ class Block;
 class Channel;
 class Function;
 class FunctionBase;
+class PackageTransaction;
 class Proc;
 class SingleValueChannel;
 class StreamingChannel;
@@ -68,6 +76,13 @@ struct TransformMetrics {
   // Node::ReplaceOperand[Number]).
   int64_t operands_replaced = 0;
 
+  // Number of nodes in the function bases on which function-base passes ran
+  // (see OptimizationFunctionBasePass).
+  int64_t nodes_visited = 0;
+
+  // Time spent populating query engines (see ScopedQueryEngineTimer).
+  absl::Duration query_engine_time;
+
   TransformMetrics operator+(const TransformMetrics& other) const;
   TransformMetrics operator-(const TransformMetrics& other) const;
   std::string ToString() const;
@@ -216,7 +231,7 @@ class Package {
 
   // Retrieves the next node ID to assign to a node in the package and
   // increments the next node counter. For use in node construction.
-  int64_t GetNextNodeIdAndIncrement() { return next_node_id_++; }
+  int64_t GetNextNodeIdAndIncrement();
 
   // Adds a file to the file-number table and returns its corresponding number.
   // If it already exists, returns the existing file-number entry.
@@ -279,12 +294,46 @@ class Package {
   // Dumps the IR in a parsable text format.
   std::string DumpIr() const;
 
+  // Emits the IR in the text format of DumpIr to `sink` in pieces of at most
+  // one function base, so the text of the entire package is never held in
+  // memory. If `parallelism` is greater than one, up to that many function
+  // bases are formatted concurrently; the emitted text is the same. Returns
+  // the first error returned by `sink`.
+  absl::Status EmitIr(absl::FunctionRef<absl::Status(std::string_view)> sink,
+                      int64_t parallelism = 1) const;
+
+  // Writes the IR in the text format of DumpIr to the file at `path` as it is
+  // emitted. See EmitIr.
+  absl::Status DumpIrToFile(const std::filesystem::path& path,
+                            int64_t parallelism = 1) const;
+
   std::vector<std::string> GetFunctionNames() const;
 
-  int64_t next_node_id() const { return next_node_id_; }
+  // Returns the id the next node created in the package will be given.
+  int64_t next_node_id() const;
 
   // Intended for use by the parser when node ids are suggested by the IR text.
-  void set_next_node_id(int64_t value) { next_node_id_ = value; }
+  void set_next_node_id(int64_t value);
+
+  // Calls `f` on each of `function_bases` using up to `thread_count` threads.
+  // Each call may only modify the function base it is passed; it may read
+  // (but not modify) the rest of the package and may create types and
+  // intern values. If `thread_count` is one, the calls are made in order on
+  // the calling thread until one fails.
+  //
+  // The result is deterministic: it does not depend on how the calls are
+  // scheduled on the threads. Before any call is made, each function base is
+  // given ranges of node ids from which the nodes it creates take their ids,
+  // so the ids are the same for any `thread_count` greater than one. They
+  // differ from the ids of a run on one thread, but within each function base
+  // new nodes are still numbered after its existing nodes and in the order
+  // they are created. While `f` runs, next_node_id() returns the next id of
+  // the calling thread's function base and transform_metrics() returns the
+  // metrics of the calling thread's function base only. Returns the error of
+  // the first function base (in order) for which `f` failed.
+  absl::Status ForEachFunctionBaseConcurrently(
+      absl::Span<FunctionBase* const> function_bases, int64_t thread_count,
+      absl::FunctionRef<absl::Status(FunctionBase*)> f);
 
   // Create a channel. Channels are used with send/receive nodes in communicate
   // between procs or between procs and external (to XLS) components. If no
@@ -441,10 +490,25 @@ class Package {
       const CloneChannelOverrides& overrides = CloneChannelOverrides());
 
   // Returns the transform metrics aggregated across all FunctionBases.
-  const TransformMetrics& transform_metrics() const {
-    return transform_metrics_;
-  }
-  TransformMetrics& transform_metrics() { return transform_metrics_; }
+  const TransformMetrics& transform_metrics() const;
+  TransformMetrics& transform_metrics();
+
+  // Returns the transaction recording the mutations of this package, or
+  // nullptr if there is none. See PackageTransaction.
+  PackageTransaction* transaction() const { return transaction_; }
+
+  // Returns the pool of values interned in this package. The values of
+  // literals are interned so equal literals share storage.
+  ValuePool& value_pool() { return value_pool_; }
+
+  // Returns the tables in which the names and source locations of the nodes in
+  // this package are interned.
+  NameTable& name_table() { return name_table_; }
+  SourceInfoTable& source_info_table() { return source_info_table_; }
+
+  // Returns the arena from which the nodes of this package are allocated. The
+  // arena is released when the package is destroyed.
+  NodeArena& node_arena() { return *node_arena_; }
 
  private:
   std::vector<std::string> GetChannelNames() const;
@@ -453,6 +517,7 @@ class Package {
   absl::Status AddChannel(std::unique_ptr<Channel> channel, Proc* proc);
 
   friend class FunctionBuilder;
+  friend class PackageTransaction;
 
   std::optional<FunctionBase*> top_;
 
@@ -466,13 +531,24 @@ class Package {
   // Ordinal to assign to the next node created in this package.
   int64_t next_node_id_ = 1;
 
+  // Declared before the function bases so the nodes are destroyed first.
+  std::unique_ptr<NodeArena, NodeArena::Deleter> node_arena_ =
+      NodeArena::Create();
+  NameTable name_table_;
+  SourceInfoTable source_info_table_;
+
   std::vector<std::unique_ptr<Function>> functions_;
   std::vector<std::unique_ptr<Proc>> procs_;
   std::vector<std::unique_ptr<Block>> blocks_;
 
+  // The active transaction on this package, if any. Not owned.
+  PackageTransaction* transaction_ = nullptr;
+
   // Underlying manager for types used in this package.
   TypeManager type_manager_;
 
+  ValuePool value_pool_;
+
   // The largest `Fileno` used in this `Package`.
   std::optional<Fileno> maximum_fileno_;
 
@@ -15,27 +15,38 @@
 #include "xls/ir/package.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <sstream>
+#include <string>
 #include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
 #include "xls/ir/xls_type.pb.h"
 
 namespace xls {
@@ -1224,5 +1235,151 @@ TEST_F(PackageTest, TransformMetrics) {
   EXPECT_EQ(p->transform_metrics().operands_replaced, 2);
 }
 
+TEST_F(PackageTest, ForEachFunctionBaseConcurrentlyIsDeterministic) {
+  auto make_package = [&]() {
+    std::unique_ptr<Package> p = CreatePackage();
+    for (int64_t i = 0; i < 8; ++i) {
+      FunctionBuilder fb(absl::StrCat("f", i), p.get());
+      fb.Add(fb.Param("x", p->GetBitsType(8)), fb.Literal(UBits(i, 8)));
+      CHECK_OK(fb.Build().status());
+    }
+    return p;
+  };
+  // Negates the return value of function `fi` i + 1 times, naming a copy of
+  // each negation after its generated name and removing a temporary node.
+  auto transform = [](FunctionBase* fb) -> absl::Status {
+    Function* f = fb->AsFunctionOrDie();
+    for (int64_t i = 0; i <= f->name().back() - '0'; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * temp,
+          f->MakeNode<UnOp>(SourceInfo(), f->return_value(), Op::kNot));
+      XLS_ASSIGN_OR_RETURN(
+          Node * neg,
+          f->MakeNode<UnOp>(SourceInfo(), f->return_value(), Op::kNeg));
+      XLS_RETURN_IF_ERROR(f->RemoveNode(temp));
+      XLS_ASSIGN_OR_RETURN(
+          Node * copy,
+          f->MakeNodeWithName<UnOp>(SourceInfo(), neg, Op::kIdentity,
+                                    absl::StrCat(neg->GetName(), "_copy")));
+      XLS_RETURN_IF_ERROR(f->set_return_value(copy));
+    }
+    return absl::OkStatus();
+  };
+
+  std::unique_ptr<Package> serial = make_package();
+  XLS_ASSERT_OK(serial->ForEachFunctionBaseConcurrently(
+      serial->GetFunctionBases(), /*thread_count=*/1, transform));
+  std::optional<std::string> concurrent_ir;
+  for (int64_t thread_count : {2, 3, 16}) {
+    std::unique_ptr<Package> p = make_package();
+    XLS_ASSERT_OK(p->ForEachFunctionBaseConcurrently(p->GetFunctionBases(),
+                                                     thread_count, transform));
+    XLS_ASSERT_OK(VerifyPackage(p.get()));
+    if (!concurrent_ir.has_value()) {
+      concurrent_ir = p->DumpIr();
+    }
+    EXPECT_EQ(p->DumpIr(), *concurrent_ir) << "thread_count=" << thread_count;
+    // Only the ids of the new nodes differ from a serial run.
+    for (int64_t i = 0; i < p->GetFunctionBases().size(); ++i) {
+      EXPECT_EQ(p->GetFunctionBases()[i]->node_count(),
+                serial->GetFunctionBases()[i]->node_count());
+      EXPECT_EQ(p->GetFunctionBases()[i]->graph_version(),
+                serial->GetFunctionBases()[i]->graph_version());
+    }
+    EXPECT_EQ(p->transform_metrics().nodes_added,
+              serial->transform_metrics().nodes_added);
+  }
+}
+
+TEST_F(PackageTest, ForEachFunctionBaseConcurrentlyWithManyNewNodes) {
+  auto make_package = [&]() {
+    std::unique_ptr<Package> p = CreatePackage();
+    for (int64_t i = 0; i < 4; ++i) {
+      FunctionBuilder fb(absl::StrCat("f", i), p.get());
+      fb.Param("x", p->GetBitsType(8));
+      CHECK_OK(fb.Build().status());
+    }
+    return p;
+  };
+  // Function `fi` creates far more nodes than the range of ids it is first
+  // given, so it continues in later ranges.
+  auto transform = [](FunctionBase* fb) -> absl::Status {
+    Function* f = fb->AsFunctionOrDie();
+    for (int64_t i = 0; i < 1000 * (f->name().back() - '0'); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * neg,
+          f->MakeNode<UnOp>(SourceInfo(), f->return_value(), Op::kNeg));
+      XLS_RETURN_IF_ERROR(f->set_return_value(neg));
+    }
+    return absl::OkStatus();
+  };
+
+  std::optional<std::string> expected_ir;
+  for (int64_t thread_count : {2, 4}) {
+    std::unique_ptr<Package> p = make_package();
+    int64_t base_id = p->next_node_id();
+    XLS_ASSERT_OK(p->ForEachFunctionBaseConcurrently(p->GetFunctionBases(),
+                                                     thread_count, transform));
+    // The verifier checks that the ids are unique.
+    XLS_ASSERT_OK(VerifyPackage(p.get()));
+    if (!expected_ir.has_value()) {
+      expected_ir = p->DumpIr();
+    }
+    EXPECT_EQ(p->DumpIr(), *expected_ir) << "thread_count=" << thread_count;
+    // The ids stay within a few rounds of ranges rather than being spread
+    // across the id space.
+    EXPECT_LT(p->next_node_id(), base_id + 4 * 6000);
+  }
+}
+
+TEST_F(PackageTest, ForEachFunctionBaseConcurrentlyReturnsFirstError) {
+  auto p = CreatePackage();
+  for (int64_t i = 0; i < 4; ++i) {
+    FunctionBuilder fb(absl::StrCat("f", i), p.get());
+    fb.Param("x", p->GetBitsType(8));
+    XLS_ASSERT_OK(fb.Build().status());
+  }
+  EXPECT_THAT(p->ForEachFunctionBaseConcurrently(
+                  p->GetFunctionBases(), /*thread_count=*/4,
+                  [](FunctionBase* fb) -> absl::Status {
+                    if (fb->name() == "f0") {
+                      return absl::OkStatus();
+                    }
+                    return absl::InternalError(fb->name());
+                  }),
+              StatusIs(absl::StatusCode::kInternal, "f1"));
+}
+
+TEST_F(PackageTest, EmitIrMatchesDumpIr) {
+  auto p = CreatePackage();
+  EXPECT_EQ(p->DumpIr(), absl::StrCat("package ", p->name(), "\n"));
+
+  for (int64_t i = 0; i < 5; ++i) {
+    FunctionBuilder fb(absl::StrCat("f", i), p.get());
+    fb.Add(fb.Param("x", p->GetBitsType(8)), fb.Literal(UBits(i, 8)));
+    XLS_ASSERT_OK(fb.Build().status());
+  }
+  XLS_ASSERT_OK(p->SetTopByName("f2"));
+  std::string expected = p->DumpIr();
+  EXPECT_THAT(expected, HasSubstr("top fn f2"));
+
+  for (int64_t parallelism : {1, 2, 3, 8}) {
+    std::vector<std::string> pieces;
+    XLS_ASSERT_OK(p->EmitIr(
+        [&](std::string_view piece) {
+          pieces.push_back(std::string(piece));
+          return absl::OkStatus();
+        },
+        parallelism));
+    // The package header and then one piece per function.
+    EXPECT_EQ(pieces.size(), 6);
+    EXPECT_EQ(absl::StrJoin(pieces, ""), expected)
+        << "parallelism=" << parallelism;
+  }
+  std::ostringstream os;
+  os << *p;
+  EXPECT_EQ(os.str(), expected);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,296 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/package_transaction.h"
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "absl/types/variant.h"
+#include "xls/common/casts.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/visitor.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+namespace {
+
+// Returns the distinct non-null operands of `node` in operand order.
+std::vector<Node*> UniqueOperands(absl::Span<Node* const> operands) {
+  std::vector<Node*> result;
+  for (Node* operand : operands) {
+    if (operand != nullptr && !absl::c_linear_search(result, operand)) {
+      result.push_back(operand);
+    }
+  }
+  return result;
+}
+
+// Removes `function_base` from `function_bases` and returns it.
+template <typename T>
+std::unique_ptr<FunctionBase> ExtractFunctionBase(
+    std::vector<std::unique_ptr<T>>& function_bases,
+    FunctionBase* function_base) {
+  auto it = absl::c_find_if(function_bases, [&](const std::unique_ptr<T>& fb) {
+    return fb.get() == function_base;
+  });
+  CHECK(it != function_bases.end());
+  std::unique_ptr<FunctionBase> result = std::move(*it);
+  function_bases.erase(it);
+  return result;
+}
+
+template <typename T>
+void InsertFunctionBase(std::vector<std::unique_ptr<T>>& function_bases,
+                        std::unique_ptr<FunctionBase> function_base,
+                        int64_t index) {
+  function_bases.insert(function_bases.begin() + index,
+                        std::unique_ptr<T>(down_cast<T*>(
+                            function_base.release())));
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<PackageTransaction>>
+PackageTransaction::Begin(Package* package) {
+  if (package->transaction() != nullptr) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Package `%s` already has an active transaction", package->name()));
+  }
+  auto transaction = absl::WrapUnique(new PackageTransaction(package));
+  package->transaction_ = transaction.get();
+  return transaction;
+}
+
+PackageTransaction::~PackageTransaction() {
+  if (!active()) {
+    return;
+  }
+  absl::Status status = Rollback();
+  if (!status.ok()) {
+    LOG(ERROR) << "Unable to roll back transaction on package `"
+               << package_->name() << "`: " << status;
+  }
+}
+
+void PackageTransaction::Commit() {
+  CHECK(active());
+  package_->transaction_ = nullptr;
+  log_.clear();
+}
+
+absl::Status PackageTransaction::Rollback() {
+  XLS_RET_CHECK(active()) << "Transaction is not active";
+  // Stop recording so the mutations made while undoing are not logged.
+  package_->transaction_ = nullptr;
+  if (unsupported_mutation_.has_value()) {
+    log_.clear();
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Cannot roll back transaction on package `%s`: %s is not supported "
+        "by transactions",
+        package_->name(), *unsupported_mutation_));
+  }
+  for (auto it = log_.rbegin(); it != log_.rend(); ++it) {
+    XLS_RETURN_IF_ERROR(Undo(*it));
+  }
+  log_.clear();
+  graveyard_.clear();
+  return absl::OkStatus();
+}
+
+absl::Status PackageTransaction::Undo(Mutation& mutation) {
+  return absl::visit(
+      Visitor{
+          [&](NodeAdded& m) -> absl::Status {
+            return m.node->function_base()->RemoveNode(m.node);
+          },
+          [&](NodeRemoved& m) -> absl::Status {
+            FunctionBase* fb = m.function_base;
+            Node* node = m.node.get();
+            auto position = m.next_node == nullptr
+                                ? fb->nodes_.end()
+                                : m.next_node->node_list_position_;
+            node->node_list_position_ =
+                fb->nodes_.insert(position, std::move(m.node));
+            for (Node* operand : UniqueOperands(node->operands())) {
+              operand->AddUser(node);
+            }
+            if (node->Is<Param>()) {
+              XLS_RET_CHECK(m.list_index.has_value());
+              fb->params_.insert(fb->params_.begin() + *m.list_index,
+                                 node->As<Param>());
+            }
+            if (node->Is<StateRead>()) {
+              fb->next_values_by_state_read_[node->As<StateRead>()];
+            }
+            if (node->Is<Next>()) {
+              XLS_RET_CHECK(m.list_index.has_value());
+              Next* next = node->As<Next>();
+              fb->next_values_.insert(fb->next_values_.begin() + *m.list_index,
+                                      next);
+              fb->next_values_by_state_read_
+                  .at(next->state_read()->As<StateRead>())
+                  .insert(next);
+            }
+            fb->IncrementGraphVersion();
+            return absl::OkStatus();
+          },
+          [&](OperandsChanged& m) -> absl::Status {
+            Node* node = m.node;
+            for (Node* operand : UniqueOperands(node->operands())) {
+              operand->RemoveUser(node);
+            }
+            node->operands_.assign(m.old_operands.begin(),
+                                   m.old_operands.end());
+            for (Node* operand : UniqueOperands(node->operands())) {
+              operand->AddUser(node);
+            }
+            return absl::OkStatus();
+          },
+          [&](NameChanged& m) -> absl::Status {
+            m.node->name_id_ = m.old_name_id;
+            return absl::OkStatus();
+          },
+          [&](LocChanged& m) -> absl::Status {
+            m.node->AssignLoc(m.old_loc);
+            return absl::OkStatus();
+          },
+          [&](ReturnValueChanged& m) -> absl::Status {
+            m.function->return_value_ = m.old_return_value;
+            m.function->IncrementGraphVersion();
+            return absl::OkStatus();
+          },
+          [&](ParamMoved& m) -> absl::Status {
+            return m.param->function_base()->MoveParamToIndex(m.param,
+                                                              m.old_index);
+          },
+          [&](FunctionBaseAdded& m) -> absl::Status {
+            FunctionBase* fb = m.function_base;
+            if (fb->IsFunction()) {
+              graveyard_.push_back(
+                  ExtractFunctionBase(package_->functions_, fb));
+            } else if (fb->IsProc()) {
+              graveyard_.push_back(ExtractFunctionBase(package_->procs_, fb));
+            } else {
+              graveyard_.push_back(ExtractFunctionBase(package_->blocks_, fb));
+            }
+            return absl::OkStatus();
+          },
+          [&](FunctionBaseRemoved& m) -> absl::Status {
+            FunctionBase* fb = m.function_base.get();
+            if (fb->IsFunction()) {
+              InsertFunctionBase(package_->functions_,
+                                 std::move(m.function_base), m.index);
+            } else if (fb->IsProc()) {
+              InsertFunctionBase(package_->procs_, std::move(m.function_base),
+                                 m.index);
+            } else {
+              InsertFunctionBase(package_->blocks_, std::move(m.function_base),
+                                 m.index);
+            }
+            return absl::OkStatus();
+          },
+          [&](TopChanged& m) -> absl::Status {
+            package_->top_ = m.old_top;
+            return absl::OkStatus();
+          },
+      },
+      mutation);
+}
+
+void PackageTransaction::RecordNodeAdded(Node* node) {
+  log_.push_back(NodeAdded{.node = node});
+}
+
+void PackageTransaction::RecordNodeRemoved(FunctionBase* function_base,
+                                           std::unique_ptr<Node> node,
+                                           Node* next_node,
+                                           std::optional<int64_t> list_index) {
+  log_.push_back(NodeRemoved{.function_base = function_base,
+                             .node = std::move(node),
+                             .next_node = next_node,
+                             .list_index = list_index});
+}
+
+void PackageTransaction::RecordOperandsChanged(Node* node) {
+  if (node->function_base()->IsBlock()) {
+    RecordUnsupportedMutation("changing the operands of a block node");
+    return;
+  }
+  log_.push_back(OperandsChanged{
+      .node = node,
+      .old_operands = std::vector<Node*>(node->operands().begin(),
+                                         node->operands().end())});
+}
+
+void PackageTransaction::RecordNameChanged(Node* node) {
+  log_.push_back(NameChanged{.node = node, .old_name_id = node->name_id_});
+}
+
+void PackageTransaction::RecordLocChanged(Node* node) {
+  log_.push_back(LocChanged{.node = node, .old_loc = node->loc()});
+}
+
+void PackageTransaction::RecordReturnValueChanged(Function* function) {
+  log_.push_back(ReturnValueChanged{
+      .function = function, .old_return_value = function->return_value()});
+}
+
+void PackageTransaction::RecordParamMoved(Param* param, int64_t old_index) {
+  log_.push_back(ParamMoved{.param = param, .old_index = old_index});
+}
+
+void PackageTransaction::RecordFunctionBaseAdded(FunctionBase* function_base) {
+  log_.push_back(FunctionBaseAdded{.function_base = function_base});
+}
+
+void PackageTransaction::RecordFunctionBaseRemoved(
+    std::unique_ptr<FunctionBase> function_base, int64_t index) {
+  log_.push_back(FunctionBaseRemoved{.function_base = std::move(function_base),
+                                     .index = index});
+}
+
+void PackageTransaction::RecordTopChanged() {
+  log_.push_back(TopChanged{.old_top = package_->GetTop()});
+}
+
+void PackageTransaction::RecordUnsupportedMutation(std::string_view what) {
+  if (!unsupported_mutation_.has_value()) {
+    unsupported_mutation_ = std::string(what);
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,185 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_PACKAGE_TRANSACTION_H_
+#define XLS_IR_PACKAGE_TRANSACTION_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+
+// Records the mutations made to a package so that they can be undone. This
+// allows speculative transformations (e.g., in the IR minimizer) to be tried
+// and rolled back at a cost proportional to the number of changes rather than
+// cloning the entire package up front.
+//
+// Example:
+//
+//   XLS_ASSIGN_OR_RETURN(std::unique_ptr<PackageTransaction> txn,
+//                        PackageTransaction::Begin(package));
+//   XLS_RETURN_IF_ERROR(RunSomeTransform(package));
+//   if (!IsAcceptable(package)) {
+//     XLS_RETURN_IF_ERROR(txn->Rollback());
+//   } else {
+//     txn->Commit();
+//   }
+//
+// The following mutations are recorded: adding and removing nodes of functions
+// and procs, operand replacement, node name and location changes, setting a
+// function's return value, reordering parameters, adding and removing
+// functions, procs and blocks, and setting the top entity. Other mutations
+// (e.g., of proc state elements, channels or the nodes of blocks) make the
+// transaction impossible to roll back; see CanRollback. Changes to attributes
+// of individual nodes other than their names and locations (e.g.,
+// ArrayIndex::SetAssumedInBounds) are not recorded.
+//
+// Rollback restores the structure of the package. Node ids and the names
+// reserved by the node name uniquer are not reclaimed so nodes created after a
+// rollback may be given different ids or names than they otherwise would.
+//
+// Nodes and function bases removed while the transaction is active are kept
+// alive until the transaction ends so pointers to them remain valid. At most
+// one transaction may be active on a package at a time and the transaction
+// must not outlive the package.
+class PackageTransaction {
+ public:
+  // Starts recording the mutations of `package`.
+  static absl::StatusOr<std::unique_ptr<PackageTransaction>> Begin(
+      Package* package);
+
+  // Rolls back the transaction if it has not been committed or rolled back.
+  ~PackageTransaction();
+
+  PackageTransaction(const PackageTransaction&) = delete;
+  PackageTransaction& operator=(const PackageTransaction&) = delete;
+
+  // Keeps all mutations made during the transaction and stops recording.
+  void Commit();
+
+  // Undoes all mutations made during the transaction, in reverse order, and
+  // stops recording. Returns an error and leaves the package unchanged if the
+  // transaction cannot be rolled back.
+  absl::Status Rollback();
+
+  // Returns whether the transaction is still recording mutations.
+  bool active() const { return package_->transaction() == this; }
+
+  // Returns whether all mutations made so far can be undone.
+  bool CanRollback() const { return !unsupported_mutation_.has_value(); }
+
+  // Returns the number of mutations recorded so far.
+  int64_t mutation_count() const { return log_.size(); }
+
+  // Hooks called by the IR before (or, for additions, after) each mutation.
+  void RecordNodeAdded(Node* node);
+  // `next_node` is the node which followed `node` in the node list (nullptr if
+  // none) and `list_index` is the position of `node` in the params or next
+  // values of the function base, if applicable.
+  void RecordNodeRemoved(FunctionBase* function_base,
+                         std::unique_ptr<Node> node, Node* next_node,
+                         std::optional<int64_t> list_index);
+  void RecordOperandsChanged(Node* node);
+  void RecordNameChanged(Node* node);
+  void RecordLocChanged(Node* node);
+  void RecordReturnValueChanged(Function* function);
+  void RecordParamMoved(Param* param, int64_t old_index);
+  void RecordFunctionBaseAdded(FunctionBase* function_base);
+  void RecordFunctionBaseRemoved(std::unique_ptr<FunctionBase> function_base,
+                                 int64_t index);
+  void RecordTopChanged();
+  // Notes a mutation which cannot be undone. `what` describes the mutation
+  // for the error returned by Rollback.
+  void RecordUnsupportedMutation(std::string_view what);
+
+ private:
+  explicit PackageTransaction(Package* package) : package_(package) {}
+
+  struct NodeAdded {
+    Node* node;
+  };
+  struct NodeRemoved {
+    FunctionBase* function_base;
+    std::unique_ptr<Node> node;
+    // The node following the removed node in the node list, or nullptr if it
+    // was the last node.
+    Node* next_node;
+    // Position of the node in the params or next values list, if applicable.
+    std::optional<int64_t> list_index;
+  };
+  struct OperandsChanged {
+    Node* node;
+    std::vector<Node*> old_operands;
+  };
+  struct NameChanged {
+    Node* node;
+    // Id of the old name in the NameTable of the package.
+    int32_t old_name_id;
+  };
+  struct LocChanged {
+    Node* node;
+    SourceInfo old_loc;
+  };
+  struct ReturnValueChanged {
+    Function* function;
+    Node* old_return_value;
+  };
+  struct ParamMoved {
+    Param* param;
+    int64_t old_index;
+  };
+  struct FunctionBaseAdded {
+    FunctionBase* function_base;
+  };
+  struct FunctionBaseRemoved {
+    std::unique_ptr<FunctionBase> function_base;
+    int64_t index;
+  };
+  struct TopChanged {
+    std::optional<FunctionBase*> old_top;
+  };
+  using Mutation =
+      std::variant<NodeAdded, NodeRemoved, OperandsChanged, NameChanged,
+                   LocChanged, ReturnValueChanged, ParamMoved,
+                   FunctionBaseAdded, FunctionBaseRemoved, TopChanged>;
+
+  absl::Status Undo(Mutation& mutation);
+
+  Package* package_;
+  std::vector<Mutation> log_;
+  std::optional<std::string> unsupported_mutation_;
+  // Function bases removed by undoing their addition. Nodes may be added to a
+  // function base before the function base is added to the package, so these
+  // are kept alive until the rollback completes as the entries for those nodes
+  // are undone afterwards.
+  std::vector<std::unique_ptr<FunctionBase>> graveyard_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_PACKAGE_TRANSACTION_H_
@@ -0,0 +1,170 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/package_transaction.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class PackageTransactionTest : public IrTestBase {};
+
+TEST_F(PackageTransactionTest, RollbackRestoresNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y, SourceInfo(), "sum");
+  BValue neg = fb.Negate(add);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(neg));
+  XLS_ASSERT_OK(p->SetTop(f));
+  std::string original = p->DumpIr();
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PackageTransaction> txn,
+                           PackageTransaction::Begin(p.get()));
+  EXPECT_TRUE(txn->active());
+
+  // Replace the add with a subtract, drop the negate and rename and reorder
+  // what remains.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub,
+      f->MakeNode<BinOp>(SourceInfo(), x.node(), y.node(), Op::kSub));
+  XLS_ASSERT_OK(add.node()->ReplaceUsesWith(sub));
+  XLS_ASSERT_OK(f->set_return_value(sub));
+  XLS_ASSERT_OK(f->RemoveNode(neg.node()));
+  XLS_ASSERT_OK(f->RemoveNode(add.node()));
+  sub->SetName("difference");
+  XLS_ASSERT_OK(f->MoveParamToIndex(y.node()->As<Param>(), 0));
+
+  // Add a new function and make it top.
+  FunctionBuilder other_fb("other", p.get());
+  other_fb.Literal(UBits(42, 8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * other, other_fb.Build());
+  XLS_ASSERT_OK(p->SetTop(other));
+  EXPECT_NE(p->DumpIr(), original);
+  EXPECT_TRUE(txn->CanRollback());
+  EXPECT_GT(txn->mutation_count(), 0);
+
+  XLS_ASSERT_OK(txn->Rollback());
+  EXPECT_FALSE(txn->active());
+  EXPECT_EQ(p->DumpIr(), original);
+  EXPECT_EQ(f->return_value(), neg.node());
+  EXPECT_EQ(neg.node()->operand(0), add.node());
+  EXPECT_EQ(p->GetTop(), f);
+  XLS_EXPECT_OK(VerifyPackage(p.get()));
+}
+
+TEST_F(PackageTransactionTest, RollbackRestoresRemovedFunction) {
+  auto p = CreatePackage();
+  FunctionBuilder callee_fb("callee", p.get());
+  callee_fb.Param("a", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * callee, callee_fb.Build());
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(1, 8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK(p->SetTop(f));
+  std::string original = p->DumpIr();
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PackageTransaction> txn,
+                           PackageTransaction::Begin(p.get()));
+  XLS_ASSERT_OK(p->RemoveFunction(callee));
+  EXPECT_EQ(p->functions().size(), 1);
+  XLS_ASSERT_OK(txn->Rollback());
+
+  EXPECT_EQ(p->DumpIr(), original);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * restored, p->GetFunction("callee"));
+  EXPECT_EQ(restored, callee);
+}
+
+TEST_F(PackageTransactionTest, CommitKeepsChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(fb.Not(x)));
+
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PackageTransaction> txn,
+                             PackageTransaction::Begin(p.get()));
+    XLS_ASSERT_OK(f->set_return_value(x.node()));
+    txn->Commit();
+    EXPECT_FALSE(txn->active());
+    EXPECT_EQ(p->transaction(), nullptr);
+  }
+  EXPECT_EQ(f->return_value(), x.node());
+}
+
+TEST_F(PackageTransactionTest, DestructorRollsBack) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue not_x = fb.Not(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(not_x));
+
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PackageTransaction> txn,
+                             PackageTransaction::Begin(p.get()));
+    XLS_ASSERT_OK(f->set_return_value(x.node()));
+  }
+  EXPECT_EQ(p->transaction(), nullptr);
+  EXPECT_EQ(f->return_value(), not_x.node());
+}
+
+TEST_F(PackageTransactionTest, OneTransactionAtATime) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PackageTransaction> txn,
+                           PackageTransaction::Begin(p.get()));
+  EXPECT_THAT(PackageTransaction::Begin(p.get()),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(PackageTransactionTest, UnsupportedMutationPreventsRollback) {
+  auto p = CreatePackage();
+  ProcBuilder pb(TestName(), p.get());
+  BValue st = pb.StateElement("st", Value(UBits(0, 32)));
+  pb.Next(st, st);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PackageTransaction> txn,
+                           PackageTransaction::Begin(p.get()));
+  XLS_ASSERT_OK(proc->AppendStateElement("extra", Value(UBits(0, 8))).status());
+  EXPECT_FALSE(txn->CanRollback());
+  EXPECT_THAT(txn->Rollback(), StatusIs(absl::StatusCode::kFailedPrecondition,
+                                        HasSubstr("state element")));
+  EXPECT_EQ(proc->GetStateElementCount(), 2);
+}
+
+}  // namespace
+}  // namespace xls
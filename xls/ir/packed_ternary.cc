@@ -0,0 +1,188 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/packed_ternary.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+namespace {
+
+// Returns the word-wise combination of `lhs` and `rhs`. `f` is called with the
+// known and value words of each operand and returns the known and value words
+// of the result.
+template <typename F>
+PackedTernaryVector CombineWords(const PackedTernaryVector& lhs,
+                                 const PackedTernaryVector& rhs, F f) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  InlineBitmap known(lhs.bit_count());
+  InlineBitmap value(lhs.bit_count());
+  for (int64_t i = 0; i < lhs.word_count(); ++i) {
+    auto [known_word, value_word] =
+        f(lhs.known().GetWord(i), lhs.value().GetWord(i),
+          rhs.known().GetWord(i), rhs.value().GetWord(i));
+    known.SetWord(i, known_word);
+    value.SetWord(i, value_word & known_word);
+  }
+  return PackedTernaryVector(std::move(known), std::move(value));
+}
+
+template <typename F>
+PackedTernaryVector Fold(absl::Span<const PackedTernaryVector> operands, F f) {
+  CHECK(!operands.empty());
+  PackedTernaryVector result = operands.front();
+  for (const PackedTernaryVector& operand : operands.subspan(1)) {
+    result = f(result, operand);
+  }
+  return result;
+}
+
+// Adds `a`, `b` and the carry-in `carry` (0 or 1), updating `carry` with the
+// carry out.
+uint64_t AddWithCarry(uint64_t a, uint64_t b, uint64_t& carry) {
+  uint64_t sum = a + b;
+  uint64_t carry_out = sum < a ? 1 : 0;
+  uint64_t result = sum + carry;
+  carry = carry_out | (result < sum ? 1 : 0);
+  return result;
+}
+
+}  // namespace
+
+PackedTernaryVector::PackedTernaryVector(InlineBitmap known,
+                                         InlineBitmap value)
+    : known_(std::move(known)), value_(std::move(value)) {
+  CHECK_EQ(known_.bit_count(), value_.bit_count());
+  value_.Intersect(known_);
+}
+
+PackedTernaryVector PackedTernaryVector::FromTernary(TernarySpan ternary) {
+  PackedTernaryVector result(ternary.size());
+  for (int64_t i = 0; i < ternary.size(); ++i) {
+    if (ternary[i] != TernaryValue::kUnknown) {
+      result.Set(i, ternary[i]);
+    }
+  }
+  return result;
+}
+
+TernaryVector PackedTernaryVector::ToTernaryVector() const {
+  TernaryVector result(bit_count(), TernaryValue::kUnknown);
+  for (int64_t w = 0; w < word_count(); ++w) {
+    uint64_t known_word = known_.GetWord(w);
+    if (known_word == 0) {
+      continue;
+    }
+    uint64_t value_word = value_.GetWord(w);
+    int64_t limit = std::min<int64_t>(64, bit_count() - w * 64);
+    for (int64_t b = 0; b < limit; ++b) {
+      if ((known_word >> b) & 1) {
+        result[w * 64 + b] = ((value_word >> b) & 1) ? TernaryValue::kKnownOne
+                                                     : TernaryValue::kKnownZero;
+      }
+    }
+  }
+  return result;
+}
+
+namespace ternary_ops {
+
+PackedTernaryVector Not(const PackedTernaryVector& x) {
+  InlineBitmap value(x.bit_count());
+  for (int64_t i = 0; i < x.word_count(); ++i) {
+    value.SetWord(i, ~x.value().GetWord(i) & x.known().GetWord(i));
+  }
+  return PackedTernaryVector(x.known(), std::move(value));
+}
+
+PackedTernaryVector And(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs) {
+  return CombineWords(lhs, rhs,
+                      [](uint64_t lk, uint64_t lv, uint64_t rk, uint64_t rv) {
+                        // Known zero in either operand forces a known zero.
+                        uint64_t known = (lk & rk) | (lk & ~lv) | (rk & ~rv);
+                        return std::pair(known, lv & rv);
+                      });
+}
+
+PackedTernaryVector Or(const PackedTernaryVector& lhs,
+                       const PackedTernaryVector& rhs) {
+  return CombineWords(lhs, rhs,
+                      [](uint64_t lk, uint64_t lv, uint64_t rk, uint64_t rv) {
+                        // Known one in either operand forces a known one.
+                        uint64_t known = (lk & rk) | lv | rv;
+                        return std::pair(known, lv | rv);
+                      });
+}
+
+PackedTernaryVector Xor(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs) {
+  return CombineWords(
+      lhs, rhs, [](uint64_t lk, uint64_t lv, uint64_t rk, uint64_t rv) {
+        return std::pair(lk & rk, lv ^ rv);
+      });
+}
+
+PackedTernaryVector And(absl::Span<const PackedTernaryVector> operands) {
+  return Fold(operands, [](const PackedTernaryVector& a,
+                           const PackedTernaryVector& b) { return And(a, b); });
+}
+
+PackedTernaryVector Or(absl::Span<const PackedTernaryVector> operands) {
+  return Fold(operands, [](const PackedTernaryVector& a,
+                           const PackedTernaryVector& b) { return Or(a, b); });
+}
+
+PackedTernaryVector Xor(absl::Span<const PackedTernaryVector> operands) {
+  return Fold(operands, [](const PackedTernaryVector& a,
+                           const PackedTernaryVector& b) { return Xor(a, b); });
+}
+
+PackedTernaryVector Add(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  // The smallest possible sum sets every unknown bit to zero and the largest
+  // sets every unknown bit to one. Since sum = lhs ^ rhs ^ carry_in, comparing
+  // these sums against the operands gives the carry into each bit in the two
+  // extreme cases. Carries are monotonic in the operands, so a carry which is
+  // one in the smallest sum or zero in the largest sum is known.
+  InlineBitmap known(lhs.bit_count());
+  InlineBitmap value(lhs.bit_count());
+  uint64_t min_carry = 0;
+  uint64_t max_carry = 0;
+  for (int64_t i = 0; i < lhs.word_count(); ++i) {
+    uint64_t lk = lhs.known().GetWord(i);
+    uint64_t lv = lhs.value().GetWord(i);
+    uint64_t rk = rhs.known().GetWord(i);
+    uint64_t rv = rhs.value().GetWord(i);
+    uint64_t min_sum = AddWithCarry(lv, rv, min_carry);
+    uint64_t max_sum = AddWithCarry(lv | ~lk, rv | ~rk, max_carry);
+    uint64_t carry_known_one = min_sum ^ lv ^ rv;
+    uint64_t carry_known_zero = ~(max_sum ^ (lv | ~lk) ^ (rv | ~rk));
+    uint64_t known_word = lk & rk & (carry_known_one | carry_known_zero);
+    known.SetWord(i, known_word);
+    value.SetWord(i, min_sum & known_word);
+  }
+  return PackedTernaryVector(std::move(known), std::move(value));
+}
+
+}  // namespace ternary_ops
+}  // namespace xls
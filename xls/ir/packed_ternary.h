@@ -0,0 +1,108 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_PACKED_TERNARY_H_
+#define XLS_IR_PACKED_TERNARY_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+
+// A bit-packed vector of ternary values, stored as two bitmaps: `known` has a
+// 1 for each bit whose value is known, and `value` holds the value of each
+// known bit. Unknown bits always have a 0 in `value`.
+//
+// This uses 2 bits of storage per ternary value instead of the byte used by
+// TernaryVector, and lets the transfer functions in this file operate on 64
+// bits at a time. A TernaryVector can be converted to and from this form, so
+// code that uses the TernaryVector API can use this as the backing store for
+// wide operations.
+class PackedTernaryVector {
+ public:
+  // Creates a vector of `bit_count` unknown bits.
+  explicit PackedTernaryVector(int64_t bit_count)
+      : known_(bit_count), value_(bit_count) {}
+
+  // Creates a vector from a known-bits mask and the values of the known bits.
+  // Bits of `value` which are not set in `known` are ignored.
+  PackedTernaryVector(InlineBitmap known, InlineBitmap value);
+
+  static PackedTernaryVector FromTernary(TernarySpan ternary);
+
+  int64_t bit_count() const { return known_.bit_count(); }
+  int64_t word_count() const { return known_.word_count(); }
+  const InlineBitmap& known() const { return known_; }
+  const InlineBitmap& value() const { return value_; }
+
+  TernaryValue Get(int64_t index) const {
+    if (!known_.Get(index)) {
+      return TernaryValue::kUnknown;
+    }
+    return value_.Get(index) ? TernaryValue::kKnownOne
+                             : TernaryValue::kKnownZero;
+  }
+  void Set(int64_t index, TernaryValue value) {
+    known_.Set(index, value != TernaryValue::kUnknown);
+    value_.Set(index, value == TernaryValue::kKnownOne);
+  }
+
+  bool IsFullyKnown() const { return known_.IsAllOnes(); }
+
+  TernaryVector ToTernaryVector() const;
+  std::string ToString() const { return xls::ToString(ToTernaryVector()); }
+
+  bool operator==(const PackedTernaryVector& other) const {
+    return known_ == other.known_ && value_ == other.value_;
+  }
+  bool operator!=(const PackedTernaryVector& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  InlineBitmap known_;
+  InlineBitmap value_;
+};
+
+namespace ternary_ops {
+
+// Word-parallel ternary operations. All operands must have the same bit count.
+PackedTernaryVector Not(const PackedTernaryVector& x);
+PackedTernaryVector And(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs);
+PackedTernaryVector Or(const PackedTernaryVector& lhs,
+                       const PackedTernaryVector& rhs);
+PackedTernaryVector Xor(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs);
+
+// N-ary forms of the above. `operands` must be non-empty.
+PackedTernaryVector And(absl::Span<const PackedTernaryVector> operands);
+PackedTernaryVector Or(absl::Span<const PackedTernaryVector> operands);
+PackedTernaryVector Xor(absl::Span<const PackedTernaryVector> operands);
+
+// Returns the ternary sum of `lhs` and `rhs` (modulo 2^bit_count). A bit of
+// the result is known exactly when every assignment of the unknown operand
+// bits yields the same value for it. This is computed by propagating carries
+// across whole words for the smallest and largest possible sums.
+PackedTernaryVector Add(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs);
+
+}  // namespace ternary_ops
+}  // namespace xls
+
+#endif  // XLS_IR_PACKED_TERNARY_H_
@@ -0,0 +1,173 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/packed_ternary.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+namespace {
+
+// Returns every ternary vector of the given width.
+std::vector<TernaryVector> AllTernaryVectors(int64_t width) {
+  std::vector<TernaryVector> result = {TernaryVector()};
+  for (int64_t i = 0; i < width; ++i) {
+    std::vector<TernaryVector> next;
+    for (const TernaryVector& v : result) {
+      for (TernaryValue t : {TernaryValue::kKnownZero, TernaryValue::kKnownOne,
+                             TernaryValue::kUnknown}) {
+        TernaryVector extended = v;
+        extended.push_back(t);
+        next.push_back(extended);
+      }
+    }
+    result = std::move(next);
+  }
+  return result;
+}
+
+TernaryVector Parse(std::string_view s) {
+  return StringToTernaryVector(s).value();
+}
+
+// Returns the most precise ternary sum of `a` and `b` by enumerating every
+// possible value of each operand.
+TernaryVector ExhaustiveAdd(TernarySpan a, TernarySpan b) {
+  std::optional<TernaryVector> result;
+  for (const Bits& x : ternary_ops::AllBitsValues(a)) {
+    for (const Bits& y : ternary_ops::AllBitsValues(b)) {
+      Bits sum = bits_ops::Add(x, y);
+      if (result.has_value()) {
+        ternary_ops::UpdateWithIntersection(*result, sum);
+      } else {
+        result = ternary_ops::BitsToTernary(sum);
+      }
+    }
+  }
+  return *result;
+}
+
+TEST(PackedTernaryTest, RoundTrip) {
+  for (int64_t width : {0, 1, 5, 63, 64, 65, 130}) {
+    TernaryVector v(width);
+    for (int64_t i = 0; i < width; ++i) {
+      v[i] = static_cast<TernaryValue>(i % 3);
+    }
+    PackedTernaryVector packed = PackedTernaryVector::FromTernary(v);
+    EXPECT_EQ(packed.bit_count(), width);
+    EXPECT_EQ(packed.ToTernaryVector(), v);
+    for (int64_t i = 0; i < width; ++i) {
+      EXPECT_EQ(packed.Get(i), v[i]);
+    }
+  }
+}
+
+TEST(PackedTernaryTest, ValueIsMaskedByKnown) {
+  PackedTernaryVector v(InlineBitmap::FromWord(0b0011, 4),
+                        InlineBitmap::FromWord(0b1110, 4));
+  EXPECT_EQ(v.ToString(), "0bXX10");
+  EXPECT_EQ(v, PackedTernaryVector::FromTernary(Parse("0bXX10")));
+}
+
+TEST(PackedTernaryTest, BitwiseOpsMatchPerBitOps) {
+  for (const TernaryVector& a : AllTernaryVectors(3)) {
+    for (const TernaryVector& b : AllTernaryVectors(3)) {
+      PackedTernaryVector pa = PackedTernaryVector::FromTernary(a);
+      PackedTernaryVector pb = PackedTernaryVector::FromTernary(b);
+      TernaryVector expected_and(3);
+      TernaryVector expected_or(3);
+      TernaryVector expected_xor(3);
+      TernaryVector expected_not(3);
+      for (int64_t i = 0; i < 3; ++i) {
+        expected_and[i] = ternary_ops::And(a[i], b[i]);
+        expected_or[i] = ternary_ops::Or(a[i], b[i]);
+        expected_xor[i] = (a[i] == TernaryValue::kUnknown ||
+                           b[i] == TernaryValue::kUnknown)
+                              ? TernaryValue::kUnknown
+                              : static_cast<TernaryValue>(a[i] != b[i]);
+        expected_not[i] = a[i] == TernaryValue::kUnknown
+                              ? TernaryValue::kUnknown
+                              : static_cast<TernaryValue>(
+                                    a[i] == TernaryValue::kKnownZero);
+      }
+      EXPECT_EQ(ternary_ops::And(pa, pb).ToTernaryVector(), expected_and);
+      EXPECT_EQ(ternary_ops::Or(pa, pb).ToTernaryVector(), expected_or);
+      EXPECT_EQ(ternary_ops::Xor(pa, pb).ToTernaryVector(), expected_xor);
+      EXPECT_EQ(ternary_ops::Not(pa).ToTernaryVector(), expected_not);
+    }
+  }
+}
+
+TEST(PackedTernaryTest, NaryOps) {
+  std::vector<PackedTernaryVector> operands = {
+      PackedTernaryVector::FromTernary(Parse("0b111XXX000")),
+      PackedTernaryVector::FromTernary(Parse("0b0X10X10X1")),
+      PackedTernaryVector::FromTernary(Parse("0b010001010"))};
+  EXPECT_EQ(ternary_ops::And(operands).ToString(), "0b0_X000_X000");
+  EXPECT_EQ(ternary_ops::Or(operands).ToString(), "0b1_11XX_1011");
+  EXPECT_EQ(ternary_ops::Xor(operands).ToString(), "0b1_X0XX_X0X1");
+}
+
+TEST(PackedTernaryTest, AddIsExact) {
+  for (const TernaryVector& a : AllTernaryVectors(4)) {
+    for (const TernaryVector& b : AllTernaryVectors(4)) {
+      EXPECT_EQ(ternary_ops::Add(PackedTernaryVector::FromTernary(a),
+                                 PackedTernaryVector::FromTernary(b))
+                    .ToTernaryVector(),
+                ExhaustiveAdd(a, b))
+          << ToString(a) << " + " << ToString(b);
+    }
+  }
+}
+
+TEST(PackedTernaryTest, AddCarriesAcrossWords) {
+  // All ones in the low 64 bits plus one carries into bit 64.
+  TernaryVector all_ones(130, TernaryValue::kKnownOne);
+  TernaryVector one(130, TernaryValue::kKnownZero);
+  one[0] = TernaryValue::kKnownOne;
+  for (int64_t i = 64; i < 130; ++i) {
+    all_ones[i] = TernaryValue::kKnownZero;
+  }
+  TernaryVector expected(130, TernaryValue::kKnownZero);
+  expected[64] = TernaryValue::kKnownOne;
+  EXPECT_EQ(ternary_ops::Add(PackedTernaryVector::FromTernary(all_ones),
+                             PackedTernaryVector::FromTernary(one))
+                .ToTernaryVector(),
+            expected);
+
+  // An unknown low bit makes the whole carry chain unknown, but bits above the
+  // chain stay known.
+  one[0] = TernaryValue::kUnknown;
+  expected = TernaryVector(130, TernaryValue::kUnknown);
+  for (int64_t i = 65; i < 130; ++i) {
+    expected[i] = TernaryValue::kKnownZero;
+  }
+  EXPECT_EQ(ternary_ops::Add(PackedTernaryVector::FromTernary(all_ones),
+                             PackedTernaryVector::FromTernary(one))
+                .ToTernaryVector(),
+            expected);
+}
+
+}  // namespace
+}  // namespace xls
@@ -44,6 +44,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/package_transaction.h"
 #include "xls/ir/proc_instantiation.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/state_element.h"
@@ -53,6 +54,19 @@
 #include "xls/ir/value_utils.h"
 
 namespace xls {
+namespace {
+
+// Notes a mutation of `proc` which cannot be rolled back by an active
+// PackageTransaction. Also counts as a modification of the proc as these
+// mutations need not change the graph.
+void RecordUnsupportedMutation(Proc* proc, std::string_view what) {
+  if (proc->package()->transaction() != nullptr) {
+    proc->package()->transaction()->RecordUnsupportedMutation(what);
+  }
+  proc->IncrementModificationCount();
+}
+
+}  // namespace
 
 std::string Proc::DumpIr() const {
   std::string res = absl::StrFormat("proc %s", name());
@@ -163,6 +177,7 @@ absl::btree_set<int64_t> Proc::GetNextStateIndices(Node* node) const {
 }
 
 absl::Status Proc::SetNextStateElement(int64_t index, Node* next) {
+  RecordUnsupportedMutation(this, "setting the next state of a proc");
   if (next->GetType() != GetStateElementType(index)) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Cannot set next state element %d to \"%s\"; type %s does not match "
@@ -250,6 +265,7 @@ absl::Status Proc::ReplaceState(
 absl::StatusOr<StateRead*> Proc::ReplaceStateElement(
     int64_t index, std::string_view requested_state_name,
     const Value& init_value, std::optional<Node*> next_state) {
+  RecordUnsupportedMutation(this, "replacing a proc state element");
   XLS_RET_CHECK_LT(index, GetStateElementCount());
 
   // Check that it's safe to remove the current state read node.
@@ -309,6 +325,7 @@ absl::StatusOr<StateRead*> Proc::ReplaceStateElement(
 }
 
 absl::Status Proc::RemoveStateElement(int64_t index) {
+  RecordUnsupportedMutation(this, "removing a proc state element");
   XLS_RET_CHECK_LT(index, GetStateElementCount());
   for (auto& [_, state_element] : state_elements_) {
     CHECK(absl::c_contains(state_vec_, state_element.get()));
@@ -361,6 +378,7 @@ absl::StatusOr<StateRead*> Proc::InsertStateElement(
     int64_t index, std::string_view requested_state_name,
     const Value& init_value, std::optional<Node*> read_predicate,
     std::optional<Node*> next_state) {
+  RecordUnsupportedMutation(this, "inserting a proc state element");
   XLS_RET_CHECK_LE(index, GetStateElementCount());
   const bool is_append = (index == GetStateElementCount());
   std::string state_name = UniquifyStateName(requested_state_name);
@@ -670,6 +688,7 @@ absl::StatusOr<Type*> Proc::GetChannelReferenceType(
 
 absl::StatusOr<ChannelReferences> Proc::AddChannel(
     std::unique_ptr<Channel> channel) {
+  RecordUnsupportedMutation(this, "adding a proc-scoped channel");
   XLS_RET_CHECK(is_new_style_proc());
   std::string channel_name{channel->name()};
   auto [channel_it, inserted] =
@@ -760,6 +779,7 @@ absl::StatusOr<SendChannelReference*> Proc::AddOutputChannelReference(
 
 absl::StatusOr<ChannelReference*> Proc::AddInterfaceChannelReference(
     std::unique_ptr<ChannelReference> channel_ref) {
+  RecordUnsupportedMutation(this, "adding a proc interface channel");
   XLS_RET_CHECK(is_new_style_proc());
   if (channels_.contains(channel_ref->name())) {
     return absl::InvalidArgumentError(
@@ -807,6 +827,7 @@ absl::StatusOr<ChannelReference*> Proc::AddInterfaceChannel(
 }
 
 absl::Status Proc::RemoveInterfaceChannel(ChannelReference* channel_ref) {
+  RecordUnsupportedMutation(this, "removing a proc interface channel");
   auto interface_it =
       std::find(interface_.begin(), interface_.end(), channel_ref);
   if (interface_it == interface_.end()) {
@@ -826,6 +847,7 @@ absl::Status Proc::RemoveInterfaceChannel(ChannelReference* channel_ref) {
 absl::StatusOr<ProcInstantiation*> Proc::AddProcInstantiation(
     std::string_view name, absl::Span<ChannelReference* const> channel_args,
     Proc* proc) {
+  RecordUnsupportedMutation(this, "adding a proc instantiation");
   XLS_RET_CHECK(is_new_style_proc());
   proc_instantiations_.push_back(
       std::make_unique<ProcInstantiation>(name, channel_args, proc));
@@ -888,6 +910,7 @@ absl::StatusOr<ProcInstantiation*> Proc::GetProcInstantiation(
 }
 
 absl::Status Proc::ConvertToNewStyle() {
+  RecordUnsupportedMutation(this, "converting a proc to a new-style proc");
   if (is_new_style_proc()) {
     return absl::InternalError("Proc is already new style.");
   }
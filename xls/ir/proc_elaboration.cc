@@ -25,6 +25,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -47,22 +48,57 @@
 namespace xls {
 namespace {
 
+using ChannelRefTables =
+    absl::flat_hash_map<Proc*, std::shared_ptr<const ChannelRefTable>>;
+
+// Adds `channel_ref` with the given name to the end of the numbering in
+// `table`.
+void AddToChannelRefTable(ChannelRef channel_ref, std::string_view name,
+                          ChannelRefTable& table) {
+  int64_t index = table.indices.size();
+  table.indices.emplace(channel_ref, index);
+  table.indices_by_name.emplace(name, index);
+}
+
+// Returns the numbering of the channel references of the new-style proc
+// `proc`, creating it if it is not already in `tables`.
+std::shared_ptr<const ChannelRefTable> GetChannelRefTable(
+    Proc* proc, ChannelRefTables& tables) {
+  std::shared_ptr<const ChannelRefTable>& table = tables[proc];
+  if (table == nullptr) {
+    auto new_table = std::make_shared<ChannelRefTable>();
+    for (const std::unique_ptr<ChannelReference>& channel_reference :
+         proc->channel_references()) {
+      AddToChannelRefTable(channel_reference.get(), channel_reference->name(),
+                           *new_table);
+    }
+    table = std::move(new_table);
+  }
+  return table;
+}
+
 absl::StatusOr<std::unique_ptr<ProcInstance>> CreateNewStyleProcInstance(
     Proc* proc, std::optional<ProcInstantiation*> proc_instantiation,
     const ProcInstantiationPath& path,
-    absl::Span<const ChannelBinding> interface_bindings) {
+    absl::Span<const ChannelBinding> interface_bindings,
+    ChannelRefTables& channel_ref_tables) {
   XLS_RET_CHECK(proc->is_new_style_proc());
 
-  // Map from channel reference name to ChannelInstance.
-  absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings;
+  std::shared_ptr<const ChannelRefTable> channel_ref_table =
+      GetChannelRefTable(proc, channel_ref_tables);
+  std::vector<ChannelBinding> channel_bindings(
+      channel_ref_table->indices.size());
+  auto binding = [&](ChannelRef channel_ref) -> ChannelBinding& {
+    return channel_bindings[channel_ref_table->indices.at(channel_ref)];
+  };
   XLS_RET_CHECK_EQ(interface_bindings.size(), proc->interface().size());
   for (int64_t i = 0; i < interface_bindings.size(); ++i) {
-    channel_bindings[proc->interface()[i]] = interface_bindings[i];
+    binding(proc->interface()[i]) = interface_bindings[i];
   }
   std::vector<std::unique_ptr<ChannelInstance>> declared_channels;
   for (Channel* channel : proc->channels()) {
-    declared_channels.push_back(std::make_unique<ChannelInstance>(
-        ChannelInstance{.channel = channel, .path = path}));
+    declared_channels.push_back(
+        std::make_unique<ChannelInstance>(ChannelInstance{.channel = channel}));
     ChannelInstance* channel_instance = declared_channels.back().get();
     XLS_ASSIGN_OR_RETURN(ChannelReference * send_reference,
                          proc->GetSendChannelReference(channel->name()));
@@ -70,9 +106,9 @@ absl::StatusOr<std::unique_ptr<ProcInstance>> CreateNewStyleProcInstance(
                          proc->GetReceiveChannelReference(channel->name()));
     // Channel bindings for channels declared in this proc do not themselves
     // bind to another reference, so the parent reference field is empty.
-    channel_bindings[send_reference] = ChannelBinding{
-        .instance = channel_instance, .parent_reference = std::nullopt};
-    channel_bindings[receive_reference] = ChannelBinding{
+    binding(send_reference) = ChannelBinding{.instance = channel_instance,
+                                             .parent_reference = std::nullopt};
+    binding(receive_reference) = ChannelBinding{
         .instance = channel_instance, .parent_reference = std::nullopt};
   }
 
@@ -97,60 +133,83 @@ absl::StatusOr<std::unique_ptr<ProcInstance>> CreateNewStyleProcInstance(
     std::vector<ChannelBinding> subproc_interface_bindings;
     for (ChannelReference* channel_ref : instantiation->channel_args()) {
       subproc_interface_bindings.push_back(
-          ChannelBinding{.instance = channel_bindings.at(channel_ref).instance,
+          ChannelBinding{.instance = binding(channel_ref).instance,
                          .parent_reference = channel_ref});
     }
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcInstance> instantiation_instance,
-                         CreateNewStyleProcInstance(
-                             instantiation->proc(), instantiation.get(),
-                             instantiation_path, subproc_interface_bindings));
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ProcInstance> instantiation_instance,
+        CreateNewStyleProcInstance(instantiation->proc(), instantiation.get(),
+                                   instantiation_path,
+                                   subproc_interface_bindings,
+                                   channel_ref_tables));
     instantiated_procs.push_back(std::move(instantiation_instance));
   }
 
   return std::make_unique<ProcInstance>(
-      proc, proc_instantiation, path, std::move(declared_channels),
-      std::move(instantiated_procs), std::move(channel_bindings));
+      proc, proc_instantiation, std::move(declared_channels),
+      std::move(instantiated_procs), std::move(channel_ref_table),
+      std::move(channel_bindings));
 }
 
 }  // namespace
 
+std::optional<ProcInstantiationPath> ChannelInstance::path() const {
+  if (proc_instance == nullptr) {
+    return std::nullopt;
+  }
+  return proc_instance->path();
+}
+
 std::string ChannelInstance::ToString() const {
-  if (path.has_value()) {
-    return absl::StrFormat("%s [%s]", channel->name(), path->ToString());
+  std::optional<ProcInstantiationPath> instance_path = path();
+  if (instance_path.has_value()) {
+    return absl::StrFormat("%s [%s]", channel->name(),
+                           instance_path->ToString());
   }
   return std::string{channel->name()};
 }
 
 ProcInstance::ProcInstance(
     Proc* proc, std::optional<ProcInstantiation*> proc_instantiation,
-    std::optional<ProcInstantiationPath> path,
     std::vector<std::unique_ptr<ChannelInstance>> channel_instances,
     std::vector<std::unique_ptr<ProcInstance>> instantiated_procs,
-    absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings)
+    std::shared_ptr<const ChannelRefTable> channel_ref_table,
+    std::vector<ChannelBinding> channel_bindings)
     : proc_(proc),
       proc_instantiation_(proc_instantiation),
-      path_(std::move(path)),
       channel_instances_(std::move(channel_instances)),
       instantiated_procs_(std::move(instantiated_procs)),
+      channel_ref_table_(std::move(channel_ref_table)),
       channel_bindings_(std::move(channel_bindings)) {
-  if (proc->is_new_style_proc()) {
-    for (const std::unique_ptr<ChannelReference>& channel_reference :
-         proc->channel_references()) {
-      channel_name_map_[channel_reference->name()] =
-          channel_bindings_.at(channel_reference.get()).instance;
-    }
-  } else {
-    for (Channel* channel : proc->package()->channels()) {
-      channel_name_map_[channel->name()] =
-          channel_bindings_.at(channel).instance;
-    }
+  CHECK_EQ(channel_bindings_.size(), channel_ref_table_->indices.size());
+  for (const std::unique_ptr<ChannelInstance>& channel_instance :
+       channel_instances_) {
+    channel_instance->proc_instance = this;
+  }
+  for (const std::unique_ptr<ProcInstance>& instance : instantiated_procs_) {
+    instance->parent_ = this;
+  }
+}
+
+std::optional<ProcInstantiationPath> ProcInstance::path() const {
+  if (!proc()->is_new_style_proc()) {
+    return std::nullopt;
   }
+  ProcInstantiationPath path;
+  const ProcInstance* instance = this;
+  for (; instance->parent_ != nullptr; instance = instance->parent_) {
+    path.path.push_back(*instance->proc_instantiation());
+  }
+  path.top = instance->proc();
+  std::reverse(path.path.begin(), path.path.end());
+  return path;
 }
 
 absl::StatusOr<ChannelInstance*> ProcInstance::GetChannelInstance(
     std::string_view channel_reference_name) const {
-  if (channel_name_map_.contains(channel_reference_name)) {
-    return channel_name_map_.at(channel_reference_name);
+  auto it = channel_ref_table_->indices_by_name.find(channel_reference_name);
+  if (it != channel_ref_table_->indices_by_name.end()) {
+    return channel_bindings_[it->second].instance;
   }
   return absl::NotFoundError(
       absl::StrFormat("No channel reference named `%s` in proc `%s`",
@@ -158,10 +217,11 @@ absl::StatusOr<ChannelInstance*> ProcInstance::GetChannelInstance(
 }
 
 std::string ProcInstance::GetName() const {
-  if (!path().has_value()) {
+  std::optional<ProcInstantiationPath> instance_path = path();
+  if (!instance_path.has_value()) {
     return proc()->name();
   }
-  return absl::StrFormat("%s [%s]", proc()->name(), path()->ToString());
+  return absl::StrFormat("%s [%s]", proc()->name(), instance_path->ToString());
 }
 
 std::string ProcInstance::ToString(int64_t indent_amount) const {
@@ -202,29 +262,30 @@ std::string ProcInstance::ToString(int64_t indent_amount) const {
 }
 
 absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
-  XLS_RET_CHECK(proc_instance->path().has_value());
+  XLS_RET_CHECK(proc_instance->proc()->is_new_style_proc());
 
+  proc_instance->id_ = proc_instance_ptrs_.size();
   proc_instance_ptrs_.push_back(proc_instance);
   instances_of_proc_[proc_instance->proc()].push_back(proc_instance);
 
-  proc_instances_by_path_[proc_instance->path().value()] = proc_instance;
   for (const std::unique_ptr<ChannelInstance>& channel_instance :
        proc_instance->channels()) {
     instances_of_channel_[channel_instance->channel].push_back(
         channel_instance.get());
+    channel_instance->id = channel_instance_ptrs_.size();
     channel_instance_ptrs_.push_back(channel_instance.get());
   }
 
   for (const std::unique_ptr<ChannelReference>& channel_reference :
        proc_instance->proc()->channel_references()) {
-    XLS_ASSIGN_OR_RETURN(
-        ChannelInstance * channel_instance,
-        proc_instance->GetChannelInstance(channel_reference->name()));
-    channel_instances_by_path_[{std::string{channel_reference->name()},
-                                proc_instance->path().value()}] =
-        channel_instance;
     instances_of_channel_reference_[channel_reference.get()].push_back(
-        channel_instance);
+        proc_instance->GetChannelBinding(channel_reference.get()).instance);
+  }
+
+  absl::Span<const std::unique_ptr<ProcInstantiation>> instantiations =
+      proc_instance->proc()->proc_instantiations();
+  for (int64_t i = 0; i < instantiations.size(); ++i) {
+    instantiation_indices_.emplace(instantiations[i].get(), i);
   }
 
   for (const std::unique_ptr<ProcInstance>& subinstance :
@@ -278,19 +339,20 @@ absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
     ++channel_id;
     elaboration.interface_channel_instances_.push_back(
         std::make_unique<ChannelInstance>(ChannelInstance{
-            .channel = elaboration.interface_channels_.back().get(),
-            .path = std::nullopt}));
+            .channel = elaboration.interface_channels_.back().get()}));
     interface_bindings.push_back(ChannelBinding{
         .instance = elaboration.interface_channel_instances_.back().get(),
         .parent_reference = std::nullopt});
   }
+  ChannelRefTables channel_ref_tables;
   XLS_ASSIGN_OR_RETURN(
       elaboration.top_,
       CreateNewStyleProcInstance(top, /*proc_instantiation=*/std::nullopt, path,
-                                 interface_bindings));
+                                 interface_bindings, channel_ref_tables));
 
   for (const std::unique_ptr<ChannelInstance>& channel_instance :
        elaboration.interface_channel_instances_) {
+    channel_instance->id = elaboration.channel_instance_ptrs_.size();
     elaboration.channel_instance_ptrs_.push_back(channel_instance.get());
   }
   XLS_RETURN_IF_ERROR(elaboration.BuildInstanceMaps(elaboration.top_.get()));
@@ -320,13 +382,27 @@ std::string ProcElaboration::ToString() const {
 
 absl::StatusOr<ProcInstance*> ProcElaboration::GetProcInstance(
     const ProcInstantiationPath& path) const {
-  auto it = proc_instances_by_path_.find(path);
-  if (it == proc_instances_by_path_.end()) {
+  auto not_found = [&]() {
     return absl::NotFoundError(absl::StrFormat(
         "Instantiation path `%s` does not exist in elaboration from proc `%s`",
         path.ToString(), top()->proc()->name()));
+  };
+  if (top_ == nullptr || path.top != top_->proc()) {
+    return not_found();
+  }
+  ProcInstance* instance = top_.get();
+  for (ProcInstantiation* instantiation : path.path) {
+    auto it = instantiation_indices_.find(instantiation);
+    if (it == instantiation_indices_.end() ||
+        it->second >=
+            static_cast<int64_t>(instance->instantiated_procs().size()) ||
+        instance->proc()->proc_instantiations()[it->second].get() !=
+            instantiation) {
+      return not_found();
+    }
+    instance = instance->instantiated_procs()[it->second].get();
   }
-  return it->second;
+  return instance;
 }
 
 absl::StatusOr<ProcInstance*> ProcElaboration::GetProcInstance(
@@ -340,14 +416,18 @@ absl::StatusOr<ProcInstance*> ProcElaboration::GetProcInstance(
 
 absl::StatusOr<ChannelInstance*> ProcElaboration::GetChannelInstance(
     std::string_view channel_name, const ProcInstantiationPath& path) const {
-  auto it = channel_instances_by_path_.find({std::string{channel_name}, path});
-  if (it == channel_instances_by_path_.end()) {
-    return absl::NotFoundError(
-        absl::StrFormat("No channel `%s` at instantiation path `%s` in "
-                        "elaboration from proc `%s`",
-                        channel_name, path.ToString(), top()->proc()->name()));
-  }
-  return it->second;
+  absl::StatusOr<ProcInstance*> proc_instance = GetProcInstance(path);
+  if (proc_instance.ok()) {
+    absl::StatusOr<ChannelInstance*> channel_instance =
+        (*proc_instance)->GetChannelInstance(channel_name);
+    if (channel_instance.ok()) {
+      return channel_instance;
+    }
+  }
+  return absl::NotFoundError(
+      absl::StrFormat("No channel `%s` at instantiation path `%s` in "
+                      "elaboration from proc `%s`",
+                      channel_name, path.ToString(), top()->proc()->name()));
 }
 
 absl::StatusOr<ChannelInstance*> ProcElaboration::GetChannelInstance(
@@ -379,27 +459,31 @@ ProcElaboration::ElaborateOldStylePackage(Package* package) {
   // All channels are available in all procs. Create a global map from channel
   // name to channel instance and pass it to the constructor of every proc
   // instance.
-  absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings;
+  auto channel_ref_table = std::make_shared<ChannelRefTable>();
+  std::vector<ChannelBinding> channel_bindings;
   for (Channel* channel : package->channels()) {
+    int64_t id = elaboration.channel_instances_.size();
     elaboration.channel_instances_.push_back(std::make_unique<ChannelInstance>(
-        ChannelInstance{.channel = channel, .path = std::nullopt}));
+        ChannelInstance{.channel = channel, .id = id}));
     ChannelInstance* channel_instance =
         elaboration.channel_instances_.back().get();
 
     elaboration.channel_instance_ptrs_.push_back(channel_instance);
     elaboration.instances_of_channel_[channel] = {channel_instance};
-    channel_bindings[channel] = ChannelBinding{
-        .instance = channel_instance, .parent_reference = std::nullopt};
+    AddToChannelRefTable(channel, channel->name(), *channel_ref_table);
+    channel_bindings.push_back(ChannelBinding{
+        .instance = channel_instance, .parent_reference = std::nullopt});
   }
 
   for (const std::unique_ptr<Proc>& proc : package->procs()) {
     XLS_RET_CHECK(!proc->is_new_style_proc());
     elaboration.proc_instances_.push_back(std::make_unique<ProcInstance>(
         proc.get(), /*proc_instantiation=*/std::nullopt,
-        /*path=*/std::nullopt,
         /*channel_instances=*/std::vector<std::unique_ptr<ChannelInstance>>(),
         /*instantiated_procs=*/std::vector<std::unique_ptr<ProcInstance>>(),
-        channel_bindings));
+        channel_ref_table, channel_bindings));
+    elaboration.proc_instances_.back()->id_ =
+        elaboration.proc_instance_ptrs_.size();
     elaboration.proc_instance_ptrs_.push_back(
         elaboration.proc_instances_.back().get());
 
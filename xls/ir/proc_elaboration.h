@@ -20,7 +20,6 @@
 #include <optional>
 #include <string>
 #include <string_view>
-#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -84,13 +83,27 @@ namespace xls {
 //
 // There are five instances of `leaf_proc` as there are five paths from
 // `top_proc` to `leaf_proc` in the proc hierarchy.
+//
+// Instances are numbered densely (see ProcInstance::id and ChannelInstance::id)
+// so clients can keep per-instance state in vectors. Instantiation paths are
+// not stored per instance; each instance points to its parent in the tree and
+// paths are reconstructed on demand.
+
+class ProcInstance;
 
 struct ChannelInstance {
   Channel* channel;
 
+  // The proc instance in which this channel is defined. Is nullptr for
+  // old-style channels and for the interface channels of the top proc.
+  ProcInstance* proc_instance = nullptr;
+
+  // Index of this channel instance in ProcElaboration::channel_instances().
+  int64_t id = -1;
+
   // Instantiation path of the proc instance in which this channel is
   // defined. Is nullopt for old-style channels.
-  std::optional<ProcInstantiationPath> path;
+  std::optional<ProcInstantiationPath> path() const;
 
   std::string ToString() const;
 };
@@ -111,17 +124,26 @@ struct ChannelBinding {
   std::optional<ChannelReference*> parent_reference;
 };
 
+// Dense numbering of the channel references of a proc (or of the channels of
+// the package for old-style procs). It is shared by all instances of the proc
+// and indexes their channel bindings.
+struct ChannelRefTable {
+  absl::flat_hash_map<ChannelRef, int64_t> indices;
+  absl::flat_hash_map<std::string, int64_t> indices_by_name;
+};
+
 // Representation of an instance of a proc. This is a recursive data structure
 // which also holds all channel and proc instances instantiated by this proc
 // instance including recursively.
 class ProcInstance {
  public:
-  ProcInstance(
-      Proc* proc, std::optional<ProcInstantiation*> proc_instantiation,
-      std::optional<ProcInstantiationPath> path,
-      std::vector<std::unique_ptr<ChannelInstance>> channel_instances,
-      std::vector<std::unique_ptr<ProcInstance>> instantiated_procs,
-      absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings);
+  // `channel_bindings` is indexed by the numbering in `channel_ref_table`.
+  ProcInstance(Proc* proc,
+               std::optional<ProcInstantiation*> proc_instantiation,
+               std::vector<std::unique_ptr<ChannelInstance>> channel_instances,
+               std::vector<std::unique_ptr<ProcInstance>> instantiated_procs,
+               std::shared_ptr<const ChannelRefTable> channel_ref_table,
+               std::vector<ChannelBinding> channel_bindings);
 
   Proc* proc() const { return proc_; }
 
@@ -134,7 +156,14 @@ class ProcInstance {
 
   // The path to this proc instance through the proc hierarchy. This is
   // std::nullopt for old-style procs.
-  const std::optional<ProcInstantiationPath>& path() const { return path_; }
+  std::optional<ProcInstantiationPath> path() const;
+
+  // The proc instance which instantiates this proc instance. This is nullptr
+  // for the top proc instance and for old-style procs.
+  ProcInstance* parent() const { return parent_; }
+
+  // Index of this proc instance in ProcElaboration::proc_instances().
+  int64_t id() const { return id_; }
 
   // The ChannelInstances corresponding to the channels declared in the proc
   // associated with this proc instance.
@@ -159,18 +188,18 @@ class ProcInstance {
   // only.
   ChannelBinding GetChannelBinding(ChannelReference* channel_reference) const {
     CHECK(proc()->is_new_style_proc());
-    return channel_bindings_.at(channel_reference);
+    return GetChannelBinding(ChannelRef(channel_reference));
   }
 
   // Return the binding for the given channel. For old-style procs only.
   ChannelBinding GetChannelBinding(Channel* channel) const {
     CHECK(!proc()->is_new_style_proc());
-    return channel_bindings_.at(channel);
+    return GetChannelBinding(ChannelRef(channel));
   }
 
   // Return the binding for the given ChannelRef.
   ChannelBinding GetChannelBinding(ChannelRef channel_ref) const {
-    return channel_bindings_.at(channel_ref);
+    return channel_bindings_[channel_ref_table_->indices.at(channel_ref)];
   }
 
   // Returns a unique name for this proc instantiation. For new-style procs this
@@ -182,24 +211,24 @@ class ProcInstance {
   std::string ToString(int64_t indent_amount = 0) const;
 
  private:
+  friend class ProcElaboration;
+
   Proc* proc_;
   std::optional<ProcInstantiation*> proc_instantiation_;
-  std::optional<ProcInstantiationPath> path_;
+  ProcInstance* parent_ = nullptr;
+  int64_t id_ = -1;
 
   // Channel and proc instances in this proc instance. Unique pointers are used
   // for pointer stability as pointers to these objects are handed out.
   std::vector<std::unique_ptr<ChannelInstance>> channel_instances_;
   std::vector<std::unique_ptr<ProcInstance>> instantiated_procs_;
 
-  // Map from ChannelRef (variant of ChannelReference and Channel) to the
-  // channel binding. For old-style procs this contains *all* channels as all
-  // channels are referenceable in all procs. For new-style procs this contains
-  // only the channel references in this proc.
-  absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings_;
-
-  // Map from channel reference name to channel instance for all channel
-  // references in the proc.
-  absl::flat_hash_map<std::string, ChannelInstance*> channel_name_map_;
+  // Channel bindings indexed by the channel reference numbering of the proc.
+  // For old-style procs this contains *all* channels as all channels are
+  // referenceable in all procs. For new-style procs this contains only the
+  // channel references in this proc.
+  std::shared_ptr<const ChannelRefTable> channel_ref_table_;
+  std::vector<ChannelBinding> channel_bindings_;
 };
 
 // Data structure representing the elaboration tree.
@@ -305,15 +334,11 @@ class ProcElaboration {
   // Channel instances for the interface channels.
   std::vector<std::unique_ptr<ChannelInstance>> interface_channel_instances_;
 
-  // All proc instances in the elaboration indexed by instantiation path.
-  absl::flat_hash_map<ProcInstantiationPath, ProcInstance*>
-      proc_instances_by_path_;
-
-  // All channel instances in the elaboration indexed by channel reference name
-  // (new style) or channel name (old style) and instantiation path.
-  absl::flat_hash_map<std::pair<std::string, ProcInstantiationPath>,
-                      ChannelInstance*>
-      channel_instances_by_path_;
+  // Index of each proc instantiation among the instantiations of its proc,
+  // which is also the index of the corresponding ProcInstance among the
+  // instantiated procs of the parent instance. Used to walk instantiation
+  // paths down the instance tree.
+  absl::flat_hash_map<ProcInstantiation*, int64_t> instantiation_indices_;
 
   // List of instances of each Proc/Channel.
   absl::flat_hash_map<Proc*, std::vector<ProcInstance*>> instances_of_proc_;
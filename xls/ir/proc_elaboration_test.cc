@@ -15,6 +15,7 @@
 #include "xls/ir/proc_elaboration.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string_view>
 #include <vector>
@@ -291,13 +292,13 @@ TEST_F(ElaborationTest, MultipleInstantiations) {
       elab.GetInstancesOfChannelReference(leaf_proc->interface()[1]).size(), 7);
 
   EXPECT_EQ(elab.GetInstancesOfChannelReference(leaf_proc->interface()[0])[0]
-                ->path->ToString(),
+                ->path()->ToString(),
             "top_proc::top_proc_inst0->middle");
   EXPECT_EQ(elab.GetInstancesOfChannelReference(leaf_proc->interface()[0])[1]
-                ->path->ToString(),
+                ->path()->ToString(),
             "top_proc::top_proc_inst0->middle");
   EXPECT_EQ(elab.GetInstancesOfChannelReference(leaf_proc->interface()[0])[6]
-                ->path->ToString(),
+                ->path()->ToString(),
             "top_proc");
 
   EXPECT_THAT(elab.top(), ProcInstanceFor(top));
@@ -320,6 +321,59 @@ TEST_F(ElaborationTest, MultipleInstantiations) {
   leaf<leaf_ch0=ch0, leaf_ch1=ch1> [top_proc_inst2])");
 }
 
+TEST_F(ElaborationTest, InstanceIdsAndParents) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * leaf_proc,
+      CreateLeafProc("leaf", /*input_channel_count=*/2, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * middle_proc,
+      CreateMultipleInstantiationProc(
+          "middle", /*input_channel_count=*/2, /*instantiated_channel_count=*/2,
+          {leaf_proc, leaf_proc}, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * top,
+                           CreateMultipleInstantiationProc(
+                               "top_proc", /*input_channel_count=*/2,
+                               /*instantiated_channel_count=*/2,
+                               {middle_proc, middle_proc}, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elab,
+                           ProcElaboration::Elaborate(top));
+
+  for (int64_t i = 0; i < elab.proc_instances().size(); ++i) {
+    ProcInstance* instance = elab.proc_instances()[i];
+    EXPECT_EQ(instance->id(), i);
+    // The path is reconstructed from the parent chain and leads back to the
+    // same instance.
+    if (instance == elab.top()) {
+      EXPECT_EQ(instance->parent(), nullptr);
+    } else {
+      ASSERT_NE(instance->parent(), nullptr);
+      bool is_child_of_parent = false;
+      for (const std::unique_ptr<ProcInstance>& child :
+           instance->parent()->instantiated_procs()) {
+        is_child_of_parent |= child.get() == instance;
+      }
+      EXPECT_TRUE(is_child_of_parent);
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(ProcInstance * found,
+                             elab.GetProcInstance(instance->path().value()));
+    EXPECT_EQ(found, instance);
+  }
+  for (int64_t i = 0; i < elab.channel_instances().size(); ++i) {
+    EXPECT_EQ(elab.channel_instances()[i]->id, i);
+  }
+
+  ProcInstance* leaf_instance = elab.GetInstances(leaf_proc)[3];
+  EXPECT_EQ(leaf_instance->path()->ToString(),
+            "top_proc::top_proc_inst1->middle::middle_inst1->leaf");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ChannelInstance * channel_instance,
+      elab.GetChannelInstance("leaf_ch0", leaf_instance->path().value()));
+  EXPECT_EQ(channel_instance->proc_instance, leaf_instance->parent());
+  EXPECT_EQ(channel_instance->path()->ToString(),
+            "top_proc::top_proc_inst1->middle");
+}
+
 TEST_F(ElaborationTest, ProcInstantiatingProcWithNoChannels) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -0,0 +1,84 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/source_info_table.h"
+
+#include <cstdint>
+#include <limits>
+
+#include "absl/base/no_destructor.h"
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+
+int32_t SourceInfoTable::Acquire(const SourceInfo& loc) {
+  if (loc.Empty()) {
+    return kEmptyId;
+  }
+  absl::MutexLock lock(&mutex_);
+  auto it = ids_.find(absl::MakeConstSpan(loc.locations));
+  if (it != ids_.end()) {
+    ++entries_[it->second - 1].reference_count;
+    return it->second;
+  }
+  int32_t id;
+  if (free_ids_.empty()) {
+    CHECK_LT(entries_.size(), std::numeric_limits<int32_t>::max());
+    entries_.emplace_back();
+    id = static_cast<int32_t>(entries_.size());
+  } else {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  }
+  Entry& entry = entries_[id - 1];
+  entry.loc = loc;
+  entry.reference_count = 1;
+  ids_.emplace(absl::MakeConstSpan(entry.loc.locations), id);
+  return id;
+}
+
+void SourceInfoTable::Release(int32_t id) {
+  if (id == kEmptyId) {
+    return;
+  }
+  absl::MutexLock lock(&mutex_);
+  Entry& entry = entries_[id - 1];
+  DCHECK_GT(entry.reference_count, 0);
+  if (--entry.reference_count > 0) {
+    return;
+  }
+  ids_.erase(absl::MakeConstSpan(entry.loc.locations));
+  entry.loc = SourceInfo();
+  free_ids_.push_back(id);
+}
+
+const SourceInfo& SourceInfoTable::Get(int32_t id) const {
+  if (id == kEmptyId) {
+    static const absl::NoDestructor<SourceInfo> kEmpty;
+    return *kEmpty;
+  }
+  absl::ReaderMutexLock lock(&mutex_);
+  DCHECK_GT(entries_[id - 1].reference_count, 0);
+  return entries_[id - 1].loc;
+}
+
+int64_t SourceInfoTable::size() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return entries_.size() - free_ids_.size();
+}
+
+}  // namespace xls
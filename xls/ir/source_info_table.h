@@ -0,0 +1,76 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_SOURCE_INFO_TABLE_H_
+#define XLS_IR_SOURCE_INFO_TABLE_H_
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+
+// A deduplicated, reference-counted table of source location stacks. Nodes
+// hold the id of their SourceInfo in the table of their package so the many
+// nodes which share a location stack (e.g., the nodes created by inlining one
+// invocation) share its storage. An entry is freed when its last reference is
+// released and its id may then be reused. The table is thread-safe.
+class SourceInfoTable {
+ public:
+  // Id of the empty SourceInfo. It is not reference counted.
+  static constexpr int32_t kEmptyId = 0;
+
+  SourceInfoTable() = default;
+  SourceInfoTable(const SourceInfoTable&) = delete;
+  SourceInfoTable& operator=(const SourceInfoTable&) = delete;
+
+  // Returns the id of `loc`, adding it to the table if necessary, and takes a
+  // reference to it.
+  int32_t Acquire(const SourceInfo& loc);
+
+  // Releases a reference to the entry with the given id.
+  void Release(int32_t id);
+
+  // Returns the SourceInfo with the given id. The reference is valid while
+  // the caller holds a reference to the entry.
+  const SourceInfo& Get(int32_t id) const;
+
+  // Returns the number of live entries in the table.
+  int64_t size() const;
+
+ private:
+  struct Entry {
+    SourceInfo loc;
+    int64_t reference_count = 0;
+  };
+
+  mutable absl::Mutex mutex_;
+  // Entries indexed by id - 1. A deque so entries do not move as entries are
+  // added. The keys of `ids_` refer to the locations of the entries.
+  std::deque<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<absl::Span<const SourceLocation>, int32_t> ids_
+      ABSL_GUARDED_BY(mutex_);
+  // Ids of freed entries available for reuse.
+  std::vector<int32_t> free_ids_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_SOURCE_INFO_TABLE_H_
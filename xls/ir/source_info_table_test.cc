@@ -0,0 +1,71 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/source_info_table.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "xls/ir/fileno.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+SourceInfo MakeLoc(int32_t line) {
+  return SourceInfo(
+      {SourceLocation(Fileno(1), Lineno(line), Colno(0)),
+       SourceLocation(Fileno(2), Lineno(line + 1), Colno(4))});
+}
+
+TEST(SourceInfoTableTest, EqualLocationsShareAnEntry) {
+  SourceInfoTable table;
+  int32_t a = table.Acquire(MakeLoc(1));
+  int32_t b = table.Acquire(MakeLoc(1));
+  int32_t c = table.Acquire(MakeLoc(2));
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(&table.Get(a), &table.Get(b));
+  EXPECT_EQ(table.Get(c).ToString(), MakeLoc(2).ToString());
+  EXPECT_EQ(table.size(), 2);
+}
+
+TEST(SourceInfoTableTest, EmptyLocationIsNotStored) {
+  SourceInfoTable table;
+  EXPECT_EQ(table.Acquire(SourceInfo()), SourceInfoTable::kEmptyId);
+  EXPECT_TRUE(table.Get(SourceInfoTable::kEmptyId).Empty());
+  table.Release(SourceInfoTable::kEmptyId);
+  EXPECT_EQ(table.size(), 0);
+}
+
+TEST(SourceInfoTableTest, EntriesAreFreedAndReused) {
+  SourceInfoTable table;
+  int32_t a = table.Acquire(MakeLoc(1));
+  table.Acquire(MakeLoc(1));
+  table.Release(a);
+  EXPECT_EQ(table.size(), 1);
+  EXPECT_EQ(table.Get(a).ToString(), MakeLoc(1).ToString());
+  table.Release(a);
+  EXPECT_EQ(table.size(), 0);
+
+  int32_t b = table.Acquire(MakeLoc(3));
+  EXPECT_EQ(b, a);
+  EXPECT_EQ(table.Get(b).ToString(), MakeLoc(3).ToString());
+  // The freed location is no longer found.
+  EXPECT_NE(table.Acquire(MakeLoc(1)), b);
+  EXPECT_EQ(table.size(), 2);
+}
+
+}  // namespace
+}  // namespace xls
@@ -17,6 +17,7 @@
 
 #include <compare>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -54,6 +55,12 @@ class SourceLocation {
     }
     return colno_.value() <=> other.colno_.value();
   }
+  bool operator==(const SourceLocation& other) const = default;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const SourceLocation& loc) {
+    return H::combine(std::move(h), loc.fileno_, loc.lineno_, loc.colno_);
+  }
 
  private:
   Fileno fileno_;
@@ -17,6 +17,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <deque>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -31,8 +33,9 @@
 #include "xls/ir/node.h"
 
 namespace xls {
+namespace {
 
-std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
+std::vector<Node*> ComputeReverseTopoSort(FunctionBase* f) {
   // For topological traversal we only add nodes to the order when all of its
   // users have been scheduled.
   //
@@ -155,6 +158,18 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
   return ordered;
 }
 
+}  // namespace
+
+std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
+  if (std::optional<std::vector<Node*>> cached = f->GetCachedReverseTopoSort();
+      cached.has_value()) {
+    return *std::move(cached);
+  }
+  std::vector<Node*> ordered = ComputeReverseTopoSort(f);
+  f->SetCachedReverseTopoSort(ordered);
+  return ordered;
+}
+
 std::vector<Node*> TopoSort(FunctionBase* f) {
   std::vector<Node*> ordered = ReverseTopoSort(f);
   std::reverse(ordered.begin(), ordered.end());
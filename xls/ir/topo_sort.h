@@ -32,7 +32,10 @@ namespace xls {
 // satisfied).
 //
 // Note that the ordering for all nodes is computed up front, *not*
-// incrementally as iteration proceeds.
+// incrementally as iteration proceeds. The order is cached on the function
+// base and only recomputed after the graph changes (see
+// FunctionBase::graph_version), so repeated calls on an unmodified function
+// base only pay for copying the order.
 std::vector<Node*> TopoSort(FunctionBase* f);
 
 // As above, but returns a reverse topo order.
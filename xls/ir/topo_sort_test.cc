@@ -21,7 +21,9 @@
 #include <vector>
 
 #include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
@@ -40,6 +42,8 @@
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+
 // Note that the elaborated topo sort on blocks is intended to have the same
 // order (modulo instantiations) as this topo sort. Tests should be duplicated
 // here and there to the extend that it is possible.
@@ -288,6 +292,100 @@ TEST(NodeIteratorTest, RpoVsTopo) {
 
 // LINT.ThenChange(//xls/ir/block_elaboration_test.cc)
 
+TEST(NodeIteratorTest, CachedOrderIsInvalidatedByMutation) {
+  std::string program = R"(
+  fn f(x: bits[32], y: bits[32]) -> bits[32] {
+    neg.1: bits[32] = neg(x)
+    not.2: bits[32] = not(y)
+    ret add.3: bits[32] = add(neg.1, not.2)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  auto names = [](absl::Span<Node* const> nodes) {
+    std::vector<std::string> result;
+    for (Node* node : nodes) {
+      result.push_back(node->GetName());
+    }
+    return result;
+  };
+
+  EXPECT_THAT(names(TopoSort(f)),
+              ElementsAre("x", "y", "neg.1", "not.2", "add.3"));
+  int64_t version = f->graph_version();
+  EXPECT_THAT(names(TopoSort(f)),
+              ElementsAre("x", "y", "neg.1", "not.2", "add.3"));
+  EXPECT_EQ(f->graph_version(), version);
+
+  // Replacing an operand changes the order.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg, f->GetNode("neg.1"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * not_node, f->GetNode("not.2"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * y, f->GetNode("y"));
+  XLS_ASSERT_OK(neg->ReplaceOperandNumber(0, not_node));
+  EXPECT_GT(f->graph_version(), version);
+  EXPECT_THAT(names(TopoSort(f)),
+              ElementsAre("y", "not.2", "neg.1", "x", "add.3"));
+
+  // Adding and removing nodes and changing the return value invalidate the
+  // order.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub, f->MakeNodeWithName<BinOp>(SourceInfo(), y, neg, Op::kSub,
+                                             "sub"));
+  EXPECT_THAT(names(ReverseTopoSort(f)),
+              ElementsAre("add.3", "sub", "x", "neg.1", "not.2", "y"));
+  XLS_ASSERT_OK(f->set_return_value(sub));
+  EXPECT_EQ(TopoSort(f).back(), sub);
+  XLS_ASSERT_OK(f->RemoveNode(f->GetNode("add.3").value()));
+  EXPECT_THAT(names(TopoSort(f)),
+              ElementsAre("y", "not.2", "neg.1", "x", "sub"));
+}
+
+TEST(NodeIteratorTest, CachedOrderIsInvalidatedByReorderingOperands) {
+  std::string program = R"(
+  package p
+
+  fn f(x: bits[32], y: bits[32]) -> bits[64] {
+    neg.1: bits[32] = neg(x)
+    not.2: bits[32] = not(y)
+    ret concat.3: bits[64] = concat(neg.1, not.2)
+  }
+
+  fn g(x: bits[32], y: bits[32]) -> bits[96] {
+    neg.4: bits[32] = neg(x)
+    not.5: bits[32] = not(y)
+    ret concat.6: bits[96] = concat(neg.4, not.5, neg.4)
+  })";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+
+  // Swapping the operands leaves the user sets unchanged but changes the
+  // order in which the operands are visited.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("f"));
+  std::vector<Node*> original = TopoSort(f);
+  int64_t version = f->graph_version();
+  f->return_value()->SwapOperands(0, 1);
+  EXPECT_GT(f->graph_version(), version);
+  std::vector<Node*> cached = TopoSort(f);
+  EXPECT_NE(cached, original);
+  // Force recomputation.
+  f->IncrementGraphVersion();
+  EXPECT_EQ(cached, TopoSort(f));
+
+  // Likewise for replacing an operand with another operand of the node while
+  // the replaced operand remains an operand.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g, p->GetFunction("g"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * not_node, g->GetNode("not.5"));
+  original = TopoSort(g);
+  version = g->graph_version();
+  XLS_ASSERT_OK(g->return_value()->ReplaceOperandNumber(2, not_node));
+  EXPECT_GT(g->graph_version(), version);
+  cached = TopoSort(g);
+  EXPECT_NE(cached, original);
+  g->IncrementGraphVersion();
+  EXPECT_EQ(cached, TopoSort(g));
+}
+
 void BM_TopoSortBinaryTree(benchmark::State& state) {
   std::unique_ptr<VerifiedPackage> p =
       std::make_unique<VerifiedPackage>("balanced_tree_pkg");
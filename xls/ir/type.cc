@@ -20,12 +20,14 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/call_once.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/ir/xls_type.pb.h"
 
@@ -74,6 +76,29 @@ absl::StatusOr<TupleType*> Type::AsTuple() {
       absl::StrCat("Type is not a tuple: ", *this));
 }
 
+absl::Span<Type* const> Type::leaf_types() const {
+  absl::call_once(leaf_types_once_, [this]() {
+    leaf_types_.reserve(leaf_count());
+    if (IsTuple()) {
+      for (Type* element_type : AsTupleOrDie()->element_types()) {
+        absl::Span<Type* const> element_leaves = element_type->leaf_types();
+        leaf_types_.insert(leaf_types_.end(), element_leaves.begin(),
+                           element_leaves.end());
+      }
+    } else if (IsArray()) {
+      absl::Span<Type* const> element_leaves =
+          AsArrayOrDie()->element_type()->leaf_types();
+      for (int64_t i = 0; i < AsArrayOrDie()->size(); ++i) {
+        leaf_types_.insert(leaf_types_.end(), element_leaves.begin(),
+                           element_leaves.end());
+      }
+    } else {
+      leaf_types_.push_back(const_cast<Type*>(this));
+    }
+  });
+  return leaf_types_;
+}
+
 TypeProto BitsType::ToProto() const {
   TypeProto proto;
   proto.set_type_enum(TypeProto::BITS);
@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/call_once.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
@@ -87,6 +88,11 @@ class Type {
   // Returns the number of leaf Bits types in this object.
   virtual int64_t leaf_count() const = 0;
 
+  // Returns the leaf (bits and token) types of this type in flattened order,
+  // i.e., the order of the elements of a LeafTypeTree of this type. Computed on
+  // first use and shared by all callers for the lifetime of the type.
+  absl::Span<Type* const> leaf_types() const;
+
   virtual std::string ToString() const = 0;
 
   template <typename Sink>
@@ -97,8 +103,17 @@ class Type {
  protected:
   explicit Type(TypeKind kind) : kind_(kind) {}
 
+  // Types are copied/moved into their owning TypeManager on creation. The
+  // cached leaf types may refer to the type itself so they are not carried
+  // over.
+  Type(const Type& other) : kind_(other.kind_) {}
+  Type& operator=(const Type& other) = delete;
+
  private:
   TypeKind kind_;
+
+  mutable absl::once_flag leaf_types_once_;
+  mutable std::vector<Type*> leaf_types_;
 };
 
 std::ostream& operator<<(std::ostream& os, const Type& type);
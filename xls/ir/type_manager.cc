@@ -25,6 +25,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
@@ -36,9 +37,11 @@ namespace xls {
 
 TypeManager::TypeManager() {
   token_type_ = std::make_unique<TokenType>();
+  absl::MutexLock lock(mutex_.get());
   owned_types_.insert(token_type_.get());
 }
 BitsType* TypeManager::GetBitsType(int64_t bit_count) {
+  absl::MutexLock lock(mutex_.get());
   if (bit_count_to_type_.find(bit_count) != bit_count_to_type_.end()) {
     return &bit_count_to_type_.at(bit_count);
   }
@@ -50,10 +53,11 @@ BitsType* TypeManager::GetBitsType(int64_t bit_count) {
 
 ArrayType* TypeManager::GetArrayType(int64_t size, Type* element_type) {
   ArrayKey key{size, element_type};
+  absl::MutexLock lock(mutex_.get());
   if (array_types_.find(key) != array_types_.end()) {
     return &array_types_.at(key);
   }
-  CHECK(IsOwnedType(element_type))
+  CHECK(owned_types_.contains(element_type))
       << "Type is not owned by package: " << *element_type;
   auto it = array_types_.emplace(key, ArrayType(size, element_type));
   ArrayType* new_type = &(it.first->second);
@@ -63,11 +67,12 @@ ArrayType* TypeManager::GetArrayType(int64_t size, Type* element_type) {
 
 TupleType* TypeManager::GetTupleType(absl::Span<Type* const> element_types) {
   TypeVec key(element_types.begin(), element_types.end());
+  absl::MutexLock lock(mutex_.get());
   if (tuple_types_.find(key) != tuple_types_.end()) {
     return &tuple_types_.at(key);
   }
   for (const Type* element_type : element_types) {
-    CHECK(IsOwnedType(element_type))
+    CHECK(owned_types_.contains(element_type))
         << "Type is not owned by package: " << *element_type;
   }
   auto it = tuple_types_.emplace(key, TupleType(element_types));
@@ -115,12 +120,13 @@ absl::StatusOr<Type*> TypeManager::MapTypeFromOtherArena(
 FunctionType* TypeManager::GetFunctionType(absl::Span<Type* const> args_types,
                                            Type* return_type) {
   std::string key = FunctionType(args_types, return_type).ToString();
+  absl::MutexLock lock(mutex_.get());
   if (function_types_.find(key) != function_types_.end()) {
     return &function_types_.at(key);
   }
   for (Type* t : args_types) {
-    CHECK(IsOwnedType(t)) << "Parameter type is not owned by package: "
-                          << t->ToString();
+    CHECK(owned_types_.contains(t))
+        << "Parameter type is not owned by package: " << t->ToString();
   }
   auto it = function_types_.emplace(key, FunctionType(args_types, return_type));
   FunctionType* new_type = &(it.first->second);
@@ -20,10 +20,12 @@
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -31,6 +33,9 @@
 
 namespace xls {
 
+// Owns the types of a package. The methods of the type manager are
+// thread-safe so the function bases of a package may be transformed
+// concurrently.
 class TypeManager {
  public:
   explicit TypeManager();
@@ -42,11 +47,12 @@ class TypeManager {
   TypeManager& operator=(const TypeManager&) = delete;
   // Returns whether the given type is one of the types owned by this package.
   bool IsOwnedType(const Type* type) const {
-    return owned_types_.find(type) != owned_types_.end();
+    absl::MutexLock lock(mutex_.get());
+    return owned_types_.contains(type);
   }
   bool IsOwnedFunctionType(const FunctionType* function_type) const {
-    return owned_function_types_.find(function_type) !=
-           owned_function_types_.end();
+    absl::MutexLock lock(mutex_.get());
+    return owned_function_types_.contains(function_type);
   }
 
   BitsType* GetBitsType(int64_t bit_count);
@@ -67,33 +73,42 @@ class TypeManager {
   Type* GetTypeForValue(const Value& value);
 
  private:
+  // Guards the type tables below. Held by pointer to keep the type manager
+  // movable. Types are never removed and are stored with stable addresses so
+  // pointers to them may be used without holding the lock.
+  std::unique_ptr<absl::Mutex> mutex_ = std::make_unique<absl::Mutex>();
+
   // Set of owned types in this package.
-  absl::flat_hash_set<const Type*> owned_types_;
+  absl::flat_hash_set<const Type*> owned_types_ ABSL_GUARDED_BY(*mutex_);
 
   // Set of owned function types in this package.
-  absl::flat_hash_set<const FunctionType*> owned_function_types_;
+  absl::flat_hash_set<const FunctionType*> owned_function_types_
+      ABSL_GUARDED_BY(*mutex_);
 
   // Mapping from bit count to the owned "bits" type with that many bits. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_;
+  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_
+      ABSL_GUARDED_BY(*mutex_);
 
   // Mapping from the size and element type of an array type to the owned
   // ArrayType. Use node_hash_map for pointer stability.
   using ArrayKey = std::pair<int64_t, const Type*>;
-  absl::node_hash_map<ArrayKey, ArrayType> array_types_;
+  absl::node_hash_map<ArrayKey, ArrayType> array_types_
+      ABSL_GUARDED_BY(*mutex_);
 
   // Mapping from elements to the owned tuple type.
   //
   // Uses node_hash_map for pointer stability.
   using TypeVec = absl::InlinedVector<const Type*, 4>;
-  absl::node_hash_map<TypeVec, TupleType> tuple_types_;
+  absl::node_hash_map<TypeVec, TupleType> tuple_types_ ABSL_GUARDED_BY(*mutex_);
 
   // Owned token type.
   std::unique_ptr<TokenType> token_type_;
 
   // Mapping from Type:ToString to the owned function type. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<std::string, FunctionType> function_types_;
+  absl::node_hash_map<std::string, FunctionType> function_types_
+      ABSL_GUARDED_BY(*mutex_);
 };
 
 }  // namespace xls
@@ -27,7 +27,9 @@ namespace {
 
 using ::absl_testing::IsOkAndHolds;
 using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 
 TEST(TypeTest, TestVariousTypes) {
   BitsType b42(42);
@@ -208,6 +210,24 @@ TEST(TypeTest, AsXTypeCallsWork) {
                        HasSubstr("Type is not a tuple: bits[32][7]")));
 }
 
+TEST(TypeTest, LeafTypes) {
+  TypeManager man;
+  BitsType* b1 = man.GetBitsType(1);
+  BitsType* b32 = man.GetBitsType(32);
+  TokenType* token = man.GetTokenType();
+  ArrayType* array = man.GetArrayType(3, b32);
+  TupleType* tuple = man.GetTupleType({b1, array, man.GetTupleType({}), token});
+
+  EXPECT_THAT(b32->leaf_types(), ElementsAre(b32));
+  EXPECT_THAT(token->leaf_types(), ElementsAre(token));
+  EXPECT_THAT(array->leaf_types(), ElementsAre(b32, b32, b32));
+  EXPECT_THAT(man.GetTupleType({})->leaf_types(), IsEmpty());
+  EXPECT_THAT(tuple->leaf_types(), ElementsAre(b1, b32, b32, b32, token));
+
+  // The leaf types are computed once and shared.
+  EXPECT_EQ(tuple->leaf_types().data(), tuple->leaf_types().data());
+}
+
 TEST(TypeTest, InstantiationType) {
   TypeManager man;
   InstantiationType it1(/*input_types=*/{{"foo", man.GetBitsType(32)}},
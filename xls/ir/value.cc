@@ -253,7 +253,7 @@ void Value::FlattenTo(BitPushBuffer* buffer) const {
 }
 
 absl::StatusOr<std::vector<Value>> Value::GetElements() const {
-  if (!std::holds_alternative<std::vector<Value>>(payload_)) {
+  if (!std::holds_alternative<ElementStorage>(payload_)) {
     return absl::InvalidArgumentError("Value does not hold elements.");
   }
   return std::vector<Value>(elements().begin(), elements().end());
@@ -467,6 +467,12 @@ bool Value::operator==(const Value& other) const {
     return bits() == other.bits();
   }
 
+  // Copies of a value share element storage so they are trivially equal.
+  if (std::get<ElementStorage>(payload_) ==
+      std::get<ElementStorage>(other.payload_)) {
+    return true;
+  }
+
   // All non-Bits types are container types -- should have a size attribute.
   if (size() != other.size()) {
     return false;
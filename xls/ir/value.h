@@ -17,6 +17,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -56,6 +57,8 @@ inline std::ostream& operator<<(std::ostream& os, ValueKind kind) {
   return os;
 }
 
+class ValuePool;
+
 // Represents a value in the XLS system; e.g. values can be "bits", tuples of
 // values, or arrays or values. Arrays are represented similarly to tuples, but
 // are monomorphic and potentially multi-dimensional.
@@ -68,7 +71,7 @@ class Value {
     return Value(ValueKind::kTuple, elements);
   }
   static Value TupleOwned(std::vector<Value>&& elements) {
-    return Value(ValueKind::kTuple, elements);
+    return Value(ValueKind::kTuple, std::move(elements));
   }
 
   // All members of "elements" must be of the same type, or an error status will
@@ -106,9 +109,7 @@ class Value {
     return Value(ValueKind::kArray, std::move(elements));
   }
 
-  static Value Token() {
-    return Value(ValueKind::kToken, std::vector<Value>({}));
-  }
+  static Value Token() { return Value(ValueKind::kToken, ElementStorage()); }
   static Value Bool(bool enabled) {
     return Value(
         UBits(/*value=*/static_cast<uint64_t>(enabled), /*bit_count=*/1));
@@ -146,7 +147,11 @@ class Value {
   absl::StatusOr<std::vector<Value>> GetElements() const;
 
   absl::Span<const Value> elements() const {
-    return std::get<std::vector<Value>>(payload_);
+    const ElementStorage& storage = std::get<ElementStorage>(payload_);
+    if (storage == nullptr) {
+      return {};
+    }
+    return *storage;
   }
   const Value& element(int64_t i) const { return elements().at(i); }
   int64_t size() const { return elements().size(); }
@@ -193,19 +198,48 @@ class Value {
 
   template <typename H>
   friend H AbslHashValue(H h, const Value& v) {
-    return H::combine(std::move(h), v.kind_, v.payload_);
+    if (v.IsBits()) {
+      return H::combine(std::move(h), v.kind_, v.bits());
+    }
+    if (std::holds_alternative<ElementStorage>(v.payload_)) {
+      return H::combine(std::move(h), v.kind_, v.elements());
+    }
+    return H::combine(std::move(h), v.kind_);
   }
 
  private:
+  // The elements of a tuple, array or token. Values are immutable so the
+  // element storage is shared between copies of a value, which makes copying
+  // an aggregate O(1) rather than a deep copy of the entire value tree. A null
+  // pointer represents an aggregate with no elements so tokens and empty
+  // tuples require no allocation.
+  using ElementStorage = std::shared_ptr<const std::vector<Value>>;
+
+  static ElementStorage MakeElementStorage(std::vector<Value>&& elements) {
+    if (elements.empty()) {
+      return nullptr;
+    }
+    return std::make_shared<const std::vector<Value>>(std::move(elements));
+  }
+
   Value(ValueKind kind, absl::Span<const Value> elements)
-      : kind_(kind),
-        payload_(std::vector<Value>(elements.begin(), elements.end())) {}
+      : Value(kind, std::vector<Value>(elements.begin(), elements.end())) {}
 
   Value(ValueKind kind, std::vector<Value>&& elements)
+      : kind_(kind), payload_(MakeElementStorage(std::move(elements))) {}
+
+  Value(ValueKind kind, ElementStorage elements)
       : kind_(kind), payload_(std::move(elements)) {}
 
+  // Returns the element storage of a tuple, array or token.
+  const ElementStorage& element_storage() const {
+    return std::get<ElementStorage>(payload_);
+  }
+
+  friend class ValuePool;
+
   ValueKind kind_;
-  std::variant<std::nullptr_t, std::vector<Value>, Bits> payload_;
+  std::variant<std::nullptr_t, ElementStorage, Bits> payload_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Value& value) {
@@ -0,0 +1,107 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/value_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+namespace {
+
+// Returns whether the storage of `value` can be shared by interning.
+bool IsInternable(const Value& value) {
+  return (value.IsTuple() || value.IsArray()) && !value.empty();
+}
+
+}  // namespace
+
+Value ValuePool::Intern(Value value) {
+  if (!IsInternable(value)) {
+    return value;
+  }
+  absl::MutexLock lock(&mutex_);
+  if (values_.size() >= prune_threshold_) {
+    PruneLocked();
+  }
+  return *values_.insert(std::move(value)).first;
+}
+
+absl::StatusOr<std::shared_ptr<const LeafTypeTree<Value>>>
+ValuePool::GetLeafTypeTree(const Value& value, Type* type) {
+  if (!IsInternable(value)) {
+    XLS_ASSIGN_OR_RETURN(LeafTypeTree<Value> tree,
+                         ValueToLeafTypeTree(value, type));
+    return std::make_shared<const LeafTypeTree<Value>>(std::move(tree));
+  }
+  // The interned copy keeps the storage (and so the key) alive while the tree
+  // is computed without holding the lock.
+  Value interned = Intern(value);
+  std::pair<const void*, Type*> key(interned.element_storage().get(), type);
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = trees_.find(key);
+    if (it != trees_.end()) {
+      return it->second;
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(LeafTypeTree<Value> tree,
+                       ValueToLeafTypeTree(interned, type));
+  auto shared_tree =
+      std::make_shared<const LeafTypeTree<Value>>(std::move(tree));
+  absl::MutexLock lock(&mutex_);
+  return trees_.try_emplace(key, std::move(shared_tree)).first->second;
+}
+
+void ValuePool::Prune() {
+  absl::MutexLock lock(&mutex_);
+  PruneLocked();
+}
+
+void ValuePool::PruneLocked() {
+  absl::flat_hash_set<const void*> pruned;
+  absl::erase_if(values_, [&](const Value& value) {
+    const Value::ElementStorage& storage = value.element_storage();
+    if (storage.use_count() > 1) {
+      return false;
+    }
+    pruned.insert(storage.get());
+    return true;
+  });
+  if (!pruned.empty()) {
+    absl::erase_if(trees_, [&](const auto& entry) {
+      return pruned.contains(entry.first.first);
+    });
+  }
+  prune_threshold_ =
+      std::max(kMinPruneThreshold, 2 * static_cast<int64_t>(values_.size()));
+}
+
+int64_t ValuePool::size() const {
+  absl::MutexLock lock(&mutex_);
+  return values_.size();
+}
+
+}  // namespace xls
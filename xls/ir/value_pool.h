@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_VALUE_POOL_H_
+#define XLS_IR_VALUE_POOL_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// A pool of interned (hash-consed) values. Interning an aggregate value
+// returns a value which shares its element storage with every other equal
+// value interned in the pool, so many copies of a large value (e.g., a ROM
+// table duplicated by unrolling or inlining) occupy the memory of one.
+//
+// The pool also caches the LeafTypeTree<Value> of interned values so the
+// analyses which decompose literals into their leaves do so once per distinct
+// value rather than once per literal (or query).
+//
+// Values no longer referenced outside the pool are dropped periodically as
+// values are interned. The pool is thread-safe.
+class ValuePool {
+ public:
+  ValuePool() = default;
+  ValuePool(const ValuePool&) = delete;
+  ValuePool& operator=(const ValuePool&) = delete;
+
+  // Returns a value equal to `value`. If `value` is a non-empty tuple or array
+  // the returned value shares its storage with all other equal values
+  // interned in the pool. Bits values are returned unchanged as their storage
+  // is not shared.
+  Value Intern(Value value);
+
+  // Returns the leaf type tree of `value` which must be of type `type`. The
+  // tree is shared among all equal values of the same type.
+  absl::StatusOr<std::shared_ptr<const LeafTypeTree<Value>>> GetLeafTypeTree(
+      const Value& value, Type* type);
+
+  // Drops the values (and leaf type trees) which are referenced only by the
+  // pool.
+  void Prune();
+
+  // Returns the number of distinct values in the pool.
+  int64_t size() const;
+
+ private:
+  void PruneLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_set<Value> values_ ABSL_GUARDED_BY(mutex_);
+  // Leaf type trees of interned values keyed by the value's element storage
+  // (which the entry in `values_` keeps alive) and type.
+  absl::flat_hash_map<std::pair<const void*, Type*>,
+                      std::shared_ptr<const LeafTypeTree<Value>>>
+      trees_ ABSL_GUARDED_BY(mutex_);
+  // Size of the pool at which it is next pruned. Doubling the threshold after
+  // each prune keeps the cost of pruning amortized constant per value.
+  int64_t prune_threshold_ ABSL_GUARDED_BY(mutex_) = kMinPruneThreshold;
+
+  static constexpr int64_t kMinPruneThreshold = 1024;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_VALUE_POOL_H_
@@ -0,0 +1,92 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/value_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+Value MakeTable(int64_t size) {
+  std::vector<Value> elements;
+  for (int64_t i = 0; i < size; ++i) {
+    elements.push_back(Value(UBits(i * 7, 32)));
+  }
+  return Value::ArrayOwned(std::move(elements));
+}
+
+TEST(ValuePoolTest, EqualValuesShareStorage) {
+  ValuePool pool;
+  Value a = pool.Intern(MakeTable(16));
+  Value b = pool.Intern(MakeTable(16));
+  Value c = pool.Intern(MakeTable(17));
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(a.elements().data(), b.elements().data());
+  EXPECT_NE(a.elements().data(), c.elements().data());
+  EXPECT_EQ(pool.size(), 2);
+}
+
+TEST(ValuePoolTest, BitsAndEmptyValuesAreNotPooled) {
+  ValuePool pool;
+  EXPECT_EQ(pool.Intern(Value(UBits(42, 8))), Value(UBits(42, 8)));
+  EXPECT_EQ(pool.Intern(Value::Tuple({})), Value::Tuple({}));
+  EXPECT_EQ(pool.Intern(Value::Token()), Value::Token());
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST(ValuePoolTest, PruneDropsUnreferencedValues) {
+  ValuePool pool;
+  Value kept = pool.Intern(MakeTable(4));
+  pool.Intern(MakeTable(5));
+  EXPECT_EQ(pool.size(), 2);
+  pool.Prune();
+  EXPECT_EQ(pool.size(), 1);
+  EXPECT_EQ(pool.Intern(MakeTable(4)).elements().data(),
+            kept.elements().data());
+}
+
+TEST(ValuePoolTest, LeafTypeTreesAreShared) {
+  Package package("test");
+  ValuePool pool;
+  Value table = MakeTable(8);
+  Type* type = package.GetTypeForValue(table);
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const LeafTypeTree<Value>> a,
+                           pool.GetLeafTypeTree(table, type));
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const LeafTypeTree<Value>> b,
+                           pool.GetLeafTypeTree(MakeTable(8), type));
+  EXPECT_EQ(a, b);
+  ASSERT_EQ(a->size(), 8);
+  EXPECT_EQ(a->Get({3}), Value(UBits(21, 32)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const LeafTypeTree<Value>> bits_tree,
+      pool.GetLeafTypeTree(Value(UBits(1, 4)), package.GetBitsType(4)));
+  EXPECT_EQ(bits_tree->Get({}), Value(UBits(1, 4)));
+}
+
+}  // namespace
+}  // namespace xls
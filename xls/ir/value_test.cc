@@ -20,6 +20,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/fuzzing/fuzztest.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/types/span.h"
@@ -343,6 +344,29 @@ TEST(ValueTest, XBitsArrayWrongSizes) {
               HasSubstr("elements of arrays should have consistent size."));
 }
 
+TEST(ValueTest, CopiesShareElements) {
+  Value tuple = Value::Tuple({Value(UBits(1, 8)), Value(UBits(200, 100))});
+  Value array = Value::ArrayOrDie({tuple, tuple, tuple});
+  Value copy = array;
+  EXPECT_EQ(copy.elements().data(), array.elements().data());
+  EXPECT_EQ(copy, array);
+  EXPECT_EQ(absl::HashOf(copy), absl::HashOf(array));
+
+  // Structurally equal values with distinct storage are equal and hash equal.
+  Value rebuilt = Value::ArrayOrDie(
+      {Value::Tuple({Value(UBits(1, 8)), Value(UBits(200, 100))}), tuple,
+       tuple});
+  EXPECT_NE(rebuilt.elements().data(), array.elements().data());
+  EXPECT_EQ(rebuilt, array);
+  EXPECT_EQ(absl::HashOf(rebuilt), absl::HashOf(array));
+  EXPECT_NE(rebuilt, Value::ArrayOrDie({tuple, tuple}));
+
+  EXPECT_TRUE(Value::Token().empty());
+  EXPECT_EQ(Value::Token(), Value::Token());
+  EXPECT_NE(Value::Token(), Value::Tuple({}));
+  EXPECT_EQ(absl::HashOf(Value::Tuple({})), absl::HashOf(Value::Tuple({})));
+}
+
 TEST(ValueTest, ToProtoBits) {
   {
     std::string_view expected_txt = R"pb(
@@ -24,8 +24,10 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
@@ -106,15 +108,25 @@ absl::Status VerifyName(FunctionBase* function_base) {
   return absl::OkStatus();
 }
 
-// Verify common invariants to function-level constructs.
-absl::Status VerifyFunctionBase(FunctionBase* function) {
+// Verify common invariants to function-level constructs. If `nodes_to_verify`
+// is non-null, only those nodes are checked individually; invariants spanning
+// the whole function base are always checked.
+absl::Status VerifyFunctionBase(
+    FunctionBase* function,
+    const absl::flat_hash_set<Node*>* nodes_to_verify = nullptr) {
   VLOG(2) << absl::StreamFormat("Verifying function %s:", function->name());
   XLS_VLOG_LINES(4, function->DumpIr());
 
   XLS_RETURN_IF_ERROR(VerifyName(function));
+  auto should_verify = [&](Node* node) {
+    return nodes_to_verify == nullptr || nodes_to_verify->contains(node);
+  };
 
   // Verify all types are owned by package.
   for (Node* node : function->nodes()) {
+    if (!should_verify(node)) {
+      continue;
+    }
     XLS_RET_CHECK(node->package()->IsOwnedType(node->GetType()));
     XLS_RET_CHECK(node->package() == function->package());
   }
@@ -137,7 +149,9 @@ absl::Status VerifyFunctionBase(FunctionBase* function) {
 
   // Verify consistency of node::users() and node::operands().
   for (Node* node : function->nodes()) {
-    XLS_RETURN_IF_ERROR(VerifyNode(node));
+    if (should_verify(node)) {
+      XLS_RETURN_IF_ERROR(VerifyNode(node));
+    }
   }
 
   // Verify the set of parameter nodes is exactly Function::params(), and that
@@ -507,11 +521,13 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
   return absl::OkStatus();
 }
 
-absl::Status VerifyFunction(Function* function, bool codegen) {
+static absl::Status VerifyFunctionImpl(
+    Function* function, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify) {
   VLOG(4) << "Verifying function:\n";
   XLS_VLOG_LINES(4, function->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function, nodes_to_verify));
 
   for (Node* node : function->nodes()) {
     if (node->Is<Send>() || node->Is<Receive>()) {
@@ -524,6 +540,10 @@ absl::Status VerifyFunction(Function* function, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyFunction(Function* function, bool codegen) {
+  return VerifyFunctionImpl(function, codegen, /*nodes_to_verify=*/nullptr);
+}
+
 static absl::Status VerifyProcScopedChannels(Proc* proc) {
   // Verify channel references contains exactly the set expected from the
   // interface and channel definitions. Map value is used to track how many
@@ -687,11 +707,13 @@ static absl::Status VerifyProcInstantiations(Proc* proc) {
   return absl::OkStatus();
 }
 
-absl::Status VerifyProc(Proc* proc, bool codegen) {
+static absl::Status VerifyProcImpl(
+    Proc* proc, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify) {
   VLOG(4) << "Verifying proc:\n";
   XLS_VLOG_LINES(4, proc->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc, nodes_to_verify));
 
   if (proc->is_new_style_proc()) {
     XLS_RETURN_IF_ERROR(VerifyProcScopedChannels(proc));
@@ -736,6 +758,10 @@ absl::Status VerifyProc(Proc* proc, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyProc(Proc* proc, bool codegen) {
+  return VerifyProcImpl(proc, codegen, /*nodes_to_verify=*/nullptr);
+}
+
 // Verify that the given set of port nodes on the instantiated block match
 // one-to-one with the instantiation input/output nodes in the instantiating
 // block.
@@ -752,10 +778,14 @@ static absl::Status VerifyPortsMatch(
   for (InstantiationNodeT* instantiation_node : instantiation_nodes) {
     instantiation_port_names.push_back(instantiation_node->port_name());
   }
+  // Blocks stitched from many procs have many ports so use sets for the
+  // membership checks.
+  absl::flat_hash_set<std::string_view> block_port_name_set(
+      block_port_names.begin(), block_port_names.end());
+  absl::flat_hash_set<std::string_view> instantiation_port_name_set(
+      instantiation_port_names.begin(), instantiation_port_names.end());
   for (const std::string& name : block_port_names) {
-    if (std::find(instantiation_port_names.begin(),
-                  instantiation_port_names.end(),
-                  name) == instantiation_port_names.end()) {
+    if (!instantiation_port_name_set.contains(name)) {
       return absl::InternalError(
           absl::StrFormat("Instantiation `%s` of block `%s` is missing "
                           "instantation input/output node for port `%s`",
@@ -764,8 +794,7 @@ static absl::Status VerifyPortsMatch(
     }
   }
   for (const std::string& name : instantiation_port_names) {
-    if (std::find(block_port_names.begin(), block_port_names.end(), name) ==
-        block_port_names.end()) {
+    if (!block_port_name_set.contains(name)) {
       return absl::InternalError(absl::StrFormat(
           "No port `%s` on instantiated block `%s` for instantiation `%s`",
           name, instantiation->instantiated_block()->name(),
@@ -787,19 +816,13 @@ static absl::Status VerifyPortsMatch(
 }
 
 // Verifies invariants of the given block instantiation.
-static absl::Status VerifyBlockInstantiation(BlockInstantiation* instantiation,
-                                             Block* instantiating_block) {
+// `package_blocks` holds the blocks of the package of `instantiating_block`.
+static absl::Status VerifyBlockInstantiation(
+    BlockInstantiation* instantiation, Block* instantiating_block,
+    const absl::flat_hash_set<Block*>& package_blocks) {
   Block* instantiated_block = instantiation->instantiated_block();
   Package* package = instantiating_block->package();
-  auto block_in_package = [](Package* p, Block* b) {
-    for (const std::unique_ptr<Block>& block : p->blocks()) {
-      if (block.get() == b) {
-        return true;
-      }
-    }
-    return false;
-  };
-  if (!block_in_package(package, instantiated_block)) {
+  if (!package_blocks.contains(instantiated_block)) {
     return absl::InternalError(absl::StrFormat(
         "Instantiated block `%s` (%p) is not owned by package `%s`",
         instantiated_block->name(), instantiated_block, package->name()));
@@ -947,11 +970,13 @@ static absl::Status VerifyFifoInstantiation(Package* package,
   return absl::OkStatus();
 }
 
-absl::Status VerifyBlock(Block* block, bool codegen) {
+static absl::Status VerifyBlockImpl(
+    Block* block, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify) {
   VLOG(4) << "Verifying block:\n";
   XLS_VLOG_LINES(4, block->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(block));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(block, nodes_to_verify));
 
   // Verify that there are no cycles in the node graph.
   // The previous check in VerifyFunctionBase looks locally, but does not look
@@ -1061,13 +1086,21 @@ absl::Status VerifyBlock(Block* block, bool codegen) {
     XLS_RET_CHECK_EQ(reg_write, reg_writes.at(reg));
   }
 
+  absl::flat_hash_set<Block*> package_blocks;
+  if (!block->GetInstantiations().empty()) {
+    for (const std::unique_ptr<Block>& package_block :
+         block->package()->blocks()) {
+      package_blocks.insert(package_block.get());
+    }
+  }
   for (Instantiation* instantiation : block->GetInstantiations()) {
     switch (instantiation->kind()) {
       case InstantiationKind::kBlock:
         // Verify each instantiation is a block instantiation and the block is
         // owned the package.
         XLS_RETURN_IF_ERROR(VerifyBlockInstantiation(
-            down_cast<BlockInstantiation*>(instantiation), block));
+            down_cast<BlockInstantiation*>(instantiation), block,
+            package_blocks));
         break;
       case InstantiationKind::kExtern:
         XLS_RETURN_IF_ERROR(VerifyExternInstantiation(
@@ -1087,4 +1120,182 @@ absl::Status VerifyBlock(Block* block, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyBlock(Block* block, bool codegen) {
+  return VerifyBlockImpl(block, codegen, /*nodes_to_verify=*/nullptr);
+}
+
+namespace {
+
+// Returns a hash of the properties of `node` which verifying it depends on.
+uint64_t NodeSignature(Node* node) {
+  uint64_t signature = absl::HashOf(node->op(), node->GetType());
+  for (Node* operand : node->operands()) {
+    signature = absl::HashOf(signature, operand->id());
+  }
+  return signature;
+}
+
+bool IsChannelNode(Node* node) {
+  return node->Is<Send>() || node->Is<Receive>();
+}
+
+// Returns the sizes of the lists of non-node entities (state elements,
+// channels, registers, etc) owned by `function_base`.
+std::vector<int64_t> FunctionBaseShape(FunctionBase* function_base) {
+  if (function_base->IsProc()) {
+    Proc* proc = function_base->AsProcOrDie();
+    return {proc->GetStateElementCount(),
+            static_cast<int64_t>(proc->interface().size()),
+            static_cast<int64_t>(proc->channels().size()),
+            static_cast<int64_t>(proc->proc_instantiations().size())};
+  }
+  if (function_base->IsBlock()) {
+    Block* block = function_base->AsBlockOrDie();
+    return {static_cast<int64_t>(block->GetRegisters().size()),
+            static_cast<int64_t>(block->GetInstantiations().size())};
+  }
+  return {};
+}
+
+}  // namespace
+
+struct IncrementalVerifier::Snapshot {
+  struct FunctionBaseRecord {
+    // Signature of each node keyed by node id.
+    absl::flat_hash_map<int64_t, uint64_t> node_signatures;
+    std::vector<Node*> params;
+    std::vector<int64_t> shape;
+  };
+
+  Package* package = nullptr;
+  int64_t next_node_id = 0;
+  std::vector<FunctionBase*> function_bases;
+  std::vector<Channel*> channels;
+  absl::flat_hash_map<FunctionBase*, FunctionBaseRecord> records;
+};
+
+IncrementalVerifier::IncrementalVerifier(bool codegen) : codegen_(codegen) {}
+
+IncrementalVerifier::~IncrementalVerifier() = default;
+
+void IncrementalVerifier::Reset() { snapshot_.reset(); }
+
+absl::Status IncrementalVerifier::VerifyFull(Package* package) {
+  snapshot_.reset();
+  XLS_RETURN_IF_ERROR(VerifyPackage(package, codegen_));
+
+  auto snapshot = std::make_unique<Snapshot>();
+  snapshot->package = package;
+  snapshot->next_node_id = package->next_node_id();
+  snapshot->function_bases = package->GetFunctionBases();
+  snapshot->channels.assign(package->channels().begin(),
+                            package->channels().end());
+  for (FunctionBase* function_base : snapshot->function_bases) {
+    Snapshot::FunctionBaseRecord& record = snapshot->records[function_base];
+    for (Node* node : function_base->nodes()) {
+      record.node_signatures[node->id()] = NodeSignature(node);
+    }
+    record.params.assign(function_base->params().begin(),
+                         function_base->params().end());
+    record.shape = FunctionBaseShape(function_base);
+  }
+  snapshot_ = std::move(snapshot);
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalVerifier::Verify(Package* package) {
+  if (snapshot_ == nullptr || snapshot_->package != package ||
+      snapshot_->function_bases != package->GetFunctionBases() ||
+      !absl::c_equal(snapshot_->channels, package->channels())) {
+    return VerifyFull(package);
+  }
+
+  // Find the nodes of each function base which were added or modified since
+  // the snapshot. Anything which could affect package-level invariants
+  // (channels, elaboration, node id uniqueness across function bases) falls
+  // back to verifying the whole package.
+  absl::flat_hash_map<FunctionBase*, Snapshot::FunctionBaseRecord> records;
+  std::vector<std::pair<FunctionBase*, absl::flat_hash_set<Node*>>> changed;
+  absl::flat_hash_set<int64_t> new_ids;
+  for (FunctionBase* function_base : snapshot_->function_bases) {
+    const Snapshot::FunctionBaseRecord& old_record =
+        snapshot_->records.at(function_base);
+    Snapshot::FunctionBaseRecord record;
+    record.params.assign(function_base->params().begin(),
+                         function_base->params().end());
+    record.shape = FunctionBaseShape(function_base);
+    if (record.shape != old_record.shape) {
+      return VerifyFull(package);
+    }
+
+    std::vector<Node*> changed_nodes;
+    int64_t surviving_node_count = 0;
+    for (Node* node : function_base->nodes()) {
+      uint64_t signature = NodeSignature(node);
+      if (!record.node_signatures.emplace(node->id(), signature).second) {
+        return VerifyFull(package);
+      }
+      auto it = old_record.node_signatures.find(node->id());
+      if (it == old_record.node_signatures.end()) {
+        if (node->id() < snapshot_->next_node_id ||
+            node->id() >= package->next_node_id() ||
+            !new_ids.insert(node->id()).second) {
+          return VerifyFull(package);
+        }
+      } else {
+        ++surviving_node_count;
+        if (it->second == signature) {
+          continue;
+        }
+      }
+      if (IsChannelNode(node)) {
+        return VerifyFull(package);
+      }
+      changed_nodes.push_back(node);
+    }
+    bool nodes_removed =
+        surviving_node_count !=
+        static_cast<int64_t>(old_record.node_signatures.size());
+    if (!changed_nodes.empty() || nodes_removed ||
+        record.params != old_record.params) {
+      // The users and operands of a changed node have changed user and
+      // operand lists respectively so verify them as well.
+      absl::flat_hash_set<Node*> nodes_to_verify;
+      for (Node* node : changed_nodes) {
+        nodes_to_verify.insert(node);
+        nodes_to_verify.insert(node->operands().begin(),
+                               node->operands().end());
+        nodes_to_verify.insert(node->users().begin(), node->users().end());
+      }
+      changed.push_back({function_base, std::move(nodes_to_verify)});
+    }
+    records[function_base] = std::move(record);
+  }
+
+  for (auto& [function_base, nodes_to_verify] : changed) {
+    VLOG(4) << absl::StreamFormat(
+        "Incrementally verifying %d nodes of %s", nodes_to_verify.size(),
+        function_base->name());
+    absl::Status status;
+    if (function_base->IsFunction()) {
+      status = VerifyFunctionImpl(function_base->AsFunctionOrDie(), codegen_,
+                                  &nodes_to_verify);
+    } else if (function_base->IsProc()) {
+      status = VerifyProcImpl(function_base->AsProcOrDie(), codegen_,
+                              &nodes_to_verify);
+    } else {
+      status = VerifyBlockImpl(function_base->AsBlockOrDie(), codegen_,
+                               &nodes_to_verify);
+    }
+    if (!status.ok()) {
+      snapshot_.reset();
+      return status;
+    }
+  }
+
+  snapshot_->next_node_id = package->next_node_id();
+  snapshot_->records = std::move(records);
+  return absl::OkStatus();
+}
+
 }  // namespace xls
@@ -15,6 +15,8 @@
 #ifndef XLS_IR_VERIFIER_H_
 #define XLS_IR_VERIFIER_H_
 
+#include <memory>
+
 #include "absl/status/status.h"
 
 namespace xls {
@@ -32,6 +34,39 @@ absl::Status VerifyFunction(Function* function, bool codegen = false);
 absl::Status VerifyProc(Proc* Proc, bool codegen = false);
 absl::Status VerifyBlock(Block* Block, bool codegen = false);
 
+// Verifies a package which is repeatedly transformed, e.g. between the passes
+// of a pipeline, re-checking only what changed since the previous
+// verification. Nodes which were added or whose op, type or operands changed
+// are verified along with their operands and users, and the function-level
+// invariants (params, state, ports, cycles) of the function bases containing
+// them are rechecked. Changes which can affect package-level invariants, such
+// as added function bases or channels or modified send/receive nodes, fall
+// back to a full VerifyPackage, as does the first verification. Detecting
+// changes visits every node but is much cheaper than verifying it.
+class IncrementalVerifier {
+ public:
+  explicit IncrementalVerifier(bool codegen = false);
+  ~IncrementalVerifier();
+
+  // Verifies the package, incrementally if a snapshot of it from a previous
+  // verification is available.
+  absl::Status Verify(Package* package);
+
+  // Verifies the whole package and records a snapshot of it for subsequent
+  // incremental verification.
+  absl::Status VerifyFull(Package* package);
+
+  // Discards the snapshot so the next call to Verify verifies the whole
+  // package.
+  void Reset();
+
+ private:
+  struct Snapshot;
+
+  bool codegen_;
+  std::unique_ptr<Snapshot> snapshot_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_IR_VERIFIER_H_
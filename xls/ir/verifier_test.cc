@@ -690,5 +690,43 @@ proc my_new_proc<>() {}
                                  "proc-scoped channels")));
 }
 
+TEST_F(VerifierTest, IncrementalVerifierChecksModifiedNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  BValue neg = fb.Negate(x);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Tuple({fb.Not(neg), y})).status());
+
+  IncrementalVerifier verifier;
+  XLS_ASSERT_OK(verifier.Verify(p.get()));
+  XLS_ASSERT_OK(verifier.Verify(p.get()));
+
+  // Rewire the negation to an operand of the wrong width.
+  XLS_ASSERT_OK(neg.node()->ReplaceOperandNumber(0, y.node(),
+                                                 /*type_must_match=*/false));
+  EXPECT_THAT(verifier.Verify(p.get()),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of")));
+}
+
+TEST_F(VerifierTest, IncrementalVerifierVerifiesAddedFunctions) {
+  auto p = CreatePackage();
+  FunctionBuilder fb("f", p.get());
+  fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK(fb.Build().status());
+
+  IncrementalVerifier verifier;
+  XLS_ASSERT_OK(verifier.Verify(p.get()));
+
+  FunctionBuilder keyword_fb("top", p.get(), /*should_verify=*/false);
+  keyword_fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK(keyword_fb.Build().status());
+  EXPECT_THAT(
+      verifier.Verify(p.get()),
+      StatusIs(absl::StatusCode::kInternal,
+               HasSubstr("Function/proc/block name 'top' is a keyword")));
+}
+
 }  // namespace
 }  // namespace xls
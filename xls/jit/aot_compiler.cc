@@ -23,6 +23,8 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/ADT/StringRef.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
@@ -54,11 +56,13 @@
 namespace xls {
 
 /* static */ absl::StatusOr<std::unique_ptr<AotCompiler>> AotCompiler::Create(
-    bool include_msan, int64_t opt_level, JitObserver* observer) {
+    bool include_msan, int64_t opt_level, JitObserver* observer,
+    const LlvmPgoOptions& pgo_options) {
   LlvmCompiler::InitializeLlvm();
   auto compiler = std::unique_ptr<AotCompiler>(
       new AotCompiler(opt_level, include_msan, observer));
   XLS_RETURN_IF_ERROR(compiler->Init());
+  XLS_RETURN_IF_ERROR(compiler->SetPgoOptions(pgo_options));
   return std::move(compiler);
 }
 
@@ -182,7 +186,9 @@ absl::Status AotCompiler::CompileModule(
   if (notification.unoptimized_module) {
     jit_observer_->UnoptimizedModule(module.get());
   }
+  absl::Time optimization_start = absl::Now();
   auto err = PerformStandardOptimization(module.get());
+  absl::Duration optimization_time = absl::Now() - optimization_start;
   if (err) {
     std::string mem;
     llvm::raw_string_ostream oss(mem);
@@ -219,9 +225,19 @@ absl::Status AotCompiler::CompileModule(
                                            llvm::CodeGenFileType::ObjectFile)) {
     return absl::InternalError("Unable to add passes for object code dumping");
   }
+  absl::Time codegen_start = absl::Now();
   mpm.run(*module);
+  absl::Duration codegen_time = absl::Now() - codegen_start;
   object_code_ =
       std::vector<uint8_t>(stream_buffer.begin(), stream_buffer.end());
+  if (notification.compilation_stats) {
+    jit_observer_->CompilationStats(
+        module.get(),
+        JitCompilationStats{.opt_level = opt_level(),
+                            .vectorize = vectorize(),
+                            .optimization_time = optimization_time,
+                            .codegen_time = codegen_time});
+  }
 
   return absl::OkStatus();
 }
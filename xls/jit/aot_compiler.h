@@ -35,7 +35,8 @@ class AotCompiler final : public LlvmCompiler {
  public:
   static absl::StatusOr<std::unique_ptr<AotCompiler>> Create(
       bool include_msan, int64_t opt_level = LlvmCompiler::kDefaultOptLevel,
-      JitObserver* observer = nullptr);
+      JitObserver* observer = nullptr,
+      const LlvmPgoOptions& pgo_options = LlvmPgoOptions());
 
   absl::StatusOr<AotCompiler*> AsAotCompiler() override { return this; }
 
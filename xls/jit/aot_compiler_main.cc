@@ -20,33 +20,46 @@
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/IR/LLVMContext.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "google/protobuf/text_format.h"
+#include "xls/common/casts.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dev_tools/extract_interface.h"
 #include "xls/ir/block_elaboration.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/state_element.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/block_jit.h"
 #include "xls/jit/function_base_jit.h"
@@ -55,6 +68,7 @@
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/observer.h"
+#include "xls/jit/type_layout.h"
 #include "xls/jit/type_layout.pb.h"
 
 ABSL_FLAG(std::string, input, "", "Path to the IR to compile.");
@@ -78,6 +92,19 @@ ABSL_FLAG(std::optional<std::string>, output_asm, std::nullopt,
           "Path at which to write the output optimized llvm file.");
 ABSL_FLAG(int64_t, llvm_opt_level, xls::LlvmCompiler::kDefaultOptLevel,
           "The optimization level to use for the LLVM optimizer.");
+ABSL_FLAG(bool, pgo_instrument, false,
+          "Instrument the generated code to collect an LLVM profile for "
+          "profile-guided optimization. The binary the object is linked into "
+          "must link the LLVM profile runtime (e.g., with "
+          "-fprofile-generate). Profiles are written to "
+          "--pgo_profile_output.");
+ABSL_FLAG(std::string, pgo_profile_output, "",
+          "Path to which instrumented code writes its raw profile. `%p` and "
+          "`%m` patterns are supported and LLVM_PROFILE_FILE overrides the "
+          "path at runtime. Defaults to `default_%m.profraw`.");
+ABSL_FLAG(std::optional<std::string>, pgo_profile, std::nullopt,
+          "Path to a merged (llvm-profdata merge) profile collected from "
+          "code compiled with --pgo_instrument to optimize the code with.");
 
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
 static constexpr bool kHasMsan = true;
@@ -166,6 +193,16 @@ absl::StatusOr<AotEntrypointProto> GenerateEntrypointProto(
         object_code.queue_indices().begin(), object_code.queue_indices().end());
     *proc_metadata_proto->mutable_proc_interface() =
         ExtractProcInterface(func->AsProcOrDie());
+    for (StateElement* state_element : func->AsProcOrDie()->StateElements()) {
+      TypeLayout layout =
+          type_converter.CreateTypeLayout(state_element->type());
+      std::string buffer(layout.size(), '\0');
+      layout.ValueToNativeLayout(state_element->initial_value(),
+                                 reinterpret_cast<uint8_t*>(buffer.data()));
+      proc_metadata_proto->add_initial_state(std::move(buffer));
+    }
+    proc_metadata_proto->set_has_next_values(
+        !func->AsProcOrDie()->next_values().empty());
   } else {
     XLS_RET_CHECK(func->IsBlock());
     proto.set_type(AotEntrypointProto::BLOCK);
@@ -227,11 +264,117 @@ absl::StatusOr<AotEntrypointProto> GenerateEntrypointProto(
   return proto;
 }
 
+// Returns the channel instance bound to `channel_name` in `proc_instance`.
+absl::StatusOr<ChannelInstance*> GetBoundChannelInstance(
+    const ProcElaboration& elaboration, ProcInstance* proc_instance,
+    std::string_view channel_name) {
+  if (proc_instance->path().has_value()) {
+    return elaboration.GetChannelInstance(channel_name,
+                                          *proc_instance->path());
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Channel * channel,
+      proc_instance->proc()->package()->GetChannel(channel_name));
+  return elaboration.GetUniqueInstance(channel);
+}
+
+// Describes the channels and proc instances of the elaborated network so that
+// a standalone runtime can be generated for it.
+absl::StatusOr<AotProcNetworkProto> GenerateProcNetworkProto(
+    const ProcElaboration& elaboration,
+    absl::Span<const FunctionEntrypoint> entrypoints,
+    LlvmTypeConverter& type_converter) {
+  AotProcNetworkProto proto;
+  absl::flat_hash_set<ChannelInstance*> network_inputs;
+  absl::flat_hash_set<ChannelInstance*> network_outputs;
+  if (elaboration.top() != nullptr &&
+      elaboration.top()->path().has_value()) {
+    for (ChannelReference* ref : elaboration.top()->proc()->interface()) {
+      XLS_ASSIGN_OR_RETURN(
+          ChannelInstance * instance,
+          elaboration.GetChannelInstance(ref->name(),
+                                         *elaboration.top()->path()));
+      if (ref->direction() == Direction::kReceive) {
+        network_inputs.insert(instance);
+      } else {
+        network_outputs.insert(instance);
+      }
+    }
+  } else {
+    for (ChannelInstance* instance : elaboration.channel_instances()) {
+      if (instance->channel->supported_ops() == ChannelOps::kReceiveOnly) {
+        network_inputs.insert(instance);
+      } else if (instance->channel->supported_ops() ==
+                 ChannelOps::kSendOnly) {
+        network_outputs.insert(instance);
+      }
+    }
+  }
+
+  absl::flat_hash_map<ChannelInstance*, int64_t> channel_indices;
+  for (ChannelInstance* instance : elaboration.channel_instances()) {
+    channel_indices[instance] = proto.channels_size();
+    AotProcNetworkProto::ChannelProto* channel = proto.add_channels();
+    Type* type = instance->channel->type();
+    channel->set_name(instance->ToString());
+    channel->set_element_size(type_converter.GetTypeByteSize(type));
+    channel->set_element_alignment(
+        type_converter.GetTypePreferredAlignment(type));
+    channel->set_single_value(instance->channel->kind() ==
+                              ChannelKind::kSingleValue);
+    if (instance->channel->kind() == ChannelKind::kStreaming) {
+      std::optional<int64_t> depth =
+          down_cast<StreamingChannel*>(instance->channel)->GetFifoDepth();
+      if (depth.has_value()) {
+        channel->set_fifo_depth(*depth);
+      }
+    }
+    TypeLayout layout = type_converter.CreateTypeLayout(type);
+    for (const Value& value : instance->channel->initial_values()) {
+      std::string buffer(layout.size(), '\0');
+      layout.ValueToNativeLayout(value,
+                                 reinterpret_cast<uint8_t*>(buffer.data()));
+      channel->add_initial_values(std::move(buffer));
+    }
+    channel->set_is_network_input(network_inputs.contains(instance));
+    channel->set_is_network_output(network_outputs.contains(instance));
+  }
+
+  for (ProcInstance* instance : elaboration.proc_instances()) {
+    auto entrypoint_it =
+        absl::c_find_if(entrypoints, [&](const FunctionEntrypoint& e) {
+          return e.function == instance->proc();
+        });
+    XLS_RET_CHECK(entrypoint_it != entrypoints.end())
+        << "No entrypoint for proc " << instance->proc()->name();
+    const JittedFunctionBase& jit_info = entrypoint_it->jit_info;
+    AotProcNetworkProto::ProcInstanceProto* instance_proto =
+        proto.add_instances();
+    instance_proto->set_name(instance->GetName());
+    instance_proto->set_entrypoint_index(
+        std::distance(entrypoints.begin(), entrypoint_it));
+    std::vector<int64_t> queue_channels(jit_info.queue_indices().size(), -1);
+    for (const auto& [channel_name, queue_index] : jit_info.queue_indices()) {
+      XLS_ASSIGN_OR_RETURN(
+          ChannelInstance * channel_instance,
+          GetBoundChannelInstance(elaboration, instance, channel_name));
+      XLS_RET_CHECK_LT(queue_index, queue_channels.size());
+      queue_channels[queue_index] = channel_indices.at(channel_instance);
+    }
+    for (int64_t channel_index : queue_channels) {
+      XLS_RET_CHECK_GE(channel_index, 0);
+      instance_proto->add_channel_indices(channel_index);
+    }
+  }
+  return proto;
+}
+
 absl::Status RealMain(const std::string& input_ir_path,
                       const std::optional<std::string>& top,
                       const std::optional<std::string>& output_object_path,
                       const std::optional<std::string>& output_proto_path,
                       bool include_msan, int64_t llvm_opt_level,
+                      const LlvmPgoOptions& pgo_options,
                       const std::optional<std::string>& output_textproto_path,
                       const std::optional<std::string>& output_llvm_ir_path,
                       const std::optional<std::string>& output_llvm_opt_ir_path,
@@ -264,24 +407,27 @@ absl::Status RealMain(const std::string& input_ir_path,
   if (f->IsFunction()) {
     XLS_ASSIGN_OR_RETURN(object_code, FunctionJit::CreateObjectCode(
                                           f->AsFunctionOrDie(), llvm_opt_level,
-                                          include_msan, &obs));
+                                          include_msan, &obs, pgo_options));
   } else if (f->IsProc()) {
     if (f->AsProcOrDie()->is_new_style_proc()) {
       XLS_ASSIGN_OR_RETURN(
-          object_code, CreateProcAotObjectCode(f->AsProcOrDie(), llvm_opt_level,
-                                               include_msan, &obs));
+          object_code,
+          CreateProcAotObjectCode(f->AsProcOrDie(), llvm_opt_level,
+                                  include_msan, &obs, pgo_options));
     } else {
       // all procs
       XLS_ASSIGN_OR_RETURN(
-          object_code, CreateProcAotObjectCode(package.get(), llvm_opt_level,
-                                               include_msan, &obs));
+          object_code,
+          CreateProcAotObjectCode(package.get(), llvm_opt_level, include_msan,
+                                  &obs, pgo_options));
     }
   } else {
     XLS_ASSIGN_OR_RETURN(BlockElaboration elab,
                          BlockElaboration::Elaborate(f->AsBlockOrDie()));
     XLS_ASSIGN_OR_RETURN(
         object_code,
-        BlockJit::CreateObjectCode(elab, llvm_opt_level, include_msan, &obs));
+        BlockJit::CreateObjectCode(elab, llvm_opt_level, include_msan, &obs,
+                                   pgo_options));
   }
   AotPackageEntrypointsProto all_entrypoints;
   if (output_object_path) {
@@ -302,6 +448,17 @@ absl::Status RealMain(const std::string& input_ir_path,
             object_code->package ? object_code->package.get() : package.get(),
             oc, include_msan, type_converter));
   }
+  if (f->IsProc()) {
+    XLS_ASSIGN_OR_RETURN(
+        ProcElaboration elaboration,
+        f->AsProcOrDie()->is_new_style_proc()
+            ? ProcElaboration::Elaborate(f->AsProcOrDie())
+            : ProcElaboration::ElaborateOldStylePackage(package.get()));
+    XLS_ASSIGN_OR_RETURN(*all_entrypoints.mutable_proc_network(),
+                         GenerateProcNetworkProto(elaboration,
+                                                  object_code->entrypoints,
+                                                  type_converter));
+  }
   if (output_textproto_path) {
     std::string text;
     XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(all_entrypoints, &text));
@@ -342,9 +499,22 @@ int main(int argc, char** argv) {
       absl::GetFlag(FLAGS_output_proto);
 
   bool include_msan = absl::GetFlag(FLAGS_include_msan);
+  std::optional<std::string> pgo_profile = absl::GetFlag(FLAGS_pgo_profile);
+  QCHECK(!(absl::GetFlag(FLAGS_pgo_instrument) && pgo_profile.has_value()))
+      << "--pgo_instrument and --pgo_profile are mutually exclusive.";
+  xls::LlvmPgoOptions pgo_options;
+  if (absl::GetFlag(FLAGS_pgo_instrument)) {
+    pgo_options = xls::LlvmPgoOptions{
+        .mode = xls::LlvmPgoOptions::Mode::kInstrument,
+        .profile_path = absl::GetFlag(FLAGS_pgo_profile_output)};
+  } else if (pgo_profile.has_value()) {
+    pgo_options =
+        xls::LlvmPgoOptions{.mode = xls::LlvmPgoOptions::Mode::kUseProfile,
+                            .profile_path = *pgo_profile};
+  }
   absl::Status status = xls::RealMain(
       input_ir_path, top, output_object_path, output_proto_path, include_msan,
-      absl::GetFlag(FLAGS_llvm_opt_level),
+      absl::GetFlag(FLAGS_llvm_opt_level), pgo_options,
       absl::GetFlag(FLAGS_output_textproto),
       absl::GetFlag(FLAGS_output_llvm_ir),
       absl::GetFlag(FLAGS_output_llvm_opt_ir), absl::GetFlag(FLAGS_output_asm));
@@ -0,0 +1,329 @@
+# Copyright 2024 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Generates a standalone C++ runtime for an AOT compiled proc network.
+
+The generated class statically allocates every channel, state and temporary
+buffer and drives the compiled procs with a generated scheduling loop. It only
+depends on the standard library and //xls/jit:aot_standalone_runtime so it can
+be linked without LLVM or the XLS IR and interpreter libraries.
+"""
+
+from collections.abc import Sequence
+import dataclasses
+import re
+
+from absl import app
+from absl import flags
+import jinja2
+
+from google.protobuf import text_format
+from xls.common import runfiles
+from xls.jit import aot_entrypoint_pb2
+
+
+_READ_TEXTPROTO = flags.DEFINE_bool(
+    "read_textproto",
+    default=False,
+    required=False,
+    help="Read the input AotPackageEntrypointsProto as a text-proto",
+)
+_NAMESPACES = flags.DEFINE_string(
+    "namespaces",
+    default="",
+    help=(
+        "Comma-separated list of namespaces into which to place the generated"
+        " code. Earlier-specified namespaces enclose later-specified."
+    ),
+    required=False,
+)
+_CLASS_NAME = flags.DEFINE_string(
+    "class_name",
+    default=None,
+    required=True,
+    help="Name of the generated network class.",
+)
+_CHANNEL_CAPACITY = flags.DEFINE_integer(
+    "channel_capacity",
+    default=16,
+    help=(
+        "Minimum number of elements each streaming channel can hold. Channels"
+        " with a larger configured FIFO depth use that depth instead."
+    ),
+)
+_OUTPUT_HEADER = flags.DEFINE_string(
+    "output_header",
+    default=None,
+    required=True,
+    help="Path at which to write the output header file.",
+)
+_OUTPUT_SOURCE = flags.DEFINE_string(
+    "output_source",
+    default=None,
+    required=True,
+    help="Path at which to write the output source file.",
+)
+_HEADER_INCLUDE_PATH = flags.DEFINE_string(
+    "header_include_path",
+    default=None,
+    required=True,
+    help=(
+        "The path in the source tree at which the header should be #included."
+        " This is copied verbatim into an #include directive in the generated"
+        " source file (the .cc file specified with --output_source)."
+    ),
+)
+
+
+def _round_up(value: int, multiple: int) -> int:
+  return (value + multiple - 1) // multiple * multiple
+
+
+def _to_identifier(name: str) -> str:
+  """Converts a channel name into a C++ identifier."""
+  # Drop the instantiation path of new-style channels.
+  name = name.split(" [")[0]
+  ident = re.sub(r"[^A-Za-z0-9_]", "_", name)
+  if not ident or ident[0].isdigit():
+    ident = "_" + ident
+  return ident
+
+
+def _byte_initializer(data: bytes) -> str:
+  # Zero-sized arrays are not allowed so empty values get a dummy byte. Only
+  # the element size is ever copied.
+  return ", ".join(f"0x{b:02x}" for b in data) if data else "0x00"
+
+
+@dataclasses.dataclass(frozen=True)
+class AotChannel:
+  """A statically allocated channel of the network.
+
+  Attributes:
+    index: Index of the channel in the network.
+    name: Full name of the channel instance.
+    ident: C++ identifier for the accessor of network channels.
+    element_size: Size in bytes of a single element.
+    alignment: Alignment of the channel storage.
+    stride: Distance in bytes between elements in the storage.
+    capacity: Number of elements the channel can hold.
+    single_value: Whether the channel has single-value semantics.
+    initial_values: Initializers of the initial values of the channel.
+    is_network_input: Whether the channel is written from outside.
+    is_network_output: Whether the channel is read from outside.
+  """
+
+  index: int
+  name: str
+  ident: str
+  element_size: int
+  alignment: int
+  stride: int
+  capacity: int
+  single_value: bool
+  initial_values: Sequence[str]
+  is_network_input: bool
+  is_network_output: bool
+
+  @property
+  def storage_size(self) -> int:
+    return max(1, self.stride * self.capacity)
+
+
+@dataclasses.dataclass(frozen=True)
+class AotStateElement:
+  """A state element of a proc instance.
+
+  Attributes:
+    size: Size in bytes of the element.
+    alignment: Alignment of the element buffers.
+    initial_value: Initializer of the initial value of the element.
+  """
+
+  size: int
+  alignment: int
+  initial_value: str
+
+  @property
+  def storage_size(self) -> int:
+    return max(1, self.size)
+
+
+@dataclasses.dataclass(frozen=True)
+class AotProcInstance:
+  """A proc instance of the network.
+
+  Attributes:
+    index: Index of the instance in the network.
+    name: Name of the proc instance.
+    symbol: Symbol of the compiled proc.
+    state: The state elements of the proc.
+    has_next_values: Whether the proc updates state with next_value nodes.
+    temp_buffer_size: Size of the temp buffer.
+    temp_buffer_alignment: Alignment of the temp buffer.
+    channel_indices: The channel bound to each queue index of the proc.
+  """
+
+  index: int
+  name: str
+  symbol: str
+  state: Sequence[AotStateElement]
+  has_next_values: bool
+  temp_buffer_size: int
+  temp_buffer_alignment: int
+  channel_indices: Sequence[int]
+
+
+@dataclasses.dataclass(frozen=True)
+class AotProcNetwork:
+  """AOT data for a proc network.
+
+  Attributes:
+    namespace: The namespace in which to place the generated code.
+    header_filename: The filename of the header file to be #included.
+    class_name: The name of the generated class.
+    symbols: The symbols of all compiled procs.
+    channels: The channels of the network.
+    instances: The proc instances of the network.
+    extern_sanitizer: Whether msan is linked in.
+  """
+
+  namespace: str
+  header_filename: str
+  class_name: str
+  symbols: Sequence[str]
+  channels: Sequence[AotChannel]
+  instances: Sequence[AotProcInstance]
+  extern_sanitizer: bool
+
+  @property
+  def network_channels(self) -> Sequence[AotChannel]:
+    return [
+        c for c in self.channels if c.is_network_input or c.is_network_output
+    ]
+
+
+def _build_network(
+    all_entrypoints: aot_entrypoint_pb2.AotPackageEntrypointsProto,
+) -> AotProcNetwork:
+  """Collects the information needed by the templates from the proto."""
+  network = all_entrypoints.proc_network
+  channels = []
+  for index, channel in enumerate(network.channels):
+    alignment = max(1, channel.element_alignment)
+    capacity = (
+        1
+        if channel.single_value
+        else max(
+            _CHANNEL_CAPACITY.value,
+            channel.fifo_depth,
+            len(channel.initial_values),
+        )
+    )
+    channels.append(
+        AotChannel(
+            index=index,
+            name=channel.name,
+            ident=_to_identifier(channel.name),
+            element_size=channel.element_size,
+            alignment=alignment,
+            stride=max(1, _round_up(channel.element_size, alignment)),
+            capacity=capacity,
+            single_value=channel.single_value,
+            initial_values=[
+                _byte_initializer(v) for v in channel.initial_values
+            ],
+            is_network_input=channel.is_network_input,
+            is_network_output=channel.is_network_output,
+        )
+    )
+  idents = [
+      c.ident for c in channels if c.is_network_input or c.is_network_output
+  ]
+  if len(idents) != len(set(idents)):
+    raise app.UsageError(f"Network channel names collide: {idents}")
+
+  instances = []
+  for index, instance in enumerate(network.instances):
+    entrypoint = all_entrypoints.entrypoint[instance.entrypoint_index]
+    if entrypoint.type != aot_entrypoint_pb2.AotEntrypointProto.PROC:
+      raise app.UsageError(f"{entrypoint.function_symbol} is not a proc.")
+    metadata = entrypoint.proc_metadata
+    state = [
+        AotStateElement(size, max(1, align), _byte_initializer(initial))
+        for size, align, initial in zip(
+            entrypoint.input_buffer_sizes,
+            entrypoint.input_buffer_alignments,
+            metadata.initial_state,
+            strict=True,
+        )
+    ]
+    instances.append(
+        AotProcInstance(
+            index=index,
+            name=instance.name,
+            symbol=entrypoint.function_symbol,
+            state=state,
+            has_next_values=metadata.has_next_values,
+            temp_buffer_size=max(1, entrypoint.temp_buffer_size),
+            temp_buffer_alignment=max(1, entrypoint.temp_buffer_alignment),
+            channel_indices=list(instance.channel_indices),
+        )
+    )
+  return AotProcNetwork(
+      namespace="::".join(_NAMESPACES.value.split(",")),
+      header_filename=_HEADER_INCLUDE_PATH.value,
+      class_name=_CLASS_NAME.value,
+      symbols=sorted({i.symbol for i in instances}),
+      channels=channels,
+      instances=instances,
+      extern_sanitizer=any(e.has_msan for e in all_entrypoints.entrypoint),
+  )
+
+
+def main(argv: Sequence[str]) -> None:
+  if len(argv) != 2:
+    raise app.UsageError(f"Usage: {argv[0]} [flags] AotPackageEntrypointsProto")
+  if _READ_TEXTPROTO.value:
+    all_entrypoints = aot_entrypoint_pb2.AotPackageEntrypointsProto()
+    with open(argv[1], "rt") as proto:
+      text_format.Parse(proto.read(), all_entrypoints)
+  else:
+    with open(argv[1], "rb") as proto:
+      all_entrypoints = (
+          aot_entrypoint_pb2.AotPackageEntrypointsProto.FromString(proto.read())
+      )
+  if not all_entrypoints.HasField("proc_network"):
+    raise app.UsageError("Input does not describe a proc network.")
+  network = _build_network(all_entrypoints)
+  env = jinja2.Environment(undefined=jinja2.StrictUndefined)
+  bindings = {"aot": network, "len": len, "max": max}
+  with open(_OUTPUT_HEADER.value, "wt") as h_file:
+    h_template = env.from_string(
+        runfiles.get_contents_as_text("xls/jit/aot_proc_network_h.tmpl")
+    )
+    h_file.write("// Generated File. Do not edit.\n")
+    h_file.write(h_template.render(bindings))
+    h_file.write("\n")
+  with open(_OUTPUT_SOURCE.value, "wt") as cc_file:
+    cc_template = env.from_string(
+        runfiles.get_contents_as_text("xls/jit/aot_proc_network_cc.tmpl")
+    )
+    cc_file.write("// Generated File. Do not edit.\n")
+    cc_file.write(cc_template.render(bindings))
+    cc_file.write("\n")
+
+
+if __name__ == "__main__":
+  app.run(main)
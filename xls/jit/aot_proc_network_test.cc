@@ -0,0 +1,68 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "xls/jit/aot_standalone_runtime.h"
+#include "xls/jit/multi_proc_network.h"
+
+namespace xls {
+namespace {
+
+using ::xls::aot_standalone::TickStatus;
+
+uint32_t ReadU32(aot_standalone::ChannelQueue& queue) {
+  uint32_t value = 0;
+  EXPECT_TRUE(queue.Read(reinterpret_cast<uint8_t*>(&value)));
+  return value;
+}
+
+void WriteU32(aot_standalone::ChannelQueue& queue, uint32_t value) {
+  EXPECT_TRUE(queue.Write(reinterpret_cast<const uint8_t*>(&value)));
+}
+
+TEST(AotProcNetworkTest, Tick) {
+  test::MultiProcNetwork network;
+  EXPECT_EQ(network.kInstanceCount, 3);
+  WriteU32(network.multi_proc__bytes_src(), 3);
+  WriteU32(network.multi_proc__bytes_src(), 7);
+  EXPECT_EQ(network.Tick(), TickStatus::kCompleted);
+  EXPECT_EQ(network.Tick(), TickStatus::kCompleted);
+  EXPECT_EQ(ReadU32(network.multi_proc__bytes_result()), 30);
+  EXPECT_EQ(ReadU32(network.multi_proc__bytes_result()), 70);
+  EXPECT_TRUE(network.multi_proc__bytes_result().empty());
+}
+
+TEST(AotProcNetworkTest, BlocksWithoutInput) {
+  test::MultiProcNetwork network;
+  EXPECT_EQ(network.Tick(), TickStatus::kBlocked);
+  EXPECT_EQ(network.Tick(), TickStatus::kBlocked);
+
+  // The blocked instances resume once input is available.
+  WriteU32(network.multi_proc__bytes_src(), 5);
+  EXPECT_EQ(network.Tick(), TickStatus::kCompleted);
+  EXPECT_EQ(ReadU32(network.multi_proc__bytes_result()), 50);
+}
+
+TEST(AotProcNetworkTest, LookupByName) {
+  test::MultiProcNetwork network;
+  EXPECT_EQ(network.GetChannel("multi_proc__bytes_src"),
+            &network.multi_proc__bytes_src());
+  EXPECT_EQ(network.GetChannel("not_a_channel"), nullptr);
+  EXPECT_NE(network.GetInstance("__multi_proc__proc_ten_0_next"), nullptr);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,201 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/aot_standalone_runtime.h"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace xls::aot_standalone {
+
+bool ChannelQueue::Write(const uint8_t* data) {
+  if (single_value_) {
+    std::memcpy(storage_, data, element_size_);
+    size_ = 1;
+    return true;
+  }
+  if (size_ == capacity_) {
+    return false;
+  }
+  std::memcpy(storage_ + write_index_ * stride_, data, element_size_);
+  write_index_ = write_index_ + 1 == capacity_ ? 0 : write_index_ + 1;
+  ++size_;
+  return true;
+}
+
+bool ChannelQueue::Read(uint8_t* buffer) {
+  if (size_ == 0) {
+    return false;
+  }
+  if (single_value_) {
+    std::memcpy(buffer, storage_, element_size_);
+    return true;
+  }
+  std::memcpy(buffer, storage_ + read_index_ * stride_, element_size_);
+  read_index_ = read_index_ + 1 == capacity_ ? 0 : read_index_ + 1;
+  --size_;
+  return true;
+}
+
+namespace {
+
+void PerformStringStep(InstanceContext* thiz, char* step_string,
+                       std::string* buffer) {
+  buffer->append(step_string);
+}
+
+// Formatting values requires the XLS type which is not available without the
+// IR library so formatted arguments are replaced with a placeholder.
+void PerformFormatStep(InstanceContext* thiz, void* runtime,
+                       const uint8_t* type_proto_data,
+                       int64_t type_proto_data_size, const uint8_t* value,
+                       uint64_t format_u64, std::string* buffer) {
+  buffer->append("<unformatted>");
+}
+
+void RecordTrace(InstanceContext* thiz, std::string* buffer, int64_t verbosity,
+                 ProcEvents* events) {
+  events->trace_msgs.push_back(
+      TraceMessage{.message = std::move(*buffer), .verbosity = verbosity});
+  delete buffer;
+}
+
+std::string* CreateTraceBuffer(InstanceContext* thiz) {
+  return new std::string();
+}
+
+void RecordAssertion(InstanceContext* thiz, const char* msg,
+                     ProcEvents* events) {
+  events->assert_msgs.push_back(msg);
+}
+
+bool QueueReceiveWrapper(InstanceContext* thiz, int64_t queue_index,
+                         uint8_t* buffer) {
+  return thiz->queues[queue_index]->Read(buffer);
+}
+
+void QueueSendWrapper(InstanceContext* thiz, int64_t queue_index,
+                      const uint8_t* data) {
+  ChannelQueue* queue = thiz->queues[queue_index];
+  if (!queue->Write(data)) {
+    queue->RecordOverflow();
+  }
+}
+
+// Observers are not supported in standalone mode.
+void RecordActiveNextValue(InstanceContext* thiz, int64_t param_id,
+                           int64_t next_id) {}
+void RecordNodeResult(InstanceContext* thiz, int64_t node_ptr,
+                      const uint8_t* data) {}
+
+// Traces are formatted immediately. As with PerformFormatStep the operands are
+// replaced with a placeholder. See EncodeDeferredTraceFormat in jit_callbacks.h
+// for the encoding of `format`.
+void RecordDeferredTrace(InstanceContext* thiz, const char* format,
+                         int64_t format_size, const uint8_t* type_proto_data,
+                         int64_t type_proto_data_size, const uint8_t* operands,
+                         int64_t operands_size, int64_t verbosity,
+                         ProcEvents* events) {
+  constexpr char kOperandMarker = '\x01';
+  std::string message;
+  for (int64_t i = 0; i < format_size; ++i) {
+    if (format[i] != kOperandMarker) {
+      message.push_back(format[i]);
+    } else if (++i < format_size && format[i] == kOperandMarker) {
+      message.push_back(kOperandMarker);
+    } else {
+      message.append("<unformatted>");
+    }
+  }
+  events->trace_msgs.push_back(
+      TraceMessage{.message = std::move(message), .verbosity = verbosity});
+}
+
+}  // namespace
+
+const InstanceContextVTable& GetInstanceContextVTable() {
+  static constexpr InstanceContextVTable kVTable{
+      .perform_string_step = PerformStringStep,
+      .perform_format_step = PerformFormatStep,
+      .record_trace = RecordTrace,
+      .create_trace_buffer = CreateTraceBuffer,
+      .record_assertion = RecordAssertion,
+      .queue_receive_wrapper = QueueReceiveWrapper,
+      .queue_send_wrapper = QueueSendWrapper,
+      .record_active_next_value = RecordActiveNextValue,
+      .record_node_result = RecordNodeResult,
+      .record_deferred_trace = RecordDeferredTrace,
+  };
+  return kVTable;
+}
+
+RunResult ProcInstance::Run() {
+  int64_t start_continuation_point = continuation_point_;
+  int64_t next_continuation_point =
+      entrypoint_(input_state_, output_state_, temp_buffer_, &events_,
+                  &context_, /*jit_runtime=*/nullptr, continuation_point_);
+  if (next_continuation_point != 0) {
+    continuation_point_ = next_continuation_point;
+    return RunResult{
+        .completed = false,
+        .progress_made = next_continuation_point != start_continuation_point};
+  }
+  continuation_point_ = 0;
+  std::swap(input_state_, output_state_);
+  if (has_next_values_) {
+    // New-style state updates only write the elements with an active next
+    // value so the output state starts out as the current state.
+    for (int64_t i = 0; i < state_count_; ++i) {
+      std::memcpy(output_state_[i], input_state_[i], state_sizes_[i]);
+    }
+  }
+  return RunResult{.completed = true, .progress_made = true};
+}
+
+std::string_view TickStatusToString(TickStatus status) {
+  switch (status) {
+    case TickStatus::kCompleted:
+      return "completed";
+    case TickStatus::kBlocked:
+      return "blocked";
+    case TickStatus::kChannelOverflow:
+      return "channel overflow";
+    case TickStatus::kAssertionFailed:
+      return "assertion failed";
+  }
+  return "<invalid>";
+}
+
+std::optional<TickStatus> CheckForErrors(ProcInstance* const* instances,
+                                         int64_t instance_count,
+                                         ChannelQueue* const* channels,
+                                         int64_t channel_count) {
+  for (int64_t i = 0; i < instance_count; ++i) {
+    if (!instances[i]->events().assert_msgs.empty()) {
+      return TickStatus::kAssertionFailed;
+    }
+  }
+  for (int64_t i = 0; i < channel_count; ++i) {
+    if (channels[i]->overflowed()) {
+      return TickStatus::kChannelOverflow;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace xls::aot_standalone
@@ -0,0 +1,263 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Minimal runtime for executing networks of ahead-of-time compiled procs
+// without linking against LLVM or the XLS IR and interpreter libraries. The
+// generated wrappers (see aot_proc_network_main.py) statically allocate all
+// channel, state and temporary buffers and use this library to drive the
+// compiled code. Only the C++ standard library is used.
+
+#ifndef XLS_JIT_AOT_STANDALONE_RUNTIME_H_
+#define XLS_JIT_AOT_STANDALONE_RUNTIME_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xls::aot_standalone {
+
+// A trace message recorded by the compiled code.
+struct TraceMessage {
+  std::string message;
+  int64_t verbosity;
+};
+
+// Events recorded during execution of a proc instance. Layout is private to
+// this runtime: the compiled code only passes the pointer back to the
+// callbacks below.
+struct ProcEvents {
+  std::vector<TraceMessage> trace_msgs;
+  std::vector<std::string> assert_msgs;
+
+  void Clear() {
+    trace_msgs.clear();
+    assert_msgs.clear();
+  }
+};
+
+// A fixed-capacity ring buffer of channel elements in the native layout used
+// by the compiled code. Storage is provided by the caller and must hold
+// `capacity * stride` bytes. If `single_value` is true the channel follows
+// single-value semantics: writes overwrite the value and reads are
+// non-destructive.
+class ChannelQueue {
+ public:
+  ChannelQueue(std::string_view name, uint8_t* storage, int64_t element_size,
+               int64_t stride, int64_t capacity, bool single_value)
+      : name_(name),
+        storage_(storage),
+        element_size_(element_size),
+        stride_(stride),
+        capacity_(capacity),
+        single_value_(single_value) {}
+
+  ChannelQueue(const ChannelQueue&) = delete;
+  ChannelQueue& operator=(const ChannelQueue&) = delete;
+
+  std::string_view name() const { return name_; }
+  int64_t element_size() const { return element_size_; }
+  int64_t capacity() const { return capacity_; }
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return !single_value_ && size_ == capacity_; }
+
+  // Writes `element_size()` bytes from `data` to the queue. Returns false (and
+  // drops the value) if the queue is full.
+  bool Write(const uint8_t* data);
+
+  // Reads `element_size()` bytes into `buffer`. Returns false if the queue is
+  // empty.
+  bool Read(uint8_t* buffer);
+
+  // Whether a write from the compiled code was dropped because the queue was
+  // full. Sends in the compiled code cannot fail so overflow is sticky and
+  // reported by the scheduler.
+  bool overflowed() const { return overflowed_; }
+  void ClearOverflow() { overflowed_ = false; }
+  void RecordOverflow() { overflowed_ = true; }
+
+ private:
+  std::string_view name_;
+  uint8_t* storage_;
+  int64_t element_size_;
+  int64_t stride_;
+  int64_t capacity_;
+  bool single_value_;
+  int64_t size_ = 0;
+  int64_t read_index_ = 0;
+  int64_t write_index_ = 0;
+  bool overflowed_ = false;
+};
+
+struct InstanceContext;
+
+// Manual vtable passed to the compiled code. Must be layout compatible with
+// xls::InstanceContextVTable (see jit_callbacks.h); the compiled code calls
+// these at fixed offsets. Only the pointer types differ: the opaque runtime
+// and events pointers are the ones this runtime passes to the compiled code.
+struct InstanceContextVTable {
+  using PerformStringStepFn = void (*)(InstanceContext* thiz, char* step_string,
+                                       std::string* buffer);
+  using PerformFormatStepFn = void (*)(InstanceContext* thiz, void* runtime,
+                                       const uint8_t* type_proto_data,
+                                       int64_t type_proto_data_size,
+                                       const uint8_t* value,
+                                       uint64_t format_u64,
+                                       std::string* buffer);
+  using RecordTraceFn = void (*)(InstanceContext* thiz, std::string* buffer,
+                                 int64_t verbosity, ProcEvents* events);
+  using CreateTraceBufferFn = std::string* (*)(InstanceContext* thiz);
+  using RecordAssertionFn = void (*)(InstanceContext* thiz, const char* msg,
+                                     ProcEvents* events);
+  using QueueReceiveWrapperFn = bool (*)(InstanceContext* thiz,
+                                         int64_t queue_index, uint8_t* buffer);
+  using QueueSendWrapperFn = void (*)(InstanceContext* thiz,
+                                      int64_t queue_index, const uint8_t* data);
+  using RecordActiveNextValueFn = void (*)(InstanceContext* thiz,
+                                           int64_t param_id, int64_t next_id);
+  using RecordNodeResultFn = void (*)(InstanceContext* thiz, int64_t node_ptr,
+                                      const uint8_t* data);
+  using RecordDeferredTraceFn =
+      void (*)(InstanceContext* thiz, const char* format, int64_t format_size,
+               const uint8_t* type_proto_data, int64_t type_proto_data_size,
+               const uint8_t* operands, int64_t operands_size,
+               int64_t verbosity, ProcEvents* events);
+
+  PerformStringStepFn perform_string_step;
+  PerformFormatStepFn perform_format_step;
+  RecordTraceFn record_trace;
+  CreateTraceBufferFn create_trace_buffer;
+  RecordAssertionFn record_assertion;
+  QueueReceiveWrapperFn queue_receive_wrapper;
+  QueueSendWrapperFn queue_send_wrapper;
+  RecordActiveNextValueFn record_active_next_value;
+  RecordNodeResultFn record_node_result;
+  RecordDeferredTraceFn record_deferred_trace;
+};
+
+// Returns the vtable implemented by this runtime.
+const InstanceContextVTable& GetInstanceContextVTable();
+
+// Context passed to the compiled code of a single proc instance. The vtable
+// must be the first member.
+struct InstanceContext {
+  InstanceContextVTable vtable;
+  // Direct queue accessors (xls::InstanceContext::channel_queue_slots). Always
+  // null so the compiled code reads and writes queues through the vtable.
+  const void* channel_queue_slots;
+  // The channel bound to each queue index of the compiled proc.
+  ChannelQueue* const* queues;
+};
+
+static_assert(offsetof(InstanceContext, vtable) == 0);
+static_assert(sizeof(InstanceContextVTable) == 10 * sizeof(void (*)()));
+
+// Signature of the compiled proc entrypoints. The same ABI as
+// xls::JitFunctionType with the XLS-specific pointer types replaced by the
+// ones of this runtime.
+using ProcEntrypointFn = int64_t (*)(const uint8_t* const* inputs,
+                                     uint8_t* const* outputs,
+                                     void* temp_buffer, ProcEvents* events,
+                                     InstanceContext* instance_context,
+                                     void* jit_runtime,
+                                     int64_t continuation_point);
+
+// Result of running a proc instance until it completes its tick or blocks.
+struct RunResult {
+  // Whether the instance completed its tick.
+  bool completed;
+  // Whether any progress (a completed tick or an operation which moved the
+  // continuation point) was made.
+  bool progress_made;
+};
+
+// A single instance of a compiled proc. Does not own any buffers: the state
+// buffers (two sets which are swapped after each tick), the temp buffer and
+// the queue array must outlive the instance.
+class ProcInstance {
+ public:
+  ProcInstance(std::string_view name, ProcEntrypointFn entrypoint,
+               uint8_t* const* input_state, uint8_t* const* output_state,
+               const int64_t* state_sizes, int64_t state_count,
+               void* temp_buffer, ChannelQueue* const* queues,
+               bool has_next_values)
+      : name_(name),
+        entrypoint_(entrypoint),
+        input_state_(input_state),
+        output_state_(output_state),
+        state_sizes_(state_sizes),
+        state_count_(state_count),
+        temp_buffer_(temp_buffer),
+        has_next_values_(has_next_values),
+        context_{GetInstanceContextVTable(), /*channel_queue_slots=*/nullptr,
+                 queues} {}
+
+  ProcInstance(const ProcInstance&) = delete;
+  ProcInstance& operator=(const ProcInstance&) = delete;
+
+  std::string_view name() const { return name_; }
+
+  // Runs the compiled code from the current continuation point until the tick
+  // completes or the proc blocks on a receive (or exits after a send).
+  RunResult Run();
+
+  bool AtStartOfTick() const { return continuation_point_ == 0; }
+
+  // The buffers holding the current value of each state element.
+  uint8_t* const* state() const { return input_state_; }
+
+  const ProcEvents& events() const { return events_; }
+  ProcEvents& events() { return events_; }
+
+ private:
+  std::string_view name_;
+  ProcEntrypointFn entrypoint_;
+  uint8_t* const* input_state_;
+  uint8_t* const* output_state_;
+  const int64_t* state_sizes_;
+  int64_t state_count_;
+  void* temp_buffer_;
+  bool has_next_values_;
+  InstanceContext context_;
+  ProcEvents events_;
+  int64_t continuation_point_ = 0;
+};
+
+// Result of ticking an entire network.
+enum class TickStatus {
+  // Every proc instance completed one tick.
+  kCompleted,
+  // No further progress can be made; some instances are blocked on receives.
+  kBlocked,
+  // A send was dropped because a channel was full.
+  kChannelOverflow,
+  // An assertion failed in one of the instances.
+  kAssertionFailed,
+};
+
+std::string_view TickStatusToString(TickStatus status);
+
+// Returns kAssertionFailed if any instance recorded an assertion failure or
+// kChannelOverflow if any channel overflowed. Returns std::nullopt otherwise.
+std::optional<TickStatus> CheckForErrors(ProcInstance* const* instances,
+                                         int64_t instance_count,
+                                         ChannelQueue* const* channels,
+                                         int64_t channel_count);
+
+}  // namespace xls::aot_standalone
+
+#endif  // XLS_JIT_AOT_STANDALONE_RUNTIME_H_
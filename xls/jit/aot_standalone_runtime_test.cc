@@ -0,0 +1,209 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/aot_standalone_runtime.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/jit/jit_callbacks.h"
+
+namespace xls::aot_standalone {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+
+// The compiled code calls into the vtable at the offsets of the JIT's
+// InstanceContextVTable so the layouts must match exactly.
+static_assert(sizeof(aot_standalone::InstanceContextVTable) ==
+              sizeof(xls::InstanceContextVTable));
+static_assert(offsetof(aot_standalone::InstanceContextVTable,
+                       perform_string_step) ==
+              xls::InstanceContext::kPerformStringStepOffset);
+static_assert(offsetof(aot_standalone::InstanceContextVTable,
+                       perform_format_step) ==
+              xls::InstanceContext::kPerformFormatStepOffset);
+static_assert(offsetof(aot_standalone::InstanceContextVTable, record_trace) ==
+              xls::InstanceContext::kRecordTraceOffset);
+static_assert(offsetof(aot_standalone::InstanceContextVTable,
+                       create_trace_buffer) ==
+              xls::InstanceContext::kCreateTraceBufferOffset);
+static_assert(offsetof(aot_standalone::InstanceContextVTable,
+                       record_assertion) ==
+              xls::InstanceContext::kRecordAssertionOffset);
+static_assert(offsetof(aot_standalone::InstanceContextVTable,
+                       queue_receive_wrapper) ==
+              xls::InstanceContext::kQueueReceiveWrapperOffset);
+static_assert(offsetof(aot_standalone::InstanceContextVTable,
+                       queue_send_wrapper) ==
+              xls::InstanceContext::kQueueSendWrapperOffset);
+static_assert(offsetof(aot_standalone::InstanceContextVTable,
+                       record_active_next_value) ==
+              xls::InstanceContext::kRecordActiveNextValueOffset);
+static_assert(offsetof(aot_standalone::InstanceContextVTable,
+                       record_node_result) ==
+              xls::InstanceContext::kRecordNodeResultOffset);
+static_assert(offsetof(aot_standalone::InstanceContextVTable,
+                       record_deferred_trace) ==
+              xls::InstanceContext::kRecordDeferredTraceOffset);
+static_assert(offsetof(aot_standalone::InstanceContext, channel_queue_slots) ==
+              xls::InstanceContext::kChannelQueueSlotsOffset);
+
+TEST(ChannelQueueTest, FifoWrapsAround) {
+  alignas(4) uint8_t storage[12];
+  ChannelQueue queue("q", storage, /*element_size=*/4, /*stride=*/4,
+                     /*capacity=*/3, /*single_value=*/false);
+  uint32_t value;
+  EXPECT_FALSE(queue.Read(reinterpret_cast<uint8_t*>(&value)));
+  for (uint32_t i = 0; i < 10; ++i) {
+    EXPECT_TRUE(queue.Write(reinterpret_cast<const uint8_t*>(&i)));
+    uint32_t next = i + 100;
+    EXPECT_TRUE(queue.Write(reinterpret_cast<const uint8_t*>(&next)));
+    EXPECT_EQ(queue.size(), 2);
+    EXPECT_TRUE(queue.Read(reinterpret_cast<uint8_t*>(&value)));
+    EXPECT_EQ(value, i);
+    EXPECT_TRUE(queue.Read(reinterpret_cast<uint8_t*>(&value)));
+    EXPECT_EQ(value, i + 100);
+    EXPECT_TRUE(queue.empty());
+  }
+}
+
+TEST(ChannelQueueTest, FullFifoRejectsWrites) {
+  alignas(8) uint8_t storage[16];
+  ChannelQueue queue("q", storage, /*element_size=*/1, /*stride=*/8,
+                     /*capacity=*/2, /*single_value=*/false);
+  uint8_t value = 1;
+  EXPECT_TRUE(queue.Write(&value));
+  EXPECT_TRUE(queue.Write(&value));
+  EXPECT_TRUE(queue.full());
+  EXPECT_FALSE(queue.Write(&value));
+  EXPECT_EQ(queue.size(), 2);
+}
+
+TEST(ChannelQueueTest, SingleValue) {
+  alignas(4) uint8_t storage[4];
+  ChannelQueue queue("q", storage, /*element_size=*/4, /*stride=*/4,
+                     /*capacity=*/1, /*single_value=*/true);
+  uint32_t value = 5;
+  EXPECT_TRUE(queue.Write(reinterpret_cast<const uint8_t*>(&value)));
+  value = 6;
+  EXPECT_TRUE(queue.Write(reinterpret_cast<const uint8_t*>(&value)));
+  uint32_t read = 0;
+  EXPECT_TRUE(queue.Read(reinterpret_cast<uint8_t*>(&read)));
+  EXPECT_EQ(read, 6);
+  read = 0;
+  EXPECT_TRUE(queue.Read(reinterpret_cast<uint8_t*>(&read)));
+  EXPECT_EQ(read, 6);
+}
+
+// Stand-in for a compiled proc which accumulates the values it receives on
+// queue 0 into its single state element and sends the sum on queue 1.
+int64_t Accumulate(const uint8_t* const* inputs, uint8_t* const* outputs,
+                   void* temp_buffer, ProcEvents* events,
+                   InstanceContext* context, void* jit_runtime,
+                   int64_t continuation_point) {
+  uint32_t value;
+  if (!context->vtable.queue_receive_wrapper(
+          context, 0, reinterpret_cast<uint8_t*>(&value))) {
+    return 1;
+  }
+  uint32_t sum = *reinterpret_cast<const uint32_t*>(inputs[0]) + value;
+  *reinterpret_cast<uint32_t*>(outputs[0]) = sum;
+  context->vtable.queue_send_wrapper(context, 1,
+                                     reinterpret_cast<const uint8_t*>(&sum));
+  std::string* buffer = context->vtable.create_trace_buffer(context);
+  char step[] = "sent";
+  context->vtable.perform_string_step(context, step, buffer);
+  context->vtable.record_trace(context, buffer, /*verbosity=*/1, events);
+  if (sum > 100) {
+    context->vtable.record_assertion(context, "too big", events);
+  }
+  return 0;
+}
+
+class ProcInstanceTest : public ::testing::Test {
+ protected:
+  alignas(4) uint8_t in_storage_[8];
+  alignas(4) uint8_t out_storage_[4];
+  ChannelQueue in_{"in", in_storage_, /*element_size=*/4, /*stride=*/4,
+                   /*capacity=*/2, /*single_value=*/false};
+  ChannelQueue out_{"out", out_storage_, /*element_size=*/4, /*stride=*/4,
+                    /*capacity=*/1, /*single_value=*/false};
+  ChannelQueue* const queues_[2] = {&in_, &out_};
+  ChannelQueue* const channels_[2] = {&in_, &out_};
+  alignas(4) uint8_t state_a_[4] = {};
+  alignas(4) uint8_t state_b_[4] = {};
+  uint8_t* const input_state_[1] = {state_a_};
+  uint8_t* const output_state_[1] = {state_b_};
+  const int64_t state_sizes_[1] = {4};
+  ProcInstance instance_{"accumulate",
+                         Accumulate,
+                         input_state_,
+                         output_state_,
+                         state_sizes_,
+                         /*state_count=*/1,
+                         /*temp_buffer=*/nullptr,
+                         queues_,
+                         /*has_next_values=*/false};
+};
+
+TEST_F(ProcInstanceTest, RunsUntilBlocked) {
+  RunResult result = instance_.Run();
+  EXPECT_FALSE(result.completed);
+  EXPECT_TRUE(result.progress_made);
+  EXPECT_FALSE(instance_.AtStartOfTick());
+  result = instance_.Run();
+  EXPECT_FALSE(result.completed);
+  EXPECT_FALSE(result.progress_made);
+
+  uint32_t value = 42;
+  EXPECT_TRUE(in_.Write(reinterpret_cast<const uint8_t*>(&value)));
+  result = instance_.Run();
+  EXPECT_TRUE(result.completed);
+  EXPECT_TRUE(instance_.AtStartOfTick());
+  EXPECT_EQ(*reinterpret_cast<const uint32_t*>(instance_.state()[0]), 42);
+  EXPECT_THAT(instance_.events().trace_msgs,
+              ElementsAre(Field(&TraceMessage::message, "sent")));
+  EXPECT_EQ(CheckForErrors(nullptr, 0, channels_, 2), std::nullopt);
+}
+
+TEST_F(ProcInstanceTest, ReportsOverflowAndAssertions) {
+  uint32_t value = 60;
+  EXPECT_TRUE(in_.Write(reinterpret_cast<const uint8_t*>(&value)));
+  EXPECT_TRUE(in_.Write(reinterpret_cast<const uint8_t*>(&value)));
+  EXPECT_TRUE(instance_.Run().completed);
+  EXPECT_THAT(instance_.events().assert_msgs, IsEmpty());
+  // The output queue only holds one element.
+  EXPECT_TRUE(instance_.Run().completed);
+  EXPECT_TRUE(out_.overflowed());
+  EXPECT_THAT(instance_.events().assert_msgs, ElementsAre("too big"));
+
+  ProcInstance* const instances[1] = {&instance_};
+  EXPECT_EQ(CheckForErrors(instances, 1, channels_, 2),
+            TickStatus::kAssertionFailed);
+  instance_.events().Clear();
+  EXPECT_EQ(CheckForErrors(instances, 1, channels_, 2),
+            TickStatus::kChannelOverflow);
+  out_.ClearOverflow();
+  EXPECT_EQ(CheckForErrors(instances, 1, channels_, 2), std::nullopt);
+}
+
+}  // namespace
+}  // namespace xls::aot_standalone
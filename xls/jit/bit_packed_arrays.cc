@@ -0,0 +1,116 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/bit_packed_arrays.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/IR/LLVMContext.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/jit/jit_layout_options.h"
+#include "xls/jit/llvm_type_converter.h"
+
+namespace xls {
+namespace {
+
+// Adds the array types contained in `type` (including `type` itself) which can
+// be bit-packed to `types`.
+void CollectPackableTypes(Type* type, absl::flat_hash_set<const Type*>& types) {
+  if (LlvmTypeConverter::CanBitPackArray(type)) {
+    types.insert(type);
+    return;
+  }
+  if (type->IsArray()) {
+    CollectPackableTypes(type->AsArrayOrDie()->element_type(), types);
+  } else if (type->IsTuple()) {
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      CollectPackableTypes(element_type, types);
+    }
+  }
+}
+
+}  // namespace
+
+bool SupportsBitPackedArrays(Node* node) {
+  switch (node->op()) {
+    case Op::kArray:
+    case Op::kArrayIndex:
+    case Op::kArrayUpdate:
+    case Op::kGate:
+    case Op::kIdentity:
+    case Op::kInvoke:
+    case Op::kLiteral:
+    case Op::kNext:
+    case Op::kParam:
+    case Op::kSel:
+    case Op::kStateRead:
+    case Op::kTuple:
+    case Op::kTupleIndex:
+      return true;
+    default:
+      return false;
+  }
+}
+
+absl::StatusOr<JitLayoutOptions> ChooseBitPackedArrayLayout(
+    Package* package, const llvm::DataLayout& data_layout,
+    int64_t min_byte_size) {
+  absl::flat_hash_set<const Type*> candidates;
+  absl::flat_hash_set<const Type*> excluded;
+  for (FunctionBase* function_base : package->GetFunctionBases()) {
+    for (Node* node : function_base->nodes()) {
+      absl::flat_hash_set<const Type*>& types =
+          SupportsBitPackedArrays(node) ? candidates : excluded;
+      CollectPackableTypes(node->GetType(), types);
+      for (Node* operand : node->operands()) {
+        CollectPackableTypes(operand->GetType(), types);
+      }
+    }
+  }
+  for (Channel* channel : package->channels()) {
+    CollectPackableTypes(channel->type(), excluded);
+  }
+
+  auto context = std::make_unique<llvm::LLVMContext>();
+  LlvmTypeConverter native_converter(context.get(), data_layout);
+  JitLayoutOptions options;
+  for (const Type* type : candidates) {
+    if (excluded.contains(type)) {
+      continue;
+    }
+    int64_t native_size = native_converter.GetTypeByteSize(type);
+    int64_t packed_size =
+        LlvmTypeConverter::GetBitPackedArrayByteSize(type->AsArrayOrDie());
+    if (native_size >= min_byte_size && packed_size < native_size) {
+      VLOG(1) << absl::StreamFormat(
+          "Bit-packing type %s: %d bytes instead of %d", type->ToString(),
+          packed_size, native_size);
+      options.packed_array_types.insert(type);
+    }
+  }
+  return options;
+}
+
+}  // namespace xls
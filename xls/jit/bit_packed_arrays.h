@@ -0,0 +1,45 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_BIT_PACKED_ARRAYS_H_
+#define XLS_JIT_BIT_PACKED_ARRAYS_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/jit/jit_layout_options.h"
+
+namespace xls {
+
+// Returns whether the JIT can compile `node` when its operands or result
+// contain bit-packed arrays. Supported nodes either treat values as opaque
+// buffers (e.g., params, state, tuples, selects and invokes) or access
+// individual array elements (array, array_index and array_update).
+bool SupportsBitPackedArrays(Node* node);
+
+// Returns layout options which bit-pack the array types of `package` whose
+// native layout under `data_layout` occupies at least `min_byte_size` bytes and
+// would shrink by packing. Types used by nodes which do not support bit-packed
+// arrays, or carried on channels, are left in the native layout so the choice
+// never prevents compilation and channel payloads keep their usual layout.
+absl::StatusOr<JitLayoutOptions> ChooseBitPackedArrayLayout(
+    Package* package, const llvm::DataLayout& data_layout,
+    int64_t min_byte_size);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_BIT_PACKED_ARRAYS_H_
@@ -0,0 +1,183 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/bit_packed_arrays.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/jit_layout_options.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+class BitPackedArraysTest : public IrTestBase {
+ protected:
+  llvm::DataLayout DataLayout() {
+    if (orc_jit_ == nullptr) {
+      orc_jit_ = OrcJit::Create().value();
+    }
+    return orc_jit_->CreateDataLayout().value();
+  }
+
+  std::unique_ptr<OrcJit> orc_jit_;
+};
+
+TEST_F(BitPackedArraysTest, TypeLayoutRoundTrip) {
+  auto package = CreatePackage();
+  ArrayType* type = package->GetArrayType(7, package->GetBitsType(5));
+  ASSERT_TRUE(LlvmTypeConverter::CanBitPackArray(type));
+  JitLayoutOptions options;
+  options.packed_array_types.insert(type);
+  orc_jit_ = OrcJit::Create().value();
+  LlvmTypeConverter converter(orc_jit_->GetContext(),
+                              orc_jit_->CreateDataLayout().value(), options);
+  EXPECT_TRUE(converter.IsBitPackedArray(type));
+  // 35 bits round up to 5 bytes plus one slack byte.
+  EXPECT_EQ(LlvmTypeConverter::GetBitPackedArrayByteSize(type), 6);
+  EXPECT_EQ(converter.GetTypeByteSize(type), 6);
+
+  TypeLayout layout = converter.CreateTypeLayout(type);
+  ASSERT_EQ(layout.elements().size(), 7);
+  EXPECT_EQ(layout.elements()[3].bit_offset, 15);
+
+  std::vector<Value> elements;
+  for (int64_t i = 0; i < 7; ++i) {
+    elements.push_back(Value(UBits(31 - 3 * i, 5)));
+  }
+  Value value = Value::ArrayOrDie(elements);
+  std::vector<uint8_t> buffer(layout.size(), 0xff);
+  layout.ValueToNativeLayout(value, buffer.data());
+  EXPECT_EQ(buffer.back(), 0);
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+}
+
+TEST_F(BitPackedArraysTest, ChooseLayout) {
+  auto package = CreatePackage();
+  Type* u3 = package->GetBitsType(3);
+  Type* u32 = package->GetBitsType(32);
+  ArrayType* packed_type = package->GetArrayType(256, u3);
+  ArrayType* small_type = package->GetArrayType(4, u3);
+  ArrayType* compared_type = package->GetArrayType(512, u3);
+  ArrayType* wide_type = package->GetArrayType(256, u32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetArrayType(300, u3)));
+
+  ProcBuilder pb(TestName(), package.get());
+  BValue packed = pb.StateElement("packed", ZeroOfType(packed_type));
+  BValue small = pb.StateElement("small", ZeroOfType(small_type));
+  BValue compared = pb.StateElement("compared", ZeroOfType(compared_type));
+  BValue wide = pb.StateElement("wide", ZeroOfType(wide_type));
+  BValue idx = pb.Literal(UBits(1, 8));
+  pb.Next(packed, pb.ArrayUpdate(packed, pb.Literal(UBits(1, 3)), {idx}));
+  pb.Next(small, pb.ArrayUpdate(small, pb.Literal(UBits(1, 3)), {idx}));
+  // Arrays compared with `eq` are not packed.
+  pb.Next(compared, compared, pb.Eq(compared, compared));
+  pb.Next(wide, wide);
+  pb.Send(ch, pb.AfterAll({}), pb.Literal(ZeroOfType(ch->type())));
+  XLS_ASSERT_OK(pb.Build().status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      JitLayoutOptions options,
+      ChooseBitPackedArrayLayout(package.get(), DataLayout(),
+                                 /*min_byte_size=*/64));
+  // The small array is below the threshold, the wide array does not shrink
+  // and the channel payload keeps the native layout.
+  EXPECT_THAT(options.packed_array_types, UnorderedElementsAre(packed_type));
+}
+
+TEST_F(BitPackedArraysTest, ProcMatchesInterpreter) {
+  auto package = CreatePackage();
+  ArrayType* array_type = package->GetArrayType(100, package->GetBitsType(3));
+  std::vector<Value> initial;
+  for (int64_t i = 0; i < 100; ++i) {
+    initial.push_back(Value(UBits(i % 8, 3)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(3)));
+
+  ProcBuilder pb(TestName(), package.get());
+  BValue array = pb.StateElement("array", Value::ArrayOrDie(initial));
+  BValue counter = pb.StateElement("counter", Value(UBits(0, 8)));
+  BValue index = pb.UMod(counter, pb.Literal(UBits(100, 8)));
+  BValue next_index = pb.UMod(pb.Add(counter, pb.Literal(UBits(37, 8))),
+                              pb.Literal(UBits(100, 8)));
+  BValue element = pb.ArrayIndex(array, {index});
+  BValue neighbor = pb.ArrayIndex(array, {next_index});
+  BValue updated =
+      pb.ArrayUpdate(array, pb.Add(element, neighbor), {next_index});
+  // Out of bounds updates are no-ops.
+  updated = pb.ArrayUpdate(updated, element, {pb.Literal(UBits(200, 8))});
+  BValue rebuilt = pb.Array({element, neighbor, element}, element.GetType());
+  pb.Send(ch, pb.AfterAll({}),
+          pb.ArrayIndex(rebuilt, {pb.Literal(UBits(1, 2))}));
+  pb.Next(array, pb.Select(pb.BitSlice(counter, 0, 1), {updated, array}));
+  pb.Next(counter, pb.Add(counter, pb.Literal(UBits(1, 8))));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      JitLayoutOptions options,
+      ChooseBitPackedArrayLayout(package.get(), DataLayout(),
+                                 /*min_byte_size=*/1));
+  EXPECT_THAT(options.packed_array_types, UnorderedElementsAre(array_type));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> interpreter,
+      CreateInterpreterSerialProcRuntime(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> jit,
+      CreateJitSerialProcRuntime(
+          package.get(),
+          EvaluatorOptions().set_jit_bit_packed_array_min_bytes(1)));
+  for (int64_t i = 0; i < 300; ++i) {
+    XLS_ASSERT_OK(interpreter->Tick());
+    XLS_ASSERT_OK(jit->Tick());
+    ASSERT_EQ(jit->ResolveState(proc), interpreter->ResolveState(proc))
+        << "tick " << i;
+    ASSERT_EQ(jit->queue_manager().GetQueue(ch).Read(),
+              interpreter->queue_manager().GetQueue(ch).Read());
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,6 +14,8 @@
 
 #include "xls/jit/block_jit.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -25,7 +27,9 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -36,6 +40,7 @@
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/materialize_fifos_pass.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/block_evaluator.h"
@@ -64,6 +69,7 @@
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -327,20 +333,23 @@ BlockJit::InterfaceMetadata::CreateFromAotEntrypoint(
 }
 
 absl::StatusOr<std::unique_ptr<BlockJit>> BlockJit::Create(
-    Block* block, bool support_observer_callbacks) {
+    Block* block, bool support_observer_callbacks,
+    NodeProfiler* node_profiler) {
   XLS_ASSIGN_OR_RETURN(BlockElaboration elab,
                        BlockElaboration::Elaborate(block));
-  return BlockJit::Create(elab, support_observer_callbacks);
+  return BlockJit::Create(elab, support_observer_callbacks, node_profiler);
 }
 
 absl::StatusOr<std::unique_ptr<BlockJit>> BlockJit::Create(
-    const BlockElaboration& elab, bool support_observer_callbacks) {
+    const BlockElaboration& elab, bool support_observer_callbacks,
+    NodeProfiler* node_profiler) {
   Block* block;
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<OrcJit> orc_jit,
       OrcJit::Create(
           LlvmCompiler::kDefaultOptLevel,
           /*include_observer_callbacks=*/support_observer_callbacks));
+  orc_jit->set_node_profiler(node_profiler);
   XLS_ASSIGN_OR_RETURN(auto data_layout, orc_jit->CreateDataLayout());
   auto jit_runtime = std::make_unique<JitRuntime>(data_layout);
   if (elab.top()->block() &&
@@ -412,9 +421,10 @@ absl::StatusOr<std::unique_ptr<BlockJit>> BlockJit::Create(
 
 /* static */ absl::StatusOr<JitObjectCode> BlockJit::CreateObjectCode(
     const BlockElaboration& elab, int64_t opt_level, bool include_msan,
-    JitObserver* obs) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<AotCompiler> comp,
-                       AotCompiler::Create(include_msan, opt_level, obs));
+    JitObserver* obs, const LlvmPgoOptions& pgo_options) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<AotCompiler> comp,
+      AotCompiler::Create(include_msan, opt_level, obs, pgo_options));
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout, comp->CreateDataLayout());
   // NB We could avoid doing a package clone if there are no instantations but
   // since this is aot anyway its easier to just not bother. The cloned package
@@ -440,6 +450,16 @@ absl::StatusOr<std::unique_ptr<BlockJit>> BlockJit::Create(
   };
 }
 
+/* static */ std::vector<TypeLayout> BlockJit::CreateLayouts(
+    absl::Span<Type* const> types, JitRuntime* runtime) {
+  std::vector<TypeLayout> layouts;
+  layouts.reserve(types.size());
+  for (Type* type : types) {
+    layouts.push_back(runtime->CreateTypeLayout(type));
+  }
+  return layouts;
+}
+
 std::unique_ptr<BlockJitContinuation> BlockJit::NewContinuation() {
   return std::unique_ptr<BlockJitContinuation>(
       new BlockJitContinuation(metadata_, this, function_));
@@ -456,6 +476,132 @@ absl::Status BlockJit::RunOneCycle(BlockJitContinuation& continuation) {
   return absl::OkStatus();
 }
 
+BlockJitPortStream::BlockJitPortStream(absl::Span<const TypeLayout> layouts,
+                                       absl::Span<const int64_t> sizes,
+                                       absl::Span<const int64_t> alignments,
+                                       int64_t cycle_count)
+    : layouts_(layouts), cycle_count_(cycle_count) {
+  CHECK_EQ(layouts.size(), sizes.size());
+  CHECK_EQ(layouts.size(), alignments.size());
+  int64_t max_align = 1;
+  int64_t offset = 0;
+  offsets_.reserve(sizes.size());
+  for (int64_t i = 0; i < sizes.size(); ++i) {
+    offset = RoundUpToNearest(offset, alignments[i]);
+    offsets_.push_back(offset);
+    offset += sizes[i];
+    max_align = std::max(max_align, alignments[i]);
+  }
+  cycle_stride_ = RoundUpToNearest(offset, max_align);
+  int64_t total_size = cycle_stride_ * cycle_count_;
+  if (total_size > 0) {
+    data_.reset(
+        absl::bit_cast<uint8_t*>(AllocateAligned(max_align, total_size)));
+    CHECK(data_ != nullptr) << "Unable to allocate. align: " << max_align
+                            << " size: " << total_size;
+    // The jit requires padding bits to be zero.
+    memset(data_.get(), 0, total_size);
+  }
+}
+
+absl::Status BlockJitPortStream::SetValues(
+    int64_t cycle, absl::Span<const Value> values) const {
+  XLS_RET_CHECK(cycle >= 0 && cycle < cycle_count_) << cycle;
+  XLS_RET_CHECK_EQ(values.size(), port_count());
+  for (int64_t i = 0; i < port_count(); ++i) {
+    XLS_RET_CHECK(ValueConformsToType(values[i], layouts_[i].type()))
+        << "Value " << values[i] << " does not match type "
+        << layouts_[i].type()->ToString() << " of port " << i;
+    layouts_[i].ValueToNativeLayout(values[i], GetPointer(cycle, i));
+  }
+  return absl::OkStatus();
+}
+
+std::vector<Value> BlockJitPortStream::GetValues(int64_t cycle) const {
+  std::vector<Value> values;
+  values.reserve(port_count());
+  for (int64_t i = 0; i < port_count(); ++i) {
+    values.push_back(layouts_[i].NativeLayoutToValue(GetPointer(cycle, i)));
+  }
+  return values;
+}
+
+BlockJitPortStream BlockJit::CreateInputPortStream(int64_t cycle_count) const {
+  return BlockJitPortStream(
+      input_port_layouts_, input_port_sizes(),
+      absl::MakeConstSpan(function_.input_buffer_preferred_alignments())
+          .subspan(0, metadata_.InputPortCount()),
+      cycle_count);
+}
+
+BlockJitPortStream BlockJit::CreateOutputPortStream(int64_t cycle_count) const {
+  return BlockJitPortStream(
+      output_port_layouts_,
+      absl::MakeConstSpan(function_.output_buffer_sizes())
+          .subspan(0, metadata_.OutputPortCount()),
+      absl::MakeConstSpan(function_.output_buffer_preferred_alignments())
+          .subspan(0, metadata_.OutputPortCount()),
+      cycle_count);
+}
+
+absl::Status BlockJit::RunCycles(BlockJitContinuation& continuation,
+                                 const BlockJitPortStream& inputs,
+                                 const BlockJitPortStream& outputs) {
+  XLS_RET_CHECK(inputs.layouts_.data() == input_port_layouts_.data() &&
+                outputs.layouts_.data() == output_port_layouts_.data())
+      << "Streams must be created by this jit";
+  XLS_RET_CHECK_GE(outputs.cycle_count(), inputs.cycle_count());
+  const int64_t num_cycles = inputs.cycle_count();
+  if (num_cycles == 0) {
+    return absl::OkStatus();
+  }
+  const int64_t num_input_ports = metadata_.InputPortCount();
+  const int64_t num_output_ports = metadata_.OutputPortCount();
+
+  // The continuation alternates between two sets of register buffers. Copy
+  // the argument pointer arrays of both so the port pointers can be redirected
+  // into the streams while the register pointers are left as is.
+  std::array<std::vector<const uint8_t*>, 2> input_ptrs;
+  std::array<std::vector<uint8_t*>, 2> output_ptrs;
+  for (int64_t side = 0; side < 2; ++side) {
+    input_ptrs[side].assign(continuation.function_inputs().begin(),
+                            continuation.function_inputs().end());
+    output_ptrs[side].assign(continuation.function_outputs().begin(),
+                             continuation.function_outputs().end());
+    continuation.SwapRegisters();
+  }
+
+  for (int64_t cycle = 0; cycle < num_cycles; ++cycle) {
+    std::vector<const uint8_t*>& cycle_inputs = input_ptrs[cycle % 2];
+    std::vector<uint8_t*>& cycle_outputs = output_ptrs[cycle % 2];
+    for (int64_t i = 0; i < num_input_ports; ++i) {
+      cycle_inputs[i] = inputs.GetPointer(cycle, i);
+    }
+    for (int64_t i = 0; i < num_output_ports; ++i) {
+      cycle_outputs[i] = outputs.GetPointer(cycle, i);
+    }
+    function_.RunUnalignedJittedFunction</*kForceZeroCopy=*/true>(
+        cycle_inputs.data(), cycle_outputs.data(),
+        continuation.temp_buffer_.get(), &continuation.GetEvents(),
+        /*instance_context=*/&continuation.callbacks_, runtime_.get(),
+        /*continuation=*/0);
+    continuation.SwapRegisters();
+  }
+
+  // Leave the ports of the last cycle in the continuation as RunOneCycle
+  // would.
+  for (int64_t i = 0; i < num_input_ports; ++i) {
+    memcpy(continuation.input_port_pointers()[i],
+           inputs.GetPointer(num_cycles - 1, i), input_port_sizes()[i]);
+  }
+  for (int64_t i = 0; i < num_output_ports; ++i) {
+    memcpy(continuation.function_outputs()[i],
+           outputs.GetPointer(num_cycles - 1, i),
+           function_.output_buffer_sizes()[i]);
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<JitArgumentSet> BlockJitContinuation::CombineBuffers(
     const JittedFunctionBase& jit_func, const JitArgumentSet& left,
     int64_t left_count, const JitArgumentSet& rest, int64_t rest_start,
@@ -797,7 +943,8 @@ JitBlockEvaluator::MakeNewContinuation(
   XLS_ASSIGN_OR_RETURN(
       auto jit,
       BlockJit::Create(elaboration,
-                       /*support_observer_callbacks=*/supports_observer_));
+                       /*support_observer_callbacks=*/supports_observer_,
+                       node_profiler_));
   auto jit_cont = jit->NewContinuation();
   XLS_RETURN_IF_ERROR(jit_cont->SetRegisters(initial_registers));
   return std::make_unique<BlockContinuationJitWrapper>(std::move(jit_cont),
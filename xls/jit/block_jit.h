@@ -43,11 +43,57 @@
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/llvm_compiler.h"
+#include "xls/jit/native_layout_view.h"
+#include "xls/jit/node_profiler.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
+// A packed buffer holding the values of a set of block ports (either all the
+// input ports or all the output ports) for each of a sequence of cycles. The
+// values are stored in the native layout used by the jit so BlockJit::RunCycles
+// can pass them to the jitted code without any copies.
+class BlockJitPortStream {
+ public:
+  BlockJitPortStream(BlockJitPortStream&&) = default;
+  BlockJitPortStream& operator=(BlockJitPortStream&&) = default;
+
+  int64_t cycle_count() const { return cycle_count_; }
+  int64_t port_count() const { return offsets_.size(); }
+
+  // Returns a pointer to the value of port `port` in cycle `cycle`.
+  uint8_t* GetPointer(int64_t cycle, int64_t port) const {
+    return data_.get() + cycle * cycle_stride_ + offsets_[port];
+  }
+
+  // Returns a view of the value of port `port` in cycle `cycle`.
+  MutableNativeLayoutView GetView(int64_t cycle, int64_t port) const {
+    return MutableNativeLayoutView(&layouts_[port], GetPointer(cycle, port));
+  }
+
+  // Sets (or gets) the values of all the ports in cycle `cycle`.
+  absl::Status SetValues(int64_t cycle, absl::Span<const Value> values) const;
+  std::vector<Value> GetValues(int64_t cycle) const;
+
+ private:
+  BlockJitPortStream(absl::Span<const TypeLayout> layouts,
+                     absl::Span<const int64_t> sizes,
+                     absl::Span<const int64_t> alignments, int64_t cycle_count);
+
+  absl::Span<const TypeLayout> layouts_;
+  int64_t cycle_count_;
+  // Offset of each port's value from the start of the cycle's values.
+  std::vector<int64_t> offsets_;
+  // Distance in bytes between the values of consecutive cycles.
+  int64_t cycle_stride_;
+  std::unique_ptr<uint8_t[], DeleteAligned> data_;
+
+  friend class BlockJit;
+};
+
 class BlockJitContinuation;
 class BlockJit {
  public:
@@ -72,10 +118,14 @@ class BlockJit {
     int64_t RegisterCount() const { return register_names.size(); }
   };
 
+  // If `node_profiler` is given the compiled code records the cycles spent in
+  // each node into it; it must outlive the returned object.
   static absl::StatusOr<std::unique_ptr<BlockJit>> Create(
-      Block* block, bool support_observer_callbacks = false);
+      Block* block, bool support_observer_callbacks = false,
+      NodeProfiler* node_profiler = nullptr);
   static absl::StatusOr<std::unique_ptr<BlockJit>> Create(
-      const BlockElaboration& elab, bool support_observer_callbacks = false);
+      const BlockElaboration& elab, bool support_observer_callbacks = false,
+      NodeProfiler* node_profiler = nullptr);
 
   static absl::StatusOr<std::unique_ptr<BlockJit>> CreateFromAot(
       const AotEntrypointProto& entrypoint, std::string_view data_layout,
@@ -84,7 +134,7 @@ class BlockJit {
   // Returns the bytes of an object file containing the compiled XLS function.
   static absl::StatusOr<JitObjectCode> CreateObjectCode(
       const BlockElaboration& elab, int64_t opt_level, bool include_msan,
-      JitObserver* obs);
+      JitObserver* obs, const LlvmPgoOptions& pgo_options = LlvmPgoOptions());
 
   virtual ~BlockJit() = default;
 
@@ -95,6 +145,22 @@ class BlockJit {
   // Runs a single cycle of a block with the given continuation.
   virtual absl::Status RunOneCycle(BlockJitContinuation& continuation);
 
+  // Creates streams with space for the input (or output) port values of
+  // `cycle_count` cycles for use with RunCycles.
+  BlockJitPortStream CreateInputPortStream(int64_t cycle_count) const;
+  BlockJitPortStream CreateOutputPortStream(int64_t cycle_count) const;
+
+  // Runs `inputs.cycle_count()` cycles of the block with the given
+  // continuation. Cycle `i` reads its input ports from cycle `i` of `inputs`
+  // and writes its output ports to cycle `i` of `outputs` which must have (at
+  // least) as many cycles. The port values are passed to the jitted code in
+  // place and registers stay in the continuation's buffers, so no values are
+  // converted or copied between cycles. Afterwards the continuation's input
+  // and output ports hold the values of the last cycle.
+  absl::Status RunCycles(BlockJitContinuation& continuation,
+                         const BlockJitPortStream& inputs,
+                         const BlockJitPortStream& outputs);
+
   OrcJit& orc_jit() const { return *jit_; }
 
   JitRuntime* runtime() const { return runtime_.get(); }
@@ -111,6 +177,18 @@ class BlockJit {
         .subspan(metadata_.InputPortCount());
   }
 
+  // Get the native layouts of the values of the input ports, output ports and
+  // registers.
+  absl::Span<const TypeLayout> input_port_layouts() const {
+    return input_port_layouts_;
+  }
+  absl::Span<const TypeLayout> output_port_layouts() const {
+    return output_port_layouts_;
+  }
+  absl::Span<const TypeLayout> register_layouts() const {
+    return register_layouts_;
+  }
+
   bool supports_observer() const { return supports_observer_; }
 
  protected:
@@ -121,13 +199,25 @@ class BlockJit {
         runtime_(std::move(runtime)),
         jit_(std::move(jit)),
         function_(std::move(function)),
-        supports_observer_(supports_observer) {}
+        supports_observer_(supports_observer),
+        input_port_layouts_(
+            CreateLayouts(metadata_.input_port_types, runtime_.get())),
+        output_port_layouts_(
+            CreateLayouts(metadata_.output_port_types, runtime_.get())),
+        register_layouts_(
+            CreateLayouts(metadata_.register_types, runtime_.get())) {}
+
+  static std::vector<TypeLayout> CreateLayouts(absl::Span<Type* const> types,
+                                               JitRuntime* runtime);
 
   InterfaceMetadata metadata_;
   std::unique_ptr<JitRuntime> runtime_;
   std::unique_ptr<OrcJit> jit_;
   JittedFunctionBase function_;
   bool supports_observer_;
+  std::vector<TypeLayout> input_port_layouts_;
+  std::vector<TypeLayout> output_port_layouts_;
+  std::vector<TypeLayout> register_layouts_;
 };
 
 class BlockJitContinuation {
@@ -230,6 +320,23 @@ class BlockJitContinuation {
                                       /*len=*/metadata_.OutputPortCount());
   }
 
+  // Gets views of the input port (or register) values for the next cycle.
+  // Writing through the views sets the port (or register) in place without
+  // constructing Values.
+  MutableNativeLayoutView GetInputPortView(int64_t index) const {
+    return MutableNativeLayoutView(&block_jit_->input_port_layouts()[index],
+                                   input_port_pointers()[index]);
+  }
+  MutableNativeLayoutView GetRegisterView(int64_t index) const {
+    return MutableNativeLayoutView(&block_jit_->register_layouts()[index],
+                                   register_pointers()[index]);
+  }
+  // Gets a view of the value of an output port after the last cycle.
+  NativeLayoutView GetOutputPortView(int64_t index) const {
+    return NativeLayoutView(&block_jit_->output_port_layouts()[index],
+                            output_port_pointers()[index]);
+  }
+
   const InterpreterEvents& GetEvents() const { return events_; }
   InterpreterEvents& GetEvents() { return events_; }
   void ClearEvents() { events_.Clear(); }
@@ -314,12 +421,15 @@ class BlockJitContinuation {
 };
 
 // A jit block evaluator that tries to use the jit's register saving as
-// possible.
+// possible. If `node_profiler` is given the blocks it compiles record the
+// cycles spent in each node into it.
 class JitBlockEvaluator : public BlockEvaluator {
  public:
-  explicit constexpr JitBlockEvaluator(bool supports_observer = false)
+  explicit constexpr JitBlockEvaluator(bool supports_observer = false,
+                                       NodeProfiler* node_profiler = nullptr)
       : BlockEvaluator(supports_observer ? "ObservableJit" : "Jit"),
-        supports_observer_(supports_observer) {}
+        supports_observer_(supports_observer),
+        node_profiler_(node_profiler) {}
   absl::StatusOr<JitRuntime*> GetRuntime(BlockContinuation* cont) const;
 
  protected:
@@ -330,6 +440,7 @@ class JitBlockEvaluator : public BlockEvaluator {
 
  private:
   bool supports_observer_;
+  NodeProfiler* node_profiler_;
 };
 
 inline constexpr JitBlockEvaluator kJitBlockEvaluator(false);
@@ -40,6 +40,7 @@
 #include "xls/ir/register.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_view.h"
+#include "xls/jit/native_layout_view.h"
 
 namespace xls {
 namespace {
@@ -216,6 +217,107 @@ TEST_F(BlockJitTest, SetRegistersWithViews) {
                   testing::Pair("test2", Value(UBits(0, 16)))));
 }
 
+TEST_F(BlockJitTest, PortsAndRegistersWithNativeLayoutViews) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  Type* tuple_type = p->GetTupleType(
+      {p->GetBitsType(8), p->GetArrayType(2, p->GetBitsType(24))});
+  XLS_ASSERT_OK_AND_ASSIGN(auto r,
+                           bb.block()->AddRegister("acc", p->GetBitsType(24)));
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  auto input = bb.InputPort("input", tuple_type);
+  auto read = bb.RegisterRead(r);
+  auto array = bb.TupleIndex(input, 1);
+  auto sum = bb.Add(bb.ArrayIndex(array, {bb.Literal(UBits(0, 1))}),
+                    bb.ArrayIndex(array, {bb.Literal(UBits(1, 1))}));
+  bb.RegisterWrite(r, bb.Add(read, sum));
+  bb.OutputPort("tag", bb.TupleIndex(input, 0));
+  bb.OutputPort("acc", read);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  ASSERT_EQ(jit->input_port_layouts().size(), 1);
+  EXPECT_EQ(jit->input_port_layouts()[0].size(), jit->input_port_sizes()[0]);
+
+  cont->GetRegisterView(0).SetUint64(100);
+  MutableNativeLayoutView input_view = cont->GetInputPortView(0);
+  input_view.mutable_element(0).SetUint64(7);
+  input_view.mutable_element(1).mutable_element(0).SetUint64(20);
+  input_view.mutable_element(1).mutable_element(1).SetUint64(22);
+  XLS_ASSERT_OK(jit->RunOneCycle(*cont));
+
+  absl::flat_hash_map<std::string, int64_t> outputs =
+      cont->GetOutputPortIndices();
+  EXPECT_EQ(cont->GetOutputPortView(outputs.at("tag")).GetUint64(), 7);
+  EXPECT_EQ(cont->GetOutputPortView(outputs.at("acc")).GetUint64(), 100);
+  EXPECT_EQ(cont->GetRegisterView(0).GetUint64(), 142);
+  EXPECT_THAT(cont->GetRegisters(), ElementsAre(Value(UBits(142, 24))));
+}
+
+TEST_F(BlockJitTest, RunCyclesMatchesRunOneCycle) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(auto r,
+                           bb.block()->AddRegister("acc", p->GetBitsType(32)));
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  auto tag = bb.InputPort("tag", p->GetBitsType(8));
+  auto value = bb.InputPort("value", p->GetBitsType(32));
+  auto read = bb.RegisterRead(r);
+  bb.RegisterWrite(r, bb.Add(read, value));
+  bb.OutputPort("tag_out", bb.Not(tag));
+  bb.OutputPort("acc", read);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto single = jit->NewContinuation();
+  auto multi = jit->NewContinuation();
+  XLS_ASSERT_OK(single->SetRegisters({Value(UBits(3, 32))}));
+  XLS_ASSERT_OK(multi->SetRegisters({Value(UBits(3, 32))}));
+
+  // Use an odd number of cycles so the registers end up in the other buffer.
+  constexpr int64_t kCycles = 7;
+  BlockJitPortStream inputs = jit->CreateInputPortStream(kCycles);
+  BlockJitPortStream outputs = jit->CreateOutputPortStream(kCycles);
+  EXPECT_EQ(inputs.port_count(), 2);
+  EXPECT_EQ(outputs.port_count(), 2);
+  for (int64_t cycle = 0; cycle < kCycles; ++cycle) {
+    XLS_ASSERT_OK(
+        inputs.SetValues(cycle, {Value(UBits(cycle, 8)),
+                                 Value(UBits(1000 * (cycle + 1), 32))}));
+  }
+  XLS_ASSERT_OK(jit->RunCycles(*multi, inputs, outputs));
+
+  for (int64_t cycle = 0; cycle < kCycles; ++cycle) {
+    XLS_ASSERT_OK(single->SetInputPorts(inputs.GetValues(cycle)));
+    XLS_ASSERT_OK(jit->RunOneCycle(*single));
+    EXPECT_EQ(outputs.GetValues(cycle), single->GetOutputPorts())
+        << "cycle " << cycle;
+  }
+  EXPECT_EQ(outputs.GetView(kCycles - 1, 0).GetUint64(),
+            static_cast<uint8_t>(~(kCycles - 1)));
+  EXPECT_EQ(multi->GetRegisters(), single->GetRegisters());
+  EXPECT_EQ(multi->GetOutputPorts(), single->GetOutputPorts());
+
+  // Single cycles continue from where RunCycles left off.
+  XLS_ASSERT_OK(jit->RunOneCycle(*multi));
+  XLS_ASSERT_OK(jit->RunOneCycle(*single));
+  EXPECT_EQ(multi->GetRegisters(), single->GetRegisters());
+  EXPECT_EQ(multi->GetOutputPorts(), single->GetOutputPorts());
+}
+
+TEST_F(BlockJitTest, RunCyclesRejectsShortOutputStream) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  bb.OutputPort("out", bb.InputPort("in", p->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  EXPECT_THAT(jit->RunCycles(*cont, jit->CreateInputPortStream(4),
+                             jit->CreateOutputPortStream(3)),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
 TEST_F(BlockJitTest, ExternInstantiationIsAnError) {
   auto p = CreatePackage();
   FunctionBuilder fb("extern_target", p.get());
@@ -0,0 +1,260 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/channel_stream.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/error_code_to_status.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
+#include "xls/jit/type_layout.pb.h"
+
+namespace xls {
+namespace {
+
+constexpr std::array<char, 8> kMagic = {'X', 'L', 'S', 'C',
+                                        'H', 'S', 'T', 'M'};
+constexpr uint32_t kVersion = 1;
+
+// Alignment of the first element in the file. Chosen so the mapped elements
+// satisfy the alignment of any scalar type.
+constexpr int64_t kDataAlignment = 64;
+
+struct StreamHeader {
+  std::array<char, 8> magic;
+  uint32_t version;
+  // Size of the serialized TypeLayoutProto which immediately follows the
+  // header.
+  uint32_t layout_proto_size;
+  int64_t element_stride;
+  int64_t element_count;
+  int64_t data_offset;
+};
+static_assert(sizeof(StreamHeader) == 40);
+
+absl::Status CheckLayoutsMatch(const TypeLayoutProto& stream_layout,
+                               const TypeLayout& layout,
+                               const std::filesystem::path& path) {
+  TypeLayoutProto expected = layout.ToProto();
+  bool match = stream_layout.type() == expected.type() &&
+               stream_layout.size() == expected.size() &&
+               stream_layout.elements_size() == expected.elements_size();
+  for (int64_t i = 0; match && i < expected.elements_size(); ++i) {
+    const ElementLayoutProto& a = stream_layout.elements(i);
+    const ElementLayoutProto& b = expected.elements(i);
+    match = a.offset() == b.offset() && a.data_size() == b.data_size() &&
+            a.padded_size() == b.padded_size();
+  }
+  if (!match) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel stream `%s` holds values of type %s (size %d) which does not "
+        "match the expected layout of type %s (size %d)",
+        path.string(), stream_layout.type(), stream_layout.size(),
+        expected.type(), expected.size()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<ChannelStreamReader>>
+ChannelStreamReader::Open(const std::filesystem::path& path,
+                          const TypeLayout& layout) {
+  FileDescriptor fd(open(path.c_str(), O_RDONLY));
+  if (fd.get() < 0) {
+    return ErrnoToStatus(errno) << "Unable to open channel stream "
+                                << path.string();
+  }
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0) {
+    return ErrnoToStatus(errno) << "Unable to stat channel stream "
+                                << path.string();
+  }
+  int64_t file_size = st.st_size;
+  if (file_size < static_cast<int64_t>(sizeof(StreamHeader))) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel stream `%s` is too small to hold a header", path.string()));
+  }
+  void* mapping =
+      mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd.get(), /*offset=*/0);
+  if (mapping == MAP_FAILED) {
+    return ErrnoToStatus(errno) << "Unable to map channel stream "
+                                << path.string();
+  }
+  uint8_t* bytes = static_cast<uint8_t*>(mapping);
+  auto fail = [&](std::string_view message) {
+    munmap(mapping, file_size);
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid channel stream `%s`: %s", path.string(), message));
+  };
+
+  StreamHeader header;
+  memcpy(&header, bytes, sizeof(header));
+  if (header.magic != kMagic) {
+    return fail("bad magic number");
+  }
+  if (header.version != kVersion) {
+    return fail(absl::StrFormat("unsupported version %d", header.version));
+  }
+  int64_t layout_end = sizeof(StreamHeader) + header.layout_proto_size;
+  if (header.data_offset < layout_end || header.data_offset > file_size) {
+    return fail("bad data offset");
+  }
+  TypeLayoutProto layout_proto;
+  if (!layout_proto.ParseFromArray(bytes + sizeof(StreamHeader),
+                                   header.layout_proto_size)) {
+    return fail("unable to parse type layout");
+  }
+  absl::Status layout_status = CheckLayoutsMatch(layout_proto, layout, path);
+  if (!layout_status.ok()) {
+    munmap(mapping, file_size);
+    return layout_status;
+  }
+  if (header.element_stride < std::max(layout.size(), int64_t{1}) ||
+      header.element_count < 0 ||
+      header.element_count >
+          (file_size - header.data_offset) / header.element_stride) {
+    return fail(absl::StrFormat(
+        "%d elements of stride %d do not fit in the file",
+        header.element_count, header.element_stride));
+  }
+  // Reads of the stream are sequential.
+  madvise(mapping, file_size, MADV_SEQUENTIAL);
+  return absl::WrapUnique(new ChannelStreamReader(
+      layout, bytes, file_size, header.data_offset, header.element_stride,
+      header.element_count));
+}
+
+ChannelStreamReader::~ChannelStreamReader() {
+  munmap(mapping_, mapping_size_);
+}
+
+void ChannelStreamReader::ReleaseBefore(int64_t index) {
+  static const int64_t kPageSize = sysconf(_SC_PAGESIZE);
+  int64_t offset =
+      FloorOfRatio(static_cast<int64_t>(element(index) - mapping_), kPageSize) *
+      kPageSize;
+  if (offset > released_offset_) {
+    madvise(mapping_ + released_offset_, offset - released_offset_,
+            MADV_DONTNEED);
+    released_offset_ = offset;
+  }
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<ChannelStreamWriter>>
+ChannelStreamWriter::Create(const std::filesystem::path& path,
+                            const TypeLayout& layout) {
+  XLS_ASSIGN_OR_RETURN(FileStream file, FileStream::Open(path, "wb"));
+  TypeLayoutProto layout_proto = layout.ToProto();
+  int64_t element_stride = std::max(
+      int64_t{1},
+      RoundUpToNearest(layout.size(),
+                       static_cast<int64_t>(alignof(std::max_align_t))));
+  int64_t data_offset = RoundUpToNearest(
+      static_cast<int64_t>(sizeof(StreamHeader) + layout_proto.ByteSizeLong()),
+      kDataAlignment);
+  auto writer = absl::WrapUnique(
+      new ChannelStreamWriter(layout, std::move(file), std::move(layout_proto),
+                              element_stride, data_offset));
+  XLS_RETURN_IF_ERROR(writer->WriteHeader());
+  return writer;
+}
+
+ChannelStreamWriter::~ChannelStreamWriter() {
+  if (!closed_) {
+    Close().IgnoreError();
+  }
+}
+
+absl::Status ChannelStreamWriter::WriteHeader() {
+  StreamHeader header;
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.layout_proto_size = layout_proto_.ByteSizeLong();
+  header.element_stride = element_stride_;
+  header.element_count = element_count_;
+  header.data_offset = data_offset_;
+  std::string prefix(data_offset_, '\0');
+  memcpy(prefix.data(), &header, sizeof(header));
+  XLS_RET_CHECK(layout_proto_.SerializeToArray(
+      prefix.data() + sizeof(header), header.layout_proto_size));
+  if (fseek(file_.get(), 0, SEEK_SET) != 0 ||
+      fwrite(prefix.data(), 1, prefix.size(), file_.get()) != prefix.size()) {
+    return ErrnoToStatus(errno) << "Unable to write channel stream header to "
+                                << file_.path().string();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ChannelStreamWriter::Write(const uint8_t* data, int64_t count,
+                                        int64_t stride) {
+  XLS_RET_CHECK(!closed_) << "Channel stream is closed";
+  static constexpr std::array<uint8_t, alignof(std::max_align_t)> kZeros = {};
+  size_t size = layout_.size();
+  size_t padding = element_stride_ - layout_.size();
+  for (int64_t i = 0; i < count; ++i) {
+    if (fwrite(data + i * stride, 1, size, file_.get()) != size ||
+        fwrite(kZeros.data(), 1, padding, file_.get()) != padding) {
+      return ErrnoToStatus(errno) << "Unable to write to channel stream "
+                                  << file_.path().string();
+    }
+  }
+  element_count_ += count;
+  return absl::OkStatus();
+}
+
+absl::Status ChannelStreamWriter::WriteValue(const Value& value) {
+  std::vector<uint8_t> buffer(layout_.size());
+  layout_.ValueToNativeLayout(value, buffer.data());
+  return Write(buffer.data(), /*count=*/1, /*stride=*/layout_.size());
+}
+
+absl::Status ChannelStreamWriter::Close() {
+  XLS_RET_CHECK(!closed_) << "Channel stream is already closed";
+  closed_ = true;
+  XLS_RETURN_IF_ERROR(WriteHeader());
+  if (fflush(file_.get()) != 0) {
+    return ErrnoToStatus(errno) << "Unable to flush channel stream "
+                                << file_.path().string();
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,162 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_CHANNEL_STREAM_H_
+#define XLS_JIT_CHANNEL_STREAM_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
+#include "xls/jit/type_layout.pb.h"
+
+namespace xls {
+
+// Channel streams are binary files holding a sequence of values of a single
+// XLS type stored in the native layout used by the JIT. They allow long
+// sequences of channel values to be fed to (and collected from) a proc
+// simulation without parsing text and without holding the sequence in memory.
+//
+// A stream file consists of:
+//
+//   * A fixed-size header: an 8-byte magic string, a version number, the
+//     size of the serialized TypeLayoutProto, the distance in bytes between
+//     consecutive elements, the number of elements and the offset of the first
+//     element. Integers are stored in the byte order of the host.
+//   * A serialized TypeLayoutProto describing the layout of each element.
+//   * Zero padding up to the (aligned) offset of the first element.
+//   * The elements, each padded with zeros to the element stride.
+//
+// Because the layout is the JIT's native layout, streams are only portable
+// between hosts with the same data layout. Readers verify the stored layout
+// matches the layout they expect.
+
+// Read-only view of a channel stream file which is memory-mapped so elements
+// are paged in on demand.
+class ChannelStreamReader {
+ public:
+  // Opens and maps the stream at `path`. Returns an error if the file is not a
+  // valid stream or if the layout stored in the stream is not `layout`.
+  static absl::StatusOr<std::unique_ptr<ChannelStreamReader>> Open(
+      const std::filesystem::path& path, const TypeLayout& layout);
+
+  ~ChannelStreamReader();
+
+  ChannelStreamReader(const ChannelStreamReader&) = delete;
+  ChannelStreamReader& operator=(const ChannelStreamReader&) = delete;
+
+  int64_t element_count() const { return element_count_; }
+
+  // The distance in bytes between consecutive elements.
+  int64_t element_stride() const { return element_stride_; }
+
+  // Returns a pointer to the `index`-th element. Element `index + i` is at
+  // `element(index) + i * element_stride()`.
+  const uint8_t* element(int64_t index) const {
+    return data_ + index * element_stride_;
+  }
+
+  // Returns the `index`-th element as a Value.
+  Value GetValue(int64_t index) const {
+    return layout_.NativeLayoutToValue(element(index));
+  }
+
+  // Tells the kernel the pages holding elements before `index` are no longer
+  // needed so a sequential scan of the stream does not grow the resident set
+  // without bound. The elements remain readable.
+  void ReleaseBefore(int64_t index);
+
+ private:
+  ChannelStreamReader(const TypeLayout& layout, uint8_t* mapping,
+                      int64_t mapping_size, int64_t data_offset,
+                      int64_t element_stride, int64_t element_count)
+      : layout_(layout),
+        mapping_(mapping),
+        mapping_size_(mapping_size),
+        data_(mapping + data_offset),
+        element_stride_(element_stride),
+        element_count_(element_count) {}
+
+  TypeLayout layout_;
+  uint8_t* mapping_;
+  int64_t mapping_size_;
+  const uint8_t* data_;
+  int64_t element_stride_;
+  int64_t element_count_;
+  // Offset into the mapping of the first byte not yet released.
+  int64_t released_offset_ = 0;
+};
+
+// Writes a channel stream file. Elements are appended with buffered writes and
+// the header is finalized by `Close`.
+class ChannelStreamWriter {
+ public:
+  // Creates (or truncates) the stream at `path` holding values with the given
+  // layout.
+  static absl::StatusOr<std::unique_ptr<ChannelStreamWriter>> Create(
+      const std::filesystem::path& path, const TypeLayout& layout);
+
+  // Discards any error when closing. Call `Close` to check for errors.
+  ~ChannelStreamWriter();
+
+  ChannelStreamWriter(const ChannelStreamWriter&) = delete;
+  ChannelStreamWriter& operator=(const ChannelStreamWriter&) = delete;
+
+  // Appends `count` elements in native layout. Element `i` is read from
+  // `data + i * stride`.
+  absl::Status Write(const uint8_t* data, int64_t count, int64_t stride);
+
+  // Appends `value` which must be of the stream's type.
+  absl::Status WriteValue(const Value& value);
+
+  int64_t element_count() const { return element_count_; }
+
+  // The distance in bytes between consecutive elements in the file.
+  int64_t element_stride() const { return element_stride_; }
+
+  // Writes the final header and closes the file. No elements may be written
+  // after closing.
+  absl::Status Close();
+
+ private:
+  ChannelStreamWriter(const TypeLayout& layout, FileStream file,
+                      TypeLayoutProto layout_proto, int64_t element_stride,
+                      int64_t data_offset)
+      : layout_(layout),
+        file_(std::move(file)),
+        layout_proto_(std::move(layout_proto)),
+        element_stride_(element_stride),
+        data_offset_(data_offset) {}
+
+  // Writes the header and layout proto at the start of the file.
+  absl::Status WriteHeader();
+
+  TypeLayout layout_;
+  FileStream file_;
+  TypeLayoutProto layout_proto_;
+  int64_t element_stride_;
+  int64_t data_offset_;
+  int64_t element_count_ = 0;
+  bool closed_ = false;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_CHANNEL_STREAM_H_
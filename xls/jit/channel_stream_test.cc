@@ -0,0 +1,187 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/channel_stream.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+TypeLayout CreateTypeLayout(Type* type) {
+  std::unique_ptr<OrcJit> orc_jit = OrcJit::Create().value();
+  LlvmTypeConverter type_converter(orc_jit->GetContext(),
+                                   orc_jit->CreateDataLayout().value());
+  return type_converter.CreateTypeLayout(type);
+}
+
+class ChannelStreamTest : public ::testing::Test {
+ protected:
+  Type* ParseType(std::string_view type_str) {
+    return Parser::ParseType(type_str, &package_).value();
+  }
+
+  Package package_{"test"};
+};
+
+TEST_F(ChannelStreamTest, RoundTripValues) {
+  absl::BitGen bitgen;
+  for (std::string_view type_str :
+       {"bits[1]", "bits[32]", "bits[65][4]", "(bits[3], (bits[128], bits[9]))",
+        "()"}) {
+    Type* type = ParseType(type_str);
+    TypeLayout layout = CreateTypeLayout(type);
+    XLS_ASSERT_OK_AND_ASSIGN(TempFile temp, TempFile::Create(".xcs"));
+
+    std::vector<Value> values;
+    for (int64_t i = 0; i < 100; ++i) {
+      values.push_back(RandomValue(type, bitgen));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelStreamWriter> writer,
+                             ChannelStreamWriter::Create(temp.path(), layout));
+    for (const Value& value : values) {
+      XLS_ASSERT_OK(writer->WriteValue(value));
+    }
+    EXPECT_EQ(writer->element_count(), values.size());
+    XLS_ASSERT_OK(writer->Close());
+
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelStreamReader> reader,
+                             ChannelStreamReader::Open(temp.path(), layout));
+    ASSERT_EQ(reader->element_count(), values.size());
+    EXPECT_EQ(reader->element_stride(), writer->element_stride());
+    for (int64_t i = 0; i < values.size(); ++i) {
+      EXPECT_EQ(reader->GetValue(i), values[i]) << type_str << " index " << i;
+      EXPECT_EQ(layout.NativeLayoutToValue(reader->element(i)), values[i]);
+      reader->ReleaseBefore(i);
+    }
+  }
+}
+
+TEST_F(ChannelStreamTest, WriteRawElementsWithStride) {
+  Type* type = ParseType("bits[16]");
+  TypeLayout layout = CreateTypeLayout(type);
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp, TempFile::Create(".xcs"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelStreamWriter> writer,
+                           ChannelStreamWriter::Create(temp.path(), layout));
+  // Elements are 16 bits spaced 8 bytes apart. The bytes between elements
+  // must not be written to the stream.
+  std::vector<uint8_t> data(8 * 10, 0xff);
+  for (int64_t i = 0; i < 10; ++i) {
+    data[8 * i] = i;
+    data[8 * i + 1] = 0;
+  }
+  XLS_ASSERT_OK(writer->Write(data.data(), /*count=*/4, /*stride=*/8));
+  XLS_ASSERT_OK(writer->Write(data.data() + 8 * 4, /*count=*/6, /*stride=*/8));
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelStreamReader> reader,
+                           ChannelStreamReader::Open(temp.path(), layout));
+  ASSERT_EQ(reader->element_count(), 10);
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(reader->GetValue(i), Value(UBits(i, 16)));
+    for (int64_t j = layout.size(); j < reader->element_stride(); ++j) {
+      EXPECT_EQ(reader->element(i)[j], 0);
+    }
+  }
+}
+
+TEST_F(ChannelStreamTest, EmptyStream) {
+  TypeLayout layout = CreateTypeLayout(ParseType("bits[8]"));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp, TempFile::Create(".xcs"));
+  {
+    // The destructor finalizes the stream.
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelStreamWriter> writer,
+                             ChannelStreamWriter::Create(temp.path(), layout));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelStreamReader> reader,
+                           ChannelStreamReader::Open(temp.path(), layout));
+  EXPECT_EQ(reader->element_count(), 0);
+}
+
+TEST_F(ChannelStreamTest, LayoutMismatch) {
+  TypeLayout layout = CreateTypeLayout(ParseType("bits[8]"));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp, TempFile::Create(".xcs"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelStreamWriter> writer,
+                           ChannelStreamWriter::Create(temp.path(), layout));
+  XLS_ASSERT_OK(writer->WriteValue(Value(UBits(1, 8))));
+  XLS_ASSERT_OK(writer->Close());
+
+  EXPECT_THAT(ChannelStreamReader::Open(
+                  temp.path(), CreateTypeLayout(ParseType("bits[9]"))),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("holds values of type bits[8]")));
+}
+
+TEST_F(ChannelStreamTest, InvalidFiles) {
+  TypeLayout layout = CreateTypeLayout(ParseType("bits[8]"));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile too_small,
+                           TempFile::CreateWithContent("XLS", ".xcs"));
+  EXPECT_THAT(ChannelStreamReader::Open(too_small.path(), layout),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("too small to hold a header")));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile bad_magic,
+      TempFile::CreateWithContent(std::string(128, 'x'), ".xcs"));
+  EXPECT_THAT(ChannelStreamReader::Open(bad_magic.path(), layout),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("bad magic number")));
+
+  // Truncate a valid stream so its elements no longer fit.
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp, TempFile::Create(".xcs"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelStreamWriter> writer,
+                           ChannelStreamWriter::Create(temp.path(), layout));
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(writer->WriteValue(Value(UBits(i, 8))));
+  }
+  XLS_ASSERT_OK(writer->Close());
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents,
+                           GetFileContents(temp.path()));
+  XLS_ASSERT_OK(SetFileContents(temp.path(),
+                                contents.substr(0, contents.size() - 1)));
+  EXPECT_THAT(ChannelStreamReader::Open(temp.path(), layout),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("do not fit in the file")));
+
+  EXPECT_THAT(ChannelStreamReader::Open("/does/not/exist.xcs", layout),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,6 +14,7 @@
 #include "xls/jit/function_base_jit.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <iterator>
@@ -38,15 +39,20 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/IR/Attributes.h"
+#include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/Function.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
 #include "llvm/include/llvm/IR/Instructions.h"
+#include "llvm/include/llvm/IR/Intrinsics.h"
 #include "llvm/include/llvm/IR/LLVMContext.h"
+#include "llvm/include/llvm/IR/Metadata.h"
 #include "llvm/include/llvm/IR/Type.h"
 #include "llvm/include/llvm/IR/Value.h"
 #include "llvm/include/llvm/Support/Alignment.h"
+#include "llvm/include/llvm/Support/AtomicOrdering.h"
 #include "llvm/include/llvm/Support/Casting.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
@@ -69,6 +75,7 @@
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/node_profiler.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
@@ -315,10 +322,35 @@ class BufferAllocator {
     }
   }
 
+  // Assigns `node` the buffer already allocated to `source`. `source` must be
+  // dead once `node` is computed.
+  void SetAliasedBuffer(Node* node, Node* source) {
+    CHECK(!allocation_kinds_.contains(node));
+    AllocationKind kind = allocation_kinds_.at(source);
+    CHECK(kind != AllocationKind::kNone);
+    allocation_kinds_[node] = kind;
+    aliased_buffers_[node] = source;
+    if (kind == AllocationKind::kTempBlock) {
+      temp_block_offsets_[node] = temp_block_offsets_.at(source);
+      VLOG(3) << absl::StreamFormat("Aliased %s to buffer of %s at offset %d",
+                                    node->GetName(), source->GetName(),
+                                    temp_block_offsets_.at(node));
+    }
+  }
+
   AllocationKind GetAllocationKind(Node* node) const {
     return allocation_kinds_.at(node);
   }
 
+  // Returns the node whose buffer `node` shares, if any.
+  std::optional<Node*> GetAliasedNode(Node* node) const {
+    auto it = aliased_buffers_.find(node);
+    if (it == aliased_buffers_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
   // Returns the offset within the temp block for the buffer allocated for
   // `node`. Node must be assigned allocation kind kTempblock.
   int64_t GetOffset(Node* node) const {
@@ -353,6 +385,7 @@ class BufferAllocator {
   int64_t current_offset_ = 0;
   int64_t alignment_ = 1;
   absl::flat_hash_map<Node*, AllocationKind> allocation_kinds_;
+  absl::flat_hash_map<Node*, Node*> aliased_buffers_;
 };
 
 // The maximum number of xls::Nodes in a partition.
@@ -511,6 +544,65 @@ Type* OutputType(const Node* node) {
   return node->GetType();
 }
 
+// Emits the code which attributes the cycles spent in a partition function to
+// the nodes it evaluates when a NodeProfiler is attached to the compiler. The
+// cycle counter is read on entry to the partition and after each node
+// function, so each node is charged for its own node function plus the
+// (small) cost of loading its operand buffers.
+class PartitionProfiler {
+ public:
+  static_assert(sizeof(std::atomic<int64_t>) == sizeof(int64_t) &&
+                std::atomic<int64_t>::is_always_lock_free);
+
+  PartitionProfiler(NodeProfiler* profiler, llvm::IRBuilder<>& b)
+      : profiler_(profiler) {
+    llvm::Value* paused = b.CreateLoad(
+        b.getInt8Ty(), HostPointer(profiler->paused_flag(), b), "paused");
+    enabled_ = b.CreateICmpEQ(paused, b.getInt8(0), "profile_enabled");
+    last_cycle_ = ReadCycleCounter(b);
+  }
+
+  // Attributes the cycles since the previous reading to `node`.
+  void RecordNode(Node* node, llvm::IRBuilder<>& b) {
+    llvm::Value* now = ReadCycleCounter(b);
+    llvm::Value* elapsed = b.CreateSub(now, last_cycle_, "elapsed");
+    // The counter may appear to go backwards if the thread migrates between
+    // cores with unsynchronized counters.
+    llvm::Value* record_elapsed =
+        b.CreateAnd(enabled_, b.CreateICmpSGT(elapsed, b.getInt64(0)));
+    NodeProfiler::Counters* counters = profiler_->GetOrCreateCounters(node);
+    b.CreateAtomicRMW(llvm::AtomicRMWInst::Add,
+                      HostPointer(&counters->cycles, b),
+                      b.CreateSelect(record_elapsed, elapsed, b.getInt64(0)),
+                      llvm::MaybeAlign(8), llvm::AtomicOrdering::Monotonic);
+    b.CreateAtomicRMW(llvm::AtomicRMWInst::Add,
+                      HostPointer(&counters->evaluations, b),
+                      b.CreateZExt(enabled_, b.getInt64Ty()),
+                      llvm::MaybeAlign(8), llvm::AtomicOrdering::Monotonic);
+    // Read the counter again so the cost of the update is not attributed to
+    // the next node.
+    last_cycle_ = ReadCycleCounter(b);
+  }
+
+ private:
+  static llvm::Value* HostPointer(const void* ptr, llvm::IRBuilder<>& b) {
+    return b.CreateIntToPtr(
+        b.getInt64(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr))),
+        llvm::PointerType::getUnqual(b.getContext()));
+  }
+
+  static llvm::Value* ReadCycleCounter(llvm::IRBuilder<>& b) {
+    llvm::Function* read_cycle_counter =
+        llvm::Intrinsic::getOrInsertDeclaration(
+            b.GetInsertBlock()->getModule(), llvm::Intrinsic::readcyclecounter);
+    return b.CreateCall(read_cycle_counter, {}, "cycle");
+  }
+
+  NodeProfiler* profiler_;
+  llvm::Value* enabled_;
+  llvm::Value* last_cycle_;
+};
+
 // Builds an LLVM function of the given `name` which executes the given set of
 // nodes. The signature of the partition function is the same as the jitted
 // function implementing a FunctionBase (i.e., `JitFunctionType`). A partition
@@ -564,6 +656,11 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
   // partitions which are early exit points (e.g., have a blocking receive).
   llvm::Value* interrupt_execution = nullptr;
 
+  std::optional<PartitionProfiler> profiler;
+  if (jit_context.llvm_compiler().node_profiler() != nullptr) {
+    profiler.emplace(jit_context.llvm_compiler().node_profiler(), b);
+  }
+
   // The pointers to the buffers of nodes in the partition.
   absl::flat_hash_map<Node*, llvm::Value*> value_buffers;
   for (Node* node : partition.nodes) {
@@ -571,7 +668,13 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       // Node is an input node. We need to generate a node function for  this
       // node to call callbacks on the node.
       XLS_RET_CHECK(allocator.GetAllocationKind(node) == AllocationKind::kNone);
-      if (wrapper.IsOutputNode(node)) {
+      // The state reads of procs with next_value nodes are outputs but the
+      // caller initializes the output buffers with the current state, so
+      // unchanged state elements are not copied.
+      bool output_initialized_by_caller =
+          node->Is<StateRead>() &&
+          !node->function_base()->next_values().empty();
+      if (wrapper.IsOutputNode(node) && !output_initialized_by_caller) {
         // `node` is also an output node. This can occur, for example, if a
         // state param is the next state value for a proc.
         llvm::Value* input_buffer = wrapper.GetInputBuffer(node, b);
@@ -610,8 +713,14 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       // nor has a temp buffer). Allocate a buffer on the stack with alloca.
       XLS_RET_CHECK(!node->Is<RegisterWrite>());
       XLS_RET_CHECK(!node->Is<OutputPort>());
-      output_buffers = {b.CreateAlloca(
-          jit_context.type_converter().ConvertToLlvmType(node->GetType()))};
+      if (std::optional<Node*> source = allocator.GetAliasedNode(node);
+          source.has_value()) {
+        XLS_RET_CHECK(value_buffers.contains(*source)) << node;
+        output_buffers = {value_buffers.at(*source)};
+      } else {
+        output_buffers = {b.CreateAlloca(
+            jit_context.type_converter().ConvertToLlvmType(node->GetType()))};
+      }
     } else {
       // Node has no allocation and is not an output buffer. Nothing to emit for
       // this node.
@@ -676,6 +785,9 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
     }
     XLS_RET_CHECK_EQ(node_function.function->arg_size(), args.size());
     llvm::CallInst* node_blocked = b.CreateCall(node_function.function, args);
+    if (profiler.has_value()) {
+      profiler->RecordNode(node, b);
+    }
 
     if (partition.early_exit_point.has_value()) {
       XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
@@ -692,30 +804,77 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
   return wrapper.function();
 }
 
+// Returns whether `update` can be computed in the buffer of the array it
+// updates, i.e., the array has a buffer of its own and no other use.
+bool CanUpdateInPlace(
+    ArrayUpdate* update,
+    const absl::flat_hash_map<Node*, AllocationKind>& kinds) {
+  Node* array = update->array_to_update();
+  return kinds.at(update) != AllocationKind::kNone &&
+         kinds.at(array) != AllocationKind::kNone &&
+         !array->function_base()->HasImplicitUse(array) &&
+         array->users().size() == 1 &&
+         absl::c_count(update->operands(), array) == 1;
+}
+
 // Determine the type of buffers required by each node. Allocates the temporary
-// buffers for nodes as needed.
+// buffers for nodes as needed. Array updates of arrays which are otherwise
+// dead share the array's buffer so chains of updates are done in place.
 absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
                              const LlvmFunctionWrapper& wrapper,
                              BufferAllocator& allocator) {
+  std::vector<Node*> nodes;
+  absl::flat_hash_map<Node*, AllocationKind> kinds;
   for (const Partition& partition : partitions) {
     absl::flat_hash_set<Node*> partition_set(partition.nodes.begin(),
                                              partition.nodes.end());
     for (Node* node : partition.nodes) {
+      nodes.push_back(node);
       if (wrapper.IsInputNode(node) || wrapper.IsOutputNode(node) ||
           ShouldMaterializeAtUse(node)) {
-        allocator.SetAllocationKind(node, AllocationKind::kNone);
+        kinds[node] = AllocationKind::kNone;
       } else if (!node->function_base()->HasImplicitUse(node) &&
                  std::all_of(
                      node->users().begin(), node->users().end(),
                      [&](Node* u) { return partition_set.contains(u); })) {
         // All of the uses of node are in the partition.
-        allocator.SetAllocationKind(node, AllocationKind::kAlloca);
+        kinds[node] = AllocationKind::kAlloca;
       } else {
         // Node has a use in another partition.
-        allocator.SetAllocationKind(node, AllocationKind::kTempBlock);
+        kinds[node] = AllocationKind::kTempBlock;
       }
     }
   }
+
+  // Map from in-place array update to the array whose buffer it shares. Nodes
+  // sharing a buffer must agree on its kind, so a chain of updates is put in
+  // the temp block if any node in it needs to be. Propagate that backwards
+  // and then forwards along the chains (the nodes are topologically sorted).
+  absl::flat_hash_map<Node*, Node*> aliases;
+  for (Node* node : nodes) {
+    if (node->Is<ArrayUpdate>() &&
+        CanUpdateInPlace(node->As<ArrayUpdate>(), kinds)) {
+      aliases[node] = node->As<ArrayUpdate>()->array_to_update();
+    }
+  }
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+    if (aliases.contains(*it) && kinds.at(*it) == AllocationKind::kTempBlock) {
+      kinds[aliases.at(*it)] = AllocationKind::kTempBlock;
+    }
+  }
+  for (Node* node : nodes) {
+    if (aliases.contains(node)) {
+      kinds[node] = kinds.at(aliases.at(node));
+    }
+  }
+
+  for (Node* node : nodes) {
+    if (aliases.contains(node)) {
+      allocator.SetAliasedBuffer(node, aliases.at(node));
+    } else {
+      allocator.SetAllocationKind(node, kinds.at(node));
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -1258,6 +1417,132 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
   return wrapper.function();
 }
 
+// Builds a wrapper around the jitted function `callee` which invokes `callee`
+// once for each of a batch of argument sets. The number of argument sets is
+// passed in place of the continuation point. The i-th input (output) pointer
+// points to an arena in which consecutive argument sets are `input_strides[i]`
+// (`output_strides[i]`) bytes apart. `callee` must not have early exit points.
+//
+// If `vector_lanes` is given `callee` is forcibly inlined into the loop and the
+// loop is annotated for the LLVM loop vectorizer to evaluate `vector_lanes`
+// argument sets in parallel.
+absl::StatusOr<llvm::Function*> BuildBatchedWrapper(
+    std::string_view name, FunctionBase* xls_function, llvm::Function* callee,
+    absl::Span<const int64_t> input_strides,
+    absl::Span<const int64_t> output_strides,
+    std::optional<int64_t> vector_lanes, JitBuilderContext& jit_context) {
+  llvm::LLVMContext* context = &jit_context.context();
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  llvm::Type* pointer_type = llvm::PointerType::getUnqual(*context);
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  XLS_RET_CHECK_EQ(inputs.size(), input_strides.size());
+  XLS_RET_CHECK_EQ(outputs.size(), output_strides.size());
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      name, inputs, outputs, i64, jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "count", .type = i64});
+  llvm::IRBuilder<>& entry_builder = wrapper.entry_builder();
+  llvm::Value* count = wrapper.GetExtraArg().value();
+
+  // Arrays of pointers to the values of the current argument set which are
+  // passed to `callee`.
+  llvm::Value* input_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(pointer_type, inputs.size()));
+  llvm::Value* output_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(pointer_type, outputs.size()));
+
+  // The arena base pointers are loop invariant so load them once up front.
+  std::vector<llvm::Value*> input_arenas;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    input_arenas.push_back(LoadPointerFromPointerArray(
+        i, wrapper.GetInputsArg(), &entry_builder));
+  }
+  std::vector<llvm::Value*> output_arenas;
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    output_arenas.push_back(LoadPointerFromPointerArray(
+        i, wrapper.GetOutputsArg(), &entry_builder));
+  }
+
+  llvm::BasicBlock* loop_block =
+      llvm::BasicBlock::Create(*context, "loop", wrapper.function());
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(*context, "exit", wrapper.function());
+  entry_builder.CreateCondBr(
+      entry_builder.CreateICmpSGT(count, llvm::ConstantInt::get(i64, 0)),
+      loop_block, exit_block);
+
+  llvm::IRBuilder<> loop_builder(loop_block);
+  llvm::PHINode* index = loop_builder.CreatePHI(i64, 2, "index");
+  index->addIncoming(llvm::ConstantInt::get(i64, 0),
+                     entry_builder.GetInsertBlock());
+  auto store_element_pointers = [&](absl::Span<llvm::Value* const> arenas,
+                                    absl::Span<const int64_t> strides,
+                                    llvm::Value* arg_array) {
+    for (int64_t i = 0; i < arenas.size(); ++i) {
+      llvm::Value* offset = loop_builder.CreateMul(
+          index, llvm::ConstantInt::get(i64, strides[i]));
+      llvm::Value* element = loop_builder.CreateGEP(
+          llvm::Type::getInt8Ty(*context), arenas[i], offset);
+      llvm::Value* gep = loop_builder.CreateGEP(
+          pointer_type, arg_array,
+          {llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i)});
+      loop_builder.CreateStore(element, gep);
+    }
+  };
+  store_element_pointers(input_arenas, input_strides, input_arg_array);
+  store_element_pointers(output_arenas, output_strides, output_arg_array);
+
+  std::vector<llvm::Value*> args;
+  args.push_back(input_arg_array);
+  args.push_back(output_arg_array);
+  args.push_back(wrapper.GetTempBufferArg());
+  args.push_back(wrapper.GetInterpreterEventsArg());
+  args.push_back(wrapper.GetInstanceContextArg());
+  args.push_back(wrapper.GetJitRuntimeArg());
+  args.push_back(llvm::ConstantInt::get(i64, 0));
+  loop_builder.CreateCall(callee, args);
+
+  llvm::Value* next_index =
+      loop_builder.CreateAdd(index, llvm::ConstantInt::get(i64, 1));
+  index->addIncoming(next_index, loop_block);
+  llvm::BranchInst* loop_branch = loop_builder.CreateCondBr(
+      loop_builder.CreateICmpSLT(next_index, count), loop_block, exit_block);
+
+  if (vector_lanes.has_value()) {
+    // The vectorizer only handles loop bodies without calls so the callee and
+    // all the functions it transitively calls must be inlined.
+    for (llvm::Function& function : *jit_context.module()) {
+      if (!function.isDeclaration() && &function != wrapper.function()) {
+        function.addFnAttr(llvm::Attribute::AlwaysInline);
+      }
+    }
+    // The loop ID is a distinct node whose first operand refers to itself.
+    llvm::Type* i32 = llvm::Type::getInt32Ty(*context);
+    std::vector<llvm::Metadata*> loop_properties = {
+        nullptr,
+        llvm::MDNode::get(
+            *context,
+            {llvm::MDString::get(*context, "llvm.loop.vectorize.enable"),
+             llvm::ConstantAsMetadata::get(
+                 llvm::ConstantInt::getTrue(*context))}),
+        llvm::MDNode::get(
+            *context,
+            {llvm::MDString::get(*context, "llvm.loop.vectorize.width"),
+             llvm::ConstantAsMetadata::get(
+                 llvm::ConstantInt::get(i32, *vector_lanes))}),
+    };
+    llvm::MDNode* loop_id =
+        llvm::MDNode::getDistinct(*context, loop_properties);
+    loop_id->replaceOperandWith(0, loop_id);
+    loop_branch->setMetadata(llvm::LLVMContext::MD_loop, loop_id);
+  }
+
+  llvm::IRBuilder<> exit_builder(exit_block);
+  exit_builder.CreateRet(llvm::ConstantInt::get(i64, 0));
+
+  return wrapper.function();
+}
+
 }  // namespace
 
 JitArgumentSet JittedFunctionBase::CreateInputBuffer() const {
@@ -1278,6 +1563,28 @@ absl::StatusOr<JitArgumentSet> JittedFunctionBase::CreateInputOutputBuffer()
       {input_buffer_sizes(), output_buffer_sizes()});
 }
 
+JitArgumentSet JittedFunctionBase::CreateBatchedInputBuffer(
+    int64_t count) const {
+  std::vector<int64_t> sizes;
+  sizes.reserve(input_batch_strides_.size());
+  for (int64_t stride : input_batch_strides_) {
+    sizes.push_back(stride * count);
+  }
+  return JitArgumentSet::CreateInput(this, input_buffer_preferred_alignments(),
+                                     sizes);
+}
+
+JitArgumentSet JittedFunctionBase::CreateBatchedOutputBuffer(
+    int64_t count) const {
+  std::vector<int64_t> sizes;
+  sizes.reserve(output_batch_strides_.size());
+  for (int64_t stride : output_batch_strides_) {
+    sizes.push_back(stride * count);
+  }
+  return JitArgumentSet::CreateOutput(
+      this, output_buffer_preferred_alignments(), sizes);
+}
+
 JitTempBuffer JittedFunctionBase::CreateTempBuffer() const {
   return JitTempBuffer(this, temp_buffer_alignment(), temp_buffer_size());
 }
@@ -1286,7 +1593,7 @@ JitTempBuffer JittedFunctionBase::CreateTempBuffer() const {
 // dependent xls::Functions which may be called by `xls_function`.
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
     FunctionBase* xls_function, JitBuilderContext& jit_context,
-    bool build_packed_wrapper) {
+    bool build_packed_wrapper, const JitBatchOptions& batch_options) {
   std::vector<FunctionBase*> functions = GetDependentFunctions(xls_function);
   BufferAllocator allocator(&jit_context.type_converter());
   llvm::Function* top_function = nullptr;
@@ -1318,11 +1625,56 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
 
   std::string function_name = MangleForLLVM(top_function->getName().str());
   std::string packed_wrapper_name;
+  std::string batched_wrapper_name;
+  std::string packed_batched_wrapper_name;
+  std::vector<int64_t> input_batch_strides;
+  std::vector<int64_t> output_batch_strides;
+  for (const Node* input : GetJittedFunctionInputs(xls_function)) {
+    input_batch_strides.push_back(RoundUpToNearest(
+        jit_context.type_converter().GetTypeByteSize(InputType(input)),
+        jit_context.type_converter().GetTypePreferredAlignment(
+            InputType(input))));
+  }
+  for (const Node* output : GetJittedFunctionOutputs(xls_function)) {
+    output_batch_strides.push_back(RoundUpToNearest(
+        jit_context.type_converter().GetTypeByteSize(OutputType(output)),
+        jit_context.type_converter().GetTypePreferredAlignment(
+            OutputType(output))));
+  }
   if (build_packed_wrapper) {
     XLS_ASSIGN_OR_RETURN(
         llvm::Function * packed_wrapper_function,
         BuildPackedWrapper(xls_function, top_function, jit_context));
     packed_wrapper_name = packed_wrapper_function->getName().str();
+
+    // Batched wrappers loop over many argument sets inside the jitted code to
+    // avoid the per-invocation overhead for callers evaluating many inputs.
+    XLS_ASSIGN_OR_RETURN(
+        llvm::Function * batched_wrapper_function,
+        BuildBatchedWrapper(absl::StrFormat("%s_batched", xls_function->name()),
+                            xls_function, top_function, input_batch_strides,
+                            output_batch_strides, batch_options.vector_lanes,
+                            jit_context));
+    batched_wrapper_name = batched_wrapper_function->getName().str();
+    std::vector<int64_t> packed_input_sizes;
+    for (const Node* input : GetJittedFunctionInputs(xls_function)) {
+      packed_input_sizes.push_back(
+          jit_context.type_converter().GetPackedTypeByteSize(InputType(input)));
+    }
+    std::vector<int64_t> packed_output_sizes;
+    for (const Node* output : GetJittedFunctionOutputs(xls_function)) {
+      packed_output_sizes.push_back(
+          jit_context.type_converter().GetPackedTypeByteSize(
+              OutputType(output)));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        llvm::Function * packed_batched_wrapper_function,
+        BuildBatchedWrapper(
+            absl::StrFormat("%s_packed_batched", xls_function->name()),
+            xls_function, packed_wrapper_function, packed_input_sizes,
+            packed_output_sizes, batch_options.vector_lanes, jit_context));
+    packed_batched_wrapper_name =
+        packed_batched_wrapper_function->getName().str();
   }
 
   XLS_RETURN_IF_ERROR(
@@ -1355,7 +1707,21 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
       // actually try to invoke it.
       jitted_function.packed_function_ = InvalidJitFunctionUse;
     }
+    if (jit_context.llvm_compiler().IsOrcJit()) {
+      XLS_ASSIGN_OR_RETURN(auto* orc_jit,
+                           jit_context.llvm_compiler().AsOrcJit());
+      XLS_ASSIGN_OR_RETURN(auto batched_fn_address,
+                           orc_jit->LoadSymbol(batched_wrapper_name));
+      jitted_function.batched_function_ =
+          absl::bit_cast<JitFunctionType>(batched_fn_address);
+      XLS_ASSIGN_OR_RETURN(auto packed_batched_fn_address,
+                           orc_jit->LoadSymbol(packed_batched_wrapper_name));
+      jitted_function.packed_batched_function_ =
+          absl::bit_cast<JitFunctionType>(packed_batched_fn_address);
+    }
   }
+  jitted_function.input_batch_strides_ = std::move(input_batch_strides);
+  jitted_function.output_batch_strides_ = std::move(output_batch_strides);
 
   for (const Node* input : GetJittedFunctionInputs(xls_function)) {
     Type* input_type = InputType(input);
@@ -1397,10 +1763,19 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
-    Function* xls_function, LlvmCompiler& compiler) {
+    Function* xls_function, LlvmCompiler& compiler,
+    const JitBatchOptions& batch_options) {
+  if (batch_options.vector_lanes.has_value() &&
+      (*batch_options.vector_lanes < 1 ||
+       !IsPowerOfTwo(static_cast<uint64_t>(*batch_options.vector_lanes)))) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Vector lane count must be a power of two, got %d",
+                        *batch_options.vector_lanes));
+  }
   JitBuilderContext jit_context(compiler, xls_function);
   return JittedFunctionBase::BuildInternal(xls_function, jit_context,
-                                           /*build_packed_wrapper=*/true);
+                                           /*build_packed_wrapper=*/true,
+                                           batch_options);
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
@@ -1478,8 +1853,11 @@ int64_t JittedFunctionBase::RunJittedFunction(
   CHECK(outputs.is_outputs());
   CHECK_EQ(outputs.source(), this);
   CHECK_EQ(temp_buffer.source(), this);
-  return function_(inputs.get(), outputs.get(), temp_buffer.get(), events,
-                   instance_context, jit_runtime, continuation_point);
+  int64_t result =
+      function_(inputs.get(), outputs.get(), temp_buffer.get(), events,
+                instance_context, jit_runtime, continuation_point);
+  FlushDeferredTraces(instance_context, jit_runtime);
+  return result;
 }
 
 namespace {
@@ -1532,8 +1910,10 @@ int64_t JittedFunctionBase::RunUnalignedJittedFunction(
       return result;
     }
   }
-  return function_(inputs, outputs, temp_buffer, events, instance_context,
-                   jit_runtime, continuation);
+  int64_t result = function_(inputs, outputs, temp_buffer, events,
+                             instance_context, jit_runtime, continuation);
+  FlushDeferredTraces(instance_context, jit_runtime);
+  return result;
 }
 
 template int64_t
@@ -1554,9 +1934,38 @@ std::optional<int64_t> JittedFunctionBase::RunPackedJittedFunction(
     JitRuntime* jit_runtime, int64_t continuation_point) const {
   // Packed Jit makes no alignment assumptions, so nothing to check.
   if (packed_function_) {
-    return (*packed_function_)(inputs, outputs, temp_buffer, events,
-                               instance_context, jit_runtime,
-                               continuation_point);
+    int64_t result =
+        (*packed_function_)(inputs, outputs, temp_buffer, events,
+                            instance_context, jit_runtime, continuation_point);
+    FlushDeferredTraces(instance_context, jit_runtime);
+    return result;
+  }
+  return std::nullopt;
+}
+
+std::optional<int64_t> JittedFunctionBase::RunBatchedJittedFunction(
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    InterpreterEvents* events, InstanceContext* instance_context,
+    JitRuntime* jit_runtime, int64_t count) const {
+  if (batched_function_) {
+    int64_t result = (*batched_function_)(inputs, outputs, temp_buffer, events,
+                                          instance_context, jit_runtime, count);
+    FlushDeferredTraces(instance_context, jit_runtime);
+    return result;
+  }
+  return std::nullopt;
+}
+
+std::optional<int64_t> JittedFunctionBase::RunPackedBatchedJittedFunction(
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    InterpreterEvents* events, InstanceContext* instance_context,
+    JitRuntime* jit_runtime, int64_t count) const {
+  if (packed_batched_function_) {
+    int64_t result =
+        (*packed_batched_function_)(inputs, outputs, temp_buffer, events,
+                                    instance_context, jit_runtime, count);
+    FlushDeferredTraces(instance_context, jit_runtime);
+    return result;
   }
   return std::nullopt;
 }
@@ -75,6 +75,16 @@ using JitFunctionType = int64_t (*)(const uint8_t* const* inputs,
                                     JitRuntime* jit_runtime,
                                     int64_t continuation_point);
 
+// Options controlling the batched entry points of jitted xls::Functions.
+struct JitBatchOptions {
+  // If set, the batched entry points evaluate this many argument sets at a time
+  // in the lanes of SIMD vector registers. The function body is inlined into
+  // the batch loop which is then vectorized with this width. Must be a power
+  // of two. Functions which cannot be vectorized (e.g., those containing
+  // traces or asserts) are evaluated one argument set at a time as usual.
+  std::optional<int64_t> vector_lanes;
+};
+
 // Abstraction holding function pointers and metadata about a jitted function
 // implementing a XLS Function, Proc, etc.
 //
@@ -84,11 +94,16 @@ class JittedFunctionBase {
   JittedFunctionBase() = default;
   // Builds and returns an LLVM IR function implementing the given XLS
   // function.
-  static absl::StatusOr<JittedFunctionBase> Build(Function* xls_function,
-                                                  LlvmCompiler& compiler);
+  static absl::StatusOr<JittedFunctionBase> Build(
+      Function* xls_function, LlvmCompiler& compiler,
+      const JitBatchOptions& batch_options = JitBatchOptions());
 
   // Builds and returns an LLVM IR function implementing the given XLS
   // proc.
+  //
+  // If the proc has next_value nodes, the outputs are the state elements and
+  // only the elements with an active next_value are written. The caller must
+  // initialize the output state buffers with the current state.
   static absl::StatusOr<JittedFunctionBase> Build(Proc* proc,
                                                   LlvmCompiler& compiler);
 
@@ -151,8 +166,35 @@ class JittedFunctionBase {
       InterpreterEvents* events, InstanceContext* instance_context,
       JitRuntime* jit_runtime, int64_t continuation_point) const;
 
+  // Execute the batched version of the function which evaluates `count`
+  // argument sets in a single call. `inputs[i]` points to an arena holding
+  // `count` consecutive values of the i-th input in the native LLVM data layout
+  // with each value `input_batch_strides()[i]` bytes after the previous one.
+  // `outputs` is laid out likewise using `output_batch_strides()`. Returns
+  // nullopt if there is no batched version of the function.
+  std::optional<int64_t> RunBatchedJittedFunction(
+      const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+      InterpreterEvents* events, InstanceContext* instance_context,
+      JitRuntime* jit_runtime, int64_t count) const;
+
+  // As RunBatchedJittedFunction but the values are in the packed layout and
+  // each is `packed_input_buffer_sizes()[i]` (or
+  // `packed_output_buffer_sizes()[i]`) bytes after the previous one.
+  std::optional<int64_t> RunPackedBatchedJittedFunction(
+      const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+      InterpreterEvents* events, InstanceContext* instance_context,
+      JitRuntime* jit_runtime, int64_t count) const;
+
+  // Create buffers with space for `count` sets of inputs (or outputs) laid out
+  // as expected by RunBatchedJittedFunction.
+  JitArgumentSet CreateBatchedInputBuffer(int64_t count) const;
+  JitArgumentSet CreateBatchedOutputBuffer(int64_t count) const;
+
   // Checks if we have a packed version of the function.
   bool HasPackedFunction() const { return packed_function_.has_value(); }
+
+  // Checks if we have batched versions of the function.
+  bool HasBatchedFunction() const { return batched_function_.has_value(); }
   std::optional<std::string_view> packed_function_name() const {
     return HasPackedFunction()
                ? std::make_optional<std::string_view>(*packed_function_name_)
@@ -177,6 +219,16 @@ class JittedFunctionBase {
     return packed_output_buffer_sizes_;
   }
 
+  // Distance in bytes between consecutive values of each input/output in the
+  // arenas passed to RunBatchedJittedFunction.
+  absl::Span<int64_t const> input_batch_strides() const {
+    return input_batch_strides_;
+  }
+
+  absl::Span<int64_t const> output_batch_strides() const {
+    return output_batch_strides_;
+  }
+
   absl::Span<int64_t const> input_buffer_preferred_alignments() const {
     return input_buffer_preferred_alignments_;
   }
@@ -213,6 +265,8 @@ class JittedFunctionBase {
     JittedFunctionBase res = *this;
     res.function_ = entrypoint;
     res.packed_function_ = packed_entrypoint;
+    res.batched_function_ = std::nullopt;
+    res.packed_batched_function_ = std::nullopt;
     return res;
   }
 
@@ -252,7 +306,8 @@ class JittedFunctionBase {
 
   static absl::StatusOr<JittedFunctionBase> BuildInternal(
       FunctionBase* function, JitBuilderContext& jit_context,
-      bool build_packed_wrapper);
+      bool build_packed_wrapper,
+      const JitBatchOptions& batch_options = JitBatchOptions());
 
   // Name and function pointer for the jitted function which accepts/produces
   // arguments/results in LLVM native format.
@@ -265,6 +320,14 @@ class JittedFunctionBase {
   std::optional<std::string> packed_function_name_;
   std::optional<JitFunctionType> packed_function_;
 
+  // Function pointers for the jitted functions which evaluate a batch of
+  // argument sets in native LLVM format or packed format respectively. Only
+  // exists for JITted xls::Functions. The functions have the signature of
+  // JitFunctionType except that the final argument is the number of argument
+  // sets in the batch.
+  std::optional<JitFunctionType> batched_function_;
+  std::optional<JitFunctionType> packed_batched_function_;
+
   // Sizes of the inputs/outputs in native LLVM format for `function_base`.
   std::vector<int64_t> input_buffer_sizes_;
   std::vector<int64_t> output_buffer_sizes_;
@@ -281,6 +344,10 @@ class JittedFunctionBase {
   std::vector<int64_t> packed_input_buffer_sizes_;
   std::vector<int64_t> packed_output_buffer_sizes_;
 
+  // Strides of the inputs/outputs in the arenas of the batched function.
+  std::vector<int64_t> input_batch_strides_;
+  std::vector<int64_t> output_batch_strides_;
+
   // Size of the temporary buffer required by `function`.
   int64_t temp_buffer_size_ = -1;
   // Alignment of the temporary buffer required by `function`
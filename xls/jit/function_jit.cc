@@ -23,15 +23,19 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/Support/Error.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/keyword_args.h"
@@ -45,8 +49,10 @@
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -94,11 +100,47 @@ FunctionJit::InterfaceMetadata::CreateFromAotEntrypoint(
   return metadata;
 }
 
+/* static */ std::vector<TypeLayout> FunctionJit::CreateArgLayouts(
+    const InterfaceMetadata& metadata, JitRuntime* runtime) {
+  std::vector<TypeLayout> layouts;
+  layouts.reserve(metadata.ParamCount());
+  for (Type* param_type : metadata.param_types) {
+    layouts.push_back(runtime->CreateTypeLayout(param_type));
+  }
+  return layouts;
+}
+
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
     Function* xls_function, int64_t opt_level, bool include_observer_callbacks,
-    JitObserver* jit_observer) {
-  return CreateInternal(xls_function, opt_level, include_observer_callbacks,
-                        jit_observer);
+    JitObserver* jit_observer, const JitBatchOptions& batch_options,
+    NodeProfiler* node_profiler) {
+  return CreateInternal(xls_function,
+                        LlvmOptimization{.opt_level = opt_level},
+                        include_observer_callbacks, jit_observer,
+                        batch_options, node_profiler);
+}
+
+absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateAdaptive(
+    Function* xls_function, std::optional<int64_t> expected_invocations,
+    const AdaptiveOptOptions& options, bool include_observer_callbacks,
+    JitObserver* jit_observer, const JitBatchOptions& batch_options) {
+  // Invoked functions are compiled into the same module.
+  int64_t node_count = 0;
+  for (FunctionBase* f : GetDependentFunctions(xls_function)) {
+    node_count += f->node_count();
+  }
+  LlvmOptimization optimization =
+      ChooseAdaptiveOptimization(node_count, expected_invocations, options);
+  // The batched entry points rely on the loop vectorizer.
+  if (batch_options.vector_lanes.has_value()) {
+    optimization.vectorize = true;
+  }
+  VLOG(2) << absl::StreamFormat(
+      "Compiling function %s with %d nodes at O%d%s", xls_function->name(),
+      node_count, optimization.opt_level,
+      optimization.vectorize ? "" : " without vectorization");
+  return CreateInternal(xls_function, optimization, include_observer_callbacks,
+                        jit_observer, batch_options);
 }
 
 // Returns an object containing an AOT-compiled version of the specified XLS
@@ -131,9 +173,10 @@ FunctionJit::CreateFromAot(const AotEntrypointProto& entrypoint,
 
 absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
     Function* xls_function, int64_t opt_level, bool include_msan,
-    JitObserver* observer) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<AotCompiler> comp,
-                       AotCompiler::Create(include_msan, opt_level, observer));
+    JitObserver* observer, const LlvmPgoOptions& pgo_options) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<AotCompiler> comp,
+      AotCompiler::Create(include_msan, opt_level, observer, pgo_options));
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout, comp->CreateDataLayout());
   XLS_ASSIGN_OR_RETURN(JittedFunctionBase jfb,
                        JittedFunctionBase::Build(xls_function, *comp));
@@ -150,15 +193,19 @@ absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
 }
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
-    Function* xls_function, int64_t opt_level, bool include_observer_callbacks,
-    JitObserver* jit_observer) {
+    Function* xls_function, const LlvmOptimization& optimization,
+    bool include_observer_callbacks, JitObserver* jit_observer,
+    const JitBatchOptions& batch_options, NodeProfiler* node_profiler) {
   XLS_ASSIGN_OR_RETURN(
-      auto orc_jit,
-      OrcJit::Create(opt_level, include_observer_callbacks, jit_observer));
+      auto orc_jit, OrcJit::Create(optimization.opt_level,
+                                   include_observer_callbacks, jit_observer));
+  orc_jit->set_vectorize(optimization.vectorize);
+  orc_jit->set_node_profiler(node_profiler);
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
                        orc_jit->CreateDataLayout());
   XLS_ASSIGN_OR_RETURN(auto function_base,
-                       JittedFunctionBase::Build(xls_function, *orc_jit));
+                       JittedFunctionBase::Build(xls_function, *orc_jit,
+                                                 batch_options));
 
   XLS_ASSIGN_OR_RETURN(InterfaceMetadata metadata,
                        InterfaceMetadata::CreateFromFunction(xls_function));
@@ -167,8 +214,41 @@ absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
       include_observer_callbacks, std::make_unique<JitRuntime>(data_layout)));
 }
 
+std::unique_ptr<FunctionJitScratch> FunctionJit::AcquireScratch() const {
+  {
+    absl::MutexLock lock(&scratch_pool_mutex_);
+    if (!scratch_pool_.empty()) {
+      std::unique_ptr<FunctionJitScratch> scratch =
+          std::move(scratch_pool_.back());
+      scratch_pool_.pop_back();
+      return scratch;
+    }
+  }
+  // Allocate outside the lock so other invocations are not held up.
+  return absl::WrapUnique(new FunctionJitScratch(jitted_function_base_));
+}
+
+void FunctionJit::ReleaseScratch(
+    std::unique_ptr<FunctionJitScratch> scratch) const {
+  absl::MutexLock lock(&scratch_pool_mutex_);
+  scratch_pool_.push_back(std::move(scratch));
+}
+
 absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
-    absl::Span<const Value> args) {
+    absl::Span<const Value> args) const {
+  PooledScratch scratch(this);
+  return RunWithScratch(args, *scratch);
+}
+
+absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
+    absl::Span<const Value> args, FunctionJitScratch& scratch) const {
+  XLS_RET_CHECK_EQ(scratch.temp_.source(), &jitted_function_base_)
+      << "Scratch was created by a different FunctionJit.";
+  return RunWithScratch(args, scratch);
+}
+
+absl::StatusOr<InterpreterResult<Value>> FunctionJit::RunWithScratch(
+    absl::Span<const Value> args, FunctionJitScratch& scratch) const {
   if (args.size() != metadata_.ParamCount()) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Arg list to '%s' has the wrong size: %d vs expected %d.",
@@ -185,30 +265,181 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
 
   // Allocate argument buffers and copy in arg Values.
   XLS_RETURN_IF_ERROR(jit_runtime_->PackArgs(args, metadata_.param_types,
-                                             arg_buffers_.pointers()));
+                                             scratch.args_.pointers()));
 
   InterpreterEvents events;
   jitted_function_base_.RunJittedFunction(
-      arg_buffers_, result_buffers_, temp_buffer_, &events,
+      scratch.args_, scratch.results_, scratch.temp_, &events,
       /*instance_context=*/&callbacks_, /*jit_runtime=*/runtime(),
       /*continuation_point=*/0);
-  Value result = jit_runtime_->UnpackBuffer(result_buffers_.pointers()[0],
+  Value result = jit_runtime_->UnpackBuffer(scratch.results_.pointers()[0],
                                             metadata_.return_type);
 
   return InterpreterResult<Value>{std::move(result), std::move(events)};
 }
 
+void FunctionJit::RunInPlace(InterpreterEvents* events) {
+  jitted_function_base_.RunJittedFunction(
+      in_place_scratch_.args_, in_place_scratch_.results_,
+      in_place_scratch_.temp_, events,
+      /*instance_context=*/&callbacks_, /*jit_runtime=*/runtime(),
+      /*continuation_point=*/0);
+}
+
 absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
-    const absl::flat_hash_map<std::string, Value>& kwargs) {
+    const absl::flat_hash_map<std::string, Value>& kwargs) const {
   XLS_ASSIGN_OR_RETURN(std::vector<Value> positional_args,
                        KeywordArgsToPositional(metadata_.param_names, kwargs));
   return Run(positional_args);
 }
 
+absl::StatusOr<InterpreterResult<std::vector<Value>>> FunctionJit::RunBatched(
+    absl::Span<const std::vector<Value>> args) const {
+  XLS_RET_CHECK(jitted_function_base_.HasBatchedFunction());
+  for (const std::vector<Value>& arg_set : args) {
+    if (arg_set.size() != metadata_.ParamCount()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Arg list to '%s' has the wrong size: %d vs expected %d.",
+          metadata_.name, arg_set.size(), metadata_.ParamCount()));
+    }
+    for (int64_t i = 0; i < metadata_.ParamCount(); ++i) {
+      if (!ValueConformsToType(arg_set[i], metadata_.param_types[i])) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Got argument %s for parameter %d which is not of type %s",
+            arg_set[i].ToString(), i, metadata_.param_types[i]->ToString()));
+      }
+    }
+  }
+
+  int64_t count = args.size();
+  JitArgumentSet arg_arenas =
+      jitted_function_base_.CreateBatchedInputBuffer(count);
+  JitArgumentSet result_arenas =
+      jitted_function_base_.CreateBatchedOutputBuffer(count);
+  for (int64_t i = 0; i < metadata_.ParamCount(); ++i) {
+    int64_t stride = GetBatchedArgStride(i);
+    for (int64_t k = 0; k < count; ++k) {
+      jit_runtime_->BlitValueToBuffer(
+          args[k][i], metadata_.param_types[i],
+          absl::MakeSpan(arg_arenas.pointers()[i] + k * stride,
+                         GetArgTypeSize(i)));
+    }
+  }
+
+  InterpreterEvents events;
+  PooledScratch scratch(this);
+  jitted_function_base_.RunBatchedJittedFunction(
+      arg_arenas.get(), result_arenas.get(), scratch->temp_.get(), &events,
+      /*instance_context=*/&callbacks_, /*jit_runtime=*/runtime(), count);
+
+  std::vector<Value> results;
+  results.reserve(count);
+  for (int64_t k = 0; k < count; ++k) {
+    results.push_back(jit_runtime_->UnpackBuffer(
+        result_arenas.pointers()[0] + k * GetBatchedReturnStride(),
+        metadata_.return_type));
+  }
+  return InterpreterResult<std::vector<Value>>{std::move(results),
+                                               std::move(events)};
+}
+
+absl::Status FunctionJit::CheckBatchedArenas(
+    absl::Span<const absl::Span<const uint8_t>> args,
+    absl::Span<const int64_t> arg_strides, absl::Span<uint8_t> result,
+    int64_t result_stride, int64_t count) const {
+  if (args.size() != metadata_.ParamCount()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        args.size(), metadata_.ParamCount()));
+  }
+  if (count < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Batch size must be non-negative, got %d.", count));
+  }
+  for (int64_t i = 0; i < args.size(); ++i) {
+    if (args[i].size() < arg_strides[i] * count) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Arena for argument %d too small - must be at least %d bytes!", i,
+          arg_strides[i] * count));
+    }
+  }
+  if (result.size() < result_stride * count) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result arena too small - must be at least %d bytes!",
+        result_stride * count));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status FunctionJit::RunBatchedWithViews(
+    absl::Span<const absl::Span<const uint8_t>> args,
+    absl::Span<uint8_t> result, int64_t count,
+    InterpreterEvents* events) const {
+  XLS_RET_CHECK(jitted_function_base_.HasBatchedFunction());
+  XLS_RETURN_IF_ERROR(CheckBatchedArenas(
+      args, jitted_function_base_.input_batch_strides(), result,
+      GetBatchedReturnStride(), count));
+  std::vector<const uint8_t*> arg_buffers;
+  arg_buffers.reserve(args.size());
+  for (int64_t i = 0; i < args.size(); ++i) {
+    if (reinterpret_cast<uintptr_t>(args[i].data()) % GetArgTypeAlignment(i) !=
+        0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Arena for argument %d does not have alignment of %d.", i,
+          GetArgTypeAlignment(i)));
+    }
+    arg_buffers.push_back(args[i].data());
+  }
+  if (reinterpret_cast<uintptr_t>(result.data()) % GetReturnTypeAlignment() !=
+      0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Result arena does not have alignment of %d.",
+                        GetReturnTypeAlignment()));
+  }
+  uint8_t* result_buffers[1] = {result.data()};
+  PooledScratch scratch(this);
+  jitted_function_base_.RunBatchedJittedFunction(
+      arg_buffers.data(), result_buffers, scratch->temp_.get(), events,
+      /*instance_context=*/&callbacks_, runtime(), count);
+  return absl::OkStatus();
+}
+
+absl::Status FunctionJit::RunBatchedWithPackedViews(
+    absl::Span<const absl::Span<const uint8_t>> args,
+    absl::Span<uint8_t> result, int64_t count,
+    InterpreterEvents* events) const {
+  XLS_RET_CHECK(jitted_function_base_.HasBatchedFunction());
+  XLS_RETURN_IF_ERROR(CheckBatchedArenas(
+      args, jitted_function_base_.packed_input_buffer_sizes(), result,
+      jitted_function_base_.packed_output_buffer_sizes()[0], count));
+  std::vector<const uint8_t*> arg_buffers;
+  arg_buffers.reserve(args.size());
+  for (absl::Span<const uint8_t> arg : args) {
+    arg_buffers.push_back(arg.data());
+  }
+  uint8_t* result_buffers[1] = {result.data()};
+  PooledScratch scratch(this);
+  jitted_function_base_.RunPackedBatchedJittedFunction(
+      arg_buffers.data(), result_buffers, scratch->temp_.get(), events,
+      /*instance_context=*/&callbacks_, runtime(), count);
+  return absl::OkStatus();
+}
+
 template <bool kForceZeroCopy>
 absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
                                        absl::Span<uint8_t> result_buffer,
-                                       InterpreterEvents* events) {
+                                       InterpreterEvents* events) const {
+  PooledScratch scratch(this);
+  return RunWithViews<kForceZeroCopy>(args, result_buffer, events, *scratch);
+}
+
+template <bool kForceZeroCopy>
+absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
+                                       absl::Span<uint8_t> result_buffer,
+                                       InterpreterEvents* events,
+                                       FunctionJitScratch& scratch) const {
+  XLS_RET_CHECK_EQ(scratch.temp_.source(), &jitted_function_base_)
+      << "Scratch was created by a different FunctionJit.";
   if (args.size() != metadata_.ParamCount()) {
     return absl::InvalidArgumentError(
         absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
@@ -222,32 +453,38 @@ absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
   }
 
   InvokeUnalignedJitFunction<kForceZeroCopy>(args, result_buffer.data(),
-                                             events);
+                                             events, scratch);
   return absl::OkStatus();
 }
 
 template absl::Status FunctionJit::RunWithViews</*kForceZeroCopy=*/true>(
     absl::Span<uint8_t* const> args, absl::Span<uint8_t> result_buffer,
-    InterpreterEvents* events);
+    InterpreterEvents* events) const;
+template absl::Status FunctionJit::RunWithViews</*kForceZeroCopy=*/false>(
+    absl::Span<uint8_t* const> args, absl::Span<uint8_t> result_buffer,
+    InterpreterEvents* events) const;
+template absl::Status FunctionJit::RunWithViews</*kForceZeroCopy=*/true>(
+    absl::Span<uint8_t* const> args, absl::Span<uint8_t> result_buffer,
+    InterpreterEvents* events, FunctionJitScratch& scratch) const;
 template absl::Status FunctionJit::RunWithViews</*kForceZeroCopy=*/false>(
     absl::Span<uint8_t* const> args, absl::Span<uint8_t> result_buffer,
-    InterpreterEvents* events);
+    InterpreterEvents* events, FunctionJitScratch& scratch) const;
 
 template <bool kForceZeroCopy>
 void FunctionJit::InvokeUnalignedJitFunction(
     absl::Span<const uint8_t* const> arg_buffers, uint8_t* output_buffer,
-    InterpreterEvents* events) {
+    InterpreterEvents* events, FunctionJitScratch& scratch) const {
   uint8_t* output_buffers[1] = {output_buffer};
   jitted_function_base_.RunUnalignedJittedFunction<kForceZeroCopy>(
-      arg_buffers.data(), output_buffers, temp_buffer_.get(), events,
+      arg_buffers.data(), output_buffers, scratch.temp_.get(), events,
       /*instance_context=*/&callbacks_, runtime(), /*continuation=*/0);
 }
 
 template void FunctionJit::InvokeUnalignedJitFunction</*kForceZeroCopy=*/false>(
     absl::Span<const uint8_t* const> arg_buffers, uint8_t* output_buffer,
-    InterpreterEvents* events);
+    InterpreterEvents* events, FunctionJitScratch& scratch) const;
 template void FunctionJit::InvokeUnalignedJitFunction</*kForceZeroCopy=*/true>(
     absl::Span<const uint8_t* const> arg_buffers, uint8_t* output_buffer,
-    InterpreterEvents* events);
+    InterpreterEvents* events, FunctionJitScratch& scratch) const;
 
 }  // namespace xls
@@ -23,9 +23,11 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/Function.h"
 #include "xls/common/status/ret_check.h"
@@ -39,23 +41,76 @@
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/llvm_compiler.h"
+#include "xls/jit/native_layout_view.h"
+#include "xls/jit/node_profiler.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
+class FunctionJit;
+
+// The argument, result and temporary buffers used by a single invocation of a
+// FunctionJit. Invocations using different scratch objects do not share any
+// mutable state and may run concurrently. A scratch object may only be used
+// with the FunctionJit which created it.
+class FunctionJitScratch {
+ public:
+  FunctionJitScratch(FunctionJitScratch&&) = default;
+  FunctionJitScratch& operator=(FunctionJitScratch&&) = default;
+  FunctionJitScratch(const FunctionJitScratch&) = delete;
+  FunctionJitScratch& operator=(const FunctionJitScratch&) = delete;
+
+ private:
+  friend class FunctionJit;
+
+  explicit FunctionJitScratch(const JittedFunctionBase& jitted_function)
+      : args_(jitted_function.CreateInputBuffer()),
+        results_(jitted_function.CreateOutputBuffer()),
+        temp_(jitted_function.CreateTempBuffer()) {}
+
+  JitArgumentSet args_;
+  JitArgumentSet results_;
+  JitTempBuffer temp_;
+};
+
 // This class provides a facility to execute XLS functions (on the host) by
-// converting it to LLVM IR, compiling it, and finally executing it. Not
-// thread-safe due to sharing of result and temporary buffers between
-// invocations of Run.
+// converting it to LLVM IR, compiling it, and finally executing it.
+//
+// The const run methods are thread-safe: a single compilation may be invoked
+// from many threads at once. Each invocation borrows scratch buffers from a
+// pool owned by the FunctionJit (growing the pool if all scratch buffers are
+// in use), or uses a FunctionJitScratch supplied by the caller. RunInPlace and
+// the views returned by GetArgView/GetResultView share a single set of
+// buffers and are not thread-safe. Setting the runtime observer concurrently
+// with an invocation is not thread-safe, and an observer which is set is
+// notified from every thread running the function.
 class FunctionJit {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // function.
+  // function. `batch_options` controls the code generated for the batched run
+  // methods (e.g., RunBatched). If `node_profiler` is given the compiled code
+  // records the cycles spent in each node into it; it must outlive the
+  // returned object.
   static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
       Function* xls_function, int64_t opt_level = 3,
       bool include_observer_callbacks = false,
-      JitObserver* jit_observer = nullptr);
+      JitObserver* jit_observer = nullptr,
+      const JitBatchOptions& batch_options = JitBatchOptions(),
+      NodeProfiler* node_profiler = nullptr);
+
+  // As above but the LLVM optimization level (and whether to vectorize) is
+  // chosen by ChooseAdaptiveOptimization from the number of nodes in the
+  // function and the functions it invokes and from `expected_invocations`, the
+  // number of times the function is expected to be run, if known.
+  static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateAdaptive(
+      Function* xls_function, std::optional<int64_t> expected_invocations,
+      const AdaptiveOptOptions& options = AdaptiveOptOptions(),
+      bool include_observer_callbacks = false,
+      JitObserver* jit_observer = nullptr,
+      const JitBatchOptions& batch_options = JitBatchOptions());
 
   // Returns an object containing an AOT-compiled version of the specified XLS
   // function.
@@ -67,14 +122,28 @@ class FunctionJit {
   // Returns the bytes of an object file containing the compiled XLS function.
   static absl::StatusOr<JitObjectCode> CreateObjectCode(
       Function* xls_function, int64_t opt_level, bool include_msan,
-      JitObserver* observer = nullptr);
+      JitObserver* observer = nullptr,
+      const LlvmPgoOptions& pgo_options = LlvmPgoOptions());
 
   // Executes the compiled function with the specified arguments.
-  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      absl::Span<const Value> args) const;
+
+  // As above but uses the caller-supplied `scratch` (created by CreateScratch)
+  // rather than borrowing scratch buffers from the pool. Threads each holding
+  // their own scratch never contend on the pool.
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      absl::Span<const Value> args, FunctionJitScratch& scratch) const;
 
   // As above, buth with arguments as key-value pairs.
   absl::StatusOr<InterpreterResult<Value>> Run(
-      const absl::flat_hash_map<std::string, Value>& kwargs);
+      const absl::flat_hash_map<std::string, Value>& kwargs) const;
+
+  // Returns a new set of scratch buffers for use with the Run overloads which
+  // take a FunctionJitScratch.
+  FunctionJitScratch CreateScratch() const {
+    return FunctionJitScratch(jitted_function_base_);
+  }
 
   // Executes the compiled function with the arguments and results specified as
   // "views" - flat buffers onto which structures layouts can be applied (see
@@ -91,7 +160,14 @@ class FunctionJit {
   template <bool kForceZeroCopy = false>
   absl::Status RunWithViews(absl::Span<uint8_t* const> args,
                             absl::Span<uint8_t> result_buffer,
-                            InterpreterEvents* events);
+                            InterpreterEvents* events) const;
+
+  // As above but uses the caller-supplied `scratch` for temporary storage.
+  template <bool kForceZeroCopy = false>
+  absl::Status RunWithViews(absl::Span<uint8_t* const> args,
+                            absl::Span<uint8_t> result_buffer,
+                            InterpreterEvents* events,
+                            FunctionJitScratch& scratch) const;
 
   // Similar to RunWithViews(), except the arguments here are _packed_views_ -
   // views whose data elements are tightly packed, with no padding bits or bytes
@@ -112,7 +188,7 @@ class FunctionJit {
   // and especially the packed-view-using-call - interface; there are some
   // sharp edges here!
   template <typename... ArgsT>
-  absl::Status RunWithPackedViews(ArgsT... args) {
+  absl::Status RunWithPackedViews(ArgsT... args) const {
     XLS_RET_CHECK(jitted_function_base_.HasPackedFunction());
     const uint8_t* arg_buffers[sizeof...(ArgsT)];
     uint8_t* result_buffer;
@@ -121,16 +197,43 @@ class FunctionJit {
 
     InterpreterEvents events;
     uint8_t* output_buffers[1] = {result_buffer};
+    PooledScratch scratch(this);
     jitted_function_base_.RunPackedJittedFunction(
-        arg_buffers, output_buffers, temp_buffer_.get(), &events,
+        arg_buffers, output_buffers, scratch->temp_.get(), &events,
         /*instance_context=*/&callbacks_, runtime(), /*continuation_point=*/0);
 
     return InterpreterEventsToStatus(events);
   }
 
+  // Executes the compiled function on each of the given argument sets with a
+  // single call into the jitted code. Returns the results in the same order as
+  // `args`. The events of all invocations are combined.
+  absl::StatusOr<InterpreterResult<std::vector<Value>>> RunBatched(
+      absl::Span<const std::vector<Value>> args) const;
+
+  // Executes the compiled function on `count` argument sets with a single call
+  // into the jitted code and without copying the arguments or results.
+  // `args[i]` is an arena holding `count` consecutive values of the i-th
+  // parameter in the native LLVM data layout, GetBatchedArgStride(i) bytes
+  // apart. Similarly `result` holds `count` return values
+  // GetBatchedReturnStride() bytes apart. Arenas must be aligned to
+  // GetArgTypeAlignment(i) (GetReturnTypeAlignment() for the result).
+  absl::Status RunBatchedWithViews(
+      absl::Span<const absl::Span<const uint8_t>> args,
+      absl::Span<uint8_t> result, int64_t count,
+      InterpreterEvents* events) const;
+
+  // As RunBatchedWithViews but the values are in the packed layout, each
+  // GetPackedArgTypeSize(i) (GetPackedReturnTypeSize() for the result) bytes
+  // after the previous one. The arenas need not be aligned.
+  absl::Status RunBatchedWithPackedViews(
+      absl::Span<const absl::Span<const uint8_t>> args,
+      absl::Span<uint8_t> result, int64_t count,
+      InterpreterEvents* events) const;
+
   // Same as RunWithPackedViews but expects a View rather than a PackedView.
   template <typename... ArgsT>
-  absl::Status RunWithUnpackedViews(ArgsT... args) {
+  absl::Status RunWithUnpackedViews(ArgsT... args) const {
     return RunWithUnpackedViewsCommon</*kForceZeroCopy=*/false, ArgsT...>(
         args...);
   }
@@ -141,7 +244,7 @@ class FunctionJit {
   // NOTE: Alignment is determined by LLVM and might change with little warning.
   // TODO(allight): 2023-12-6 We need to make this more usable safely.
   template <typename... ArgsT>
-  absl::Status RunWithUnpackedViewsZeroCopy(ArgsT... args) {
+  absl::Status RunWithUnpackedViewsZeroCopy(ArgsT... args) const {
     return RunWithUnpackedViewsCommon</*kForceZeroCopy=*/true, ArgsT...>(
         args...);
   }
@@ -165,13 +268,50 @@ class FunctionJit {
     return jitted_function_base_.output_buffer_abi_alignments()[0];
   }
 
+  // Gets the native layout of the compiled function's arguments (or return
+  // value). Native layout views over these layouts can fill argument buffers
+  // and inspect result buffers passed to RunWithViews without constructing
+  // Values.
+  const TypeLayout& GetArgTypeLayout(int arg_index) const {
+    return arg_layouts_.at(arg_index);
+  }
+  const TypeLayout& GetReturnTypeLayout() const { return return_layout_; }
+
+  // Returns views of the preallocated argument (or result) buffers used by
+  // RunInPlace. Not thread safe.
+  MutableNativeLayoutView GetArgView(int arg_index) {
+    return MutableNativeLayoutView(
+        &arg_layouts_.at(arg_index),
+        in_place_scratch_.args_.pointers()[arg_index]);
+  }
+  NativeLayoutView GetResultView() const {
+    return NativeLayoutView(&return_layout_,
+                            in_place_scratch_.results_.pointers()[0]);
+  }
+
+  // Runs the function on the arguments written through the views returned by
+  // GetArgView. The result may be read through GetResultView until the next
+  // invocation. No Values are constructed and no data is copied. Not thread
+  // safe.
+  void RunInPlace(InterpreterEvents* events);
+
+  // Gets the distance in bytes between consecutive values of the compiled
+  // function's arguments (or return value) in the arenas passed to
+  // RunBatchedWithViews.
+  int64_t GetBatchedArgStride(int arg_index) const {
+    return jitted_function_base_.input_batch_strides()[arg_index];
+  }
+  int64_t GetBatchedReturnStride() const {
+    return jitted_function_base_.output_batch_strides()[0];
+  }
+
   // Gets the size of the compiled function's arguments (or return value) in the
   // packed layout.
   int64_t GetPackedArgTypeSize(int arg_index) const {
     return jitted_function_base_.packed_input_buffer_sizes().at(arg_index);
   }
   int64_t GetPackedReturnTypeSize() const {
-    return jitted_function_base_.output_buffer_sizes()[0];
+    return jitted_function_base_.packed_output_buffer_sizes()[0];
   }
 
   // Returns the size of the temporary buffer which must be passed to the jitted
@@ -207,6 +347,12 @@ class FunctionJit {
   }
   bool SupportsObservers() const { return has_observer_callbacks_; }
 
+  // Traces with a verbosity above `verbosity` are dropped by the jitted code
+  // before they are recorded or formatted. By default all traces are recorded.
+  void SetMaxTraceVerbosity(int64_t verbosity) {
+    callbacks_.max_trace_verbosity = verbosity;
+  }
+
  private:
   struct InterfaceMetadata {
     std::string name;
@@ -232,18 +378,49 @@ class FunctionJit {
       : metadata_(std::move(metadata)),
         orc_jit_(std::move(orc_jit)),
         jitted_function_base_(std::move(jitted_function_base)),
-        arg_buffers_(jitted_function_base_.CreateInputBuffer()),
-        result_buffers_(jitted_function_base_.CreateOutputBuffer()),
-        temp_buffer_(jitted_function_base_.CreateTempBuffer()),
+        in_place_scratch_(jitted_function_base_),
         jit_runtime_(std::move(runtime)),
+        arg_layouts_(CreateArgLayouts(metadata_, jit_runtime_.get())),
+        return_layout_(jit_runtime_->CreateTypeLayout(metadata_.return_type)),
         has_observer_callbacks_(has_observer_callbacks) {}
 
+  static std::vector<TypeLayout> CreateArgLayouts(
+      const InterfaceMetadata& metadata, JitRuntime* runtime);
+
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
-      Function* xls_function, int64_t opt_level,
-      bool include_observer_callbacks, JitObserver* jit_observer);
+      Function* xls_function, const LlvmOptimization& optimization,
+      bool include_observer_callbacks, JitObserver* jit_observer,
+      const JitBatchOptions& batch_options,
+      NodeProfiler* node_profiler = nullptr);
+
+  // Scratch buffers borrowed from the pool for the duration of a single
+  // invocation.
+  class PooledScratch {
+   public:
+    explicit PooledScratch(const FunctionJit* jit)
+        : jit_(jit), scratch_(jit->AcquireScratch()) {}
+    ~PooledScratch() { jit_->ReleaseScratch(std::move(scratch_)); }
+    PooledScratch(const PooledScratch&) = delete;
+    PooledScratch& operator=(const PooledScratch&) = delete;
+
+    FunctionJitScratch& operator*() const { return *scratch_; }
+    FunctionJitScratch* operator->() const { return scratch_.get(); }
+
+   private:
+    const FunctionJit* jit_;
+    std::unique_ptr<FunctionJitScratch> scratch_;
+  };
+
+  // Takes a scratch from the pool, creating a new one if the pool is empty.
+  std::unique_ptr<FunctionJitScratch> AcquireScratch() const;
+  // Returns `scratch` to the pool.
+  void ReleaseScratch(std::unique_ptr<FunctionJitScratch> scratch) const;
+
+  absl::StatusOr<InterpreterResult<Value>> RunWithScratch(
+      absl::Span<const Value> args, FunctionJitScratch& scratch) const;
 
   template <bool kForceZeroCopy, typename... ArgsT>
-  absl::Status RunWithUnpackedViewsCommon(ArgsT... args) {
+  absl::Status RunWithUnpackedViewsCommon(ArgsT... args) const {
     const uint8_t* arg_buffers[sizeof...(ArgsT)];
     uint8_t* result_buffer;
 
@@ -251,8 +428,9 @@ class FunctionJit {
     PackArgBuffers(arg_buffers, &result_buffer, args...);
 
     InterpreterEvents events;
+    PooledScratch scratch(this);
     InvokeUnalignedJitFunction<kForceZeroCopy>(arg_buffers, result_buffer,
-                                               &events);
+                                               &events, *scratch);
     return InterpreterEventsToStatus(events);
   }
 
@@ -281,7 +459,7 @@ class FunctionJit {
   // arg/buffer pointer.
   template <typename FrontT, typename... RestT>
   void PackArgBuffers(const uint8_t** arg_buffers, uint8_t** result_buffer,
-                      FrontT front, RestT... rest) {
+                      FrontT front, RestT... rest) const {
     arg_buffers[0] = front.buffer();
     PackArgBuffers(&arg_buffers[1], result_buffer, rest...);
   }
@@ -289,15 +467,24 @@ class FunctionJit {
   // Base case for the above recursive template.
   template <typename LastT>
   void PackArgBuffers(const uint8_t** arg_buffers, uint8_t** result_buffer,
-                      LastT front) {
+                      LastT front) const {
     *result_buffer = front.mutable_buffer();
   }
 
-  // Invokes the jitted function with the given argument and outputs.
+  // Checks that the arenas passed to one of the batched run methods are large
+  // enough to hold `count` values given the per-value strides.
+  absl::Status CheckBatchedArenas(
+      absl::Span<const absl::Span<const uint8_t>> args,
+      absl::Span<const int64_t> arg_strides, absl::Span<uint8_t> result,
+      int64_t result_stride, int64_t count) const;
+
+  // Invokes the jitted function with the given argument and outputs using the
+  // temporary buffer of `scratch`.
   template <bool kForceZeroCopy = false>
   void InvokeUnalignedJitFunction(absl::Span<const uint8_t* const> arg_buffers,
                                   uint8_t* output_buffer,
-                                  InterpreterEvents* events);
+                                  InterpreterEvents* events,
+                                  FunctionJitScratch& scratch) const;
 
   InterfaceMetadata metadata_;
 
@@ -305,19 +492,25 @@ class FunctionJit {
 
   JittedFunctionBase jitted_function_base_;
 
-  // Pre-allocated & aligned storage for a set of arguments. Not thread safe.
-  JitArgumentSet arg_buffers_;
-  // Pre-allocated & aligned storage for a result. Not thread safe.
-  JitArgumentSet result_buffers_;
-  // Pre-allocated & aligned storage for required temporary storage. NB Not
-  // thread safe.
-  JitTempBuffer temp_buffer_;
+  // Pre-allocated & aligned storage used by RunInPlace and the argument and
+  // result views. Not thread safe.
+  FunctionJitScratch in_place_scratch_;
 
-  // Context callbacks.
-  InstanceContext callbacks_ = InstanceContext::CreateForFunc();
+  // Scratch buffers not currently used by any invocation.
+  mutable absl::Mutex scratch_pool_mutex_;
+  mutable std::vector<std::unique_ptr<FunctionJitScratch>> scratch_pool_
+      ABSL_GUARDED_BY(scratch_pool_mutex_);
+
+  // Context callbacks. Only read by the jitted code, mutable so the const run
+  // methods can pass it along.
+  mutable InstanceContext callbacks_ = InstanceContext::CreateForFunc();
 
   std::unique_ptr<JitRuntime> jit_runtime_;
 
+  // Native layouts of the arguments and the return value.
+  std::vector<TypeLayout> arg_layouts_;
+  TypeLayout return_layout_;
+
   // Are callbacks for node-values compiled in.
   bool has_observer_callbacks_;
 };
@@ -15,6 +15,7 @@
 #include "xls/jit/function_jit.h"
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <initializer_list>
@@ -44,12 +45,18 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/Instruction.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/IR/Value.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/random_value.h"
@@ -68,6 +75,7 @@
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_compiler.h"
+#include "xls/jit/native_layout_view.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
@@ -80,6 +88,7 @@ using ::absl_testing::StatusIs;
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
+using ::testing::Not;
 using ::testing::TestParamInfo;
 using ::testing::Values;
 
@@ -292,6 +301,34 @@ TEST(FunctionJitTest, TraceFmtBigArgTest) {
             "00000000000000000000000000000000000000000000000000000000000000");
 }
 
+TEST(FunctionJitTest, TraceCompoundArgsAndVerbosityFilter) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn traces(tkn: token, x: bits[8], y: bits[100]) -> token {
+    literal.1: bits[1] = literal(value=1)
+    tuple.2: (bits[8], bits[100]) = tuple(x, y)
+    array.3: bits[8][2] = array(x, x)
+    trace.4: token = trace(tkn, literal.1, format="t: {:x} a: {}", data_operands=[tuple.2, array.3], id=4)
+    ret trace.5: token = trace(trace.4, literal.1, format="y is {:d}", data_operands=[y], verbosity=2, id=5)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  std::vector<Value> args = {Value::Token(), Value(UBits(0xab, 8)),
+                             Value(UBits(5, 100))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre(TraceMessage("t: (0xab, 0x5) a: [171, 171]", 0),
+                          TraceMessage("y is 5", 2)));
+
+  jit->SetMaxTraceVerbosity(1);
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->Run(args));
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre(TraceMessage("t: (0xab, 0x5) a: [171, 171]", 0)));
+}
+
 // This test verifies that a compiled JIT function can be reused.
 TEST(FunctionJitTest, ReuseTest) {
   Package package("my_package");
@@ -312,6 +349,42 @@ TEST(FunctionJitTest, ReuseTest) {
               IsOkAndHolds(Value(UBits(7, 8))));
 }
 
+// Chains of array updates whose intermediate arrays have no other uses share
+// one buffer. Verify the results when the chain forks and when an update is
+// out of bounds.
+TEST(FunctionJitTest, ArrayUpdateChain) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn f(a: bits[8][4], x: bits[8]) -> (bits[8][4], bits[8][4], bits[8][4]) {
+    literal.1: bits[2] = literal(value=0)
+    literal.2: bits[2] = literal(value=1)
+    literal.3: bits[2] = literal(value=2)
+    literal.4: bits[2] = literal(value=3)
+    literal.5: bits[3] = literal(value=7)
+    add.6: bits[8] = add(x, x)
+    array_update.7: bits[8][4] = array_update(a, x, indices=[literal.1])
+    array_update.8: bits[8][4] = array_update(array_update.7, add.6, indices=[literal.2])
+    array_update.9: bits[8][4] = array_update(array_update.8, x, indices=[literal.5])
+    array_update.10: bits[8][4] = array_update(array_update.9, add.6, indices=[literal.3])
+    array_update.11: bits[8][4] = array_update(array_update.10, x, indices=[literal.4])
+    array_update.12: bits[8][4] = array_update(array_update.10, add.6, indices=[literal.1])
+    ret tuple.13: (bits[8][4], bits[8][4], bits[8][4]) = tuple(a, array_update.11, array_update.12)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value a, Value::UBitsArray({10, 11, 12, 13}, /*bit_count=*/8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value a_11,
+                           Value::UBitsArray({3, 6, 6, 3}, /*bit_count=*/8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value a_12,
+                           Value::UBitsArray({6, 6, 6, 13}, /*bit_count=*/8));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {a, Value(UBits(3, 8))}),
+              IsOkAndHolds(Value::Tuple({a, a_11, a_12})));
+}
+
 TEST(FunctionJitTest, OneHotZeroBit) {
   Package package("my_package");
   std::string ir_text = R"(
@@ -397,6 +470,262 @@ TEST(FunctionJitTest, PackedAndUnpackedSmokeWide) {
 }
 
 // Tests PackedBitView<X> input/output handling.
+TEST(FunctionJitTest, RunBatched) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn add(x: bits[17], y: (bits[17], bits[3])) -> bits[17] {
+    tuple_index.1: bits[17] = tuple_index(y, index=0)
+    ret add.2: bits[17] = add(x, tuple_index.1)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  std::vector<std::vector<Value>> args;
+  std::vector<Value> expected;
+  for (int64_t i = 0; i < 100; ++i) {
+    args.push_back({Value(UBits(i, 17)),
+                    Value::Tuple({Value(UBits(1000 * i, 17)),
+                                  Value(UBits(i % 8, 3))})});
+    expected.push_back(Value(UBits((1001 * i) % (1 << 17), 17)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> result,
+                           jit->RunBatched(args));
+  EXPECT_EQ(result.value, expected);
+  EXPECT_TRUE(result.events.trace_msgs.empty());
+
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->RunBatched({}));
+  EXPECT_TRUE(result.value.empty());
+
+  std::vector<std::vector<Value>> bad_args = {{Value(UBits(1, 17))}};
+  EXPECT_THAT(jit->RunBatched(bad_args),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("wrong size")));
+}
+
+TEST(FunctionJitTest, RunBatchedWithViews) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn add(x: bits[17], y: bits[17]) -> bits[17] {
+    ret add.1: bits[17] = add(x, y)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  ASSERT_EQ(jit->GetBatchedArgStride(0), sizeof(uint32_t));
+  ASSERT_EQ(jit->GetBatchedReturnStride(), sizeof(uint32_t));
+
+  constexpr int64_t kCount = 64;
+  std::vector<uint32_t> x(kCount);
+  std::vector<uint32_t> y(kCount);
+  std::vector<uint32_t> result(kCount);
+  for (int64_t i = 0; i < kCount; ++i) {
+    x[i] = i;
+    y[i] = 3 * i + 1;
+  }
+  auto as_bytes = [](std::vector<uint32_t>& v) {
+    return absl::MakeSpan(reinterpret_cast<uint8_t*>(v.data()),
+                          v.size() * sizeof(uint32_t));
+  };
+  InterpreterEvents events;
+  XLS_ASSERT_OK(jit->RunBatchedWithViews({as_bytes(x), as_bytes(y)},
+                                         as_bytes(result), kCount, &events));
+  for (int64_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(result[i], static_cast<uint32_t>(4 * i + 1)) << i;
+  }
+
+  // Arenas which are too small are rejected.
+  EXPECT_THAT(jit->RunBatchedWithViews({as_bytes(x), as_bytes(y)},
+                                       as_bytes(result), kCount + 1, &events),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("too small")));
+}
+
+TEST(FunctionJitTest, RunBatchedWithPackedViews) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn add(x: bits[17], y: bits[17]) -> bits[17] {
+    ret add.1: bits[17] = add(x, y)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  ASSERT_EQ(jit->GetPackedArgTypeSize(0), 3);
+  ASSERT_EQ(jit->GetPackedReturnTypeSize(), 3);
+
+  constexpr int64_t kCount = 10;
+  std::vector<uint8_t> x(3 * kCount);
+  std::vector<uint8_t> y(3 * kCount);
+  std::vector<uint8_t> result(3 * kCount);
+  for (int64_t i = 0; i < kCount; ++i) {
+    Bits x_bits = UBits(10000 * i, 17);
+    Bits y_bits = UBits(i, 17);
+    x_bits.ToBytes(absl::MakeSpan(x).subspan(3 * i, 3));
+    y_bits.ToBytes(absl::MakeSpan(y).subspan(3 * i, 3));
+  }
+  InterpreterEvents events;
+  XLS_ASSERT_OK(jit->RunBatchedWithPackedViews(
+      {absl::MakeConstSpan(x), absl::MakeConstSpan(y)}, absl::MakeSpan(result),
+      kCount, &events));
+  for (int64_t i = 0; i < kCount; ++i) {
+    Bits expected = UBits((10001 * i) % (1 << 17), 17);
+    std::vector<uint8_t> expected_bytes = expected.ToBytes();
+    EXPECT_THAT(absl::MakeConstSpan(result).subspan(3 * i, 3),
+                ElementsAreArray(expected_bytes))
+        << i;
+  }
+}
+
+// Counts the instructions of the optimized module which produce or consume
+// vector values.
+class VectorInstructionObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const override {
+    return JitObserverRequests{.optimized_module = true};
+  }
+  void OptimizedModule(const llvm::Module* module) override {
+    for (const llvm::Function& function : *module) {
+      for (const llvm::BasicBlock& block : function) {
+        for (const llvm::Instruction& instruction : block) {
+          bool is_vector = instruction.getType()->isVectorTy();
+          for (const llvm::Value* operand : instruction.operand_values()) {
+            is_vector = is_vector || operand->getType()->isVectorTy();
+          }
+          if (is_vector) {
+            ++vector_instruction_count_;
+          }
+        }
+      }
+    }
+  }
+  int64_t vector_instruction_count() const {
+    return vector_instruction_count_;
+  }
+
+ private:
+  int64_t vector_instruction_count_ = 0;
+};
+
+class VectorizedFunctionJitTest : public ::testing::TestWithParam<int64_t> {};
+
+TEST_P(VectorizedFunctionJitTest, RunBatchedMatchesScalar) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn f(x: bits[8], y: bits[8], z: bits[3]) -> (bits[8], bits[1]) {
+    add.1: bits[8] = add(x, y)
+    and.2: bits[8] = and(x, y)
+    xor.3: bits[8] = xor(add.1, and.2)
+    shll.4: bits[8] = shll(xor.3, z)
+    ult.5: bits[1] = ult(x, y)
+    sel.6: bits[8] = sel(ult.5, cases=[shll.4, add.1])
+    ret tuple.7: (bits[8], bits[1]) = tuple(sel.6, ult.5)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto scalar_jit, FunctionJit::Create(function));
+  VectorInstructionObserver observer;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto vector_jit,
+      FunctionJit::Create(function, /*opt_level=*/3,
+                          /*include_observer_callbacks=*/false, &observer,
+                          JitBatchOptions{.vector_lanes = GetParam()}));
+  // With more than one lane the batch loop must actually have been
+  // vectorized.
+  if (GetParam() > 1) {
+    EXPECT_GT(observer.vector_instruction_count(), 0);
+  }
+
+  // Use a count which is not a multiple of the lane count to exercise the
+  // remainder iterations.
+  std::minstd_rand bitgen;
+  std::vector<std::vector<Value>> args;
+  for (int64_t i = 0; i < 101; ++i) {
+    args.push_back({RandomValue(package.GetBitsType(8), bitgen),
+                    RandomValue(package.GetBitsType(8), bitgen),
+                    RandomValue(package.GetBitsType(3), bitgen)});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> expected,
+                           scalar_jit->RunBatched(args));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> actual,
+                           vector_jit->RunBatched(args));
+  EXPECT_EQ(actual.value, expected.value);
+  for (int64_t i = 0; i < args.size(); ++i) {
+    EXPECT_THAT(RunJitNoEvents(vector_jit.get(), args[i]),
+                IsOkAndHolds(expected.value[i]));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(VectorizedFunctionJitTest, VectorizedFunctionJitTest,
+                         Values(1, 4, 8, 16),
+                         [](const TestParamInfo<int64_t>& info) {
+                           return absl::StrFormat("lanes_%d", info.param);
+                         });
+
+TEST(FunctionJitTest, VectorLanesMustBePowerOfTwo) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn get_identity(x: bits[8]) -> bits[8] {
+    ret identity.1: bits[8] = identity(x)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  EXPECT_THAT(FunctionJit::Create(function, /*opt_level=*/3,
+                                  /*include_observer_callbacks=*/false,
+                                  /*jit_observer=*/nullptr,
+                                  JitBatchOptions{.vector_lanes = 6}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("power of two")));
+}
+
+TEST(FunctionJitTest, PgoInstrumentedObjectCodeUsesProfileRuntime) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn choose(p: bits[1], x: bits[32], y: bits[32]) -> bits[32] {
+    ret sel.1: bits[32] = sel(p, cases=[x, y])
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      JitObjectCode object_code,
+      FunctionJit::CreateObjectCode(
+          function, /*opt_level=*/3, /*include_msan=*/false,
+          /*observer=*/nullptr,
+          LlvmPgoOptions{.mode = LlvmPgoOptions::Mode::kInstrument,
+                         .profile_path = "choose.profraw"}));
+  std::string_view object(
+      reinterpret_cast<const char*>(object_code.object_code.data()),
+      object_code.object_code.size());
+  EXPECT_THAT(object, HasSubstr("__llvm_profile_runtime"));
+  EXPECT_THAT(object, HasSubstr("choose.profraw"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      JitObjectCode plain_object_code,
+      FunctionJit::CreateObjectCode(function, /*opt_level=*/3,
+                                    /*include_msan=*/false));
+  std::string_view plain_object(
+      reinterpret_cast<const char*>(plain_object_code.object_code.data()),
+      plain_object_code.object_code.size());
+  EXPECT_THAT(plain_object, Not(HasSubstr("__llvm_profile_runtime")));
+}
+
+TEST(FunctionJitTest, PgoInstrumentationRequiresAot) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+  EXPECT_THAT(orc_jit->SetPgoOptions(
+                  LlvmPgoOptions{.mode = LlvmPgoOptions::Mode::kInstrument}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("only supported for AOT")));
+  EXPECT_THAT(orc_jit->SetPgoOptions(
+                  LlvmPgoOptions{.mode = LlvmPgoOptions::Mode::kUseProfile}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("profile path is required")));
+}
+
 template <int64_t kBitWidth>
 absl::Status TestPackedBits(absl::BitGenRef bitgen) {
   Package package("my_package");
@@ -1003,6 +1332,194 @@ fn f(x: bits[1], y: bits[21]) -> (bits[1], bits[21]) {
   }
 }
 
+TEST(FunctionJitTest, RunInPlaceWithNativeLayoutViews) {
+  Package package("my_package");
+  std::string ir_text = R"(
+fn f(x: bits[8][4], y: (bits[1], bits[40])) -> (bits[8], bits[40]) {
+  tuple_index.1: bits[1] = tuple_index(y, index=0)
+  array_index.2: bits[8] = array_index(x, indices=[tuple_index.1])
+  tuple_index.3: bits[40] = tuple_index(y, index=1)
+  ret tuple.4: (bits[8], bits[40]) = tuple(array_index.2, tuple_index.3)
+})";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  EXPECT_EQ(jit->GetArgTypeLayout(0).size(), jit->GetArgTypeSize(0));
+  EXPECT_EQ(jit->GetReturnTypeLayout().size(), jit->GetReturnTypeSize());
+
+  MutableNativeLayoutView x = jit->GetArgView(0);
+  for (int64_t i = 0; i < 4; ++i) {
+    x.mutable_element(i).SetUint64(10 + i);
+  }
+  MutableNativeLayoutView y = jit->GetArgView(1);
+  y.mutable_element(0).SetUint64(1);
+  y.mutable_element(1).SetUint64(0xab12345678);
+
+  InterpreterEvents events;
+  jit->RunInPlace(&events);
+  NativeLayoutView result = jit->GetResultView();
+  EXPECT_EQ(result.element(0).GetUint64(), 11);
+  EXPECT_EQ(result.element(1).GetUint64(), 0xab12345678);
+  EXPECT_EQ(result.ToValue(), Value::Tuple({Value(UBits(11, 8)),
+                                            Value(UBits(0xab12345678, 40))}));
+
+  // Only the modified leaf needs to be rewritten between invocations.
+  y.mutable_element(0).SetUint64(0);
+  jit->RunInPlace(&events);
+  EXPECT_EQ(jit->GetResultView().element(0).GetUint64(), 10);
+
+  // Views over caller-owned buffers work with RunWithViews.
+  std::vector<uint8_t> x_buffer(jit->GetArgTypeSize(0));
+  std::vector<uint8_t> y_buffer(jit->GetArgTypeSize(1));
+  std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
+  MutableNativeLayoutView(&jit->GetArgTypeLayout(0), x_buffer.data())
+      .SetValue(Value::UBitsArray({1, 2, 3, 4}, 8).value());
+  MutableNativeLayoutView y_view(&jit->GetArgTypeLayout(1), y_buffer.data());
+  y_view.mutable_element(0).SetUint64(1);
+  y_view.mutable_element(1).SetUint64(42);
+  std::vector<uint8_t*> args = {x_buffer.data(), y_buffer.data()};
+  XLS_ASSERT_OK(jit->RunWithViews(args, absl::MakeSpan(result_buffer),
+                                  &events));
+  NativeLayoutView result_view(&jit->GetReturnTypeLayout(),
+                               result_buffer.data());
+  EXPECT_EQ(result_view.element(0).GetUint64(), 2);
+  EXPECT_EQ(result_view.element(1).GetUint64(), 42);
+}
+
+TEST(FunctionJitTest, ConcurrentRun) {
+  Package package("my_package");
+  std::string ir_text = R"(
+fn f(x: bits[32], y: bits[32]) -> (bits[32], bits[32]) {
+  umul.1: bits[32] = umul(x, y)
+  add.2: bits[32] = add(umul.1, x)
+  sub.3: bits[32] = sub(add.2, y)
+  ret tuple.4: (bits[32], bits[32]) = tuple(add.2, sub.3)
+})";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(function));
+  const FunctionJit& shared_jit = *jit;
+
+  constexpr int64_t kThreadCount = 8;
+  constexpr uint32_t kIterations = 2000;
+  std::atomic<int64_t> mismatches = 0;
+  auto check = [&](uint32_t x, uint32_t y,
+                   absl::StatusOr<InterpreterResult<Value>> result) {
+    uint32_t sum = x * y + x;
+    Value expected =
+        Value::Tuple({Value(UBits(sum, 32)), Value(UBits(sum - y, 32))});
+    if (!result.ok() || result->value != expected) {
+      ++mismatches;
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      // Half the threads borrow scratch buffers from the pool, the others
+      // supply their own.
+      std::optional<FunctionJitScratch> scratch;
+      if (t % 2 == 1) {
+        scratch.emplace(shared_jit.CreateScratch());
+      }
+      for (uint32_t i = 0; i < kIterations; ++i) {
+        uint32_t x = static_cast<uint32_t>(t) * kIterations + i;
+        uint32_t y = i ^ 0x5a5a5a5a;
+        std::vector<Value> args = {Value(UBits(x, 32)), Value(UBits(y, 32))};
+        check(x, y,
+              scratch.has_value() ? shared_jit.Run(args, *scratch)
+                                  : shared_jit.Run(args));
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_EQ(mismatches, 0);
+}
+
+TEST(FunctionJitTest, ScratchFromOtherJitRejected) {
+  Package package("my_package");
+  std::string ir_text = R"(
+fn f(x: bits[8]) -> bits[8] {
+  ret neg.1: bits[8] = neg(x)
+})";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit_a, FunctionJit::Create(function));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit_b, FunctionJit::Create(function));
+  FunctionJitScratch scratch = jit_a->CreateScratch();
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           jit_a->Run({Value(UBits(1, 8))}, scratch));
+  EXPECT_EQ(result.value, Value(UBits(0xff, 8)));
+  EXPECT_THAT(jit_b->Run({Value(UBits(1, 8))}, scratch),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("different FunctionJit")));
+}
+
+TEST(FunctionJitTest, ChooseAdaptiveOptimization) {
+  AdaptiveOptOptions options{.large_node_count = 100,
+                             .huge_node_count = 1000,
+                             .hot_invocation_count = 50,
+                             .cold_invocation_count = 5};
+  auto opt_level = [&](int64_t nodes, std::optional<int64_t> invocations) {
+    return ChooseAdaptiveOptimization(nodes, invocations, options).opt_level;
+  };
+  EXPECT_EQ(opt_level(10, std::nullopt), 2);
+  EXPECT_EQ(opt_level(10, 50), 3);
+  EXPECT_EQ(opt_level(100, 50), 2);
+  EXPECT_EQ(opt_level(100, 1), 1);
+  EXPECT_EQ(opt_level(1000, std::nullopt), 1);
+  EXPECT_EQ(opt_level(1000, 1), 0);
+  EXPECT_TRUE(ChooseAdaptiveOptimization(10, 50, options).vectorize);
+  EXPECT_FALSE(ChooseAdaptiveOptimization(100, 50, options).vectorize);
+}
+
+class CompilationStatsObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const override {
+    return JitObserverRequests{.compilation_stats = true};
+  }
+  void CompilationStats(const llvm::Module* module,
+                        const JitCompilationStats& stats) override {
+    stats_.push_back(stats);
+  }
+  const std::vector<JitCompilationStats>& stats() const { return stats_; }
+
+ private:
+  std::vector<JitCompilationStats> stats_;
+};
+
+TEST(FunctionJitTest, CreateAdaptive) {
+  Package package("my_package");
+  std::string ir_text = R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  umul.1: bits[32] = umul(x, y)
+  ret add.2: bits[32] = add(umul.1, x)
+})";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  for (int64_t expected_invocations : {1, 1'000'000}) {
+    CompilationStatsObserver observer;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<FunctionJit> jit,
+        FunctionJit::CreateAdaptive(
+            function, expected_invocations,
+            AdaptiveOptOptions{.large_node_count = 2,
+                               .cold_invocation_count = 10},
+            /*include_observer_callbacks=*/false, &observer));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpreterResult<Value> result,
+        jit->Run({Value(UBits(3, 32)), Value(UBits(5, 32))}));
+    EXPECT_EQ(result.value, Value(UBits(18, 32)));
+    ASSERT_FALSE(observer.stats().empty());
+    EXPECT_EQ(observer.stats().front().opt_level,
+              expected_invocations == 1 ? 1 : 2);
+    EXPECT_FALSE(observer.stats().front().vectorize);
+  }
+}
+
 TEST(FunctionJitTest, TupleViewSmokeTest) {
   Package package("my_package");
 
@@ -65,7 +65,9 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/jit/bit_packed_arrays.h"
 #include "xls/jit/jit_callbacks.h"
+#include "xls/jit/jit_node_coverage.h"
 #include "xls/jit/llvm_type_converter.h"
 
 namespace xls {
@@ -585,69 +587,97 @@ llvm::Value* InvokeCallback(llvm::IRBuilder<>* builder, llvm::Type* return_type,
   return builder->CreateCall(fn_type, fn_ptr, all_args);
 }
 
-// Build the LLVM IR that handles string fragment format steps.
-absl::Status InvokeStringStepCallback(llvm::IRBuilder<>* builder,
-                                      const std::string& step_string,
-                                      llvm::Value* buffer_ptr,
-                                      llvm::Value* instance_ctx) {
-  llvm::Constant* step_constant = builder->CreateGlobalStringPtr(step_string);
-  InvokeCallback<InstanceContext::kPerformStringStepOffset>(
-      builder, llvm::Type::getVoidTy(builder->getContext()), instance_ctx,
-      {step_constant, buffer_ptr});
-  return absl::OkStatus();
-}
-
-// Build the LLVM IR that handles formatting a runtime value according to a
-// format preference.
-absl::Status InvokeFormatStepCallback(
-    llvm::IRBuilder<>* builder, FormatPreference format,
-    xls::Type* operand_type, llvm::Value* operand, llvm::Value* buffer_ptr,
-    llvm::Value* jit_runtime_ptr, llvm::Value* instance_ctx) {
-  // Note: we assume the package lifetime is >= that of the JIT code by
-  // capturing this type pointer as a value burned into the JIT code, which
-  // should always be true.
-  llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
-  auto* i64_type = llvm::Type::getInt64Ty(builder->getContext());
-
-  llvm::ConstantInt* llvm_format =
-      llvm::ConstantInt::get(i64_type, static_cast<uint64_t>(format));
-  auto proto_str = operand_type->ToProto().SerializeAsString();
-  llvm::ConstantInt* proto_len =
-      llvm::ConstantInt::get(i64_type, proto_str.size());
-  llvm::Constant* proto_llvm_str = builder->CreateGlobalStringPtr(proto_str);
-  InvokeCallback<InstanceContext::kPerformFormatStepOffset>(
-      builder, void_type, instance_ctx,
-      {jit_runtime_ptr, proto_llvm_str, proto_len, operand, llvm_format,
-       buffer_ptr});
-  return absl::OkStatus();
+// Build the LLVM IR to read or write channel queue `queue_index` by calling
+// the function at `slot_index` of its InstanceContext::ChannelQueueSlot with
+// the queue and `data`. If the instance context has no queue slots the
+// callback at `kCallbackOffset` is invoked with the queue index instead. On
+// return `builder` is positioned in the block after the call.
+template <int64_t kCallbackOffset>
+llvm::Value* InvokeQueueAccess(llvm::IRBuilder<>* builder,
+                               llvm::Type* return_type,
+                               llvm::Value* instance_ptr, int64_t queue_index,
+                               int64_t slot_index, llvm::Value* data) {
+  llvm::LLVMContext& context = builder->getContext();
+  llvm::Function* function = builder->GetInsertBlock()->getParent();
+  llvm::Type* ptr_type = llvm::PointerType::get(context, 0);
+  llvm::Value* slots_ptr = builder->CreateGEP(
+      builder->getInt8Ty(), instance_ptr,
+      builder->getInt64(InstanceContext::kChannelQueueSlotsOffset),
+      "queue_slots_ptr", llvm::GEPNoWrapFlags::inBounds());
+  llvm::Value* slots = builder->CreateLoad(ptr_type, slots_ptr, "queue_slots");
+
+  llvm::BasicBlock* direct_block =
+      llvm::BasicBlock::Create(context, "queue_direct", function);
+  llvm::BasicBlock* callback_block =
+      llvm::BasicBlock::Create(context, "queue_callback", function);
+  llvm::BasicBlock* join_block =
+      llvm::BasicBlock::Create(context, "queue_join", function);
+  builder->CreateCondBr(builder->CreateIsNotNull(slots), direct_block,
+                        callback_block);
+
+  llvm::IRBuilder<> direct_builder(direct_block);
+  llvm::StructType* slot_type =
+      llvm::StructType::get(context, {ptr_type, ptr_type, ptr_type});
+  llvm::Value* queue = direct_builder.CreateLoad(
+      ptr_type,
+      direct_builder.CreateGEP(
+          slot_type, slots,
+          {direct_builder.getInt64(queue_index),
+           direct_builder.getInt32(
+               InstanceContext::kChannelQueueSlotQueueIndex)}),
+      "queue");
+  llvm::Value* access_fn = direct_builder.CreateLoad(
+      ptr_type,
+      direct_builder.CreateGEP(slot_type, slots,
+                               {direct_builder.getInt64(queue_index),
+                                direct_builder.getInt32(slot_index)}),
+      "queue_access_fn");
+  llvm::FunctionType* access_fn_type = llvm::FunctionType::get(
+      return_type, {ptr_type, data->getType()}, /*isVarArg=*/false);
+  llvm::Value* direct_result =
+      direct_builder.CreateCall(access_fn_type, access_fn, {queue, data});
+  direct_builder.CreateBr(join_block);
+
+  llvm::IRBuilder<> callback_builder(callback_block);
+  llvm::Value* callback_result = InvokeCallback<kCallbackOffset>(
+      &callback_builder, return_type, instance_ptr,
+      {callback_builder.getInt64(queue_index), data});
+  callback_builder.CreateBr(join_block);
+
+  builder->SetInsertPoint(join_block);
+  if (return_type->isVoidTy()) {
+    return nullptr;
+  }
+  llvm::PHINode* result =
+      builder->CreatePHI(return_type, /*NumReservedValues=*/2);
+  result->addIncoming(direct_result, direct_block);
+  result->addIncoming(callback_result, callback_block);
+  return result;
 }
 
-// Build the LLVM IR to invoke the callback that records traces.
-absl::Status InvokeRecordTraceCallback(llvm::IRBuilder<>* builder,
-                                       int64_t verbosity,
-                                       llvm::Value* buffer_ptr,
-                                       llvm::Value* interpreter_events_ptr,
-                                       llvm::Value* instance_ctx) {
+// Build the LLVM IR to invoke the callback that records a trace for deferred
+// formatting. `operands` points to the data operands of the trace laid out as
+// a value of type `operands_type`.
+absl::Status InvokeDeferredTraceCallback(
+    llvm::IRBuilder<>* builder, absl::Span<const FormatStep> format,
+    int64_t verbosity, TupleType* operands_type, int64_t operands_size,
+    llvm::Value* operands, llvm::Value* interpreter_events_ptr,
+    llvm::Value* instance_ctx) {
   llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
 
-  llvm::Value* verbosity_value = builder->getInt64(verbosity);
-  std::vector<llvm::Value*> args = {buffer_ptr, verbosity_value,
-                                    interpreter_events_ptr};
-
-  InvokeCallback<InstanceContext::kRecordTraceOffset>(
+  std::string format_str = EncodeDeferredTraceFormat(format);
+  std::string proto_str = operands_type->ToProto().SerializeAsString();
+  InvokeCallback<InstanceContext::kRecordDeferredTraceOffset>(
       builder, void_type, instance_ctx,
-      {buffer_ptr, verbosity_value, interpreter_events_ptr});
+      {builder->CreateGlobalStringPtr(format_str),
+       builder->getInt64(format_str.size()),
+       builder->CreateGlobalStringPtr(proto_str),
+       builder->getInt64(proto_str.size()), operands,
+       builder->getInt64(operands_size), builder->getInt64(verbosity),
+       interpreter_events_ptr});
   return absl::OkStatus();
 }
 
-// Build the LLVM IR to invoke the callback that creates a trace buffer.
-absl::StatusOr<llvm::Value*> InvokeCreateBufferCallback(
-    llvm::IRBuilder<>* builder, llvm::Value* instance_ctx) {
-  llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
-  return InvokeCallback<InstanceContext::kCreateTraceBufferOffset>(
-      builder, ptr_type, instance_ctx, {});
-}
-
 // Build the LLVM IR to invoke the callback that records assertions.
 absl::Status InvokeAssertCallback(llvm::IRBuilder<>* builder,
                                   const std::string& message,
@@ -1075,6 +1105,118 @@ llvm::Value* NodeIrContext::GetOperandPtr(int64_t i,
   return llvm_function_->getArg(operand_to_arg_.at(operand));
 }
 
+namespace {
+
+// Coverage buffers up to this size are updated with straight-line code, larger
+// ones with a loop.
+constexpr int64_t kMaxUnrolledCoverageBytes = 64;
+
+// Returns a pointer constant holding the given host address.
+llvm::Value* HostPointer(const void* ptr, llvm::IRBuilder<>& b) {
+  return b.CreateIntToPtr(
+      b.getInt64(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr))),
+      llvm::PointerType::getUnqual(b.getContext()));
+}
+
+// Emits code which ORs the `byte_size` bytes at `value_buffer` into
+// `coverage_buffer` unless coverage collection is paused. The coverage buffer
+// is shared by all threads running the code, so bits are set with atomic ORs.
+// Coverage saturates quickly, so the buffer is first read and the atomic
+// update is only made when the value sets new bits. Returns a builder for the
+// block following the update.
+std::unique_ptr<llvm::IRBuilder<>> EmitNodeCoverageUpdate(
+    uint8_t* coverage_buffer, const uint8_t* paused_flag,
+    llvm::Value* value_buffer, int64_t byte_size, llvm::IRBuilder<>& b) {
+  llvm::Function* function = b.GetInsertBlock()->getParent();
+  llvm::BasicBlock* update_blk =
+      llvm::BasicBlock::Create(b.getContext(), "update_coverage", function);
+  auto done = std::make_unique<llvm::IRBuilder<>>(
+      llvm::BasicBlock::Create(b.getContext(), "coverage_done", function));
+  llvm::Value* paused =
+      b.CreateLoad(b.getInt8Ty(), HostPointer(paused_flag, b), "paused");
+  b.CreateCondBr(b.CreateICmpNE(paused, b.getInt8(0)), done->GetInsertBlock(),
+                 update_blk);
+
+  llvm::IRBuilder<> update(update_blk);
+  llvm::Value* coverage_ptr = HostPointer(coverage_buffer, update);
+  // A word of the coverage buffer and the bits of the value not yet set in it.
+  struct CoverageWord {
+    llvm::Value* ptr;
+    llvm::Align align;
+    llvm::Value* new_bits;
+  };
+  // The coverage buffer is 8-byte aligned and padded, so `type`-sized words at
+  // `type`-aligned offsets are naturally aligned. The value buffer is not
+  // necessarily aligned.
+  auto read_word = [&](llvm::IRBuilder<>& ub, llvm::Type* type,
+                       llvm::Value* offset) {
+    llvm::Align align(type->getPrimitiveSizeInBits() / 8);
+    llvm::Value* src = ub.CreateGEP(ub.getInt8Ty(), value_buffer, offset);
+    llvm::Value* dst = ub.CreateGEP(ub.getInt8Ty(), coverage_ptr, offset);
+    llvm::LoadInst* covered = ub.CreateAlignedLoad(type, dst, align);
+    covered->setAtomic(llvm::AtomicOrdering::Monotonic);
+    llvm::Value* value = ub.CreateAlignedLoad(type, src, llvm::MaybeAlign(1));
+    return CoverageWord{.ptr = dst,
+                        .align = align,
+                        .new_bits = ub.CreateAnd(value, ub.CreateNot(covered))};
+  };
+  auto set_bits = [](llvm::IRBuilder<>& ub, const CoverageWord& word) {
+    ub.CreateAtomicRMW(llvm::AtomicRMWInst::Or, word.ptr, word.new_bits,
+                       word.align, llvm::AtomicOrdering::Monotonic);
+  };
+  // Updates the bytes from `begin` to the end of the buffer with straight-line
+  // code and a single branch, then branches to `done`.
+  auto update_unrolled = [&](llvm::IRBuilder<>& ub, int64_t begin) {
+    std::vector<CoverageWord> words;
+    int64_t offset = begin;
+    for (; offset + 8 <= byte_size; offset += 8) {
+      words.push_back(read_word(ub, ub.getInt64Ty(), ub.getInt64(offset)));
+    }
+    for (; offset < byte_size; ++offset) {
+      words.push_back(read_word(ub, ub.getInt8Ty(), ub.getInt64(offset)));
+    }
+    if (words.empty()) {
+      ub.CreateBr(done->GetInsertBlock());
+      return;
+    }
+    llvm::Value* any_new = ub.getFalse();
+    for (const CoverageWord& word : words) {
+      llvm::Value* zero =
+          llvm::Constant::getNullValue(word.new_bits->getType());
+      any_new = ub.CreateOr(any_new, ub.CreateICmpNE(word.new_bits, zero));
+    }
+    llvm::BasicBlock* set_blk =
+        llvm::BasicBlock::Create(ub.getContext(), "set_coverage", function);
+    ub.CreateCondBr(any_new, set_blk, done->GetInsertBlock());
+    llvm::IRBuilder<> set(set_blk);
+    for (const CoverageWord& word : words) {
+      set_bits(set, word);
+    }
+    set.CreateBr(done->GetInsertBlock());
+  };
+  if (byte_size <= kMaxUnrolledCoverageBytes) {
+    update_unrolled(update, 0);
+  } else {
+    LlvmIrLoop loop(byte_size / 8, update, /*stride=*/8);
+    llvm::IRBuilder<>& body = loop.body_builder();
+    CoverageWord word = read_word(body, body.getInt64Ty(), loop.index());
+    llvm::BasicBlock* set_blk =
+        llvm::BasicBlock::Create(body.getContext(), "set_coverage", function);
+    llvm::IRBuilder<> next(
+        llvm::BasicBlock::Create(body.getContext(), "next_word", function));
+    body.CreateCondBr(body.CreateICmpNE(word.new_bits, body.getInt64(0)),
+                      set_blk, next.GetInsertBlock());
+    llvm::IRBuilder<> set(set_blk);
+    set_bits(set, word);
+    set.CreateBr(next.GetInsertBlock());
+    loop.Finalize(&next);
+    update_unrolled(loop.exit_builder(), byte_size / 8 * 8);
+  }
+  return done;
+}
+
+}  // namespace
+
 void NodeIrContext::FinalizeWithValue(
     llvm::Value* result, std::optional<llvm::IRBuilder<>*> exit_builder,
     std::optional<llvm::Value*> return_value,
@@ -1126,6 +1268,21 @@ void NodeIrContext::FinalizeWithPointerToValue(
   } else {
     final_exit_block = b;
   }
+  std::unique_ptr<llvm::IRBuilder<>> after_coverage;
+  // Nodes whose recorded value is not of the node's type (e.g. register
+  // writes) are not covered.
+  JitNodeCoverage* coverage = jit_context_.llvm_compiler().node_coverage();
+  if (coverage != nullptr &&
+      result_type.value_or(node()->GetType()) == node()->GetType()) {
+    int64_t byte_size = type_converter().GetTypeByteSize(node()->GetType());
+    uint8_t* coverage_buffer = coverage->GetOrCreateBuffer(node(), byte_size);
+    if (byte_size > 0) {
+      after_coverage = EmitNodeCoverageUpdate(
+          coverage_buffer, coverage->paused_flag(), result_buffer, byte_size,
+          *final_exit_block);
+      final_exit_block = after_coverage.get();
+    }
+  }
   for (int64_t i = 0; i < output_ptrs_.size(); ++i) {
     if (output_ptrs_[i] != result_buffer) {
       LlvmMemcpy(output_ptrs_[i], result_buffer,
@@ -1268,6 +1425,10 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
   }
 
   // Creates and returns a new NodeIrContext for the given XLS node.
+  // Returns an error if `node` operates on a bit-packed array (see
+  // JitLayoutOptions) in a way the JIT does not implement.
+  absl::Status CheckBitPackedArraysSupported(Node* node);
+
   absl::StatusOr<NodeIrContext> NewNodeIrContext(
       Node* node, absl::Span<const std::string> operand_names,
       bool include_wrapper_args = false);
@@ -1306,9 +1467,9 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
       llvm::Value* events, llvm::Value* instance_context, llvm::Value* runtime,
       llvm::IRBuilder<>& builder);
 
-  // Invokes the receive callback function. The received data is written into
-  // the buffer pointer to be `output_ptr`. Returns an i1 value indicating
-  // whether the receive fired.
+  // Reads from the channel queue. The received data is written into the
+  // buffer pointer to be `output_ptr`. Returns an i1 value indicating whether
+  // the receive fired. `builder` may be moved to a new block.
   absl::StatusOr<llvm::Value*> ReceiveFromQueue(llvm::IRBuilder<>* builder,
                                                 int64_t queue_index,
                                                 Receive* receive,
@@ -1566,9 +1727,22 @@ absl::Status IrBuilderVisitor::HandleArray(Array* array) {
 
   llvm::Type* array_type =
       type_converter()->ConvertToLlvmType(array->GetType());
+  llvm::Value* output_buffer = node_context.GetOutputPtr(0);
+  if (type_converter()->IsBitPackedArray(array->GetType())) {
+    // Zero the buffer first so the bits between and after the packed elements
+    // are cleared.
+    b.CreateStore(type_converter()->ZeroOfType(array_type), output_buffer);
+    for (int64_t i = 0; i < array->size(); ++i) {
+      type_converter()->StoreBitPackedElement(
+          output_buffer, array->GetType()->AsArrayOrDie(),
+          llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()), i),
+          node_context.LoadOperand(i), b);
+    }
+    return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
+                                                   output_buffer);
+  }
   int64_t element_size = type_converter()->GetTypeByteSize(
       array->GetType()->AsArrayOrDie()->element_type());
-  llvm::Value* output_buffer = node_context.GetOutputPtr(0);
   for (uint32_t i = 0; i < array->size(); ++i) {
     llvm::Value* output_element = b.CreateGEP(
         array_type, output_buffer,
@@ -1596,7 +1770,6 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
   llvm::Value* condition = node_context.LoadOperand(1);
   llvm::Value* events_ptr = node_context.GetInterpreterEventsArg();
-  llvm::Value* jit_runtime_ptr = node_context.GetJitRuntimeArg();
 
   std::string trace_name = trace_op->GetName();
 
@@ -1614,40 +1787,37 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
       ctx(), absl::StrCat(trace_name, "_print"), node_context.llvm_function());
   llvm::IRBuilder<> print_builder(print_block);
 
-  XLS_ASSIGN_OR_RETURN(
-      llvm::Value * buffer_ptr,
-      InvokeCreateBufferCallback(&print_builder,
-                                 node_context.GetInstanceContextArg()));
-
   // Operands are: (tok, pred, ..data_operands..)
   XLS_RET_CHECK_EQ(trace_op->operand(0)->GetType(),
                    trace_op->package()->GetTokenType());
   XLS_RET_CHECK_EQ(trace_op->operand(1)->GetType(),
                    trace_op->package()->GetBitsType(1));
 
-  size_t operand_index = 2;
-  for (const FormatStep& step : trace_op->format()) {
-    if (std::holds_alternative<std::string>(step)) {
-      XLS_RETURN_IF_ERROR(InvokeStringStepCallback(
-          &print_builder, std::get<std::string>(step), buffer_ptr,
-          node_context.GetInstanceContextArg()));
-    } else {
-      xls::Node* o = trace_op->operand(operand_index);
-      llvm::Value* operand = node_context.LoadOperand(operand_index);
-      llvm::AllocaInst* alloca = print_builder.CreateAlloca(operand->getType());
-      print_builder.CreateStore(operand, alloca);
-      // The way our format strings are currently formed we implicitly refer to
-      // the next operand after formatting this one.
-      operand_index += 1;
-      XLS_RETURN_IF_ERROR(InvokeFormatStepCallback(
-          &print_builder, std::get<FormatPreference>(step), o->GetType(),
-          alloca, buffer_ptr, jit_runtime_ptr,
-          node_context.GetInstanceContextArg()));
-    }
+  // Copy the data operands into a single tuple-shaped buffer. Formatting is
+  // deferred until the jitted code returns so the trace callback only copies
+  // these bytes.
+  std::vector<Type*> operand_types;
+  for (Node* arg : trace_op->args()) {
+    operand_types.push_back(arg->GetType());
+  }
+  TupleType* operands_type = trace_op->package()->GetTupleType(operand_types);
+  llvm::Type* operands_llvm_type =
+      type_converter()->ConvertToLlvmType(operands_type);
+  llvm::AllocaInst* operands = print_builder.CreateAlloca(operands_llvm_type);
+  for (int64_t i = 0; i < operand_types.size(); ++i) {
+    std::vector<llvm::Value*> gep_indices = {
+        llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx()), 0),
+        llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx()), i)};
+    llvm::Value* element =
+        print_builder.CreateGEP(operands_llvm_type, operands, gep_indices);
+    LlvmMemcpy(element, node_context.GetOperandPtr(i + 2),
+               type_converter()->GetTypeByteSize(operand_types[i]),
+               print_builder);
   }
 
-  XLS_RETURN_IF_ERROR(InvokeRecordTraceCallback(
-      &print_builder, trace_op->verbosity(), buffer_ptr, events_ptr,
+  XLS_RETURN_IF_ERROR(InvokeDeferredTraceCallback(
+      &print_builder, trace_op->format(), trace_op->verbosity(), operands_type,
+      type_converter()->GetTypeByteSize(operands_type), operands, events_ptr,
       node_context.GetInstanceContextArg()));
 
   print_builder.CreateBr(after_block);
@@ -1676,8 +1846,20 @@ absl::Status IrBuilderVisitor::HandleArrayIndex(ArrayIndex* index) {
   Type* array_type = index->array()->GetType();
   for (int64_t i = 1; i < index->operand_count(); ++i) {
     llvm::Value* index_value = node_context.LoadOperand(i);
-    gep_indices.push_back(
-        ClampIndexInBounds(index_value, array_type->AsArrayOrDie(), b));
+    llvm::Value* clamped_index =
+        ClampIndexInBounds(index_value, array_type->AsArrayOrDie(), b);
+    if (type_converter()->IsBitPackedArray(array_type)) {
+      // Bit-packed arrays only hold bits so this must be the last index.
+      // Address the packed array with the outer indices and extract the
+      // element from it.
+      llvm::Value* packed_array = b.CreateGEP(
+          type_converter()->ConvertToLlvmType(index->array()->GetType()),
+          node_context.GetOperandPtr(0), gep_indices);
+      llvm::Value* element = type_converter()->LoadBitPackedElement(
+          packed_array, array_type->AsArrayOrDie(), clamped_index, b);
+      return FinalizeNodeIrContextWithValue(std::move(node_context), element);
+    }
+    gep_indices.push_back(clamped_index);
     array_type = array_type->AsArrayOrDie()->element_type();
   }
   llvm::Value* indexed_element = b.CreateGEP(
@@ -1763,10 +1945,7 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
                         NumberedStrings("index", update->indices().size()))));
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
-  // First, copy the entire array to update (operand 0) to the output buffer.
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
-  LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
-             type_converter()->GetTypeByteSize(update->GetType()), b);
 
   // Determine whether the indices are all inbounds. If any are out of bounds
   // then the array update operation is a NOP. Also, gather the GEP indices for
@@ -1778,6 +1957,10 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
       llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx()), 0),
   };
   llvm::Type* i64 = llvm::Type::getInt64Ty(ctx());
+  // The bit-packed array containing the element to update and the element's
+  // index within it, if the updated element is in a bit-packed array.
+  const ArrayType* packed_array_type = nullptr;
+  llvm::Value* packed_index = nullptr;
   for (int64_t i = 2; i < update->operand_count(); ++i) {
     llvm::Value* index_value = node_context.LoadOperand(i);
     is_inbounds = b.CreateAnd(
@@ -1787,8 +1970,15 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
     // indices of unusual widths. This is safe because if the cast to i64 ends
     // up truncating the value, the gep is unused because the index is
     // necessarily out of bounds.
-    gep_indices.push_back(
-        b.CreateIntCast(index_value, i64, /*isSigned=*/false));
+    llvm::Value* index_i64 =
+        b.CreateIntCast(index_value, i64, /*isSigned=*/false);
+    if (type_converter()->IsBitPackedArray(array_type)) {
+      // Bit-packed arrays only hold bits so this must be the last index.
+      packed_array_type = array_type->AsArrayOrDie();
+      packed_index = index_i64;
+      break;
+    }
+    gep_indices.push_back(index_i64);
     array_type = array_type->AsArrayOrDie()->element_type();
   }
 
@@ -1805,14 +1995,31 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   llvm::Value* output_element = inbounds_builder.CreateGEP(
       type_converter()->ConvertToLlvmType(update->GetType()), output_buffer,
       gep_indices);
-  LlvmMemcpy(output_element, node_context.GetOperandPtr(1),
-             type_converter()->GetTypeByteSize(update->operand(1)->GetType()),
-             inbounds_builder);
+  if (packed_array_type != nullptr) {
+    type_converter()->StoreBitPackedElement(
+        output_element, packed_array_type, packed_index,
+        node_context.LoadOperand(1), inbounds_builder);
+  } else {
+    LlvmMemcpy(output_element, node_context.GetOperandPtr(1),
+               type_converter()->GetTypeByteSize(update->operand(1)->GetType()),
+               inbounds_builder);
+  }
   inbounds_builder.CreateBr(exit_block);
 
-  // From the entry block, branch to the inbounds block if the index is
-  // inbounds. Otherwise branch to the exit block.
-  b.CreateCondBr(is_inbounds, inbounds_block, exit_block);
+  // Copy the entire array to update (operand 0) to the output buffer unless
+  // they are the same buffer. The buffer allocator gives the update the buffer
+  // of the array if nothing else uses the array, so the update is in place.
+  llvm::Value* array_buffer = node_context.GetOperandPtr(0);
+  LlvmIfThen copy = CreateIfThen(b.CreateICmpNE(output_buffer, array_buffer),
+                                 b, absl::StrCat(update->GetName(), "_copy"));
+  LlvmMemcpy(output_buffer, array_buffer,
+             type_converter()->GetTypeByteSize(update->GetType()),
+             *copy.then_builder);
+  std::unique_ptr<llvm::IRBuilder<>> copied_builder = copy.Finalize();
+
+  // Then branch to the inbounds block if the index is inbounds. Otherwise
+  // branch to the exit block.
+  copied_builder->CreateCondBr(is_inbounds, inbounds_block, exit_block);
 
   return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
                                                  output_buffer, &exit_builder);
@@ -2647,9 +2854,17 @@ absl::Status IrBuilderVisitor::HandleNext(Next* next) {
 
   llvm::Value* value_ptr = node_context.GetOperandPtr(Next::kValueOperand);
 
+  // The output buffer starts out holding the current state (see
+  // JittedFunctionBase::Build) so a next_value which leaves the state
+  // unchanged only needs to record that it is active.
+  bool is_unchanged = next->value() == next->state_read();
+
   if (!next->predicate().has_value()) {
-    LlvmMemcpy(node_context.GetOutputPtr(0), value_ptr,
-               type_converter()->GetTypeByteSize(next->value()->GetType()), b);
+    if (!is_unchanged) {
+      LlvmMemcpy(node_context.GetOutputPtr(0), value_ptr,
+                 type_converter()->GetTypeByteSize(next->value()->GetType()),
+                 b);
+    }
 
     // Record that this Next node was activated.
     XLS_RETURN_IF_ERROR(InvokeNextValueCallback(
@@ -2663,9 +2878,11 @@ absl::Status IrBuilderVisitor::HandleNext(Next* next) {
   llvm::Value* predicate = node_context.LoadOperand(2);
   LlvmIfThen if_then = CreateIfThen(predicate, b, next->GetName());
 
-  LlvmMemcpy(node_context.GetOutputPtr(0), value_ptr,
-             type_converter()->GetTypeByteSize(next->value()->GetType()),
-             *if_then.then_builder);
+  if (!is_unchanged) {
+    LlvmMemcpy(node_context.GetOutputPtr(0), value_ptr,
+               type_converter()->GetTypeByteSize(next->value()->GetType()),
+               *if_then.then_builder);
+  }
 
   // Record that this Next node was activated.
   XLS_RETURN_IF_ERROR(InvokeNextValueCallback(
@@ -3230,15 +3447,48 @@ absl::Status IrBuilderVisitor::HandleBinaryOpWithOperandConversion(
       });
 }
 
+absl::Status IrBuilderVisitor::CheckBitPackedArraysSupported(Node* node) {
+  if (type_converter()->layout_options().packed_array_types.empty() ||
+      SupportsBitPackedArrays(node)) {
+    return absl::OkStatus();
+  }
+  std::function<bool(Type*)> touches_packed_array = [&](Type* type) {
+    if (type_converter()->IsBitPackedArray(type)) {
+      return true;
+    }
+    if (type->IsArray()) {
+      return touches_packed_array(type->AsArrayOrDie()->element_type());
+    }
+    if (type->IsTuple()) {
+      return absl::c_any_of(type->AsTupleOrDie()->element_types(),
+                            touches_packed_array);
+    }
+    return false;
+  };
+  bool touches = touches_packed_array(node->GetType());
+  for (Node* operand : node->operands()) {
+    touches = touches || touches_packed_array(operand->GetType());
+  }
+  if (touches) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Node %s uses a bit-packed array but %s does not support bit-packed "
+        "arrays in the JIT",
+        node->GetName(), OpToString(node->op())));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<NodeIrContext> IrBuilderVisitor::NewNodeIrContext(
     Node* node, absl::Span<const std::string> operand_names,
     bool include_wrapper_args) {
+  XLS_RETURN_IF_ERROR(CheckBitPackedArraysSupported(node));
   return NodeIrContext::Create(node, operand_names, output_arg_count_,
                                include_wrapper_args, metadata_, jit_context_);
 }
 
 absl::StatusOr<NodeIrContext> IrBuilderVisitor::NewInputNodeIrContext(
     Node* node, bool include_wrapper_args) {
+  XLS_RETURN_IF_ERROR(CheckBitPackedArraysSupported(node));
   return NodeIrContext::CreateForInputNode(node, include_wrapper_args,
                                            metadata_, jit_context_);
 }
@@ -3314,13 +3564,10 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::CallFunction(
 absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
     llvm::IRBuilder<>* builder, int64_t queue_index, Receive* receive,
     llvm::Value* output_ptr, llvm::Value* instance_context) {
-  // llvm::Type* i64_type = llvm::Type::getInt64Ty(ctx());
   llvm::Type* bool_type = llvm::Type::getInt1Ty(ctx());
-  // Call the wrapper to JitChannelQueue::Recv.
-  llvm::Value* queue_index_value =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()), queue_index);
-  return InvokeCallback<InstanceContext::kQueueReceiveWrapperOffset>(
-      builder, bool_type, instance_context, {queue_index_value, output_ptr});
+  return InvokeQueueAccess<InstanceContext::kQueueReceiveWrapperOffset>(
+      builder, bool_type, instance_context, queue_index,
+      InstanceContext::kChannelQueueSlotReadIndex, output_ptr);
 }
 
 absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
@@ -3387,7 +3634,8 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
 
     llvm::PHINode* receive_fired = join_builder.CreatePHI(
         llvm::Type::getInt1Ty(ctx()), /*NumReservedValues=*/2);
-    receive_fired->addIncoming(true_receive_fired, true_block);
+    receive_fired->addIncoming(true_receive_fired,
+                               true_builder.GetInsertBlock());
     receive_fired->addIncoming(llvm::ConstantInt::getFalse(ctx()), false_block);
     receive_fired->setName("receive_fired");
     if (!recv->is_blocking()) {
@@ -3436,10 +3684,9 @@ absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
                                            llvm::Value* send_data_ptr,
                                            llvm::Value* instance_context) {
   llvm::Type* void_type = llvm::Type::getVoidTy(ctx());
-  llvm::Value* queue_index_value =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()), queue_index);
-  InvokeCallback<InstanceContext::kQueueSendWrapperOffset>(
-      builder, void_type, instance_context, {queue_index_value, send_data_ptr});
+  InvokeQueueAccess<InstanceContext::kQueueSendWrapperOffset>(
+      builder, void_type, instance_context, queue_index,
+      InstanceContext::kChannelQueueSlotWriteIndex, send_data_ptr);
   return absl::OkStatus();
 }
 
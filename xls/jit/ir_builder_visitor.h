@@ -51,7 +51,8 @@ class JitBuilderContext {
         llvm_compiler_(llvm_compiler),
         top_(top),
         type_converter_(llvm_compiler_.GetContext(),
-                        llvm_compiler_.CreateDataLayout().value()) {
+                        llvm_compiler_.CreateDataLayout().value(),
+                        llvm_compiler_.layout_options()) {
     CHECK_EQ(module_->getTargetTriple(), llvm_compiler_.target_triple());
   }
 
@@ -16,12 +16,16 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/xls_type.pb.h"
@@ -30,6 +34,58 @@
 namespace xls {
 
 namespace {
+
+// Marks an operand in an encoded deferred trace format. It is followed by the
+// operand's format preference offset by kFormatPreferenceBias, or by a second
+// marker for a literal marker character.
+constexpr char kOperandMarker = '\x01';
+constexpr int kFormatPreferenceBias = 2;
+
+// A trace recorded by jitted code which has not been formatted yet.
+struct DeferredTrace {
+  InterpreterEvents* events;
+  std::string_view format;
+  absl::Span<uint8_t const> type_proto;
+  int64_t verbosity;
+  int64_t operands_offset;
+};
+
+// The traces recorded on a thread since the last flush. Flushing clears but
+// does not free the vectors so recording a trace does not allocate once the
+// log has grown to the size needed by a run.
+struct DeferredTraceLog {
+  std::vector<DeferredTrace> traces;
+  std::vector<uint8_t> operand_data;
+};
+
+DeferredTraceLog& GetDeferredTraceLog() {
+  thread_local DeferredTraceLog log;
+  return log;
+}
+
+std::string FormatDeferredTrace(std::string_view format,
+                                const Value& operands) {
+  std::string message;
+  int64_t operand_index = 0;
+  for (int64_t i = 0; i < format.size(); ++i) {
+    if (format[i] != kOperandMarker) {
+      message.push_back(format[i]);
+      continue;
+    }
+    ++i;
+    CHECK_LT(i, format.size());
+    if (format[i] == kOperandMarker) {
+      message.push_back(kOperandMarker);
+      continue;
+    }
+    FormatPreference preference =
+        static_cast<FormatPreference>(format[i] - kFormatPreferenceBias);
+    absl::StrAppend(&message, operands.element(operand_index++).ToHumanString(
+                                  preference));
+  }
+  return message;
+}
+
 void PerformStringStep(InstanceContext* thiz, char* step_string,
                        std::string* buffer) {
   buffer->append(step_string);
@@ -63,6 +119,29 @@ void RecordAssertion(InstanceContext* thiz, const char* msg,
   events->assert_msgs.push_back(msg);
 }
 
+void RecordDeferredTrace(InstanceContext* thiz, const char* format,
+                         int64_t format_size, const uint8_t* type_proto_data,
+                         int64_t type_proto_data_size, const uint8_t* operands,
+                         int64_t operands_size, int64_t verbosity,
+                         InterpreterEvents* events) {
+  if (verbosity > thiz->max_trace_verbosity) {
+    return;
+  }
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+  __msan_unpoison(operands, operands_size);
+#endif
+  DeferredTraceLog& log = GetDeferredTraceLog();
+  int64_t offset = log.operand_data.size();
+  log.operand_data.insert(log.operand_data.end(), operands,
+                          operands + operands_size);
+  log.traces.push_back(DeferredTrace{
+      .events = events,
+      .format = std::string_view(format, format_size),
+      .type_proto = absl::MakeConstSpan(type_proto_data, type_proto_data_size),
+      .verbosity = verbosity,
+      .operands_offset = offset});
+}
+
 bool QueueReceiveWrapper(InstanceContext* thiz, int64_t queue_index,
                          uint8_t* buffer) {
   return thiz->channel_queues[queue_index]->ReadRaw(buffer);
@@ -95,7 +174,8 @@ InstanceContextVTable::InstanceContextVTable()
       queue_receive_wrapper(&QueueReceiveWrapper),
       queue_send_wrapper(&QueueSendWrapper),
       record_active_next_value(&RecordActiveNextValue),
-      record_node_result(&RecordNodeResult) {}
+      record_node_result(&RecordNodeResult),
+      record_deferred_trace(&RecordDeferredTrace) {}
 
 Type* InstanceContext::ParseTypeFromProto(absl::Span<uint8_t const> data) {
   TypeProto proto;
@@ -104,4 +184,43 @@ Type* InstanceContext::ParseTypeFromProto(absl::Span<uint8_t const> data) {
   CHECK_OK(type_or);
   return *type_or;
 }
+
+std::string EncodeDeferredTraceFormat(absl::Span<const FormatStep> format) {
+  std::string encoded;
+  for (const FormatStep& step : format) {
+    if (std::holds_alternative<FormatPreference>(step)) {
+      encoded.push_back(kOperandMarker);
+      encoded.push_back(static_cast<char>(
+          static_cast<int>(std::get<FormatPreference>(step)) +
+          kFormatPreferenceBias));
+      continue;
+    }
+    for (char c : std::get<std::string>(step)) {
+      if (c == kOperandMarker) {
+        encoded.push_back(kOperandMarker);
+      }
+      encoded.push_back(c);
+    }
+  }
+  return encoded;
+}
+
+void FlushDeferredTraces(InstanceContext* instance_context,
+                         JitRuntime* jit_runtime) {
+  DeferredTraceLog& log = GetDeferredTraceLog();
+  if (log.traces.empty()) {
+    return;
+  }
+  for (const DeferredTrace& trace : log.traces) {
+    Type* type = instance_context->ParseTypeFromProto(trace.type_proto);
+    Value operands = jit_runtime->UnpackBuffer(
+        log.operand_data.data() + trace.operands_offset, type);
+    trace.events->trace_msgs.push_back(
+        TraceMessage{.message = FormatDeferredTrace(trace.format, operands),
+                     .verbosity = trace.verbosity});
+  }
+  log.traces.clear();
+  log.operand_data.clear();
+}
+
 }  // namespace xls
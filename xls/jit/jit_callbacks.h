@@ -18,6 +18,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -27,6 +28,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
 #include "xls/ir/events.h"
+#include "xls/ir/format_strings.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/type.h"
 #include "xls/ir/type_manager.h"
@@ -100,6 +102,19 @@ struct InstanceContextVTable {
   // Data is in JIT data format and can be read using the appropriate type
   // information for the node.
   const RecordNodeResultFn record_node_result;
+
+  using RecordDeferredTraceFn =
+      void (*)(InstanceContext* thiz, const char* format, int64_t format_size,
+               const uint8_t* type_proto_data, int64_t type_proto_data_size,
+               const uint8_t* operands, int64_t operands_size,
+               int64_t verbosity, InterpreterEvents* events);
+  // This is a shim to let JIT code record a trace without formatting it.
+  // `format` is the trace format as produced by EncodeDeferredTraceFormat and
+  // `operands` holds the data operands laid out as a tuple of the type given by
+  // the type proto. The operand bytes are copied into a per-thread log which is
+  // formatted into `events` by FlushDeferredTraces once the jitted code
+  // returns.
+  const RecordDeferredTraceFn record_deferred_trace;
 };
 
 // Data structure passed to the JITted function which contains instance-specific
@@ -112,10 +127,30 @@ struct InstanceContext {
                                        std::vector<JitChannelQueue*> queues) {
     InstanceContext ret;
     ret.instance = inst;
+    ret.channel_queue_slot_storage.reserve(queues.size());
+    for (JitChannelQueue* queue : queues) {
+      ret.channel_queue_slot_storage.push_back(
+          ChannelQueueSlot{.queue = queue,
+                           .read = queue->raw_read_fn(),
+                           .write = queue->raw_write_fn()});
+    }
+    ret.channel_queue_slots = ret.channel_queue_slot_storage.data();
     ret.channel_queues = std::move(queues);
     return ret;
   }
 
+  // A channel queue along with the functions which read and write it. Jitted
+  // sends and receives load the slot of their queue index and call the
+  // function directly with the queue.
+  struct ChannelQueueSlot {
+    JitChannelQueue* queue;
+    JitChannelQueue::RawReadFn read;
+    JitChannelQueue::RawWriteFn write;
+  };
+  static constexpr int64_t kChannelQueueSlotQueueIndex = 0;
+  static constexpr int64_t kChannelQueueSlotReadIndex = 1;
+  static constexpr int64_t kChannelQueueSlotWriteIndex = 2;
+
   // Offsets in the vtable the LLVM can use to grab the actual function pointer.
   static constexpr int64_t kPerformStringStepOffset =
       offsetof(InstanceContextVTable, perform_string_step);
@@ -135,7 +170,12 @@ struct InstanceContext {
       offsetof(InstanceContextVTable, record_active_next_value);
   static constexpr int64_t kRecordNodeResultOffset =
       offsetof(InstanceContextVTable, record_node_result);
-  static constexpr int64_t kVTableLength = 9;
+  static constexpr int64_t kRecordDeferredTraceOffset =
+      offsetof(InstanceContextVTable, record_deferred_trace);
+  static constexpr int64_t kVTableLength = 10;
+  // Offset of `channel_queue_slots` which immediately follows the vtable.
+  static constexpr int64_t kChannelQueueSlotsOffset =
+      sizeof(InstanceContextVTable);
   using VTableArrayType = std::array<void (*)(), kVTableLength>;
 
   static constexpr bool IsVtableOffset(int64_t v) {
@@ -143,13 +183,18 @@ struct InstanceContext {
            v == kRecordTraceOffset || v == kCreateTraceBufferOffset ||
            v == kRecordAssertionOffset || v == kQueueReceiveWrapperOffset ||
            v == kQueueSendWrapperOffset || v == kRecordActiveNextValueOffset ||
-           v == kRecordNodeResultOffset;
+           v == kRecordNodeResultOffset || v == kRecordDeferredTraceOffset;
   }
 
   Type* ParseTypeFromProto(absl::Span<uint8_t const> data);
 
   InstanceContextVTable vtable;
 
+  // The queues of `channel_queues` indexed by queue index, or null if the
+  // queues must be accessed through the vtable callbacks (e.g. when not
+  // evaluating a proc). Points into `channel_queue_slot_storage`.
+  const ChannelQueueSlot* channel_queue_slots = nullptr;
+
   // The proc instance being evaluated (if we are evaluating a proc).
   ProcInstance* instance = nullptr;
 
@@ -161,17 +206,33 @@ struct InstanceContext {
   // assigned at JIT compile time. The indices of particular queues is baked
   // into the JITted code for sends and receives.
   std::vector<JitChannelQueue*> channel_queues;
+  std::vector<ChannelQueueSlot> channel_queue_slot_storage;
 
   // Arena used to materialize types that are passed to callbacks.
   std::unique_ptr<TypeManager> type_manager = std::make_unique<TypeManager>();
 
   RuntimeObserver* observer = nullptr;
+
+  // Traces with a verbosity above this are dropped before they are recorded.
+  int64_t max_trace_verbosity = std::numeric_limits<int64_t>::max();
 };
 
 static_assert(offsetof(InstanceContext, vtable) == 0);
+static_assert(offsetof(InstanceContext, channel_queue_slots) ==
+              InstanceContext::kChannelQueueSlotsOffset);
 static_assert(sizeof(InstanceContextVTable) ==
               sizeof(InstanceContext::VTableArrayType));
 
+// Returns the encoding of `format` passed to the record_deferred_trace
+// callback. Literal text is stored as is and each operand is stored as a
+// marker byte followed by its format preference.
+std::string EncodeDeferredTraceFormat(absl::Span<const FormatStep> format);
+
+// Formats the traces recorded on this thread by record_deferred_trace since the
+// last flush and appends them to the events they were recorded for.
+void FlushDeferredTraces(InstanceContext* instance_context,
+                         JitRuntime* jit_runtime);
+
 }  // namespace xls
 
 #endif  // XLS_JIT_JIT_CALLBACKS_H_
@@ -15,8 +15,10 @@
 #include "xls/jit/jit_channel_queue.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -30,6 +32,9 @@
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/type.h"
@@ -56,20 +61,65 @@ std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
   return runtime.UnpackBuffer(buffer.data(), type);
 }
 
+// Returns, for each channel instance in the elaboration indexed by id, whether
+// it is a streaming channel sent on by exactly one proc instance and received
+// on by exactly one proc instance. These can be backed by a lock-free
+// single-producer/single-consumer queue.
+absl::StatusOr<std::vector<bool>> GetSingleProducerSingleConsumerChannels(
+    const ProcElaboration& elaboration) {
+  // A sending/receiving proc instance of each channel instance and whether
+  // there is more than one.
+  int64_t channel_count = elaboration.channel_instances().size();
+  std::vector<ProcInstance*> senders(channel_count, nullptr);
+  std::vector<ProcInstance*> receivers(channel_count, nullptr);
+  std::vector<bool> sender_is_multiple(channel_count, false);
+  std::vector<bool> receiver_is_multiple(channel_count, false);
+  for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+    for (Node* node : proc_instance->proc()->nodes()) {
+      if (!node->Is<ChannelNode>()) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
+                           proc_instance->GetChannelInstance(
+                               node->As<ChannelNode>()->channel_name()));
+      bool is_send = node->Is<Send>();
+      ProcInstance*& user = is_send ? senders[channel_instance->id]
+                                    : receivers[channel_instance->id];
+      std::vector<bool>& is_multiple =
+          is_send ? sender_is_multiple : receiver_is_multiple;
+      if (user != nullptr && user != proc_instance) {
+        is_multiple[channel_instance->id] = true;
+      }
+      user = proc_instance;
+    }
+  }
+  std::vector<bool> result(channel_count, false);
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    int64_t id = channel_instance->id;
+    result[id] = channel_instance->channel->kind() == ChannelKind::kStreaming &&
+                 senders[id] != nullptr && !sender_is_multiple[id] &&
+                 receivers[id] != nullptr && !receiver_is_multiple[id];
+  }
+  return result;
+}
+
 }  // namespace
 
-ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
-    : channel_element_size_(channel_element_size),
-      allocated_element_size_(
-          RoundUpToNearest(channel_element_size,
-                           static_cast<int64_t>(alignof(std::max_align_t)))),
-      is_single_value_(is_single_value) {
+/* static */ int64_t ByteQueue::GetAllocatedElementSize(
+    int64_t channel_element_size) {
   // Special case to handle empty tuples. Assigning the allocated element size
   // to one serves as a tangible instance for the number of elements within the
   // queue.
-  if (allocated_element_size_ == 0) {
-    allocated_element_size_ = 1;
-  }
+  return std::max(
+      int64_t{1},
+      RoundUpToNearest(channel_element_size,
+                       static_cast<int64_t>(alignof(std::max_align_t))));
+}
+
+ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
+    : channel_element_size_(channel_element_size),
+      allocated_element_size_(GetAllocatedElementSize(channel_element_size)),
+      is_single_value_(is_single_value) {
   // Align the vector allocation to a power of 2 for efficient utilization
   // of the memory.
   int64_t element_size_2 = 1 << CeilOfLog2(allocated_element_size_);
@@ -102,6 +152,87 @@ void ByteQueue::Resize() {
   }
 }
 
+void ByteQueue::Reserve(int64_t byte_count) {
+  if (byte_count <= max_byte_count_) {
+    return;
+  }
+  int64_t new_size = static_cast<int64_t>(circular_buffer_.size());
+  while (FloorOfRatio(new_size, allocated_element_size_) *
+             allocated_element_size_ <
+         byte_count) {
+    new_size *= 2;
+  }
+  absl::InlinedVector<uint8_t, kInitBufferSize> new_buffer(new_size);
+  int64_t first_segment = std::min(bytes_used_, max_byte_count_ - read_index_);
+  memcpy(new_buffer.data(), circular_buffer_.data() + read_index_,
+         first_segment);
+  memcpy(new_buffer.data() + first_segment, circular_buffer_.data(),
+         bytes_used_ - first_segment);
+  circular_buffer_ = std::move(new_buffer);
+  max_byte_count_ = FloorOfRatio(new_size, allocated_element_size_) *
+                    allocated_element_size_;
+  read_index_ = 0;
+  write_index_ = bytes_used_ == max_byte_count_ ? 0 : bytes_used_;
+}
+
+void ByteQueue::WriteN(const uint8_t* data, int64_t count, int64_t stride) {
+  if (count == 0) {
+    return;
+  }
+  if (is_single_value_) {
+    Write(data + (count - 1) * stride);
+    return;
+  }
+  if (stride != allocated_element_size_) {
+    Reserve(bytes_used_ + count * allocated_element_size_);
+    for (int64_t i = 0; i < count; ++i) {
+      Write(data + i * stride);
+    }
+    return;
+  }
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+  __msan_unpoison(data, count * stride);
+#endif
+  int64_t byte_count = count * allocated_element_size_;
+  Reserve(bytes_used_ + byte_count);
+  int64_t first_segment = std::min(byte_count, max_byte_count_ - write_index_);
+  memcpy(circular_buffer_.data() + write_index_, data, first_segment);
+  memcpy(circular_buffer_.data(), data + first_segment,
+         byte_count - first_segment);
+  bytes_used_ += byte_count;
+  write_index_ += byte_count;
+  if (write_index_ >= max_byte_count_) {
+    write_index_ -= max_byte_count_;
+  }
+}
+
+int64_t ByteQueue::ReadN(uint8_t* buffer, int64_t max_count, int64_t stride) {
+  if (max_count == 0 || bytes_used_ == 0) {
+    return 0;
+  }
+  if (is_single_value_) {
+    return Read(buffer) ? 1 : 0;
+  }
+  int64_t count = std::min(max_count, size());
+  if (stride != allocated_element_size_) {
+    for (int64_t i = 0; i < count; ++i) {
+      Read(buffer + i * stride);
+    }
+    return count;
+  }
+  int64_t byte_count = count * allocated_element_size_;
+  int64_t first_segment = std::min(byte_count, max_byte_count_ - read_index_);
+  memcpy(buffer, circular_buffer_.data() + read_index_, first_segment);
+  memcpy(buffer + first_segment, circular_buffer_.data(),
+         byte_count - first_segment);
+  bytes_used_ -= byte_count;
+  read_index_ += byte_count;
+  if (read_index_ >= max_byte_count_) {
+    read_index_ -= max_byte_count_;
+  }
+  return count;
+}
+
 int64_t ThreadSafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
@@ -120,6 +251,135 @@ std::optional<Value> ThreadSafeJitChannelQueue::ReadInternal() {
   return value;
 }
 
+void ThreadSafeJitChannelQueue::WriteRawN(const uint8_t* data,
+                                          int64_t count) {
+  absl::MutexLock lock(&mutex_);
+  byte_queue_.WriteN(data, count, raw_element_stride());
+  if (!callbacks_.empty()) {
+    for (int64_t i = 0; i < count; ++i) {
+      CallWriteCallbacks(jit_runtime_->UnpackBuffer(
+          data + i * raw_element_stride(), channel()->type()));
+    }
+  }
+}
+
+int64_t ThreadSafeJitChannelQueue::ReadRawN(uint8_t* buffer,
+                                            int64_t max_count) {
+  absl::MutexLock lock(&mutex_);
+  int64_t count = 0;
+  if (generator_.has_value()) {
+    // Generated values are produced one at a time.
+    while (count < max_count) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+      if (!byte_queue_.Read(buffer + count * raw_element_stride())) {
+        break;
+      }
+      ++count;
+    }
+  } else {
+    count = byte_queue_.ReadN(buffer, max_count, raw_element_stride());
+  }
+  if (!callbacks_.empty()) {
+    for (int64_t i = 0; i < count; ++i) {
+      CallReadCallbacks(jit_runtime_->UnpackBuffer(
+          buffer + i * raw_element_stride(), channel()->type()));
+    }
+  }
+  return count;
+}
+
+SpscJitChannelQueue::SpscJitChannelQueue(ChannelInstance* channel_instance,
+                                         JitRuntime* jit_runtime)
+    : JitChannelQueue(channel_instance, jit_runtime),
+      element_size_(
+          jit_runtime->GetTypeByteSize(channel_instance->channel->type())),
+      allocated_element_size_(
+          ByteQueue::GetAllocatedElementSize(element_size_)) {
+  CHECK_EQ(channel_instance->channel->kind(), ChannelKind::kStreaming)
+      << "SpscJitChannelQueue only supports streaming channels: "
+      << channel_instance->ToString();
+  consumer_ring_ = new Ring(kInitialCapacity, allocated_element_size_);
+  producer_ring_ = consumer_ring_;
+}
+
+SpscJitChannelQueue::~SpscJitChannelQueue() {
+  Ring* ring = consumer_ring_;
+  while (ring != nullptr) {
+    Ring* next = ring->next.load(std::memory_order_acquire);
+    delete ring;
+    ring = next;
+  }
+}
+
+SpscJitChannelQueue::Ring* SpscJitChannelQueue::Grow() {
+  Ring* full_ring = producer_ring_;
+  Ring* new_ring = new Ring(full_ring->capacity * 2, allocated_element_size_);
+  producer_ring_ = new_ring;
+  producer_cached_head_ = 0;
+  // The producer never touches `full_ring` after this store. The consumer may
+  // free it as soon as it has drained it and observed the link.
+  full_ring->next.store(new_ring, std::memory_order_release);
+  return new_ring;
+}
+
+bool SpscJitChannelQueue::Pop(uint8_t* buffer) {
+  while (true) {
+    Ring* ring = consumer_ring_;
+    int64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head == consumer_cached_tail_) {
+      consumer_cached_tail_ = ring->tail.load(std::memory_order_acquire);
+      if (head == consumer_cached_tail_) {
+        Ring* next = ring->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+          return false;
+        }
+        // The producer finished writing to `ring` before linking `next` so
+        // after reloading the tail the ring is either non-empty or drained
+        // for good.
+        consumer_cached_tail_ = ring->tail.load(std::memory_order_acquire);
+        if (head == consumer_cached_tail_) {
+          consumer_ring_ = next;
+          consumer_cached_tail_ = 0;
+          delete ring;
+          continue;
+        }
+      }
+    }
+    memcpy(buffer, ring->Slot(head), element_size_);
+    ring->head.store(head + 1, std::memory_order_release);
+    read_count_.fetch_add(1, std::memory_order_release);
+    return true;
+  }
+}
+
+int64_t SpscJitChannelQueue::GetSizeInternal() const {
+  // Load the read count first so the result is never negative.
+  int64_t read_count = read_count_.load(std::memory_order_acquire);
+  return write_count_.load(std::memory_order_acquire) - read_count;
+}
+
+void SpscJitChannelQueue::WriteInternal(const Value& value) {
+  CallWriteCallbacks(value);
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      element_size_);
+  jit_runtime_->BlitValueToBuffer(value, channel()->type(),
+                                  absl::MakeSpan(buffer));
+  Push(buffer.data());
+}
+
+std::optional<Value> SpscJitChannelQueue::ReadInternal() {
+  std::vector<uint8_t> buffer(element_size_);
+  if (!Pop(buffer.data())) {
+    return std::nullopt;
+  }
+  Value value = jit_runtime_->UnpackBuffer(buffer.data(), channel()->type());
+  CallReadCallbacks(value);
+  return value;
+}
+
 int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
@@ -138,6 +398,44 @@ std::optional<Value> ThreadUnsafeJitChannelQueue::ReadInternal() {
   return value;
 }
 
+void ThreadUnsafeJitChannelQueue::WriteRawN(const uint8_t* data,
+                                            int64_t count) {
+  byte_queue_.WriteN(data, count, raw_element_stride());
+  if (!callbacks_.empty()) {
+    for (int64_t i = 0; i < count; ++i) {
+      CallWriteCallbacks(jit_runtime_->UnpackBuffer(
+          data + i * raw_element_stride(), channel()->type()));
+    }
+  }
+}
+
+int64_t ThreadUnsafeJitChannelQueue::ReadRawN(uint8_t* buffer,
+                                              int64_t max_count) {
+  int64_t count = 0;
+  if (generator_.has_value()) {
+    // Generated values are produced one at a time.
+    while (count < max_count) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+      if (!byte_queue_.Read(buffer + count * raw_element_stride())) {
+        break;
+      }
+      ++count;
+    }
+  } else {
+    count = byte_queue_.ReadN(buffer, max_count, raw_element_stride());
+  }
+  if (!callbacks_.empty()) {
+    for (int64_t i = 0; i < count; ++i) {
+      CallReadCallbacks(jit_runtime_->UnpackBuffer(
+          buffer + i * raw_element_stride(), channel()->type()));
+    }
+  }
+  return count;
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(Package* package,
                                          std::unique_ptr<JitRuntime> runtime) {
@@ -149,10 +447,18 @@ JitChannelQueueManager::CreateThreadSafe(Package* package,
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(ProcElaboration&& elaboration,
                                          std::unique_ptr<JitRuntime> runtime) {
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<bool> spsc_channels,
+      GetSingleProducerSingleConsumerChannels(elaboration));
   std::vector<std::unique_ptr<ChannelQueue>> queues;
   for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
-    queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
-        channel_instance, runtime.get()));
+    if (spsc_channels[channel_instance->id]) {
+      queues.push_back(std::make_unique<SpscJitChannelQueue>(channel_instance,
+                                                             runtime.get()));
+    } else {
+      queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
+          channel_instance, runtime.get()));
+    }
   }
   return absl::WrapUnique(new JitChannelQueueManager(
       std::move(elaboration), std::move(queues), std::move(runtime)));
@@ -14,6 +14,8 @@
 #ifndef XLS_JIT_JIT_CHANNEL_QUEUE_H_
 #define XLS_JIT_JIT_CHANNEL_QUEUE_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -23,6 +25,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "xls/interpreter/channel_queue.h"
@@ -31,6 +34,8 @@
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/native_layout_view.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -86,11 +91,30 @@ class ByteQueue {
     return true;
   }
 
+  // Bulk versions of Write and Read which move `count` (at most `max_count`)
+  // elements. Element `i` is at `data + i * stride` (`buffer + i * stride`).
+  // When `stride` equals allocated_element_size() the elements are copied with
+  // at most two memcpys (one per contiguous segment of the circular buffer).
+  // For single-value queues only the last element written is retained and at
+  // most one element is read. ReadN returns the number of elements read.
+  void WriteN(const uint8_t* data, int64_t count, int64_t stride);
+  int64_t ReadN(uint8_t* buffer, int64_t max_count, int64_t stride);
+
   int64_t size() const { return bytes_used_ / allocated_element_size_; }
 
+  // The number of bytes occupied by each element in the circular buffer. This
+  // is the element size rounded up to the alignment of the largest scalar
+  // type.
+  int64_t allocated_element_size() const { return allocated_element_size_; }
+  static int64_t GetAllocatedElementSize(int64_t channel_element_size);
+
   static constexpr int64_t kInitBufferSize = 128;
 
  private:
+  // Grows the circular buffer so it can hold at least `byte_count` bytes. The
+  // contents are moved to the start of the buffer.
+  void Reserve(int64_t byte_count);
+
   // Size of an element in the channel in units of bytes.
   int64_t channel_element_size_ = 0;
   // Allocated size of an element in the circular buffer in units of bytes. The
@@ -118,14 +142,81 @@ class ByteQueue {
 class JitChannelQueue : public ChannelQueue {
  public:
   JitChannelQueue(ChannelInstance* channel, JitRuntime* jit_runtime)
-      : ChannelQueue(channel), jit_runtime_(jit_runtime) {}
+      : ChannelQueue(channel),
+        jit_runtime_(jit_runtime),
+        type_layout_(jit_runtime->CreateTypeLayout(channel->channel->type())),
+        raw_element_stride_(ByteQueue::GetAllocatedElementSize(
+            jit_runtime->GetTypeByteSize(channel->channel->type()))) {}
   ~JitChannelQueue() override = default;
 
   virtual void WriteRaw(const uint8_t* data) = 0;
   virtual bool ReadRaw(uint8_t* buffer) = 0;
 
+  // Functions which call ReadRaw and WriteRaw of this queue without virtual
+  // dispatch. Jitted code calls these directly (see
+  // InstanceContext::ChannelQueueSlot) rather than going through a callback
+  // which looks up the queue and then makes a virtual call.
+  using RawReadFn = bool (*)(JitChannelQueue* queue, uint8_t* buffer);
+  using RawWriteFn = void (*)(JitChannelQueue* queue, const uint8_t* data);
+  virtual RawReadFn raw_read_fn() const = 0;
+  virtual RawWriteFn raw_write_fn() const = 0;
+
+  // Batch versions of WriteRaw and ReadRaw. WriteRawN writes `count` elements
+  // from `data` and ReadRawN reads up to `max_count` elements into `buffer`,
+  // returning the number read. Element `i` of a batch is located at offset
+  // `i * raw_element_stride()` so buffers must hold `count *
+  // raw_element_stride()` bytes. Reads of single-value channels are
+  // non-destructive so at most one element is read. Implementations may move
+  // an entire batch with one lock acquisition and one or two memcpys.
+  virtual void WriteRawN(const uint8_t* data, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+      WriteRaw(data + i * raw_element_stride_);
+    }
+  }
+  virtual int64_t ReadRawN(uint8_t* buffer, int64_t max_count) {
+    if (channel()->kind() == ChannelKind::kSingleValue) {
+      max_count = std::min(max_count, int64_t{1});
+    }
+    int64_t count = 0;
+    while (count < max_count && ReadRaw(buffer + count * raw_element_stride_)) {
+      ++count;
+    }
+    return count;
+  }
+
+  // The distance in bytes between consecutive elements of the buffers passed
+  // to WriteRawN and ReadRawN. This is the native size of the channel type
+  // rounded up to the alignment of the largest scalar type.
+  int64_t raw_element_stride() const { return raw_element_stride_; }
+
+  // The native layout of the data passed to WriteRaw and ReadRaw. Buffers of
+  // `type_layout().size()` bytes may be filled or inspected in place with
+  // native layout views to avoid constructing Values.
+  const TypeLayout& type_layout() const { return type_layout_; }
+
+  // Writes the value viewed by `view` to the queue. `view` must view an entire
+  // value of the channel type.
+  void WriteView(NativeLayoutView view) {
+    DCHECK_EQ(view.type(), type_layout_.type());
+    WriteRaw(view.buffer());
+  }
+
  protected:
+  // Implementations of raw_read_fn and raw_write_fn for queues of type
+  // `QueueT`. The qualified calls are not virtual so the bodies of ReadRaw and
+  // WriteRaw are inlined.
+  template <typename QueueT>
+  static bool ReadRawOf(JitChannelQueue* queue, uint8_t* buffer) {
+    return static_cast<QueueT*>(queue)->QueueT::ReadRaw(buffer);
+  }
+  template <typename QueueT>
+  static void WriteRawOf(JitChannelQueue* queue, const uint8_t* data) {
+    static_cast<QueueT*>(queue)->QueueT::WriteRaw(data);
+  }
+
   JitRuntime* jit_runtime_;
+  TypeLayout type_layout_;
+  int64_t raw_element_stride_;
 };
 
 // A thread-safe version of the JIT channel queue. All accesses are guarded by a
@@ -166,6 +257,15 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
     return value_read;
   }
 
+  void WriteRawN(const uint8_t* data, int64_t count) override;
+  int64_t ReadRawN(uint8_t* buffer, int64_t max_count) override;
+  RawReadFn raw_read_fn() const override {
+    return &ReadRawOf<ThreadSafeJitChannelQueue>;
+  }
+  RawWriteFn raw_write_fn() const override {
+    return &WriteRawOf<ThreadSafeJitChannelQueue>;
+  }
+
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value)
@@ -207,6 +307,15 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
     return value_read;
   }
 
+  void WriteRawN(const uint8_t* data, int64_t count) override;
+  int64_t ReadRawN(uint8_t* buffer, int64_t max_count) override;
+  RawReadFn raw_read_fn() const override {
+    return &ReadRawOf<ThreadUnsafeJitChannelQueue>;
+  }
+  RawWriteFn raw_write_fn() const override {
+    return &WriteRawOf<ThreadUnsafeJitChannelQueue>;
+  }
+
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value) override;
@@ -215,13 +324,145 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
   ByteQueue byte_queue_;
 };
 
+// A lock-free JIT channel queue for channels with exactly one producer thread
+// and one consumer thread. `WriteRaw` must only be called from a single
+// thread (the producer) and `ReadRaw` must only be called from a single
+// thread (the consumer). The producer and consumer may be different threads.
+// Only streaming channels are supported.
+//
+// Elements are stored in a linked list of power-of-two sized circular
+// buffers. The producer writes into the newest buffer and when it is full
+// allocates a buffer twice as large and links it behind the full one. The
+// consumer drains the oldest buffer and frees it once the producer has moved
+// on. Head and tail indices live on separate cache lines so the producer and
+// consumer do not contend on the same line in the common case.
+//
+// The Value-based methods inherited from ChannelQueue (`Write`, `Read`) are
+// serialized through the base class mutex and count as a producer or consumer
+// respectively.
+class SpscJitChannelQueue : public JitChannelQueue {
+ public:
+  SpscJitChannelQueue(ChannelInstance* channel_instance,
+                      JitRuntime* jit_runtime);
+  ~SpscJitChannelQueue() override;
+
+  void WriteRaw(const uint8_t* data) override {
+    Push(data);
+    if (!callbacks_.empty()) {
+      CallWriteCallbacks(jit_runtime_->UnpackBuffer(data, channel()->type()));
+    }
+  }
+
+  bool ReadRaw(uint8_t* buffer) override {
+    if (generator_.has_value()) {
+      absl::MutexLock lock(&mutex_);
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+    }
+    bool value_read = Pop(buffer);
+    if (value_read && !callbacks_.empty()) {
+      CallReadCallbacks(jit_runtime_->UnpackBuffer(buffer, channel()->type()));
+    }
+    return value_read;
+  }
+
+  RawReadFn raw_read_fn() const override {
+    return &ReadRawOf<SpscJitChannelQueue>;
+  }
+  RawWriteFn raw_write_fn() const override {
+    return &WriteRawOf<SpscJitChannelQueue>;
+  }
+
+  // Initial number of elements held by the first circular buffer.
+  static constexpr int64_t kInitialCapacity = 16;
+
+ protected:
+  // Size of a cache line. Used to keep the producer and consumer indices from
+  // sharing a line.
+  static constexpr int64_t kCacheLineSize = 64;
+
+  // A fixed-capacity circular buffer of elements. `head` is only written by
+  // the consumer and `tail` is only written by the producer. Both are
+  // monotonically increasing element counts.
+  struct Ring {
+    Ring(int64_t capacity, int64_t allocated_element_size)
+        : capacity(capacity),
+          allocated_element_size(allocated_element_size),
+          buffer(capacity * allocated_element_size) {}
+
+    uint8_t* Slot(int64_t index) {
+      return buffer.data() + (index & (capacity - 1)) * allocated_element_size;
+    }
+
+    const int64_t capacity;
+    const int64_t allocated_element_size;
+    std::vector<uint8_t> buffer;
+    alignas(kCacheLineSize) std::atomic<int64_t> head = 0;
+    alignas(kCacheLineSize) std::atomic<int64_t> tail = 0;
+    // The next (larger) ring written by the producer after this one filled.
+    std::atomic<Ring*> next = nullptr;
+  };
+
+  // Pushes an element from `data`. Called by the producer only.
+  void Push(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(data, element_size_);
+#endif
+    Ring* ring = producer_ring_;
+    int64_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail - producer_cached_head_ == ring->capacity) {
+      producer_cached_head_ = ring->head.load(std::memory_order_acquire);
+      if (tail - producer_cached_head_ == ring->capacity) {
+        ring = Grow();
+        tail = 0;
+      }
+    }
+    memcpy(ring->Slot(tail), data, element_size_);
+    ring->tail.store(tail + 1, std::memory_order_release);
+    write_count_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Allocates a new ring of twice the capacity of the current producer ring
+  // and links it to the current one. Called by the producer only. Returns the
+  // new ring.
+  Ring* Grow();
+
+  // Pops an element into `buffer`. Called by the consumer only. Returns false
+  // if the queue is empty.
+  bool Pop(uint8_t* buffer);
+
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+  // Size of an element in the channel in bytes.
+  int64_t element_size_;
+  // Size of a slot in the circular buffers in bytes.
+  int64_t allocated_element_size_;
+
+  // State owned by the consumer.
+  alignas(kCacheLineSize) Ring* consumer_ring_;
+  int64_t consumer_cached_tail_ = 0;
+  std::atomic<int64_t> read_count_ = 0;
+
+  // State owned by the producer.
+  alignas(kCacheLineSize) Ring* producer_ring_;
+  int64_t producer_cached_head_ = 0;
+  std::atomic<int64_t> write_count_ = 0;
+};
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
   ~JitChannelQueueManager() override = default;
 
   // Factories which create a queue manager with exclusively ThreadSafe/Unsafe
-  // queues.
+  // queues. The thread-safe factories use a lock-free SpscJitChannelQueue in
+  // place of a ThreadSafeJitChannelQueue for streaming channel instances
+  // which the elaboration shows have exactly one sending proc instance and
+  // exactly one receiving proc instance.
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadSafe(Package* package, std::unique_ptr<JitRuntime> runtime);
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
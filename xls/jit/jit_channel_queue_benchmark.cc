@@ -20,6 +20,7 @@
 
 #include "absl/log/check.h"
 #include "include/benchmark/benchmark.h"
+#include "xls/common/thread.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/package.h"
@@ -93,6 +94,73 @@ BENCHMARK(BM_QueueWriteThenRead<ThreadUnsafeJitChannelQueue>)
     ->ArgPair(2048, 1)
     ->ArgPair(2048, 128);
 
+BENCHMARK(BM_QueueWriteThenRead<SpscJitChannelQueue>)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 128)
+    ->ArgPair(8, 1)
+    ->ArgPair(8, 128)
+    ->ArgPair(32, 1)
+    ->ArgPair(32, 128)
+    ->ArgPair(2048, 1)
+    ->ArgPair(2048, 128);
+
+// Benchmark evaluating a producer thread writing to the channel while the
+// benchmark thread concurrently reads from it. This models a send/receive pair
+// of procs running on different threads.
+template <typename QueueT,
+          typename std::enable_if<std::is_base_of_v<JitChannelQueue, QueueT>,
+                                  QueueT>::type* = nullptr>
+static void BM_QueueConcurrentWriteAndRead(benchmark::State& state) {
+  int64_t element_size_bytes = state.range(0);
+
+  Package package("benchmark");
+  auto orc_jit = OrcJit::Create().value();
+  auto jit_runtime =
+      std::make_unique<JitRuntime>(orc_jit->CreateDataLayout().value());
+  Channel* channel =
+      package
+          .CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                  package.GetBitsType(8 * element_size_bytes))
+          .value();
+  ProcElaboration elaboration =
+      ProcElaboration::ElaborateOldStylePackage(&package).value();
+
+  QueueT queue(elaboration.GetUniqueInstance(channel).value(),
+               jit_runtime.get());
+
+  int64_t send_count = state.range(1);
+  std::vector<uint8_t> send_buffer(element_size_bytes);
+  std::vector<uint8_t> recv_buffer(element_size_bytes);
+  std::fill(send_buffer.begin(), send_buffer.end(), 42);
+  for (auto _ : state) {
+    Thread producer([&]() {
+      for (int64_t i = 0; i < send_count; ++i) {
+        queue.WriteRaw(send_buffer.data());
+      }
+    });
+    int64_t received = 0;
+    while (received < send_count) {
+      if (queue.ReadRaw(recv_buffer.data())) {
+        ++received;
+      }
+    }
+    producer.Join();
+  }
+  state.SetItemsProcessed(state.iterations() * send_count);
+}
+
+BENCHMARK(BM_QueueConcurrentWriteAndRead<ThreadSafeJitChannelQueue>)
+    ->ArgPair(1, 4096)
+    ->ArgPair(8, 4096)
+    ->ArgPair(32, 4096)
+    ->ArgPair(2048, 4096);
+
+BENCHMARK(BM_QueueConcurrentWriteAndRead<SpscJitChannelQueue>)
+    ->ArgPair(1, 4096)
+    ->ArgPair(8, 4096)
+    ->ArgPair(32, 4096)
+    ->ArgPair(2048, 4096);
+
 }  // namespace
 }  // namespace xls
 
@@ -25,21 +25,29 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/channel_queue_test_base.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/native_layout_view.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
 
 using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 
 JitRuntime* GetJitRuntime() {
   static auto orc_jit = OrcJit::Create().value();
@@ -68,7 +76,8 @@ template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     SpscJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 // An empty tuple represents a zero width.
@@ -107,6 +116,75 @@ TYPED_TEST(JitChannelQueueTest, ChannelWithEmptyTuple) {
   EXPECT_TRUE(queue.IsEmpty());
 }
 
+TYPED_TEST(JitChannelQueueTest, RawAccessFunctions) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+  JitChannelQueue* base = &queue;
+  JitChannelQueue::RawReadFn read = base->raw_read_fn();
+  JitChannelQueue::RawWriteFn write = base->raw_write_fn();
+
+  for (uint32_t i = 0; i < 5; ++i) {
+    write(base, reinterpret_cast<const uint8_t*>(&i));
+  }
+  EXPECT_EQ(queue.GetSize(), 5);
+  for (uint32_t i = 0; i < 5; ++i) {
+    uint32_t value;
+    EXPECT_TRUE(read(base, reinterpret_cast<uint8_t*>(&value)));
+    EXPECT_EQ(value, i);
+  }
+  uint32_t value;
+  EXPECT_FALSE(read(base, reinterpret_cast<uint8_t*>(&value)));
+}
+
+TYPED_TEST(JitChannelQueueTest, AccessWithNativeLayoutViews) {
+  Package package("test");
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(3),
+       package.GetArrayType(4, package.GetBitsType(50))});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     type));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+  const TypeLayout& layout = queue.type_layout();
+  EXPECT_EQ(layout.type(), type);
+
+  std::vector<uint8_t> send_buffer(layout.size());
+  MutableNativeLayoutView send_view(&layout, send_buffer.data());
+  for (uint64_t i = 0; i < 5; ++i) {
+    send_view.mutable_element(0).SetUint64(i);
+    for (uint64_t j = 0; j < 4; ++j) {
+      send_view.mutable_element(1).mutable_element(j).SetUint64(
+          (uint64_t{1} << 40) * i + j);
+    }
+    queue.WriteView(send_view);
+  }
+
+  std::vector<uint8_t> recv_buffer(layout.size());
+  NativeLayoutView recv_view(&layout, recv_buffer.data());
+  for (uint64_t i = 0; i < 5; ++i) {
+    ASSERT_TRUE(queue.ReadRaw(recv_buffer.data()));
+    EXPECT_EQ(recv_view.element(0).GetUint64(), i);
+    for (uint64_t j = 0; j < 4; ++j) {
+      EXPECT_EQ(recv_view.element(1).element(j).GetUint64(),
+                (uint64_t{1} << 40) * i + j);
+    }
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
 TYPED_TEST(JitChannelQueueTest, BasicAccess) {
   Package package("test");
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -181,5 +259,244 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TYPED_TEST(JitChannelQueueTest, ManyElementsInFlight) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+
+  // Interleave reads and writes while the queue grows well past its initial
+  // capacity so the wrap-around and growth paths are exercised.
+  constexpr uint32_t kCount = 1000;
+  uint32_t next_write = 0;
+  uint32_t next_read = 0;
+  while (next_write < kCount) {
+    for (int64_t i = 0; i < 3 && next_write < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<uint8_t*>(&next_write));
+      ++next_write;
+    }
+    uint32_t value;
+    ASSERT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+    EXPECT_EQ(value, next_read++);
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+  }
+  uint32_t value;
+  while (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+    EXPECT_EQ(value, next_read++);
+  }
+  EXPECT_EQ(next_read, kCount);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TYPED_TEST(JitChannelQueueTest, BatchRawAccess) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+  int64_t stride = queue.raw_element_stride();
+  ASSERT_GE(stride, int64_t{sizeof(uint32_t)});
+
+  auto write_batch = [&](uint32_t first, int64_t count) {
+    std::vector<uint8_t> buffer(count * stride);
+    for (int64_t i = 0; i < count; ++i) {
+      uint32_t value = first + i;
+      memcpy(buffer.data() + i * stride, &value, sizeof(value));
+    }
+    queue.WriteRawN(buffer.data(), count);
+  };
+  auto read_batch = [&](int64_t max_count) {
+    std::vector<uint8_t> buffer(max_count * stride);
+    int64_t count = queue.ReadRawN(buffer.data(), max_count);
+    std::vector<uint32_t> values(count);
+    for (int64_t i = 0; i < count; ++i) {
+      memcpy(&values[i], buffer.data() + i * stride, sizeof(uint32_t));
+    }
+    return values;
+  };
+
+  EXPECT_THAT(read_batch(4), IsEmpty());
+  write_batch(0, 5);
+  EXPECT_EQ(queue.GetSize(), 5);
+  EXPECT_THAT(read_batch(3), ElementsAre(0, 1, 2));
+
+  // Batches and single elements interleave in FIFO order.
+  uint32_t single = 5;
+  queue.WriteRaw(reinterpret_cast<uint8_t*>(&single));
+  uint32_t value;
+  ASSERT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+  EXPECT_EQ(value, 3);
+
+  // Write batches which wrap around the end of the buffer and force it to grow
+  // while it holds elements.
+  uint32_t next_write = 6;
+  uint32_t next_read = 4;
+  for (int64_t count : {7, 30, 1, 200, 64}) {
+    write_batch(next_write, count);
+    next_write += count;
+    std::vector<uint32_t> values = read_batch(count / 2 + 1);
+    for (uint32_t v : values) {
+      EXPECT_EQ(v, next_read++);
+    }
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+  }
+  std::vector<uint32_t> rest = read_batch(1000);
+  ASSERT_EQ(rest.size(), next_write - next_read);
+  for (uint32_t v : rest) {
+    EXPECT_EQ(v, next_read++);
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_THAT(read_batch(1), IsEmpty());
+}
+
+TYPED_TEST(JitChannelQueueTest, BatchRawReadWithGenerator) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+  XLS_ASSERT_OK(queue.AttachGenerator(
+      FixedValueGenerator({Value(UBits(7, 32)), Value(UBits(8, 32)),
+                           Value(UBits(9, 32))})));
+
+  int64_t stride = queue.raw_element_stride();
+  std::vector<uint8_t> buffer(5 * stride);
+  EXPECT_EQ(queue.ReadRawN(buffer.data(), 2), 2);
+  uint32_t value;
+  memcpy(&value, buffer.data() + stride, sizeof(value));
+  EXPECT_EQ(value, 8);
+  EXPECT_EQ(queue.ReadRawN(buffer.data(), 5), 1);
+  memcpy(&value, buffer.data(), sizeof(value));
+  EXPECT_EQ(value, 9);
+  EXPECT_EQ(queue.ReadRawN(buffer.data(), 5), 0);
+}
+
+TEST(ByteQueueTest, SingleValueBatchAccess) {
+  ByteQueue queue(/*channel_element_size=*/4, /*is_single_value=*/true);
+  int64_t stride = queue.allocated_element_size();
+  std::vector<uint8_t> buffer(3 * stride, 0);
+  EXPECT_EQ(queue.ReadN(buffer.data(), 3, stride), 0);
+  for (int64_t i = 0; i < 3; ++i) {
+    buffer[i * stride] = 10 * (i + 1);
+  }
+  queue.WriteN(buffer.data(), 3, stride);
+  EXPECT_EQ(queue.size(), 1);
+
+  std::vector<uint8_t> result(3 * stride, 0);
+  EXPECT_EQ(queue.ReadN(result.data(), 3, stride), 1);
+  EXPECT_EQ(result[0], 30);
+  EXPECT_EQ(queue.ReadN(result.data(), 3, stride), 1);
+  EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(ByteQueueTest, BatchAccessWithPackedStride) {
+  // Batches whose stride differs from the allocated element size are copied
+  // element by element.
+  ByteQueue queue(/*channel_element_size=*/3, /*is_single_value=*/false);
+  ASSERT_NE(queue.allocated_element_size(), 3);
+  std::vector<uint8_t> data(3 * 100);
+  for (int64_t i = 0; i < 3 * 100; ++i) {
+    data[i] = i % 251;
+  }
+  queue.WriteN(data.data(), 100, /*stride=*/3);
+  EXPECT_EQ(queue.size(), 100);
+  std::vector<uint8_t> result(3 * 100);
+  EXPECT_EQ(queue.ReadN(result.data(), 40, /*stride=*/3), 40);
+  EXPECT_EQ(queue.ReadN(result.data() + 3 * 40, 100, /*stride=*/3), 60);
+  EXPECT_EQ(result, data);
+  EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(SpscJitChannelQueueTest, ConcurrentProducerAndConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  SpscJitChannelQueue queue(elaboration.GetUniqueInstance(channel).value(),
+                            GetJitRuntime());
+
+  constexpr uint64_t kCount = 100000;
+  Thread producer([&]() {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<uint8_t*>(&i));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kCount) {
+    uint64_t value;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    }
+  }
+  producer.Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(JitChannelQueueManagerTest, ThreadSafeManagerUsesSpscForOneToOneChannels) {
+  auto p = std::make_unique<Package>("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * internal,
+      p->CreateStreamingChannel("internal", ChannelOps::kSendReceive,
+                                p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * single,
+      p->CreateSingleValueChannel("single", ChannelOps::kSendReceive,
+                                  p->GetBitsType(32)));
+
+  ProcBuilder producer("producer", p.get());
+  BValue x = producer.Literal(UBits(1, 32));
+  producer.Send(internal, producer.Literal(Value::Token()), x);
+  producer.Send(single, producer.Literal(Value::Token()), x);
+  XLS_ASSERT_OK(producer.Build({}).status());
+
+  ProcBuilder consumer("consumer", p.get());
+  BValue rcv = consumer.Receive(internal, consumer.Literal(Value::Token()));
+  BValue rcv_single =
+      consumer.Receive(single, consumer.TupleIndex(rcv, 0));
+  consumer.Send(out, consumer.TupleIndex(rcv_single, 0),
+                consumer.TupleIndex(rcv, 1));
+  XLS_ASSERT_OK(consumer.Build({}).status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto orc_jit, OrcJit::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(auto data_layout, orc_jit->CreateDataLayout());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> manager,
+      JitChannelQueueManager::CreateThreadSafe(
+          p.get(), std::make_unique<JitRuntime>(data_layout)));
+
+  EXPECT_NE(dynamic_cast<SpscJitChannelQueue*>(&manager->GetJitQueue(internal)),
+            nullptr);
+  EXPECT_NE(
+      dynamic_cast<ThreadSafeJitChannelQueue*>(&manager->GetJitQueue(out)),
+      nullptr);
+  EXPECT_NE(
+      dynamic_cast<ThreadSafeJitChannelQueue*>(&manager->GetJitQueue(single)),
+      nullptr);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,41 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_LAYOUT_OPTIONS_H_
+#define XLS_JIT_JIT_LAYOUT_OPTIONS_H_
+
+#include "absl/container/flat_hash_set.h"
+#include "xls/ir/type.h"
+
+namespace xls {
+
+// Options controlling the native layout the JIT uses for XLS types. Code
+// compiled with a set of options must be run with a JitRuntime using the same
+// options.
+struct JitLayoutOptions {
+  // Array types which are stored bit-packed rather than with each element
+  // padded out to its own power-of-two sized integer. A bit-packed array
+  // `bits[w][n]` occupies ceil(n * w / 8) + 1 bytes with element `i` starting
+  // at bit `i * w`. The byte of slack lets each element be read with a single
+  // (unaligned) load. Packing greatly reduces the footprint of large arrays of
+  // narrow elements (e.g., memories held in proc state) at the cost of
+  // shifting and masking on each access. Only types for which
+  // LlvmTypeConverter::CanBitPackArray is true may be included. See
+  // bit_packed_arrays.h for choosing the types.
+  absl::flat_hash_set<const Type*> packed_array_types;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_LAYOUT_OPTIONS_H_
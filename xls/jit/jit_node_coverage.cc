@@ -0,0 +1,59 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_node_coverage.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+uint8_t* JitNodeCoverage::GetOrCreateBuffer(Node* node, int64_t byte_size) {
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = buffers_.try_emplace(node);
+  if (inserted) {
+    it->second.byte_size = byte_size;
+    it->second.words.resize(CeilOfRatio(byte_size, int64_t{8}), 0);
+  }
+  CHECK_EQ(it->second.byte_size, byte_size)
+      << "Coverage buffer size mismatch for node " << node->GetName();
+  return reinterpret_cast<uint8_t*>(it->second.words.data());
+}
+
+void JitNodeCoverage::ForEachNode(
+    absl::FunctionRef<void(Node*, absl::Span<const uint8_t>)> f) const {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& [node, buffer] : buffers_) {
+    f(node, absl::MakeConstSpan(
+                reinterpret_cast<const uint8_t*>(buffer.words.data()),
+                buffer.byte_size));
+  }
+}
+
+void JitNodeCoverage::Clear() {
+  absl::MutexLock lock(&mutex_);
+  for (auto& [node, buffer] : buffers_) {
+    std::fill(buffer.words.begin(), buffer.words.end(), 0);
+  }
+}
+
+}  // namespace xls
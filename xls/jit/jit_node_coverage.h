@@ -0,0 +1,82 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_NODE_COVERAGE_H_
+#define XLS_JIT_JIT_NODE_COVERAGE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Storage for node coverage collected natively by jitted code. When a
+// JitNodeCoverage is attached to an LlvmCompiler, the code generated for each
+// node ORs the node's value (in the native layout of the JIT) into a buffer
+// owned by this object. No callbacks are made so coverage runs are nearly as
+// fast as plain JIT runs. After evaluation the buffers hold the union of all
+// the values each node took, i.e. the bits which toggled to one.
+//
+// The buffers are referenced by address from the jitted code so this object
+// must outlive any code compiled with it. Jitted code sets bits with atomic
+// ORs, so code running concurrently on several threads never loses coverage.
+class JitNodeCoverage {
+ public:
+  JitNodeCoverage() = default;
+  JitNodeCoverage(const JitNodeCoverage&) = delete;
+  JitNodeCoverage& operator=(const JitNodeCoverage&) = delete;
+
+  // Returns the zero-initialized coverage buffer of `byte_size` bytes for
+  // `node`, allocating it if necessary. The buffer is 8-byte aligned and padded
+  // to a multiple of 8 bytes so it can be updated with aligned atomics. The
+  // pointer is stable for the lifetime of this object. Thread-safe so procs may
+  // be compiled concurrently.
+  uint8_t* GetOrCreateBuffer(Node* node, int64_t byte_size);
+
+  // Address of the flag which jitted code checks before updating coverage.
+  // Non-zero while paused.
+  const uint8_t* paused_flag() const { return &paused_; }
+
+  // While paused jitted code does not update the coverage buffers. Must not be
+  // called while jitted code is running.
+  void SetPaused(bool paused) { paused_ = paused ? 1 : 0; }
+
+  // Calls `f` with each node and its coverage buffer.
+  void ForEachNode(
+      absl::FunctionRef<void(Node*, absl::Span<const uint8_t>)> f) const;
+
+  // Clears all the collected coverage.
+  void Clear();
+
+ private:
+  mutable absl::Mutex mutex_;
+  struct Buffer {
+    int64_t byte_size = 0;
+    std::vector<uint64_t> words;
+  };
+  // The buffer storage never moves (even when the map rehashes) so the
+  // pointers baked into jitted code remain valid.
+  absl::flat_hash_map<Node*, Buffer> buffers_ ABSL_GUARDED_BY(mutex_);
+  uint8_t paused_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_NODE_COVERAGE_H_
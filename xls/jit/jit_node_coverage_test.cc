@@ -0,0 +1,182 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_node_coverage.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+class JitNodeCoverageTest : public IrTestBase {
+ protected:
+  // Returns the coverage of every node.
+  absl::flat_hash_map<Node*, std::vector<uint8_t>> GetCoverage(
+      const JitNodeCoverage& coverage) {
+    absl::flat_hash_map<Node*, std::vector<uint8_t>> result;
+    coverage.ForEachNode([&](Node* node, absl::Span<const uint8_t> data) {
+      result[node] = std::vector<uint8_t>(data.begin(), data.end());
+    });
+    return result;
+  }
+};
+
+TEST_F(JitNodeCoverageTest, BuffersAreStableAndCleared) {
+  auto package = CreatePackage();
+  FunctionBuilder fb(TestName(), package.get());
+  BValue x = fb.Param("x", package->GetBitsType(8));
+  BValue y = fb.Not(x);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  JitNodeCoverage coverage;
+  uint8_t* x_buffer = coverage.GetOrCreateBuffer(x.node(), 1);
+  uint8_t* y_buffer = coverage.GetOrCreateBuffer(y.node(), 1);
+  EXPECT_EQ(coverage.GetOrCreateBuffer(x.node(), 1), x_buffer);
+  EXPECT_EQ(*x_buffer, 0);
+  *y_buffer = 0x5a;
+  EXPECT_THAT(GetCoverage(coverage)[y.node()], ElementsAre(0x5a));
+  coverage.Clear();
+  EXPECT_THAT(GetCoverage(coverage)[y.node()], ElementsAre(0));
+
+  EXPECT_EQ(*coverage.paused_flag(), 0);
+  coverage.SetPaused(true);
+  EXPECT_NE(*coverage.paused_flag(), 0);
+}
+
+TEST_F(JitNodeCoverageTest, ProcJitRecordsToggledBits) {
+  auto package = CreatePackage();
+  ProcBuilder pb(TestName(), package.get());
+  BValue counter = pb.StateElement("counter", Value(UBits(5, 32)));
+  BValue next = pb.Add(counter, pb.Literal(UBits(1, 32)));
+  pb.Next(counter, next);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto orc_jit, OrcJit::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(auto data_layout, orc_jit->CreateDataLayout());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(
+          package.get(), std::make_unique<JitRuntime>(data_layout)));
+  JitNodeCoverage coverage;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> jit,
+      ProcJit::Create(proc, &queue_manager->runtime(), queue_manager.get(),
+                      /*include_observer_callbacks=*/false,
+                      /*observer=*/nullptr, &coverage));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProcInstance * instance,
+      queue_manager->elaboration().GetUniqueInstance(proc));
+  std::unique_ptr<ProcContinuation> continuation =
+      jit->NewContinuation(instance);
+
+  // The counter takes the values 6, 7, 8 which together set the low four
+  // bits.
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(jit->Tick(*continuation).status());
+  }
+  EXPECT_THAT(GetCoverage(coverage)[next.node()], ElementsAre(0xf, 0, 0, 0));
+
+  // Nothing is recorded while paused.
+  coverage.SetPaused(true);
+  XLS_ASSERT_OK(jit->Tick(*continuation).status());
+  EXPECT_THAT(GetCoverage(coverage)[next.node()], ElementsAre(0xf, 0, 0, 0));
+
+  coverage.SetPaused(false);
+  coverage.Clear();
+  XLS_ASSERT_OK(jit->Tick(*continuation).status());
+  EXPECT_THAT(GetCoverage(coverage)[next.node()], ElementsAre(10, 0, 0, 0));
+}
+
+TEST_F(JitNodeCoverageTest, ConcurrentTicksDoNotLoseBits) {
+  // A one-hot bit walks up a wide state element, so each tick sets a bit no
+  // other tick sets. The value is wide enough to be updated with a loop.
+  constexpr int64_t kWidth = 1024;
+  constexpr int64_t kThreads = 8;
+  constexpr int64_t kTicks = 100;
+  auto package = CreatePackage();
+  ProcBuilder pb(TestName(), package.get());
+  BValue state = pb.StateElement("state", Value(UBits(1, kWidth)));
+  BValue next = pb.Shll(state, pb.Literal(UBits(1, 32)));
+  pb.Next(state, next);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto orc_jit, OrcJit::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(auto data_layout, orc_jit->CreateDataLayout());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(
+          package.get(), std::make_unique<JitRuntime>(data_layout)));
+  JitNodeCoverage coverage;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> jit,
+      ProcJit::Create(proc, &queue_manager->runtime(), queue_manager.get(),
+                      /*include_observer_callbacks=*/false,
+                      /*observer=*/nullptr, &coverage));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProcInstance * instance,
+      queue_manager->elaboration().GetUniqueInstance(proc));
+
+  // Thread `t` walks the bit from position t * kTicks so the threads together
+  // set bits 1 through kThreads * kTicks of `next`.
+  std::vector<std::unique_ptr<ProcContinuation>> continuations;
+  for (int64_t t = 0; t < kThreads; ++t) {
+    continuations.push_back(jit->NewContinuation(instance));
+    XLS_ASSERT_OK(continuations.back()->SetState(
+        {Value(Bits::PowerOfTwo(t * kTicks, kWidth))}));
+  }
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t t = 0; t < kThreads; ++t) {
+      threads.push_back(std::make_unique<Thread>([&, t]() {
+        for (int64_t i = 0; i < kTicks; ++i) {
+          XLS_EXPECT_OK(jit->Tick(*continuations[t]).status());
+        }
+      }));
+    }
+  }
+
+  std::vector<uint8_t> expected(kWidth / 8, 0);
+  for (int64_t bit = 1; bit <= kThreads * kTicks; ++bit) {
+    expected[bit / 8] |= 1 << (bit % 8);
+  }
+  EXPECT_THAT(GetCoverage(coverage)[next.node()], ElementsAreArray(expected));
+}
+
+}  // namespace
+}  // namespace xls
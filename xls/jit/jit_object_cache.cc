@@ -0,0 +1,175 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+
+#include "absl/base/no_destructor.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/ADT/ArrayRef.h"
+#include "llvm/include/llvm/ADT/StringExtras.h"
+#include "llvm/include/llvm/ADT/StringRef.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Support/SHA256.h"
+#include "llvm/include/llvm/Support/raw_ostream.h"
+#include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+
+ABSL_FLAG(std::optional<std::string>, xls_jit_object_cache_dir, std::nullopt,
+          "If set, objects compiled by the XLS JIT are cached in this "
+          "directory and reused by later compilations of identical IR, "
+          "including compilations in other processes.");
+
+namespace xls {
+namespace {
+
+// Bumped whenever the JIT changes in a way which invalidates cached objects
+// without changing the LLVM IR (e.g., the code generation pipeline).
+constexpr std::string_view kCacheFormatVersion = "xls-jit-object-cache-v1";
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<JitObjectCache>>
+JitObjectCache::Create(const std::filesystem::path& directory) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  return absl::WrapUnique(new JitObjectCache(directory));
+}
+
+/* static */ JitObjectCache* JitObjectCache::GetDefault() {
+  std::optional<std::string> directory =
+      absl::GetFlag(FLAGS_xls_jit_object_cache_dir);
+  if (!directory.has_value() || directory->empty()) {
+    return nullptr;
+  }
+  static absl::NoDestructor<absl::Mutex> mutex;
+  static absl::NoDestructor<
+      absl::flat_hash_map<std::string, std::unique_ptr<JitObjectCache>>>
+      caches;
+  absl::MutexLock lock(mutex.get());
+  auto it = caches->find(*directory);
+  if (it != caches->end()) {
+    return it->second.get();
+  }
+  absl::StatusOr<std::unique_ptr<JitObjectCache>> cache = Create(*directory);
+  if (!cache.ok()) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to create JIT object cache in `%s`, caching disabled: %s",
+        *directory, cache.status().ToString());
+    caches->emplace(*directory, nullptr);
+    return nullptr;
+  }
+  return caches->emplace(*directory, *std::move(cache)).first->second.get();
+}
+
+/* static */ std::string JitObjectCache::ComputeKey(
+    const llvm::Module& module, const llvm::TargetMachine& target_machine,
+    int64_t opt_level, bool vectorize, bool include_msan) {
+  std::string text;
+  llvm::raw_string_ostream ostream(text);
+  ostream << kCacheFormatVersion << "\n"
+          << target_machine.getTargetTriple().str() << "\n"
+          << target_machine.getTargetCPU() << "\n"
+          << target_machine.getTargetFeatureString() << "\n"
+          << "opt_level=" << opt_level << "\n"
+          << "vectorize=" << vectorize << "\n"
+          << "msan=" << include_msan << "\n";
+  module.print(ostream, /*AAW=*/nullptr);
+  ostream.flush();
+  std::array<uint8_t, 32> digest = llvm::SHA256::hash(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(text.data()), text.size()));
+  return llvm::toHex(digest, /*LowerCase=*/true);
+}
+
+std::filesystem::path JitObjectCache::GetObjectPath(
+    std::string_view key) const {
+  return directory_ / absl::StrCat(key, ".o");
+}
+
+std::unique_ptr<llvm::MemoryBuffer> JitObjectCache::Lookup(
+    std::string_view key) {
+  std::filesystem::path path = GetObjectPath(key);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(path.string(), /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false);
+  absl::MutexLock lock(&mutex_);
+  if (!buffer) {
+    ++miss_count_;
+    VLOG(2) << absl::StreamFormat("JIT object cache miss: %s", path.string());
+    return nullptr;
+  }
+  ++hit_count_;
+  VLOG(2) << absl::StreamFormat("JIT object cache hit: %s", path.string());
+  return std::move(buffer.get());
+}
+
+void JitObjectCache::Store(std::string_view key,
+                           llvm::MemoryBufferRef object) {
+  // Write to a uniquely named temporary file and rename it into place so that
+  // concurrent readers never observe a partially written object.
+  std::filesystem::path path = GetObjectPath(key);
+  static std::atomic<int64_t> temp_file_counter = 0;
+  std::filesystem::path temp_path =
+      directory_ / absl::StrFormat("%s.o.tmp.%d.%d", key, getpid(),
+                                   temp_file_counter.fetch_add(1));
+  absl::Status status = SetFileContents(
+      temp_path, std::string_view(object.getBufferStart(),
+                                  object.getBufferSize()));
+  if (status.ok()) {
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+      status = absl::InternalError(ec.message());
+    }
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to write JIT object cache entry `%s`: %s", path.string(),
+        status.ToString());
+    std::error_code ec;
+    std::filesystem::remove(temp_path, ec);
+  }
+}
+
+int64_t JitObjectCache::hit_count() const {
+  absl::MutexLock lock(&mutex_);
+  return hit_count_;
+}
+
+int64_t JitObjectCache::miss_count() const {
+  absl::MutexLock lock(&mutex_);
+  return miss_count_;
+}
+
+}  // namespace xls
@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Target/TargetMachine.h"
+
+namespace xls {
+
+// A persistent cache of JIT-compiled object files stored in a directory on
+// disk. Objects are keyed by a hash of the unoptimized LLVM IR, the target
+// machine and the optimization level so that repeat compilations of the same
+// IR can skip optimization and code generation entirely.
+//
+// Lookups are performed by OrcJit before the module is optimized (see
+// `Lookup`). On a miss the OrcJit remembers the key of the module and, once
+// the module has been compiled, passes the generated object to `Store`. The
+// cache itself holds no per-module state.
+//
+// The cache is thread-safe and may be shared by any number of OrcJits. Entries
+// are written atomically so multiple processes may share a cache directory.
+class JitObjectCache {
+ public:
+  // Creates a cache which stores objects in `directory`. The directory is
+  // created if it does not exist.
+  static absl::StatusOr<std::unique_ptr<JitObjectCache>> Create(
+      const std::filesystem::path& directory);
+
+  // Returns the process-wide cache rooted at the directory given by the
+  // `--xls_jit_object_cache_dir` flag or nullptr if the flag is not set.
+  static JitObjectCache* GetDefault();
+
+  // Returns the cache key for the given (unoptimized) module when compiled
+  // for `target_machine` with the given optimization settings.
+  static std::string ComputeKey(const llvm::Module& module,
+                                const llvm::TargetMachine& target_machine,
+                                int64_t opt_level, bool vectorize,
+                                bool include_msan);
+
+  // Returns the cached object with the given key or nullptr if there is none.
+  std::unique_ptr<llvm::MemoryBuffer> Lookup(std::string_view key);
+
+  // Writes `object` to the cache under `key`. Failures are logged and
+  // otherwise ignored as the cache is only an optimization.
+  void Store(std::string_view key, llvm::MemoryBufferRef object);
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  int64_t hit_count() const;
+  int64_t miss_count() const;
+
+ private:
+  explicit JitObjectCache(const std::filesystem::path& directory)
+      : directory_(directory) {}
+
+  std::filesystem::path GetObjectPath(std::string_view key) const;
+
+  std::filesystem::path directory_;
+
+  mutable absl::Mutex mutex_;
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
@@ -0,0 +1,233 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
+#include "llvm/include/llvm/IR/BasicBlock.h"
+#include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/observer.h"
+#include "xls/jit/orc_jit.h"
+
+ABSL_DECLARE_FLAG(std::optional<std::string>, xls_jit_object_cache_dir);
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::testing::SizeIs;
+
+constexpr std::string_view kAddPackage = R"(
+package add_package
+
+top fn add(x: bits[32] id=1, y: bits[32] id=2) -> bits[32] {
+  ret add.3: bits[32] = add(x, y, id=3)
+}
+)";
+
+class JitObjectCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+    temp_dir_ = std::make_unique<TempDirectory>(std::move(temp_dir));
+    absl::SetFlag(&FLAGS_xls_jit_object_cache_dir, temp_dir_->path().string());
+  }
+
+  void TearDown() override {
+    absl::SetFlag(&FLAGS_xls_jit_object_cache_dir, std::nullopt);
+  }
+
+  // Returns the number of objects in the cache directory.
+  absl::StatusOr<int64_t> EntryCount() {
+    XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> entries,
+                         GetDirectoryEntries(temp_dir_->path()));
+    return entries.size();
+  }
+
+  std::unique_ptr<TempDirectory> temp_dir_;
+};
+
+// Requests the optimized module, which disables the object cache.
+class OptimizedModuleObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const override {
+    return JitObserverRequests{.optimized_module = true};
+  }
+};
+
+// Compiles a module defining `int64_t add_constant(int64_t x)` which returns
+// `x + addend` with a fresh OrcJit. The function is only materialized (and
+// the object only generated) if `load` is true, in which case it is also
+// called to check the compiled code.
+absl::Status CompileAddConstant(int64_t addend, bool load) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> jit, OrcJit::Create());
+  std::unique_ptr<llvm::Module> module = jit->NewModule("add_constant");
+  llvm::IRBuilder<> b(module->getContext());
+  llvm::Function* function = llvm::Function::Create(
+      llvm::FunctionType::get(b.getInt64Ty(), {b.getInt64Ty()},
+                              /*isVarArg=*/false),
+      llvm::Function::ExternalLinkage, "add_constant", module.get());
+  b.SetInsertPoint(
+      llvm::BasicBlock::Create(module->getContext(), "entry", function));
+  b.CreateRet(b.CreateAdd(function->getArg(0), b.getInt64(addend)));
+  XLS_RETURN_IF_ERROR(jit->CompileModule(std::move(module)));
+  if (!load) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(llvm::orc::ExecutorAddr address,
+                       jit->LoadSymbol("add_constant"));
+  XLS_RET_CHECK_EQ(address.toPtr<int64_t (*)(int64_t)>()(1), 1 + addend);
+  return absl::OkStatus();
+}
+
+TEST_F(JitObjectCacheTest, DefaultCacheUsesFlag) {
+  JitObjectCache* cache = JitObjectCache::GetDefault();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(cache->directory(), temp_dir_->path());
+  EXPECT_EQ(JitObjectCache::GetDefault(), cache);
+
+  absl::SetFlag(&FLAGS_xls_jit_object_cache_dir, std::nullopt);
+  EXPECT_EQ(JitObjectCache::GetDefault(), nullptr);
+}
+
+TEST_F(JitObjectCacheTest, SecondCompilationHitsCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kAddPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetTopAsFunction());
+  JitObjectCache* cache = JitObjectCache::GetDefault();
+  ASSERT_NE(cache, nullptr);
+
+  std::vector<Value> args = {Value(UBits(40, 32)), Value(UBits(2, 32))};
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(function));
+    EXPECT_THAT(DropInterpreterEvents(jit->Run(args)),
+                IsOkAndHolds(Value(UBits(42, 32))));
+  }
+  EXPECT_EQ(cache->hit_count(), 0);
+  EXPECT_EQ(cache->miss_count(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           GetDirectoryEntries(temp_dir_->path()));
+  EXPECT_THAT(entries, SizeIs(1));
+
+  // A fresh package with identical IR reuses the cached object.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package2,
+                           Parser::ParsePackage(kAddPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function2, package2->GetTopAsFunction());
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(function2));
+    EXPECT_THAT(DropInterpreterEvents(jit->Run(args)),
+                IsOkAndHolds(Value(UBits(42, 32))));
+  }
+  EXPECT_EQ(cache->hit_count(), 1);
+  EXPECT_EQ(cache->miss_count(), 1);
+
+  // A different optimization level is a different cache entry.
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(function2, /*opt_level=*/1));
+    EXPECT_THAT(DropInterpreterEvents(jit->Run(args)),
+                IsOkAndHolds(Value(UBits(42, 32))));
+  }
+  EXPECT_EQ(cache->hit_count(), 1);
+  EXPECT_EQ(cache->miss_count(), 2);
+}
+
+TEST_F(JitObjectCacheTest, UncacheableCompilationDoesNotWriteCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kAddPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetTopAsFunction());
+  JitObjectCache* cache = JitObjectCache::GetDefault();
+  ASSERT_NE(cache, nullptr);
+
+  std::vector<Value> args = {Value(UBits(40, 32)), Value(UBits(2, 32))};
+  OptimizedModuleObserver observer;
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<FunctionJit> jit,
+        FunctionJit::Create(function, /*opt_level=*/3,
+                            /*include_observer_callbacks=*/false, &observer));
+    EXPECT_THAT(DropInterpreterEvents(jit->Run(args)),
+                IsOkAndHolds(Value(UBits(42, 32))));
+  }
+  EXPECT_EQ(cache->hit_count(), 0);
+  EXPECT_EQ(cache->miss_count(), 0);
+  EXPECT_THAT(EntryCount(), IsOkAndHolds(0));
+
+  // A cacheable compilation afterwards is cached as usual.
+  for (int64_t i = 0; i < 2; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(function));
+    EXPECT_THAT(DropInterpreterEvents(jit->Run(args)),
+                IsOkAndHolds(Value(UBits(42, 32))));
+  }
+  EXPECT_EQ(cache->hit_count(), 1);
+  EXPECT_EQ(cache->miss_count(), 1);
+  EXPECT_THAT(EntryCount(), IsOkAndHolds(1));
+}
+
+TEST_F(JitObjectCacheTest, UnmaterializedModuleIsNotCached) {
+  JitObjectCache* cache = JitObjectCache::GetDefault();
+  ASSERT_NE(cache, nullptr);
+
+  // The object of a module which is never materialized is never generated so
+  // nothing is cached for it, and the key it registered must not be used for
+  // the objects of later modules.
+  XLS_ASSERT_OK(CompileAddConstant(/*addend=*/1, /*load=*/false));
+  EXPECT_THAT(EntryCount(), IsOkAndHolds(0));
+  XLS_ASSERT_OK(CompileAddConstant(/*addend=*/2, /*load=*/true));
+  EXPECT_THAT(EntryCount(), IsOkAndHolds(1));
+  EXPECT_EQ(cache->hit_count(), 0);
+  EXPECT_EQ(cache->miss_count(), 2);
+
+  XLS_ASSERT_OK(CompileAddConstant(/*addend=*/1, /*load=*/true));
+  EXPECT_EQ(cache->hit_count(), 0);
+  EXPECT_EQ(cache->miss_count(), 3);
+  XLS_ASSERT_OK(CompileAddConstant(/*addend=*/2, /*load=*/true));
+  XLS_ASSERT_OK(CompileAddConstant(/*addend=*/1, /*load=*/true));
+  EXPECT_EQ(cache->hit_count(), 2);
+  EXPECT_EQ(cache->miss_count(), 3);
+  EXPECT_THAT(EntryCount(), IsOkAndHolds(2));
+}
+
+}  // namespace
+}  // namespace xls
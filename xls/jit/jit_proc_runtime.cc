@@ -14,6 +14,8 @@
 
 #include "xls/jit/jit_proc_runtime.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -25,6 +27,7 @@
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -36,8 +39,10 @@
 #include "llvm/include/llvm/Target/TargetMachine.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
@@ -46,9 +51,12 @@
 #include "xls/ir/value.h"
 #include "xls/jit/aot_compiler.h"
 #include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/bit_packed_arrays.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_layout_options.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/lazy_proc_jit.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/proc_jit.h"
@@ -123,12 +131,12 @@ class SharedCompiler final : public LlvmCompiler {
   std::optional<std::unique_ptr<llvm::Module>> the_module_;
 };
 
-absl::StatusOr<JitObjectCode> GetAotObjectCode(ProcElaboration elaboration,
-                                               int64_t opt_level,
-                                               bool with_msan,
-                                               JitObserver* observer) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<AotCompiler> compiler,
-                       AotCompiler::Create(with_msan, opt_level, observer));
+absl::StatusOr<JitObjectCode> GetAotObjectCode(
+    ProcElaboration elaboration, int64_t opt_level, bool with_msan,
+    JitObserver* observer, const LlvmPgoOptions& pgo_options) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<AotCompiler> compiler,
+      AotCompiler::Create(with_msan, opt_level, observer, pgo_options));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::TargetMachine> target,
                        compiler->CreateTargetMachine());
   llvm::DataLayout layout = target->createDataLayout();
@@ -232,7 +240,13 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotRuntime(
   return std::move(proc_runtime);
 }
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
+// The queue manager and ProcJits for all procs in an elaboration.
+struct ProcJitNetwork {
+  std::unique_ptr<JitChannelQueueManager> queue_manager;
+  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
+};
+
+absl::StatusOr<ProcJitNetwork> CreateProcJitNetwork(
     ProcElaboration elaboration, const EvaluatorOptions& options) {
   // We use the compiler to know the data layout.
   XLS_ASSIGN_OR_RETURN(
@@ -241,29 +255,104 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
           LlvmCompiler::kDefaultOptLevel,
           /*include_observer_callbacks=*/options.support_observers()));
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout layout, comp->CreateDataLayout());
+  JitLayoutOptions layout_options;
+  if (options.jit_bit_packed_array_min_bytes() > 0) {
+    XLS_ASSIGN_OR_RETURN(layout_options,
+                         ChooseBitPackedArrayLayout(
+                             elaboration.package(), layout,
+                             options.jit_bit_packed_array_min_bytes()));
+  }
   // Create a queue manager for the queues. This factory verifies that there an
   // receive only queue for every receive only channel.
+  ProcJitNetwork network;
   XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      network.queue_manager,
       JitChannelQueueManager::CreateThreadSafe(
-          std::move(elaboration), std::make_unique<JitRuntime>(layout)));
+          std::move(elaboration),
+          std::make_unique<JitRuntime>(layout, std::move(layout_options))));
 
-  // Create a ProcJit for each Proc.
-  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
-  for (Proc* proc : queue_manager->elaboration().procs()) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<ProcJit> proc_jit,
-        ProcJit::Create(
-            proc, &queue_manager->runtime(), queue_manager.get(),
-            /*include_observer_callbacks=*/options.support_observers()));
-    proc_jits.push_back(std::move(proc_jit));
+  absl::Span<Proc* const> procs = network.queue_manager->elaboration().procs();
+  if (options.lazy_jit_compilation()) {
+    for (Proc* proc : procs) {
+      network.proc_jits.push_back(std::make_unique<LazyProcJit>(
+          proc, &network.queue_manager->runtime(), network.queue_manager.get(),
+          /*include_observer_callbacks=*/options.support_observers(),
+          options.jit_node_coverage(), options.jit_node_profiler()));
+    }
+    return network;
   }
 
+  // Create a ProcJit for each Proc. Each ProcJit owns a separate OrcJit (and
+  // LLVM context) so the procs may be compiled concurrently.
+  std::vector<absl::StatusOr<std::unique_ptr<ProcJit>>> proc_jits(
+      procs.size(), absl::UnknownError("Proc not compiled"));
+  auto compile_proc = [&](int64_t i) {
+    proc_jits[i] = ProcJit::Create(
+        procs[i], &network.queue_manager->runtime(),
+        network.queue_manager.get(),
+        /*include_observer_callbacks=*/options.support_observers(),
+        /*observer=*/nullptr, options.jit_node_coverage(),
+        options.jit_node_profiler());
+  };
+  int64_t thread_count = std::min(options.jit_compile_threads(),
+                                  static_cast<int64_t>(procs.size()));
+  if (thread_count <= 1) {
+    for (int64_t i = 0; i < procs.size(); ++i) {
+      compile_proc(i);
+    }
+  } else {
+    VLOG(1) << absl::StreamFormat("Compiling %d procs on %d threads",
+                                  procs.size(), thread_count);
+    std::atomic<int64_t> next_proc = 0;
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t t = 0; t < thread_count; ++t) {
+      threads.push_back(std::make_unique<Thread>([&]() {
+        for (int64_t i = next_proc.fetch_add(1); i < procs.size();
+             i = next_proc.fetch_add(1)) {
+          compile_proc(i);
+        }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (absl::StatusOr<std::unique_ptr<ProcJit>>& proc_jit : proc_jits) {
+    XLS_RETURN_IF_ERROR(proc_jit.status());
+    network.proc_jits.push_back(*std::move(proc_jit));
+  }
+  return network;
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options) {
+  XLS_ASSIGN_OR_RETURN(ProcJitNetwork network,
+                       CreateProcJitNetwork(std::move(elaboration), options));
+
   // Create a runtime.
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<SerialProcRuntime> proc_runtime,
-      SerialProcRuntime::Create(std::move(proc_jits), std::move(queue_manager),
-                                options));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
+                       SerialProcRuntime::Create(
+                           std::move(network.proc_jits),
+                           std::move(network.queue_manager), options));
+
+  XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
+      proc_runtime->elaboration(), proc_runtime->queue_manager()));
+  return std::move(proc_runtime);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> CreateParallelRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options,
+    std::optional<int64_t> thread_count) {
+  XLS_ASSIGN_OR_RETURN(ProcJitNetwork network,
+                       CreateProcJitNetwork(std::move(elaboration), options));
+
+  // Create a runtime.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParallelProcRuntime> proc_runtime,
+                       ParallelProcRuntime::Create(
+                           std::move(network.proc_jits),
+                           std::move(network.queue_manager), options,
+                           thread_count));
 
   XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
       proc_runtime->elaboration(), proc_runtime->queue_manager()));
@@ -286,23 +375,37 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
   return CreateRuntime(std::move(elaboration), options);
 }
 
-absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(Package* package,
-                                                      int64_t opt_level,
-                                                      bool with_msan,
-                                                      JitObserver* observer) {
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Package* package, const EvaluatorOptions& options,
+                             std::optional<int64_t> thread_count) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateParallelRuntime(std::move(elaboration), options, thread_count);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Proc* top, const EvaluatorOptions& options,
+                             std::optional<int64_t> thread_count) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  return CreateParallelRuntime(std::move(elaboration), options, thread_count);
+}
+
+absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(
+    Package* package, int64_t opt_level, bool with_msan, JitObserver* observer,
+    const LlvmPgoOptions& pgo_options) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::ElaborateOldStylePackage(package));
   return GetAotObjectCode(std::move(elaboration), opt_level, with_msan,
-                          observer);
+                          observer, pgo_options);
 }
-absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(Proc* top,
-                                                      int64_t opt_level,
-                                                      bool with_msan,
-                                                      JitObserver* observer) {
+absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(
+    Proc* top, int64_t opt_level, bool with_msan, JitObserver* observer,
+    const LlvmPgoOptions& pgo_options) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::Elaborate(top));
   return GetAotObjectCode(std::move(elaboration), opt_level, with_msan,
-                          observer);
+                          observer, pgo_options);
 }
 
 // Create a SerialProcRuntime composed of ProcJits. Constructed from the
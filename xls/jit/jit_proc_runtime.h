@@ -22,11 +22,13 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
 #include "xls/ir/xls_ir_interface.pb.h"
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/function_base_jit.h"
+#include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
 namespace xls {
@@ -41,6 +43,21 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Proc* top, const EvaluatorOptions& options = EvaluatorOptions());
 
+// Create a ParallelProcRuntime composed of ProcJits. Proc instances are ticked
+// on `thread_count` worker threads (by default the number of available CPUs).
+// Supports old-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Package* package, const EvaluatorOptions& options = EvaluatorOptions(),
+    std::optional<int64_t> thread_count = std::nullopt);
+
+// Create a ParallelProcRuntime composed of ProcJits. Constructed from the
+// elaboration of the given proc. Supports new-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Proc* top, const EvaluatorOptions& options = EvaluatorOptions(),
+    std::optional<int64_t> thread_count = std::nullopt);
+
 struct ProcAotEntrypoints {
   // What proc these entrypoints are associated with.
   PackageInterfaceProto::Proc proc_interface_proto;
@@ -73,11 +90,13 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialProcRuntime(
 // Generate AOT code for the given proc elaboration.
 absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(
     Package* package, int64_t opt_level, bool with_msan,
-    JitObserver* observer = nullptr);
+    JitObserver* observer = nullptr,
+    const LlvmPgoOptions& pgo_options = LlvmPgoOptions());
 // Generate AOT code for the given proc elaboration.
 absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(
     Proc* top, int64_t opt_level, bool with_msan,
-    JitObserver* observer = nullptr);
+    JitObserver* observer = nullptr,
+    const LlvmPgoOptions& pgo_options = LlvmPgoOptions());
 
 }  // namespace xls
 
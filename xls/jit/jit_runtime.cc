@@ -38,14 +38,17 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
-JitRuntime::JitRuntime(llvm::DataLayout data_layout)
+JitRuntime::JitRuntime(llvm::DataLayout data_layout,
+                       JitLayoutOptions layout_options)
     : data_layout_(data_layout),
+      layout_options_(std::move(layout_options)),
       context_(std::make_unique<llvm::LLVMContext>()),
-      type_converter_(
-          std::make_unique<LlvmTypeConverter>(context_.get(), data_layout_)) {}
+      type_converter_(std::make_unique<LlvmTypeConverter>(
+          context_.get(), data_layout_, layout_options_)) {}
 
 absl::Status JitRuntime::PackArgs(absl::Span<const Value> args,
                                   absl::Span<Type* const> arg_types,
@@ -105,10 +108,18 @@ Value JitRuntime::UnpackBufferInternal(const uint8_t* buffer,
       }
 
       const Type* element_type = array_type->element_type();
-      llvm::Type* llvm_element_type =
-          type_converter_->ConvertToLlvmType(array_type->element_type());
       std::vector<Value> values;
       values.reserve(array_type->size());
+      if (type_converter_->IsBitPackedArray(array_type)) {
+        int64_t bit_count = element_type->GetFlatBitCount();
+        for (int64_t i = 0; i < array_type->size(); ++i) {
+          values.push_back(Value(UBits(
+              ReadPackedBits(buffer, i * bit_count, bit_count), bit_count)));
+        }
+        return Value::ArrayOrDie(values);
+      }
+      llvm::Type* llvm_element_type =
+          type_converter_->ConvertToLlvmType(array_type->element_type());
       // This BitsType is only used inside the ToLlvmConstantCall() (and isn't
       // stored), so it's safe for it to live on the stack.
       BitsType bits_type(64);
@@ -165,6 +176,13 @@ void JitRuntime::BlitValueToBufferInternal(const Value& value, const Type* type,
     if (remainder_bits != 0) {
       buffer[byte_count - 1] &= static_cast<uint8_t>(Mask(remainder_bits));
     }
+  } else if (value.IsArray() && type_converter_->IsBitPackedArray(type)) {
+    // The buffer has been zeroed so only the element bits need to be written.
+    int64_t bit_count = type->AsArrayOrDie()->element_type()->GetFlatBitCount();
+    for (int64_t i = 0; i < value.size(); ++i) {
+      WritePackedBits(buffer.data(), i * bit_count, bit_count,
+                      value.element(i).bits().ToUint64().value());
+    }
   } else if (value.IsArray()) {
     const ArrayType* array_type = type->AsArrayOrDie();
     int64_t element_size =
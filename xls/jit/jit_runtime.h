@@ -27,6 +27,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -35,7 +36,10 @@ namespace xls {
 // data out of a flat character buffer, thus these routines are necessary.
 class JitRuntime {
  public:
-  explicit JitRuntime(llvm::DataLayout data_layout);
+  // `layout_options` must match the options the code run with this runtime was
+  // compiled with.
+  explicit JitRuntime(llvm::DataLayout data_layout,
+                      JitLayoutOptions layout_options = JitLayoutOptions());
 
   // Packs the specified values into a flat buffer with the data layout
   // expected by LLVM.
@@ -57,6 +61,10 @@ class JitRuntime {
 
   const llvm::DataLayout& data_layout() { return data_layout_; }
 
+  // The options controlling the native layout of values handled by this
+  // runtime. Immutable after construction.
+  const JitLayoutOptions& layout_options() const { return layout_options_; }
+
   // Returns the number of bytes that should be allocated for a native LLVM
   // value storing `size` bytes with `alignment` alignment.
   //
@@ -108,6 +116,13 @@ class JitRuntime {
     return type_converter_->GetTypePreferredAlignment(xls_type);
   }
 
+  // Returns the native layout of `xls_type` used by code compiled for this
+  // runtime's data layout.
+  TypeLayout CreateTypeLayout(Type* xls_type) {
+    absl::MutexLock lock(&mutex_);
+    return type_converter_->CreateTypeLayout(xls_type);
+  }
+
   const llvm::DataLayout& data_layout() const { return data_layout_; }
 
  private:
@@ -120,6 +135,7 @@ class JitRuntime {
   mutable absl::Mutex mutex_;
 
   const llvm::DataLayout data_layout_;
+  const JitLayoutOptions layout_options_;
   std::unique_ptr<llvm::LLVMContext> context_ ABSL_GUARDED_BY(mutex_);
   std::unique_ptr<LlvmTypeConverter> type_converter_ ABSL_GUARDED_BY(mutex_);
 };
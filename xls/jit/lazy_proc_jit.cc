@@ -0,0 +1,182 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/lazy_proc_jit.h"
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/observer.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+namespace {
+
+// A continuation for a LazyProcJit. Until the proc is compiled the
+// continuation wraps a continuation of the proc interpreter. Once the proc is
+// compiled, and the interpreter is between ticks, a continuation of the
+// compiled ProcJit is created from the interpreter's state and all further
+// operations are forwarded to it.
+class LazyProcJitContinuation : public ProcContinuation {
+ public:
+  LazyProcJitContinuation(
+      ProcInstance* proc_instance, bool supports_observers,
+      std::unique_ptr<ProcContinuation> interpreter_continuation)
+      : ProcContinuation(proc_instance),
+        supports_observers_(supports_observers),
+        interpreter_continuation_(std::move(interpreter_continuation)) {}
+
+  std::vector<Value> GetState() const override { return active().GetState(); }
+  absl::Status SetState(std::vector<Value> v) override {
+    return active().SetState(std::move(v));
+  }
+
+  const InterpreterEvents& GetEvents() const override {
+    return active().GetEvents();
+  }
+  InterpreterEvents& GetEvents() override { return active().GetEvents(); }
+  void ClearEvents() override { active().ClearEvents(); }
+
+  bool AtStartOfTick() const override { return active().AtStartOfTick(); }
+
+  absl::Status SetObserver(EvaluationObserver* observer) override {
+    if (!supports_observers_) {
+      return absl::UnimplementedError(
+          "Observers are not supported on this compilation.");
+    }
+    XLS_RETURN_IF_ERROR(ProcContinuation::SetObserver(observer));
+    return active().SetObserver(observer);
+  }
+  void ClearObserver() override {
+    ProcContinuation::ClearObserver();
+    active().ClearObserver();
+  }
+  bool SupportsObservers() const override { return supports_observers_; }
+
+  // Returns whether the continuation has been handed over to the compiled
+  // proc.
+  bool compiled() const { return jit_continuation_ != nullptr; }
+
+  ProcContinuation& interpreter_continuation() {
+    return *interpreter_continuation_;
+  }
+  ProcContinuation& jit_continuation() { return *jit_continuation_; }
+
+  // Hands the continuation over to the compiled proc. The state and pending
+  // events of the interpreter continuation are carried over, so the
+  // interpreter must be between ticks.
+  absl::Status SwitchToJit(const ProcJit& jit) {
+    XLS_RET_CHECK(!compiled());
+    XLS_RET_CHECK(interpreter_continuation_->AtStartOfTick());
+    std::unique_ptr<ProcContinuation> jit_continuation =
+        jit.NewContinuation(proc_instance());
+    XLS_RETURN_IF_ERROR(
+        jit_continuation->SetState(interpreter_continuation_->GetState()));
+    jit_continuation->GetEvents() = interpreter_continuation_->GetEvents();
+    if (GetObserver().has_value()) {
+      XLS_RETURN_IF_ERROR(jit_continuation->SetObserver(*GetObserver()));
+    }
+    jit_continuation_ = std::move(jit_continuation);
+    interpreter_continuation_.reset();
+    return absl::OkStatus();
+  }
+
+ private:
+  const ProcContinuation& active() const {
+    return compiled() ? *jit_continuation_ : *interpreter_continuation_;
+  }
+  ProcContinuation& active() {
+    return compiled() ? *jit_continuation_ : *interpreter_continuation_;
+  }
+
+  bool supports_observers_;
+  std::unique_ptr<ProcContinuation> interpreter_continuation_;
+  std::unique_ptr<ProcContinuation> jit_continuation_;
+};
+
+}  // namespace
+
+std::unique_ptr<ProcContinuation> LazyProcJit::NewContinuation(
+    ProcInstance* proc_instance) const {
+  return std::make_unique<LazyProcJitContinuation>(
+      proc_instance, include_observer_callbacks_,
+      interpreter_.NewContinuation(proc_instance));
+}
+
+bool LazyProcJit::IsCompiled() const {
+  absl::MutexLock lock(&mutex_);
+  return jit_ != nullptr;
+}
+
+absl::StatusOr<const ProcJit*> LazyProcJit::GetOrCompile() const {
+  absl::MutexLock lock(&mutex_);
+  if (jit_ == nullptr && compile_status_.ok()) {
+    VLOG(1) << absl::StreamFormat("Lazily compiling proc `%s`", proc()->name());
+    absl::StatusOr<std::unique_ptr<ProcJit>> jit =
+        ProcJit::Create(proc(), jit_runtime_, queue_mgr_,
+                        include_observer_callbacks_, /*observer=*/nullptr,
+                        node_coverage_, node_profiler_);
+    if (jit.ok()) {
+      jit_ = *std::move(jit);
+    } else {
+      compile_status_ = jit.status();
+    }
+  }
+  XLS_RETURN_IF_ERROR(compile_status_);
+  return jit_.get();
+}
+
+absl::StatusOr<TickResult> LazyProcJit::Tick(
+    ProcContinuation& continuation) const {
+  LazyProcJitContinuation* cont =
+      dynamic_cast<LazyProcJitContinuation*>(&continuation);
+  XLS_RET_CHECK_NE(cont, nullptr)
+      << "LazyProcJit requires a continuation of type LazyProcJitContinuation";
+  // Native coverage and profiling are only recorded by compiled code, so with
+  // either of them the proc is compiled on its first tick.
+  bool compile_now = node_coverage_ != nullptr || node_profiler_ != nullptr ||
+                     (IsCompiled() && cont->AtStartOfTick());
+  if (!cont->compiled() && !compile_now) {
+    // Interpret the proc until it completes a tick, so that procs which never
+    // get past their first blocking receive are never compiled.
+    XLS_ASSIGN_OR_RETURN(TickResult result,
+                         interpreter_.Tick(cont->interpreter_continuation()));
+    if (result.execution_state == TickExecutionState::kCompleted) {
+      XLS_ASSIGN_OR_RETURN(const ProcJit* jit, GetOrCompile());
+      XLS_RETURN_IF_ERROR(cont->SwitchToJit(*jit));
+    }
+    return result;
+  }
+  XLS_ASSIGN_OR_RETURN(const ProcJit* jit, GetOrCompile());
+  if (!cont->compiled()) {
+    XLS_RETURN_IF_ERROR(cont->SwitchToJit(*jit));
+  }
+  return jit->Tick(cont->jit_continuation());
+}
+
+}  // namespace xls
@@ -0,0 +1,93 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_LAZY_PROC_JIT_H_
+#define XLS_JIT_LAZY_PROC_JIT_H_
+
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_node_coverage.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/node_profiler.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+
+// A proc evaluator which defers JIT compilation of the proc until an instance
+// of the proc completes a tick. Until then ticks are run by the proc
+// interpreter, and each instance switches to the compiled proc at its next
+// tick boundary once the proc is compiled. Creating a LazyProcJit (and
+// continuations for it) is cheap, so runtimes built from LazyProcJits only pay
+// compilation cost for the procs which actually execute: a proc which never
+// gets past a blocking receive is never compiled.
+//
+// With native node coverage or profiling, which the interpreter does not
+// record, the proc is instead compiled on the first tick of any instance.
+//
+// Compilation is thread-safe: if several instances of the proc are ticked
+// concurrently the proc is compiled exactly once.
+class LazyProcJit : public ProcEvaluator {
+ public:
+  LazyProcJit(Proc* proc, JitRuntime* jit_runtime,
+              JitChannelQueueManager* queue_mgr,
+              bool include_observer_callbacks = false,
+              JitNodeCoverage* node_coverage = nullptr,
+              NodeProfiler* node_profiler = nullptr)
+      : ProcEvaluator(proc),
+        interpreter_(proc, queue_mgr),
+        jit_runtime_(jit_runtime),
+        queue_mgr_(queue_mgr),
+        include_observer_callbacks_(include_observer_callbacks),
+        node_coverage_(node_coverage),
+        node_profiler_(node_profiler) {}
+  ~LazyProcJit() override = default;
+
+  std::unique_ptr<ProcContinuation> NewContinuation(
+      ProcInstance* proc_instance) const override;
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override;
+
+  // Returns whether the proc has been compiled.
+  bool IsCompiled() const;
+
+ private:
+  // Returns the compiled ProcJit, compiling the proc if necessary.
+  absl::StatusOr<const ProcJit*> GetOrCompile() const;
+
+  ProcInterpreter interpreter_;
+  JitRuntime* jit_runtime_;
+  JitChannelQueueManager* queue_mgr_;
+  bool include_observer_callbacks_;
+  JitNodeCoverage* node_coverage_;
+  NodeProfiler* node_profiler_;
+
+  mutable absl::Mutex mutex_;
+  mutable std::unique_ptr<ProcJit> jit_ ABSL_GUARDED_BY(mutex_);
+  // The error encountered when compiling the proc, if any. Compilation is not
+  // retried after an error.
+  mutable absl::Status compile_status_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_LAZY_PROC_JIT_H_
@@ -0,0 +1,154 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/lazy_proc_jit.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+JitRuntime* GetJitRuntime() {
+  static auto orc_jit = OrcJit::Create().value();
+  static auto jit_runtime =
+      std::make_unique<JitRuntime>(orc_jit->CreateDataLayout().value());
+  return jit_runtime.get();
+}
+
+template <bool kWithObserver>
+std::unique_ptr<ProcEvaluator> EvaluatorFromProc(
+    Proc* proc, ChannelQueueManager* queue_manager) {
+  JitChannelQueueManager* jit_queue_manager =
+      dynamic_cast<JitChannelQueueManager*>(queue_manager);
+  CHECK(jit_queue_manager != nullptr);
+  return std::make_unique<LazyProcJit>(
+      proc, GetJitRuntime(), jit_queue_manager,
+      /*include_observer_callbacks=*/kWithObserver);
+}
+
+std::unique_ptr<ChannelQueueManager> QueueManagerForPackage(Package* package) {
+  return JitChannelQueueManager::CreateThreadSafe(
+             package,
+             std::make_unique<JitRuntime>(GetJitRuntime()->data_layout()))
+      .value();
+}
+
+// Instantiate and run all the tests in proc_evaluator_test_base.cc.
+INSTANTIATE_TEST_SUITE_P(
+    LazyProcJitTest, ProcEvaluatorTestBase,
+    testing::Values(ProcEvaluatorTestParam(EvaluatorFromProc<false>,
+                                           QueueManagerForPackage,
+                                           /*supports_observers=*/false),
+                    ProcEvaluatorTestParam(EvaluatorFromProc<true>,
+                                           QueueManagerForPackage,
+                                           /*supports_observers=*/true)));
+
+class LazyProcJitTest : public IrTestBase {};
+
+TEST_F(LazyProcJitTest, CompiledAfterFirstCompletedTick) {
+  auto package = CreatePackage();
+  ProcBuilder pb(TestName(), package.get());
+  BValue counter = pb.StateElement("counter", Value(UBits(5, 32)));
+  pb.Next(counter, pb.Add(counter, pb.Literal(UBits(1, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      QueueManagerForPackage(package.get());
+  LazyProcJit jit(proc, GetJitRuntime(),
+                  dynamic_cast<JitChannelQueueManager*>(queue_manager.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProcInstance * instance,
+      queue_manager->elaboration().GetUniqueInstance(proc));
+  std::unique_ptr<ProcContinuation> continuation =
+      jit.NewContinuation(instance);
+  EXPECT_FALSE(jit.IsCompiled());
+  EXPECT_TRUE(continuation->AtStartOfTick());
+  EXPECT_THAT(continuation->GetState(), ElementsAre(Value(UBits(5, 32))));
+
+  // State set before compilation is carried over to the compiled proc.
+  XLS_ASSERT_OK(continuation->SetState({Value(UBits(10, 32))}));
+  EXPECT_FALSE(jit.IsCompiled());
+
+  XLS_ASSERT_OK(jit.Tick(*continuation).status());
+  EXPECT_TRUE(jit.IsCompiled());
+  EXPECT_THAT(continuation->GetState(), ElementsAre(Value(UBits(11, 32))));
+  XLS_ASSERT_OK(jit.Tick(*continuation).status());
+  EXPECT_THAT(continuation->GetState(), ElementsAre(Value(UBits(12, 32))));
+}
+
+TEST_F(LazyProcJitTest, BlockedProcIsNeverCompiled) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_in,
+      package->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                      package->GetBitsType(32)));
+  ProcBuilder pb(TestName(), package.get());
+  BValue sum = pb.StateElement("sum", Value(UBits(0, 32)));
+  BValue input = pb.TupleIndex(pb.Receive(ch_in, pb.Literal(Value::Token())),
+                               1);
+  pb.Next(sum, pb.Add(sum, input));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      QueueManagerForPackage(package.get());
+  LazyProcJit jit(proc, GetJitRuntime(),
+                  dynamic_cast<JitChannelQueueManager*>(queue_manager.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProcInstance * instance,
+      queue_manager->elaboration().GetUniqueInstance(proc));
+  std::unique_ptr<ProcContinuation> continuation =
+      jit.NewContinuation(instance);
+
+  // Nothing is ever sent on the input channel, so the proc never gets past its
+  // receive.
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(TickResult result, jit.Tick(*continuation));
+    EXPECT_EQ(result.execution_state, TickExecutionState::kBlockedOnReceive);
+  }
+  EXPECT_FALSE(jit.IsCompiled());
+
+  // Once the proc can complete a tick it is compiled.
+  XLS_ASSERT_OK(queue_manager->GetQueue(ch_in).Write(Value(UBits(7, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(TickResult result, jit.Tick(*continuation));
+  EXPECT_EQ(result.execution_state, TickExecutionState::kCompleted);
+  EXPECT_TRUE(jit.IsCompiled());
+  EXPECT_THAT(continuation->GetState(), ElementsAre(Value(UBits(7, 32))));
+}
+
+}  // namespace
+}  // namespace xls
@@ -17,9 +17,11 @@
 #include <cerrno>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <system_error>  // NOLINT
+#include <utility>
 
 #include "absl/base/call_once.h"
 #include "absl/log/check.h"
@@ -41,6 +43,8 @@
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/Casting.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "llvm/include/llvm/Support/PGOOptions.h"
+#include "llvm/include/llvm/Support/VirtualFileSystem.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
 #include "llvm/include/llvm/Transforms/Instrumentation/MemorySanitizer.h"
@@ -60,12 +64,53 @@ void OnceInit() {
 }
 }  // namespace
 
+LlvmOptimization ChooseAdaptiveOptimization(
+    int64_t node_count, std::optional<int64_t> expected_invocations,
+    const AdaptiveOptOptions& options) {
+  bool hot = expected_invocations.has_value() &&
+             *expected_invocations >= options.hot_invocation_count;
+  bool cold = expected_invocations.has_value() &&
+              *expected_invocations < options.cold_invocation_count;
+  if (node_count >= options.huge_node_count) {
+    return LlvmOptimization{.opt_level = cold ? 0 : 1, .vectorize = false};
+  }
+  if (node_count >= options.large_node_count) {
+    return LlvmOptimization{.opt_level = cold ? 1 : 2, .vectorize = false};
+  }
+  return LlvmOptimization{.opt_level = hot ? 3 : 2, .vectorize = true};
+}
+
 std::string LlvmCompiler::target_triple() const {
   return target_machine_->getTargetTriple().getTriple();
 }
 
 void LlvmCompiler::InitializeLlvm() { absl::call_once(once, OnceInit); }
 
+absl::Status LlvmCompiler::SetPgoOptions(LlvmPgoOptions options) {
+  switch (options.mode) {
+    case LlvmPgoOptions::Mode::kNone:
+      break;
+    case LlvmPgoOptions::Mode::kInstrument:
+      if (!IsAotCompiler()) {
+        return absl::InvalidArgumentError(
+            "PGO instrumentation is only supported for AOT compilation; the "
+            "instrumented code must be linked against the profile runtime.");
+      }
+      if (options.profile_path.empty()) {
+        options.profile_path = "default_%m.profraw";
+      }
+      break;
+    case LlvmPgoOptions::Mode::kUseProfile:
+      if (options.profile_path.empty()) {
+        return absl::InvalidArgumentError(
+            "A profile path is required to optimize with a profile.");
+      }
+      break;
+  }
+  pgo_options_ = std::move(options);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<llvm::DataLayout> LlvmCompiler::CreateDataLayout() {
   LlvmCompiler::InitializeLlvm();
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::TargetMachine> target_machine,
@@ -142,7 +187,37 @@ llvm::Error LlvmCompiler::PerformStandardOptimization(
   llvm::FunctionAnalysisManager fam;
   llvm::LoopAnalysisManager lam;
   llvm::ModuleAnalysisManager mam;
-  llvm::PassBuilder pass_builder;
+  std::optional<llvm::PGOOptions> pgo_options;
+  switch (pgo_options_.mode) {
+    case LlvmPgoOptions::Mode::kNone:
+      break;
+    case LlvmPgoOptions::Mode::kInstrument:
+      VLOG(2) << "Building with PGO instrumentation writing to "
+              << pgo_options_.profile_path;
+      pgo_options = llvm::PGOOptions(
+          pgo_options_.profile_path, /*CSProfileGenFile=*/"",
+          /*ProfileRemappingFile=*/"", /*MemoryProfile=*/"",
+          llvm::vfs::getRealFileSystem(), llvm::PGOOptions::IRInstr);
+      break;
+    case LlvmPgoOptions::Mode::kUseProfile:
+      VLOG(2) << "Optimizing with PGO profile " << pgo_options_.profile_path;
+      pgo_options = llvm::PGOOptions(
+          pgo_options_.profile_path, /*CSProfileGenFile=*/"",
+          /*ProfileRemappingFile=*/"", /*MemoryProfile=*/"",
+          llvm::vfs::getRealFileSystem(), llvm::PGOOptions::IRUse);
+      break;
+  }
+  llvm::PipelineTuningOptions tuning_options;
+  if (!vectorize_) {
+    VLOG(2) << "Building without vectorization";
+    tuning_options.LoopVectorization = false;
+    tuning_options.LoopInterleaving = false;
+    tuning_options.SLPVectorization = false;
+  }
+  // Pass the target machine so optimizations such as the vectorizers can use
+  // the host's vector registers and cost model.
+  llvm::PassBuilder pass_builder(target_machine_.get(), tuning_options,
+                                 pgo_options);
 
   if (include_msan_) {
     VLOG(2) << "Building with MSAN";
@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -27,6 +28,7 @@
 #include "llvm/include/llvm/Support/Error.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/jit/jit_layout_options.h"
 
 // LLVM is so huge that it noticeably slows down code completion. Don't have
 // includes in the header to avoid this issue as much as possible.
@@ -37,8 +39,71 @@ class Module;
 namespace xls {
 
 class AotCompiler;
+class JitNodeCoverage;
+class NodeProfiler;
 class OrcJit;
 
+// Profile-guided optimization settings for the LLVM optimization pipeline. PGO
+// is a two phase process: code is first compiled with instrumentation and run
+// on representative stimuli, then the raw profiles written by the runs are
+// merged (`llvm-profdata merge -o foo.profdata *.profraw`) and the code is
+// recompiled using the merged profile. Instrumentation counts branches and
+// selects so block layout, inlining and select lowering follow the observed
+// frequencies.
+struct LlvmPgoOptions {
+  enum class Mode : int8_t {
+    kNone,
+    // Emit instrumentation which writes a raw profile at exit. The compiled
+    // code must be linked against the LLVM profile runtime (e.g., with
+    // `-fprofile-generate`) so this is only supported for AOT compilation.
+    kInstrument,
+    // Optimize using a profile collected from instrumented code.
+    kUseProfile,
+  };
+
+  Mode mode = Mode::kNone;
+  // For kInstrument, the path to which the instrumented code writes its raw
+  // profile. `%p` and `%m` patterns are supported and the LLVM_PROFILE_FILE
+  // environment variable takes precedence at runtime. For kUseProfile, the
+  // path of the merged (indexed) profile.
+  std::string profile_path;
+};
+
+// The optimization applied by LlvmCompiler to a compilation unit.
+struct LlvmOptimization {
+  // LLVM optimization level (0-3).
+  int64_t opt_level = 3;
+  // Whether the loop vectorizer, loop interleaving and the SLP vectorizer are
+  // run. These can dominate compile time on the very large straight-line
+  // functions produced by unrolling.
+  bool vectorize = true;
+};
+
+// Thresholds for ChooseAdaptiveOptimization.
+struct AdaptiveOptOptions {
+  // Units with at least this many IR nodes are compiled at O2 (O1 if cold)
+  // without vectorization.
+  int64_t large_node_count = 10'000;
+  // Units with at least this many IR nodes are compiled at O1 (O0 if cold)
+  // without vectorization.
+  int64_t huge_node_count = 100'000;
+  // Smaller units expected to be invoked at least this many times are
+  // compiled at O3.
+  int64_t hot_invocation_count = 100'000;
+  // Units expected to be invoked fewer than this many times are cold: compile
+  // time dominates their run time.
+  int64_t cold_invocation_count = 100;
+};
+
+// Chooses the optimization of a compilation unit (e.g., a jitted function and
+// the functions it invokes) with `node_count` IR nodes which is expected to be
+// invoked `expected_invocations` times, if known. Small units are compiled at
+// O2, or O3 if they are hot, while large units trade code quality for compile
+// time.
+LlvmOptimization ChooseAdaptiveOptimization(
+    int64_t node_count, std::optional<int64_t> expected_invocations,
+    const AdaptiveOptOptions& options = AdaptiveOptOptions());
+
 class LlvmCompiler {
  public:
   static constexpr int64_t kDefaultOptLevel = 3;
@@ -87,11 +152,44 @@ class LlvmCompiler {
   CreateTargetMachine() = 0;
 
   int64_t opt_level() const { return opt_level_; }
+  // Whether the vectorizers run when optimizing the module. Must be set before
+  // the module is compiled.
+  void set_vectorize(bool value) { vectorize_ = value; }
+  bool vectorize() const { return vectorize_; }
   bool include_msan() const { return include_msan_; }
   bool include_observer_callbacks() const {
     return include_observer_callbacks_;
   }
 
+  // When set, the compiled code records the value of every node into
+  // `coverage`, which must outlive the compiled code. Must be set before the
+  // module is compiled. Native coverage embeds host addresses in the code so
+  // it is only meaningful for JIT compilation.
+  void set_node_coverage(JitNodeCoverage* coverage) {
+    node_coverage_ = coverage;
+  }
+  JitNodeCoverage* node_coverage() const { return node_coverage_; }
+
+  // When set, the compiled code accumulates the cycles spent evaluating each
+  // node into `profiler`, which must outlive the compiled code. Must be set
+  // before the module is compiled. Like native coverage this embeds host
+  // addresses in the code so it is only meaningful for JIT compilation.
+  void set_node_profiler(NodeProfiler* profiler) { node_profiler_ = profiler; }
+  NodeProfiler* node_profiler() const { return node_profiler_; }
+
+  // Sets the profile-guided optimization mode used when optimizing the module.
+  // Must be called before the module is compiled.
+  absl::Status SetPgoOptions(LlvmPgoOptions options);
+  const LlvmPgoOptions& pgo_options() const { return pgo_options_; }
+
+  // Sets the native layout of the types in the compiled code. Must be called
+  // before the module is created. The compiled code must be run with a
+  // JitRuntime using the same options.
+  void set_layout_options(JitLayoutOptions options) {
+    layout_options_ = std::move(options);
+  }
+  const JitLayoutOptions& layout_options() const { return layout_options_; }
+
  protected:
   absl::Status Init();
 
@@ -124,6 +222,7 @@ class LlvmCompiler {
   llvm::DataLayout data_layout_;
 
   int64_t opt_level_;
+  bool vectorize_ = true;
   // If the jitted code should include msan calls. Defaults to whatever 'this'
   // process is doing and should only be overridden for AOT generators.
   const bool include_msan_;
@@ -132,6 +231,16 @@ class LlvmCompiler {
   // callback.
   const bool include_observer_callbacks_;
 
+  // Where the compiled code records node coverage, if anywhere.
+  JitNodeCoverage* node_coverage_ = nullptr;
+
+  // Where the compiled code records the node profile, if anywhere.
+  NodeProfiler* node_profiler_ = nullptr;
+
+  LlvmPgoOptions pgo_options_;
+
+  JitLayoutOptions layout_options_;
+
   bool module_created_ = false;
 };
 
@@ -18,6 +18,7 @@
 #include <climits>
 #include <cstdint>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/base/casts.h"
@@ -44,8 +45,83 @@
 namespace xls {
 
 LlvmTypeConverter::LlvmTypeConverter(llvm::LLVMContext* context,
-                                     const llvm::DataLayout& data_layout)
-    : context_(*context), data_layout_(data_layout) {}
+                                     const llvm::DataLayout& data_layout,
+                                     JitLayoutOptions layout_options)
+    : context_(*context),
+      data_layout_(data_layout),
+      layout_options_(std::move(layout_options)) {
+  for (const Type* type : layout_options_.packed_array_types) {
+    CHECK(CanBitPackArray(type))
+        << "Type cannot be bit-packed: " << type->ToString();
+  }
+}
+
+/* static */ bool LlvmTypeConverter::CanBitPackArray(const Type* type) {
+  if (!type->IsArray() || type->AsArrayOrDie()->size() == 0) {
+    return false;
+  }
+  const Type* element_type = type->AsArrayOrDie()->element_type();
+  return element_type->IsBits() && element_type->GetFlatBitCount() > 0 &&
+         element_type->GetFlatBitCount() <= kMaxBitPackedElementBitCount;
+}
+
+/* static */ int64_t LlvmTypeConverter::GetBitPackedArrayByteSize(
+    const ArrayType* type) {
+  return CeilOfRatio(type->GetFlatBitCount(), int64_t{8}) + 1;
+}
+
+llvm::IntegerType* LlvmTypeConverter::GetBitPackedWordType(
+    const ArrayType* array_type) const {
+  // An element may start at any bit of its first byte.
+  int64_t element_bit_count = array_type->element_type()->GetFlatBitCount();
+  return llvm::IntegerType::get(
+      context_, 8 * CeilOfRatio(element_bit_count + 7, int64_t{8}));
+}
+
+llvm::Value* LlvmTypeConverter::LoadBitPackedElement(
+    llvm::Value* array_ptr, const ArrayType* array_type, llvm::Value* index,
+    llvm::IRBuilder<>& builder) const {
+  Type* element_type = array_type->element_type();
+  llvm::IntegerType* word_type = GetBitPackedWordType(array_type);
+  llvm::Value* bit_offset = builder.CreateMul(
+      index, builder.getInt64(element_type->GetFlatBitCount()));
+  llvm::Value* word_ptr = builder.CreateGEP(
+      builder.getInt8Ty(), array_ptr, builder.CreateLShr(bit_offset, 3));
+  llvm::Value* word =
+      builder.CreateAlignedLoad(word_type, word_ptr, llvm::Align(1));
+  llvm::Value* shift =
+      builder.CreateZExtOrTrunc(builder.CreateAnd(bit_offset, 7), word_type);
+  llvm::Value* element = builder.CreateZExtOrTrunc(
+      builder.CreateLShr(word, shift), ConvertToLlvmType(element_type));
+  return ClearPaddingBits(element, element_type, builder);
+}
+
+void LlvmTypeConverter::StoreBitPackedElement(
+    llvm::Value* array_ptr, const ArrayType* array_type, llvm::Value* index,
+    llvm::Value* value, llvm::IRBuilder<>& builder) const {
+  Type* element_type = array_type->element_type();
+  int64_t element_bit_count = element_type->GetFlatBitCount();
+  llvm::IntegerType* word_type = GetBitPackedWordType(array_type);
+  llvm::Value* bit_offset =
+      builder.CreateMul(index, builder.getInt64(element_bit_count));
+  llvm::Value* word_ptr = builder.CreateGEP(
+      builder.getInt8Ty(), array_ptr, builder.CreateLShr(bit_offset, 3));
+  llvm::Value* word =
+      builder.CreateAlignedLoad(word_type, word_ptr, llvm::Align(1));
+  llvm::Value* shift =
+      builder.CreateZExtOrTrunc(builder.CreateAnd(bit_offset, 7), word_type);
+  llvm::Value* mask = builder.CreateShl(
+      llvm::ConstantInt::get(word_type,
+                             (uint64_t{1} << element_bit_count) - 1),
+      shift);
+  llvm::Value* element_bits = builder.CreateShl(
+      builder.CreateZExtOrTrunc(
+          ClearPaddingBits(value, element_type, builder), word_type),
+      shift);
+  llvm::Value* updated = builder.CreateOr(
+      builder.CreateAnd(word, builder.CreateNot(mask)), element_bits);
+  builder.CreateAlignedStore(updated, word_ptr, llvm::Align(1));
+}
 
 int64_t LlvmTypeConverter::GetLlvmBitCount(int64_t xls_bit_count) const {
   // LLVM does not accept 0-bit types, and we want to be able to JIT-compile
@@ -75,6 +151,10 @@ llvm::Type* LlvmTypeConverter::ConvertToLlvmType(const Type* xls_type) const {
     }
 
     llvm_type = llvm::StructType::get(context_, tuple_types);
+  } else if (IsBitPackedArray(xls_type)) {
+    llvm_type = llvm::ArrayType::get(
+        llvm::Type::getInt8Ty(context_),
+        GetBitPackedArrayByteSize(xls_type->AsArrayOrDie()));
   } else if (xls_type->IsArray()) {
     const ArrayType* array_type = xls_type->AsArrayOrDie();
     llvm::Type* element_type = ConvertToLlvmType(array_type->element_type());
@@ -106,6 +186,46 @@ int64_t LlvmTypeConverter::GetPackedTypeByteSize(const Type* type) const {
 
 absl::StatusOr<llvm::Constant*> LlvmTypeConverter::ToLlvmConstant(
     const Type* type, const Value& value) const {
+  if (layout_options_.packed_array_types.empty()) {
+    return ToLlvmConstant(ConvertToLlvmType(type), value);
+  }
+  // Bit-packed arrays are not apparent from the LLVM type so walk the XLS
+  // type.
+  if (IsBitPackedArray(type)) {
+    const ArrayType* array_type = type->AsArrayOrDie();
+    int64_t element_bit_count = array_type->element_type()->GetFlatBitCount();
+    std::vector<uint8_t> bytes(GetBitPackedArrayByteSize(array_type), 0);
+    for (int64_t i = 0; i < value.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(uint64_t element,
+                           value.element(i).bits().ToUint64());
+      WritePackedBits(bytes.data(), i * element_bit_count, element_bit_count,
+                      element);
+    }
+    return llvm::ConstantDataArray::get(context_, bytes);
+  }
+  if (type->IsTuple()) {
+    std::vector<llvm::Constant*> elements;
+    for (int64_t i = 0; i < value.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          llvm::Constant * element,
+          ToLlvmConstant(type->AsTupleOrDie()->element_type(i),
+                         value.element(i)));
+      elements.push_back(element);
+    }
+    return llvm::ConstantStruct::get(
+        llvm::cast<llvm::StructType>(ConvertToLlvmType(type)), elements);
+  }
+  if (type->IsArray()) {
+    std::vector<llvm::Constant*> elements;
+    for (const Value& element : value.elements()) {
+      XLS_ASSIGN_OR_RETURN(
+          llvm::Constant * llvm_element,
+          ToLlvmConstant(type->AsArrayOrDie()->element_type(), element));
+      elements.push_back(llvm_element);
+    }
+    return llvm::ConstantArray::get(
+        llvm::cast<llvm::ArrayType>(ConvertToLlvmType(type)), elements);
+  }
   return ToLlvmConstant(ConvertToLlvmType(type), value);
 }
 
@@ -275,6 +395,20 @@ void LlvmTypeConverter::ComputeElementLayouts(
         .padded_size = GetTypeByteSize(xls_type)});
     return;
   }
+  if (IsBitPackedArray(xls_type)) {
+    ArrayType* array_type = xls_type->AsArrayOrDie();
+    int64_t element_bit_count = array_type->element_type()->GetFlatBitCount();
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      int64_t bit_offset = i * element_bit_count;
+      int64_t byte_count =
+          CeilOfRatio(bit_offset % 8 + element_bit_count, int64_t{8});
+      layouts->push_back(ElementLayout{.offset = offset + bit_offset / 8,
+                                       .data_size = byte_count,
+                                       .padded_size = byte_count,
+                                       .bit_offset = bit_offset % 8});
+    }
+    return;
+  }
   if (xls_type->IsArray()) {
     ArrayType* array_type = xls_type->AsArrayOrDie();
     Type* element_type = array_type->element_type();
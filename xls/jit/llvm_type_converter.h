@@ -28,6 +28,7 @@
 #include "llvm/include/llvm/IR/Type.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/jit_layout_options.h"
 #include "xls/jit/type_layout.h"
 
 namespace xls {
@@ -38,8 +39,44 @@ namespace xls {
 // This class must live as long as its constructor argument module.
 class LlvmTypeConverter {
  public:
+  // The maximum element width of bit-packed arrays. Any element of a packed
+  // array together with its sub-byte offset fits in 64 bits.
+  static constexpr int64_t kMaxBitPackedElementBitCount = 56;
+
   LlvmTypeConverter(llvm::LLVMContext* context,
-                    const llvm::DataLayout& data_layout);
+                    const llvm::DataLayout& data_layout,
+                    JitLayoutOptions layout_options = JitLayoutOptions());
+
+  const JitLayoutOptions& layout_options() const { return layout_options_; }
+
+  // Returns whether `type` is an array type which may be bit-packed: a
+  // non-empty array of bits types of width 1 to kMaxBitPackedElementBitCount.
+  static bool CanBitPackArray(const Type* type);
+
+  // Returns whether values of `type` are stored bit-packed.
+  bool IsBitPackedArray(const Type* type) const {
+    return !layout_options_.packed_array_types.empty() &&
+           layout_options_.packed_array_types.contains(type);
+  }
+
+  // Returns the number of bytes of a bit-packed array of the given type.
+  static int64_t GetBitPackedArrayByteSize(const ArrayType* type);
+
+  // Emits code which reads the element at `index` (an i64 which must be in
+  // bounds) of the bit-packed array at `array_ptr`. The result has the native
+  // LLVM type of the element.
+  llvm::Value* LoadBitPackedElement(llvm::Value* array_ptr,
+                                    const ArrayType* array_type,
+                                    llvm::Value* index,
+                                    llvm::IRBuilder<>& builder) const;
+
+  // Emits code which overwrites the element at `index` (an i64 which must be
+  // in bounds) of the bit-packed array at `array_ptr` with `value` which has
+  // the native LLVM type of the element.
+  void StoreBitPackedElement(llvm::Value* array_ptr,
+                             const ArrayType* array_type, llvm::Value* index,
+                             llvm::Value* value,
+                             llvm::IRBuilder<>& builder) const;
 
   llvm::Type* ConvertToLlvmType(const Type* type) const;
   llvm::Type* ConvertToPointerToLlvmType(const Type* type) const {
@@ -160,8 +197,13 @@ class LlvmTypeConverter {
                              std::vector<ElementLayout>* layouts,
                              int64_t offset);
 
+  // Returns the integer type of the word loaded to access an element of the
+  // given bit-packed array.
+  llvm::IntegerType* GetBitPackedWordType(const ArrayType* array_type) const;
+
   llvm::LLVMContext& context_;
   llvm::DataLayout data_layout_;
+  JitLayoutOptions layout_options_;
 };
 
 }  // namespace xls
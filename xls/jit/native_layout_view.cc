@@ -0,0 +1,207 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/native_layout_view.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+Value LeavesToValue(const TypeLayout& layout, const uint8_t* buffer,
+                    Type* type, int64_t* leaf_index) {
+  if (type->IsBits()) {
+    int64_t bit_count = type->AsBitsOrDie()->bit_count();
+    const ElementLayout& element = layout.elements()[(*leaf_index)++];
+    if (element.bit_offset.has_value()) {
+      return Value(UBits(ReadPackedBits(buffer + element.offset,
+                                        *element.bit_offset, bit_count),
+                         bit_count));
+    }
+    return Value(Bits::FromBytes(
+        absl::MakeSpan(buffer + element.offset,
+                       CeilOfRatio(bit_count, int64_t{8})),
+        bit_count));
+  }
+  if (type->IsToken()) {
+    ++(*leaf_index);
+    return Value::Token();
+  }
+  std::vector<Value> elements;
+  if (type->IsTuple()) {
+    TupleType* tuple_type = type->AsTupleOrDie();
+    elements.reserve(tuple_type->size());
+    for (Type* element_type : tuple_type->element_types()) {
+      elements.push_back(
+          LeavesToValue(layout, buffer, element_type, leaf_index));
+    }
+    return Value::TupleOwned(std::move(elements));
+  }
+  ArrayType* array_type = type->AsArrayOrDie();
+  elements.reserve(array_type->size());
+  for (int64_t i = 0; i < array_type->size(); ++i) {
+    elements.push_back(LeavesToValue(layout, buffer,
+                                     array_type->element_type(), leaf_index));
+  }
+  return Value::ArrayOwned(std::move(elements));
+}
+
+void ValueToLeaves(const TypeLayout& layout, const Value& value,
+                   uint8_t* buffer, int64_t* leaf_index) {
+  if (value.IsBits() || value.IsToken()) {
+    const ElementLayout& element = layout.elements()[(*leaf_index)++];
+    uint8_t* element_buffer = buffer + element.offset;
+    if (element.bit_offset.has_value()) {
+      WritePackedBits(element_buffer, *element.bit_offset,
+                      value.bits().bit_count(),
+                      value.bits().ToUint64().value());
+      return;
+    }
+    int64_t written = 0;
+    if (value.IsBits()) {
+      value.bits().ToBytes(absl::MakeSpan(element_buffer, element.data_size));
+      written = element.data_size;
+    }
+    std::memset(element_buffer + written, 0, element.padded_size - written);
+    return;
+  }
+  for (const Value& element : value.elements()) {
+    ValueToLeaves(layout, element, buffer, leaf_index);
+  }
+}
+
+}  // namespace
+
+int64_t NativeLayoutView::size() const {
+  if (type_->IsTuple()) {
+    return type_->AsTupleOrDie()->size();
+  }
+  return type_->AsArrayOrDie()->size();
+}
+
+Type* NativeLayoutView::ElementType(int64_t index) const {
+  if (type_->IsTuple()) {
+    return type_->AsTupleOrDie()->element_type(index);
+  }
+  return type_->AsArrayOrDie()->element_type();
+}
+
+int64_t NativeLayoutView::ElementLeafIndex(int64_t index) const {
+  CHECK_GE(index, 0);
+  CHECK_LT(index, size()) << absl::StreamFormat(
+      "Element index %d out of bounds for type `%s`", index,
+      type_->ToString());
+  if (type_->IsArray()) {
+    return leaf_index_ + index * ElementType(0)->leaf_count();
+  }
+  int64_t leaf_index = leaf_index_;
+  for (int64_t i = 0; i < index; ++i) {
+    leaf_index += ElementType(i)->leaf_count();
+  }
+  return leaf_index;
+}
+
+NativeLayoutView NativeLayoutView::element(int64_t index) const {
+  return NativeLayoutView(layout_, buffer_, ElementType(index),
+                          ElementLeafIndex(index));
+}
+
+Bits NativeLayoutView::GetBits() const {
+  int64_t width = bit_count();
+  if (leaf_layout().bit_offset.has_value()) {
+    return UBits(GetUint64(), width);
+  }
+  return Bits::FromBytes(
+      absl::MakeSpan(buffer_ + leaf_layout().offset,
+                     CeilOfRatio(width, int64_t{8})),
+      width);
+}
+
+uint64_t NativeLayoutView::GetUint64() const {
+  CHECK_LE(bit_count(), 64);
+  const ElementLayout& leaf = leaf_layout();
+  const uint8_t* data = buffer_ + leaf.offset;
+  if (leaf.bit_offset.has_value()) {
+    return ReadPackedBits(data, *leaf.bit_offset, bit_count());
+  }
+  uint64_t result = 0;
+  for (int64_t i = 0; i < leaf.data_size; ++i) {
+    result |= uint64_t{data[i]} << (8 * i);
+  }
+  return result;
+}
+
+Value NativeLayoutView::ToValue() const {
+  int64_t leaf_index = leaf_index_;
+  return LeavesToValue(*layout_, buffer_, type_, &leaf_index);
+}
+
+MutableNativeLayoutView MutableNativeLayoutView::mutable_element(
+    int64_t index) const {
+  return MutableNativeLayoutView(layout_, mutable_buffer(), ElementType(index),
+                                 ElementLeafIndex(index));
+}
+
+void MutableNativeLayoutView::SetBits(const Bits& bits) const {
+  CHECK_EQ(bits.bit_count(), bit_count());
+  const ElementLayout& leaf = leaf_layout();
+  uint8_t* data = mutable_buffer() + leaf.offset;
+  if (leaf.bit_offset.has_value()) {
+    WritePackedBits(data, *leaf.bit_offset, bits.bit_count(),
+                    bits.ToUint64().value());
+    return;
+  }
+  bits.ToBytes(absl::MakeSpan(data, leaf.data_size));
+  std::memset(data + leaf.data_size, 0, leaf.padded_size - leaf.data_size);
+}
+
+void MutableNativeLayoutView::SetUint64(uint64_t value) const {
+  int64_t width = bit_count();
+  CHECK_LE(width, 64);
+  if (width < 64) {
+    value &= (uint64_t{1} << width) - 1;
+  }
+  const ElementLayout& leaf = leaf_layout();
+  uint8_t* data = mutable_buffer() + leaf.offset;
+  if (leaf.bit_offset.has_value()) {
+    WritePackedBits(data, *leaf.bit_offset, width, value);
+    return;
+  }
+  for (int64_t i = 0; i < leaf.data_size; ++i) {
+    data[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+  std::memset(data + leaf.data_size, 0, leaf.padded_size - leaf.data_size);
+}
+
+void MutableNativeLayoutView::SetValue(const Value& value) const {
+  DCHECK(ValueConformsToType(value, type_)) << absl::StreamFormat(
+      "Value `%s` is not of type `%s`", value.ToString(), type_->ToString());
+  int64_t leaf_index = leaf_index_;
+  ValueToLeaves(*layout_, value, mutable_buffer(), &leaf_index);
+}
+
+}  // namespace xls
@@ -0,0 +1,113 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_NATIVE_LAYOUT_VIEW_H_
+#define XLS_JIT_NATIVE_LAYOUT_VIEW_H_
+
+#include <cstdint>
+
+#include "xls/ir/bits.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// A read-only view of a value of an XLS type stored in a buffer in the native
+// layout used by the JIT as described by a TypeLayout. Unlike
+// TypeLayout::NativeLayoutToValue, reading through a view does not construct
+// any Value objects so individual leaves (or sub-elements) of large aggregates
+// may be inspected cheaply.
+//
+// Views are lightweight (a few pointers) and are passed by value. Neither the
+// layout nor the buffer are owned and both must outlive the view.
+class NativeLayoutView {
+ public:
+  NativeLayoutView(const TypeLayout* layout, const uint8_t* buffer)
+      : NativeLayoutView(layout, buffer, layout->type(), /*leaf_index=*/0) {}
+
+  // The type of the value viewed. For views of sub-elements this is the
+  // element type, not the type of the entire layout.
+  Type* type() const { return type_; }
+
+  // The buffer holding the entire value the layout describes.
+  const uint8_t* buffer() const { return buffer_; }
+
+  // Returns a view of the `index`-th element of the tuple or array viewed.
+  NativeLayoutView element(int64_t index) const;
+
+  // Returns the number of elements of the tuple or array viewed.
+  int64_t size() const;
+
+  // Accessors for views of bits types.
+  int64_t bit_count() const { return type_->AsBitsOrDie()->bit_count(); }
+  Bits GetBits() const;
+  // Requires bit_count() <= 64.
+  uint64_t GetUint64() const;
+
+  // Materializes the viewed (sub-)value as a Value.
+  Value ToValue() const;
+
+ protected:
+  NativeLayoutView(const TypeLayout* layout, const uint8_t* buffer, Type* type,
+                   int64_t leaf_index)
+      : layout_(layout),
+        buffer_(buffer),
+        type_(type),
+        leaf_index_(leaf_index) {}
+
+  // Returns the leaf index of the `index`-th element of the viewed aggregate.
+  int64_t ElementLeafIndex(int64_t index) const;
+  Type* ElementType(int64_t index) const;
+  const ElementLayout& leaf_layout() const {
+    return layout_->elements()[leaf_index_];
+  }
+
+  const TypeLayout* layout_;
+  const uint8_t* buffer_;
+  Type* type_;
+  // Index of the first leaf of the viewed value in `layout_->elements()`.
+  int64_t leaf_index_;
+};
+
+// A view of a value stored in the native layout used by the JIT which allows
+// individual leaves (or sub-elements) to be written in place. All writes keep
+// the padding bytes of the written leaves zeroed as required by the JIT.
+class MutableNativeLayoutView : public NativeLayoutView {
+ public:
+  MutableNativeLayoutView(const TypeLayout* layout, uint8_t* buffer)
+      : NativeLayoutView(layout, buffer) {}
+
+  uint8_t* mutable_buffer() const { return const_cast<uint8_t*>(buffer_); }
+
+  MutableNativeLayoutView mutable_element(int64_t index) const;
+
+  // Mutators for views of bits types. `bits` must have width bit_count().
+  void SetBits(const Bits& bits) const;
+  // Requires bit_count() <= 64. Bits of `value` above bit_count() are
+  // discarded.
+  void SetUint64(uint64_t value) const;
+
+  // Writes `value`, which must be of type type(), to the viewed location.
+  void SetValue(const Value& value) const;
+
+ private:
+  MutableNativeLayoutView(const TypeLayout* layout, uint8_t* buffer,
+                          Type* type, int64_t leaf_index)
+      : NativeLayoutView(layout, buffer, type, leaf_index) {}
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_NATIVE_LAYOUT_VIEW_H_
@@ -0,0 +1,150 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/native_layout_view.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/random/random.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+TypeLayout CreateTypeLayout(Type* type) {
+  std::unique_ptr<OrcJit> orc_jit = OrcJit::Create().value();
+  LlvmTypeConverter type_converter(orc_jit->GetContext(),
+                                   orc_jit->CreateDataLayout().value());
+  return type_converter.CreateTypeLayout(type);
+}
+
+class NativeLayoutViewTest : public ::testing::Test {
+ protected:
+  Type* ParseType(std::string_view type_str) {
+    return Parser::ParseType(type_str, &package_).value();
+  }
+
+  Package package_{"test"};
+};
+
+TEST_F(NativeLayoutViewTest, ReadBits) {
+  Type* type = ParseType("bits[42]");
+  TypeLayout layout = CreateTypeLayout(type);
+  std::vector<uint8_t> buffer(layout.size());
+  layout.ValueToNativeLayout(Value(UBits(0x123456789ab, 42)), buffer.data());
+
+  NativeLayoutView view(&layout, buffer.data());
+  EXPECT_EQ(view.type(), type);
+  EXPECT_EQ(view.bit_count(), 42);
+  EXPECT_EQ(view.GetUint64(), 0x123456789ab);
+  EXPECT_EQ(view.GetBits(), UBits(0x123456789ab, 42));
+  EXPECT_EQ(view.ToValue(), Value(UBits(0x123456789ab, 42)));
+}
+
+TEST_F(NativeLayoutViewTest, ReadNestedElements) {
+  Type* type = ParseType("(bits[2], (bits[15], bits[4])[3], bits[100])");
+  TypeLayout layout = CreateTypeLayout(type);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value value,
+      Parser::ParseTypedValue(
+          "(bits[2]:1, [(bits[15]:10, bits[4]:11), (bits[15]:20, bits[4]:12), "
+          "(bits[15]:30, bits[4]:13)], bits[100]:0xabcdef0123456789abcd)"));
+  std::vector<uint8_t> buffer(layout.size());
+  layout.ValueToNativeLayout(value, buffer.data());
+
+  NativeLayoutView view(&layout, buffer.data());
+  EXPECT_EQ(view.size(), 3);
+  EXPECT_EQ(view.element(0).GetUint64(), 1);
+  NativeLayoutView array = view.element(1);
+  EXPECT_EQ(array.size(), 3);
+  for (uint64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(array.element(i).element(0).GetUint64(), 10 * (i + 1));
+    EXPECT_EQ(array.element(i).element(1).GetUint64(), 11 + i);
+  }
+  EXPECT_EQ(array.element(2).ToValue(), value.element(1).element(2));
+  EXPECT_EQ(view.element(2).GetBits(), value.element(2).bits());
+  EXPECT_EQ(view.ToValue(), value);
+}
+
+TEST_F(NativeLayoutViewTest, WriteMatchesValueToNativeLayout) {
+  Type* type = ParseType("(bits[7], bits[33][2], (), token, bits[64])");
+  TypeLayout layout = CreateTypeLayout(type);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value value, Parser::ParseTypedValue(
+                       "(bits[7]:0x55, [bits[33]:0x1ffffffff, bits[33]:0x2], "
+                       "(), token, bits[64]:0xffffffffffffffff)"));
+  std::vector<uint8_t> expected(layout.size(), 0);
+  layout.ValueToNativeLayout(value, expected.data());
+
+  // Start from garbage to verify padding is cleared.
+  std::vector<uint8_t> buffer(layout.size(), 0xff);
+  MutableNativeLayoutView view(&layout, buffer.data());
+  view.SetValue(value);
+  EXPECT_EQ(NativeLayoutView(&layout, buffer.data()).ToValue(), value);
+
+  std::vector<uint8_t> leaf_buffer(layout.size(), 0);
+  MutableNativeLayoutView leaf_view(&layout, leaf_buffer.data());
+  leaf_view.mutable_element(0).SetUint64(0x55);
+  leaf_view.mutable_element(1).mutable_element(0).SetBits(
+      UBits(0x1ffffffff, 33));
+  leaf_view.mutable_element(1).mutable_element(1).SetUint64(0x2);
+  leaf_view.mutable_element(3).SetValue(Value::Token());
+  leaf_view.mutable_element(4).SetUint64(0xffffffffffffffff);
+  EXPECT_EQ(leaf_view.ToValue(), value);
+  EXPECT_EQ(leaf_buffer, expected);
+}
+
+TEST_F(NativeLayoutViewTest, SetUint64TruncatesToWidth) {
+  Type* type = ParseType("bits[12]");
+  TypeLayout layout = CreateTypeLayout(type);
+  std::vector<uint8_t> buffer(layout.size(), 0xff);
+  MutableNativeLayoutView view(&layout, buffer.data());
+  view.SetUint64(0xfabc);
+  EXPECT_EQ(view.GetUint64(), 0xabc);
+  EXPECT_EQ(view.ToValue(), Value(UBits(0xabc, 12)));
+}
+
+TEST_F(NativeLayoutViewTest, RandomRoundTrip) {
+  absl::BitGen bitgen;
+  for (std::string_view type_str :
+       {"bits[1]", "bits[65][4]", "(bits[3], (bits[128], bits[9][2]))",
+        "((), bits[0], bits[17][3][2])"}) {
+    Type* type = ParseType(type_str);
+    TypeLayout layout = CreateTypeLayout(type);
+    for (int64_t i = 0; i < 10; ++i) {
+      Value value = RandomValue(type, bitgen);
+      std::vector<uint8_t> buffer(layout.size(), 0xaa);
+      MutableNativeLayoutView(&layout, buffer.data()).SetValue(value);
+      EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+      EXPECT_EQ(NativeLayoutView(&layout, buffer.data()).ToValue(), value);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,115 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/node_profiler.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+
+NodeProfiler::Counters* NodeProfiler::GetOrCreateCounters(Node* node) {
+  absl::MutexLock lock(&mutex_);
+  std::unique_ptr<Entry>& entry = entries_[node];
+  if (entry == nullptr) {
+    entry = std::make_unique<Entry>();
+    entry->description = NodeProfile{
+        .function_base = node->function_base()->name(),
+        .node_name = node->GetName(),
+        .op = node->op(),
+        .loc = node->loc().Empty() ? "" : node->loc().ToString(),
+        .node_id = node->id(),
+        .evaluations = 0,
+        .cycles = 0};
+  }
+  return &entry->counters;
+}
+
+void NodeProfiler::Reset() {
+  absl::MutexLock lock(&mutex_);
+  for (auto& [_, entry] : entries_) {
+    entry->counters.cycles.store(0, std::memory_order_relaxed);
+    entry->counters.evaluations.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::vector<NodeProfiler::NodeProfile> NodeProfiler::GetProfile() const {
+  std::vector<NodeProfile> result;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (const auto& [_, entry] : entries_) {
+      int64_t evaluations =
+          entry->counters.evaluations.load(std::memory_order_relaxed);
+      if (evaluations == 0) {
+        continue;
+      }
+      NodeProfile& profile = result.emplace_back(entry->description);
+      profile.evaluations = evaluations;
+      profile.cycles = entry->counters.cycles.load(std::memory_order_relaxed);
+    }
+  }
+  absl::c_sort(result, [](const NodeProfile& a, const NodeProfile& b) {
+    if (a.cycles != b.cycles) {
+      return a.cycles > b.cycles;
+    }
+    if (a.function_base != b.function_base) {
+      return a.function_base < b.function_base;
+    }
+    return a.node_id < b.node_id;
+  });
+  return result;
+}
+
+std::string NodeProfiler::ToString(int64_t max_nodes) const {
+  std::vector<NodeProfile> profile = GetProfile();
+  int64_t total_cycles = 0;
+  int64_t total_evaluations = 0;
+  for (const NodeProfile& p : profile) {
+    total_cycles += p.cycles;
+    total_evaluations += p.evaluations;
+  }
+  std::string result = absl::StrFormat(
+      "Node profile: %d cycles attributed over %d evaluations of %d nodes\n",
+      total_cycles, total_evaluations, profile.size());
+  absl::StrAppendFormat(&result, "%14s %7s %12s %10s  %s\n", "cycles", "%",
+                        "evaluations", "avg", "node");
+  for (int64_t i = 0; i < profile.size() && i < max_nodes; ++i) {
+    const NodeProfile& p = profile[i];
+    double percent = total_cycles == 0 ? 0.0
+                                       : 100.0 * static_cast<double>(p.cycles) /
+                                             static_cast<double>(total_cycles);
+    double average =
+        static_cast<double>(p.cycles) / static_cast<double>(p.evaluations);
+    absl::StrAppendFormat(&result, "%14d %6.2f%% %12d %10.1f  %s::%s (%s)",
+                          p.cycles, percent, p.evaluations, average,
+                          p.function_base, p.node_name, OpToString(p.op));
+    if (!p.loc.empty()) {
+      absl::StrAppend(&result, " ", p.loc);
+    }
+    absl::StrAppend(&result, "\n");
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,117 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_NODE_PROFILER_H_
+#define XLS_JIT_NODE_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+
+// Storage for a per-node execution time profile collected natively by jitted
+// code. When a NodeProfiler is attached to an LlvmCompiler, each partition
+// function of the compiled code reads the processor cycle counter on entry and
+// after calling each node function, and adds the elapsed cycles and an
+// evaluation count to counters owned by this object. No callbacks are made and
+// no locks are taken while the jitted code runs. Because the counter is read
+// afresh on entry to every partition, time spent outside of jitted code (e.g.,
+// between ticks or invocations) is never attributed to a node.
+//
+// The time of a node which invokes another function includes the time of the
+// nodes in the invoked function, which are also profiled individually. The
+// unit of the counter (`llvm.readcyclecounter`) is target dependent; on x86 it
+// is the time stamp counter and on targets without a cycle counter it reads
+// as zero, in which case only evaluation counts are collected.
+//
+// The counters are referenced by address from the jitted code so this object
+// must outlive any code compiled with it. Counters are updated atomically so
+// code running concurrently on several threads may share a profiler.
+class NodeProfiler {
+ public:
+  // The counters of a single node. The jitted code adds to these directly.
+  struct Counters {
+    std::atomic<int64_t> cycles = 0;
+    std::atomic<int64_t> evaluations = 0;
+  };
+
+  struct NodeProfile {
+    // The name of the function base containing the node.
+    std::string function_base;
+    std::string node_name;
+    Op op;
+    // The node's source location, if any, as a string.
+    std::string loc;
+    int64_t node_id;
+    // Number of times the node was evaluated.
+    int64_t evaluations;
+    // Total cycles attributed to the node.
+    int64_t cycles;
+  };
+
+  NodeProfiler() = default;
+  NodeProfiler(const NodeProfiler&) = delete;
+  NodeProfiler& operator=(const NodeProfiler&) = delete;
+
+  // Returns the counters for `node`, creating them if necessary. The pointer
+  // is stable for the lifetime of this object. The description of the node
+  // used in the report is captured here so the IR need not outlive the
+  // compiled code. Thread-safe so procs may be compiled concurrently.
+  Counters* GetOrCreateCounters(Node* node);
+
+  // Address of the flag which jitted code checks on entry to each partition.
+  // Non-zero while paused.
+  const uint8_t* paused_flag() const { return &paused_; }
+
+  // While paused jitted code does not update the counters. Must not be called
+  // while jitted code is running.
+  void SetPaused(bool paused) { paused_ = paused ? 1 : 0; }
+
+  // Zeroes all the counters. Must not be called while jitted code is running.
+  void Reset();
+
+  // Returns the profile of every node which was evaluated ordered by
+  // decreasing cycle count.
+  std::vector<NodeProfile> GetProfile() const;
+
+  // Returns a human readable report of the `max_nodes` nodes with the most
+  // cycles attributed to them.
+  std::string ToString(int64_t max_nodes = 25) const;
+
+ private:
+  struct Entry {
+    Counters counters;
+    NodeProfile description;
+  };
+
+  mutable absl::Mutex mutex_;
+  // The entries never move (even when the map rehashes) so the counter
+  // addresses baked into jitted code remain valid.
+  absl::flat_hash_map<Node*, std::unique_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+  uint8_t paused_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_NODE_PROFILER_H_
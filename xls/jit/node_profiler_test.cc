@@ -0,0 +1,178 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/node_profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+
+class NodeProfilerTest : public IrTestBase {
+ protected:
+  absl::StatusOr<Function*> MakeFunction(Package* p) {
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    BValue product = fb.UMul(x, y, SourceInfo(), "product");
+    fb.Add(product, x, SourceInfo(), "sum");
+    return fb.Build();
+  }
+
+  // Returns the arguments of the functions built by MakeFunction.
+  static std::vector<Value> Args(int64_t x) {
+    return {Value(UBits(x, 32)), Value(UBits(3, 32))};
+  }
+
+  absl::StatusOr<std::unique_ptr<FunctionJit>> CreateJit(
+      Function* f, NodeProfiler* profiler) {
+    return FunctionJit::Create(f, /*opt_level=*/3,
+                               /*include_observer_callbacks=*/false,
+                               /*jit_observer=*/nullptr, JitBatchOptions(),
+                               profiler);
+  }
+
+  // Returns the profile entry of the node with the given name, if any.
+  const NodeProfiler::NodeProfile* FindNode(
+      const std::vector<NodeProfiler::NodeProfile>& profile,
+      std::string_view function_base, std::string_view node_name) {
+    auto it = std::find_if(profile.begin(), profile.end(),
+                           [&](const NodeProfiler::NodeProfile& p) {
+                             return p.function_base == function_base &&
+                                    p.node_name == node_name;
+                           });
+    return it == profile.end() ? nullptr : &*it;
+  }
+
+  // Checks every non-parameter node of `f` was profiled `evaluations` times
+  // and the profile is sorted by decreasing cycles.
+  void ExpectAllNodesEvaluated(const NodeProfiler& profiler, Function* f,
+                               int64_t evaluations) {
+    std::vector<NodeProfiler::NodeProfile> profile = profiler.GetProfile();
+    for (Node* node : f->nodes()) {
+      if (node->Is<Param>()) {
+        continue;
+      }
+      const NodeProfiler::NodeProfile* p =
+          FindNode(profile, f->name(), node->GetName());
+      ASSERT_NE(p, nullptr) << node->ToString();
+      EXPECT_EQ(p->op, node->op());
+      EXPECT_EQ(p->evaluations, evaluations) << node->ToString();
+      EXPECT_GE(p->cycles, 0);
+    }
+    for (int64_t i = 1; i < profile.size(); ++i) {
+      EXPECT_GE(profile[i - 1].cycles, profile[i].cycles);
+    }
+  }
+};
+
+TEST_F(NodeProfilerTest, ProfileJit) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, MakeFunction(p.get()));
+  NodeProfiler profiler;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           CreateJit(f, &profiler));
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                             jit->Run(Args(i)));
+    EXPECT_EQ(result.value, Value(UBits(4 * i, 32)));
+  }
+  ExpectAllNodesEvaluated(profiler, f, 10);
+  EXPECT_THAT(profiler.ToString(), HasSubstr("sum (add)"));
+
+  profiler.Reset();
+  EXPECT_TRUE(profiler.GetProfile().empty());
+  XLS_ASSERT_OK(jit->Run(Args(1)).status());
+  ExpectAllNodesEvaluated(profiler, f, 1);
+}
+
+TEST_F(NodeProfilerTest, PausedProfilerIgnoresNodes) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, MakeFunction(p.get()));
+  NodeProfiler profiler;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           CreateJit(f, &profiler));
+  profiler.SetPaused(true);
+  XLS_ASSERT_OK(jit->Run(Args(1)).status());
+  EXPECT_TRUE(profiler.GetProfile().empty());
+
+  profiler.SetPaused(false);
+  XLS_ASSERT_OK(jit->Run(Args(1)).status());
+  ExpectAllNodesEvaluated(profiler, f, 1);
+}
+
+TEST_F(NodeProfilerTest, InvokedFunctionsAreProfiled) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * callee, MakeFunction(p.get()));
+  FunctionBuilder fb("caller", p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue call = fb.Invoke({x, y}, callee, SourceInfo(), "call");
+  fb.Invoke({call, y}, callee, SourceInfo(), "call_again");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * caller, fb.Build());
+
+  NodeProfiler profiler;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           CreateJit(caller, &profiler));
+  for (int64_t i = 0; i < 5; ++i) {
+    XLS_ASSERT_OK(jit->Run(Args(i)).status());
+  }
+  ExpectAllNodesEvaluated(profiler, caller, 5);
+  // The callee is invoked twice per evaluation of the caller.
+  ExpectAllNodesEvaluated(profiler, callee, 10);
+}
+
+TEST_F(NodeProfilerTest, ProfileOutlivesIr) {
+  NodeProfiler profiler;
+  {
+    auto p = CreatePackage();
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, MakeFunction(p.get()));
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             CreateJit(f, &profiler));
+    XLS_ASSERT_OK(jit->Run(Args(1)).status());
+  }
+  std::vector<NodeProfiler::NodeProfile> profile = profiler.GetProfile();
+  const NodeProfiler::NodeProfile* product =
+      FindNode(profile, TestName(), "product");
+  ASSERT_NE(product, nullptr);
+  EXPECT_EQ(product->op, Op::kUMul);
+  EXPECT_EQ(product->evaluations, 1);
+  EXPECT_THAT(profiler.ToString(), HasSubstr("product (umul)"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -43,6 +43,11 @@ JitObserverRequests CompoundJitObserver::GetNotificationOptions() const {
                          [](auto* o) {
                            return o->GetNotificationOptions().assembly_code_str;
                          }),
+      .compilation_stats =
+          absl::c_any_of(observers_,
+                         [](auto* o) {
+                           return o->GetNotificationOptions().compilation_stats;
+                         }),
   };
 }
 void CompoundJitObserver::UnoptimizedModule(const llvm::Module* module) {
@@ -68,6 +73,15 @@ void CompoundJitObserver::AssemblyCodeString(const llvm::Module* module,
   }
 }
 
+void CompoundJitObserver::CompilationStats(const llvm::Module* module,
+                                           const JitCompilationStats& stats) {
+  for (auto* o : observers_) {
+    if (o->GetNotificationOptions().compilation_stats) {
+      o->CompilationStats(module, stats);
+    }
+  }
+}
+
 void CompoundJitObserver::AddObserver(JitObserver* o) {
   observers_.push_back(o);
 }
@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/interpreter/observer.h"
 #include "xls/ir/node.h"
@@ -45,6 +46,18 @@ struct JitObserverRequests {
   bool optimized_module = false;
   // Do we want to get called with optimized asm code.
   bool assembly_code_str = false;
+  // Do we want to get called with the compile time of each module.
+  bool compilation_stats = false;
+};
+
+// How a LLVM module was compiled and how long it took.
+struct JitCompilationStats {
+  int64_t opt_level;
+  bool vectorize;
+  // Time spent in the LLVM optimization pipeline.
+  absl::Duration optimization_time;
+  // Time spent generating machine code.
+  absl::Duration codegen_time;
 };
 
 // Basic observer for JIT compilation events
@@ -60,6 +73,10 @@ class JitObserver {
   // Called when a LLVM module has been compiled with the module code.
   virtual void AssemblyCodeString(const llvm::Module* module,
                                   std::string_view asm_code) {}
+  // Called when a LLVM module has been compiled to machine code. Not called
+  // for modules whose object code is loaded from a cache.
+  virtual void CompilationStats(const llvm::Module* module,
+                                const JitCompilationStats& stats) {}
 };
 
 // A compound observer that lets one trigger multiple observers at once.
@@ -72,6 +89,8 @@ class CompoundJitObserver final : public JitObserver {
   void OptimizedModule(const llvm::Module* module) final;
   void AssemblyCodeString(const llvm::Module* module,
                           std::string_view asm_code) final;
+  void CompilationStats(const llvm::Module* module,
+                        const JitCompilationStats& stats) final;
 
   void AddObserver(JitObserver* o);
 
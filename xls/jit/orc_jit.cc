@@ -28,8 +28,12 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/AbsoluteSymbols.h"  // IWYU pragma: keep
 #include "llvm/include/llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
@@ -52,12 +56,14 @@
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Transforms/Instrumentation/MemorySanitizer.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/jit/jit_clang_builtins.h"
 #include "xls/jit/jit_emulated_tls.h"  // NOLINT: Used with MSAN
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
@@ -92,10 +98,15 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
     jit_observer_->UnoptimizedModule(bare_module);
   }
 
+  absl::Time optimization_start = absl::Now();
   auto error = PerformStandardOptimization(bare_module);
   if (error) {
+    ForgetPendingCacheKey(bare_module->getModuleIdentifier());
     return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(error));
   }
+  optimization_time_ = absl::Now() - optimization_start;
+  VLOG(2) << "Optimized module " << bare_module->getName().str() << " at O"
+          << opt_level() << " in " << optimization_time_;
 
   VLOG(2) << "Optimized module IR:";
   XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
@@ -132,6 +143,42 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   return module;
 }
 
+class OrcJit::TimedCompiler : public llvm::orc::SimpleCompiler {
+ public:
+  TimedCompiler(OrcJit* jit, llvm::TargetMachine& target_machine,
+                llvm::ObjectCache* object_cache)
+      : llvm::orc::SimpleCompiler(target_machine, object_cache), jit_(jit) {}
+
+  llvm::Expected<CompileResult> operator()(llvm::Module& module) override {
+    absl::Time start = absl::Now();
+    llvm::Expected<CompileResult> result =
+        llvm::orc::SimpleCompiler::operator()(module);
+    if (result) {
+      jit_->NotifyCompiled(module, absl::Now() - start);
+    } else {
+      jit_->ForgetPendingCacheKey(module.getModuleIdentifier());
+    }
+    return result;
+  }
+
+ private:
+  OrcJit* jit_;
+};
+
+void OrcJit::NotifyCompiled(const llvm::Module& module,
+                            absl::Duration codegen_time) {
+  VLOG(2) << "Generated code for module " << module.getName().str() << " in "
+          << codegen_time;
+  if (jit_observer_ != nullptr &&
+      jit_observer_->GetNotificationOptions().compilation_stats) {
+    jit_observer_->CompilationStats(
+        &module, JitCompilationStats{.opt_level = opt_level(),
+                                     .vectorize = vectorize(),
+                                     .optimization_time = optimization_time_,
+                                     .codegen_time = codegen_time});
+  }
+}
+
 absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
     int64_t opt_level, bool include_observer_callbacks, JitObserver* observer) {
   LlvmCompiler::InitializeLlvm();
@@ -143,6 +190,7 @@ absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
   std::unique_ptr<OrcJit> jit = absl::WrapUnique(
       new OrcJit(opt_level, kHasMsan, include_observer_callbacks));
   jit->SetJitObserver(observer);
+  jit->SetObjectCache(JitObjectCache::GetDefault());
   XLS_RETURN_IF_ERROR(jit->Init());
   return std::move(jit);
 }
@@ -221,7 +269,8 @@ absl::Status OrcJit::InitInternal() {
   // Add some selected compiler-rt symbols.
   XLS_RETURN_IF_ERROR(AddCompilerRtSymbols(dylib_, data_layout_));
 
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  auto compiler = std::make_unique<TimedCompiler>(this, *target_machine_,
+                                                  &object_cache_forwarder_);
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
       execution_session_, object_layer_, std::move(compiler));
 
@@ -237,11 +286,81 @@ absl::Status OrcJit::InitInternal() {
   return absl::OkStatus();
 }
 
+void OrcJit::ObjectCacheForwarder::notifyObjectCompiled(
+    const llvm::Module* module, llvm::MemoryBufferRef object) {
+  jit_->StoreCompiledObject(*module, object);
+}
+
+void OrcJit::StoreCompiledObject(const llvm::Module& module,
+                                 llvm::MemoryBufferRef object) {
+  std::string key;
+  {
+    absl::MutexLock lock(&pending_cache_keys_mutex_);
+    auto it = pending_cache_keys_.find(module.getModuleIdentifier());
+    if (it == pending_cache_keys_.end()) {
+      return;
+    }
+    key = std::move(it->second);
+    pending_cache_keys_.erase(it);
+  }
+  if (object_cache_ != nullptr) {
+    object_cache_->Store(key, object);
+  }
+}
+
+void OrcJit::ForgetPendingCacheKey(const std::string& module_identifier) {
+  absl::MutexLock lock(&pending_cache_keys_mutex_);
+  pending_cache_keys_.erase(module_identifier);
+}
+
+bool OrcJit::CanUseObjectCache() const {
+  // Instrumented code bakes host addresses into the object, so it can't be
+  // reused by another process.
+  if (object_cache_ == nullptr || node_profiler() != nullptr ||
+      node_coverage() != nullptr) {
+    return false;
+  }
+  if (jit_observer_ == nullptr) {
+    return true;
+  }
+  JitObserverRequests requests = jit_observer_->GetNotificationOptions();
+  return !requests.unoptimized_module && !requests.optimized_module &&
+         !requests.assembly_code_str;
+}
+
 absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
+  std::optional<std::string> pending_identifier;
+  if (CanUseObjectCache()) {
+    std::string key =
+        JitObjectCache::ComputeKey(*module, *target_machine_, opt_level(),
+                                   vectorize(), include_msan());
+    if (std::unique_ptr<llvm::MemoryBuffer> object =
+            object_cache_->Lookup(key)) {
+      llvm::Error error = object_layer_.add(dylib_, std::move(object));
+      if (error) {
+        return absl::UnknownError(
+            absl::StrFormat("Error adding cached object: %s",
+                            llvm::toString(std::move(error))));
+      }
+      return absl::OkStatus();
+    }
+    // Modules are generally all created with the same identifier so make it
+    // unique to tell apart the modules compiled by this JIT.
+    {
+      absl::MutexLock lock(&pending_cache_keys_mutex_);
+      pending_identifier = absl::StrCat(module->getModuleIdentifier(), ".",
+                                        cached_module_count_++);
+      pending_cache_keys_[*pending_identifier] = std::move(key);
+    }
+    module->setModuleIdentifier(*pending_identifier);
+  }
   llvm::Error error = transform_layer_->add(
       dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
   if (error) {
+    if (pending_identifier.has_value()) {
+      ForgetPendingCacheKey(*pending_identifier);
+    }
     return absl::UnknownError(absl::StrFormat(
         "Error compiling converted IR: %s", llvm::toString(std::move(error))));
   }
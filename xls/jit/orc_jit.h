@@ -17,10 +17,16 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
@@ -28,9 +34,12 @@
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
 #include "llvm/include/llvm/Support/Error.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
@@ -59,7 +68,17 @@ class OrcJit : public LlvmCompiler {
 
   JitObserver* jit_observer() const { return jit_observer_; }
 
-  // Compiles the given LLVM module into the JIT's execution session.
+  // Sets the cache used to store and retrieve compiled objects. By default the
+  // cache given by JitObjectCache::GetDefault() is used. Passing nullptr
+  // disables caching. The cache must outlive the JIT.
+  void SetObjectCache(JitObjectCache* cache) { object_cache_ = cache; }
+
+  JitObjectCache* object_cache() const { return object_cache_; }
+
+  // Compiles the given LLVM module into the JIT's execution session. If an
+  // object cache is in use and it contains an object for this module (see
+  // JitObjectCache) the cached object is linked in directly and optimization
+  // and code generation are skipped.
   absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module) override;
 
   // Returns the address of the given JIT'ed function.
@@ -84,6 +103,42 @@ class OrcJit : public LlvmCompiler {
       llvm::orc::ThreadSafeModule module,
       const llvm::orc::MaterializationResponsibility& responsibility);
 
+  // Reports the compilation of `module`, whose code generation took
+  // `codegen_time`, to the observer.
+  void NotifyCompiled(const llvm::Module& module, absl::Duration codegen_time);
+
+  // Compiler which times code generation.
+  class TimedCompiler;
+
+  // Returns whether the object cache may be used. The cache is bypassed when
+  // the observer requests the LLVM module or assembly as those are not
+  // produced for cached objects, and for profiled code which embeds the
+  // addresses of this process's counters.
+  bool CanUseObjectCache() const;
+
+  // Stores the object compiled for `module` in `object_cache_` if this JIT
+  // registered the module in `pending_cache_keys_`.
+  void StoreCompiledObject(const llvm::Module& module,
+                           llvm::MemoryBufferRef object);
+
+  // Forgets the pending cache key of the module with the given identifier.
+  void ForgetPendingCacheKey(const std::string& module_identifier);
+
+  // Forwards compiled objects to StoreCompiledObject.
+  class ObjectCacheForwarder : public llvm::ObjectCache {
+   public:
+    explicit ObjectCacheForwarder(OrcJit* jit) : jit_(jit) {}
+    void notifyObjectCompiled(const llvm::Module* module,
+                              llvm::MemoryBufferRef object) override;
+    std::unique_ptr<llvm::MemoryBuffer> getObject(
+        const llvm::Module* module) override {
+      return nullptr;
+    }
+
+   private:
+    OrcJit* jit_;
+  };
+
   llvm::orc::ThreadSafeContext context_;
   llvm::orc::ExecutionSession execution_session_;
   llvm::orc::RTDyldObjectLinkingLayer object_layer_;
@@ -93,6 +148,20 @@ class OrcJit : public LlvmCompiler {
   std::unique_ptr<llvm::orc::IRTransformLayer> transform_layer_;
 
   JitObserver* jit_observer_ = nullptr;
+  JitObjectCache* object_cache_ = nullptr;
+  // Cache keys of the modules which missed in `object_cache_` and are waiting
+  // to be compiled, indexed by module identifier. CompileModule makes the
+  // identifiers unique. Entries of modules which are never compiled (e.g.,
+  // whose materialization is discarded) die with the JIT.
+  absl::Mutex pending_cache_keys_mutex_;
+  absl::flat_hash_map<std::string, std::string> pending_cache_keys_
+      ABSL_GUARDED_BY(pending_cache_keys_mutex_);
+  // Number of modules registered in `pending_cache_keys_`, used to make their
+  // identifiers unique.
+  int64_t cached_module_count_ ABSL_GUARDED_BY(pending_cache_keys_mutex_) = 0;
+  // Time taken by the optimizer on the (single) module compiled by this JIT.
+  absl::Duration optimization_time_;
+  ObjectCacheForwarder object_cache_forwarder_{this};
 };
 
 }  // namespace xls
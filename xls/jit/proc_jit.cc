@@ -23,7 +23,9 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
@@ -50,6 +52,7 @@
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_node_coverage.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
@@ -147,6 +150,9 @@ class ProcJitContinuation : public ProcContinuation {
 
   RuntimeObserverShim observer_shim_;
 
+  // IDs of the next_value nodes which leave their state element unchanged.
+  absl::flat_hash_set<int64_t> unchanged_next_values_;
+
   // if the code has observer callbacks compiled in.
   bool has_observer_callbacks_;
 };
@@ -166,14 +172,23 @@ ProcJitContinuation::ProcJitContinuation(ProcInstance* proc_instance,
           InstanceContext::CreateForProc(proc_instance, std::move(queues))),
       observer_shim_(this),
       has_observer_callbacks_(has_observer_callbacks) {
-  // Write initial state value to the input_buffer.
+  // Write initial state value to the input and output buffers. The output
+  // buffers must hold the current state at the start of each tick (see
+  // JittedFunctionBase::Build).
   for (StateElement* state_element : proc()->StateElements()) {
     int64_t state_index = *proc()->GetStateElementIndex(state_element);
-    jit_runtime->BlitValueToBuffer(
-        state_element->initial_value(), state_element->type(),
-        absl::Span<uint8_t>(
-            input_.pointers()[state_index],
-            jit_runtime_->GetTypeByteSize(state_element->type())));
+    for (JitArgumentSet* buffers : {&input_, &output_}) {
+      jit_runtime->BlitValueToBuffer(
+          state_element->initial_value(), state_element->type(),
+          absl::Span<uint8_t>(
+              buffers->pointers()[state_index],
+              jit_runtime_->GetTypeByteSize(state_element->type())));
+    }
+  }
+  for (Next* next : proc()->next_values()) {
+    if (next->value() == next->state_read()) {
+      unchanged_next_values_.insert(next->id());
+    }
   }
 }
 
@@ -212,11 +227,13 @@ absl::Status ProcJitContinuation::SetState(std::vector<Value> v) {
 
   for (StateElement* state_element : proc()->StateElements()) {
     int64_t state_index = *proc()->GetStateElementIndex(state_element);
-    jit_runtime_->BlitValueToBuffer(
-        v[state_index], state_element->type(),
-        absl::Span<uint8_t>(
-            input_.pointers()[state_index],
-            jit_runtime_->GetTypeByteSize(state_element->type())));
+    for (JitArgumentSet* buffers : {&input_, &output_}) {
+      jit_runtime_->BlitValueToBuffer(
+          v[state_index], state_element->type(),
+          absl::Span<uint8_t>(
+              buffers->pointers()[state_index],
+              jit_runtime_->GetTypeByteSize(state_element->type())));
+    }
   }
 
   return absl::OkStatus();
@@ -250,7 +267,6 @@ absl::Status ProcJitContinuation::NextTick() {
               })));
     }
   }
-  instance_context_.active_next_values.clear();
 
   continuation_point_ = 0;
   {
@@ -265,14 +281,22 @@ absl::Status ProcJitContinuation::NextTick() {
 
   if (!proc()->next_values().empty()) {
     // New-style state param evaluation; initialize the output state params to
-    // be unchanged by default.
-    for (int64_t state_index = 0; state_index < proc()->GetStateElementCount();
-         ++state_index) {
+    // be unchanged by default. The two buffers only differ in the state
+    // elements changed by the tick which just completed, so only those are
+    // copied.
+    for (const auto& [state_index, active_next_values] :
+         instance_context_.active_next_values) {
+      if (absl::c_all_of(active_next_values, [&](int64_t next) {
+            return unchanged_next_values_.contains(next);
+          })) {
+        continue;
+      }
       memcpy(output_.pointers()[state_index], input_.pointers()[state_index],
              jit_runtime_->GetTypeByteSize(
                  proc()->GetStateElementType(state_index)));
     }
   }
+  instance_context_.active_next_values.clear();
   return absl::OkStatus();
 }
 
@@ -333,11 +357,15 @@ absl::Status InitializeChannelQueues(
 
 absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::Create(
     Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
-    bool include_observer_callbacks, JitObserver* jit_observer) {
+    bool include_observer_callbacks, JitObserver* jit_observer,
+    JitNodeCoverage* node_coverage, NodeProfiler* node_profiler) {
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<OrcJit> orc_jit,
       OrcJit::Create(LlvmCompiler::kDefaultOptLevel, include_observer_callbacks,
                      jit_observer));
+  orc_jit->set_node_coverage(node_coverage);
+  orc_jit->set_node_profiler(node_profiler);
+  orc_jit->set_layout_options(jit_runtime->layout_options());
   auto jit = absl::WrapUnique(
       new ProcJit(proc, jit_runtime, queue_mgr, std::move(orc_jit),
                   /*has_observer_callbacks=*/include_observer_callbacks));
@@ -29,7 +29,9 @@
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_node_coverage.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/node_profiler.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
@@ -40,10 +42,15 @@ namespace xls {
 class ProcJit : public ProcEvaluator {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // proc.
+  // proc. If `node_coverage` is given the compiled code records the values of
+  // all nodes into it; it must outlive the returned object. Likewise if
+  // `node_profiler` is given the compiled code records the cycles spent in each
+  // node into it.
   static absl::StatusOr<std::unique_ptr<ProcJit>> Create(
       Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
-      bool include_observer_callbacks = false, JitObserver* observer = nullptr);
+      bool include_observer_callbacks = false, JitObserver* observer = nullptr,
+      JitNodeCoverage* node_coverage = nullptr,
+      NodeProfiler* node_profiler = nullptr);
 
   static absl::StatusOr<std::unique_ptr<ProcJit>> CreateFromAot(
       Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -23,7 +24,12 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/ir_interpreter.h"
@@ -33,6 +39,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/value.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
 namespace xls {
@@ -79,11 +86,94 @@ SwitchableFunctionJit::Create(Function* xls_function, ExecutionType execution,
     case ExecutionType::kJit:
       return SwitchableFunctionJit::CreateJit(xls_function, opt_level,
                                               observer);
+    case ExecutionType::kAdaptive:
+      return SwitchableFunctionJit::CreateAdaptive(
+          xls_function, AdaptiveJitOptions(), opt_level, observer);
     case ExecutionType::kDefault:
       LOG(FATAL) << "Unreachable";
   }
 }
 
+absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
+SwitchableFunctionJit::CreateAdaptive(Function* xls_function,
+                                      const AdaptiveJitOptions& options,
+                                      int64_t opt_level,
+                                      JitObserver* observer) {
+  XLS_RET_CHECK_GE(options.invocation_threshold, 0);
+  std::unique_ptr<SwitchableFunctionJit> result(
+      new SwitchableFunctionJit(xls_function, /*use_jit=*/false, nullptr));
+  result->adaptive_options_ = options;
+  result->opt_level_ = opt_level;
+  result->observer_ = observer;
+  return result;
+}
+
+void SwitchableFunctionJit::Compile() {
+  VLOG(1) << absl::StreamFormat("Compiling hot function `%s`",
+                                xls_function_->name());
+  absl::StatusOr<std::unique_ptr<FunctionJit>> jit;
+  if (adaptive_options_->adaptive_optimization.has_value()) {
+    std::optional<int64_t> expected_invocations =
+        adaptive_options_->expected_invocations;
+    if (!expected_invocations.has_value()) {
+      absl::MutexLock lock(&mutex_);
+      expected_invocations = interpreted_invocations_;
+    }
+    jit = FunctionJit::CreateAdaptive(
+        xls_function_, expected_invocations,
+        *adaptive_options_->adaptive_optimization,
+        /*include_observer_callbacks=*/false, observer_);
+  } else {
+    jit = FunctionJit::Create(xls_function_, opt_level_,
+                              /*include_observer_callbacks=*/false, observer_);
+  }
+  absl::MutexLock lock(&mutex_);
+  if (jit.ok()) {
+    function_jit_ = *std::move(jit);
+    use_jit_ = true;
+  } else {
+    LOG(WARNING) << absl::StreamFormat(
+        "Failed to JIT compile function `%s`, continuing in the interpreter: "
+        "%s",
+        xls_function_->name(), jit.status().ToString());
+    compile_status_ = jit.status();
+  }
+  compilation_done_ = true;
+}
+
+void SwitchableFunctionJit::RecordInterpretedInvocation(
+    absl::Duration duration) {
+  if (!adaptive_options_.has_value()) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    ++interpreted_invocations_;
+    interpreter_time_ += duration;
+    if (compilation_started_ ||
+        (interpreted_invocations_ < adaptive_options_->invocation_threshold &&
+         interpreter_time_ < adaptive_options_->interpreter_time_threshold)) {
+      return;
+    }
+    compilation_started_ = true;
+    if (adaptive_options_->compile_in_background) {
+      compile_thread_ = std::make_unique<Thread>([this]() { Compile(); });
+      return;
+    }
+  }
+  Compile();
+}
+
+absl::Status SwitchableFunctionJit::WaitForCompilation() {
+  absl::MutexLock lock(&mutex_);
+  auto compilation_finished = [&]() {
+    mutex_.AssertReaderHeld();
+    return !compilation_started_ || compilation_done_;
+  };
+  mutex_.Await(absl::Condition(&compilation_finished));
+  return compile_status_;
+}
+
 namespace {
 absl::StatusOr<absl::flat_hash_map<Node*, Value>> ToValueMap(
     absl::Span<const Value> args, Function* f) {
@@ -131,20 +221,28 @@ absl::StatusOr<InterpreterResult<Value>> Interpret(
 
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     absl::Span<const Value> args) {
-  if (use_jit_) {
+  if (IsJitReady()) {
     return function_jit_->Run(args);
   }
+  absl::Time start = absl::Now();
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(args, function()));
-  return Interpret(std::move(node_args), function());
+  XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
+                       Interpret(std::move(node_args), function()));
+  RecordInterpretedInvocation(absl::Now() - start);
+  return result;
 }
 
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     const absl::flat_hash_map<std::string, Value>& kwargs) {
-  if (use_jit_) {
+  if (IsJitReady()) {
     return function_jit_->Run(kwargs);
   }
+  absl::Time start = absl::Now();
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(kwargs, function()));
-  return Interpret(std::move(node_args), function());
+  XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
+                       Interpret(std::move(node_args), function()));
+  RecordInterpretedInvocation(absl::Now() - start);
+  return result;
 }
 
 }  // namespace xls
@@ -21,13 +21,19 @@
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/value.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
 namespace xls {
@@ -36,6 +42,32 @@ enum class ExecutionType {
   kDefault,
   kJit,
   kInterpreter,
+  // Start in the interpreter and switch to the JIT once the function has been
+  // invoked often enough (see AdaptiveJitOptions).
+  kAdaptive,
+};
+
+// Thresholds controlling when an adaptive SwitchableFunctionJit switches from
+// the interpreter to the JIT. Compilation starts as soon as either threshold
+// is reached.
+struct AdaptiveJitOptions {
+  // Number of interpreted invocations after which the function is compiled.
+  int64_t invocation_threshold = 64;
+  // Cumulative time spent interpreting the function after which the function
+  // is compiled.
+  absl::Duration interpreter_time_threshold = absl::Milliseconds(50);
+  // If true the function is compiled on a background thread and invocations
+  // continue in the interpreter until compilation completes. Otherwise the
+  // invocation which reaches the threshold compiles the function itself.
+  bool compile_in_background = true;
+  // If set, the LLVM optimization level is chosen from the size of the
+  // function and its expected number of invocations (see
+  // ChooseAdaptiveOptimization) rather than being the given opt_level.
+  std::optional<AdaptiveOptOptions> adaptive_optimization;
+  // Hint for the total number of times the function is expected to be invoked.
+  // If unset the number of interpreted invocations before compilation is used
+  // as the estimate.
+  std::optional<int64_t> expected_invocations;
 };
 
 // A wrapper for the jit structures that can be turned off at build time if
@@ -54,6 +86,13 @@ class SwitchableFunctionJit {
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> Create(
       Function* xls_function, ExecutionType execution = ExecutionType::kDefault,
       int64_t opt_level = 3, JitObserver* observer = nullptr);
+  // Returns an object which interprets the function until one of the
+  // thresholds in `options` is reached and then switches (transparently) to
+  // a JIT-compiled version of the function. If compilation fails the function
+  // continues to be interpreted.
+  static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> CreateAdaptive(
+      Function* xls_function, const AdaptiveJitOptions& options = {},
+      int64_t opt_level = 3, JitObserver* observer = nullptr);
 
   // Executes the compiled function with the specified arguments.
   absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
@@ -67,13 +106,19 @@ class SwitchableFunctionJit {
   // Returns the function that the JIT executes.
   Function* function() { return xls_function_; }
 
+  // Returns the JIT used to execute the function, if any. For adaptive
+  // objects this is empty until the function has been compiled.
   std::optional<FunctionJit*> function_jit() {
-    if (use_jit_) {
+    if (IsJitReady()) {
       return function_jit_.get();
     }
     return std::nullopt;
   }
 
+  // Blocks until any in-progress background compilation finishes and returns
+  // its status. Returns OkStatus if no compilation was started.
+  absl::Status WaitForCompilation();
+
  private:
   explicit SwitchableFunctionJit(Function* xls_function, bool use_jit,
                                  std::unique_ptr<FunctionJit>&& jit)
@@ -81,9 +126,36 @@ class SwitchableFunctionJit {
         use_jit_(use_jit),
         function_jit_(std::move(jit)) {}
 
+  bool IsJitReady() {
+    absl::MutexLock lock(&mutex_);
+    return use_jit_;
+  }
+
+  // Records an interpreted invocation which took `duration` and starts
+  // compilation if a threshold has been reached.
+  void RecordInterpretedInvocation(absl::Duration duration);
+  void Compile();
+
   Function* xls_function_;
-  bool use_jit_;
+
+  // Set only for adaptive objects.
+  std::optional<AdaptiveJitOptions> adaptive_options_;
+  int64_t opt_level_ = 3;
+  JitObserver* observer_ = nullptr;
+
+  absl::Mutex mutex_;
+  bool use_jit_ ABSL_GUARDED_BY(mutex_);
+  // Once `use_jit_` is true the jit is never modified so it may be read
+  // without holding the lock.
   std::unique_ptr<FunctionJit> function_jit_;
+  int64_t interpreted_invocations_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::Duration interpreter_time_ ABSL_GUARDED_BY(mutex_);
+  bool compilation_started_ ABSL_GUARDED_BY(mutex_) = false;
+  bool compilation_done_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status compile_status_ ABSL_GUARDED_BY(mutex_);
+  // Declared last so the thread is joined before any other member is
+  // destroyed.
+  std::unique_ptr<Thread> compile_thread_;
 };
 }  // namespace xls
 
@@ -14,10 +14,15 @@
 
 #include "xls/jit/switchable_function_jit.h"
 
+#include <cstdint>
+#include <limits>
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
@@ -79,5 +84,70 @@ TEST_F(SwitchableFunctionJitTest, CanExecuteDefault) {
             Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
 }
 
+TEST_F(SwitchableFunctionJitTest, AdaptiveSwitchesAfterInvocationThreshold) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      SwitchableFunctionJit::CreateAdaptive(
+          f, AdaptiveJitOptions{.invocation_threshold = 3,
+                                .interpreter_time_threshold =
+                                    absl::InfiniteDuration(),
+                                .compile_in_background = false}));
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_FALSE(runner->function_jit().has_value());
+    XLS_ASSERT_OK_AND_ASSIGN(auto result,
+                             runner->Run(std::vector<Value>{
+                                 Value(UBits(i, 8)), Value(UBits(4, 8))}));
+    EXPECT_EQ(result.value,
+              Value::Tuple({Value(UBits(i + 4, 8)), Value(UBits(i * 4, 8))}));
+  }
+  XLS_ASSERT_OK(runner->WaitForCompilation());
+  EXPECT_TRUE(runner->function_jit().has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto result,
+      runner->Run(std::vector<Value>{Value(UBits(8, 8)), Value(UBits(4, 8))}));
+  EXPECT_EQ(result.value,
+            Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
+}
+
+TEST_F(SwitchableFunctionJitTest, AdaptiveCompilesInBackground) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::Create(f, ExecutionType::kAdaptive));
+  EXPECT_FALSE(runner->function_jit().has_value());
+  // Results are the same regardless of which tier executes the call.
+  for (int64_t i = 0; i < 200; ++i) {
+    absl::flat_hash_map<std::string, Value> kwargs = {
+        {"p1", Value(UBits(i, 8))}, {"p2", Value(UBits(3, 8))}};
+    XLS_ASSERT_OK_AND_ASSIGN(auto result, runner->Run(kwargs));
+    EXPECT_EQ(result.value, Value::Tuple({Value(UBits((i + 3) % 256, 8)),
+                                          Value(UBits((i * 3) % 256, 8))}));
+  }
+  XLS_ASSERT_OK(runner->WaitForCompilation());
+  EXPECT_TRUE(runner->function_jit().has_value());
+}
+
+TEST_F(SwitchableFunctionJitTest, AdaptiveSwitchesAfterTimeThreshold) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      SwitchableFunctionJit::CreateAdaptive(
+          f, AdaptiveJitOptions{
+                 .invocation_threshold = std::numeric_limits<int64_t>::max(),
+                 .interpreter_time_threshold = absl::ZeroDuration(),
+                 .compile_in_background = false}));
+  EXPECT_FALSE(runner->function_jit().has_value());
+  XLS_ASSERT_OK(
+      runner->Run(std::vector<Value>{Value(UBits(8, 8)), Value(UBits(4, 8))})
+          .status());
+  EXPECT_TRUE(runner->function_jit().has_value());
+}
+
 }  // namespace
 }  // namespace xls
@@ -42,10 +42,43 @@ static bool IsLeafValue(const Value& value) {
   return value.IsBits() || value.IsToken();
 }
 
+uint64_t ReadPackedBits(const uint8_t* buffer, int64_t bit_offset,
+                        int64_t bit_count) {
+  DCHECK_LE(bit_offset % 8 + bit_count, 64);
+  const uint8_t* data = buffer + bit_offset / 8;
+  int64_t shift = bit_offset % 8;
+  uint64_t word = 0;
+  for (int64_t i = 0; i < CeilOfRatio(shift + bit_count, int64_t{8}); ++i) {
+    word |= uint64_t{data[i]} << (8 * i);
+  }
+  word >>= shift;
+  return bit_count == 64 ? word : word & ((uint64_t{1} << bit_count) - 1);
+}
+
+void WritePackedBits(uint8_t* buffer, int64_t bit_offset, int64_t bit_count,
+                     uint64_t value) {
+  DCHECK_LE(bit_offset % 8 + bit_count, 64);
+  uint8_t* data = buffer + bit_offset / 8;
+  int64_t shift = bit_offset % 8;
+  uint64_t mask =
+      (bit_count == 64 ? ~uint64_t{0} : (uint64_t{1} << bit_count) - 1)
+      << shift;
+  uint64_t bits = (value << shift) & mask;
+  for (int64_t i = 0; i < CeilOfRatio(shift + bit_count, int64_t{8}); ++i) {
+    uint8_t byte_mask = static_cast<uint8_t>(mask >> (8 * i));
+    data[i] = (data[i] & ~byte_mask) | static_cast<uint8_t>(bits >> (8 * i));
+  }
+}
+
 static void LeafValueToNativeLayout(const Value& value,
                                     const ElementLayout& element_layout,
                                     uint8_t* buffer) {
   uint8_t* element_buffer = buffer + element_layout.offset;
+  if (element_layout.bit_offset.has_value()) {
+    WritePackedBits(element_buffer, *element_layout.bit_offset,
+                    value.bits().bit_count(), value.bits().ToUint64().value());
+    return;
+  }
   if (value.IsBits()) {
     // Write the bytes from the Bits object into the buffer.
     value.bits().ToBytes(
@@ -64,6 +97,12 @@ void TypeLayout::ValueToNativeLayout(const Value& value,
   DCHECK(ValueConformsToType(value, type())) << absl::StreamFormat(
       "Value `%s` is not of type `%s`", value.ToString(), type()->ToString());
 
+  // Leaves of bit-packed arrays only write their own bits so clear the slack
+  // bits of the arrays up front.
+  if (has_packed_elements_) {
+    std::memset(buffer, 0, size_);
+  }
+
   if (IsLeafValue(value)) {
     return LeafValueToNativeLayout(value, elements_.front(), buffer);
   }
@@ -115,6 +154,11 @@ Value TypeLayout::NativeLayoutToValueInternal(Type* element_type,
     int64_t bit_count = element_type->AsBitsOrDie()->bit_count();
     const ElementLayout& element_layout = elements_.at(*leaf_index);
     ++(*leaf_index);
+    if (element_layout.bit_offset.has_value()) {
+      return Value(UBits(ReadPackedBits(buffer + element_layout.offset,
+                                        *element_layout.bit_offset, bit_count),
+                         bit_count));
+    }
     return Value(
         Bits::FromBytes(absl::MakeSpan(buffer + element_layout.offset,
                                        CeilOfRatio(bit_count, int64_t{8})),
@@ -174,6 +218,9 @@ std::string TypeLayout::ToString() const {
         ElementLayout{.offset = element_proto.offset(),
                       .data_size = element_proto.data_size(),
                       .padded_size = element_proto.padded_size()});
+    if (element_proto.has_bit_offset()) {
+      elements.back().bit_offset = element_proto.bit_offset();
+    }
   }
   return TypeLayout(type, proto.size(), elements);
 }
@@ -187,6 +234,9 @@ TypeLayoutProto TypeLayout::ToProto() const {
     element_proto->set_offset(element.offset);
     element_proto->set_data_size(element.data_size);
     element_proto->set_padded_size(element.padded_size);
+    if (element.bit_offset.has_value()) {
+      element_proto->set_bit_offset(*element.bit_offset);
+    }
   }
   return proto;
 }
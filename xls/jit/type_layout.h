@@ -16,6 +16,7 @@
 #define XLS_JIT_TYPE_LAYOUT_H_
 
 #include <cstdint>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -31,10 +32,9 @@
 namespace xls {
 
 // Data structure describing the layout of a single leaf element of an xls::Type
-// in the native layout used by the JIT. All offsets and sizes are in
-// bytes. Sub-byte alignment is not supported.
-// TODO(meheff): 2022/11/08 Add support for sub-byte alignment to allow
-// expression of our "packed" representation.
+// in the native layout used by the JIT. All offsets and sizes are in bytes.
+// Leaves of bit-packed arrays (see JitLayoutOptions) additionally have a
+// sub-byte `bit_offset`.
 struct ElementLayout {
   // Byte offset of this leaf element in the type it is contained in.
   int64_t offset;
@@ -46,7 +46,20 @@ struct ElementLayout {
   // beyond `data_size` up to `padded_size` must be zero.
   int64_t padded_size;
 
+  // Set only for the elements of bit-packed arrays: the bit within the byte at
+  // `offset` where the data of this leaf starts. Such leaves share bytes with
+  // their neighbors so they must be written with a read-modify-write (see
+  // WritePackedBits). `data_size` and `padded_size` are both the number of
+  // bytes touched by the leaf.
+  std::optional<int64_t> bit_offset;
+
   std::string ToString() const {
+    if (bit_offset.has_value()) {
+      return absl::StrFormat(
+          "ElementLayout{.offset=%d, .data_size=%d, .padded_size=%d, "
+          ".bit_offset=%d}",
+          offset, data_size, padded_size, *bit_offset);
+    }
     return absl::StrFormat(
         "ElementLayout{.offset=%d, .data_size=%d, .padded_size=%d}", offset,
         data_size, padded_size);
@@ -54,7 +67,7 @@ struct ElementLayout {
 
   bool operator==(const ElementLayout& other) const {
     return offset == other.offset && data_size == other.data_size &&
-           padded_size == other.padded_size;
+           padded_size == other.padded_size && bit_offset == other.bit_offset;
   }
   bool operator!=(const ElementLayout& other) const {
     return !(*this == other);
@@ -82,6 +95,14 @@ struct ElementLayout {
 //                      ElementLayout{.offset=8, .data_size=2, .padded_size=4},
 //                      ElementLayout{.offset=12, .data_size=1, .padded_size=4}}
 //
+// bits[5][3] bit-packed
+//                     {ElementLayout{.offset=0, .data_size=1, .padded_size=1,
+//                                    .bit_offset=0},
+//                      ElementLayout{.offset=0, .data_size=2, .padded_size=2,
+//                                    .bit_offset=5},
+//                      ElementLayout{.offset=1, .data_size=1, .padded_size=1,
+//                                    .bit_offset=2}}
+//
 // TODO(https://github.com/google/xls/issues/760): Reduce the redundancy in the
 // array element layouts.
 class TypeLayout {
@@ -90,6 +111,9 @@ class TypeLayout {
                       absl::Span<const ElementLayout> elements)
       : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
     CHECK_EQ(elements.size(), type->leaf_count());
+    for (const ElementLayout& element : elements_) {
+      has_packed_elements_ |= element.bit_offset.has_value();
+    }
   }
 
   // Converts TypeLayout objects to/from TypeLayoutProtos.
@@ -125,8 +149,21 @@ class TypeLayout {
   Type* type_;
   int64_t size_;
   std::vector<ElementLayout> elements_;
+  // Whether any leaf is an element of a bit-packed array.
+  bool has_packed_elements_ = false;
 };
 
+// Returns the `bit_count` bits starting `bit_offset` bits into `buffer`.
+// `bit_offset % 8 + bit_count` must be at most 64.
+uint64_t ReadPackedBits(const uint8_t* buffer, int64_t bit_offset,
+                        int64_t bit_count);
+
+// Overwrites the `bit_count` bits starting `bit_offset` bits into `buffer` with
+// the low bits of `value`. All other bits of `buffer` are unchanged.
+// `bit_offset % 8 + bit_count` must be at most 64.
+void WritePackedBits(uint8_t* buffer, int64_t bit_offset, int64_t bit_count,
+                     uint64_t value);
+
 std::ostream& operator<<(std::ostream& os, ElementLayout layout);
 std::ostream& operator<<(std::ostream& os, const TypeLayout& layout);
 
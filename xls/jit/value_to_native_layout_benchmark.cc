@@ -24,6 +24,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/native_layout_view.h"
 #include "xls/jit/orc_jit.h"
 #include "xls/jit/type_layout.h"
 
@@ -75,8 +76,28 @@ static void BM_NativeLayoutToValue(benchmark::State& state) {
   }
 }
 
+// Measures reading a single leaf (the last one) of a value in the native
+// layout through a view rather than converting the entire value.
+static void BM_NativeLayoutViewReadLastLeaf(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  TypeLayout type_layout = CreateTypeLayout(type);
+  std::vector<uint8_t> buffer(type_layout.size(), 0);
+  for (auto _ : state) {
+    NativeLayoutView view(&type_layout, buffer.data());
+    while ((view.type()->IsTuple() || view.type()->IsArray()) &&
+           view.size() > 0) {
+      view = view.element(view.size() - 1);
+    }
+    if (view.type()->IsBits()) {
+      benchmark::DoNotOptimize(view.GetBits());
+    }
+  }
+}
+
 BENCHMARK(BM_ValueToNativeLayout)->DenseRange(0, kNumTypes - 1);
 BENCHMARK(BM_NativeLayoutToValue)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_NativeLayoutViewReadLastLeaf)->DenseRange(0, kNumTypes - 1);
 
 }  // namespace
 }  // namespace xls
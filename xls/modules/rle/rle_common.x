@@ -32,3 +32,23 @@ pub struct CompressedData<SYMBOL_WIDTH: u32, COUNT_WIDTH: u32> {
     count: bits[COUNT_WIDTH],   // symbol counter
     last: bool,                 // flush RLE
 }
+
+// Structure contains up to SYMBOL_COUNT uncompressed symbols, of which
+// the first `length` are valid.
+// Structure is used as an input to the multi-symbol RLE encoder.
+pub struct PlainDataWide<SYMBOL_WIDTH: u32, SYMBOL_COUNT: u32, LENGTH_WIDTH: u32> {
+    symbols: bits[SYMBOL_WIDTH][SYMBOL_COUNT], // symbols
+    length: bits[LENGTH_WIDTH],                // number of valid symbols
+    last: bool,                                // flush RLE
+}
+
+// Structure contains up to SYMBOL_COUNT compressed (symbol, counter) pairs,
+// of which the first `length` are valid.
+// Structure is used as an output from the multi-symbol RLE encoder.
+pub struct CompressedDataWide<SYMBOL_WIDTH: u32, COUNT_WIDTH: u32,
+                              SYMBOL_COUNT: u32, LENGTH_WIDTH: u32> {
+    symbols: bits[SYMBOL_WIDTH][SYMBOL_COUNT], // symbols
+    counts: bits[COUNT_WIDTH][SYMBOL_COUNT],   // symbol counters
+    length: bits[LENGTH_WIDTH],                // number of valid pairs
+    last: bool,                                // flush RLE
+}
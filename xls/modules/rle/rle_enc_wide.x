@@ -0,0 +1,222 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file implements a parametric multi-symbol RLE encoder
+//
+// The encoder behaves like the one in rle_enc.x, but consumes up to LANES
+// symbols per evaluation of `next`. The lanes are scanned in order, extending
+// the current run or closing it and starting a new one. A lane closes at most
+// one run, so at most LANES (symbol, count) pairs are produced per evaluation
+// and they all fit in a single output packet. Packets that complete no run
+// are not sent.
+//
+// As in the single-symbol encoder, a packet with the `last` flag set causes
+// the pending run to be sent, with `last` set, in the following evaluation.
+// With LANES symbols of SYMBOL_WIDTH bits accepted every cycle, the encoder
+// sustains LANES * SYMBOL_WIDTH / 8 bytes per cycle at full throughput.
+
+import std;
+import xls.modules.rle.rle_common as rle_common;
+
+type EncInData  = rle_common::PlainDataWide;
+type EncOutData = rle_common::CompressedDataWide;
+
+// structure to preserve the state of a multi-symbol RLE encoder
+struct RunLengthEncoderWideState<SYMBOL_WIDTH: u32, COUNT_WIDTH: u32> {
+    // symbol of the run that is being counted, valid if prev_count > 0
+    prev_symbol: bits[SYMBOL_WIDTH],
+    // length of the run that is being counted, zero if there is none
+    prev_count: bits[COUNT_WIDTH],
+    // flag indicating that the previous packet was the last one
+    // in the transmission
+    prev_last: bool,
+}
+
+// Multi-symbol RLE encoder implementation
+pub proc RunLengthEncoderWide<SYMBOL_WIDTH: u32, COUNT_WIDTH: u32, LANES: u32,
+                              LENGTH_WIDTH: u32 = {std::clog2(LANES + u32:1)}> {
+    type InData = EncInData<SYMBOL_WIDTH, LANES, LENGTH_WIDTH>;
+    type OutData = EncOutData<SYMBOL_WIDTH, COUNT_WIDTH, LANES, LENGTH_WIDTH>;
+    type State = RunLengthEncoderWideState<SYMBOL_WIDTH, COUNT_WIDTH>;
+    type Symbol = bits[SYMBOL_WIDTH];
+    type Count = bits[COUNT_WIDTH];
+    type Length = bits[LENGTH_WIDTH];
+
+    input_r: chan<InData> in;
+    output_s: chan<OutData> out;
+
+    config(input_r: chan<InData> in, output_s: chan<OutData> out) {
+        (input_r, output_s)
+    }
+
+    init { zero!<State>() }
+
+    next(state: State) {
+        let (input_tok, input) =
+            recv_if(join(), input_r, !state.prev_last, zero!<InData>());
+
+        // Scan the valid lanes in order, closing the current run whenever the
+        // symbol changes or its counter would overflow.
+        let (symbol, count, symbols, counts, length) =
+            for (i, (symbol, count, symbols, counts, length)):
+                (u32, (Symbol, Count, Symbol[LANES], Count[LANES], Length)) in u32:0..LANES {
+            let lane_valid = i < (input.length as u32);
+            let lane_symbol = input.symbols[i];
+            let run_valid = count != Count:0;
+            let overflow = count == std::unsigned_max_value<COUNT_WIDTH>();
+            let close = lane_valid && run_valid && (lane_symbol != symbol || overflow);
+
+            let (symbols, counts, length) = if close {
+                (update(symbols, length, symbol), update(counts, length, count), length + Length:1)
+            } else {
+                (symbols, counts, length)
+            };
+            let (symbol, count) = if !lane_valid {
+                (symbol, count)
+            } else if close || !run_valid {
+                (lane_symbol, Count:1)
+            } else {
+                (symbol, count + Count:1)
+            };
+            (symbol, count, symbols, counts, length)
+        }((state.prev_symbol, state.prev_count, zero!<Symbol[LANES]>(), zero!<Count[LANES]>(),
+           Length:0));
+
+        let (data, next_state) = if state.prev_last {
+            let flush_length = if state.prev_count != Count:0 { Length:1 } else { Length:0 };
+            (
+                OutData {
+                    symbols: update(zero!<Symbol[LANES]>(), u32:0, state.prev_symbol),
+                    counts: update(zero!<Count[LANES]>(), u32:0, state.prev_count),
+                    length: flush_length,
+                    last: true,
+                }, zero!<State>(),
+            )
+        } else {
+            (
+                OutData { symbols, counts, length, last: false },
+                State { prev_symbol: symbol, prev_count: count, prev_last: input.last },
+            )
+        };
+
+        let do_send = state.prev_last || length != Length:0;
+        send_if(input_tok, output_s, do_send, data);
+
+        next_state
+    }
+}
+
+// Multi-symbol RLE encoder specialization for the codegen: eight 8-bit
+// symbols (8 bytes) per cycle.
+proc RunLengthEncoderWide8x8 {
+    config(input_r: chan<EncInData<8, 8, 4>> in, output_s: chan<EncOutData<8, 16, 8, 4>> out) {
+        spawn RunLengthEncoderWide<u32:8, u32:16, u32:8>(input_r, output_s);
+    }
+
+    init {  }
+
+    next(state: ()) {  }
+}
+
+// Tests
+
+const TEST_SYMBOL_WIDTH = u32:32;
+const TEST_COUNT_WIDTH = u32:2;
+const TEST_LANES = u32:4;
+const TEST_LENGTH_WIDTH = std::clog2(TEST_LANES + u32:1);
+
+type TestSymbol = bits[TEST_SYMBOL_WIDTH];
+type TestCount = bits[TEST_COUNT_WIDTH];
+type TestLength = bits[TEST_LENGTH_WIDTH];
+type TestSymbols = TestSymbol[TEST_LANES];
+type TestCounts = TestCount[TEST_LANES];
+type TestEncInData = EncInData<TEST_SYMBOL_WIDTH, TEST_LANES, TEST_LENGTH_WIDTH>;
+type TestEncOutData =
+    EncOutData<TEST_SYMBOL_WIDTH, TEST_COUNT_WIDTH, TEST_LANES, TEST_LENGTH_WIDTH>;
+
+fn test_input(symbols: TestSymbols, length: TestLength, last: bool) -> TestEncInData {
+    TestEncInData { symbols, length, last }
+}
+
+fn test_output(symbols: TestSymbols, counts: TestCounts, length: TestLength, last: bool)
+    -> TestEncOutData {
+    TestEncOutData { symbols, counts, length, last }
+}
+
+#[test_proc]
+proc RunLengthEncoderWideTest {
+    terminator: chan<bool> out;
+    enc_input_s: chan<TestEncInData> out;
+    enc_output_r: chan<TestEncOutData> in;
+
+    config(terminator: chan<bool> out) {
+        let (enc_input_s, enc_input_r) = chan<TestEncInData>("enc_input");
+        let (enc_output_s, enc_output_r) = chan<TestEncOutData>("enc_output");
+
+        spawn RunLengthEncoderWide<TEST_SYMBOL_WIDTH, TEST_COUNT_WIDTH, TEST_LANES>(
+            enc_input_r, enc_output_s);
+        (terminator, enc_input_s, enc_output_r)
+    }
+
+    init {  }
+
+    next(state: ()) {
+        // Runs spanning packets, a counter overflow within a packet, a partial
+        // last packet, a packet closing several runs at once and an empty last
+        // packet.
+        let stimuli: TestEncInData[5] = [
+            test_input(TestSymbols:[0xA, 0xA, 0xA, 0xB], TestLength:4, false),
+            test_input(TestSymbols:[0xB, 0xC, 0xC, 0xC], TestLength:4, false),
+            test_input(TestSymbols:[0xC, 0xC, 0x0, 0x0], TestLength:2, true),
+            test_input(TestSymbols:[0x1, 0x2, 0x3, 0x4], TestLength:4, true),
+            test_input(TestSymbols:[0x0, 0x0, 0x0, 0x0], TestLength:0, true),
+        ];
+        let tok = for ((counter, stimulus), tok): ((u32, TestEncInData), token) in
+            enumerate(stimuli) {
+            let tok = send(tok, enc_input_s, stimulus);
+            trace_fmt!(
+                "Sent {} stimuli, length: {}, last: {}", counter, stimulus.length,
+                stimulus.last);
+            tok
+        }(join());
+
+        let expected_output: TestEncOutData[7] = [
+            test_output(
+                TestSymbols:[0xA, 0x0, 0x0, 0x0], TestCounts:[3, 0, 0, 0], TestLength:1, false),
+            test_output(
+                TestSymbols:[0xB, 0x0, 0x0, 0x0], TestCounts:[2, 0, 0, 0], TestLength:1, false),
+            test_output(
+                TestSymbols:[0xC, 0x0, 0x0, 0x0], TestCounts:[3, 0, 0, 0], TestLength:1, false),
+            test_output(
+                TestSymbols:[0xC, 0x0, 0x0, 0x0], TestCounts:[2, 0, 0, 0], TestLength:1, true),
+            test_output(
+                TestSymbols:[0x1, 0x2, 0x3, 0x0], TestCounts:[1, 1, 1, 0], TestLength:3, false),
+            test_output(
+                TestSymbols:[0x4, 0x0, 0x0, 0x0], TestCounts:[1, 0, 0, 0], TestLength:1, true),
+            // With no pending run, the flush packet is empty.
+            test_output(
+                TestSymbols:[0x0, 0x0, 0x0, 0x0], TestCounts:[0, 0, 0, 0], TestLength:0, true),
+        ];
+        let tok = for ((counter, expected), tok): ((u32, TestEncOutData), token) in
+            enumerate(expected_output) {
+            let (tok, enc_output) = recv(tok, enc_output_r);
+            trace_fmt!(
+                "Received {} packets, length: {}, last: {}", counter, enc_output.length,
+                enc_output.last);
+            assert_eq(enc_output, expected);
+            tok
+        }(tok);
+        send(tok, terminator, true);
+    }
+}
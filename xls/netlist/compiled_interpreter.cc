@@ -0,0 +1,342 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_interpreter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/function_parser.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// Slots holding the constant zero and all-ones words.
+constexpr int32_t kZeroSlot = 0;
+constexpr int32_t kOneSlot = 1;
+
+}  // namespace
+
+// Lowers the cells of a module, in topological order, to instructions of a
+// CompiledModule.
+class CompiledModule::Compiler {
+ public:
+  using SlotMap = absl::flat_hash_map<rtl::NetRef, int32_t>;
+
+  Compiler(const rtl::Netlist* netlist, CompiledModule* compiled)
+      : netlist_(netlist), compiled_(compiled) {
+    compiled_->slot_count_ = 2;
+  }
+
+  int32_t NewSlot() { return compiled_->slot_count_++; }
+
+  // Compiles the cells of `module`. The input nets of the module must be in
+  // `slots`; the nets driven by the cells are added to it.
+  absl::Status CompileModule(const rtl::Module* module, SlotMap& slots) {
+    // Cells which read a net assigned from a newly driven net must be
+    // revisited when that net is driven.
+    absl::flat_hash_map<rtl::NetRef, std::vector<rtl::NetRef>> assigned_from;
+    for (const auto& [lhs, rhs] : module->assigns()) {
+      assigned_from[rhs].push_back(lhs);
+    }
+
+    auto is_ready = [&](const rtl::Cell* cell) {
+      return std::all_of(cell->inputs().begin(), cell->inputs().end(),
+                         [&](const rtl::Cell::Pin& pin) {
+                           return SlotOf(module, slots, pin.netref).has_value();
+                         });
+    };
+    absl::flat_hash_set<const rtl::Cell*> scheduled;
+    std::vector<const rtl::Cell*> ready;
+    for (const auto& cell : module->cells()) {
+      if (is_ready(cell.get())) {
+        scheduled.insert(cell.get());
+        ready.push_back(cell.get());
+      }
+    }
+    while (!ready.empty()) {
+      const rtl::Cell* cell = ready.back();
+      ready.pop_back();
+      XLS_ASSIGN_OR_RETURN(std::vector<rtl::NetRef> driven,
+                           CompileCell(module, cell, slots));
+      while (!driven.empty()) {
+        rtl::NetRef net = driven.back();
+        driven.pop_back();
+        for (const rtl::Cell* user : net->connected_input_cells()) {
+          if (!scheduled.contains(user) && is_ready(user)) {
+            scheduled.insert(user);
+            ready.push_back(user);
+          }
+        }
+        if (auto it = assigned_from.find(net); it != assigned_from.end()) {
+          driven.insert(driven.end(), it->second.begin(), it->second.end());
+        }
+      }
+    }
+
+    if (scheduled.size() != module->cells().size()) {
+      for (const auto& cell : module->cells()) {
+        if (!scheduled.contains(cell.get())) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Netlist contains unconnected subgraphs and cannot be "
+              "translated. Example: cell %s",
+              cell->name()));
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Returns the slot holding the value of `net`, following assignments, or
+  // std::nullopt if the net is not driven yet.
+  static std::optional<int32_t> SlotOf(const rtl::Module* module,
+                                       const SlotMap& slots, rtl::NetRef net) {
+    while (true) {
+      if (auto it = slots.find(net); it != slots.end()) {
+        return it->second;
+      }
+      if (net == module->zero()) {
+        return kZeroSlot;
+      }
+      if (net == module->one()) {
+        return kOneSlot;
+      }
+      auto it = module->assigns().find(net);
+      if (it == module->assigns().end()) {
+        return std::nullopt;
+      }
+      net = it->second;
+    }
+  }
+
+ private:
+  // Compiles a cell whose inputs are all driven and returns the nets it
+  // drives.
+  absl::StatusOr<std::vector<rtl::NetRef>> CompileCell(
+      const rtl::Module* module, const rtl::Cell* cell, SlotMap& slots) {
+    const CellLibraryEntry* entry = cell->cell_library_entry();
+    std::vector<rtl::NetRef> driven;
+    if (std::optional<const rtl::Module*> submodule =
+            netlist_->MaybeGetModule(entry->name());
+        submodule.has_value()) {
+      // Inline the submodule with its inputs bound to the slots of the nets
+      // connected to the cell. Pins are matched by name.
+      const rtl::Module* child = *submodule;
+      absl::Span<const std::string> input_names =
+          child->AsCellLibraryEntry()->input_names();
+      SlotMap child_slots;
+      for (const rtl::Cell::Pin& input : cell->inputs()) {
+        auto it = std::find(input_names.begin(), input_names.end(), input.name);
+        XLS_RET_CHECK(it != input_names.end()) << absl::StrFormat(
+            "Could not find input pin \"%s\" in module \"%s\", referenced in "
+            "cell \"%s\"!",
+            input.name, child->name(), cell->name());
+        child_slots[child->inputs()[it - input_names.begin()]] =
+            *SlotOf(module, slots, input.netref);
+      }
+      XLS_RETURN_IF_ERROR(CompileModule(child, child_slots));
+      for (const rtl::Cell::OutputPin& output : cell->outputs()) {
+        auto it = std::find_if(
+            child->outputs().begin(), child->outputs().end(),
+            [&](rtl::NetRef net) { return net->name() == output.name; });
+        XLS_RET_CHECK(it != child->outputs().end()) << absl::StrFormat(
+            "Could not find output pin \"%s\" in module \"%s\", referenced in "
+            "cell \"%s\"!",
+            output.name, child->name(), cell->name());
+        std::optional<int32_t> slot = SlotOf(child, child_slots, *it);
+        XLS_RET_CHECK(slot.has_value()) << absl::StrFormat(
+            "Output \"%s\" of module \"%s\" is not driven.", output.name,
+            child->name());
+        slots[output.netref] = *slot;
+        driven.push_back(output.netref);
+      }
+      return driven;
+    }
+
+    for (const rtl::Cell::OutputPin& output : cell->outputs()) {
+      if (output.eval != nullptr) {
+        return absl::UnimplementedError(absl::StrFormat(
+            "Cell %s has a custom evaluation function, which cannot be "
+            "compiled.",
+            cell->name()));
+      }
+      XLS_ASSIGN_OR_RETURN(const function::Ast* ast,
+                           GetFunction(entry, output.name));
+      XLS_ASSIGN_OR_RETURN(int32_t slot, Lower(*ast, module, *cell, slots));
+      slots[output.netref] = slot;
+      driven.push_back(output.netref);
+    }
+    return driven;
+  }
+
+  // Returns the parsed function of the given output pin of a cell library
+  // entry. Functions are parsed once per entry rather than once per cell.
+  absl::StatusOr<const function::Ast*> GetFunction(
+      const CellLibraryEntry* entry, const std::string& pin_name) {
+    auto key = std::make_pair(entry, pin_name);
+    if (auto it = functions_.find(key); it != functions_.end()) {
+      return &it->second;
+    }
+    auto it = entry->output_pin_to_function().find(pin_name);
+    if (it == entry->output_pin_to_function().end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "No function for output pin %s of cell library entry %s", pin_name,
+          entry->name()));
+    }
+    XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                         function::Parser::ParseFunction(it->second));
+    return &functions_.emplace(key, std::move(ast)).first->second;
+  }
+
+  // Lowers `ast`, a function of the inputs of `cell`, and returns the slot
+  // holding its value.
+  absl::StatusOr<int32_t> Lower(const function::Ast& ast,
+                                const rtl::Module* module,
+                                const rtl::Cell& cell, const SlotMap& slots) {
+    switch (ast.kind()) {
+      case function::Ast::Kind::kIdentifier: {
+        for (const rtl::Cell::Pin& input : cell.inputs()) {
+          if (input.name == ast.name()) {
+            return *SlotOf(module, slots, input.netref);
+          }
+        }
+        for (const rtl::Cell::Pin& internal : cell.internal_pins()) {
+          if (internal.name == ast.name()) {
+            return absl::UnimplementedError(absl::StrFormat(
+                "Cell %s uses state table signal %s, which cannot be "
+                "compiled.",
+                cell.name(), internal.name));
+          }
+        }
+        return absl::NotFoundError(
+            absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
+                            "or internal signals.",
+                            ast.name(), cell.name()));
+      }
+      case function::Ast::Kind::kLiteralZero:
+        return kZeroSlot;
+      case function::Ast::Kind::kLiteralOne:
+        return kOneSlot;
+      case function::Ast::Kind::kNot: {
+        XLS_ASSIGN_OR_RETURN(int32_t operand,
+                             Lower(ast.children()[0], module, cell, slots));
+        return Emit(Op::kNot, operand, operand);
+      }
+      case function::Ast::Kind::kAnd:
+      case function::Ast::Kind::kOr:
+      case function::Ast::Kind::kXor: {
+        XLS_ASSIGN_OR_RETURN(int32_t lhs,
+                             Lower(ast.children()[0], module, cell, slots));
+        XLS_ASSIGN_OR_RETURN(int32_t rhs,
+                             Lower(ast.children()[1], module, cell, slots));
+        Op op = ast.kind() == function::Ast::Kind::kAnd  ? Op::kAnd
+                : ast.kind() == function::Ast::Kind::kOr ? Op::kOr
+                                                         : Op::kXor;
+        return Emit(op, lhs, rhs);
+      }
+    }
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Unknown AST element type: ", static_cast<int>(ast.kind())));
+  }
+
+  int32_t Emit(Op op, int32_t lhs, int32_t rhs) {
+    int32_t dest = NewSlot();
+    compiled_->instructions_.push_back(
+        Instruction{.op = op, .dest = dest, .lhs = lhs, .rhs = rhs});
+    return dest;
+  }
+
+  const rtl::Netlist* netlist_;
+  CompiledModule* compiled_;
+  absl::flat_hash_map<std::pair<const CellLibraryEntry*, std::string>,
+                      function::Ast>
+      functions_;
+};
+
+/* static */ absl::StatusOr<CompiledModule> CompiledModule::Create(
+    const rtl::Netlist* netlist, const rtl::Module* module) {
+  CompiledModule compiled;
+  Compiler compiler(netlist, &compiled);
+  Compiler::SlotMap slots;
+  for (rtl::NetRef input : module->inputs()) {
+    int32_t slot = compiler.NewSlot();
+    slots[input] = slot;
+    compiled.input_slots_.push_back(slot);
+  }
+  XLS_RETURN_IF_ERROR(compiler.CompileModule(module, slots));
+  for (rtl::NetRef output : module->outputs()) {
+    std::optional<int32_t> slot = Compiler::SlotOf(module, slots, output);
+    if (!slot.has_value()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Output %s of module %s is not driven.", output->name(),
+          module->name()));
+    }
+    compiled.output_slots_.push_back(*slot);
+  }
+  return compiled;
+}
+
+absl::StatusOr<std::vector<uint64_t>> CompiledModule::Evaluate(
+    absl::Span<const uint64_t> inputs) const {
+  XLS_RET_CHECK_EQ(inputs.size(), input_slots_.size());
+  std::vector<uint64_t> values(slot_count_);
+  values[kZeroSlot] = 0;
+  values[kOneSlot] = ~uint64_t{0};
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    values[input_slots_[i]] = inputs[i];
+  }
+  for (const Instruction& instruction : instructions_) {
+    uint64_t lhs = values[instruction.lhs];
+    uint64_t rhs = values[instruction.rhs];
+    switch (instruction.op) {
+      case Op::kAnd:
+        values[instruction.dest] = lhs & rhs;
+        break;
+      case Op::kOr:
+        values[instruction.dest] = lhs | rhs;
+        break;
+      case Op::kXor:
+        values[instruction.dest] = lhs ^ rhs;
+        break;
+      case Op::kNot:
+        values[instruction.dest] = ~lhs;
+        break;
+    }
+  }
+  std::vector<uint64_t> outputs;
+  outputs.reserve(output_slots_.size());
+  for (int32_t slot : output_slots_) {
+    outputs.push_back(values[slot]);
+  }
+  return outputs;
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,80 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_COMPILED_INTERPRETER_H_
+#define XLS_NETLIST_COMPILED_INTERPRETER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// A netlist module compiled for fast repeated evaluation. Unlike Interpreter,
+// which walks the cells through a work queue and re-interprets each cell's
+// function on every evaluation, the module is levelized once and the cell
+// functions are lowered to a flat list of bitwise instructions. Submodules
+// are inlined.
+//
+// Evaluation is bit-parallel: every net holds a 64-bit word whose bit `i`
+// belongs to input vector `i`, so a single evaluation simulates 64 input
+// vectors.
+//
+// Cells with state tables or custom evaluation functions are not supported.
+class CompiledModule {
+ public:
+  // The number of input vectors simulated by one evaluation.
+  static constexpr int64_t kLanes = 64;
+
+  // Compiles `module`, resolving submodule cells in `netlist`.
+  static absl::StatusOr<CompiledModule> Create(const rtl::Netlist* netlist,
+                                               const rtl::Module* module);
+
+  // Evaluates the module. `inputs` holds one word per module input, in the
+  // order of Module::inputs(); the returned words are in the order of
+  // Module::outputs().
+  absl::StatusOr<std::vector<uint64_t>> Evaluate(
+      absl::Span<const uint64_t> inputs) const;
+
+  int64_t input_count() const { return input_slots_.size(); }
+  int64_t output_count() const { return output_slots_.size(); }
+  int64_t instruction_count() const { return instructions_.size(); }
+
+ private:
+  enum class Op : uint8_t { kAnd, kOr, kXor, kNot };
+  struct Instruction {
+    Op op;
+    int32_t dest;
+    int32_t lhs;
+    int32_t rhs;
+  };
+
+  class Compiler;
+
+  CompiledModule() = default;
+
+  int64_t slot_count_ = 0;
+  std::vector<Instruction> instructions_;
+  std::vector<int32_t> input_slots_;
+  std::vector<int32_t> output_slots_;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPILED_INTERPRETER_H_
@@ -0,0 +1,153 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_interpreter.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Evaluates every combination of the module's inputs with both the compiled
+// module and the interpreter and checks that they agree.
+void ExpectMatchesInterpreter(rtl::Netlist* netlist,
+                              const rtl::Module* module) {
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Create(netlist, module));
+  int64_t input_count = module->inputs().size();
+  ASSERT_LE(int64_t{1} << input_count, CompiledModule::kLanes);
+
+  // Lane `i` holds input combination `i`.
+  std::vector<uint64_t> input_words(input_count);
+  for (int64_t lane = 0; lane < (int64_t{1} << input_count); ++lane) {
+    for (int64_t i = 0; i < input_count; ++i) {
+      input_words[i] |= static_cast<uint64_t>((lane >> i) & 1) << lane;
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<uint64_t> output_words,
+                           compiled.Evaluate(input_words));
+  ASSERT_EQ(output_words.size(), module->outputs().size());
+
+  Interpreter interpreter(netlist);
+  for (int64_t lane = 0; lane < (int64_t{1} << input_count); ++lane) {
+    NetRef2Value inputs;
+    for (int64_t i = 0; i < input_count; ++i) {
+      inputs[module->inputs()[i]] = (lane >> i) & 1;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value outputs,
+                             interpreter.InterpretModule(module, inputs));
+    for (int64_t i = 0; i < module->outputs().size(); ++i) {
+      EXPECT_EQ((output_words[i] >> lane) & 1,
+                outputs.at(module->outputs()[i]))
+          << "lane " << lane << ", output " << module->outputs()[i]->name();
+    }
+  }
+}
+
+TEST(CompiledInterpreterTest, Tree) {
+  std::string module_text = R"(
+module main (i0, i1, i2, i3, o0, o1);
+  input i0, i1, i2, i3;
+  output o0, o1;
+  wire and_o, or_o;
+
+  AND and0( .A(i0), .B(i1), .Z(and_o) );
+  OR or0( .A(i2), .B(i3), .Z(or_o) );
+  XOR xor0( .A(and_o), .B(or_o), .Z(o0) );
+  INV inv0( .A(o0), .ZN(o1) );
+endmodule
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  ExpectMatchesInterpreter(netlist.get(), module);
+}
+
+TEST(CompiledInterpreterTest, SubmodulesAndAssigns) {
+  std::string module_text = R"(
+module submodule_0 (i2_0, i2_1, o2_0);
+  input i2_0, i2_1;
+  output o2_0;
+
+  AND and0( .A(i2_0), .B(i2_1), .Z(o2_0) );
+endmodule
+
+module submodule_1 (i1_0, i1_1, i1_2, o1_0, o1_1);
+  input i1_0, i1_1, i1_2;
+  output o1_0, o1_1;
+  wire res0;
+
+  submodule_0 and0 ( .i2_0(i1_0), .i2_1(i1_1), .o2_0(res0) );
+  XOR xor0 ( .A(res0), .B(i1_2), .Z(o1_0) );
+  assign o1_1 = i1_2;
+endmodule
+
+module main (i0, i1, i2, o0, o1, o2);
+  input i0, i1, i2;
+  output o0, o1, o2;
+
+  submodule_1 sub0( .i1_0(i0), .i1_1(i1), .i1_2(i2), .o1_0(o0), .o1_1(o1) );
+  assign o2 = 1'b1;
+endmodule
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  ExpectMatchesInterpreter(netlist.get(), module);
+}
+
+TEST(CompiledInterpreterTest, UndrivenOutput) {
+  std::string module_text = R"(
+module main (i0, o0);
+  input i0;
+  output o0;
+endmodule
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  EXPECT_THAT(CompiledModule::Create(netlist.get(), module),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Output o0 of module main is not driven")));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
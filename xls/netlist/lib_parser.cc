@@ -14,9 +14,13 @@
 
 #include "xls/netlist/lib_parser.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include <cctype>
+#include <cerrno>
 #include <cstdint>
-#include <fstream>
 #include <memory>
 #include <optional>
 #include <string>
@@ -33,6 +37,8 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/variant.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/status/error_code_to_status.h"
 #include "xls/common/status/status_macros.h"
 
 namespace xls {
@@ -41,18 +47,47 @@ namespace cell_lib {
 
 /* static */ absl::StatusOr<CharStream> CharStream::FromPath(
     std::string_view path) {
-  std::ifstream file_stream{std::string(path)};
-  if (file_stream.is_open()) {
-    return CharStream(std::move(file_stream));
+  FileDescriptor fd(open(std::string(path).c_str(), O_RDONLY));
+  if (fd.get() < 0) {
+    return absl::NotFoundError(
+        absl::StrCat("Could not open file at path: ", path));
+  }
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0) {
+    return ErrnoToStatus(errno) << "Unable to stat file at path: " << path;
+  }
+  if (st.st_size == 0) {
+    return CharStream(std::string());
   }
-  return absl::NotFoundError(
-      absl::StrCat("Could not open file at path: ", path));
+  void* mapping =
+      mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd.get(), /*offset=*/0);
+  if (mapping == MAP_FAILED) {
+    return ErrnoToStatus(errno) << "Unable to map file at path: " << path;
+  }
+  // The file is scanned front to back.
+  madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+  return CharStream(mapping, st.st_size);
 }
 
 /* static */ absl::StatusOr<CharStream> CharStream::FromText(std::string text) {
   return CharStream(std::move(text));
 }
 
+CharStream::CharStream(CharStream&& other)
+    : pos_(other.pos_),
+      text_(std::move(other.text_)),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      mapping_size_(other.mapping_size_),
+      contents_(std::exchange(other.contents_, std::string_view())),
+      cursor_(other.cursor_),
+      last_colno_(other.last_colno_) {}
+
+CharStream::~CharStream() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
 std::string TokenKindToString(TokenKind kind) {
   switch (kind) {
     case TokenKind::kIdentifier:
@@ -82,52 +117,29 @@ std::string TokenKindToString(TokenKind kind) {
 absl::StatusOr<Token> Scanner::ScanIdentifier() {
   const Pos start_pos = cs_->GetPos();
   CHECK(IsIdentifierStart(cs_->PeekCharOrDie()));
-  absl::InlinedVector<char, 16> chars;
-  while (!cs_->AtEof() && IsIdentifierRest(cs_->PeekCharOrDie())) {
-    chars.push_back(cs_->PopCharOrDie());
-  }
-  return Token::Identifier(
-      start_pos, std::string(std::string_view(chars.data(), chars.size())));
+  return Token::Identifier(start_pos,
+                           std::string(cs_->PopWhile(IsIdentifierRest)));
 }
 
 // Scans a number token.
 absl::StatusOr<Token> Scanner::ScanNumber() {
   const Pos start_pos = cs_->GetPos();
   CHECK_NE(std::isdigit(cs_->PeekCharOrDie()), 0);
-  absl::InlinedVector<char, 16> chars;
-  while (!cs_->AtEof()) {
-    if (IsNumberRest(cs_->PeekCharOrDie())) {
-      chars.push_back(cs_->PopCharOrDie());
-    } else if (cs_->TryDropChars('e', '-')) {
-      chars.push_back('e');
-      chars.push_back('-');
-    } else {
-      break;
-    }
-  }
-  return Token::Number(
-      start_pos, std::string(std::string_view(chars.data(), chars.size())));
+  return Token::Number(start_pos, std::string(cs_->PopWhile(IsNumberRest)));
 }
 
 // Scans a string token.
 absl::StatusOr<Token> Scanner::ScanQuotedString() {
   const Pos start_pos = cs_->GetPos();
   CHECK(cs_->TryDropChar('"'));
-  absl::InlinedVector<char, 16> chars;
-  while (true) {
-    if (cs_->AtEof()) {
-      return absl::InvalidArgumentError(
-          "Unexpected end-of-file in string token starting @ " +
-          start_pos.ToHumanString());
-    }
-    char c = cs_->PopCharOrDie();
-    if (c == '"') {
-      break;
-    }
-    chars.push_back(c);
+  std::string_view contents =
+      cs_->PopWhile([](char c) { return c != '"'; });
+  if (!cs_->TryDropChar('"')) {
+    return absl::InvalidArgumentError(
+        "Unexpected end-of-file in string token starting @ " +
+        start_pos.ToHumanString());
   }
-  return Token::QuotedString(
-      start_pos, std::string(std::string_view(chars.data(), chars.size())));
+  return Token::QuotedString(start_pos, std::string(contents));
 }
 
 absl::Status Scanner::PeekInternal() {
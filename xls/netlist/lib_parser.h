@@ -22,7 +22,6 @@
 
 #include <cctype>
 #include <cstdint>
-#include <fstream>
 #include <memory>
 #include <optional>
 #include <string>
@@ -54,34 +53,24 @@ struct Pos {
 };
 
 // Wraps a file as a character stream with a 1- or 2-character lookahead
-// interface.
+// interface. Files are memory-mapped rather than read, so scanning is a walk
+// over a contiguous buffer and runs of characters can be viewed without
+// copying.
 class CharStream {
  public:
   static absl::StatusOr<CharStream> FromPath(std::string_view path);
   static absl::StatusOr<CharStream> FromText(std::string text);
 
-  ~CharStream() {
-    if (if_.has_value()) {
-      if_->close();
-    }
-  }
+  ~CharStream();
 
-  CharStream(CharStream&& other) = default;
+  CharStream(CharStream&& other);
+  CharStream& operator=(CharStream&& other) = delete;
 
   Pos GetPos() const { return pos_; }
-  bool AtEof() const {
-    if (if_.has_value()) {
-      return if_->eof();
-    }
-    return cursor_ >= text_.size();
-  }
+  bool AtEof() const { return cursor_ >= contents_.size(); }
   char PeekCharOrDie() {
-    if (if_.has_value()) {
-      DCHECK(!if_->eof());
-      return if_->peek();
-    }
-    DCHECK_LT(cursor_, text_.size());
-    return text_[cursor_];
+    DCHECK_LT(cursor_, contents_.size());
+    return contents_[cursor_];
   }
   char PopCharOrDie() {
     char c = PeekCharOrDie();
@@ -116,10 +105,25 @@ class CharStream {
     return false;
   }
 
+  // Pops the longest run of characters satisfying `pred` and returns a view of
+  // it. The view is valid for the lifetime of the stream.
+  template <typename Pred>
+  std::string_view PopWhile(Pred pred) {
+    int64_t start = cursor_;
+    while (!AtEof() && pred(contents_[cursor_])) {
+      BumpPos(contents_[cursor_]);
+    }
+    return contents_.substr(start, cursor_ - start);
+  }
+
  private:
-  explicit CharStream(std::ifstream file_stream)
-      : if_(std::move(file_stream)) {}
-  explicit CharStream(std::string text) : text_(std::move(text)) {}
+  explicit CharStream(std::string text)
+      : text_(std::make_unique<std::string>(std::move(text))),
+        contents_(*text_) {}
+  CharStream(void* mapping, int64_t mapping_size)
+      : mapping_(mapping),
+        mapping_size_(mapping_size),
+        contents_(static_cast<const char*>(mapping), mapping_size) {}
 
   void Unget(char c) {
     cursor_--;
@@ -129,9 +133,6 @@ class CharStream {
     } else {
       pos_.colno--;
     }
-    if (if_.has_value()) {
-      if_->unget();
-    }
   }
 
   void BumpPos(char c) {
@@ -147,13 +148,13 @@ class CharStream {
 
   Pos pos_ = {0, 0};
 
-  // We have both ifstream mode and text mode data, we store both inline.
-
-  // ifstream mode
-  std::optional<std::ifstream> if_;
+  // The text is either owned (text mode) or a read-only mapping of a file.
+  // Either way `contents_` views it.
+  std::unique_ptr<std::string> text_;
+  void* mapping_ = nullptr;
+  int64_t mapping_size_ = 0;
+  std::string_view contents_;
 
-  // text mode
-  std::string text_;
   int64_t cursor_ = 0;
   int64_t last_colno_ = 0;
 };
@@ -19,9 +19,13 @@
 #include <string>
 #include <utility>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 
@@ -30,6 +34,8 @@ namespace netlist {
 namespace cell_lib {
 namespace {
 
+using ::absl_testing::StatusIs;
+
 TEST(LibParserTest, ScanSimple) {
   std::string text = "{}()";
   XLS_ASSERT_OK_AND_ASSIGN(auto cs, CharStream::FromText(text));
@@ -45,6 +51,36 @@ TEST(LibParserTest, ScanSimple) {
   EXPECT_TRUE(scanner.AtEof());
 }
 
+TEST(LibParserTest, ScanFromPath) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile temp_file,
+      TempFile::CreateWithContent("library (foo) {\n  area : 1.5e-3;\n}\n",
+                                  ".lib"));
+  XLS_ASSERT_OK_AND_ASSIGN(auto cs,
+                           CharStream::FromPath(temp_file.path().string()));
+  Scanner scanner(&cs);
+  XLS_ASSERT_OK_AND_ASSIGN(Token library, scanner.Pop());
+  EXPECT_EQ(library.payload(), "library");
+  EXPECT_EQ(scanner.Pop().value().kind(), TokenKind::kOpenParen);
+  EXPECT_EQ(scanner.Pop().value().payload(), "foo");
+  EXPECT_EQ(scanner.Pop().value().kind(), TokenKind::kCloseParen);
+  EXPECT_EQ(scanner.Pop().value().kind(), TokenKind::kOpenCurl);
+  XLS_ASSERT_OK_AND_ASSIGN(Token area, scanner.Pop());
+  EXPECT_EQ(area.payload(), "area");
+  EXPECT_EQ(area.pos().lineno, 1);
+  EXPECT_EQ(area.pos().colno, 2);
+  EXPECT_EQ(scanner.Pop().value().kind(), TokenKind::kColon);
+  EXPECT_EQ(scanner.Pop().value().payload(), "1.5e-3");
+  EXPECT_EQ(scanner.Pop().value().kind(), TokenKind::kSemi);
+  EXPECT_EQ(scanner.Pop().value().kind(), TokenKind::kCloseCurl);
+  EXPECT_TRUE(scanner.AtEof());
+}
+
+TEST(LibParserTest, ScanFromMissingPath) {
+  EXPECT_THAT(CharStream::FromPath("/does/not/exist.lib"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 // Helper that parses the given text as a library block and returns the
 // block structure.
 absl::StatusOr<std::unique_ptr<Block>> Parse(
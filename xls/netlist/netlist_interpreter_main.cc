@@ -15,10 +15,12 @@
 // Driver for NetlistInterpreter: loads a netlist from disk, feeds Value input
 // (taken from the command line) into it, and prints the result.
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
@@ -39,6 +41,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/netlist/cell_library.h"
+#include "xls/netlist/compiled_interpreter.h"
 #include "xls/netlist/function_extractor.h"
 #include "xls/netlist/interpreter.h"
 #include "xls/netlist/lib_parser.h"
@@ -50,6 +53,11 @@ ABSL_FLAG(std::string, cell_library, "",
           "Cell library to use for interpretation.");
 ABSL_FLAG(std::string, cell_library_proto, "",
           "Preprocessed cell library proto to use for interpretation.");
+ABSL_FLAG(bool, compiled, false,
+          "Compile the module to a flat instruction list before evaluating it "
+          "rather than interpreting it cell by cell. Much faster for large "
+          "netlists, but does not support --dump_cells or cells with state "
+          "tables.");
 // TODO(rspringer): Eliminate the need for this flag.
 // This one is a hidden temporary flag until we can properly handle cells
 // with state_function attributes (e.g., some latches).
@@ -94,7 +102,8 @@ static absl::Status RealMain(const std::string& netlist_path,
                              const std::string& module_name,
                              absl::Span<const std::string> inputs,
                              const std::string& output_type_string,
-                             absl::Span<const std::string> dump_cells) {
+                             absl::Span<const std::string> dump_cells,
+                             bool compiled) {
   XLS_ASSIGN_OR_RETURN(
       netlist::CellLibrary cell_library,
       GetCellLibrary(cell_library_path, cell_library_proto_path));
@@ -126,22 +135,46 @@ static absl::Status RealMain(const std::string& netlist_path,
   }
   input_bits = bits_ops::Reverse(input_bits);
 
-  netlist::NetRef2Value input_nets;
   const std::vector<netlist::rtl::NetRef>& module_inputs = module->inputs();
   XLS_RET_CHECK(module_inputs.size() == input_bits.bit_count());
 
-  for (int i = 0; i < module->inputs().size(); i++) {
-    const netlist::rtl::NetRef in = module_inputs[i];
-    input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
-  }
-
-  netlist::Interpreter interpreter(netlist.get());
-  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
-                                             module, input_nets, dump_cells));
-
-  BitsRope rope(output_nets.size());
-  for (const netlist::rtl::NetRef ref : module->outputs()) {
-    rope.push_back(output_nets[ref]);
+  BitsRope rope(module->outputs().size());
+  if (compiled) {
+    if (absl::c_any_of(dump_cells,
+                       [](const std::string& cell) { return !cell.empty(); })) {
+      return absl::InvalidArgumentError(
+          "--dump_cells is not supported with --compiled");
+    }
+    XLS_ASSIGN_OR_RETURN(
+        netlist::CompiledModule compiled_module,
+        netlist::CompiledModule::Create(netlist.get(), module));
+    // Every lane evaluates the same input; the result is read from lane 0.
+    std::vector<uint64_t> input_words;
+    input_words.reserve(module_inputs.size());
+    for (const netlist::rtl::NetRef in : module_inputs) {
+      input_words.push_back(
+          input_bits.Get(module->GetInputPortOffset(in->name())) ? ~uint64_t{0}
+                                                                 : 0);
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<uint64_t> output_words,
+                         compiled_module.Evaluate(input_words));
+    for (uint64_t word : output_words) {
+      rope.push_back((word & 1) != 0);
+    }
+  } else {
+    netlist::NetRef2Value input_nets;
+    for (int i = 0; i < module->inputs().size(); i++) {
+      const netlist::rtl::NetRef in = module_inputs[i];
+      input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
+    }
+
+    netlist::Interpreter interpreter(netlist.get());
+    XLS_ASSIGN_OR_RETURN(
+        auto output_nets,
+        interpreter.InterpretModule(module, input_nets, dump_cells));
+    for (const netlist::rtl::NetRef ref : module->outputs()) {
+      rope.push_back(output_nets[ref]);
+    }
   }
   Bits output_bits = rope.Build();
 
@@ -189,5 +222,6 @@ int main(int argc, char* argv[]) {
 
   return xls::ExitStatus(xls::RealMain(netlist_path, cell_library_path,
                                        cell_library_proto_path, module_name,
-                                       inputs, output_type, dump_cells));
+                                       inputs, output_type, dump_cells,
+                                       absl::GetFlag(FLAGS_compiled)));
 }
@@ -26,7 +26,9 @@ NETLIST_INTERPRETER_MAIN = runfiles.get_path(
 CELL_LIBRARY = runfiles.get_path(XLS_NETLIST + 'testdata/simple_cell.lib')
 
 
-def run_netlist_interpreter(netlist, module, input_data, output_type):
+def run_netlist_interpreter(
+    netlist, module, input_data, output_type, compiled=False
+):
   result = subprocess.check_output([
       NETLIST_INTERPRETER_MAIN,
       '--netlist=' + runfiles.get_path(XLS_NETLIST + netlist),
@@ -34,6 +36,7 @@ def run_netlist_interpreter(netlist, module, input_data, output_type):
       '--input=' + input_data,
       '--output_type=' + output_type,
       '--cell_library=' + CELL_LIBRARY,
+      '--compiled=' + str(compiled).lower(),
   ])
   return result.decode('utf-8').strip()
 
@@ -55,6 +58,22 @@ class NetlistTranspilerMainTest(test_base.TestCase):
     )
     self.assertEqual(res, 'bits[8]:0xaa')
 
+  def test_sqrt_compiled(self):
+    res = run_netlist_interpreter(
+        'testdata/isqrt.v', 'isqrt', 'bits[16]:100', 'bits[8]', compiled=True
+    )
+    self.assertEqual(res, 'bits[8]:0xa')
+
+  def test_ifte_compiled(self):
+    res = run_netlist_interpreter(
+        'testdata/ifte.v',
+        'ifte',
+        'bits[1]:0;bits[8]:0xaa;bits[8]:0xbb',
+        'bits[8]',
+        compiled=True,
+    )
+    self.assertEqual(res, 'bits[8]:0xbb')
+
 
 if __name__ == '__main__':
   test_base.main()
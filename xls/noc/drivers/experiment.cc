@@ -15,7 +15,9 @@
 #include "xls/noc/drivers/experiment.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,11 +26,16 @@
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
+#include "google/protobuf/text_format.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
@@ -141,22 +148,42 @@ absl::Status ExperimentMetrics::DebugDump() const {
   return absl::OkStatus();
 }
 
-absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
-    const ExperimentConfig& experiment_config,
-    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
-    const {
-  // Build and assign simulation objects.
-  NetworkManager graph;
-  NocParameters params;
+absl::StatusOr<std::unique_ptr<ExperimentTopology>> BuildExperimentTopology(
+    const NetworkConfigProto& network_config,
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder) {
+  auto topology = std::make_unique<ExperimentTopology>();
 
+  // Build and assign simulation objects.
   XLS_RETURN_IF_ERROR(BuildNetworkGraphFromProto(
-      experiment_config.GetNetworkConfig(), &graph, &params));
+      network_config, &topology->graph, &topology->params));
 
   // Create global routing table.
   XLS_ASSIGN_OR_RETURN(
-      DistributedRoutingTable routing_table,
+      topology->routing_table,
       distributed_routing_table_builder.BuildNetworkRoutingTables(
-          graph.GetNetworkIds()[0], graph, params));
+          topology->graph.GetNetworkIds()[0], topology->graph,
+          topology->params));
+
+  return topology;
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
+    const ExperimentConfig& experiment_config,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
+    const {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ExperimentTopology> topology,
+      BuildExperimentTopology(experiment_config.GetNetworkConfig(),
+                              distributed_routing_table_builder));
+  return RunExperiment(experiment_config, *topology);
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
+    const ExperimentConfig& experiment_config,
+    ExperimentTopology& topology) const {
+  NetworkManager& graph = topology.graph;
+  NocParameters& params = topology.params;
+  DistributedRoutingTable& routing_table = topology.routing_table;
 
   // Build traffic model.
   RandomNumberInterface rnd;
@@ -332,4 +359,68 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   return experiment_data;
 }
 
+absl::Status Experiment::RunSteps(
+    int64_t max_concurrency, const StepCallback& callback,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
+    const {
+  // Build the configs up front and share the graph and routing tables
+  // between steps whose network config is identical; sweeps that only
+  // mutate the traffic then build the topology once.
+  int64_t step_count = GetStepCount();
+  std::vector<ExperimentConfig> configs;
+  std::vector<ExperimentTopology*> step_topologies;
+  configs.reserve(step_count);
+  step_topologies.reserve(step_count);
+  absl::flat_hash_map<std::string, std::unique_ptr<ExperimentTopology>>
+      topologies;
+  for (int64_t step = 0; step < step_count; ++step) {
+    XLS_ASSIGN_OR_RETURN(ExperimentConfig config, GetConfigForStep(step));
+    std::string key;
+    XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(
+        config.GetNetworkConfig(), &key));
+    std::unique_ptr<ExperimentTopology>& topology = topologies[key];
+    if (topology == nullptr) {
+      XLS_ASSIGN_OR_RETURN(
+          topology, BuildExperimentTopology(config.GetNetworkConfig(),
+                                            distributed_routing_table_builder));
+    }
+    configs.push_back(std::move(config));
+    step_topologies.push_back(topology.get());
+  }
+  VLOG(1) << absl::StreamFormat("Running %d steps over %d topologies.",
+                                step_count, topologies.size());
+
+  // The simulator only reads the shared topology, so the steps can run
+  // concurrently. Results are handed to the callback as they complete.
+  absl::Mutex mutex;
+  absl::Status status = absl::OkStatus();
+  std::atomic<int64_t> next_step = 0;
+  auto worker = [&]() {
+    for (int64_t step = next_step.fetch_add(1); step < step_count;
+         step = next_step.fetch_add(1)) {
+      absl::StatusOr<ExperimentData> data =
+          runner_.RunExperiment(configs[step], *step_topologies[step]);
+      absl::MutexLock lock(&mutex);
+      if (!status.ok()) {
+        return;
+      }
+      status = data.ok() ? callback(step, *std::move(data)) : data.status();
+      if (!status.ok()) {
+        return;
+      }
+    }
+  };
+  int64_t thread_count = std::clamp<int64_t>(
+      max_concurrency > 0 ? max_concurrency : AvailableCPUs(), 1, step_count);
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (auto& t : threads) {
+    t->Join();
+  }
+  return status;
+}
+
 }  // namespace xls::noc
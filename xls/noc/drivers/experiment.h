@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -35,6 +36,8 @@
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/traffic_description.h"
 
 // This file contains classes used to construct different
@@ -215,6 +218,22 @@ struct ExperimentData {
   ExperimentInfo info;
 };
 
+// The network graph, parameters, and routing tables built from a network
+// config. The simulator only reads these, so a single topology can be shared
+// by concurrently running steps whose network config is identical.
+//
+// Not movable as the routing table points into the graph and parameters.
+struct ExperimentTopology {
+  NetworkManager graph;
+  NocParameters params;
+  DistributedRoutingTable routing_table;
+};
+
+// Builds the topology for the given network config.
+absl::StatusOr<std::unique_ptr<ExperimentTopology>> BuildExperimentTopology(
+    const NetworkConfigProto& network_config,
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder);
+
 // Class to setup and run a single step of the experiment,
 // including the setup and initialization of the traffic model.
 class ExperimentRunner {
@@ -227,6 +246,11 @@ class ExperimentRunner {
       DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
           DistributedRoutingTableBuilderForTrees()) const;
 
+  // Runs the experiment on a prebuilt topology of the config's network.
+  absl::StatusOr<ExperimentData> RunExperiment(
+      const ExperimentConfig& experiment_config,
+      ExperimentTopology& topology) const;
+
   ExperimentRunner& SetSimulationCycleCount(int64_t count) {
     CHECK_GE(count, 0);
     total_simulation_cycle_count_ = count;
@@ -293,6 +317,22 @@ class Experiment {
                                 std::move(distributed_routing_table_builder));
   }
 
+  // Called with the data of each step as soon as the step completes. Calls
+  // are serialized but arrive in completion order rather than step order.
+  // Returning an error stops the sweep.
+  using StepCallback =
+      std::function<absl::Status(int64_t step, ExperimentData data)>;
+
+  // Runs every step, up to `max_concurrency` at a time (or one per CPU if
+  // non-positive), and streams the results to `callback`.
+  //
+  // The topology is built once for each distinct network config in the
+  // sweep and shared by all steps using it.
+  absl::Status RunSteps(
+      int64_t max_concurrency, const StepCallback& callback,
+      DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
+          DistributedRoutingTableBuilderForTrees()) const;
+
   // Get the configuration for step N.
   absl::StatusOr<ExperimentConfig> GetConfigForStep(int64_t step) const {
     XLS_RET_CHECK(step >= 0 && step < GetStepCount());
@@ -15,13 +15,18 @@
 #include "xls/noc/drivers/sample_experiments.h"
 
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/btree_map.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
 #include "xls/noc/drivers/experiment.h"
@@ -32,6 +37,9 @@
 namespace xls::noc {
 namespace {
 
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+
 TEST(SampleExperimentsTest, SimpleVCExperiment) {
   ExperimentFactory experiment_factory;
   XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
@@ -220,5 +228,53 @@ TEST(SampleExperimentsTest, AggregateTreeTest) {
   }
 }
 
+TEST(SampleExperimentsTest, RunStepsMatchesRunStep) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+
+  int64_t step_count = experiment.GetStepCount();
+  std::vector<std::optional<ExperimentData>> experiment_data(step_count);
+  XLS_ASSERT_OK(experiment.RunSteps(
+      /*max_concurrency=*/2, [&](int64_t step, ExperimentData data) {
+        EXPECT_FALSE(experiment_data.at(step).has_value());
+        experiment_data.at(step) = std::move(data);
+        return absl::OkStatus();
+      }));
+
+  for (int64_t i = 0; i < step_count; ++i) {
+    ASSERT_TRUE(experiment_data.at(i).has_value());
+    XLS_ASSERT_OK_AND_ASSIGN(ExperimentData expected, experiment.RunStep(i));
+    for (std::string_view metric :
+         {"Flow:flow_0:TrafficRateInMiBps", "Flow:flow_1:TrafficRateInMiBps",
+          "Sink:RecvPort0:VC:0:TrafficRateInMiBps"}) {
+      XLS_ASSERT_OK_AND_ASSIGN(double expected_rate,
+                               expected.metrics.GetFloatMetric(metric));
+      EXPECT_THAT(experiment_data.at(i)->metrics.GetFloatMetric(metric),
+                  IsOkAndHolds(expected_rate))
+          << "step " << i << ", " << metric;
+    }
+  }
+}
+
+TEST(SampleExperimentsTest, RunStepsStopsOnCallbackError) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+
+  int64_t calls = 0;
+  EXPECT_THAT(experiment.RunSteps(/*max_concurrency=*/1,
+                                  [&](int64_t step, ExperimentData data) {
+                                    ++calls;
+                                    return absl::AbortedError("stop");
+                                  }),
+              StatusIs(absl::StatusCode::kAborted));
+  EXPECT_EQ(calls, 1);
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -279,6 +279,74 @@ void DistributedRoutingTable::AllocateTableForNetwork(NetworkId network_id,
   routing_tables_[network_index].resize(component_count);
 }
 
+absl::Status DistributedRoutingTable::BuildIndexedRoutingTables(
+    NetworkId network_id) {
+  int64_t network_index = network_id.id();
+  if (indexed_routing_tables_.size() <= network_index) {
+    indexed_routing_tables_.resize(network_index + 1);
+  }
+  std::vector<IndexedRouterRoutingTable>& indexed_tables =
+      indexed_routing_tables_[network_index];
+  indexed_tables.clear();
+  indexed_tables.resize(routing_tables_.at(network_index).size());
+
+  int64_t destination_count = sink_indices_.NetworkComponentCount();
+  const Network& network = network_manager_->GetNetwork(network_id);
+  for (const NetworkComponentId& nc_id : network.GetNetworkComponentIds()) {
+    const NetworkComponent& nc = network.GetNetworkComponent(nc_id);
+    if (nc.kind() != NetworkComponentKind::kRouter) {
+      continue;
+    }
+    const RouterRoutingTable& table = GetRoutingTable(nc_id);
+    IndexedRouterRoutingTable& indexed_table = indexed_tables.at(nc_id.id());
+    indexed_table.destination_count = destination_count;
+
+    // Number the input vcs, one per vc slot of the routing table.
+    int64_t input_port_count = nc.GetInputPortIds().size();
+    std::vector<PortId> input_ports(input_port_count);
+    indexed_table.input_vc_offset.assign(1, 0);
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          input_ports[i],
+          port_indices_.GetPortByIndex(nc_id, PortDirection::kInput, i));
+      int64_t port_local_id = input_ports[i].id();
+      int64_t vc_count = port_local_id < table.routes.size()
+                             ? table.routes[port_local_id].size()
+                             : 0;
+      indexed_table.input_vc_offset.push_back(
+          indexed_table.input_vc_offset.back() + vc_count);
+    }
+    indexed_table.routes.assign(
+        indexed_table.input_vc_offset.back() * destination_count,
+        PortIndexAndVCIndex{-1, -1});
+
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      int64_t vc_count = indexed_table.input_vc_offset[i + 1] -
+                         indexed_table.input_vc_offset[i];
+      for (int64_t vc = 0; vc < vc_count; ++vc) {
+        for (const auto& [destination_index, hop] :
+             table.routes[input_ports[i].id()][vc]) {
+          XLS_RET_CHECK(destination_index >= 0 &&
+                        destination_index < destination_count);
+          PortIndexAndVCIndex& entry = indexed_table.routes
+              [(indexed_table.input_vc_offset[i] + vc) * destination_count +
+               destination_index];
+          // As in GetRouterOutputPortByIndex, the first route listed wins.
+          if (entry.port_index_ != -1) {
+            continue;
+          }
+          XLS_ASSIGN_OR_RETURN(
+              int64_t output_port_index,
+              port_indices_.GetPortIndex(hop.port_id_, PortDirection::kOutput));
+          entry = PortIndexAndVCIndex{output_port_index, hop.vc_index_};
+        }
+      }
+    }
+  }
+
+  return absl::OkStatus();
+}
+
 absl::Status DistributedRoutingTableBuilderBase::BuildNetworkInterfaceIndices(
     NetworkId network_id, DistributedRoutingTable* routing_table) {
   NetworkComponentIndexMapBuilder source_index_builder;
@@ -372,6 +440,7 @@ DistributedRoutingTableBuilderForTrees::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(routing_table.BuildIndexedRoutingTables(network_id));
 
   return routing_table;
 }
@@ -501,6 +570,7 @@ DistributedRoutingTableBuilderForMultiplePaths::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(routing_table.BuildIndexedRoutingTables(network_id));
 
   return routing_table;
 }
@@ -74,6 +74,28 @@ class DistributedRoutingTable {
     std::vector<std::vector<PortRoutingList>> routes;
   };
 
+  // A router's routing table compiled to port and vc indices so that a route
+  // is found with a single array access.
+  //
+  // Input vcs are numbered consecutively in input port index order, and the
+  // output for a flit arriving on input vc i destined to sink index d is
+  //   routes[i * destination_count + d].
+  // Entries without a route have a port_index_ of -1.
+  struct IndexedRouterRoutingTable {
+    int64_t destination_count = 0;
+    std::vector<int64_t> input_vc_offset;
+    std::vector<PortIndexAndVCIndex> routes;
+
+    // Returns the output port index and vc for a flit on the given input port
+    // index and vc destined to destination_index.
+    PortIndexAndVCIndex GetOutput(int64_t port_index, int64_t vc_index,
+                                  int64_t destination_index) const {
+      return routes[(input_vc_offset[port_index] + vc_index) *
+                        destination_count +
+                    destination_index];
+    }
+  };
+
   // Returns route to destination from a particular source network interface
   // to a sink network interface.
   //
@@ -107,8 +129,14 @@ class DistributedRoutingTable {
   absl::StatusOr<PortAndVCIndex> GetRouterOutputPortByIndex(
       PortAndVCIndex from, int64_t destination_index);
 
-  // TODO(tedhong): 2020-01-25 Add indexer for input/output ports of a router
-  //                          and support routing directly via indices.
+  // Returns the indexed routing table of a router.
+  //
+  // The indexed tables are built along with the routing tables, so lookups
+  // are read-only.
+  const IndexedRouterRoutingTable& GetIndexedRoutingTable(
+      NetworkComponentId nc_id) const {
+    return indexed_routing_tables_[nc_id.network()][nc_id.id()];
+  }
 
   // Returns mapping of vc params to local indicies.
   const VirtualChannelIndexMap& GetVirtualChannelIndices() {
@@ -141,6 +169,10 @@ class DistributedRoutingTable {
     return routing_tables_[nc_id.network()][nc_id.id()];
   }
 
+  // Compiles the routing tables of the routers in the network into
+  // indexed_routing_tables_. Called once the routing tables are complete.
+  absl::Status BuildIndexedRoutingTables(NetworkId network_id);
+
   // Get possible routes associated with given port and vc.
   PortRoutingList& GetRoutingList(PortAndVCIndex port_and_vc) {
     NetworkComponentId nc_id = port_and_vc.port_id_.GetNetworkComponentId();
@@ -164,6 +196,9 @@ class DistributedRoutingTable {
   // ie. routing table for ComponentId id is
   //  routing_tables_[id.network()][id.id()]
   std::vector<std::vector<RouterRoutingTable>> routing_tables_;
+
+  // Indexed routing tables, laid out as routing_tables_.
+  std::vector<std::vector<IndexedRouterRoutingTable>> indexed_routing_tables_;
 };
 
 // Abstract base class for distributed routing table builder.
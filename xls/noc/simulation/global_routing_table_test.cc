@@ -23,6 +23,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -30,6 +31,7 @@
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/config/network_config_proto_builder.h"
 #include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/network_graph.h"
 #include "xls/noc/simulation/network_graph_builder.h"
 #include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/sample_network_graphs.h"
@@ -51,6 +53,48 @@ void LogRoute(std::string_view route_name,
   }
 }
 
+// Checks that the indexed routing table of every router agrees with
+// GetRouterOutputPortByIndex.
+void ExpectIndexedRoutesMatch(DistributedRoutingTable& routing_table,
+                              const NetworkManager& graph,
+                              const NocParameters& params) {
+  const Network& network = graph.GetNetwork(graph.GetNetworkIds()[0]);
+  int64_t destination_count =
+      routing_table.GetSinkIndices().NetworkComponentCount();
+  for (NetworkComponentId nc_id : network.GetNetworkComponentIds()) {
+    const NetworkComponent& nc = network.GetNetworkComponent(nc_id);
+    if (nc.kind() != NetworkComponentKind::kRouter) {
+      continue;
+    }
+    const DistributedRoutingTable::IndexedRouterRoutingTable& indexed =
+        routing_table.GetIndexedRoutingTable(nc_id);
+    EXPECT_EQ(indexed.destination_count, destination_count);
+    for (int64_t i = 0; i < nc.GetInputPortIds().size(); ++i) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          PortId port_id, routing_table.GetPortIndices().GetPortByIndex(
+                              nc_id, PortDirection::kInput, i));
+      XLS_ASSERT_OK_AND_ASSIGN(PortParam port_param,
+                               params.GetPortParam(port_id));
+      for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
+        for (int64_t d = 0; d < destination_count; ++d) {
+          absl::StatusOr<PortAndVCIndex> expected =
+              routing_table.GetRouterOutputPortByIndex(
+                  PortAndVCIndex{port_id, vc}, d);
+          PortIndexAndVCIndex actual = indexed.GetOutput(i, vc, d);
+          if (!expected.ok()) {
+            EXPECT_EQ(actual.port_index_, -1);
+            continue;
+          }
+          EXPECT_THAT(routing_table.GetPortIndices().GetPortIndex(
+                          expected->port_id_, PortDirection::kOutput),
+                      absl_testing::IsOkAndHolds(actual.port_index_));
+          EXPECT_EQ(actual.vc_index_, expected->vc_index_);
+        }
+      }
+    }
+  }
+}
+
 TEST(GlobalRoutingTableTest, Index) {
   LOG(INFO) << "Setting up network ...";
   NetworkConfigProtoBuilder builder("Test");
@@ -220,6 +264,8 @@ TEST(GlobalRoutingTableTest, Index) {
   EXPECT_EQ(route00[0], sendport0);
   EXPECT_EQ(route00[2], routera_nc);
   EXPECT_EQ(route00[4], recvport0);
+
+  ExpectIndexedRoutesMatch(routing_table, graph, params);
 }
 
 TEST(GlobalRoutingTableTest, RouterLoop) {
@@ -386,6 +432,8 @@ TEST(GlobalRoutingTableTest, MultiplePathsBetweenRouters) {
   EXPECT_THAT(route11, ::testing::ElementsAre(sendport1, linkai1_id, routera_id,
                                               linkao1_id, routerb_id,
                                               linkbo1_id, recvport1));
+
+  ExpectIndexedRoutesMatch(routing_table, graph, params);
 }
 
 TEST(GlobalRoutingTableTest, MultiplePathsBetweenRoutersWithLoop0) {
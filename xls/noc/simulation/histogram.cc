@@ -0,0 +1,115 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "xls/noc/simulation/histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/ret_check.h"
+
+namespace xls::noc {
+
+absl::StatusOr<LogLinearHistogram> LogLinearHistogram::Create(
+    int64_t max_value, int64_t sub_bucket_bits) {
+  if (max_value < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Histogram max value %d is negative.", max_value));
+  }
+  if (sub_bucket_bits < 1 || sub_bucket_bits > 20) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Histogram sub-bucket bits %d is not in [1, 20].", sub_bucket_bits));
+  }
+  return LogLinearHistogram(max_value, sub_bucket_bits);
+}
+
+LogLinearHistogram::LogLinearHistogram(int64_t max_value,
+                                       int64_t sub_bucket_bits)
+    : max_value_(max_value),
+      sub_bucket_bits_(sub_bucket_bits),
+      sub_bucket_count_(int64_t{1} << sub_bucket_bits) {
+  counts_.resize(GetBucketIndex(max_value) + 1, 0);
+}
+
+int64_t LogLinearHistogram::GetBucketIndex(int64_t value) const {
+  if (value < sub_bucket_count_) {
+    return value;
+  }
+  // value is in [2^k, 2^(k+1)) with k >= sub_bucket_bits_; its bucket is
+  // given by its top sub_bucket_bits_ bits.
+  int64_t k = absl::bit_width(static_cast<uint64_t>(value)) - 1;
+  int64_t shift = k - sub_bucket_bits_ + 1;
+  int64_t half_count = sub_bucket_count_ / 2;
+  return sub_bucket_count_ + (k - sub_bucket_bits_) * half_count +
+         ((value >> shift) - half_count);
+}
+
+int64_t LogLinearHistogram::GetBucketHighestValue(int64_t index) const {
+  if (index < sub_bucket_count_) {
+    return index;
+  }
+  int64_t half_count = sub_bucket_count_ / 2;
+  int64_t shift = (index - sub_bucket_count_) / half_count + 1;
+  int64_t sub_bucket = half_count + (index - sub_bucket_count_) % half_count;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+int64_t LogLinearHistogram::GetValueAtPercentile(double percentile) const {
+  if (total_count_ == 0) {
+    return 0;
+  }
+  int64_t target = static_cast<int64_t>(
+      std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 *
+                static_cast<double>(total_count_)));
+  target = std::max<int64_t>(target, 1);
+
+  int64_t seen = 0;
+  for (int64_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= target) {
+      return std::clamp(GetBucketHighestValue(i), min_, max_);
+    }
+  }
+  return max_;
+}
+
+absl::Status LogLinearHistogram::Merge(const LogLinearHistogram& other) {
+  XLS_RET_CHECK_EQ(max_value_, other.max_value_);
+  XLS_RET_CHECK_EQ(sub_bucket_bits_, other.sub_bucket_bits_);
+  for (int64_t i = 0; i < counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  total_count_ += other.total_count_;
+  overflow_count_ += other.overflow_count_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+  return absl::OkStatus();
+}
+
+void LogLinearHistogram::Reset() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  total_count_ = 0;
+  overflow_count_ = 0;
+  sum_ = 0;
+  min_ = std::numeric_limits<int64_t>::max();
+  max_ = std::numeric_limits<int64_t>::min();
+}
+
+}  // namespace xls::noc
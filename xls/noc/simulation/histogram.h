@@ -0,0 +1,109 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef XLS_NOC_SIMULATION_HISTOGRAM_H_
+#define XLS_NOC_SIMULATION_HISTOGRAM_H_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+namespace xls::noc {
+
+// A fixed-memory histogram of non-negative integer values (ex. latencies in
+// cycles), in the style of HdrHistogram.
+//
+// Values below 2^sub_bucket_bits are counted exactly. Each larger power of two
+// range [2^k, 2^(k+1)) is split into 2^(sub_bucket_bits-1) equally sized
+// buckets, so values are reported with a relative error below
+// 2^-(sub_bucket_bits-1).
+//
+// All memory is allocated on creation; Record() does not allocate.
+class LogLinearHistogram {
+ public:
+  // Creates a histogram for values in [0, max_value]. Larger values are
+  // recorded as max_value and counted by GetOverflowCount().
+  static absl::StatusOr<LogLinearHistogram> Create(int64_t max_value,
+                                                   int64_t sub_bucket_bits = 5);
+
+  // Records count occurrences of value.
+  void Record(int64_t value, int64_t count = 1) {
+    if (value > max_value_) {
+      overflow_count_ += count;
+      value = max_value_;
+    }
+    if (value < 0) {
+      value = 0;
+    }
+    counts_[GetBucketIndex(value)] += count;
+    total_count_ += count;
+    sum_ += value * count;
+    if (value < min_) {
+      min_ = value;
+    }
+    if (value > max_) {
+      max_ = value;
+    }
+  }
+
+  // Returns the smallest recorded value such that at least percentile% of the
+  // recorded values are less than or equal to it, up to the histogram's
+  // precision. Returns 0 if nothing was recorded.
+  int64_t GetValueAtPercentile(double percentile) const;
+
+  int64_t GetCount() const { return total_count_; }
+  int64_t GetOverflowCount() const { return overflow_count_; }
+  int64_t GetMin() const { return total_count_ == 0 ? 0 : min_; }
+  int64_t GetMax() const { return total_count_ == 0 ? 0 : max_; }
+  double GetMean() const {
+    return total_count_ == 0 ? 0.0
+                             : static_cast<double>(sum_) /
+                                   static_cast<double>(total_count_);
+  }
+
+  int64_t GetMaxValue() const { return max_value_; }
+  int64_t GetBucketCount() const { return counts_.size(); }
+
+  // Adds the values recorded by other, which must have been created with the
+  // same parameters.
+  absl::Status Merge(const LogLinearHistogram& other);
+
+  // Forgets all recorded values.
+  void Reset();
+
+ private:
+  LogLinearHistogram(int64_t max_value, int64_t sub_bucket_bits);
+
+  int64_t GetBucketIndex(int64_t value) const;
+
+  // Returns the largest value counted by the given bucket.
+  int64_t GetBucketHighestValue(int64_t index) const;
+
+  int64_t max_value_;
+  int64_t sub_bucket_bits_;
+  int64_t sub_bucket_count_;
+
+  int64_t total_count_ = 0;
+  int64_t overflow_count_ = 0;
+  int64_t sum_ = 0;
+  int64_t min_ = std::numeric_limits<int64_t>::max();
+  int64_t max_ = std::numeric_limits<int64_t>::min();
+  std::vector<int64_t> counts_;
+};
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_HISTOGRAM_H_
@@ -0,0 +1,107 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "xls/noc/simulation/histogram.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls::noc {
+namespace {
+
+using ::absl_testing::StatusIs;
+
+TEST(LogLinearHistogramTest, SmallValuesAreExact) {
+  XLS_ASSERT_OK_AND_ASSIGN(LogLinearHistogram histogram,
+                           LogLinearHistogram::Create(/*max_value=*/100,
+                                                      /*sub_bucket_bits=*/4));
+  for (int64_t i = 1; i <= 10; ++i) {
+    histogram.Record(i);
+  }
+  EXPECT_EQ(histogram.GetCount(), 10);
+  EXPECT_EQ(histogram.GetMin(), 1);
+  EXPECT_EQ(histogram.GetMax(), 10);
+  EXPECT_DOUBLE_EQ(histogram.GetMean(), 5.5);
+  EXPECT_EQ(histogram.GetValueAtPercentile(0), 1);
+  EXPECT_EQ(histogram.GetValueAtPercentile(50), 5);
+  EXPECT_EQ(histogram.GetValueAtPercentile(90), 9);
+  EXPECT_EQ(histogram.GetValueAtPercentile(100), 10);
+}
+
+TEST(LogLinearHistogramTest, LargeValuesHaveBoundedError) {
+  int64_t sub_bucket_bits = 5;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      LogLinearHistogram histogram,
+      LogLinearHistogram::Create(/*max_value=*/int64_t{1} << 30,
+                                 sub_bucket_bits));
+  // Memory is logarithmic in the value range.
+  EXPECT_LT(histogram.GetBucketCount(), 32 * 16);
+
+  for (int64_t i = 1; i <= 100'000; ++i) {
+    histogram.Record(i * 37);
+  }
+  double max_error = 1.0 / (1 << (sub_bucket_bits - 1));
+  for (double percentile : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9}) {
+    double exact = percentile / 100.0 * 100'000 * 37;
+    double reported = histogram.GetValueAtPercentile(percentile);
+    EXPECT_GE(reported, exact * (1.0 - max_error)) << percentile;
+    EXPECT_LE(reported, exact * (1.0 + max_error)) << percentile;
+  }
+  EXPECT_EQ(histogram.GetValueAtPercentile(100), 100'000 * 37);
+}
+
+TEST(LogLinearHistogramTest, OverflowIsClamped) {
+  XLS_ASSERT_OK_AND_ASSIGN(LogLinearHistogram histogram,
+                           LogLinearHistogram::Create(/*max_value=*/1000));
+  histogram.Record(5);
+  histogram.Record(5000, /*count=*/3);
+  EXPECT_EQ(histogram.GetCount(), 4);
+  EXPECT_EQ(histogram.GetOverflowCount(), 3);
+  EXPECT_EQ(histogram.GetMax(), 1000);
+  EXPECT_EQ(histogram.GetValueAtPercentile(99), 1000);
+}
+
+TEST(LogLinearHistogramTest, MergeAndReset) {
+  XLS_ASSERT_OK_AND_ASSIGN(LogLinearHistogram a,
+                           LogLinearHistogram::Create(/*max_value=*/1000));
+  XLS_ASSERT_OK_AND_ASSIGN(LogLinearHistogram b,
+                           LogLinearHistogram::Create(/*max_value=*/1000));
+  a.Record(1);
+  b.Record(3);
+  XLS_ASSERT_OK(a.Merge(b));
+  EXPECT_EQ(a.GetCount(), 2);
+  EXPECT_EQ(a.GetMin(), 1);
+  EXPECT_EQ(a.GetMax(), 3);
+
+  XLS_ASSERT_OK_AND_ASSIGN(LogLinearHistogram c,
+                           LogLinearHistogram::Create(/*max_value=*/10));
+  EXPECT_FALSE(a.Merge(c).ok());
+
+  a.Reset();
+  EXPECT_EQ(a.GetCount(), 0);
+  EXPECT_EQ(a.GetValueAtPercentile(50), 0);
+}
+
+TEST(LogLinearHistogramTest, InvalidParameters) {
+  EXPECT_THAT(LogLinearHistogram::Create(-1),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(LogLinearHistogram::Create(100, /*sub_bucket_bits=*/0),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls::noc
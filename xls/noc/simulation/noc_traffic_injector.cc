@@ -16,7 +16,12 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <limits>
 #include <memory>
+#include <queue>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <variant>
@@ -25,8 +30,11 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
 #include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
@@ -49,41 +57,63 @@ absl::Status NocTrafficInjector::RunCycle() {
 
   ++cycle_;
 
+  if (batched_) {
+    if (cycle_ >= schedule_end_cycle_) {
+      GenerateInjectionSchedule(cycle_ + schedule_chunk_cycles_);
+    }
+    for (int64_t i = 0; i < flow_schedules_.size(); ++i) {
+      const std::vector<int64_t>& schedule = flow_schedules_[i];
+      int64_t& position = flow_schedule_positions_[i];
+      batched_packets_.clear();
+      while (position < schedule.size() && schedule[position] <= cycle_) {
+        batched_packets_.push_back(flow_packet_prototypes_[i]);
+        ++position;
+      }
+      XLS_RETURN_IF_ERROR(InjectPackets(i, absl::MakeSpan(batched_packets_)));
+    }
+    return absl::OkStatus();
+  }
+
   for (int64_t i = 0; i < traffic_models_.size(); ++i) {
     // Retrieve packets.
     std::vector<DataPacket> packets =
         traffic_models_[i]->GetNewCyclePackets(cycle_);
+    XLS_RETURN_IF_ERROR(InjectPackets(i, absl::MakeSpan(packets)));
+  }
 
-    this->traffic_model_monitor_[i].AcceptNewPackets(absl::MakeSpan(packets),
-                                                     cycle_);
-
-    // Convert to flits, and sequence them for injection.
-    int64_t source_index = flows_index_to_sources_index_map_.at(i);
-    NetworkComponentId source = source_network_interfaces_.at(source_index);
-
-    // All packets are depacketized and converted to flits on a single cycle.
-    // Those flits are injected into the simulator.  The simulator is
-    // expected to have an infinite queue and will send a single flit per
-    // cycle in the order in which they are received..
-    //
-    // TODO(tedhong): 2021-06-29 - Model a fixed queue between the depacketizer
-    //                            and the network interface.
-    //
-    // TODO(tedhong): 2021-06-29 - Model priority between different flows.
-    //                             so packets are not handled and sent in-order.
-
-    DePacketizer& depacketizer = depacketizers_[source_index];
-    for (DataPacket& p : packets) {
-      XLS_RET_CHECK_OK(depacketizer.AcceptNewPacket(p));
-
-      while (!depacketizer.IsIdle()) {
-        XLS_ASSIGN_OR_RETURN(DataFlit flit, depacketizer.ComputeNextFlit());
-        // Add information defining the cycle iteration the flit is injected
-        // into the network.
-        TimedDataFlitInfo info{cycle_};
-        TimedDataFlit timed_data_flit{cycle_, flit, info};
-        XLS_RET_CHECK_OK(simulator_->SendFlitAtTime(timed_data_flit, source));
-      }
+  return absl::OkStatus();
+}
+
+absl::Status NocTrafficInjector::InjectPackets(int64_t flow_index,
+                                               absl::Span<DataPacket> packets) {
+  this->traffic_model_monitor_[flow_index].AcceptNewPackets(packets, cycle_);
+
+  // Convert to flits, and sequence them for injection.
+  int64_t source_index = flows_index_to_sources_index_map_.at(flow_index);
+  NetworkComponentId source = source_network_interfaces_.at(source_index);
+
+  // All packets are depacketized and converted to flits on a single cycle.
+  // Those flits are injected into the simulator.  The simulator is
+  // expected to have an infinite queue and will send a single flit per
+  // cycle in the order in which they are received..
+  //
+  // TODO(tedhong): 2021-06-29 - Model a fixed queue between the depacketizer
+  //                            and the network interface.
+  //
+  // TODO(tedhong): 2021-06-29 - Model priority between different flows.
+  //                             so packets are not handled and sent in-order.
+
+  DePacketizer& depacketizer = depacketizers_[source_index];
+  for (DataPacket& p : packets) {
+    XLS_RET_CHECK_OK(depacketizer.AcceptNewPacket(p));
+
+    while (!depacketizer.IsIdle()) {
+      XLS_ASSIGN_OR_RETURN(DataFlit flit, depacketizer.ComputeNextFlit());
+      // Add information defining the cycle iteration the flit is injected
+      // into the network.
+      TimedDataFlitInfo info{cycle_};
+      TimedDataFlit timed_data_flit{cycle_, flit, info};
+      XLS_RET_CHECK_OK(simulator_->SendFlitAtTime(timed_data_flit, source));
     }
   }
 
@@ -92,6 +122,124 @@ absl::Status NocTrafficInjector::RunCycle() {
 
 namespace {
 
+// Returns the packet sent by every call to the model's GetNewCyclePackets().
+absl::StatusOr<DataPacket> BuildPacketPrototype(const TrafficModel& model) {
+  return DataPacketBuilder()
+      .Valid(true)
+      .ZeroedData(model.GetPacketSizeInBits())
+      .VirtualChannel(model.GetVCIndex())
+      .SourceIndex(model.GetSourceIndex())
+      .DestinationIndex(model.GetDestinationIndex())
+      .Build();
+}
+
+}  // namespace
+
+absl::Status NocTrafficInjector::EnableBatchedInjection(
+    int64_t schedule_chunk_cycles) {
+  XLS_RET_CHECK_EQ(cycle_, -1)
+      << "Batched injection must be enabled before the first cycle.";
+  XLS_RET_CHECK_GT(schedule_chunk_cycles, 0);
+
+  batched_ = true;
+  schedule_chunk_cycles_ = schedule_chunk_cycles;
+  schedule_end_cycle_ = 0;
+  flow_schedules_.assign(traffic_models_.size(), {});
+  flow_schedule_positions_.assign(traffic_models_.size(), 0);
+  flow_packet_prototypes_.clear();
+  for (const std::unique_ptr<TrafficModel>& model : traffic_models_) {
+    XLS_ASSIGN_OR_RETURN(DataPacket packet, BuildPacketPrototype(*model));
+    flow_packet_prototypes_.push_back(std::move(packet));
+  }
+  return absl::OkStatus();
+}
+
+void NocTrafficInjector::GenerateInjectionSchedule(int64_t end_cycle) {
+  int64_t start_cycle = schedule_end_cycle_;
+
+  // Advance the models in (cycle, flow index) order, as RunCycle() does, so
+  // that models sharing a random number generator draw the same numbers.
+  //
+  // A model whose next packet cycle does not move forward would never send
+  // again when run cycle by cycle, so it is dropped from the schedule.
+  using Event = std::pair<int64_t, int64_t>;
+  std::priority_queue<Event, std::vector<Event>, std::greater<>> events;
+  for (int64_t i = 0; i < traffic_models_.size(); ++i) {
+    int64_t next_cycle = traffic_models_[i]->GetNextPacketCycle();
+    if (next_cycle >= start_cycle && next_cycle < end_cycle) {
+      events.push({next_cycle, i});
+    }
+  }
+  while (!events.empty()) {
+    auto [cycle, flow_index] = events.top();
+    events.pop();
+
+    TrafficModel& model = *traffic_models_[flow_index];
+    int64_t packet_count = model.GetNewCyclePackets(cycle).size();
+    std::vector<int64_t>& schedule = flow_schedules_[flow_index];
+    schedule.insert(schedule.end(), packet_count, cycle);
+
+    int64_t next_cycle = model.GetNextPacketCycle();
+    if (next_cycle > cycle && next_cycle < end_cycle) {
+      events.push({next_cycle, flow_index});
+    }
+  }
+
+  schedule_end_cycle_ = end_cycle;
+}
+
+absl::Status NocTrafficInjector::LoadInjectionTrace(
+    const std::filesystem::path& path) {
+  XLS_RETURN_IF_ERROR(EnableBatchedInjection());
+
+  XLS_ASSIGN_OR_RETURN(std::string trace, GetFileContents(path));
+  for (std::string_view line :
+       absl::StrSplit(trace, '\n', absl::SkipWhitespace())) {
+    std::vector<std::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    int64_t flow_index;
+    int64_t cycle;
+    if (fields.size() != 2 || !absl::SimpleAtoi(fields[0], &flow_index) ||
+        !absl::SimpleAtoi(fields[1], &cycle)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Malformed injection trace line in %s: \"%s\"", path.string(),
+          line));
+    }
+    if (flow_index < 0 || flow_index >= flow_schedules_.size() || cycle < 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Injection trace %s has packet for flow %d on cycle %d but the "
+          "injector has %d flows.",
+          path.string(), flow_index, cycle, flow_schedules_.size()));
+    }
+    flow_schedules_[flow_index].push_back(cycle);
+  }
+  for (std::vector<int64_t>& schedule : flow_schedules_) {
+    std::sort(schedule.begin(), schedule.end());
+  }
+
+  // The traffic models are not used when replaying a trace.
+  schedule_end_cycle_ = std::numeric_limits<int64_t>::max();
+  return absl::OkStatus();
+}
+
+absl::Status NocTrafficInjector::WriteInjectionTrace(
+    const std::filesystem::path& path) const {
+  if (!batched_) {
+    return absl::FailedPreconditionError(
+        "Injection traces can only be written with batched injection.");
+  }
+
+  std::string trace;
+  for (int64_t i = 0; i < flow_schedules_.size(); ++i) {
+    for (int64_t j = 0; j < flow_schedule_positions_[i]; ++j) {
+      absl::StrAppendFormat(&trace, "%d %d\n", i, flow_schedules_[i][j]);
+    }
+  }
+  return SetFileContents(path, trace);
+}
+
+namespace {
+
 // Function that calls run_action(i, j) for each flow and network_component
 // such that flow[i] corresponds to a flow that carries traffic
 // associated with network_object[j].
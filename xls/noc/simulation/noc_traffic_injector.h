@@ -16,6 +16,7 @@
 #define XLS_NOC_SIMULATION_NOC_TRAFFIC_INJECTOR_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <vector>
 
@@ -48,6 +49,30 @@ class NocTrafficInjector {
   // on the current_cycle.
   absl::Status RunCycle();
 
+  // Switches the injector to batched injection.
+  //
+  // Instead of querying every traffic model on every cycle, the injection
+  // cycles of all flows are generated ahead of time, schedule_chunk_cycles
+  // cycles at a time, and replayed. Models are advanced in the same order as
+  // in unbatched injection, so the injected traffic is identical.
+  //
+  // Must be called before the first cycle is run.
+  absl::Status EnableBatchedInjection(
+      int64_t schedule_chunk_cycles = kDefaultScheduleChunkCycles);
+
+  // Replays the injection trace previously written by WriteInjectionTrace()
+  // instead of using the traffic models. The trace must have been recorded
+  // with the same traffic mode.
+  //
+  // Must be called before the first cycle is run.
+  absl::Status LoadInjectionTrace(const std::filesystem::path& path);
+
+  // Writes the packets injected so far to a trace, with one
+  // "<flow index> <cycle>" line per packet.
+  //
+  // Only supported with batched injection.
+  absl::Status WriteInjectionTrace(const std::filesystem::path& path) const;
+
   // Provides the interface between this object and the NOC simulator.
   void SetSimulatorShim(NocSimulatorTrafficServiceShim& simulator) {
     simulator_ = &simulator;
@@ -104,9 +129,32 @@ class NocTrafficInjector {
     return traffic_model_monitor_[flow_index].MeasuredBitsSent();
   }
 
+  static constexpr int64_t kDefaultScheduleChunkCycles = 1024;
+
  private:
   friend NocTrafficInjectorBuilder;
 
+  // Depacketizes the packets of the given flow and injects the flits.
+  absl::Status InjectPackets(int64_t flow_index,
+                             absl::Span<DataPacket> packets);
+
+  // Extends the injection schedule of every flow up to cycle end_cycle
+  // (exclusive).
+  void GenerateInjectionSchedule(int64_t end_cycle);
+
+  // Batched injection state.
+  //
+  // Each flow's schedule holds the (sorted) cycle of every packet the flow
+  // injects, generated up to schedule_end_cycle_. Packets are copies of the
+  // flow's packet prototype.
+  bool batched_ = false;
+  int64_t schedule_chunk_cycles_ = kDefaultScheduleChunkCycles;
+  int64_t schedule_end_cycle_ = 0;
+  std::vector<std::vector<int64_t>> flow_schedules_;
+  std::vector<int64_t> flow_schedule_positions_;
+  std::vector<DataPacket> flow_packet_prototypes_;
+  std::vector<DataPacket> batched_packets_;
+
   // Interface to simulator for injecting flits.
   NocSimulatorTrafficServiceShim* simulator_ = nullptr;
 
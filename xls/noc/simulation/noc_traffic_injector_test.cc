@@ -15,14 +15,20 @@
 #include "xls/noc/simulation/noc_traffic_injector.h"
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
@@ -655,5 +661,136 @@ TEST(NocTrafficInjectorTest, ReplaySource) {
   EXPECT_DOUBLE_EQ(replay_model->GetPacketSizeInBits(), 128);
 }
 
+// Records the flits injected into each source.
+class RecordingTrafficServiceShim : public NocSimulatorTrafficServiceShim {
+ public:
+  absl::Status RunCycle() override { return absl::OkStatus(); }
+
+  absl::Status SendFlitAtTime(TimedDataFlit flit,
+                              NetworkComponentId source) override {
+    flits_.push_back(absl::StrFormat("%d %x %s", flit.cycle, source.AsUInt64(),
+                                     flit.flit.ToString()));
+    return absl::OkStatus();
+  }
+
+  const std::vector<std::string>& flits() const { return flits_; }
+
+ private:
+  std::vector<std::string> flits_;
+};
+
+TEST(NocTrafficInjectorTest, BatchedInjectionAndTraceReplay) {
+  // Two bursty flows sharing a source and one on another source, all drawing
+  // from the same random number generator.
+  NocTrafficManager traffic_mgr;
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficFlowId flow0_id,
+                           traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(8 * 1024)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(70);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficFlowId flow1_id,
+                           traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow1_id)
+      .SetName("flow1")
+      .SetSource("SendPort1")
+      .SetDestination("RecvPort0")
+      .SetVC("VC1")
+      .SetTrafficRateInMiBps(18 * 1024)
+      .SetPacketSizeInBits(256)
+      .SetBurstProbInMils(10);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficFlowId flow2_id,
+                           traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow2_id)
+      .SetName("flow2")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort1")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(4 * 1024)
+      .SetPacketSizeInBits(64)
+      .SetBurstProbInMils(20);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficModeId mode0_id,
+                           traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id)
+      .SetName("Mode 0")
+      .RegisterTrafficFlow(flow0_id)
+      .RegisterTrafficFlow(flow1_id)
+      .RegisterTrafficFlow(flow2_id);
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphTree001(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+
+  int64_t cycle_time_in_ps = 1000;
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path trace_path = temp_dir.path() / "trace.txt";
+
+  // Runs an injector configured by setup and returns the injected flits.
+  // If write_trace is set, the injection trace is written afterwards.
+  auto run_injector = [&](absl::FunctionRef<absl::Status(NocTrafficInjector&)>
+                              setup,
+                          bool write_trace = false)
+      -> absl::StatusOr<std::vector<std::string>> {
+    RandomNumberInterface rnd;
+    rnd.SetSeed(1000);
+    XLS_ASSIGN_OR_RETURN(
+        NocTrafficInjector traffic_injector,
+        NocTrafficInjectorBuilder().Build(
+            cycle_time_in_ps, mode0_id,
+            routing_table.GetSourceIndices().GetNetworkComponents(),
+            routing_table.GetSinkIndices().GetNetworkComponents(),
+            params.GetNetworkParam(graph.GetNetworkIds()[0])
+                ->GetVirtualChannels(),
+            traffic_mgr, graph, params, rnd));
+    XLS_RETURN_IF_ERROR(setup(traffic_injector));
+    RecordingTrafficServiceShim shim;
+    traffic_injector.SetSimulatorShim(shim);
+    for (int64_t cycle = 0; cycle < 10'000; ++cycle) {
+      XLS_RETURN_IF_ERROR(traffic_injector.RunCycle());
+    }
+    if (write_trace) {
+      XLS_RETURN_IF_ERROR(traffic_injector.WriteInjectionTrace(trace_path));
+    }
+    return shim.flits();
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> unbatched,
+      run_injector([](NocTrafficInjector&) { return absl::OkStatus(); }));
+  EXPECT_GT(unbatched.size(), 1000);
+
+  // Use a chunk size that does not divide the cycle count.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> batched,
+      run_injector(
+          [](NocTrafficInjector& injector) {
+            return injector.EnableBatchedInjection(
+                /*schedule_chunk_cycles=*/333);
+          },
+          /*write_trace=*/true));
+  EXPECT_EQ(batched, unbatched);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> replayed,
+      run_injector([&](NocTrafficInjector& injector) {
+        return injector.LoadInjectionTrace(trace_path);
+      }));
+  EXPECT_EQ(replayed, unbatched);
+}
+
 }  // namespace
 }  // namespace xls::noc
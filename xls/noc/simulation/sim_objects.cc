@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <queue>
 #include <utility>
@@ -147,6 +148,39 @@ absl::Status NocSimulator::CreateSimulationObjects(NetworkId network) {
     XLS_RETURN_IF_ERROR(CreateNetworkComponent(id));
   }
 
+  // Record the components in tick order along with which of them share a
+  // connection, for the event-driven evaluation in RunCycle.
+  components_.clear();
+  for (SimNetworkInterfaceSrc& nc : network_interface_sources_) {
+    components_.push_back(&nc);
+  }
+  for (SimLink& nc : links_) {
+    components_.push_back(&nc);
+  }
+  for (SimInputBufferedVCRouter& nc : routers_) {
+    components_.push_back(&nc);
+  }
+  for (SimNetworkInterfaceSink& nc : network_interface_sinks_) {
+    components_.push_back(&nc);
+  }
+  std::vector<std::vector<int64_t>> connection_components(connections_.size());
+  for (int64_t i = 0; i < components_.size(); ++i) {
+    for (int64_t index : components_[i]->GetConnectionIndices(*this)) {
+      XLS_RET_CHECK_LT(index, connections_.size());
+      connection_components[index].push_back(i);
+    }
+  }
+  component_neighbors_.assign(components_.size(), {});
+  for (const std::vector<int64_t>& sharing : connection_components) {
+    for (int64_t i : sharing) {
+      for (int64_t j : sharing) {
+        if (i != j) {
+          component_neighbors_[i].push_back(j);
+        }
+      }
+    }
+  }
+
   return absl::OkStatus();
 }
 
@@ -267,11 +301,54 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
     XLS_RET_CHECK_OK(svc->RunCycle());
   }
 
-  bool converged = false;
+  // Whether each component has converged for this cycle and whether it needs
+  // to be ticked (again).
+  std::vector<bool> converged(components_.size(), false);
+  std::vector<bool> dirty(components_.size(), true);
+  int64_t unconverged_count = components_.size();
   int64_t nticks = 0;
-  while (!converged) {
+  while (unconverged_count > 0) {
     VLOG(2) << absl::StreamFormat("Tick %d", nticks);
-    converged = Tick();
+    if (std::find(dirty.begin(), dirty.end(), true) == dirty.end()) {
+      // No component observed a change; fall back to ticking all of the
+      // unconverged components.
+      for (int64_t i = 0; i < components_.size(); ++i) {
+        dirty[i] = !converged[i];
+      }
+    }
+    std::vector<bool> next_dirty(components_.size(), false);
+    for (int64_t i = 0; i < components_.size(); ++i) {
+      if (!dirty[i]) {
+        continue;
+      }
+      bool progressed = false;
+      bool this_converged = components_[i]->Tick(*this, &progressed);
+      VLOG(2) << absl::StreamFormat(" NC %x Converged %d",
+                                    components_[i]->GetId().AsUInt64(),
+                                    this_converged);
+      if (this_converged) {
+        converged[i] = true;
+        --unconverged_count;
+      } else if (progressed) {
+        next_dirty[i] = true;
+      }
+      if (!progressed) {
+        continue;
+      }
+      // Components later in tick order are ticked on this tick, as they would
+      // be by a full sweep; earlier ones on the next.
+      for (int64_t neighbor : component_neighbors_[i]) {
+        if (converged[neighbor]) {
+          continue;
+        }
+        if (neighbor > i) {
+          dirty[neighbor] = true;
+        } else {
+          next_dirty[neighbor] = true;
+        }
+      }
+    }
+    dirty = std::move(next_dirty);
     ++nticks;
     if (nticks >= max_ticks) {
       return absl::InternalError(absl::StrFormat(
@@ -345,13 +422,16 @@ bool NocSimulator::Tick() {
   return converged;
 }
 
-bool SimNetworkComponentBase::Tick(NocSimulator& simulator) {
+bool SimNetworkComponentBase::Tick(NocSimulator& simulator,
+                                   bool* progressed) {
   int64_t cycle = simulator.GetCurrentCycle();
 
   bool converged = true;
+  bool any_propagated = false;
   if (forward_propagated_cycle_ != cycle) {
     if (TryForwardPropagation(simulator)) {
       forward_propagated_cycle_ = cycle;
+      any_propagated = true;
     } else {
       converged = false;
     }
@@ -359,13 +439,53 @@ bool SimNetworkComponentBase::Tick(NocSimulator& simulator) {
   if (reverse_propagated_cycle_ != cycle) {
     if (TryReversePropagation(simulator)) {
       reverse_propagated_cycle_ = cycle;
+      any_propagated = true;
     } else {
       converged = false;
     }
   }
+  if (progressed != nullptr) {
+    *progressed = any_propagated;
+  }
   return converged;
 }
 
+int64_t DataFlitRingArena::AddRing(int64_t capacity) {
+  int64_t index = rings_.size();
+  rings_.push_back(Ring{.offset = static_cast<int64_t>(elements_.size()),
+                        .capacity = capacity,
+                        .head = 0,
+                        .size = 0});
+  elements_.resize(elements_.size() + capacity);
+  return index;
+}
+
+absl::Status DataFlitRingArena::Push(int64_t ring,
+                                     DataFlitQueueElement element) {
+  Ring& r = rings_[ring];
+  if (r.size == r.capacity) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "Flit buffer %d with capacity %d overflowed", ring, r.capacity));
+  }
+  int64_t tail = r.head + r.size;
+  if (tail >= r.capacity) {
+    tail -= r.capacity;
+  }
+  elements_[r.offset + tail] = std::move(element);
+  ++r.size;
+  return absl::OkStatus();
+}
+
+void DataFlitRingArena::Pop(int64_t ring) {
+  Ring& r = rings_[ring];
+  DCHECK_GT(r.size, 0);
+  ++r.head;
+  if (r.head == r.capacity) {
+    r.head = 0;
+  }
+  --r.size;
+}
+
 int64_t SimLink::GetSourceConnectionIndex() const {
   return src_connection_index_;
 }
@@ -480,23 +600,51 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
 int64_t SimInputBufferedVCRouter::GetUtilizationCycleCount() const {
   return utilization_cycle_count_;
 }
+
+int64_t SimInputBufferedVCRouter::GetInputVcOccupancy(NocSimulator& simulator,
+                                                      int64_t input_vc) const {
+  return simulator.GetInputBufferArena().size(input_buffer_start_ + input_vc);
+}
+
+int64_t SimInputBufferedVCRouter::GetInputVcCapacity(NocSimulator& simulator,
+                                                     int64_t input_vc) const {
+  return simulator.GetInputBufferArena().capacity(input_buffer_start_ +
+                                                  input_vc);
+}
+
+std::vector<int64_t> SimInputBufferedVCRouter::GetConnectionIndices(
+    NocSimulator& simulator) const {
+  std::vector<int64_t> indices;
+  indices.reserve(input_connection_count_ + output_connection_count_);
+  for (int64_t index : simulator.GetConnectionIndicesStore(
+           input_connection_index_start_, input_connection_count_)) {
+    indices.push_back(index);
+  }
+  for (int64_t index : simulator.GetConnectionIndicesStore(
+           output_connection_index_start_, output_connection_count_)) {
+    indices.push_back(index);
+  }
+  return indices;
+}
+
 absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
   NetworkManager* network_manager = simulator.GetNetworkManager();
   NetworkComponent& nc = network_manager->GetNetworkComponent(id_);
   const PortIndexMap& port_indexer =
       simulator.GetRoutingTable()->GetPortIndices();
+  routes_ = &simulator.GetRoutingTable()->GetIndexedRoutingTable(id_);
 
   // Setup structures associated with the inputs.
   //  - input to SimConnectionState (input_connection_index_start_ and count_)
-  //  - input_buffers_
+  //  - input buffers (input_buffer_start_ and input_vc_offset_)
   input_connection_count_ = nc.GetInputPortIds().size();
   input_connection_index_start_ =
       simulator.GetNewConnectionIndicesStore(input_connection_count_);
   absl::Span<int64_t> input_indices = simulator.GetConnectionIndicesStore(
       input_connection_index_start_, input_connection_count_);
 
-  input_buffers_.resize(input_connection_count_);
-  input_credit_to_send_.resize(input_connection_count_);
+  input_vc_offset_.assign(1, 0);
+  input_buffer_start_ = simulator.GetInputBufferArena().ring_count();
   max_vc_ = 0;
   for (int64_t i = 0; i < input_connection_count_; ++i) {
     XLS_ASSIGN_OR_RETURN(
@@ -510,15 +658,16 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
     std::vector<VirtualChannelParam> vc_params =
         port_param.GetVirtualChannels();
 
-    input_buffers_[i].resize(port_param.VirtualChannelCount());
     for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
-      input_buffers_[i][vc].max_queue_size = vc_params[vc].GetDepth();
+      simulator.GetInputBufferArena().AddRing(vc_params[vc].GetDepth());
     }
-    input_credit_to_send_[i].resize(port_param.VirtualChannelCount());
+    input_vc_offset_.push_back(input_vc_offset_.back() +
+                               port_param.VirtualChannelCount());
     if (max_vc_ < port_param.VirtualChannelCount()) {
       max_vc_ = port_param.VirtualChannelCount();
     }
   }
+  input_credit_to_send_.assign(input_vc_offset_.back(), 0);
 
   // Setup structures associated with the outputs.
   //  - output to SimConnectionState (output_connection_index_start_ and count_)
@@ -528,7 +677,7 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
       simulator.GetNewConnectionIndicesStore(output_connection_count_);
   absl::Span<int64_t> output_indices = simulator.GetConnectionIndicesStore(
       output_connection_index_start_, output_connection_count_);
-  credit_.resize(output_connection_count_);
+  output_vc_offset_.assign(1, 0);
   credit_update_.resize(output_connection_count_);
   for (int64_t i = 0; i < output_connection_count_; ++i) {
     XLS_ASSIGN_OR_RETURN(
@@ -539,11 +688,14 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
 
     XLS_ASSIGN_OR_RETURN(PortParam port_param,
                          simulator.GetNocParameters()->GetPortParam(port_id));
-    credit_[i].resize(port_param.VirtualChannelCount(), 0);
+    output_vc_offset_.push_back(output_vc_offset_.back() +
+                                port_param.VirtualChannelCount());
     credit_update_[i].resize(port_param.VirtualChannelCount(),
                              CreditState{simulator.GetCurrentCycle(), 0});
   }
 
+  credit_start_ = simulator.GetNewCounterStore(output_vc_offset_.back());
+
   internal_propagated_cycle_ = simulator.GetCurrentCycle();
   utilization_cycle_count_ = 0;
 
@@ -706,25 +858,23 @@ bool SimNetworkInterfaceSrc::TryReversePropagation(NocSimulator& simulator) {
 
 absl::StatusOr<SimInputBufferedVCRouter::PortIndexAndVCIndex>
 SimInputBufferedVCRouter::GetDestinationPortIndexAndVcIndex(
-    NocSimulator& simulator, PortIndexAndVCIndex input,
-    int64_t destination_index) {
-  DistributedRoutingTable* routes = simulator.GetRoutingTable();
-
-  XLS_ASSIGN_OR_RETURN(PortId input_port,
-                       routes->GetPortIndices().GetPortByIndex(
-                           GetId(), PortDirection::kInput, input.port_index));
-
-  PortAndVCIndex port_from{input_port, input.vc_index};
-
-  XLS_ASSIGN_OR_RETURN(
-      PortAndVCIndex port_to,
-      routes->GetRouterOutputPortByIndex(port_from, destination_index));
-
-  XLS_ASSIGN_OR_RETURN(int64_t output_port_index,
-                       routes->GetPortIndices().GetPortIndex(
-                           port_to.port_id_, PortDirection::kOutput));
-
-  return PortIndexAndVCIndex{output_port_index, port_to.vc_index_};
+    PortIndexAndVCIndex input, int64_t destination_index) const {
+  XLS_RET_CHECK(destination_index >= 0 &&
+                destination_index < routes_->destination_count);
+  int64_t routed_vc_count = routes_->input_vc_offset[input.port_index + 1] -
+                            routes_->input_vc_offset[input.port_index];
+  ::xls::noc::PortIndexAndVCIndex output =
+      input.vc_index < routed_vc_count
+          ? routes_->GetOutput(input.port_index, input.vc_index,
+                               destination_index)
+          : ::xls::noc::PortIndexAndVCIndex{-1, -1};
+  if (output.port_index_ < 0) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Router %x has no route from port index %d vc %d to destination %d",
+        GetId().AsUInt64(), input.port_index, input.vc_index,
+        destination_index));
+  }
+  return PortIndexAndVCIndex{output.port_index_, output.vc_index_};
 }
 
 bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
@@ -738,22 +888,27 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
       simulator.GetConnectionIndicesStore(output_connection_index_start_,
                                           output_connection_count_);
 
+  DataFlitRingArena& input_buffers = simulator.GetInputBufferArena();
+  absl::Span<int64_t> credit =
+      simulator.GetCounterStore(credit_start_, output_vc_offset_.back());
+
   // Update credits (for output ports)
   if (internal_propagated_cycle_ != current_cycle) {
     for (int64_t i = 0; i < credit_update_.size(); ++i) {
       for (int64_t vc = 0; vc < credit_update_[i].size(); ++vc) {
+        int64_t& vc_credit = credit[OutputVcIndex(i, vc)];
         if (credit_update_[i][vc].credit > 0) {
-          credit_[i][vc] += credit_update_[i][vc].credit;
+          vc_credit += credit_update_[i][vc].credit;
           VLOG(2) << absl::StrFormat(
               "... router %x output port %d vc %d added credits %d, now %d",
               GetId().AsUInt64(), i, vc, credit_update_[i][vc].credit,
-              credit_[i][vc]);
+              vc_credit);
         } else {
           VLOG(2) << absl::StrFormat(
               "... router %x output port %d vc %d did not add credits %d, now "
               "%d",
               GetId().AsUInt64(), i, vc, credit_update_[i][vc].credit,
-              credit_[i][vc]);
+              vc_credit);
         }
       }
     }
@@ -778,11 +933,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
   }
 
   // Reset credits to send on reverse channel to 0.
-  for (int64_t i = 0; i < input_connection_count_; ++i) {
-    for (int64_t vc = 0; vc < input_credit_to_send_[i].size(); ++vc) {
-      input_credit_to_send_[i][vc] = 0;
-    }
-  }
+  std::fill(input_credit_to_send_.begin(), input_credit_to_send_.end(), 0);
 
   bool flit_sent = false;
   // This router supports bypass so a flit arriving at the
@@ -793,8 +944,9 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
     if (input.forward_channels.flit.type != FlitType::kInvalid) {
       int64_t vc = input.forward_channels.flit.vc;
-      input_buffers_[i][vc].queue.push(
-          {input.forward_channels.flit, input.forward_channels.metadata});
+      CHECK_OK(input_buffers.Push(
+          input_buffer_start_ + InputVcIndex(i, vc),
+          {input.forward_channels.flit, input.forward_channels.metadata}));
 
       VLOG(2) << absl::StrFormat(
           "... router %x from %x received data %s port %d vc %d",
@@ -806,34 +958,35 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
   // Use fixed priority to route to output ports.
   // Priority goes to the port with the least vc and the least port index.
   for (int64_t vc = 0; vc < max_vc_; ++vc) {
-    for (int64_t i = 0; i < input_buffers_.size(); ++i) {
-      if (vc >= input_buffers_[i].size()) {
+    for (int64_t i = 0; i < input_connection_count_; ++i) {
+      if (vc >= InputVcCount(i)) {
         continue;
       }
 
       // See if we have a flit to route and can route it.
-      if (input_buffers_[i][vc].queue.empty()) {
+      int64_t ring = input_buffer_start_ + InputVcIndex(i, vc);
+      if (input_buffers.empty(ring)) {
         continue;
       }
 
-      DataFlit flit = input_buffers_[i][vc].queue.front().flit;
-      TimedDataFlitInfo metadata = input_buffers_[i][vc].queue.front().metadata;
+      DataFlit flit = input_buffers.front(ring).flit;
+      TimedDataFlitInfo metadata = input_buffers.front(ring).metadata;
       int64_t destination_index = flit.destination_index;
 
       PortIndexAndVCIndex input{i, vc};
       absl::StatusOr<PortIndexAndVCIndex> output_status =
-          GetDestinationPortIndexAndVcIndex(simulator, input,
-                                            destination_index);
+          GetDestinationPortIndexAndVcIndex(input, destination_index);
       CHECK_OK(output_status.status());
       PortIndexAndVCIndex output = output_status.value();
 
       // Now see if we have sufficient credits.
-      if (credit_.at(output.port_index).at(output.vc_index) <= 0) {
+      int64_t& output_credit =
+          credit[OutputVcIndex(output.port_index, output.vc_index)];
+      if (output_credit <= 0) {
         VLOG(2) << absl::StreamFormat(
             "... router unable to send data %s vc %d credit now %d"
             " from port index %d to port index %d.",
-            flit, flit.vc, credit_.at(output.port_index).at(output.vc_index), i,
-            output.port_index);
+            flit, flit.vc, output_credit, i, output.port_index);
         continue;
       }
 
@@ -854,11 +1007,11 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
           TimedRouteItem{id_, current_cycle});
 
       // Update credit on output.
-      --credit_.at(output.port_index).at(output.vc_index);
+      --output_credit;
 
       // Update credit to send back to input.
-      ++input_credit_to_send_[i][vc];
-      input_buffers_[i][vc].queue.pop();
+      ++input_credit_to_send_[InputVcIndex(i, vc)];
+      input_buffers.Pop(ring);
 
       flit_sent = true;
 
@@ -866,8 +1019,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
           "... router sending data %s vc %d credit now %d"
           " from port index %d to port index %d on %x.",
           output_state.forward_channels.flit,
-          output_state.forward_channels.flit.vc,
-          credit_.at(output.port_index).at(output.vc_index), i,
+          output_state.forward_channels.flit.vc, output_credit, i,
           output.port_index, output_state.id.AsUInt64());
     }
   }
@@ -915,11 +1067,13 @@ bool SimInputBufferedVCRouter::TryReversePropagation(NocSimulator& simulator) {
 
       // Upon reset (cycle-0) a full update of credits is sent.
       if (current_cycle == 0) {
-        input.reverse_channels[vc].flit.data =
-            UBits(input_buffers_[i][vc].max_queue_size, 32);
+        input.reverse_channels[vc].flit.data = UBits(
+            simulator.GetInputBufferArena().capacity(input_buffer_start_ +
+                                                     InputVcIndex(i, vc)),
+            32);
       } else {
         input.reverse_channels[vc].flit.data =
-            UBits(input_credit_to_send_[i][vc], 32);
+            UBits(input_credit_to_send_[InputVcIndex(i, vc)], 32);
       }
       input.reverse_channels[vc].cycle = current_cycle;
 
@@ -65,6 +65,49 @@ struct DataFlitQueue {
 
 // Represents a fifo/buffer used to store metadata phits.
 
+// Storage for the virtual channel input buffers of all routers in a
+// simulation.
+//
+// Each buffer is a fixed-capacity ring of flits. The rings are laid out back
+// to back in a single arena in allocation order, so the buffers of the vcs
+// of a router, and of routers created one after another, are contiguous in
+// memory.
+class DataFlitRingArena {
+ public:
+  // Allocates a ring holding up to `capacity` flits and returns its index.
+  // Rings allocated one after another have consecutive indices.
+  int64_t AddRing(int64_t capacity);
+
+  int64_t ring_count() const { return rings_.size(); }
+  int64_t capacity(int64_t ring) const { return rings_[ring].capacity; }
+  int64_t size(int64_t ring) const { return rings_[ring].size; }
+  bool empty(int64_t ring) const { return rings_[ring].size == 0; }
+
+  // Returns the oldest flit in the ring, which must not be empty.
+  const DataFlitQueueElement& front(int64_t ring) const {
+    const Ring& r = rings_[ring];
+    return elements_[r.offset + r.head];
+  }
+
+  // Appends a flit to the ring. Returns an error if the ring is full, i.e. the
+  // sender did not respect the credits it was given.
+  absl::Status Push(int64_t ring, DataFlitQueueElement element);
+
+  // Removes the oldest flit from the ring, which must not be empty.
+  void Pop(int64_t ring);
+
+ private:
+  struct Ring {
+    int64_t offset;
+    int64_t capacity;
+    int64_t head;
+    int64_t size;
+  };
+
+  std::vector<Ring> rings_;
+  std::vector<DataFlitQueueElement> elements_;
+};
+
 class NocSimulator;
 
 // Common functionality and base class for all simulator objects.
@@ -78,8 +121,17 @@ class SimNetworkComponentBase {
   // attached to this component have state associated with the current.
   // cycle.
   //
+  // If `progressed` is given, it is set to whether forward or reverse
+  // propagation completed during this tick.
+  //
   // See NocSimulator::Tick.
-  bool Tick(NocSimulator& simulator);
+  bool Tick(NocSimulator& simulator, bool* progressed = nullptr);
+
+  // Returns the indices of the SimConnectionState objects this component
+  // reads or writes. Used to determine which components need to be ticked
+  // again once this one makes progress.
+  virtual std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const = 0;
 
   // Returns the associated NetworkComponentId.
   NetworkComponentId GetId() const { return id_; }
@@ -155,6 +207,11 @@ class SimLink : public SimNetworkComponentBase {
 
   // Get the sink connection index that in used in the simulator.
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override {
+    return {src_connection_index_, sink_connection_index_};
+  }
+
  private:
   SimLink() = default;
 
@@ -192,6 +249,11 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   // Register a flit to be sent at a specific time.
   absl::Status SendFlitAtTime(TimedDataFlit flit);
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override {
+    return {sink_connection_index_};
+  }
+
  private:
   SimNetworkInterfaceSrc() = default;
 
@@ -250,6 +312,11 @@ class SimNetworkInterfaceSink : public SimNetworkComponentBase {
     return bits_per_sec / 1024.0 / 1024.0 / 8.0;
   }
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override {
+    return {src_connection_index_};
+  }
+
  private:
   SimNetworkInterfaceSink() = default;
 
@@ -295,6 +362,18 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 
   int64_t GetUtilizationCycleCount() const;
 
+  // Returns the number of input vcs of the router. Input vcs are numbered
+  // consecutively in input port index order.
+  int64_t GetInputVcCount() const { return input_vc_offset_.back(); }
+
+  // Returns the number of flits buffered in the given input vc and the
+  // capacity of its buffer.
+  int64_t GetInputVcOccupancy(NocSimulator& simulator, int64_t input_vc) const;
+  int64_t GetInputVcCapacity(NocSimulator& simulator, int64_t input_vc) const;
+
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override;
+
  private:
   SimInputBufferedVCRouter() = default;
 
@@ -323,8 +402,11 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
   // output port and vc a flit should go out on given the input port and vc
   // along with the eventual flit destination.
   absl::StatusOr<PortIndexAndVCIndex> GetDestinationPortIndexAndVcIndex(
-      NocSimulator& simulator, PortIndexAndVCIndex input,
-      int64_t destination_index);
+      PortIndexAndVCIndex input, int64_t destination_index) const;
+
+  // The routing table of this router, owned by the simulator's
+  // DistributedRoutingTable.
+  const DistributedRoutingTable::IndexedRouterRoutingTable* routes_;
 
   // Index for the input connections associated with this router.
   // Each input port is associated with a single connection.
@@ -340,12 +422,35 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
   // updated its credit count from the updates received in the previous cycle.
   int64_t internal_propagated_cycle_;
 
-  // Stores the input buffers associated with each input port and vc.
-  std::vector<std::vector<DataFlitQueue>> input_buffers_;
+  // Returns the index of the given input port and vc among all of the input
+  // vcs of this router.
+  int64_t InputVcIndex(int64_t port_index, int64_t vc_index) const {
+    return input_vc_offset_[port_index] + vc_index;
+  }
+  int64_t InputVcCount(int64_t port_index) const {
+    return input_vc_offset_[port_index + 1] - input_vc_offset_[port_index];
+  }
+
+  // Returns the index of the given output port and vc among all of the output
+  // vcs of this router.
+  int64_t OutputVcIndex(int64_t port_index, int64_t vc_index) const {
+    return output_vc_offset_[port_index] + vc_index;
+  }
+
+  // The index of the first vc of each port among all of the input (output) vcs
+  // of the router, followed by the total number of input (output) vcs.
+  std::vector<int64_t> input_vc_offset_;
+  std::vector<int64_t> output_vc_offset_;
 
-  // Stores the credit count associated with each output port and vc.
+  // The input buffer of each input vc is ring
+  // input_buffer_start_ + InputVcIndex(port, vc) of the simulator's
+  // DataFlitRingArena.
+  int64_t input_buffer_start_;
+
+  // The credit count of each output vc is counter
+  // credit_start_ + OutputVcIndex(port, vc) of the simulator's counter store.
   // Each cycle, the router updates its credit count from credit_update_.
-  std::vector<std::vector<int64_t>> credit_;
+  int64_t credit_start_;
 
   // Stores the credit count received on cycle N-1.
   std::vector<std::vector<CreditState>> credit_update_;
@@ -356,7 +461,8 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 
   // Used by forward propagation to store the number of phits that left
   // the input buffers and hence credits that can be sent back upstream.
-  std::vector<std::vector<int64_t>> input_credit_to_send_;
+  // Indexed by InputVcIndex.
+  std::vector<int64_t> input_credit_to_send_;
 
   // The number of cycles that a transfer from input to output occurred.
   int64_t utilization_cycle_count_;
@@ -369,6 +475,10 @@ class NocSimulator {
   NocSimulator()
       : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
 
+  // The simulator holds pointers into its own simulation object stores.
+  NocSimulator(const NocSimulator&) = delete;
+  NocSimulator& operator=(const NocSimulator&) = delete;
+
   // Creates all simulation objects for a given network.
   // NetworkManager, NocParameters, and DistributedRoutingTable should
   // have aleady been setup.
@@ -421,6 +531,23 @@ class NocSimulator {
     return next_start;
   }
 
+  // Returns the arena holding the input buffers of the routers.
+  DataFlitRingArena& GetInputBufferArena() { return input_buffer_arena_; }
+
+  // Allocates `size` zero-initialized counters and returns the index of the
+  // first, to be used with GetCounterStore.
+  int64_t GetNewCounterStore(int64_t size) {
+    int64_t next_start = counter_store_.size();
+    counter_store_.resize(next_start + size, 0);
+    return next_start;
+  }
+
+  // Returns a reference to the counters previously reserved with
+  // GetNewCounterStore.
+  absl::Span<int64_t> GetCounterStore(int64_t start, int64_t size = 1) {
+    return absl::Span<int64_t>(counter_store_.data() + start, size);
+  }
+
   // Allocates and returns an index that can be used with
   // GetPortIdStore to retreive an array of size)
 
@@ -434,9 +561,17 @@ class NocSimulator {
   void Dump();
 
   // Run a single cycle of the simulator.
+  //
+  // The cycle is evaluated event-driven: after every component has been
+  // ticked once, a component is only ticked again if it or a component
+  // sharing a connection with it made progress on the previous tick. Should
+  // that leave no component to tick before the cycle has converged, every
+  // unconverged component is ticked, so the cycle converges exactly when
+  // repeated calls to Tick() would. Fails if the cycle does not converge
+  // within `max_ticks` ticks.
   absl::Status RunCycle(int64_t max_ticks = 9999);
 
-  // Runs a single tick of the simulator.
+  // Runs a single tick of the simulator, ticking every component.
   bool Tick();
 
   // Register a service to run once at the beginning of each cycle.
@@ -502,6 +637,10 @@ class NocSimulator {
   std::vector<int64_t> component_to_connection_index_;
   std::vector<SimConnectionState> connections_;
 
+  // Packed per-vc state of the routers (see SimInputBufferedVCRouter).
+  DataFlitRingArena input_buffer_arena_;
+  std::vector<int64_t> counter_store_;
+
   // Stores port ids for routers.
   std::vector<PortId> port_id_store_;
 
@@ -510,6 +649,11 @@ class NocSimulator {
   std::vector<SimNetworkInterfaceSink> network_interface_sinks_;
   std::vector<SimInputBufferedVCRouter> routers_;
 
+  // All of the simulation objects above in tick order and, for each of them,
+  // the indices into components_ of the objects sharing a connection with it.
+  std::vector<SimNetworkComponentBase*> components_;
+  std::vector<std::vector<int64_t>> component_neighbors_;
+
   // Shims to services to run at the beginning of each cycle.
   std::vector<NocSimulatorServiceShim*> pre_cycle_services_;
 
@@ -302,6 +302,39 @@ TEST(SimObjectsTest, TreeNetwork0) {
       38146);
 }
 
+TEST(SimObjectsTest, DataFlitRingArena) {
+  DataFlitRingArena arena;
+  int64_t a = arena.AddRing(2);
+  int64_t b = arena.AddRing(1);
+  EXPECT_EQ(b, a + 1);
+  EXPECT_EQ(arena.ring_count(), 2);
+  EXPECT_EQ(arena.capacity(a), 2);
+  EXPECT_TRUE(arena.empty(a));
+
+  auto element = [](int64_t destination_index) {
+    DataFlitQueueElement e;
+    e.flit.destination_index = destination_index;
+    return e;
+  };
+  XLS_ASSERT_OK(arena.Push(a, element(1)));
+  XLS_ASSERT_OK(arena.Push(b, element(10)));
+  XLS_ASSERT_OK(arena.Push(a, element(2)));
+  EXPECT_FALSE(arena.Push(a, element(3)).ok());
+  EXPECT_FALSE(arena.Push(b, element(11)).ok());
+  EXPECT_EQ(arena.size(a), 2);
+
+  // Wrap around the end of ring `a`.
+  EXPECT_EQ(arena.front(a).flit.destination_index, 1);
+  arena.Pop(a);
+  XLS_ASSERT_OK(arena.Push(a, element(3)));
+  EXPECT_EQ(arena.front(a).flit.destination_index, 2);
+  arena.Pop(a);
+  EXPECT_EQ(arena.front(a).flit.destination_index, 3);
+  arena.Pop(a);
+  EXPECT_TRUE(arena.empty(a));
+  EXPECT_EQ(arena.front(b).flit.destination_index, 10);
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
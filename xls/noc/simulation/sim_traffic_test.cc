@@ -12,15 +12,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/histogram.h"
 #include "xls/noc/simulation/network_graph.h"
 #include "xls/noc/simulation/network_graph_builder.h"
 #include "xls/noc/simulation/noc_traffic_injector.h"
@@ -28,6 +37,7 @@
 #include "xls/noc/simulation/random_number_interface.h"
 #include "xls/noc/simulation/sample_network_graphs.h"
 #include "xls/noc/simulation/sim_objects.h"
+#include "xls/noc/simulation/simulator_to_histogram_monitor_service_shim.h"
 #include "xls/noc/simulation/simulator_to_link_monitor_service_shim.h"
 #include "xls/noc/simulation/simulator_to_traffic_injector_shim.h"
 #include "xls/noc/simulation/traffic_description.h"
@@ -387,5 +397,127 @@ TEST(SimTrafficTest, NetworkWithMultiplePathsAndReplay) {
   EXPECT_EQ(simulator.GetRouters()[1].GetUtilizationCycleCount(), 10);
 }
 
+TEST(SimTrafficTest, HistogramMonitor) {
+  NocTrafficManager traffic_mgr;
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficFlowId flow0_id,
+                           traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(8 * 1024)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficFlowId flow1_id,
+                           traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow1_id)
+      .SetName("flow1")
+      .SetSource("SendPort1")
+      .SetDestination("RecvPort0")
+      .SetVC("VC1")
+      .SetTrafficRateInMiBps(8 * 1024)
+      .SetPacketSizeInBits(256)
+      .SetBurstProbInMils(1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficModeId mode0_id,
+                           traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id)
+      .SetName("Mode 0")
+      .RegisterTrafficFlow(flow0_id)
+      .RegisterTrafficFlow(flow1_id);
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphTree001(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+
+  RandomNumberInterface rnd;
+  int64_t cycle_time_in_ps = 1000;
+  rnd.SetSeed(1000);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NocTrafficInjector traffic_injector,
+      NocTrafficInjectorBuilder().Build(
+          cycle_time_in_ps, mode0_id,
+          routing_table.GetSourceIndices().GetNetworkComponents(),
+          routing_table.GetSinkIndices().GetNetworkComponents(),
+          params.GetNetworkParam(graph.GetNetworkIds()[0])
+              ->GetVirtualChannels(),
+          traffic_mgr, graph, params, rnd));
+
+  NocSimulator simulator;
+  XLS_ASSERT_OK(simulator.Initialize(graph, params, routing_table,
+                                     graph.GetNetworkIds()[0]));
+
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path export_path = temp_dir.path() / "histograms.csv";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<NocSimulatorToHistogramMonitorServiceShim> monitor,
+      NocSimulatorToHistogramMonitorServiceShim::Create(
+          simulator, HistogramMonitorOptions{.sub_bucket_bits = 7,
+                                             .export_path = export_path,
+                                             .export_interval_cycles = 5000}));
+  simulator.RegisterPostCycleService(*monitor);
+
+  for (int64_t i = 0; i < 20'000; ++i) {
+    XLS_ASSERT_OK(simulator.RunCycle());
+  }
+
+  // The flow histograms see every flit received by the sink.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId recv_port_0,
+      FindNetworkComponentByName("RecvPort0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t recv_port_0_index,
+                           routing_table.GetSinkIndices()
+                               .GetNetworkComponentIndex(recv_port_0));
+  XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSink * sim_recv_port_0,
+                           simulator.GetSimNetworkInterfaceSink(recv_port_0));
+  absl::Span<const TimedDataFlit> received =
+      sim_recv_port_0->GetReceivedTraffic();
+  ASSERT_GT(received.size(), 1000);
+
+  for (int64_t vc = 0; vc < 2; ++vc) {
+    int64_t count = 0;
+    int64_t max_latency = 0;
+    for (const TimedDataFlit& flit : received) {
+      if (flit.flit.vc == vc) {
+        ++count;
+        max_latency = std::max(
+            max_latency, flit.cycle - flit.metadata.injection_cycle_time);
+      }
+    }
+    int64_t histogram_count = 0;
+    int64_t histogram_max = 0;
+    for (int64_t src = 0;
+         src < routing_table.GetSourceIndices().NetworkComponentCount();
+         ++src) {
+      const LogLinearHistogram& histogram =
+          monitor->GetFlowLatencyHistogram(src, recv_port_0_index, vc);
+      histogram_count += histogram.GetCount();
+      histogram_max = std::max(histogram_max, histogram.GetMax());
+    }
+    EXPECT_EQ(histogram_count, count) << "vc " << vc;
+    EXPECT_EQ(histogram_max, max_latency) << "vc " << vc;
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string csv, GetFileContents(export_path));
+  EXPECT_THAT(csv, ::testing::StartsWith("cycle,metric,name,vc,"));
+  EXPECT_THAT(csv, ::testing::HasSubstr("19999,flow_latency,"));
+  EXPECT_THAT(csv, ::testing::HasSubstr(",link_latency,"));
+  EXPECT_THAT(csv, ::testing::HasSubstr(",router_occupancy,"));
+}
+
 }  // namespace
 }  // namespace xls::noc
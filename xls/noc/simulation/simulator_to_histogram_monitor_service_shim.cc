@@ -0,0 +1,231 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "xls/noc/simulation/simulator_to_histogram_monitor_service_shim.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/flit.h"
+#include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/histogram.h"
+#include "xls/noc/simulation/parameters.h"
+#include "xls/noc/simulation/sim_objects.h"
+
+namespace xls::noc {
+
+namespace {
+
+absl::StatusOr<std::string> GetComponentName(NocParameters& params,
+                                             NetworkComponentId id) {
+  XLS_ASSIGN_OR_RETURN(NetworkComponentParam param,
+                       params.GetNetworkComponentParam(id));
+  return std::string(
+      std::visit([](const auto& nc_param) { return nc_param.GetName(); },
+                 param));
+}
+
+void AppendCsvRow(std::string& out, int64_t cycle, std::string_view metric,
+                  std::string_view name, int64_t vc,
+                  const LogLinearHistogram& histogram) {
+  absl::StrAppendFormat(&out, "%d,%s,%s,%d,%d,%d,%g,%d,%d,%d,%d\n", cycle,
+                        metric, name, vc, histogram.GetCount(),
+                        histogram.GetMin(), histogram.GetMean(),
+                        histogram.GetValueAtPercentile(50),
+                        histogram.GetValueAtPercentile(90),
+                        histogram.GetValueAtPercentile(99),
+                        histogram.GetMax());
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<NocSimulatorToHistogramMonitorServiceShim>>
+NocSimulatorToHistogramMonitorServiceShim::Create(
+    NocSimulator& simulator, HistogramMonitorOptions options) {
+  XLS_RET_CHECK_GT(options.export_interval_cycles, 0);
+  std::unique_ptr<NocSimulatorToHistogramMonitorServiceShim> shim(
+      new NocSimulatorToHistogramMonitorServiceShim(simulator,
+                                                    std::move(options)));
+
+  NocParameters& params = *simulator.GetNocParameters();
+  DistributedRoutingTable& routing = *simulator.GetRoutingTable();
+  NetworkId network_id = simulator.GetNetworkManager()->GetNetworkIds()[0];
+  XLS_ASSIGN_OR_RETURN(NetworkParam network_param,
+                       params.GetNetworkParam(network_id));
+  shim->vc_count_ = std::max<int64_t>(network_param.VirtualChannelCount(), 1);
+
+  XLS_ASSIGN_OR_RETURN(LogLinearHistogram latency_histogram,
+                       LogLinearHistogram::Create(
+                           shim->options_.max_latency,
+                           shim->options_.sub_bucket_bits));
+
+  for (const SimLink& link : simulator.GetLinks()) {
+    shim->link_connection_indices_.push_back(link.GetSourceConnectionIndex());
+    XLS_ASSIGN_OR_RETURN(std::string name,
+                         GetComponentName(params, link.GetId()));
+    shim->link_names_.push_back(std::move(name));
+  }
+  shim->link_latency_.assign(
+      shim->link_connection_indices_.size() * shim->vc_count_,
+      latency_histogram);
+
+  for (NetworkComponentId source :
+       routing.GetSourceIndices().GetNetworkComponents()) {
+    XLS_ASSIGN_OR_RETURN(std::string name, GetComponentName(params, source));
+    shim->source_names_.push_back(std::move(name));
+  }
+  for (NetworkComponentId sink :
+       routing.GetSinkIndices().GetNetworkComponents()) {
+    XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sim_sink,
+                         simulator.GetSimNetworkInterfaceSink(sink));
+    std::vector<int64_t> connection_indices =
+        sim_sink->GetConnectionIndices(simulator);
+    XLS_RET_CHECK_EQ(connection_indices.size(), 1);
+    shim->sink_connection_indices_.push_back(connection_indices[0]);
+    XLS_ASSIGN_OR_RETURN(std::string name, GetComponentName(params, sink));
+    shim->sink_names_.push_back(std::move(name));
+  }
+  shim->source_count_ = shim->source_names_.size();
+  shim->sink_count_ = shim->sink_names_.size();
+  shim->flow_latency_.assign(
+      shim->source_count_ * shim->sink_count_ * shim->vc_count_,
+      latency_histogram);
+
+  shim->router_occupancy_offset_.push_back(0);
+  for (const SimInputBufferedVCRouter& router : simulator.GetRouters()) {
+    for (int64_t vc = 0; vc < router.GetInputVcCount(); ++vc) {
+      XLS_ASSIGN_OR_RETURN(
+          LogLinearHistogram occupancy_histogram,
+          LogLinearHistogram::Create(
+              router.GetInputVcCapacity(simulator, vc),
+              shim->options_.sub_bucket_bits));
+      shim->router_occupancy_.push_back(std::move(occupancy_histogram));
+    }
+    shim->router_occupancy_offset_.push_back(shim->router_occupancy_.size());
+    XLS_ASSIGN_OR_RETURN(std::string name,
+                         GetComponentName(params, router.GetId()));
+    shim->router_names_.push_back(std::move(name));
+  }
+
+  if (shim->options_.export_path.has_value()) {
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        *shim->options_.export_path,
+        "cycle,metric,name,vc,count,min,mean,p50,p90,p99,max\n"));
+  }
+
+  return shim;
+}
+
+absl::Status NocSimulatorToHistogramMonitorServiceShim::RunCycle() {
+  int64_t cycle = simulator_.GetCurrentCycle();
+
+  for (int64_t i = 0; i < link_connection_indices_.size(); ++i) {
+    const TimedDataFlit& flit =
+        simulator_.GetSimConnectionByIndex(link_connection_indices_[i])
+            .forward_channels;
+    if (flit.cycle != cycle || flit.flit.type == FlitType::kInvalid ||
+        flit.flit.vc >= vc_count_) {
+      continue;
+    }
+    link_latency_[i * vc_count_ + flit.flit.vc].Record(
+        cycle - flit.metadata.injection_cycle_time);
+  }
+
+  for (int64_t i = 0; i < sink_connection_indices_.size(); ++i) {
+    const TimedDataFlit& flit =
+        simulator_.GetSimConnectionByIndex(sink_connection_indices_[i])
+            .forward_channels;
+    if (flit.cycle != cycle || flit.flit.type == FlitType::kInvalid ||
+        flit.flit.vc >= vc_count_ || flit.flit.source_index >= source_count_) {
+      continue;
+    }
+    flow_latency_[FlowIndex(flit.flit.source_index, i, flit.flit.vc)].Record(
+        cycle - flit.metadata.injection_cycle_time);
+  }
+
+  absl::Span<const SimInputBufferedVCRouter> routers = simulator_.GetRouters();
+  for (int64_t r = 0; r < routers.size(); ++r) {
+    for (int64_t vc = 0; vc < routers[r].GetInputVcCount(); ++vc) {
+      router_occupancy_[router_occupancy_offset_[r] + vc].Record(
+          routers[r].GetInputVcOccupancy(simulator_, vc));
+    }
+  }
+
+  if (options_.export_path.has_value() &&
+      (cycle + 1) % options_.export_interval_cycles == 0) {
+    XLS_RETURN_IF_ERROR(Export());
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status NocSimulatorToHistogramMonitorServiceShim::Export() {
+  if (!options_.export_path.has_value()) {
+    return absl::FailedPreconditionError(
+        "No export path given to the histogram monitor.");
+  }
+
+  int64_t cycle = simulator_.GetCurrentCycle();
+  std::string rows;
+  for (int64_t i = 0; i < link_names_.size(); ++i) {
+    for (int64_t vc = 0; vc < vc_count_; ++vc) {
+      const LogLinearHistogram& histogram = GetLinkLatencyHistogram(i, vc);
+      if (histogram.GetCount() > 0) {
+        AppendCsvRow(rows, cycle, "link_latency", link_names_[i], vc,
+                     histogram);
+      }
+    }
+  }
+  for (int64_t src = 0; src < source_count_; ++src) {
+    for (int64_t sink = 0; sink < sink_count_; ++sink) {
+      for (int64_t vc = 0; vc < vc_count_; ++vc) {
+        const LogLinearHistogram& histogram =
+            GetFlowLatencyHistogram(src, sink, vc);
+        if (histogram.GetCount() > 0) {
+          AppendCsvRow(
+              rows, cycle, "flow_latency",
+              absl::StrFormat("%s->%s", source_names_[src], sink_names_[sink]),
+              vc, histogram);
+        }
+      }
+    }
+  }
+  for (int64_t r = 0; r < router_names_.size(); ++r) {
+    for (int64_t vc = 0;
+         vc < router_occupancy_offset_[r + 1] - router_occupancy_offset_[r];
+         ++vc) {
+      const LogLinearHistogram& histogram = GetRouterOccupancyHistogram(r, vc);
+      if (histogram.GetCount() > 0) {
+        AppendCsvRow(rows, cycle, "router_occupancy", router_names_[r], vc,
+                     histogram);
+      }
+    }
+  }
+  return AppendStringToFile(*options_.export_path, rows);
+}
+
+}  // namespace xls::noc
@@ -0,0 +1,127 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef XLS_NOC_SIMULATION_SIMULATOR_TO_HISTOGRAM_MONITOR_SERVICE_SHIM_H_
+#define XLS_NOC_SIMULATION_SIMULATOR_TO_HISTOGRAM_MONITOR_SERVICE_SHIM_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/noc/simulation/histogram.h"
+#include "xls/noc/simulation/sim_objects.h"
+#include "xls/noc/simulation/simulator_shims.h"
+
+namespace xls::noc {
+
+struct HistogramMonitorOptions {
+  // Latencies are tracked up to this many cycles; larger ones are clamped.
+  int64_t max_latency = int64_t{1} << 20;
+
+  // Precision of the latency histograms, see LogLinearHistogram.
+  int64_t sub_bucket_bits = 5;
+
+  // If set, a snapshot of the histograms is appended to this CSV file every
+  // export_interval_cycles cycles.
+  std::optional<std::filesystem::path> export_path;
+  int64_t export_interval_cycles = 10'000;
+};
+
+// Shim to collect latency and occupancy histograms from the simulator.
+//
+// Unlike the traffic recorded by the sinks, the memory used is fixed when the
+// shim is created, and nothing is allocated while the simulation runs. The
+// histograms collected are
+//   - for each link and vc, the latency (cycles since injection) of the
+//     flits entering the link,
+//   - for each flow, ie. (source index, destination index, vc), the latency
+//     of the flits leaving the network at a sink, and
+//   - for each router input vc, the number of flits buffered, sampled every
+//     cycle.
+class NocSimulatorToHistogramMonitorServiceShim
+    : public NocSimulatorServiceShim {
+ public:
+  static absl::StatusOr<
+      std::unique_ptr<NocSimulatorToHistogramMonitorServiceShim>>
+  Create(NocSimulator& simulator, HistogramMonitorOptions options = {});
+
+  absl::Status RunCycle() override;
+
+  // link_index indexes NocSimulator::GetLinks().
+  const LogLinearHistogram& GetLinkLatencyHistogram(int64_t link_index,
+                                                    int64_t vc) const {
+    return link_latency_[link_index * vc_count_ + vc];
+  }
+
+  const LogLinearHistogram& GetFlowLatencyHistogram(int64_t source_index,
+                                                    int64_t destination_index,
+                                                    int64_t vc) const {
+    return flow_latency_[FlowIndex(source_index, destination_index, vc)];
+  }
+
+  // router_index indexes NocSimulator::GetRouters(), see
+  // SimInputBufferedVCRouter::GetInputVcCount() for input_vc.
+  const LogLinearHistogram& GetRouterOccupancyHistogram(
+      int64_t router_index, int64_t input_vc) const {
+    return router_occupancy_[router_occupancy_offset_[router_index] +
+                             input_vc];
+  }
+
+  // Appends a snapshot of all non-empty histograms to the export file.
+  //
+  // Each row is "cycle,metric,name,vc,count,min,mean,p50,p90,p99,max"; the
+  // histograms are cumulative from the start of the simulation.
+  absl::Status Export();
+
+ private:
+  NocSimulatorToHistogramMonitorServiceShim(NocSimulator& simulator,
+                                            HistogramMonitorOptions options)
+      : simulator_(simulator), options_(std::move(options)) {}
+
+  int64_t FlowIndex(int64_t source_index, int64_t destination_index,
+                    int64_t vc) const {
+    return (source_index * sink_count_ + destination_index) * vc_count_ + vc;
+  }
+
+  NocSimulator& simulator_;
+  HistogramMonitorOptions options_;
+
+  int64_t vc_count_ = 1;
+  int64_t source_count_ = 0;
+  int64_t sink_count_ = 0;
+
+  // Connections the links and sinks receive flits from.
+  std::vector<int64_t> link_connection_indices_;
+  std::vector<int64_t> sink_connection_indices_;
+
+  std::vector<LogLinearHistogram> link_latency_;
+  std::vector<LogLinearHistogram> flow_latency_;
+  std::vector<LogLinearHistogram> router_occupancy_;
+  std::vector<int64_t> router_occupancy_offset_;
+
+  // Names used when exporting.
+  std::vector<std::string> link_names_;
+  std::vector<std::string> source_names_;
+  std::vector<std::string> sink_names_;
+  std::vector<std::string> router_names_;
+};
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_SIMULATOR_TO_HISTOGRAM_MONITOR_SERVICE_SHIM_H_
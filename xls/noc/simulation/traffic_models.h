@@ -15,7 +15,9 @@
 #ifndef XLS_NOC_SIMULATION_TRAFFIC_MODELS_H_
 #define XLS_NOC_SIMULATION_TRAFFIC_MODELS_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <type_traits>
 #include <vector>
@@ -45,6 +47,14 @@ class TrafficModel {
   // TODO(tedhong): 2021-06-27 Add an interface to support fast-forwarding.
   virtual std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) = 0;
 
+  // Returns the earliest cycle on which GetNewCyclePackets() may return
+  // packets, or std::numeric_limits<int64_t>::max() if the model will not
+  // send any more packets.
+  //
+  // Calls to GetNewCyclePackets() for the cycles before it return no packets,
+  // so they can be skipped when generating a schedule ahead of time.
+  virtual int64_t GetNextPacketCycle() const = 0;
+
   // Returns expected rate of traffic injected in MebiBytes Per Sec.
   virtual double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const = 0;
 
@@ -140,6 +150,12 @@ class GeneralizedGeometricTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
 
+  int64_t GetNextPacketCycle() const override {
+    // Packets sent on cycle 0 are only due to a burst, see
+    // GetNewCyclePackets().
+    return std::max<int64_t>(next_packet_cycle_, 0);
+  }
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override {
     double num_cycles = 1.0e12 / static_cast<double>(cycle_time_ps);
     double num_packets = lambda_ * num_cycles;
@@ -202,6 +218,12 @@ class ReplayTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
 
+  int64_t GetNextPacketCycle() const override {
+    return clock_cycle_iter_ == clock_cycles_.cend()
+               ? std::numeric_limits<int64_t>::max()
+               : *clock_cycle_iter_;
+  }
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override;
 
   // Sets clock cycles to list and sorts the complete list of clock cycle.
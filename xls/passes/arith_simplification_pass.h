@@ -37,6 +37,8 @@ class ArithSimplificationPass : public OptimizationFunctionBasePass {
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+  bool SkipsUnchangedFunctionBases() const override { return true; }
 };
 
 }  // namespace xls
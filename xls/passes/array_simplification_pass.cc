@@ -50,6 +50,7 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_manager.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/union_query_engine.h"
@@ -1612,12 +1613,13 @@ absl::StatusOr<bool> ArraySimplificationPass::RunOnFunctionBaseInternal(
     PassResults* results) const {
   bool changed = false;
 
-  std::vector<std::unique_ptr<QueryEngine>> query_engines;
-  query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<TernaryQueryEngine>());
-
-  UnionQueryEngine query_engine(std::move(query_engines));
-  XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
+  std::vector<std::unique_ptr<QueryEngine>> owned_engines;
+  XLS_ASSIGN_OR_RETURN(TernaryQueryEngine * ternary_query_engine,
+                       GetPopulatedQueryEngine<TernaryQueryEngine>(
+                           func, options.query_engine_manager, owned_engines));
+  StatelessQueryEngine stateless_query_engine;
+  UnownedUnionQueryEngine query_engine(
+      {&stateless_query_engine, ternary_query_engine});
 
   // Replace known OOB indicates with clamped value. This helps later
   // optimizations.
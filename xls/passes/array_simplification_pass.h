@@ -36,6 +36,8 @@ class ArraySimplificationPass : public OptimizationFunctionBasePass {
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+  bool SkipsUnchangedFunctionBases() const override { return true; }
 };
 
 }  // namespace xls
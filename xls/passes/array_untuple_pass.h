@@ -46,6 +46,8 @@ class ArrayUntuplePass : public OptimizationFunctionBasePass {
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+  bool SkipsUnchangedFunctionBases() const override { return true; }
 };
 }  // namespace xls
 
@@ -38,6 +38,8 @@ class BddCsePass : public OptimizationFunctionBasePass {
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+  bool SkipsUnchangedFunctionBases() const override { return true; }
 };
 
 }  // namespace xls
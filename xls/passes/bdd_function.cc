@@ -320,6 +320,16 @@ class BddStatistics {
   for (const auto& pair : values) {
     bdd_function->node_map_[pair.first] = ToBddNodeVector(pair.second);
   }
+
+  // Expressions which exceeded the path limit were replaced with new variables
+  // and intermediate expressions are no longer needed, so free every node not
+  // reachable from an XLS node's value. The freed slots are reused by queries
+  // which build new expressions.
+  std::vector<BddNodeIndex> roots;
+  for (const auto& [_, bdd_vector] : bdd_function->node_map_) {
+    roots.insert(roots.end(), bdd_vector.begin(), bdd_vector.end());
+  }
+  bdd_function->bdd().GarbageCollect(roots);
   return std::move(bdd_function);
 }
 
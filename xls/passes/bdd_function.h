@@ -35,7 +35,7 @@
 namespace xls {
 
 using BddNodeVector = std::vector<BddNodeIndex>;
-using NodeMap = absl::flat_hash_map<const Node*, BddNodeVector>;
+using BddNodeMap = absl::flat_hash_map<const Node*, BddNodeVector>;
 
 // A class which represents an XLS function using a binary decision diagram
 // (BDD). The BDD is constructed by an abstract evaluation of the operations in
@@ -106,7 +106,7 @@ class BddFunction {
 
   // A map from XLS Node to vector of BDD nodes representing the XLS Node's
   // expression.
-  NodeMap node_map_;
+  BddNodeMap node_map_;
 
   // Set containing the Nodes which have exceeded the maximum number of paths
   // from the XLS node's BDD node to the terminal nodes 0 and 1 in the
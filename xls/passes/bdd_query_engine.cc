@@ -250,6 +250,7 @@ bool BddQueryEngine::AssumingBddQueryEngine::IsFullyKnown(Node* n) const {
 }
 
 absl::StatusOr<ReachedFixpoint> BddQueryEngine::Populate(FunctionBase* f) {
+  ScopedQueryEngineTimer timer(f);
   XLS_ASSIGN_OR_RETURN(bdd_function_,
                        BddFunction::Run(f, path_limit_, node_filter_));
   // Construct the Bits objects indication which bit values are statically known
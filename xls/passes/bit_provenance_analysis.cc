@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "xls/ir/node_map.h"
 #include "xls/passes/bit_provenance_analysis.h"
 
 #include <algorithm>
@@ -22,7 +23,6 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -52,10 +52,13 @@ class BitProvenanceVisitor final : public DataflowVisitor<TreeBitSources> {
   // TODO(allight): With a query engine passed down to DataflowVisitor we could
   // do a better job picking which select branches etc are possible.
 
-  absl::flat_hash_map<Node*, LeafTypeTree<TreeBitSources>>&& map() && {
+  NodeMap<LeafTypeTree<TreeBitSources>>&& map() && {
     return std::move(map_);
   }
 
+  // Every handler only reads operand values and sets the value of its node.
+  bool IsThreadSafe() const override { return true; }
+
   absl::Status DefaultHandler(Node* node) override {
     // Generic node is the sole source of all of its bits.
     XLS_ASSIGN_OR_RETURN(
@@ -270,9 +273,9 @@ class BitProvenanceVisitor final : public DataflowVisitor<TreeBitSources> {
 }  // namespace
 
 /* static */ absl::StatusOr<BitProvenanceAnalysis>
-BitProvenanceAnalysis::Create(FunctionBase* function) {
+BitProvenanceAnalysis::Create(FunctionBase* function, int64_t thread_count) {
   BitProvenanceVisitor prov;
-  XLS_RETURN_IF_ERROR(function->Accept(&prov));
+  XLS_RETURN_IF_ERROR(prov.AcceptLevelParallel(function, thread_count));
   return BitProvenanceAnalysis(std::move(prov).map());
 }
 
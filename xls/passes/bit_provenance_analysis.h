@@ -19,7 +19,6 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
@@ -27,6 +26,7 @@
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 #include "xls/passes/query_engine.h"
 
 namespace xls {
@@ -145,8 +145,10 @@ class TreeBitSources {
 // only concerning itself with tracking bits that vary together precisely.
 class BitProvenanceAnalysis {
  public:
-  // Create a provenance analysis.
-  static absl::StatusOr<BitProvenanceAnalysis> Create(FunctionBase* function);
+  // Create a provenance analysis. If `thread_count` is greater than one, wide
+  // levels of the graph are analyzed on that many threads.
+  static absl::StatusOr<BitProvenanceAnalysis> Create(
+      FunctionBase* function, int64_t thread_count = 1);
 
   // Get the tree-bit-location which provides the original source of the given
   // bit.
@@ -162,10 +164,10 @@ class BitProvenanceAnalysis {
 
  private:
   explicit BitProvenanceAnalysis(
-      absl::flat_hash_map<Node*, LeafTypeTree<TreeBitSources>>&& sources)
+      NodeMap<LeafTypeTree<TreeBitSources>>&& sources)
       : sources_(std::move(sources)) {}
   // Map from a node to the nodes which are the source of each of its bits.
-  absl::flat_hash_map<Node*, LeafTypeTree<TreeBitSources>> sources_;
+  NodeMap<LeafTypeTree<TreeBitSources>> sources_;
 };
 
 }  // namespace xls
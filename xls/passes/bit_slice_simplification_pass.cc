@@ -51,6 +51,7 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_manager.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -60,17 +61,22 @@ namespace xls {
 namespace {
 
 static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
-    FunctionBase* f, int64_t opt_level) {
-  std::vector<std::unique_ptr<QueryEngine>> engines;
-  engines.push_back(std::make_unique<StatelessQueryEngine>());
-  engines.push_back(std::make_unique<TernaryQueryEngine>());
-  if (opt_level >= 3) {
-    engines.push_back(std::make_unique<RangeQueryEngine>());
+    FunctionBase* f, const OptimizationPassOptions& options) {
+  std::vector<std::unique_ptr<QueryEngine>> owned_engines;
+  owned_engines.push_back(std::make_unique<StatelessQueryEngine>());
+  std::vector<QueryEngine*> engines = {owned_engines.back().get()};
+  XLS_ASSIGN_OR_RETURN(TernaryQueryEngine * ternary_query_engine,
+                       GetPopulatedQueryEngine<TernaryQueryEngine>(
+                           f, options.query_engine_manager, owned_engines));
+  engines.push_back(ternary_query_engine);
+  if (options.opt_level >= 3) {
+    XLS_ASSIGN_OR_RETURN(RangeQueryEngine * range_query_engine,
+                         GetPopulatedQueryEngine<RangeQueryEngine>(
+                             f, options.query_engine_manager, owned_engines));
+    engines.push_back(range_query_engine);
   }
-  auto query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
-
-  XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
-  return std::move(query_engine);
+  return std::make_unique<UnionQueryEngine>(std::move(engines),
+                                            std::move(owned_engines));
 }
 
 // If we can identify `scaled_index` as a known multiple of `scale`, return the
@@ -1065,7 +1071,7 @@ absl::StatusOr<bool> BitSliceSimplificationPass::RunOnFunctionBaseInternal(
   bool changed = false;
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
-                       GetQueryEngine(f, options.opt_level));
+                       GetQueryEngine(f, options));
 
   // Iterating through these operations in reverse topological order makes sure
   // we don't need to re-populate the query engine between nodes.
@@ -28,6 +28,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -121,17 +122,17 @@ class InterestingNodeFinder final : public DfsVisitorWithDefault {
 
 // Class to hold givens extracted from select context.
 //
-// This also restricts the range analysis to end at the select we are
-// specializing on since nodes below it can only be specialized to this select
-// if we moved them into the selects branches. This sort of transform is not one
-// we currently perform.
+// The analysis only computes the ranges of the nodes which are affected by the
+// select context (in topological order); every other node visited has its
+// ranges given, either from the context or from the base ranges. The nodes
+// with given ranges must be visited before the nodes whose ranges are
+// computed.
 class ContextGivens final : public RangeDataProvider {
  public:
-  ContextGivens(const std::vector<Node*>& topo_sort, const Node* finish,
+  ContextGivens(std::vector<Node*> order,
                 const absl::flat_hash_map<Node*, RangeData>& data,
                 std::function<std::optional<RangeData>(Node*)> memoized_data)
-      : topo_sort_(topo_sort),
-        finish_(finish),
+      : order_(std::move(order)),
         data_(data),
         memoized_data_(std::move(memoized_data)) {}
 
@@ -143,19 +144,15 @@ class ContextGivens final : public RangeDataProvider {
   }
 
   absl::Status IterateFunction(DfsVisitor* visitor) final {
-    for (Node* n : topo_sort_) {
-      if (n == finish_) {
-        break;
-      }
+    for (Node* n : order_) {
       XLS_RETURN_IF_ERROR(n->VisitSingleNode(visitor));
     }
     return absl::OkStatus();
   }
 
  private:
-  const std::vector<Node*>& topo_sort_;
-  const Node* finish_;
-  const absl::flat_hash_map<Node*, RangeData> data_;
+  const std::vector<Node*> order_;
+  const absl::flat_hash_map<Node*, RangeData>& data_;
   std::function<std::optional<RangeData>(Node*)> memoized_data_;
 };
 
@@ -176,227 +173,161 @@ struct SelectorAndArm {
   }
 };
 
-struct EquivalenceSet {
-  std::vector<PredicateState> equivalent_states;
-  InlineBitmap interesting_nodes;
+struct InterestingStatesAndNodeList {
+  absl::flat_hash_map<Node*, int64_t> node_indices;
+  std::vector<std::pair<PredicateState, InlineBitmap>> state_and_nodes;
 };
 
-// Helper to perform the actual analysis and hold together all data needed.
-// This is used to fill in the fields of the actual query engine and therefore
-// does not own the arena/map that it fills in.
-class Analysis {
- public:
-  struct InterestingStatesAndNodeList {
-    absl::flat_hash_map<Node*, int64_t> node_indices;
-    std::vector<std::pair<PredicateState, InlineBitmap>> state_and_nodes;
-  };
-  Analysis(
-      RangeQueryEngine& base_range,
-      std::vector<std::unique_ptr<const RangeQueryEngine>>& arena,
-      absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines)
-      : base_range_(base_range), arena_(arena), engines_(engines) {}
-
-  absl::StatusOr<ReachedFixpoint> Execute(FunctionBase* f) {
-    // Get the topological sort once so we don't recalculate it each time.
-    topo_sort_ = TopoSort(f);
-    // Get the base case.
-    absl::flat_hash_map<Node*, RangeData> empty;
-    ContextGivens base_givens(
-        topo_sort_, /*finish=*/nullptr,
-        /* data=*/empty,
-        [](auto n) -> std::optional<RangeData> { return std::nullopt; });
-    XLS_RETURN_IF_ERROR(base_range_.PopulateWithGivens(base_givens).status());
-
-    // Get every possible one-hot state.
-
-    std::vector<PredicateState> all_states;
-    // Iterate in same order we walk.
-    for (Node* n : topo_sort_) {
-      // TODO(allight): Support priority-select
-      if (n->Is<Select>()) {
-        for (int64_t idx = 0; idx < n->As<Select>()->cases().size(); ++idx) {
-          all_states.push_back(PredicateState(n->As<Select>(), idx));
-        }
-        if (n->As<Select>()->default_value().has_value()) {
-          all_states.push_back(
-              PredicateState(n->As<Select>(), PredicateState::kDefaultArm));
-        }
-      }
+// Get rid of any predicate-states that we can statically tell won't affect
+// anything. A predicate state where the values that impact the selector don't
+// impact the selected value in any meaningful way will not show any
+// differences in the calculated ranges so no need to calculate them at all.
+absl::StatusOr<InterestingStatesAndNodeList> FilterUninterestingStates(
+    FunctionBase* f, const RangeQueryEngine& base_range,
+    const std::vector<PredicateState>& states) {
+  std::vector<Node*> select_nodes;
+  std::vector<Node*> selectee_nodes;
+  // Calculate all nodes which depend on or are depended on by either selector
+  // values or the selected values.
+  //
+  // We do this in one pass so find all the interesting nodes first.
+  for (const PredicateState& s : states) {
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<Node*> interesting,
+        InterestingNodeFinder::Execute(base_range, s.selector()));
+    absl::c_copy(interesting, std::back_inserter(select_nodes));
+    selectee_nodes.push_back(s.value());
+  }
+  NodeDependencyAnalysis forward_interesting(
+      NodeDependencyAnalysis::ForwardDependents(f, select_nodes));
+  NodeDependencyAnalysis backwards_interesting(
+      NodeDependencyAnalysis::BackwardDependents(f, selectee_nodes));
+  std::vector<std::pair<PredicateState, InlineBitmap>> interesting_states;
+  interesting_states.reserve(states.size());
+  for (const PredicateState& ps : states) {
+    // If there's any node which is both an input into the select value and
+    // affected by something the conditional specialization can discover we
+    // consider it interesting.
+    InlineBitmap forward_bm(f->node_count(), false);
+    // What nodes do we care about for this specific run. Since this basically
+    // only depends on the input node no need to memoize it.
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<Node*> interesting,
+        InterestingNodeFinder::Execute(base_range, ps.selector()));
+    for (Node* n : interesting) {
+      XLS_ASSIGN_OR_RETURN(auto deps, forward_interesting.GetDependents(n));
+      forward_bm.Union(deps.bitmap());
     }
-    XLS_ASSIGN_OR_RETURN(auto interesting,
-                         FilterUninterestingStates(f, all_states));
-    // Bucket states into equivalence classes. Any predicate-states where the
-    // arm and selector are identical
-    absl::flat_hash_map<SelectorAndArm, EquivalenceSet> equivalences;
-    equivalences.reserve(interesting.state_and_nodes.size());
-    for (const auto& [state, interesting_nodes] : interesting.state_and_nodes) {
-      EquivalenceSet& cur =
-          equivalences
-              .try_emplace(
-                  SelectorAndArm{
-                      .selector = state.node()->As<Select>()->selector(),
-                      .arm = state.arm()},
-                  EquivalenceSet{
-                      .equivalent_states = {},
-                      .interesting_nodes = InlineBitmap(f->node_count())})
-              .first->second;
-      cur.equivalent_states.push_back(state);
-      cur.interesting_nodes.Union(interesting_nodes);
+    XLS_ASSIGN_OR_RETURN(auto backwards_bm,
+                         backwards_interesting.GetDependents(ps.value()));
+    // Nodes that the selector affects & nodes the selected value is affected
+    // by is the set of nodes with potentially changed conditional ranges.
+    InlineBitmap final_bm = forward_bm;
+    final_bm.Intersect(backwards_bm.bitmap());
+    if (!final_bm.IsAllZeroes()) {
+      // nodes affected by the known data are the ones we need to recalculate.
+      interesting_states.push_back({ps, std::move(forward_bm)});
     }
-    // NB We don't care what order we examine each equivalence (since all are
-    // disjoint).
-    for (const auto& [_, states] : equivalences) {
-      // Since the all_states_ is in topo the last equiv state is usable for
-      // everything.
-      // We don't care what order we calculate the equivalences because each is
-      // fully disjoint from one another as we consider only a single condition
-      // to be true at a time.
-      XLS_ASSIGN_OR_RETURN(auto tmp,
-                           CalculateRangeGiven(states.equivalent_states.back(),
-                                               states.interesting_nodes,
-                                               interesting.node_indices));
-      auto result =
-          arena_
-              .emplace_back(std::make_unique<RangeQueryEngine>(std::move(tmp)))
-              .get();
-      for (const PredicateState& ps : states.equivalent_states) {
-        engines_[ps] = result;
-      }
-    }
-    return ReachedFixpoint::Changed;
   }
+  return InterestingStatesAndNodeList{
+      .node_indices = backwards_interesting.node_indices(),
+      .state_and_nodes = interesting_states};
+}
 
- private:
-  // Get rid of any predicate-states that we can statically tell won't affect
-  // anything. A predicate state where the values that impact the selector don't
-  // impact the selected value in any meaningful way will not show any
-  // differences in the calculated ranges so no need to calculate them at all.
-  absl::StatusOr<InterestingStatesAndNodeList> FilterUninterestingStates(
-      FunctionBase* f, const std::vector<PredicateState>& states) {
-    std::vector<Node*> select_nodes;
-    std::vector<Node*> selectee_nodes;
-    // Calculate all nodes which depend on or are depended on by either selector
-    // values or the selected values.
-    //
-    // We do this in one pass so find all the interesting nodes first.
-    for (const PredicateState& s : states) {
-      XLS_ASSIGN_OR_RETURN(
-          std::vector<Node*> interesting,
-          InterestingNodeFinder::Execute(base_range_, s.selector()));
-      absl::c_copy(interesting, std::back_inserter(select_nodes));
-      selectee_nodes.push_back(s.value());
-    }
-    NodeDependencyAnalysis forward_interesting(
-        NodeDependencyAnalysis::ForwardDependents(f, select_nodes));
-    NodeDependencyAnalysis backwards_interesting(
-        NodeDependencyAnalysis::BackwardDependents(f, selectee_nodes));
-    std::vector<std::pair<PredicateState, InlineBitmap>> interesting_states;
-    interesting_states.reserve(states.size());
-    for (const PredicateState& ps : states) {
-      // If there's any node which is both an input into the select value and
-      // affected by something the conditional specialization can discover we
-      // consider it interesting.
-      InlineBitmap forward_bm(f->node_count(), false);
-      // What nodes do we care about for this specific run. Since this basically
-      // only depends on the input node no need to memoize it.
-      XLS_ASSIGN_OR_RETURN(
-          std::vector<Node*> interesting,
-          InterestingNodeFinder::Execute(base_range_, ps.selector()));
-      for (Node* n : interesting) {
-        XLS_ASSIGN_OR_RETURN(auto deps, forward_interesting.GetDependents(n));
-        forward_bm.Union(deps.bitmap());
-      }
-      XLS_ASSIGN_OR_RETURN(auto backwards_bm,
-                           backwards_interesting.GetDependents(ps.value()));
-      // Nodes that the selector affects & nodes the selected value is affected
-      // by is the set of nodes with potentially changed conditional ranges.
-      InlineBitmap final_bm = forward_bm;
-      final_bm.Intersect(backwards_bm.bitmap());
-      if (!final_bm.IsAllZeroes()) {
-        // nodes affected by the known data are the ones we need to recalculate.
-        interesting_states.push_back({ps, std::move(forward_bm)});
-      }
-    }
-    return InterestingStatesAndNodeList{
-        .node_indices = backwards_interesting.node_indices(),
-        .state_and_nodes = interesting_states};
-  }
-  absl::StatusOr<RangeQueryEngine> CalculateRangeGiven(
-      PredicateState s, const InlineBitmap& interesting_nodes,
-      const absl::flat_hash_map<Node*, int64_t>& node_ids) const {
-    RangeQueryEngine result;
-    absl::flat_hash_map<Node*, RangeData> known_data;
-    XLS_ASSIGN_OR_RETURN(known_data, ExtractKnownData(s));
-    ContextGivens givens(
-        topo_sort_, s.node(), known_data,
-        [&](Node* n) -> std::optional<RangeData> {
-          if (interesting_nodes.Get(node_ids.at(n))) {
-            // Affected by known data.
-            return std::nullopt;
-          }
-          // return memoized value from base
-          std::optional<SharedLeafTypeTree<TernaryVector>> ternary =
-              n->GetType()->IsBits() ? base_range_.GetTernary(n) : std::nullopt;
-          return RangeData{
-              .ternary = ternary.has_value()
-                             ? std::make_optional(ternary->Get({}))
-                             : std::nullopt,
-              .interval_set = base_range_.GetIntervals(n),
-          };
-        });
-    XLS_RETURN_IF_ERROR(result.PopulateWithGivens(givens).status());
-    return result;
-  }
-
-  absl::StatusOr<absl::flat_hash_map<Node*, RangeData>> ExtractKnownData(
-      PredicateState s) const {
-    XLS_RET_CHECK(!s.IsBasePredicate())
-        << "Can't back-propagate base predicate!";
-    Select* select_node = s.node()->As<Select>();
-    Node* selector = select_node->selector();
-    CHECK(selector->GetType()->IsBits()) << "Non-bits select: " << *selector;
-    IntervalSet given(selector->GetType()->GetFlatBitCount());
-    if (s.IsDefaultArm()) {
-      given.AddInterval(Interval(
-          UBits(select_node->cases().size(), selector->BitCountOrDie()),
-          Bits::AllOnes(selector->BitCountOrDie())));
+RangeData BaseRangeData(const RangeQueryEngine& base_range, Node* node) {
+  std::optional<SharedLeafTypeTree<TernaryVector>> ternary =
+      node->GetType()->IsBits() ? base_range.GetTernary(node) : std::nullopt;
+  return RangeData{
+      .ternary = ternary.has_value() ? std::make_optional(ternary->Get({}))
+                                     : std::nullopt,
+      .interval_set = base_range.GetIntervals(node),
+  };
+}
+
+absl::StatusOr<absl::flat_hash_map<Node*, RangeData>> ExtractKnownData(
+    const RangeQueryEngine& base_range, PredicateState s) {
+  XLS_RET_CHECK(!s.IsBasePredicate())
+      << "Can't back-propagate base predicate!";
+  Select* select_node = s.node()->As<Select>();
+  Node* selector = select_node->selector();
+  XLS_RET_CHECK(selector->GetType()->IsBits())
+      << "Non-bits select: " << *selector;
+  IntervalSet given(selector->GetType()->GetFlatBitCount());
+  if (s.IsDefaultArm()) {
+    given.AddInterval(Interval(
+        UBits(select_node->cases().size(), selector->BitCountOrDie()),
+        Bits::AllOnes(selector->BitCountOrDie())));
+  } else {
+    Bits value = UBits(s.arm_index(), selector->BitCountOrDie());
+    given = IntervalSet::Precise(value);
+  }
+  given.Normalize();
+  XLS_ASSIGN_OR_RETURN(
+      (absl::flat_hash_map<Node*, IntervalSet> intervals),
+      PropagateOneGivenBackwards(base_range, selector, given));
+  absl::flat_hash_map<Node*, RangeData> ranges;
+  ranges.reserve(intervals.size());
+  for (auto [node, interval] : std::move(intervals)) {
+    if (interval.IsEmpty()) {
+      // This case is actually impossible? For now just ignore.
+      // TODO: Figure out some way to communicate this.
+      ranges[node] = BaseRangeData(base_range, node);
     } else {
-      Bits value = UBits(s.arm_index(), selector->BitCountOrDie());
-      given = IntervalSet::Precise(value);
+      ranges[node] =
+          RangeData{.ternary = interval_ops::ExtractTernaryVector(interval),
+                    .interval_set = IntervalSetTree::CreateSingleElementTree(
+                        node->GetType(), std::move(interval))};
     }
-    given.Normalize();
-    XLS_ASSIGN_OR_RETURN(
-        (absl::flat_hash_map<Node*, IntervalSet> intervals),
-        PropagateOneGivenBackwards(base_range_, selector, given));
-    absl::flat_hash_map<Node*, RangeData> ranges;
-    ranges.reserve(intervals.size());
-    for (auto [node, interval] : std::move(intervals)) {
-      if (interval.IsEmpty()) {
-        // This case is actually impossible? For now just ignore.
-        // TODO: Figure out some way to communicate this.
-        std::optional<SharedLeafTypeTree<TernaryVector>> ternary =
-            base_range_.GetTernary(node);
-        ranges[node] = RangeData{
-            .ternary = ternary.has_value()
-                           ? std::make_optional(ternary->Get({}))
-                           : std::nullopt,
-            .interval_set = base_range_.GetIntervals(node),
-        };
-      } else {
-        ranges[node] =
-            RangeData{.ternary = interval_ops::ExtractTernaryVector(interval),
-                      .interval_set = IntervalSetTree::CreateSingleElementTree(
-                          node->GetType(), std::move(interval))};
+  }
+  return ranges;
+}
+
+// Calculates the ranges given the predicate state `s`. Only the nodes in
+// `computed` (which must be in topological order) have their ranges
+// recalculated. Their other operands and the nodes constrained by `s` have
+// their ranges given.
+absl::StatusOr<RangeQueryEngine> CalculateRangeGiven(
+    const RangeQueryEngine& base_range, PredicateState s,
+    const std::vector<Node*>& computed) {
+  XLS_ASSIGN_OR_RETURN((absl::flat_hash_map<Node*, RangeData> known_data),
+                       ExtractKnownData(base_range, s));
+  absl::flat_hash_set<Node*> computed_set(computed.begin(), computed.end());
+  std::vector<Node*> given;
+  absl::flat_hash_set<Node*> given_set;
+  for (Node* n : computed) {
+    for (Node* operand : n->operands()) {
+      if (!computed_set.contains(operand) &&
+          given_set.insert(operand).second) {
+        given.push_back(operand);
       }
     }
-    return ranges;
   }
-
-  std::vector<Node*> topo_sort_;
-  RangeQueryEngine& base_range_;
-  std::vector<std::unique_ptr<const RangeQueryEngine>>& arena_;
-  absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines_;
-};
+  for (const auto& [n, _] : known_data) {
+    if (!computed_set.contains(n) && given_set.insert(n).second) {
+      given.push_back(n);
+    }
+  }
+  // The order of the given nodes does not affect the result but keep it
+  // deterministic anyway.
+  std::sort(given.begin(), given.end(),
+            [](Node* a, Node* b) { return a->id() < b->id(); });
+  std::vector<Node*> order = std::move(given);
+  absl::c_copy(computed, std::back_inserter(order));
+
+  RangeQueryEngine result;
+  ContextGivens givens(
+      std::move(order), known_data,
+      [&](Node* n) -> std::optional<RangeData> {
+        if (computed_set.contains(n)) {
+          // Affected by known data.
+          return std::nullopt;
+        }
+        // return memoized value from base
+        return BaseRangeData(base_range, n);
+      });
+  XLS_RETURN_IF_ERROR(result.PopulateWithGivens(givens).status());
+  return result;
+}
 
 // A proxy query engine which specializes using select context.
 class ProxyContextQueryEngine final : public QueryEngine {
@@ -519,20 +450,6 @@ class ProxyContextQueryEngine final : public QueryEngine {
   const RangeQueryEngine& range_data_;
 };
 
-std::vector<std::unique_ptr<QueryEngine>> SpecializedForArms(
-    const ContextSensitiveRangeQueryEngine* base, Select* n) {
-  std::vector<std::unique_ptr<QueryEngine>> res;
-  res.reserve(n->operand_count() - 1);
-  for (int64_t i = 0; i < n->As<Select>()->cases().size(); ++i) {
-    res.push_back(
-        base->SpecializeGivenPredicate({PredicateState(n->As<Select>(), i)}));
-  }
-  if (n->As<Select>()->default_value()) {
-    res.push_back(base->SpecializeGivenPredicate(
-        {PredicateState(n->As<Select>(), PredicateState::kDefaultArm)}));
-  }
-  return res;
-}
 std::vector<Interval> GetBranchIntervals(Select* n) {
   std::vector<Interval> res;
   res.reserve(n->operand_count() - 1);
@@ -546,57 +463,173 @@ std::vector<Interval> GetBranchIntervals(Select* n) {
   }
   return res;
 }
+
+std::vector<PredicateState> GetBranchStates(Select* n) {
+  std::vector<PredicateState> res;
+  res.reserve(n->operand_count() - 1);
+  for (int64_t i = 0; i < n->cases().size(); ++i) {
+    res.push_back(PredicateState(n, i));
+  }
+  if (n->default_value()) {
+    res.push_back(PredicateState(n, PredicateState::kDefaultArm));
+  }
+  return res;
+}
 }  // namespace
 
 absl::StatusOr<ReachedFixpoint> ContextSensitiveRangeQueryEngine::Populate(
     FunctionBase* f) {
-  Analysis analysis(base_case_ranges_, arena_, one_hot_ranges_);
-  XLS_ASSIGN_OR_RETURN(ReachedFixpoint fixpoint, analysis.Execute(f));
-  // Fill in select ranges before any changes occur to the function.
-  for (Node* n : TopoSort(f)) {
+  removed_node_ids_ = f->TrackNodeRemovals();
+  // Get the topological sort once so we don't recalculate it each time.
+  topo_sort_ = TopoSort(f);
+  original_ids_.clear();
+  original_ids_.reserve(topo_sort_.size());
+  for (Node* n : topo_sort_) {
+    original_ids_[n] = n->id();
+  }
+
+  // Get the base case.
+  absl::flat_hash_map<Node*, RangeData> empty;
+  ContextGivens base_givens(
+      topo_sort_, /* data=*/empty,
+      [](auto n) -> std::optional<RangeData> { return std::nullopt; });
+  XLS_RETURN_IF_ERROR(base_case_ranges_.PopulateWithGivens(base_givens).status());
+
+  // Get every possible one-hot state.
+  std::vector<PredicateState> all_states;
+  // Iterate in same order we walk.
+  for (Node* n : topo_sort_) {
     // TODO(allight): Support priority-select
     if (n->Is<Select>()) {
-      std::optional<RangeData> data;
-      IntervalSet selector_interval =
-          GetIntervals(n->As<Select>()->selector()).Get({});
-      for (const auto& [branch, qe, branch_req_interval] :
-           iter::zip(n->operands().subspan(1),
-                     SpecializedForArms(this, n->As<Select>()),
-                     GetBranchIntervals(n->As<Select>()))) {
-        if (IntervalSet::Disjoint(selector_interval,
-                                  IntervalSet::Of({branch_req_interval}))) {
-          // Selector cannot actually take this branch.
-          continue;
-        }
-        if (!data) {
-          data = RangeData{
-              .ternary =
-                  n->GetType()->IsBits()
-                      ? std::make_optional(qe->GetTernary(branch)->Get({}))
-                      : std::nullopt,
-              .interval_set = qe->GetIntervals(branch),
-          };
-        } else {
-          XLS_RETURN_IF_ERROR(
-              (leaf_type_tree::UpdateFrom<IntervalSet, IntervalSet>(
-                  data->interval_set.AsMutableView(),
-                  qe->GetIntervals(branch).AsView(),
-                  [](Type* t, IntervalSet& l, const IntervalSet& r,
-                     absl::Span<int64_t const> idx) -> absl::Status {
-                    l = IntervalSet::Combine(l, r);
-                    return absl::OkStatus();
-                  })));
-          if (data->ternary) {
-            ternary_ops::UpdateWithIntersection(
-                *data->ternary, qe->GetTernary(branch)->Get({}));
-          }
-        }
+      absl::c_copy(GetBranchStates(n->As<Select>()),
+                   std::back_inserter(all_states));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(
+      InterestingStatesAndNodeList interesting,
+      FilterUninterestingStates(f, base_case_ranges_, all_states));
+  node_indices_ = std::move(interesting.node_indices);
+
+  // Bucket states into equivalence classes. Any predicate-states where the
+  // arm and selector are identical have the same specialized ranges. Since the
+  // states are in topological order the last state of each class is usable for
+  // everything. The ranges themselves are only computed when first asked for.
+  absl::flat_hash_map<SelectorAndArm, int64_t> equivalences;
+  classes_.clear();
+  class_indices_.clear();
+  select_ranges_.clear();
+  for (auto& [state, interesting_nodes] : interesting.state_and_nodes) {
+    auto [it, inserted] = equivalences.try_emplace(
+        SelectorAndArm{.selector = state.node()->As<Select>()->selector(),
+                       .arm = state.arm()},
+        classes_.size());
+    if (inserted) {
+      classes_.push_back(EquivalenceClass{
+          .representative = state,
+          .interesting_nodes = InlineBitmap(f->node_count()),
+      });
+    }
+    EquivalenceClass& cur = classes_[it->second];
+    cur.representative = state;
+    cur.interesting_nodes.Union(interesting_nodes);
+    class_indices_[state] = it->second;
+  }
+  return ReachedFixpoint::Changed;
+}
+
+bool ContextSensitiveRangeQueryEngine::IsOriginalNode(Node* node) const {
+  // A removed node's address may have been reused by a new node, so check the
+  // id recorded for the address rather than looking at the node itself.
+  auto it = original_ids_.find(node);
+  return it != original_ids_.end() && !removed_node_ids_->contains(it->second);
+}
+
+const RangeQueryEngine* ContextSensitiveRangeQueryEngine::GetSpecializedRanges(
+    int64_t class_index) const {
+  EquivalenceClass& equivalence = classes_[class_index];
+  if (equivalence.computed) {
+    return equivalence.ranges.get();
+  }
+  equivalence.computed = true;
+
+  // Only the affected nodes which precede the select need recalculating;
+  // nodes below it could only be specialized to this select if we moved them
+  // into the select's branches, which is not a transform we currently perform.
+  const PredicateState& state = equivalence.representative;
+  if (!IsOriginalNode(state.node())) {
+    return nullptr;
+  }
+  std::vector<Node*> computed;
+  for (Node* n : topo_sort_) {
+    if (n == state.node()) {
+      break;
+    }
+    if (equivalence.interesting_nodes.Get(node_indices_.at(n))) {
+      if (!IsOriginalNode(n)) {
+        VLOG(3) << "Not specializing ranges for " << state
+                << " as the function has changed";
+        return nullptr;
+      }
+      computed.push_back(n);
+    }
+  }
+  absl::StatusOr<RangeQueryEngine> ranges =
+      CalculateRangeGiven(base_case_ranges_, state, computed);
+  if (!ranges.ok()) {
+    LOG(WARNING) << "Unable to specialize ranges for " << state << ": "
+                 << ranges.status();
+    return nullptr;
+  }
+  equivalence.ranges =
+      std::make_unique<const RangeQueryEngine>(*std::move(ranges));
+  return equivalence.ranges.get();
+}
+
+const RangeData* ContextSensitiveRangeQueryEngine::GetSelectRanges(
+    Node* node) const {
+  // TODO(allight): Support priority-select
+  if (!node->Is<Select>() || !IsOriginalNode(node)) {
+    return nullptr;
+  }
+  if (auto it = select_ranges_.find(node); it != select_ranges_.end()) {
+    return it->second.has_value() ? &*it->second : nullptr;
+  }
+  Select* select = node->As<Select>();
+  std::optional<RangeData> data;
+  IntervalSet selector_interval = GetIntervals(select->selector()).Get({});
+  for (const auto& [branch, state, branch_req_interval] :
+       iter::zip(select->operands().subspan(1), GetBranchStates(select),
+                 GetBranchIntervals(select))) {
+    if (IntervalSet::Disjoint(selector_interval,
+                              IntervalSet::Of({branch_req_interval}))) {
+      // Selector cannot actually take this branch.
+      continue;
+    }
+    std::unique_ptr<QueryEngine> qe = SpecializeGivenPredicate({state});
+    if (!data) {
+      data = RangeData{
+          .ternary = select->GetType()->IsBits()
+                         ? std::make_optional(qe->GetTernary(branch)->Get({}))
+                         : std::nullopt,
+          .interval_set = qe->GetIntervals(branch),
+      };
+    } else {
+      CHECK_OK((leaf_type_tree::UpdateFrom<IntervalSet, IntervalSet>(
+          data->interval_set.AsMutableView(), qe->GetIntervals(branch).AsView(),
+          [](Type* t, IntervalSet& l, const IntervalSet& r,
+             absl::Span<int64_t const> idx) -> absl::Status {
+            l = IntervalSet::Combine(l, r);
+            return absl::OkStatus();
+          })));
+      if (data->ternary) {
+        ternary_ops::UpdateWithIntersection(*data->ternary,
+                                            qe->GetTernary(branch)->Get({}));
       }
-      XLS_RET_CHECK(data) << "No branch is selectable for " << n;
-      select_ranges_[n] = *std::move(data);
     }
   }
-  return fixpoint;
+  // If no branch is selectable the select is unreachable; use the base ranges.
+  auto [it, _] = select_ranges_.emplace(node, std::move(data));
+  return it->second.has_value() ? &*it->second : nullptr;
 }
 
 std::unique_ptr<QueryEngine>
@@ -608,45 +641,56 @@ ContextSensitiveRangeQueryEngine::SpecializeGivenPredicate(
   // don't have any particular strategy for picking which one gets to be the
   // 'real' state just using 'begin'.
   CHECK_LE(state.size(), 1);
-  if (state.empty() || !one_hot_ranges_.contains(*state.cbegin())) {
+  if (state.empty()) {
+    return QueryEngine::SpecializeGivenPredicate(state);
+  }
+  auto it = class_indices_.find(*state.cbegin());
+  if (it == class_indices_.end()) {
+    return QueryEngine::SpecializeGivenPredicate(state);
+  }
+  const RangeQueryEngine* ranges = GetSpecializedRanges(it->second);
+  if (ranges == nullptr) {
     return QueryEngine::SpecializeGivenPredicate(state);
   }
-  return std::make_unique<ProxyContextQueryEngine>(
-      *this, *one_hot_ranges_.at(*state.cbegin()));
+  return std::make_unique<ProxyContextQueryEngine>(*this, *ranges);
 }
 
 LeafTypeTree<IntervalSet> ContextSensitiveRangeQueryEngine::GetIntervals(
     Node* node) const {
-  if (!node->OpIn({Op::kSel}) || !select_ranges_.contains(node)) {
+  const RangeData* select_ranges = GetSelectRanges(node);
+  if (select_ranges == nullptr) {
     return base_case_ranges_.GetIntervals(node);
   }
-  return select_ranges_.at(node).interval_set;
+  return select_ranges->interval_set;
 }
 
 std::optional<SharedLeafTypeTree<TernaryVector>>
 ContextSensitiveRangeQueryEngine::GetTernary(Node* node) const {
-  if (!node->OpIn({Op::kSel}) || !select_ranges_.contains(node)) {
+  const RangeData* select_ranges = GetSelectRanges(node);
+  if (select_ranges == nullptr) {
     return base_case_ranges_.GetTernary(node);
   }
-  if (!select_ranges_.at(node).ternary) {
+  if (!select_ranges->ternary) {
     return std::nullopt;
   }
   return LeafTypeTree<TernaryVector>::CreateSingleElementTree(
-             node->GetType(), *select_ranges_.at(node).ternary)
+             node->GetType(), *select_ranges->ternary)
       .AsShared();
 }
 Bits ContextSensitiveRangeQueryEngine::MaxUnsignedValue(Node* node) const {
-  if (!node->OpIn({Op::kSel}) || !select_ranges_.contains(node)) {
+  const RangeData* select_ranges = GetSelectRanges(node);
+  if (select_ranges == nullptr) {
     return base_case_ranges_.MaxUnsignedValue(node);
   }
-  return select_ranges_.at(node).interval_set.Get({}).UpperBound().value_or(
+  return select_ranges->interval_set.Get({}).UpperBound().value_or(
       Bits::AllOnes(node->BitCountOrDie()));
 }
 Bits ContextSensitiveRangeQueryEngine::MinUnsignedValue(Node* node) const {
-  if (!node->OpIn({Op::kSel}) || !select_ranges_.contains(node)) {
+  const RangeData* select_ranges = GetSelectRanges(node);
+  if (select_ranges == nullptr) {
     return base_case_ranges_.MinUnsignedValue(node);
   }
-  return select_ranges_.at(node).interval_set.Get({}).LowerBound().value_or(
+  return select_ranges->interval_set.Get({}).LowerBound().value_or(
       Bits(node->BitCountOrDie()));
 }
 
@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 #define XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -24,6 +25,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_base.h"
@@ -46,6 +48,14 @@ namespace xls {
 // given their selector is at the appropriate value and propagating that down
 // for each single case. This means the engine is only able to provide
 // information for a single case at a time.
+//
+// Populate only computes the base ranges and which nodes each case could
+// affect. The ranges given a case are computed the first time they are asked
+// for (through SpecializeGivenPredicate or the ranges of a select) and cover
+// only the affected nodes; every other node shares the base ranges. If the
+// function has been modified since Populate, specialized ranges are only
+// computed if all the affected nodes still exist, otherwise the base ranges are
+// used. Like other query engines this is not thread-safe.
 class ContextSensitiveRangeQueryEngine final : public QueryEngine {
  public:
   ContextSensitiveRangeQueryEngine() = default;
@@ -119,10 +129,42 @@ class ContextSensitiveRangeQueryEngine final : public QueryEngine {
   Bits MinUnsignedValue(Node* node) const override;
 
  private:
+  // A set of predicate states which give the same selector the same value and
+  // so share their specialized ranges.
+  struct EquivalenceClass {
+    // The state whose select is last in topological order. Specialized ranges
+    // are computed up to this select.
+    PredicateState representative;
+    // The nodes whose ranges might be changed by the state, indexed by
+    // `node_indices_`.
+    InlineBitmap interesting_nodes;
+    bool computed = false;
+    // The specialized ranges or nullptr if they could not be computed.
+    std::unique_ptr<const RangeQueryEngine> ranges;
+  };
+
+  // Returns the ranges specialized for the given equivalence class, computing
+  // them on first use, or nullptr if there are none.
+  const RangeQueryEngine* GetSpecializedRanges(int64_t class_index) const;
+
+  // Returns the ranges of `select` as the union of the ranges of its
+  // selectable arms, computing them on first use, or nullptr if there are none.
+  const RangeData* GetSelectRanges(Node* select) const;
+
+  // Returns true if `node` is a node which existed when the engine was
+  // populated and is still in the function.
+  bool IsOriginalNode(Node* node) const;
+
   RangeQueryEngine base_case_ranges_;
-  std::vector<std::unique_ptr<const RangeQueryEngine>> arena_;
-  absl::flat_hash_map<PredicateState, const RangeQueryEngine*> one_hot_ranges_;
-  absl::flat_hash_map<Node*, RangeData> select_ranges_;
+  std::vector<Node*> topo_sort_;
+  // The ids of the nodes when the engine was populated.
+  absl::flat_hash_map<Node*, int64_t> original_ids_;
+  absl::flat_hash_map<Node*, int64_t> node_indices_;
+  absl::flat_hash_map<PredicateState, int64_t> class_indices_;
+  mutable std::vector<EquivalenceClass> classes_;
+  mutable absl::flat_hash_map<Node*, std::optional<RangeData>> select_ranges_;
+  // The ids of the nodes removed from the function since it was populated.
+  std::shared_ptr<const absl::flat_hash_set<int64_t>> removed_node_ids_;
 };
 
 }  // namespace xls
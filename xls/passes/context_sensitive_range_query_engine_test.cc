@@ -37,7 +37,10 @@
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/ir/value_builder.h"
 #include "xls/passes/predicate_state.h"
 #include "xls/passes/range_query_engine.h"
@@ -314,6 +317,92 @@ TEST_F(ContextSensitiveRangeQueryEngineTest, Eq) {
   EXPECT_EQ(consequent_arm_range->GetIntervals(res.node()), res_ist);
 }
 
+TEST_F(ContextSensitiveRangeQueryEngineTest,
+       SpecializationAfterUnrelatedModification) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+
+  // if (x == 12) { x + 10 } else { x }
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue cond = fb.Eq(x, fb.Literal(UBits(12, 8)));
+  BValue add_ten = fb.Add(x, fb.Literal(UBits(10, 8)));
+  BValue res = fb.Select(cond, {x, add_ten});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ContextSensitiveRangeQueryEngine engine;
+  XLS_ASSERT_OK(engine.Populate(f));
+
+  // Specialized ranges are computed on demand so modifying the function before
+  // asking for them must not lose them as long as the nodes involved remain.
+  XLS_ASSERT_OK(f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNot).status());
+  auto consequent_arm_range = engine.SpecializeGivenPredicate(
+      {PredicateState(res.node()->As<Select>(), kConsequentArm)});
+  EXPECT_EQ(consequent_arm_range->GetIntervals(add_ten.node()),
+            BitsLTT(add_ten.node(), {Interval::Precise(UBits(22, 8))}));
+}
+
+TEST_F(ContextSensitiveRangeQueryEngineTest,
+       SpecializationAfterRemovingAffectedNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+
+  // if (x == 12) { x + 10 } else { x }
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue cond = fb.Eq(x, fb.Literal(UBits(12, 8)));
+  BValue add_ten = fb.Add(x, fb.Literal(UBits(10, 8)));
+  BValue res = fb.Select(cond, {x, add_ten});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ContextSensitiveRangeQueryEngine engine;
+  XLS_ASSERT_OK(engine.Populate(f));
+
+  // Replace the add with a new node so the specialized ranges cannot be
+  // computed any more; the base ranges are used instead.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * ten, f->MakeNode<Literal>(SourceInfo(), Value(UBits(10, 8))));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub, f->MakeNode<BinOp>(SourceInfo(), x.node(), ten, Op::kSub));
+  XLS_ASSERT_OK(add_ten.node()->ReplaceUsesWith(sub));
+  XLS_ASSERT_OK(f->RemoveNode(add_ten.node()));
+  auto consequent_arm_range = engine.SpecializeGivenPredicate(
+      {PredicateState(res.node()->As<Select>(), kConsequentArm)});
+  EXPECT_EQ(consequent_arm_range->GetIntervals(x.node()),
+            BitsLTT(x.node(), {Interval::Maximal(8)}));
+}
+
+TEST_F(ContextSensitiveRangeQueryEngineTest,
+       SpecializationAfterReplacingAffectedNodeInPlace) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+
+  // if (x == 12) { x + 10 } else { x }
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue cond = fb.Eq(x, fb.Literal(UBits(12, 8)));
+  BValue ten = fb.Literal(UBits(10, 8));
+  BValue add_ten = fb.Add(x, ten);
+  BValue res = fb.Select(cond, {x, add_ten});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ContextSensitiveRangeQueryEngine engine;
+  XLS_ASSERT_OK(engine.Populate(f));
+
+  // Remove the add before creating its replacement so the replacement may be
+  // allocated at the same address. It must still not be mistaken for the
+  // original node.
+  XLS_ASSERT_OK(
+      res.node()->ReplaceOperandNumber(2, x.node(), /*type_must_match=*/true));
+  XLS_ASSERT_OK(f->RemoveNode(add_ten.node()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub,
+      f->MakeNode<BinOp>(SourceInfo(), x.node(), ten.node(), Op::kSub));
+  XLS_ASSERT_OK(
+      res.node()->ReplaceOperandNumber(2, sub, /*type_must_match=*/true));
+  auto consequent_arm_range = engine.SpecializeGivenPredicate(
+      {PredicateState(res.node()->As<Select>(), kConsequentArm)});
+  EXPECT_EQ(consequent_arm_range->GetIntervals(x.node()),
+            BitsLTT(x.node(), {Interval::Maximal(8)}));
+}
+
 TEST_F(ContextSensitiveRangeQueryEngineTest, Ne) {
   Bits max_bits = UBits(12, 8);
   auto p = CreatePackage();
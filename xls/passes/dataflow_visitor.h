@@ -15,7 +15,10 @@
 #ifndef XLS_PASSES_DATAFLOW_VISITOR_H_
 #define XLS_PASSES_DATAFLOW_VISITOR_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -26,12 +29,16 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/dfs_visitor.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/passes/stateless_query_engine.h"
 
@@ -266,6 +273,50 @@ class DataflowVisitor : public DfsVisitorWithDefault {
     return ltt;
   }
 
+  // Returns true if the handlers of this visitor may run concurrently on
+  // different nodes. This requires that handlers only read the values of
+  // operands through GetValue, only write the value of the visited node
+  // through SetValue, and touch no other mutable state.
+  virtual bool IsThreadSafe() const { return false; }
+
+  // Evaluates every node of `f`. If `thread_count` is greater than one and the
+  // visitor is thread-safe, the nodes are partitioned into topological levels
+  // (each node is in the level after the deepest of its operands) and the nodes
+  // of each wide level are evaluated on `thread_count` threads. Otherwise this
+  // is equivalent to `f->Accept(this)`. The resulting values are the same in
+  // either case.
+  absl::Status AcceptLevelParallel(FunctionBase* f, int64_t thread_count) {
+    if (thread_count <= 1 || !IsThreadSafe()) {
+      return f->Accept(this);
+    }
+    std::vector<std::vector<Node*>> levels;
+    absl::flat_hash_map<Node*, int64_t> node_level;
+    for (Node* node : TopoSort(f)) {
+      int64_t level = 0;
+      for (Node* operand : node->operands()) {
+        level = std::max(level, node_level.at(operand) + 1);
+      }
+      node_level[node] = level;
+      if (level == levels.size()) {
+        levels.emplace_back();
+      }
+      levels[level].push_back(node);
+    }
+    for (absl::Span<Node* const> level : levels) {
+      int64_t level_threads = std::min<int64_t>(
+          thread_count, level.size() / kMinNodesPerLevelThread);
+      if (level_threads <= 1) {
+        for (Node* node : level) {
+          XLS_RETURN_IF_ERROR(node->VisitSingleNode(this));
+          MarkVisited(node);
+        }
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(VisitLevelInParallel(level, level_threads));
+    }
+    return absl::OkStatus();
+  }
+
  protected:
   // Joins the elements of `data_sources` together and returns the result.
   // This operation is used, for example, to join the leaf values of possible
@@ -317,13 +368,18 @@ class DataflowVisitor : public DfsVisitorWithDefault {
 
   // Sets the leaf type tree value associated with `node`.
   absl::Status SetValue(Node* node, LeafTypeTreeView<LeafT> value) {
-    XLS_RET_CHECK_EQ(node->GetType(), value.type());
-    map_[node] = leaf_type_tree::Clone(value);
-    return absl::OkStatus();
+    return SetValue(node, leaf_type_tree::Clone(value));
   }
   absl::Status SetValue(Node* node, LeafTypeTree<LeafT>&& value) {
     XLS_RET_CHECK_EQ(node->GetType(), value.type());
-    map_[node] = value;
+    if (level_slots_ != nullptr) {
+      // Evaluating a level in parallel; the map must not be modified until
+      // the whole level is done.
+      XLS_RET_CHECK(level_slots_->contains(node));
+      level_values_[level_slots_->at(node)] = std::move(value);
+      return absl::OkStatus();
+    }
+    map_[node] = std::move(value);
     return absl::OkStatus();
   }
 
@@ -382,7 +438,69 @@ class DataflowVisitor : public DfsVisitorWithDefault {
   }
 
   StatelessQueryEngine query_engine_;
-  absl::flat_hash_map<Node*, LeafTypeTree<LeafT>> map_;
+  NodeMap<LeafTypeTree<LeafT>> map_;
+
+ private:
+  // Levels are only split across threads if each thread gets at least this
+  // many nodes.
+  static constexpr int64_t kMinNodesPerLevelThread = 64;
+
+  // Evaluates the nodes of `level`, none of which depend on each other, on
+  // `thread_count` threads. Values are written to per-node slots and moved
+  // into the map once every node of the level has been evaluated.
+  absl::Status VisitLevelInParallel(absl::Span<Node* const> level,
+                                    int64_t thread_count) {
+    absl::flat_hash_map<Node*, int64_t> slots;
+    slots.reserve(level.size());
+    for (int64_t i = 0; i < level.size(); ++i) {
+      slots[level[i]] = i;
+    }
+    level_values_.clear();
+    level_values_.resize(level.size());
+    level_slots_ = &slots;
+
+    std::atomic<int64_t> next_node = 0;
+    std::vector<absl::Status> statuses(thread_count);
+    auto work = [&](int64_t thread_index) {
+      for (int64_t i = next_node.fetch_add(1); i < level.size();
+           i = next_node.fetch_add(1)) {
+        absl::Status status = level[i]->VisitSingleNode(this);
+        if (!status.ok()) {
+          statuses[thread_index] = status;
+          return;
+        }
+      }
+    };
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      threads.reserve(thread_count - 1);
+      for (int64_t t = 1; t < thread_count; ++t) {
+        threads.push_back(std::make_unique<Thread>([&work, t]() { work(t); }));
+      }
+      work(0);
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+    level_slots_ = nullptr;
+    for (const absl::Status& status : statuses) {
+      XLS_RETURN_IF_ERROR(status);
+    }
+
+    for (int64_t i = 0; i < level.size(); ++i) {
+      if (level_values_[i].has_value()) {
+        map_[level[i]] = *std::move(level_values_[i]);
+      }
+      MarkVisited(level[i]);
+    }
+    level_values_.clear();
+    return absl::OkStatus();
+  }
+
+  // While a level is evaluated in parallel, the slot in `level_values_` of
+  // each node in the level. Null otherwise.
+  const absl::flat_hash_map<Node*, int64_t>* level_slots_ = nullptr;
+  std::vector<std::optional<LeafTypeTree<LeafT>>> level_values_;
 };
 
 }  // namespace xls
@@ -19,6 +19,7 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -39,6 +40,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/node.h"
 #include "xls/ir/source_location.h"
 
 namespace xls {
@@ -136,6 +138,12 @@ class TestDataflowVisitorWithControl : public TestDataflowVisitor {
   }
 };
 
+// Thread-safe variant of TestDataflowVisitorWithControl.
+class ThreadSafeTestDataflowVisitor : public TestDataflowVisitorWithControl {
+ public:
+  bool IsThreadSafe() const override { return true; }
+};
+
 TEST_F(DataflowVisitorTest, Tuples) {
   auto p = CreatePackage();
   Type* u32 = p->GetBitsType(32);
@@ -322,5 +330,35 @@ TEST_F(DataflowVisitorTest, OneHotSelects) {
   EXPECT_THAT(visitor.GetValue(onehot_ohs.node()).ToString(), "x OR y OR z");
 }
 
+TEST_F(DataflowVisitorTest, LevelParallelMatchesSequential) {
+  auto p = CreatePackage();
+  Type* u32 = p->GetBitsType(32);
+  FunctionBuilder b(TestName(), p.get());
+
+  // Enough independent nodes per level to be split across threads.
+  BValue pred = b.Param("pred", p->GetBitsType(1));
+  std::vector<BValue> selects;
+  for (int64_t i = 0; i < 300; ++i) {
+    BValue x = b.Param(absl::StrCat("x", i), u32);
+    BValue y = b.Param(absl::StrCat("y", i), u32);
+    BValue tuple = b.Tuple({x, y});
+    selects.push_back(b.Select(pred, {b.TupleIndex(tuple, 0), y}));
+  }
+  b.Tuple(selects);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+
+  ThreadSafeTestDataflowVisitor sequential;
+  XLS_ASSERT_OK(f->Accept(&sequential));
+  ThreadSafeTestDataflowVisitor parallel;
+  XLS_ASSERT_OK(parallel.AcceptLevelParallel(f, /*thread_count=*/4));
+
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(parallel.GetValue(node).ToString(),
+              sequential.GetValue(node).ToString())
+        << node->GetName();
+  }
+  EXPECT_EQ(parallel.GetValue(selects[7].node()).ToString(), "x7 OR y7 | pred");
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,277 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/function_deduplication_pass.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+// Returns the function called by `node` if it calls one.
+std::optional<Function*> CalledFunction(Node* node) {
+  switch (node->op()) {
+    case Op::kInvoke:
+      return node->As<Invoke>()->to_apply();
+    case Op::kMap:
+      return node->As<Map>()->to_apply();
+    case Op::kCountedFor:
+      return node->As<CountedFor>()->body();
+    case Op::kDynamicCountedFor:
+      return node->As<DynamicCountedFor>()->body();
+    default:
+      return std::nullopt;
+  }
+}
+
+// Returns the nodes which are neither used by another node nor the return
+// value. Together with the return value they reach every node of `f`.
+std::vector<Node*> DanglingNodes(Function* f, absl::Span<Node* const> order) {
+  std::vector<Node*> dangling;
+  for (Node* node : order) {
+    if (node->users().empty() && node != f->return_value()) {
+      dangling.push_back(node);
+    }
+  }
+  return dangling;
+}
+
+// A hash of the structure of a function which ignores names, node ids and
+// node attributes. Equal functions have equal hashes.
+struct FunctionHash {
+  uint64_t hash;
+  // Hash of each node of the function.
+  absl::flat_hash_map<Node*, uint64_t> node_hashes;
+};
+
+FunctionHash HashFunction(Function* f) {
+  FunctionHash result;
+  std::vector<Node*> order = TopoSort(f);
+  std::vector<uint64_t> operand_hashes;
+  for (Node* node : order) {
+    operand_hashes.clear();
+    if (node->Is<Param>()) {
+      operand_hashes.push_back(f->GetParamIndex(node->As<Param>()).value());
+    }
+    for (Node* operand : node->operands()) {
+      operand_hashes.push_back(result.node_hashes.at(operand));
+    }
+    result.node_hashes[node] =
+        absl::HashOf(node->op(), node->GetType(), operand_hashes);
+  }
+  std::vector<uint64_t> dangling_hashes;
+  for (Node* node : DanglingNodes(f, order)) {
+    dangling_hashes.push_back(result.node_hashes.at(node));
+  }
+  absl::c_sort(dangling_hashes);
+  result.hash = absl::HashOf(f->GetType()->ToString(), f->node_count(),
+                             result.node_hashes.at(f->return_value()),
+                             dangling_hashes);
+  return result;
+}
+
+// Returns true if there is a one-to-one mapping between the nodes of `a` and
+// `b` which preserves parameter positions, the return value, the operation
+// and attributes of each node, and operands.
+bool AreStructurallyEqual(Function* a, const FunctionHash& a_hash, Function* b,
+                          const FunctionHash& b_hash) {
+  if (a->ForeignFunctionData().has_value() ||
+      b->ForeignFunctionData().has_value() ||
+      a->node_count() != b->node_count() ||
+      a->params().size() != b->params().size() ||
+      !a->GetType()->IsEqualTo(b->GetType())) {
+    return false;
+  }
+  absl::flat_hash_map<Node*, Node*> a_to_b;
+  absl::flat_hash_map<Node*, Node*> b_to_a;
+  auto map_nodes = [&](Node* x, Node* y) {
+    auto [a_it, a_inserted] = a_to_b.insert({x, y});
+    auto [b_it, b_inserted] = b_to_a.insert({y, x});
+    return a_it->second == y && b_it->second == x;
+  };
+  for (int64_t i = 0; i < a->params().size(); ++i) {
+    map_nodes(a->param(i), b->param(i));
+  }
+
+  // Dangling nodes are paired up in the order of their hashes; functions whose
+  // dangling nodes can't be paired this way are treated as different.
+  auto by_hash = [](const FunctionHash& hash) {
+    return [&hash](Node* x, Node* y) {
+      return hash.node_hashes.at(x) < hash.node_hashes.at(y);
+    };
+  };
+  std::vector<Node*> a_dangling = DanglingNodes(a, TopoSort(a));
+  std::vector<Node*> b_dangling = DanglingNodes(b, TopoSort(b));
+  if (a_dangling.size() != b_dangling.size()) {
+    return false;
+  }
+  absl::c_stable_sort(a_dangling, by_hash(a_hash));
+  absl::c_stable_sort(b_dangling, by_hash(b_hash));
+
+  std::vector<std::pair<Node*, Node*>> worklist = {
+      {a->return_value(), b->return_value()}};
+  for (int64_t i = 0; i < a_dangling.size(); ++i) {
+    worklist.push_back({a_dangling[i], b_dangling[i]});
+  }
+  while (!worklist.empty()) {
+    auto [x, y] = worklist.back();
+    worklist.pop_back();
+    if (auto it = a_to_b.find(x); it != a_to_b.end()) {
+      if (it->second != y) {
+        return false;
+      }
+      continue;
+    }
+    if (!x->IsDefinitelyEqualTo(y) || !map_nodes(x, y)) {
+      return false;
+    }
+    for (int64_t i = 0; i < x->operand_count(); ++i) {
+      worklist.push_back({x->operand(i), y->operand(i)});
+    }
+  }
+  return a_to_b.size() == a->node_count();
+}
+
+// Replaces `node`, which calls a function, with an equivalent node calling
+// `target`.
+absl::StatusOr<Node*> RedirectCall(Node* node, Function* target) {
+  Node* replacement;
+  switch (node->op()) {
+    case Op::kInvoke:
+      XLS_ASSIGN_OR_RETURN(replacement, node->ReplaceUsesWithNew<Invoke>(
+                                            node->operands(), target));
+      break;
+    case Op::kMap:
+      XLS_ASSIGN_OR_RETURN(replacement, node->ReplaceUsesWithNew<Map>(
+                                            node->operand(0), target));
+      break;
+    case Op::kCountedFor: {
+      CountedFor* loop = node->As<CountedFor>();
+      XLS_ASSIGN_OR_RETURN(
+          replacement,
+          node->ReplaceUsesWithNew<CountedFor>(
+              loop->initial_value(), loop->invariant_args(),
+              loop->trip_count(), loop->stride(), target));
+      break;
+    }
+    case Op::kDynamicCountedFor: {
+      DynamicCountedFor* loop = node->As<DynamicCountedFor>();
+      XLS_ASSIGN_OR_RETURN(
+          replacement, node->ReplaceUsesWithNew<DynamicCountedFor>(
+                           loop->initial_value(), loop->trip_count(),
+                           loop->stride(), loop->invariant_args(), target));
+      break;
+    }
+    default:
+      return absl::InternalError(
+          absl::StrFormat("Node %s does not call a function", node->GetName()));
+  }
+  XLS_RETURN_IF_ERROR(node->function_base()->RemoveNode(node));
+  return replacement;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> FunctionDeduplicationPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  // Index the call sites of each function once up front.
+  absl::flat_hash_map<Function*, std::vector<Node*>> callers;
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    for (Node* node : f->nodes()) {
+      if (std::optional<Function*> callee = CalledFunction(node);
+          callee.has_value()) {
+        callers[*callee].push_back(node);
+      }
+    }
+  }
+
+  std::optional<FunctionBase*> top = p->GetTop();
+  absl::flat_hash_map<uint64_t, std::vector<Function*>> representatives;
+  absl::flat_hash_map<Function*, FunctionHash> hashes;
+  bool changed = false;
+  // Callees come first so call sites are redirected before their callers are
+  // hashed.
+  for (FunctionBase* fb : FunctionsInPostOrder(p)) {
+    if (!fb->IsFunction() || (top.has_value() && *top == fb)) {
+      continue;
+    }
+    Function* f = fb->AsFunctionOrDie();
+    // Side-effecting operations carry identity (e.g. assertion labels and
+    // trace messages which tools match on), so such functions are kept.
+    if (f->ForeignFunctionData().has_value() ||
+        absl::c_any_of(f->nodes(),
+                       [](Node* n) { return OpIsSideEffecting(n->op()); })) {
+      continue;
+    }
+    FunctionHash hash = HashFunction(f);
+    std::vector<Function*>& bucket = representatives[hash.hash];
+    auto representative = absl::c_find_if(bucket, [&](Function* other) {
+      return AreStructurallyEqual(other, hashes.at(other), f, hash);
+    });
+    if (representative == bucket.end()) {
+      bucket.push_back(f);
+      hashes.emplace(f, std::move(hash));
+      continue;
+    }
+
+    VLOG(2) << absl::StreamFormat("Function %s is a duplicate of %s",
+                                  f->name(), (*representative)->name());
+    auto it = callers.find(f);
+    if (it == callers.end()) {
+      continue;
+    }
+    std::vector<Node*> calls = std::move(it->second);
+    callers.erase(it);
+    std::vector<Node*>& redirected = callers[*representative];
+    for (Node* call : calls) {
+      XLS_RET_CHECK(CalledFunction(call) == f);
+      XLS_ASSIGN_OR_RETURN(Node * new_call,
+                           RedirectCall(call, *representative));
+      redirected.push_back(new_call);
+    }
+    changed = true;
+  }
+  return changed;
+}
+
+REGISTER_OPT_PASS(FunctionDeduplicationPass);
+
+}  // namespace xls
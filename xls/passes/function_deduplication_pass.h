@@ -0,0 +1,52 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_FUNCTION_DEDUPLICATION_PASS_H_
+#define XLS_PASSES_FUNCTION_DEDUPLICATION_PASS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Pass which finds functions in the package with identical bodies and
+// redirects all invokes, maps and loops which call a duplicate to a single
+// representative. The duplicates are left unreferenced for dead function
+// elimination to remove.
+//
+// Functions are bucketed by a structural hash of their bodies which ignores
+// names and node ids, and functions in the same bucket are compared node by
+// node. Callees are processed before their callers so callers which only
+// differ in which duplicate they call are themselves deduplicated. Functions
+// containing side-effecting operations are never considered equal.
+class FunctionDeduplicationPass : public OptimizationPass {
+ public:
+  static constexpr std::string_view kName = "function_dedup";
+  explicit FunctionDeduplicationPass()
+      : OptimizationPass(kName, "Function Deduplication") {}
+  ~FunctionDeduplicationPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_FUNCTION_DEDUPLICATION_PASS_H_
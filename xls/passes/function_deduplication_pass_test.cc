@@ -0,0 +1,197 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/function_deduplication_pass.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+class FunctionDeduplicationPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Package* p) {
+    PassResults results;
+    return FunctionDeduplicationPass().Run(p, OptimizationPassOptions(),
+                                           &results);
+  }
+};
+
+TEST_F(FunctionDeduplicationPassTest, IdenticalFunctionsMerged) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(R"(
+package test
+
+fn add_one__8(x: bits[8]) -> bits[8] {
+  one: bits[8] = literal(value=1)
+  ret sum: bits[8] = add(x, one)
+}
+
+fn add_one__8_again(y: bits[8]) -> bits[8] {
+  literal.10: bits[8] = literal(value=1)
+  ret add.11: bits[8] = add(y, literal.10)
+}
+
+top fn main(a: bits[8], b: bits[8]) -> (bits[8], bits[8]) {
+  invoke.20: bits[8] = invoke(a, to_apply=add_one__8)
+  invoke.21: bits[8] = invoke(b, to_apply=add_one__8_again)
+  ret tuple.22: (bits[8], bits[8]) = tuple(invoke.20, invoke.21)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetFunction("main"));
+  Node* first = main->return_value()->operand(0);
+  Node* second = main->return_value()->operand(1);
+  EXPECT_THAT(first, m::Invoke(m::Param("a")));
+  EXPECT_THAT(second, m::Invoke(m::Param("b")));
+  EXPECT_EQ(first->As<Invoke>()->to_apply(),
+            second->As<Invoke>()->to_apply());
+}
+
+TEST_F(FunctionDeduplicationPassTest, CallersOfDuplicatesMerged) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(R"(
+package test
+
+fn leaf_a(x: bits[8]) -> bits[8] {
+  ret neg.1: bits[8] = neg(x)
+}
+
+fn leaf_b(x: bits[8]) -> bits[8] {
+  ret neg.2: bits[8] = neg(x)
+}
+
+fn caller_a(x: bits[8]) -> bits[8] {
+  ret invoke.3: bits[8] = invoke(x, to_apply=leaf_a)
+}
+
+fn caller_b(x: bits[8]) -> bits[8] {
+  ret invoke.4: bits[8] = invoke(x, to_apply=leaf_b)
+}
+
+top fn main(a: bits[8]) -> (bits[8], bits[8]) {
+  invoke.5: bits[8] = invoke(a, to_apply=caller_a)
+  invoke.6: bits[8] = invoke(a, to_apply=caller_b)
+  ret tuple.7: (bits[8], bits[8]) = tuple(invoke.5, invoke.6)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetFunction("main"));
+  EXPECT_EQ(main->return_value()->operand(0)->As<Invoke>()->to_apply(),
+            main->return_value()->operand(1)->As<Invoke>()->to_apply());
+}
+
+TEST_F(FunctionDeduplicationPassTest, SideEffectingFunctionsNotMerged) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(R"(
+package test
+
+fn check__8(tkn: token, x: bits[8]) -> token {
+  zero: bits[8] = literal(value=0)
+  ne: bits[1] = ne(x, zero)
+  traced: token = trace(tkn, ne, format="x = {}", data_operands=[x])
+  ret checked: token = assert(traced, ne, message="x is zero", label="nonzero")
+}
+
+fn check__8_again(tkn: token, x: bits[8]) -> token {
+  zero: bits[8] = literal(value=0)
+  ne: bits[1] = ne(x, zero)
+  traced: token = trace(tkn, ne, format="x = {}", data_operands=[x])
+  ret checked: token = assert(traced, ne, message="x is zero", label="nonzero")
+}
+
+top fn main(tkn: token, a: bits[8], b: bits[8]) -> (token, token) {
+  invoke.20: token = invoke(tkn, a, to_apply=check__8)
+  invoke.21: token = invoke(tkn, b, to_apply=check__8_again)
+  ret tuple.22: (token, token) = tuple(invoke.20, invoke.21)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetFunction("main"));
+  EXPECT_NE(main->return_value()->operand(0)->As<Invoke>()->to_apply(),
+            main->return_value()->operand(1)->As<Invoke>()->to_apply());
+}
+
+TEST_F(FunctionDeduplicationPassTest, DifferentFunctionsNotMerged) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(R"(
+package test
+
+fn add_one(x: bits[8]) -> bits[8] {
+  one: bits[8] = literal(value=1)
+  ret sum: bits[8] = add(x, one)
+}
+
+fn add_two(x: bits[8]) -> bits[8] {
+  two: bits[8] = literal(value=2)
+  ret sum: bits[8] = add(x, two)
+}
+
+fn sub_one(x: bits[8]) -> bits[8] {
+  one: bits[8] = literal(value=1)
+  ret diff: bits[8] = sub(one, x)
+}
+
+top fn main(a: bits[8]) -> (bits[8], bits[8], bits[8]) {
+  invoke.1: bits[8] = invoke(a, to_apply=add_one)
+  invoke.2: bits[8] = invoke(a, to_apply=add_two)
+  invoke.3: bits[8] = invoke(a, to_apply=sub_one)
+  ret tuple.4: (bits[8], bits[8], bits[8]) = tuple(invoke.1, invoke.2, invoke.3)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(FunctionDeduplicationPassTest, SwappedParametersNotMerged) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(R"(
+package test
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  ret sub.1: bits[8] = sub(x, y)
+}
+
+fn g(x: bits[8], y: bits[8]) -> bits[8] {
+  ret sub.2: bits[8] = sub(y, x)
+}
+
+top fn main(a: bits[8], b: bits[8]) -> (bits[8], bits[8]) {
+  invoke.3: bits[8] = invoke(a, b, to_apply=f)
+  invoke.4: bits[8] = invoke(a, b, to_apply=g)
+  ret tuple.5: (bits[8], bits[8]) = tuple(invoke.3, invoke.4)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xls
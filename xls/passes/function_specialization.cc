@@ -0,0 +1,229 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/function_specialization.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+namespace {
+
+// Replaces the parameters of `f` named in `names` with the respective literal
+// in `values` and removes them from the signature.
+absl::Status BindParams(Function* f, absl::Span<const std::string> names,
+                        absl::Span<const Value> values) {
+  XLS_RET_CHECK_EQ(names.size(), values.size());
+  for (int64_t i = 0; i < names.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Param * param, f->GetParamByName(names[i]));
+    XLS_RETURN_IF_ERROR(param->ReplaceUsesWithNew<Literal>(values[i]).status());
+    XLS_RETURN_IF_ERROR(f->RemoveNode(param));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<ParamSpecialization>> ParseParamSpecializations(
+    std::string_view text) {
+  std::vector<ParamSpecialization> result;
+  for (std::string_view entry : absl::StrSplit(text, ';', absl::SkipEmpty())) {
+    std::vector<std::string_view> name_and_values =
+        absl::StrSplit(entry, absl::MaxSplits('=', 1));
+    if (name_and_values.size() != 2) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid parameter specialization `%s`, expected "
+          "`name=value[|value...]`",
+          entry));
+    }
+    ParamSpecialization& specialization = result.emplace_back();
+    specialization.param_name =
+        std::string(absl::StripAsciiWhitespace(name_and_values[0]));
+    for (std::string_view value : absl::StrSplit(name_and_values[1], '|')) {
+      XLS_ASSIGN_OR_RETURN(
+          Value parsed,
+          Parser::ParseTypedValue(absl::StripAsciiWhitespace(value)));
+      specialization.values.push_back(parsed);
+    }
+  }
+  return result;
+}
+
+absl::StatusOr<Function*> SpecializeFunction(
+    Function* f, absl::Span<const ParamSpecialization> specializations,
+    std::string_view new_name, int64_t max_variants) {
+  std::vector<std::string> constant_names;
+  std::vector<Value> constant_values;
+  std::vector<const ParamSpecialization*> quasi_static;
+  absl::flat_hash_set<std::string> seen;
+  for (const ParamSpecialization& specialization : specializations) {
+    if (!seen.insert(specialization.param_name).second) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Parameter `%s` is specialized more than once",
+                          specialization.param_name));
+    }
+    XLS_ASSIGN_OR_RETURN(Param * param,
+                         f->GetParamByName(specialization.param_name));
+    if (specialization.values.empty()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("No values given for parameter `%s`",
+                          specialization.param_name));
+    }
+    for (const Value& value : specialization.values) {
+      if (!ValueConformsToType(value, param->GetType())) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Value %s does not match type %s of parameter `%s`",
+            value.ToString(), param->GetType()->ToString(),
+            param->GetName()));
+      }
+    }
+    if (specialization.values.size() == 1) {
+      constant_names.push_back(specialization.param_name);
+      constant_values.push_back(specialization.values.front());
+    } else {
+      quasi_static.push_back(&specialization);
+    }
+  }
+
+  int64_t variant_count = 1;
+  for (const ParamSpecialization* specialization : quasi_static) {
+    variant_count *= specialization->values.size();
+    if (variant_count > max_variants) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Specializing function `%s` requires more than %d variants",
+          f->name(), max_variants));
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(Function * specialized, f->Clone(new_name));
+  XLS_RETURN_IF_ERROR(BindParams(specialized, constant_names, constant_values));
+  if (quasi_static.empty()) {
+    return specialized;
+  }
+
+  // Create a variant for each combination of quasi-static values. The i-th
+  // variant takes the values given by the mixed-radix digits of i.
+  std::vector<std::string> quasi_static_names;
+  for (const ParamSpecialization* specialization : quasi_static) {
+    quasi_static_names.push_back(specialization->param_name);
+  }
+  std::vector<std::vector<Value>> combinations;
+  std::vector<Function*> variants;
+  for (int64_t i = 0; i < variant_count; ++i) {
+    std::vector<Value> combination;
+    int64_t remainder = i;
+    for (const ParamSpecialization* specialization : quasi_static) {
+      int64_t value_count = specialization->values.size();
+      combination.push_back(specialization->values[remainder % value_count]);
+      remainder /= value_count;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Function * variant,
+        specialized->Clone(absl::StrCat(new_name, "__variant_", i)));
+    XLS_RETURN_IF_ERROR(BindParams(variant, quasi_static_names, combination));
+    combinations.push_back(std::move(combination));
+    variants.push_back(variant);
+  }
+
+  // Replace the body of the specialized function with a selection among
+  // invocations of the variants.
+  std::vector<Node*> old_nodes = TopoSort(specialized);
+  std::vector<Node*> quasi_static_params;
+  for (const std::string& name : quasi_static_names) {
+    XLS_ASSIGN_OR_RETURN(Param * param, specialized->GetParamByName(name));
+    quasi_static_params.push_back(param);
+  }
+  // The variants take the remaining parameters in the same order.
+  std::vector<Node*> args;
+  for (Param* param : specialized->params()) {
+    if (!absl::c_linear_search(quasi_static_names, param->GetName())) {
+      args.push_back(param);
+    }
+  }
+  std::vector<Node*> cases;
+  std::vector<Node*> matches;
+  for (int64_t i = 0; i < variant_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        Node * invoke,
+        specialized->MakeNode<Invoke>(SourceInfo(), args, variants[i]));
+    cases.push_back(invoke);
+    if (i == variant_count - 1) {
+      break;
+    }
+    std::vector<Node*> conditions;
+    for (int64_t j = 0; j < quasi_static_params.size(); ++j) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * literal,
+          specialized->MakeNode<Literal>(SourceInfo(), combinations[i][j]));
+      XLS_ASSIGN_OR_RETURN(
+          Node * eq,
+          specialized->MakeNode<CompareOp>(
+              SourceInfo(), quasi_static_params[j], literal, Op::kEq));
+      conditions.push_back(eq);
+    }
+    if (conditions.size() == 1) {
+      matches.push_back(conditions.front());
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          Node * match,
+          specialized->MakeNode<NaryOp>(SourceInfo(), conditions, Op::kAnd));
+      matches.push_back(match);
+    }
+  }
+  Node* default_case = cases.back();
+  cases.pop_back();
+  // Bit i of the selector selects case i; concat places its first operand in
+  // the most significant bits.
+  std::reverse(matches.begin(), matches.end());
+  XLS_ASSIGN_OR_RETURN(Node * selector,
+                       specialized->MakeNode<Concat>(SourceInfo(), matches));
+  XLS_ASSIGN_OR_RETURN(Node * select, specialized->MakeNode<PrioritySelect>(
+                                          SourceInfo(), selector, cases,
+                                          default_case));
+  XLS_RETURN_IF_ERROR(specialized->set_return_value(select));
+  for (auto it = old_nodes.rbegin(); it != old_nodes.rend(); ++it) {
+    if (!(*it)->Is<Param>()) {
+      XLS_RETURN_IF_ERROR(specialized->RemoveNode(*it));
+    }
+  }
+  return specialized;
+}
+
+}  // namespace xls
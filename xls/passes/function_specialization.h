@@ -0,0 +1,66 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_FUNCTION_SPECIALIZATION_H_
+#define XLS_PASSES_FUNCTION_SPECIALIZATION_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Binds a parameter of a function to the values it takes in a particular
+// instantiation of the function.
+struct ParamSpecialization {
+  std::string param_name;
+
+  // A single value ties the parameter to a constant. Several values mark the
+  // parameter as quasi-static configuration which takes one of the values
+  // while the hardware is running.
+  std::vector<Value> values;
+};
+
+// Parses a list of parameter specializations of the form
+// `name=value[|value...][;name=value[|value...]...]` where each value is a
+// typed IR value, e.g. `mode=bits[2]:1;width=bits[8]:8|bits[8]:16`.
+absl::StatusOr<std::vector<ParamSpecialization>> ParseParamSpecializations(
+    std::string_view text);
+
+// Creates a specialization of `f` named `new_name` in the same package. The
+// parameters of `f` tied to a constant are removed from the signature and
+// replaced by literals.
+//
+// If any parameters are quasi-static, a variant of `f` is created for every
+// combination of their values (named `<new_name>__variant_<i>`) in which those
+// parameters are also replaced by literals. The specialized function keeps the
+// quasi-static parameters and selects the result of the variant matching
+// their values. If the parameters take a combination of values which was not
+// listed, the result of the last variant is returned. Optimizing the package
+// (in particular inlining and constant folding) then produces a datapath
+// specialized to each configuration. Returns an error if there would be more
+// than `max_variants` variants.
+absl::StatusOr<Function*> SpecializeFunction(
+    Function* f, absl::Span<const ParamSpecialization> specializations,
+    std::string_view new_name, int64_t max_variants = 64);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_FUNCTION_SPECIALIZATION_H_
@@ -0,0 +1,179 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/function_specialization.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+
+class FunctionSpecializationTest : public IrTestBase {
+ protected:
+  // Builds `f(x: bits[8], mode: bits[2], scale: bits[8])` which returns one of
+  // `x + scale`, `x - scale`, `x * scale` or `x` selected by `mode`.
+  absl::StatusOr<Function*> BuildConfigurable(Package* p) {
+    FunctionBuilder fb("f", p);
+    BValue x = fb.Param("x", p->GetBitsType(8));
+    BValue mode = fb.Param("mode", p->GetBitsType(2));
+    BValue scale = fb.Param("scale", p->GetBitsType(8));
+    fb.Select(mode, {fb.Add(x, scale), fb.Subtract(x, scale),
+                     fb.UMul(x, scale), x});
+    return fb.Build();
+  }
+
+  absl::StatusOr<Value> Run(Function* f, absl::Span<const Value> args) {
+    return DropInterpreterEvents(InterpretFunction(f, args));
+  }
+};
+
+TEST_F(FunctionSpecializationTest, ConstantParams) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildConfigurable(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * specialized,
+      SpecializeFunction(
+          f,
+          {ParamSpecialization{.param_name = "mode",
+                               .values = {Value(UBits(2, 2))}},
+           ParamSpecialization{.param_name = "scale",
+                               .values = {Value(UBits(3, 8))}}},
+          "f_specialized"));
+  EXPECT_EQ(specialized->name(), "f_specialized");
+  ASSERT_THAT(specialized->params(), SizeIs(1));
+  EXPECT_EQ(specialized->params()[0]->GetName(), "x");
+  for (int64_t x = 0; x < 256; ++x) {
+    EXPECT_THAT(Run(specialized, {Value(UBits(x, 8))}),
+                IsOkAndHolds(Value(UBits((x * 3) & 0xff, 8))));
+  }
+}
+
+TEST_F(FunctionSpecializationTest, QuasiStaticParam) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildConfigurable(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * specialized,
+      SpecializeFunction(f,
+                         {ParamSpecialization{
+                             .param_name = "mode",
+                             .values = {Value(UBits(0, 2)), Value(UBits(1, 2)),
+                                        Value(UBits(3, 2))}}},
+                         "f_specialized"));
+  ASSERT_THAT(specialized->params(), SizeIs(3));
+  XLS_ASSERT_OK(p->GetFunction("f_specialized__variant_0").status());
+  XLS_ASSERT_OK(p->GetFunction("f_specialized__variant_2").status());
+  for (int64_t mode : {0, 1, 3}) {
+    for (int64_t x : {0, 7, 200}) {
+      std::vector<Value> args = {Value(UBits(x, 8)), Value(UBits(mode, 2)),
+                                 Value(UBits(5, 8))};
+      XLS_ASSERT_OK_AND_ASSIGN(Value expected, Run(f, args));
+      EXPECT_THAT(Run(specialized, args), IsOkAndHolds(expected));
+    }
+  }
+}
+
+TEST_F(FunctionSpecializationTest, ConstantAndQuasiStaticParams) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildConfigurable(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * specialized,
+      SpecializeFunction(
+          f,
+          {ParamSpecialization{.param_name = "scale",
+                               .values = {Value(UBits(1, 8)),
+                                          Value(UBits(4, 8))}},
+           ParamSpecialization{.param_name = "mode",
+                               .values = {Value(UBits(0, 2)),
+                                          Value(UBits(2, 2))}}},
+          "f_specialized"));
+  ASSERT_THAT(specialized->params(), SizeIs(3));
+  for (int64_t mode : {0, 2}) {
+    for (int64_t scale : {1, 4}) {
+      std::vector<Value> args = {Value(UBits(9, 8)), Value(UBits(mode, 2)),
+                                 Value(UBits(scale, 8))};
+      XLS_ASSERT_OK_AND_ASSIGN(Value expected, Run(f, args));
+      EXPECT_THAT(Run(specialized, args), IsOkAndHolds(expected));
+    }
+  }
+}
+
+TEST_F(FunctionSpecializationTest, Errors) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildConfigurable(p.get()));
+  EXPECT_THAT(SpecializeFunction(f,
+                                 {ParamSpecialization{
+                                     .param_name = "nope",
+                                     .values = {Value(UBits(0, 2))}}},
+                                 "a"),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(SpecializeFunction(f,
+                                 {ParamSpecialization{
+                                     .param_name = "mode",
+                                     .values = {Value(UBits(0, 3))}}},
+                                 "b"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("does not match type")));
+  EXPECT_THAT(
+      SpecializeFunction(
+          f,
+          {ParamSpecialization{.param_name = "mode",
+                               .values = {Value(UBits(0, 2)),
+                                          Value(UBits(1, 2))}},
+           ParamSpecialization{.param_name = "scale",
+                               .values = {Value(UBits(0, 8)),
+                                          Value(UBits(1, 8))}}},
+          "c", /*max_variants=*/3),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("more than 3 variants")));
+}
+
+TEST_F(FunctionSpecializationTest, Parse) {
+  EXPECT_THAT(
+      ParseParamSpecializations("mode=bits[2]:1; scale=bits[8]:2|bits[8]:4"),
+      IsOkAndHolds(ElementsAre(
+          Field(&ParamSpecialization::values, ElementsAre(Value(UBits(1, 2)))),
+          Field(&ParamSpecialization::values,
+                ElementsAre(Value(UBits(2, 8)), Value(UBits(4, 8)))))));
+  EXPECT_THAT(ParseParamSpecializations("mode"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("expected `name=value")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -15,25 +15,33 @@
 #include "xls/passes/inlining_pass.h"
 
 #include <cstdint>
+#include <deque>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/call_graph.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
@@ -84,9 +92,9 @@ std::optional<std::string> GetInlinedNodeName(Node* node, Invoke* invoke) {
 // the original node ID to an inlined coverpoint. Post-processing will be needed
 // to re-aggregate coverpoints disaggregated in this method.
 std::string GetPrefixedLabel(Invoke* invoke, std::string_view label,
-                             int inline_count) {
+                             std::string_view inline_tag) {
   FunctionBase* caller = invoke->function_base();
-  return absl::StrCat(caller->name(), "_", inline_count, "_",
+  return absl::StrCat(caller->name(), "_", inline_tag, "_",
                       invoke->to_apply()->name(), "_", label);
 }
 
@@ -96,9 +104,11 @@ static bool IsInlineable(const Invoke* invoke) {
 }
 
 // Inlines the node "invoke" by replacing it with the contents of the called
-// function.
+// function. `inline_tag` distinguishes the labels of covers and asserts inlined
+// at this call site. Returns the node which replaced the invoke.
 template <bool kCheckNoSubInvokes = true>
-absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
+absl::StatusOr<Node*> InlineInvoke(Invoke* invoke,
+                                   std::string_view inline_tag) {
   Function* invoked = invoke->to_apply();
   absl::flat_hash_map<Node*, Node*> invoked_node_to_replacement;
   for (int64_t i = 0; i < invoked->params().size(); ++i) {
@@ -166,7 +176,7 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
       Cover* c = node->As<Cover>();
       std::string original_label = c->original_label().value_or(c->label());
       std::string new_label =
-          GetPrefixedLabel(invoke, node->As<Cover>()->label(), inline_count);
+          GetPrefixedLabel(invoke, node->As<Cover>()->label(), inline_tag);
       Cover* cover = invoked_node_to_replacement.at(node)->As<Cover>();
       Node* condition = cover->condition();
       XLS_ASSIGN_OR_RETURN(auto new_cover,
@@ -181,7 +191,7 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
       std::optional<std::string> original_label =
           a->original_label().has_value() ? a->original_label() : a->label();
       std::string new_label = GetPrefixedLabel(
-          invoke, node->As<Assert>()->label().value(), inline_count);
+          invoke, node->As<Assert>()->label().value(), inline_tag);
       Assert* asrt = invoked_node_to_replacement.at(node)->As<Assert>();
       Node* token = asrt->token();
       Node* condition = asrt->condition();
@@ -195,15 +205,98 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
     }
   }
 
-  XLS_RETURN_IF_ERROR(invoke->ReplaceUsesWith(
-      invoked_node_to_replacement.at(invoked->return_value())));
-  return invoke->function_base()->RemoveNode(invoke);
+  Node* result = invoked_node_to_replacement.at(invoked->return_value());
+  XLS_RETURN_IF_ERROR(invoke->ReplaceUsesWith(result));
+  XLS_RETURN_IF_ERROR(invoke->function_base()->RemoveNode(invoke));
+  return result;
+}
+
+// Returns true if `node` can be replaced by a literal computed by the
+// interpreter. Loops, maps and invokes are excluded to bound the time spent
+// evaluating.
+bool IsFoldable(Node* node) {
+  if (node->Is<Literal>() || TypeHasToken(node->GetType()) ||
+      (OpIsSideEffecting(node->op()) && !node->Is<Gate>()) ||
+      node->OpIn({Op::kInvoke, Op::kMap, Op::kCountedFor,
+                  Op::kDynamicCountedFor})) {
+    return false;
+  }
+  return absl::c_all_of(node->operands(),
+                        [](Node* operand) { return operand->Is<Literal>(); });
+}
+
+// Folds the nodes which are transitively computed only from literals, starting
+// from the users of the literals in `seeds`. Nodes left dead by the folding are
+// removed, except for `result`. Returns the node which replaces `result`.
+absl::StatusOr<Node*> FoldConstants(absl::Span<Node* const> seeds,
+                                    Node* result) {
+  FunctionBase* f = result->function_base();
+  std::deque<Node*> worklist;
+  for (Node* seed : seeds) {
+    if (seed->Is<Literal>()) {
+      worklist.insert(worklist.end(), seed->users().begin(),
+                      seed->users().end());
+    }
+  }
+  absl::flat_hash_set<Node*> folded;
+  std::vector<Node*> folded_order;
+  while (!worklist.empty()) {
+    Node* node = worklist.front();
+    worklist.pop_front();
+    if (folded.contains(node) || !IsFoldable(node)) {
+      continue;
+    }
+    std::vector<Value> operand_values;
+    operand_values.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operand_values.push_back(operand->As<Literal>()->value());
+    }
+    XLS_ASSIGN_OR_RETURN(Value value, InterpretNode(node, operand_values));
+    XLS_ASSIGN_OR_RETURN(Literal * literal,
+                         node->ReplaceUsesWithNew<Literal>(value));
+    if (node == result) {
+      result = literal;
+    }
+    folded.insert(node);
+    folded_order.push_back(node);
+    worklist.insert(worklist.end(), literal->users().begin(),
+                    literal->users().end());
+  }
+
+  // Remove the folded nodes and any of their operands which are left dead.
+  absl::flat_hash_set<Node*> removed;
+  std::vector<Node*> dead = std::move(folded_order);
+  while (!dead.empty()) {
+    Node* node = dead.back();
+    dead.pop_back();
+    if (removed.contains(node) || node == result || !node->users().empty() ||
+        f->HasImplicitUse(node) || OpIsSideEffecting(node->op())) {
+      continue;
+    }
+    std::vector<Node*> operands(node->operands().begin(),
+                                node->operands().end());
+    XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+    removed.insert(node);
+    dead.insert(dead.end(), operands.begin(), operands.end());
+  }
+  return result;
 }
 
 }  // namespace
 
 absl::Status InliningPass::InlineOneInvoke(Invoke* invoke) {
-  return InlineInvoke</*kCheckNoSubInvokes=*/false>(invoke, /*inline_count=*/0);
+  return InlineInvoke</*kCheckNoSubInvokes=*/false>(invoke, /*inline_tag=*/"0")
+      .status();
+}
+
+absl::StatusOr<Node*> InliningPass::InlineAndFoldInvoke(Invoke* invoke) {
+  std::vector<Node*> arguments(invoke->operands().begin(),
+                               invoke->operands().end());
+  XLS_ASSIGN_OR_RETURN(
+      Node * result,
+      InlineInvoke</*kCheckNoSubInvokes=*/false>(
+          invoke, /*inline_tag=*/absl::StrCat("id", invoke->id())));
+  return FoldConstants(arguments, result);
 }
 
 absl::StatusOr<bool> InliningPass::RunInternal(
@@ -214,14 +307,29 @@ absl::StatusOr<bool> InliningPass::RunInternal(
   // post order of the call graph (leaves first). This ensures that when a
   // function Foo is inlined into its callsites, no invokes remain in Foo. This
   // avoid duplicate work.
+  //
+  // Under a node budget an invoke is left in place if inlining it would exceed
+  // the budget, or if its callee still contains invokes for that reason.
   int inline_count = 0;
+  absl::flat_hash_set<Function*> has_deferred_invokes;
   for (FunctionBase* f : FunctionsInPostOrder(p)) {
     // Create copy of nodes() because we will be adding and removing nodes
     // during inlining.
     std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
     for (Node* node : nodes) {
       if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
-        XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++));
+        Function* callee = node->As<Invoke>()->to_apply();
+        if (has_deferred_invokes.contains(callee) ||
+            !FitsNodeBudget(short_name(), node, callee->node_count(), options,
+                            results)) {
+          if (f->IsFunction()) {
+            has_deferred_invokes.insert(f->AsFunctionOrDie());
+          }
+          continue;
+        }
+        XLS_RETURN_IF_ERROR(
+            InlineInvoke(node->As<Invoke>(), absl::StrCat(inline_count++))
+                .status());
         changed = true;
       }
     }
@@ -19,6 +19,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
@@ -37,6 +38,14 @@ class InliningPass : public OptimizationPass {
   // have invokes in the function code.
   static absl::Status InlineOneInvoke(Invoke* invoke);
 
+  // Inlines a single invoke instruction and then folds the inlined nodes which
+  // are computed only from literal arguments, removing the nodes left dead.
+  // This simplifies a body for its constant arguments (e.g., the induction
+  // variable of an unrolled loop) as it is spliced into the caller rather than
+  // leaving the work to later passes. The invoked function may contain
+  // invokes. Returns the node which replaced the invoke.
+  static absl::StatusOr<Node*> InlineAndFoldInvoke(Invoke* invoke);
+
  protected:
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
@@ -0,0 +1,257 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/interprocedural_constant_propagation_pass.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_manager.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+
+namespace {
+
+// The constant arguments of an invoke. Element i holds the value of parameter
+// i if it is known to be constant.
+using ConstantArgs = std::vector<std::optional<Value>>;
+
+// Returns a name for a specialization of `callee` which is not yet used in the
+// package.
+std::string SpecializationName(Function* callee) {
+  Package* p = callee->package();
+  for (int64_t i = 0;; ++i) {
+    std::string name = absl::StrFormat("%s__ipcp_%d", callee->name(), i);
+    if (!p->TryGetFunction(name).has_value()) {
+      return name;
+    }
+  }
+}
+
+// Returns a clone of `callee` in which each parameter with a constant argument
+// in `args` is replaced by a literal and removed from the signature.
+absl::StatusOr<Function*> Specialize(Function* callee,
+                                     const ConstantArgs& args) {
+  XLS_ASSIGN_OR_RETURN(Function * clone,
+                       callee->Clone(SpecializationName(callee)));
+  // Copy the params as removing them modifies the param list.
+  std::vector<Param*> params(clone->params().begin(), clone->params().end());
+  for (int64_t i = 0; i < params.size(); ++i) {
+    if (!args[i].has_value()) {
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(
+        params[i]->ReplaceUsesWithNew<Literal>(args[i].value()).status());
+    XLS_RETURN_IF_ERROR(clone->RemoveNode(params[i]));
+  }
+  VLOG(3) << absl::StreamFormat("Specialized %s as %s", callee->name(),
+                                clone->name());
+  return clone;
+}
+
+// Retargets invokes in `f` with constant arguments to specializations of their
+// callees. New specializations are appended to `worklist`.
+absl::StatusOr<bool> SpecializeInvokes(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    absl::flat_hash_map<std::pair<Function*, ConstantArgs>, Function*>&
+        specializations,
+    std::deque<FunctionBase*>& worklist) {
+  std::vector<Invoke*> invokes;
+  for (Node* node : f->nodes()) {
+    if (node->Is<Invoke>()) {
+      invokes.push_back(node->As<Invoke>());
+    }
+  }
+  if (invokes.empty()) {
+    return false;
+  }
+
+  std::vector<std::unique_ptr<QueryEngine>> owned_engines;
+  XLS_ASSIGN_OR_RETURN(TernaryQueryEngine * query_engine,
+                       GetPopulatedQueryEngine<TernaryQueryEngine>(
+                           f, options.query_engine_manager, owned_engines));
+
+  bool changed = false;
+  for (Invoke* invoke : invokes) {
+    // Foreign functions are implemented outside of XLS so their signature must
+    // be kept.
+    if (invoke->to_apply()->ForeignFunctionData().has_value()) {
+      continue;
+    }
+    ConstantArgs args;
+    args.reserve(invoke->operand_count());
+    for (Node* operand : invoke->operands()) {
+      args.push_back(query_engine->KnownValue(operand));
+    }
+    if (absl::c_none_of(args, [](const std::optional<Value>& arg) {
+          return arg.has_value();
+        })) {
+      continue;
+    }
+
+    auto [it, inserted] =
+        specializations.insert({{invoke->to_apply(), args}, nullptr});
+    if (inserted) {
+      XLS_ASSIGN_OR_RETURN(it->second, Specialize(invoke->to_apply(), args));
+      worklist.push_back(it->second);
+    }
+    std::vector<Node*> remaining_operands;
+    for (int64_t i = 0; i < args.size(); ++i) {
+      if (!args[i].has_value()) {
+        remaining_operands.push_back(invoke->operand(i));
+      }
+    }
+    XLS_RETURN_IF_ERROR(invoke
+                            ->ReplaceUsesWithNew<Invoke>(remaining_operands,
+                                                         it->second)
+                            .status());
+    XLS_RETURN_IF_ERROR(f->RemoveNode(invoke));
+    changed = true;
+  }
+  return changed;
+}
+
+// Returns true if evaluating `f` may have an effect other than producing its
+// return value. `side_effects` holds the result for each function called by
+// `f`. Foreign functions are treated as having side effects as their IR body
+// is only a stand-in for the real implementation.
+bool HasSideEffects(
+    Function* f, const absl::flat_hash_map<Function*, bool>& side_effects) {
+  if (f->ForeignFunctionData().has_value()) {
+    return true;
+  }
+  return absl::c_any_of(f->nodes(), [&](Node* node) {
+    if (node->Is<Param>()) {
+      return false;
+    }
+    if (node->Is<Invoke>()) {
+      auto it = side_effects.find(node->As<Invoke>()->to_apply());
+      return it == side_effects.end() || it->second;
+    }
+    // Conservatively assume loops and maps may apply a function with side
+    // effects.
+    return OpIsSideEffecting(node->op()) || node->op() == Op::kMap ||
+           node->op() == Op::kCountedFor ||
+           node->op() == Op::kDynamicCountedFor;
+  });
+}
+
+// Replaces invokes of side-effect-free functions with constant return values by
+// literals. Functions are visited callees first so that constant return values
+// propagate up the call graph.
+absl::StatusOr<bool> FoldConstantReturns(Package* p,
+                                         const OptimizationPassOptions& options) {
+  bool changed = false;
+  absl::flat_hash_map<Function*, bool> side_effects;
+  absl::flat_hash_map<Function*, Value> constant_returns;
+  for (FunctionBase* f : FunctionsInPostOrder(p)) {
+    std::vector<Invoke*> invokes;
+    for (Node* node : f->nodes()) {
+      if (node->Is<Invoke>() &&
+          constant_returns.contains(node->As<Invoke>()->to_apply())) {
+        invokes.push_back(node->As<Invoke>());
+      }
+    }
+    for (Invoke* invoke : invokes) {
+      XLS_RETURN_IF_ERROR(
+          invoke
+              ->ReplaceUsesWithNew<Literal>(
+                  constant_returns.at(invoke->to_apply()))
+              .status());
+      XLS_RETURN_IF_ERROR(f->RemoveNode(invoke));
+      changed = true;
+    }
+
+    if (!f->IsFunction()) {
+      continue;
+    }
+    Function* function = f->AsFunctionOrDie();
+    bool function_has_side_effects = HasSideEffects(function, side_effects);
+    side_effects[function] = function_has_side_effects;
+    if (function_has_side_effects) {
+      continue;
+    }
+    if (function->return_value()->Is<Literal>()) {
+      constant_returns[function] =
+          function->return_value()->As<Literal>()->value();
+      continue;
+    }
+    std::vector<std::unique_ptr<QueryEngine>> owned_engines;
+    XLS_ASSIGN_OR_RETURN(
+        TernaryQueryEngine * query_engine,
+        GetPopulatedQueryEngine<TernaryQueryEngine>(
+            function, options.query_engine_manager, owned_engines));
+    std::optional<Value> return_value =
+        query_engine->KnownValue(function->return_value());
+    if (return_value.has_value()) {
+      VLOG(3) << absl::StreamFormat("%s returns constant %s", function->name(),
+                                    return_value->ToString());
+      constant_returns[function] = *std::move(return_value);
+    }
+  }
+  return changed;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> InterproceduralConstantPropagationPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  // Visit callers before callees so that constants propagate down the call
+  // graph, including into the specializations created along the way.
+  std::vector<FunctionBase*> post_order = FunctionsInPostOrder(p);
+  std::deque<FunctionBase*> worklist(post_order.rbegin(), post_order.rend());
+  absl::flat_hash_map<std::pair<Function*, ConstantArgs>, Function*>
+      specializations;
+  bool changed = false;
+  while (!worklist.empty()) {
+    FunctionBase* f = worklist.front();
+    worklist.pop_front();
+    XLS_ASSIGN_OR_RETURN(bool specialized,
+                         SpecializeInvokes(f, options, specializations,
+                                           worklist));
+    changed = changed || specialized;
+  }
+
+  XLS_ASSIGN_OR_RETURN(bool folded, FoldConstantReturns(p, options));
+  return changed || folded;
+}
+
+REGISTER_OPT_PASS(InterproceduralConstantPropagationPass);
+
+}  // namespace xls
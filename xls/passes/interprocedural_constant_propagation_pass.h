@@ -0,0 +1,56 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_INTERPROCEDURAL_CONSTANT_PROPAGATION_PASS_H_
+#define XLS_PASSES_INTERPROCEDURAL_CONSTANT_PROPAGATION_PASS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Pass which propagates constants across invoke boundaries without inlining.
+//
+// Walking the call graph from callers to callees, each invoke with arguments
+// known to be constant (by ternary analysis of the caller) is retargeted to a
+// clone of the callee in which those parameters are removed and replaced with
+// literals. Clones are shared between invokes of the same callee with the same
+// constant arguments. Walking back from callees to callers, invokes of
+// side-effect-free functions whose return value is known to be constant are
+// replaced with a literal.
+//
+// The clones are not simplified by this pass; running the simplification
+// passes afterwards folds the constants through the clones, which can in turn
+// expose constant return values on a later run. Callees left without callers
+// are removed by DeadFunctionEliminationPass.
+class InterproceduralConstantPropagationPass : public OptimizationPass {
+ public:
+  static constexpr std::string_view kName = "ipcp";
+  explicit InterproceduralConstantPropagationPass()
+      : OptimizationPass(kName, "Interprocedural Constant Propagation") {}
+  ~InterproceduralConstantPropagationPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_INTERPROCEDURAL_CONSTANT_PROPAGATION_PASS_H_
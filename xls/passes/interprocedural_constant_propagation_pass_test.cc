@@ -0,0 +1,148 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/interprocedural_constant_propagation_pass.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+class InterproceduralConstantPropagationPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Package* package) {
+    PassResults results;
+    return InterproceduralConstantPropagationPass().Run(
+        package, OptimizationPassOptions(), &results);
+  }
+};
+
+TEST_F(InterproceduralConstantPropagationPassTest, SpecializeConstantArgument) {
+  const std::string program = R"(
+package some_package
+
+fn callee(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(x, y)
+}
+
+fn caller(a: bits[32]) -> bits[32] {
+  literal.2: bits[32] = literal(value=2)
+  ret invoke.3: bits[32] = invoke(a, literal.2, to_apply=callee)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  ASSERT_THAT(Run(package.get()), IsOkAndHolds(true));
+
+  Function* caller = FindFunction("caller", package.get());
+  ASSERT_THAT(caller->return_value(), m::Invoke(m::Param("a")));
+  Function* specialized = caller->return_value()->As<Invoke>()->to_apply();
+  EXPECT_EQ(specialized->name(), "callee__ipcp_0");
+  EXPECT_EQ(specialized->params().size(), 1);
+  EXPECT_THAT(specialized->return_value(),
+              m::Add(m::Param("x"), m::Literal(2)));
+
+  // The original callee is unchanged.
+  Function* callee = FindFunction("callee", package.get());
+  EXPECT_THAT(callee->return_value(), m::Add(m::Param("x"), m::Param("y")));
+}
+
+TEST_F(InterproceduralConstantPropagationPassTest, SpecializationIsShared) {
+  const std::string program = R"(
+package some_package
+
+fn callee(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(x, y)
+}
+
+fn caller(a: bits[32], b: bits[32]) -> (bits[32], bits[32]) {
+  literal.2: bits[32] = literal(value=2)
+  invoke.3: bits[32] = invoke(a, literal.2, to_apply=callee)
+  invoke.4: bits[32] = invoke(b, literal.2, to_apply=callee)
+  ret tuple.5: (bits[32], bits[32]) = tuple(invoke.3, invoke.4)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  ASSERT_THAT(Run(package.get()), IsOkAndHolds(true));
+
+  Function* caller = FindFunction("caller", package.get());
+  ASSERT_THAT(caller->return_value(),
+              m::Tuple(m::Invoke(m::Param("a")), m::Invoke(m::Param("b"))));
+  EXPECT_EQ(
+      caller->return_value()->operand(0)->As<Invoke>()->to_apply(),
+      caller->return_value()->operand(1)->As<Invoke>()->to_apply());
+  EXPECT_EQ(package->functions().size(), 3);
+}
+
+TEST_F(InterproceduralConstantPropagationPassTest, FoldConstantReturn) {
+  const std::string program = R"(
+package some_package
+
+fn callee(x: bits[8]) -> bits[8] {
+  literal.1: bits[8] = literal(value=0)
+  ret and.2: bits[8] = and(x, literal.1)
+}
+
+fn caller(a: bits[8]) -> bits[8] {
+  ret invoke.3: bits[8] = invoke(a, to_apply=callee)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  ASSERT_THAT(Run(package.get()), IsOkAndHolds(true));
+
+  Function* caller = FindFunction("caller", package.get());
+  EXPECT_THAT(caller->return_value(), m::Literal(0));
+}
+
+TEST_F(InterproceduralConstantPropagationPassTest,
+       SideEffectingCalleeNotFolded) {
+  const std::string program = R"(
+package some_package
+
+fn callee(tkn: token, x: bits[8]) -> bits[8] {
+  literal.1: bits[8] = literal(value=0)
+  literal.2: bits[1] = literal(value=0)
+  assert.3: token = assert(tkn, literal.2, message="boom")
+  ret and.4: bits[8] = and(x, literal.1)
+}
+
+fn caller(tkn: token, a: bits[8]) -> bits[8] {
+  ret invoke.5: bits[8] = invoke(tkn, a, to_apply=callee)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  ASSERT_THAT(Run(package.get()), IsOkAndHolds(false));
+
+  Function* caller = FindFunction("caller", package.get());
+  EXPECT_THAT(caller->return_value(), m::Invoke());
+}
+
+}  // namespace
+}  // namespace xls
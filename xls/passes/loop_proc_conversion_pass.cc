@@ -0,0 +1,226 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/loop_proc_conversion_pass.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+// Returns `name`, suffixed if necessary to not collide with an existing
+// channel in `p`.
+std::string UniqueChannelName(Package* p, std::string_view name) {
+  std::string result(name);
+  for (int64_t i = 1; p->HasChannelWithName(result); ++i) {
+    result = absl::StrCat(name, "__", i);
+  }
+  return result;
+}
+
+// Returns true if `loop` should be moved into its own proc.
+bool ShouldConvert(CountedFor* loop, int64_t iterations_per_activation) {
+  if (loop->trip_count() <= iterations_per_activation) {
+    return false;
+  }
+  if (loop->users().empty() && !loop->function_base()->HasImplicitUse(loop)) {
+    return false;
+  }
+  // Tokens can't be carried in proc state or sent over channels.
+  if (TypeHasToken(loop->GetType())) {
+    return false;
+  }
+  for (Node* invariant : loop->invariant_args()) {
+    if (TypeHasToken(invariant->GetType())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Builds the proc executing `loop`, `iterations_per_activation` iterations at
+// a time. The proc receives a tuple of the initial loop carry and the
+// invariant arguments on `request` and sends the final loop carry on
+// `response`.
+absl::Status BuildLoopProc(std::string_view name, CountedFor* loop,
+                           int64_t iterations_per_activation, Channel* request,
+                           Channel* response) {
+  Package* p = loop->package();
+  Type* carry_type = loop->GetType();
+  Type* invariants_type = request->type()->AsTupleOrDie()->element_type(1);
+  int64_t ivar_width = loop->body()->params()[0]->BitCountOrDie();
+  int64_t trip_width = Bits::MinBitCountUnsigned(loop->trip_count() +
+                                                 iterations_per_activation);
+
+  ProcBuilder pb(name, p);
+  BValue busy = pb.StateElement("busy", Value(UBits(0, 1)));
+  BValue trip = pb.StateElement("trip", Value(UBits(0, trip_width)));
+  BValue ivar = pb.StateElement("ivar", Value(UBits(0, ivar_width)));
+  BValue carry = pb.StateElement("carry", ZeroOfType(carry_type));
+  BValue invariants =
+      pb.StateElement("invariants", ZeroOfType(invariants_type));
+
+  // Start a new loop when idle.
+  BValue receive = pb.ReceiveIf(request, pb.Literal(Value::Token()),
+                                pb.Not(busy), loop->loc());
+  BValue request_data = pb.TupleIndex(receive, 1);
+  BValue current_carry =
+      pb.Select(busy, carry, pb.TupleIndex(request_data, 0));
+  BValue current_invariants =
+      pb.Select(busy, invariants, pb.TupleIndex(request_data, 1));
+  BValue current_trip = pb.Select(busy, trip, pb.Literal(UBits(0, trip_width)));
+  BValue current_ivar =
+      pb.Select(busy, ivar, pb.Literal(UBits(0, ivar_width)));
+
+  BValue trip_count = pb.Literal(UBits(loop->trip_count(), trip_width));
+  BValue one = pb.Literal(UBits(1, trip_width));
+  BValue stride = pb.Literal(UBits(loop->stride(), ivar_width));
+  for (int64_t i = 0; i < iterations_per_activation; ++i) {
+    std::vector<BValue> args = {current_ivar, current_carry};
+    for (int64_t j = 0; j < loop->invariant_args().size(); ++j) {
+      args.push_back(pb.TupleIndex(current_invariants, j));
+    }
+    BValue next_carry = pb.Invoke(args, loop->body(), loop->loc());
+    current_carry = pb.Select(pb.ULt(current_trip, trip_count), next_carry,
+                              current_carry);
+    current_trip = pb.Add(current_trip, one);
+    current_ivar = pb.Add(current_ivar, stride);
+  }
+
+  BValue done = pb.UGe(current_trip, trip_count);
+  pb.SendIf(response, pb.TupleIndex(receive, 0), done, current_carry,
+            loop->loc());
+  return pb
+      .Build({pb.Not(done), current_trip, current_ivar, current_carry,
+              current_invariants})
+      .status();
+}
+
+// Replaces `loop` in `proc` with a request to and a response from a new proc
+// executing the loop.
+absl::Status ConvertLoop(Proc* proc, CountedFor* loop,
+                         int64_t iterations_per_activation) {
+  Package* p = proc->package();
+  std::string base_name = absl::StrCat(proc->name(), "__", loop->GetName());
+  std::string proc_name = base_name;
+  for (int64_t i = 1; p->TryGetProc(proc_name).has_value(); ++i) {
+    proc_name = absl::StrCat(base_name, "__", i);
+  }
+
+  std::vector<Type*> invariant_types;
+  for (Node* invariant : loop->invariant_args()) {
+    invariant_types.push_back(invariant->GetType());
+  }
+  Type* request_type = p->GetTupleType(
+      {loop->GetType(), p->GetTupleType(invariant_types)});
+  XLS_ASSIGN_OR_RETURN(
+      StreamingChannel * request,
+      p->CreateStreamingChannel(
+          UniqueChannelName(p, absl::StrCat(proc_name, "_request")),
+          ChannelOps::kSendReceive, request_type));
+  XLS_ASSIGN_OR_RETURN(
+      StreamingChannel * response,
+      p->CreateStreamingChannel(
+          UniqueChannelName(p, absl::StrCat(proc_name, "_response")),
+          ChannelOps::kSendReceive, loop->GetType()));
+  XLS_RETURN_IF_ERROR(BuildLoopProc(proc_name, loop, iterations_per_activation,
+                                    request, response));
+
+  XLS_ASSIGN_OR_RETURN(Node * token,
+                       proc->MakeNode<Literal>(loop->loc(), Value::Token()));
+  std::vector<Node*> invariants(loop->invariant_args().begin(),
+                                loop->invariant_args().end());
+  XLS_ASSIGN_OR_RETURN(Node * invariant_tuple,
+                       proc->MakeNode<Tuple>(loop->loc(), invariants));
+  XLS_ASSIGN_OR_RETURN(
+      Node * request_data,
+      proc->MakeNode<Tuple>(
+          loop->loc(), std::vector<Node*>{loop->initial_value(),
+                                          invariant_tuple}));
+  XLS_ASSIGN_OR_RETURN(
+      Node * send,
+      proc->MakeNode<Send>(loop->loc(), token, request_data,
+                           /*predicate=*/std::nullopt, request->name()));
+  XLS_ASSIGN_OR_RETURN(
+      Node * receive,
+      proc->MakeNode<Receive>(loop->loc(), send, /*predicate=*/std::nullopt,
+                              response->name(), /*is_blocking=*/true));
+  XLS_RETURN_IF_ERROR(
+      loop->ReplaceUsesWithNew<TupleIndex>(receive, 1).status());
+  return proc->RemoveNode(loop);
+}
+
+}  // namespace
+
+absl::StatusOr<bool> LoopProcConversionPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  if (!options.loop_iterations_per_activation.has_value()) {
+    return false;
+  }
+  int64_t iterations_per_activation = *options.loop_iterations_per_activation;
+  XLS_RET_CHECK_GT(iterations_per_activation, 0);
+
+  // Collect the loops up front as converting them adds procs to the package.
+  std::vector<std::pair<Proc*, CountedFor*>> loops;
+  for (const std::unique_ptr<Proc>& proc : p->procs()) {
+    // New-style procs would need the channels declared in the proc and the
+    // loop proc instantiated; leave their loops to be unrolled.
+    if (proc->is_new_style_proc()) {
+      continue;
+    }
+    for (Node* node : TopoSort(proc.get())) {
+      if (node->Is<CountedFor>() &&
+          ShouldConvert(node->As<CountedFor>(), iterations_per_activation)) {
+        loops.push_back({proc.get(), node->As<CountedFor>()});
+      }
+    }
+  }
+  for (const auto& [proc, loop] : loops) {
+    XLS_RETURN_IF_ERROR(ConvertLoop(proc, loop, iterations_per_activation));
+  }
+  return !loops.empty();
+}
+
+REGISTER_OPT_PASS(LoopProcConversionPass);
+
+}  // namespace xls
@@ -0,0 +1,54 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_LOOP_PROC_CONVERSION_PASS_H_
+#define XLS_PASSES_LOOP_PROC_CONVERSION_PASS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Pass which time-multiplexes long counted_for loops in procs rather than
+// unrolling them.
+//
+// If OptimizationPassOptions::loop_iterations_per_activation is set to K, each
+// counted_for in an (old-style) proc with more than K iterations is moved into
+// a new proc which executes K iterations of the loop body per activation. The
+// new proc receives the initial loop carry and the invariant arguments on a
+// request channel, iterates while holding them in its state, and sends the
+// final loop carry on a response channel. The counted_for in the original proc
+// is replaced by a send on the request channel followed by a blocking receive
+// on the response channel, so each activation of the original proc stalls
+// until the loop completes. Smaller K means less area and lower throughput.
+class LoopProcConversionPass : public OptimizationPass {
+ public:
+  static constexpr std::string_view kName = "loop_proc_conversion";
+  LoopProcConversionPass()
+      : OptimizationPass(kName, "Convert counted loops to procs") {}
+  ~LoopProcConversionPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_LOOP_PROC_CONVERSION_PASS_H_
@@ -0,0 +1,148 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/loop_proc_conversion_pass.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+using ::testing::SizeIs;
+
+class LoopProcConversionPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Package* p,
+                           std::optional<int64_t> iterations_per_activation) {
+    PassResults results;
+    OptimizationPassOptions options;
+    options.loop_iterations_per_activation = iterations_per_activation;
+    return LoopProcConversionPass().Run(p, options, &results);
+  }
+
+  // Creates a proc which receives `x` on `in` and sends the sum of `x * i` for
+  // `i` in [0, 10) on `out`, computed by a counted_for in the proc.
+  void CreateSumProc(Package* p) {
+    Type* u32 = p->GetBitsType(32);
+    Function* body;
+    {
+      FunctionBuilder fb("body", p);
+      BValue i = fb.Param("i", u32);
+      BValue acc = fb.Param("acc", u32);
+      BValue x = fb.Param("x", u32);
+      fb.Add(acc, fb.UMul(i, x));
+      XLS_ASSERT_OK_AND_ASSIGN(body, fb.Build());
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * in,
+        p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * out,
+        p->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+    ProcBuilder pb("sum", p);
+    BValue receive = pb.Receive(in, pb.Literal(Value::Token()));
+    BValue sum = pb.CountedFor(pb.Literal(UBits(0, 32)), /*trip_count=*/10,
+                               /*stride=*/1, body,
+                               {pb.TupleIndex(receive, 1)});
+    pb.Send(out, pb.TupleIndex(receive, 0), sum);
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+
+  // Runs the procs of `p` on the inputs and returns the outputs.
+  absl::StatusOr<std::vector<Value>> Simulate(Package* p,
+                                              absl::Span<const Value> inputs) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcRuntime> runtime,
+                         CreateInterpreterSerialProcRuntime(p));
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
+                         runtime->queue_manager().GetQueueByName("in"));
+    XLS_RETURN_IF_ERROR(in_queue->WriteValues(inputs));
+    XLS_ASSIGN_OR_RETURN(Channel * out, p->GetChannel("out"));
+    XLS_RETURN_IF_ERROR(
+        runtime
+            ->TickUntilOutput(absl::flat_hash_map<Channel*, int64_t>{{
+                                  out, static_cast<int64_t>(inputs.size())}},
+                              /*max_ticks=*/100)
+            .status());
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
+                         runtime->queue_manager().GetQueueByName("out"));
+    std::vector<Value> outputs;
+    while (std::optional<Value> value = out_queue->Read()) {
+      outputs.push_back(*value);
+    }
+    return outputs;
+  }
+};
+
+TEST_F(LoopProcConversionPassTest, DisabledByDefault) {
+  auto p = CreatePackage();
+  CreateSumProc(p.get());
+  EXPECT_THAT(Run(p.get(), std::nullopt), IsOkAndHolds(false));
+  EXPECT_THAT(p->procs(), SizeIs(1));
+}
+
+TEST_F(LoopProcConversionPassTest, ShortLoopNotConverted) {
+  auto p = CreatePackage();
+  CreateSumProc(p.get());
+  EXPECT_THAT(Run(p.get(), 10), IsOkAndHolds(false));
+  EXPECT_THAT(p->procs(), SizeIs(1));
+}
+
+TEST_F(LoopProcConversionPassTest, ConvertsLoop) {
+  for (int64_t iterations_per_activation : {1, 3, 9}) {
+    auto p = CreatePackage();
+    CreateSumProc(p.get());
+    EXPECT_THAT(Run(p.get(), iterations_per_activation), IsOkAndHolds(true));
+    ASSERT_THAT(p->procs(), SizeIs(2));
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * sum, p->GetProc("sum"));
+    for (Node* node : sum->nodes()) {
+      EXPECT_FALSE(node->Is<CountedFor>());
+    }
+    EXPECT_THAT(
+        Simulate(p.get(), {Value(UBits(1, 32)), Value(UBits(2, 32)),
+                           Value(UBits(7, 32))}),
+        IsOkAndHolds(ElementsAre(Value(UBits(45, 32)), Value(UBits(90, 32)),
+                                 Value(UBits(315, 32)))));
+  }
+}
+
+}  // namespace
+}  // namespace xls
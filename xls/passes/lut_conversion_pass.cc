@@ -17,7 +17,6 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -26,13 +25,13 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/math_util.h"
@@ -106,6 +105,116 @@ Node* GetCase(Select* select, const Bits& selector) {
   return select->get_case(static_cast<int64_t>(*selector_value));
 }
 
+// Evaluates a node as a function of the values of a set of input nodes which
+// cut it from the rest of the graph. The cone between the inputs and the node
+// is flattened into a sequence of steps over a table of values once, so each
+// evaluation only visits the nodes which depend on the inputs.
+class ConeEvaluator {
+ public:
+  static absl::StatusOr<ConeEvaluator> Create(Node* root,
+                                              absl::Span<Node* const> inputs,
+                                              const QueryEngine& query_engine) {
+    ConeEvaluator evaluator;
+    absl::flat_hash_map<Node*, int64_t> slots;
+    auto add_slot = [&](Node* node) {
+      int64_t slot = evaluator.values_.size();
+      slots[node] = slot;
+      evaluator.values_.push_back(Value());
+      return slot;
+    };
+    for (Node* input : inputs) {
+      evaluator.input_slots_.push_back(add_slot(input));
+    }
+
+    // Collect the cone in topological order, stopping at the inputs and at
+    // nodes with known values.
+    std::vector<Node*> cone;
+    std::vector<std::pair<Node*, bool>> stack = {{root, false}};
+    while (!stack.empty()) {
+      auto [node, operands_visited] = stack.back();
+      stack.pop_back();
+      if (operands_visited) {
+        cone.push_back(node);
+        continue;
+      }
+      if (slots.contains(node)) {
+        continue;
+      }
+      if (std::optional<Value> known_value = query_engine.KnownValue(node);
+          known_value.has_value()) {
+        evaluator.values_[add_slot(node)] = *std::move(known_value);
+        continue;
+      }
+      add_slot(node);
+      stack.push_back({node, true});
+      for (Node* operand : node->operands()) {
+        if (!slots.contains(operand)) {
+          stack.push_back({operand, false});
+        }
+      }
+    }
+
+    // Nodes which don't depend on the inputs are evaluated once here.
+    absl::flat_hash_set<Node*> dependent(inputs.begin(), inputs.end());
+    std::vector<Value> operand_values;
+    for (Node* node : cone) {
+      Step step{.node = node, .slot = slots.at(node)};
+      bool is_dependent = false;
+      for (Node* operand : node->operands()) {
+        step.operand_slots.push_back(slots.at(operand));
+        is_dependent = is_dependent || dependent.contains(operand);
+      }
+      if (is_dependent) {
+        dependent.insert(node);
+        evaluator.steps_.push_back(std::move(step));
+        continue;
+      }
+      evaluator.GatherOperands(step, operand_values);
+      XLS_ASSIGN_OR_RETURN(evaluator.values_[step.slot],
+                           InterpretNode(node, operand_values));
+    }
+    evaluator.root_slot_ = slots.at(root);
+    return evaluator;
+  }
+
+  // Returns the value of the root given the values of the inputs, in the order
+  // the inputs were given to Create.
+  absl::StatusOr<Value> Evaluate(absl::Span<const Value> input_values) {
+    XLS_RET_CHECK_EQ(input_values.size(), input_slots_.size());
+    for (int64_t i = 0; i < input_values.size(); ++i) {
+      values_[input_slots_[i]] = input_values[i];
+    }
+    for (const Step& step : steps_) {
+      GatherOperands(step, operand_values_);
+      XLS_ASSIGN_OR_RETURN(values_[step.slot],
+                           InterpretNode(step.node, operand_values_));
+    }
+    return values_[root_slot_];
+  }
+
+ private:
+  struct Step {
+    Node* node;
+    int64_t slot;
+    std::vector<int64_t> operand_slots;
+  };
+
+  ConeEvaluator() = default;
+
+  void GatherOperands(const Step& step, std::vector<Value>& operand_values) {
+    operand_values.clear();
+    for (int64_t slot : step.operand_slots) {
+      operand_values.push_back(values_[slot]);
+    }
+  }
+
+  std::vector<Value> values_;
+  std::vector<int64_t> input_slots_;
+  std::vector<Step> steps_;
+  int64_t root_slot_ = 0;
+  std::vector<Value> operand_values_;
+};
+
 absl::StatusOr<bool> MaybeMergeLutIntoSelects(
     Node* selector, const QueryEngine& query_engine, int64_t opt_level,
     std::optional<DataflowGraphAnalysis>& dataflow_graph_analysis) {
@@ -204,26 +313,8 @@ absl::StatusOr<bool> MaybeMergeLutIntoSelects(
     }
   }
 
-  // Populate an interpreter with all known values that feed into the
-  // selector.
-  IrInterpreter base_interpreter;
-  std::vector<Node*> to_visit({selector});
-  absl::flat_hash_set<Node*> visited;
-  while (!to_visit.empty()) {
-    Node* n = to_visit.back();
-    to_visit.pop_back();
-    if (visited.contains(n) || base_interpreter.IsVisited(n)) {
-      continue;
-    }
-    if (std::optional<Value> known_value = query_engine.KnownValue(n);
-        known_value.has_value()) {
-      XLS_RETURN_IF_ERROR(base_interpreter.SetValueResult(n, *known_value));
-      base_interpreter.MarkVisited(n);
-    } else {
-      absl::c_copy(n->operands(), std::back_inserter(to_visit));
-      visited.insert(n);
-    }
-  }
+  XLS_ASSIGN_OR_RETURN(ConeEvaluator cone,
+                       ConeEvaluator::Create(selector, min_cut, query_engine));
 
   std::vector<std::vector<Value>> cut_values(min_cut.size());
   for (size_t i = 0; i < min_cut.size(); ++i) {
@@ -242,44 +333,21 @@ absl::StatusOr<bool> MaybeMergeLutIntoSelects(
 
   std::vector<Bits> new_case_sequence;
   new_case_sequence.reserve(new_case_count);
+  std::vector<Value> inputs(min_cut.size());
   absl::Status status = absl::OkStatus();
   MixedRadixIterate(
       values_radix, [&](const std::vector<int64_t>& value_indices) {
-        // Invoke an interpreter using known values & these values on the
-        // min-cut to compute the value of the selector.
-        IrInterpreter interpreter = base_interpreter;
+        // Compute the value of the selector from these values on the min-cut.
         for (size_t i = 0; i < value_indices.size(); ++i) {
-          Node* cut_node = min_cut[i];
-          int64_t value_index = value_indices[i];
-          const Value& cut_value = cut_values[i][value_index];
-          if (interpreter.IsVisited(cut_node)) {
-            // It seems this cut node is actually fully-known!
-            if (const Value& resolved_value =
-                    interpreter.ResolveAsValue(cut_node);
-                resolved_value != cut_value) {
-              status.Update(absl::InternalError(absl::StrFormat(
-                  "Cut node %s has different value in interpreter (%s) than "
-                  "expected (%s)",
-                  cut_node->ToString(), resolved_value.ToString(),
-                  cut_value.ToString())));
-              return true;
-            }
-          } else {
-            status.Update(interpreter.SetValueResult(cut_node, cut_value));
-            if (!status.ok()) {
-              return true;
-            }
-            interpreter.MarkVisited(cut_node);
-          }
+          inputs[i] = cut_values[i][value_indices[i]];
         }
-        status.Update(selector->Accept(&interpreter));
-        if (!status.ok()) {
+        absl::StatusOr<Value> selector_value = cone.Evaluate(inputs);
+        if (!selector_value.ok()) {
+          status.Update(selector_value.status());
           return true;
         }
-
-        Value selector_value = interpreter.ResolveAsValue(selector);
-        CHECK(selector_value.IsBits());
-        new_case_sequence.push_back(std::move(selector_value).bits());
+        CHECK(selector_value->IsBits());
+        new_case_sequence.push_back(std::move(selector_value)->bits());
         return false;
       });
   XLS_RETURN_IF_ERROR(status);
@@ -14,25 +14,31 @@
 
 #include "xls/passes/map_inlining_pass.h"
 
+#include <cstdint>
 #include <vector>
 
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/value.h"
+#include "xls/passes/inlining_pass.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/pass_pipeline.pb.h"
 
 namespace xls {
 
-MapInliningPass::MapInliningPass()
+MapInliningPass::MapInliningPass(bool fold_invocations)
     : OptimizationFunctionBasePass(MapInliningPass::kName,
-                                   "Inline map operations") {}
+                                   "Inline map operations"),
+      fold_invocations_(fold_invocations) {}
 
 absl::StatusOr<bool> MapInliningPass::RunOnFunctionBaseInternal(
     FunctionBase* function, const OptimizationPassOptions& options,
@@ -42,12 +48,18 @@ absl::StatusOr<bool> MapInliningPass::RunOnFunctionBaseInternal(
   for (Node* node : function->nodes()) {
     if (node->Is<Map>()) {
       map_nodes.push_back(node);
-      changed = true;
     }
   }
 
   for (Node* node : map_nodes) {
-    XLS_RETURN_IF_ERROR(ReplaceMap(node->As<Map>()));
+    Map* map = node->As<Map>();
+    int64_t growth = map->operand(0)->GetType()->AsArrayOrDie()->size() *
+                     (map->to_apply()->node_count() + 2);
+    if (!FitsNodeBudget(short_name(), map, growth, options, results)) {
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(ReplaceMap(map));
+    changed = true;
   }
 
   return changed;
@@ -64,19 +76,35 @@ absl::Status MapInliningPass::ReplaceMap(Map* map) const {
   int map_inputs_size = map->operand(0)->GetType()->AsArrayOrDie()->size();
   std::vector<Node*> invocations;
   invocations.reserve(map_inputs_size);
+  Node* input = map->operand(0);
   for (int i = 0; i < map_inputs_size; i++) {
-    Value index_value =
-        Value(UBits(i, Bits::MinBitCountUnsigned(map_inputs_size)));
-    XLS_ASSIGN_OR_RETURN(Node * index,
-                         function->MakeNode<Literal>(map->loc(), index_value));
-    XLS_ASSIGN_OR_RETURN(Node * array_index, function->MakeNode<ArrayIndex>(
-                                                 map->loc(), map->operand(0),
-                                                 std::vector<Node*>({index})));
+    Node* element;
+    if (fold_invocations_ && input->Is<Literal>()) {
+      XLS_ASSIGN_OR_RETURN(
+          element, function->MakeNode<Literal>(
+                       map->loc(), input->As<Literal>()->value().element(i)));
+    } else if (fold_invocations_ && input->Is<Array>()) {
+      element = input->operand(i);
+    } else {
+      Value index_value =
+          Value(UBits(i, Bits::MinBitCountUnsigned(map_inputs_size)));
+      XLS_ASSIGN_OR_RETURN(
+          Node * index, function->MakeNode<Literal>(map->loc(), index_value));
+      XLS_ASSIGN_OR_RETURN(element, function->MakeNode<ArrayIndex>(
+                                        map->loc(), input,
+                                        std::vector<Node*>({index})));
+    }
     XLS_ASSIGN_OR_RETURN(
-        Node * node,
-        function->MakeNode<Invoke>(map->loc(), absl::MakeSpan(&array_index, 1),
+        Invoke * invoke,
+        function->MakeNode<Invoke>(map->loc(), absl::MakeSpan(&element, 1),
                                    map->to_apply()));
-    invocations.push_back(node);
+    if (fold_invocations_) {
+      XLS_ASSIGN_OR_RETURN(Node * node,
+                           InliningPass::InlineAndFoldInvoke(invoke));
+      invocations.push_back(node);
+    } else {
+      invocations.push_back(invoke);
+    }
   }
 
   Type* output_element_type = map->GetType()->AsArrayOrDie()->element_type();
@@ -86,6 +114,17 @@ absl::Status MapInliningPass::ReplaceMap(Map* map) const {
   return function->RemoveNode(map);
 }
 
-REGISTER_OPT_PASS(MapInliningPass);
+absl::StatusOr<PassPipelineProto::Element> MapInliningPass::ToProto() const {
+  PassPipelineProto::Element e;
+  *e.mutable_pass_name() = fold_invocations_ ? "map_inlining(fold)" : kName;
+  return e;
+}
+
+XLS_REGISTER_MODULE_INITIALIZER(map_inlining, {
+  CHECK_OK(RegisterOptimizationPass<MapInliningPass>(MapInliningPass::kName,
+                                                     false));
+  CHECK_OK(
+      RegisterOptimizationPass<MapInliningPass>("map_inlining(fold)", true));
+});
 
 }  // namespace xls
@@ -23,15 +23,20 @@
 #include "xls/ir/nodes.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/pass_pipeline.pb.h"
 
 namespace xls {
 
 // A pass to convert map nodes to in-line Invoke nodes. We don't directly lower
-// maps to Verilog.
+// maps to Verilog. If `fold_invocations` is true, each invocation is instead
+// inlined as it is created and simplified for its arguments where they are
+// constant (e.g., elements of a literal array).
 class MapInliningPass : public OptimizationFunctionBasePass {
  public:
   static constexpr std::string_view kName = "map_inlining";
-  MapInliningPass();
+  explicit MapInliningPass(bool fold_invocations = false);
+
+  absl::StatusOr<PassPipelineProto::Element> ToProto() const override;
 
   // Inline a single Map instruction. Provided for test and utility
   // (ir_minimizer) use.
@@ -42,8 +47,13 @@ class MapInliningPass : public OptimizationFunctionBasePass {
       FunctionBase* function, const OptimizationPassOptions& options,
       PassResults* results) const override;
 
+  bool UsesNodeBudget() const override { return true; }
+
   // Replaces a single Map node with a CountedFor operation.
   absl::Status ReplaceMap(Map* map) const;
+
+ private:
+  bool fold_invocations_;
 };
 
 }  // namespace xls
@@ -123,5 +123,36 @@ TEST_F(MapInliningPassTest, InlineOneMap) {
                map_two.node()));
 }
 
+TEST_F(MapInliningPassTest, FoldInvocations) {
+  const char kPackage[] = R"(
+package p
+
+fn map_fn(x: bits[32]) -> bits[16] {
+  ret bit_slice.1: bits[16] = bit_slice(x, start=0, width=16)
+}
+
+fn main(a: bits[32]) -> bits[16][3] {
+  literal_1: bits[32] = literal(value=0x123)
+  literal_2: bits[32] = literal(value=0x456)
+  array_1: bits[32][3] = array(literal_1, a, literal_2)
+  ret result: bits[16][3] = map(array_1, to_apply=map_fn)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(auto func, package->GetFunction("main"));
+  MapInliningPass pass(/*fold_invocations=*/true);
+  OptimizationPassOptions options;
+  XLS_ASSERT_OK_AND_ASSIGN(bool changed,
+                           pass.RunOnFunctionBase(func, options, nullptr));
+  ASSERT_TRUE(changed);
+
+  // The elements are taken directly from the array operand and the map
+  // function is inlined and folded where its argument is constant.
+  EXPECT_THAT(func->return_value(),
+              m::Array(m::Literal(0x123), m::BitSlice(m::Param("a")),
+                       m::Literal(0x456)));
+}
+
 }  // namespace
 }  // namespace xls
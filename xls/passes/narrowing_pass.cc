@@ -69,6 +69,7 @@
 #include "xls/passes/predicate_state.h"
 #include "xls/passes/proc_state_range_query_engine.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_manager.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -1786,31 +1787,53 @@ void AnalysisLog(FunctionBase* f, const QueryEngine& query_engine) {
   }
 }
 
-absl::StatusOr<AliasingQueryEngine> GetQueryEngine(FunctionBase* f,
-                                                   AnalysisType analysis) {
-  std::vector<std::unique_ptr<QueryEngine>> engines;
-  engines.push_back(std::make_unique<StatelessQueryEngine>());
+// Adds an engine of type `EngineT` populated on `f` to `engines`, shared
+// through `manager` if it is non-null.
+template <typename EngineT>
+absl::Status AddPopulatedEngine(
+    FunctionBase* f, QueryEngineManager* manager,
+    std::vector<QueryEngine*>& engines,
+    std::vector<std::unique_ptr<QueryEngine>>& owned_engines) {
+  XLS_ASSIGN_OR_RETURN(
+      EngineT * engine,
+      GetPopulatedQueryEngine<EngineT>(f, manager, owned_engines));
+  engines.push_back(engine);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<AliasingQueryEngine> GetQueryEngine(
+    FunctionBase* f, AnalysisType analysis, QueryEngineManager* manager) {
+  std::vector<std::unique_ptr<QueryEngine>> owned;
+  owned.push_back(std::make_unique<StatelessQueryEngine>());
+  std::vector<QueryEngine*> engines = {owned.back().get()};
   if (analysis == AnalysisType::kRangeWithContext) {
     if (ProcStateRangeQueryEngine::CanAnalyzeProcStateEvolution(f)) {
       // NB ProcStateRange already includes a ternary qe
-      engines.push_back(std::make_unique<ProcStateRangeQueryEngine>());
+      XLS_RETURN_IF_ERROR(AddPopulatedEngine<ProcStateRangeQueryEngine>(
+          f, manager, engines, owned));
     } else {
-      engines.push_back(std::make_unique<TernaryQueryEngine>());
+      XLS_RETURN_IF_ERROR(
+          AddPopulatedEngine<TernaryQueryEngine>(f, manager, engines, owned));
     }
-    engines.push_back(std::make_unique<ContextSensitiveRangeQueryEngine>());
+    XLS_RETURN_IF_ERROR(AddPopulatedEngine<ContextSensitiveRangeQueryEngine>(
+        f, manager, engines, owned));
   } else if (analysis == AnalysisType::kRange) {
     if (ProcStateRangeQueryEngine::CanAnalyzeProcStateEvolution(f)) {
       // NB ProcStateRange already includes a ternary qe
-      engines.push_back(std::make_unique<ProcStateRangeQueryEngine>());
+      XLS_RETURN_IF_ERROR(AddPopulatedEngine<ProcStateRangeQueryEngine>(
+          f, manager, engines, owned));
     } else {
-      engines.push_back(std::make_unique<TernaryQueryEngine>());
-      engines.push_back(std::make_unique<RangeQueryEngine>());
+      XLS_RETURN_IF_ERROR(
+          AddPopulatedEngine<TernaryQueryEngine>(f, manager, engines, owned));
+      XLS_RETURN_IF_ERROR(
+          AddPopulatedEngine<RangeQueryEngine>(f, manager, engines, owned));
     }
   } else {
-    engines.push_back(std::make_unique<TernaryQueryEngine>());
+    XLS_RETURN_IF_ERROR(
+        AddPopulatedEngine<TernaryQueryEngine>(f, manager, engines, owned));
   }
-  auto query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
-  XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
+  auto query_engine =
+      std::make_unique<UnionQueryEngine>(std::move(engines), std::move(owned));
   if (VLOG_IS_ON(3)) {
     AnalysisLog(f, *query_engine);
   }
@@ -1823,7 +1846,8 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
   XLS_ASSIGN_OR_RETURN(AliasingQueryEngine query_engine,
-                       GetQueryEngine(f, RealAnalysis(options)));
+                       GetQueryEngine(f, RealAnalysis(options),
+                                      options.query_engine_manager));
 
   PredicateDominatorAnalysis pda = PredicateDominatorAnalysis::Run(f);
   SpecializedQueryEngines sqe(RealAnalysis(options), pda, query_engine);
@@ -53,6 +53,8 @@ class NarrowingPass : public OptimizationFunctionBasePass {
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+  bool SkipsUnchangedFunctionBases() const override { return true; }
 };
 
 std::ostream& operator<<(std::ostream& os, NarrowingPass::AnalysisType a);
@@ -14,12 +14,19 @@
 
 #include "xls/passes/node_dependency_analysis.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
 #include <tuple>
 #include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -81,16 +88,191 @@ AnalyzeDependents(FunctionBase* f,
   return {results, node_ids};
 }
 
+// Lazy analyses index nodes in topological order so that cones are mostly
+// contiguous.
+absl::flat_hash_map<Node*, int64_t> TopologicalIndices(FunctionBase* fb) {
+  absl::flat_hash_map<Node*, int64_t> node_ids;
+  node_ids.reserve(fb->node_count());
+  for (Node* n : TopoSort(fb)) {
+    node_ids.emplace(n, node_ids.size());
+  }
+  return node_ids;
+}
+
 }  // namespace
 
+DependencyIntervals::DependencyIntervals(std::vector<int64_t> indices) {
+  absl::c_sort(indices);
+  for (int64_t index : indices) {
+    if (!intervals_.empty() && index <= intervals_.back().second) {
+      intervals_.back().second = std::max(intervals_.back().second, index + 1);
+    } else {
+      intervals_.push_back({index, index + 1});
+    }
+  }
+}
+
+bool DependencyIntervals::Contains(int64_t index) const {
+  // Find the first interval which starts after 'index'; only the one before it
+  // can contain 'index'.
+  auto it = absl::c_upper_bound(
+      intervals_, index,
+      [](int64_t i, const std::pair<int64_t, int64_t>& interval) {
+        return i < interval.first;
+      });
+  return it != intervals_.begin() && index < std::prev(it)->second;
+}
+
+int64_t DependencyIntervals::size() const {
+  int64_t size = 0;
+  for (const auto& [start, limit] : intervals_) {
+    size += limit - start;
+  }
+  return size;
+}
+
+InlineBitmap DependencyIntervals::ToBitmap(int64_t bit_count) const {
+  InlineBitmap bitmap(bit_count);
+  for (const auto& [start, limit] : intervals_) {
+    for (int64_t i = start; i < limit; ++i) {
+      bitmap.Set(i);
+    }
+  }
+  return bitmap;
+}
+
+// Least-recently-used cache of lazily computed dependents.
+class NodeDependencyAnalysis::LazyDependents {
+ public:
+  LazyDependents(int64_t node_count, int64_t cache_size)
+      : cache_size_(cache_size), visited_epoch_(node_count, 0) {
+    CHECK_GT(cache_size, 0);
+  }
+
+  // Returns the dependents of 'node' which stay valid until the next call.
+  const DependencyIntervals& Get(
+      Node* node, bool is_forward,
+      const absl::flat_hash_map<Node*, int64_t>& node_indices) {
+    auto it = entries_.find(node);
+    if (it != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+      return it->second.dependents;
+    }
+    if (entries_.size() >= cache_size_) {
+      entries_.erase(lru_.back());
+      lru_.pop_back();
+    }
+    lru_.push_front(node);
+    Entry& entry = entries_[node];
+    entry.dependents = Compute(node, is_forward, node_indices);
+    entry.lru_position = lru_.begin();
+    return entry.dependents;
+  }
+
+ private:
+  // Walks the cone of 'node' which takes time proportional to the size of the
+  // cone rather than of the function.
+  DependencyIntervals Compute(
+      Node* node, bool is_forward,
+      const absl::flat_hash_map<Node*, int64_t>& node_indices) {
+    ++epoch_;
+    std::vector<int64_t> indices;
+    std::vector<Node*> worklist;
+    auto visit = [&](Node* n) {
+      int64_t index = node_indices.at(n);
+      if (visited_epoch_[index] != epoch_) {
+        visited_epoch_[index] = epoch_;
+        indices.push_back(index);
+        worklist.push_back(n);
+      }
+    };
+    visit(node);
+    while (!worklist.empty()) {
+      Node* n = worklist.back();
+      worklist.pop_back();
+      if (is_forward) {
+        absl::c_for_each(n->users(), visit);
+      } else {
+        absl::c_for_each(n->operands(), visit);
+      }
+    }
+    return DependencyIntervals(std::move(indices));
+  }
+
+  struct Entry {
+    DependencyIntervals dependents;
+    std::list<Node*>::iterator lru_position;
+  };
+
+  int64_t cache_size_;
+  // Most recently used first.
+  std::list<Node*> lru_;
+  absl::flat_hash_map<Node*, Entry> entries_;
+  // Scratch space for the cone walks: a node has been visited by the current
+  // walk if its entry equals 'epoch_'.
+  std::vector<int64_t> visited_epoch_;
+  int64_t epoch_ = 0;
+};
+
+NodeDependencyAnalysis::NodeDependencyAnalysis(
+    bool is_forwards, absl::flat_hash_map<Node*, int64_t> node_ids,
+    std::shared_ptr<LazyDependents> lazy)
+    : is_forward_(is_forwards),
+      node_indices_(std::move(node_ids)),
+      lazy_(std::move(lazy)) {}
+
+const DependencyIntervals& NodeDependencyAnalysis::GetLazyDependents(
+    Node* node) const {
+  return lazy_->Get(node, is_forward_, node_indices_);
+}
+
 absl::StatusOr<DependencyBitmap> NodeDependencyAnalysis::GetDependents(
     Node* node) const {
   if (!IsAnalyzed(node)) {
     return absl::InvalidArgumentError("Node is not analyzed");
   }
+  if (IsLazy()) {
+    return DependencyBitmap(
+        std::make_shared<const InlineBitmap>(
+            GetLazyDependents(node).ToBitmap(node_indices_.size())),
+        node_indices_);
+  }
   return DependencyBitmap(dependents_.at(node), node_indices_);
 }
 
+absl::StatusOr<DependencyIntervals>
+NodeDependencyAnalysis::GetDependentIntervals(Node* node) const {
+  if (!IsAnalyzed(node)) {
+    return absl::InvalidArgumentError("Node is not analyzed");
+  }
+  if (IsLazy()) {
+    return GetLazyDependents(node);
+  }
+  const InlineBitmap& bitmap = dependents_.at(node);
+  std::vector<int64_t> indices;
+  for (int64_t i = 0; i < bitmap.bit_count(); ++i) {
+    if (bitmap.Get(i)) {
+      indices.push_back(i);
+    }
+  }
+  return DependencyIntervals(std::move(indices));
+}
+
+absl::StatusOr<bool> NodeDependencyAnalysis::IsDependent(Node* from,
+                                                         Node* to) const {
+  if (IsLazy()) {
+    if (!IsAnalyzed(from)) {
+      return absl::InvalidArgumentError("Node is not analyzed");
+    }
+    if (!node_indices_.contains(to)) {
+      return absl::InvalidArgumentError("node is from a different function!");
+    }
+    return GetLazyDependents(from).Contains(node_indices_.at(to));
+  }
+  XLS_ASSIGN_OR_RETURN(auto bitmap, GetDependents(from));
+  return bitmap.IsDependent(to);
+}
+
 NodeDependencyAnalysis NodeDependencyAnalysis::BackwardDependents(
     FunctionBase* fb, absl::Span<Node* const> nodes) {
   absl::flat_hash_set<Node*> interesting(nodes.begin(), nodes.end());
@@ -109,4 +291,18 @@ NodeDependencyAnalysis NodeDependencyAnalysis::ForwardDependents(
   return NodeDependencyAnalysis(/*is_forwards=*/true, dependents, node_ids);
 }
 
+NodeDependencyAnalysis NodeDependencyAnalysis::LazyBackwardDependents(
+    FunctionBase* fb, int64_t cache_size) {
+  return NodeDependencyAnalysis(
+      /*is_forwards=*/false, TopologicalIndices(fb),
+      std::make_shared<LazyDependents>(fb->node_count(), cache_size));
+}
+
+NodeDependencyAnalysis NodeDependencyAnalysis::LazyForwardDependents(
+    FunctionBase* fb, int64_t cache_size) {
+  return NodeDependencyAnalysis(
+      /*is_forwards=*/true, TopologicalIndices(fb),
+      std::make_shared<LazyDependents>(fb->node_count(), cache_size));
+}
+
 }  // namespace xls
@@ -16,7 +16,9 @@
 #define XLS_PASSES_NODE_DEPENDENCY_ANALYSIS_H_
 
 #include <cstdint>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/container/flat_hash_map.h"
@@ -55,13 +57,55 @@ class DependencyBitmap {
                    const absl::flat_hash_map<Node*, int64_t>& node_indices
                        ABSL_ATTRIBUTE_LIFETIME_BOUND)
       : bitmap_(bitmap), node_indices_(node_indices) {}
+  // A bitmap which is materialized on request and owned by this object (and
+  // its copies) rather than by the analysis.
+  DependencyBitmap(std::shared_ptr<const InlineBitmap> bitmap,
+                   const absl::flat_hash_map<Node*, int64_t>& node_indices
+                       ABSL_ATTRIBUTE_LIFETIME_BOUND)
+      : owned_bitmap_(std::move(bitmap)),
+        bitmap_(*owned_bitmap_),
+        node_indices_(node_indices) {}
+  std::shared_ptr<const InlineBitmap> owned_bitmap_;
   const InlineBitmap& bitmap_;
   const absl::flat_hash_map<Node*, int64_t>& node_indices_;
   friend class NodeDependencyAnalysis;
 };
 
+// A set of node indices stored as sorted, disjoint, half-open intervals. When
+// nodes are indexed in topological order the dependency cone of a node in a
+// wide datapath is usually a handful of intervals rather than a bitmap over the
+// whole function.
+class DependencyIntervals {
+ public:
+  DependencyIntervals() = default;
+  // Builds the set from the given indices which need not be sorted or unique.
+  explicit DependencyIntervals(std::vector<int64_t> indices);
+
+  bool Contains(int64_t index) const;
+  // Returns the number of indices in the set.
+  int64_t size() const;
+  // Returns the set as a bitmap of `bit_count` bits.
+  InlineBitmap ToBitmap(int64_t bit_count) const;
+
+  // The [start, limit) intervals of the set in increasing order.
+  const std::vector<std::pair<int64_t, int64_t>>& intervals() const {
+    return intervals_;
+  }
+
+ private:
+  std::vector<std::pair<int64_t, int64_t>> intervals_;
+};
+
 // Analysis which lets us check whether different nodes are connected or over a
 // horizon from each other.
+//
+// The eager analyses compute a bitmap over all nodes for each node of interest
+// up front which takes O(N^2) bits when all nodes are of interest. The lazy
+// analyses instead compute the dependents of a node the first time they are
+// requested and keep at most a fixed number of them, evicting the least
+// recently used. Lazily computed dependents are stored as intervals over a
+// topological order of the nodes. The lazy analyses are not thread safe, even
+// for const access, and copies share a single cache.
 class NodeDependencyAnalysis {
  public:
   NodeDependencyAnalysis(NodeDependencyAnalysis&&) = default;
@@ -85,23 +129,43 @@ class NodeDependencyAnalysis {
   static NodeDependencyAnalysis BackwardDependents(
       FunctionBase* fb, absl::Span<Node* const> nodes = {});
 
+  static constexpr int64_t kDefaultLazyCacheSize = 1024;
+
+  // Analyze the forward dependents of every node of `fb`, computing them only
+  // when requested. At most `cache_size` results are kept at any time.
+  static NodeDependencyAnalysis LazyForwardDependents(
+      FunctionBase* fb, int64_t cache_size = kDefaultLazyCacheSize);
+
+  // Analyze the backward dependents of every node of `fb`, computing them only
+  // when requested. At most `cache_size` results are kept at any time.
+  static NodeDependencyAnalysis LazyBackwardDependents(
+      FunctionBase* fb, int64_t cache_size = kDefaultLazyCacheSize);
+
   // Returns if this is a forwards-dependency relationship. That is if
   // 'IsDependent(X, Y)' implies that a change in X could cause a change in Y.
   bool IsForward() const { return is_forward_; }
 
   // Returns if the dependents are analyzed for this node. If this returns false
   // other calls will return error.
-  bool IsAnalyzed(Node* node) const { return dependents_.contains(node); }
+  bool IsAnalyzed(Node* node) const {
+    return lazy_ != nullptr ? node_indices_.contains(node)
+                            : dependents_.contains(node);
+  }
+
+  // Returns if dependents are computed on request.
+  bool IsLazy() const { return lazy_ != nullptr; }
 
   // Get the bitmap for Node->GetId() -> bool for dependents of 'node'. Return
-  // is owned by the NodeDependencyAnalysis object.
+  // is owned by the NodeDependencyAnalysis object, or by the returned object
+  // itself for a lazy analysis.
   absl::StatusOr<DependencyBitmap> GetDependents(Node* node) const;
 
+  // Get the dependents of 'node' as intervals over node_indices(). This avoids
+  // materializing a bitmap for a lazy analysis.
+  absl::StatusOr<DependencyIntervals> GetDependentIntervals(Node* node) const;
+
   // Return if 'to' is a dependent of 'from'
-  absl::StatusOr<bool> IsDependent(Node* from, Node* to) const {
-    XLS_ASSIGN_OR_RETURN(auto bitmap, GetDependents(from));
-    return bitmap.IsDependent(to);
-  }
+  absl::StatusOr<bool> IsDependent(Node* from, Node* to) const;
   const absl::flat_hash_map<Node*, int64_t>& node_indices() const {
     return node_indices_;
   }
@@ -114,9 +178,19 @@ class NodeDependencyAnalysis {
         dependents_(std::move(dependents)),
         node_indices_(std::move(node_ids)) {}
 
+  class LazyDependents;
+  NodeDependencyAnalysis(bool is_forwards,
+                         absl::flat_hash_map<Node*, int64_t> node_ids,
+                         std::shared_ptr<LazyDependents> lazy);
+
+  // Returns the lazily computed dependents of 'node' which must be analyzed.
+  const DependencyIntervals& GetLazyDependents(Node* node) const;
+
   bool is_forward_;
   absl::flat_hash_map<Node*, InlineBitmap> dependents_;
   absl::flat_hash_map<Node*, int64_t> node_indices_;
+  // Only set for lazy analyses.
+  std::shared_ptr<LazyDependents> lazy_;
 };
 
 }  // namespace xls
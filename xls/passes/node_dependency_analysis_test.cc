@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <utility>
 
 #include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
@@ -28,7 +29,9 @@
 #include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/package.h"
 
 namespace xls {
@@ -295,6 +298,107 @@ TEST_F(NodeDependencyAnalysisTest, WorksWithNodeIdGaps) {
               testing::Not(absl_testing::IsOk()));
 }
 
+TEST_F(NodeDependencyAnalysisTest, LazyMatchesEager) {
+  // x -> a1 -> a2 -> finish
+  // x -> b1 -> b2 -> finish
+  // y -> b2
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue a1 = fb.Not(x);
+  BValue a2 = fb.Not(a1);
+  BValue b1 = fb.Not(x);
+  BValue b2 = fb.Add(b1, y);
+  fb.Add(a2, b2);
+  XLS_ASSERT_OK_AND_ASSIGN(auto* f, fb.Build());
+  NodeDependencyAnalysis forward = NodeDependencyAnalysis::ForwardDependents(f);
+  NodeDependencyAnalysis backward =
+      NodeDependencyAnalysis::BackwardDependents(f);
+  // A tiny cache so results are evicted and recomputed.
+  NodeDependencyAnalysis lazy_forward =
+      NodeDependencyAnalysis::LazyForwardDependents(f, /*cache_size=*/2);
+  NodeDependencyAnalysis lazy_backward =
+      NodeDependencyAnalysis::LazyBackwardDependents(f, /*cache_size=*/2);
+  EXPECT_TRUE(lazy_forward.IsLazy());
+  EXPECT_TRUE(lazy_forward.IsForward());
+  EXPECT_FALSE(lazy_backward.IsForward());
+  for (int64_t round = 0; round < 2; ++round) {
+    for (Node* from : f->nodes()) {
+      ASSERT_TRUE(lazy_forward.IsAnalyzed(from));
+      for (Node* to : f->nodes()) {
+        EXPECT_EQ(lazy_forward.IsDependent(from, to).value(),
+                  forward.IsDependent(from, to).value())
+            << from << " -> " << to;
+        EXPECT_EQ(lazy_backward.IsDependent(from, to).value(),
+                  backward.IsDependent(from, to).value())
+            << from << " -> " << to;
+      }
+    }
+  }
+  // Bitmaps returned by a lazy analysis outlive eviction of the result.
+  XLS_ASSERT_OK_AND_ASSIGN(DependencyBitmap x_users,
+                           lazy_forward.GetDependents(x.node()));
+  XLS_ASSERT_OK(lazy_forward.GetDependents(y.node()).status());
+  XLS_ASSERT_OK(lazy_forward.GetDependents(a1.node()).status());
+  XLS_ASSERT_OK(lazy_forward.GetDependents(b1.node()).status());
+  EXPECT_THAT(x_users.IsDependent(a2.node()), absl_testing::IsOkAndHolds(true));
+  EXPECT_THAT(x_users.IsDependent(y.node()), absl_testing::IsOkAndHolds(false));
+}
+
+TEST_F(NodeDependencyAnalysisTest, LazyCrossFunction) {
+  auto p = CreatePackage();
+  FunctionBuilder fb1(TestName() + "_first", p.get());
+  FunctionBuilder fb2(TestName() + "_second", p.get());
+  BValue x1 = fb1.Param("x", p->GetBitsType(8));
+  BValue x2 = fb2.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(auto* f1, fb1.Build());
+  XLS_ASSERT_OK(fb2.Build().status());
+  NodeDependencyAnalysis nda = NodeDependencyAnalysis::LazyForwardDependents(f1);
+  EXPECT_FALSE(nda.IsAnalyzed(x2.node()));
+  EXPECT_THAT(nda.GetDependents(x2.node()),
+              testing::Not(absl_testing::IsOk()));
+  EXPECT_THAT(nda.IsDependent(x1.node(), x2.node()),
+              testing::Not(absl_testing::IsOk()));
+  EXPECT_THAT(nda.IsDependent(x2.node(), x1.node()),
+              testing::Not(absl_testing::IsOk()));
+}
+
+TEST_F(NodeDependencyAnalysisTest, LazyChainIsSingleInterval) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue v = x;
+  for (int64_t i = 0; i < 100; ++i) {
+    v = fb.Not(v);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(auto* f, fb.Build());
+  NodeDependencyAnalysis nda = NodeDependencyAnalysis::LazyBackwardDependents(f);
+  XLS_ASSERT_OK_AND_ASSIGN(DependencyIntervals intervals,
+                           nda.GetDependentIntervals(v.node()));
+  EXPECT_EQ(intervals.intervals().size(), 1);
+  EXPECT_EQ(intervals.size(), 101);
+  XLS_ASSERT_OK_AND_ASSIGN(DependencyBitmap bitmap,
+                           nda.GetDependents(v.node()));
+  EXPECT_TRUE(bitmap.bitmap().IsAllOnes());
+}
+
+TEST(DependencyIntervalsTest, Basic) {
+  DependencyIntervals intervals({7, 3, 4, 5, 9, 3, 10, 0});
+  EXPECT_THAT(intervals.intervals(),
+              testing::ElementsAre(std::pair<int64_t, int64_t>{0, 1},
+                                   std::pair<int64_t, int64_t>{3, 6},
+                                   std::pair<int64_t, int64_t>{7, 8},
+                                   std::pair<int64_t, int64_t>{9, 11}));
+  EXPECT_EQ(intervals.size(), 7);
+  for (int64_t i = 0; i < 12; ++i) {
+    bool expected = i == 0 || (i >= 3 && i < 6) || i == 7 || i == 9 || i == 10;
+    EXPECT_EQ(intervals.Contains(i), expected) << i;
+    EXPECT_EQ(intervals.ToBitmap(12).Get(i), expected) << i;
+  }
+  EXPECT_FALSE(DependencyIntervals().Contains(0));
+}
+
 template <typename Iter>
 Node* NodeAt(Iter nodes, int64_t off) {
   return *std::next(nodes.begin(), off);
@@ -487,6 +591,20 @@ void BM_NDALadderBackwardMidOnly(benchmark::State& state) {
       },
       state);
 }
+// Queries the dependents of every node with a lazy analysis.
+void BM_NDADenseLazyBackwardAllNodes(benchmark::State& state) {
+  BM_NDADense(
+      [](FunctionBase* f) {
+        NodeDependencyAnalysis nda =
+            NodeDependencyAnalysis::LazyBackwardDependents(f);
+        int64_t count = 0;
+        for (Node* n : f->nodes()) {
+          count += nda.GetDependentIntervals(n)->size();
+        }
+        return count;
+      },
+      state);
+}
 
 BENCHMARK(BM_NDABinaryTreeForward)->DenseRange(2, 12, 2);
 BENCHMARK(BM_NDABinaryTreeBackward)->DenseRange(2, 12, 2);
@@ -506,6 +624,7 @@ BENCHMARK(BM_NDADenseForwardReturnOnly)->RangePair(2, 512, 3, 32);
 BENCHMARK(BM_NDADenseBackwardReturnOnly)->RangePair(2, 512, 3, 32);
 BENCHMARK(BM_NDADenseForwardMidOnly)->RangePair(2, 512, 3, 32);
 BENCHMARK(BM_NDADenseBackwardMidOnly)->RangePair(2, 512, 3, 32);
+BENCHMARK(BM_NDADenseLazyBackwardAllNodes)->RangePair(2, 512, 3, 32);
 
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,283 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/optimization_cache.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+// Bumped whenever the format of cache entries or keys changes, or when the
+// optimizer changes in a way which is not reflected in the pipeline
+// configuration.
+constexpr std::string_view kCacheFormatVersion = "xls-optimization-cache-v1";
+
+// Name of the function in the canonical packages used for keys and entries.
+constexpr std::string_view kCanonicalFunctionName = "leaf";
+
+// Returns a package holding only a clone of `f` with source locations removed.
+// Clones are numbered in a fixed order so the IR text of the package depends
+// only on the structure of `f`.
+absl::StatusOr<std::unique_ptr<Package>> CanonicalPackage(Function* f) {
+  auto package = std::make_unique<Package>(kCanonicalFunctionName);
+  XLS_ASSIGN_OR_RETURN(Function * clone,
+                       f->Clone(kCanonicalFunctionName, package.get()));
+  for (Node* node : clone->nodes()) {
+    node->SetLoc(SourceInfo());
+  }
+  XLS_RETURN_IF_ERROR(package->SetTop(clone));
+  return package;
+}
+
+std::string KeyForCanonicalPackage(Package* package,
+                                   std::string_view pipeline_config,
+                                   int64_t opt_level) {
+  std::string text =
+      absl::StrFormat("%s\n%s\nopt_level=%d\n%s", kCacheFormatVersion,
+                      pipeline_config, opt_level, package->DumpIr());
+  std::array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(text.data()), text.size(),
+         digest.data());
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest.data()), digest.size()));
+}
+
+// Replaces the body of `f` with a copy of the body of `replacement` which must
+// have the same signature.
+absl::Status ReplaceBody(Function* f, Function* replacement) {
+  std::vector<Node*> old_nodes;
+  for (Node* node : ReverseTopoSort(f)) {
+    if (!node->Is<Param>()) {
+      // Free up the names for the copied nodes.
+      node->ClearName();
+      old_nodes.push_back(node);
+    }
+  }
+
+  absl::flat_hash_map<Node*, Node*> node_map;
+  for (int64_t i = 0; i < f->params().size(); ++i) {
+    node_map[replacement->param(i)] = f->param(i);
+  }
+  for (Node* node : TopoSort(replacement)) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    std::vector<Node*> operands;
+    operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operands.push_back(node_map.at(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(node_map[node], node->CloneInNewFunction(operands, f));
+  }
+  XLS_RETURN_IF_ERROR(
+      f->set_return_value(node_map.at(replacement->return_value())));
+  for (Node* node : old_nodes) {
+    XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+  }
+  return absl::OkStatus();
+}
+
+// Returns the function held by the cached package `ir` if it is usable in
+// place of `f`.
+std::optional<std::unique_ptr<Package>> ParseEntry(std::string_view ir,
+                                                   Function* f) {
+  absl::StatusOr<std::unique_ptr<Package>> package = Parser::ParsePackage(ir);
+  if (!package.ok()) {
+    LOG(WARNING) << "Ignoring unparsable optimization cache entry: "
+                 << package.status();
+    return std::nullopt;
+  }
+  absl::StatusOr<Function*> cached = (*package)->GetTopAsFunction();
+  if (!cached.ok() ||
+      (*cached)->GetType()->ToString() != f->GetType()->ToString()) {
+    LOG(WARNING) << "Ignoring optimization cache entry with mismatched "
+                    "signature for "
+                 << f->name();
+    return std::nullopt;
+  }
+  return *std::move(package);
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<OptimizationCache>>
+OptimizationCache::Create(const std::filesystem::path& directory) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  return absl::WrapUnique(new OptimizationCache(directory));
+}
+
+/* static */ absl::StatusOr<std::string> OptimizationCache::ComputeKey(
+    Function* f, std::string_view pipeline_config, int64_t opt_level) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package, CanonicalPackage(f));
+  return KeyForCanonicalPackage(package.get(), pipeline_config, opt_level);
+}
+
+std::filesystem::path OptimizationCache::GetEntryPath(
+    std::string_view key) const {
+  return directory_ / absl::StrCat(key, ".ir");
+}
+
+std::optional<std::string> OptimizationCache::Lookup(std::string_view key) {
+  std::filesystem::path path = GetEntryPath(key);
+  absl::StatusOr<std::string> contents = GetFileContents(path);
+  RecordLookup(contents.ok());
+  if (!contents.ok()) {
+    VLOG(2) << absl::StreamFormat("Optimization cache miss: %s", path.string());
+    return std::nullopt;
+  }
+  VLOG(2) << absl::StreamFormat("Optimization cache hit: %s", path.string());
+  return *std::move(contents);
+}
+
+void OptimizationCache::Store(std::string_view key, std::string_view ir) {
+  // Write to a uniquely named temporary file and rename it into place so that
+  // concurrent readers never observe a partially written entry.
+  std::filesystem::path path = GetEntryPath(key);
+  static std::atomic<int64_t> temp_file_counter = 0;
+  std::filesystem::path temp_path =
+      directory_ / absl::StrFormat("%s.ir.tmp.%d.%d", key, getpid(),
+                                   temp_file_counter.fetch_add(1));
+  absl::Status status = SetFileContents(temp_path, ir);
+  if (status.ok()) {
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+      status = absl::InternalError(ec.message());
+    }
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to write optimization cache entry `%s`: %s", path.string(),
+        status.ToString());
+    std::error_code ec;
+    std::filesystem::remove(temp_path, ec);
+  }
+}
+
+void OptimizationCache::RecordLookup(bool hit) {
+  absl::MutexLock lock(&mutex_);
+  if (hit) {
+    ++hit_count_;
+  } else {
+    ++miss_count_;
+  }
+}
+
+int64_t OptimizationCache::hit_count() const {
+  absl::MutexLock lock(&mutex_);
+  return hit_count_;
+}
+
+int64_t OptimizationCache::miss_count() const {
+  absl::MutexLock lock(&mutex_);
+  return miss_count_;
+}
+
+bool IsCacheableLeafFunction(FunctionBase* f) {
+  if (!f->IsFunction() ||
+      f->AsFunctionOrDie()->ForeignFunctionData().has_value()) {
+    return false;
+  }
+  return absl::c_none_of(f->nodes(), [](Node* node) {
+    return node->Is<Invoke>() || node->Is<Map>() || node->Is<CountedFor>() ||
+           node->Is<DynamicCountedFor>();
+  });
+}
+
+absl::StatusOr<bool> OptimizeLeafFunctionsWithCache(
+    Package* p, const OptimizationPass& pipeline,
+    std::string_view pipeline_config, const OptimizationPassOptions& options,
+    OptimizationCache& cache) {
+  // Query engines are keyed by function base so must not be shared with the
+  // short-lived canonical packages. IR dumps, bisection and metrics apply to
+  // the optimization of the package as a whole.
+  OptimizationPassOptions leaf_options = options;
+  leaf_options.query_engine_manager = nullptr;
+  leaf_options.ir_dump_path.clear();
+  leaf_options.bisect_limit = std::nullopt;
+  leaf_options.record_metrics = false;
+
+  // Copy the functions as optimizing a leaf must not change the function list.
+  std::vector<Function*> functions;
+  for (const std::unique_ptr<Function>& f : p->functions()) {
+    if (IsCacheableLeafFunction(f.get())) {
+      functions.push_back(f.get());
+    }
+  }
+
+  bool changed = false;
+  for (Function* f : functions) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> canonical,
+                         CanonicalPackage(f));
+    std::string key = KeyForCanonicalPackage(canonical.get(), pipeline_config,
+                                             options.opt_level);
+    std::optional<std::unique_ptr<Package>> optimized;
+    if (std::optional<std::string> ir = cache.Lookup(key); ir.has_value()) {
+      optimized = ParseEntry(*ir, f);
+    }
+    if (!optimized.has_value()) {
+      VLOG(2) << absl::StreamFormat("Optimizing leaf function %s in isolation",
+                                    f->name());
+      PassResults results;
+      XLS_RETURN_IF_ERROR(
+          pipeline.Run(canonical.get(), leaf_options, &results).status());
+      cache.Store(key, canonical->DumpIr());
+      optimized = std::move(canonical);
+    }
+    XLS_ASSIGN_OR_RETURN(Function * replacement,
+                         (*optimized)->GetTopAsFunction());
+    XLS_RETURN_IF_ERROR(ReplaceBody(f, replacement));
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace xls
@@ -0,0 +1,109 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_OPTIMIZATION_CACHE_H_
+#define XLS_PASSES_OPTIMIZATION_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+
+namespace xls {
+
+// A content-addressed cache of optimized functions. Each entry maps a key
+// computed by `ComputeKey` from the unoptimized function and the optimization
+// configuration to the IR of the optimized function.
+//
+// By default entries are stored as files in a directory on disk. Entries are
+// written atomically so multiple processes may share a cache directory. Other
+// stores (e.g., a remote cache service) can be supported by overriding
+// `Lookup` and `Store`.
+class OptimizationCache {
+ public:
+  // Creates a cache which stores entries in `directory`. The directory is
+  // created if it does not exist.
+  static absl::StatusOr<std::unique_ptr<OptimizationCache>> Create(
+      const std::filesystem::path& directory);
+
+  virtual ~OptimizationCache() = default;
+
+  // Returns the cache key of `f` when optimized with the pipeline described by
+  // `pipeline_config` at the given optimization level. The key depends only on
+  // the structure of `f`: node ids and source locations are ignored so the
+  // same function has the same key in any package.
+  static absl::StatusOr<std::string> ComputeKey(Function* f,
+                                                std::string_view pipeline_config,
+                                                int64_t opt_level);
+
+  // Returns the IR of the package stored with the given key or std::nullopt if
+  // there is none.
+  virtual std::optional<std::string> Lookup(std::string_view key);
+
+  // Stores the IR of a package holding the optimized function under `key`.
+  // Failures are logged rather than returned as the cache is only an
+  // optimization.
+  virtual void Store(std::string_view key, std::string_view ir);
+
+  int64_t hit_count() const;
+  int64_t miss_count() const;
+
+ protected:
+  OptimizationCache() = default;
+
+  // Records the outcome of a lookup in the hit/miss counts.
+  void RecordLookup(bool hit);
+
+ private:
+  explicit OptimizationCache(const std::filesystem::path& directory)
+      : directory_(directory) {}
+
+  std::filesystem::path GetEntryPath(std::string_view key) const;
+
+  std::filesystem::path directory_;
+
+  mutable absl::Mutex mutex_;
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Returns true if `f` is a function whose optimized form depends only on the
+// function itself, i.e. it is not a foreign function and it calls no other
+// function (via invoke, map or a loop).
+bool IsCacheableLeafFunction(FunctionBase* f);
+
+// Replaces the body of each cacheable leaf function of `p` with its optimized
+// form. Cached results are used where available; otherwise the function is
+// optimized in isolation with `pipeline` and the result is added to the cache.
+// `pipeline_config` must uniquely describe `pipeline` and any option which
+// affects its result. The leaf functions' signatures are unchanged so callers
+// remain valid. Returns true if any function was changed.
+absl::StatusOr<bool> OptimizeLeafFunctionsWithCache(
+    Package* p, const OptimizationPass& pipeline,
+    std::string_view pipeline_config, const OptimizationPassOptions& options,
+    OptimizationCache& cache);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_OPTIMIZATION_CACHE_H_
@@ -0,0 +1,168 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/optimization_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/passes/dce_pass.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+// A pipeline which records how many times it has run.
+class CountingPass : public OptimizationPass {
+ public:
+  CountingPass() : OptimizationPass("counting", "Counting") {}
+
+  int64_t run_count() const { return run_count_; }
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override {
+    ++run_count_;
+    return DeadCodeEliminationPass().Run(p, options, results);
+  }
+
+ private:
+  mutable int64_t run_count_ = 0;
+};
+
+constexpr std::string_view kPackage = R"(
+package p
+
+fn leaf(x: bits[32]) -> bits[32] {
+  unused: bits[32] = neg(x)
+  ret add.2: bits[32] = add(x, x)
+}
+
+top fn caller(a: bits[32]) -> bits[32] {
+  ret invoke.3: bits[32] = invoke(a, to_apply=leaf)
+}
+)";
+
+class OptimizationCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+    temp_dir_ = std::make_unique<TempDirectory>(std::move(temp_dir));
+    XLS_ASSERT_OK_AND_ASSIGN(cache_,
+                             OptimizationCache::Create(temp_dir_->path()));
+  }
+
+  std::unique_ptr<TempDirectory> temp_dir_;
+  std::unique_ptr<OptimizationCache> cache_;
+};
+
+TEST_F(OptimizationCacheTest, KeyIgnoresNodeIds) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p1,
+                           Parser::ParsePackage(R"(
+package p1
+
+fn f(x: bits[8] id=1) -> bits[8] {
+  ret not.2: bits[8] = not(x, id=2)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p2,
+                           Parser::ParsePackage(R"(
+package p2
+
+fn f(x: bits[8] id=10) -> bits[8] {
+  ret not.20: bits[8] = not(x, id=20)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p3,
+                           Parser::ParsePackage(R"(
+package p3
+
+fn f(x: bits[8] id=1) -> bits[8] {
+  ret neg.2: bits[8] = neg(x, id=2)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, p1->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, p2->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f3, p3->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string k1,
+                           OptimizationCache::ComputeKey(f1, "config", 3));
+  EXPECT_THAT(OptimizationCache::ComputeKey(f2, "config", 3),
+              IsOkAndHolds(k1));
+  EXPECT_THAT(OptimizationCache::ComputeKey(f3, "config", 3),
+              IsOkAndHolds(testing::Ne(k1)));
+  EXPECT_THAT(OptimizationCache::ComputeKey(f1, "other", 3),
+              IsOkAndHolds(testing::Ne(k1)));
+  EXPECT_THAT(OptimizationCache::ComputeKey(f1, "config", 1),
+              IsOkAndHolds(testing::Ne(k1)));
+}
+
+TEST_F(OptimizationCacheTest, LeafFunctionsOptimizedAndCached) {
+  CountingPass pipeline;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kPackage));
+  EXPECT_THAT(OptimizeLeafFunctionsWithCache(p.get(), pipeline, "config",
+                                             OptimizationPassOptions(), *cache_),
+              IsOkAndHolds(true));
+  EXPECT_EQ(pipeline.run_count(), 1);
+  EXPECT_EQ(cache_->miss_count(), 1);
+  EXPECT_EQ(cache_->hit_count(), 0);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * leaf, p->GetFunction("leaf"));
+  EXPECT_EQ(leaf->node_count(), 2);
+  EXPECT_THAT(leaf->return_value(), m::Add(m::Param("x"), m::Param("x")));
+
+  // The same function in another package is taken from the cache.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p2,
+                           Parser::ParsePackage(kPackage));
+  EXPECT_THAT(OptimizeLeafFunctionsWithCache(p2.get(), pipeline, "config",
+                                             OptimizationPassOptions(), *cache_),
+              IsOkAndHolds(true));
+  EXPECT_EQ(pipeline.run_count(), 1);
+  EXPECT_EQ(cache_->hit_count(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * leaf2, p2->GetFunction("leaf"));
+  EXPECT_EQ(leaf2->node_count(), 2);
+  EXPECT_THAT(leaf2->return_value(), m::Add(m::Param("x"), m::Param("x")));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * caller, p2->GetFunction("caller"));
+  EXPECT_THAT(caller->return_value(), m::Invoke(m::Param("a")));
+}
+
+TEST_F(OptimizationCacheTest, CallersAreNotCached) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * leaf, p->GetFunction("leaf"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * caller, p->GetFunction("caller"));
+  EXPECT_TRUE(IsCacheableLeafFunction(leaf));
+  EXPECT_FALSE(IsCacheableLeafFunction(caller));
+}
+
+}  // namespace
+}  // namespace xls
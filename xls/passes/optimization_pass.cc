@@ -14,6 +14,7 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <iterator>
@@ -37,6 +38,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/pass_metrics.pb.h"
 
 namespace xls {
 
@@ -95,12 +97,50 @@ absl::StatusOr<RamKind> RamKindFromProto(RamKindProto proto) {
   };
 }
 
+std::string_view RamBankingKindToString(RamBankingKind kind) {
+  switch (kind) {
+    case RamBankingKind::kCyclic:
+      return "cyclic";
+    case RamBankingKind::kBlock:
+      return "block";
+  }
+}
+
+absl::StatusOr<RamBankingKind> RamBankingKindFromProto(
+    RamBankingKindProto proto) {
+  switch (proto) {
+    case RamBankingKindProto::RAM_BANKING_CYCLIC:
+      return RamBankingKind::kCyclic;
+    case RamBankingKindProto::RAM_BANKING_BLOCK:
+      return RamBankingKind::kBlock;
+    default:
+      return absl::InvalidArgumentError("Invalid RamBankingKind");
+  }
+}
+
+/* static */ absl::StatusOr<RamBanking> RamBanking::FromProto(
+    const RamBankingProto& proto) {
+  XLS_ASSIGN_OR_RETURN(RamBankingKind kind,
+                       RamBankingKindFromProto(proto.kind()));
+  if (proto.bank_count() < 1 ||
+      !IsPowerOfTwo(static_cast<uint64_t>(proto.bank_count()))) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "RAM bank count must be a positive power of two, got %d",
+        proto.bank_count()));
+  }
+  return RamBanking{.kind = kind, .bank_count = proto.bank_count()};
+}
+
 /* static */ absl::StatusOr<RamRewrite> RamRewrite::FromProto(
     const RamRewriteProto& proto) {
   XLS_ASSIGN_OR_RETURN(RamConfig from_config,
                        RamConfig::FromProto(proto.from_config()));
   XLS_ASSIGN_OR_RETURN(RamConfig to_config,
                        RamConfig::FromProto(proto.to_config()));
+  std::optional<RamBanking> banking;
+  if (proto.has_banking()) {
+    XLS_ASSIGN_OR_RETURN(banking, RamBanking::FromProto(proto.banking()));
+  }
   return RamRewrite{
       .from_config = from_config,
       .from_channels_logical_to_physical =
@@ -112,6 +152,7 @@ absl::StatusOr<RamKind> RamKindFromProto(RamKindProto proto) {
       .proc_name = proto.has_proc_name()
                        ? std::optional<std::string>(proto.proc_name())
                        : std::nullopt,
+      .banking = banking,
   };
 }
 
@@ -127,6 +168,42 @@ absl::StatusOr<std::vector<RamRewrite>> RamRewritesFromProto(
   return rewrites;
 }
 
+int64_t PackageNodeCount(Package* p) {
+  int64_t count = 0;
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    count += f->node_count();
+  }
+  return count;
+}
+
+bool FitsNodeBudget(std::string_view pass_name, Node* node, int64_t growth,
+                    const OptimizationPassOptions& options,
+                    PassResults* results) {
+  if (!options.node_budget.has_value()) {
+    return true;
+  }
+  int64_t node_count = PackageNodeCount(node->package());
+  if (node_count + growth <= *options.node_budget) {
+    return true;
+  }
+  VLOG(1) << absl::StreamFormat(
+      "%s: deferring expansion of %s (%d nodes + %d > budget of %d)",
+      pass_name, node->GetName(), node_count, growth, *options.node_budget);
+  NodeBudgetEventProto& event = results->node_budget_events.emplace_back();
+  event.set_pass_name(std::string(pass_name));
+  event.set_function_base(node->function_base()->name());
+  event.set_node(node->GetName());
+  event.set_node_count(node_count);
+  event.set_estimated_growth(growth);
+  event.set_node_budget(*options.node_budget);
+  return false;
+}
+
+bool NearNodeBudget(Package* p, const OptimizationPassOptions& options) {
+  return options.node_budget.has_value() &&
+         PackageNodeCount(p) * 4 >= *options.node_budget * 3;
+}
+
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
@@ -147,13 +224,41 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
-  bool changed = false;
-  for (FunctionBase* f : p->GetFunctionBases()) {
-    XLS_ASSIGN_OR_RETURN(bool function_changed,
-                         RunOnFunctionBaseInternal(f, options, results));
-    changed = changed || function_changed;
+  // Whether a pass changes a function base then depends on the rest of the
+  // package.
+  bool budgeted = options.node_budget.has_value() && UsesNodeBudget();
+  // The session is thread-local so read it here rather than in the workers.
+  std::optional<int64_t> session =
+      budgeted || !SkipsUnchangedFunctionBases() ? std::nullopt
+                                                 : FixedPointSession::Current();
+  std::atomic<bool> changed = false;
+  XLS_RETURN_IF_ERROR(p->ForEachFunctionBaseConcurrently(
+      p->GetFunctionBases(), budgeted ? 1 : options.function_base_parallelism,
+      [&](FunctionBase* f) -> absl::Status {
+        if (session.has_value() && f->IsUnchangedBy(this, *session)) {
+          VLOG(3) << absl::StreamFormat(
+              "Skipping %s on unchanged function_base %s", short_name(),
+              f->name());
+          return absl::OkStatus();
+        }
+        p->transform_metrics().nodes_visited += f->node_count();
+        XLS_ASSIGN_OR_RETURN(bool function_changed,
+                             RunOnFunctionBaseInternal(f, options, results));
+        if (function_changed) {
+          // Passes may report changes which are not tracked by the function
+          // base (e.g. to nodes' attributes) so count them explicitly.
+          f->IncrementModificationCount();
+          changed = true;
+        } else if (session.has_value()) {
+          f->RecordUnchangedBy(this, *session);
+        }
+        return absl::OkStatus();
+      }));
+  if (options.query_engine_manager != nullptr) {
+    // Drop the engines of function bases which have been removed.
+    options.query_engine_manager->Prune(p->GetFunctionBases());
   }
-  return changed;
+  return changed.load();
 }
 
 absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
@@ -213,8 +318,12 @@ absl::StatusOr<bool> OptimizationProcPass::RunInternal(
     PassResults* results) const {
   bool changed = false;
   for (const auto& proc : p->procs()) {
+    p->transform_metrics().nodes_visited += proc->node_count();
     XLS_ASSIGN_OR_RETURN(bool proc_changed,
                          RunOnProcInternal(proc.get(), options, results));
+    if (proc_changed) {
+      proc->IncrementModificationCount();
+    }
     changed = changed || proc_changed;
   }
   return changed;
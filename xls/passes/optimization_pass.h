@@ -40,6 +40,8 @@
 #include "xls/passes/pass_base.h"
 #include "xls/passes/pass_registry.h"
 #include "xls/passes/pipeline_generator.h"
+#include "xls/passes/query_engine_manager.h"
+#include "xls/passes/rewrite_cost_model.h"
 
 namespace xls {
 
@@ -78,6 +80,30 @@ struct RamConfig {
   static absl::StatusOr<RamConfig> FromProto(const RamConfigProto& proto);
 };
 
+// How the addresses of a banked RAM are distributed over its banks.
+enum class RamBankingKind {
+  // Consecutive addresses map to consecutive banks: the low address bits
+  // select the bank.
+  kCyclic,
+  // Each bank holds a contiguous block of addresses: the high address bits
+  // select the bank.
+  kBlock,
+};
+
+std::string_view RamBankingKindToString(RamBankingKind kind);
+absl::StatusOr<RamBankingKind> RamBankingKindFromProto(
+    RamBankingKindProto proto);
+
+// Configuration for splitting one logical RAM into several physical RAMs
+// ("banks") which can be accessed concurrently.
+struct RamBanking {
+  RamBankingKind kind;
+  // Must be a power of two.
+  int64_t bank_count;
+
+  static absl::StatusOr<RamBanking> FromProto(const RamBankingProto& proto);
+};
+
 // A configuration describing a desired RAM rewrite.
 struct RamRewrite {
   // Configuration of RAM we start with.
@@ -95,6 +121,10 @@ struct RamRewrite {
   // defined in.
   std::optional<std::string> proc_name;
 
+  // If set, the "from" RAM is split into `banking->bank_count` RAMs, each with
+  // config `to_config` and named `<to_name_prefix>_bank<i>`.
+  std::optional<RamBanking> banking = std::nullopt;
+
   static absl::StatusOr<RamRewrite> FromProto(const RamRewriteProto& proto);
 };
 
@@ -156,8 +186,61 @@ struct OptimizationPassOptions : public PassOptionsBase {
 
   // Use select context during narrowing range analysis.
   bool use_context_narrowing_analysis = false;
+
+  // Number of threads on which function-base passes transform the function
+  // bases of the package concurrently. The resulting IR is the same for any
+  // value greater than one, and differs from a serial run only in the ids of
+  // new nodes. See Package::ForEachFunctionBaseConcurrently.
+  int64_t function_base_parallelism = 1;
+
+  // If set, passes which expand the IR (loop unrolling, map inlining and
+  // function inlining) defer any expansion which would grow the package beyond
+  // this many nodes, and cleanup passes run between them once the package
+  // nears the budget. Deferred expansions are reported in
+  // PassResults::node_budget_events and remain in the IR.
+  std::optional<int64_t> node_budget = std::nullopt;
+
+  // If set, counted loops in procs with more than this many iterations are
+  // moved into a separate proc which executes this many iterations per
+  // activation rather than being unrolled. See LoopProcConversionPass.
+  std::optional<int64_t> loop_iterations_per_activation = std::nullopt;
+
+  // If set, ResourceSharingPass folds expensive operations in mutually
+  // exclusive select arms into a single operation. Off by default: the pass
+  // reruns whole-function analyses each round and its delay guard only
+  // approximates the delay model used for scheduling.
+  bool resource_sharing = false;
+
+  // If set, the verifier invariant checker re-verifies only the parts of the
+  // package changed by each pass rather than the whole package. The whole
+  // package is still verified at the start of the pipeline.
+  bool incremental_verification = false;
+
+  // If set, passes share populated query engines through this manager rather
+  // than each populating their own. Not owned.
+  QueryEngineManager* query_engine_manager = nullptr;
+
+  // If set, passes which make profitability decisions (e.g. table switch
+  // conversion and select lifting) reject rewrites which this model estimates
+  // would increase area or critical-path delay. Not owned.
+  const RewriteCostModel* cost_model = nullptr;
 };
 
+// Returns the number of nodes in all function bases of `p`.
+int64_t PackageNodeCount(Package* p);
+
+// Returns true if there is no node budget in `options` or if growing the
+// package containing `node` by `growth` nodes keeps it within the budget.
+// Otherwise records in `results` that the pass `pass_name` deferred expanding
+// `node` and returns false.
+bool FitsNodeBudget(std::string_view pass_name, Node* node, int64_t growth,
+                    const OptimizationPassOptions& options,
+                    PassResults* results);
+
+// Returns true if the package uses at least three quarters of the node budget
+// in `options`.
+bool NearNodeBudget(Package* p, const OptimizationPassOptions& options);
+
 // An object containing information about the invocation of a pass (single call
 // to PassBase::Run).
 // Defines the pass types for optimizations which operate strictly on XLS IR
@@ -332,7 +415,16 @@ class OptimizationFunctionBasePass : public OptimizationPass {
 
  protected:
   // Iterates over each function and proc in the package calling
-  // RunOnFunctionBase.
+  // RunOnFunctionBase. If options.function_base_parallelism is greater than
+  // one (and the pass does not use the node budget) the function bases are
+  // transformed concurrently, so
+  // RunOnFunctionBaseInternal must only modify the function base it is
+  // given and must not modify `results`.
+  //
+  // Within a run of a fixed-point compound pass (see FixedPointSession),
+  // passes which opt in through SkipsUnchangedFunctionBases skip function
+  // bases which they left unchanged in an earlier iteration and which have not
+  // been modified since.
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
                                    PassResults* results) const override;
@@ -341,6 +433,20 @@ class OptimizationFunctionBasePass : public OptimizationPass {
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const = 0;
 
+  // Returns true if the pass consults the node budget of the package (see
+  // OptimizationPassOptions::node_budget). When a budget is set such passes
+  // depend on the whole package, so the function bases are transformed one at
+  // a time and never skipped as unchanged, and RunOnFunctionBaseInternal may
+  // record budget events in `results`.
+  virtual bool UsesNodeBudget() const { return false; }
+
+  // Returns true if the pass may be skipped on function bases it left
+  // unchanged earlier in the same fixed-point run (see RunInternal). Only
+  // passes whose RunOnFunctionBaseInternal depends solely on the function base
+  // it is given and the options may return true; passes which consult other
+  // function bases (e.g., by inlining their callees) must not.
+  virtual bool SkipsUnchangedFunctionBases() const { return false; }
+
   // Calls the given function for every node in the graph in a loop until no
   // further simplifications are possible.  simplify_f should return true if the
   // IR was modified. simplify_f can add or remove nodes including the node
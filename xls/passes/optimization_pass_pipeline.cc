@@ -29,6 +29,7 @@
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/package.h"
@@ -50,9 +51,12 @@
 #include "xls/passes/dataflow_simplification_pass.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/dfe_pass.h"
+#include "xls/passes/function_deduplication_pass.h"
 #include "xls/passes/identity_removal_pass.h"
 #include "xls/passes/inlining_pass.h"
+#include "xls/passes/interprocedural_constant_propagation_pass.h"
 #include "xls/passes/label_recovery_pass.h"
+#include "xls/passes/loop_proc_conversion_pass.h"
 #include "xls/passes/lut_conversion_pass.h"
 #include "xls/passes/map_inlining_pass.h"
 #include "xls/passes/narrowing_pass.h"
@@ -67,10 +71,12 @@
 #include "xls/passes/proc_state_narrowing_pass.h"
 #include "xls/passes/proc_state_optimization_pass.h"
 #include "xls/passes/proc_state_provenance_narrowing_pass.h"
+#include "xls/passes/proc_state_sharing_pass.h"
 #include "xls/passes/proc_state_tuple_flattening_pass.h"
 #include "xls/passes/ram_rewrite_pass.h"
 #include "xls/passes/reassociation_pass.h"
 #include "xls/passes/receive_default_value_simplification_pass.h"
+#include "xls/passes/resource_sharing_pass.h"
 #include "xls/passes/select_lifting_pass.h"
 #include "xls/passes/select_simplification_pass.h"
 #include "xls/passes/sparsify_select_pass.h"
@@ -159,6 +165,13 @@ PreInliningPassGroup::PreInliningPassGroup()
   Add<DeadCodeEliminationPass>();
   // TODO: google/xls#1795 - Remove once full transition to next-op is complete.
   Add<NextNodeModernizePass>();
+  // Specialize callees for constant arguments so the simplification passes can
+  // exploit the constants before everything is inlined.
+  Add<IfOptLevelAtLeast<1, InterproceduralConstantPropagationPass>>();
+  // Merge functions with identical bodies, e.g. parametric instantiations
+  // which only differ in name, so each body is only simplified once.
+  Add<IfOptLevelAtLeast<1, FunctionDeduplicationPass>>();
+  Add<DeadFunctionEliminationPass>();
   // At this stage in the pipeline only optimizations up to level 2 should
   // run. 'opt_level' is the maximum level of optimization which should be run
   // in the entire pipeline so set the level of the simplification pass to the
@@ -167,11 +180,44 @@ PreInliningPassGroup::PreInliningPassGroup()
   Add<IfOptLevelAtLeast<1, Inner>>();
 }
 
+NodeBudgetCleanupPass::NodeBudgetCleanupPass()
+    : OptimizationCompoundPass(NodeBudgetCleanupPass::kName,
+                               "Cleanup when near the node budget") {
+  Add<DeadCodeEliminationPass>();
+  Add<CsePass>();
+  Add<ConstantFoldingPass>();
+  Add<DeadCodeEliminationPass>();
+}
+
+absl::StatusOr<PassPipelineProto::Element> NodeBudgetCleanupPass::ToProto()
+    const {
+  PassPipelineProto::Element e;
+  *e.mutable_pass_name() = kName;
+  return e;
+}
+
+absl::StatusOr<CompoundPassResult> NodeBudgetCleanupPass::RunNested(
+    Package* p, const OptimizationPassOptions& options, PassResults* results,
+    std::string_view top_level_name,
+    absl::Span<const OptimizationInvariantChecker* const> invariant_checkers)
+    const {
+  if (!NearNodeBudget(p, options)) {
+    return CompoundPassResult();
+  }
+  return OptimizationCompoundPass::RunNested(p, options, results,
+                                             top_level_name, invariant_checkers);
+}
+
 UnrollingAndInliningPassGroup::UnrollingAndInliningPassGroup()
     : OptimizationCompoundPass(UnrollingAndInliningPassGroup::kName,
                                "full function inlining passes") {
-  Add<UnrollPass>();
-  Add<MapInliningPass>();
+  // Under a node budget the expansions which don't fit are deferred. Cleaning
+  // up in between leaves more room for the later ones.
+  Add<LoopProcConversionPass>();
+  Add<UnrollPass>(/*fold_iterations=*/true);
+  Add<NodeBudgetCleanupPass>();
+  Add<MapInliningPass>(/*fold_invocations=*/true);
+  Add<NodeBudgetCleanupPass>();
   Add<InliningPass>();
   Add<DeadFunctionEliminationPass>();
 }
@@ -251,12 +297,23 @@ class PostInliningOptPassGroup : public OptimizationCompoundPass {
     Add<ProcStateOptimizationPass>();
     Add<DeadCodeEliminationPass>();
 
+    // Fold state elements with disjoint lifetimes into shared storage once the
+    // state has been narrowed as far as possible.
+    Add<ProcStateSharingPass>();
+    Add<DeadCodeEliminationPass>();
+
     Add<CapOptLevel<3, BddSimplificationPass>>();
     Add<DeadCodeEliminationPass>();
     Add<BddCsePass>();
     Add<SelectLiftingPass>();
     Add<DeadCodeEliminationPass>();
 
+    // Fold expensive operations in exclusive select arms together once the
+    // selects have been simplified. Only runs if resource sharing is enabled
+    // in the options.
+    Add<ResourceSharingPass>();
+    Add<DeadCodeEliminationPass>();
+
     Add<LutConversionPass>();
     Add<DeadCodeEliminationPass>();
 
@@ -382,6 +439,7 @@ XLS_REGISTER_MODULE_INITIALIZER(simp_pass, {
 });
 
 REGISTER_OPT_PASS(PreInliningPassGroup);
+REGISTER_OPT_PASS(NodeBudgetCleanupPass);
 REGISTER_OPT_PASS(UnrollingAndInliningPassGroup);
 REGISTER_OPT_PASS(ProcStateFlatteningFixedPointPass);
 REGISTER_OPT_PASS(PostInliningPassGroup);
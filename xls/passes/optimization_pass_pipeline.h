@@ -23,8 +23,10 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 #include "xls/passes/pass_pipeline.pb.h"
 
 namespace xls {
@@ -47,6 +49,24 @@ class PreInliningPassGroup : public OptimizationCompoundPass {
   explicit PreInliningPassGroup();
 };
 
+// Cleanup passes which only run once the package uses most of its node budget
+// (see OptimizationPassOptions::node_budget). Run between the expansion passes
+// to make room for later expansions.
+class NodeBudgetCleanupPass : public OptimizationCompoundPass {
+ public:
+  static constexpr std::string_view kName = "node_budget_cleanup";
+  explicit NodeBudgetCleanupPass();
+
+  absl::StatusOr<PassPipelineProto::Element> ToProto() const override;
+
+ protected:
+  absl::StatusOr<CompoundPassResult> RunNested(
+      Package* p, const OptimizationPassOptions& options, PassResults* results,
+      std::string_view top_level_name,
+      absl::Span<const OptimizationInvariantChecker* const> invariant_checkers)
+      const override;
+};
+
 // The passes which perform full function inlining.
 //
 // NB Proc-inlining is not performed by this group and is performed in the
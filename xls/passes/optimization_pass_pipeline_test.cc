@@ -22,9 +22,11 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
@@ -35,6 +37,7 @@
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -276,5 +279,67 @@ TEST_F(OptimizationPipelineTest, LogicCombining) {
   EXPECT_THAT(f->return_value(), m::Param("x"));
 }
 
+TEST_F(OptimizationPipelineTest, FunctionBaseParallelismIsDeterministic) {
+  // The callees are optimized concurrently before they are inlined.
+  constexpr std::string_view kIr = R"(
+package p
+
+fn f0(x: bits[8], y: bits[8]) -> bits[8] {
+  add.1: bits[8] = add(x, y)
+  neg.2: bits[8] = neg(add.1)
+  ret neg.3: bits[8] = neg(neg.2)
+}
+
+fn f1(x: bits[8], y: bits[8]) -> bits[8] {
+  literal.4: bits[8] = literal(value=3)
+  umul.5: bits[8] = umul(x, literal.4)
+  ret sub.6: bits[8] = sub(umul.5, y)
+}
+
+fn f2(x: bits[8], y: bits[8]) -> bits[8] {
+  concat.7: bits[16] = concat(x, y)
+  bit_slice.8: bits[8] = bit_slice(concat.7, start=4, width=8)
+  ret xor.9: bits[8] = xor(bit_slice.8, x)
+}
+
+fn f3(x: bits[8], y: bits[8]) -> bits[8] {
+  ult.10: bits[1] = ult(x, y)
+  ret sel.11: bits[8] = sel(ult.10, cases=[x, y])
+}
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  invoke.12: bits[8] = invoke(x, y, to_apply=f0)
+  invoke.13: bits[8] = invoke(invoke.12, y, to_apply=f1)
+  invoke.14: bits[8] = invoke(invoke.13, x, to_apply=f2)
+  ret invoke.15: bits[8] = invoke(invoke.14, y, to_apply=f3)
+}
+)";
+  auto optimize = [&](int64_t parallelism)
+      -> absl::StatusOr<std::unique_ptr<Package>> {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p, ParsePackage(kIr));
+    OptimizationPassOptions options;
+    options.function_base_parallelism = parallelism;
+    PassResults results;
+    XLS_RETURN_IF_ERROR(
+        CreateOptimizationPassPipeline()->Run(p.get(), options, &results)
+            .status());
+    return p;
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> serial, optimize(1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> concurrent, optimize(2));
+  // Concurrent runs give new nodes different ids than a serial run, but the
+  // same graph.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * serial_main,
+                           serial->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * concurrent_main,
+                           concurrent->GetFunction("main"));
+  EXPECT_EQ(concurrent_main->node_count(), serial_main->node_count());
+  for (int64_t parallelism : {4, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, optimize(parallelism));
+    EXPECT_EQ(p->DumpIr(), concurrent->DumpIr())
+        << "parallelism=" << parallelism;
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -24,6 +24,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
@@ -35,6 +36,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
@@ -51,6 +53,8 @@ using ::absl_testing::StatusIs;
 using ::testing::Contains;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
 
 class DummyPass : public OptimizationPass {
  public:
@@ -505,6 +509,108 @@ TEST(PassesTest, TestTransformNodesToFixedPointWhileRemovingNodes) {
       IsOkAndHolds(false));
 }
 
+// Counts the number of times it runs on each function base. Never changes the
+// IR.
+class CountingPass : public OptimizationFunctionBasePass {
+ public:
+  explicit CountingPass(bool skips_unchanged = true)
+      : OptimizationFunctionBasePass("counting", "Counting"),
+        skips_unchanged_(skips_unchanged) {}
+
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    ++run_counts_[f->name()];
+    return false;
+  }
+
+  bool SkipsUnchangedFunctionBases() const override { return skips_unchanged_; }
+
+  const absl::flat_hash_map<std::string, int64_t>& run_counts() const {
+    return run_counts_;
+  }
+
+ private:
+  bool skips_unchanged_;
+  mutable absl::flat_hash_map<std::string, int64_t> run_counts_;
+};
+
+// Renames the return value of the function `target` the first time it runs on
+// it.
+class RenamingPass : public OptimizationFunctionBasePass {
+ public:
+  explicit RenamingPass(std::string_view target)
+      : OptimizationFunctionBasePass("renaming", "Renaming"), target_(target) {}
+
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    if (f->name() != target_ || renamed_) {
+      return false;
+    }
+    f->AsFunctionOrDie()->return_value()->SetName("renamed");
+    renamed_ = true;
+    return true;
+  }
+
+ private:
+  std::string target_;
+  mutable bool renamed_ = false;
+};
+
+TEST(PassesTest, FixedPointSkipsUnchangedFunctionBases) {
+  auto p = std::make_unique<Package>("p");
+  for (std::string_view name : {"a", "b"}) {
+    FunctionBuilder fb(name, p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Not(x)).status());
+  }
+
+  OptimizationFixedPointCompoundPass fixed_point("fixed_point", "Fixed point");
+  CountingPass* counting = fixed_point.Add<CountingPass>();
+  fixed_point.Add<RenamingPass>("a");
+  PassResults results;
+  ASSERT_THAT(fixed_point.Run(p.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  // The second iteration only reruns the counting pass on `a` which was
+  // modified in the first iteration.
+  EXPECT_THAT(counting->run_counts(),
+              UnorderedElementsAre(Pair("a", 2), Pair("b", 1)));
+
+  // A new run of the fixed-point pass does not reuse the earlier results.
+  ASSERT_THAT(fixed_point.Run(p.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(false));
+  EXPECT_THAT(counting->run_counts(),
+              UnorderedElementsAre(Pair("a", 3), Pair("b", 2)));
+
+  // Outside of a fixed-point pass nothing is skipped.
+  ASSERT_THAT(counting->Run(p.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(false));
+  ASSERT_THAT(counting->Run(p.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(false));
+  EXPECT_THAT(counting->run_counts(),
+              UnorderedElementsAre(Pair("a", 5), Pair("b", 4)));
+}
+
+TEST(PassesTest, FixedPointRerunsPassesWhichDoNotSkipUnchanged) {
+  auto p = std::make_unique<Package>("p");
+  for (std::string_view name : {"a", "b"}) {
+    FunctionBuilder fb(name, p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Not(x)).status());
+  }
+
+  OptimizationFixedPointCompoundPass fixed_point("fixed_point", "Fixed point");
+  CountingPass* counting =
+      fixed_point.Add<CountingPass>(/*skips_unchanged=*/false);
+  fixed_point.Add<RenamingPass>("a");
+  PassResults results;
+  ASSERT_THAT(fixed_point.Run(p.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  EXPECT_THAT(counting->run_counts(),
+              UnorderedElementsAre(Pair("a", 2), Pair("b", 2)));
+}
+
 TEST(RamDatastructuresTest, AddrWidthCorrect) {
   RamConfig config{.kind = RamKind::kAbstract, .depth = 2};
   EXPECT_EQ(config.addr_width(), 1);
@@ -602,6 +708,28 @@ TEST(RamDatastructuresTest, RamRewriteProtoTest) {
   EXPECT_EQ(RamRewrite::FromProto(proto)->to_name_prefix, "ram");
 }
 
+TEST(RamDatastructuresTest, RamRewriteWithBankingProtoTest) {
+  RamRewriteProto proto;
+  proto.mutable_from_config()->set_kind(RamKindProto::RAM_ABSTRACT);
+  proto.mutable_from_config()->set_depth(1024);
+  proto.mutable_to_config()->set_kind(RamKindProto::RAM_1RW);
+  proto.mutable_to_config()->set_depth(256);
+  proto.set_to_name_prefix("ram");
+  EXPECT_EQ(RamRewrite::FromProto(proto)->banking, std::nullopt);
+
+  proto.mutable_banking()->set_kind(RamBankingKindProto::RAM_BANKING_BLOCK);
+  proto.mutable_banking()->set_bank_count(4);
+  XLS_ASSERT_OK_AND_ASSIGN(RamRewrite rewrite, RamRewrite::FromProto(proto));
+  ASSERT_TRUE(rewrite.banking.has_value());
+  EXPECT_EQ(rewrite.banking->kind, RamBankingKind::kBlock);
+  EXPECT_EQ(rewrite.banking->bank_count, 4);
+
+  proto.mutable_banking()->set_bank_count(3);
+  EXPECT_THAT(RamRewrite::FromProto(proto),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("positive power of two")));
+}
+
 TEST(RamDatastructuresTest, RamRewritesProtoTest) {
   RamRewritesProto proto;
   RamRewriteProto rewrite_proto;
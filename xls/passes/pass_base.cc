@@ -14,6 +14,8 @@
 
 #include "xls/passes/pass_base.h"
 
+#include <sys/resource.h>
+
 #include <algorithm>
 #include <cstdint>
 #include <string>
@@ -28,6 +30,30 @@
 
 namespace xls {
 
+namespace internal {
+
+int64_t PeakRssBytes() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  // ru_maxrss is in bytes on macOS and kilobytes elsewhere.
+  return usage.ru_maxrss;
+#else
+  return int64_t{usage.ru_maxrss} * 1024;
+#endif
+}
+
+void SetDurationProto(absl::Duration duration,
+                      google::protobuf::Duration* proto) {
+  absl::Duration rem;
+  proto->set_seconds(absl::IDivDuration(duration, absl::Seconds(1), &rem));
+  proto->set_nanos(absl::IDivDuration(rem, absl::Nanoseconds(1), &rem));
+}
+
+}  // namespace internal
+
 void CompoundPassResult::AddSinglePassResult(std::string_view pass_name,
                                              bool changed,
                                              absl::Duration duration,
@@ -16,6 +16,7 @@
 #define XLS_PASSES_PASS_BASE_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iterator>
@@ -23,9 +24,11 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "google/protobuf/duration.pb.h"
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
@@ -42,6 +45,7 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/passes/pass_metrics.pb.h"
 #include "xls/passes/pass_pipeline.pb.h"
@@ -138,8 +142,46 @@ struct PassResults {
 
   // The aggregate results of all actual invocations performed.
   CompoundPassResult aggregate_results;
+
+  // Profiles of the invocations of passes and compound passes in the order
+  // they completed. Only recorded if PassOptionsBase::record_metrics is set.
+  std::vector<PassInvocationProfileProto> invocation_profiles;
+
+  // The time at which the first profiled invocation started.
+  std::optional<absl::Time> profile_start;
+  // Nesting depth and fixed-point iteration of the currently running passes.
+  int64_t profile_depth = 0;
+  int64_t fixed_point_iteration = 0;
+
+  // Expansions which passes deferred to stay within a node budget.
+  std::vector<NodeBudgetEventProto> node_budget_events;
 };
 
+namespace internal {
+
+// Returns the peak resident set size of the process, or zero if unavailable.
+int64_t PeakRssBytes();
+
+// Sets `proto` to the given duration.
+void SetDurationProto(absl::Duration duration,
+                      google::protobuf::Duration* proto);
+
+// Returns the number of nodes in `ir` if it is a package.
+template <typename IrT>
+std::optional<int64_t> NodeCount(IrT* ir) {
+  if constexpr (std::is_same_v<IrT, Package>) {
+    int64_t count = 0;
+    for (FunctionBase* f : ir->GetFunctionBases()) {
+      count += f->node_count();
+    }
+    return count;
+  } else {
+    return std::nullopt;
+  }
+}
+
+}  // namespace internal
+
 // Base class for all compiler passes. Template parameters:
 //
 //   IrT : The data type that the pass operates on (e.g., xls::Package). The
@@ -362,7 +404,12 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
         ir_dump_path / absl::StrFormat("%s.%s.%05d.%s.%s.ir", ir->name(),
                                        top_level_name, ordinal, tag,
                                        changed ? "changed" : "unchanged");
-    return SetFileContents(path, ir->DumpIr());
+    if constexpr (std::is_same_v<IrT, Package>) {
+      // Stream packages to the file rather than building the text in memory.
+      return ir->DumpIrToFile(path);
+    } else {
+      return SetFileContents(path, ir->DumpIr());
+    }
   }
 
   std::vector<std::unique_ptr<Pass>> passes_;
@@ -372,6 +419,37 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
   std::vector<InvariantChecker*> invariant_checker_ptrs_;
 };
 
+// An RAII scope identifying one run of a fixed-point compound pass on the
+// current thread. Passes may use the session id to avoid repeating work which
+// is known to be a no-op within the session: if a pass made no change to some
+// part of the IR in an earlier iteration and that part has not been modified
+// since, rerunning the pass on it is pointless. Nested sessions are allowed;
+// the innermost one is current.
+class FixedPointSession {
+ public:
+  FixedPointSession()
+      : id_(next_id_.fetch_add(1, std::memory_order_relaxed)),
+        previous_(current_) {
+    current_ = id_;
+  }
+  ~FixedPointSession() { current_ = previous_; }
+
+  FixedPointSession(const FixedPointSession&) = delete;
+  FixedPointSession& operator=(const FixedPointSession&) = delete;
+
+  int64_t id() const { return id_; }
+
+  // Returns the id of the innermost session on this thread, if any.
+  static std::optional<int64_t> Current() { return current_; }
+
+ private:
+  static inline std::atomic<int64_t> next_id_ = 0;
+  static inline thread_local std::optional<int64_t> current_;
+
+  int64_t id_;
+  std::optional<int64_t> previous_;
+};
+
 // A compound pass which runs its set of passes to fixed point.
 template <typename IrT, typename OptionsT, typename ResultsT = PassResults>
 class FixedPointCompoundPassBase
@@ -399,11 +477,14 @@ class FixedPointCompoundPassBase
       absl::Span<const typename CompoundPassBase<
           IrT, OptionsT, ResultsT>::InvariantChecker* const>
           invariant_checkers) const override {
+    FixedPointSession session;
     bool local_changed = true;
     int64_t iteration_count = 0;
+    int64_t outer_iteration = results->fixed_point_iteration;
     CompoundPassResult aggregate_result;
     while (local_changed) {
       ++iteration_count;
+      results->fixed_point_iteration = iteration_count;
       XLS_ASSIGN_OR_RETURN(
           CompoundPassResult compound_result,
           (CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
@@ -413,6 +494,7 @@ class FixedPointCompoundPassBase
       local_changed = compound_result.changed();
       aggregate_result.AccumulateCompoundPassResult(compound_result);
     }
+    results->fixed_point_iteration = outer_iteration;
     VLOG(1) << absl::StreamFormat(
         "Fixed point compound pass %s iterated %d times.", this->long_name(),
         iteration_count);
@@ -484,15 +566,36 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
     // do not check it in optimized builds.
     std::string ir_before = ir->DumpIr();
 #endif
+    std::optional<PassInvocationProfileProto> profile;
+    int64_t peak_rss_before = 0;
+    if (options.record_metrics) {
+      if (!results->profile_start.has_value()) {
+        results->profile_start = absl::Now();
+      }
+      profile.emplace();
+      profile->set_pass_name(pass->short_name());
+      profile->set_compound(pass->IsCompound());
+      profile->set_depth(results->profile_depth);
+      if (results->fixed_point_iteration > 0) {
+        profile->set_fixed_point_iteration(results->fixed_point_iteration);
+      }
+      if (std::optional<int64_t> count = internal::NodeCount(ir)) {
+        profile->set_node_count_before(*count);
+      }
+      peak_rss_before = internal::PeakRssBytes();
+    }
+
     absl::Time start = absl::Now();
     bool pass_changed;
     if (pass->IsCompound()) {
+      ++results->profile_depth;
       XLS_ASSIGN_OR_RETURN(
           CompoundPassResult compound_result,
           (down_cast<CompoundPassBase<IrT, OptionsT, ResultsT>*>(pass.get())
                ->RunNested(ir, options, results, top_level_name, checkers)),
           _ << "Running pass #" << results->invocations.size() << ": "
             << pass->long_name() << " [short: " << pass->short_name() << "]");
+      --results->profile_depth;
       pass_changed = compound_result.changed();
     } else {
       XLS_ASSIGN_OR_RETURN(pass_changed, pass->Run(ir, options, results));
@@ -524,6 +627,19 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
     if (pass_changed) {
       VLOG(1) << absl::StrFormat("Metrics: %s", pass_metrics.ToString());
     }
+    if (profile.has_value()) {
+      profile->set_changed(pass_changed);
+      internal::SetDurationProto(start - *results->profile_start,
+                                 profile->mutable_start());
+      internal::SetDurationProto(duration, profile->mutable_duration());
+      profile->set_peak_rss_delta_bytes(internal::PeakRssBytes() -
+                                        peak_rss_before);
+      if (std::optional<int64_t> count = internal::NodeCount(ir)) {
+        profile->set_node_count_after(*count);
+      }
+      *profile->mutable_metrics() = pass_metrics.ToProto();
+      results->invocation_profiles.push_back(*std::move(profile));
+    }
     if (!pass->IsCompound()) {
       results->invocations.push_back(
           {pass->short_name(), pass_changed, duration});
@@ -23,6 +23,7 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -39,6 +40,7 @@
 #include "xls/ir/value.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_metrics.pb.h"
 
 namespace m = ::xls::op_matchers;
 namespace xls {
@@ -289,5 +291,63 @@ TEST_F(PassBaseTest, BisectLimitZero) {
   EXPECT_THAT(results.invocations, IsEmpty());
 }
 
+TEST_F(PassBaseTest, RecordsInvocationProfiles) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 2));
+  XLS_ASSERT_OK(fb.Build().status());
+  OptimizationCompoundPass opt("opt", "opt");
+  {
+    auto fp =
+        std::make_unique<OptimizationFixedPointCompoundPass>("fixed", "fixed");
+    fp->Add<LevelUpPass>();
+    fp->Add<DeadCodeEliminationPass>();
+    opt.AddOwned(std::move(fp));
+  }
+  PassResults results;
+  ASSERT_THAT(
+      opt.Run(p.get(),
+              OptimizationPassOptions(PassOptionsBase{.record_metrics = true}),
+              &results),
+      IsOk());
+
+  // The literal is incremented three times so the fixed point takes four
+  // iterations of two passes, followed by the fixed-point pass itself.
+  ASSERT_EQ(results.invocation_profiles.size(), 9);
+  const PassInvocationProfileProto& first = results.invocation_profiles[0];
+  EXPECT_EQ(first.pass_name(), "level_up");
+  EXPECT_FALSE(first.compound());
+  EXPECT_EQ(first.depth(), 1);
+  EXPECT_EQ(first.fixed_point_iteration(), 1);
+  EXPECT_TRUE(first.changed());
+  EXPECT_EQ(first.node_count_before(), 1);
+  EXPECT_EQ(first.node_count_after(), 2);
+  EXPECT_EQ(first.metrics().nodes_added(), 1);
+  EXPECT_EQ(first.metrics().nodes_visited(), 1);
+
+  const PassInvocationProfileProto& dce = results.invocation_profiles[1];
+  EXPECT_EQ(dce.pass_name(), "dce");
+  EXPECT_EQ(dce.node_count_after(), 1);
+  EXPECT_EQ(dce.metrics().nodes_removed(), 1);
+
+  const PassInvocationProfileProto& last = results.invocation_profiles[7];
+  EXPECT_EQ(last.fixed_point_iteration(), 4);
+  EXPECT_FALSE(last.changed());
+
+  const PassInvocationProfileProto& fixed = results.invocation_profiles[8];
+  EXPECT_EQ(fixed.pass_name(), "fixed");
+  EXPECT_TRUE(fixed.compound());
+  EXPECT_EQ(fixed.depth(), 0);
+  EXPECT_FALSE(fixed.has_fixed_point_iteration());
+  EXPECT_TRUE(fixed.changed());
+  EXPECT_EQ(fixed.metrics().nodes_added(), 3);
+  // The nested invocations lie within the compound pass's invocation.
+  absl::Duration fixed_start = absl::Seconds(fixed.start().seconds()) +
+                               absl::Nanoseconds(fixed.start().nanos());
+  absl::Duration first_start = absl::Seconds(first.start().seconds()) +
+                               absl::Nanoseconds(first.start().nanos());
+  EXPECT_LE(fixed_start, first_start);
+}
+
 }  // namespace
 }  // namespace xls
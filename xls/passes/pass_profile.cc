@@ -0,0 +1,102 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_profile.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "google/protobuf/duration.pb.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/ir/transform_metrics.pb.h"
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+namespace {
+
+// Returns `s` as a quoted JSON string.
+std::string JsonString(std::string_view s) {
+  std::string result = "\"";
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(&result, "\\u%04x", c);
+        } else {
+          result += c;
+        }
+    }
+  }
+  result += "\"";
+  return result;
+}
+
+// Returns the duration in (fractional) microseconds, the unit of trace event
+// timestamps.
+double Micros(const google::protobuf::Duration& duration) {
+  return static_cast<double>(duration.seconds()) * 1e6 +
+         static_cast<double>(duration.nanos()) / 1e3;
+}
+
+}  // namespace
+
+std::string PipelineMetricsToChromeTrace(const PipelineMetricsProto& metrics) {
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const PassInvocationProfileProto& profile : metrics.invocations()) {
+    if (!first) {
+      json += ",";
+    }
+    first = false;
+    const TransformMetricsProto& transform = profile.metrics();
+    absl::StrAppendFormat(
+        &json,
+        "\n{\"name\":%s,\"cat\":%s,\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+        "\"pid\":0,\"tid\":0,\"args\":{\"changed\":%s,\"depth\":%d",
+        JsonString(profile.pass_name()),
+        profile.compound() ? "\"compound\"" : "\"pass\"",
+        Micros(profile.start()), Micros(profile.duration()),
+        profile.changed() ? "true" : "false", profile.depth());
+    if (profile.has_fixed_point_iteration()) {
+      absl::StrAppend(&json, ",\"fixed_point_iteration\":",
+                      profile.fixed_point_iteration());
+    }
+    if (profile.has_node_count_before()) {
+      absl::StrAppend(&json, ",\"node_count_before\":",
+                      profile.node_count_before(), ",\"node_count_after\":",
+                      profile.node_count_after());
+    }
+    absl::StrAppendFormat(
+        &json,
+        ",\"peak_rss_delta_bytes\":%d,\"nodes_visited\":%d,"
+        "\"nodes_added\":%d,\"nodes_removed\":%d,\"nodes_replaced\":%d,"
+        "\"operands_replaced\":%d,\"query_engine_us\":%.3f}}",
+        profile.peak_rss_delta_bytes(), transform.nodes_visited(),
+        transform.nodes_added(), transform.nodes_removed(),
+        transform.nodes_replaced(), transform.operands_replaced(),
+        Micros(transform.query_engine_duration()));
+  }
+  json += "\n]}\n";
+  return json;
+}
+
+}  // namespace xls
@@ -0,0 +1,34 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PASS_PROFILE_H_
+#define XLS_PASSES_PASS_PROFILE_H_
+
+#include <string>
+
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+
+// Returns the invocation profiles recorded in `metrics` as a JSON document in
+// the Chrome trace event format, which can be loaded into chrome://tracing or
+// Perfetto. Each invocation becomes a complete event. Invocations run by a
+// compound pass nest inside the compound pass's event. The remaining profile
+// fields (changes, node counts, memory, query engine time) are attached to
+// each event as arguments.
+std::string PipelineMetricsToChromeTrace(const PipelineMetricsProto& metrics);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PASS_PROFILE_H_
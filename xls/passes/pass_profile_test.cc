@@ -0,0 +1,69 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_profile.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+TEST(PassProfileTest, EmptyTrace) {
+  EXPECT_EQ(PipelineMetricsToChromeTrace(PipelineMetricsProto()),
+            "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n]}\n");
+}
+
+TEST(PassProfileTest, InvocationsBecomeCompleteEvents) {
+  PipelineMetricsProto metrics;
+  PassInvocationProfileProto* outer = metrics.add_invocations();
+  outer->set_pass_name("fixed");
+  outer->set_compound(true);
+  outer->set_changed(true);
+  outer->mutable_duration()->set_seconds(2);
+  PassInvocationProfileProto* inner = metrics.add_invocations();
+  inner->set_pass_name("we\"ird");
+  inner->set_depth(1);
+  inner->set_fixed_point_iteration(3);
+  inner->mutable_start()->set_nanos(1500);
+  inner->mutable_duration()->set_nanos(250000);
+  inner->set_node_count_before(10);
+  inner->set_node_count_after(7);
+  inner->mutable_metrics()->set_nodes_removed(3);
+  inner->mutable_metrics()->mutable_query_engine_duration()->set_nanos(2000);
+
+  std::string trace = PipelineMetricsToChromeTrace(metrics);
+  EXPECT_THAT(trace,
+              StartsWith("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+  EXPECT_THAT(trace, HasSubstr("{\"name\":\"fixed\",\"cat\":\"compound\","
+                               "\"ph\":\"X\",\"ts\":0.000,\"dur\":2000000.000,"
+                               "\"pid\":0,\"tid\":0,\"args\":{\"changed\":true,"
+                               "\"depth\":0,\"peak_rss_delta_bytes\":0"));
+  EXPECT_THAT(trace, HasSubstr("{\"name\":\"we\\\"ird\",\"cat\":\"pass\","
+                               "\"ph\":\"X\",\"ts\":1.500,\"dur\":250.000,"));
+  EXPECT_THAT(trace, HasSubstr("\"fixed_point_iteration\":3,"
+                               "\"node_count_before\":10,"
+                               "\"node_count_after\":7,"));
+  EXPECT_THAT(trace, HasSubstr("\"nodes_removed\":3,"));
+  EXPECT_THAT(trace, HasSubstr("\"query_engine_us\":2.000}}"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -15,6 +15,7 @@
 #include "xls/passes/proc_inlining_pass.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -38,6 +39,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
+#include "xls/common/thread.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -733,6 +735,80 @@ GetReceiveDataDependencies(Proc* inlined_proc) {
   return std::move(result);
 }
 
+// The analyses of a proc required to inline it. These depend only on the proc
+// being inlined, which is not modified during inlining, so the analyses of
+// different procs are independent.
+struct InlinedProcAnalysis {
+  // The token DAG of the proc in topological order.
+  std::vector<NodeAndPredecessors> token_graph;
+  // The nodes which are data dependent on each receive as returned by
+  // GetReceiveDataDependencies.
+  absl::flat_hash_map<Receive*, std::vector<Node*>> receive_data_deps;
+};
+
+absl::StatusOr<InlinedProcAnalysis> AnalyzeInlinedProc(Proc* proc) {
+  XLS_RETURN_IF_ERROR(VerifyTokenDependencies(proc));
+  InlinedProcAnalysis analysis;
+  XLS_ASSIGN_OR_RETURN(analysis.token_graph, ComputeTopoSortedTokenDAG(proc));
+  XLS_ASSIGN_OR_RETURN(analysis.receive_data_deps,
+                       GetReceiveDataDependencies(proc));
+  return analysis;
+}
+
+// Analyzes each of the given procs. The analyses only read the procs so they
+// are run in parallel, one proc at a time per thread.
+absl::StatusOr<std::vector<InlinedProcAnalysis>> AnalyzeInlinedProcs(
+    absl::Span<Proc* const> procs) {
+  std::vector<absl::StatusOr<InlinedProcAnalysis>> results(
+      procs.size(), absl::UnknownError("Proc not analyzed"));
+  std::atomic<int64_t> next_proc = 0;
+  auto analyze_procs = [&]() {
+    for (int64_t i = next_proc.fetch_add(1); i < procs.size();
+         i = next_proc.fetch_add(1)) {
+      results[i] = AnalyzeInlinedProc(procs[i]);
+    }
+  };
+  int64_t thread_count =
+      std::min(static_cast<int64_t>(AvailableCPUs()),
+               static_cast<int64_t>(procs.size()));
+  if (thread_count <= 1) {
+    analyze_procs();
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(analyze_procs));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  std::vector<InlinedProcAnalysis> analyses;
+  analyses.reserve(procs.size());
+  for (absl::StatusOr<InlinedProcAnalysis>& result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+    analyses.push_back(*std::move(result));
+  }
+  return analyses;
+}
+
+// Removes the nodes of `proc` which have no effect. Every node of an inlined
+// proc is copied into the container proc so removing dead logic from each proc
+// beforehand keeps it out of the (much larger) container and the analyses over
+// it. Returns true if any node was removed.
+absl::StatusOr<bool> RemoveDeadNodes(Proc* proc) {
+  bool changed = false;
+  for (Node* node : ReverseTopoSort(proc)) {
+    if (node->IsDead() && !node->Is<StateRead>() &&
+        !OpIsSideEffecting(node->op())) {
+      XLS_RETURN_IF_ERROR(proc->RemoveNode(node));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
 // Abstraction representing a proc thread. A proc thread contains the logic
 // required to virtually evaluate a proc (the "inlined proc") within another
 // proc (the "container proc"). An activation bit is threaded through the proc's
@@ -742,13 +818,15 @@ class ProcThread {
  public:
   // Creates and returns a proc thread which executes the given proc.
   // `container_proc` is the FunctionBase which will contain the proc thread.
-  static absl::StatusOr<ProcThread> Create(Proc* inlined_proc,
-                                           Proc* container_proc) {
+  // `analysis` is the analysis of `inlined_proc` and must outlive the proc
+  // thread.
+  static absl::StatusOr<ProcThread> Create(
+      Proc* inlined_proc, Proc* container_proc,
+      const InlinedProcAnalysis* analysis) {
     ProcThread proc_thread;
     proc_thread.inlined_proc_ = inlined_proc;
     proc_thread.container_proc_ = container_proc;
-
-    XLS_RETURN_IF_ERROR(VerifyTokenDependencies(inlined_proc));
+    proc_thread.analysis_ = analysis;
 
     // Create the state element to hold the state of the inlined proc.
     for (int64_t i = 0; i < inlined_proc->GetStateElementCount(); ++i) {
@@ -819,8 +897,8 @@ class ProcThread {
   // source and sink nodes as well.
   absl::Status CreateActivationNetwork() {
     VLOG(3) << "CreateActivationNetwork " << inlined_proc_->name();
-    XLS_ASSIGN_OR_RETURN(std::vector<NodeAndPredecessors> token_graph,
-                         ComputeTopoSortedTokenDAG(inlined_proc_));
+    const std::vector<NodeAndPredecessors>& token_graph =
+        analysis_->token_graph;
     // Create the state element for the activation bit of the proc thread.
     XLS_ASSIGN_OR_RETURN(
         activation_state_,
@@ -978,9 +1056,8 @@ class ProcThread {
   // activation nodes.
   absl::StatusOr<absl::flat_hash_map<Receive*, std::vector<ActivationNode*>>>
   GetDataDependentActivationNodes() {
-    absl::flat_hash_map<Receive*, std::vector<Node*>> receive_data_deps;
-    XLS_ASSIGN_OR_RETURN(receive_data_deps,
-                         GetReceiveDataDependencies(inlined_proc_));
+    const absl::flat_hash_map<Receive*, std::vector<Node*>>& receive_data_deps =
+        analysis_->receive_data_deps;
 
     absl::flat_hash_set<Node*> next_state_nodes(
         inlined_proc_->NextState().begin(), inlined_proc_->NextState().end());
@@ -1359,6 +1436,9 @@ class ProcThread {
   // simultaneously evaluate multiple proc threads.
   Proc* container_proc_;
 
+  // The analysis of `inlined_proc_`.
+  const InlinedProcAnalysis* analysis_;
+
   // The state elements required to by this proc thread. These elements are
   // later added to the container proc state.
   std::list<AbstractStateElement> state_elements_;
@@ -1686,10 +1766,12 @@ absl::StatusOr<Node*> ProcThread::ConvertToActivatedReceive(
 // the `virtual_send` and `virtual_receive` maps.
 absl::StatusOr<ProcThread> InlineProcAsProcThread(
     Proc* proc_to_inline, Proc* container_proc,
+    const InlinedProcAnalysis* analysis,
     absl::flat_hash_map<Channel*, VirtualChannel>& virtual_channels) {
   auto topo_sort = TopoSort(proc_to_inline);
-  XLS_ASSIGN_OR_RETURN(ProcThread proc_thread,
-                       ProcThread::Create(proc_to_inline, container_proc));
+  XLS_ASSIGN_OR_RETURN(
+      ProcThread proc_thread,
+      ProcThread::Create(proc_to_inline, container_proc, analysis));
   absl::flat_hash_map<Node*, Node*> node_map;
 
   auto clone_node = [&](Node* node) -> absl::StatusOr<Node*> {
@@ -1910,6 +1992,7 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
 
   for (Proc* proc : procs_to_inline) {
     XLS_RETURN_IF_ERROR(ConvertToNextStateElements(proc));
+    XLS_RETURN_IF_ERROR(RemoveDeadNodes(proc).status());
   }
 
   VLOG(3) << "After switching to next-state elements:\n" << p->DumpIr();
@@ -1936,6 +2019,9 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
     }
   }
 
+  XLS_ASSIGN_OR_RETURN(std::vector<InlinedProcAnalysis> analyses,
+                       AnalyzeInlinedProcs(procs_to_inline));
+
   Proc* container_proc = p->AddProc(std::make_unique<Proc>("__container", p));
   XLS_ASSIGN_OR_RETURN(Node * container_token,
                        container_proc->MakeNodeWithName<Literal>(
@@ -1965,10 +2051,11 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
   // virtual send/receives.
   // TODO(meheff): 2022/02/11 Add analysis which determines whether inlining is
   // a legal transformation.
-  for (Proc* proc : procs_to_inline) {
-    XLS_ASSIGN_OR_RETURN(
-        ProcThread proc_thread,
-        InlineProcAsProcThread(proc, container_proc, virtual_channels));
+  for (int64_t i = 0; i < procs_to_inline.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(ProcThread proc_thread,
+                         InlineProcAsProcThread(procs_to_inline[i],
+                                                container_proc, &analyses[i],
+                                                virtual_channels));
     proc_threads.push_back(std::move(proc_thread));
   }
 
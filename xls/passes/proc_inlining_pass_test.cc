@@ -523,6 +523,54 @@ TEST_F(ProcInliningPassTest, NestedProcs) {
                     .status());
 }
 
+TEST_F(ProcInliningPassTest, ChainOfManyNestedProcs) {
+  // A pass-through proc which sends its input through a chain of doublers.
+  // Enough procs that they are analyzed on several threads.
+  constexpr int64_t kDoublerCount = 16;
+  auto p = CreatePackage();
+  Type* u32 = p->GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_in,
+      p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_out,
+      p->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+
+  std::vector<Channel*> links;
+  for (int64_t i = 0; i <= kDoublerCount; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * link,
+        p->CreateStreamingChannel(absl::StrFormat("link%d", i),
+                                  ChannelOps::kSendReceive, u32,
+                                  /*initial_values=*/{},
+                                  /*fifo_config=*/FifoConfigWithDepth(0)));
+    links.push_back(link);
+  }
+
+  XLS_ASSERT_OK(MakePassThroughProc("A", ch_in, links.front(), links.back(),
+                                    ch_out, p.get())
+                    .status());
+  for (int64_t i = 0; i < kDoublerCount; ++i) {
+    XLS_ASSERT_OK(MakeDoublerProc(absl::StrFormat("D%d", i), links[i],
+                                  links[i + 1], p.get())
+                      .status());
+  }
+
+  EXPECT_EQ(p->procs().size(), kDoublerCount + 1);
+  XLS_EXPECT_OK(EvalAndExpect(p.get(), {{"in", {1, 2, 3}}},
+                              {{"out", {1 << kDoublerCount, 2 << kDoublerCount,
+                                        3 << kDoublerCount}}})
+                    .status());
+
+  ASSERT_THAT(Run(p.get(), /*top=*/"A"), IsOkAndHolds(true));
+
+  EXPECT_EQ(p->procs().size(), 1);
+  XLS_EXPECT_OK(EvalAndExpect(p.get(), {{"in", {1, 2, 3}}},
+                              {{"out", {1 << kDoublerCount, 2 << kDoublerCount,
+                                        3 << kDoublerCount}}})
+                    .status());
+}
+
 TEST_F(ProcInliningPassTest, NestedProcsFifoDepth1) {
   // Nested procs where the inner proc does a trivial arithmetic operation.
   auto p = CreatePackage();
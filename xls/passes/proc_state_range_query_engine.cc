@@ -12,9 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "xls/ir/node_map.h"
 #include "xls/passes/proc_state_range_query_engine.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <queue>
 #include <utility>
@@ -49,7 +51,6 @@
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
-#include "xls/ir/value_utils.h"
 #include "xls/passes/back_propagate_range_analysis.h"
 #include "xls/passes/dataflow_visitor.h"
 #include "xls/passes/node_dependency_analysis.h"
@@ -287,8 +288,7 @@ class ConstantValueIrInterpreter
   // it's hard to imagine many procs with more than a handful of constant set
   // values which are still narrowable.
   static constexpr int64_t kSegmentLimit = 8;
-  const absl::flat_hash_map<Node*, LeafTypeTree<absl::flat_hash_set<Bits>>>&
-  values() const {
+  const NodeMap<LeafTypeTree<absl::flat_hash_set<Bits>>>& values() const {
     return map_;
   }
   absl::Status DefaultHandler(Node* n) override {
@@ -407,10 +407,10 @@ class ConstantValueIrInterpreter
   absl::Status HandleParam(Param* p) override { return HandleNonConst(p); }
 
   absl::Status HandleLiteral(Literal* l) override {
-    XLS_ASSIGN_OR_RETURN(LeafTypeTree<Value> value_ltt,
-                         ValueToLeafTypeTree(l->value(), l->GetType()));
+    XLS_ASSIGN_OR_RETURN(std::shared_ptr<const LeafTypeTree<Value>> value_ltt,
+                         l->GetValueTree());
     return SetValue(l, leaf_type_tree::Map<absl::flat_hash_set<Bits>, Value>(
-                           value_ltt.AsView(),
+                           value_ltt->AsView(),
                            [](const Value& v) -> absl::flat_hash_set<Bits> {
                              if (v.IsToken()) {
                                return {UBits(0, 0)};
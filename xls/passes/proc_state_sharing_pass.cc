@@ -0,0 +1,253 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proc_state_sharing_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/graph_coloring.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/state_element.h"
+#include "xls/ir/value.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/stateless_query_engine.h"
+#include "xls/passes/union_query_engine.h"
+
+namespace xls {
+namespace {
+
+// A state element which may share storage with other state elements.
+struct SharingCandidate {
+  StateRead* state_read;
+  // The only next value of the state element. It always has a predicate.
+  Next* next;
+};
+
+// Returns the write flag of the state element written by `next`, i.e., a
+// one-bit state element which is initially zero and is unconditionally set to
+// the predicate of `next` every tick. The flag is therefore set exactly in the
+// ticks following a write of the state element.
+std::optional<StateRead*> FindWriteFlag(Proc* proc, Next* next) {
+  Node* write_predicate = next->predicate().value();
+  for (Node* user : write_predicate->users()) {
+    if (!user->Is<Next>()) {
+      continue;
+    }
+    Next* flag_next = user->As<Next>();
+    if (flag_next->value() != write_predicate ||
+        flag_next->predicate().has_value()) {
+      continue;
+    }
+    StateRead* flag = flag_next->state_read()->As<StateRead>();
+    if (flag == next->state_read() || flag->predicate().has_value() ||
+        proc->next_values(flag).size() != 1 ||
+        flag->state_element()->initial_value() != Value(UBits(0, 1))) {
+      continue;
+    }
+    return flag;
+  }
+  return std::nullopt;
+}
+
+// Returns the state element read by `state_read` as a candidate for sharing if
+// its value is only observed in the tick after it was written.
+std::optional<SharingCandidate> GetSharingCandidate(
+    Proc* proc, StateRead* state_read, const QueryEngine& query_engine) {
+  if (!state_read->GetType()->IsBits() || state_read->BitCountOrDie() == 0 ||
+      !state_read->predicate().has_value()) {
+    return std::nullopt;
+  }
+  const absl::btree_set<Next*, Node::NodeIdLessThan>& next_values =
+      proc->next_values(state_read);
+  if (next_values.size() != 1) {
+    return std::nullopt;
+  }
+  Next* next = *next_values.begin();
+  if (!next->predicate().has_value() || next->value() == state_read) {
+    return std::nullopt;
+  }
+  std::optional<StateRead*> flag = FindWriteFlag(proc, next);
+  if (!flag.has_value()) {
+    return std::nullopt;
+  }
+  // The value is only observed when the read predicate holds; this must imply
+  // that the state element was written in the previous tick.
+  if (!query_engine.Implies(TreeBitLocation(*state_read->predicate(), 0),
+                            TreeBitLocation(*flag, 0))) {
+    return std::nullopt;
+  }
+  VLOG(3) << absl::StreamFormat("State element %s may be shared; write flag %s",
+                                state_read->state_element()->name(),
+                                (*flag)->state_element()->name());
+  return SharingCandidate{.state_read = state_read, .next = next};
+}
+
+// Replaces the given state elements with a single state element wide enough to
+// hold any of them. The state elements must never be written in the same tick.
+absl::Status ShareStateElements(Proc* proc,
+                                absl::Span<const SharingCandidate> group) {
+  int64_t bit_count = 0;
+  std::vector<std::string_view> names;
+  for (const SharingCandidate& candidate : group) {
+    bit_count = std::max(bit_count, candidate.state_read->BitCountOrDie());
+    names.push_back(candidate.state_read->state_element()->name());
+  }
+  VLOG(2) << absl::StreamFormat("Sharing %d bits of state between %s",
+                                bit_count, absl::StrJoin(names, ", "));
+
+  // No element is observed before it has been written so the initial value is
+  // arbitrary.
+  XLS_ASSIGN_OR_RETURN(
+      StateRead * shared,
+      proc->AppendStateElement(absl::StrFormat("%s__shared", names.front()),
+                               Value(UBits(0, bit_count)),
+                               /*read_predicate=*/std::nullopt,
+                               /*next_state=*/std::nullopt));
+
+  for (const SharingCandidate& candidate : group) {
+    StateRead* state_read = candidate.state_read;
+    Next* next = candidate.next;
+    Node* value = next->value();
+    if (value->BitCountOrDie() != bit_count) {
+      XLS_ASSIGN_OR_RETURN(value, proc->MakeNode<ExtendOp>(next->loc(), value,
+                                                           bit_count,
+                                                           Op::kZeroExt));
+    }
+    XLS_RETURN_IF_ERROR(
+        proc->MakeNode<Next>(next->loc(), /*state_read=*/shared, value,
+                             next->predicate())
+            .status());
+    XLS_RETURN_IF_ERROR(
+        next->ReplaceUsesWithNew<Literal>(Value::Tuple({})).status());
+    XLS_RETURN_IF_ERROR(proc->RemoveNode(next));
+
+    if (state_read->BitCountOrDie() == bit_count) {
+      XLS_RETURN_IF_ERROR(state_read->ReplaceUsesWith(shared));
+    } else {
+      XLS_RETURN_IF_ERROR(
+          state_read
+              ->ReplaceUsesWithNew<BitSlice>(shared, /*start=*/0,
+                                             state_read->BitCountOrDie())
+              .status());
+    }
+  }
+
+  std::vector<int64_t> indices;
+  for (const SharingCandidate& candidate : group) {
+    XLS_ASSIGN_OR_RETURN(int64_t index,
+                         proc->GetStateElementIndex(
+                             candidate.state_read->state_element()));
+    indices.push_back(index);
+  }
+  absl::c_sort(indices, std::greater<int64_t>());
+  for (int64_t index : indices) {
+    XLS_RETURN_IF_ERROR(proc->RemoveStateElement(index));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ProcStateSharingPass::RunOnProcInternal(
+    Proc* proc, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  // TODO(epastor): Clean this up once we no longer use next-state elements.
+  if (proc->next_values().empty()) {
+    return false;
+  }
+
+  std::vector<std::unique_ptr<QueryEngine>> query_engines;
+  query_engines.push_back(std::make_unique<StatelessQueryEngine>());
+  query_engines.push_back(std::make_unique<BddQueryEngine>(
+      BddFunction::kDefaultPathLimit, IsCheapForBdds));
+  UnionQueryEngine query_engine(std::move(query_engines));
+  XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
+
+  std::vector<SharingCandidate> candidates;
+  for (StateElement* state_element : proc->StateElements()) {
+    std::optional<SharingCandidate> candidate = GetSharingCandidate(
+        proc, proc->GetStateRead(state_element), query_engine);
+    if (candidate.has_value()) {
+      candidates.push_back(*candidate);
+    }
+  }
+  if (candidates.size() < 2) {
+    return false;
+  }
+
+  // Two candidates interfere if they may be written in the same tick.
+  std::vector<absl::flat_hash_set<int64_t>> interference(candidates.size());
+  absl::flat_hash_set<int64_t> vertices;
+  for (int64_t i = 0; i < candidates.size(); ++i) {
+    vertices.insert(i);
+    for (int64_t j = i + 1; j < candidates.size(); ++j) {
+      if (!query_engine.AtMostOneTrue(
+              {TreeBitLocation(*candidates[i].next->predicate(), 0),
+               TreeBitLocation(*candidates[j].next->predicate(), 0)})) {
+        interference[i].insert(j);
+        interference[j].insert(i);
+      }
+    }
+  }
+  std::vector<absl::flat_hash_set<int64_t>> colors =
+      RecursiveLargestFirstColoring<int64_t>(
+          vertices, [&](const int64_t& v) { return interference[v]; });
+
+  bool changed = false;
+  for (const absl::flat_hash_set<int64_t>& color : colors) {
+    if (color.size() < 2) {
+      continue;
+    }
+    std::vector<int64_t> members(color.begin(), color.end());
+    absl::c_sort(members);
+    std::vector<SharingCandidate> group;
+    group.reserve(members.size());
+    for (int64_t member : members) {
+      group.push_back(candidates[member]);
+    }
+    XLS_RETURN_IF_ERROR(ShareStateElements(proc, group));
+    changed = true;
+  }
+  return changed;
+}
+
+REGISTER_OPT_PASS(ProcStateSharingPass);
+
+}  // namespace xls
@@ -0,0 +1,52 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PROC_STATE_SHARING_PASS_H_
+#define XLS_PASSES_PROC_STATE_SHARING_PASS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/proc.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Pass which merges proc state elements with non-overlapping lifetimes into a
+// single shared state element, reducing the number of flops in the proc.
+//
+// A state element X can share storage if its value is only ever observed (its
+// read predicate holds) in the tick after it was written. This is established
+// by a one-bit "write flag" state element F with initial value zero whose only
+// next value is the write predicate of X, and a read predicate of X which
+// implies F. Two such elements interfere if they may be written in the same
+// tick. The interference graph is colored and the elements of each color are
+// replaced by a single state element as wide as the widest of them.
+class ProcStateSharingPass : public OptimizationProcPass {
+ public:
+  static constexpr std::string_view kName = "proc_state_sharing";
+  ProcStateSharingPass()
+      : OptimizationProcPass(kName, "Proc State Sharing") {}
+  ~ProcStateSharingPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunOnProcInternal(Proc* proc,
+                                         const OptimizationPassOptions& options,
+                                         PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PROC_STATE_SHARING_PASS_H_
@@ -0,0 +1,136 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proc_state_sharing_pass.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/passes/pass_base.h"
+
+namespace m = ::xls::op_matchers;
+namespace xls {
+namespace {
+using ::absl_testing::IsOkAndHolds;
+using ::testing::UnorderedElementsAre;
+
+class ProcStateSharingPassTest : public IrTestBase {
+ public:
+  absl::StatusOr<bool> RunPass(Proc* p) {
+    ScopedRecordIr sri(p->package());
+    ProcStateSharingPass pass;
+    PassResults r;
+    return pass.Run(p->package(), {}, &r);
+  }
+
+  // Builds a proc with two data state elements `a` (32 bits) and `b` (16 bits)
+  // loaded from a counter under the given write predicates and each sent out
+  // in the tick after it was loaded, as tracked by a write flag.
+  absl::StatusOr<Proc*> MakeTwoRegisterProc(
+      Package* p, bool exclusive_writes,
+      bool read_predicates_imply_flags = true) {
+    XLS_ASSIGN_OR_RETURN(
+        Channel * out_a, p->CreateStreamingChannel("out_a",
+                                                   ChannelOps::kSendOnly,
+                                                   p->GetBitsType(32)));
+    XLS_ASSIGN_OR_RETURN(
+        Channel * out_b, p->CreateStreamingChannel("out_b",
+                                                   ChannelOps::kSendOnly,
+                                                   p->GetBitsType(16)));
+    ProcBuilder pb(TestName(), p);
+    BValue phase = pb.StateElement("phase", UBits(0, 1));
+    BValue count = pb.StateElement("count", UBits(0, 32));
+    BValue a_valid = pb.StateElement("a_valid", UBits(0, 1));
+    BValue b_valid = pb.StateElement("b_valid", UBits(0, 1));
+    BValue a = pb.StateElement(
+        "a", UBits(0, 32),
+        read_predicates_imply_flags ? a_valid : pb.Literal(UBits(1, 1)));
+    BValue b = pb.StateElement("b", UBits(0, 16), b_valid);
+
+    BValue write_a = pb.Not(phase);
+    BValue write_b = exclusive_writes ? phase : pb.Literal(UBits(1, 1));
+    pb.Next(phase, pb.Not(phase));
+    pb.Next(count, pb.Add(count, pb.Literal(UBits(1, 32))));
+    pb.Next(a, count, write_a);
+    pb.Next(a_valid, write_a);
+    pb.Next(b, pb.BitSlice(count, 0, 16), write_b);
+    pb.Next(b_valid, write_b);
+
+    BValue tok = pb.Literal(Value::Token());
+    pb.SendIf(out_a, tok, a_valid, a);
+    pb.SendIf(out_b, tok, b_valid, b);
+    return pb.Build();
+  }
+};
+
+TEST_F(ProcStateSharingPassTest, ExclusiveRegistersShared) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, MakeTwoRegisterProc(p.get(), /*exclusive_writes=*/true));
+
+  EXPECT_THAT(RunPass(proc), IsOkAndHolds(true));
+
+  EXPECT_THAT(proc->StateElements(),
+              UnorderedElementsAre(
+                  m::StateElement("phase", p->GetBitsType(1)),
+                  m::StateElement("count", p->GetBitsType(32)),
+                  m::StateElement("a_valid", p->GetBitsType(1)),
+                  m::StateElement("b_valid", p->GetBitsType(1)),
+                  m::StateElement("a__shared", p->GetBitsType(32))));
+  StateRead* shared = proc->GetStateRead(int64_t{4});
+  EXPECT_EQ(proc->next_values(shared).size(), 2);
+  EXPECT_THAT(proc->next_values(shared),
+              UnorderedElementsAre(
+                  m::Next(m::StateRead("a__shared"), m::StateRead("count"),
+                          m::Not(m::StateRead("phase"))),
+                  m::Next(m::StateRead("a__shared"),
+                          m::ZeroExt(m::BitSlice(m::StateRead("count"))),
+                          m::StateRead("phase"))));
+}
+
+TEST_F(ProcStateSharingPassTest, SimultaneousWritesNotShared) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, MakeTwoRegisterProc(p.get(), /*exclusive_writes=*/false));
+
+  EXPECT_THAT(RunPass(proc), IsOkAndHolds(false));
+  EXPECT_EQ(proc->GetStateElementCount(), 6);
+}
+
+TEST_F(ProcStateSharingPassTest, ReadWithoutWriteFlagNotShared) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      MakeTwoRegisterProc(p.get(), /*exclusive_writes=*/true,
+                          /*read_predicates_imply_flags=*/false));
+
+  EXPECT_THAT(RunPass(proc), IsOkAndHolds(false));
+  EXPECT_EQ(proc->GetStateElementCount(), 6);
+}
+
+}  // namespace
+}  // namespace xls
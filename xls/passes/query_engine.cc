@@ -30,13 +30,17 @@
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/interval_ops.h"
 #include "xls/ir/interval_set.h"
 #include "xls/ir/node.h"
+#include "xls/ir/package.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -459,4 +463,20 @@ std::unique_ptr<QueryEngine> QueryEngine::SpecializeGiven(
   return std::make_unique<ForwardingQueryEngine>(*this);
 }
 
+thread_local int64_t ScopedQueryEngineTimer::depth_ = 0;
+
+ScopedQueryEngineTimer::ScopedQueryEngineTimer(FunctionBase* f) {
+  if (depth_++ == 0) {
+    package_ = f->package();
+    start_ = absl::Now();
+  }
+}
+
+ScopedQueryEngineTimer::~ScopedQueryEngineTimer() {
+  --depth_;
+  if (package_ != nullptr) {
+    package_->transform_metrics().query_engine_time += absl::Now() - start_;
+  }
+}
+
 }  // namespace xls
@@ -28,11 +28,13 @@
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/interval_set.h"
 #include "xls/ir/node.h"
+#include "xls/ir/package.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/value.h"
 #include "xls/passes/predicate_state.h"
@@ -254,6 +256,26 @@ class QueryEngine {
   std::string ToString(Node* node) const;
 };
 
+// Adds the time spent within its scope to the query engine time in the
+// transform metrics of the package of `f`. Query engines time their Populate
+// methods with it. Scopes nested on the same thread (e.g. an engine populating
+// the engines it is composed of) are only counted once.
+class ScopedQueryEngineTimer {
+ public:
+  explicit ScopedQueryEngineTimer(FunctionBase* f);
+  ~ScopedQueryEngineTimer();
+
+  ScopedQueryEngineTimer(const ScopedQueryEngineTimer&) = delete;
+  ScopedQueryEngineTimer& operator=(const ScopedQueryEngineTimer&) = delete;
+
+ private:
+  static thread_local int64_t depth_;
+
+  // Null if this scope is nested within another.
+  Package* package_ = nullptr;
+  absl::Time start_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_PASSES_QUERY_ENGINE_H_
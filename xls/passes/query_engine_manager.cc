@@ -0,0 +1,91 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_manager.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/query_engine.h"
+
+namespace xls {
+
+QueryEngine* QueryEngineManager::Lookup(const Key& key,
+                                        int64_t modification_count) {
+  absl::MutexLock lock(&mutex_);
+  auto it = engines_.find(key);
+  if (it == engines_.end() ||
+      it->second.modification_count != modification_count) {
+    return nullptr;
+  }
+  ++hit_count_;
+  return it->second.engine.get();
+}
+
+absl::Status QueryEngineManager::Insert(const Key& key,
+                                        int64_t modification_count,
+                                        std::unique_ptr<QueryEngine> engine) {
+  absl::MutexLock lock(&mutex_);
+  if (auto it = engines_.find(key);
+      it != engines_.end() &&
+      it->second.modification_count == modification_count) {
+    return absl::InternalError(absl::StrFormat(
+        "A %s is already registered for the function base with uid %d at "
+        "modification count %d",
+        key.second.name(), key.first, modification_count));
+  }
+  engines_.insert_or_assign(
+      key, Entry{.modification_count = modification_count,
+                 .engine = std::move(engine)});
+  return absl::OkStatus();
+}
+
+void QueryEngineManager::Invalidate(FunctionBase* f) {
+  absl::MutexLock lock(&mutex_);
+  absl::erase_if(engines_, [&](const auto& entry) {
+    return entry.first.first == f->uid();
+  });
+}
+
+void QueryEngineManager::Prune(absl::Span<FunctionBase* const> live) {
+  absl::flat_hash_set<int64_t> live_uids;
+  live_uids.reserve(live.size());
+  for (FunctionBase* f : live) {
+    live_uids.insert(f->uid());
+  }
+  absl::MutexLock lock(&mutex_);
+  absl::erase_if(engines_, [&](const auto& entry) {
+    return !live_uids.contains(entry.first.first);
+  });
+}
+
+int64_t QueryEngineManager::size() const {
+  absl::MutexLock lock(&mutex_);
+  return engines_.size();
+}
+
+int64_t QueryEngineManager::hit_count() const {
+  absl::MutexLock lock(&mutex_);
+  return hit_count_;
+}
+
+}  // namespace xls
@@ -0,0 +1,123 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_QUERY_ENGINE_MANAGER_H_
+#define XLS_PASSES_QUERY_ENGINE_MANAGER_H_
+
+#include <cstdint>
+#include <memory>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/query_engine.h"
+
+namespace xls {
+
+// Holds populated query engines shared by the passes of a pipeline. Building
+// an engine such as a TernaryQueryEngine or RangeQueryEngine requires
+// evaluating the whole function base, so rather than each pass populating its
+// own engine, passes request one from the manager which returns the engine
+// populated by an earlier pass if the function base has not been modified
+// since. Otherwise a new engine is created and populated.
+//
+// Engines returned by the manager are owned by it. They remain valid until the
+// same kind of engine is next requested for the same function base after it
+// has been modified, or the manager is destroyed. Requests for different
+// function bases may be made concurrently; concurrent requests for the same
+// function base (including from within an engine's Populate) are an error.
+class QueryEngineManager {
+ public:
+  QueryEngineManager() = default;
+  QueryEngineManager(const QueryEngineManager&) = delete;
+  QueryEngineManager& operator=(const QueryEngineManager&) = delete;
+
+  // Returns a default-constructed engine of type `EngineT` populated on `f`.
+  template <typename EngineT>
+  absl::StatusOr<EngineT*> GetPopulated(FunctionBase* f) {
+    Key key{f->uid(), std::type_index(typeid(EngineT))};
+    if (QueryEngine* engine = Lookup(key, f->modification_count());
+        engine != nullptr) {
+      return static_cast<EngineT*>(engine);
+    }
+    // Populate without holding the lock so engines for different function
+    // bases may be populated concurrently.
+    int64_t modification_count = f->modification_count();
+    auto engine = std::make_unique<EngineT>();
+    XLS_RETURN_IF_ERROR(engine->Populate(f).status());
+    EngineT* result = engine.get();
+    XLS_RETURN_IF_ERROR(Insert(key, modification_count, std::move(engine)));
+    return result;
+  }
+
+  // Drops all engines held for `f`.
+  void Invalidate(FunctionBase* f);
+
+  // Drops all engines held for function bases other than those in `live`.
+  void Prune(absl::Span<FunctionBase* const> live);
+
+  // Returns the number of engines currently held.
+  int64_t size() const;
+
+  // Returns the number of requests answered with an existing engine.
+  int64_t hit_count() const;
+
+ private:
+  using Key = std::pair<int64_t, std::type_index>;
+  struct Entry {
+    int64_t modification_count;
+    std::unique_ptr<QueryEngine> engine;
+  };
+
+  // Returns the engine for `key` if it was populated at `modification_count`.
+  QueryEngine* Lookup(const Key& key, int64_t modification_count);
+  // Records `engine` for `key`, replacing any engine populated at an earlier
+  // modification count. Returns an error if an engine populated at
+  // `modification_count` is already registered, as a caller may hold it.
+  absl::Status Insert(const Key& key, int64_t modification_count,
+                      std::unique_ptr<QueryEngine> engine);
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<Key, Entry> engines_ ABSL_GUARDED_BY(mutex_);
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Returns an engine of type `EngineT` populated on `f`. If `manager` is
+// non-null the engine is shared through it. Otherwise a new engine is created,
+// populated and appended to `owned`.
+template <typename EngineT>
+absl::StatusOr<EngineT*> GetPopulatedQueryEngine(
+    FunctionBase* f, QueryEngineManager* manager,
+    std::vector<std::unique_ptr<QueryEngine>>& owned) {
+  if (manager != nullptr) {
+    return manager->GetPopulated<EngineT>(f);
+  }
+  auto engine = std::make_unique<EngineT>();
+  XLS_RETURN_IF_ERROR(engine->Populate(f).status());
+  EngineT* result = engine.get();
+  owned.push_back(std::move(engine));
+  return result;
+}
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_QUERY_ENGINE_MANAGER_H_
@@ -0,0 +1,160 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_manager.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class QueryEngineManagerTest : public IrTestBase {};
+
+// An engine which requests an engine of its own type for the function base it
+// is populating from the manager, as a pass running concurrently on the same
+// function base might.
+class ReentrantQueryEngine : public TernaryQueryEngine {
+ public:
+  static QueryEngineManager* manager;
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    if (manager != nullptr) {
+      QueryEngineManager* outer = manager;
+      manager = nullptr;
+      XLS_RETURN_IF_ERROR(
+          outer->GetPopulated<ReentrantQueryEngine>(f).status());
+    }
+    return TernaryQueryEngine::Populate(f);
+  }
+};
+
+QueryEngineManager* ReentrantQueryEngine::manager = nullptr;
+
+TEST_F(QueryEngineManagerTest, ReusesEngineUntilModified) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineManager manager;
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * engine,
+                           manager.GetPopulated<TernaryQueryEngine>(f));
+  EXPECT_TRUE(engine->IsTracked(y.node()));
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * same_engine,
+                           manager.GetPopulated<TernaryQueryEngine>(f));
+  EXPECT_EQ(engine, same_engine);
+  EXPECT_EQ(manager.hit_count(), 1);
+  EXPECT_EQ(manager.size(), 1);
+
+  // Adding a node modifies the function so the engine is repopulated and
+  // tracks the new node.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * z, f->MakeNode<UnOp>(SourceInfo(), y.node(), Op::kNot));
+  XLS_ASSERT_OK(f->set_return_value(z));
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * new_engine,
+                           manager.GetPopulated<TernaryQueryEngine>(f));
+  EXPECT_TRUE(new_engine->IsTracked(z));
+  EXPECT_EQ(manager.hit_count(), 1);
+  EXPECT_EQ(manager.size(), 1);
+}
+
+TEST_F(QueryEngineManagerTest, DuplicateRegistrationIsAnError) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // The inner request registers an engine which the outer request must not
+  // replace as its caller may still be using it.
+  QueryEngineManager manager;
+  ReentrantQueryEngine::manager = &manager;
+  EXPECT_THAT(manager.GetPopulated<ReentrantQueryEngine>(f),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("already registered")));
+  EXPECT_EQ(manager.size(), 1);
+  XLS_EXPECT_OK(manager.GetPopulated<ReentrantQueryEngine>(f).status());
+  EXPECT_EQ(manager.hit_count(), 1);
+}
+
+TEST_F(QueryEngineManagerTest, PruneDropsRemovedFunctionBases) {
+  auto p = CreatePackage();
+  std::vector<Function*> functions;
+  for (int i = 0; i < 2; ++i) {
+    FunctionBuilder fb(absl::StrCat(TestName(), i), p.get());
+    fb.Not(fb.Param("x", p->GetBitsType(8)));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+    functions.push_back(f);
+  }
+
+  QueryEngineManager manager;
+  for (Function* f : functions) {
+    XLS_ASSERT_OK(manager.GetPopulated<TernaryQueryEngine>(f).status());
+  }
+  EXPECT_EQ(manager.size(), 2);
+  manager.Prune({functions[0]});
+  EXPECT_EQ(manager.size(), 1);
+  manager.Invalidate(functions[0]);
+  EXPECT_EQ(manager.size(), 0);
+}
+
+TEST_F(QueryEngineManagerTest, UnsharedEnginesAreOwnedByCaller) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::vector<std::unique_ptr<QueryEngine>> owned;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TernaryQueryEngine * engine,
+      GetPopulatedQueryEngine<TernaryQueryEngine>(f, /*manager=*/nullptr,
+                                                  owned));
+  ASSERT_EQ(owned.size(), 1);
+  EXPECT_EQ(owned.front().get(), engine);
+  EXPECT_TRUE(engine->IsTracked(f->return_value()));
+
+  QueryEngineManager manager;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TernaryQueryEngine * shared_engine,
+      GetPopulatedQueryEngine<TernaryQueryEngine>(f, &manager, owned));
+  EXPECT_EQ(owned.size(), 1);
+  EXPECT_EQ(manager.size(), 1);
+  EXPECT_TRUE(shared_engine->IsTracked(f->return_value()));
+}
+
+}  // namespace
+}  // namespace xls
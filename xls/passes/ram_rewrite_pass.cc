@@ -18,19 +18,25 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
 #include <optional>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
@@ -39,7 +45,9 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/op.h"
 #include "xls/ir/proc_instantiation.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -47,6 +55,10 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/stateless_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+#include "xls/passes/union_query_engine.h"
 
 namespace xls {
 namespace {
@@ -302,13 +314,13 @@ absl::StatusOr<std::array<Node*, N>> ExtractTupleElements(
 }
 
 // Returns a mapping from logical names to channels for a new ram with config
-// ram_config.
+// ram_config. Channel names are prefixed with `name_prefix`.
 //
 // If a model builder is supplied, invoke it and add the result to the current
 // package. If a model builder is not supplied, call MakeChannels() to directly
 // create bare channels for the given config.
 absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
-    Package* p, const RamMetadata& metadata) {
+    Package* p, const RamMetadata& metadata, std::string_view name_prefix) {
   RamChannelMap channels;
 
   int64_t addr_width = metadata.rewrite.to_config.addr_width();
@@ -328,7 +340,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
           channels[RamLogicalChannel::kAbstractReadReq],
           CreateRamChannel(
               RamLogicalChannel::kAbstractReadReq, p, metadata,
-              absl::StrCat(metadata.rewrite.to_name_prefix, "_read_req"),
+              absl::StrCat(name_prefix, "_read_req"),
               read_req_type,
               /*initial_values=*/{},
               /*fifo_config=*/
@@ -342,7 +354,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
           channels[RamLogicalChannel::kAbstractReadResp],
           CreateRamChannel(
               RamLogicalChannel::kAbstractReadResp, p, metadata,
-              absl::StrCat(metadata.rewrite.to_name_prefix, "_read_resp"),
+              absl::StrCat(name_prefix, "_read_resp"),
               read_resp_type,
               /*initial_values=*/{},
               /*fifo_config=*/
@@ -355,7 +367,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
           channels[RamLogicalChannel::kAbstractWriteReq],
           CreateRamChannel(
               RamLogicalChannel::kAbstractWriteReq, p, metadata,
-              absl::StrCat(metadata.rewrite.to_name_prefix, "_write_req"),
+              absl::StrCat(name_prefix, "_write_req"),
               write_req_type,
               /*initial_values=*/{},
               /*fifo_config=*/
@@ -367,8 +379,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
       XLS_ASSIGN_OR_RETURN(
           channels[RamLogicalChannel::kWriteCompletion],
           CreateRamChannel(RamLogicalChannel::kWriteCompletion, p, metadata,
-                           absl::StrCat(metadata.rewrite.to_name_prefix,
-                                        "_write_completion"),
+                           absl::StrCat(name_prefix, "_write_completion"),
                            p->GetTupleType({}),
                            /*initial_values=*/{},
                            /*fifo_config=*/
@@ -391,7 +402,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
           channels[RamLogicalChannel::k1RWReq],
           CreateRamChannel(
               RamLogicalChannel::k1RWReq, p, metadata,
-              absl::StrCat(metadata.rewrite.to_name_prefix, "_req"), req_type,
+              absl::StrCat(name_prefix, "_req"), req_type,
               /*initial_values=*/{},
               /*fifo_config=*/
               FifoConfig(/*depth=*/0, /*bypass=*/true,
@@ -403,7 +414,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
           channels[RamLogicalChannel::k1RWResp],
           CreateRamChannel(
               RamLogicalChannel::k1RWResp, p, metadata,
-              absl::StrCat(metadata.rewrite.to_name_prefix, "_resp"), resp_type,
+              absl::StrCat(name_prefix, "_resp"), resp_type,
               /*initial_values=*/{},
               /*fifo_config=*/
               FifoConfig(/*depth=*/0, /*bypass=*/true,
@@ -415,8 +426,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
       XLS_ASSIGN_OR_RETURN(
           channels[RamLogicalChannel::kWriteCompletion],
           CreateRamChannel(RamLogicalChannel::kWriteCompletion, p, metadata,
-                           absl::StrCat(metadata.rewrite.to_name_prefix,
-                                        "_write_completion"),
+                           absl::StrCat(name_prefix, "_write_completion"),
                            empty_tuple_type,
                            /*initial_values=*/{},
                            /*fifo_config=*/
@@ -438,7 +448,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
           channels[RamLogicalChannel::k1R1WReadReq],
           CreateRamChannel(
               RamLogicalChannel::k1R1WReadReq, p, metadata,
-              absl::StrCat(metadata.rewrite.to_name_prefix, "_read_req"),
+              absl::StrCat(name_prefix, "_read_req"),
               read_req_type,
               /*initial_values=*/{},
               /*fifo_config=*/
@@ -451,7 +461,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
           channels[RamLogicalChannel::k1R1WReadResp],
           CreateRamChannel(
               RamLogicalChannel::k1R1WReadResp, p, metadata,
-              absl::StrCat(metadata.rewrite.to_name_prefix, "_read_resp"),
+              absl::StrCat(name_prefix, "_read_resp"),
               read_resp_type,
               /*initial_values=*/{},
               /*fifo_config=*/
@@ -464,7 +474,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
           channels[RamLogicalChannel::k1R1WWriteReq],
           CreateRamChannel(
               RamLogicalChannel::k1R1WWriteReq, p, metadata,
-              absl::StrCat(metadata.rewrite.to_name_prefix, "_write_req"),
+              absl::StrCat(name_prefix, "_write_req"),
               write_req_type,
               /*initial_values=*/{},
               /*fifo_config=*/
@@ -476,8 +486,7 @@ absl::StatusOr<RamChannelMap> CreateChannelsForNewRam(
       XLS_ASSIGN_OR_RETURN(
           channels[RamLogicalChannel::kWriteCompletion],
           CreateRamChannel(RamLogicalChannel::kWriteCompletion, p, metadata,
-                           absl::StrCat(metadata.rewrite.to_name_prefix,
-                                        "_write_completion"),
+                           absl::StrCat(name_prefix, "_write_completion"),
                            empty_tuple_type,
                            /*initial_values=*/{},
                            /*fifo_config=*/
@@ -759,6 +768,27 @@ absl::Status ReplaceReceive(Proc* proc, Receive* old_receive,
   return absl::OkStatus();
 }
 
+// Mapping from channel -> logical name. Used for figuring out what kind of
+// channel each send/recv is operating on.
+using ReverseRamChannelMap =
+    absl::flat_hash_map<ChannelRef, RamLogicalChannel>;
+
+absl::StatusOr<ReverseRamChannelMap> ReverseChannelMap(
+    const RamMetadata& metadata) {
+  ReverseRamChannelMap reverse_mapping;
+  for (auto& [logical_channel, ram_channel] : metadata.channel_map) {
+    if (auto [it, inserted] = reverse_mapping.try_emplace(
+            ram_channel.channel_ref, logical_channel);
+        !inserted) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Channel mapping must be one-to-one, got multiple "
+                          "names for channel %s.",
+                          ChannelRefName(ram_channel.channel_ref)));
+    }
+  }
+  return reverse_mapping;
+}
+
 // Replace sends and receives on old channels with sends and receives on new
 // channels. This involves:
 // 1. Repacking the inputs to sends.
@@ -774,19 +804,8 @@ absl::Status ReplaceReceive(Proc* proc, Receive* old_receive,
 // have been replaced.
 absl::Status ReplaceChannelReferences(Package* p, const RamMetadata& metadata,
                                       const RamChannelMap& to_mapping) {
-  // Make a reverse mapping from channel -> logical name.
-  // Used for figuring out what kind of channel each send/recv is operating on.
-  absl::flat_hash_map<ChannelRef, RamLogicalChannel> reverse_from_mapping;
-  for (auto& [logical_channel, ram_channel] : metadata.channel_map) {
-    if (auto [it, inserted] = reverse_from_mapping.try_emplace(
-            ram_channel.channel_ref, logical_channel);
-        !inserted) {
-      return absl::InvalidArgumentError(
-          absl::StrFormat("Channel mapping must be one-to-one, got multiple "
-                          "names for channel %s.",
-                          ChannelRefName(ram_channel.channel_ref)));
-    }
-  }
+  XLS_ASSIGN_OR_RETURN(ReverseRamChannelMap reverse_from_mapping,
+                       ReverseChannelMap(metadata));
 
   auto handle_send = [&](Send* send,
                          std::optional<Proc*> proc_scope) -> absl::Status {
@@ -866,6 +885,402 @@ absl::Status ReplaceChannelReferences(Package* p, const RamMetadata& metadata,
   return absl::OkStatus();
 }
 
+// Address decoding of an access to a banked RAM.
+struct BankedRequest {
+  // bits[log2(bank_count)] index of the bank the request is sent to.
+  Node* bank;
+  // If the bank was determined statically, its index. Otherwise the request is
+  // sent to every bank, predicated on `bank_selects`.
+  std::optional<int64_t> static_bank;
+  // For dynamically selected banks, `bank == i` for each bank i.
+  std::vector<Node*> bank_selects;
+  // The sends replacing the original request.
+  std::vector<Node*> sends;
+};
+
+// Describes which address bits of a banked RAM select the bank and which form
+// the address within the bank.
+struct BankedAddressLayout {
+  int64_t bank_start;
+  int64_t bank_width;
+  int64_t local_start;
+  int64_t local_width;
+};
+
+absl::StatusOr<BankedAddressLayout> GetBankedAddressLayout(
+    const RamRewrite& rewrite) {
+  XLS_RET_CHECK(rewrite.banking.has_value());
+  const RamBanking& banking = rewrite.banking.value();
+  if (rewrite.from_config.kind != RamKind::kAbstract) {
+    return absl::UnimplementedError(
+        absl::StrFormat("Banking is only supported for abstract RAMs, got %s.",
+                        RamKindToString(rewrite.from_config.kind)));
+  }
+  if (!IsPowerOfTwo(static_cast<uint64_t>(banking.bank_count)) ||
+      rewrite.to_config.depth < 1 ||
+      !IsPowerOfTwo(static_cast<uint64_t>(rewrite.to_config.depth))) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Banked RAMs must have a power of two bank count and bank depth, got "
+        "%d banks of depth %d.",
+        banking.bank_count, rewrite.to_config.depth));
+  }
+  if (rewrite.from_config.depth !=
+      banking.bank_count * rewrite.to_config.depth) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "RAM of depth %d cannot be split into %d banks of depth %d.",
+        rewrite.from_config.depth, banking.bank_count,
+        rewrite.to_config.depth));
+  }
+  int64_t bank_width = CeilOfLog2(static_cast<uint64_t>(banking.bank_count));
+  int64_t local_width = rewrite.to_config.addr_width();
+  switch (banking.kind) {
+    case RamBankingKind::kCyclic:
+      return BankedAddressLayout{.bank_start = 0,
+                                 .bank_width = bank_width,
+                                 .local_start = bank_width,
+                                 .local_width = local_width};
+    case RamBankingKind::kBlock:
+      return BankedAddressLayout{.bank_start = local_width,
+                                 .bank_width = bank_width,
+                                 .local_start = 0,
+                                 .local_width = local_width};
+  }
+}
+
+// Returns the bank targeted by `send` if the query engine can prove it.
+std::optional<int64_t> StaticBank(const QueryEngine& query_engine, Send* send,
+                                  const BankedAddressLayout& layout) {
+  int64_t bank = 0;
+  for (int64_t i = 0; i < layout.bank_width; ++i) {
+    // The address is the first element of every request.
+    std::optional<bool> bit = query_engine.KnownValue(
+        TreeBitLocation(send->data(), layout.bank_start + i, {0}));
+    if (!bit.has_value()) {
+      return std::nullopt;
+    }
+    bank |= static_cast<int64_t>(*bit) << i;
+  }
+  return bank;
+}
+
+absl::StatusOr<Node*> AndWithPredicate(Proc* proc, const SourceInfo& loc,
+                                       std::optional<Node*> predicate,
+                                       Node* condition) {
+  if (!predicate.has_value()) {
+    return condition;
+  }
+  return proc->MakeNode<NaryOp>(
+      loc, std::vector<Node*>{predicate.value(), condition}, Op::kAnd);
+}
+
+// Replaces a request to a banked RAM with sends to the bank(s) it may target.
+// The address is split into a bank index and a bank-local address; if the bank
+// is not known statically one predicated send is made per bank.
+absl::StatusOr<BankedRequest> ReplaceBankedSend(
+    Proc* proc, Send* old_send, RamLogicalChannel logical_channel,
+    const RamMetadata& metadata, const BankedAddressLayout& layout,
+    absl::Span<const RamChannelMap> banks, std::optional<int64_t> static_bank) {
+  const RamRewrite& rewrite = metadata.rewrite;
+  XLS_ASSIGN_OR_RETURN(RamLogicalChannel new_logical_channel,
+                       MapChannel(rewrite.from_config.kind, logical_channel,
+                                  rewrite.to_config.kind));
+  Node* data = old_send->data();
+  if (!data->GetType()->IsTuple() ||
+      data->GetType()->AsTupleOrDie()->size() == 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected %s to be a tuple starting with an address, got type %s.",
+        data->ToString(), data->GetType()->ToString()));
+  }
+  std::vector<Node*> elements;
+  for (int64_t i = 0; i < data->GetType()->AsTupleOrDie()->size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Node * element,
+                         proc->MakeNode<TupleIndex>(data->loc(), data, i));
+    elements.push_back(element);
+  }
+  Node* addr = elements.front();
+  int64_t addr_width = rewrite.from_config.addr_width();
+  if (!addr->GetType()->IsBits() ||
+      addr->GetType()->GetFlatBitCount() != addr_width) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected address of %s to have type bits[%d], got %s.",
+        old_send->ToString(), addr_width, addr->GetType()->ToString()));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      elements.front(),
+      proc->MakeNode<BitSlice>(addr->loc(), addr, layout.local_start,
+                               layout.local_width));
+  XLS_ASSIGN_OR_RETURN(Node * local_payload,
+                       proc->MakeNode<Tuple>(data->loc(), elements));
+
+  // Within a bank, the request looks like one to a RAM with the bank's depth.
+  RamConfig bank_from_config = rewrite.from_config;
+  bank_from_config.depth = rewrite.to_config.depth;
+  XLS_ASSIGN_OR_RETURN(
+      Node * payload,
+      RepackPayload(proc, local_payload, logical_channel, bank_from_config,
+                    rewrite.to_config, metadata.data_type));
+
+  BankedRequest request{.static_bank = static_bank};
+  if (static_bank.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        request.bank,
+        proc->MakeNode<Literal>(
+            addr->loc(), Value(UBits(*static_bank, layout.bank_width))));
+    XLS_ASSIGN_OR_RETURN(
+        Node * send,
+        proc->MakeNode<Send>(
+            old_send->loc(), old_send->token(), payload,
+            old_send->predicate(),
+            ChannelRefName(
+                banks[*static_bank].at(new_logical_channel).channel_ref)));
+    request.sends.push_back(send);
+    XLS_RETURN_IF_ERROR(old_send->ReplaceUsesWith(send));
+  } else {
+    XLS_ASSIGN_OR_RETURN(request.bank,
+                         proc->MakeNode<BitSlice>(addr->loc(), addr,
+                                                  layout.bank_start,
+                                                  layout.bank_width));
+    for (int64_t bank = 0; bank < banks.size(); ++bank) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * bank_index,
+          proc->MakeNode<Literal>(addr->loc(),
+                                  Value(UBits(bank, layout.bank_width))));
+      XLS_ASSIGN_OR_RETURN(Node * bank_select,
+                           proc->MakeNode<CompareOp>(addr->loc(), request.bank,
+                                                     bank_index, Op::kEq));
+      request.bank_selects.push_back(bank_select);
+      XLS_ASSIGN_OR_RETURN(
+          Node * predicate,
+          AndWithPredicate(proc, old_send->loc(), old_send->predicate(),
+                           bank_select));
+      XLS_ASSIGN_OR_RETURN(
+          Node * send,
+          proc->MakeNode<Send>(
+              old_send->loc(), old_send->token(), payload, predicate,
+              ChannelRefName(banks[bank].at(new_logical_channel).channel_ref)));
+      request.sends.push_back(send);
+    }
+    XLS_RETURN_IF_ERROR(
+        old_send->ReplaceUsesWithNew<AfterAll>(request.sends).status());
+  }
+  XLS_RETURN_IF_ERROR(proc->RemoveNode(old_send));
+  return request;
+}
+
+// Replaces a response from a banked RAM with a receive from the bank its
+// request went to. If that bank is only known at runtime, one predicated
+// receive is made per bank and the results are muxed by the bank index.
+absl::Status ReplaceBankedReceive(Proc* proc, Receive* old_receive,
+                                  RamLogicalChannel logical_channel,
+                                  const RamMetadata& metadata,
+                                  absl::Span<const RamChannelMap> banks,
+                                  const BankedRequest& request) {
+  const RamRewrite& rewrite = metadata.rewrite;
+  XLS_ASSIGN_OR_RETURN(RamLogicalChannel new_logical_channel,
+                       MapChannel(rewrite.from_config.kind, logical_channel,
+                                  rewrite.to_config.kind));
+  Node* result;
+  if (request.static_bank.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        result,
+        proc->MakeNode<Receive>(
+            old_receive->loc(), old_receive->token(), old_receive->predicate(),
+            ChannelRefName(banks[*request.static_bank]
+                               .at(new_logical_channel)
+                               .channel_ref),
+            old_receive->is_blocking()));
+  } else {
+    std::vector<Node*> receives;
+    for (int64_t bank = 0; bank < banks.size(); ++bank) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * predicate,
+          AndWithPredicate(proc, old_receive->loc(), old_receive->predicate(),
+                           request.bank_selects[bank]));
+      XLS_ASSIGN_OR_RETURN(
+          Node * receive,
+          proc->MakeNode<Receive>(
+              old_receive->loc(), old_receive->token(), predicate,
+              ChannelRefName(banks[bank].at(new_logical_channel).channel_ref),
+              old_receive->is_blocking()));
+      receives.push_back(receive);
+    }
+    // Receives whose predicate is false produce zeros, so muxing by the bank
+    // index picks the one that actually fired.
+    std::vector<Node*> elements;
+    XLS_ASSIGN_OR_RETURN(
+        elements.emplace_back(),
+        proc->MakeNode<AfterAll>(old_receive->loc(), receives));
+    int64_t element_count = old_receive->GetType()->AsTupleOrDie()->size();
+    for (int64_t i = 1; i < element_count; ++i) {
+      std::vector<Node*> cases;
+      for (Node* receive : receives) {
+        XLS_ASSIGN_OR_RETURN(
+            cases.emplace_back(),
+            proc->MakeNode<TupleIndex>(old_receive->loc(), receive, i));
+      }
+      XLS_ASSIGN_OR_RETURN(
+          elements.emplace_back(),
+          proc->MakeNode<Select>(old_receive->loc(), request.bank, cases,
+                                 /*default_value=*/std::nullopt));
+    }
+    XLS_ASSIGN_OR_RETURN(result,
+                         proc->MakeNode<Tuple>(old_receive->loc(), elements));
+  }
+  RamConfig bank_from_config = rewrite.from_config;
+  bank_from_config.depth = rewrite.to_config.depth;
+  XLS_ASSIGN_OR_RETURN(Node * new_return_value,
+                       RepackPayload(proc, result, logical_channel,
+                                     bank_from_config, rewrite.to_config,
+                                     metadata.data_type));
+  XLS_RETURN_IF_ERROR(old_receive->ReplaceUsesWith(new_return_value));
+  return proc->RemoveNode(old_receive);
+}
+
+// Returns the logical channel carrying the responses to requests on
+// `logical_channel`, or nullopt if it is not a request channel.
+std::optional<RamLogicalChannel> ResponseChannel(
+    RamLogicalChannel logical_channel) {
+  switch (logical_channel) {
+    case RamLogicalChannel::kAbstractReadReq:
+      return RamLogicalChannel::kAbstractReadResp;
+    case RamLogicalChannel::kAbstractWriteReq:
+      return RamLogicalChannel::kWriteCompletion;
+    default:
+      return std::nullopt;
+  }
+}
+
+// Returns true if `node` transitively depends on `target`.
+bool DependsOn(Node* node, Node* target) {
+  absl::flat_hash_set<Node*> visited;
+  std::vector<Node*> worklist = {node};
+  while (!worklist.empty()) {
+    Node* current = worklist.back();
+    worklist.pop_back();
+    if (current == target) {
+      return true;
+    }
+    if (!visited.insert(current).second) {
+      continue;
+    }
+    absl::c_copy(current->operands(), std::back_inserter(worklist));
+  }
+  return false;
+}
+
+// Returns the logical channel `node` operates on, or nullopt if it is not a
+// channel of the RAM being rewritten.
+absl::StatusOr<std::optional<RamLogicalChannel>> GetLogicalChannel(
+    ChannelNode* node, std::optional<Proc*> proc_scope,
+    const ReverseRamChannelMap& reverse_mapping) {
+  XLS_ASSIGN_OR_RETURN(
+      ChannelRef channel,
+      GetChannelRef(node->package(), node->channel_name(),
+                    node->Is<Send>() ? Direction::kSend : Direction::kReceive,
+                    proc_scope));
+  auto it = reverse_mapping.find(channel);
+  if (it == reverse_mapping.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+// Like ReplaceChannelReferences() but for a RAM split into `banks`.
+//
+// Requests are sent to the bank selected by their address (see
+// RamBankingKind). Where the ternary query engine can prove which bank a
+// request targets the request is sent to that bank alone, so requests to
+// different banks no longer compete for the same channel. Otherwise bank-select
+// logic is generated and the request is sent to each bank predicated on the
+// decoded bank index.
+//
+// Responses are paired with requests in order: the n-th receive of read
+// responses (write completions) in a proc activation answers the n-th read
+// (write) request of that activation, and must be token-ordered after it.
+absl::Status ReplaceBankedChannelReferences(
+    Package* p, const RamMetadata& metadata,
+    absl::Span<const RamChannelMap> banks) {
+  XLS_ASSIGN_OR_RETURN(ReverseRamChannelMap reverse_from_mapping,
+                       ReverseChannelMap(metadata));
+  XLS_ASSIGN_OR_RETURN(BankedAddressLayout layout,
+                       GetBankedAddressLayout(metadata.rewrite));
+
+  auto handle_proc = [&](Proc* proc,
+                         std::optional<Proc*> proc_scope) -> absl::Status {
+    std::vector<Node*> nodes = TopoSort(proc);
+
+    // Resolve banks before modifying the proc so the analysis stays valid.
+    std::vector<std::unique_ptr<QueryEngine>> query_engines;
+    query_engines.push_back(std::make_unique<StatelessQueryEngine>());
+    query_engines.push_back(std::make_unique<TernaryQueryEngine>());
+    UnionQueryEngine query_engine(std::move(query_engines));
+    XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
+    absl::flat_hash_map<Send*, std::optional<int64_t>> static_banks;
+    for (Node* node : nodes) {
+      if (node->Is<Send>()) {
+        static_banks[node->As<Send>()] =
+            StaticBank(query_engine, node->As<Send>(), layout);
+      }
+    }
+
+    // Requests still waiting for their response, by response channel.
+    absl::flat_hash_map<RamLogicalChannel, std::deque<BankedRequest>> pending;
+    for (Node* node : nodes) {
+      if (node->Is<Send>()) {
+        Send* send = node->As<Send>();
+        XLS_ASSIGN_OR_RETURN(
+            std::optional<RamLogicalChannel> logical_channel,
+            GetLogicalChannel(send, proc_scope, reverse_from_mapping));
+        if (!logical_channel.has_value()) {
+          continue;
+        }
+        XLS_ASSIGN_OR_RETURN(
+            BankedRequest request,
+            ReplaceBankedSend(proc, send, *logical_channel, metadata, layout,
+                              banks, static_banks.at(send)));
+        std::optional<RamLogicalChannel> response_channel =
+            ResponseChannel(*logical_channel);
+        XLS_RET_CHECK(response_channel.has_value());
+        pending[*response_channel].push_back(std::move(request));
+      } else if (node->Is<Receive>()) {
+        Receive* receive = node->As<Receive>();
+        XLS_ASSIGN_OR_RETURN(
+            std::optional<RamLogicalChannel> logical_channel,
+            GetLogicalChannel(receive, proc_scope, reverse_from_mapping));
+        if (!logical_channel.has_value()) {
+          continue;
+        }
+        std::deque<BankedRequest>& requests = pending[*logical_channel];
+        if (requests.empty() ||
+            !absl::c_any_of(requests.front().sends, [&](Node* send) {
+              return DependsOn(receive->token(), send);
+            })) {
+          return absl::UnimplementedError(absl::StrFormat(
+              "Cannot determine the bank of %s: responses from a banked RAM "
+              "must be token-ordered after their request in the same "
+              "activation.",
+              receive->ToString()));
+        }
+        XLS_RETURN_IF_ERROR(ReplaceBankedReceive(proc, receive,
+                                                 *logical_channel, metadata,
+                                                 banks, requests.front()));
+        requests.pop_front();
+      }
+    }
+    return absl::OkStatus();
+  };
+
+  if (metadata.proc_scope.has_value()) {
+    XLS_RET_CHECK(p->ChannelsAreProcScoped());
+    return handle_proc(metadata.proc_scope.value(), metadata.proc_scope);
+  }
+  XLS_RET_CHECK(!p->ChannelsAreProcScoped());
+  for (auto& proc : p->procs()) {
+    XLS_RETURN_IF_ERROR(handle_proc(proc.get(), /*proc_scope=*/std::nullopt));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status RemoveRamChannel(Package* p, const RamChannel& ram_channel,
                               std::optional<Proc*> proc_scope) {
   if (proc_scope.has_value()) {
@@ -978,11 +1393,24 @@ absl::StatusOr<bool> RamRewritePass::RunInternal(
     XLS_ASSIGN_OR_RETURN(RamMetadata metadata,
                          GetRamMetadata(p, proc_scope, rewrite));
 
-    RamChannelMap new_logical_to_channels;
-    XLS_ASSIGN_OR_RETURN(new_logical_to_channels,
-                         CreateChannelsForNewRam(p, metadata));
-    XLS_RETURN_IF_ERROR(
-        ReplaceChannelReferences(p, metadata, new_logical_to_channels));
+    if (rewrite.banking.has_value() && rewrite.banking->bank_count > 1) {
+      std::vector<RamChannelMap> banks;
+      for (int64_t bank = 0; bank < rewrite.banking->bank_count; ++bank) {
+        XLS_ASSIGN_OR_RETURN(
+            banks.emplace_back(),
+            CreateChannelsForNewRam(
+                p, metadata,
+                absl::StrCat(rewrite.to_name_prefix, "_bank", bank)));
+      }
+      XLS_RETURN_IF_ERROR(ReplaceBankedChannelReferences(p, metadata, banks));
+    } else {
+      RamChannelMap new_logical_to_channels;
+      XLS_ASSIGN_OR_RETURN(
+          new_logical_to_channels,
+          CreateChannelsForNewRam(p, metadata, rewrite.to_name_prefix));
+      XLS_RETURN_IF_ERROR(
+          ReplaceChannelReferences(p, metadata, new_logical_to_channels));
+    }
 
     // ReplaceChannelReferences() removes old sends and receives, but the old
     // channels are still there.
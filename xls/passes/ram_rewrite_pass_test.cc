@@ -23,6 +23,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
@@ -38,7 +39,10 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
@@ -50,6 +54,8 @@ namespace {
 namespace m = xls::op_matchers;
 using ::absl_testing::IsOkAndHolds;
 using ::absl_testing::StatusIs;
+using ::testing::_;
+using ::testing::Contains;
 using ::testing::HasSubstr;
 
 class RamRewritePassTest : public IrTestBase {
@@ -897,5 +903,182 @@ TEST_F(RamRewritePassTest, SingleAbstractTo1R1WRewriteProcScoped) {
               IsOkAndHolds(m::ChannelWithType("()")));
 }
 
+int64_t SendCount(Proc* proc, std::string_view channel_name) {
+  return absl::c_count_if(proc->nodes(), [&](Node* node) {
+    return node->Is<Send>() && node->As<Send>()->channel_name() == channel_name;
+  });
+}
+
+int64_t ReceiveCount(Proc* proc, std::string_view channel_name) {
+  return absl::c_count_if(proc->nodes(), [&](Node* node) {
+    return node->Is<Receive>() &&
+           node->As<Receive>()->channel_name() == channel_name;
+  });
+}
+
+TEST_F(RamRewritePassTest, BankedAbstractTo1R1WWithStaticBanks) {
+  auto p = std::make_unique<Package>(TestName());
+  auto pb = MakeProcBuilder(p.get(), "p");
+  RamConfig config_abstract{.kind = RamKind::kAbstract,
+                            .depth = 1024,
+                            .word_partition_size = std::nullopt,
+                            .initial_value = std::nullopt};
+  RamConfig config_bank = config_abstract;
+  config_bank.kind = RamKind::k1R1W;
+  config_bank.depth = 512;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      RamChannels channels,
+      MakeAbstractRam(p.get(), config_abstract, "ram_abstract",
+                      /*data_type=*/p->GetBitsType(32)));
+
+  // With cyclic banking, odd addresses live in bank 1 and even ones in bank 0.
+  pb->Send(channels.read_req,
+           pb->Literal(Value::Tuple({Value(UBits(5, 10)), Value::Tuple({})})));
+  pb->Receive(channels.read_resp);
+  pb->Send(channels.write_req,
+           pb->Literal(Value::Tuple(
+               {Value(UBits(6, 10)), Value(UBits(0, 32)), Value::Tuple({})})));
+  pb->Receive(channels.write_resp);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb->Build({}));
+  XLS_ASSERT_OK(p->SetTopByName("p"));
+
+  std::vector<RamRewrite> ram_rewrites{RamRewrite{
+      .from_config = config_abstract,
+      .from_channels_logical_to_physical =
+          absl::flat_hash_map<std::string, std::string>{
+              {"abstract_read_req", "ram_abstract_read_req"},
+              {"abstract_read_resp", "ram_abstract_read_resp"},
+              {"abstract_write_req", "ram_abstract_write_req"},
+              {"write_completion", "ram_abstract_write_resp"},
+          },
+      .to_config = config_bank,
+      .to_name_prefix = "ram",
+      .proc_name = std::nullopt,
+      .banking = RamBanking{.kind = RamBankingKind::kCyclic, .bank_count = 2},
+  }};
+  EXPECT_THAT(Run(p.get(), ram_rewrites), IsOkAndHolds(true));
+  EXPECT_EQ(p->channels().size(), 8);
+  for (std::string_view bank : {"ram_bank0", "ram_bank1"}) {
+    EXPECT_THAT(p->GetChannel(absl::StrCat(bank, "_read_req")).value(),
+                m::ChannelWithType("(bits[9], ())"));
+    EXPECT_THAT(p->GetChannel(absl::StrCat(bank, "_read_resp")).value(),
+                m::ChannelWithType("(bits[32])"));
+    EXPECT_THAT(p->GetChannel(absl::StrCat(bank, "_write_req")).value(),
+                m::ChannelWithType("(bits[9], bits[32], ())"));
+  }
+  EXPECT_EQ(SendCount(proc, "ram_bank0_read_req"), 0);
+  EXPECT_EQ(SendCount(proc, "ram_bank1_read_req"), 1);
+  EXPECT_EQ(ReceiveCount(proc, "ram_bank0_read_resp"), 0);
+  EXPECT_EQ(ReceiveCount(proc, "ram_bank1_read_resp"), 1);
+  EXPECT_EQ(SendCount(proc, "ram_bank0_write_req"), 1);
+  EXPECT_EQ(SendCount(proc, "ram_bank1_write_req"), 0);
+  EXPECT_EQ(ReceiveCount(proc, "ram_bank0_write_completion"), 1);
+  EXPECT_EQ(ReceiveCount(proc, "ram_bank1_write_completion"), 0);
+  // Address 5 is the third word of bank 1.
+  EXPECT_THAT(proc->nodes(),
+              Contains(m::Send(
+                  _,
+                  m::Literal(Value::Tuple({Value(UBits(2, 9)),
+                                           Value::Tuple({})})),
+                  m::Channel("ram_bank1_read_req"))));
+}
+
+TEST_F(RamRewritePassTest, BankedAbstractTo1RWWithDynamicBanks) {
+  auto p = std::make_unique<Package>(TestName());
+  auto pb = MakeProcBuilder(p.get(), "p");
+  RamConfig config_abstract{.kind = RamKind::kAbstract,
+                            .depth = 1024,
+                            .word_partition_size = std::nullopt,
+                            .initial_value = std::nullopt};
+  RamConfig config_bank = config_abstract;
+  config_bank.kind = RamKind::k1RW;
+  config_bank.depth = 256;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      RamChannels channels,
+      MakeAbstractRam(p.get(), config_abstract, "ram_abstract",
+                      /*data_type=*/p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * addr_channel,
+      p->CreateStreamingChannel("addr", ChannelOps::kReceiveOnly,
+                                p->GetBitsType(10)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * data_channel,
+      p->CreateStreamingChannel("data", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+
+  BValue addr = pb->Receive(addr_channel);
+  pb->Send(channels.read_req, pb->Tuple({addr, pb->Tuple({})}));
+  BValue read_resp = pb->Receive(channels.read_resp);
+  pb->Send(data_channel, pb->TupleIndex(read_resp, 0));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb->Build({}));
+  XLS_ASSERT_OK(p->SetTopByName("p"));
+
+  std::vector<RamRewrite> ram_rewrites{RamRewrite{
+      .from_config = config_abstract,
+      .from_channels_logical_to_physical =
+          absl::flat_hash_map<std::string, std::string>{
+              {"abstract_read_req", "ram_abstract_read_req"},
+              {"abstract_read_resp", "ram_abstract_read_resp"},
+              {"abstract_write_req", "ram_abstract_write_req"},
+              {"write_completion", "ram_abstract_write_resp"},
+          },
+      .to_config = config_bank,
+      .to_name_prefix = "ram",
+      .proc_name = std::nullopt,
+      .banking = RamBanking{.kind = RamBankingKind::kBlock, .bank_count = 4},
+  }};
+  EXPECT_THAT(Run(p.get(), ram_rewrites), IsOkAndHolds(true));
+  for (int64_t bank = 0; bank < 4; ++bank) {
+    std::string prefix = absl::StrCat("ram_bank", bank);
+    EXPECT_THAT(
+        p->GetChannel(absl::StrCat(prefix, "_req")).value(),
+        m::ChannelWithType("(bits[8], bits[32], (), (), bits[1], bits[1])"));
+    // The address is only known at runtime, so every bank gets a request
+    // predicated on the high address bits.
+    EXPECT_EQ(SendCount(proc, absl::StrCat(prefix, "_req")), 1);
+    EXPECT_EQ(ReceiveCount(proc, absl::StrCat(prefix, "_resp")), 1);
+  }
+  EXPECT_THAT(proc->nodes(),
+              Contains(m::Send(_, _, /*predicate=*/_,
+                               m::Channel("ram_bank3_req"))));
+}
+
+TEST_F(RamRewritePassTest, BankedRewriteWithMismatchedDepth) {
+  auto p = std::make_unique<Package>(TestName());
+  auto pb = MakeProcBuilder(p.get(), "p");
+  RamConfig config_abstract{.kind = RamKind::kAbstract,
+                            .depth = 1024,
+                            .word_partition_size = std::nullopt,
+                            .initial_value = std::nullopt};
+  RamConfig config_bank = config_abstract;
+  config_bank.kind = RamKind::k1RW;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      RamChannels channels,
+      MakeAbstractRam(p.get(), config_abstract, "ram_abstract",
+                      /*data_type=*/p->GetBitsType(32)));
+  pb->Send(channels.read_req,
+           pb->Literal(Value::Tuple({Value(UBits(0, 10)), Value::Tuple({})})));
+  pb->Receive(channels.read_resp);
+  XLS_ASSERT_OK(pb->Build({}).status());
+  XLS_ASSERT_OK(p->SetTopByName("p"));
+
+  std::vector<RamRewrite> ram_rewrites{RamRewrite{
+      .from_config = config_abstract,
+      .from_channels_logical_to_physical =
+          absl::flat_hash_map<std::string, std::string>{
+              {"abstract_read_req", "ram_abstract_read_req"},
+              {"abstract_read_resp", "ram_abstract_read_resp"},
+          },
+      .to_config = config_bank,
+      .to_name_prefix = "ram",
+      .proc_name = std::nullopt,
+      .banking = RamBanking{.kind = RamBankingKind::kCyclic, .bank_count = 2},
+  }};
+  EXPECT_THAT(Run(p.get(), ram_rewrites),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("RAM of depth 1024 cannot be split into 2 "
+                                 "banks of depth 1024")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -318,6 +318,7 @@ void RangeQueryEngine::SetIntervalSetTree(
           lhs = IntervalSet::Intersect(lhs, rhs);
         });
   }
+  WidenIntervalSets(ist);
 
   if (node->GetType()->IsBits()) {
     interval_ops::KnownBits bits =
@@ -340,6 +341,7 @@ void RangeQueryEngine::SetIntervalSetTree(Node* node,
           lhs = IntervalSet::Intersect(lhs, rhs);
         });
   }
+  WidenIntervalSets(ist);
 
   if (node->GetType()->IsBits()) {
     interval_ops::KnownBits bits =
@@ -349,6 +351,16 @@ void RangeQueryEngine::SetIntervalSetTree(Node* node,
   }
 }
 
+void RangeQueryEngine::WidenIntervalSets(
+    MutableIntervalSetTreeView interval_sets) const {
+  for (IntervalSet& set : interval_sets.elements()) {
+    if (set.NumberOfIntervals() > max_interval_set_size_) {
+      set = interval_ops::MinimizeIntervals(std::move(set),
+                                            max_interval_set_size_);
+    }
+  }
+}
+
 void RangeQueryEngine::InitializeNode(Node* node) {
   if (!known_bits_.contains(node) || !known_bit_values_.contains(node)) {
     known_bits_[node] = Bits(node->GetType()->GetFlatBitCount());
@@ -603,12 +615,11 @@ absl::Status RangeQueryVisitor::HandleInvoke(Invoke* invoke) {
 
 absl::Status RangeQueryVisitor::HandleLiteral(Literal* literal) {
   INITIALIZE_OR_SKIP(literal);
-  XLS_ASSIGN_OR_RETURN(
-      LeafTypeTree<Value> v_ltt,
-      ValueToLeafTypeTree(literal->value(), literal->GetType()));
+  XLS_ASSIGN_OR_RETURN(std::shared_ptr<const LeafTypeTree<Value>> v_ltt,
+                       literal->GetValueTree());
   SetIntervalSetTree(literal,
                      leaf_type_tree::Map<IntervalSet, Value>(
-                         v_ltt.AsView(), [](const Value& value) {
+                         v_ltt->AsView(), [](const Value& value) {
                            IntervalSet interval_set(value.GetFlatBitCount());
                            if (value.IsBits()) {
                              return IntervalSet::Precise(value.bits());
@@ -21,7 +21,6 @@
 #include <string>
 #include <utility>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -33,6 +32,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/interval_set.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/type.h"
 #include "xls/passes/query_engine.h"
@@ -102,8 +102,19 @@ class NoGivensProvider final : public RangeDataProvider {
 // A query engine which tracks sets of intervals that a value can be in.
 class RangeQueryEngine : public QueryEngine {
  public:
+  // Interval sets with more than this many intervals are widened by merging
+  // their closest intervals, unless another limit is given.
+  static constexpr int64_t kDefaultMaxIntervalSetSize = 64;
+
   // Create a `RangeQueryEngine` that contains no data.
   RangeQueryEngine() = default;
+
+  // Create a `RangeQueryEngine` that contains no data and which widens any
+  // interval set with more than `max_interval_set_size` intervals. Smaller
+  // sets are kept exact. Lower limits bound the cost of the interval
+  // arithmetic on wide multiplies and selects at the cost of precision.
+  explicit RangeQueryEngine(int64_t max_interval_set_size)
+      : max_interval_set_size_(max_interval_set_size) {}
   RangeQueryEngine(RangeQueryEngine&&) = default;
   RangeQueryEngine(const RangeQueryEngine&) = default;
   RangeQueryEngine& operator=(const RangeQueryEngine&) = default;
@@ -112,6 +123,7 @@ class RangeQueryEngine : public QueryEngine {
   // Populate the data in this `RangeQueryEngine` using the
   // given `FunctionBase*`;
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    ScopedQueryEngineTimer timer(f);
     NoGivensProvider givens(f);
     return PopulateWithGivens(givens);
   }
@@ -241,9 +253,14 @@ class RangeQueryEngine : public QueryEngine {
  private:
   friend class RangeQueryVisitor;
 
-  absl::flat_hash_map<Node*, Bits> known_bits_;
-  absl::flat_hash_map<Node*, Bits> known_bit_values_;
-  absl::flat_hash_map<Node*, IntervalSetTree> interval_sets_;
+  // Merges the closest intervals of any set in `interval_sets` with more than
+  // `max_interval_set_size_` intervals.
+  void WidenIntervalSets(MutableIntervalSetTreeView interval_sets) const;
+
+  int64_t max_interval_set_size_ = kDefaultMaxIntervalSetSize;
+  NodeMap<Bits> known_bits_;
+  NodeMap<Bits> known_bit_values_;
+  NodeMap<IntervalSetTree> interval_sets_;
 };
 
 std::string IntervalSetTreeToString(const IntervalSetTree& tree);
@@ -134,6 +134,32 @@ TEST_F(RangeQueryEngineTest, Add) {
             "[[0, 1048575]]");
 }
 
+TEST_F(RangeQueryEngineTest, LargeIntervalSetsWidened) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue s = fb.Param("s", p->GetBitsType(1));
+  BValue expr = fb.Select(s, {x, y});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  RangeQueryEngine engine(/*max_interval_set_size=*/4);
+  engine.SetIntervalSetTree(x.node(),
+                            BitsLTT(x.node(), {{0, 0}, {10, 10}, {20, 20}}));
+  engine.SetIntervalSetTree(
+      y.node(), BitsLTT(y.node(), {{100, 100}, {110, 110}, {200, 200}}));
+  XLS_ASSERT_OK(engine.Populate(f));
+
+  // Small sets are exact.
+  EXPECT_EQ(IntervalSetTreeToString(engine.GetIntervalSetTree(x.node())),
+            "[[0, 0], [10, 10], [20, 20]]");
+  // The six values of the select are merged into four intervals by joining the
+  // closest ones.
+  EXPECT_EQ(IntervalSetTreeToString(engine.GetIntervalSetTree(expr.node())),
+            "[[0, 20], [100, 100], [110, 110], [200, 200]]");
+}
+
 TEST_F(RangeQueryEngineTest, Array) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -0,0 +1,462 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/resource_sharing_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/predicate_dominator_analysis.h"
+#include "xls/passes/predicate_state.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/rewrite_cost_model.h"
+#include "xls/passes/stateless_query_engine.h"
+#include "xls/passes/union_query_engine.h"
+
+namespace xls {
+namespace {
+
+// Returns true if `node` is expensive enough that sharing it between exclusive
+// uses is worth the cost of the operand muxes. Adds and subtracts are
+// excluded: their operand muxes are about as large as the adder itself.
+bool IsShareableOp(Node* node) {
+  if (!node->GetType()->IsBits() || node->operand_count() != 2) {
+    return false;
+  }
+  switch (node->op()) {
+    case Op::kUMul:
+    case Op::kSMul:
+    case Op::kUDiv:
+    case Op::kSDiv:
+    case Op::kUMod:
+    case Op::kSMod:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// An operation all of whose uses are guarded by a single arm of a select.
+struct SharingCandidate {
+  Node* node;
+  Select* guard;
+  PredicateState::ArmT arm;
+};
+
+// Returns true if `a` and `b` can be replaced by a single shared operation,
+// ignoring exclusivity.
+bool HaveSameSignature(Node* a, Node* b) {
+  return a->op() == b->op() && a->GetType() == b->GetType() &&
+         a->operand(0)->GetType() == b->operand(0)->GetType() &&
+         a->operand(1)->GetType() == b->operand(1)->GetType();
+}
+
+// Returns the value of the one-bit selector of `select` for which `arm` is
+// chosen.
+bool SelectorValueForArm(Select* select, PredicateState::ArmT arm) {
+  if (std::holds_alternative<int64_t>(arm)) {
+    return std::get<int64_t>(arm) == 1;
+  }
+  return select->cases().size() == 1;
+}
+
+// Returns true if the guards of `a` and `b` can never both hold.
+bool AreExclusive(const SharingCandidate& a, const SharingCandidate& b,
+                  const QueryEngine& query_engine) {
+  if (a.guard == b.guard) {
+    return a.arm != b.arm;
+  }
+  Node* a_selector = a.guard->selector();
+  Node* b_selector = b.guard->selector();
+  if (a_selector->BitCountOrDie() != 1 || b_selector->BitCountOrDie() != 1) {
+    return false;
+  }
+  TreeBitLocation a_bit(a_selector, 0);
+  TreeBitLocation b_bit(b_selector, 0);
+  bool a_value = SelectorValueForArm(a.guard, a.arm);
+  bool b_value = SelectorValueForArm(b.guard, b.arm);
+  if (a_value && b_value) {
+    return query_engine.AtMostOneTrue({a_bit, b_bit});
+  }
+  if (a_value) {
+    return query_engine.Implies(a_bit, b_bit);
+  }
+  if (b_value) {
+    return query_engine.Implies(b_bit, a_bit);
+  }
+  return query_engine.AtLeastOneTrue({a_bit, b_bit});
+}
+
+// Returns true if any of `roots` transitively depends on a node in `nodes`.
+bool DependsOnAny(absl::Span<Node* const> roots,
+                  const absl::flat_hash_set<Node*>& nodes) {
+  std::vector<Node*> worklist(roots.begin(), roots.end());
+  absl::flat_hash_set<Node*> visited(roots.begin(), roots.end());
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (nodes.contains(node)) {
+      return true;
+    }
+    for (Node* operand : node->operands()) {
+      if (visited.insert(operand).second) {
+        worklist.push_back(operand);
+      }
+    }
+  }
+  return false;
+}
+
+// Estimates node delays with the cost model of the pass options if there is
+// one, and otherwise with the standard delay model.
+class NodeDelays {
+ public:
+  explicit NodeDelays(const RewriteCostModel* cost_model)
+      : cost_model_(cost_model) {}
+
+  int64_t operator()(Node* node) const {
+    absl::StatusOr<int64_t> delay =
+        cost_model_ != nullptr
+            ? cost_model_->GetDelayInPs(node)
+            : GetStandardDelayEstimator().GetOperationDelayInPs(node);
+    // Not every operation has a delay model; treat those as free.
+    return delay.ok() ? *delay : 0;
+  }
+
+ private:
+  const RewriteCostModel* cost_model_;
+};
+
+// Estimated combinational timing of a function.
+struct Timing {
+  // Time at which the output of each node is available.
+  absl::flat_hash_map<Node*, int64_t> arrival;
+  // Longest delay from the output of each node to a sink of the function.
+  absl::flat_hash_map<Node*, int64_t> tail;
+};
+
+Timing ComputeTiming(FunctionBase* f, const NodeDelays& node_delay) {
+  Timing timing;
+  std::vector<Node*> topo_order = TopoSort(f);
+  for (Node* node : topo_order) {
+    int64_t start = 0;
+    for (Node* operand : node->operands()) {
+      start = std::max(start, timing.arrival.at(operand));
+    }
+    timing.arrival[node] = start + node_delay(node);
+  }
+  for (auto it = topo_order.rbegin(); it != topo_order.rend(); ++it) {
+    Node* node = *it;
+    int64_t tail = 0;
+    for (Node* user : node->users()) {
+      tail = std::max(tail, node_delay(user) + timing.tail.at(user));
+    }
+    timing.tail[node] = tail;
+  }
+  return timing;
+}
+
+int64_t CriticalPath(const Timing& timing) {
+  int64_t critical_path = 0;
+  for (const auto& [node, arrival] : timing.arrival) {
+    critical_path = std::max(critical_path, arrival);
+  }
+  return critical_path;
+}
+
+// Builds a one-bit node which is true exactly when `candidate`'s guarding arm
+// is chosen. New nodes are appended to `new_nodes`.
+absl::StatusOr<Node*> MakeGuardCondition(const SharingCandidate& candidate,
+                                         std::vector<Node*>& new_nodes) {
+  FunctionBase* f = candidate.node->function_base();
+  const SourceInfo& loc = candidate.node->loc();
+  Node* selector = candidate.guard->selector();
+  int64_t width = selector->BitCountOrDie();
+  if (width == 1) {
+    if (SelectorValueForArm(candidate.guard, candidate.arm)) {
+      return selector;
+    }
+    XLS_ASSIGN_OR_RETURN(Node * not_selector,
+                         f->MakeNode<UnOp>(loc, selector, Op::kNot));
+    new_nodes.push_back(not_selector);
+    return not_selector;
+  }
+  bool is_default = !std::holds_alternative<int64_t>(candidate.arm);
+  int64_t value = is_default ? candidate.guard->cases().size()
+                             : std::get<int64_t>(candidate.arm);
+  XLS_ASSIGN_OR_RETURN(Node * literal,
+                       f->MakeNode<Literal>(loc, Value(UBits(value, width))));
+  new_nodes.push_back(literal);
+  XLS_ASSIGN_OR_RETURN(
+      Node * condition,
+      f->MakeNode<CompareOp>(loc, selector, literal,
+                             is_default ? Op::kUGe : Op::kEq));
+  new_nodes.push_back(condition);
+  return condition;
+}
+
+// Replaces the operations of `group` with a single operation whose operands
+// are chosen by the guards of the group, and returns the shared operation.
+// Returns nullptr and leaves the function unchanged if doing so would lengthen
+// the critical path.
+absl::StatusOr<Node*> ShareGroup(absl::Span<const SharingCandidate> group,
+                                 const Timing& timing, int64_t critical_path,
+                                 const NodeDelays& node_delay) {
+  Node* first = group.front().node;
+  FunctionBase* f = first->function_base();
+  std::vector<Node*> new_nodes;
+
+  // The last candidate is the default of the operand muxes so needs no
+  // condition.
+  std::vector<Node*> conditions;
+  for (const SharingCandidate& candidate : group.first(group.size() - 1)) {
+    XLS_ASSIGN_OR_RETURN(Node * condition,
+                         MakeGuardCondition(candidate, new_nodes));
+    conditions.push_back(condition);
+  }
+  Node* selector = conditions.front();
+  if (conditions.size() > 1) {
+    // Concat places its first operand in the most significant bits.
+    std::vector<Node*> bits(conditions.rbegin(), conditions.rend());
+    XLS_ASSIGN_OR_RETURN(selector, f->MakeNode<Concat>(first->loc(), bits));
+    new_nodes.push_back(selector);
+  }
+
+  std::vector<Node*> operands;
+  for (int64_t i = 0; i < first->operand_count(); ++i) {
+    std::vector<Node*> cases;
+    for (const SharingCandidate& candidate : group.first(group.size() - 1)) {
+      cases.push_back(candidate.node->operand(i));
+    }
+    Node* default_value = group.back().node->operand(i);
+    if (absl::c_all_of(cases,
+                       [&](Node* n) { return n == default_value; })) {
+      operands.push_back(default_value);
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(Node * mux,
+                         f->MakeNode<PrioritySelect>(first->loc(), selector,
+                                                     cases, default_value));
+    new_nodes.push_back(mux);
+    operands.push_back(mux);
+  }
+  XLS_ASSIGN_OR_RETURN(Node * shared, first->Clone(operands));
+  new_nodes.push_back(shared);
+
+  // New nodes are created in topological order.
+  absl::flat_hash_map<Node*, int64_t> new_arrival;
+  for (Node* node : new_nodes) {
+    int64_t start = 0;
+    for (Node* operand : node->operands()) {
+      auto it = new_arrival.find(operand);
+      start = std::max(start, it == new_arrival.end()
+                                  ? timing.arrival.at(operand)
+                                  : it->second);
+    }
+    new_arrival[node] = start + node_delay(node);
+  }
+  int64_t tail = 0;
+  for (const SharingCandidate& candidate : group) {
+    tail = std::max(tail, timing.tail.at(candidate.node));
+  }
+  if (new_arrival.at(shared) + tail > critical_path) {
+    VLOG(3) << absl::StreamFormat(
+        "Not sharing %s: path of %dps exceeds critical path of %dps",
+        first->GetName(), new_arrival.at(shared) + tail, critical_path);
+    for (auto it = new_nodes.rbegin(); it != new_nodes.rend(); ++it) {
+      XLS_RETURN_IF_ERROR(f->RemoveNode(*it));
+    }
+    return nullptr;
+  }
+
+  for (const SharingCandidate& candidate : group) {
+    VLOG(2) << absl::StreamFormat("Replacing %s with shared %s",
+                                  candidate.node->GetName(),
+                                  shared->GetName());
+    XLS_RETURN_IF_ERROR(candidate.node->ReplaceUsesWith(shared));
+    // Every use of a candidate is guarded by a select arm, so it is now dead.
+    XLS_RETURN_IF_ERROR(f->RemoveNode(candidate.node));
+  }
+  return shared;
+}
+
+// Adds `node` and the nodes it transitively depends on (if `operands`) or
+// which transitively depend on it (otherwise) to `cone`.
+void AddCone(Node* node, bool operands, absl::flat_hash_set<Node*>& cone) {
+  if (!cone.insert(node).second) {
+    return;
+  }
+  std::vector<Node*> worklist = {node};
+  while (!worklist.empty()) {
+    Node* next = worklist.back();
+    worklist.pop_back();
+    for (Node* neighbor : operands ? absl::Span<Node* const>(next->operands())
+                                   : absl::Span<Node* const>(next->users())) {
+      if (cone.insert(neighbor).second) {
+        worklist.push_back(neighbor);
+      }
+    }
+  }
+}
+
+// Runs the analyses of `f` once and shares every group of exclusive
+// operations they find which is independent of the groups already shared in
+// this round. Returns whether anything changed.
+absl::StatusOr<bool> ShareRound(FunctionBase* f, const NodeDelays& node_delay,
+                                int64_t critical_path) {
+  PredicateDominatorAnalysis predicates = PredicateDominatorAnalysis::Run(f);
+  std::vector<SharingCandidate> candidates;
+  for (Node* node : TopoSort(f)) {
+    if (!IsShareableOp(node)) {
+      continue;
+    }
+    PredicateState predicate = predicates.GetSingleNearestPredicate(node);
+    if (!predicate.IsSelectPredicate() || !predicate.node()->Is<Select>()) {
+      continue;
+    }
+    candidates.push_back(SharingCandidate{
+        .node = node,
+        .guard = predicate.node()->As<Select>(),
+        .arm = predicate.arm()});
+  }
+  if (candidates.size() < 2) {
+    return false;
+  }
+
+  std::vector<std::unique_ptr<QueryEngine>> query_engines;
+  query_engines.push_back(std::make_unique<StatelessQueryEngine>());
+  query_engines.push_back(std::make_unique<BddQueryEngine>(
+      BddFunction::kDefaultPathLimit, IsCheapForBdds));
+  UnionQueryEngine query_engine(std::move(query_engines));
+  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+
+  // Greedily place each candidate in the first group whose members it is
+  // exclusive with.
+  std::vector<std::vector<SharingCandidate>> groups;
+  for (const SharingCandidate& candidate : candidates) {
+    auto group = absl::c_find_if(
+        groups, [&](const std::vector<SharingCandidate>& group) {
+          return HaveSameSignature(group.front().node, candidate.node) &&
+                 absl::c_all_of(group, [&](const SharingCandidate& member) {
+                   return AreExclusive(member, candidate, query_engine);
+                 });
+        });
+    if (group == groups.end()) {
+      groups.push_back({candidate});
+    } else {
+      group->push_back(candidate);
+    }
+  }
+
+  Timing timing = ComputeTiming(f, node_delay);
+  // Sharing a group changes the timing of the nodes it feeds and is fed by,
+  // and the predicates and values downstream of it. Groups touching those
+  // nodes are left to the next round, when the analyses are rerun.
+  absl::flat_hash_set<Node*> fan_in;
+  absl::flat_hash_set<Node*> fan_out;
+  bool changed = false;
+  for (const std::vector<SharingCandidate>& group : groups) {
+    if (group.size() < 2) {
+      continue;
+    }
+    // The shared operation depends on the operands and guards of every
+    // member, so none of them may depend on a member.
+    absl::flat_hash_set<Node*> members;
+    std::vector<Node*> roots;
+    for (const SharingCandidate& candidate : group) {
+      members.insert(candidate.node);
+      roots.push_back(candidate.guard->selector());
+      roots.insert(roots.end(), candidate.node->operands().begin(),
+                   candidate.node->operands().end());
+    }
+    if (DependsOnAny(roots, members)) {
+      continue;
+    }
+    auto touched = [&](Node* node) {
+      return fan_in.contains(node) || fan_out.contains(node);
+    };
+    if (absl::c_any_of(members, touched) ||
+        absl::c_any_of(roots,
+                       [&](Node* node) { return fan_out.contains(node); })) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Node * shared, ShareGroup(group, timing, critical_path, node_delay));
+    if (shared == nullptr) {
+      continue;
+    }
+    changed = true;
+    AddCone(shared, /*operands=*/true, fan_in);
+    AddCone(shared, /*operands=*/false, fan_out);
+  }
+  return changed;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ResourceSharingPass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  if (!options.resource_sharing) {
+    return false;
+  }
+  NodeDelays node_delay(options.cost_model);
+  // Sharing must never lengthen the critical path of the original function.
+  int64_t critical_path = CriticalPath(ComputeTiming(f, node_delay));
+
+  // Each round shares at least one group, which removes its operations, so
+  // this terminates.
+  bool changed = false;
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(bool shared, ShareRound(f, node_delay, critical_path));
+    if (!shared) {
+      break;
+    }
+    changed = true;
+  }
+  return changed;
+}
+
+REGISTER_OPT_PASS(ResourceSharingPass);
+
+}  // namespace xls
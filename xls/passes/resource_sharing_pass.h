@@ -0,0 +1,72 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_RESOURCE_SHARING_PASS_H_
+#define XLS_PASSES_RESOURCE_SHARING_PASS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Pass which folds expensive operations (multiplies, divides and modulos)
+// which are never observed in the same evaluation into a single operation with
+// muxed operands. For example:
+//
+//   x = umul(a, b)
+//   y = umul(c, d)
+//   s = sel(p, cases=[x, y])
+//
+// becomes:
+//
+//   a_or_c = priority_sel(not(p), cases=[a], default=c)
+//   b_or_d = priority_sel(not(p), cases=[b], default=d)
+//   xy = umul(a_or_c, b_or_d)
+//   s = sel(p, cases=[xy, xy])
+//
+// Operations are candidates when all of their uses are guarded by a single
+// select arm (see PredicateDominatorAnalysis). Two candidates are exclusive if
+// they are guarded by different arms of the same select, or by arms of selects
+// with one-bit selectors which the BDD proves are never both chosen.
+//
+// Sharing adds a mux in front of the operation, so a group is only shared if
+// it does not lengthen the critical path of the function. Delays come from
+// OptimizationPassOptions::cost_model if set and the standard delay model
+// otherwise.
+//
+// The pass does nothing unless OptimizationPassOptions::resource_sharing is
+// set.
+class ResourceSharingPass : public OptimizationFunctionBasePass {
+ public:
+  static constexpr std::string_view kName = "resource_sharing";
+
+  ResourceSharingPass()
+      : OptimizationFunctionBasePass(kName, "Resource Sharing") {}
+  ~ResourceSharingPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override;
+
+  bool SkipsUnchangedFunctionBases() const override { return true; }
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_RESOURCE_SHARING_PASS_H_
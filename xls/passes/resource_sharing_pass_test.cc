@@ -0,0 +1,181 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/resource_sharing_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/passes/dce_pass.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+class ResourceSharingPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Function* f, bool resource_sharing = true) {
+    PassResults results;
+    OptimizationPassOptions options;
+    options.resource_sharing = resource_sharing;
+    XLS_ASSIGN_OR_RETURN(
+        bool changed,
+        ResourceSharingPass().RunOnFunctionBase(f, options, &results));
+    XLS_RETURN_IF_ERROR(
+        DeadCodeEliminationPass()
+            .RunOnFunctionBase(f, OptimizationPassOptions(), &results)
+            .status());
+    return changed;
+  }
+
+  // Returns a value computed through a chain of multiplies which is slower than
+  // anything else in the tests, leaving slack for the operand muxes.
+  BValue SlowPath(FunctionBuilder& fb, BValue x) {
+    BValue result = x;
+    for (int i = 0; i < 4; ++i) {
+      result = fb.UMul(result, x);
+    }
+    return result;
+  }
+};
+
+TEST_F(ResourceSharingPassTest, ArmsOfOneSelectShared) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue c = fb.Param("c", p->GetBitsType(1));
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue s = fb.Select(c, {fb.UMul(a, b), fb.UMul(x, y)});
+  fb.Tuple({s, SlowPath(fb, a)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(s.node()->operand(1), s.node()->operand(2));
+  EXPECT_THAT(s.node()->operand(1),
+              m::UMul(m::PrioritySelect(), m::PrioritySelect()));
+}
+
+TEST_F(ResourceSharingPassTest, DisabledByDefault) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue c = fb.Param("c", p->GetBitsType(1));
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  fb.Tuple(
+      {fb.Select(c, {fb.UMul(a, b), fb.UMul(x, y)}), SlowPath(fb, a)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f, /*resource_sharing=*/false), IsOkAndHolds(false));
+}
+
+TEST_F(ResourceSharingPassTest, IndependentGroupsShared) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue c = fb.Param("c", p->GetBitsType(1));
+  BValue d = fb.Param("d", p->GetBitsType(1));
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue s1 = fb.Select(c, {fb.UMul(a, b), fb.UMul(x, y)});
+  BValue s2 = fb.Select(d, {fb.UDiv(a, y), fb.UDiv(x, b)});
+  fb.Tuple({s1, s2, SlowPath(fb, a)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(s1.node()->operand(1), s1.node()->operand(2));
+  EXPECT_THAT(s1.node()->operand(1),
+              m::UMul(m::PrioritySelect(), m::PrioritySelect()));
+  EXPECT_EQ(s2.node()->operand(1), s2.node()->operand(2));
+  EXPECT_THAT(s2.node()->operand(1),
+              m::UDiv(m::PrioritySelect(), m::PrioritySelect()));
+}
+
+TEST_F(ResourceSharingPassTest, ExclusiveSelectsShared) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue c = fb.Param("c", p->GetBitsType(1));
+  BValue d = fb.Param("d", p->GetBitsType(1));
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue zero = fb.Literal(UBits(0, 32));
+  BValue s1 = fb.Select(c, {zero, fb.UDiv(a, b)});
+  BValue s2 = fb.Select(fb.And(fb.Not(c), d), {zero, fb.UDiv(x, y)});
+  fb.Tuple({fb.Add(s1, s2), SlowPath(fb, a)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(s1.node()->operand(2), s2.node()->operand(2));
+  EXPECT_THAT(s1.node()->operand(2),
+              m::UDiv(m::PrioritySelect(), m::PrioritySelect()));
+}
+
+TEST_F(ResourceSharingPassTest, OverlappingSelectsNotShared) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue c = fb.Param("c", p->GetBitsType(1));
+  BValue d = fb.Param("d", p->GetBitsType(1));
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue zero = fb.Literal(UBits(0, 32));
+  BValue s1 = fb.Select(c, {zero, fb.UDiv(a, b)});
+  BValue s2 = fb.Select(d, {zero, fb.UDiv(x, y)});
+  fb.Tuple({fb.Add(s1, s2), SlowPath(fb, a)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(false));
+}
+
+TEST_F(ResourceSharingPassTest, CriticalPathNotLengthened) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue c = fb.Param("c", p->GetBitsType(1));
+  BValue a = fb.Param("a", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(32));
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  fb.Select(c, {fb.UMul(a, b), fb.UMul(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(false));
+  EXPECT_THAT(f->return_value(),
+              m::Select(m::Param("c"), {m::UMul(m::Param("a"), m::Param("b")),
+                                        m::UMul(m::Param("x"), m::Param("y"))}));
+}
+
+}  // namespace
+}  // namespace xls
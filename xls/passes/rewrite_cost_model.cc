@@ -0,0 +1,189 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/rewrite_cost_model.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+namespace {
+
+// Returns the longest combinational path through `nodes`, counting only edges
+// between nodes of the set.
+absl::StatusOr<int64_t> LongestPathInPs(const RewriteCostModel& model,
+                                        absl::Span<Node* const> nodes) {
+  absl::flat_hash_set<Node*> in_set(nodes.begin(), nodes.end());
+  absl::flat_hash_map<Node*, int64_t> arrival;
+  // Depth-first in post order so operands in the set are visited first.
+  std::vector<std::pair<Node*, bool>> stack;
+  int64_t longest = 0;
+  for (Node* root : nodes) {
+    stack.push_back({root, false});
+    while (!stack.empty()) {
+      auto [node, operands_done] = stack.back();
+      stack.pop_back();
+      if (arrival.contains(node)) {
+        continue;
+      }
+      if (!operands_done) {
+        stack.push_back({node, true});
+        for (Node* operand : node->operands()) {
+          if (in_set.contains(operand) && !arrival.contains(operand)) {
+            stack.push_back({operand, false});
+          }
+        }
+        continue;
+      }
+      int64_t start = 0;
+      for (Node* operand : node->operands()) {
+        if (auto it = arrival.find(operand); it != arrival.end()) {
+          start = std::max(start, it->second);
+        }
+      }
+      XLS_ASSIGN_OR_RETURN(int64_t delay, model.GetDelayInPs(node));
+      arrival[node] = start + delay;
+      longest = std::max(longest, start + delay);
+    }
+  }
+  return longest;
+}
+
+absl::StatusOr<double> TotalAreaInSquareMicrons(
+    const RewriteCostModel& model, absl::Span<Node* const> nodes) {
+  double total = 0.0;
+  for (Node* node : nodes) {
+    XLS_ASSIGN_OR_RETURN(double area, model.GetAreaInSquareMicrons(node));
+    total += area;
+  }
+  return total;
+}
+
+}  // namespace
+
+absl::StatusOr<RewriteCostDelta> RewriteCostModel::GetRewriteDelta(
+    absl::Span<Node* const> removed, absl::Span<Node* const> added) const {
+  XLS_ASSIGN_OR_RETURN(double removed_area,
+                       TotalAreaInSquareMicrons(*this, removed));
+  XLS_ASSIGN_OR_RETURN(double added_area,
+                       TotalAreaInSquareMicrons(*this, added));
+  XLS_ASSIGN_OR_RETURN(int64_t removed_delay, LongestPathInPs(*this, removed));
+  XLS_ASSIGN_OR_RETURN(int64_t added_delay, LongestPathInPs(*this, added));
+  return RewriteCostDelta{.area_um2 = added_area - removed_area,
+                          .delay_ps = added_delay - removed_delay};
+}
+
+bool RewriteCostModel::AcceptRewrite(absl::Span<Node* const> removed,
+                                     absl::Span<Node* const> added) const {
+  absl::StatusOr<RewriteCostDelta> delta = GetRewriteDelta(removed, added);
+  if (!delta.ok()) {
+    VLOG(3) << "Cost model " << name()
+            << " cannot estimate rewrite, accepting: " << delta.status();
+    return true;
+  }
+  VLOG(3) << "Cost model " << name() << ": rewrite changes area by "
+          << delta->area_um2 << "um^2 and delay by " << delta->delay_ps
+          << "ps";
+  return delta->area_um2 <= 0.0 && delta->delay_ps <= 0;
+}
+
+std::vector<Node*> NodesKilledByReplacing(Node* node) {
+  FunctionBase* f = node->function_base();
+  std::vector<Node*> killed = {node};
+  absl::flat_hash_set<Node*> dead = {node};
+  // The number of users of each node which are known to be dead.
+  absl::flat_hash_map<Node*, int64_t> dead_users;
+  for (int64_t i = 0; i < killed.size(); ++i) {
+    absl::flat_hash_set<Node*> operands(killed[i]->operands().begin(),
+                                        killed[i]->operands().end());
+    for (Node* operand : operands) {
+      if (dead.contains(operand) || operand->Is<Param>() ||
+          OpIsSideEffecting(operand->op()) || f->HasImplicitUse(operand)) {
+        continue;
+      }
+      if (++dead_users[operand] ==
+          static_cast<int64_t>(operand->users().size())) {
+        dead.insert(operand);
+        killed.push_back(operand);
+      }
+    }
+  }
+  return killed;
+}
+
+EstimatorRewriteCostModel::EstimatorRewriteCostModel(
+    const AreaEstimator& area_estimator, const DelayEstimator& delay_estimator)
+    : RewriteCostModel(
+          absl::StrCat(area_estimator.name(), "/", delay_estimator.name())),
+      area_estimator_(area_estimator),
+      delay_estimator_(delay_estimator) {}
+
+absl::StatusOr<double> EstimatorRewriteCostModel::GetAreaInSquareMicrons(
+    Node* node) const {
+  std::string key = StructuralDelayCache::StructuralKey(node);
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = areas_.find(key); it != areas_.end()) {
+      ++cache_hits_;
+      return it->second;
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(double area,
+                       area_estimator_.GetOperationAreaInSquareMicrons(node));
+  absl::MutexLock lock(&mutex_);
+  areas_.emplace(std::move(key), area);
+  return area;
+}
+
+absl::StatusOr<int64_t> EstimatorRewriteCostModel::GetDelayInPs(
+    Node* node) const {
+  std::string key = StructuralDelayCache::StructuralKey(node);
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = delays_.find(key); it != delays_.end()) {
+      ++cache_hits_;
+      return it->second;
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t delay,
+                       delay_estimator_.GetOperationDelayInPs(node));
+  absl::MutexLock lock(&mutex_);
+  delays_.emplace(std::move(key), delay);
+  return delay;
+}
+
+int64_t EstimatorRewriteCostModel::cache_hits() const {
+  absl::MutexLock lock(&mutex_);
+  return cache_hits_;
+}
+
+}  // namespace xls
@@ -0,0 +1,108 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_REWRITE_COST_MODEL_H_
+#define XLS_PASSES_REWRITE_COST_MODEL_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// The estimated change in area and critical-path delay of a rewrite. Positive
+// values mean the rewrite makes the design larger or slower.
+struct RewriteCostDelta {
+  double area_um2 = 0.0;
+  int64_t delay_ps = 0;
+};
+
+// Estimates the cost of candidate rewrites so that passes which make
+// profitability decisions can reject rewrites which would increase area or
+// critical-path delay. A pass builds the replacement nodes, asks the model
+// whether replacing the nodes which become dead with them is worthwhile, and
+// removes the replacement again if not. Implementations must be safe for
+// concurrent use from passes running on different function bases.
+class RewriteCostModel {
+ public:
+  explicit RewriteCostModel(std::string_view name) : name_(name) {}
+  virtual ~RewriteCostModel() = default;
+
+  const std::string& name() const { return name_; }
+
+  virtual absl::StatusOr<double> GetAreaInSquareMicrons(Node* node) const = 0;
+  virtual absl::StatusOr<int64_t> GetDelayInPs(Node* node) const = 0;
+
+  // Returns the estimated change from replacing the nodes `removed` with the
+  // nodes `added`. The area delta is the difference of the summed node areas;
+  // the delay delta is the difference of the longest combinational paths
+  // through each set, which approximates the change of the critical path
+  // through the rewritten region.
+  absl::StatusOr<RewriteCostDelta> GetRewriteDelta(
+      absl::Span<Node* const> removed, absl::Span<Node* const> added) const;
+
+  // Returns whether the rewrite increases neither area nor delay. Rewrites
+  // whose cost cannot be estimated are accepted, leaving the decision to the
+  // pass's own heuristics.
+  bool AcceptRewrite(absl::Span<Node* const> removed,
+                     absl::Span<Node* const> added) const;
+
+ private:
+  std::string name_;
+};
+
+// Returns `node` and the nodes which would become dead if all uses of `node`
+// were replaced: operands, transitively, whose every user is dead. Params and
+// side-effecting or implicitly-used nodes never become dead.
+std::vector<Node*> NodesKilledByReplacing(Node* node);
+
+// A RewriteCostModel backed by area and delay estimators. Estimates are cached
+// on the structure of the operation (see StructuralDelayCache::StructuralKey)
+// so they stay valid as passes rewrite the IR.
+class EstimatorRewriteCostModel : public RewriteCostModel {
+ public:
+  EstimatorRewriteCostModel(const AreaEstimator& area_estimator,
+                            const DelayEstimator& delay_estimator);
+
+  absl::StatusOr<double> GetAreaInSquareMicrons(Node* node) const override;
+  absl::StatusOr<int64_t> GetDelayInPs(Node* node) const override;
+
+  // Returns the number of estimates answered from the cache.
+  int64_t cache_hits() const;
+
+ private:
+  const AreaEstimator& area_estimator_;
+  const DelayEstimator& delay_estimator_;
+
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<std::string, double> areas_
+      ABSL_GUARDED_BY(mutex_);
+  mutable absl::flat_hash_map<std::string, int64_t> delays_
+      ABSL_GUARDED_BY(mutex_);
+  mutable int64_t cache_hits_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_REWRITE_COST_MODEL_H_
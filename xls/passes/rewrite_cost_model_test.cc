@@ -0,0 +1,117 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/rewrite_cost_model.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+// Area and delay are both the bit count of the node.
+class BitCountAreaEstimator : public AreaEstimator {
+ public:
+  BitCountAreaEstimator() : AreaEstimator("bit_count") {}
+
+  absl::StatusOr<double> GetOperationAreaInSquareMicrons(
+      Node* node) const override {
+    ++queries_;
+    return node->GetType()->GetFlatBitCount();
+  }
+
+  mutable int64_t queries_ = 0;
+
+ private:
+  absl::StatusOr<double> GetOneBitRegisterAreaInSquareMicrons() const override {
+    return 1.0;
+  }
+};
+
+class BitCountDelayEstimator : public DelayEstimator {
+ public:
+  BitCountDelayEstimator() : DelayEstimator("bit_count") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    return node->GetType()->GetFlatBitCount();
+  }
+};
+
+class RewriteCostModelTest : public IrTestBase {};
+
+TEST_F(RewriteCostModelTest, NodesKilledByReplacing) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  BValue shared = fb.Not(y);
+  BValue add = fb.Add(neg, fb.Add(shared, shared));
+  BValue other = fb.Xor(shared, x);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Tuple({add, other})).status());
+
+  // `shared` is also used by `other` so it survives; params always do.
+  std::vector<Node*> killed = NodesKilledByReplacing(add.node());
+  EXPECT_THAT(killed, UnorderedElementsAre(add.node(), neg.node(),
+                                           add.node()->operand(1)));
+}
+
+TEST_F(RewriteCostModelTest, RewriteDelta) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue narrow = fb.Negate(fb.BitSlice(x, 0, 4));
+  BValue wide = fb.Negate(fb.Not(x));
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Tuple({narrow, wide})).status());
+
+  BitCountAreaEstimator area_estimator;
+  BitCountDelayEstimator delay_estimator;
+  EstimatorRewriteCostModel model(area_estimator, delay_estimator);
+  EXPECT_EQ(model.name(), "bit_count/bit_count");
+
+  // Replacing the 8-bit chain with the 4-bit one halves area and delay.
+  std::vector<Node*> wide_nodes = NodesKilledByReplacing(wide.node());
+  std::vector<Node*> narrow_nodes = NodesKilledByReplacing(narrow.node());
+  XLS_ASSERT_OK_AND_ASSIGN(RewriteCostDelta delta,
+                           model.GetRewriteDelta(wide_nodes, narrow_nodes));
+  EXPECT_EQ(delta.area_um2, -8.0);
+  EXPECT_EQ(delta.delay_ps, -8);
+  EXPECT_TRUE(model.AcceptRewrite(wide_nodes, narrow_nodes));
+  EXPECT_FALSE(model.AcceptRewrite(narrow_nodes, wide_nodes));
+
+  // Structurally equal queries are answered from the cache.
+  int64_t queries = area_estimator.queries_;
+  XLS_ASSERT_OK(model.GetAreaInSquareMicrons(wide.node()).status());
+  EXPECT_EQ(area_estimator.queries_, queries);
+  EXPECT_GT(model.cache_hits(), 0);
+}
+
+}  // namespace
+}  // namespace xls
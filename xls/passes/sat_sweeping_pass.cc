@@ -0,0 +1,199 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/sat_sweeping_pass.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_op_translator.h"
+#include "xls/solvers/z3_utils.h"
+#include "z3/src/api/z3_api.h"
+
+namespace xls {
+
+namespace {
+
+// Returns true if the node may be merged with an equivalent node.
+bool IsSweepable(Node* node) {
+  return node->GetType()->IsBits() && !OpIsSideEffecting(node->op());
+}
+
+// Simulates the function base on `sample_count` random inputs and returns a
+// signature for each sweepable node which is a hash of the values it takes on.
+// Nodes which are equivalent have equal signatures. Parameters, side-effecting
+// operations and operations the interpreter cannot evaluate in isolation are
+// given random values.
+absl::flat_hash_map<Node*, size_t> SimulationSignatures(
+    FunctionBase* f, absl::Span<Node* const> topo_order, int64_t sample_count) {
+  // Use a fixed seed so the pass is deterministic.
+  std::seed_seq seed_seq({0x5a75});
+  std::mt19937_64 rng(seed_seq);
+
+  absl::flat_hash_map<Node*, size_t> signatures;
+  absl::flat_hash_map<Node*, Value> values;
+  values.reserve(f->node_count());
+  std::vector<Value> operand_values;
+  for (int64_t sample = 0; sample < sample_count; ++sample) {
+    values.clear();
+    for (Node* node : topo_order) {
+      absl::StatusOr<Value> value = absl::UnimplementedError("random value");
+      if (!node->Is<Param>() && !OpIsSideEffecting(node->op())) {
+        operand_values.clear();
+        for (Node* operand : node->operands()) {
+          operand_values.push_back(values.at(operand));
+        }
+        value = InterpretNode(node, operand_values);
+      }
+      if (!value.ok()) {
+        value = RandomValue(node->GetType(), rng);
+      }
+      if (IsSweepable(node)) {
+        signatures[node] = absl::HashOf(signatures[node], *value);
+      }
+      values[node] = *std::move(value);
+    }
+  }
+  return signatures;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> SatSweepingPass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  std::vector<Node*> topo_order = TopoSort(f);
+  absl::flat_hash_map<Node*, size_t> signatures =
+      SimulationSignatures(f, topo_order, sample_count_);
+
+  // Group the candidate equivalent nodes into classes keyed by bit count and
+  // signature. The first node of each class in topological order (or a literal
+  // if the class contains one) is the representative which replaces the other
+  // members once they are proven equivalent. This cannot introduce a cycle as
+  // the representative either precedes the replaced node in topological order
+  // or has no operands.
+  using ClassKey = std::pair<int64_t, size_t>;
+  absl::flat_hash_map<ClassKey, std::vector<Node*>> classes;
+  std::vector<ClassKey> class_order;
+  for (Node* node : topo_order) {
+    if (!IsSweepable(node)) {
+      continue;
+    }
+    ClassKey key = {node->BitCountOrDie(), signatures.at(node)};
+    std::vector<Node*>& members = classes[key];
+    if (members.empty()) {
+      class_order.push_back(key);
+    }
+    if (node->Is<Literal>() && !members.empty() &&
+        !members.front()->Is<Literal>()) {
+      members.insert(members.begin(), node);
+    } else {
+      members.push_back(node);
+    }
+  }
+  if (std::all_of(classes.begin(), classes.end(),
+                  [](const auto& p) { return p.second.size() < 2; })) {
+    return false;
+  }
+
+  absl::StatusOr<std::unique_ptr<solvers::z3::IrTranslator>> translator =
+      solvers::z3::IrTranslator::CreateAndTranslate(f,
+                                                    /*allow_unsupported=*/true);
+  if (!translator.ok()) {
+    VLOG(2) << "Unable to translate " << f->name()
+            << " to Z3: " << translator.status();
+    return false;
+  }
+  Z3_context ctx = (*translator)->ctx();
+  solvers::z3::Z3OpTranslator t(ctx);
+  Z3_solver solver = solvers::z3::CreateSolver(ctx, /*num_threads=*/1);
+  auto cleanup = absl::Cleanup([&] { Z3_solver_dec_ref(ctx, solver); });
+
+  auto set_timeout = [&](absl::Duration timeout) {
+    Z3_params params = Z3_mk_params(ctx);
+    Z3_params_inc_ref(ctx, params);
+    Z3_params_set_uint(
+        ctx, params, Z3_mk_string_symbol(ctx, "timeout"),
+        static_cast<unsigned>(
+            std::max(int64_t{1}, absl::ToInt64Milliseconds(timeout))));
+    Z3_solver_set_params(ctx, solver, params);
+    Z3_params_dec_ref(ctx, params);
+  };
+
+  const absl::Time deadline = absl::Now() + time_budget_;
+  bool changed = false;
+  for (const ClassKey& key : class_order) {
+    std::vector<Node*>& members = classes.at(key);
+    Node* representative = members.front();
+    for (int64_t i = 1; i < members.size(); ++i) {
+      absl::Duration remaining = deadline - absl::Now();
+      if (remaining <= absl::ZeroDuration()) {
+        VLOG(2) << "SAT sweeping time budget exhausted for " << f->name();
+        return changed;
+      }
+      Node* node = members[i];
+      Z3_ast representative_value =
+          (*translator)->GetTranslation(representative);
+      Z3_ast node_value = (*translator)->GetTranslation(node);
+
+      // The nodes are equivalent if no input makes them differ.
+      set_timeout(std::min(remaining, query_timeout_));
+      Z3_solver_push(ctx, solver);
+      Z3_solver_assert(ctx, solver, t.NeBool(representative_value, node_value));
+      Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
+      Z3_solver_pop(ctx, solver, 1);
+      if (satisfiable != Z3_L_FALSE) {
+        continue;
+      }
+
+      // Record the proven equivalence so later queries can make use of it.
+      Z3_solver_assert(ctx, solver, t.EqBool(representative_value, node_value));
+      VLOG(4) << "Proved equivalence:";
+      VLOG(4) << "  Node: " << node->ToString();
+      VLOG(4) << "  Replacement: " << representative->ToString();
+      XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(representative));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+REGISTER_OPT_PASS(SatSweepingPass);
+
+}  // namespace xls
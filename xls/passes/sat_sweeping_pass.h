@@ -0,0 +1,72 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_SAT_SWEEPING_PASS_H_
+#define XLS_PASSES_SAT_SWEEPING_PASS_H_
+
+#include <cstdint>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Pass which commons equivalent expressions in the graph using SAT sweeping.
+//
+// Random simulation partitions the bits-typed nodes into classes of candidate
+// equivalent nodes: nodes which produce the same value for every sample. Each
+// candidate is then checked against the representative of its class with a
+// single incremental Z3 solver holding the translation of the whole function
+// base. Proven equivalences are merged and added to the solver to simplify
+// later queries. Unlike BddCsePass there is no path limit so wide datapaths
+// are handled; instead the total solver time is bounded by `time_budget`.
+class SatSweepingPass : public OptimizationFunctionBasePass {
+ public:
+  static constexpr std::string_view kName = "sat_sweeping";
+
+  static constexpr absl::Duration kDefaultTimeBudget = absl::Seconds(10);
+  static constexpr absl::Duration kDefaultQueryTimeout = absl::Seconds(1);
+  static constexpr int64_t kDefaultSampleCount = 64;
+
+  // `time_budget` bounds the total time spent in the solver for each function
+  // base and `query_timeout` the time spent on a single equivalence check.
+  // `sample_count` is the number of random input vectors simulated to find
+  // candidate equivalences.
+  explicit SatSweepingPass(absl::Duration time_budget = kDefaultTimeBudget,
+                           absl::Duration query_timeout = kDefaultQueryTimeout,
+                           int64_t sample_count = kDefaultSampleCount)
+      : OptimizationFunctionBasePass(kName, "SAT Sweeping"),
+        time_budget_(time_budget),
+        query_timeout_(query_timeout),
+        sample_count_(sample_count) {}
+  ~SatSweepingPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override;
+
+ private:
+  absl::Duration time_budget_;
+  absl::Duration query_timeout_;
+  int64_t sample_count_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_SAT_SWEEPING_PASS_H_
@@ -0,0 +1,120 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/sat_sweeping_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+class SatSweepingPassTest : public IrTestBase {
+ protected:
+  SatSweepingPassTest() = default;
+
+  absl::StatusOr<bool> Run(
+      Function* f,
+      absl::Duration time_budget = SatSweepingPass::kDefaultTimeBudget) {
+    PassResults results;
+    return SatSweepingPass(time_budget)
+        .RunOnFunctionBase(f, OptimizationPassOptions(), &results);
+  }
+};
+
+TEST_F(SatSweepingPassTest, WideDistributiveLaw) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(64));
+  BValue y = fb.Param("y", p->GetBitsType(64));
+  BValue z = fb.Param("z", p->GetBitsType(64));
+  BValue factored = fb.And(x, fb.Or(y, z));
+  BValue distributed = fb.Or(fb.And(x, y), fb.And(x, z));
+  fb.Tuple({factored, distributed});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::And(m::Param("x"), m::Or()),
+                       m::And(m::Param("x"), m::Or())));
+}
+
+TEST_F(SatSweepingPassTest, ArithmeticIdentity) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue sum = fb.Add(x, y);
+  BValue difference = fb.Subtract(x, fb.Negate(y));
+  fb.Tuple({sum, difference});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Add(m::Param("x"), m::Param("y")),
+                       m::Add(m::Param("x"), m::Param("y"))));
+}
+
+TEST_F(SatSweepingPassTest, ReplacedWithLiteral) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue x_xor_x = fb.Xor(x, x);
+  fb.Tuple({x_xor_x, fb.Literal(UBits(0, 16))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Tuple(m::Literal(0), m::Literal(0)));
+}
+
+TEST_F(SatSweepingPassTest, DifferentExpressions) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  fb.Tuple({fb.Add(x, y), fb.Subtract(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(false));
+}
+
+TEST_F(SatSweepingPassTest, ExhaustedTimeBudget) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(64));
+  BValue y = fb.Param("y", p->GetBitsType(64));
+  BValue z = fb.Param("z", p->GetBitsType(64));
+  fb.Tuple({fb.And(x, fb.Or(y, z)), fb.Or(fb.And(x, y), fb.And(x, z))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f, /*time_budget=*/absl::ZeroDuration()),
+              IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xls
@@ -38,6 +38,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/rewrite_cost_model.h"
 
 namespace xls {
 
@@ -402,7 +403,8 @@ bool ShouldLiftSelect(FunctionBase *func, Node *select_to_optimize,
 }
 
 absl::StatusOr<TransformationResult> LiftSelectForArrayIndex(
-    FunctionBase *func, Node *select_to_optimize, Node *array_reference) {
+    FunctionBase *func, Node *select_to_optimize, Node *array_reference,
+    const RewriteCostModel *cost_model) {
   TransformationResult result;
 
   // Step 0: add a new "select" for the indices
@@ -452,6 +454,17 @@ absl::StatusOr<TransformationResult> LiftSelectForArrayIndex(
       SourceInfo(), array_reference, absl::Span<Node *const>(new_indices),
       "array_index_after_select", func));
 
+  // Let the cost model, if any, veto the transformation now that the new nodes
+  // can be estimated.
+  if (cost_model != nullptr &&
+      !cost_model->AcceptRewrite(NodesKilledByReplacing(select_to_optimize),
+                                 {new_select, new_array_index})) {
+    VLOG(3) << "    The cost model rejects the transformation";
+    XLS_RETURN_IF_ERROR(func->RemoveNode(new_array_index));
+    XLS_RETURN_IF_ERROR(func->RemoveNode(new_select));
+    return result;
+  }
+
   // Step 2: replace the uses of the original "select" node with the only
   //         exception of the new array access
   VLOG(3) << "    Step 2: replace the uses of the original \"select\"";
@@ -480,7 +493,8 @@ absl::StatusOr<TransformationResult> LiftSelectForArrayIndex(
 
 absl::StatusOr<TransformationResult> LiftSelect(
     FunctionBase *func, Node *select_to_optimize,
-    const LiftableSelectOperandInfo &shared_between_inputs) {
+    const LiftableSelectOperandInfo &shared_between_inputs,
+    const RewriteCostModel *cost_model) {
   TransformationResult result;
   VLOG(3) << "  Apply the transformation";
 
@@ -488,7 +502,8 @@ absl::StatusOr<TransformationResult> LiftSelect(
   switch (shared_between_inputs.op) {
     case Op::kArrayIndex:
       return LiftSelectForArrayIndex(func, select_to_optimize,
-                                     shared_between_inputs.shared_input);
+                                     shared_between_inputs.shared_input,
+                                     cost_model);
 
     default:
 
@@ -500,8 +515,9 @@ absl::StatusOr<TransformationResult> LiftSelect(
   }
 }
 
-absl::StatusOr<TransformationResult> LiftSelect(FunctionBase *func,
-                                                Node *select_to_optimize) {
+absl::StatusOr<TransformationResult> LiftSelect(
+    FunctionBase *func, Node *select_to_optimize,
+    const RewriteCostModel *cost_model) {
   TransformationResult result;
 
   // Check if it is safe to apply the transformation
@@ -531,14 +547,16 @@ absl::StatusOr<TransformationResult> LiftSelect(FunctionBase *func,
   VLOG(3) << "  This transformation is applicable and profitable for this "
              "select";
   XLS_ASSIGN_OR_RETURN(
-      result, LiftSelect(func, select_to_optimize, shared_between_inputs));
+      result, LiftSelect(func, select_to_optimize, shared_between_inputs,
+                         cost_model));
 
   return result;
 }
 
 absl::StatusOr<TransformationResult> LiftSelects(
     FunctionBase *func,
-    const absl::btree_set<Node *, Node::NodeIdLessThan> &selects_to_consider) {
+    const absl::btree_set<Node *, Node::NodeIdLessThan> &selects_to_consider,
+    const RewriteCostModel *cost_model) {
   TransformationResult result;
 
   // Try to optimize all "select" nodes
@@ -552,7 +570,7 @@ absl::StatusOr<TransformationResult> LiftSelects(
 
     // Try to optimize the current "select" node
     XLS_ASSIGN_OR_RETURN(TransformationResult current_transformation_result,
-                         LiftSelect(func, select_node));
+                         LiftSelect(func, select_node, cost_model));
 
     // Accumulate the result of the transformation
     result.was_code_modified |= current_transformation_result.was_code_modified;
@@ -604,7 +622,8 @@ absl::StatusOr<bool> SelectLiftingPass::RunOnFunctionBaseInternal(
 
     // Optimize all "select" nodes.
     XLS_ASSIGN_OR_RETURN(TransformationResult current_result,
-                         LiftSelects(func, selects_to_consider));
+                         LiftSelects(func, selects_to_consider,
+                                     options.cost_model));
 
     // Check if we have modified the code.
     was_code_modified |= current_result.was_code_modified;
@@ -68,6 +68,7 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_manager.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -2205,16 +2206,23 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
 absl::StatusOr<bool> SelectSimplificationPassBase::RunOnFunctionBaseInternal(
     FunctionBase* func, const OptimizationPassOptions& options,
     PassResults* results) const {
-  std::vector<std::unique_ptr<QueryEngine>> query_engines;
-  query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<TernaryQueryEngine>());
+  std::vector<std::unique_ptr<QueryEngine>> owned_engines;
+  StatelessQueryEngine stateless_query_engine;
+  XLS_ASSIGN_OR_RETURN(TernaryQueryEngine * ternary_query_engine,
+                       GetPopulatedQueryEngine<TernaryQueryEngine>(
+                           func, options.query_engine_manager, owned_engines));
+  std::vector<QueryEngine*> query_engines = {&stateless_query_engine,
+                                             ternary_query_engine};
   if (range_analysis_) {
-    query_engines.push_back(std::make_unique<RangeQueryEngine>());
+    XLS_ASSIGN_OR_RETURN(RangeQueryEngine * range_query_engine,
+                         GetPopulatedQueryEngine<RangeQueryEngine>(
+                             func, options.query_engine_manager,
+                             owned_engines));
+    query_engines.push_back(range_query_engine);
   }
   VLOG(2) << "Range analysis is " << std::boolalpha << range_analysis_;
 
-  UnionQueryEngine query_engine(std::move(query_engines));
-  XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
+  UnownedUnionQueryEngine query_engine(std::move(query_engines));
 
   XLS_ASSIGN_OR_RETURN(BitProvenanceAnalysis provenance,
                        BitProvenanceAnalysis::Create(func));
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -32,7 +33,6 @@
 #include "xls/ir/ternary.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
-#include "xls/ir/value_utils.h"
 #include "xls/passes/query_engine.h"
 
 namespace xls {
@@ -42,12 +42,12 @@ std::optional<bool> StatelessQueryEngine::KnownValue(
   if (!bit.node()->Is<Literal>()) {
     return std::nullopt;
   }
-  auto value_tree = ValueToLeafTypeTree(bit.node()->As<Literal>()->value(),
-                                        bit.node()->GetType());
+  absl::StatusOr<std::shared_ptr<const LeafTypeTree<Value>>> value_tree =
+      bit.node()->As<Literal>()->GetValueTree();
   if (!value_tree.ok()) {
     return std::nullopt;
   }
-  const Value& value = value_tree->Get(bit.tree_index());
+  const Value& value = (*value_tree)->Get(bit.tree_index());
   CHECK(value.IsBits());
   CHECK_GT(value.bits().bit_count(), bit.bit_index());
   return value.bits().Get(bit.bit_index());
@@ -76,11 +76,10 @@ bool StatelessQueryEngine::IsAllOnes(Node* node) const {
 std::optional<SharedLeafTypeTree<TernaryVector>>
 StatelessQueryEngine::GetTernary(Node* node) const {
   if (node->Is<Literal>()) {
-    LeafTypeTree<Value> values =
-        ValueToLeafTypeTree(node->As<Literal>()->value(), node->GetType())
-            .value();
+    std::shared_ptr<const LeafTypeTree<Value>> values =
+        node->As<Literal>()->GetValueTree().value();
     return leaf_type_tree::Map<TernaryVector, Value>(
-               values.AsView(),
+               values->AsView(),
                [](const Value& v) -> TernaryVector {
                  if (v.IsToken()) {
                    return TernaryVector();
@@ -42,6 +42,7 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/rewrite_cost_model.h"
 #include "xls/passes/stateless_query_engine.h"
 
 namespace xls {
@@ -508,6 +509,8 @@ absl::StatusOr<bool> TableSwitchPass::RunOnFunctionBaseInternal(
 
     XLS_ASSIGN_OR_RETURN(Literal * array_literal,
                          f->MakeNode<Literal>(node->loc(), table.value()));
+    std::vector<Node*> added = {array_literal};
+    Node* replacement;
     if (first_case > 0) {
       XLS_RET_CHECK(node->Is<PrioritySelect>());
       PrioritySelect* sel = node->As<PrioritySelect>();
@@ -519,17 +522,31 @@ absl::StatusOr<bool> TableSwitchPass::RunOnFunctionBaseInternal(
           Node * truncated_selector,
           sel->function_base()->MakeNode<BitSlice>(
               node->loc(), sel->selector(), /*start=*/0, /*width=*/first_case));
-      XLS_RETURN_IF_ERROR(sel->ReplaceUsesWithNew<PrioritySelect>(
-                                 truncated_selector,
-                                 sel->cases().subspan(0, /*len=*/first_case),
-                                 /*default_value=*/array_index)
-                              .status());
+      XLS_ASSIGN_OR_RETURN(replacement,
+                           f->MakeNode<PrioritySelect>(
+                               sel->loc(), truncated_selector,
+                               sel->cases().subspan(0, /*len=*/first_case),
+                               /*default_value=*/array_index));
+      added.push_back(array_index);
+      added.push_back(truncated_selector);
     } else {
-      XLS_RETURN_IF_ERROR(
-          node->ReplaceUsesWithNew<ArrayIndex>(
-                  array_literal, std::vector<Node*>({links.back().index}))
-              .status());
+      XLS_ASSIGN_OR_RETURN(
+          replacement, f->MakeNode<ArrayIndex>(
+                           node->loc(), array_literal,
+                           std::vector<Node*>({links.back().index})));
+    }
+    added.push_back(replacement);
+
+    if (options.cost_model != nullptr &&
+        !options.cost_model->AcceptRewrite(NodesKilledByReplacing(node),
+                                           added)) {
+      VLOG(3) << "Replacement rejected by the cost model.";
+      for (auto it = added.rbegin(); it != added.rend(); ++it) {
+        XLS_RETURN_IF_ERROR(f->RemoveNode(*it));
+      }
+      continue;
     }
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(replacement));
 
     // Mark the replaced nodes as being transformed to avoid quadratic
     // behavior. These nodes will be skipped in future iterations.
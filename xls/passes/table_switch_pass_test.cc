@@ -14,6 +14,7 @@
 
 #include "xls/passes/table_switch_pass.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -38,6 +39,7 @@
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/rewrite_cost_model.h"
 #include "xls/solvers/z3_ir_equivalence_testutils.h"
 
 namespace m = ::xls::op_matchers;
@@ -134,6 +136,59 @@ fn main(index: bits[32]) -> bits[32] {
   XLS_ASSERT_OK(CompareBeforeAfter(f, before_data));
 }
 
+// A cost model charging a fixed area for each node with the given op.
+class OpAreaCostModel : public RewriteCostModel {
+ public:
+  OpAreaCostModel(Op op, double area)
+      : RewriteCostModel("op_area"), op_(op), area_(area) {}
+
+  absl::StatusOr<double> GetAreaInSquareMicrons(Node* node) const override {
+    return node->op() == op_ ? area_ : 0.0;
+  }
+  absl::StatusOr<int64_t> GetDelayInPs(Node* node) const override {
+    return 0;
+  }
+
+ private:
+  Op op_;
+  double area_;
+};
+
+TEST_F(TableSwitchPassTest, CostModelRejectsConversion) {
+  const std::string program = R"(
+fn main(index: bits[32]) -> bits[32] {
+  literal.0: bits[32] = literal(value=0)
+  literal.1: bits[32] = literal(value=1)
+  literal.2: bits[32] = literal(value=2)
+  literal.3: bits[32] = literal(value=3)
+  eq.10: bits[1] = eq(index, literal.0)
+  eq.11: bits[1] = eq(index, literal.1)
+  eq.12: bits[1] = eq(index, literal.2)
+  sel.20: bits[32] = sel(eq.10, cases=[literal.0, literal.1])
+  sel.21: bits[32] = sel(eq.11, cases=[sel.20, literal.2])
+  ret sel.22: bits[32] = sel(eq.12, cases=[sel.21, literal.3])
+})";
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, p.get()));
+  int64_t node_count = f->node_count();
+
+  OpAreaCostModel expensive_array_index(Op::kArrayIndex, 1000.0);
+  OptimizationPassOptions options;
+  options.cost_model = &expensive_array_index;
+  PassResults results;
+  EXPECT_THAT(TableSwitchPass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_EQ(f->node_count(), node_count);
+  EXPECT_THAT(f->return_value(), m::Select());
+
+  // The conversion removes selects, so a model charging for them accepts it.
+  OpAreaCostModel expensive_select(Op::kSel, 1000.0);
+  options.cost_model = &expensive_select;
+  EXPECT_THAT(TableSwitchPass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::ArrayIndex());
+}
+
 // Verifies that an N-deep tree is converted into a table lookup; smoke test.
 TEST_F(TableSwitchPassTest, SimplePrioritySelectLookup) {
   constexpr int kNumLiterals = 7;
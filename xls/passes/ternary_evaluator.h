@@ -15,8 +15,11 @@
 #ifndef XLS_PASSES_TERNARY_EVALUATOR_H_
 #define XLS_PASSES_TERNARY_EVALUATOR_H_
 
+#include <vector>
+
 #include "absl/log/log.h"
 #include "xls/ir/abstract_evaluator.h"
+#include "xls/ir/packed_ternary.h"
 #include "xls/ir/ternary.h"
 
 namespace xls {
@@ -61,6 +64,38 @@ class TernaryEvaluator
     }
     return TernaryValue::kUnknown;
   }
+
+  // Bitwise operations and addition are evaluated word-at-a-time on a packed
+  // representation rather than bit-by-bit through the generic implementations
+  // in AbstractEvaluator.
+  Vector BitwiseAnd(SpanOfSpan inputs) {
+    return ternary_ops::And(Pack(inputs)).ToTernaryVector();
+  }
+  Vector BitwiseOr(SpanOfSpan inputs) {
+    return ternary_ops::Or(Pack(inputs)).ToTernaryVector();
+  }
+  Vector BitwiseXor(SpanOfSpan inputs) {
+    return ternary_ops::Xor(Pack(inputs)).ToTernaryVector();
+  }
+  Vector BitwiseAnd(Span a, Span b) { return BitwiseAnd({a, b}); }
+  Vector BitwiseOr(Span a, Span b) { return BitwiseOr({a, b}); }
+  Vector BitwiseXor(Span a, Span b) { return BitwiseXor({a, b}); }
+
+  Vector Add(Span a, Span b) {
+    return ternary_ops::Add(PackedTernaryVector::FromTernary(a),
+                            PackedTernaryVector::FromTernary(b))
+        .ToTernaryVector();
+  }
+
+ private:
+  static std::vector<PackedTernaryVector> Pack(SpanOfSpan inputs) {
+    std::vector<PackedTernaryVector> packed;
+    packed.reserve(inputs.size());
+    for (Span input : inputs) {
+      packed.push_back(PackedTernaryVector::FromTernary(input));
+    }
+    return packed;
+  }
 };
 
 }  // namespace xls
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "xls/ir/node_map.h"
 #include "xls/passes/ternary_query_engine.h"
 
 #include <cstdint>
@@ -23,7 +24,6 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -113,8 +113,7 @@ static constexpr int64_t kIndexBitLimit = 10;
 // pathological cases are encountered.
 bool IsExpensiveToEvaluate(
     Node* node,
-    const absl::flat_hash_map<Node*, LeafTypeTree<TernaryEvaluator::Vector>>&
-        known_bits) {
+    const NodeMap<LeafTypeTree<TernaryEvaluator::Vector>>& known_bits) {
   // How many bits of output we allow for complex evaluations.
   static constexpr int64_t kComplexEvaluationLimit = 256;
   // How many bits of data we are willing to keep track of for compound
@@ -320,6 +319,7 @@ class NoOpGivens final : public TernaryDataProvider {
 
 absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::PopulateWithGivens(
     FunctionBase* f, const TernaryDataProvider& givens) {
+  ScopedQueryEngineTimer timer(f);
   TernaryEvaluator evaluator;
   TernaryNodeEvaluator ternary_visitor(evaluator);
   for (Node* n : TopoSort(f)) {
@@ -336,7 +336,7 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::PopulateWithGivens(
     XLS_RETURN_IF_ERROR(n->VisitSingleNode(&ternary_visitor));
   }
 
-  absl::flat_hash_map<Node*, LeafTypeTree<TernaryVector>> new_values =
+  NodeMap<LeafTypeTree<TernaryVector>> new_values =
       std::move(ternary_visitor).values();
   ReachedFixpoint rf = ReachedFixpoint::Unchanged;
   for (Node* node : f->nodes()) {
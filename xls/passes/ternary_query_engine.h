@@ -20,7 +20,6 @@
 #include <variant>
 
 #include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -28,6 +27,7 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/type.h"
 #include "xls/passes/query_engine.h"
@@ -106,7 +106,7 @@ class TernaryQueryEngine : public QueryEngine {
 
  private:
   // Holds which bits values are known for nodes in the function.
-  absl::flat_hash_map<Node*, LeafTypeTree<TernaryEvaluator::Vector>> values_;
+  NodeMap<LeafTypeTree<TernaryEvaluator::Vector>> values_;
 };
 
 }  // namespace xls
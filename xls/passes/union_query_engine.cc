@@ -83,6 +83,7 @@ bool UnownedUnionQueryEngine::IsAllZeros(Node* n) const {
 
 absl::StatusOr<ReachedFixpoint> UnownedUnionQueryEngine::Populate(
     FunctionBase* f) {
+  ScopedQueryEngineTimer timer(f);
   ReachedFixpoint result = ReachedFixpoint::Unchanged;
   for (QueryEngine* engine : engines_) {
     XLS_ASSIGN_OR_RETURN(ReachedFixpoint rf, engine->Populate(f));
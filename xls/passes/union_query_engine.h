@@ -113,6 +113,12 @@ class UnionQueryEngine : public UnownedUnionQueryEngine {
   explicit UnionQueryEngine(std::vector<std::unique_ptr<QueryEngine>> engines)
       : UnownedUnionQueryEngine(ToUnownedVector(engines)),
         owned_engines_(std::move(engines)) {}
+  // Unions `engines` of which only `owned_engines` are owned. The rest must
+  // outlive this query engine.
+  UnionQueryEngine(std::vector<QueryEngine*> engines,
+                   std::vector<std::unique_ptr<QueryEngine>> owned_engines)
+      : UnownedUnionQueryEngine(std::move(engines)),
+        owned_engines_(std::move(owned_engines)) {}
 
  private:
   static std::vector<QueryEngine*> ToUnownedVector(
@@ -17,9 +17,12 @@
 #include <cstdint>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
@@ -27,18 +30,21 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
+#include "xls/passes/inlining_pass.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/pass_pipeline.pb.h"
 
 namespace xls {
 namespace {
 
 // Finds an "effectively used" (has users or is return value) counted for in the
-// function f, or returns nullptr if none is found.
-CountedFor* FindCountedFor(FunctionBase* f) {
+// function f which is not in `deferred`, or returns nullptr if none is found.
+CountedFor* FindCountedFor(FunctionBase* f,
+                           const absl::flat_hash_set<Node*>& deferred) {
   for (Node* node : TopoSort(f)) {
-    if (node->Is<CountedFor>() &&
+    if (node->Is<CountedFor>() && !deferred.contains(node) &&
         (f->HasImplicitUse(node) || !node->users().empty())) {
       return node->As<CountedFor>();
     }
@@ -47,8 +53,9 @@ CountedFor* FindCountedFor(FunctionBase* f) {
 }
 
 // Unrolls the node "loop" by replacing it with a sequence of dependent
-// invocations.
-absl::Status UnrollCountedFor(CountedFor* loop) {
+// invocations. If `fold_iterations` is true the invocations are inlined and
+// simplified for their constant arguments as they are created.
+absl::Status UnrollCountedFor(CountedFor* loop, bool fold_iterations) {
   FunctionBase* f = loop->function_base();
   Node* loop_carry = loop->initial_value();
   int64_t ivar_bit_count = loop->body()->params()[0]->BitCountOrDie();
@@ -65,9 +72,15 @@ absl::Status UnrollCountedFor(CountedFor* loop) {
     }
 
     XLS_ASSIGN_OR_RETURN(
-        loop_carry,
+        Invoke * invoke,
         f->MakeNode<Invoke>(loop->loc(), absl::MakeSpan(invoke_args),
                             loop->body()));
+    if (fold_iterations) {
+      XLS_ASSIGN_OR_RETURN(loop_carry,
+                           InliningPass::InlineAndFoldInvoke(invoke));
+    } else {
+      loop_carry = invoke;
+    }
   }
   XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
   return f->RemoveNode(loop);
@@ -79,17 +92,34 @@ absl::StatusOr<bool> UnrollPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
   bool changed = false;
+  // Loops left rolled to stay within the node budget.
+  absl::flat_hash_set<Node*> deferred;
   while (true) {
-    CountedFor* loop = FindCountedFor(f);
+    CountedFor* loop = FindCountedFor(f, deferred);
     if (loop == nullptr) {
       break;
     }
-    XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
+    if (!FitsNodeBudget(short_name(), loop,
+                        loop->trip_count() * loop->body()->node_count(),
+                        options, results)) {
+      deferred.insert(loop);
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(UnrollCountedFor(loop, fold_iterations_));
     changed = true;
   }
   return changed;
 }
 
-REGISTER_OPT_PASS(UnrollPass);
+absl::StatusOr<PassPipelineProto::Element> UnrollPass::ToProto() const {
+  PassPipelineProto::Element e;
+  *e.mutable_pass_name() = fold_iterations_ ? "loop_unroll(fold)" : kName;
+  return e;
+}
+
+XLS_REGISTER_MODULE_INITIALIZER(loop_unroll, {
+  CHECK_OK(RegisterOptimizationPass<UnrollPass>(UnrollPass::kName, false));
+  CHECK_OK(RegisterOptimizationPass<UnrollPass>("loop_unroll(fold)", true));
+});
 
 }  // namespace xls
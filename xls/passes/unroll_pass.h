@@ -21,18 +21,35 @@
 #include "xls/ir/function_base.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/pass_pipeline.pb.h"
 
 namespace xls {
 
+// Pass which replaces counted_for loops with a sequence of iterations.
+//
+// By default each iteration is an invoke of the loop body. If
+// `fold_iterations` is true, each iteration is instead inlined as it is created
+// and the nodes computed only from literals (e.g., from the induction variable
+// or a constant loop carry) are folded. This keeps the unrolled graph small
+// rather than materializing every iteration in full before simplification.
 class UnrollPass : public OptimizationFunctionBasePass {
  public:
   static constexpr std::string_view kName = "loop_unroll";
-  UnrollPass() : OptimizationFunctionBasePass(kName, "Unroll counted loops") {}
+  explicit UnrollPass(bool fold_iterations = false)
+      : OptimizationFunctionBasePass(kName, "Unroll counted loops"),
+        fold_iterations_(fold_iterations) {}
+
+  absl::StatusOr<PassPipelineProto::Element> ToProto() const override;
 
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+  bool UsesNodeBudget() const override { return true; }
+
+ private:
+  bool fold_iterations_;
 };
 
 }  // namespace xls
@@ -63,5 +63,99 @@ fn unrollable() -> bits[32] {
                         m::Literal(0)));
 }
 
+TEST(UnrollPassTest, FoldIterationsWithConstantCarry) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32], zero: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  add.4: bits[32] = add(zero_ext.3, accum)
+  ret add.5: bits[32] = add(add.4, zero)
+}
+
+fn unrollable() -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=3, stride=2, body=body, invariant_args=[literal.1])
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  UnrollPass pass(/*fold_iterations=*/true);
+  EXPECT_THAT(pass.RunOnFunctionBase(f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  // 0 + 2 + 4
+  EXPECT_THAT(f->return_value(), m::Literal(6));
+  // Only the initial value literal and the result remain.
+  EXPECT_EQ(f->node_count(), 2);
+}
+
+TEST(UnrollPassTest, FoldIterationsWithVariableCarry) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  umul.4: bits[32] = umul(zero_ext.3, zero_ext.3)
+  ret add.5: bits[32] = add(umul.4, accum)
+}
+
+fn unrollable(x: bits[32]) -> bits[32] {
+  ret counted_for.2: bits[32] = counted_for(x, trip_count=2, stride=3, body=body)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  UnrollPass pass(/*fold_iterations=*/true);
+  EXPECT_THAT(pass.RunOnFunctionBase(f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  // The induction variable computations are folded leaving only the adds of
+  // the loop carry.
+  EXPECT_THAT(f->return_value(),
+              m::Add(m::Literal(9), m::Add(m::Literal(0), m::Param("x"))));
+  EXPECT_EQ(f->node_count(), 5);
+}
+
+TEST(UnrollPassTest, LoopOverNodeBudgetDeferred) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  ret add.4: bits[32] = add(zero_ext.3, accum)
+}
+
+fn unrollable(x: bits[32]) -> bits[32] {
+  ret counted_for.2: bits[32] = counted_for(x, trip_count=8, stride=1, body=body)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  UnrollPass pass;
+  OptimizationPassOptions options;
+  // The package has 6 nodes and unrolling adds about 8 * 4.
+  options.node_budget = 20;
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_THAT(f->return_value(), m::CountedFor());
+  ASSERT_EQ(results.node_budget_events.size(), 1);
+  EXPECT_EQ(results.node_budget_events[0].node(), "counted_for.2");
+  EXPECT_EQ(results.node_budget_events[0].estimated_growth(), 32);
+
+  options.node_budget = 100;
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Invoke());
+  EXPECT_EQ(results.node_budget_events.size(), 1);
+}
+
 }  // namespace
 }  // namespace xls
@@ -24,7 +24,14 @@ namespace xls {
 absl::Status VerifierChecker::Run(Package* p,
                                   const OptimizationPassOptions& options,
                                   PassResults* results) const {
-  return VerifyPackage(p);
+  if (!options.incremental_verification) {
+    return VerifyPackage(p);
+  }
+  // No pass has run yet at the start of the pipeline.
+  if (results->invocations.empty()) {
+    return incremental_verifier_.VerifyFull(p);
+  }
+  return incremental_verifier_.Verify(p);
 }
 
 }  // namespace xls
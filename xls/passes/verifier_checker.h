@@ -17,16 +17,26 @@
 
 #include "absl/status/status.h"
 #include "xls/ir/package.h"
+#include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 
 namespace xls {
 
 // Invariant checker which just runs xls::Verifier.
+// Invariant checker which verifies the package. If
+// OptimizationPassOptions::incremental_verification is set, only the parts of
+// the package changed since the previous check are verified except at the
+// start of the pipeline, where the whole package is verified.
 class VerifierChecker : public OptimizationInvariantChecker {
  public:
   absl::Status Run(Package* p, const OptimizationPassOptions& options,
                    PassResults* results) const override;
+
+ private:
+  // Checkers are run sequentially between passes so the verifier state needs
+  // no synchronization.
+  mutable IncrementalVerifier incremental_verifier_;
 };
 
 }  // namespace xls
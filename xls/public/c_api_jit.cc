@@ -0,0 +1,320 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/public/c_api_jit.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/public/c_api_impl_helpers.h"
+
+namespace {
+
+const xls::FunctionJit* ToCpp(const struct xls_function_jit* jit) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<const xls::FunctionJit*>(jit);
+}
+
+xls::SerialProcRuntime* ToCpp(struct xls_serial_proc_runtime* runtime) {
+  CHECK(runtime != nullptr);
+  return reinterpret_cast<xls::SerialProcRuntime*>(runtime);
+}
+
+bool ReturnError(const absl::Status& status, char** error_out) {
+  *error_out = xls::ToOwnedCString(status.ToString());
+  return false;
+}
+
+absl::StatusOr<xls::JitChannelQueue*> GetJitChannelQueue(
+    xls::SerialProcRuntime* runtime, const char* channel_name) {
+  XLS_ASSIGN_OR_RETURN(xls::ChannelQueue * queue,
+                       runtime->queue_manager().GetQueueByName(channel_name));
+  auto* jit_queue = dynamic_cast<xls::JitChannelQueue*>(queue);
+  if (jit_queue == nullptr) {
+    return absl::InternalError(absl::StrFormat(
+        "Queue of channel `%s` is not a JIT channel queue", channel_name));
+  }
+  return jit_queue;
+}
+
+}  // namespace
+
+extern "C" {
+
+bool xls_make_function_jit(struct xls_function* function, char** error_out,
+                           struct xls_function_jit** result_out) {
+  CHECK(function != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  absl::StatusOr<std::unique_ptr<xls::FunctionJit>> jit =
+      xls::FunctionJit::Create(reinterpret_cast<xls::Function*>(function));
+  if (!jit.ok()) {
+    *result_out = nullptr;
+    return ReturnError(jit.status(), error_out);
+  }
+  *error_out = nullptr;
+  *result_out = reinterpret_cast<struct xls_function_jit*>(jit->release());
+  return true;
+}
+
+void xls_function_jit_free(struct xls_function_jit* jit) {
+  delete reinterpret_cast<xls::FunctionJit*>(jit);
+}
+
+int64_t xls_function_jit_get_arg_count(const struct xls_function_jit* jit) {
+  return ToCpp(jit)->jitted_function_base().input_buffer_sizes().size();
+}
+
+int64_t xls_function_jit_get_arg_size(const struct xls_function_jit* jit,
+                                      int64_t arg_index) {
+  CHECK_LT(arg_index, xls_function_jit_get_arg_count(jit));
+  return ToCpp(jit)->GetArgTypeSize(arg_index);
+}
+
+int64_t xls_function_jit_get_arg_alignment(const struct xls_function_jit* jit,
+                                           int64_t arg_index) {
+  CHECK_LT(arg_index, xls_function_jit_get_arg_count(jit));
+  return ToCpp(jit)->GetArgTypeAlignment(arg_index);
+}
+
+int64_t xls_function_jit_get_result_size(const struct xls_function_jit* jit) {
+  return ToCpp(jit)->GetReturnTypeSize();
+}
+
+int64_t xls_function_jit_get_result_alignment(
+    const struct xls_function_jit* jit) {
+  return ToCpp(jit)->GetReturnTypeAlignment();
+}
+
+int64_t xls_function_jit_get_batched_arg_stride(
+    const struct xls_function_jit* jit, int64_t arg_index) {
+  CHECK_LT(arg_index, xls_function_jit_get_arg_count(jit));
+  return ToCpp(jit)->GetBatchedArgStride(arg_index);
+}
+
+int64_t xls_function_jit_get_batched_result_stride(
+    const struct xls_function_jit* jit) {
+  return ToCpp(jit)->GetBatchedReturnStride();
+}
+
+bool xls_function_jit_run_with_buffers(const struct xls_function_jit* jit,
+                                       const uint8_t* const* args,
+                                       uint8_t* result, char** error_out) {
+  CHECK(result != nullptr);
+  CHECK(error_out != nullptr);
+  const xls::FunctionJit* cpp_jit = ToCpp(jit);
+  int64_t arg_count = xls_function_jit_get_arg_count(jit);
+  CHECK(arg_count == 0 || args != nullptr);
+  // The arguments are only read.
+  std::vector<uint8_t*> arg_buffers;
+  arg_buffers.reserve(arg_count);
+  for (int64_t i = 0; i < arg_count; ++i) {
+    CHECK(args[i] != nullptr);
+    arg_buffers.push_back(const_cast<uint8_t*>(args[i]));
+  }
+  xls::InterpreterEvents events;
+  absl::Status status = cpp_jit->RunWithViews(
+      arg_buffers, absl::MakeSpan(result, cpp_jit->GetReturnTypeSize()),
+      &events);
+  if (status.ok()) {
+    status = xls::InterpreterEventsToStatus(events);
+  }
+  if (!status.ok()) {
+    return ReturnError(status, error_out);
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_function_jit_run_batched_with_buffers(
+    const struct xls_function_jit* jit, const uint8_t* const* args,
+    int64_t count, uint8_t* result, char** error_out) {
+  CHECK(result != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK_GE(count, 0);
+  const xls::FunctionJit* cpp_jit = ToCpp(jit);
+  int64_t arg_count = xls_function_jit_get_arg_count(jit);
+  CHECK(arg_count == 0 || args != nullptr);
+  std::vector<absl::Span<const uint8_t>> arenas;
+  arenas.reserve(arg_count);
+  for (int64_t i = 0; i < arg_count; ++i) {
+    CHECK(args[i] != nullptr);
+    arenas.push_back(
+        absl::MakeConstSpan(args[i], count * cpp_jit->GetBatchedArgStride(i)));
+  }
+  xls::InterpreterEvents events;
+  absl::Status status = cpp_jit->RunBatchedWithViews(
+      arenas,
+      absl::MakeSpan(result, count * cpp_jit->GetBatchedReturnStride()),
+      count, &events);
+  if (status.ok()) {
+    status = xls::InterpreterEventsToStatus(events);
+  }
+  if (!status.ok()) {
+    return ReturnError(status, error_out);
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_function_jit_run(const struct xls_function_jit* jit, size_t argc,
+                          const struct xls_value** args, char** error_out,
+                          struct xls_value** result_out) {
+  CHECK(argc == 0 || args != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  std::vector<xls::Value> cpp_args;
+  cpp_args.reserve(argc);
+  for (size_t i = 0; i < argc; ++i) {
+    CHECK(args[i] != nullptr);
+    cpp_args.push_back(*reinterpret_cast<const xls::Value*>(args[i]));
+  }
+  absl::StatusOr<xls::Value> result =
+      xls::DropInterpreterEvents(ToCpp(jit)->Run(cpp_args));
+  if (!result.ok()) {
+    *result_out = nullptr;
+    return ReturnError(result.status(), error_out);
+  }
+  *error_out = nullptr;
+  *result_out = reinterpret_cast<struct xls_value*>(
+      new xls::Value(std::move(result).value()));
+  return true;
+}
+
+bool xls_make_serial_proc_runtime(struct xls_package* package,
+                                  char** error_out,
+                                  struct xls_serial_proc_runtime** result_out) {
+  CHECK(package != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  xls::Package* cpp_package = reinterpret_cast<xls::Package*>(package);
+  absl::StatusOr<std::unique_ptr<xls::SerialProcRuntime>> runtime;
+  std::optional<xls::FunctionBase*> top = cpp_package->GetTop();
+  if (top.has_value() && (*top)->IsProc() &&
+      (*top)->AsProcOrDie()->is_new_style_proc()) {
+    runtime = xls::CreateJitSerialProcRuntime((*top)->AsProcOrDie());
+  } else {
+    runtime = xls::CreateJitSerialProcRuntime(cpp_package);
+  }
+  if (!runtime.ok()) {
+    *result_out = nullptr;
+    return ReturnError(runtime.status(), error_out);
+  }
+  *error_out = nullptr;
+  *result_out =
+      reinterpret_cast<struct xls_serial_proc_runtime*>(runtime->release());
+  return true;
+}
+
+void xls_serial_proc_runtime_free(struct xls_serial_proc_runtime* runtime) {
+  delete reinterpret_cast<xls::SerialProcRuntime*>(runtime);
+}
+
+bool xls_serial_proc_runtime_tick(struct xls_serial_proc_runtime* runtime,
+                                  char** error_out) {
+  CHECK(error_out != nullptr);
+  absl::Status status = ToCpp(runtime)->Tick();
+  if (!status.ok()) {
+    return ReturnError(status, error_out);
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_serial_proc_runtime_tick_until_blocked(
+    struct xls_serial_proc_runtime* runtime, int64_t max_ticks,
+    char** error_out, int64_t* ticks_out) {
+  CHECK(error_out != nullptr);
+  CHECK(ticks_out != nullptr);
+  absl::StatusOr<int64_t> ticks = ToCpp(runtime)->TickUntilBlocked(
+      max_ticks < 0 ? std::nullopt : std::make_optional(max_ticks));
+  if (!ticks.ok()) {
+    return ReturnError(ticks.status(), error_out);
+  }
+  *error_out = nullptr;
+  *ticks_out = *ticks;
+  return true;
+}
+
+bool xls_serial_proc_runtime_get_channel_element_size(
+    struct xls_serial_proc_runtime* runtime, const char* channel_name,
+    char** error_out, int64_t* size_out) {
+  CHECK(channel_name != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(size_out != nullptr);
+  absl::StatusOr<xls::JitChannelQueue*> queue =
+      GetJitChannelQueue(ToCpp(runtime), channel_name);
+  if (!queue.ok()) {
+    return ReturnError(queue.status(), error_out);
+  }
+  *error_out = nullptr;
+  *size_out = (*queue)->type_layout().size();
+  return true;
+}
+
+bool xls_serial_proc_runtime_push_raw(struct xls_serial_proc_runtime* runtime,
+                                      const char* channel_name,
+                                      const uint8_t* data, char** error_out) {
+  CHECK(channel_name != nullptr);
+  CHECK(data != nullptr);
+  CHECK(error_out != nullptr);
+  absl::StatusOr<xls::JitChannelQueue*> queue =
+      GetJitChannelQueue(ToCpp(runtime), channel_name);
+  if (!queue.ok()) {
+    return ReturnError(queue.status(), error_out);
+  }
+  (*queue)->WriteRaw(data);
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_serial_proc_runtime_pop_raw(struct xls_serial_proc_runtime* runtime,
+                                     const char* channel_name, uint8_t* buffer,
+                                     char** error_out, bool* popped_out) {
+  CHECK(channel_name != nullptr);
+  CHECK(buffer != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(popped_out != nullptr);
+  absl::StatusOr<xls::JitChannelQueue*> queue =
+      GetJitChannelQueue(ToCpp(runtime), channel_name);
+  if (!queue.ok()) {
+    return ReturnError(queue.status(), error_out);
+  }
+  *error_out = nullptr;
+  *popped_out = (*queue)->ReadRaw(buffer);
+  return true;
+}
+
+}  // extern "C"
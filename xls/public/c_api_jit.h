@@ -0,0 +1,137 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// JIT APIs: evaluate functions and proc networks with the LLVM JIT on
+// caller-owned buffers in the JIT's native data layout.
+//
+// Compared to `xls_interpret_function` no `xls_value` is constructed per
+// argument or result: the caller writes arguments into (and reads results out
+// of) byte buffers whose sizes and alignments are queried from the JIT. The
+// layout of a value of a given type in such a buffer is an implementation
+// detail of the JIT and may change from one XLS commit to the next.
+
+#ifndef XLS_PUBLIC_C_API_JIT_H_
+#define XLS_PUBLIC_C_API_JIT_H_
+
+#include <stddef.h>  // NOLINT(modernize-deprecated-headers)
+#include <stdint.h>  // NOLINT(modernize-deprecated-headers)
+
+extern "C" {
+
+// Opaque structs.
+struct xls_function;
+struct xls_package;
+struct xls_value;
+struct xls_function_jit;
+struct xls_serial_proc_runtime;
+
+// Compiles the given `function` with the LLVM JIT. The function must outlive
+// the returned JIT, which must be freed via `xls_function_jit_free`.
+bool xls_make_function_jit(struct xls_function* function, char** error_out,
+                           struct xls_function_jit** result_out);
+
+void xls_function_jit_free(struct xls_function_jit* jit);
+
+// Returns the number of arguments of the compiled function.
+int64_t xls_function_jit_get_arg_count(const struct xls_function_jit* jit);
+
+// Returns the size in bytes and the required alignment of argument
+// `arg_index` (or the result) in the native data layout.
+int64_t xls_function_jit_get_arg_size(const struct xls_function_jit* jit,
+                                      int64_t arg_index);
+int64_t xls_function_jit_get_arg_alignment(const struct xls_function_jit* jit,
+                                           int64_t arg_index);
+int64_t xls_function_jit_get_result_size(const struct xls_function_jit* jit);
+int64_t xls_function_jit_get_result_alignment(
+    const struct xls_function_jit* jit);
+
+// Returns the distance in bytes between consecutive values of argument
+// `arg_index` (or the result) in the buffers given to
+// `xls_function_jit_run_batched_with_buffers`.
+int64_t xls_function_jit_get_batched_arg_stride(
+    const struct xls_function_jit* jit, int64_t arg_index);
+int64_t xls_function_jit_get_batched_result_stride(
+    const struct xls_function_jit* jit);
+
+// Runs the compiled function on `args` (one buffer per argument, each holding
+// a value in the native layout) and writes the result into `result`, which
+// must hold at least `xls_function_jit_get_result_size` bytes. Buffers which
+// have the required alignment are used in place; others are copied.
+//
+// May be called concurrently from multiple threads on the same JIT.
+bool xls_function_jit_run_with_buffers(const struct xls_function_jit* jit,
+                                       const uint8_t* const* args,
+                                       uint8_t* result, char** error_out);
+
+// Runs the compiled function on `count` argument sets with a single call into
+// the jitted code. `args[i]` holds `count` values of argument `i`,
+// `xls_function_jit_get_batched_arg_stride(jit, i)` bytes apart, and the
+// results are written into `result` likewise. All buffers must have the
+// required alignment; nothing is copied.
+//
+// May be called concurrently from multiple threads on the same JIT.
+bool xls_function_jit_run_batched_with_buffers(
+    const struct xls_function_jit* jit, const uint8_t* const* args,
+    int64_t count, uint8_t* result, char** error_out);
+
+// As `xls_interpret_function` but runs the compiled function.
+bool xls_function_jit_run(const struct xls_function_jit* jit, size_t argc,
+                          const struct xls_value** args, char** error_out,
+                          struct xls_value** result_out);
+
+// Creates a runtime which ticks the procs of `package` serially, each compiled
+// with the LLVM JIT. If the top of the package is a proc with proc-scoped
+// channels, the runtime evaluates the elaboration of that proc. The package
+// must outlive the returned runtime, which must be freed via
+// `xls_serial_proc_runtime_free`.
+bool xls_make_serial_proc_runtime(struct xls_package* package,
+                                  char** error_out,
+                                  struct xls_serial_proc_runtime** result_out);
+
+void xls_serial_proc_runtime_free(struct xls_serial_proc_runtime* runtime);
+
+// Executes a single tick of every proc in the network.
+bool xls_serial_proc_runtime_tick(struct xls_serial_proc_runtime* runtime,
+                                  char** error_out);
+
+// Ticks the network until all procs are blocked on receives, at most
+// `max_ticks` times (unbounded if negative). The number of ticks executed is
+// placed in `ticks_out`.
+bool xls_serial_proc_runtime_tick_until_blocked(
+    struct xls_serial_proc_runtime* runtime, int64_t max_ticks,
+    char** error_out, int64_t* ticks_out);
+
+// Returns the size in bytes of the buffers holding one element of the channel
+// named `channel_name` for `xls_serial_proc_runtime_push_raw` and
+// `xls_serial_proc_runtime_pop_raw`.
+bool xls_serial_proc_runtime_get_channel_element_size(
+    struct xls_serial_proc_runtime* runtime, const char* channel_name,
+    char** error_out, int64_t* size_out);
+
+// Pushes the element in `data`, in the native layout of the channel type, onto
+// the channel named `channel_name`.
+bool xls_serial_proc_runtime_push_raw(struct xls_serial_proc_runtime* runtime,
+                                      const char* channel_name,
+                                      const uint8_t* data, char** error_out);
+
+// Pops an element off the channel named `channel_name` into `buffer` if the
+// channel is not empty. Whether an element was popped is placed in
+// `popped_out`.
+bool xls_serial_proc_runtime_pop_raw(struct xls_serial_proc_runtime* runtime,
+                                     const char* channel_name, uint8_t* buffer,
+                                     char** error_out, bool* popped_out);
+
+}  // extern "C"
+
+#endif  // XLS_PUBLIC_C_API_JIT_H_
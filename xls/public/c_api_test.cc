@@ -15,6 +15,7 @@
 #include "xls/public/c_api.h"
 
 #include <cstdint>
+#include <cstring>
 #include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
@@ -366,6 +367,150 @@ fn f(x: bits[32] id=3) -> bits[32] {
   ASSERT_TRUE(xls_value_eq(ft, result));
 }
 
+TEST(XlsCApiTest, FunctionJitRunWithBuffers) {
+  const std::string kPackage = R"(package p
+
+fn f(x: bits[32] id=1, y: bits[32] id=2) -> bits[32] {
+  ret add.3: bits[32] = add(x, y, id=3)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_function* function = nullptr;
+  ASSERT_TRUE(xls_package_get_function(package, "f", &error, &function));
+
+  struct xls_function_jit* jit = nullptr;
+  ASSERT_TRUE(xls_make_function_jit(function, &error, &jit))
+      << "xls_make_function_jit error: " << error;
+  absl::Cleanup free_jit([jit] { xls_function_jit_free(jit); });
+
+  ASSERT_EQ(xls_function_jit_get_arg_count(jit), 2);
+  ASSERT_EQ(xls_function_jit_get_arg_size(jit, 0), 4);
+  ASSERT_EQ(xls_function_jit_get_result_size(jit), 4);
+  ASSERT_LE(xls_function_jit_get_arg_alignment(jit, 0), 4);
+
+  uint32_t x = 40;
+  uint32_t y = 2;
+  uint32_t result = 0;
+  const uint8_t* args[] = {reinterpret_cast<const uint8_t*>(&x),
+                           reinterpret_cast<const uint8_t*>(&y)};
+  ASSERT_TRUE(xls_function_jit_run_with_buffers(
+      jit, args, reinterpret_cast<uint8_t*>(&result), &error))
+      << "xls_function_jit_run_with_buffers error: " << error;
+  EXPECT_EQ(result, 42);
+
+  // Run a batch of argument sets laid out at the batched strides.
+  constexpr int64_t kCount = 8;
+  int64_t arg_stride = xls_function_jit_get_batched_arg_stride(jit, 0);
+  int64_t result_stride = xls_function_jit_get_batched_result_stride(jit);
+  ASSERT_LE(arg_stride, 64);
+  ASSERT_LE(result_stride, 64);
+  alignas(64) uint8_t xs[kCount * 64] = {};
+  alignas(64) uint8_t ys[kCount * 64] = {};
+  alignas(64) uint8_t results[kCount * 64] = {};
+  for (int64_t i = 0; i < kCount; ++i) {
+    uint32_t x_i = i;
+    uint32_t y_i = 100 * i;
+    memcpy(xs + i * arg_stride, &x_i, sizeof(x_i));
+    memcpy(ys + i * arg_stride, &y_i, sizeof(y_i));
+  }
+  const uint8_t* batched_args[] = {xs, ys};
+  ASSERT_TRUE(xls_function_jit_run_batched_with_buffers(
+      jit, batched_args, kCount, results, &error))
+      << "xls_function_jit_run_batched_with_buffers error: " << error;
+  for (int64_t i = 0; i < kCount; ++i) {
+    uint32_t result_i;
+    memcpy(&result_i, results + i * result_stride, sizeof(result_i));
+    EXPECT_EQ(result_i, static_cast<uint32_t>(101 * i));
+  }
+
+  // The Value-based entry point agrees.
+  struct xls_value* x_value = nullptr;
+  struct xls_value* y_value = nullptr;
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:40", &error, &x_value));
+  absl::Cleanup free_x([x_value] { xls_value_free(x_value); });
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:2", &error, &y_value));
+  absl::Cleanup free_y([y_value] { xls_value_free(y_value); });
+  const struct xls_value* value_args[] = {x_value, y_value};
+  struct xls_value* result_value = nullptr;
+  ASSERT_TRUE(
+      xls_function_jit_run(jit, /*argc=*/2, value_args, &error, &result_value));
+  absl::Cleanup free_result([result_value] { xls_value_free(result_value); });
+  char* result_str = nullptr;
+  ASSERT_TRUE(xls_value_to_string(result_value, &result_str));
+  absl::Cleanup free_result_str([result_str] { xls_c_str_free(result_str); });
+  EXPECT_EQ(std::string_view(result_str), "bits[32]:42");
+}
+
+TEST(XlsCApiTest, SerialProcRuntimePushAndPopRaw) {
+  const std::string kPackage = R"(package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid)
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid)
+
+top proc accumulate(sum: bits[32], init={0}) {
+  tkn: token = literal(value=token)
+  rcv: (token, bits[32]) = receive(tkn, channel=in)
+  rcv_token: token = tuple_index(rcv, index=0)
+  rcv_data: bits[32] = tuple_index(rcv, index=1)
+  next_sum: bits[32] = add(sum, rcv_data)
+  send: token = send(rcv_token, next_sum, channel=out)
+  next (next_sum)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_serial_proc_runtime* runtime = nullptr;
+  ASSERT_TRUE(xls_make_serial_proc_runtime(package, &error, &runtime))
+      << "xls_make_serial_proc_runtime error: " << error;
+  absl::Cleanup free_runtime(
+      [runtime] { xls_serial_proc_runtime_free(runtime); });
+
+  int64_t element_size = 0;
+  ASSERT_TRUE(xls_serial_proc_runtime_get_channel_element_size(
+      runtime, "in", &error, &element_size));
+  ASSERT_EQ(element_size, 4);
+
+  for (uint32_t input : {1, 2, 3}) {
+    ASSERT_TRUE(xls_serial_proc_runtime_push_raw(
+        runtime, "in", reinterpret_cast<const uint8_t*>(&input), &error))
+        << "xls_serial_proc_runtime_push_raw error: " << error;
+  }
+  int64_t ticks = 0;
+  ASSERT_TRUE(xls_serial_proc_runtime_tick_until_blocked(
+      runtime, /*max_ticks=*/100, &error, &ticks))
+      << "xls_serial_proc_runtime_tick_until_blocked error: " << error;
+
+  for (uint32_t expected : {1, 3, 6}) {
+    uint32_t output = 0;
+    bool popped = false;
+    ASSERT_TRUE(xls_serial_proc_runtime_pop_raw(
+        runtime, "out", reinterpret_cast<uint8_t*>(&output), &error, &popped));
+    ASSERT_TRUE(popped);
+    EXPECT_EQ(output, expected);
+  }
+  uint32_t output = 0;
+  bool popped = true;
+  ASSERT_TRUE(xls_serial_proc_runtime_pop_raw(
+      runtime, "out", reinterpret_cast<uint8_t*>(&output), &error, &popped));
+  EXPECT_FALSE(popped);
+
+  EXPECT_FALSE(xls_serial_proc_runtime_get_channel_element_size(
+      runtime, "nonexistent", &error, &element_size));
+  absl::Cleanup free_error([error] { xls_c_str_free(error); });
+  EXPECT_THAT(error, HasSubstr("nonexistent"));
+}
+
 TEST(XlsCApiTest, ParsePackageAndOptimizeFunctionInIt) {
   const std::string kPackage = R"(
 package p
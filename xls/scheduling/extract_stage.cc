@@ -25,8 +25,9 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
-#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
 namespace xls {
@@ -34,50 +35,57 @@ namespace xls {
 absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
                                        const PipelineSchedule& schedule,
                                        int stage) {
-  // Create a new function in the package which only contains the nodes at the
-  // given stage (cycle).
-  Package* package = src->package();
+  return ExtractStage(src, schedule, stage, src->package());
+}
+
+absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
+                                       const PipelineSchedule& schedule,
+                                       int stage, Package* target) {
+  // Create a new function in the target package which only contains the nodes
+  // at the given stage (cycle). The schedule holds the nodes of each cycle in
+  // topological order so only the nodes of the stage need to be visited.
   auto new_f = std::make_unique<Function>(
-      absl::StrFormat("%s_stage_%d", src->name(), stage), package);
+      absl::StrFormat("%s_stage_%d", src->name(), stage), target);
   absl::flat_hash_map<Node*, Node*> node_map;
   std::vector<Node*> live_out;
-  for (Node* node : TopoSort(src)) {
-    if (schedule.cycle(node) == stage) {
-      std::vector<Node*> new_operands;
-      for (Node* operand : node->operands()) {
-        if (node_map.contains(operand)) {
-          new_operands.push_back(node_map.at(operand));
-        } else {
-          Node* new_param = new_f->AddNode(
-              std::make_unique<Param>(operand->loc(), operand->GetType(),
-                                      operand->GetName(), new_f.get()));
-          node_map[operand] = new_param;
-          new_operands.push_back(new_param);
-        }
-      }
-      // hack to support viewing procs as functions
-      Node* new_node;
-      if (node->Is<StateRead>() || node->Is<Next>() || node->Is<Send>() ||
-          node->Is<Receive>()) {
-        // NB The fact that data-dependencies is dropped is fine since prior to
-        // this anything used by the Send or Next node is marked for return
-        // below.
-        new_node = new_f->AddNode(std::make_unique<xls::Param>(
-            node->loc(), node->GetType(), node->GetName(), new_f.get()));
+  for (Node* node : schedule.nodes_in_cycle(stage)) {
+    std::vector<Node*> new_operands;
+    for (Node* operand : node->operands()) {
+      if (node_map.contains(operand)) {
+        new_operands.push_back(node_map.at(operand));
       } else {
         XLS_ASSIGN_OR_RETURN(
-            new_node, node->CloneInNewFunction(new_operands, new_f.get()));
-      }
-      node_map[node] = new_node;
-      // NB This checks whether the value is *USED* by a send or next and
-      // returns it.
-      if (std::any_of(node->users().begin(), node->users().end(), [&](Node* u) {
-            return schedule.cycle(u) > stage || u->Is<Send>() ||
-                   u->Is<Next>() || new_f->HasImplicitUse(node);
-          })) {
-        live_out.push_back(new_node);
+            Type * type, target->MapTypeFromOtherPackage(operand->GetType()));
+        Node* new_param = new_f->AddNode(std::make_unique<Param>(
+            operand->loc(), type, operand->GetName(), new_f.get()));
+        node_map[operand] = new_param;
+        new_operands.push_back(new_param);
       }
     }
+    // hack to support viewing procs as functions
+    Node* new_node;
+    if (node->Is<StateRead>() || node->Is<Next>() || node->Is<Send>() ||
+        node->Is<Receive>()) {
+      // NB The fact that data-dependencies is dropped is fine since prior to
+      // this anything used by the Send or Next node is marked for return
+      // below.
+      XLS_ASSIGN_OR_RETURN(Type * type,
+                           target->MapTypeFromOtherPackage(node->GetType()));
+      new_node = new_f->AddNode(std::make_unique<xls::Param>(
+          node->loc(), type, node->GetName(), new_f.get()));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          new_node, node->CloneInNewFunction(new_operands, new_f.get()));
+    }
+    node_map[node] = new_node;
+    // NB This checks whether the value is *USED* by a send or next and
+    // returns it.
+    if (std::any_of(node->users().begin(), node->users().end(), [&](Node* u) {
+          return schedule.cycle(u) > stage || u->Is<Send>() ||
+                 u->Is<Next>() || new_f->HasImplicitUse(node);
+        })) {
+      live_out.push_back(new_node);
+    }
   }
 
   // If this stage doesn't include the function output, create a final tuple
@@ -97,6 +105,6 @@ absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
       XLS_RETURN_IF_ERROR(new_f->set_return_value(return_tuple));
     }
   }
-  return package->AddFunction(std::move(new_f));
+  return target->AddFunction(std::move(new_f));
 }
 }  // namespace xls
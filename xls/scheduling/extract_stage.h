@@ -18,6 +18,7 @@
 #include "absl/status/statusor.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
 namespace xls {
@@ -28,6 +29,14 @@ absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
                                        const PipelineSchedule& schedule,
                                        int stage);
 
+// As above, but adds the new function to `target` rather than to the package
+// of `src`. Only the nodes scheduled in `stage` are visited, so extracting a
+// stage into a fresh package costs time and memory proportional to the size of
+// the stage rather than the size of `src`.
+absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
+                                       const PipelineSchedule& schedule,
+                                       int stage, Package* target);
+
 }  // namespace xls
 
 #endif  // XLS_SCHEDULING_EXTRACT_STAGE_H_
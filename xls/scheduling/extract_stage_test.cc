@@ -214,5 +214,42 @@ TEST_F(ExtractStageTest, ProcSchedule) {
   EXPECT_EQ(schedule.length(), 3);
 }
 
+// Verifies that stages can be extracted into a separate package which contains
+// nothing but the extracted stage.
+TEST_F(ExtractStageTest, ExtractIntoNewPackage) {
+  std::string ir_text = R"(
+package p
+
+fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
+  add.1: bits[3] = add(i0, i1)
+  sub.2: bits[3] = sub(add.1, i1)
+  ret and.3: bits[3] = and(sub.2, add.1)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetFunction("main"));
+  ScheduleCycleMap cycle_map;
+  cycle_map[FindNode("i0", function)] = 0;
+  cycle_map[FindNode("i1", function)] = 0;
+  cycle_map[FindNode("add.1", function)] = 0;
+  cycle_map[FindNode("sub.2", function)] = 1;
+  cycle_map[FindNode("and.3", function)] = 1;
+  PipelineSchedule schedule(function, cycle_map);
+
+  Package extracted("extracted");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * stage_fn,
+                           ExtractStage(function, schedule, 1, &extracted));
+  EXPECT_EQ(stage_fn->package(), &extracted);
+  EXPECT_EQ(extracted.functions().size(), 1);
+  EXPECT_EQ(package->functions().size(), 1);
+  EXPECT_THAT(stage_fn->return_value(),
+              m::And(m::Sub(m::Param(), m::Param("i1")), m::Param()));
+  EXPECT_EQ(stage_fn->params().size(), 2);
+  for (Node* param : stage_fn->params()) {
+    EXPECT_EQ(param->GetType(), extracted.GetBitsType(3));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -157,18 +157,20 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
   VLOG(4) << "Initial bounds:";
   XLS_VLOG_LINES(4, bounds->ToString());
 
+  // Bound propagation only revisits the nodes after (before) the earliest
+  // (latest) tightened one, so pin all the nodes before propagating.
   for (const SchedulingConstraint& constraint : constraints) {
     if (std::holds_alternative<RecvsFirstSendsLastConstraint>(constraint)) {
       for (Node* node : f->nodes()) {
         if (node->Is<Receive>()) {
           XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
-          XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
         }
         if (node->Is<Send>()) {
           XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, pipeline_stages - 1));
-          XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
         }
       }
+      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+      XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
     } else {
       return absl::InternalError(
           "MinCutScheduler doesn't support constraints "
@@ -187,12 +189,11 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
   if (Proc* proc = dynamic_cast<Proc*>(f)) {
     for (Node* node : proc->params()) {
       XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
-      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
     }
     for (Node* node : proc->NextState()) {
       XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
-      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
     }
+    XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
   }
 
   // Try a number of different orderings of cycle boundary at which the min-cut
@@ -966,9 +966,9 @@ struct PredicateSet {
   }
 };
 
-using NodeSet = absl::btree_set<Node*, Node::NodeIdLessThan>;
+using SortedNodeSet = absl::btree_set<Node*, Node::NodeIdLessThan>;
 template <typename T>
-using NodeMap = absl::btree_map<Node*, T, Node::NodeIdLessThan>;
+using SortedNodeMap = absl::btree_map<Node*, T, Node::NodeIdLessThan>;
 
 absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<PostDominatorAnalysis> pda,
@@ -982,7 +982,7 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   // First, take each select and add to the `PredicateSet` of all nodes
   // that are postdominated by one of its cases a predicate of the form
   // `selector == case_number`.
-  NodeMap<PredicateSet> predicate_sets;
+  SortedNodeMap<PredicateSet> predicate_sets;
   for (Node* node : TopoSort(f)) {
     if (node->Is<Select>()) {
       Select* select = node->As<Select>();
@@ -1020,7 +1020,7 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   // Second, create a map from predicate set to nodes, which is intended to
   // exploit the fact that two nodes may (and will often) have the same
   // predicate set, so we only want to create nodes for that predicate set once.
-  absl::btree_map<PredicateSet, NodeSet> inverse_predicate_sets;
+  absl::btree_map<PredicateSet, SortedNodeSet> inverse_predicate_sets;
   for (const auto& [node, predicate_set] : predicate_sets) {
     inverse_predicate_sets[predicate_set].insert(node);
   }
@@ -1055,7 +1055,8 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   // Fourth, we create a mapping from selector to the value of the selector
   // to set of nodes that contain that selector-value pair, which will be used
   // later in creating mutual exclusion edges.
-  NodeMap<absl::btree_map<Bits, NodeSet, BitsLT>> selector_to_value_to_preds;
+  SortedNodeMap<absl::btree_map<Bits, SortedNodeSet, BitsLT>>
+      selector_to_value_to_preds;
 
   // Fifth, we AND together all the select predicates that apply to a given node
   // and then AND that with the current predicate of that node via the call to
@@ -0,0 +1,239 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/partitioned_sdc_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "ortools/math_opt/cpp/math_opt.h"
+
+namespace xls {
+
+namespace {
+
+using DelayMap = absl::flat_hash_map<Node*, int64_t>;
+namespace math_opt = ::operations_research::math_opt;
+
+int64_t MinDelayOf(Node* node) {
+  return node->Is<MinDelay>() ? node->As<MinDelay>()->delay() : 0;
+}
+
+// Solves the SDC problem for the nodes of `partition`, which must be
+// contiguous in topological order with every earlier node already in
+// `cycle_map`. `last_use` holds, for each scheduled node, the latest cycle in
+// which its value is used so far. Returns std::nullopt if the solver does not
+// find an optimal solution.
+absl::StatusOr<std::optional<ScheduleCycleMap>> SolvePartition(
+    absl::Span<Node* const> partition, int64_t clock_period_ps,
+    const DelayMap& delay_map, const sched::ScheduleBounds& bounds,
+    const absl::flat_hash_map<Node*, int64_t>& last_use) {
+  math_opt::Model model("partition");
+  math_opt::LinearExpression objective;
+  const double infinity = std::numeric_limits<double>::infinity();
+
+  absl::flat_hash_map<Node*, math_opt::Variable> cycle_var;
+  absl::flat_hash_map<Node*, math_opt::Variable> lifetime_var;
+  for (Node* node : partition) {
+    cycle_var.emplace(node, model.AddContinuousVariable(
+                                static_cast<double>(bounds.lb(node)),
+                                static_cast<double>(bounds.ub(node)),
+                                node->GetName()));
+    lifetime_var.emplace(
+        node, model.AddContinuousVariable(
+                  0.0, infinity, absl::StrFormat("lifetime_%s",
+                                                 node->GetName())));
+    // Same weighting as the full SDC objective; the cycle term favors ASAP
+    // schedules among equally good ones.
+    objective += 1024 *
+                 static_cast<double>(node->GetType()->GetFlatBitCount()) *
+                 lifetime_var.at(node);
+    objective += cycle_var.at(node);
+  }
+
+  // Values defined in earlier partitions are already live up to
+  // `last_use`; using them later costs the extension beyond that point.
+  absl::flat_hash_map<Node*, math_opt::Variable> extension_var;
+  for (Node* node : partition) {
+    math_opt::Variable cycle = cycle_var.at(node);
+    for (Node* operand : node->operands()) {
+      if (auto it = cycle_var.find(operand); it != cycle_var.end()) {
+        model.AddLinearConstraint(
+            cycle - it->second >= static_cast<double>(MinDelayOf(node)));
+        model.AddLinearConstraint(lifetime_var.at(operand) + it->second -
+                                      cycle >=
+                                  0.0);
+        continue;
+      }
+      auto [it, inserted] = extension_var.try_emplace(operand);
+      if (inserted) {
+        it->second = model.AddContinuousVariable(
+            0.0, infinity, absl::StrFormat("extension_%s", operand->GetName()));
+        objective +=
+            1024 * static_cast<double>(operand->GetType()->GetFlatBitCount()) *
+            it->second;
+      }
+      model.AddLinearConstraint(it->second - cycle >=
+                                -static_cast<double>(last_use.at(operand)));
+    }
+    // Users in later partitions are not scheduled yet; their lower bounds are
+    // the best available estimate of where they will land.
+    for (Node* user : node->users()) {
+      if (!cycle_var.contains(user)) {
+        model.AddLinearConstraint(lifetime_var.at(node) + cycle >=
+                                  static_cast<double>(bounds.lb(user)));
+      }
+    }
+  }
+
+  // Critical-path distances between nodes of the partition. Paths entering
+  // from earlier partitions are accounted for by lower-bound propagation when
+  // the result is committed.
+  absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
+      distances_to_node;
+  distances_to_node.reserve(partition.size());
+  for (Node* node : partition) {
+    absl::flat_hash_map<Node*, int64_t>& distances = distances_to_node[node];
+    int64_t node_delay = delay_map.at(node);
+    distances[node] = node_delay;
+    for (Node* operand : node->operands()) {
+      auto operand_it = distances_to_node.find(operand);
+      if (operand_it == distances_to_node.end()) {
+        continue;
+      }
+      for (auto [source, operand_distance] : operand_it->second) {
+        int64_t& distance = distances[source];
+        distance = std::max(distance, operand_distance + node_delay);
+      }
+    }
+  }
+  // Only the first node on each path to exceed the clock period needs a
+  // constraint; the nodes after it are ordered by the causal constraints.
+  for (Node* target : partition) {
+    int64_t target_delay = delay_map.at(target);
+    for (auto [source, distance] : distances_to_node.at(target)) {
+      if (distance > clock_period_ps &&
+          distance - target_delay <= clock_period_ps) {
+        model.AddLinearConstraint(cycle_var.at(target) - cycle_var.at(source) >=
+                                  1.0);
+      }
+    }
+  }
+  distances_to_node.clear();
+
+  model.Minimize(objective);
+  XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result,
+                       math_opt::Solve(model, math_opt::SolverType::kGlop));
+  if (result.termination.reason != math_opt::TerminationReason::kOptimal) {
+    VLOG(2) << "Partition solve did not terminate optimally: "
+            << result.termination;
+    return std::nullopt;
+  }
+  math_opt::VariableMap<double> values = result.variable_values();
+  ScheduleCycleMap cycles;
+  for (Node* node : partition) {
+    double cycle = values.at(cycle_var.at(node));
+    if (std::fabs(cycle - std::round(cycle)) > 0.001) {
+      return absl::InternalError(
+          "The scheduling result is expected to be integer");
+    }
+    cycles[node] = std::lround(cycle);
+  }
+  return cycles;
+}
+
+}  // namespace
+
+absl::StatusOr<ScheduleCycleMap> PartitionedSDCScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    int64_t partition_size) {
+  XLS_RET_CHECK_GT(partition_size, 0);
+  XLS_RET_CHECK_LT(bounds->max_lower_bound(), pipeline_stages);
+  VLOG(3) << absl::StreamFormat(
+      "PartitionedSDCScheduler: %d nodes, %d stages, partitions of %d",
+      f->node_count(), pipeline_stages, partition_size);
+
+  XLS_ASSIGN_OR_RETURN(DelayMap delay_map,
+                       delay_estimator.GetOperationDelaysInPs(f));
+
+  std::vector<Node*> topo_sort = TopoSort(f);
+  ScheduleCycleMap cycle_map;
+  absl::flat_hash_map<Node*, int64_t> last_use;
+  for (int64_t start = 0; start < topo_sort.size(); start += partition_size) {
+    absl::Span<Node* const> partition = absl::MakeConstSpan(topo_sort).subspan(
+        start, std::min<int64_t>(partition_size, topo_sort.size() - start));
+    XLS_ASSIGN_OR_RETURN(std::optional<ScheduleCycleMap> cycles,
+                         SolvePartition(partition, clock_period_ps, delay_map,
+                                        *bounds, last_use));
+
+    // Commit the solution as lower bounds so propagation fixes any path which
+    // is too long once combined with the previous partitions. If that makes
+    // the bounds infeasible, fall back to scheduling the partition ASAP,
+    // which the current bounds already guarantee to be valid.
+    if (cycles.has_value()) {
+      sched::ScheduleBounds saved_bounds = *bounds;
+      absl::Status status = absl::OkStatus();
+      for (Node* node : partition) {
+        status = bounds->TightenNodeLb(node, cycles->at(node));
+        if (!status.ok()) {
+          break;
+        }
+      }
+      if (status.ok()) {
+        status = bounds->PropagateLowerBounds();
+      }
+      if (!status.ok()) {
+        if (!absl::IsResourceExhausted(status)) {
+          return status;
+        }
+        VLOG(2) << "Scheduling partition at node " << start
+                << " ASAP: " << status;
+        *bounds = std::move(saved_bounds);
+      }
+    }
+
+    for (Node* node : partition) {
+      int64_t cycle = bounds->lb(node);
+      cycle_map[node] = cycle;
+      last_use[node] = std::max(last_use[node], cycle);
+      for (Node* operand : node->operands()) {
+        last_use[operand] = std::max(last_use.at(operand), cycle);
+      }
+    }
+  }
+  return cycle_map;
+}
+
+}  // namespace xls
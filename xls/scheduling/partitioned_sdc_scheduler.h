@@ -0,0 +1,56 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_PARTITIONED_SDC_SCHEDULER_H_
+#define XLS_SCHEDULING_PARTITIONED_SDC_SCHEDULER_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// The default number of nodes in each partition of the partitioned SDC
+// scheduler. The all-pairs timing analysis of a partition is quadratic in this
+// size.
+inline constexpr int64_t kDefaultSchedulingPartitionSize = 2048;
+
+// Schedules the given function into a pipeline with the given clock period
+// without building a single SDC problem over the whole function.
+//
+// The topological order of `f` is split into partitions of at most
+// `partition_size` nodes, which are scheduled in order. Each partition is
+// scheduled by a small SDC problem which minimizes pipeline register bits
+// within the partition's nodes, with the nodes of earlier partitions fixed at
+// their cycles and those of later partitions represented by their current
+// lower bounds. The chosen cycles are then committed through `bounds`, whose
+// lower-bound propagation repairs any timing violation across the partition
+// boundary, so the result is always a valid schedule. Memory and time grow
+// linearly with the number of partitions rather than quadratically with the
+// size of `f`.
+//
+// `bounds` must hold the ASAP/ALAP bounds of `f` for `pipeline_stages`; it is
+// updated as nodes are scheduled. Scheduling constraints are not supported.
+absl::StatusOr<ScheduleCycleMap> PartitionedSDCScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    int64_t partition_size = kDefaultSchedulingPartitionSize);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_PARTITIONED_SDC_SCHEDULER_H_
@@ -118,12 +118,25 @@ absl::StatusOr<PipelineSchedule> PipelineSchedule::FromProto(
   if (schedule_it == package_schedules_proto.schedules().end()) {
     return absl::InvalidArgumentError("Function does not have a schedule.");
   }
+  // Index the nodes by name up front; FunctionBase::GetNode is a linear scan
+  // which would make loading the schedule of a large design quadratic.
+  absl::flat_hash_map<std::string, Node*> nodes_by_name;
+  nodes_by_name.reserve(function->node_count());
+  for (Node* node : function->nodes()) {
+    nodes_by_name.emplace(node->GetName(), node);
+  }
   ScheduleCycleMap cycle_map;
   for (const auto& stage : schedule_it->second.stages()) {
     for (const auto& timed_node : stage.timed_nodes()) {
       // NOTE: we handle timing with our estimator, so ignore timings from proto
       // but it might be useful in the future to e.g. detect regressions.
-      XLS_ASSIGN_OR_RETURN(Node * node, function->GetNode(timed_node.node()));
+      auto node_it = nodes_by_name.find(timed_node.node());
+      Node* node;
+      if (node_it != nodes_by_name.end()) {
+        node = node_it->second;
+      } else {
+        XLS_ASSIGN_OR_RETURN(node, function->GetNode(timed_node.node()));
+      }
       cycle_map[node] = stage.stage();
     }
   }
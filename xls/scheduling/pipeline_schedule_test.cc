@@ -289,6 +289,101 @@ TEST_F(PipelineScheduleTest, MinimizeRegisterBitslices) {
       UnorderedElementsAre(m::BitSlice(m::Param("x")), m::Neg(), m::Concat()));
 }
 
+TEST_F(PipelineScheduleTest, PartitionedMinimizeRegisterBitslices) {
+  // The same function as above, scheduled partition by partition; a single
+  // partition should find the same schedule as the full SDC problem.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto x_slice = fb.BitSlice(x, /*start=*/8, /*width=*/8);
+  auto y_slice = fb.BitSlice(y, /*start=*/8, /*width=*/8);
+  auto neg_neg_y = fb.Negate(fb.Negate(y));
+  fb.Concat({x, x_slice, y_slice, neg_neg_y});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(f, TestDelayEstimator(),
+                          SchedulingOptions()
+                              .clock_period_ps(1)
+                              .partitioned_scheduling_threshold(1)));
+
+  EXPECT_EQ(schedule.length(), 2);
+  EXPECT_THAT(schedule.nodes_in_cycle(0),
+              UnorderedElementsAre(m::Param("x"), m::Param("y"),
+                                   m::BitSlice(m::Param("y")), m::Neg()));
+  EXPECT_THAT(
+      schedule.nodes_in_cycle(1),
+      UnorderedElementsAre(m::BitSlice(m::Param("x")), m::Neg(), m::Concat()));
+}
+
+TEST_F(PipelineScheduleTest, MultiCycleOperation) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  auto x = fb.Param("x", u32);
+  auto y = fb.Param("y", u32);
+  auto z = fb.Param("z", u32);
+  fb.Add(fb.UDiv(x, y), z);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // The divide is longer than the clock period, so it cannot be scheduled
+  // unless it may span stages.
+  EXPECT_FALSE(RunPipelineSchedule(f, TestDelayEstimator(),
+                                   SchedulingOptions().clock_period_ps(1))
+                   .ok());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(1).multi_cycle_ops({Op::kUDiv})));
+  EXPECT_EQ(schedule.length(), 3);
+  EXPECT_THAT(schedule.nodes_in_cycle(0),
+              IsSupersetOf({m::Param("x"), m::Param("y"), m::UDiv()}));
+  EXPECT_THAT(schedule.nodes_in_cycle(2), Contains(m::Add()));
+}
+
+TEST_F(PipelineScheduleTest, MultiCycleReturnValue) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  fb.UDiv(fb.Param("x", u32), fb.Param("y", u32));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(1).multi_cycle_ops({Op::kUDiv})));
+  // The divide's result is registered into a new return value after the
+  // stages it spans.
+  EXPECT_THAT(f->return_value(), m::Identity(m::UDiv()));
+  EXPECT_EQ(schedule.length(), 3);
+  EXPECT_EQ(schedule.cycle(f->return_value()->operand(0)), 0);
+  EXPECT_EQ(schedule.cycle(f->return_value()), 2);
+}
+
+TEST_F(PipelineScheduleTest, MultiCycleOperationRequiresClockPeriod) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  fb.UDiv(fb.Param("x", u32), fb.Param("y", u32));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(RunPipelineSchedule(
+                  f, TestDelayEstimator(),
+                  SchedulingOptions().pipeline_stages(3).multi_cycle_ops(
+                      {Op::kUDiv})),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("--clock_period_ps")));
+}
+
 TEST_F(PipelineScheduleTest, AsapScheduleComplex) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
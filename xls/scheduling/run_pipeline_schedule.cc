@@ -37,6 +37,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/binary_search.h"
@@ -55,6 +56,7 @@
 #include "xls/ir/proc.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/scheduling/min_cut_scheduler.h"
+#include "xls/scheduling/partitioned_sdc_scheduler.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/schedule_bounds.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -322,6 +324,85 @@ absl::StatusOr<int64_t> FindMinimumWorstCaseThroughput(
   return min_worst_case_throughput;
 }
 
+// Schedules `f` with the operations of `options.multi_cycle_ops()` allowed to
+// span several stages. An operation whose delay d exceeds the clock period c
+// needs k = ceil(d / c) stages: it is scheduled with the delay d - (k - 1) * c
+// in its first stage, leaving it the k - 1 stages after, and its users are
+// constrained to be at least k stages later. The k pipeline registers between
+// them give synthesis retiming what it needs to pipeline the operation.
+absl::StatusOr<PipelineSchedule> RunMultiCycleSchedule(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options,
+    const synthesis::Synthesizer* synthesizer) {
+  if (!options.clock_period_ps().has_value()) {
+    return absl::InvalidArgumentError(
+        "Multi-cycle operations (--multi_cycle_ops) require "
+        "--clock_period_ps to be specified.");
+  }
+  SchedulingOptions single_cycle_options = options;
+  single_cycle_options.multi_cycle_ops({});
+  int64_t clock_period_ps = *options.clock_period_ps();
+  if (options.clock_margin_percent().has_value()) {
+    clock_period_ps -=
+        (clock_period_ps * *options.clock_margin_percent() + 50) / 100;
+  }
+  if (clock_period_ps <= 0) {
+    // Let the scheduler report the invalid clock period.
+    return RunPipelineSchedule(f, delay_estimator, single_cycle_options,
+                               synthesizer);
+  }
+
+  absl::flat_hash_map<Node*, int64_t> stages;
+  for (Node* node : f->nodes()) {
+    if (!options.multi_cycle_ops().contains(node->op())) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    int64_t node_stages = CeilOfRatio(delay, clock_period_ps);
+    if (node_stages > 1) {
+      stages[node] = node_stages;
+    }
+  }
+  if (stages.empty()) {
+    return RunPipelineSchedule(f, delay_estimator, single_cycle_options,
+                               synthesizer);
+  }
+
+  if (f->IsFunction()) {
+    // The return value is in the last stage, which leaves no room for the
+    // stages of a multi-cycle operation; give it a user to register it into.
+    Function* function = f->AsFunctionOrDie();
+    Node* return_value = function->return_value();
+    if (stages.contains(return_value)) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * identity,
+          function->MakeNode<UnOp>(return_value->loc(), return_value,
+                                   Op::kIdentity));
+      XLS_RETURN_IF_ERROR(function->set_return_value(identity));
+    }
+  }
+  for (const auto& [node, node_stages] : stages) {
+    VLOG(3) << absl::StreamFormat("Multi-cycle operation %s spans %d stages",
+                                  node->GetName(), node_stages);
+    for (Node* user : node->users()) {
+      single_cycle_options.add_constraint(
+          DifferenceConstraint(node, user, -node_stages));
+    }
+  }
+
+  DecoratingDelayEstimator multi_cycle_delays(
+      "multi_cycle", delay_estimator, [&](Node* node, int64_t base_delay) {
+        auto it = stages.find(node);
+        if (it == stages.end()) {
+          return base_delay;
+        }
+        return base_delay - (it->second - 1) * clock_period_ps;
+      });
+  return RunPipelineSchedule(f, multi_cycle_delays, single_cycle_options,
+                             synthesizer);
+}
+
 }  // namespace
 
 absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
@@ -336,6 +417,9 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
         "https://google.github.io/xls/codegen_options/"
         "#pipelining-and-scheduling-options for details.");
   }
+  if (!options.multi_cycle_ops().empty()) {
+    return RunMultiCycleSchedule(f, delay_estimator, options, synthesizer);
+  }
 
   int64_t input_delay = options.additional_input_delay_ps().value_or(0);
   int64_t output_delay = options.additional_output_delay_ps().value_or(0);
@@ -399,8 +483,10 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
   std::unique_ptr<SDCScheduler> sdc_scheduler;
   auto initialize_sdc_scheduler = [&]() -> absl::Status {
     if (sdc_scheduler == nullptr) {
-      XLS_ASSIGN_OR_RETURN(sdc_scheduler,
-                           SDCScheduler::Create(f, io_delay_added));
+      XLS_ASSIGN_OR_RETURN(
+          sdc_scheduler,
+          SDCScheduler::Create(f, io_delay_added,
+                               options.lazy_timing_constraints()));
       XLS_RETURN_IF_ERROR(sdc_scheduler->AddConstraints(options.constraints()));
     }
     return absl::OkStatus();
@@ -497,8 +583,21 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     }
   }
 
+  // Very large functions are scheduled one partition at a time rather than by
+  // a single SDC problem, which would need memory quadratic in their size.
+  bool partitioned =
+      options.strategy() == SchedulingStrategy::SDC && !options.use_fdo() &&
+      options.partitioned_scheduling_threshold().has_value() &&
+      f->node_count() > *options.partitioned_scheduling_threshold();
+  if (partitioned && (!f->IsFunction() || !options.constraints().empty())) {
+    LOG(WARNING) << "Partitioned scheduling only supports functions without "
+                    "scheduling constraints; scheduling "
+                 << f->name() << " with a single SDC problem.";
+    partitioned = false;
+  }
+
   ScheduleCycleMap cycle_map;
-  if (options.strategy() == SchedulingStrategy::SDC) {
+  if (options.strategy() == SchedulingStrategy::SDC && !partitioned) {
     // Enable iterative SDC scheduling when use_fdo is true
     if (options.use_fdo()) {
       if (!options.clock_period_ps().has_value()) {
@@ -635,7 +734,14 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
                                  io_delay_added);
     XLS_RETURN_IF_ERROR(TightenBounds(bounds, f, options.pipeline_stages()));
 
-    if (options.strategy() == SchedulingStrategy::MIN_CUT) {
+    if (partitioned) {
+      XLS_ASSIGN_OR_RETURN(
+          cycle_map,
+          PartitionedSDCScheduler(
+              f,
+              options.pipeline_stages().value_or(bounds.max_lower_bound() + 1),
+              clock_period_ps, io_delay_added, &bounds));
+    } else if (options.strategy() == SchedulingStrategy::MIN_CUT) {
       XLS_ASSIGN_OR_RETURN(
           cycle_map,
           MinCutScheduler(
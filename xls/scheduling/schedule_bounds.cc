@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -37,74 +38,96 @@ namespace sched {
 
 ScheduleBounds::ScheduleBounds(FunctionBase* f, int64_t clock_period_ps,
                                const DelayEstimator& delay_estimator)
-    : clock_period_ps_(clock_period_ps), delay_estimator_(&delay_estimator) {
-  auto topo_sort_it = TopoSort(f);
-  topo_sort_ = std::vector<Node*>(topo_sort_it.begin(), topo_sort_it.end());
-  Reset();
-}
+    : ScheduleBounds(f, TopoSort(f), clock_period_ps, delay_estimator) {}
 
 ScheduleBounds::ScheduleBounds(FunctionBase* f, std::vector<Node*> topo_sort,
                                int64_t clock_period_ps,
                                const DelayEstimator& delay_estimator)
-    : topo_sort_(std::move(topo_sort)),
-      clock_period_ps_(clock_period_ps),
-      delay_estimator_(&delay_estimator) {
+    : clock_period_ps_(clock_period_ps), delay_estimator_(&delay_estimator) {
+  auto topo_order = std::make_shared<TopoOrder>();
+  topo_order->nodes = std::move(topo_sort);
+  topo_order->index.reserve(topo_order->nodes.size());
+  for (int64_t i = 0; i < topo_order->nodes.size(); ++i) {
+    topo_order->index[topo_order->nodes[i]] = i;
+  }
+  topo_order_ = std::move(topo_order);
   Reset();
 }
 
 void ScheduleBounds::Reset() {
+  int64_t node_count = topo_order_->nodes.size();
+  bounds_.assign(node_count, {0, std::numeric_limits<int64_t>::max()});
+  lb_in_cycle_delay_.assign(node_count, 0);
+  ub_in_cycle_delay_.assign(node_count, 0);
+  lb_dirty_begin_ = 0;
+  ub_dirty_end_ = node_count;
   max_lower_bound_ = 0;
-  min_upper_bound_ = 0;
-  for (Node* node : topo_sort_) {
-    bounds_[node] = {0, std::numeric_limits<int64_t>::max()};
-    max_lower_bound_ = 0;
-    min_upper_bound_ = std::numeric_limits<int64_t>::max();
-  }
+  min_upper_bound_ =
+      node_count == 0 ? 0 : std::numeric_limits<int64_t>::max();
 }
 
 std::string ScheduleBounds::ToString() const {
   std::string out = "Bounds:\n";
-  if (!bounds_.empty()) {
-    for (Node* node : TopoSort(bounds_.begin()->first->function_base())) {
-      if (bounds_.contains(node)) {
-        absl::StrAppendFormat(&out, "  %s : [%d, %d]\n", node->GetName(),
-                              lb(node), ub(node));
-      }
-    }
+  for (Node* node : topo_order_->nodes) {
+    absl::StrAppendFormat(&out, "  %s : [%d, %d]\n", node->GetName(), lb(node),
+                          ub(node));
   }
   return out;
 }
 
+absl::Status ScheduleBounds::ComputeNodeDelays() {
+  if (!node_delays_.empty() || topo_order_->nodes.empty()) {
+    return absl::OkStatus();
+  }
+  std::vector<int64_t> node_delays;
+  node_delays.reserve(topo_order_->nodes.size());
+  for (Node* node : topo_order_->nodes) {
+    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
+                         delay_estimator_->GetOperationDelayInPs(node));
+    if (node_delay > clock_period_ps_) {
+      return absl::ResourceExhaustedError(absl::StrFormat(
+          "Node %s has a greater delay (%dps) than the clock period (%dps)",
+          node->GetName(), node_delay, clock_period_ps_));
+    }
+    node_delays.push_back(node_delay);
+  }
+  node_delays_ = std::move(node_delays);
+  return absl::OkStatus();
+}
+
 absl::Status ScheduleBounds::PropagateLowerBounds() {
   VLOG(4) << "PropagateLowerBounds()";
-  // The delay in picoseconds from the beginning of a cycle to the start of the
-  // node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
+  XLS_RETURN_IF_ERROR(ComputeNodeDelays());
+  const std::vector<Node*>& topo_sort = topo_order_->nodes;
 
   // Compute the lower bound of each node based on the lower bounds of the
-  // operands of the node.
-  for (Node* node : topo_sort_) {
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
+  // operands of the node. `lb_in_cycle_delay_` holds the delay in picoseconds
+  // from the beginning of a cycle to the start of the node; the nodes before
+  // the first tightened one keep their bounds and in-cycle delays.
+  for (int64_t i = lb_dirty_begin_; i < topo_sort.size(); ++i) {
+    Node* node = topo_sort[i];
+    int64_t& node_in_cycle_delay = lb_in_cycle_delay_[i];
+    node_in_cycle_delay = 0;
     VLOG(4) << absl::StreamFormat("  %s : original lb=%d", node->GetName(),
-                                  lb(node));
+                                  bounds_[i].first);
     for (Node* operand : node->operands()) {
-      int64_t operand_lb = lb(operand);
-      if (operand_lb < lb(node)) {
+      int64_t operand_index = index(operand);
+      int64_t operand_lb = bounds_[operand_index].first;
+      if (operand_lb < bounds_[i].first) {
         continue;
       }
-      XLS_ASSIGN_OR_RETURN(int64_t operand_delay,
-                           delay_estimator_->GetOperationDelayInPs(operand));
-      if (operand_lb > lb(node)) {
+      int64_t operand_delay = node_delays_[operand_index];
+      if (operand_lb > bounds_[i].first) {
         VLOG(4) << absl::StreamFormat(
             "    tightened lb to %d because of operand %s", operand_lb,
             operand->GetName());
         XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb));
-        node_in_cycle_delay = in_cycle_delay.at(operand) + operand_delay;
+        node_in_cycle_delay = lb_in_cycle_delay_[operand_index] + operand_delay;
         continue;
       }
       int64_t min_delay =
           operand->Is<MinDelay>() ? operand->As<MinDelay>()->delay() : 0;
-      if (operand_lb + min_delay > lb(node)) {
+      if (operand_lb + min_delay > bounds_[i].first) {
         VLOG(4) << absl::StreamFormat(
             "    tightened lb to %d because of operand %s", operand_lb,
             operand->GetName());
@@ -112,71 +135,65 @@ absl::Status ScheduleBounds::PropagateLowerBounds() {
         node_in_cycle_delay = 0;
         continue;
       }
-      node_in_cycle_delay = std::max(
-          node_in_cycle_delay, in_cycle_delay.at(operand) + operand_delay);
-    }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator_->GetOperationDelayInPs(node));
-    if (node_delay > clock_period_ps_) {
-      return absl::ResourceExhaustedError(absl::StrFormat(
-          "Node %s has a greater delay (%dps) than the clock period (%dps)",
-          node->GetName(), node_delay, clock_period_ps_));
+      node_in_cycle_delay =
+          std::max(node_in_cycle_delay,
+                   lb_in_cycle_delay_[operand_index] + operand_delay);
     }
-    if (node_in_cycle_delay + node_delay > clock_period_ps_) {
+    if (node_in_cycle_delay + node_delays_[i] > clock_period_ps_) {
       // Node does not fit in this cycle. Move to next cycle.
-      VLOG(4) << "    overflows clock period, tightened lb to " << lb(node) + 1;
-      XLS_RETURN_IF_ERROR(TightenNodeLb(node, lb(node) + 1));
+      VLOG(4) << "    overflows clock period, tightened lb to "
+              << bounds_[i].first + 1;
+      XLS_RETURN_IF_ERROR(TightenNodeLb(node, bounds_[i].first + 1));
       node_in_cycle_delay = 0;
     }
   }
+  lb_dirty_begin_ = topo_sort.size();
   return absl::OkStatus();
 }
 
 absl::Status ScheduleBounds::PropagateUpperBounds() {
   VLOG(4) << "PropagateUpperBounds()";
-  // The delay in picoseconds from the end of a cycle to the end of the node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
+  XLS_RETURN_IF_ERROR(ComputeNodeDelays());
+  const std::vector<Node*>& topo_sort = topo_order_->nodes;
 
   // Compute the upper bound of each node based on the upper bounds of the
-  // users of the node.
-  for (auto it = topo_sort_.rbegin(); it != topo_sort_.rend(); ++it) {
-    Node* node = *it;
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
+  // users of the node. `ub_in_cycle_delay_` holds the delay in picoseconds
+  // from the end of a cycle to the end of the node; the nodes after the last
+  // tightened one keep their bounds and in-cycle delays.
+  for (int64_t i = ub_dirty_end_ - 1; i >= 0; --i) {
+    Node* node = topo_sort[i];
+    int64_t& node_in_cycle_delay = ub_in_cycle_delay_[i];
+    node_in_cycle_delay = 0;
     VLOG(4) << absl::StreamFormat("  %s : original ub=%d", node->GetName(),
-                                  ub(node));
+                                  bounds_[i].second);
     for (Node* user : node->users()) {
-      int64_t user_ub = ub(user);
+      int64_t user_index = index(user);
+      int64_t user_ub = bounds_[user_index].second;
       if (user_ub == std::numeric_limits<int64_t>::max() ||
-          user_ub > ub(node)) {
+          user_ub > bounds_[i].second) {
         continue;
       }
-      XLS_ASSIGN_OR_RETURN(int64_t user_delay,
-                           delay_estimator_->GetOperationDelayInPs(user));
-      if (user_ub < ub(node)) {
+      int64_t user_delay = node_delays_[user_index];
+      if (user_ub < bounds_[i].second) {
         VLOG(4) << absl::StreamFormat(
             "    tightened ub to %d because of user %s", user_ub,
             user->GetName());
         XLS_RETURN_IF_ERROR(TightenNodeUb(node, user_ub));
-        node_in_cycle_delay = in_cycle_delay.at(user) + user_delay;
+        node_in_cycle_delay = ub_in_cycle_delay_[user_index] + user_delay;
         continue;
       }
-      node_in_cycle_delay =
-          std::max(node_in_cycle_delay, in_cycle_delay.at(user) + user_delay);
-    }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator_->GetOperationDelayInPs(node));
-    if (node_delay > clock_period_ps_) {
-      return absl::ResourceExhaustedError(absl::StrFormat(
-          "Node %s has a greater delay (%dps) than the clock period (%dps)",
-          node->GetName(), node_delay, clock_period_ps_));
+      node_in_cycle_delay = std::max(
+          node_in_cycle_delay, ub_in_cycle_delay_[user_index] + user_delay);
     }
-    if (node_in_cycle_delay + node_delay > clock_period_ps_) {
+    if (node_in_cycle_delay + node_delays_[i] > clock_period_ps_) {
       // Node does not fit in this cycle. Move to next cycle.
-      VLOG(4) << "    overflows clock period, tightened ub to " << ub(node) - 1;
-      XLS_RETURN_IF_ERROR(TightenNodeUb(node, ub(node) - 1));
+      VLOG(4) << "    overflows clock period, tightened ub to "
+              << bounds_[i].second - 1;
+      XLS_RETURN_IF_ERROR(TightenNodeUb(node, bounds_[i].second - 1));
       node_in_cycle_delay = 0;
     }
   }
+  ub_dirty_end_ = 0;
   return absl::OkStatus();
 }
 
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -34,6 +35,12 @@ namespace sched {
 // An abstraction holding lower and upper bounds for each node in a
 // function. The bounds are constraints on cycles in which a node may be
 // scheduled.
+//
+// Bounds are stored in arrays indexed by the position of the node in a
+// topological sort, which is shared between copies, so copying the bounds (as
+// schedulers do to try alternatives) is cheap. Propagation is incremental: it
+// starts from the earliest (latest) node whose lower (upper) bound was
+// tightened since the last propagation.
 class ScheduleBounds {
  public:
   // Returns a object with the lower bounds of each node set to the earliest
@@ -65,12 +72,12 @@ class ScheduleBounds {
   void Reset();
 
   // Return the lower/upper bound of the given node.
-  int64_t lb(Node* node) const { return bounds_.at(node).first; }
-  int64_t ub(Node* node) const { return bounds_.at(node).second; }
+  int64_t lb(Node* node) const { return bounds_[index(node)].first; }
+  int64_t ub(Node* node) const { return bounds_[index(node)].second; }
 
   // Return the lower and upper bound as a pair (lower bound is first element).
   const std::pair<int64_t, int64_t>& bounds(Node* node) const {
-    return bounds_.at(node);
+    return bounds_[index(node)];
   }
 
   // Sets the lower bound of the given node to the maximum of its existing value
@@ -82,7 +89,11 @@ class ScheduleBounds {
           absl::StrFormat("Unable to tighten the lower bound of node %s to %d.",
                           node->GetName(), value));
     }
-    bounds_.at(node).first = std::max(bounds_.at(node).first, value);
+    int64_t i = index(node);
+    if (value > bounds_[i].first) {
+      bounds_[i].first = value;
+      lb_dirty_begin_ = std::min(lb_dirty_begin_, i);
+    }
     max_lower_bound_ = std::max(max_lower_bound_, value);
     return absl::OkStatus();
   }
@@ -96,7 +107,11 @@ class ScheduleBounds {
           absl::StrFormat("Unable to tighten the upper bound of node %s to %d.",
                           node->GetName(), value));
     }
-    bounds_.at(node).second = std::min(bounds_.at(node).second, value);
+    int64_t i = index(node);
+    if (value < bounds_[i].second) {
+      bounds_[i].second = value;
+      ub_dirty_end_ = std::max(ub_dirty_end_, i + 1);
+    }
     min_upper_bound_ = std::min(min_upper_bound_, value);
     return absl::OkStatus();
   }
@@ -117,14 +132,41 @@ class ScheduleBounds {
   absl::Status PropagateUpperBounds();
 
  private:
-  // A topological sort of the nodes in the function.
-  std::vector<Node*> topo_sort_;
+  // The nodes of the function in topological order, and the position of each
+  // node in it. Immutable and shared between copies.
+  struct TopoOrder {
+    std::vector<Node*> nodes;
+    absl::flat_hash_map<Node*, int64_t> index;
+  };
+
+  int64_t index(Node* node) const { return topo_order_->index.at(node); }
+
+  // Fills `node_delays_` if it is not filled yet.
+  absl::Status ComputeNodeDelays();
+
+  std::shared_ptr<const TopoOrder> topo_order_;
 
   int64_t clock_period_ps_;
   const DelayEstimator* delay_estimator_;
 
-  // The bounds of each node stored as a {lower, upper} pair.
-  absl::flat_hash_map<Node*, std::pair<int64_t, int64_t>> bounds_;
+  // The delay of each node, by topological position. Empty until the first
+  // propagation.
+  std::vector<int64_t> node_delays_;
+
+  // The bounds of each node stored as a {lower, upper} pair, by topological
+  // position.
+  std::vector<std::pair<int64_t, int64_t>> bounds_;
+
+  // The in-cycle delays computed by the last propagation of the lower (upper)
+  // bounds, by topological position. See PropagateLowerBounds and
+  // PropagateUpperBounds.
+  std::vector<int64_t> lb_in_cycle_delay_;
+  std::vector<int64_t> ub_in_cycle_delay_;
+
+  // Lower (upper) bound propagation must revisit the nodes at positions at or
+  // after `lb_dirty_begin_` (before `ub_dirty_end_`).
+  int64_t lb_dirty_begin_;
+  int64_t ub_dirty_end_;
 
   int64_t max_lower_bound_;
   int64_t min_upper_bound_;
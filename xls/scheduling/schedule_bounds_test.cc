@@ -167,6 +167,38 @@ TEST_F(ScheduleBoundsTest, SimpleExpressionTightenBounds) {
   EXPECT_EQ(bounds.lb(result.node()), 23);
 }
 
+TEST_F(ScheduleBoundsTest, CopiesTightenIndependently) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto n1 = fb.Not(x);
+  auto n2 = fb.Not(n1);
+  auto n3 = fb.Not(n2);
+  auto n4 = fb.Not(n3);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ScheduleBounds bounds(f, /*clock_period_ps=*/2, delay_estimator_);
+  XLS_ASSERT_OK(bounds.PropagateLowerBounds());
+  EXPECT_EQ(bounds.lb(n2.node()), 0);
+  EXPECT_EQ(bounds.lb(n3.node()), 1);
+  EXPECT_EQ(bounds.lb(n4.node()), 1);
+
+  // Moving n2 to the second cycle pushes n4 out of it.
+  ScheduleBounds trial = bounds;
+  XLS_ASSERT_OK(trial.TightenNodeLb(n2.node(), 1));
+  XLS_ASSERT_OK(trial.PropagateLowerBounds());
+  EXPECT_EQ(trial.lb(n3.node()), 1);
+  EXPECT_EQ(trial.lb(n4.node()), 2);
+
+  XLS_ASSERT_OK(trial.TightenNodeLb(n3.node(), 2));
+  XLS_ASSERT_OK(trial.PropagateLowerBounds());
+  EXPECT_EQ(trial.lb(n4.node()), 2);
+
+  EXPECT_EQ(bounds.lb(n2.node()), 0);
+  EXPECT_EQ(bounds.lb(n4.node()), 1);
+  EXPECT_EQ(bounds.max_lower_bound(), 1);
+}
+
 }  // namespace
 }  // namespace sched
 }  // namespace xls
@@ -0,0 +1,231 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_exploration.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+namespace {
+
+struct Candidate {
+  std::optional<int64_t> clock_period_ps;
+  std::optional<int64_t> pipeline_stages;
+};
+
+// Returns the values to sweep, or the single base value if none are given.
+std::vector<std::optional<int64_t>> ValuesOrBase(
+    absl::Span<const int64_t> values, std::optional<int64_t> base) {
+  if (values.empty()) {
+    return {base};
+  }
+  return std::vector<std::optional<int64_t>>(values.begin(), values.end());
+}
+
+// Returns whether `a` is at least as good as `b` in every metric and better
+// in at least one.
+bool Dominates(const ScheduleExplorationPoint& a,
+               const ScheduleExplorationPoint& b) {
+  auto cost = [](const ScheduleExplorationPoint& p) {
+    return std::make_tuple(
+        p.throughput_ps, p.latency_ps,
+        p.area_um2.value_or(static_cast<double>(p.pipeline_register_bits)));
+  };
+  auto [a_throughput, a_latency, a_area] = cost(a);
+  auto [b_throughput, b_latency, b_area] = cost(b);
+  return a_throughput <= b_throughput && a_latency <= b_latency &&
+         a_area <= b_area && cost(a) != cost(b);
+}
+
+}  // namespace
+
+std::string ScheduleExplorationPoint::ToString() const {
+  std::string area =
+      area_um2.has_value() ? absl::StrFormat("%.1fum2", *area_um2) : "n/a";
+  return absl::StrFormat(
+      "period=%dps stages=%d ii=%d: throughput=%dps latency=%dps "
+      "register_bits=%d area=%s",
+      clock_period_ps, schedule.length(), initiation_interval, throughput_ps,
+      latency_ps, pipeline_register_bits, area);
+}
+
+absl::StatusOr<std::vector<ScheduleExplorationPoint>> ExploreSchedules(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& base_options,
+    const ScheduleExplorationSpace& space,
+    const AreaEstimator* area_estimator) {
+  std::vector<Candidate> candidates;
+  for (std::optional<int64_t> clock_period_ps :
+       ValuesOrBase(space.clock_periods_ps, base_options.clock_period_ps())) {
+    for (std::optional<int64_t> pipeline_stages : ValuesOrBase(
+             space.pipeline_stages, base_options.pipeline_stages())) {
+      candidates.push_back(Candidate{.clock_period_ps = clock_period_ps,
+                                     .pipeline_stages = pipeline_stages});
+    }
+  }
+  std::vector<int64_t> initiation_intervals = space.initiation_intervals;
+  if (initiation_intervals.empty() || !f->IsProc()) {
+    initiation_intervals = {
+        f->IsProc() ? base_options.worst_case_throughput().value_or(
+                          f->GetInitiationInterval().value_or(1))
+                    : 1};
+  }
+
+  std::optional<double> operation_area_um2;
+  if (area_estimator != nullptr) {
+    operation_area_um2 = 0.0;
+    for (Node* node : f->nodes()) {
+      XLS_ASSIGN_OR_RETURN(double node_area,
+                           area_estimator->GetOperationAreaInSquareMicrons(node));
+      *operation_area_um2 += node_area;
+    }
+  }
+
+  // The scheduler reads the initiation interval from `f`, so the candidates
+  // are scheduled concurrently one initiation interval at a time.
+  std::optional<int64_t> original_initiation_interval =
+      f->GetInitiationInterval();
+  std::vector<ScheduleExplorationPoint> points;
+  absl::Status status = absl::OkStatus();
+  for (int64_t initiation_interval : initiation_intervals) {
+    if (f->IsProc()) {
+      f->SetInitiationInterval(initiation_interval);
+    }
+    std::vector<absl::StatusOr<PipelineSchedule>> schedules(
+        candidates.size(), absl::UnknownError("not scheduled"));
+    std::atomic<int64_t> next_index = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_index.fetch_add(1); i < candidates.size();
+           i = next_index.fetch_add(1)) {
+        SchedulingOptions options = base_options;
+        if (candidates[i].clock_period_ps.has_value()) {
+          options.clock_period_ps(*candidates[i].clock_period_ps);
+        }
+        if (candidates[i].pipeline_stages.has_value()) {
+          options.pipeline_stages(*candidates[i].pipeline_stages);
+        }
+        options.clear_worst_case_throughput();
+        options.minimize_worst_case_throughput(false);
+        schedules[i] = RunPipelineSchedule(f, delay_estimator, options);
+      }
+    };
+    int64_t thread_count = std::clamp<int64_t>(
+        space.max_concurrency > 0 ? space.max_concurrency : AvailableCPUs(), 1,
+        std::max<int64_t>(candidates.size(), 1));
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (auto& t : threads) {
+      t->Join();
+    }
+
+    for (int64_t i = 0; i < candidates.size(); ++i) {
+      if (!schedules[i].ok()) {
+        if (absl::IsResourceExhausted(schedules[i].status()) ||
+            absl::IsInvalidArgument(schedules[i].status())) {
+          VLOG(2) << "Skipping infeasible candidate: "
+                  << schedules[i].status();
+          continue;
+        }
+        status.Update(schedules[i].status());
+        continue;
+      }
+      PipelineSchedule& schedule = *schedules[i];
+      // Without a given clock period, the scheduler picks the minimum one.
+      int64_t clock_period_ps = candidates[i].clock_period_ps.value_or(
+          schedule.min_clock_period_ps().value_or(0));
+      int64_t register_bits = schedule.CountFinalInteriorPipelineRegisters();
+      std::optional<double> area_um2;
+      if (operation_area_um2.has_value()) {
+        absl::StatusOr<double> register_area =
+            area_estimator->GetRegisterAreaInSquareMicrons(register_bits);
+        if (!register_area.ok()) {
+          status.Update(register_area.status());
+          continue;
+        }
+        area_um2 = *operation_area_um2 + *register_area;
+      }
+      int64_t latency_ps = schedule.length() * clock_period_ps;
+      points.push_back(ScheduleExplorationPoint{
+          .clock_period_ps = clock_period_ps,
+          .initiation_interval = initiation_interval,
+          .schedule = std::move(schedule),
+          .throughput_ps = initiation_interval * clock_period_ps,
+          .latency_ps = latency_ps,
+          .pipeline_register_bits = register_bits,
+          .area_um2 = area_um2,
+      });
+    }
+    if (!status.ok()) {
+      break;
+    }
+  }
+  if (f->IsProc()) {
+    if (original_initiation_interval.has_value()) {
+      f->SetInitiationInterval(*original_initiation_interval);
+    } else {
+      f->ClearInitiationInterval();
+    }
+  }
+  XLS_RETURN_IF_ERROR(status);
+  return points;
+}
+
+std::vector<ScheduleExplorationPoint> ParetoFront(
+    absl::Span<const ScheduleExplorationPoint> points) {
+  std::vector<ScheduleExplorationPoint> front;
+  for (const ScheduleExplorationPoint& point : points) {
+    if (std::none_of(points.begin(), points.end(),
+                     [&](const ScheduleExplorationPoint& other) {
+                       return Dominates(other, point);
+                     })) {
+      front.push_back(point);
+    }
+  }
+  std::stable_sort(front.begin(), front.end(),
+                   [](const ScheduleExplorationPoint& a,
+                      const ScheduleExplorationPoint& b) {
+                     return std::tie(a.throughput_ps, a.latency_ps) <
+                            std::tie(b.throughput_ps, b.latency_ps);
+                   });
+  return front;
+}
+
+}  // namespace xls
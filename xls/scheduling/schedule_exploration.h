@@ -0,0 +1,86 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_SCHEDULE_EXPLORATION_H_
+#define XLS_SCHEDULING_SCHEDULE_EXPLORATION_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// The values swept by ExploreSchedules. An empty list means the value of the
+// base scheduling options is used.
+struct ScheduleExplorationSpace {
+  std::vector<int64_t> clock_periods_ps;
+  std::vector<int64_t> pipeline_stages;
+  // Worst-case throughputs (initiation intervals) to try. Only meaningful for
+  // procs; functions always have an initiation interval of 1.
+  std::vector<int64_t> initiation_intervals;
+
+  // The maximum number of candidates scheduled at once. If zero, the number of
+  // available CPUs.
+  int64_t max_concurrency = 0;
+};
+
+// A feasible point of the design space and its schedule.
+struct ScheduleExplorationPoint {
+  int64_t clock_period_ps;
+  int64_t initiation_interval;
+  PipelineSchedule schedule;
+
+  // The time between successive inputs: initiation_interval * clock period.
+  int64_t throughput_ps;
+  // The time from an input to its output: number of stages * clock period.
+  int64_t latency_ps;
+  // The number of bits of the pipeline registers between stages.
+  int64_t pipeline_register_bits;
+  // The estimated area of the operations and pipeline registers, if an area
+  // estimator was given.
+  std::optional<double> area_um2;
+
+  std::string ToString() const;
+};
+
+// Schedules `f` for every combination of the values in `space`, with the
+// other options taken from `base_options`, and returns the feasible points.
+// Candidates which cannot be scheduled are skipped. The candidates of each
+// initiation interval are scheduled concurrently; `delay_estimator` must be
+// safe for concurrent use. Scheduling constraints of `base_options` apply to
+// every candidate.
+absl::StatusOr<std::vector<ScheduleExplorationPoint>> ExploreSchedules(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& base_options,
+    const ScheduleExplorationSpace& space,
+    const AreaEstimator* area_estimator = nullptr);
+
+// Returns the points which are not dominated by another point in throughput,
+// latency and area (or pipeline register bits, without an area estimate),
+// ordered by throughput then latency.
+std::vector<ScheduleExplorationPoint> ParetoFront(
+    absl::Span<const ScheduleExplorationPoint> points);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_SCHEDULE_EXPLORATION_H_
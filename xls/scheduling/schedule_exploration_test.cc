@@ -0,0 +1,65 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_exploration.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+class ScheduleExplorationTest : public IrTestBase {};
+
+TEST_F(ScheduleExplorationTest, ParetoFrontOfPeriodsAndStages) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  fb.Not(fb.Not(fb.Not(fb.Not(x))));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ScheduleExplorationSpace space;
+  space.clock_periods_ps = {1, 2};
+  space.pipeline_stages = {2, 4};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<ScheduleExplorationPoint> points,
+      ExploreSchedules(f, TestDelayEstimator(), SchedulingOptions(), space));
+
+  // The four negations do not fit in two 1ps stages.
+  ASSERT_EQ(points.size(), 3);
+  for (const ScheduleExplorationPoint& point : points) {
+    EXPECT_EQ(point.initiation_interval, 1);
+    EXPECT_EQ(point.throughput_ps, point.clock_period_ps);
+    EXPECT_EQ(point.latency_ps,
+              point.clock_period_ps * point.schedule.length());
+    EXPECT_FALSE(point.area_um2.has_value());
+  }
+
+  // Four 2ps stages are slower and no smaller than four 1ps stages.
+  std::vector<ScheduleExplorationPoint> front = ParetoFront(points);
+  ASSERT_EQ(front.size(), 2);
+  EXPECT_EQ(front[0].clock_period_ps, 1);
+  EXPECT_EQ(front[0].schedule.length(), 4);
+  EXPECT_EQ(front[1].clock_period_ps, 2);
+  EXPECT_EQ(front[1].schedule.length(), 2);
+  EXPECT_LT(front[1].pipeline_register_bits, front[0].pipeline_register_bits);
+}
+
+}  // namespace
+}  // namespace xls
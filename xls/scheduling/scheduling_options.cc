@@ -17,9 +17,11 @@
 #include <cstdint>
 #include <limits>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
@@ -28,6 +30,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/tools/scheduling_options_flags.pb.h"
 
@@ -65,6 +68,19 @@ absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   }
   scheduling_options.minimize_worst_case_throughput(
       proto.minimize_worst_case_throughput());
+  scheduling_options.lazy_timing_constraints(proto.lazy_timing_constraints());
+  if (proto.partitioned_scheduling_threshold() != 0) {
+    scheduling_options.partitioned_scheduling_threshold(
+        proto.partitioned_scheduling_threshold());
+  }
+  if (!proto.multi_cycle_ops().empty()) {
+    absl::flat_hash_set<Op> multi_cycle_ops;
+    for (const std::string& op : proto.multi_cycle_ops()) {
+      XLS_ASSIGN_OR_RETURN(Op multi_cycle_op, StringToOp(op));
+      multi_cycle_ops.insert(multi_cycle_op);
+    }
+    scheduling_options.multi_cycle_ops(std::move(multi_cycle_ops));
+  }
   if (proto.additional_input_delay_ps() != 0) {
     scheduling_options.additional_input_delay_ps(
         proto.additional_input_delay_ps());
@@ -19,15 +19,18 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/tools/scheduling_options_flags.pb.h"
@@ -334,6 +337,38 @@ class SchedulingOptions {
     return minimize_worst_case_throughput_;
   }
 
+  // Sets/gets whether the SDC scheduler adds timing constraints to the LP only
+  // once a solution violates them, re-solving until none is violated.
+  SchedulingOptions& lazy_timing_constraints(bool value) {
+    lazy_timing_constraints_ = value;
+    return *this;
+  }
+  bool lazy_timing_constraints() const { return lazy_timing_constraints_; }
+
+  // Sets/gets the node count above which a function scheduled with the SDC
+  // strategy is instead scheduled partition by partition, trading some
+  // register count for memory and time linear in the size of the function.
+  SchedulingOptions& partitioned_scheduling_threshold(int64_t value) {
+    partitioned_scheduling_threshold_ = value;
+    return *this;
+  }
+  std::optional<int64_t> partitioned_scheduling_threshold() const {
+    return partitioned_scheduling_threshold_;
+  }
+
+  // Sets/gets the ops whose operations may span several pipeline stages, e.g.
+  // wide multipliers and dividers. Such an operation with a delay longer than
+  // the clock period takes as many stages as it needs, and codegen emits the
+  // pipeline registers after it for synthesis retiming to move into its
+  // logic. Requires a clock period.
+  SchedulingOptions& multi_cycle_ops(absl::flat_hash_set<Op> value) {
+    multi_cycle_ops_ = std::move(value);
+    return *this;
+  }
+  const absl::flat_hash_set<Op>& multi_cycle_ops() const {
+    return multi_cycle_ops_;
+  }
+
   // Sets/gets the worst-case throughput bound to use when scheduling; for
   // procs, controls the length of state backedges allowed in scheduling.
   SchedulingOptions& worst_case_throughput(int64_t value) {
@@ -343,6 +378,10 @@ class SchedulingOptions {
   std::optional<int64_t> worst_case_throughput() const {
     return worst_case_throughput_;
   }
+  SchedulingOptions& clear_worst_case_throughput() {
+    worst_case_throughput_ = std::nullopt;
+    return *this;
+  }
 
   // Sets/gets the additional delay added to each input.
   //
@@ -545,6 +584,9 @@ class SchedulingOptions {
   bool minimize_clock_on_failure_;
   bool recover_after_minimizing_clock_;
   bool minimize_worst_case_throughput_;
+  bool lazy_timing_constraints_ = false;
+  std::optional<int64_t> partitioned_scheduling_threshold_;
+  absl::flat_hash_set<Op> multi_cycle_ops_;
   std::optional<int64_t> worst_case_throughput_;
   std::optional<int64_t> additional_input_delay_ps_;
   std::optional<int64_t> additional_output_delay_ps_;
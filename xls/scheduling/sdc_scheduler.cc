@@ -14,6 +14,7 @@
 
 #include "xls/scheduling/sdc_scheduler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <memory>
@@ -24,6 +25,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -61,12 +63,7 @@ namespace math_opt = ::operations_research::math_opt;
 // A helper function to compute each node's delay by calling the delay estimator
 absl::StatusOr<DelayMap> ComputeNodeDelays(
     FunctionBase* f, const DelayEstimator& delay_estimator) {
-  DelayMap result;
-  for (Node* node : f->nodes()) {
-    XLS_ASSIGN_OR_RETURN(result[node],
-                         delay_estimator.GetOperationDelayInPs(node));
-  }
-  return result;
+  return delay_estimator.GetOperationDelaysInPs(f);
 }
 
 // Compute all-pairs longest distance between all nodes in `f`. The distance
@@ -127,63 +124,6 @@ ComputeDistancesToNodes(FunctionBase* f, absl::Span<Node* const> topo_sort,
   return distances_to_node;
 }
 
-// Returns the minimal set of schedule constraints which ensure that no
-// combinational path in the schedule exceeds `clock_period_ps`. The returned
-// map has a (potentially empty) vector entry for each node in `f`. The map
-// value (vector of nodes) for node `x` is the set of nodes which must be
-// scheduled at least one cycle later than `x`. That is, if `return_value[x]` is
-// `S` then:
-//
-//   cycle(i) + 1 >= cycle(x) for i \in S
-//
-// The set of constraints is a minimal set which guarantees that no
-// combinational path violates the clock period timing. Specifically, `(a, b)`
-// is in the set of returned constraints (ie., `return_value[a]` contains `b`)
-// iff critical-path distance from `a` to `b` including the delay of `a` and `b`
-// is greater than `critical_path_period`, but the critical-path distance of the
-// path *not* including the delay of `b` is *less than* `critical_path_period`.
-absl::flat_hash_map<Node*, std::vector<Node*>>
-ComputeCombinationalDelayConstraints(
-    FunctionBase* f, absl::Span<Node* const> topo_sort, int64_t clock_period_ps,
-    const absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>&
-        distances_to_node,
-    const DelayMap& delay_map) {
-  absl::flat_hash_map<Node*, std::vector<Node*>> result;
-  result.reserve(f->node_count());
-  for (Node* a : topo_sort) {
-    result[a];
-  }
-
-  for (Node* node : topo_sort) {
-    const int64_t node_delay = delay_map.at(node);
-
-    // For each ancestor `a`, check whether the critical-path length from `a`'s
-    // start to `node`'s end crosses a `clock_period_ps` boundary due to
-    // `node`'s delay. If so, we need a constraint to ensure that `node` is in a
-    // later stage than `a`.
-    //
-    // NOTE: The order in which we iterate over the ancestors `a` here does not
-    // matter. As long as our iteration over `node` is deterministic, we will
-    // push the same sequence of `node`s into each `result[a]` every time.
-    for (auto [a, distance] : distances_to_node.at(node)) {
-      if (distance > clock_period_ps &&
-          distance - node_delay <= clock_period_ps) {
-        result.at(a).push_back(node);
-      }
-    }
-  }
-
-  if (VLOG_IS_ON(4)) {
-    VLOG(4) << absl::StrFormat("Constraints (clock period: %dps):",
-                               clock_period_ps);
-    for (Node* node : topo_sort) {
-      VLOG(4) << absl::StrFormat("  %s: [%s]", node->GetName(),
-                                 absl::StrJoin(result.at(node), ", "));
-    }
-  }
-  return result;
-}
-
 }  // namespace
 
 SDCSchedulingModel::SDCSchedulingModel(FunctionBase* func,
@@ -200,6 +140,7 @@ SDCSchedulingModel::SDCSchedulingModel(FunctionBase* func,
   // are not used.
   if (!delay_map_.empty()) {
     distances_to_node_ = ComputeDistancesToNodes(func_, topo_sort_, delay_map_);
+    InitializeTimingCandidates();
   }
 
   for (Node* node : topo_sort_) {
@@ -233,6 +174,49 @@ SDCSchedulingModel::SDCSchedulingModel(FunctionBase* func,
   }
 }
 
+void SDCSchedulingModel::InitializeTimingCandidates() {
+  // The pair (a, b) needs a constraint iff the critical-path distance from `a`
+  // to `b` including the delay of `a` and `b` is greater than the clock
+  // period, but the distance *not* including the delay of `b` is not. This
+  // holds for clock periods in [distance - delay(b), distance).
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  for (int64_t i = 0; i < topo_sort_.size(); ++i) {
+    topo_index[topo_sort_[i]] = i;
+  }
+  for (Node* target : topo_sort_) {
+    const int64_t target_delay = delay_map_.at(target);
+    if (target_delay == 0) {
+      continue;
+    }
+    for (auto [source, distance] : distances_to_node_.at(target)) {
+      timing_candidates_.push_back(TimingCandidate{
+          .source = source,
+          .target = target,
+          .min_clock_period_ps = distance - target_delay,
+          .max_clock_period_ps = distance});
+    }
+  }
+  // Order the candidates by source and then target so the constraints are
+  // always added to the model in the same order.
+  absl::c_sort(timing_candidates_, [&](const TimingCandidate& x,
+                                       const TimingCandidate& y) {
+    return std::make_pair(topo_index.at(x.source), topo_index.at(x.target)) <
+           std::make_pair(topo_index.at(y.source), topo_index.at(y.target));
+  });
+
+  candidates_by_min_.resize(timing_candidates_.size());
+  absl::c_iota(candidates_by_min_, 0);
+  candidates_by_max_ = candidates_by_min_;
+  absl::c_stable_sort(candidates_by_min_, [&](int64_t x, int64_t y) {
+    return timing_candidates_[x].min_clock_period_ps <
+           timing_candidates_[y].min_clock_period_ps;
+  });
+  absl::c_stable_sort(candidates_by_max_, [&](int64_t x, int64_t y) {
+    return timing_candidates_[x].max_clock_period_ps <
+           timing_candidates_[y].max_clock_period_ps;
+  });
+}
+
 absl::Status SDCSchedulingModel::AddDefUseConstraints(
     Node* node, std::optional<Node*> user) {
   XLS_RETURN_IF_ERROR(AddCausalConstraint(node, user));
@@ -529,42 +513,96 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::ExtractResult(
 }
 
 void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
-  absl::flat_hash_map<Node*, std::vector<Node*>> prev_delay_constraints =
-      std::move(delay_constraints_);
-  delay_constraints_ = ComputeCombinationalDelayConstraints(
-      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_);
-
-  for (Node* source : topo_sort_) {
-    if (!prev_delay_constraints.empty()) {
-      // Check over all the prior constraints, dropping any that are obsolete.
-      absl::flat_hash_set<Node*> new_targets(
-          delay_constraints_.at(source).begin(),
-          delay_constraints_.at(source).end());
-      for (Node* target : prev_delay_constraints.at(source)) {
-        if (new_targets.contains(target)) {
-          continue;
-        }
+  if (clock_period_ps_ == clock_period_ps) {
+    return;
+  }
 
-        // No longer related; remove constraint.
-        auto it = timing_constraint_.find(std::make_pair(source, target));
+  // Only the candidates with a bound between the previous and the new clock
+  // period can change whether they need a constraint, so the model is updated
+  // incrementally as the clock period search narrows down.
+  std::vector<int64_t> changed;
+  if (!clock_period_ps_.has_value()) {
+    changed.resize(timing_candidates_.size());
+    absl::c_iota(changed, 0);
+  } else {
+    const int64_t low = std::min(*clock_period_ps_, clock_period_ps);
+    const int64_t high = std::max(*clock_period_ps_, clock_period_ps);
+    auto add_in_range = [&](absl::Span<const int64_t> sorted,
+                            int64_t TimingCandidate::* bound) {
+      auto by_bound = [&](int64_t value, int64_t index) {
+        return value < timing_candidates_[index].*bound;
+      };
+      auto begin = absl::c_upper_bound(sorted, low, by_bound);
+      auto end = absl::c_upper_bound(sorted, high, by_bound);
+      changed.insert(changed.end(), begin, end);
+    };
+    add_in_range(candidates_by_min_, &TimingCandidate::min_clock_period_ps);
+    add_in_range(candidates_by_max_, &TimingCandidate::max_clock_period_ps);
+    absl::c_sort(changed);
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+  }
+  clock_period_ps_ = clock_period_ps;
+
+  for (int64_t index : changed) {
+    const TimingCandidate& candidate = timing_candidates_[index];
+    if (!IsTimingConstraintNeeded(candidate)) {
+      // No longer related; remove constraint.
+      auto it = timing_constraint_.find(
+          std::make_pair(candidate.source, candidate.target));
+      if (it != timing_constraint_.end()) {
         model_.DeleteLinearConstraint(it->second);
         timing_constraint_.erase(it);
       }
+    } else if (!lazy_timing_constraints_) {
+      // Newly related; add constraint.
+      AddTimingConstraint(candidate);
     }
+  }
+}
 
-    // Add all new constraints, avoiding duplicates for any that already exist.
-    for (Node* target : delay_constraints_.at(source)) {
-      auto key = std::make_pair(source, target);
-      if (timing_constraint_.contains(key)) {
-        continue;
-      }
+bool SDCSchedulingModel::IsTimingConstraintNeeded(
+    const TimingCandidate& candidate) const {
+  return clock_period_ps_.has_value() &&
+         candidate.min_clock_period_ps <= *clock_period_ps_ &&
+         *clock_period_ps_ < candidate.max_clock_period_ps;
+}
 
-      // Newly related; add constraint.
-      VLOG(2) << "Setting timing constraint: "
-              << absl::StrFormat("1 ≤ %s - %s", target->GetName(),
-                                 source->GetName());
-      timing_constraint_.emplace(
-          key, DiffAtLeastConstraint(target, source, 1, "timing"));
+bool SDCSchedulingModel::AddTimingConstraint(const TimingCandidate& candidate) {
+  auto key = std::make_pair(candidate.source, candidate.target);
+  if (timing_constraint_.contains(key)) {
+    return false;
+  }
+  VLOG(2) << "Setting timing constraint: "
+          << absl::StrFormat("1 ≤ %s - %s", candidate.target->GetName(),
+                             candidate.source->GetName());
+  timing_constraint_.emplace(
+      key,
+      DiffAtLeastConstraint(candidate.target, candidate.source, 1, "timing"));
+  return true;
+}
+
+int64_t SDCSchedulingModel::AddViolatedTimingConstraints(
+    const math_opt::VariableMap<double>& variable_values) {
+  int64_t added = 0;
+  for (const TimingCandidate& candidate : timing_candidates_) {
+    if (!IsTimingConstraintNeeded(candidate)) {
+      continue;
+    }
+    double source_cycle =
+        std::round(variable_values.at(cycle_var_.at(candidate.source)));
+    double target_cycle =
+        std::round(variable_values.at(cycle_var_.at(candidate.target)));
+    if (target_cycle < source_cycle + 1 && AddTimingConstraint(candidate)) {
+      ++added;
+    }
+  }
+  return added;
+}
+
+void SDCSchedulingModel::AddAllTimingConstraints() {
+  for (const TimingCandidate& candidate : timing_candidates_) {
+    if (IsTimingConstraintNeeded(candidate)) {
+      AddTimingConstraint(candidate);
     }
   }
 }
@@ -911,11 +949,13 @@ SDCSchedulingModel::AddLowerBoundSlack(
 }
 
 absl::StatusOr<std::unique_ptr<SDCScheduler>> SDCScheduler::Create(
-    FunctionBase* f, const DelayEstimator& delay_estimator) {
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    bool lazy_timing_constraints) {
   XLS_ASSIGN_OR_RETURN(DelayMap delay_map,
                        ComputeNodeDelays(f, delay_estimator));
   std::unique_ptr<SDCScheduler> scheduler(
       new SDCScheduler(f, std::move(delay_map)));
+  scheduler->model_.SetLazyTimingConstraints(lazy_timing_constraints);
   XLS_RETURN_IF_ERROR(scheduler->Initialize());
   return std::move(scheduler);
 }
@@ -963,6 +1003,23 @@ absl::Status SDCScheduler::AddConstraints(
   return absl::OkStatus();
 }
 
+absl::StatusOr<math_opt::SolveResult> SDCScheduler::Solve() {
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result, solver_->Solve());
+    if (result.termination.reason != math_opt::TerminationReason::kOptimal &&
+        result.termination.reason != math_opt::TerminationReason::kFeasible) {
+      // Missing timing constraints can't make the problem infeasible.
+      return result;
+    }
+    int64_t added = model_.AddViolatedTimingConstraints(result.variable_values());
+    if (added == 0) {
+      return result;
+    }
+    VLOG(2) << absl::StreamFormat(
+        "Added %d violated timing constraints; re-solving", added);
+  }
+}
+
 absl::Status SDCScheduler::BuildError(
     const math_opt::SolveResult& result,
     SchedulingFailureBehavior failure_behavior) {
@@ -972,6 +1029,8 @@ absl::Status SDCScheduler::BuildError(
       (result.termination.reason == math_opt::TerminationReason::kInfeasible ||
        result.termination.reason ==
            math_opt::TerminationReason::kInfeasibleOrUnbounded)) {
+    // Explain the infeasibility in terms of the full set of constraints.
+    model_.AddAllTimingConstraints();
     XLS_RETURN_IF_ERROR(model_.AddSlackVariables(
         failure_behavior.infeasible_per_state_backedge_slack_pool));
     XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result_with_slack,
@@ -1010,7 +1069,7 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
     model_.MinimizePipelineLength();
     XLS_ASSIGN_OR_RETURN(
         const math_opt::SolveResult result_with_minimized_pipeline_length,
-        solver_->Solve());
+        Solve());
     if (result_with_minimized_pipeline_length.termination.reason !=
         math_opt::TerminationReason::kOptimal) {
       return BuildError(result_with_minimized_pipeline_length,
@@ -1029,7 +1088,7 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
     model_.SetObjective();
   }
 
-  XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result, solver_->Solve());
+  XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result, Solve());
   if (result.termination.reason == math_opt::TerminationReason::kOptimal ||
       (check_feasibility &&
        result.termination.reason == math_opt::TerminationReason::kFeasible)) {
@@ -65,6 +65,21 @@ class SDCSchedulingModel {
 
   void SetClockPeriod(int64_t clock_period_ps);
 
+  // If `lazy` is true, SetClockPeriod only removes timing constraints which
+  // no longer apply and never adds any. The constraints are instead added by
+  // AddViolatedTimingConstraints as solutions violate them. Must be set before
+  // the first call to SetClockPeriod.
+  void SetLazyTimingConstraints(bool lazy) { lazy_timing_constraints_ = lazy; }
+
+  // Adds the timing constraints for the current clock period which the
+  // solution in `variable_values` violates. Returns the number added.
+  int64_t AddViolatedTimingConstraints(
+      const operations_research::math_opt::VariableMap<double>&
+          variable_values);
+
+  // Adds every timing constraint for the current clock period.
+  void AddAllTimingConstraints();
+
   absl::Status SetWorstCaseThroughput(int64_t worst_case_throughput);
 
   void SetPipelineLength(std::optional<int64_t> pipeline_length);
@@ -174,8 +189,29 @@ class SDCSchedulingModel {
   // data-dependence graph.
   operations_research::math_opt::Variable cycle_at_sinknode_;
 
-  // A cache of the delay constraints.
-  absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints_;
+  // A pair of nodes which needs a timing constraint (`target` in a later stage
+  // than `source`) iff the clock period is in
+  // [min_clock_period_ps, max_clock_period_ps).
+  struct TimingCandidate {
+    Node* source;
+    Node* target;
+    int64_t min_clock_period_ps;
+    int64_t max_clock_period_ps;
+  };
+  void InitializeTimingCandidates();
+  bool IsTimingConstraintNeeded(const TimingCandidate& candidate) const;
+  // Returns false if the constraint was already present.
+  bool AddTimingConstraint(const TimingCandidate& candidate);
+
+  // Every pair of nodes which needs a timing constraint for some clock period,
+  // ordered by source and target, and their indices sorted by each bound.
+  std::vector<TimingCandidate> timing_candidates_;
+  std::vector<int64_t> candidates_by_min_;
+  std::vector<int64_t> candidates_by_max_;
+
+  // The clock period the timing constraints in the model are for.
+  std::optional<int64_t> clock_period_ps_;
+  bool lazy_timing_constraints_ = false;
 
   absl::flat_hash_map<std::pair<Node*, Node*>,
                       operations_research::math_opt::LinearConstraint>
@@ -211,8 +247,13 @@ class SDCScheduler {
   using DelayMap = absl::flat_hash_map<Node*, int64_t>;
 
  public:
+  // If `lazy_timing_constraints` is true, timing constraints are only added to
+  // the LP once a solution violates them, and the LP is re-solved until no
+  // constraint is violated. The schedules are equally valid but the LP is
+  // typically much smaller for large datapaths.
   static absl::StatusOr<std::unique_ptr<SDCScheduler>> Create(
-      FunctionBase* f, const DelayEstimator& delay_estimator);
+      FunctionBase* f, const DelayEstimator& delay_estimator,
+      bool lazy_timing_constraints = false);
 
   absl::Status AddConstraints(
       absl::Span<const SchedulingConstraint> constraints);
@@ -250,6 +291,10 @@ class SDCScheduler {
   SDCScheduler(FunctionBase* f, DelayMap delay_map);
   absl::Status Initialize();
 
+  // Solves the model, adding violated timing constraints and re-solving as
+  // needed if they are added lazily.
+  absl::StatusOr<operations_research::math_opt::SolveResult> Solve();
+
   absl::Status BuildError(
       const operations_research::math_opt::SolveResult& result,
       SchedulingFailureBehavior failure_behavior);
@@ -0,0 +1,243 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/sdc_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Returns the value of the SDC objective (see
+// SDCSchedulingModel::SetObjective) for the given schedule of a function.
+double Objective(FunctionBase* f, const ScheduleCycleMap& cycle_map) {
+  double objective = 0.0;
+  for (Node* node : f->nodes()) {
+    int64_t lifetime = 0;
+    for (Node* user : node->users()) {
+      lifetime = std::max(lifetime, cycle_map.at(user) - cycle_map.at(node));
+    }
+    objective += 1024.0 *
+                     static_cast<double>(node->GetType()->GetFlatBitCount()) *
+                     static_cast<double>(lifetime) +
+                 static_cast<double>(cycle_map.at(node));
+  }
+  return objective;
+}
+
+absl::StatusOr<ScheduleCycleMap> Schedule(
+    FunctionBase* f, int64_t clock_period_ps, bool lazy_timing_constraints,
+    std::optional<int64_t> pipeline_stages = std::nullopt,
+    std::optional<int64_t> worst_case_throughput = std::nullopt) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<SDCScheduler> scheduler,
+      SDCScheduler::Create(f, TestDelayEstimator(), lazy_timing_constraints));
+  return scheduler->Schedule(pipeline_stages, clock_period_ps,
+                             SchedulingFailureBehavior(),
+                             /*check_feasibility=*/false,
+                             worst_case_throughput);
+}
+
+class SdcSchedulerTest : public IrTestBase {
+ protected:
+  // Schedules `f` with eager and lazy timing constraints at several clock
+  // periods and checks that both give valid schedules with the same
+  // objective.
+  void ExpectLazyMatchesEager(Function* f) {
+    for (int64_t clock_period_ps : {1, 2, 3, 5, 8}) {
+      SCOPED_TRACE(clock_period_ps);
+      XLS_ASSERT_OK_AND_ASSIGN(
+          ScheduleCycleMap eager,
+          Schedule(f, clock_period_ps, /*lazy_timing_constraints=*/false));
+      XLS_ASSERT_OK_AND_ASSIGN(
+          ScheduleCycleMap lazy,
+          Schedule(f, clock_period_ps, /*lazy_timing_constraints=*/true));
+
+      PipelineSchedule lazy_schedule(f, lazy);
+      XLS_EXPECT_OK(lazy_schedule.Verify());
+      XLS_EXPECT_OK(
+          lazy_schedule.VerifyTiming(clock_period_ps, TestDelayEstimator()));
+      EXPECT_EQ(lazy_schedule.length(), PipelineSchedule(f, eager).length());
+      EXPECT_EQ(Objective(f, lazy), Objective(f, eager));
+    }
+  }
+};
+
+TEST_F(SdcSchedulerTest, LazyMatchesEagerOnChain) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  for (int64_t i = 0; i < 12; ++i) {
+    x = fb.Not(x);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ExpectLazyMatchesEager(f);
+}
+
+TEST_F(SdcSchedulerTest, LazyMatchesEagerOnReconvergentPaths) {
+  // Wide and narrow values on paths of different lengths which reconverge, so
+  // that where each value is registered matters for the objective.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(64));
+  BValue b = fb.Param("b", p->GetBitsType(8));
+  BValue wide = a;
+  BValue narrow = b;
+  for (int64_t i = 0; i < 6; ++i) {
+    wide = fb.Add(wide, fb.ZeroExtend(narrow, 64));
+    narrow = fb.Negate(fb.BitSlice(wide, /*start=*/i, /*width=*/8));
+    if (i % 2 == 1) {
+      narrow = fb.UDiv(narrow, b);
+    }
+  }
+  fb.Concat({wide, narrow, fb.Not(b)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ExpectLazyMatchesEager(f);
+}
+
+TEST_F(SdcSchedulerTest, LazyMatchesEagerOnTree) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> level;
+  for (int64_t i = 0; i < 8; ++i) {
+    level.push_back(fb.Param(absl::StrCat("x", i), p->GetBitsType(16)));
+  }
+  while (level.size() > 1) {
+    std::vector<BValue> next;
+    for (int64_t i = 0; i + 1 < level.size(); i += 2) {
+      next.push_back(fb.UMul(fb.Not(level[i]), level[i + 1]));
+    }
+    level = next;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ExpectLazyMatchesEager(f);
+}
+
+TEST_F(SdcSchedulerTest, LazyResolveLoopTerminates) {
+  // Every pair of nodes on a long chain needs a timing constraint at a one
+  // picosecond clock, so the lazy loop has to re-solve many times.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  for (int64_t i = 0; i < 64; ++i) {
+    x = fb.Negate(x);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ScheduleCycleMap lazy,
+      Schedule(f, /*clock_period_ps=*/1, /*lazy_timing_constraints=*/true));
+  PipelineSchedule schedule(f, lazy);
+  XLS_EXPECT_OK(schedule.Verify());
+  XLS_EXPECT_OK(schedule.VerifyTiming(1, TestDelayEstimator()));
+  EXPECT_EQ(schedule.length(), 64);
+}
+
+TEST_F(SdcSchedulerTest, LazyInfeasiblePipelineLengthDiagnostics) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  fb.Not(fb.Not(fb.Not(fb.Not(x))));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  absl::Status eager =
+      Schedule(f, /*clock_period_ps=*/1, /*lazy_timing_constraints=*/false,
+               /*pipeline_stages=*/2)
+          .status();
+  EXPECT_THAT(eager, StatusIs(absl::StatusCode::kInvalidArgument,
+                              HasSubstr("`--pipeline_stages=4`")));
+  EXPECT_EQ(Schedule(f, /*clock_period_ps=*/1,
+                     /*lazy_timing_constraints=*/true,
+                     /*pipeline_stages=*/2)
+                .status(),
+            eager);
+}
+
+TEST_F(SdcSchedulerTest, LazyInfeasibleBackedgeDiagnostics) {
+  // The next state is four operations away from the state read, which can't
+  // be done in a single cycle at full throughput.
+  auto p = CreatePackage();
+  ProcBuilder pb(TestName(), p.get());
+  BValue state = pb.StateElement("state", Value(UBits(0, 32)));
+  pb.Next(state, pb.Not(pb.Not(pb.Not(pb.Not(state)))));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  absl::Status eager =
+      Schedule(proc, /*clock_period_ps=*/1, /*lazy_timing_constraints=*/false,
+               /*pipeline_stages=*/std::nullopt,
+               /*worst_case_throughput=*/1)
+          .status();
+  EXPECT_THAT(eager, StatusIs(absl::StatusCode::kInvalidArgument,
+                              HasSubstr("full throughput")));
+  EXPECT_EQ(Schedule(proc, /*clock_period_ps=*/1,
+                     /*lazy_timing_constraints=*/true,
+                     /*pipeline_stages=*/std::nullopt,
+                     /*worst_case_throughput=*/1)
+                .status(),
+            eager);
+}
+
+TEST_F(SdcSchedulerTest, LazyFindsSameMinimumClockPeriod) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  fb.Add(fb.UDiv(fb.Not(x), fb.Negate(y)), fb.Not(fb.Not(y)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  auto options = [](bool lazy_timing_constraints) {
+    return SchedulingOptions(SchedulingStrategy::SDC)
+        .pipeline_stages(2)
+        .lazy_timing_constraints(lazy_timing_constraints);
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule eager,
+      RunPipelineSchedule(f, TestDelayEstimator(), options(false)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule lazy,
+      RunPipelineSchedule(f, TestDelayEstimator(), options(true)));
+  ASSERT_TRUE(eager.min_clock_period_ps().has_value());
+  EXPECT_EQ(lazy.min_clock_period_ps(), eager.min_clock_period_ps());
+  EXPECT_EQ(Objective(f, lazy.GetCycleMap()),
+            Objective(f, eager.GetCycleMap()));
+}
+
+}  // namespace
+}  // namespace xls
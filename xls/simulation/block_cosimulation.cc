@@ -0,0 +1,417 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/simulation/block_cosimulation.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/codegen/flattening.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/codegen/vast/vast.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/block_elaboration.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/simulation/module_testbench.h"
+#include "xls/simulation/module_testbench_thread.h"
+#include "xls/simulation/testbench_signal_capture.h"
+#include "xls/simulation/testbench_stream.h"
+#include "xls/simulation/verilog_include.h"
+#include "xls/simulation/verilog_simulator.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+// The number of cycles up to and including a divergence shown in the trace.
+constexpr int64_t kTraceCycles = 8;
+
+struct Divergence {
+  int64_t cycle;
+  std::string port_name;
+  Bits simulated;
+};
+
+// The output port values computed by the block evaluator. Shared between the
+// thread running the evaluator and the threads reading the simulation's output
+// streams, which wait for the evaluator to reach the cycle they compare.
+class EvaluatedOutputs {
+ public:
+  explicit EvaluatedOutputs(int64_t cycle_count) : outputs_(cycle_count) {}
+
+  // Records the output port values of the next cycle.
+  void Push(absl::flat_hash_map<std::string, Bits> outputs) {
+    absl::MutexLock lock(&mutex_);
+    outputs_[evaluated_cycles_] = std::move(outputs);
+    ++evaluated_cycles_;
+    evaluated_.SignalAll();
+  }
+
+  // Marks the evaluation as finished, successfully or not.
+  void Finish(absl::Status status) {
+    absl::MutexLock lock(&mutex_);
+    finished_ = true;
+    status_ = std::move(status);
+    evaluated_.SignalAll();
+  }
+
+  // Waits until the given cycle is evaluated and returns its output port
+  // values, or returns nullptr if the evaluation stopped first.
+  const absl::flat_hash_map<std::string, Bits>* Wait(int64_t cycle) {
+    absl::MutexLock lock(&mutex_);
+    while (!finished_ && evaluated_cycles_ <= cycle) {
+      evaluated_.Wait(&mutex_);
+    }
+    if (evaluated_cycles_ <= cycle) {
+      return nullptr;
+    }
+    return &outputs_[cycle];
+  }
+
+  // Records a divergence between the evaluator and the simulation. Only the
+  // earliest divergence is kept.
+  void RecordDivergence(Divergence divergence) {
+    absl::MutexLock lock(&mutex_);
+    if (!divergence_.has_value() || divergence.cycle < divergence_->cycle) {
+      divergence_ = std::move(divergence);
+    }
+  }
+
+  // Returns whether the evaluation should stop early because the simulations
+  // have already diverged.
+  bool ShouldStop() {
+    absl::MutexLock lock(&mutex_);
+    return divergence_.has_value();
+  }
+
+  // Accessors which must only be called after all threads are joined.
+  const std::optional<Divergence>& divergence() const
+      ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    return divergence_;
+  }
+  const absl::Status& status() const ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    return status_;
+  }
+  const absl::flat_hash_map<std::string, Bits>& outputs(int64_t cycle) const {
+    return outputs_[cycle];
+  }
+
+ private:
+  absl::Mutex mutex_;
+  absl::CondVar evaluated_;
+  // Sized up front so waiting threads may read a cycle's entry outside the
+  // lock once the evaluator has moved past it.
+  std::vector<absl::flat_hash_map<std::string, Bits>> outputs_;
+  int64_t evaluated_cycles_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool finished_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  std::optional<Divergence> divergence_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Produces the per-cycle values of an input port for a testbench stream.
+class InputPortProducer {
+ public:
+  InputPortProducer(
+      std::string port_name,
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs)
+      : port_name_(std::move(port_name)), inputs_(inputs), cycle_(0) {}
+
+  std::optional<Bits> operator()() const {
+    if (cycle_ >= inputs_.size()) {
+      return std::nullopt;
+    }
+    return FlattenValueToBits(inputs_[cycle_++].at(port_name_));
+  }
+
+ private:
+  std::string port_name_;
+  absl::Span<const absl::flat_hash_map<std::string, Value>> inputs_;
+  // The testbench stream API takes a absl::FunctionRef which is a const
+  // reference so make this field mutable.
+  mutable int64_t cycle_;
+};
+
+// Compares the per-cycle values of an output port read from a testbench stream
+// against the values computed by the block evaluator.
+class OutputPortComparator {
+ public:
+  OutputPortComparator(std::string port_name, EvaluatedOutputs* evaluated)
+      : port_name_(std::move(port_name)), evaluated_(evaluated), cycle_(0) {}
+
+  absl::Status operator()(const Bits& simulated) const {
+    int64_t cycle = cycle_++;
+    const absl::flat_hash_map<std::string, Bits>* outputs =
+        evaluated_->Wait(cycle);
+    if (outputs != nullptr && outputs->at(port_name_) != simulated) {
+      evaluated_->RecordDivergence(Divergence{
+          .cycle = cycle, .port_name = port_name_, .simulated = simulated});
+    }
+    return absl::OkStatus();
+  }
+
+  int64_t cycle_count() const { return cycle_; }
+
+ private:
+  std::string port_name_;
+  EvaluatedOutputs* evaluated_;
+  // The testbench stream API takes a absl::FunctionRef which is a const
+  // reference so make this field mutable.
+  mutable int64_t cycle_;
+};
+
+// Returns a trace of the input and evaluated output port values of the cycles
+// leading up to and including `divergence_cycle`.
+std::string DivergenceTrace(
+    Block* block,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    const EvaluatedOutputs& evaluated, int64_t divergence_cycle) {
+  std::vector<std::string> lines;
+  int64_t first_cycle =
+      std::max<int64_t>(0, divergence_cycle - kTraceCycles + 1);
+  for (int64_t cycle = first_cycle; cycle <= divergence_cycle; ++cycle) {
+    std::vector<std::string> input_values;
+    for (InputPort* port : block->GetInputPorts()) {
+      // The reset port is driven by the testbench rather than the inputs.
+      auto value = inputs[cycle].find(port->name());
+      if (value != inputs[cycle].end()) {
+        input_values.push_back(absl::StrFormat(
+            "%s=%s", port->name(),
+            value->second.ToString(FormatPreference::kHex)));
+      }
+    }
+    std::vector<std::string> output_values;
+    for (OutputPort* port : block->GetOutputPorts()) {
+      output_values.push_back(absl::StrFormat(
+          "%s=%s", port->name(),
+          BitsToString(evaluated.outputs(cycle).at(port->name()),
+                       FormatPreference::kHex)));
+    }
+    lines.push_back(absl::StrFormat(
+        "  cycle %d: inputs: %s; outputs: %s", cycle,
+        absl::StrJoin(input_values, ", "), absl::StrJoin(output_values, ", ")));
+  }
+  return absl::StrJoin(lines, "\n");
+}
+
+// Returns the register values of the block after reset. Registers without a
+// reset value are zero.
+absl::StatusOr<absl::flat_hash_map<std::string, Value>> ResetRegisterValues(
+    Block* block) {
+  XLS_ASSIGN_OR_RETURN(BlockElaboration elaboration,
+                       BlockElaboration::Elaborate(block));
+  absl::flat_hash_map<std::string, Value> registers;
+  for (BlockInstance* instance : elaboration.instances()) {
+    if (!instance->block().has_value()) {
+      continue;
+    }
+    for (Register* reg : (*instance->block())->GetRegisters()) {
+      registers[absl::StrCat(instance->RegisterPrefix(), reg->name())] =
+          reg->reset().has_value() ? reg->reset()->reset_value
+                                   : ZeroOfType(reg->type());
+    }
+  }
+  return registers;
+}
+
+}  // namespace
+
+absl::Status CosimulateBlock(
+    Block* block, const BlockEvaluator& evaluator,
+    std::string_view verilog_text, FileType file_type,
+    const ModuleSignature& signature, const VerilogSimulator* simulator,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    absl::Span<const VerilogInclude> includes) {
+  int64_t cycle_count = inputs.size();
+  std::optional<ResetProto> reset;
+  if (signature.proto().has_reset()) {
+    reset = signature.proto().reset();
+  }
+  auto is_reset_port = [&](InputPort* port) {
+    return reset.has_value() && port->name() == reset->name();
+  };
+  for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+    for (InputPort* port : block->GetInputPorts()) {
+      if (!is_reset_port(port) && !inputs[cycle].contains(port->name())) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Missing value for input port `%s` on cycle %d",
+                            port->name(), cycle));
+      }
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ModuleTestbench> tb,
+      ModuleTestbench::CreateFromVerilogText(
+          verilog_text, file_type, signature, simulator,
+          /*reset_dut=*/reset.has_value(), includes,
+          /*simulation_cycle_limit=*/std::nullopt));
+
+  // Each non-empty input port other than the reset, which the testbench drives
+  // itself, is driven from its own stream once per cycle.
+  std::vector<DutInput> dut_inputs;
+  std::vector<std::pair<std::string, const TestbenchStream*>> input_streams;
+  for (InputPort* port : block->GetInputPorts()) {
+    int64_t width = port->GetType()->GetFlatBitCount();
+    if (width == 0 || is_reset_port(port)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        const TestbenchStream* stream,
+        tb->CreateInputStream(absl::StrCat("cosim_in_", port->name()), width));
+    input_streams.push_back({port->name(), stream});
+    dut_inputs.push_back(
+        DutInput{.port_name = port->name(), .initial_value = IsX()});
+  }
+  XLS_ASSIGN_OR_RETURN(ModuleTestbenchThread * input_thread,
+                       tb->CreateThread("input driver", dut_inputs));
+  {
+    SequentialBlock& loop = input_thread->MainBlock().Repeat(cycle_count);
+    for (const auto& [port_name, stream] : input_streams) {
+      loop.ReadFromStreamAndSet(port_name, stream);
+    }
+    loop.NextCycle();
+  }
+
+  // Each non-empty output port is sampled into its own stream once per cycle.
+  std::vector<std::pair<std::string, const TestbenchStream*>> output_streams;
+  for (OutputPort* port : block->GetOutputPorts()) {
+    int64_t width = port->operand(0)->GetType()->GetFlatBitCount();
+    if (width == 0) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        const TestbenchStream* stream,
+        tb->CreateOutputStream(absl::StrCat("cosim_out_", port->name()),
+                               width));
+    output_streams.push_back({port->name(), stream});
+  }
+  XLS_ASSIGN_OR_RETURN(ModuleTestbenchThread * output_thread,
+                       tb->CreateThread("output capture", /*dut_inputs=*/{}));
+  {
+    SequentialBlock& loop = output_thread->MainBlock().Repeat(cycle_count);
+    EndOfCycleEvent& event = loop.AtEndOfCycle();
+    for (const auto& [port_name, stream] : output_streams) {
+      event.CaptureAndWriteToStream(port_name, stream);
+    }
+  }
+
+  // The producers and comparators are referenced by absl::FunctionRef so they
+  // must not move once created.
+  std::vector<InputPortProducer> producers;
+  producers.reserve(input_streams.size());
+  absl::flat_hash_map<std::string, TestbenchStreamThread::Producer>
+      input_producers;
+  for (const auto& [port_name, stream] : input_streams) {
+    producers.emplace_back(port_name, inputs);
+    input_producers.emplace(stream->name, producers.back());
+  }
+  EvaluatedOutputs evaluated(cycle_count);
+  std::vector<OutputPortComparator> comparators;
+  comparators.reserve(output_streams.size());
+  absl::flat_hash_map<std::string, TestbenchStreamThread::Consumer>
+      output_consumers;
+  for (const auto& [port_name, stream] : output_streams) {
+    comparators.emplace_back(port_name, &evaluated);
+    output_consumers.emplace(stream->name, comparators.back());
+  }
+
+  // Run the evaluator concurrently with the simulation. It stops early once a
+  // divergence has been found. The simulated block has been reset before the
+  // first cycle, so the evaluator starts from the reset state with reset
+  // deasserted.
+  Thread evaluator_thread([&]() {
+    evaluated.Finish([&]() -> absl::Status {
+      XLS_ASSIGN_OR_RETURN(
+          (absl::flat_hash_map<std::string, Value> registers),
+          ResetRegisterValues(block));
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockContinuation> continuation,
+                           evaluator.NewContinuation(block, registers));
+      for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+        if (evaluated.ShouldStop()) {
+          break;
+        }
+        if (reset.has_value()) {
+          absl::flat_hash_map<std::string, Value> cycle_inputs = inputs[cycle];
+          cycle_inputs[reset->name()] =
+              Value(UBits(reset->active_low() ? 1 : 0, 1));
+          XLS_RETURN_IF_ERROR(continuation->RunOneCycle(cycle_inputs));
+        } else {
+          XLS_RETURN_IF_ERROR(continuation->RunOneCycle(inputs[cycle]));
+        }
+        absl::flat_hash_map<std::string, Bits> outputs;
+        for (OutputPort* port : block->GetOutputPorts()) {
+          outputs[port->name()] = FlattenValueToBits(
+              continuation->output_ports().at(port->name()));
+        }
+        evaluated.Push(std::move(outputs));
+      }
+      return absl::OkStatus();
+    }());
+  });
+  absl::Status simulation_status =
+      tb->RunWithStreamingIo(input_producers, output_consumers);
+  evaluator_thread.Join();
+
+  if (evaluated.divergence().has_value()) {
+    const Divergence& divergence = *evaluated.divergence();
+    return absl::InternalError(absl::StrFormat(
+        "Block evaluator `%s` and Verilog simulation diverge on cycle %d at "
+        "output port `%s`: evaluator produced %s, simulation produced "
+        "%s\nTrace:\n%s",
+        evaluator.name(), divergence.cycle, divergence.port_name,
+        BitsToString(
+            evaluated.outputs(divergence.cycle).at(divergence.port_name),
+            FormatPreference::kHex),
+        BitsToString(divergence.simulated, FormatPreference::kHex),
+        DivergenceTrace(block, inputs, evaluated, divergence.cycle)));
+  }
+  XLS_RETURN_IF_ERROR(evaluated.status());
+  XLS_RETURN_IF_ERROR(simulation_status);
+  for (int64_t i = 0; i < comparators.size(); ++i) {
+    if (comparators[i].cycle_count() != cycle_count) {
+      return absl::InternalError(absl::StrFormat(
+          "Verilog simulation produced %d values for output port `%s`, "
+          "expected %d",
+          comparators[i].cycle_count(), output_streams[i].first, cycle_count));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace verilog
+}  // namespace xls
@@ -0,0 +1,60 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SIMULATION_BLOCK_COSIMULATION_H_
+#define XLS_SIMULATION_BLOCK_COSIMULATION_H_
+
+#include <string>
+#include <string_view>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/vast/vast.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/ir/block.h"
+#include "xls/ir/value.h"
+#include "xls/simulation/verilog_include.h"
+#include "xls/simulation/verilog_simulator.h"
+
+namespace xls {
+namespace verilog {
+
+// Runs `block` under `evaluator` (e.g., kJitBlockEvaluator) and the Verilog
+// generated from it under `simulator` in lockstep, and checks that the output
+// ports agree on every cycle.
+//
+// `inputs` holds the value of every input port of the block for each cycle.
+// The inputs are streamed into the simulation while the evaluator runs
+// concurrently in another thread; each output value is compared as soon as the
+// simulator produces it. If the signature has a reset, the testbench resets the
+// module before the first cycle and holds reset deasserted afterwards, so
+// `inputs` need not include the reset port. Outputs must not be X, so any
+// register without a reset must be flushed by the stimulus before it is
+// observable.
+//
+// On the first divergence an error is returned which names the cycle and port
+// and holds a trace of the inputs and outputs of the cycles leading up to it.
+absl::Status CosimulateBlock(
+    Block* block, const BlockEvaluator& evaluator,
+    std::string_view verilog_text, FileType file_type,
+    const ModuleSignature& signature, const VerilogSimulator* simulator,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    absl::Span<const VerilogInclude> includes = {});
+
+}  // namespace verilog
+}  // namespace xls
+
+#endif  // XLS_SIMULATION_BLOCK_COSIMULATION_H_
@@ -0,0 +1,157 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/simulation/block_cosimulation.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/codegen/block_generator.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/signature_generator.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
+#include "xls/simulation/verilog_test_base.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::AllOf;
+using ::testing::HasSubstr;
+
+class BlockCosimulationTest : public VerilogTestBase {
+ protected:
+  // Builds a block which accumulates `x` into a register with a synchronous
+  // active-high reset and outputs the register plus `offset`.
+  absl::StatusOr<Block*> MakeAccumulator(Package* package,
+                                         std::string_view name,
+                                         int64_t offset) {
+    Type* u8 = package->GetBitsType(8);
+    BlockBuilder bb(name, package);
+    BValue x = bb.InputPort("x", u8);
+    BValue rst = bb.InputPort("rst", package->GetBitsType(1));
+    XLS_RETURN_IF_ERROR(bb.block()->AddClockPort("clk"));
+    XLS_ASSIGN_OR_RETURN(
+        Register * acc_reg,
+        bb.block()->AddRegister("acc", u8,
+                                xls::Reset{.reset_value = Value(UBits(0, 8)),
+                                           .asynchronous = false,
+                                           .active_low = false}));
+    BValue acc = bb.RegisterRead(acc_reg);
+    bb.RegisterWrite(acc_reg, bb.Add(acc, x), /*load_enable=*/std::nullopt,
+                     rst);
+    bb.OutputPort("out", bb.Add(acc, bb.Literal(UBits(offset, 8))));
+    return bb.Build();
+  }
+
+  CodegenOptions cosim_codegen_options() {
+    return codegen_options().clock_name("clk").reset(
+        "rst", /*asynchronous=*/false, /*active_low=*/false,
+        /*reset_data_path=*/false);
+  }
+
+  std::vector<absl::flat_hash_map<std::string, Value>> Stimulus(
+      int64_t cycle_count) {
+    std::vector<absl::flat_hash_map<std::string, Value>> inputs;
+    for (int64_t i = 0; i < cycle_count; ++i) {
+      inputs.push_back({{"x", Value(UBits(i * 7 + 3, 8))}});
+    }
+    return inputs;
+  }
+};
+
+TEST_P(BlockCosimulationTest, Accumulator) {
+  Package package(TestBaseName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block, MakeAccumulator(&package, "accumulator", /*offset=*/0));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateVerilog(block, cosim_codegen_options()));
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature,
+                           GenerateSignature(cosim_codegen_options(), block));
+
+  XLS_EXPECT_OK(CosimulateBlock(block, kInterpreterBlockEvaluator, verilog,
+                                GetFileType(), signature, GetSimulator(),
+                                Stimulus(100)));
+  XLS_EXPECT_OK(CosimulateBlock(block, kJitBlockEvaluator, verilog,
+                                GetFileType(), signature, GetSimulator(),
+                                Stimulus(100)));
+}
+
+TEST_P(BlockCosimulationTest, Divergence) {
+  Package package(TestBaseName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block, MakeAccumulator(&package, "accumulator", /*offset=*/0));
+  // Simulate Verilog which differs from the evaluated block.
+  XLS_ASSERT_OK_AND_ASSIGN(Block * mutant,
+                           MakeAccumulator(&package, "mutant", /*offset=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateVerilog(mutant, cosim_codegen_options()));
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature,
+                           GenerateSignature(cosim_codegen_options(), mutant));
+
+  EXPECT_THAT(
+      CosimulateBlock(block, kJitBlockEvaluator, verilog, GetFileType(),
+                      signature, GetSimulator(), Stimulus(100)),
+      StatusIs(absl::StatusCode::kInternal,
+               AllOf(HasSubstr("diverge on cycle 0 at output port `out`: "
+                               "evaluator produced 0x0, simulation produced "
+                               "0x1"),
+                     HasSubstr("cycle 0: inputs: x=bits[8]:0x3"))));
+}
+
+TEST_P(BlockCosimulationTest, MissingInput) {
+  Package package(TestBaseName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block, MakeAccumulator(&package, "accumulator", /*offset=*/0));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateVerilog(block, cosim_codegen_options()));
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature,
+                           GenerateSignature(cosim_codegen_options(), block));
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs = Stimulus(4);
+  inputs[2].clear();
+  EXPECT_THAT(CosimulateBlock(block, kInterpreterBlockEvaluator, verilog,
+                              GetFileType(), signature, GetSimulator(), inputs),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing value for input port `x` on cycle "
+                                 "2")));
+}
+
+INSTANTIATE_TEST_SUITE_P(BlockCosimulationTestInstantiation,
+                         BlockCosimulationTest,
+                         testing::ValuesIn(kDefaultSimulationTargets),
+                         ParameterizedTestName<BlockCosimulationTest>);
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
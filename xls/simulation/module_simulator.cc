@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -39,6 +40,7 @@
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/value.h"
@@ -328,7 +330,8 @@ absl::StatusOr<Bits> ModuleSimulator::RunAndReturnSingleOutput(
 }
 
 absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
-ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
+ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs,
+                            int64_t max_shards) const {
   VLOG(1) << "Running Verilog module with signature:\n"
           << signature_.ToString();
   if (VLOG_IS_ON(1)) {
@@ -356,6 +359,39 @@ ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
     return absl::InvalidArgumentError("Expected clock in signature");
   }
 
+  // Each shard is a contiguous slice of the batch run by its own testbench in
+  // its own simulator process. The DUT is reset at the start of each
+  // testbench, which is invisible to a function.
+  int64_t shards = std::clamp<int64_t>(max_shards, 1, inputs.size());
+  if (shards == 1) {
+    return RunBatchedShard(inputs);
+  }
+  std::vector<absl::StatusOr<std::vector<BitsMap>>> shard_outputs(
+      shards, absl::UnknownError("not run"));
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(shards);
+  for (int64_t shard = 0; shard < shards; ++shard) {
+    int64_t start = inputs.size() * shard / shards;
+    int64_t end = inputs.size() * (shard + 1) / shards;
+    threads.push_back(std::make_unique<Thread>([&, shard, start, end]() {
+      shard_outputs[shard] =
+          RunBatchedShard(inputs.subspan(start, end - start));
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  std::vector<BitsMap> outputs;
+  outputs.reserve(inputs.size());
+  for (absl::StatusOr<std::vector<BitsMap>>& shard_output : shard_outputs) {
+    XLS_RETURN_IF_ERROR(shard_output.status());
+    absl::c_move(*shard_output, std::back_inserter(outputs));
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+ModuleSimulator::RunBatchedShard(absl::Span<const BitsMap> inputs) const {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ModuleTestbench> tb,
                        ModuleTestbench::CreateFromVerilogText(
                            verilog_text_, file_type_, signature_, simulator_,
@@ -519,14 +555,15 @@ absl::StatusOr<Value> ModuleSimulator::RunFunction(
 }
 
 absl::StatusOr<std::vector<Value>> ModuleSimulator::RunBatched(
-    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    int64_t max_shards) const {
   std::vector<BitsMap> bits_inputs;
   for (const auto& input : inputs) {
     XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
     bits_inputs.push_back(ValueMapToBitsMap(input));
   }
   XLS_ASSIGN_OR_RETURN(std::vector<BitsMap> bits_outputs,
-                       RunBatched(bits_inputs));
+                       RunBatched(bits_inputs, max_shards));
   CHECK_EQ(signature_.data_outputs().size(), 1);
   std::vector<Value> outputs;
   for (const BitsMap& bits_output : bits_outputs) {
@@ -108,14 +108,20 @@ class ModuleSimulator {
   // Runs the given batch of argument values through the module with a single
   // invocation of the Verilog simulator. Generally, this is much faster than
   // running via separate calls to Run.
+  //
+  // If `max_shards` is greater than one, the batch is instead split into up to
+  // that many contiguous shards which are simulated concurrently, each by its
+  // own simulator invocation. The results are returned in input order. The
+  // simulator must support concurrent invocations.
   absl::StatusOr<std::vector<BitsMap>> RunBatched(
-      absl::Span<const BitsMap> inputs) const;
+      absl::Span<const BitsMap> inputs, int64_t max_shards = 1) const;
 
   // Overloads which accept Values rather than Bits.
   absl::StatusOr<Value> RunFunction(
       const absl::flat_hash_map<std::string, Value>& inputs) const;
   absl::StatusOr<std::vector<Value>> RunBatched(
-      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const;
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+      int64_t max_shards = 1) const;
 
   // Runs the given channel inputs and expects a number of values at an output
   // channel on the a design under test (DUT) derived from a proc.
@@ -143,6 +149,10 @@ class ModuleSimulator {
       std::optional<ReadyValidHoldoffs> holdoffs = std::nullopt) const;
 
  private:
+  // Runs the given validated batch with a single testbench.
+  absl::StatusOr<std::vector<BitsMap>> RunBatchedShard(
+      absl::Span<const BitsMap> inputs) const;
+
   // Returns the control input ports and their deasserted values.
   std::vector<DutInput> DeassertControlSignals() const;
 
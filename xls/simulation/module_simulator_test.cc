@@ -390,6 +390,25 @@ TEST_P(ModuleSimulatorTest, FixedLatencyBatched) {
   EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(14, 8))));
 }
 
+TEST_P(ModuleSimulatorTest, FixedLatencyShardedBatch) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeFixedLatencyModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+
+  using BitsMap = ModuleSimulator::BitsMap;
+  std::vector<BitsMap> inputs;
+  for (int64_t i = 0; i < 7; ++i) {
+    inputs.push_back(BitsMap{{"x", UBits(i, 8)}});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<BitsMap> outputs,
+                           simulator.RunBatched(inputs, /*max_shards=*/3));
+
+  ASSERT_EQ(outputs.size(), 7);
+  for (int64_t i = 0; i < 7; ++i) {
+    EXPECT_THAT(outputs[i], ElementsAre(Pair("out", UBits(2 * i, 8))));
+  }
+}
+
 TEST_P(ModuleSimulatorTest, CombinationalBatched) {
   XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeCombinationalModule());
   ModuleSimulator simulator =
@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
@@ -37,11 +38,13 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/codegen/vast/vast.h"
+#include "xls/common/file/named_pipe.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/source_location.h"
@@ -118,7 +121,7 @@ absl::StatusOr<std::vector<DutInput>> GetAllDutInputs(
     if (initial_values.default_value == ZeroOrX::kZero) {
       return UBits(0, metadata.GetPortWidth(port));
     }
-    return IsX();
+    return BitsOrX(IsX());
   };
   for (const std::string& port : metadata.dut_input_ports()) {
     // Exclude the clock as an input and reset if `exclude_reset` is true.
@@ -135,6 +138,30 @@ absl::StatusOr<std::vector<DutInput>> GetAllDutInputs(
   return dut_inputs;
 }
 
+// Returns the stream to which signal captures are written when capturing to a
+// file.
+TestbenchStream SignalCaptureStream() {
+  return TestbenchStream{
+      .name = std::string{kSignalCaptureStreamName},
+      .direction = TestbenchStreamDirection::kOutput,
+      .path_macro_name = absl::StrFormat(
+          "__%s_PATH", absl::AsciiStrToUpper(kSignalCaptureStreamName)),
+      .width = 0};
+}
+
+// Returns the path of the signal capture file in `directory` and adds the
+// macro definition pointing the testbench at it to `macro_definitions`.
+std::filesystem::path AddSignalCaptureFile(
+    const std::filesystem::path& directory,
+    std::vector<VerilogSimulator::MacroDefinition>& macro_definitions) {
+  TestbenchStream capture_stream = SignalCaptureStream();
+  std::filesystem::path path = directory / capture_stream.name;
+  macro_definitions.push_back(VerilogSimulator::MacroDefinition{
+      capture_stream.path_macro_name,
+      absl::StrFormat("\"%s\"", path.string())});
+  return path;
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<ModuleTestbench>>
@@ -185,7 +212,10 @@ ModuleTestbench::ModuleTestbench(std::string_view verilog_text,
       reset_dut_(reset_dut),
       includes_(includes.begin(), includes.end()),
       simulation_cycle_limit_(simulation_cycle_limit),
-      capture_manager_(&metadata_) {}
+      capture_manager_(&metadata_) {
+  // Reserved for capturing signals to a file.
+  stream_names_.insert(std::string{kSignalCaptureStreamName});
+}
 
 absl::Status ModuleTestbench::CreateInitialThreads() {
   // Global reset controller. If a reset is present, the threads will wait
@@ -281,6 +311,19 @@ absl::StatusOr<ModuleTestbenchThread*> ModuleTestbench::CreateThread(
   return threads_.back().get();
 }
 
+// Parses the hex value of a captured signal of the given width.
+static absl::StatusOr<BitsOrX> ParseCapturedValue(std::string_view value,
+                                                  int64_t width) {
+  if (absl::StrContains(value, "x") || absl::StrContains(value, "X")) {
+    return BitsOrX(IsX());
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Bits bits,
+      ParseUnsignedNumberWithoutPrefix(value, FormatPreference::kHex));
+  XLS_RET_CHECK_GE(width, bits.bit_count());
+  return BitsOrX(bits_ops::ZeroExtend(bits, width));
+}
+
 // Scans the given simulation stdout and finds the $display statement outputs
 // associated with captured signals. Returns the signal values as Bits (or X)
 // for each output found in a map indexed by id of the capture instance.
@@ -315,16 +358,46 @@ ExtractSignalValues(std::string_view stdout_str) {
         "Found output `%s` width %d value %s instance #%d", output_name, width,
         output_value, instance);
 
-    if (absl::StrContains(output_value, "x") ||
-        absl::StrContains(output_value, "X")) {
-      parsed_values[instance].push_back(IsX());
-    } else {
-      XLS_ASSIGN_OR_RETURN(
-          Bits value, ParseUnsignedNumberWithoutPrefix(output_value,
-                                                       FormatPreference::kHex));
-      XLS_RET_CHECK_GE(width, value.bit_count());
-      parsed_values[instance].push_back(bits_ops::ZeroExtend(value, width));
+    XLS_ASSIGN_OR_RETURN(BitsOrX value,
+                         ParseCapturedValue(output_value, width));
+    parsed_values[instance].push_back(std::move(value));
+  }
+  return parsed_values;
+}
+
+// Reads the captured signal values from the file written by the testbench
+// when capturing to a file. Each line holds a capture instance id and the
+// value in hex:
+//
+//   1 12ab
+//
+// The file is read a line at a time so memory use is bounded by the captured
+// values rather than the length of the simulation output.
+static absl::StatusOr<absl::flat_hash_map<int64_t, std::vector<BitsOrX>>>
+ExtractSignalValuesFromFile(const std::filesystem::path& path,
+                            absl::Span<const SignalCapture> signal_captures) {
+  absl::flat_hash_map<int64_t, int64_t> widths;
+  for (const SignalCapture& signal_capture : signal_captures) {
+    widths[signal_capture.instance_id] = signal_capture.signal_width;
+  }
+  absl::flat_hash_map<int64_t, std::vector<BitsOrX>> parsed_values;
+  XLS_ASSIGN_OR_RETURN(FileLineReader reader, FileLineReader::Create(path));
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> line, reader.ReadLine());
+    if (!line.has_value()) {
+      break;
     }
+    std::pair<std::string_view, std::string_view> fields =
+        absl::StrSplit(*line, absl::MaxSplits(' ', 1));
+    int64_t instance;
+    XLS_RET_CHECK(absl::SimpleAtoi(fields.first, &instance))
+        << "Malformed capture record: " << *line;
+    auto width = widths.find(instance);
+    XLS_RET_CHECK(width != widths.end())
+        << "Unknown capture instance in record: " << *line;
+    XLS_ASSIGN_OR_RETURN(BitsOrX value,
+                         ParseCapturedValue(fields.second, width->second));
+    parsed_values[instance].push_back(std::move(value));
   }
   return parsed_values;
 }
@@ -424,7 +497,8 @@ static absl::Status CheckCapturedSignalAgainstExpectation(
 }
 
 absl::Status ModuleTestbench::CaptureOutputsAndCheckExpectations(
-    std::string_view stdout_str) const {
+    std::string_view stdout_str,
+    const std::optional<std::filesystem::path>& capture_path) const {
   // Check for timeout.
   if (simulation_cycle_limit_.has_value() &&
       absl::StrContains(stdout_str,
@@ -435,7 +509,13 @@ absl::Status ModuleTestbench::CaptureOutputsAndCheckExpectations(
   }
 
   absl::flat_hash_map<int64_t, std::vector<BitsOrX>> outputs;
-  XLS_ASSIGN_OR_RETURN(outputs, ExtractSignalValues(stdout_str));
+  if (capture_path.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        outputs, ExtractSignalValuesFromFile(
+                     *capture_path, capture_manager_.signal_captures()));
+  } else {
+    XLS_ASSIGN_OR_RETURN(outputs, ExtractSignalValues(stdout_str));
+  }
 
   for (const SignalCapture& signal_capture :
        capture_manager_.signal_captures()) {
@@ -555,7 +635,8 @@ std::string ModuleTestbench::GenerateVerilog() const {
   // Create emitters for emitting Verilog code for handling file I/O. Add any
   // declarations for handling IO to/from streams. And emit code to open files.
   absl::flat_hash_map<std::string, VastStreamEmitter> stream_emitters;
-  if (!streams_.empty()) {
+  TestbenchStream capture_stream = SignalCaptureStream();
+  if (!streams_.empty() || capture_to_file_) {
     m->Add<BlankLine>(SourceInfo());
     m->Add<Comment>(SourceInfo(),
                     "Variable declarations for supporting streaming I/O.");
@@ -564,6 +645,10 @@ std::string ModuleTestbench::GenerateVerilog() const {
       stream_emitters.insert(
           {stream->name, VastStreamEmitter::Create(*stream, m)});
     }
+    if (capture_to_file_) {
+      stream_emitters.insert(
+          {capture_stream.name, VastStreamEmitter::Create(capture_stream, m)});
+    }
 
     m->Add<BlankLine>(SourceInfo());
     m->Add<Comment>(SourceInfo(), "Open files for I/O.");
@@ -571,9 +656,13 @@ std::string ModuleTestbench::GenerateVerilog() const {
     for (const std::unique_ptr<TestbenchStream>& stream : streams_) {
       stream_emitters.at(stream->name).EmitOpen(initial->statements());
     }
+    if (capture_to_file_) {
+      stream_emitters.at(capture_stream.name)
+          .EmitOpen(initial->statements());
+    }
   }
 
-  {
+  if (!monitored_signals_.has_value() || !monitored_signals_->empty()) {
     // Add a monitor statement which prints out all the port values.
     m->Add<BlankLine>(SourceInfo());
     m->Add<Comment>(SourceInfo(), "Monitor for input/output ports.");
@@ -602,7 +691,9 @@ std::string ModuleTestbench::GenerateVerilog() const {
     std::vector<Expression*> monitor_args = {
         file.Make<SystemFunctionCall>(SourceInfo(), "time")};
     for (const Connection& connection : connections) {
-      if (metadata_.IsClock(connection.port_name)) {
+      if (metadata_.IsClock(connection.port_name) ||
+          (monitored_signals_.has_value() &&
+           !monitored_signals_->contains(connection.port_name))) {
         continue;
       }
       absl::StrAppend(&monitor_fmt, " ", connection.port_name, ": %d");
@@ -665,6 +756,10 @@ std::string ModuleTestbench::GenerateVerilog() const {
     for (const std::unique_ptr<TestbenchStream>& stream : streams_) {
       stream_emitters.at(stream->name).EmitClose(initial->statements());
     }
+    if (capture_to_file_) {
+      stream_emitters.at(capture_stream.name)
+          .EmitClose(initial->statements());
+    }
 
     initial->statements()->Add<Finish>(SourceInfo());
   }
@@ -692,14 +787,21 @@ absl::Status ModuleTestbench::Run() const {
   }
   std::string verilog_text = GenerateVerilog();
   XLS_VLOG_LINES(3, verilog_text);
+  std::optional<TempDirectory> temp_dir;
+  std::optional<std::filesystem::path> capture_path;
+  std::vector<VerilogSimulator::MacroDefinition> macro_definitions;
+  if (capture_to_file_) {
+    XLS_ASSIGN_OR_RETURN(temp_dir, TempDirectory::Create());
+    capture_path = AddSignalCaptureFile(temp_dir->path(), macro_definitions);
+  }
   std::pair<std::string, std::string> stdout_stderr;
-  XLS_ASSIGN_OR_RETURN(stdout_stderr,
-                       simulator_->Run(verilog_text, file_type_,
-                                       /*macro_definitions=*/{}, includes_));
+  XLS_ASSIGN_OR_RETURN(
+      stdout_stderr,
+      simulator_->Run(verilog_text, file_type_, macro_definitions, includes_));
   VLOG(2) << "Verilog simulator stdout:\n" << stdout_stderr.first;
   VLOG(2) << "Verilog simulator stderr:\n" << stdout_stderr.second;
   const std::string& stdout_str = stdout_stderr.first;
-  return CaptureOutputsAndCheckExpectations(stdout_str);
+  return CaptureOutputsAndCheckExpectations(stdout_str, capture_path);
 }
 
 absl::Status ModuleTestbench::RunWithStreamingIo(
@@ -734,6 +836,10 @@ absl::Status ModuleTestbench::RunWithStreamingIo(
 
   XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
   std::vector<VerilogSimulator::MacroDefinition> macro_definitions;
+  std::optional<std::filesystem::path> capture_path;
+  if (capture_to_file_) {
+    capture_path = AddSignalCaptureFile(temp_dir.path(), macro_definitions);
+  }
 
   std::vector<TestbenchStreamThread> stream_threads;
   stream_threads.reserve(streams_.size());
@@ -767,7 +873,22 @@ absl::Status ModuleTestbench::RunWithStreamingIo(
   VLOG(2) << "Verilog simulator stderr:\n" << stdout_stderr.second;
 
   const std::string& stdout_str = stdout_stderr.first;
-  return CaptureOutputsAndCheckExpectations(stdout_str);
+  return CaptureOutputsAndCheckExpectations(stdout_str, capture_path);
+}
+
+absl::Status ModuleTestbench::MonitorSignals(
+    absl::Span<const std::string> port_names) {
+  absl::flat_hash_set<std::string> signals;
+  for (const std::string& port_name : port_names) {
+    if (!metadata_.HasPortNamed(port_name)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("`%s` is not a port of module `%s`", port_name,
+                          metadata_.dut_module_name()));
+    }
+    signals.insert(port_name);
+  }
+  monitored_signals_ = std::move(signals);
+  return absl::OkStatus();
 }
 
 static std::string GetPipePathMacroName(std::string_view stream_name) {
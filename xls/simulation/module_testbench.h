@@ -16,6 +16,7 @@
 #define XLS_SIMULATION_MODULE_TESTBENCH_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
@@ -115,6 +116,17 @@ class ModuleTestbench {
         thread_name, {.default_value = default_value}, wait_until_done);
   }
 
+  // Writes captured signal values (Capture, ExpectEq, etc.) to a file in a
+  // compact format rather than $display-ing them, and streams them back from
+  // the file after simulation. For long simulations this avoids buffering and
+  // scanning a very large simulator output.
+  void CaptureToFile() { capture_to_file_ = true; }
+
+  // Restricts the $monitor statement, which prints the DUT ports whenever any
+  // of them changes, to the given ports. An empty list removes the monitor.
+  // By default all ports except the clock are monitored.
+  absl::Status MonitorSignals(absl::Span<const std::string> port_names);
+
   // Generates the Verilog representation of the testbench.
   std::string GenerateVerilog() const;
 
@@ -166,9 +178,11 @@ class ModuleTestbench {
       std::string_view thread_name, absl::Span<const DutInput> dut_inputs,
       bool wait_until_done, bool wait_for_reset);
 
-  // Checks the stdout of a simulation run against expectations.
+  // Checks the stdout of a simulation run against expectations. If capturing
+  // to a file, the captured values are read from `capture_path`.
   absl::Status CaptureOutputsAndCheckExpectations(
-      std::string_view stdout_str) const;
+      std::string_view stdout_str,
+      const std::optional<std::filesystem::path>& capture_path) const;
 
   std::vector<std::string> GatherExpectedTraces() const;
 
@@ -181,6 +195,11 @@ class ModuleTestbench {
   std::optional<int64_t> simulation_cycle_limit_;
 
   SignalCaptureManager capture_manager_;
+  bool capture_to_file_ = false;
+
+  // The DUT ports to print in the $monitor statement. std::nullopt means all
+  // of them.
+  std::optional<absl::flat_hash_set<std::string>> monitored_signals_;
 
   // A list of blocks that execute concurrently in the testbench, a.k.a.
   // 'threads'. The xls::verilog::ModuleTestbench::CreateThread function
@@ -47,6 +47,7 @@ using ::absl_testing::StatusIs;
 using ::testing::ContainsRegex;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::Not;
 
 constexpr char kTestName[] = "module_testbench_test";
 constexpr char kTestdataPath[] = "xls/simulation/testdata";
@@ -855,6 +856,59 @@ TEST_P(ModuleTestbenchTest, IdentityPipelineRepeatForever) {
                                   UBits(2, 16)));
 }
 
+TEST_P(ModuleTestbenchTest, IdentityPipelineCaptureToFile) {
+  VerilogFile f = NewVerilogFile();
+  Module* m = MakeTwoStageIdentityPipelineWithReset(&f, /*width=*/16);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ModuleTestbench> tb,
+      ModuleTestbench::CreateFromVastModule(m, GetSimulator(), "clk"));
+  tb->CaptureToFile();
+  XLS_ASSERT_OK(tb->MonitorSignals({"out"}));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleTestbenchThread * input_thread,
+      tb->CreateThread(
+          "input driver",
+          {DutInput{.port_name = "reset", .initial_value = UBits(1, 1)},
+           DutInput{.port_name = "in", .initial_value = UBits(0, 16)}}));
+  {
+    SequentialBlock& seq = input_thread->MainBlock();
+    seq.Set("reset", 0).Set("in", 1).NextCycle();
+    seq.Set("in", 2).NextCycle();
+  }
+
+  std::vector<Bits> output;
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleTestbenchThread * output_thread,
+                           tb->CreateThread("output capture",
+                                            /*dut_inputs=*/{}));
+  {
+    SequentialBlock& seq = output_thread->MainBlock();
+    SequentialBlock& loop = seq.Repeat(3);
+    loop.AtEndOfCycle().CaptureMultiple("out", &output);
+    seq.AtEndOfCycle().ExpectEq("out", 2);
+  }
+
+  std::string verilog = tb->GenerateVerilog();
+  EXPECT_THAT(verilog, HasSubstr("$fwrite"));
+  EXPECT_THAT(verilog, Not(HasSubstr("OUTPUT")));
+  EXPECT_THAT(verilog, HasSubstr("out: %d"));
+  EXPECT_THAT(verilog, Not(HasSubstr("in: %d")));
+
+  XLS_ASSERT_OK(tb->Run());
+
+  EXPECT_THAT(output, ElementsAre(UBits(0, 16), UBits(0, 16), UBits(1, 16)));
+}
+
+TEST_P(ModuleTestbenchTest, MonitorInvalidSignal) {
+  VerilogFile f = NewVerilogFile();
+  Module* m = MakeTwoStageIdentityPipelineWithReset(&f, /*width=*/16);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ModuleTestbench> tb,
+      ModuleTestbench::CreateFromVastModule(m, GetSimulator(), "clk"));
+  EXPECT_THAT(tb->MonitorSignals({"not_a_port"}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("`not_a_port` is not a port of module")));
+}
+
 TEST_P(ModuleTestbenchTest, DuplicateThreadNames) {
   VerilogFile f = NewVerilogFile();
   Module* m = MakeTwoStageIdentityPipeline(&f);
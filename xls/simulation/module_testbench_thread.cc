@@ -80,7 +80,8 @@ void WaitNCycles(LogicRef* clk, StatementBlock* statement_block,
 }
 
 // Emit $display statements and file I/O into the given block which sample the
-// value of the given signals.
+// value of the given signals. If `stream_emitters` includes the signal capture
+// stream, values are written to it rather than displayed.
 void EmitSignalCaptures(
     absl::Span<const SignalCapture> signal_captures,
     StatementBlock* statement_block,
@@ -97,6 +98,22 @@ void EmitSignalCaptures(
                      signal_refs.at(signal_capture.signal_name));
       continue;
     }
+    if (auto capture_file = stream_emitters.find(kSignalCaptureStreamName);
+        capture_file != stream_emitters.end()) {
+      // The testbench captures to a file. Write a compact record holding the
+      // instance id and the value in hex.
+      if (signal_capture.signal_width == 0) {
+        capture_file->second.EmitFormattedWrite(
+            statement_block,
+            absl::StrFormat(R"(%d 0\n)", signal_capture.instance_id), {});
+      } else {
+        capture_file->second.EmitFormattedWrite(
+            statement_block,
+            absl::StrFormat(R"(%d %%0x\n)", signal_capture.instance_id),
+            {signal_refs.at(signal_capture.signal_name)});
+      }
+      continue;
+    }
     if (signal_capture.signal_width == 0) {
       // Zero-width signals are not actually represented in the Verilog though
       // they may appear in the module signature. Call $display to print a
@@ -0,0 +1,93 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/simulation/simulators/compiled_simulation_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/codegen/vast/vast.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/simulation/verilog_include.h"
+#include "xls/simulation/verilog_simulator.h"
+
+namespace xls {
+namespace verilog {
+
+absl::Status SetUpIncludes(const std::filesystem::path& directory,
+                           absl::Span<const VerilogInclude> includes) {
+  for (const VerilogInclude& include : includes) {
+    std::filesystem::path path = directory / include.relative_path;
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
+    XLS_RETURN_IF_ERROR(SetFileContents(path, include.verilog_text));
+  }
+  return absl::OkStatus();
+}
+
+std::string CompilationKey(
+    std::string_view simulator, std::string_view text, FileType file_type,
+    absl::Span<const VerilogSimulator::MacroDefinition> macro_definitions,
+    absl::Span<const VerilogInclude> includes) {
+  // Every component is length-prefixed so distinct inputs cannot collide.
+  std::string key;
+  auto append = [&](std::string_view piece) {
+    absl::StrAppend(&key, piece.size(), ":", piece);
+  };
+  append(simulator);
+  append(file_type == FileType::kSystemVerilog ? "sv" : "v");
+  append(text);
+  for (const VerilogSimulator::MacroDefinition& macro : macro_definitions) {
+    append(macro.name);
+    append(macro.value.has_value() ? absl::StrCat("=", *macro.value) : "");
+  }
+  absl::StrAppend(&key, "|");
+  for (const VerilogInclude& include : includes) {
+    append(include.relative_path);
+    append(include.verilog_text);
+  }
+  return key;
+}
+
+CompiledSimulationCache& CompiledSimulationCache::Get() {
+  static absl::NoDestructor<CompiledSimulationCache> cache;
+  return *cache;
+}
+
+std::shared_ptr<const CompiledSimulation> CompiledSimulationCache::Find(
+    const std::string& key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = compiled_.find(key);
+  return it == compiled_.end() ? nullptr : it->second;
+}
+
+void CompiledSimulationCache::Insert(
+    std::string key, std::shared_ptr<const CompiledSimulation> compiled) {
+  absl::MutexLock lock(&mutex_);
+  if (compiled_.size() >= kMaxEntries) {
+    compiled_.clear();
+  }
+  compiled_.emplace(std::move(key), std::move(compiled));
+}
+
+}  // namespace verilog
+}  // namespace xls
@@ -0,0 +1,78 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SIMULATION_SIMULATORS_COMPILED_SIMULATION_CACHE_H_
+#define XLS_SIMULATION_SIMULATORS_COMPILED_SIMULATION_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/codegen/vast/vast.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/simulation/verilog_include.h"
+#include "xls/simulation/verilog_simulator.h"
+
+namespace xls {
+namespace verilog {
+
+// Writes `includes` into `directory` at their relative paths.
+absl::Status SetUpIncludes(const std::filesystem::path& directory,
+                           absl::Span<const VerilogInclude> includes);
+
+// Returns a key which uniquely identifies the inputs of a compilation by
+// `simulator`.
+std::string CompilationKey(
+    std::string_view simulator, std::string_view text, FileType file_type,
+    absl::Span<const VerilogSimulator::MacroDefinition> macro_definitions,
+    absl::Span<const VerilogInclude> includes);
+
+// The output of a simulator's compilation step: a simulation image or
+// executable living in a temporary directory, which is removed with it.
+struct CompiledSimulation {
+  TempDirectory directory;
+  std::filesystem::path artifact;
+};
+
+// Process-wide cache of compiled simulations, so simulating the same Verilog
+// text repeatedly (e.g., a streaming testbench fed different stimulus) only
+// invokes the compiler once. The compiled files are removed when they are
+// evicted and no longer being simulated.
+class CompiledSimulationCache {
+ public:
+  static CompiledSimulationCache& Get();
+
+  std::shared_ptr<const CompiledSimulation> Find(const std::string& key);
+  void Insert(std::string key,
+              std::shared_ptr<const CompiledSimulation> compiled);
+
+ private:
+  static constexpr int64_t kMaxEntries = 64;
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const CompiledSimulation>>
+      compiled_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace verilog
+}  // namespace xls
+
+#endif  // XLS_SIMULATION_SIMULATORS_COMPILED_SIMULATION_CACHE_H_
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <string>
@@ -20,8 +21,10 @@
 #include <vector>
 
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/strip.h"
 #include "absl/types/span.h"
@@ -33,6 +36,7 @@
 #include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/simulation/simulators/compiled_simulation_cache.h"
 #include "xls/simulation/verilog_include.h"
 #include "xls/simulation/verilog_simulator.h"
 
@@ -40,16 +44,6 @@ namespace xls {
 namespace verilog {
 namespace {
 
-static absl::Status SetUpIncludes(const std::filesystem::path& temp_dir,
-                                  absl::Span<const VerilogInclude> includes) {
-  for (const VerilogInclude& include : includes) {
-    std::filesystem::path path = temp_dir / include.relative_path;
-    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
-    XLS_RETURN_IF_ERROR(SetFileContents(path, include.verilog_text));
-  }
-  return absl::OkStatus();
-}
-
 absl::StatusOr<std::pair<std::string, std::string>> InvokeIverilog(
     absl::Span<const std::string> args) {
   std::vector<std::string> args_vec;
@@ -102,22 +96,34 @@ class IcarusVerilogSimulator : public VerilogSimulator {
       return absl::UnimplementedError(
           "iverilog does not support SystemVerilog");
     }
-    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
-    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(temp_top.path()));
-    const std::filesystem::path& temp_dir = temp_top.path();
-
-    std::string top_v_path = temp_dir / GetTopFileName(file_type);
-    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
-
-    XLS_ASSIGN_OR_RETURN(TempFile temp_out, TempFile::Create(".out"));
-
-    CHECK_OK(SetUpIncludes(temp_dir, includes));
-    std::vector<std::string> args = {top_v_path, "-o", temp_out.path().string(),
-                                     "-I", temp_dir.string()};
-    AppendMacroDefinitionsToArgs(macro_definitions, args);
-    XLS_RETURN_IF_ERROR(InvokeIverilog(args).status());
+    std::string key = CompilationKey("iverilog", text, file_type,
+                                     macro_definitions, includes);
+    std::shared_ptr<const CompiledSimulation> compiled =
+        CompiledSimulationCache::Get().Find(key);
+    if (compiled == nullptr) {
+      XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+      XLS_RETURN_IF_ERROR(RecursivelyCreateDir(temp_top.path()));
+      const std::filesystem::path& temp_dir = temp_top.path();
+
+      std::string top_v_path = temp_dir / GetTopFileName(file_type);
+      XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+
+      std::filesystem::path temp_out = temp_dir / "simulation.out";
+
+      CHECK_OK(SetUpIncludes(temp_dir, includes));
+      std::vector<std::string> args = {top_v_path, "-o", temp_out.string(),
+                                       "-I", temp_dir.string()};
+      AppendMacroDefinitionsToArgs(macro_definitions, args);
+      XLS_RETURN_IF_ERROR(InvokeIverilog(args).status());
+
+      compiled = std::make_shared<const CompiledSimulation>(CompiledSimulation{
+          .directory = std::move(temp_top), .artifact = std::move(temp_out)});
+      CompiledSimulationCache::Get().Insert(std::move(key), compiled);
+    } else {
+      VLOG(1) << "Reusing compiled simulation " << compiled->artifact;
+    }
 
-    return InvokeVvp({temp_out.path().string()});
+    return InvokeVvp({compiled->artifact.string()});
   }
 
   absl::Status RunSyntaxChecking(
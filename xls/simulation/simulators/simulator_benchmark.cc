@@ -0,0 +1,111 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the Verilog simulators on designs from xls/examples. Each
+// benchmark simulates a batch of random inputs through a single testbench;
+// the first iteration includes compilation, later ones hit the compiled
+// simulation cache. Run with:
+//
+//   bazel run -c opt //xls/simulation/simulators:simulator_benchmark --
+//     --benchmark_filter=.
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/random/distributions.h"
+#include "absl/random/random.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/codegen/vast/vast.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/simulation/module_simulator.h"
+#include "xls/simulation/verilog_simulator.h"
+#include "xls/simulation/verilog_simulators.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+struct Example {
+  std::string_view verilog_path;
+  std::string_view signature_path;
+  FileType file_type;
+};
+
+constexpr Example kFindIndex = {
+    .verilog_path = "xls/examples/find_index_5000ps_model_unit.v",
+    .signature_path = "xls/examples/find_index_5000ps_model_unit.sig.textproto",
+    .file_type = FileType::kVerilog,
+};
+
+Bits RandomBits(int64_t bit_count, absl::BitGen& rng) {
+  std::vector<Bits> chunks;
+  for (int64_t remaining = bit_count; remaining > 0; remaining -= 64) {
+    int64_t width = std::min<int64_t>(remaining, 64);
+    chunks.push_back(
+        UBits(absl::Uniform<uint64_t>(rng) >> (64 - width), width));
+  }
+  return chunks.empty() ? Bits() : bits_ops::Concat(chunks);
+}
+
+void BM_Simulate(benchmark::State& state, std::string_view simulator_name,
+                 const Example& example) {
+  std::string verilog = GetFileContents(
+                            GetXlsRunfilePath(example.verilog_path).value())
+                            .value();
+  ModuleSignatureProto signature_proto =
+      ParseTextProtoFile<ModuleSignatureProto>(
+          GetXlsRunfilePath(example.signature_path).value())
+          .value();
+  ModuleSignature signature =
+      ModuleSignature::FromProto(signature_proto).value();
+  VerilogSimulator* simulator = GetVerilogSimulator(simulator_name).value();
+
+  absl::BitGen rng;
+  std::vector<ModuleSimulator::BitsMap> inputs(state.range(0));
+  for (ModuleSimulator::BitsMap& input : inputs) {
+    for (const PortProto& port : signature.data_inputs()) {
+      input[port.name()] = RandomBits(port.width(), rng);
+    }
+  }
+
+  ModuleSimulator module_simulator(signature, verilog, example.file_type,
+                                   simulator);
+  for (auto _ : state) {
+    CHECK_OK(module_simulator.RunBatched(inputs).status());
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+
+BENCHMARK_CAPTURE(BM_Simulate, find_index_iverilog, "iverilog", kFindIndex)
+    ->Arg(1024)
+    ->Arg(16384)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Simulate, find_index_verilator, "verilator", kFindIndex)
+    ->Arg(1024)
+    ->Arg(16384)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
@@ -0,0 +1,163 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <filesystem>  // NOLINT
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/codegen/vast/vast.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/module_initializer.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+#include "xls/simulation/simulators/compiled_simulation_cache.h"
+#include "xls/simulation/verilog_include.h"
+#include "xls/simulation/verilog_simulator.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+// Warnings which XLS-generated Verilog and testbenches routinely trigger and
+// which do not affect simulation.
+constexpr std::string_view kWarningArgs[] = {"-Wno-fatal", "-Wno-lint",
+                                             "-Wno-style"};
+
+// Invokes verilator with the given arguments. Verilator locates its runtime
+// sources and makefiles through VERILATOR_ROOT; unless set in the
+// environment, the copy in the runfiles next to the executable is used.
+absl::StatusOr<std::pair<std::string, std::string>> InvokeVerilator(
+    absl::Span<const std::string> args) {
+  XLS_ASSIGN_OR_RETURN(
+      std::filesystem::path verilator_path,
+      GetXlsRunfilePath("external/verilator/verilator_executable"));
+  std::string verilator_root = verilator_path.parent_path().string();
+  if (const char* root = std::getenv("VERILATOR_ROOT"); root != nullptr) {
+    verilator_root = root;
+  }
+  std::vector<std::string> args_vec = {
+      "/usr/bin/env", absl::StrCat("VERILATOR_ROOT=", verilator_root),
+      verilator_path.string()};
+  args_vec.insert(args_vec.end(), std::begin(kWarningArgs),
+                  std::end(kWarningArgs));
+  args_vec.insert(args_vec.end(), args.begin(), args.end());
+  return SubprocessResultToStrings(
+      SubprocessErrorAsStatus(InvokeSubprocess(args_vec)));
+}
+
+void AppendMacroDefinitionsToArgs(
+    absl::Span<const VerilogSimulator::MacroDefinition> macro_definitions,
+    std::vector<std::string>& args) {
+  args.push_back(
+      absl::StrFormat("-D%s", VerilogSimulator::kSimulationMacroName));
+  for (const VerilogSimulator::MacroDefinition& macro : macro_definitions) {
+    if (macro.value.has_value()) {
+      args.push_back(absl::StrFormat("-D%s=%s", macro.name, *macro.value));
+    } else {
+      args.push_back(absl::StrFormat("-D%s", macro.name));
+    }
+  }
+}
+
+// A cycle-based simulator which compiles the Verilog (including the
+// testbench) to a native executable with Verilator. Compilation is much
+// slower than iverilog's, but the resulting model runs orders of magnitude
+// faster on the synchronous designs XLS generates, and is cached so it is
+// only paid once per distinct Verilog text.
+//
+// Requires a host C++ compiler and make, which Verilator drives to build the
+// model.
+class VerilatorSimulator : public VerilogSimulator {
+ public:
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    std::string key = CompilationKey("verilator", text, file_type,
+                                     macro_definitions, includes);
+    std::shared_ptr<const CompiledSimulation> compiled =
+        CompiledSimulationCache::Get().Find(key);
+    if (compiled == nullptr) {
+      XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+      XLS_RETURN_IF_ERROR(RecursivelyCreateDir(temp_top.path()));
+      const std::filesystem::path& temp_dir = temp_top.path();
+
+      std::string top_v_path = temp_dir / GetTopFileName(file_type);
+      XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+      XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+      std::filesystem::path model_dir = temp_dir / "model";
+      std::vector<std::string> args = {
+          "--binary", "-j", "0", "--Mdir", model_dir.string(), "-o",
+          "simulation", "-I", temp_dir.string()};
+      AppendMacroDefinitionsToArgs(macro_definitions, args);
+      args.push_back(top_v_path);
+      XLS_RETURN_IF_ERROR(InvokeVerilator(args).status());
+
+      compiled = std::make_shared<const CompiledSimulation>(
+          CompiledSimulation{.directory = std::move(temp_top),
+                             .artifact = model_dir / "simulation"});
+      CompiledSimulationCache::Get().Insert(std::move(key), compiled);
+    } else {
+      VLOG(1) << "Reusing compiled model " << compiled->artifact;
+    }
+
+    return SubprocessResultToStrings(SubprocessErrorAsStatus(
+        InvokeSubprocess({compiled->artifact.string()})));
+  }
+
+  absl::Status RunSyntaxChecking(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(temp_top.path()));
+    const std::filesystem::path& temp_dir = temp_top.path();
+
+    std::string top_v_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+    std::vector<std::string> args = {"--lint-only", "-I", temp_dir.string()};
+    AppendMacroDefinitionsToArgs(macro_definitions, args);
+    args.push_back(top_v_path);
+    return InvokeVerilator(args).status();
+  }
+
+  bool DoesSupportSystemVerilog() const override { return true; }
+  bool DoesSupportAssertions() const override { return false; }
+};
+
+XLS_REGISTER_MODULE_INITIALIZER(verilator_simulator, {
+  CHECK_OK(GetVerilogSimulatorManagerSingleton().RegisterVerilogSimulator(
+      "verilator", std::make_unique<VerilatorSimulator>()));
+});
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
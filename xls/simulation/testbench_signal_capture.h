@@ -31,6 +31,11 @@
 namespace xls {
 namespace verilog {
 
+// Name of the testbench-internal stream to which signal captures are written
+// when the testbench captures to a file rather than the simulator output.
+inline constexpr std::string_view kSignalCaptureStreamName =
+    "xls_signal_captures";
+
 // Sentinel type for indicating an "X" value, in lieu of some real bits value.
 struct IsX {};
 
@@ -20,6 +20,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -30,6 +31,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/codegen/vast/vast.h"
 #include "xls/common/file/named_pipe.h"
 #include "xls/common/status/status_macros.h"
@@ -141,6 +143,19 @@ void VastStreamEmitter::EmitWrite(StatementBlock* block,
           block->file()->Make<QuotedString>(SourceInfo(), R"(\n)")});
 }
 
+void VastStreamEmitter::EmitFormattedWrite(
+    StatementBlock* block, std::string_view format,
+    absl::Span<Expression* const> args) const {
+  // Emit code:
+  //
+  //   $fwrite(fd, "<format>", <args>...);
+  std::vector<Expression*> fwrite_args = {
+      file_descriptor_,
+      block->file()->Make<QuotedString>(SourceInfo(), format)};
+  fwrite_args.insert(fwrite_args.end(), args.begin(), args.end());
+  block->Add<SystemTaskCall>(SourceInfo(), "fwrite", fwrite_args);
+}
+
 void VastStreamEmitter::EmitClose(StatementBlock* block) const {
   block->Add<SystemTaskCall>(SourceInfo(), "fclose",
                              std::vector<Expression*>{file_descriptor_});
@@ -20,11 +20,13 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/codegen/vast/vast.h"
 #include "xls/common/file/named_pipe.h"
 #include "xls/common/thread.h"
@@ -69,6 +71,11 @@ class VastStreamEmitter {
   // Emit code which writes `value` into the pipe.
   void EmitWrite(StatementBlock* block, Expression* value) const;
 
+  // Emit code which writes `args` into the file formatted according to the
+  // $fwrite format string `format`.
+  void EmitFormattedWrite(StatementBlock* block, std::string_view format,
+                          absl::Span<Expression* const> args) const;
+
  private:
   explicit VastStreamEmitter(const TestbenchStream& stream) : stream_(stream) {}
 
@@ -14,6 +14,7 @@
 
 #include "xls/simulation/verilog_simulator.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <utility>
@@ -23,6 +24,8 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "xls/codegen/name_to_bit_count.h"
 #include "xls/codegen/vast/vast.h"
 #include "xls/common/status/matchers.h"
@@ -159,6 +162,24 @@ endmodule
   EXPECT_THAT(out.first, ContainsRegex("MY_MACRO = +42\n"));
 }
 
+TEST_P(VerilogSimulatorTest, RepeatedRunsWithDifferentMacroValues) {
+  std::string text = R"(module tb;
+  initial begin
+    $display("MY_MACRO = %d", (`MY_MACRO));
+  end
+endmodule
+)";
+  for (int64_t value : {1, 2, 1}) {
+    std::pair<std::string, std::string> out;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        out, GetSimulator()->Run(text, GetFileType(),
+                                 {VerilogSimulator::MacroDefinition{
+                                     "MY_MACRO", absl::StrCat(value)}}));
+    EXPECT_THAT(out.first,
+                ContainsRegex(absl::StrFormat("MY_MACRO = +%d\n", value)));
+  }
+}
+
 TEST_P(VerilogSimulatorTest, MacroDefinitionTest) {
   std::string text = R"(module tb;
   initial begin
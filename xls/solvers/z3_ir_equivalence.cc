@@ -17,11 +17,17 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <random>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -30,7 +36,11 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/visitor.h"
+#include "xls/interpreter/compiled_function_interpreter.h"
+#include "xls/interpreter/observer.h"
+#include "xls/interpreter/random_value.h"
 #include "xls/ir/function.h"
+#include "xls/ir/events.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -42,14 +52,38 @@
 #include "xls/solvers/z3_ir_translator.h"
 
 namespace xls::solvers::z3 {
+namespace {
 
-absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
-                                                 absl::Duration timeout) {
-  std::unique_ptr<Package> to_test = std::make_unique<Package>(
+int64_t StructuralHash(Op op, absl::Span<Node* const> operands) {
+  std::vector<int64_t> values_to_hash = {static_cast<int64_t>(op)};
+  values_to_hash.reserve(operands.size() + 1);
+  for (Node* operand : operands) {
+    values_to_hash.push_back(operand->id());
+  }
+  return absl::HashOf(values_to_hash);
+}
+
+// A single function computing whether two functions agree: the first
+// function, with the nodes of the second patched in and a final comparison of
+// the two results as the return value.
+struct Miter {
+  std::unique_ptr<Package> package;
+  Function* function;
+  // Map from the nodes of the second function to their miter counterparts.
+  absl::flat_hash_map<Node*, Node*> node_map;
+  // The miter nodes which were cloned from the second function rather than
+  // shared with the first, in topological order.
+  std::vector<Node*> cloned_nodes;
+};
+
+absl::StatusOr<Miter> BuildMiter(Function* a, Function* b) {
+  Miter miter;
+  miter.package = std::make_unique<Package>(
       absl::StrFormat("%s_tester", a->package()->name()));
   XLS_ASSIGN_OR_RETURN(
-      Function * to_test_func,
-      a->Clone(absl::StrFormat("%s_test", a->name()), to_test.get()));
+      miter.function,
+      a->Clone(absl::StrFormat("%s_test", a->name()), miter.package.get()));
+  Function* to_test_func = miter.function;
 
   XLS_RET_CHECK(
       a->return_value()->GetType()->IsEqualTo(b->return_value()->GetType()))
@@ -60,11 +94,26 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
         a->params()[i]->GetType()->IsEqualTo(b->params()[i]->GetType()));
   }
 
+  // Bucket the nodes of the copy of `a` by op and operands so that nodes of b
+  // which compute exactly the same thing can be found below.
+  absl::flat_hash_map<int64_t, std::vector<Node*>> node_buckets;
+  for (Node* n : to_test_func->nodes()) {
+    if (!n->Is<Param>() && !OpIsSideEffecting(n->op())) {
+      node_buckets[StructuralHash(n->op(), n->operands())].push_back(n);
+    }
+  }
+
   // Patch b into to_test. Wire up parameters to those at the same index in the
   // to_test_function.  We do this so we can test whether the two functions are
   // semantically equivalent by making a single Z3-AST function and checking a
   // single eq node's value.
-  absl::flat_hash_map<Node*, Node*> node_map;
+  //
+  // Nodes of b which are structurally identical to a node of a (same op,
+  // attributes and already-shared operands) reuse that node rather than being
+  // cloned. A pass usually leaves most of a function untouched, so this keeps
+  // the unchanged subgraphs from being translated to Z3 twice and lets the
+  // solver see them as the same term.
+  absl::flat_hash_map<Node*, Node*>& node_map = miter.node_map;
   for (Node* n : TopoSort(b)) {
     if (n->Is<Param>()) {
       XLS_ASSIGN_OR_RETURN(int64_t index, b->GetParamIndex(n->As<Param>()));
@@ -76,22 +125,179 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
     for (Node* op : n->operands()) {
       new_ops.push_back(node_map[op]);
     }
+    Node* shared = nullptr;
+    if (!OpIsSideEffecting(n->op())) {
+      auto bucket = node_buckets.find(StructuralHash(n->op(), new_ops));
+      if (bucket != node_buckets.end()) {
+        for (Node* candidate : bucket->second) {
+          if (absl::c_equal(candidate->operands(), new_ops) &&
+              n->IsDefinitelyEqualTo(candidate)) {
+            shared = candidate;
+            break;
+          }
+        }
+      }
+    }
+    if (shared != nullptr) {
+      node_map[n] = shared;
+      continue;
+    }
     XLS_ASSIGN_OR_RETURN(node_map[n],
                          n->CloneInNewFunction(new_ops, to_test_func));
+    miter.cloned_nodes.push_back(node_map[n]);
   }
+  VLOG(2) << absl::StreamFormat(
+      "Equivalence of %s and %s: %d of %d nodes shared", a->name(), b->name(),
+      b->node_count() - b->params().size() - miter.cloned_nodes.size(),
+      b->node_count());
 
   // Add check
-
   Node* original_result = to_test_func->return_value();
   Node* transformed_result = node_map[b->return_value()];
   Node* new_ret = to_test_func->AddNode(std::make_unique<CompareOp>(
       SourceInfo(), original_result, transformed_result, Op::kEq, "TestCheck",
       to_test_func));
   XLS_RETURN_IF_ERROR(to_test_func->set_return_value(new_ret));
-  // Run prover
+  return miter;
+}
+
+// Folds every value a node takes during simulation into a signature. Nodes
+// with different signatures are certainly not equivalent.
+class SignatureObserver : public EvaluationObserver {
+ public:
+  void NodeEvaluated(Node* n, const Value& v) override {
+    uint64_t& signature = signatures_[n];
+    signature = absl::HashOf(signature, v);
+  }
+
+  const absl::flat_hash_map<Node*, uint64_t>& signatures() const {
+    return signatures_;
+  }
+
+ private:
+  absl::flat_hash_map<Node*, uint64_t> signatures_;
+};
+
+// Evaluates the miter on random inputs. Returns a counterexample (in terms of
+// the miter's params) if the two sides disagree on any of them.
+absl::StatusOr<std::optional<std::vector<Value>>> SimulateMiter(
+    const Miter& miter, const EquivalenceCheckOptions& options,
+    SignatureObserver& observer) {
   XLS_ASSIGN_OR_RETURN(
-      ProverResult base_result,
-      TryProve(to_test_func, new_ret, Predicate::NotEqualToZero(), timeout));
+      std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+      CompiledFunctionInterpreter::Create(miter.function));
+  std::mt19937_64 rng(options.seed);
+  for (int64_t i = 0; i < options.simulation_samples; ++i) {
+    std::vector<Value> args = RandomFunctionArguments(miter.function, rng);
+    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
+                         interpreter->Run(args, &observer));
+    if (result.value.bits().IsZero()) {
+      VLOG(1) << "Random simulation found a counterexample after " << i + 1
+              << " samples";
+      return args;
+    }
+  }
+  return std::nullopt;
+}
+
+// Proves and merges internal equivalences of the miter: a node cloned from
+// the second function whose simulation signature matches a node of the first
+// is proved equal to it with a short solver query and then replaced by it.
+// Merging in topological order means later queries see the already-merged
+// fan-in as shared terms, and the final query only has to reason about what
+// genuinely differs.
+absl::Status MergeCutPoints(Miter& miter,
+                            const EquivalenceCheckOptions& options,
+                            const SignatureObserver& observer) {
+  absl::flat_hash_set<Node*> cloned(miter.cloned_nodes.begin(),
+                                    miter.cloned_nodes.end());
+  absl::flat_hash_map<uint64_t, std::vector<Node*>> candidates;
+  for (Node* n : TopoSort(miter.function)) {
+    if (!cloned.contains(n) && !n->Is<Param>() && n->op() != Op::kLiteral &&
+        n != miter.function->return_value() &&
+        observer.signatures().contains(n)) {
+      candidates[observer.signatures().at(n)].push_back(n);
+    }
+  }
+
+  int64_t attempts = 0;
+  int64_t merged = 0;
+  for (Node* n : miter.cloned_nodes) {
+    if (attempts >= options.max_cut_points) {
+      break;
+    }
+    if (OpIsSideEffecting(n->op()) || !observer.signatures().contains(n)) {
+      continue;
+    }
+    auto it = candidates.find(observer.signatures().at(n));
+    if (it == candidates.end()) {
+      continue;
+    }
+    Node* equivalent = nullptr;
+    for (Node* candidate : it->second) {
+      if (candidate->GetType()->IsEqualTo(n->GetType())) {
+        equivalent = candidate;
+        break;
+      }
+    }
+    if (equivalent == nullptr) {
+      continue;
+    }
+    ++attempts;
+    absl::StatusOr<ProverResult> proof =
+        TryProve(miter.function, n, Predicate::IsEqualTo(equivalent),
+                 options.cut_point_timeout);
+    if (!proof.ok() || !std::holds_alternative<ProvenTrue>(*proof)) {
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(n->ReplaceUsesWith(equivalent));
+    ++merged;
+  }
+
+  // Drop the nodes which are no longer used so they are not translated.
+  std::vector<Node*> nodes = TopoSort(miter.function);
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+    Node* n = *it;
+    if (n->users().empty() && !n->Is<Param>() &&
+        n != miter.function->return_value() && !OpIsSideEffecting(n->op())) {
+      XLS_RETURN_IF_ERROR(miter.function->RemoveNode(n));
+    }
+  }
+  VLOG(1) << absl::StreamFormat("Merged %d of %d cut point candidates", merged,
+                                attempts);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<ProverResult> TryProveEquivalence(
+    Function* a, Function* b, const EquivalenceCheckOptions& options) {
+  XLS_ASSIGN_OR_RETURN(Miter miter, BuildMiter(a, b));
+  Function* to_test_func = miter.function;
+  absl::flat_hash_map<Node*, Node*>& node_map = miter.node_map;
+
+  if (options.simulation_samples > 0) {
+    SignatureObserver observer;
+    XLS_ASSIGN_OR_RETURN(std::optional<std::vector<Value>> counterexample,
+                         SimulateMiter(miter, options, observer));
+    if (counterexample.has_value()) {
+      absl::flat_hash_map<const Param*, Value> mapped_counterexample;
+      for (int64_t i = 0; i < a->params().size(); ++i) {
+        mapped_counterexample[a->param(i)] = (*counterexample)[i];
+      }
+      return ProvenFalse{
+          .counterexample = std::move(mapped_counterexample),
+          .message = "Counterexample found by random simulation"};
+    }
+    if (options.max_cut_points > 0) {
+      XLS_RETURN_IF_ERROR(MergeCutPoints(miter, options, observer));
+    }
+  }
+
+  // Run prover
+  XLS_ASSIGN_OR_RETURN(ProverResult base_result,
+                       TryProve(to_test_func, to_test_func->return_value(),
+                                Predicate::NotEqualToZero(), options.timeout));
   // remap parameters back tot he originals.
   return std::visit(
       Visitor{
@@ -120,6 +326,14 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
       std::move(base_result));
 }
 
+absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
+                                                 absl::Duration timeout) {
+  return TryProveEquivalence(
+      a, b,
+      EquivalenceCheckOptions{
+          .timeout = timeout, .simulation_samples = 0, .max_cut_points = 0});
+}
+
 absl::StatusOr<ProverResult> TryProveEquivalence(
     Function* original,
     const std::function<absl::Status(Package*, Function*)>& run_pass,
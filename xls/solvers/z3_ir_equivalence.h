@@ -15,6 +15,7 @@
 #ifndef XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 #define XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 
+#include <cstdint>
 #include <functional>
 
 #include "absl/status/status.h"
@@ -50,6 +51,33 @@ absl::StatusOr<ProverResult> TryProveEquivalence(
     Function* a, Function* b,
     absl::Duration timeout = absl::InfiniteDuration());
 
+struct EquivalenceCheckOptions {
+  // How long to wait for the final proof to complete.
+  absl::Duration timeout = absl::InfiniteDuration();
+
+  // Number of random input vectors to simulate before invoking the solver.
+  // Most inequivalent functions disagree on some random input, in which case
+  // the simulated counterexample is returned without a proof. Zero disables
+  // simulation (and with it cut-point merging).
+  int64_t simulation_samples = 256;
+
+  // Seed for the random inputs.
+  uint64_t seed = 0;
+
+  // Maximum number of internal equivalence candidates to try to prove. Nodes
+  // of the two functions with identical simulation signatures are proved
+  // equal one at a time, each with `cut_point_timeout`, and merged before the
+  // final proof, which then only covers the logic that actually differs.
+  int64_t max_cut_points = 256;
+  absl::Duration cut_point_timeout = absl::Seconds(1);
+};
+
+// As above, but first tries to find a counterexample by random simulation and
+// to merge simulation-identified internal equivalences before falling back to
+// the solver.
+absl::StatusOr<ProverResult> TryProveEquivalence(
+    Function* a, Function* b, const EquivalenceCheckOptions& options);
+
 }  // namespace xls::solvers::z3
 
 #endif  // XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
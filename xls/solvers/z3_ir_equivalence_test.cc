@@ -17,6 +17,8 @@
 #include <cstdint>
 #include <memory>
 #include <string_view>
+#include <variant>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest-spi.h"
@@ -25,9 +27,12 @@
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
@@ -35,6 +40,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
 #include "xls/solvers/z3_ir_equivalence_testutils.h"
@@ -49,6 +55,7 @@ using ::absl_testing::IsOk;
 using ::absl_testing::IsOkAndHolds;
 
 using ::testing::AnyOf;
+using ::testing::HasSubstr;
 using ::testing::Not;
 using ::testing::Pair;
 using ::testing::UnorderedElementsAre;
@@ -390,5 +397,105 @@ TEST_F(EquivalenceTest, MultiFunctionDetectsDifference) {
   EXPECT_THAT(TryProveEquivalence(f1, f2), IsOkAndHolds(IsProvenFalse()));
 }
 
+TEST_F(EquivalenceTest, UnchangedStructureIsShared) {
+  // A deep multiplier chain which is left untouched by the transform is
+  // shared between both sides, so only the commuted add needs proving.
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(64));
+  BValue y = fb.Param("y", p->GetBitsType(64));
+  BValue chain = x;
+  for (int64_t i = 0; i < 8; ++i) {
+    chain = fb.UMul(chain, y);
+  }
+  fb.Tuple({chain, fb.Add(x, y, SourceInfo(), "sum")});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  EXPECT_THAT(TryProveEquivalence(
+                  f,
+                  [](Package* p, Function* f) -> absl::Status {
+                    XLS_ASSIGN_OR_RETURN(Node * sum, f->GetNode("sum"));
+                    sum->SwapOperands(0, 1);
+                    return absl::OkStatus();
+                  },
+                  absl::Seconds(30)),
+              IsOkAndHolds(IsProvenTrue()));
+}
+
+TEST_F(EquivalenceTest, DifferentLiteralsAreNotShared) {
+  std::unique_ptr<Package> p1 = CreatePackage();
+  FunctionBuilder fb1(TestName(), p1.get());
+  fb1.UMul(fb1.Param("x", p1->GetBitsType(32)), fb1.Literal(UBits(3, 32)));
+
+  std::unique_ptr<Package> p2 = CreatePackage();
+  FunctionBuilder fb2(TestName(), p2.get());
+  fb2.UMul(fb2.Param("x", p2->GetBitsType(32)), fb2.Literal(UBits(5, 32)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, fb1.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, fb2.Build());
+
+  EXPECT_THAT(TryProveEquivalence(f1, f2), IsOkAndHolds(IsProvenFalse()));
+}
+
+TEST_F(EquivalenceTest, SimulationFindsCounterexample) {
+  std::unique_ptr<Package> p1 = CreatePackage();
+  FunctionBuilder fb1(TestName(), p1.get());
+  fb1.UMul(fb1.Param("x", p1->GetBitsType(64)),
+           fb1.Param("y", p1->GetBitsType(64)));
+
+  std::unique_ptr<Package> p2 = CreatePackage();
+  FunctionBuilder fb2(TestName(), p2.get());
+  BValue x = fb2.Param("x", p2->GetBitsType(64));
+  fb2.UMul(fb2.Add(x, fb2.Literal(UBits(1, 64))),
+           fb2.Param("y", p2->GetBitsType(64)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, fb1.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, fb2.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProverResult result,
+      TryProveEquivalence(f1, f2, EquivalenceCheckOptions{}));
+  ASSERT_THAT(result, IsProvenFalse());
+  const ProvenFalse& proven_false = std::get<ProvenFalse>(result);
+  EXPECT_THAT(proven_false.message, HasSubstr("random simulation"));
+  XLS_ASSERT_OK(proven_false.counterexample.status());
+
+  // The counterexample refers to the params of the first function and
+  // actually distinguishes the two.
+  std::vector<Value> args = {proven_false.counterexample->at(f1->param(0)),
+                             proven_false.counterexample->at(f1->param(1))};
+  XLS_ASSERT_OK_AND_ASSIGN(Value r1,
+                           DropInterpreterEvents(InterpretFunction(f1, args)));
+  XLS_ASSERT_OK_AND_ASSIGN(Value r2,
+                           DropInterpreterEvents(InterpretFunction(f2, args)));
+  EXPECT_NE(r1, r2);
+}
+
+TEST_F(EquivalenceTest, CutPointsMergeRestructuredLogic) {
+  // Both sides compute the same wide products with differently ordered
+  // operands, which structural sharing can't see; the cut points found by
+  // simulation let the final proof treat them as the same term.
+  std::unique_ptr<Package> p1 = CreatePackage();
+  FunctionBuilder fb1(TestName(), p1.get());
+  BValue x1 = fb1.Param("x", p1->GetBitsType(64));
+  BValue y1 = fb1.Param("y", p1->GetBitsType(64));
+  BValue product1 = fb1.UMul(x1, y1);
+  fb1.Tuple({fb1.UMul(product1, product1), fb1.Add(product1, x1)});
+
+  std::unique_ptr<Package> p2 = CreatePackage();
+  FunctionBuilder fb2(TestName(), p2.get());
+  BValue x2 = fb2.Param("x", p2->GetBitsType(64));
+  BValue y2 = fb2.Param("y", p2->GetBitsType(64));
+  BValue product2 = fb2.UMul(y2, x2);
+  fb2.Tuple({fb2.UMul(product2, product2), fb2.Add(x2, product2)});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, fb1.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, fb2.Build());
+
+  EXPECT_THAT(
+      TryProveEquivalence(f1, f2,
+                          EquivalenceCheckOptions{.timeout = absl::Seconds(60)}),
+      IsOkAndHolds(IsProvenTrue()));
+}
+
 }  // namespace
 }  // namespace xls::solvers::z3
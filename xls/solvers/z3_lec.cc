@@ -15,6 +15,7 @@
 #include "xls/solvers/z3_lec.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <iostream>
@@ -33,10 +34,14 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/codegen/vast/vast.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/format_preference.h"
@@ -515,6 +520,56 @@ std::string Lec::NodeToNetlistName(const Node* node,
   return name;
 }
 
+absl::StatusOr<std::vector<StageLecResult>> RunStagedLec(
+    const LecParams& params, const PipelineSchedule& schedule,
+    int64_t max_threads) {
+  std::vector<absl::StatusOr<StageLecResult>> results(
+      schedule.length(), absl::UnknownError("stage not checked"));
+  std::atomic<int64_t> next_stage = 0;
+  auto worker = [&]() {
+    for (int64_t stage = next_stage.fetch_add(1); stage < schedule.length();
+         stage = next_stage.fetch_add(1)) {
+      absl::Time start = absl::Now();
+      absl::StatusOr<std::unique_ptr<Lec>> lec =
+          Lec::CreateForStage(params, schedule, stage);
+      if (!lec.ok()) {
+        results[stage] = lec.status();
+        continue;
+      }
+      bool equivalent = (*lec)->Run();
+      results[stage] = StageLecResult{
+          .stage = static_cast<int>(stage),
+          .equivalent = equivalent,
+          .duration = absl::Now() - start,
+          .result = (*lec)->ResultToString(),
+      };
+      VLOG(1) << absl::StreamFormat(
+          "Stage %d: %s in %s", stage,
+          equivalent ? "equivalent" : "NOT equivalent",
+          absl::FormatDuration(results[stage]->duration));
+    }
+  };
+  int64_t thread_count =
+      std::clamp<int64_t>(max_threads > 0 ? max_threads : AvailableCPUs(), 1,
+                          std::max<int64_t>(schedule.length(), 1));
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  std::vector<StageLecResult> stage_results;
+  stage_results.reserve(results.size());
+  for (absl::StatusOr<StageLecResult>& result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+    stage_results.push_back(*std::move(result));
+  }
+  return stage_results;
+}
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
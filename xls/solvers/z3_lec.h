@@ -15,6 +15,7 @@
 #ifndef XLS_SOLVERS_Z3_LEC_H_
 #define XLS_SOLVERS_Z3_LEC_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -24,6 +25,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
 #include "xls/netlist/netlist.h"
@@ -170,6 +172,24 @@ class Lec {
   std::optional<Z3_model> model_;
 };
 
+// The result of checking a single pipeline stage.
+struct StageLecResult {
+  int stage;
+  // Whether the netlist and IR were proved equivalent for this stage.
+  bool equivalent;
+  // Wall time spent creating and running the check.
+  absl::Duration duration;
+  // A textual description of the result, as given by Lec::ResultToString.
+  std::string result;
+};
+
+// Checks every stage of `schedule` independently, up to `max_threads` stages
+// at a time (or one per available CPU if zero), each in its own Z3 context.
+// Returns the results ordered by stage.
+absl::StatusOr<std::vector<StageLecResult>> RunStagedLec(
+    const LecParams& params, const PipelineSchedule& schedule,
+    int64_t max_threads = 0);
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/log/log.h"
@@ -265,6 +266,15 @@ endmodule
     ASSERT_TRUE(lec->Run());
     LOG(INFO) << "Pass stage " << i;
   }
+
+  // The same checks, run concurrently.
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<StageLecResult> results,
+                           RunStagedLec(params, schedule, /*max_threads=*/3));
+  ASSERT_EQ(results.size(), schedule.length());
+  for (int i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].stage, i);
+    EXPECT_TRUE(results[i].equivalent) << results[i].result;
+  }
 }
 
 // This test verifies that a non-matching set of inputs "correctly" fails. This
@@ -24,7 +24,7 @@ import multiprocessing.pool as mp_pool
 import os
 import sys
 import textwrap
-from typing import Any, Dict
+from typing import Any, Dict, Optional
 
 from absl import flags
 from absl import logging
@@ -68,6 +68,33 @@ _MAX_THREADS = flags.DEFINE_integer(
     max(os.cpu_count() // 2, 1),
     'Max number of threads for parallelizing the generation of data points.',
 )
+_TARGET = flags.DEFINE_string(
+    'target',
+    '',
+    'Name of the synthesis target (e.g. the PDK) of the synthesis server.'
+    ' Recorded in the checkpoint so that checkpointed results are only reused'
+    ' for the same target and delay search range.',
+)
+
+# Prefix of the comment line recording the checkpoint context.
+_CHECKPOINT_CONTEXT_PREFIX = '# checkpoint_context: '
+
+
+def checkpoint_context() -> str:
+  """Returns the synthesis setup which checkpointed results depend on."""
+  return f'target={_TARGET.value} min_ps={_MIN_PS.value} max_ps={_MAX_PS.value}'
+
+
+def init_checkpoint(checkpoint_path: str, context: str) -> None:
+  """Records `context` at the start of a new or empty checkpoint file."""
+  if not checkpoint_path:
+    return
+  if gfile.exists(checkpoint_path):
+    with gfile.open(checkpoint_path, 'r') as f:
+      if f.read().strip():
+        return
+  with gfile.open(checkpoint_path, 'w') as f:
+    f.write(f'{_CHECKPOINT_CONTEXT_PREFIX}{context}\n')
 
 
 def get_op_name_mapping() -> Dict[str, str]:
@@ -307,12 +334,36 @@ def _run_point(
   return result_dp
 
 
-def load_checkpoints(checkpoint_path: str) -> estimator_model_pb2.DataPoints:
-  """Loads data from a checkpoint, if available."""
+def load_checkpoints(
+    checkpoint_path: str, context: Optional[str] = None
+) -> estimator_model_pb2.DataPoints:
+  """Loads data from a checkpoint, if available.
+
+  Args:
+    checkpoint_path: Path of the checkpoint file.
+    context: If given, the checkpoint must have been recorded for this context
+      (see checkpoint_context). Checkpoints which record no context are
+      accepted.
+
+  Returns:
+    The checkpointed data points.
+
+  Raises:
+    ValueError: The checkpoint was recorded for a different context.
+  """
   results = estimator_model_pb2.DataPoints()
   if checkpoint_path:
     with gfile.open(checkpoint_path, 'r') as f:
       contents = f.read()
+      if context is not None:
+        for line in contents.splitlines():
+          if line.startswith(_CHECKPOINT_CONTEXT_PREFIX):
+            recorded = line[len(_CHECKPOINT_CONTEXT_PREFIX) :].strip()
+            if recorded != context:
+              raise ValueError(
+                  f'Checkpoint {checkpoint_path} was recorded for'
+                  f' `{recorded}` but the current context is `{context}`.'
+              )
       results = text_format.Parse(contents, results)
       logging.info(
           'Loaded %d prior checkpointed results from %s of size %d bytes.',
@@ -328,7 +379,9 @@ def run_characterization(
 ) -> None:
   """Run characterization with the given synthesis service."""
   op_name_mapping = get_op_name_mapping()
-  checkpointed_results = load_checkpoints(_CHECKPOINT_PATH.value)
+  context = checkpoint_context()
+  checkpointed_results = load_checkpoints(_CHECKPOINT_PATH.value, context)
+  init_checkpoint(_CHECKPOINT_PATH.value, context)
   checkpoint_dict = estimator_model_utils.map_data_points_by_key(
       checkpointed_results.data_points
   )
@@ -349,7 +402,14 @@ def run_characterization(
         all_sample_spec_keys_in_order.append(spec_key)
         if spec_key not in checkpoint_dict:
           sample_specs_without_prior_checkpoints.append(spec)
-  logging.debug('Using thread pool of size %d', _MAX_THREADS.value)
+  logging.info(
+      '%d of %d sample points are checkpointed; synthesizing the rest with %d'
+      ' threads.',
+      len(all_sample_spec_keys_in_order)
+      - len(sample_specs_without_prior_checkpoints),
+      len(all_sample_spec_keys_in_order),
+      _MAX_THREADS.value,
+  )
   pool = mp_pool.ThreadPool(_MAX_THREADS.value)
   checkpoint_write_lock = mp.Lock()
   results_dict = estimator_model_utils.map_data_points_by_key(
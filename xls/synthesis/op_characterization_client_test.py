@@ -66,5 +66,27 @@ class OpCharacterizationClientMainTest(absltest.TestCase):
     self.assertEqual(saved_results_dict, loaded_results_dict)
 
 
+  def test_checkpoint_context(self):
+    tf = tempfile.NamedTemporaryFile()
+    lock = mp.Lock()
+    client.init_checkpoint(tf.name, "target=asap7 min_ps=100 max_ps=10000")
+    result = estimator_model_pb2.DataPoint()
+    result.operation.op = "op_a"
+    result.operation.bit_count = 8
+    result.delay = 5
+    client.save_checkpoint(result, tf.name, lock)
+
+    # Initializing an existing checkpoint leaves it unchanged.
+    client.init_checkpoint(tf.name, "target=sky130 min_ps=100 max_ps=10000")
+    loaded_results = client.load_checkpoints(
+        tf.name, "target=asap7 min_ps=100 max_ps=10000"
+    )
+    self.assertLen(loaded_results.data_points, 1)
+    self.assertEqual(loaded_results.data_points[0], result)
+    with self.assertRaisesRegex(ValueError, "recorded for"):
+      client.load_checkpoints(tf.name, "target=sky130 min_ps=100 max_ps=10000")
+    # Without a context any checkpoint is accepted.
+    self.assertLen(client.load_checkpoints(tf.name).data_points, 1)
+
 if __name__ == "__main__":
   absltest.main()
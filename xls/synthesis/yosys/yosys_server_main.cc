@@ -29,6 +29,7 @@
 #include "grpcpp/server_context.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/thread.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/yosys/yosys_synthesis_service.h"
 
@@ -66,6 +67,18 @@ ABSL_FLAG(std::string, default_driver_cell, "",
           "The default driver cell to use during synthesis.");
 ABSL_FLAG(std::string, default_load, "",
           "The default load cell to use during synthesis.");
+ABSL_FLAG(int64_t, max_concurrent_jobs, xls::AvailableCPUs(),
+          "Maximum number of requests synthesized at once.");
+ABSL_FLAG(int64_t, max_queued_jobs, 1024,
+          "Maximum number of requests waiting for a job slot; further "
+          "requests are rejected with RESOURCE_EXHAUSTED.");
+ABSL_FLAG(int64_t, result_cache_size, 1024,
+          "Maximum number of synthesis results cached in memory; 0 disables "
+          "the cache.");
+ABSL_FLAG(std::string, working_directory_root, "",
+          "Directory in which per-request working directories are created, "
+          "e.g. a tmpfs mount such as /dev/shm. Defaults to the system "
+          "temporary directory.");
 
 namespace xls {
 namespace synthesis {
@@ -107,13 +120,27 @@ void RealMain() {
     }
   }
 
+  YosysJobPoolOptions job_pool_options;
+  job_pool_options.max_concurrent_jobs =
+      absl::GetFlag(FLAGS_max_concurrent_jobs);
+  job_pool_options.max_queued_jobs = absl::GetFlag(FLAGS_max_queued_jobs);
+  job_pool_options.result_cache_size = absl::GetFlag(FLAGS_result_cache_size);
+  job_pool_options.working_directory_root =
+      absl::GetFlag(FLAGS_working_directory_root);
+  QCHECK_GT(job_pool_options.max_concurrent_jobs, 0)
+      << "--max_concurrent_jobs must be positive";
+  if (!job_pool_options.working_directory_root.empty()) {
+    QCHECK_OK(FileExists(job_pool_options.working_directory_root))
+        << "Valid --working_directory_root must be provided";
+  }
+
   int port = absl::GetFlag(FLAGS_port);
   std::string server_address = absl::StrCat("0.0.0.0:", port);
   YosysSynthesisServiceImpl service(
       yosys_path, nextpnr_path, synthesis_target, sta_path, synthesis_libraries,
       sta_libraries, absl::GetFlag(FLAGS_default_driver_cell),
       absl::GetFlag(FLAGS_default_load), absl::GetFlag(FLAGS_save_temps),
-      absl::GetFlag(FLAGS_return_netlist), synthesis_only);
+      absl::GetFlag(FLAGS_return_netlist), synthesis_only, job_pool_options);
 
   ::grpc::ServerBuilder builder;
   std::shared_ptr<::grpc::ServerCredentials> creds = GetServerCredentials();
@@ -14,6 +14,7 @@
 # limitations under the License.
 """Tests of the synthesis service: client and dummy server."""
 
+import os
 import subprocess
 import time
 
@@ -131,6 +132,44 @@ class SynthesisServerTest(absltest.TestCase):
     proc.terminate()
     proc.wait()
 
+  def test_concurrent_repeated_requests(self):
+    port = portpicker.pick_unused_port()
+    working_dir_root = self.create_tempdir()
+    proc = subprocess.Popen([
+        runfiles.get_path(SERVER_PATH),
+        f'--port={port}',
+        f'--yosys_path={YOSYS_PATH}',
+        f'--nextpnr_path={NEXTPNR_PATH}',
+        '--synthesis_target=ecp5',
+        '--max_concurrent_jobs=2',
+        f'--working_directory_root={working_dir_root.full_path}',
+    ])
+    time.sleep(2.0)
+    self.assertIsNone(proc.poll(), msg='Synth server has died.')
+
+    verilog_file = self.create_tempfile(content=VERILOG)
+    clients = [
+        subprocess.Popen(
+            [CLIENT_PATH, verilog_file.full_path, f'--port={port}',
+             '--ghz=1.0'],
+            stdout=subprocess.PIPE,
+        )
+        for _ in range(8)
+    ]
+    for client in clients:
+      response_text, _ = client.communicate()
+      self.assertEqual(client.returncode, 0)
+      response = text_format.Parse(
+          response_text.decode('utf-8'), synthesis_pb2.CompileResponse()
+      )
+      self.assertEqual(response.max_frequency_hz, 180280000)
+
+    # Per-request working directories are removed once synthesis is done.
+    self.assertEmpty(os.listdir(working_dir_root.full_path))
+
+    proc.terminate()
+    proc.wait()
+
 
 if __name__ == '__main__':
   absltest.main()
@@ -14,6 +14,7 @@
 
 #include "xls/synthesis/yosys/yosys_synthesis_service.h"
 
+#include <array>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <optional>
@@ -25,15 +26,18 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "grpcpp/server.h"
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/status.h"
+#include "openssl/sha.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/status/ret_check.h"
@@ -50,18 +54,122 @@ namespace synthesis {
     CompileResponse* result) {
   auto start = absl::Now();
 
-  absl::Status synthesis_status = RunSynthesis(request, result);
-  if (!synthesis_status.ok()) {
-    return ::grpc::Status(grpc::StatusCode::INTERNAL,
-                          std::string(synthesis_status.message()));
+  absl::StatusOr<CompileResponse> response;
+  if (job_pool_options_.result_cache_size <= 0) {
+    response = RunSynthesisInPool(request);
+  } else {
+    std::string key = ResultCacheKey(request);
+    CachedResult* entry;
+    bool cached = false;
+    {
+      absl::MutexLock lock(&cache_mutex_);
+      auto [it, inserted] = result_cache_.try_emplace(key);
+      entry = &it->second;
+      if (inserted) {
+        cache_order_.push_back(key);
+      } else {
+        // Another request may be synthesizing the same design right now.
+        ++entry->waiters;
+        cache_mutex_.Await(absl::Condition(&entry->done));
+        --entry->waiters;
+        if (entry->response.ok()) {
+          ++cache_hits_;
+          response = entry->response;
+          cached = true;
+        } else {
+          // Failures are not cached; retry the synthesis.
+          entry->done = false;
+        }
+      }
+    }
+    if (!cached) {
+      response = RunSynthesisInPool(request);
+      absl::MutexLock lock(&cache_mutex_);
+      entry->response = response;
+      entry->done = true;
+      EvictCacheEntries();
+    }
   }
 
+  if (!response.ok()) {
+    grpc::StatusCode code =
+        absl::IsResourceExhausted(response.status())
+            ? grpc::StatusCode::RESOURCE_EXHAUSTED
+            : grpc::StatusCode::INTERNAL;
+    return ::grpc::Status(code, std::string(response.status().message()));
+  }
+  *result = *std::move(response);
+
   result->set_elapsed_runtime_ms(
       absl::ToInt64Milliseconds(absl::Now() - start));
 
   return ::grpc::Status::OK;
 }
 
+std::string YosysSynthesisServiceImpl::ResultCacheKey(
+    const CompileRequest* request) const {
+  // The server configuration is fixed for its lifetime but is hashed anyway so
+  // keys stay meaningful if the cache is ever shared between servers.
+  std::string text = absl::StrFormat(
+      "top=%s\nfreq=%d\ntarget=%s\nsynth_lib=%s\nsta_lib=%s\n%s",
+      request->top_module_name(), request->target_frequency_hz(),
+      synthesis_target_, synthesis_libraries_, sta_libraries_,
+      request->module_text());
+  std::array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(text.data()), text.size(),
+         digest.data());
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest.data()), digest.size()));
+}
+
+absl::StatusOr<CompileResponse> YosysSynthesisServiceImpl::RunSynthesisInPool(
+    const CompileRequest* request) {
+  XLS_RETURN_IF_ERROR(AcquireJobSlot());
+  CompileResponse response;
+  absl::Status status = RunSynthesis(request, &response);
+  ReleaseJobSlot();
+  XLS_RETURN_IF_ERROR(status);
+  return response;
+}
+
+absl::Status YosysSynthesisServiceImpl::AcquireJobSlot() {
+  absl::MutexLock lock(&pool_mutex_);
+  if (!HasFreeJobSlot() &&
+      queued_jobs_ >= job_pool_options_.max_queued_jobs) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "Synthesis job queue is full (%d running, %d queued).", running_jobs_,
+        queued_jobs_));
+  }
+  ++queued_jobs_;
+  pool_mutex_.Await(
+      absl::Condition(this, &YosysSynthesisServiceImpl::HasFreeJobSlot));
+  --queued_jobs_;
+  ++running_jobs_;
+  return absl::OkStatus();
+}
+
+void YosysSynthesisServiceImpl::ReleaseJobSlot() {
+  absl::MutexLock lock(&pool_mutex_);
+  --running_jobs_;
+}
+
+void YosysSynthesisServiceImpl::EvictCacheEntries() {
+  while (static_cast<int64_t>(result_cache_.size()) >
+             job_pool_options_.result_cache_size &&
+         !cache_order_.empty()) {
+    auto it = result_cache_.find(cache_order_.front());
+    if (it != result_cache_.end() &&
+        (!it->second.done || it->second.waiters > 0)) {
+      // The oldest entry is still in use; evict it later.
+      break;
+    }
+    if (it != result_cache_.end()) {
+      result_cache_.erase(it);
+    }
+    cache_order_.pop_front();
+  }
+}
+
 // Run the given arguments as a subprocess with InvokeSubprocess.
 // InvokeSubprocess is wrapped because the error message can be very large (it
 // includes both stdout and stderr) which breaks propagation of the error via
@@ -205,7 +313,12 @@ absl::Status YosysSynthesisServiceImpl::RunSynthesis(
     return absl::InvalidArgumentError("Must specify top module name.");
   }
 
-  XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSIGN_OR_RETURN(
+      TempDirectory temp_dir,
+      job_pool_options_.working_directory_root.empty()
+          ? TempDirectory::Create()
+          : TempDirectory::CreateInDirectory(
+                job_pool_options_.working_directory_root));
   const std::filesystem::path temp_dir_path = temp_dir.path();
   if (save_temps_) {
     std::move(temp_dir).Release();
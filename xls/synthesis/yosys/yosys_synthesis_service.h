@@ -15,23 +15,45 @@
 #ifndef XLS_SYNTHESIS_YOSYS_YOSYS_SYNTHESIS_SERVICE_H_
 #define XLS_SYNTHESIS_YOSYS_YOSYS_SYNTHESIS_SERVICE_H_
 
+#include <cstdint>
+#include <deque>
 #include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "grpcpp/server.h"
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/status.h"
+#include "xls/common/thread.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
 
 namespace xls {
 namespace synthesis {
 
+// Limits on the synthesis work done by `YosysSynthesisServiceImpl::Compile`.
+struct YosysJobPoolOptions {
+  // Maximum number of requests synthesized at once.
+  int64_t max_concurrent_jobs = AvailableCPUs();
+  // Maximum number of requests waiting for a free job slot. Requests arriving
+  // while the queue is full are rejected with RESOURCE_EXHAUSTED so clients
+  // can back off instead of piling up on the server.
+  int64_t max_queued_jobs = 1024;
+  // Maximum number of responses kept in the result cache; zero disables
+  // caching.
+  int64_t result_cache_size = 1024;
+  // Directory in which the per-request working directories are created, e.g.
+  // a tmpfs mount such as /dev/shm. Empty uses the system temp directory.
+  std::string working_directory_root;
+};
+
 class YosysSynthesisServiceImpl : public SynthesisService::Service {
  public:
   explicit YosysSynthesisServiceImpl(
@@ -39,7 +61,8 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
       std::string_view synthesis_target, std::string_view sta_path,
       std::string_view synthesis_libraries, std::string_view sta_libraries,
       std::string_view default_driver_cell, std::string_view default_load,
-      bool save_temps, bool return_netlist, bool synthesis_only)
+      bool save_temps, bool return_netlist, bool synthesis_only,
+      const YosysJobPoolOptions& job_pool_options = YosysJobPoolOptions())
       : yosys_path_(yosys_path),
         nextpnr_path_(nextpnr_path),
         synthesis_target_(synthesis_target),
@@ -50,12 +73,21 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
         default_load_(default_load),
         save_temps_(save_temps),
         return_netlist_(return_netlist),
-        synthesis_only_(synthesis_only) {}
+        synthesis_only_(synthesis_only),
+        job_pool_options_(job_pool_options) {}
 
+  // Synthesizes the request in the job pool, answering repeated requests from
+  // the result cache.
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override;
 
+  // Returns the number of `Compile` calls answered from the result cache.
+  int64_t cache_hits() const {
+    absl::MutexLock lock(&cache_mutex_);
+    return cache_hits_;
+  }
+
   // Run the given arguments as a subprocess with InvokeSubprocess.
   // InvokeSubprocess is wrapped because the error message can be very large (it
   // includes both stdout and stderr) which breaks propagation of the error via
@@ -92,6 +124,34 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
                       const std::filesystem::path& netlist_path) const;
 
  private:
+  // A result cache entry; `done` is false while the request is being
+  // synthesized. Entries with waiters are never evicted.
+  struct CachedResult {
+    bool done = false;
+    int64_t waiters = 0;
+    absl::StatusOr<CompileResponse> response;
+  };
+
+  // Returns the result cache key of the request: a hash of everything which
+  // determines the synthesis result.
+  std::string ResultCacheKey(const CompileRequest* request) const;
+
+  // Runs `RunSynthesis` once a job slot is free.
+  absl::StatusOr<CompileResponse> RunSynthesisInPool(
+      const CompileRequest* request);
+
+  // Waits for a free job slot, or returns RESOURCE_EXHAUSTED if too many
+  // requests are already waiting.
+  absl::Status AcquireJobSlot();
+  void ReleaseJobSlot();
+  bool HasFreeJobSlot() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(pool_mutex_) {
+    return running_jobs_ < job_pool_options_.max_concurrent_jobs;
+  }
+
+  // Drops the oldest finished, unwaited cache entries until the cache fits in
+  // `result_cache_size`.
+  void EvictCacheEntries() ABSL_EXCLUSIVE_LOCKS_REQUIRED(cache_mutex_);
+
   std::string yosys_path_;
   std::string nextpnr_path_;
   std::string synthesis_target_;
@@ -103,6 +163,20 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
   bool save_temps_;
   bool return_netlist_;
   bool synthesis_only_;
+  YosysJobPoolOptions job_pool_options_;
+
+  absl::Mutex pool_mutex_;
+  int64_t running_jobs_ ABSL_GUARDED_BY(pool_mutex_) = 0;
+  int64_t queued_jobs_ ABSL_GUARDED_BY(pool_mutex_) = 0;
+
+  // Node-based storage keeps entries at stable addresses for threads waiting
+  // on them.
+  mutable absl::Mutex cache_mutex_;
+  absl::node_hash_map<std::string, CachedResult> result_cache_
+      ABSL_GUARDED_BY(cache_mutex_);
+  // Cache keys in insertion order, for eviction.
+  std::deque<std::string> cache_order_ ABSL_GUARDED_BY(cache_mutex_);
+  int64_t cache_hits_ ABSL_GUARDED_BY(cache_mutex_) = 0;
 };
 
 }  // namespace synthesis
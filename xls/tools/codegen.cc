@@ -14,6 +14,8 @@
 
 #include "xls/tools/codegen.h"
 
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
@@ -26,7 +28,9 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/time/time.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/combinational_generator.h"
@@ -35,6 +39,7 @@
 #include "xls/codegen/pipeline_generator.h"
 #include "xls/codegen/ram_configuration.h"
 #include "xls/codegen/unified_generator.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
@@ -46,6 +51,7 @@
 #include "xls/ir/verifier.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/scheduling_checker.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/scheduling_pass.h"
 #include "xls/scheduling/scheduling_pass_pipeline.h"
@@ -78,7 +84,16 @@ struct CodegenMetadata {
   const DelayEstimator* base_estimator = nullptr;
   std::unique_ptr<FfiDelayEstimator> ffi_estimator;
   std::unique_ptr<FirstMatchDelayEstimator> first_match_estimator;
+  std::unique_ptr<StructuralCachingDelayEstimator> caching_estimator;
   DelayEstimator* delay_estimator = nullptr;
+  // If non-empty, the structural delay cache is loaded from and saved to this
+  // file.
+  std::string delay_cache_path;
+  // If non-empty, schedules are cached in this directory keyed on the IR, the
+  // scheduling flags and the delay model.
+  std::string schedule_cache_dir;
+  // The part of the schedule cache key which does not depend on the IR.
+  std::string schedule_cache_options_key;
 
   static absl::StatusOr<CodegenMetadata> Create(
       Package* package,
@@ -130,7 +145,38 @@ struct CodegenMetadata {
         "combined_estimator",
         std::vector<const DelayEstimator*>(
             {metadata.base_estimator, metadata.ffi_estimator.get()}));
-    metadata.delay_estimator = metadata.first_match_estimator.get();
+    // The cache is keyed on the estimator name, which must therefore reflect
+    // the FFI fallback delay as well as the base model.
+    std::optional<int64_t> ffi_fallback_delay_ps =
+        metadata.scheduling_options.ffi_fallback_delay_ps();
+    metadata.caching_estimator =
+        std::make_unique<StructuralCachingDelayEstimator>(
+            absl::StrCat(metadata.base_estimator->name(), "+ffi:",
+                         ffi_fallback_delay_ps.has_value()
+                             ? absl::StrCat(*ffi_fallback_delay_ps)
+                             : "none"),
+            *metadata.first_match_estimator);
+    metadata.delay_estimator = metadata.caching_estimator.get();
+    metadata.delay_cache_path = scheduling_options_flags_proto.delay_cache_path();
+    if (!metadata.delay_cache_path.empty() &&
+        FileExists(metadata.delay_cache_path).ok()) {
+      XLS_RETURN_IF_ERROR(
+          StructuralDelayCache::Global().Load(metadata.delay_cache_path));
+    }
+    metadata.schedule_cache_dir =
+        scheduling_options_flags_proto.schedule_cache_dir();
+    if (!metadata.schedule_cache_dir.empty()) {
+      // Cache locations do not affect the schedule.
+      SchedulingOptionsFlagsProto key_proto = scheduling_options_flags_proto;
+      key_proto.clear_delay_cache_path();
+      key_proto.clear_schedule_cache_dir();
+      metadata.schedule_cache_options_key =
+          absl::StrCat(metadata.delay_estimator->name(), "\n",
+                       key_proto.SerializeAsString(), "\n",
+                       codegen_flags_proto.top(), "\n",
+                       absl::StrJoin(codegen_flags_proto.ram_configurations(),
+                                     "\n"));
+    }
 
     if (package->GetTop().value()->IsProc()) {
       // Force using non-pretty printed codegen when generating procs.
@@ -138,15 +184,152 @@ struct CodegenMetadata {
       //  blocks with flow control.
       metadata.codegen_options.emit_as_pipeline(false);
     }
+
+    if (!codegen_flags_proto.module_cache_dir().empty()) {
+      // The cache location, the thread count, the memory mode and the I/O
+      // analysis budget do not affect the Verilog.
+      CodegenFlagsProto key_proto = codegen_flags_proto;
+      key_proto.clear_module_cache_dir();
+      key_proto.clear_block_generation_threads();
+      key_proto.clear_low_memory();
+      key_proto.clear_io_analysis_time_budget_ms();
+      metadata.codegen_options.module_cache(
+          codegen_flags_proto.module_cache_dir(),
+          absl::StrCat(
+              key_proto.SerializeAsString(), "\nemit_as_pipeline=",
+              metadata.codegen_options.emit_as_pipeline() ? "true" : "false"));
+    }
     return metadata;
   }
 };
 
+// Returns the 64-bit FNV-1a hash of `data`. Unlike absl::Hash, it is the same
+// in every run, so it can be used to name files.
+uint64_t StableHash(std::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+std::filesystem::path ScheduleCachePath(const CodegenMetadata& metadata,
+                                        std::string_view ir) {
+  return std::filesystem::path(metadata.schedule_cache_dir) /
+         absl::StrFormat("%016x.schedule.textproto",
+                         StableHash(absl::StrCat(
+                             metadata.schedule_cache_options_key, "\n", ir)));
+}
+
+// Reconstructs the schedules stored in `proto` for `p` and checks that they are
+// valid under the scheduling options of `metadata`.
+absl::StatusOr<PipelineScheduleOrGroup> LoadCachedSchedules(
+    Package* p, const CodegenMetadata& metadata,
+    const PackagePipelineSchedulesProto& proto) {
+  const SchedulingOptions& scheduling_options = metadata.scheduling_options;
+  FunctionBase* top = p->GetTop().value();
+  SchedulingUnit unit = scheduling_options.schedule_all_procs()
+                            ? SchedulingUnit::CreateForWholePackage(p)
+                            : SchedulingUnit::CreateForSingleFunction(top);
+  if (scheduling_options.schedule_all_procs()) {
+    XLS_ASSIGN_OR_RETURN(PackagePipelineSchedules schedules,
+                         PackagePipelineSchedulesFromProto(p, proto));
+    unit.schedules() = std::move(schedules);
+  } else {
+    XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
+                         PipelineSchedule::FromProto(top, proto));
+    unit.schedules().emplace(top, std::move(schedule));
+  }
+
+  SchedulingPassOptions sched_options;
+  sched_options.scheduling_options = scheduling_options;
+  sched_options.delay_estimator = metadata.delay_estimator;
+  SchedulingPassResults results;
+  XLS_RETURN_IF_ERROR(SchedulingChecker().Run(&unit, sched_options, &results));
+  XLS_RET_CHECK(unit.schedules().contains(top));
+  for (const auto& [f, schedule] : unit.schedules()) {
+    if (scheduling_options.pipeline_stages().has_value()) {
+      XLS_RET_CHECK_EQ(schedule.length(),
+                       scheduling_options.pipeline_stages().value());
+    }
+    if (scheduling_options.clock_period_ps().has_value()) {
+      XLS_RETURN_IF_ERROR(
+          schedule.VerifyTiming(scheduling_options.clock_period_ps().value(),
+                                *metadata.delay_estimator));
+    }
+  }
+  if (scheduling_options.schedule_all_procs()) {
+    return std::move(unit).schedules();
+  }
+  return unit.schedules().at(top);
+}
+
+PackagePipelineSchedulesProto SchedulesToProto(
+    const PipelineScheduleOrGroup& schedules,
+    const DelayEstimator& delay_estimator) {
+  if (std::holds_alternative<PipelineSchedule>(schedules)) {
+    const PipelineSchedule& schedule = std::get<PipelineSchedule>(schedules);
+    PackagePipelineSchedulesProto proto;
+    proto.mutable_schedules()->insert(
+        {schedule.function_base()->name(), schedule.ToProto(delay_estimator)});
+    return proto;
+  }
+  return PackagePipelineSchedulesToProto(
+      std::get<PackagePipelineSchedules>(schedules), delay_estimator);
+}
+
 absl::StatusOr<PipelineScheduleOrGroup> ScheduleFromMetadata(
     Package* p, const CodegenMetadata& metadata,
     absl::Duration* scheduling_time) {
-  return Schedule(p, metadata.scheduling_options, metadata.delay_estimator,
-                  scheduling_time);
+  std::string unscheduled_ir;
+  std::filesystem::path schedule_cache_path;
+  if (!metadata.schedule_cache_dir.empty()) {
+    unscheduled_ir = p->DumpIr();
+    schedule_cache_path = ScheduleCachePath(metadata, unscheduled_ir);
+    if (FileExists(schedule_cache_path).ok()) {
+      std::optional<Stopwatch> stopwatch;
+      if (scheduling_time != nullptr) {
+        stopwatch.emplace();
+      }
+      absl::StatusOr<PackagePipelineSchedulesProto> proto =
+          ParseTextProtoFile<PackagePipelineSchedulesProto>(
+              schedule_cache_path);
+      absl::StatusOr<PipelineScheduleOrGroup> cached =
+          proto.ok() ? LoadCachedSchedules(p, metadata, *proto)
+                     : absl::StatusOr<PipelineScheduleOrGroup>(proto.status());
+      if (cached.ok()) {
+        VLOG(1) << "Using cached schedule " << schedule_cache_path;
+        if (scheduling_time != nullptr) {
+          *scheduling_time = stopwatch->GetElapsedTime();
+        }
+        return cached;
+      }
+      LOG(WARNING) << "Ignoring cached schedule " << schedule_cache_path
+                   << ": " << cached.status();
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(PipelineScheduleOrGroup schedules,
+                       Schedule(p, metadata.scheduling_options,
+                                metadata.delay_estimator, scheduling_time));
+  if (!metadata.delay_cache_path.empty()) {
+    XLS_RETURN_IF_ERROR(
+        StructuralDelayCache::Global().Save(metadata.delay_cache_path));
+  }
+  if (!schedule_cache_path.empty()) {
+    // The scheduling passes may rewrite the IR, in which case the schedule
+    // refers to nodes which the unscheduled IR does not have and cannot be
+    // reused.
+    if (p->DumpIr() == unscheduled_ir) {
+      XLS_RETURN_IF_ERROR(SetTextProtoFile(
+          schedule_cache_path,
+          SchedulesToProto(schedules, *metadata.delay_estimator)));
+    } else {
+      VLOG(1) << "Not caching the schedule; scheduling changed the IR.";
+    }
+  }
+  return schedules;
 }
 
 absl::StatusOr<PackagePipelineSchedules> DeterminePipelineSchedules(
@@ -221,8 +404,9 @@ absl::StatusOr<CodegenResult> CodegenFromMetadata(
   }
 
   return CodegenResult{
-      .module_generator_result = result,
-      .package_pipeline_schedules_proto = package_pipeline_schedules_proto,
+      .module_generator_result = std::move(result),
+      .package_pipeline_schedules_proto =
+          std::move(package_pipeline_schedules_proto),
   };
 }
 
@@ -344,6 +528,9 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
         std::make_unique<verilog::OpOverrideGateAssignment>(p.gate_format()));
   }
 
+  options.clock_gate_format(p.clock_gate_format());
+  options.clock_gating_min_width(p.clock_gating_min_width());
+
   if (!p.assert_format().empty()) {
     options.SetOpOverride(
         Op::kAssert,
@@ -383,6 +570,23 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
 
   options.gate_recvs(p.gate_recvs());
   options.materialize_internal_fifos(p.materialize_internal_fifos());
+  if (p.has_block_generation_threads()) {
+    if (p.block_generation_threads() < 0) {
+      return absl::InvalidArgumentError(
+          "block_generation_threads must be non-negative");
+    }
+    options.block_generation_threads(p.block_generation_threads());
+  }
+  options.retime_registers(p.retime_registers());
+  options.low_memory(p.low_memory());
+  if (p.io_analysis_time_budget_ms() < 0) {
+    return absl::InvalidArgumentError(
+        "io_analysis_time_budget_ms must be non-negative");
+  }
+  if (p.io_analysis_time_budget_ms() > 0) {
+    options.io_analysis_time_budget(
+        absl::Milliseconds(p.io_analysis_time_budget_ms()));
+  }
   options.array_index_bounds_checking(p.array_index_bounds_checking());
   switch (p.register_merge_strategy()) {
     case STRATEGY_DONT_MERGE:
@@ -467,8 +671,9 @@ absl::StatusOr<CodegenResult> CodegenPipeline(
   }
 
   return CodegenResult{
-      .module_generator_result = result,
-      .package_pipeline_schedules_proto = package_pipeline_schedules_proto,
+      .module_generator_result = std::move(result),
+      .package_pipeline_schedules_proto =
+          std::move(package_pipeline_schedules_proto),
   };
 }
 
@@ -485,7 +690,7 @@ absl::StatusOr<CodegenResult> CodegenCombinational(
   if (codegen_time != nullptr) {
     *codegen_time = stopwatch->GetElapsedTime();
   }
-  return CodegenResult{.module_generator_result = result};
+  return CodegenResult{.module_generator_result = std::move(result)};
 }
 
 absl::StatusOr<PipelineScheduleOrGroup> Schedule(
@@ -144,6 +144,37 @@ ABSL_FLAG(bool, gate_recvs, true,
 ABSL_FLAG(bool, materialize_internal_fifos, false,
           "If true, emit logic implementing fifos for any channels in the IR. "
           "If false use an externally provided fifo implementation.");
+ABSL_FLAG(int64_t, block_generation_threads, 1,
+          "Number of threads used to generate the Verilog of the blocks of a "
+          "multi-block design concurrently. 0 uses all available CPUs. The "
+          "output does not depend on this value.");
+ABSL_FLAG(std::string, module_cache_dir, "",
+          "If non-empty, a directory in which the generated Verilog of each "
+          "block is cached. Blocks which are unchanged since an earlier run "
+          "with the same options reuse the cached module text, so unchanged "
+          "modules are emitted byte-for-byte identically and faster.");
+ABSL_FLAG(bool, retime_registers, false,
+          "If true, move pipeline registers across operations which narrow "
+          "their operands (e.g. comparisons) where that reduces the number of "
+          "register bits without exceeding the clock period.");
+ABSL_FLAG(bool, low_memory, false,
+          "If true, lower the peak memory use of codegen by removing the "
+          "functions and procs from the package once they are converted to "
+          "blocks, and by generating the Verilog one block at a time. The "
+          "generated Verilog is unchanged, but the package then holds only "
+          "blocks, so the scheduled IR cannot be output.");
+ABSL_FLAG(int64_t, io_analysis_time_budget_ms, 0,
+          "If positive, the time in milliseconds after which the BDD analysis "
+          "of whether the streaming outputs of a proc are mutually exclusive "
+          "stops evaluating and answers conservatively. 0 means unlimited.");
+ABSL_FLAG(std::string, clock_gate_format, "",
+          "Format string of an integrated clock gate cell. If given, registers "
+          "sharing a load enable are clocked by a gated clock instead of "
+          "muxing their next value. Placeholders are {clock}, {enable} and "
+          "{gated_clock}.");
+ABSL_FLAG(int64_t, clock_gating_min_width, 8,
+          "The minimum total bit width of the registers sharing a load enable "
+          "for them to be clock gated with --clock_gate_format.");
 ABSL_FLAG(bool, array_index_bounds_checking, true,
           "If true, emit bounds checking on array-index operations in Verilog. "
           "Otherwise, the bounds checking is not evaluated.");
@@ -285,6 +316,13 @@ static absl::StatusOr<bool> SetOptionsFromFlags(CodegenFlagsProto &proto) {
   POPULATE_FLAG(gate_recvs);
   POPULATE_FLAG(array_index_bounds_checking);
   POPULATE_FLAG(materialize_internal_fifos);
+  POPULATE_FLAG(block_generation_threads);
+  POPULATE_FLAG(module_cache_dir);
+  POPULATE_FLAG(retime_registers);
+  POPULATE_FLAG(low_memory);
+  POPULATE_FLAG(io_analysis_time_budget_ms);
+  POPULATE_FLAG(clock_gate_format);
+  POPULATE_FLAG(clock_gating_min_width);
   XLS_ASSIGN_OR_RETURN(
       RegisterMergeStrategyProto merge_strategy,
       MergeStrategyFromString(absl::GetFlag(FLAGS_register_merge_strategy)));
@@ -18,6 +18,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -66,12 +67,21 @@ absl::Status RealMain(std::string_view ir_path) {
   if (ir_path == "-") {
     ir_path = "/dev/stdin";
   }
-  XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
-                       Parser::ParsePackage(ir_contents, ir_path));
+  std::unique_ptr<Package> p;
+  {
+    // The IR text is not needed once it is parsed.
+    XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
+    XLS_ASSIGN_OR_RETURN(p, Parser::ParsePackage(ir_contents, ir_path));
+  }
 
   XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
                        GetCodegenFlags());
+  if (codegen_flags_proto.low_memory() &&
+      !absl::GetFlag(FLAGS_output_schedule_ir_path).empty()) {
+    return absl::InvalidArgumentError(
+        "--low_memory removes the scheduled IR from the package and cannot be "
+        "used with --output_schedule_ir_path");
+  }
   if (!codegen_flags_proto.top().empty()) {
     XLS_RETURN_IF_ERROR(p->SetTopByName(codegen_flags_proto.top()));
   }
@@ -90,9 +100,9 @@ absl::Status RealMain(std::string_view ir_path) {
       CodegenResult r,
       ScheduleAndCodegen(p.get(), scheduling_options_flags_proto,
                          codegen_flags_proto, delay_model_flag_passed));
-  verilog::ModuleGeneratorResult result = r.module_generator_result;
+  verilog::ModuleGeneratorResult result = std::move(r.module_generator_result);
   std::optional<PackagePipelineSchedulesProto> schedule =
-      r.package_pipeline_schedules_proto;
+      std::move(r.package_pipeline_schedules_proto);
 
   if (!absl::GetFlag(FLAGS_output_schedule_ir_path).empty()) {
     XLS_RETURN_IF_ERROR(
@@ -117,6 +127,10 @@ absl::Status RealMain(std::string_view ir_path) {
     XLS_RETURN_IF_ERROR(SetFileContents(
         absl::GetFlag(FLAGS_output_block_ir_path), p->DumpIr()));
   }
+  if (codegen_flags_proto.low_memory()) {
+    // Nothing below reads the IR.
+    p.reset();
+  }
 
   if (!absl::GetFlag(FLAGS_output_signature_path).empty()) {
     XLS_RETURN_IF_ERROR(SetTextProtoFile(
@@ -541,6 +541,81 @@ class CodeGenMainTest(parameterized.TestCase):
       merge = blk.read()
     self.assertNotEqual(no_merge, merge)
 
+  def _codegen_with_schedule_cache(self, ir_path, cache_dir):
+    """Runs pipelined codegen with a schedule cache.
+
+    Args:
+      ir_path: Path of the IR to generate Verilog for.
+      cache_dir: Directory of the schedule cache.
+
+    Returns:
+      The generated Verilog, the schedule and the log of the run.
+    """
+    verilog_path = self.create_tempfile()
+    schedule_path = self.create_tempfile()
+    result = subprocess.run(
+        [
+            CODEGEN_MAIN_PATH,
+            '--generator=pipeline',
+            '--delay_model=unit',
+            '--pipeline_stages=2',
+            '--alsologtostderr',
+            '--v=1',
+            f'--schedule_cache_dir={cache_dir}',
+            f'--output_verilog_path={verilog_path.full_path}',
+            f'--output_schedule_path={schedule_path.full_path}',
+            ir_path,
+        ],
+        stdout=subprocess.DEVNULL,
+        stderr=subprocess.PIPE,
+        check=False,
+    )
+    stderr = result.stderr.decode('utf-8')
+    self.assertEqual(result.returncode, 0, stderr)
+    return (verilog_path.read_text(), schedule_path.read_text(), stderr)
+
+  def test_schedule_cache_hit(self):
+    ir_file = self.create_tempfile(content=NOT_ADD_IR)
+    cache_dir = self.create_tempdir()
+    verilog, schedule, stderr = self._codegen_with_schedule_cache(
+        ir_file.full_path, cache_dir.full_path
+    )
+    self.assertNotIn('Using cached schedule', stderr)
+    self.assertLen(os.listdir(cache_dir.full_path), 1)
+
+    cached_verilog, cached_schedule, stderr = (
+        self._codegen_with_schedule_cache(
+            ir_file.full_path, cache_dir.full_path
+        )
+    )
+    self.assertIn('Using cached schedule', stderr)
+    self.assertEqual(cached_verilog, verilog)
+    self.assertEqual(cached_schedule, schedule)
+
+  def test_corrupt_schedule_cache_entry_is_rescheduled(self):
+    ir_file = self.create_tempfile(content=NOT_ADD_IR)
+    cache_dir = self.create_tempdir()
+    verilog, schedule, _ = self._codegen_with_schedule_cache(
+        ir_file.full_path, cache_dir.full_path
+    )
+    [entry] = os.listdir(cache_dir.full_path)
+    entry_path = os.path.join(cache_dir.full_path, entry)
+    with open(entry_path, 'w') as f:
+      f.write('this is not a schedule {')
+
+    rescheduled_verilog, rescheduled_schedule, stderr = (
+        self._codegen_with_schedule_cache(
+            ir_file.full_path, cache_dir.full_path
+        )
+    )
+    self.assertIn('Ignoring cached schedule', stderr)
+    self.assertNotIn('Using cached schedule', stderr)
+    self.assertEqual(rescheduled_verilog, verilog)
+    self.assertEqual(rescheduled_schedule, schedule)
+    # The entry is replaced by the new schedule.
+    with open(entry_path, 'r') as f:
+      self.assertNotIn('this is not a schedule', f.read())
+
 
 if __name__ == '__main__':
   absltest.main()
@@ -93,6 +93,17 @@ ABSL_FLAG(std::optional<int>, stage, std::nullopt,
 ABSL_FLAG(std::optional<std::string>, proto_out, std::nullopt,
           "File to write a binary xls.DelayInfoProto to containing delay info "
           "of the input.");
+ABSL_FLAG(int64_t, paths_per_stage, 0,
+          "If positive and --schedule_path is given, report this many of the "
+          "longest paths of each stage along with the slack distribution of "
+          "the stage and the delay contributed by each op. The report is "
+          "included in --proto_out.");
+ABSL_FLAG(std::optional<int64_t>, clock_period_ps, std::nullopt,
+          "Clock period to measure slack against in the --paths_per_stage "
+          "report. Defaults to the delay of the longest stage.");
+ABSL_FLAG(std::optional<std::string>, critical_path_trace_out, std::nullopt,
+          "File to write the --paths_per_stage report to in the Chrome trace "
+          "event JSON format, for viewing in Perfetto or chrome://tracing.");
 
 namespace xls::tools {
 namespace {
@@ -204,6 +215,46 @@ absl::Status RealMain(std::string_view input_path) {
       }
       std::cout << "\n";
     }
+    if (int64_t paths_per_stage = absl::GetFlag(FLAGS_paths_per_stage);
+        paths_per_stage > 0) {
+      XLS_ASSIGN_OR_RETURN(
+          CriticalPathReportProto report,
+          AnalyzeStageCriticalPaths(
+              top, schedule.GetCycleMap(), absl::GetFlag(FLAGS_clock_period_ps),
+              *delay_estimator,
+              CriticalPathReportOptions{.paths_per_stage = paths_per_stage}));
+      for (const StageCriticalPathReportProto& stage : report.stages()) {
+        std::cout << absl::StrFormat(
+            "# Slack of paths leaving stage %d (clock period %dps):\n",
+            stage.stage(), report.clock_period_ps());
+        for (const SlackHistogramBucketProto& bucket :
+             stage.slack_histogram()) {
+          std::cout << absl::StreamFormat(
+              "  [%6dps, %6dps) : %d\n", bucket.min_slack_ps(),
+              bucket.min_slack_ps() + report.slack_bucket_ps(),
+              bucket.count());
+        }
+        std::cout << absl::StrFormat(
+            "# Delay by op on the %d longest paths of stage %d:\n",
+            stage.paths_size(), stage.stage());
+        for (const OpDelayContributionProto& contribution :
+             stage.op_contributions()) {
+          std::cout << absl::StreamFormat(
+              "  %-15s : %6dps in %d nodes\n",
+              OpToString(FromOpProto(contribution.op())),
+              contribution.total_delay_ps(), contribution.node_count());
+        }
+        std::cout << "\n";
+      }
+      if (std::optional<std::string> trace_path =
+              absl::GetFlag(FLAGS_critical_path_trace_out)) {
+        XLS_RETURN_IF_ERROR(SetFileContents(
+            *trace_path, CriticalPathReportToChromeTrace(report)));
+      }
+      if (delay_proto) {
+        *delay_proto->mutable_critical_path_report() = std::move(report);
+      }
+    }
     if (top->IsProc()) {
       Proc* proc = top->AsProcOrDie();
       for (StateElement* state_element : proc->StateElements()) {
@@ -0,0 +1,255 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Gathers XLS-side statistics for many IR designs in a single process. Each
+// design is parsed once and taken through optimization, scheduling and
+// pipeline codegen on a pool of worker threads, and an xls.DesignFlowStats
+// record is appended to --output as soon as the design completes, so partial
+// results are available while a large regression is still running and
+// nothing is lost if it is interrupted.
+//
+//   design_stats_main --output=/tmp/stats.textproto --pipeline_stages=4 \
+//     a.opt.ir b.opt.ir ...
+//
+// The output is an xls.DesignFlowStatsList textproto. Scheduling and codegen
+// are configured with the usual codegen_main flags; the delay model defaults
+// to "unit". Failures are recorded in the `error` field of the design's record
+// rather than aborting the run.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "google/protobuf/text_format.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_flags.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/design_flow_stats.pb.h"
+#include "xls/tools/opt.h"
+#include "xls/tools/scheduling_options_flags.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+
+ABSL_FLAG(std::string, output, "",
+          "Path of the xls.DesignFlowStatsList textproto to write. Records are "
+          "appended as designs complete.");
+ABSL_FLAG(std::string, design_list, "",
+          "Optional file listing IR files to process, one per line, in "
+          "addition to the positional arguments.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of designs to process concurrently. Defaults to the number "
+          "of available CPUs.");
+
+namespace xls {
+namespace {
+
+// Serializes writes of completed records to the output file.
+class StatsWriter {
+ public:
+  explicit StatsWriter(std::filesystem::path path) : path_(std::move(path)) {}
+
+  absl::Status Initialize() { return SetFileContents(path_, ""); }
+
+  absl::Status Append(const DesignFlowStats& stats) {
+    std::string text;
+    XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(stats, &text));
+    absl::MutexLock lock(&mutex_);
+    return AppendStringToFile(path_, absl::StrCat("designs {\n", text, "}\n"));
+  }
+
+ private:
+  std::filesystem::path path_;
+  absl::Mutex mutex_;
+};
+
+// Runs the flow on the IR in `path`, filling in `stats` as stages complete.
+absl::Status CollectStats(
+    const std::filesystem::path& path,
+    const SchedulingOptionsFlagsProto& scheduling_options,
+    const CodegenFlagsProto& codegen_flags, DesignFlowStats& stats) {
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, path.string()));
+  std::optional<FunctionBase*> top = package->GetTop();
+  XLS_RET_CHECK(top.has_value()) << "Package has no top";
+  stats.set_top((*top)->name());
+  stats.set_ir_node_count((*top)->node_count());
+
+  absl::Time start = absl::Now();
+  tools::OptOptions opt_options;
+  opt_options.top = stats.top();
+  XLS_RETURN_IF_ERROR(tools::OptimizeIrForTop(package.get(), opt_options));
+  stats.set_opt_ms(absl::ToDoubleMilliseconds(absl::Now() - start));
+  top = package->GetTop();
+  XLS_RET_CHECK(top.has_value());
+  stats.set_optimized_node_count((*top)->node_count());
+
+  start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(PipelineScheduleOrGroup schedules,
+                       Schedule(package.get(), scheduling_options,
+                                codegen_flags, /*scheduling_time=*/nullptr));
+  stats.set_schedule_ms(absl::ToDoubleMilliseconds(absl::Now() - start));
+  const PipelineSchedule* schedule = nullptr;
+  if (std::holds_alternative<PipelineSchedule>(schedules)) {
+    schedule = &std::get<PipelineSchedule>(schedules);
+  } else {
+    const PackagePipelineSchedules& group =
+        std::get<PackagePipelineSchedules>(schedules);
+    auto it = group.find(*top);
+    if (it != group.end()) {
+      schedule = &it->second;
+    }
+  }
+  if (schedule != nullptr) {
+    stats.set_pipeline_stages(schedule->length());
+    for (int64_t cycle = 0; cycle < schedule->length(); ++cycle) {
+      stats.add_nodes_per_stage(schedule->nodes_in_cycle(cycle).size());
+    }
+    stats.set_pipeline_register_bits(
+        schedule->CountFinalInteriorPipelineRegisters());
+  }
+
+  start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(
+      CodegenResult result,
+      Codegen(package.get(), scheduling_options, codegen_flags,
+              /*with_delay_model=*/true, &schedules,
+              /*codegen_time=*/nullptr));
+  stats.set_codegen_ms(absl::ToDoubleMilliseconds(absl::Now() - start));
+  const verilog::ModuleSignatureProto& signature =
+      result.module_generator_result.signature.proto();
+  if (signature.has_metrics()) {
+    *stats.mutable_metrics() = signature.metrics();
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<std::filesystem::path>> GetDesignPaths(
+    absl::Span<const std::string_view> positional_arguments) {
+  std::vector<std::filesystem::path> paths(positional_arguments.begin(),
+                                           positional_arguments.end());
+  if (!absl::GetFlag(FLAGS_design_list).empty()) {
+    XLS_ASSIGN_OR_RETURN(std::string list,
+                         GetFileContents(absl::GetFlag(FLAGS_design_list)));
+    for (std::string_view line : absl::StrSplit(list, '\n')) {
+      line = absl::StripAsciiWhitespace(line);
+      if (!line.empty() && !absl::StartsWith(line, "#")) {
+        paths.push_back(std::filesystem::path(line));
+      }
+    }
+  }
+  return paths;
+}
+
+absl::Status RealMain(
+    absl::Span<const std::string_view> positional_arguments) {
+  QCHECK(!absl::GetFlag(FLAGS_output).empty()) << "--output is required";
+  XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> paths,
+                       GetDesignPaths(positional_arguments));
+
+  // The flags are read once up front; the workers only see copies.
+  XLS_ASSIGN_OR_RETURN(SchedulingOptionsFlagsProto scheduling_options,
+                       GetSchedulingOptionsFlagsProto());
+  XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags, GetCodegenFlags());
+  codegen_flags.set_generator(GENERATOR_KIND_PIPELINE);
+  if (scheduling_options.delay_model().empty()) {
+    scheduling_options.set_delay_model("unit");
+  }
+
+  StatsWriter writer(absl::GetFlag(FLAGS_output));
+  XLS_RETURN_IF_ERROR(writer.Initialize());
+
+  std::atomic<int64_t> next_index = 0;
+  std::atomic<int64_t> failures = 0;
+  absl::Mutex status_mutex;
+  absl::Status write_status;
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < paths.size();
+         i = next_index.fetch_add(1)) {
+      DesignFlowStats stats;
+      stats.set_design(paths[i].string());
+      absl::Status status =
+          CollectStats(paths[i], scheduling_options, codegen_flags, stats);
+      if (!status.ok()) {
+        LOG(WARNING) << paths[i] << ": " << status;
+        stats.set_error(status.ToString());
+        failures.fetch_add(1);
+      }
+      absl::Status written = writer.Append(stats);
+      if (!written.ok()) {
+        absl::MutexLock lock(&status_mutex);
+        write_status.Update(written);
+      }
+    }
+  };
+  int64_t thread_count = std::clamp<int64_t>(
+      absl::GetFlag(FLAGS_threads) > 0 ? absl::GetFlag(FLAGS_threads)
+                                       : AvailableCPUs(),
+      1, std::max<int64_t>(paths.size(), 1));
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (auto& t : threads) {
+    t->Join();
+  }
+
+  XLS_RETURN_IF_ERROR(write_status);
+  LOG(INFO) << "Gathered stats for " << paths.size() << " designs ("
+            << failures.load() << " failed)";
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments = xls::InitXls(
+      "Gathers optimization, scheduling and codegen stats for IR designs.",
+      argc, argv);
+  return xls::ExitStatus(xls::RealMain(positional_arguments));
+}
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
@@ -36,6 +37,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/ADT/APInt.h"
 #include "llvm/include/llvm/ADT/StringRef.h"
@@ -67,6 +69,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/import_data.h"
@@ -80,6 +83,7 @@
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/clone_package.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/function.h"
@@ -92,6 +96,7 @@
 #include "xls/ir/value_utils.h"
 #include "xls/jit/function_jit.h"
 #include "xls/jit/jit_buffer.h"
+#include "xls/jit/node_profiler.h"
 #include "xls/jit/observer.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
@@ -143,6 +148,11 @@ Evaluate IR after every optimization pass:
 Evaluate IR using the JIT and with the interpreter and compare the results:
 
    eval_ir_main --test_llvm_jit --random_inputs=100  IR_FILE
+
+Evaluate a large number of inputs on 16 threads, comparing the results before
+and after optimizations as they are produced:
+
+   eval_ir_main --threads=16 --input_file=INPUT_FILE --optimize_ir IR_FILE
 )";
 
 // LINT.IfChange
@@ -221,6 +231,24 @@ ABSL_FLAG(std::optional<std::string>, output_node_coverage_stats_textproto,
           "File to write a (text) NodeCoverageStatsProto showing which bits "
           "in the run were actually set for each node.");
 
+ABSL_FLAG(bool, node_profile, false,
+          "Evaluate the inputs an additional time with per-node profiling "
+          "enabled and print a report of the nodes which take the most "
+          "cycles to stderr. The profiled code reads the cycle counter around "
+          "each node so it runs somewhat slower than unprofiled code. "
+          "Requires --use_llvm_jit.");
+ABSL_FLAG(int64_t, node_profile_max_nodes, 25,
+          "Maximum number of nodes to list in the --node_profile report.");
+
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads to evaluate the inputs on. Inputs are sharded "
+          "over the threads in chunks which share a single compiled function, "
+          "and results are printed in input order as they become available. "
+          "With --optimize_ir or --test_llvm_jit both evaluations run side "
+          "by side and each (matching) result is printed once. Not supported "
+          "with node coverage output, --eval_after_each_pass or "
+          "--use_llvm_jit_interpreter, which evaluate on one thread.");
+
 // TODO(allight): It would be nice to enable doing this automatically if the
 // llvm jit code crashes or something.
 ABSL_FLAG(
@@ -247,6 +275,19 @@ std::string ArgsToString(absl::Span<const Value> args) {
   return absl::StrJoin(args, "; ", ValueFormatterHex);
 }
 
+// Returns the error reported when the result `actual` for input `index` does
+// not match `expected`.
+absl::Status MiscompareError(int64_t index, const ArgSet& arg_set,
+                             std::string_view actual_src, const Value& actual,
+                             std::string_view expected_src,
+                             const Value& expected) {
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s", index,
+      ArgsToString(arg_set.args), actual_src,
+      actual.ToString(FormatPreference::kHex), expected_src,
+      expected.ToString(FormatPreference::kHex)));
+}
+
 class EvalIrJitObserver final : public JitObserver {
  public:
   explicit EvalIrJitObserver(bool interpreter) : interpreter_(interpreter) {}
@@ -385,10 +426,27 @@ absl::StatusOr<std::vector<Value>> Eval(
                  &observer));
   }
 
+  // Without an observer, evaluate all of the argument sets with a single call
+  // into the jitted code to avoid the per-invocation overhead.
+  std::optional<std::vector<Value>> batched_results;
+  if (use_jit && !eval_observer.has_value() &&
+      absl::GetFlag(FLAGS_test_only_inject_jit_result).empty() &&
+      !absl::GetFlag(FLAGS_use_llvm_jit_interpreter)) {
+    std::vector<std::vector<Value>> batched_args;
+    batched_args.reserve(arg_sets.size());
+    for (const ArgSet& arg_set : arg_sets) {
+      batched_args.push_back(arg_set.args);
+    }
+    XLS_ASSIGN_OR_RETURN(batched_results,
+                         DropInterpreterEvents(jit->RunBatched(batched_args)));
+  }
+
   std::vector<Value> results;
   for (const ArgSet& arg_set : arg_sets) {
     Value result;
-    if (use_jit) {
+    if (batched_results.has_value()) {
+      result = (*batched_results)[results.size()];
+    } else if (use_jit) {
       if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
         if (absl::GetFlag(FLAGS_use_llvm_jit_interpreter)) {
           XLS_RET_CHECK(!eval_observer)
@@ -427,11 +485,8 @@ absl::StatusOr<std::vector<Value>> Eval(
 
     if (arg_set.expected.has_value()) {
       if (result != *arg_set.expected) {
-        return absl::InvalidArgumentError(absl::StrFormat(
-            "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s",
-            results.size(), ArgsToString(arg_set.args), actual_src,
-            result.ToString(FormatPreference::kHex), expected_src,
-            arg_set.expected->ToString(FormatPreference::kHex)));
+        return MiscompareError(results.size(), arg_set, actual_src, result,
+                               expected_src, *arg_set.expected);
       }
     }
     results.push_back(result);
@@ -439,6 +494,229 @@ absl::StatusOr<std::vector<Value>> Eval(
   return results;
 }
 
+// Evaluates the function with the given ArgSets with node profiling enabled
+// and prints the resulting report to stderr.
+absl::Status ProfileEval(Function* f, absl::Span<const ArgSet> arg_sets) {
+  // Declared before the JIT as the jitted code references it.
+  NodeProfiler profiler;
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<FunctionJit> jit,
+      FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level),
+                          /*include_observer_callbacks=*/false,
+                          /*jit_observer=*/nullptr, JitBatchOptions(),
+                          &profiler));
+  for (const ArgSet& arg_set : arg_sets) {
+    XLS_RETURN_IF_ERROR(jit->Run(arg_set.args).status());
+  }
+  std::cerr << "// JIT "
+            << profiler.ToString(absl::GetFlag(FLAGS_node_profile_max_nodes));
+  return absl::OkStatus();
+}
+
+// Number of argument sets handed to a thread at a time with --threads.
+constexpr int64_t kEvalChunkSize = 1024;
+
+// A function to evaluate with --threads: with `jit` if non-null and with the
+// interpreter otherwise. `description` names the evaluation in error messages.
+struct Evaluator {
+  Function* f;
+  const FunctionJit* jit;
+  std::string_view description;
+};
+
+absl::StatusOr<std::vector<Value>> EvalChunk(
+    const Evaluator& evaluator, absl::Span<const ArgSet> arg_sets) {
+  if (evaluator.jit != nullptr) {
+    std::vector<std::vector<Value>> batched_args;
+    batched_args.reserve(arg_sets.size());
+    for (const ArgSet& arg_set : arg_sets) {
+      batched_args.push_back(arg_set.args);
+    }
+    return DropInterpreterEvents(evaluator.jit->RunBatched(batched_args));
+  }
+  std::vector<Value> results;
+  results.reserve(arg_sets.size());
+  for (const ArgSet& arg_set : arg_sets) {
+    XLS_ASSIGN_OR_RETURN(
+        Value result,
+        DropInterpreterEvents(InterpretFunction(evaluator.f, arg_set.args)));
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+// Evaluates the ArgSets with `reference` and, if given, `actual` on --threads
+// threads. Results are printed in input order as soon as all earlier results
+// are available. Returns an error if a reference result does not match the
+// expected value of its ArgSet (if any) or an actual result does not match the
+// reference result.
+absl::Status ParallelEval(absl::Span<const ArgSet> arg_sets,
+                          const Evaluator& reference,
+                          std::optional<Evaluator> actual) {
+  struct ChunkResults {
+    std::vector<Value> reference;
+    std::vector<Value> actual;
+  };
+  const int64_t chunk_count =
+      (static_cast<int64_t>(arg_sets.size()) + kEvalChunkSize - 1) /
+      kEvalChunkSize;
+  const int64_t thread_count =
+      std::clamp<int64_t>(absl::GetFlag(FLAGS_threads), 1,
+                          std::max<int64_t>(chunk_count, 1));
+  // Bound how far the threads may run ahead of the printing so the number of
+  // results held in memory does not grow with the number of inputs.
+  const int64_t max_chunks_ahead = 4 * thread_count;
+
+  absl::Mutex mutex;
+  std::vector<std::optional<absl::StatusOr<ChunkResults>>> chunks(chunk_count);
+  int64_t next_chunk = 0;
+  int64_t printed_chunks = 0;
+  bool cancelled = false;
+  auto worker = [&]() {
+    while (true) {
+      int64_t chunk;
+      {
+        absl::MutexLock lock(&mutex);
+        auto can_start = [&]() {
+          mutex.AssertReaderHeld();
+          return cancelled || next_chunk >= chunk_count ||
+                 next_chunk < printed_chunks + max_chunks_ahead;
+        };
+        mutex.Await(absl::Condition(&can_start));
+        if (cancelled || next_chunk >= chunk_count) {
+          return;
+        }
+        chunk = next_chunk++;
+      }
+      absl::Span<const ArgSet> chunk_arg_sets =
+          arg_sets.subspan(chunk * kEvalChunkSize, kEvalChunkSize);
+      absl::StatusOr<ChunkResults> results =
+          [&]() -> absl::StatusOr<ChunkResults> {
+        ChunkResults results;
+        XLS_ASSIGN_OR_RETURN(results.reference,
+                             EvalChunk(reference, chunk_arg_sets));
+        if (actual.has_value()) {
+          XLS_ASSIGN_OR_RETURN(results.actual,
+                               EvalChunk(*actual, chunk_arg_sets));
+        }
+        return results;
+      }();
+      absl::MutexLock lock(&mutex);
+      chunks[chunk] = std::move(results);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+
+  absl::Status status = absl::OkStatus();
+  for (int64_t chunk = 0; chunk < chunk_count && status.ok(); ++chunk) {
+    absl::StatusOr<ChunkResults> results;
+    {
+      absl::MutexLock lock(&mutex);
+      auto chunk_done = [&]() {
+        mutex.AssertReaderHeld();
+        return chunks[chunk].has_value();
+      };
+      mutex.Await(absl::Condition(&chunk_done));
+      results = *std::move(chunks[chunk]);
+      chunks[chunk].reset();
+    }
+    if (!results.ok()) {
+      status = results.status();
+      break;
+    }
+    for (int64_t i = 0; i < results->reference.size(); ++i) {
+      const int64_t index = chunk * kEvalChunkSize + i;
+      const ArgSet& arg_set = arg_sets[index];
+      const Value& result = results->reference[i];
+      std::cout << result.ToString(FormatPreference::kHex) << '\n';
+      if (arg_set.expected.has_value() && result != *arg_set.expected) {
+        status = MiscompareError(index, arg_set, reference.description, result,
+                                 "expected", *arg_set.expected);
+        break;
+      }
+      if (actual.has_value() && results->actual[i] != result) {
+        status =
+            MiscompareError(index, arg_set, actual->description,
+                            results->actual[i], reference.description, result);
+        break;
+      }
+    }
+    absl::MutexLock lock(&mutex);
+    printed_chunks = chunk + 1;
+  }
+  {
+    absl::MutexLock lock(&mutex);
+    cancelled = !status.ok();
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  return status;
+}
+
+// Equivalent of Run (below) which evaluates the ArgSets on --threads threads.
+// Evaluations which are compared against each other run side by side rather
+// than one after the other.
+absl::Status RunInParallel(Package* package,
+                           absl::Span<const ArgSet> arg_sets) {
+  XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+  const int64_t opt_level = absl::GetFlag(FLAGS_llvm_opt_level);
+  if (absl::GetFlag(FLAGS_test_llvm_jit)) {
+    QCHECK(!absl::GetFlag(FLAGS_optimize_ir))
+        << "Cannot specify both --test_llvm_jit and --optimize_ir";
+    for (const ArgSet& arg_set : arg_sets) {
+      QCHECK(!arg_set.expected.has_value())
+          << "Cannot specify expected values when using --test_llvm_jit";
+    }
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create(f, opt_level));
+    return ParallelEval(
+        arg_sets,
+        Evaluator{.f = f, .jit = nullptr, .description = "interpreter"},
+        Evaluator{.f = f, .jit = jit.get(), .description = "JIT"});
+  }
+
+  const bool use_jit = absl::GetFlag(FLAGS_use_llvm_jit);
+  std::unique_ptr<FunctionJit> jit;
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(f, opt_level));
+  }
+  if (!absl::GetFlag(FLAGS_optimize_ir)) {
+    return ParallelEval(
+        arg_sets, Evaluator{.f = f, .jit = jit.get(), .description = "actual"},
+        std::nullopt);
+  }
+
+  // Optimize a copy of the package so the unoptimized function can be
+  // evaluated alongside the optimized one.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> optimized,
+                       ClonePackage(package));
+  XLS_RETURN_IF_ERROR(optimized->SetTopByName(f->name()));
+  PassResults results;
+  XLS_RETURN_IF_ERROR(
+      CreateOptimizationPassPipeline()
+          ->Run(optimized.get(), OptimizationPassOptions(), &results)
+          .status());
+  XLS_ASSIGN_OR_RETURN(Function * optimized_f,
+                       optimized->GetTopAsFunction());
+  std::unique_ptr<FunctionJit> optimized_jit;
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(optimized_jit,
+                         FunctionJit::Create(optimized_f, opt_level));
+  }
+  return ParallelEval(
+      arg_sets,
+      Evaluator{
+          .f = f, .jit = jit.get(), .description = "before optimizations"},
+      Evaluator{.f = optimized_f,
+                .jit = optimized_jit.get(),
+                .description = "after optimizations"});
+}
+
 // An invariant checker which evaluates the entry function with the given
 // ArgSets. Raises an error if expectations are not matched.
 class EvalInvariantChecker : public OptimizationInvariantChecker {
@@ -484,6 +762,21 @@ absl::Status Run(Package* package, absl::Span<const ArgSet> arg_sets_in) {
   // do not exist.
   std::vector<ArgSet> arg_sets(arg_sets_in.begin(), arg_sets_in.end());
 
+  if (absl::GetFlag(FLAGS_node_profile)) {
+    if (!absl::GetFlag(FLAGS_use_llvm_jit)) {
+      return absl::InvalidArgumentError(
+          "--node_profile requires --use_llvm_jit.");
+    }
+    XLS_RETURN_IF_ERROR(ProfileEval(f, arg_sets));
+  }
+
+  if (absl::GetFlag(FLAGS_threads) > 1 && !cov.observer().has_value() &&
+      !absl::GetFlag(FLAGS_eval_after_each_pass) &&
+      !absl::GetFlag(FLAGS_use_llvm_jit_interpreter) &&
+      absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
+    return RunInParallel(package, arg_sets);
+  }
+
   if (absl::GetFlag(FLAGS_test_llvm_jit)) {
     QCHECK(!absl::GetFlag(FLAGS_optimize_ir))
         << "Cannot specify both --test_llvm_jit and --optimize_ir";
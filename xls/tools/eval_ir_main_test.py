@@ -264,6 +264,59 @@ class EvalMainTest(parameterized.TestCase):
     # And with overwhelming probability they should all be different.
     self.assertLen(set(result.decode('utf-8').strip().split('\n')), 42)
 
+  @parameterized_proc_backends
+  def test_threads_match_single_thread(self, backend):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    single_thread = subprocess.check_output(
+        [EVAL_IR_MAIN_PATH, '--random_inputs=3000', '--optimize_ir']
+        + backend
+        + [ir_file.full_path]
+    ).decode('utf-8')
+    threaded = subprocess.check_output(
+        [
+            EVAL_IR_MAIN_PATH,
+            '--random_inputs=3000',
+            '--optimize_ir',
+            '--threads=4',
+        ]
+        + backend
+        + [ir_file.full_path]
+    ).decode('utf-8')
+    # The single threaded run prints the results before and after
+    # optimizations; the threaded run prints each result once, in order.
+    self.assertLen(threaded.strip().split('\n'), 3000)
+    self.assertEqual(threaded * 2, single_thread)
+
+  def test_threads_with_failed_expected_file(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile(
+        content='\n'.join(
+            ['bits[32]:0x42; bits[32]:0x123'] * 2000
+            + ['bits[32]:0x10; bits[32]:0x00']
+        )
+    )
+    expected_file = self.create_tempfile(
+        content='\n'.join(['bits[32]:0x165'] * 2001)
+    )
+    comp = subprocess.run(
+        [
+            EVAL_IR_MAIN_PATH,
+            '--threads=4',
+            '--input_file=' + input_file.full_path,
+            '--expected_file=' + expected_file.full_path,
+            ir_file.full_path,
+        ],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        check=False,
+    )
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn(
+        'Miscompare for input[2000] "bits[32]:0x10; bits[32]:0x0"',
+        comp.stderr.decode('utf-8'),
+    )
+    self.assertLen(comp.stdout.decode('utf-8').strip().split('\n'), 2001)
+
   def test_jit_result_injection(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     result = subprocess.check_output([
@@ -349,6 +402,46 @@ class EvalMainTest(parameterized.TestCase):
     self.assertNotEqual(comp.returncode, 0)
     self.assertIn('Unable to generate valid input', comp.stderr.decode('utf-8'))
 
+  def test_node_profile(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    comp = subprocess.run(
+        [
+            EVAL_IR_MAIN_PATH,
+            ir_file.full_path,
+            '--input',
+            'bits[32]:0x5; bits[32]:0xC',
+            '--expected=bits[32]:0x11',
+            '--node_profile',
+            '--use_llvm_jit',
+        ],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        check=True,
+    )
+    self.assertEqual(comp.stdout.decode('utf-8').strip(), 'bits[32]:0x11')
+    stderr = comp.stderr.decode('utf-8')
+    self.assertIn('Node profile:', stderr)
+    self.assertIn('foo::add.1 (add)', stderr)
+
+  def test_node_profile_requires_jit(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    comp = subprocess.run(
+        [
+            EVAL_IR_MAIN_PATH,
+            ir_file.full_path,
+            '--input',
+            'bits[32]:0x5; bits[32]:0xC',
+            '--node_profile',
+            '--nouse_llvm_jit',
+        ],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        check=False,
+    )
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('--node_profile requires --use_llvm_jit',
+                  comp.stderr.decode('utf-8'))
+
   @parameterized_proc_backends
   def test_coverage(self, backend):
     ir_file = self.create_tempfile(content=ADD_IR)
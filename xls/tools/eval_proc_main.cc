@@ -15,6 +15,7 @@
 // Tool to evaluate the behavior of a Proc network.
 
 #include <algorithm>
+#include <cstring>
 #include <cstdint>
 #include <deque>
 #include <iostream>
@@ -57,9 +58,13 @@
 #include "xls/dev_tools/tool_timeout.h"
 #include "xls/interpreter/block_evaluator.h"
 #include "xls/interpreter/block_interpreter.h"
+#include "xls/interpreter/channel_occupancy.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_profile.h"
+#include "xls/interpreter/proc_runtime_profile.pb.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
@@ -77,8 +82,12 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 #include "xls/jit/block_jit.h"
+#include "xls/jit/channel_stream.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_node_coverage.h"
 #include "xls/jit/jit_proc_runtime.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/node_profiler.h"
 #include "xls/tools/eval_utils.h"
 #include "xls/tools/memory_models.h"
 #include "xls/tools/node_coverage_utils.h"
@@ -105,6 +114,8 @@ ABSL_FLAG(std::vector<std::string>, ticks, {},
 ABSL_FLAG(std::string, backend, "serial_jit",
           "Backend to use for evaluation. Valid options are:\n"
           " * serial_jit: JIT-backed single-stepping runtime.\n"
+          " * parallel_jit: JIT-backed runtime which ticks procs on a pool of "
+          "worker threads.\n"
           " * ir_interpreter: Interpreter at the IR level.\n"
           " * block_interpreter: Interpret a block generated from a proc.\n"
           " * block_jit: JIT-backed block execution generated from a proc.");
@@ -171,6 +182,28 @@ ABSL_FLAG(
     "Path to file containing ProcChannelValuesProto binary proto of outputs "
     "for all channels.");
 
+ABSL_FLAG(
+    std::vector<std::string>, stream_inputs_for_channels, {},
+    "Comma separated list of channel=filename pairs of binary channel streams "
+    "(see xls/jit/channel_stream.h) to feed to input channels. Streams are "
+    "memory-mapped and fed to the channel queues in batches of "
+    "--stream_batch_size elements so memory use is bounded regardless of the "
+    "stream length. May be combined with the other input flags for other "
+    "channels. Requires a JIT backend.");
+ABSL_FLAG(
+    std::vector<std::string>, expected_stream_outputs_for_channels, {},
+    "Comma separated list of channel=filename pairs of binary channel streams "
+    "holding the expected values of output channels. Outputs are compared as "
+    "they are produced and are not retained. Requires a JIT backend.");
+ABSL_FLAG(
+    std::vector<std::string>, stream_outputs_for_channels, {},
+    "Comma separated list of channel=filename pairs. Values produced on each "
+    "channel are written to the named file as a binary channel stream as "
+    "they are produced. Requires a JIT backend.");
+ABSL_FLAG(int64_t, stream_batch_size, 1024,
+          "Maximum number of elements fed to (or drained from) a channel queue "
+          "at once when using channel streams.");
+
 ABSL_FLAG(int64_t, random_seed, 42, "Random seed");
 ABSL_FLAG(double, prob_input_valid_assert, 1.0,
           "Single-cycle probability of asserting valid with more input ready.");
@@ -182,6 +215,10 @@ ABSL_FLAG(int64_t, max_trace_verbosity, 0,
           "Maximum verbosity for traces. Traces with higher verbosity are "
           "stripped from codegen output. 0 by default.");
 ABSL_FLAG(int64_t, trace_per_ticks, 100, "Print a trace every N ticks.");
+ABSL_FLAG(bool, fuse_proc_chains, false,
+          "For the serial_jit and ir_interpreter backends, run the receiver of "
+          "a channel between two procs as soon as data is sent on it. Speeds "
+          "up long chains of procs without changing the values they produce.");
 ABSL_FLAG(std::string, output_stats_path, "", "File to output statistics to.");
 ABSL_FLAG(bool, fail_on_assert, false,
           "When set to true, the simulation fails on the activation or cycle "
@@ -194,13 +231,56 @@ ABSL_FLAG(std::optional<std::string>, output_node_coverage_stats_textproto,
           std::nullopt,
           "File to write a (text) NodeCoverageStatsProto showing which bits "
           "in the run were actually set for each node.");
+ABSL_FLAG(bool, native_jit_node_coverage, false,
+          "When collecting node coverage of procs with the JIT, record it "
+          "directly in the jitted code rather than through observer "
+          "callbacks. This is much faster. Blocks always use observers.");
 ABSL_FLAG(bool, abstract_ram_model, false,
           "Whether or not to use an abstract RAM model, as opposed to a "
           "rewritten RAM model, for proc memory.\n");
+ABSL_FLAG(int64_t, ram_model_read_ports, 0,
+          "Maximum number of read requests the abstract RAM model services "
+          "per tick. Zero means unlimited. Requires --use_jit.");
+ABSL_FLAG(int64_t, ram_model_write_ports, 0,
+          "Maximum number of write requests the abstract RAM model services "
+          "per tick. Zero means unlimited. Requires --use_jit.");
+ABSL_FLAG(int64_t, ram_model_latency, 0,
+          "Number of ticks the abstract RAM model delays each response. "
+          "Requires --use_jit.");
 ABSL_FLAG(std::string, ram_rewrites_textproto, "",
           "Path to ram rewrites textproto, which is used to create memory "
           "models. Blank is default, in which case no memory models are added "
           "to the simulation.");
+ABSL_FLAG(bool, node_profile, false,
+          "Profile the evaluation and print a report of the nodes which take "
+          "the most cycles to stderr. The profiled code reads the cycle "
+          "counter around each node so it runs somewhat slower than "
+          "unprofiled code. Requires a JIT backend.");
+ABSL_FLAG(int64_t, node_profile_max_nodes, 25,
+          "Maximum number of nodes to list in the --node_profile report.");
+ABSL_FLAG(bool, channel_occupancy, false,
+          "Record the occupancy of the internal channels of the proc network "
+          "and print a report of the maximum occupancy and the number of ticks "
+          "each channel held unconsumed data to stderr.");
+ABSL_FLAG(std::optional<std::string>, output_fifo_sized_ir, std::nullopt,
+          "If set, record the occupancy of the internal channels of the proc "
+          "network and write the IR to this file with the FIFO depth of each "
+          "internal channel set to its maximum observed occupancy. The depths "
+          "are only as representative as the stimulus.");
+ABSL_FLAG(std::optional<std::string>, output_proc_profile_proto, std::nullopt,
+          "Output path for a binary ProcNetworkProfileProto recording the "
+          "activations and blocked ticks of each proc instance and the "
+          "occupancy and throughput of each channel instance.");
+ABSL_FLAG(std::optional<std::string>, output_proc_profile_textproto,
+          std::nullopt,
+          "Output path for a text ProcNetworkProfileProto recording the "
+          "activations and blocked ticks of each proc instance and the "
+          "occupancy and throughput of each channel instance.");
+ABSL_FLAG(std::optional<std::string>, output_proc_profile_trace_json,
+          std::nullopt,
+          "Output path for a Chrome trace event JSON file (viewable in "
+          "chrome://tracing or Perfetto) showing when each proc instance was "
+          "blocked and the occupancy of each channel instance over time.");
 
 namespace xls {
 
@@ -226,13 +306,218 @@ static absl::Status LogInterpreterEvents(std::string_view entity_name,
   return absl::OkStatus();
 }
 
+static absl::Status CheckNodeProfileFlags(bool use_jit) {
+  if (absl::GetFlag(FLAGS_node_profile) && !use_jit) {
+    return absl::InvalidArgumentError("--node_profile requires a JIT backend.");
+  }
+  return absl::OkStatus();
+}
+
 struct EvaluateProcsOptions {
   bool use_jit = false;
+  // Only meaningful when `use_jit` is true.
+  bool use_parallel_runtime = false;
   bool fail_on_assert = false;
   std::vector<int64_t> ticks = {-1};
   std::optional<std::string> top = std::nullopt;
+  // Channel name to path of binary channel streams. Only supported with the
+  // JIT.
+  absl::flat_hash_map<std::string, std::string> stream_inputs;
+  absl::flat_hash_map<std::string, std::string> expected_stream_outputs;
+  absl::flat_hash_map<std::string, std::string> stream_outputs;
+  int64_t stream_batch_size = 1024;
+};
+
+// An input channel fed from a channel stream.
+struct InputChannelStream {
+  std::string channel_name;
+  JitChannelQueue* queue;
+  std::unique_ptr<ChannelStreamReader> reader;
+  // Index of the next element of the stream to feed to the queue.
+  int64_t next = 0;
+};
+
+// An output channel drained into a channel stream and/or checked against a
+// stream of expected values.
+struct OutputChannelStream {
+  std::string channel_name;
+  JitChannelQueue* queue;
+  std::unique_ptr<ChannelStreamWriter> writer;
+  std::unique_ptr<ChannelStreamReader> expected;
+  // Number of values drained from the queue.
+  int64_t count = 0;
+};
+
+struct ChannelStreams {
+  std::vector<InputChannelStream> inputs;
+  std::vector<OutputChannelStream> outputs;
+
+  bool empty() const { return inputs.empty() && outputs.empty(); }
 };
 
+static absl::StatusOr<JitChannelQueue*> GetStreamQueue(
+    JitChannelQueueManager* queue_manager, std::string_view channel_name) {
+  XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                       queue_manager->GetQueueByName(channel_name));
+  if (queue->channel()->kind() != ChannelKind::kStreaming) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel streams are only supported for streaming channels; channel "
+        "`%s` is not streaming",
+        channel_name));
+  }
+  return dynamic_cast<JitChannelQueue*>(queue);
+}
+
+static absl::StatusOr<ChannelStreams> OpenChannelStreams(
+    ProcRuntime* runtime, const EvaluateProcsOptions& options) {
+  ChannelStreams streams;
+  if (options.stream_inputs.empty() &&
+      options.expected_stream_outputs.empty() &&
+      options.stream_outputs.empty()) {
+    return streams;
+  }
+  absl::StatusOr<JitChannelQueueManager*> queue_manager =
+      runtime->GetJitChannelQueueManager();
+  if (!queue_manager.ok()) {
+    return absl::InvalidArgumentError(
+        "Channel streams require a JIT backend (serial_jit or parallel_jit).");
+  }
+  for (const auto& [channel_name, path] : options.stream_inputs) {
+    XLS_ASSIGN_OR_RETURN(JitChannelQueue * queue,
+                         GetStreamQueue(*queue_manager, channel_name));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelStreamReader> reader,
+                         ChannelStreamReader::Open(path, queue->type_layout()));
+    streams.inputs.push_back(InputChannelStream{.channel_name = channel_name,
+                                                .queue = queue,
+                                                .reader = std::move(reader)});
+  }
+  absl::btree_map<std::string, OutputChannelStream> outputs;
+  for (const auto& [channel_name, path] : options.expected_stream_outputs) {
+    XLS_ASSIGN_OR_RETURN(JitChannelQueue * queue,
+                         GetStreamQueue(*queue_manager, channel_name));
+    OutputChannelStream& output = outputs[channel_name];
+    output.channel_name = channel_name;
+    output.queue = queue;
+    XLS_ASSIGN_OR_RETURN(output.expected,
+                         ChannelStreamReader::Open(path, queue->type_layout()));
+  }
+  for (const auto& [channel_name, path] : options.stream_outputs) {
+    XLS_ASSIGN_OR_RETURN(JitChannelQueue * queue,
+                         GetStreamQueue(*queue_manager, channel_name));
+    OutputChannelStream& output = outputs[channel_name];
+    output.channel_name = channel_name;
+    output.queue = queue;
+    XLS_ASSIGN_OR_RETURN(output.writer, ChannelStreamWriter::Create(
+                                            path, queue->type_layout()));
+  }
+  for (auto& [_, output] : outputs) {
+    streams.outputs.push_back(std::move(output));
+  }
+  return streams;
+}
+
+// Tops up the queues of input channel streams to `batch_size` elements.
+static void FeedInputStreams(ChannelStreams& streams, int64_t batch_size) {
+  std::vector<uint8_t> staging;
+  for (InputChannelStream& input : streams.inputs) {
+    int64_t count =
+        std::min(batch_size - input.queue->GetSize(),
+                 input.reader->element_count() - input.next);
+    if (count <= 0) {
+      continue;
+    }
+    int64_t stride = input.queue->raw_element_stride();
+    if (input.reader->element_stride() == stride) {
+      input.queue->WriteRawN(input.reader->element(input.next), count);
+    } else {
+      staging.resize(count * stride);
+      for (int64_t i = 0; i < count; ++i) {
+        memcpy(staging.data() + i * stride,
+               input.reader->element(input.next + i),
+               input.queue->type_layout().size());
+      }
+      input.queue->WriteRawN(staging.data(), count);
+    }
+    input.next += count;
+    input.reader->ReleaseBefore(input.next);
+  }
+}
+
+// Drains the queues of output channel streams, recording the values and
+// comparing them against the expected values. Values beyond the end of the
+// expected stream are not checked.
+static absl::Status DrainOutputStreams(ChannelStreams& streams,
+                                       int64_t batch_size) {
+  std::vector<uint8_t> buffer;
+  for (OutputChannelStream& output : streams.outputs) {
+    int64_t stride = output.queue->raw_element_stride();
+    const TypeLayout& layout = output.queue->type_layout();
+    buffer.resize(batch_size * stride);
+    while (int64_t count = output.queue->ReadRawN(buffer.data(), batch_size)) {
+      if (output.writer != nullptr) {
+        XLS_RETURN_IF_ERROR(output.writer->Write(buffer.data(), count, stride));
+      }
+      if (output.expected != nullptr) {
+        int64_t checked =
+            std::min(count, output.expected->element_count() - output.count);
+        for (int64_t i = 0; i < checked; ++i) {
+          const uint8_t* actual = buffer.data() + i * stride;
+          const uint8_t* expected = output.expected->element(output.count + i);
+          if (memcmp(actual, expected, layout.size()) != 0) {
+            return absl::UnknownError(absl::StrFormat(
+                "Outputs did not match expectations:\n\nMismatched "
+                "(channel=%s) after %d outputs (%s != %s)",
+                output.channel_name, output.count + i,
+                layout.NativeLayoutToValue(expected).ToString(),
+                layout.NativeLayoutToValue(actual).ToString()));
+          }
+        }
+        output.expected->ReleaseBefore(output.count + checked);
+      }
+      output.count += count;
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Returns whether all expected stream outputs have been produced.
+static bool AllStreamOutputsProduced(const ChannelStreams& streams) {
+  return absl::c_all_of(
+      streams.outputs, [](const OutputChannelStream& output) {
+        return output.expected == nullptr ||
+               output.count >= output.expected->element_count();
+      });
+}
+
+// Creates the abstract RAM model for `ram_rewrite`. When running on the JIT
+// the native model is used unless the RAM's channel layouts are unsupported.
+static absl::StatusOr<std::unique_ptr<memory_model::ProcMemoryModel>>
+CreateAbstractRamModel(
+    const RamRewriteProto& ram_rewrite, ProcRuntime& runtime, bool use_jit,
+    const memory_model::NativeMemoryModelOptions& native_options) {
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(JitChannelQueueManager * jit_queue_manager,
+                         runtime.GetJitChannelQueueManager());
+    absl::StatusOr<std::unique_ptr<memory_model::ProcMemoryModel>>
+        native_model = memory_model::CreateNativeAbstractProcMemoryModel(
+            ram_rewrite, *jit_queue_manager, native_options);
+    if (!absl::IsUnimplemented(native_model.status())) {
+      return native_model;
+    }
+    VLOG(1) << "Using Value-based RAM model for "
+            << ram_rewrite.to_name_prefix() << ": " << native_model.status();
+  }
+  if (native_options.read_ports != 0 || native_options.write_ports != 0 ||
+      native_options.latency != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "RAM port and latency modeling is only supported by the native RAM "
+        "model which requires --use_jit (RAM %s)",
+        ram_rewrite.to_name_prefix()));
+  }
+  return memory_model::CreateAbstractProcMemoryModel(ram_rewrite,
+                                                     runtime.queue_manager());
+}
+
 static absl::Status EvaluateProcs(
     Package* package,
     const absl::btree_map<std::string, std::vector<Value>>& inputs_for_channels,
@@ -240,13 +525,22 @@ static absl::Status EvaluateProcs(
         expected_outputs_for_channels,
     const RamRewritesProto& ram_rewrites,
     const EvaluateProcsOptions& options = {}) {
-  std::unique_ptr<SerialProcRuntime> runtime;
+  // Declared before the runtime as the jitted code references them.
+  JitNodeCoverage native_coverage;
+  NodeProfiler profiler;
+  std::unique_ptr<ProcRuntime> runtime;
   std::optional<JitRuntime*> jit;
   EvaluatorOptions evaluator_options;
   evaluator_options.set_trace_channels(absl::GetFlag(FLAGS_trace_channels));
-  bool uses_observers =
+  evaluator_options.set_fuse_proc_chains(
+      absl::GetFlag(FLAGS_fuse_proc_chains));
+  bool collect_coverage =
       absl::GetFlag(FLAGS_output_node_coverage_stats_proto).has_value() ||
       absl::GetFlag(FLAGS_output_node_coverage_stats_textproto).has_value();
+  bool use_native_coverage = collect_coverage && options.use_jit &&
+                             absl::GetFlag(FLAGS_native_jit_node_coverage);
+  bool uses_observers = collect_coverage && !use_native_coverage;
+  XLS_RETURN_IF_ERROR(CheckNodeProfileFlags(options.use_jit));
   if (options.top) {
     XLS_ASSIGN_OR_RETURN(Proc * proc, package->GetProc(*options.top));
     if (proc != package->GetTop()) {
@@ -255,7 +549,18 @@ static absl::Status EvaluateProcs(
     }
   }
   evaluator_options.set_support_observers(uses_observers);
-  if (options.use_jit) {
+  if (use_native_coverage) {
+    evaluator_options.set_jit_node_coverage(&native_coverage);
+  }
+  if (absl::GetFlag(FLAGS_node_profile)) {
+    evaluator_options.set_jit_node_profiler(&profiler);
+  }
+  if (options.use_jit && options.use_parallel_runtime) {
+    XLS_ASSIGN_OR_RETURN(
+        runtime, CreateJitParallelProcRuntime(package, evaluator_options));
+    XLS_ASSIGN_OR_RETURN(auto jit_queue, runtime->GetJitChannelQueueManager());
+    jit = &jit_queue->runtime();
+  } else if (options.use_jit) {
     XLS_ASSIGN_OR_RETURN(
         runtime, CreateJitSerialProcRuntime(package, evaluator_options));
     XLS_ASSIGN_OR_RETURN(auto jit_queue, runtime->GetJitChannelQueueManager());
@@ -267,16 +572,37 @@ static absl::Status EvaluateProcs(
   ScopedRecordNodeCoverage cov(
       absl::GetFlag(FLAGS_output_node_coverage_stats_proto),
       absl::GetFlag(FLAGS_output_node_coverage_stats_textproto), jit);
-  if (cov.observer()) {
+  if (use_native_coverage) {
+    cov.AddJitCoverage(&native_coverage);
+  } else if (cov.observer()) {
     XLS_RETURN_IF_ERROR(runtime->SetObserver(*cov.observer()));
     LOG(ERROR) << "Set observer!";
   }
-
   ChannelQueueManager& queue_manager = runtime->queue_manager();
 
+  const bool proc_profile =
+      absl::GetFlag(FLAGS_output_proc_profile_proto).has_value() ||
+      absl::GetFlag(FLAGS_output_proc_profile_textproto).has_value() ||
+      absl::GetFlag(FLAGS_output_proc_profile_trace_json).has_value();
+  if (proc_profile) {
+    runtime->EnableProfiling(
+        /*record_timeline=*/absl::GetFlag(FLAGS_output_proc_profile_trace_json)
+            .has_value());
+  }
+
+  std::unique_ptr<ChannelOccupancyTracker> occupancy_tracker;
+  if (absl::GetFlag(FLAGS_channel_occupancy) ||
+      absl::GetFlag(FLAGS_output_fifo_sized_ir).has_value()) {
+    occupancy_tracker = ChannelOccupancyTracker::Create(queue_manager);
+  }
+
   std::vector<std::unique_ptr<memory_model::ProcMemoryModel>> memory_models;
 
   const bool abstract_ram_model = absl::GetFlag(FLAGS_abstract_ram_model);
+  const memory_model::NativeMemoryModelOptions native_ram_options{
+      .read_ports = absl::GetFlag(FLAGS_ram_model_read_ports),
+      .write_ports = absl::GetFlag(FLAGS_ram_model_write_ports),
+      .latency = absl::GetFlag(FLAGS_ram_model_latency)};
 
   for (const RamRewriteProto& ram_rewrite : ram_rewrites.rewrites()) {
     XLS_RET_CHECK(ram_rewrite.has_to_config());
@@ -287,9 +613,10 @@ static absl::Status EvaluateProcs(
     std::unique_ptr<memory_model::ProcMemoryModel> memory_model;
 
     if (abstract_ram_model) {
-      XLS_ASSIGN_OR_RETURN(memory_model,
-                           memory_model::CreateAbstractProcMemoryModel(
-                               ram_rewrite, queue_manager));
+      XLS_ASSIGN_OR_RETURN(
+          memory_model, CreateAbstractRamModel(ram_rewrite, *runtime,
+                                               options.use_jit,
+                                               native_ram_options));
     } else if (ram_rewrite.to_config().kind() == RamKindProto::RAM_1RW) {
       XLS_ASSIGN_OR_RETURN(memory_model,
                            memory_model::CreateRewrittenProcMemoryModel(
@@ -307,14 +634,20 @@ static absl::Status EvaluateProcs(
   for (const auto& [channel_name, values] : inputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
                          queue_manager.GetQueueByName(channel_name));
-    for (const Value& value : values) {
-      XLS_RETURN_IF_ERROR(in_queue->Write(value));
-    }
+    XLS_RETURN_IF_ERROR(in_queue->WriteValues(values));
     if (absl::GetFlag(FLAGS_show_trace)) {
       LOG(INFO) << "Channel " << channel_name << " has " << values.size()
                 << " inputs";
     }
   }
+  XLS_ASSIGN_OR_RETURN(ChannelStreams streams,
+                       OpenChannelStreams(runtime.get(), options));
+  if (absl::GetFlag(FLAGS_show_trace)) {
+    for (const InputChannelStream& input : streams.inputs) {
+      LOG(INFO) << "Channel " << input.channel_name << " has "
+                << input.reader->element_count() << " streamed inputs";
+    }
+  }
   if (absl::GetFlag(FLAGS_show_trace)) {
     for (const auto& [channel_name, values] : expected_outputs_for_channels) {
       LOG(INFO) << "Channel " << channel_name << " has " << values.size()
@@ -351,6 +684,7 @@ static absl::Status EvaluateProcs(
       }
       // Don't double print events (traces, assertions, etc)
       runtime->ClearInterpreterEvents();
+      FeedInputStreams(streams, options.stream_batch_size);
       absl::Status tick_ret = runtime->Tick();
 
       if (!tick_ret.ok()) {
@@ -378,6 +712,11 @@ static absl::Status EvaluateProcs(
            memory_models) {
         XLS_RETURN_IF_ERROR(memory->Tick());
       }
+      if (occupancy_tracker != nullptr) {
+        occupancy_tracker->RecordTick();
+      }
+      XLS_RETURN_IF_ERROR(
+          DrainOutputStreams(streams, options.stream_batch_size));
 
       // Sort the keys for stable print order.
       absl::flat_hash_map<Proc*, std::vector<Value>> states;
@@ -429,6 +768,9 @@ static absl::Status EvaluateProcs(
             all_outputs_produced = false;
           }
         }
+        if (!AllStreamOutputsProduced(streams)) {
+          all_outputs_produced = false;
+        }
         if (all_outputs_produced) {
           absl::btree_map<std::string, std::vector<Value>> unconsumed_inputs;
           for (const auto& [channel_name, _] : inputs_for_channels) {
@@ -438,8 +780,9 @@ static absl::Status EvaluateProcs(
             if (in_queue->channel()->kind() == ChannelKind::kSingleValue) {
               continue;
             }
-            while (!in_queue->IsEmpty()) {
-              unconsumed_inputs[channel_name].push_back(*in_queue->Read());
+            if (!in_queue->IsEmpty()) {
+              unconsumed_inputs[channel_name] =
+                  in_queue->ReadValues(in_queue->GetSize());
             }
           }
           if (!unconsumed_inputs.empty()) {
@@ -455,24 +798,56 @@ static absl::Status EvaluateProcs(
   }
   absl::Duration elapsed_time = absl::Now() - start_time;
   LOG(INFO) << "Elapsed time: " << elapsed_time;
+  if (absl::GetFlag(FLAGS_node_profile)) {
+    std::cerr << profiler.ToString(absl::GetFlag(FLAGS_node_profile_max_nodes));
+  }
+  if (absl::GetFlag(FLAGS_channel_occupancy)) {
+    std::cerr << occupancy_tracker->ToString();
+  }
+  if (std::optional<std::string> path =
+          absl::GetFlag(FLAGS_output_fifo_sized_ir)) {
+    XLS_ASSIGN_OR_RETURN(
+        int64_t changed,
+        ApplyFifoDepths(occupancy_tracker->GetMaxOccupancyByChannel()));
+    LOG(INFO) << "Resized the FIFOs of " << changed << " channels";
+    XLS_RETURN_IF_ERROR(SetFileContents(*path, package->DumpIr()));
+  }
+  if (proc_profile) {
+    XLS_ASSIGN_OR_RETURN(ProcNetworkProfileProto profile,
+                         runtime->GetProfile());
+    if (std::optional<std::string> path =
+            absl::GetFlag(FLAGS_output_proc_profile_proto)) {
+      XLS_RETURN_IF_ERROR(SetProtobinFile(*path, profile));
+    }
+    if (std::optional<std::string> path =
+            absl::GetFlag(FLAGS_output_proc_profile_textproto)) {
+      XLS_RETURN_IF_ERROR(SetTextProtoFile(*path, profile));
+    }
+    if (std::optional<std::string> path =
+            absl::GetFlag(FLAGS_output_proc_profile_trace_json)) {
+      XLS_RETURN_IF_ERROR(
+          SetFileContents(*path, ProcNetworkProfileToChromeTrace(profile)));
+    }
+  }
   bool checked_any_output = false;
   std::vector<std::string> errors;
   for (const auto& [channel_name, values] : expected_outputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
                          queue_manager.GetQueueByName(channel_name));
+    std::vector<Value> out_vals = out_queue->ReadValues(values.size());
     uint64_t processed_count = 0;
     for (const Value& value : values) {
-      std::optional<Value> out_val = out_queue->Read();
-      if (!out_val.has_value()) {
+      if (processed_count >= out_vals.size()) {
         errors.push_back(absl::StrFormat(
             "Channel %s didn't consume %d expected values (processed %d)",
             channel_name, values.size() - processed_count, processed_count));
         break;
       }
-      if (value != *out_val) {
+      const Value& out_val = out_vals[processed_count];
+      if (value != out_val) {
         errors.push_back(absl::StrFormat(
             "Mismatched (channel=%s) after %d outputs (%s != %s)", channel_name,
-            processed_count, value.ToString(), out_val->ToString()));
+            processed_count, value.ToString(), out_val.ToString()));
         break;
       }
       if (absl::GetFlag(FLAGS_show_trace)) {
@@ -483,6 +858,26 @@ static absl::Status EvaluateProcs(
       ++processed_count;
     }
   }
+  for (OutputChannelStream& output : streams.outputs) {
+    if (output.expected != nullptr) {
+      if (output.count < output.expected->element_count()) {
+        errors.push_back(absl::StrFormat(
+            "Channel %s didn't produce %d expected streamed values (processed "
+            "%d)",
+            output.channel_name,
+            output.expected->element_count() - output.count, output.count));
+      } else {
+        checked_any_output = true;
+      }
+    }
+    if (output.writer != nullptr) {
+      XLS_RETURN_IF_ERROR(output.writer->Close());
+      if (absl::GetFlag(FLAGS_show_trace)) {
+        LOG(INFO) << "Channel " << output.channel_name << " streamed "
+                  << output.count << " outputs";
+      }
+    }
+  }
   if (!errors.empty()) {
     return absl::UnknownError(
         absl::StrFormat("Outputs did not match expectations:\n\n%s",
@@ -492,21 +887,16 @@ static absl::Status EvaluateProcs(
     return absl::UnknownError("No output verified (empty expected values?)");
   }
 
-  if (expected_outputs_for_channels.empty()) {
+  if (expected_outputs_for_channels.empty() && streams.outputs.empty()) {
     for (const Channel* channel : package->channels()) {
       if (!channel->CanSend()) {
         continue;
       }
       XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
                            queue_manager.GetQueueByName(channel->name()));
-      std::vector<Value> channel_values(out_queue->GetSize());
-      int64_t index = 0;
-      while (!out_queue->IsEmpty()) {
-        std::optional<Value> out_val = out_queue->Read();
-        channel_values[index++] = out_val.value();
-      }
       expected_outputs_for_channels.insert(
-          {std::string{channel->name()}, channel_values});
+          {std::string{channel->name()},
+           out_queue->ReadValues(out_queue->GetSize())});
     }
     std::cout << ChannelValuesToString(expected_outputs_for_channels);
   }
@@ -802,12 +1192,18 @@ static absl::Status RunBlock(
   bool needs_observer =
       absl::GetFlag(FLAGS_output_node_coverage_stats_proto).has_value() ||
       absl::GetFlag(FLAGS_output_node_coverage_stats_textproto).has_value();
+  XLS_RETURN_IF_ERROR(CheckNodeProfileFlags(options.use_jit));
+  // Declared before the continuation as the jitted code references it.
+  NodeProfiler profiler;
+  const JitBlockEvaluator profiled_jit_evaluator(needs_observer, &profiler);
+  const JitBlockEvaluator& jit_evaluator =
+      absl::GetFlag(FLAGS_node_profile) ? profiled_jit_evaluator
+      : needs_observer                  ? kObservableJitBlockEvaluator
+                                        : kJitBlockEvaluator;
   const BlockEvaluator& continuation_factory =
-      options.use_jit
-          ? reinterpret_cast<const BlockEvaluator&>(
-                needs_observer ? kObservableJitBlockEvaluator
-                               : kJitBlockEvaluator)
-          : reinterpret_cast<const BlockEvaluator&>(kInterpreterBlockEvaluator);
+      options.use_jit ? reinterpret_cast<const BlockEvaluator&>(jit_evaluator)
+                      : reinterpret_cast<const BlockEvaluator&>(
+                            kCompiledInterpreterBlockEvaluator);
   XLS_ASSIGN_OR_RETURN(auto continuation,
                        continuation_factory.NewContinuation(block, reg_state));
   std::optional<JitRuntime*> jit;
@@ -822,7 +1218,6 @@ static absl::Status RunBlock(
   if (cov.observer()) {
     XLS_RETURN_IF_ERROR(continuation->SetObserver(*cov.observer()));
   }
-
   int64_t last_output_cycle = 0;
   int64_t matched_outputs = 0;
   bool checked_any_output = false;
@@ -836,6 +1231,7 @@ static absl::Status RunBlock(
     // We don't want the cycle where we are initially resetting the registers to
     // be counted in coverage since its unlikely to be valuable.
     cov.SetPaused(resetting);
+    profiler.SetPaused(resetting);
 
     if (options.show_trace && ((cycle < 30) || (cycle % 100 == 0))) {
       LOG(INFO) << "Cycle[" << cycle << "]: resetting? " << resetting
@@ -1044,6 +1440,9 @@ static absl::Status RunBlock(
 
   absl::Duration elapsed_time = absl::Now() - start_time;
   LOG(INFO) << "Elapsed time: " << elapsed_time;
+  if (absl::GetFlag(FLAGS_node_profile)) {
+    std::cerr << profiler.ToString(absl::GetFlag(FLAGS_node_profile_max_nodes));
+  }
 
   absl::btree_map<std::string, std::vector<Value>> unconsumed_inputs;
   for (const auto& [channel_name, _] : inputs_for_channels) {
@@ -1174,6 +1573,12 @@ static absl::Status RealMain(
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
 
   if (backend.starts_with("block")) {
+    if (!absl::GetFlag(FLAGS_stream_inputs_for_channels).empty() ||
+        !absl::GetFlag(FLAGS_expected_stream_outputs_for_channels).empty() ||
+        !absl::GetFlag(FLAGS_stream_outputs_for_channels).empty()) {
+      return absl::InvalidArgumentError(
+          "Channel streams are not supported for block simulation.");
+    }
     RunBlockOptions block_options = {
         .ticks = ticks,
         .max_cycles_no_output = max_cycles_no_output,
@@ -1201,10 +1606,26 @@ static absl::Status RealMain(
       .fail_on_assert = fail_on_assert,
       .ticks = ticks,
       .top = absl::GetFlag(FLAGS_top),
+      .stream_batch_size = absl::GetFlag(FLAGS_stream_batch_size),
   };
+  XLS_ASSIGN_OR_RETURN(
+      evaluate_procs_options.stream_inputs,
+      ParseChannelFilenames(absl::GetFlag(FLAGS_stream_inputs_for_channels)));
+  XLS_ASSIGN_OR_RETURN(evaluate_procs_options.expected_stream_outputs,
+                       ParseChannelFilenames(absl::GetFlag(
+                           FLAGS_expected_stream_outputs_for_channels)));
+  XLS_ASSIGN_OR_RETURN(
+      evaluate_procs_options.stream_outputs,
+      ParseChannelFilenames(absl::GetFlag(FLAGS_stream_outputs_for_channels)));
+  if (evaluate_procs_options.stream_batch_size <= 0) {
+    return absl::InvalidArgumentError("--stream_batch_size must be positive.");
+  }
 
   if (backend == "serial_jit") {
     evaluate_procs_options.use_jit = true;
+  } else if (backend == "parallel_jit") {
+    evaluate_procs_options.use_jit = true;
+    evaluate_procs_options.use_parallel_runtime = true;
   } else if (backend == "ir_interpreter") {
     evaluate_procs_options.use_jit = false;
   } else {
@@ -1226,8 +1647,9 @@ int main(int argc, char* argv[]) {
   }
 
   std::string backend = absl::GetFlag(FLAGS_backend);
-  if (backend != "serial_jit" && backend != "ir_interpreter" &&
-      backend != "block_interpreter" && backend != "block_jit") {
+  if (backend != "serial_jit" && backend != "parallel_jit" &&
+      backend != "ir_interpreter" && backend != "block_interpreter" &&
+      backend != "block_jit") {
     LOG(QFATAL) << "Unrecognized backend choice.";
   }
 
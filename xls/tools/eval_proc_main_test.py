@@ -23,6 +23,7 @@ from absl.testing import absltest
 from absl.testing import parameterized
 from xls.common import runfiles
 from xls.ir import xls_value_pb2
+from xls.jit import type_layout_pb2
 from xls.tools import node_coverage_stats_pb2
 from xls.tools import proc_channel_values_pb2
 
@@ -374,6 +375,47 @@ def parameterized_proc_backends(func):
   )(func)
 
 
+# Header of a binary channel stream. See xls/jit/channel_stream.h.
+_CHANNEL_STREAM_HEADER = struct.Struct("=8sIIqqq")
+
+
+def _write_bits64_channel_stream(path: str, values) -> None:
+  """Writes `values` as a channel stream of bits[64] values."""
+  layout = type_layout_pb2.TypeLayoutProto(
+      type="bits[64]",
+      size=8,
+      elements=[
+          type_layout_pb2.ElementLayoutProto(
+              offset=0, data_size=8, padded_size=8
+          )
+      ],
+  ).SerializeToString()
+  stride = 16
+  data_offset = -(-(_CHANNEL_STREAM_HEADER.size + len(layout)) // 64) * 64
+  header = _CHANNEL_STREAM_HEADER.pack(
+      b"XLSCHSTM", 1, len(layout), stride, len(values), data_offset
+  )
+  prefix = header + layout
+  with open(path, "wb") as f:
+    f.write(prefix + b"\0" * (data_offset - len(prefix)))
+    for v in values:
+      f.write(struct.pack("=Q", v) + b"\0" * (stride - 8))
+
+
+def _read_bits64_channel_stream(path: str):
+  """Returns the values of a channel stream of bits[64] values."""
+  with open(path, "rb") as f:
+    contents = f.read()
+  magic, _, _, stride, count, data_offset = _CHANNEL_STREAM_HEADER.unpack_from(
+      contents
+  )
+  assert magic == b"XLSCHSTM"
+  return [
+      struct.unpack_from("=Q", contents, data_offset + i * stride)[0]
+      for i in range(count)
+  ]
+
+
 def run_command(args):
   """Runs the command described by args and returns the completion object."""
   # Don't use check=True because we want to print stderr/stdout on failure for a
@@ -435,6 +477,63 @@ class EvalProcTest(parameterized.TestCase):
     output = run_command(shared_args + ["--backend", "serial_jit"])
     self.assertIn("Proc __eval_proc_main_test__test_proc_0_next", output.stderr)
 
+  @parameterized.named_parameters(
+      ("serial_jit", ["--backend", "serial_jit"]),
+      ("parallel_jit", ["--backend", "parallel_jit"]),
+  )
+  def test_channel_streams(self, backend):
+    input_stream = self.create_tempfile()
+    _write_bits64_channel_stream(input_stream.full_path, [42, 101])
+    input_file_2 = self.create_tempfile(content=textwrap.dedent("""
+          bits[64]:10
+          bits[64]:6
+        """))
+    expected_stream = self.create_tempfile()
+    _write_bits64_channel_stream(expected_stream.full_path, [62, 127])
+    output_stream = self.create_tempfile()
+
+    args = [
+        EVAL_PROC_MAIN_PATH,
+        PROC_PATH,
+        "--ticks",
+        "2",
+        "--logtostderr",
+        "--stream_batch_size=1",
+        "--stream_inputs_for_channels",
+        f"eval_proc_main_test__in_ch={input_stream.full_path}",
+        "--inputs_for_channels",
+        f"eval_proc_main_test__in_ch_2={input_file_2.full_path}",
+        "--stream_outputs_for_channels",
+        f"eval_proc_main_test__out_ch_2={output_stream.full_path}",
+    ] + backend
+    run_command(
+        args
+        + [
+            "--expected_stream_outputs_for_channels",
+            f"eval_proc_main_test__out_ch={expected_stream.full_path}",
+        ]
+    )
+    self.assertEqual(
+        _read_bits64_channel_stream(output_stream.full_path), [55, 55]
+    )
+
+    # A mismatch against the expected stream is an error.
+    _write_bits64_channel_stream(expected_stream.full_path, [62, 128])
+    comp = subprocess.run(
+        args
+        + [
+            "--expected_stream_outputs_for_channels",
+            f"eval_proc_main_test__out_ch={expected_stream.full_path}",
+        ],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        encoding="utf-8",
+        check=False,
+    )
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn("Mismatched (channel=eval_proc_main_test__out_ch)",
+                  comp.stderr)
+
   def test_basic_run_until_completed(self):
     input_file = self.create_tempfile(content=textwrap.dedent("""
           bits[64]:42
@@ -1111,7 +1210,14 @@ rewrites {
         24,
     )
 
-  @parameterized_proc_backends
+  @parameterized.named_parameters(
+      ("serial_jit", ["--backend", "serial_jit"]),
+      (
+          "serial_jit_native_coverage",
+          ["--backend", "serial_jit", "--native_jit_node_coverage"],
+      ),
+      ("ir_interpreter", ["--backend", "ir_interpreter"]),
+  )
   def test_observe_proc(self, backend):
     ir_file = self.create_tempfile(content=OBSERVER_IR)
     inp_file = self.create_tempfile(content=OBSERVER_INPUT_CHANNEL_VALUES)
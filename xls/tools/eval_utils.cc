@@ -14,8 +14,10 @@
 
 #include "xls/tools/eval_utils.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -24,22 +26,186 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/btree_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
+#include "xls/ir/xls_type.pb.h"
 #include "xls/ir/xls_value.pb.h"
 #include "xls/tests/testvector.pb.h"
 #include "xls/tools/proc_channel_values.pb.h"
 #include "re2/re2.h"
 
 namespace xls {
+namespace {
+
+// Below this many values parsing is not split across threads.
+constexpr int64_t kMinValuesPerThread = 4096;
+
+// Returns the values produced by `parse(i)` for each i in [0, count). Large
+// counts are split into contiguous chunks parsed on separate threads. If any
+// parse fails the error of the first failing chunk is returned.
+absl::StatusOr<std::vector<Value>> ParallelParse(
+    int64_t count, absl::FunctionRef<absl::StatusOr<Value>(int64_t)> parse) {
+  std::vector<Value> values(count);
+  int64_t thread_count =
+      std::min<int64_t>(count / kMinValuesPerThread, AvailableCPUs());
+  thread_count = std::max<int64_t>(thread_count, 1);
+  std::vector<absl::Status> statuses(thread_count);
+  auto parse_chunk = [&](int64_t chunk) {
+    int64_t end = count * (chunk + 1) / thread_count;
+    for (int64_t i = count * chunk / thread_count; i < end; ++i) {
+      absl::StatusOr<Value> value = parse(i);
+      if (!value.ok()) {
+        statuses[chunk] = value.status();
+        return;
+      }
+      values[i] = *std::move(value);
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count - 1);
+    for (int64_t chunk = 1; chunk < thread_count; ++chunk) {
+      threads.push_back(
+          std::make_unique<Thread>([&, chunk]() { parse_chunk(chunk); }));
+    }
+    parse_chunk(0);
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return values;
+}
+
+absl::StatusOr<std::vector<Value>> ParseTypedValues(
+    absl::Span<const std::string_view> lines) {
+  return ParallelParse(lines.size(), [&](int64_t i) {
+    return Parser::ParseTypedValue(lines[i]);
+  });
+}
+
+// Returns the number of bytes a value of type `type` occupies in the packed
+// encoding of ProcChannelValuesProto.
+absl::StatusOr<int64_t> PackedSize(const TypeProto& type) {
+  switch (type.type_enum()) {
+    case TypeProto::BITS:
+      return (type.bit_count() + 7) / 8;
+    case TypeProto::TUPLE: {
+      int64_t size = 0;
+      for (const TypeProto& element : type.tuple_elements()) {
+        XLS_ASSIGN_OR_RETURN(int64_t element_size, PackedSize(element));
+        size += element_size;
+      }
+      return size;
+    }
+    case TypeProto::ARRAY: {
+      XLS_ASSIGN_OR_RETURN(int64_t element_size,
+                           PackedSize(type.array_element()));
+      return type.array_size() * element_size;
+    }
+    case TypeProto::TOKEN:
+      return 0;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid packed type: %s", type.DebugString()));
+  }
+}
+
+// Appends the packed encoding of `value` to `out`.
+void PackValue(const Value& value, std::string& out) {
+  if (value.IsBits()) {
+    int64_t offset = out.size();
+    out.resize(offset + (value.bits().bit_count() + 7) / 8);
+    value.bits().ToBytes(absl::MakeSpan(
+        reinterpret_cast<uint8_t*>(out.data()) + offset, out.size() - offset));
+    return;
+  }
+  if (value.IsTuple() || value.IsArray()) {
+    for (const Value& element : value.elements()) {
+      PackValue(element, out);
+    }
+  }
+}
+
+// Decodes a value of type `type` from the packed encoding at `data` and
+// advances `data` past it.
+absl::StatusOr<Value> UnpackValue(const TypeProto& type,
+                                  absl::Span<const uint8_t>& data) {
+  switch (type.type_enum()) {
+    case TypeProto::BITS: {
+      int64_t size = (type.bit_count() + 7) / 8;
+      XLS_RET_CHECK_LE(size, data.size());
+      Bits bits = Bits::FromBytes(data.subspan(0, size), type.bit_count());
+      data.remove_prefix(size);
+      return Value(std::move(bits));
+    }
+    case TypeProto::TUPLE: {
+      std::vector<Value> elements;
+      elements.reserve(type.tuple_elements_size());
+      for (const TypeProto& element : type.tuple_elements()) {
+        XLS_ASSIGN_OR_RETURN(Value value, UnpackValue(element, data));
+        elements.push_back(std::move(value));
+      }
+      return Value::Tuple(elements);
+    }
+    case TypeProto::ARRAY: {
+      std::vector<Value> elements;
+      elements.reserve(type.array_size());
+      for (int64_t i = 0; i < type.array_size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(Value value,
+                             UnpackValue(type.array_element(), data));
+        elements.push_back(std::move(value));
+      }
+      return Value::Array(elements);
+    }
+    case TypeProto::TOKEN:
+      return Value::Token();
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid packed type: %s", type.DebugString()));
+  }
+}
+
+absl::StatusOr<std::vector<Value>> UnpackChannelValues(
+    const ProcChannelValuesProto::Channel& channel,
+    std::optional<const int64_t> max_values_count) {
+  XLS_ASSIGN_OR_RETURN(int64_t size, PackedSize(channel.packed_type()));
+  int64_t count = channel.packed_entry_count();
+  if (count < 0 ||
+      (size > 0 && channel.packed_entries().size() / size < count) ||
+      channel.packed_entries().size() != count * size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel %s has %d bytes of packed entries; expected %d entries of %d "
+        "bytes",
+        channel.name(), channel.packed_entries().size(), count, size));
+  }
+  if (max_values_count.has_value()) {
+    count = std::min(count, *max_values_count);
+  }
+  absl::Span<const uint8_t> entries(
+      reinterpret_cast<const uint8_t*>(channel.packed_entries().data()),
+      channel.packed_entries().size());
+  return ParallelParse(count, [&](int64_t i) {
+    absl::Span<const uint8_t> data = entries.subspan(i * size, size);
+    return UnpackValue(channel.packed_type(), data);
+  });
+}
+
+}  // namespace
 
 absl::StatusOr<std::vector<Value>> ParseValuesFile(std::string_view filename,
                                                    int64_t max_lines) {
@@ -48,21 +214,16 @@ absl::StatusOr<std::vector<Value>> ParseValuesFile(std::string_view filename,
   }
 
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(filename));
-  std::vector<Value> ret;
-  int64_t li = 0;
-  for (const auto& line :
+  std::vector<std::string_view> lines;
+  for (std::string_view line :
        absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
-    if (0 == (li % 500)) {
-      VLOG(1) << "Parsing values file at line " << li;
-    }
-    li++;
-    XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(line));
-    ret.push_back(std::move(value));
-    if (li == max_lines) {
+    lines.push_back(line);
+    if (static_cast<int64_t>(lines.size()) == max_lines) {
       break;
     }
   }
-  return ret;
+  VLOG(1) << "Parsing " << lines.size() << " values from " << filename;
+  return ParseTypedValues(lines);
 }
 
 absl::StatusOr<absl::btree_map<std::string, std::vector<Value>>>
@@ -72,10 +233,12 @@ ParseChannelValues(std::string_view all_channel_values,
     kExpectStartOfChannel = 0,
     kParsingChannel,
   };
-  absl::btree_map<std::string, std::vector<Value>> channel_to_values;
+  // The lines of each channel's values are collected first and then parsed
+  // in parallel.
+  absl::btree_map<std::string, std::vector<std::string_view>> channel_to_lines;
   ParseState state = kExpectStartOfChannel;
   std::string channel_name;
-  std::vector<Value> channel_values;
+  std::vector<std::string_view> channel_lines;
   int64_t line_number = 0, values_per_channel = 0;
   for (const auto& line : absl::StrSplit(all_channel_values, '\n')) {
     if (0 == (line_number % 500)) {
@@ -95,7 +258,7 @@ ParseChannelValues(std::string_view all_channel_values,
         }
         std::vector<std::string> strings =
             absl::StrSplit(line, ' ', absl::SkipWhitespace());
-        if (channel_to_values.contains(channel_name)) {
+        if (channel_to_lines.contains(channel_name)) {
           return absl::FailedPreconditionError(absl::StrFormat(
               "Channel name '%s' declare more than once.", channel_name));
         }
@@ -105,10 +268,10 @@ ParseChannelValues(std::string_view all_channel_values,
       }
       case kParsingChannel: {
         if (line == "}") {
-          channel_to_values[channel_name] = channel_values;
+          channel_to_lines[channel_name] = std::move(channel_lines);
           VLOG(1) << "Adding channel: " << channel_name;
           values_per_channel = 0;
-          channel_values.clear();
+          channel_lines.clear();
           state = kExpectStartOfChannel;
           break;
         }
@@ -116,13 +279,16 @@ ParseChannelValues(std::string_view all_channel_values,
             values_per_channel == max_values_count.value()) {
           break;
         }
-        XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(line));
-        channel_values.push_back(value);
+        channel_lines.push_back(line);
         values_per_channel++;
         break;
       }
     }
   }
+  absl::btree_map<std::string, std::vector<Value>> channel_to_values;
+  for (const auto& [name, lines] : channel_to_lines) {
+    XLS_ASSIGN_OR_RETURN(channel_to_values[name], ParseTypedValues(lines));
+  }
   return channel_to_values;
 }
 
@@ -140,6 +306,11 @@ ParseChannelValuesFromProto(const ProcChannelValuesProto& values,
   absl::btree_map<std::string, std::vector<Value>> results;
   for (const ProcChannelValuesProto::Channel& c : values.channels()) {
     std::vector<Value>& channel_vec = results[c.name()];
+    if (c.has_packed_type()) {
+      XLS_ASSIGN_OR_RETURN(channel_vec,
+                           UnpackChannelValues(c, max_values_count));
+      continue;
+    }
     channel_vec.reserve(c.entry_size());
     int64_t cnt = 0;
     for (const ValueProto& iv : c.entry()) {
@@ -158,16 +329,14 @@ ParseChannelValuesFromProto(const testvector::ChannelInputsProto& values,
                             std::optional<const int64_t> max_values_count) {
   absl::btree_map<std::string, std::vector<Value>> results;
   for (const testvector::ChannelInputProto& c : values.inputs()) {
-    std::vector<Value>& channel_vec = results[c.channel_name()];
-    channel_vec.reserve(c.values_size());
-    int64_t cnt = 0;
-    for (std::string_view value_string : c.values()) {
-      XLS_ASSIGN_OR_RETURN(Value v, Parser::ParseTypedValue(value_string));
-      channel_vec.push_back(v);
-      if (max_values_count.has_value() && ++cnt == *max_values_count) {
-        break;
-      }
+    int64_t count = c.values_size();
+    if (max_values_count.has_value()) {
+      count = std::min(count, *max_values_count);
     }
+    XLS_ASSIGN_OR_RETURN(results[c.channel_name()],
+                         ParallelParse(count, [&](int64_t i) {
+                           return Parser::ParseTypedValue(c.values(i));
+                         }));
   }
   return results;
 }
@@ -194,7 +363,8 @@ ParseChannelValuesFromTestVectorFile(
 }
 
 absl::StatusOr<ProcChannelValuesProto> ChannelValuesToProto(
-    const absl::btree_map<std::string, std::vector<Value>>& channel_map) {
+    const absl::btree_map<std::string, std::vector<Value>>& channel_map,
+    bool packed) {
   ProcChannelValuesProto pcv;
   using ChannelMap = absl::btree_map<std::string, std::vector<Value>>;
   std::vector<ChannelMap::const_pointer> sorted;
@@ -206,6 +376,21 @@ absl::StatusOr<ProcChannelValuesProto> ChannelValuesToProto(
     const auto& [name, values] = *key_value;
     ProcChannelValuesProto::Channel* chan = pcv.add_channels();
     chan->set_name(name);
+    if (packed && !values.empty() &&
+        absl::c_all_of(values, [&](const Value& v) {
+          return v.SameTypeAs(values.front());
+        })) {
+      XLS_ASSIGN_OR_RETURN(*chan->mutable_packed_type(),
+                           values.front().TypeAsProto());
+      XLS_ASSIGN_OR_RETURN(int64_t size, PackedSize(chan->packed_type()));
+      std::string& entries = *chan->mutable_packed_entries();
+      entries.reserve(size * values.size());
+      for (const Value& v : values) {
+        PackValue(v, entries);
+      }
+      chan->set_packed_entry_count(values.size());
+      continue;
+    }
     for (const Value& v : values) {
       XLS_ASSIGN_OR_RETURN(*chan->add_entry(), v.AsProto());
     }
@@ -142,9 +142,12 @@ ParseChannelValuesFromTestVectorFile(
     std::optional<const int64_t> max_values_count = std::nullopt);
 
 // Convert a map of channel-name -> channel values into a ProcChannelValuesProto
-// proto. This is the inverse of ParseChannelValuesFromProto.
+// proto. This is the inverse of ParseChannelValuesFromProto. If `packed` is
+// true the values of each channel whose values all have the same type are
+// stored in the compact packed encoding rather than as ValueProtos.
 absl::StatusOr<ProcChannelValuesProto> ChannelValuesToProto(
-    const absl::btree_map<std::string, std::vector<Value>>& channel_map);
+    const absl::btree_map<std::string, std::vector<Value>>& channel_map,
+    bool packed = false);
 
 }  // namespace xls
 
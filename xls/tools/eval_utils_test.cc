@@ -14,6 +14,7 @@
 
 #include "xls/tools/eval_utils.h"
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "gtest/gtest.h"
 #include "absl/container/btree_map.h"
 #include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/proto_test_utils.h"
 #include "xls/common/status/matchers.h"
@@ -32,7 +34,9 @@
 namespace xls {
 namespace {
 using ::absl_testing::IsOkAndHolds;
+using ::testing::Contains;
 using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::Pair;
 using ::testing::UnorderedElementsAre;
 using ::xls::proto_testing::EqualsProto;
@@ -132,5 +136,69 @@ TEST(EvalHelpersTest, ChannelValuesToProto) {
   EXPECT_THAT(ChannelValuesToProto(input), IsOkAndHolds(EqualsProto(expected)));
 }
 
+TEST(EvalHelpersTest, PackedChannelValuesRoundTrip) {
+  absl::btree_map<std::string, std::vector<Value>> input{
+      {"bits",
+       {Value(UBits(0x434241, 24)), Value(UBits(0x1, 24)),
+        Value(UBits(0xffffff, 24))}},
+      {"compound",
+       {Value::Tuple({Value(UBits(3, 3)),
+                      Value::UBitsArray({1, 2}, 9).value()}),
+        Value::Tuple({Value(UBits(5, 3)),
+                      Value::UBitsArray({511, 0}, 9).value()})}},
+      {"mixed", {Value(UBits(1, 8)), Value(UBits(1, 16))}},
+      {"empty", {}}};
+  XLS_ASSERT_OK_AND_ASSIGN(ProcChannelValuesProto proto,
+                           ChannelValuesToProto(input, /*packed=*/true));
+  ASSERT_EQ(proto.channels_size(), 4);
+  for (const ProcChannelValuesProto::Channel& channel : proto.channels()) {
+    if (channel.name() == "bits") {
+      EXPECT_TRUE(channel.has_packed_type());
+      EXPECT_EQ(channel.packed_entry_count(), 3);
+      EXPECT_EQ(channel.packed_entries(),
+                std::string("ABC\x01\0\0\xff\xff\xff", 9));
+    } else if (channel.name() == "compound") {
+      EXPECT_TRUE(channel.has_packed_type());
+      EXPECT_EQ(channel.packed_entries().size(), 2 * (1 + 2 * 2));
+    } else {
+      // Channels with values of differing types and empty channels are not
+      // packed.
+      EXPECT_FALSE(channel.has_packed_type());
+    }
+  }
+  EXPECT_THAT(ParseChannelValuesFromProto(proto),
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair("bits", input.at("bits")),
+                  Pair("compound", input.at("compound")),
+                  Pair("mixed", input.at("mixed")), Pair("empty", IsEmpty()))));
+  EXPECT_THAT(
+      ParseChannelValuesFromProto(proto, /*max_values_count=*/1),
+      IsOkAndHolds(Contains(Pair("bits", ElementsAre(input.at("bits")[0])))));
+}
+
+TEST(EvalHelpersTest, ParseManyChannelValues) {
+  // Enough values that parsing is split across threads.
+  constexpr int64_t kValueCount = 20000;
+  std::string text = "foo : {\n";
+  std::vector<Value> expected;
+  for (int64_t i = 0; i < kValueCount; ++i) {
+    absl::StrAppend(&text, "  bits[32]:", i, "\n");
+    expected.push_back(Value(UBits(i, 32)));
+  }
+  absl::StrAppend(&text, "}\nbar : {\n  bits[8]:1\n}\n");
+  EXPECT_THAT(ParseChannelValues(text),
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair("foo", expected),
+                  Pair("bar", ElementsAre(Value(UBits(1, 8)))))));
+
+  absl::StrAppend(&text, "baz : {\n");
+  for (int64_t i = 0; i < kValueCount; ++i) {
+    absl::StrAppend(&text, i == kValueCount - 1 ? "  bogus" : "  bits[4]:1",
+                    "\n");
+  }
+  absl::StrAppend(&text, "}\n");
+  EXPECT_FALSE(ParseChannelValues(text).ok());
+}
+
 }  // namespace
 }  // namespace xls
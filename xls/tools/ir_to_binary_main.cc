@@ -0,0 +1,79 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/binary_ir.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+static constexpr std::string_view kUsage = R"(
+Converts an IR package between the text and binary IR formats. The input may be
+in either format. Tools which read IR through the IR parser accept both.
+
+  ir_to_binary_main IR_FILE --output_path=OUTPUT_FILE [--output_text]
+)";
+
+ABSL_FLAG(std::string, output_path, "", "Path of the output file.");
+ABSL_FLAG(bool, output_text, false,
+          "Write text IR instead of binary IR. Useful for inspecting binary "
+          "IR files.");
+
+namespace xls {
+namespace {
+
+absl::Status RealMain(std::string_view input_path,
+                      std::string_view output_path, bool output_text) {
+  XLS_ASSIGN_OR_RETURN(std::string input, GetFileContents(input_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(input, input_path));
+  if (output_text) {
+    return SetFileContents(output_path, package->DumpIr());
+  }
+  XLS_ASSIGN_OR_RETURN(std::string binary, PackageToBinaryIr(package.get()));
+  VLOG(1) << absl::StreamFormat("Wrote %d bytes of binary IR (%d as text)",
+                                binary.size(), input.size());
+  return SetFileContents(output_path, binary);
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s IR_FILE",
+                                      argv[0]);
+  }
+  if (absl::GetFlag(FLAGS_output_path).empty()) {
+    LOG(QFATAL) << "--output_path is required.";
+  }
+
+  return xls::ExitStatus(xls::RealMain(positional_arguments[0],
+                                       absl::GetFlag(FLAGS_output_path),
+                                       absl::GetFlag(FLAGS_output_text)));
+}
@@ -14,11 +14,15 @@
 
 #include "xls/tools/memory_models.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -34,6 +38,9 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/native_layout_view.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -207,26 +214,193 @@ class RewrittenProcMemoryModel : public ProcMemoryModel {
   ChannelQueue* write_completion_channel_;
 };
 
-absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateAbstractProcMemoryModel(
-    const RamRewriteProto& ram_rewrite, ChannelQueueManager& queue_manager) {
-  ChannelQueue* read_request_queue = nullptr;
-  ChannelQueue* read_response_queue = nullptr;
-  ChannelQueue* write_request_queue = nullptr;
-  ChannelQueue* write_response_queue = nullptr;
+// A version of AbstractProcMemoryModel which never constructs Values. The
+// memory contents are stored in a flat byte array in the native layout of the
+// element type used by the JIT, and requests and responses are moved through
+// the raw interface of the JIT channel queues. Optionally the number of
+// requests serviced per tick can be limited and responses delayed to model
+// ports and latency. Like AbstractProcMemoryModel this does read before write
+// within a tick.
+class NativeAbstractProcMemoryModel : public ProcMemoryModel {
+ public:
+  // A contiguous run of bytes copied between two native layouts.
+  struct ByteCopy {
+    int64_t src_offset;
+    int64_t dst_offset;
+    int64_t size;
+  };
+
+  NativeAbstractProcMemoryModel(
+      const std::string& name, int64_t size,
+      const NativeMemoryModelOptions& options, TypeLayout element_layout,
+      JitChannelQueue* read_request_channel,
+      JitChannelQueue* read_response_channel,
+      JitChannelQueue* write_request_channel,
+      JitChannelQueue* write_response_channel,
+      std::vector<ByteCopy> write_request_to_element,
+      std::vector<ByteCopy> element_to_read_response)
+      : name_(name),
+        size_(size),
+        options_(options),
+        element_layout_(std::move(element_layout)),
+        element_size_(element_layout_.size()),
+        read_request_channel_(read_request_channel),
+        read_response_channel_(read_response_channel),
+        write_request_channel_(write_request_channel),
+        write_response_channel_(write_response_channel),
+        write_request_to_element_(std::move(write_request_to_element)),
+        element_to_read_response_(std::move(element_to_read_response)),
+        request_buffer_(std::max(read_request_channel->type_layout().size(),
+                                 write_request_channel->type_layout().size())),
+        read_response_buffer_(read_response_channel->type_layout().size()),
+        write_response_buffer_(write_response_channel->type_layout().size()) {
+    // Fill with Xs in the native layout.
+    std::vector<uint8_t> x_element(element_size_);
+    element_layout_.ValueToNativeLayout(XsOfType(element_layout_.type()),
+                                        x_element.data());
+    elements_.reserve(size_ * element_size_);
+    for (int64_t i = 0; i < size_; ++i) {
+      elements_.insert(elements_.end(), x_element.begin(), x_element.end());
+    }
+  }
+
+  absl::Status Tick() override {
+    // Deliver the responses to requests serviced `latency` ticks ago before
+    // servicing new requests, so a response is seen `latency` ticks after the
+    // response to the same request would be without latency.
+    while (!pending_read_responses_.empty() &&
+           pending_read_responses_.front().first <= tick_) {
+      read_response_channel_->WriteRaw(
+          pending_read_responses_.front().second.data());
+      pending_read_responses_.pop_front();
+    }
+    while (!pending_write_responses_.empty() &&
+           pending_write_responses_.front() <= tick_) {
+      write_response_channel_->WriteRaw(write_response_buffer_.data());
+      pending_write_responses_.pop_front();
+    }
+
+    for (int64_t serviced = 0;
+         options_.read_ports == 0 || serviced < options_.read_ports;
+         ++serviced) {
+      if (!read_request_channel_->ReadRaw(request_buffer_.data())) {
+        break;
+      }
+      XLS_ASSIGN_OR_RETURN(
+          int64_t addr, RequestAddress(*read_request_channel_, "Read"));
+      const uint8_t* element = elements_.data() + addr * element_size_;
+      for (const ByteCopy& copy : element_to_read_response_) {
+        std::memcpy(read_response_buffer_.data() + copy.dst_offset,
+                    element + copy.src_offset, copy.size);
+      }
+      if (options_.latency == 0) {
+        read_response_channel_->WriteRaw(read_response_buffer_.data());
+      } else {
+        pending_read_responses_.push_back(
+            {tick_ + options_.latency, read_response_buffer_});
+      }
+    }
+
+    for (int64_t serviced = 0;
+         options_.write_ports == 0 || serviced < options_.write_ports;
+         ++serviced) {
+      if (!write_request_channel_->ReadRaw(request_buffer_.data())) {
+        break;
+      }
+      XLS_ASSIGN_OR_RETURN(
+          int64_t addr, RequestAddress(*write_request_channel_, "Write"));
+      uint8_t* element = elements_.data() + addr * element_size_;
+      for (const ByteCopy& copy : write_request_to_element_) {
+        std::memcpy(element + copy.dst_offset,
+                    request_buffer_.data() + copy.src_offset, copy.size);
+      }
+      if (options_.latency == 0) {
+        write_response_channel_->WriteRaw(write_response_buffer_.data());
+      } else {
+        pending_write_responses_.push_back(tick_ + options_.latency);
+      }
+    }
+
+    ++tick_;
+    return absl::OkStatus();
+  }
+
+ private:
+  // Returns the address of the request in `request_buffer_`. The address is
+  // the first element of both read and write requests.
+  absl::StatusOr<int64_t> RequestAddress(const JitChannelQueue& queue,
+                                         std::string_view kind) const {
+    NativeLayoutView addr =
+        NativeLayoutView(&queue.type_layout(), request_buffer_.data())
+            .element(0);
+    uint64_t addr_u;
+    if (addr.bit_count() <= 64) {
+      addr_u = addr.GetUint64();
+    } else {
+      XLS_ASSIGN_OR_RETURN(addr_u, addr.GetBits().ToUint64());
+    }
+    if (addr_u >= size_) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "%s request address %u to memory %s out of range [0, %li)", kind,
+          addr_u, name_, size_));
+    }
+    return static_cast<int64_t>(addr_u);
+  }
+
+  std::string name_;
+  int64_t size_;
+  NativeMemoryModelOptions options_;
+
+  TypeLayout element_layout_;
+  int64_t element_size_;
+  std::vector<uint8_t> elements_;
+
+  JitChannelQueue* read_request_channel_;
+  JitChannelQueue* read_response_channel_;
+  JitChannelQueue* write_request_channel_;
+  JitChannelQueue* write_response_channel_;
+
+  // How the data of write requests and read responses map to and from the
+  // native layout of an element.
+  std::vector<ByteCopy> write_request_to_element_;
+  std::vector<ByteCopy> element_to_read_response_;
+
+  std::vector<uint8_t> request_buffer_;
+  std::vector<uint8_t> read_response_buffer_;
+  // Write responses are empty tuples so this is all padding.
+  std::vector<uint8_t> write_response_buffer_;
+
+  int64_t tick_ = 0;
+  // Responses waiting out the latency paired with the tick they are due.
+  std::deque<std::pair<int64_t, std::vector<uint8_t>>> pending_read_responses_;
+  std::deque<int64_t> pending_write_responses_;
+};
 
+namespace {
+
+struct AbstractRamQueues {
+  ChannelQueue* read_request = nullptr;
+  ChannelQueue* read_response = nullptr;
+  ChannelQueue* write_request = nullptr;
+  ChannelQueue* write_response = nullptr;
+};
+
+absl::StatusOr<AbstractRamQueues> GetAbstractRamQueues(
+    const RamRewriteProto& ram_rewrite, ChannelQueueManager& queue_manager) {
+  AbstractRamQueues queues;
   for (const auto& [logical_name, physical_name] :
        ram_rewrite.from_channels_logical_to_physical()) {
     if (logical_name == "abstract_read_req") {
-      XLS_ASSIGN_OR_RETURN(read_request_queue,
+      XLS_ASSIGN_OR_RETURN(queues.read_request,
                            queue_manager.GetQueueByName(physical_name));
     } else if (logical_name == "abstract_read_resp") {
-      XLS_ASSIGN_OR_RETURN(read_response_queue,
+      XLS_ASSIGN_OR_RETURN(queues.read_response,
                            queue_manager.GetQueueByName(physical_name));
     } else if (logical_name == "abstract_write_req") {
-      XLS_ASSIGN_OR_RETURN(write_request_queue,
+      XLS_ASSIGN_OR_RETURN(queues.write_request,
                            queue_manager.GetQueueByName(physical_name));
     } else if (logical_name == "write_completion") {
-      XLS_ASSIGN_OR_RETURN(write_response_queue,
+      XLS_ASSIGN_OR_RETURN(queues.write_response,
                            queue_manager.GetQueueByName(physical_name));
     } else {
       return absl::UnimplementedError(
@@ -235,35 +409,133 @@ absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateAbstractProcMemoryModel(
     }
   }
 
-  if (read_request_queue == nullptr) {
+  if (queues.read_request == nullptr) {
     return absl::InvalidArgumentError(
         absl::StrFormat("No read request channel found for RAM rewrite %s",
                         ram_rewrite.to_name_prefix()));
   }
-  if (read_response_queue == nullptr) {
+  if (queues.read_response == nullptr) {
     return absl::InvalidArgumentError(
         absl::StrFormat("No read response channel found for RAM rewrite %s",
                         ram_rewrite.to_name_prefix()));
   }
-  if (write_request_queue == nullptr) {
+  if (queues.write_request == nullptr) {
     return absl::InvalidArgumentError(
         absl::StrFormat("No write request channel found for RAM rewrite %s",
                         ram_rewrite.to_name_prefix()));
   }
-  if (write_response_queue == nullptr) {
+  if (queues.write_response == nullptr) {
     return absl::InvalidArgumentError(
         absl::StrFormat("No write response channel found for RAM rewrite %s",
                         ram_rewrite.to_name_prefix()));
   }
+  return queues;
+}
+
+// Returns the copies which move the leaves of `element_layout` from (or to)
+// the leaves starting at `first_leaf` of `layout`, merging adjacent leaves.
+// If `to_element` is true the copies move data from `layout` into the element
+// layout, otherwise from the element layout into `layout`.
+absl::StatusOr<std::vector<NativeAbstractProcMemoryModel::ByteCopy>>
+LeafCopies(const TypeLayout& layout, int64_t first_leaf,
+           const TypeLayout& element_layout, bool to_element) {
+  std::vector<NativeAbstractProcMemoryModel::ByteCopy> copies;
+  for (int64_t i = 0; i < element_layout.elements().size(); ++i) {
+    const ElementLayout& element_leaf = element_layout.elements()[i];
+    const ElementLayout& leaf = layout.elements()[first_leaf + i];
+    if (element_leaf.bit_offset.has_value() || leaf.bit_offset.has_value()) {
+      return absl::UnimplementedError(
+          "Native RAM model does not support bit-packed layouts");
+    }
+    XLS_RET_CHECK_EQ(element_leaf.data_size, leaf.data_size);
+    int64_t src_offset = to_element ? leaf.offset : element_leaf.offset;
+    int64_t dst_offset = to_element ? element_leaf.offset : leaf.offset;
+    if (!copies.empty() &&
+        copies.back().src_offset + copies.back().size == src_offset &&
+        copies.back().dst_offset + copies.back().size == dst_offset) {
+      copies.back().size += leaf.data_size;
+    } else {
+      copies.push_back({.src_offset = src_offset,
+                        .dst_offset = dst_offset,
+                        .size = leaf.data_size});
+    }
+  }
+  return copies;
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateAbstractProcMemoryModel(
+    const RamRewriteProto& ram_rewrite, ChannelQueueManager& queue_manager) {
+  XLS_ASSIGN_OR_RETURN(AbstractRamQueues queues,
+                       GetAbstractRamQueues(ram_rewrite, queue_manager));
 
   auto memory_model = std::make_unique<AbstractProcMemoryModel>(
       ram_rewrite.to_name_prefix(),
-      /*size=*/ram_rewrite.from_config().depth(), read_request_queue,
-      read_response_queue, write_request_queue, write_response_queue);
+      /*size=*/ram_rewrite.from_config().depth(), queues.read_request,
+      queues.read_response, queues.write_request, queues.write_response);
 
   return std::move(memory_model);
 }
 
+absl::StatusOr<std::unique_ptr<ProcMemoryModel>>
+CreateNativeAbstractProcMemoryModel(const RamRewriteProto& ram_rewrite,
+                                    JitChannelQueueManager& queue_manager,
+                                    const NativeMemoryModelOptions& options) {
+  XLS_RET_CHECK_GE(options.read_ports, 0);
+  XLS_RET_CHECK_GE(options.write_ports, 0);
+  XLS_RET_CHECK_GE(options.latency, 0);
+  XLS_ASSIGN_OR_RETURN(AbstractRamQueues queues,
+                       GetAbstractRamQueues(ram_rewrite, queue_manager));
+  JitChannelQueue& read_request =
+      queue_manager.GetJitQueue(queues.read_request->channel_instance());
+  JitChannelQueue& read_response =
+      queue_manager.GetJitQueue(queues.read_response->channel_instance());
+  JitChannelQueue& write_request =
+      queue_manager.GetJitQueue(queues.write_request->channel_instance());
+  JitChannelQueue& write_response =
+      queue_manager.GetJitQueue(queues.write_response->channel_instance());
+
+  // Read requests are (addr, mask), read responses are (data,), write
+  // requests are (addr, data, mask) and write responses are ().
+  Type* read_response_type = read_response.channel()->type();
+  XLS_RET_CHECK(read_response_type->IsTuple());
+  XLS_RET_CHECK_EQ(read_response_type->AsTupleOrDie()->size(), 1);
+  Type* element_type = read_response_type->AsTupleOrDie()->element_type(0);
+  for (JitChannelQueue* request : {&read_request, &write_request}) {
+    Type* request_type = request->channel()->type();
+    XLS_RET_CHECK(request_type->IsTuple() &&
+                  request_type->AsTupleOrDie()->size() >= 1 &&
+                  request_type->AsTupleOrDie()->element_type(0)->IsBits())
+        << "Unexpected RAM request type " << request_type->ToString();
+  }
+  XLS_RET_CHECK_EQ(write_request.channel()->type()->AsTupleOrDie()->size(), 3);
+  XLS_RET_CHECK(write_request.channel()
+                    ->type()
+                    ->AsTupleOrDie()
+                    ->element_type(1)
+                    ->IsEqualTo(element_type));
+
+  TypeLayout element_layout =
+      queue_manager.runtime().CreateTypeLayout(element_type);
+  // The address is a single leaf so the data of a write request starts at
+  // leaf 1.
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<NativeAbstractProcMemoryModel::ByteCopy> write_copies,
+      LeafCopies(write_request.type_layout(), /*first_leaf=*/1, element_layout,
+                 /*to_element=*/true));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<NativeAbstractProcMemoryModel::ByteCopy> read_copies,
+      LeafCopies(read_response.type_layout(), /*first_leaf=*/0, element_layout,
+                 /*to_element=*/false));
+
+  return std::make_unique<NativeAbstractProcMemoryModel>(
+      ram_rewrite.to_name_prefix(),
+      /*size=*/ram_rewrite.from_config().depth(), options,
+      std::move(element_layout), &read_request, &read_response, &write_request,
+      &write_response, std::move(write_copies), std::move(read_copies));
+}
+
 absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateRewrittenProcMemoryModel(
     const RamRewriteProto& ram_rewrite, ChannelQueueManager& queue_manager) {
   XLS_ASSIGN_OR_RETURN(
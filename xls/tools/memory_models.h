@@ -29,6 +29,7 @@
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
 
 namespace xls {
 
@@ -47,6 +48,25 @@ class ProcMemoryModel {
 absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateAbstractProcMemoryModel(
     const RamRewriteProto& ram_rewrite, ChannelQueueManager& queue_manager);
 
+// Options for the native abstract RAM model.
+struct NativeMemoryModelOptions {
+  // Maximum number of read requests serviced per tick. Zero means unlimited.
+  int64_t read_ports = 0;
+  // Maximum number of write requests serviced per tick. Zero means unlimited.
+  int64_t write_ports = 0;
+  // Number of ticks between servicing a request and delivering its response.
+  int64_t latency = 0;
+};
+
+// Like CreateAbstractProcMemoryModel but the model keeps the memory contents
+// in the native layout of the JIT and services the channel queues through
+// their raw interface, avoiding constructing Values for each access. Returns
+// an unimplemented error if the channel types use bit-packed layouts.
+absl::StatusOr<std::unique_ptr<ProcMemoryModel>>
+CreateNativeAbstractProcMemoryModel(
+    const RamRewriteProto& ram_rewrite, JitChannelQueueManager& queue_manager,
+    const NativeMemoryModelOptions& options = {});
+
 absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateRewrittenProcMemoryModel(
     const RamRewriteProto& ram_rewrite, ChannelQueueManager& queue_manager);
 
@@ -0,0 +1,275 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/memory_models.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/ram_rewrite.pb.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls::memory_model {
+namespace {
+
+constexpr int64_t kDepth = 16;
+constexpr int64_t kAddressWidth = 4;
+
+struct Request {
+  bool write;
+  int64_t addr;
+  Value data;
+};
+
+// The responses produced by a RAM model in one tick.
+struct TickResponses {
+  std::vector<Value> reads;
+  int64_t write_count = 0;
+
+  bool operator==(const TickResponses&) const = default;
+};
+
+// A RAM model along with the queues through which it is driven.
+struct Ram {
+  std::unique_ptr<ChannelQueueManager> queue_manager;
+  std::unique_ptr<ProcMemoryModel> model;
+  ChannelQueue* read_request;
+  ChannelQueue* read_response;
+  ChannelQueue* write_request;
+  ChannelQueue* write_response;
+
+  absl::Status Send(const Request& request) {
+    Value addr(UBits(request.addr, kAddressWidth));
+    if (request.write) {
+      return write_request->Write(
+          Value::Tuple({addr, request.data, Value::Tuple({})}));
+    }
+    return read_request->Write(Value::Tuple({addr, Value::Tuple({})}));
+  }
+
+  absl::StatusOr<TickResponses> Tick() {
+    XLS_RETURN_IF_ERROR(model->Tick());
+    TickResponses responses;
+    while (std::optional<Value> response = read_response->Read()) {
+      responses.reads.push_back(response->element(0));
+    }
+    while (write_response->Read().has_value()) {
+      ++responses.write_count;
+    }
+    return responses;
+  }
+};
+
+class MemoryModelsTest : public IrTestBase {
+ protected:
+  // Creates the channels of an abstract RAM holding elements of type
+  // `element_type` and returns the rewrite naming them.
+  absl::StatusOr<RamRewriteProto> CreateRamChannels(Package* p,
+                                                    Type* element_type) {
+    Type* addr_type = p->GetBitsType(kAddressWidth);
+    Type* mask_type = p->GetTupleType({});
+    for (auto [logical, type] :
+         std::vector<std::pair<std::string, Type*>>{
+             {"abstract_read_req", p->GetTupleType({addr_type, mask_type})},
+             {"abstract_read_resp", p->GetTupleType({element_type})},
+             {"abstract_write_req",
+              p->GetTupleType({addr_type, element_type, mask_type})},
+             {"write_completion", p->GetTupleType({})}}) {
+      std::string physical = "ram_" + logical;
+      XLS_RETURN_IF_ERROR(
+          p->CreateStreamingChannel(physical, ChannelOps::kSendReceive, type)
+              .status());
+    }
+    RamRewriteProto rewrite;
+    rewrite.mutable_from_config()->set_depth(kDepth);
+    rewrite.set_to_name_prefix("ram");
+    for (std::string logical :
+         {"abstract_read_req", "abstract_read_resp", "abstract_write_req",
+          "write_completion"}) {
+      (*rewrite.mutable_from_channels_logical_to_physical())[logical] =
+          "ram_" + logical;
+    }
+    return rewrite;
+  }
+
+  absl::StatusOr<Ram> CreateValueRam(Package* p,
+                                     const RamRewriteProto& rewrite) {
+    Ram ram;
+    XLS_ASSIGN_OR_RETURN(ram.queue_manager, ChannelQueueManager::Create(p));
+    XLS_ASSIGN_OR_RETURN(
+        ram.model, CreateAbstractProcMemoryModel(rewrite, *ram.queue_manager));
+    XLS_RETURN_IF_ERROR(GetQueues(ram));
+    return ram;
+  }
+
+  absl::StatusOr<Ram> CreateNativeRam(Package* p,
+                                      const RamRewriteProto& rewrite,
+                                      const NativeMemoryModelOptions& options) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+    XLS_ASSIGN_OR_RETURN(auto data_layout, orc_jit->CreateDataLayout());
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                         JitChannelQueueManager::CreateThreadUnsafe(
+                             p, std::make_unique<JitRuntime>(data_layout)));
+    Ram ram;
+    XLS_ASSIGN_OR_RETURN(
+        ram.model,
+        CreateNativeAbstractProcMemoryModel(rewrite, *queue_manager, options));
+    ram.queue_manager = std::move(queue_manager);
+    XLS_RETURN_IF_ERROR(GetQueues(ram));
+    return ram;
+  }
+
+  // Returns `tick_count` ticks of random reads and writes, with up to
+  // `max_requests` of each per tick.
+  std::vector<std::vector<Request>> RandomRequests(Type* element_type,
+                                                   int64_t tick_count,
+                                                   int64_t max_requests) {
+    std::mt19937_64 rng(42);
+    std::vector<std::vector<Request>> ticks(tick_count);
+    for (std::vector<Request>& requests : ticks) {
+      int64_t reads = std::uniform_int_distribution<int64_t>(
+          0, max_requests)(rng);
+      int64_t writes = std::uniform_int_distribution<int64_t>(
+          0, max_requests)(rng);
+      for (int64_t i = 0; i < reads + writes; ++i) {
+        requests.push_back(Request{
+            .write = i >= reads,
+            .addr = std::uniform_int_distribution<int64_t>(0, kDepth - 1)(rng),
+            .data = RandomValue(element_type, rng)});
+      }
+    }
+    return ticks;
+  }
+
+ private:
+  static absl::Status GetQueues(Ram& ram) {
+    XLS_ASSIGN_OR_RETURN(ram.read_request, ram.queue_manager->GetQueueByName(
+                                               "ram_abstract_read_req"));
+    XLS_ASSIGN_OR_RETURN(ram.read_response, ram.queue_manager->GetQueueByName(
+                                                "ram_abstract_read_resp"));
+    XLS_ASSIGN_OR_RETURN(ram.write_request, ram.queue_manager->GetQueueByName(
+                                                "ram_abstract_write_req"));
+    XLS_ASSIGN_OR_RETURN(ram.write_response, ram.queue_manager->GetQueueByName(
+                                                 "ram_write_completion"));
+    return absl::OkStatus();
+  }
+
+  static Value RandomValue(Type* type, std::mt19937_64& rng) {
+    if (type->IsTuple()) {
+      std::vector<Value> elements;
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        elements.push_back(RandomValue(element_type, rng));
+      }
+      return Value::Tuple(elements);
+    }
+    std::vector<Bits> words;
+    for (int64_t remaining = type->GetFlatBitCount(); remaining > 0;
+         remaining -= 64) {
+      int64_t width = std::min<int64_t>(remaining, 64);
+      words.push_back(UBits(rng() >> (64 - width), width));
+    }
+    return Value(bits_ops::Concat(words));
+  }
+};
+
+TEST_F(MemoryModelsTest, NativeModelMatchesValueModel) {
+  auto p = CreatePackage();
+  Type* element_type =
+      p->GetTupleType({p->GetBitsType(7), p->GetBitsType(100)});
+  XLS_ASSERT_OK_AND_ASSIGN(RamRewriteProto rewrite,
+                           CreateRamChannels(p.get(), element_type));
+  XLS_ASSERT_OK_AND_ASSIGN(Ram value_ram, CreateValueRam(p.get(), rewrite));
+  XLS_ASSERT_OK_AND_ASSIGN(Ram native_ram,
+                           CreateNativeRam(p.get(), rewrite, {}));
+
+  std::vector<std::vector<Request>> ticks =
+      RandomRequests(element_type, /*tick_count=*/100, /*max_requests=*/3);
+  for (int64_t tick = 0; tick < ticks.size(); ++tick) {
+    for (const Request& request : ticks[tick]) {
+      XLS_ASSERT_OK(value_ram.Send(request));
+      XLS_ASSERT_OK(native_ram.Send(request));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(TickResponses expected, value_ram.Tick());
+    XLS_ASSERT_OK_AND_ASSIGN(TickResponses actual, native_ram.Tick());
+    EXPECT_EQ(actual, expected) << "tick " << tick;
+  }
+}
+
+// Drives the Value-based model, which has neither ports nor latency, with at
+// most `ports` requests of each kind per tick and delays its responses by
+// `latency` ticks. This is what the native model should do by itself.
+TEST_F(MemoryModelsTest, NativeModelPortsAndLatency) {
+  constexpr int64_t kPorts = 1;
+  auto p = CreatePackage();
+  Type* element_type = p->GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(RamRewriteProto rewrite,
+                           CreateRamChannels(p.get(), element_type));
+  std::vector<std::vector<Request>> ticks =
+      RandomRequests(element_type, /*tick_count=*/100, /*max_requests=*/2);
+  for (int64_t latency : {0, 1, 3}) {
+    XLS_ASSERT_OK_AND_ASSIGN(Ram value_ram, CreateValueRam(p.get(), rewrite));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Ram native_ram,
+        CreateNativeRam(p.get(), rewrite,
+                        {.read_ports = kPorts,
+                         .write_ports = kPorts,
+                         .latency = latency}));
+    std::deque<Request> pending_reads;
+    std::deque<Request> pending_writes;
+    std::deque<TickResponses> delayed(latency);
+    for (int64_t tick = 0; tick < ticks.size(); ++tick) {
+      for (const Request& request : ticks[tick]) {
+        XLS_ASSERT_OK(native_ram.Send(request));
+        (request.write ? pending_writes : pending_reads).push_back(request);
+      }
+      for (std::deque<Request>* pending : {&pending_reads, &pending_writes}) {
+        for (int64_t i = 0; i < kPorts && !pending->empty(); ++i) {
+          XLS_ASSERT_OK(value_ram.Send(pending->front()));
+          pending->pop_front();
+        }
+      }
+      XLS_ASSERT_OK_AND_ASSIGN(TickResponses responses, value_ram.Tick());
+      delayed.push_back(std::move(responses));
+      TickResponses expected = std::move(delayed.front());
+      delayed.pop_front();
+      XLS_ASSERT_OK_AND_ASSIGN(TickResponses actual, native_ram.Tick());
+      EXPECT_EQ(actual, expected) << "latency " << latency << " tick " << tick;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls::memory_model
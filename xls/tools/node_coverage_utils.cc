@@ -37,6 +37,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/jit/jit_node_coverage.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/tools/node_coverage_stats.pb.h"
 
@@ -180,10 +181,25 @@ void CoverageEvalObserver::RecordNodeValue(int64_t node_ptr,
   }
 }
 
+void CoverageEvalObserver::AddJitCoverage(const JitNodeCoverage& coverage) {
+  CHECK(jit_);
+  coverage.ForEachNode([&](Node* node, absl::Span<const uint8_t> data) {
+    auto [iter, _] = raw_coverage_.try_emplace(node, data.size(), 0);
+    std::vector<uint8_t>& bits = iter->second;
+    CHECK_EQ(bits.size(), data.size());
+    for (int64_t i = 0; i < bits.size(); ++i) {
+      bits[i] = bits[i] | data[i];
+    }
+  });
+}
+
 ScopedRecordNodeCoverage::~ScopedRecordNodeCoverage() {
   if (!txtproto_ && !binproto_) {
     return;
   }
+  if (jit_coverage_ != nullptr) {
+    obs_.AddJitCoverage(*jit_coverage_);
+  }
   CHECK_OK(obs_.Finalize());
   absl::StatusOr<NodeCoverageStatsProto> proto = obs_.proto();
   if (!proto.ok()) {
@@ -29,6 +29,7 @@
 #include "xls/interpreter/observer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/value.h"
+#include "xls/jit/jit_node_coverage.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/observer.h"
 #include "xls/tools/node_coverage_stats.pb.h"
@@ -49,6 +50,9 @@ class CoverageEvalObserver final : public EvaluationObserver,
   }
   void RecordNodeValue(int64_t node_ptr, const uint8_t* data) override;
 
+  // Adds the coverage collected natively by jitted code.
+  void AddJitCoverage(const JitNodeCoverage& coverage);
+
   // Prepare for proto conversion.
   absl::Status Finalize();
 
@@ -82,10 +86,18 @@ class ScopedRecordNodeCoverage {
   // Set to true to pause collection.
   void SetPaused(bool paused) { obs_.SetPaused(paused); }
 
+  // Includes the coverage collected natively by jitted code into `coverage`
+  // in the output. `coverage` must remain valid until this object is
+  // destroyed. Requires a JitRuntime to have been given.
+  void AddJitCoverage(const JitNodeCoverage* coverage) {
+    jit_coverage_ = coverage;
+  }
+
  private:
   std::optional<std::string> binproto_;
   std::optional<std::string> txtproto_;
   CoverageEvalObserver obs_;
+  const JitNodeCoverage* jit_coverage_ = nullptr;
 };
 
 }  // namespace xls
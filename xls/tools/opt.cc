@@ -19,29 +19,60 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/visitor.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/estimators/area_model/area_estimators.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/function_specialization.h"
+#include "xls/passes/optimization_cache.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/pass_metrics.pb.h"
 #include "xls/passes/pass_pipeline.pb.h"
+#include "xls/passes/query_engine_manager.h"
+#include "xls/passes/rewrite_cost_model.h"
 #include "xls/passes/verifier_checker.h"
 
 namespace xls::tools {
+namespace {
+
+// Returns a description of the pipeline and of the options which affect the
+// IR it produces for use in optimization cache keys.
+absl::StatusOr<std::string> PipelineConfig(
+    const OptimizationPass& pipeline, const OptimizationPassOptions& options) {
+  XLS_ASSIGN_OR_RETURN(PassPipelineProto::Element element, pipeline.ToProto());
+  return absl::StrFormat(
+      "%s\nskip_passes=%s\nconvert_array_index_to_select=%d\n"
+      "split_next_value_selects=%d\nuse_context_narrowing_analysis=%d\n"
+      "resource_sharing=%d\ncost_model=%s",
+      element.DebugString(), absl::StrJoin(options.skip_passes, ","),
+      options.convert_array_index_to_select.value_or(-1),
+      options.split_next_value_selects.value_or(-1),
+      options.use_context_narrowing_analysis, options.resource_sharing,
+      options.cost_model == nullptr ? "" : options.cost_model->name());
+}
+
+}  // namespace
 
 absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
   if (!options.top.empty()) {
@@ -61,6 +92,21 @@ absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
   }
   VLOG(3) << "Top entity: '" << top.value()->name() << "'";
 
+  if (!options.param_specializations.empty()) {
+    if (!top.value()->IsFunction()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Parameters can only be specialized for a function top, got `%s`.",
+          top.value()->name()));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Function * specialized,
+        SpecializeFunction(top.value()->AsFunctionOrDie(),
+                           options.param_specializations,
+                           absl::StrCat(top.value()->name(), "_specialized")));
+    XLS_RETURN_IF_ERROR(package->SetTop(specialized));
+    VLOG(3) << "Specialized top entity: '" << specialized->name() << "'";
+  }
+
   using PipelineResult = absl::StatusOr<std::unique_ptr<OptimizationPass>>;
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<OptimizationPass> pipeline,
@@ -104,10 +150,64 @@ absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
       options.use_context_narrowing_analysis;
   pass_options.bisect_limit = options.bisect_limit;
   pass_options.record_metrics = options.metrics != nullptr;
+  pass_options.function_base_parallelism = options.function_base_parallelism;
+  pass_options.node_budget = options.node_budget;
+  pass_options.loop_iterations_per_activation =
+      options.loop_iterations_per_activation;
+  pass_options.resource_sharing = options.resource_sharing;
+  pass_options.incremental_verification = options.incremental_verification;
+  std::optional<EstimatorRewriteCostModel> cost_model;
+  if (options.cost_model.has_value()) {
+    XLS_ASSIGN_OR_RETURN(AreaEstimator * area_estimator,
+                         GetAreaEstimator(*options.cost_model));
+    XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                         GetDelayEstimator(*options.cost_model));
+    cost_model.emplace(*area_estimator, *delay_estimator);
+    pass_options.cost_model = &*cost_model;
+  }
+  // Bisection counts the passes run on the package and the node budget applies
+  // to the whole package, so neither is compatible with substituting optimized
+  // leaf functions.
+  if (options.optimization_cache != nullptr &&
+      !options.bisect_limit.has_value() && !options.node_budget.has_value()) {
+    absl::StatusOr<std::string> config =
+        PipelineConfig(*pipeline, pass_options);
+    if (config.ok()) {
+      XLS_RETURN_IF_ERROR(OptimizeLeafFunctionsWithCache(
+                              package, *pipeline, *config, pass_options,
+                              *options.optimization_cache)
+                              .status());
+      VLOG(1) << absl::StreamFormat(
+          "Optimization cache: %d hits, %d misses",
+          options.optimization_cache->hit_count(),
+          options.optimization_cache->miss_count());
+    } else {
+      LOG(WARNING) << "Pipeline cannot be described for the optimization "
+                      "cache, caching disabled: "
+                   << config.status();
+    }
+  }
+  QueryEngineManager query_engine_manager;
+  pass_options.query_engine_manager = &query_engine_manager;
   PassResults results;
   XLS_RETURN_IF_ERROR(pipeline->Run(package, pass_options, &results).status());
+  if (options.incremental_verification) {
+    // The invariant checker only verified what each pass changed.
+    XLS_RETURN_IF_ERROR(VerifyPackage(package));
+  }
+  if (!results.node_budget_events.empty()) {
+    LOG(WARNING) << absl::StreamFormat(
+        "%d expansions were deferred to stay within the node budget of %d",
+        results.node_budget_events.size(), *options.node_budget);
+  }
   if (options.metrics) {
     *options.metrics = results.aggregate_results.ToProto();
+    for (PassInvocationProfileProto& profile : results.invocation_profiles) {
+      *options.metrics->add_invocations() = std::move(profile);
+    }
+    for (NodeBudgetEventProto& event : results.node_budget_events) {
+      *options.metrics->add_node_budget_events() = std::move(event);
+    }
   }
   return absl::OkStatus();
 }
@@ -27,6 +27,8 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/ir/package.h"
+#include "xls/passes/function_specialization.h"
+#include "xls/passes/optimization_cache.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_metrics.pb.h"
 #include "xls/passes/pass_pipeline.pb.h"
@@ -50,6 +52,27 @@ struct OptOptions {
       pass_pipeline = std::nullopt;
   std::optional<int64_t> bisect_limit;
   PipelineMetricsProto* metrics = nullptr;
+  int64_t function_base_parallelism = 1;
+  // See OptimizationPassOptions::node_budget.
+  std::optional<int64_t> node_budget = std::nullopt;
+  // See OptimizationPassOptions::loop_iterations_per_activation.
+  std::optional<int64_t> loop_iterations_per_activation = std::nullopt;
+  // See OptimizationPassOptions::resource_sharing.
+  bool resource_sharing = false;
+  // If set, the name of the area and delay models (e.g. "asap7") which passes
+  // consult to reject rewrites that increase area or critical-path delay. See
+  // OptimizationPassOptions::cost_model.
+  std::optional<std::string> cost_model = std::nullopt;
+  // If set, leaf functions are optimized in isolation and the results are
+  // cached here, keyed by the function and the pipeline configuration. Not
+  // owned.
+  OptimizationCache* optimization_cache = nullptr;
+  // See OptimizationPassOptions::incremental_verification. The whole package
+  // is verified again after the pipeline.
+  bool incremental_verification = false;
+  // If non-empty, the top function is replaced by a specialization of it with
+  // these parameters bound before optimizing. See SpecializeFunction.
+  std::vector<ParamSpecialization> param_specializations;
 };
 
 // Helper used in the opt_main tool, optimizes the given IR for a particular
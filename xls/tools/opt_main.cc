@@ -45,11 +45,17 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dev_tools/tool_timeout.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
+#include "xls/passes/function_specialization.h"
+#include "xls/passes/optimization_cache.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_metrics.pb.h"
+#include "xls/passes/pass_profile.h"
 #include "xls/passes/pass_pipeline.pb.h"
 #include "xls/tools/opt.h"
 
@@ -126,6 +132,51 @@ ABSL_FLAG(std::optional<std::string>, passes_textproto, std::nullopt,
 ABSL_FLAG(std::optional<int64_t>, passes_bisect_limit, std::nullopt,
           "Number of passes to allow to execute. This can be used as compiler "
           "fuel to ensure the compiler finishes at a particular point.");
+ABSL_FLAG(int64_t, function_base_parallelism, 1,
+          "Number of threads on which passes which operate on individual "
+          "functions and procs transform them concurrently. Zero uses all "
+          "available CPUs. The optimized IR is the same for any value other "
+          "than one, and for one differs only in the ids of new nodes.");
+ABSL_FLAG(std::optional<int64_t>, node_budget, std::nullopt,
+          "If set, loop unrolling and function and map inlining leave in "
+          "place any loop, map or invoke whose expansion would grow the "
+          "package beyond this many nodes, trading optimization quality for "
+          "memory. Deferred expansions are logged and reported in the "
+          "pipeline metrics. The resulting IR may not be codegen-ready.");
+ABSL_FLAG(std::optional<int64_t>, loop_iterations_per_activation, std::nullopt,
+          "If set, counted for loops in procs with more iterations than this "
+          "are not unrolled but moved into a separate proc which executes "
+          "this many iterations per activation; the proc containing the loop "
+          "stalls until it completes. Lower values trade throughput for "
+          "area.");
+ABSL_FLAG(bool, resource_sharing, false,
+          "If true, fold multiplies, divides and modulos in mutually "
+          "exclusive select arms into a single operation when doing so does "
+          "not lengthen the estimated critical path.");
+ABSL_FLAG(bool, incremental_verification, false,
+          "If true, the IR verifier run between passes only re-verifies the "
+          "nodes each pass added or modified (and their neighbors). The "
+          "whole package is still verified before and after the pipeline.");
+ABSL_FLAG(std::optional<std::string>, cost_model, std::nullopt,
+          "If set, the name of the area and delay models (e.g. asap7) used to "
+          "reject profitability-driven rewrites, such as table switch "
+          "conversion and select lifting, which would increase estimated "
+          "area or critical-path delay.");
+ABSL_FLAG(std::optional<std::string>, optimization_cache_dir, std::nullopt,
+          "If set, leaf functions (functions which call no other function) "
+          "are optimized in isolation and the results are cached in this "
+          "directory, keyed by the function's structure and the pipeline "
+          "configuration. Later runs on any package containing the same "
+          "function reuse the cached result.");
+ABSL_FLAG(std::optional<std::string>, specialize_params, std::nullopt,
+          "If set, the top function is specialized for the given parameter "
+          "values before optimizing, as a semicolon-separated list of "
+          "`name=value[|value...]` where values are typed IR values (e.g. "
+          "`mode=bits[2]:1;width=bits[8]:8|bits[8]:16`). A parameter with a "
+          "single value is bound to that constant and removed from the "
+          "signature. A parameter with several values is quasi-static: a "
+          "variant of the function is optimized for each value and the "
+          "variants are muxed by the parameter.");
 ABSL_FLAG(bool, list_passes, false,
           "If passed list the names of all passes and exit.");
 ABSL_FLAG(std::optional<std::string>, pipeline_metrics_proto, std::nullopt,
@@ -134,6 +185,9 @@ ABSL_FLAG(std::optional<std::string>, pipeline_metrics_proto, std::nullopt,
 ABSL_FLAG(std::optional<std::string>, pipeline_metrics_textproto, std::nullopt,
           "Output path for the pipeline metrics text proto recording what "
           "this opt performed.");
+ABSL_FLAG(std::optional<std::string>, pipeline_trace_json, std::nullopt,
+          "Output path for a Chrome trace event JSON file (viewable in "
+          "chrome://tracing or Perfetto) profiling each pass invocation.");
 
 namespace xls::tools {
 namespace {
@@ -216,6 +270,18 @@ absl::Status RealMain(std::string_view input_path) {
   std::optional<std::string> pass_list = absl::GetFlag(FLAGS_passes);
   std::optional<int64_t> bisect_limit =
       absl::GetFlag(FLAGS_passes_bisect_limit);
+  int64_t function_base_parallelism =
+      absl::GetFlag(FLAGS_function_base_parallelism);
+  if (function_base_parallelism == 0) {
+    function_base_parallelism = AvailableCPUs();
+  }
+  std::vector<ParamSpecialization> param_specializations;
+  if (std::optional<std::string> specialize_params =
+          absl::GetFlag(FLAGS_specialize_params);
+      specialize_params.has_value()) {
+    XLS_ASSIGN_OR_RETURN(param_specializations,
+                         ParseParamSpecializations(*specialize_params));
+  }
   XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(input_path));
   std::optional<std::string> pipeline_textproto =
       absl::GetFlag(FLAGS_passes_textproto);
@@ -250,26 +316,47 @@ absl::Status RealMain(std::string_view input_path) {
 
   PipelineMetricsProto metrics;
   bool wants_metrics = absl::GetFlag(FLAGS_pipeline_metrics_proto) ||
-                       absl::GetFlag(FLAGS_pipeline_metrics_textproto);
+                       absl::GetFlag(FLAGS_pipeline_metrics_textproto) ||
+                       absl::GetFlag(FLAGS_pipeline_trace_json);
+
+  std::unique_ptr<OptimizationCache> optimization_cache;
+  if (std::optional<std::string> cache_dir =
+          absl::GetFlag(FLAGS_optimization_cache_dir);
+      cache_dir.has_value()) {
+    XLS_ASSIGN_OR_RETURN(optimization_cache,
+                         OptimizationCache::Create(*cache_dir));
+  }
 
-  XLS_ASSIGN_OR_RETURN(
-      std::string opt_ir,
-      tools::OptimizeIrForTop(
-          ir,
-          OptOptions{
-              .opt_level = opt_level,
-              .top = top,
-              .ir_dump_path = ir_dump_path,
-              .skip_passes = std::move(skip_passes),
-              .convert_array_index_to_select = convert_array_index_to_select,
-              .split_next_value_selects = split_next_value_selects,
-              .inline_procs = inline_procs,
-              .ram_rewrites = std::move(ram_rewrites_vec),
-              .use_context_narrowing_analysis = use_context_narrowing_analysis,
-              .pass_pipeline = pass_pipeline,
-              .bisect_limit = bisect_limit,
-              .metrics = wants_metrics ? &metrics : nullptr,
-          }));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir));
+  // The text is no longer needed; release it before optimizing.
+  std::string().swap(ir);
+  XLS_RETURN_IF_ERROR(tools::OptimizeIrForTop(
+      package.get(),
+      OptOptions{
+          .opt_level = opt_level,
+          .top = top,
+          .ir_dump_path = ir_dump_path,
+          .skip_passes = std::move(skip_passes),
+          .convert_array_index_to_select = convert_array_index_to_select,
+          .split_next_value_selects = split_next_value_selects,
+          .inline_procs = inline_procs,
+          .ram_rewrites = std::move(ram_rewrites_vec),
+          .use_context_narrowing_analysis = use_context_narrowing_analysis,
+          .pass_pipeline = pass_pipeline,
+          .bisect_limit = bisect_limit,
+          .metrics = wants_metrics ? &metrics : nullptr,
+          .function_base_parallelism = function_base_parallelism,
+          .node_budget = absl::GetFlag(FLAGS_node_budget),
+          .loop_iterations_per_activation =
+              absl::GetFlag(FLAGS_loop_iterations_per_activation),
+          .resource_sharing = absl::GetFlag(FLAGS_resource_sharing),
+          .cost_model = absl::GetFlag(FLAGS_cost_model),
+          .optimization_cache = optimization_cache.get(),
+          .incremental_verification =
+              absl::GetFlag(FLAGS_incremental_verification),
+          .param_specializations = std::move(param_specializations),
+      }));
   if (absl::GetFlag(FLAGS_pipeline_metrics_proto)) {
     XLS_RETURN_IF_ERROR(
         SetFileContents(*absl::GetFlag(FLAGS_pipeline_metrics_proto),
@@ -281,12 +368,22 @@ absl::Status RealMain(std::string_view input_path) {
     XLS_RETURN_IF_ERROR(
         SetFileContents(*absl::GetFlag(FLAGS_pipeline_metrics_textproto), tf));
   }
+  if (absl::GetFlag(FLAGS_pipeline_trace_json)) {
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(*absl::GetFlag(FLAGS_pipeline_trace_json),
+                        PipelineMetricsToChromeTrace(metrics)));
+  }
 
+  // Stream the optimized IR out rather than building it as one string.
   if (output_path == "-") {
-    std::cout << opt_ir;
-    return absl::OkStatus();
+    return package->EmitIr(
+        [](std::string_view piece) {
+          std::cout << piece;
+          return absl::OkStatus();
+        },
+        /*parallelism=*/AvailableCPUs());
   }
-  return SetFileContents(output_path, opt_ir);
+  return package->DumpIrToFile(output_path, /*parallelism=*/AvailableCPUs());
 }
 
 }  // namespace
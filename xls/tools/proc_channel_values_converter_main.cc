@@ -0,0 +1,114 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/value.h"
+#include "xls/tools/eval_utils.h"
+#include "xls/tools/proc_channel_values.pb.h"
+
+static constexpr std::string_view kUsage = R"(
+Converts proc channel values between the formats accepted by eval_proc_main.
+
+Formats:
+  text:   the channel values text format (--inputs_for_all_channels).
+  proto:  a binary ProcChannelValuesProto with one ValueProto per value
+          (--proto_inputs_for_all_channels).
+  packed: a binary ProcChannelValuesProto using the packed encoding, which is
+          much smaller and faster to read for large inputs.
+
+Example:
+  proc_channel_values_converter_main --input_format=text \
+      --output_format=packed --output=inputs.pb inputs.txt
+)";
+
+ABSL_FLAG(std::string, input_format, "text",
+          "Format of the input file. One of: text, proto, packed. The proto "
+          "and packed formats are read identically.");
+ABSL_FLAG(std::string, output_format, "packed",
+          "Format to write. One of: text, proto, packed.");
+ABSL_FLAG(std::string, output, "", "Output file to write the values to.");
+ABSL_FLAG(std::optional<int64_t>, max_values_count, std::nullopt,
+          "If set, only the first this many values of each channel are "
+          "converted.");
+
+namespace xls {
+namespace {
+
+absl::Status RealMain(std::string_view input_path,
+                      std::string_view input_format,
+                      std::string_view output_format,
+                      std::string_view output_path,
+                      std::optional<int64_t> max_values_count) {
+  absl::btree_map<std::string, std::vector<Value>> channel_values;
+  if (input_format == "text") {
+    XLS_ASSIGN_OR_RETURN(channel_values, ParseChannelValuesFromFile(
+                                             input_path, max_values_count));
+  } else if (input_format == "proto" || input_format == "packed") {
+    XLS_ASSIGN_OR_RETURN(channel_values, ParseChannelValuesFromProtoFile(
+                                             input_path, max_values_count));
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown --input_format: %s", input_format));
+  }
+
+  if (output_format == "text") {
+    return SetFileContents(output_path, ChannelValuesToString(channel_values));
+  }
+  if (output_format == "proto" || output_format == "packed") {
+    XLS_ASSIGN_OR_RETURN(
+        ProcChannelValuesProto proto,
+        ChannelValuesToProto(channel_values,
+                             /*packed=*/output_format == "packed"));
+    return SetProtobinFile(output_path, proto);
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Unknown --output_format: %s", output_format));
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s INPUT_FILE",
+                                      argv[0]);
+  }
+
+  if (absl::GetFlag(FLAGS_output).empty()) {
+    LOG(QFATAL) << "--output (output file path) required.";
+  }
+
+  return xls::ExitStatus(xls::RealMain(
+      positional_arguments[0], absl::GetFlag(FLAGS_input_format),
+      absl::GetFlag(FLAGS_output_format), absl::GetFlag(FLAGS_output),
+      absl::GetFlag(FLAGS_max_values_count)));
+}
@@ -72,6 +72,34 @@ ABSL_FLAG(bool, minimize_worst_case_throughput, false,
           "(subject to all other constraints). If `--clock_period_ps` is not "
           "set, will first optimize for clock speed, and then find the best "
           "possible worst-case throughput within that constraint.");
+ABSL_FLAG(bool, lazy_timing_constraints, false,
+          "If true, the SDC scheduler only adds a timing constraint to its "
+          "linear program once a solution violates it, re-solving until no "
+          "constraint is violated. This yields the same kind of schedule from "
+          "a much smaller program on large datapaths, at the cost of a few "
+          "extra solves.");
+ABSL_FLAG(int64_t, partitioned_scheduling_threshold, 0,
+          "If positive, functions with more nodes than this are scheduled by "
+          "splitting their topological order into partitions and solving a "
+          "small SDC problem per partition instead of one for the whole "
+          "function. Memory and time grow linearly with the function size, "
+          "at the cost of some additional pipeline registers. Not used for "
+          "procs or with scheduling constraints.");
+ABSL_FLAG(std::vector<std::string>, multi_cycle_ops, {},
+          "Comma-separated list of ops (e.g. `umul,smul,udiv`) whose "
+          "operations may span several pipeline stages when their delay "
+          "exceeds the clock period. The pipeline registers after such an "
+          "operation are meant to be retimed into it by synthesis. Requires "
+          "`--clock_period_ps`.");
+ABSL_FLAG(std::string, delay_cache_path, "",
+          "If set, operation delays are cached by the structure of the "
+          "operation in this file, which is read before scheduling if it "
+          "exists and written afterwards. Runs sharing the file skip "
+          "re-estimating operations seen before.");
+ABSL_FLAG(std::string, schedule_cache_dir, "",
+          "If set, schedules are cached in this directory, keyed on the IR, "
+          "the scheduling flags and the delay model. A cached schedule is "
+          "checked for validity and used instead of scheduling again.");
 ABSL_FLAG(std::optional<int64_t>, worst_case_throughput, std::nullopt,
           "Allow scheduling a pipeline with worst-case throughput no slower "
           "than once per N cycles. If unspecified and "
@@ -199,6 +227,11 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(minimize_clock_on_failure);
   POPULATE_FLAG(recover_after_minimizing_clock);
   POPULATE_FLAG(minimize_worst_case_throughput);
+  POPULATE_FLAG(lazy_timing_constraints);
+  POPULATE_FLAG(partitioned_scheduling_threshold);
+  POPULATE_REPEATED_FLAG(multi_cycle_ops);
+  POPULATE_FLAG(delay_cache_path);
+  POPULATE_FLAG(schedule_cache_dir);
   {
     any_flags_set |= FLAGS_worst_case_throughput.IsSpecifiedOnCommandLine();
     proto.set_worst_case_throughput(
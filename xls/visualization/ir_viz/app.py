@@ -19,6 +19,8 @@ Exposes a text box to edit or cut-and-paste XLS IR to render as a graph.
 import functools
 import json
 import os
+import re
+import shutil
 import subprocess
 import sys
 import tempfile
@@ -65,6 +67,12 @@ flags.DEFINE_string(
     'Name of entity (function, proc, etc) to visualize. If not '
     'given then the entity specified as top in the IR file is visualzied.',
 )
+flags.DEFINE_integer(
+    'max_cluster_size',
+    1000,
+    'Maximum number of nodes per cluster in the clustered view served by '
+    '/clustered_graph.',
+)
 flags.mark_flag_as_required('delay_model')
 
 IR_EXAMPLES_FILE_LIST = 'xls/visualization/ir_viz/ir_examples_file_list.txt'
@@ -76,6 +84,15 @@ webapp.debug = True
 # these are loaded from IR_EXAMPLES_FILE_LIST unless --example_ir_dir is given.
 examples = []
 
+# Directories holding the chunks of clustered graphs produced by
+# /clustered_graph, keyed by the token handed to the client. Each chunk is
+# served on demand by /clustered_graph/<token>/<chunk>.
+clustered_graph_dirs = {}
+
+# Maximum number of clustered graphs to keep on disk. The oldest is removed
+# when the limit is exceeded.
+MAX_CLUSTERED_GRAPHS = 8
+
 OPT_MAIN_PATH = runfiles.get_path('xls/tools/opt_main')
 IR_TO_JSON_MAIN_PATH = runfiles.get_path(
     'xls/visualization/ir_viz/ir_to_json_main'
@@ -264,15 +281,7 @@ def graph_handler():
   ) as tmp_ir:
     tmp_ir.write(text)
     tmp_ir.seek(0)
-    argv = [
-        IR_TO_JSON_MAIN_PATH,
-        '--delay_model={}'.format(FLAGS.delay_model),
-        tmp_ir.name,
-    ]
-    if FLAGS.pipeline_stages is not None:
-      argv.append('--pipeline_stages={}'.format(FLAGS.pipeline_stages))
-    if FLAGS.top is not None:
-      argv.append('--entry_name={}'.format(FLAGS.top))
+    argv = _ir_to_json_argv(tmp_ir.name)
     try:
       json_text = subprocess.check_output(
           argv,
@@ -289,6 +298,74 @@ def graph_handler():
   return jsonified
 
 
+def _ir_to_json_argv(ir_path: str) -> List[str]:
+  argv = [
+      IR_TO_JSON_MAIN_PATH,
+      '--delay_model={}'.format(FLAGS.delay_model),
+      ir_path,
+  ]
+  if FLAGS.pipeline_stages is not None:
+    argv.append('--pipeline_stages={}'.format(FLAGS.pipeline_stages))
+  if FLAGS.top is not None:
+    argv.append('--entry_name={}'.format(FLAGS.top))
+  return argv
+
+
+@webapp.route('/clustered_graph', methods=['POST'])
+def clustered_graph_handler():
+  """Builds a clustered view of the posted IR for graphs too large to render.
+
+  Returns the summary graph (clusters and the edges between them) and a token
+  with which the detail of each cluster can be fetched lazily from
+  /clustered_graph/<token>/<cluster id>.
+  """
+  text = flask.request.form['text']
+  output_dir = tempfile.mkdtemp(prefix='ir_viz_clusters.')
+  with tempfile.NamedTemporaryFile(
+      mode='w', encoding='utf-8', prefix='ir_viz.', suffix='.ir'
+  ) as tmp_ir:
+    tmp_ir.write(text)
+    tmp_ir.seek(0)
+    argv = _ir_to_json_argv(tmp_ir.name) + [
+        '--output_dir={}'.format(output_dir),
+        '--max_cluster_size={}'.format(FLAGS.max_cluster_size),
+    ]
+    try:
+      subprocess.check_output(
+          argv, stdin=None, stderr=subprocess.PIPE, encoding='utf-8'
+      )
+    except Exception as e:  # pylint: disable=broad-except
+      shutil.rmtree(output_dir, ignore_errors=True)
+      return flask.jsonify({'error_code': 'error', 'message': str(e)})
+
+  token = os.path.basename(output_dir)
+  clustered_graph_dirs[token] = output_dir
+  while len(clustered_graph_dirs) > MAX_CLUSTERED_GRAPHS:
+    oldest = next(iter(clustered_graph_dirs))
+    shutil.rmtree(clustered_graph_dirs.pop(oldest), ignore_errors=True)
+
+  with open(os.path.join(output_dir, 'summary.json'), encoding='utf-8') as f:
+    summary = json.load(f)
+  return flask.jsonify(
+      {'error_code': 'ok', 'token': token, 'summary': summary}
+  )
+
+
+@webapp.route('/clustered_graph/<token>/<chunk>')
+def clustered_graph_chunk_handler(token: str, chunk: str):
+  """Returns one chunk (a cluster's detail) of a clustered graph."""
+  output_dir = clustered_graph_dirs.get(token)
+  if output_dir is None or not re.fullmatch(r'\w+', chunk):
+    flask.abort(404)
+  try:
+    with open(
+        os.path.join(output_dir, chunk + '.json'), encoding='utf-8'
+    ) as f:
+      return flask.Response(response=f.read(), content_type='application/json')
+  except IOError:
+    flask.abort(404)
+
+
 def main(argv):
   if len(argv) > 1:
     raise app.UsageError('Too many command-line arguments.')
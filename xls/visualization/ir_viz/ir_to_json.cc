@@ -14,15 +14,19 @@
 
 #include "xls/visualization/ir_viz/ir_to_json.h"
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "google/protobuf/message.h"
 #include "google/protobuf/util/json_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/visualization/ir_viz/ir_to_proto.h"
@@ -30,13 +34,10 @@
 
 namespace xls {
 
-absl::StatusOr<std::string> IrToJson(
-    Package* package, const DelayEstimator& delay_estimator,
-    const PipelineSchedule* schedule,
-    std::optional<std::string_view> entry_name) {
-  XLS_ASSIGN_OR_RETURN(viz::Package proto, IrToProto(package, delay_estimator,
-                                                     schedule, entry_name));
+namespace {
 
+absl::StatusOr<std::string> ProtoToJson(
+    const google::protobuf::Message& proto) {
   std::string serialized_json;
   google::protobuf::util::JsonPrintOptions print_options;
   print_options.add_whitespace = true;
@@ -50,4 +51,32 @@ absl::StatusOr<std::string> IrToJson(
   return serialized_json;
 }
 
+}  // namespace
+
+absl::StatusOr<std::string> IrToJson(
+    Package* package, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule,
+    std::optional<std::string_view> entry_name) {
+  XLS_ASSIGN_OR_RETURN(viz::Package proto, IrToProto(package, delay_estimator,
+                                                     schedule, entry_name));
+  return ProtoToJson(proto);
+}
+
+absl::Status IrToClusteredJson(
+    FunctionBase* function, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule, int64_t max_cluster_size,
+    const std::function<absl::Status(std::string_view chunk_name,
+                                     std::string_view json)>& chunk_callback) {
+  return IrToClusteredProtos(
+      function, delay_estimator, schedule, max_cluster_size,
+      [&](const viz::FunctionBaseSummary& summary) -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(std::string json, ProtoToJson(summary));
+        return chunk_callback("summary", json);
+      },
+      [&](const viz::ClusterDetail& detail) -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(std::string json, ProtoToJson(detail));
+        return chunk_callback(detail.cluster_id(), json);
+      });
+}
+
 }  // namespace xls
@@ -15,12 +15,16 @@
 #ifndef XLS_VISUALIZATION_IR_VIZ_IR_TO_JSON_H_
 #define XLS_VISUALIZATION_IR_VIZ_IR_TO_JSON_H_
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
@@ -34,6 +38,16 @@ absl::StatusOr<std::string> IrToJson(
     const PipelineSchedule* schedule = nullptr,
     std::optional<std::string_view> entry_name = std::nullopt);
 
+// Streams a clustered JSON representation of `function` (see
+// IrToClusteredProtos) in chunks. `chunk_callback` is called first with the
+// chunk name "summary" and the xls::viz::FunctionBaseSummary, then once per
+// cluster with the cluster id and its xls::viz::ClusterDetail.
+absl::Status IrToClusteredJson(
+    FunctionBase* function, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule, int64_t max_cluster_size,
+    const std::function<absl::Status(std::string_view chunk_name,
+                                     std::string_view json)>& chunk_callback);
+
 }  // namespace xls
 
 #endif  // XLS_VISUALIZATION_IR_VIZ_IR_TO_JSON_H_
@@ -45,9 +45,16 @@ ABSL_FLAG(std::string, delay_model, "", "Delay model to use.");
 ABSL_FLAG(std::optional<int64_t>, pipeline_stages, std::nullopt,
           "Pipeline stages to use when scheduling the function");
 ABSL_FLAG(std::optional<std::string>, entry_name, std::nullopt, "Entry name");
+ABSL_FLAG(std::optional<std::string>, output_dir, std::nullopt,
+          "If given, write a clustered view of the entry in chunks to this "
+          "directory instead of printing the whole package: summary.json "
+          "holds the cluster graph and <cluster id>.json the detail of each "
+          "cluster. Use for graphs too large to render whole.");
+ABSL_FLAG(int64_t, max_cluster_size, 1000,
+          "Maximum number of nodes per cluster with --output_dir.");
 
 constexpr std::string_view kUsage =
-    R"(Expected: ir_to_json_main --delay_model=MODEL [--pipeline_stages=N] [--entry_name=ENTRY] /path/to/file.ir)";
+    R"(Expected: ir_to_json_main --delay_model=MODEL [--pipeline_stages=N] [--entry_name=ENTRY] [--output_dir=DIR] /path/to/file.ir)";
 
 namespace xls {
 namespace {
@@ -70,7 +77,9 @@ absl::StatusOr<FunctionBase*> GetFunctionBaseToView(Package* package) {
 absl::Status RealMain(const std::filesystem::path& ir_path,
                       std::string_view delay_model_name,
                       std::optional<int64_t> pipeline_stages,
-                      std::optional<std::string_view> entry_name) {
+                      std::optional<std::string_view> entry_name,
+                      std::optional<std::filesystem::path> output_dir,
+                      int64_t max_cluster_size) {
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(ir_text));
@@ -83,22 +92,32 @@ absl::Status RealMain(const std::filesystem::path& ir_path,
   XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
                        GetDelayEstimator(delay_model_name));
 
-  std::string json;
+  std::optional<PipelineSchedule> schedule;
   if (pipeline_stages.has_value()) {
     // TODO(meheff): Support scheduled procs.
     XLS_RET_CHECK(func_base->IsFunction());
     XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
+        schedule,
         RunPipelineSchedule(
             func_base->AsFunctionOrDie(), *delay_estimator,
             SchedulingOptions().pipeline_stages(pipeline_stages.value())));
-    XLS_ASSIGN_OR_RETURN(json, IrToJson(package.get(), *delay_estimator,
-                                        &schedule, func_base->name()));
-  } else {
-    XLS_ASSIGN_OR_RETURN(json,
-                         IrToJson(package.get(), *delay_estimator,
-                                  /*schedule=*/nullptr, func_base->name()));
   }
+  const PipelineSchedule* schedule_ptr =
+      schedule.has_value() ? &schedule.value() : nullptr;
+
+  if (output_dir.has_value()) {
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(*output_dir));
+    return IrToClusteredJson(
+        func_base, *delay_estimator, schedule_ptr, max_cluster_size,
+        [&](std::string_view chunk_name, std::string_view json) {
+          return SetFileContents(
+              *output_dir / absl::StrFormat("%s.json", chunk_name), json);
+        });
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::string json,
+                       IrToJson(package.get(), *delay_estimator, schedule_ptr,
+                                func_base->name()));
   std::cout << json << "\n";
   return absl::OkStatus();
 }
@@ -120,5 +139,6 @@ int main(int argc, char** argv) {
 
   return xls::ExitStatus(xls::RealMain(
       positional_arguments[0], absl::GetFlag(FLAGS_delay_model),
-      absl::GetFlag(FLAGS_pipeline_stages), absl::GetFlag(FLAGS_entry_name)));
+      absl::GetFlag(FLAGS_pipeline_stages), absl::GetFlag(FLAGS_entry_name),
+      absl::GetFlag(FLAGS_output_dir), absl::GetFlag(FLAGS_max_cluster_size)));
 }
@@ -15,6 +15,7 @@
 #include "xls/visualization/ir_viz/ir_to_proto.h"
 
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <optional>
@@ -24,6 +25,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -45,6 +47,7 @@
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/passes/bdd_function.h"
 #include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/query_engine.h"
@@ -160,33 +163,89 @@ absl::StatusOr<viz::NodeAttributes> NodeAttributes(
   return attributes;
 }
 
-absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
-    FunctionBase* function, const DelayEstimator& delay_estimator,
-    const AreaEstimator& area_estimator, const PipelineSchedule* schedule,
-    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
-  viz::FunctionBase proto;
-  proto.set_name(function->name());
+// Fills in `graph_node` with the visualization of `node`.
+absl::Status NodeToVisualizationProto(
+    Node* node,
+    const absl::flat_hash_map<Node*, CriticalPathEntry*>& critical_path_map,
+    const QueryEngine& query_engine, const PipelineSchedule* schedule,
+    const DelayEstimator& delay_estimator, const AreaEstimator& area_estimator,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids,
+    viz::Node* graph_node) {
+  graph_node->set_name(node->GetName());
+  graph_node->set_id(GetNodeUniqueId(node, function_ids));
+  graph_node->set_opcode(OpToString(node->op()));
+  graph_node->set_ir(node->ToStringWithOperandTypes());
+  for (const auto& loc : node->loc().locations) {
+    viz::SourceLocation* graph_loc = graph_node->add_loc();
+    graph_loc->set_file(node->package()
+                            ->GetFilename(loc.fileno())
+                            .value_or(absl::StrCat(loc.fileno().value())));
+    graph_loc->set_line(loc.lineno().value());
+    graph_loc->set_column(loc.colno().value());
+  }
+  XLS_ASSIGN_OR_RETURN(
+      *graph_node->mutable_attributes(),
+      NodeAttributes(node, critical_path_map, query_engine, schedule,
+                     delay_estimator, area_estimator));
+  return absl::OkStatus();
+}
+
+// Fills in `graph_edge` with the visualization of the edge from `operand` to
+// `node`.
+void OperandEdgeToVisualizationProto(
+    Node* operand, Node* node, bool on_critical_path,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids,
+    viz::Edge* graph_edge) {
+  graph_edge->set_id(GetEdgeUniqueId(operand, node, function_ids));
+  graph_edge->set_source_id(GetNodeUniqueId(operand, function_ids));
+  graph_edge->set_target_id(GetNodeUniqueId(node, function_ids));
+  graph_edge->set_type(operand->GetType()->ToString());
+  graph_edge->set_bit_width(operand->GetType()->GetFlatBitCount());
+  graph_edge->set_on_critical_path(on_critical_path);
+}
+
+std::string FunctionBaseKind(FunctionBase* function) {
   if (function->IsFunction()) {
-    proto.set_kind("function");
-  } else if (function->IsProc()) {
-    proto.set_kind("proc");
-  } else {
-    XLS_RET_CHECK(function->IsBlock());
-    proto.set_kind("block");
+    return "function";
   }
-  proto.set_id(function_ids.at(function));
+  if (function->IsProc()) {
+    return "proc";
+  }
+  return "block";
+}
+
+// Returns the critical path of `function` keyed by node. Returns an empty map
+// (and logs) if the critical path cannot be computed.
+absl::flat_hash_map<Node*, CriticalPathEntry*> CriticalPathMap(
+    FunctionBase* function, const DelayEstimator& delay_estimator,
+    std::vector<CriticalPathEntry>& storage) {
   absl::StatusOr<std::vector<CriticalPathEntry>> critical_path =
       AnalyzeCriticalPath(function, /*clock_period_ps=*/std::nullopt,
                           delay_estimator);
   absl::flat_hash_map<Node*, CriticalPathEntry*> node_to_critical_path_entry;
   if (critical_path.ok()) {
-    for (CriticalPathEntry& entry : critical_path.value()) {
+    storage = *std::move(critical_path);
+    for (CriticalPathEntry& entry : storage) {
       node_to_critical_path_entry[entry.node] = &entry;
     }
   } else {
     LOG(WARNING) << "Could not analyze critical path for function: "
                  << critical_path.status();
   }
+  return node_to_critical_path_entry;
+}
+
+absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
+    FunctionBase* function, const DelayEstimator& delay_estimator,
+    const AreaEstimator& area_estimator, const PipelineSchedule* schedule,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
+  viz::FunctionBase proto;
+  proto.set_name(function->name());
+  proto.set_kind(FunctionBaseKind(function));
+  proto.set_id(function_ids.at(function));
+  std::vector<CriticalPathEntry> critical_path;
+  absl::flat_hash_map<Node*, CriticalPathEntry*> node_to_critical_path_entry =
+      CriticalPathMap(function, delay_estimator, critical_path);
 
   std::vector<std::unique_ptr<QueryEngine>> engines;
   engines.emplace_back(
@@ -196,23 +255,9 @@ absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
   XLS_RETURN_IF_ERROR(query_engine.Populate(function).status());
 
   for (Node* node : function->nodes()) {
-    viz::Node* graph_node = proto.add_nodes();
-    graph_node->set_name(node->GetName());
-    graph_node->set_id(GetNodeUniqueId(node, function_ids));
-    graph_node->set_opcode(OpToString(node->op()));
-    graph_node->set_ir(node->ToStringWithOperandTypes());
-    for (const auto& loc : node->loc().locations) {
-      viz::SourceLocation* graph_loc = graph_node->add_loc();
-      graph_loc->set_file(node->package()
-                              ->GetFilename(loc.fileno())
-                              .value_or(absl::StrCat(loc.fileno().value())));
-      graph_loc->set_line(loc.lineno().value());
-      graph_loc->set_column(loc.colno().value());
-    }
-    XLS_ASSIGN_OR_RETURN(
-        *graph_node->mutable_attributes(),
-        NodeAttributes(node, node_to_critical_path_entry, query_engine,
-                       schedule, delay_estimator, area_estimator));
+    XLS_RETURN_IF_ERROR(NodeToVisualizationProto(
+        node, node_to_critical_path_entry, query_engine, schedule,
+        delay_estimator, area_estimator, function_ids, proto.add_nodes()));
   }
   viz::Node* implicit_sink = nullptr;
   auto get_implicit_sink = [&]() {
@@ -231,15 +276,11 @@ absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
     bool node_on_critical_path = node_to_critical_path_entry.contains(node);
     for (int64_t i = 0; i < node->operand_count(); ++i) {
       Node* operand = node->operand(i);
-      viz::Edge* graph_edge = proto.add_edges();
-      graph_edge->set_id(GetEdgeUniqueId(operand, node, function_ids));
-      graph_edge->set_source_id(GetNodeUniqueId(operand, function_ids));
-      graph_edge->set_target_id(GetNodeUniqueId(node, function_ids));
-      graph_edge->set_type(operand->GetType()->ToString());
-      graph_edge->set_bit_width(operand->GetType()->GetFlatBitCount());
-      graph_edge->set_on_critical_path(
+      OperandEdgeToVisualizationProto(
+          operand, node,
           node_on_critical_path &&
-          node_to_critical_path_entry.contains(operand));
+              node_to_critical_path_entry.contains(operand),
+          function_ids, proto.add_edges());
     }
     if (function->HasImplicitUse(node)) {
       viz::Node* sink = get_implicit_sink();
@@ -479,6 +520,60 @@ absl::StatusOr<std::string> MarkUpIrText(Package* package) {
   return absl::StrJoin(lines, "\n");
 }
 
+// The partition of a function base's nodes computed by ClusterNodes.
+struct Clustering {
+  // The cluster index of each node.
+  absl::flat_hash_map<Node*, int64_t> node_to_cluster;
+  // The nodes of each cluster in topological order. Clusters are numbered in
+  // topological order of their first node.
+  std::vector<std::vector<Node*>> clusters;
+};
+
+// Partitions the nodes of `function` into clusters of at most
+// `max_cluster_size` nodes. With a schedule nodes are grouped by stage.
+// Otherwise a node joins the cluster of its users if they all agree, which
+// groups the fan-in cones of the outputs much like netlist::rtl's
+// FindLogicClouds groups the logic between flops.
+Clustering ClusterNodes(FunctionBase* function,
+                        const PipelineSchedule* schedule,
+                        int64_t max_cluster_size) {
+  absl::flat_hash_map<Node*, int64_t> group;
+  if (schedule != nullptr) {
+    for (Node* node : function->nodes()) {
+      group[node] = schedule->cycle(node);
+    }
+  } else {
+    int64_t next_group = 0;
+    for (Node* node : ReverseTopoSort(function)) {
+      std::optional<int64_t> user_group;
+      bool shared = function->HasImplicitUse(node) || node->users().empty();
+      for (Node* user : node->users()) {
+        if (shared) {
+          break;
+        }
+        int64_t g = group.at(user);
+        shared = user_group.has_value() && *user_group != g;
+        user_group = g;
+      }
+      group[node] = shared ? next_group++ : *user_group;
+    }
+  }
+
+  // Split oversized groups into consecutive runs in topological order.
+  Clustering result;
+  absl::flat_hash_map<int64_t, int64_t> group_to_cluster;
+  for (Node* node : TopoSort(function)) {
+    auto [it, inserted] = group_to_cluster.try_emplace(group.at(node), 0);
+    if (inserted || result.clusters[it->second].size() >= max_cluster_size) {
+      it->second = result.clusters.size();
+      result.clusters.emplace_back();
+    }
+    result.clusters[it->second].push_back(node);
+    result.node_to_cluster[node] = it->second;
+  }
+  return result;
+}
+
 struct NoAreaEstimator final : public AreaEstimator {
  public:
   explicit NoAreaEstimator() : AreaEstimator("NoArea") {}
@@ -537,4 +632,126 @@ absl::StatusOr<viz::Package> IrToProto(
   return proto;
 }
 
+absl::Status IrToClusteredProtos(
+    FunctionBase* function, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule, int64_t max_cluster_size,
+    const std::function<absl::Status(const viz::FunctionBaseSummary&)>&
+        summary_callback,
+    const std::function<absl::Status(const viz::ClusterDetail&)>&
+        cluster_callback) {
+  XLS_RET_CHECK_GT(max_cluster_size, 0);
+  XLS_RET_CHECK(schedule == nullptr || schedule->function_base() == function);
+  absl::flat_hash_map<FunctionBase*, std::string> function_ids =
+      GetFunctionIds(function->package());
+  const std::string& function_id = function_ids.at(function);
+  Clustering clustering = ClusterNodes(function, schedule, max_cluster_size);
+  auto cluster_id = [&](int64_t index) {
+    return absl::StrFormat("%s_c%d", function_id, index);
+  };
+  std::vector<CriticalPathEntry> critical_path;
+  absl::flat_hash_map<Node*, CriticalPathEntry*> node_to_critical_path_entry =
+      CriticalPathMap(function, delay_estimator, critical_path);
+
+  viz::FunctionBaseSummary summary;
+  summary.set_name(function->name());
+  summary.set_id(function_id);
+  summary.set_kind(FunctionBaseKind(function));
+  for (int64_t i = 0; i < clustering.clusters.size(); ++i) {
+    const std::vector<Node*>& nodes = clustering.clusters[i];
+    viz::Cluster* cluster = summary.add_clusters();
+    cluster->set_id(cluster_id(i));
+    cluster->set_node_count(nodes.size());
+    if (schedule != nullptr) {
+      int64_t cycle = schedule->cycle(nodes.front());
+      cluster->set_cycle(cycle);
+      cluster->set_name(absl::StrFormat("stage %d", cycle));
+    } else {
+      // The root of a cone is its last node in topological order.
+      cluster->set_name(nodes.back()->GetName());
+    }
+    cluster->set_on_critical_path(absl::c_any_of(nodes, [&](Node* node) {
+      return node_to_critical_path_entry.contains(node);
+    }));
+  }
+  absl::btree_map<std::pair<int64_t, int64_t>, viz::ClusterEdge>
+      cluster_edges;
+  for (Node* node : function->nodes()) {
+    int64_t target = clustering.node_to_cluster.at(node);
+    for (Node* operand : node->operands()) {
+      int64_t source = clustering.node_to_cluster.at(operand);
+      if (source == target) {
+        continue;
+      }
+      viz::ClusterEdge& edge = cluster_edges[{source, target}];
+      edge.set_edge_count(edge.edge_count() + 1);
+      edge.set_bit_width(edge.bit_width() +
+                         operand->GetType()->GetFlatBitCount());
+    }
+  }
+  for (auto& [key, edge] : cluster_edges) {
+    edge.set_source_id(cluster_id(key.first));
+    edge.set_target_id(cluster_id(key.second));
+    *summary.add_edges() = std::move(edge);
+  }
+  cluster_edges.clear();
+  XLS_RETURN_IF_ERROR(summary_callback(summary));
+  summary.Clear();
+
+  // The BDD engine dominates the runtime on large graphs so only ternary
+  // known bits are reported in clustered mode.
+  TernaryQueryEngine query_engine;
+  XLS_RETURN_IF_ERROR(query_engine.Populate(function).status());
+  NoAreaEstimator no_area;
+
+  // Each cluster is built and handed off on its own so only one cluster's
+  // detail is held in memory at a time.
+  for (int64_t i = 0; i < clustering.clusters.size(); ++i) {
+    viz::ClusterDetail detail;
+    detail.set_function_id(function_id);
+    detail.set_cluster_id(cluster_id(i));
+    viz::Node* implicit_sink = nullptr;
+    for (Node* node : clustering.clusters[i]) {
+      XLS_RETURN_IF_ERROR(NodeToVisualizationProto(
+          node, node_to_critical_path_entry, query_engine, schedule,
+          delay_estimator, no_area, function_ids, detail.add_nodes()));
+    }
+    for (Node* node : clustering.clusters[i]) {
+      bool node_on_critical_path = node_to_critical_path_entry.contains(node);
+      for (Node* operand : node->operands()) {
+        OperandEdgeToVisualizationProto(
+            operand, node,
+            node_on_critical_path &&
+                node_to_critical_path_entry.contains(operand),
+            function_ids, detail.add_edges());
+        int64_t source = clustering.node_to_cluster.at(operand);
+        if (source != i) {
+          (*detail.mutable_external_node_clusters())[GetNodeUniqueId(
+              operand, function_ids)] = cluster_id(source);
+        }
+      }
+      if (function->HasImplicitUse(node)) {
+        if (implicit_sink == nullptr) {
+          implicit_sink = detail.add_nodes();
+          implicit_sink->set_name(absl::StrCat(function->name(), "_sink"));
+          implicit_sink->set_id(absl::StrCat(cluster_id(i), "_sink"));
+          implicit_sink->set_opcode("ret");
+          implicit_sink->mutable_attributes()->set_on_critical_path(false);
+        }
+        if (node_on_critical_path) {
+          implicit_sink->mutable_attributes()->set_on_critical_path(true);
+        }
+        viz::Edge* sink_edge = detail.add_edges();
+        sink_edge->set_id(absl::StrFormat("%s_to_%s",
+                                          GetNodeUniqueId(node, function_ids),
+                                          implicit_sink->id()));
+        sink_edge->set_source_id(GetNodeUniqueId(node, function_ids));
+        sink_edge->set_target_id(implicit_sink->id());
+        sink_edge->set_on_critical_path(node_on_critical_path);
+      }
+    }
+    XLS_RETURN_IF_ERROR(cluster_callback(detail));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xls
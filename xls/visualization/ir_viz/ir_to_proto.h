@@ -15,12 +15,16 @@
 #ifndef XLS_VISUALIZATION_IR_VIZ_IR_TO_PROTO_H_
 #define XLS_VISUALIZATION_IR_VIZ_IR_TO_PROTO_H_
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <string_view>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/estimators/area_model/area_estimator.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/visualization/ir_viz/visualization.pb.h"
@@ -40,6 +44,20 @@ absl::StatusOr<xls::viz::Package> IrToProto(
     Package* package, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule = nullptr,
     std::optional<std::string_view> entry_name = std::nullopt);
+
+// Produces a summarized, clustered visualization of `function` for graphs too
+// large to render whole. Nodes are grouped into clusters of at most
+// `max_cluster_size` nodes (per pipeline stage if `schedule` is given, per
+// output fan-in cone otherwise). `summary_callback` is invoked once with the
+// cluster graph, then `cluster_callback` once per cluster with the cluster's
+// nodes and incoming edges. Node and edge ids match those of IrToProto.
+absl::Status IrToClusteredProtos(
+    FunctionBase* function, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule, int64_t max_cluster_size,
+    const std::function<absl::Status(const viz::FunctionBaseSummary&)>&
+        summary_callback,
+    const std::function<absl::Status(const viz::ClusterDetail&)>&
+        cluster_callback);
 }  // namespace xls
 
 #endif  // XLS_VISUALIZATION_IR_VIZ_IR_TO_PROTO_H_
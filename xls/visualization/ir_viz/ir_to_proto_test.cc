@@ -14,12 +14,15 @@
 
 #include "xls/visualization/ir_viz/ir_to_proto.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <string_view>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/golden_files.h"
 #include "xls/common/status/matchers.h"
@@ -92,6 +95,97 @@ TEST_F(IrToProtoTest, SimpleFunctionWithSchedule) {
   ExpectEqualToGoldenFile(GoldenFilePath("htmltext"), proto.ir_html());
 }
 
+TEST_F(IrToProtoTest, ClusteredByStage) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  BValue negate = fb.Negate(add);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ScheduleCycleMap cycle_map;
+  cycle_map[x.node()] = 0;
+  cycle_map[y.node()] = 0;
+  cycle_map[add.node()] = 1;
+  cycle_map[negate.node()] = 1;
+  PipelineSchedule schedule(f, cycle_map);
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+
+  viz::FunctionBaseSummary summary;
+  std::vector<viz::ClusterDetail> details;
+  XLS_ASSERT_OK(IrToClusteredProtos(
+      f, *delay_estimator, &schedule, /*max_cluster_size=*/10,
+      [&](const viz::FunctionBaseSummary& s) {
+        summary = s;
+        return absl::OkStatus();
+      },
+      [&](const viz::ClusterDetail& d) {
+        details.push_back(d);
+        return absl::OkStatus();
+      }));
+
+  ASSERT_EQ(summary.clusters_size(), 2);
+  EXPECT_EQ(summary.clusters(0).name(), "stage 0");
+  EXPECT_EQ(summary.clusters(0).node_count(), 2);
+  EXPECT_EQ(summary.clusters(1).name(), "stage 1");
+  EXPECT_EQ(summary.clusters(1).node_count(), 2);
+  ASSERT_EQ(summary.edges_size(), 1);
+  EXPECT_EQ(summary.edges(0).source_id(), summary.clusters(0).id());
+  EXPECT_EQ(summary.edges(0).target_id(), summary.clusters(1).id());
+  EXPECT_EQ(summary.edges(0).edge_count(), 2);
+  EXPECT_EQ(summary.edges(0).bit_width(), 64);
+
+  ASSERT_EQ(details.size(), 2);
+  EXPECT_EQ(details[1].cluster_id(), summary.clusters(1).id());
+  EXPECT_EQ(details[1].external_node_clusters_size(), 2);
+  for (const auto& [node_id, cluster_id] :
+       details[1].external_node_clusters()) {
+    EXPECT_EQ(cluster_id, summary.clusters(0).id());
+  }
+}
+
+TEST_F(IrToProtoTest, ClusteredByCone) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package test
+
+fn main(x: bits[32], y: bits[32], z: bits[32]) -> (bits[32], bits[32]) {
+  add.1: bits[32] = add(x, y)
+  neg.2: bits[32] = neg(add.1)
+  not.3: bits[32] = not(z)
+  ret tuple.4: (bits[32], bits[32]) = tuple(neg.2, not.3)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+
+  viz::FunctionBaseSummary summary;
+  int64_t detail_count = 0;
+  XLS_ASSERT_OK(IrToClusteredProtos(
+      f, *delay_estimator, /*schedule=*/nullptr, /*max_cluster_size=*/3,
+      [&](const viz::FunctionBaseSummary& s) {
+        summary = s;
+        return absl::OkStatus();
+      },
+      [&](const viz::ClusterDetail& d) {
+        ++detail_count;
+        return absl::OkStatus();
+      }));
+
+  // All nodes feed the single return value so they form one cone, which is
+  // split because it exceeds the maximum cluster size.
+  ASSERT_EQ(summary.clusters_size(), 3);
+  EXPECT_EQ(detail_count, 3);
+  int64_t total_nodes = 0;
+  for (const viz::Cluster& cluster : summary.clusters()) {
+    EXPECT_LE(cluster.node_count(), 3);
+    total_nodes += cluster.node_count();
+  }
+  EXPECT_EQ(total_nodes, 7);
+}
+
 TEST_F(IrToProtoTest, MultipleFunctions) {
   XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
 package test